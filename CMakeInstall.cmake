@@ -180,6 +180,7 @@ function(print_install_overview)
     MESSAGE(STATUS "Build additional utilities:    " ${TCAM_BUILD_TOOLS})
     MESSAGE(STATUS "Build documentation            " ${TCAM_BUILD_DOCUMENTATION})
     MESSAGE(STATUS "Build tests                    " ${TCAM_BUILD_TESTS})
+    MESSAGE(STATUS "Build benchmarks               " ${TCAM_BUILD_BENCHMARKS})
     MESSAGE(STATUS "")
 
   endif (NOT TCAM_EXCLUSIVE_BUILD)
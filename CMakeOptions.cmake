@@ -23,7 +23,9 @@ option(TCAM_BUILD_LIBUSB   "Include support for LibUsb cameras"   ON )
 option(TCAM_BUILD_TOOLS    "Build additional utilities"           ON)
 option(TCAM_BUILD_DOCUMENTATION "Build internal code documentation"    ON)
 option(TCAM_BUILD_TESTS    "Build tests."                         OFF)
+option(TCAM_BUILD_BENCHMARKS "Build benchmarks."                 OFF)
 option(TCAM_BUILD_VIRTCAM  "Build virtual camera backend" ON)
+option(TCAM_BUILD_REPLAY   "Build backend that streams recorded images" ON)
 
 option(TCAM_INTERNAL_ARAVIS "Use internal aravis dependency instead of system libraries" ON)
 option(TCAM_ARAVIS_USB_VISION "Use aravis usb vision backend. Disables v4l2." ON)
@@ -44,6 +46,10 @@ option(TCAM_ENABLE_DATA_INSTALL "Install static data from data/examples folder."
 option(TCAM_ENABLE_BASE_LIBRARIES "Build/install base libraries." ON)
 option(TCAM_BUILD_WITH_GUI "Build/install with GUI applications/dependencies" ON)
 
+option(TCAM_BUILD_OPENCL "Add an OpenCL conversion path to tcamconvert" OFF)
+
+option(TCAM_ENABLE_TRACEPOINTS "Add USDT probes for perf/bpftrace/LTTng, requires sys/sdt.h" ON)
+
 option(TCAM_ENABLE_CMAKE_CLANGFORMAT_TARGET "Enable clang-format build target" ON)
 option(TCAM_PACKAGE_INCLUDE_BUILD_DEPENDENCIES "Include build dependencies in package meta information" ON)
 
@@ -108,6 +114,7 @@ if (TCAM_BUILD_UVC_EXTENSION_LOADER_ONLY)
   set(TCAM_BUILD_TOOLS OFF)
   set(TCAM_BUILD_DOCUMENTATION OFF)
   set(TCAM_BUILD_TESTS OFF)
+  set(TCAM_BUILD_BENCHMARKS OFF)
   set(TCAM_ARAVIS_USB_VISION OFF)
   set(TCAM_EXCLUSIVE_BUILD ON)
 
@@ -127,6 +134,7 @@ if (TCAM_BUILD_GIGETOOL_ONLY)
   set(TCAM_BUILD_TOOLS OFF)
   set(TCAM_BUILD_DOCUMENTATION OFF)
   set(TCAM_BUILD_TESTS OFF)
+  set(TCAM_BUILD_BENCHMARKS OFF)
   set(TCAM_ARAVIS_USB_VISION OFF)
 
   set(TCAM_EXCLUSIVE_BUILD ON)
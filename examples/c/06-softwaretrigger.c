@@ -14,13 +14,95 @@
  * limitations under the License.
  */
 
-/* This example will show you how to trigger images */
+/* This example will show you how to trigger images
+   and how to measure the time between the trigger and the arrival of the image */
+
+#include "gstmetatcamstatistics.h"
 
 #include <gst/gst.h>
 #include <stdio.h> /* printf */
+#include <stdlib.h> /* qsort */
 #include <tcam-property-1.0.h>
 #include <unistd.h> /* sleep  */
 
+#define MAX_SAMPLES 1000
+
+/* trigger latencies in ns, filled by the pad probe */
+struct latency_samples
+{
+    GMutex mutex;
+    guint64 device[MAX_SAMPLES]; /* trigger until tiscamera received the image */
+    guint64 pipeline[MAX_SAMPLES]; /* trigger until the image left tcamsrc */
+    guint count;
+};
+
+
+static GstPadProbeReturn buffer_probe(GstPad* pad __attribute__((unused)),
+                                      GstPadProbeInfo* info,
+                                      gpointer user_data)
+{
+    struct latency_samples* samples = user_data;
+
+    GstBuffer* buffer = gst_pad_probe_info_get_buffer(info);
+    GstMeta* meta = gst_buffer_get_meta(buffer, g_type_from_name("TcamStatisticsMetaApi"));
+
+    if (!meta)
+    {
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstStructure* struc = ((TcamStatisticsMeta*)meta)->structure;
+
+    guint64 issue = 0;
+    guint64 arrival = 0;
+
+    /* only images that answer a software trigger have these fields */
+    if (!gst_structure_get_uint64(struc, "trigger_issue_time_ns", &issue)
+        || !gst_structure_get_uint64(struc, "trigger_arrival_time_ns", &arrival))
+    {
+        return GST_PAD_PROBE_OK;
+    }
+
+    /* both are CLOCK_MONOTONIC, like g_get_monotonic_time */
+    guint64 now = g_get_monotonic_time() * 1000;
+
+    g_mutex_lock(&samples->mutex);
+    if (samples->count < MAX_SAMPLES)
+    {
+        samples->device[samples->count] = arrival - issue;
+        samples->pipeline[samples->count] = now - issue;
+        samples->count++;
+    }
+    g_mutex_unlock(&samples->mutex);
+
+    printf("Triggered image arrived after %.3f ms\n", (arrival - issue) / 1000000.0);
+
+    return GST_PAD_PROBE_OK;
+}
+
+
+static int compare_u64(const void* a, const void* b)
+{
+    guint64 lhs = *(const guint64*)a;
+    guint64 rhs = *(const guint64*)b;
+
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+
+static void print_distribution(const char* name, guint64* values, guint count)
+{
+    qsort(values, count, sizeof(guint64), compare_u64);
+
+    printf("%-10s min %8.3f ms  median %8.3f ms  p90 %8.3f ms  p99 %8.3f ms  max %8.3f ms\n",
+           name,
+           values[0] / 1000000.0,
+           values[count / 2] / 1000000.0,
+           values[(count * 90) / 100] / 1000000.0,
+           values[(count * 99) / 100] / 1000000.0,
+           values[count - 1] / 1000000.0);
+}
+
 
 int main(int argc, char* argv[])
 {
@@ -64,6 +146,9 @@ int main(int argc, char* argv[])
 
     gst_element_set_state(pipeline, GST_STATE_PLAYING);
 
+    struct latency_samples samples = {};
+    g_mutex_init(&samples.mutex);
+
     /*
       This sleep exists only to ensure
       that a live image exists before trigger mode is activated.
@@ -71,6 +156,17 @@ int main(int argc, char* argv[])
      */
     sleep(2);
 
+    /* conversion elements may drop the meta data,
+       so the probe is attached to the source inside of tcambin */
+    GstElement* inner_source = gst_bin_get_by_name(GST_BIN(source), "tcambin-source");
+    if (inner_source)
+    {
+        GstPad* pad = gst_element_get_static_pad(inner_source, "src");
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, buffer_probe, &samples, NULL);
+        gst_object_unref(pad);
+        gst_object_unref(inner_source);
+    }
+
     tcam_property_provider_set_tcam_enumeration(TCAM_PROPERTY_PROVIDER(source), "TriggerMode", "On", &err);
 
     if (err)
@@ -84,6 +180,7 @@ int main(int argc, char* argv[])
     {
         printf("Press 'q' then 'enter' to stop the stream.\n");
         printf("Press 'Enter' to trigger a new image.\n");
+        printf("Press 'b' then 'enter' to trigger 100 images and measure the latency.\n");
 
         char c = getchar();
 
@@ -92,20 +189,46 @@ int main(int argc, char* argv[])
             break;
         }
 
-        tcam_property_provider_set_tcam_command(TCAM_PROPERTY_PROVIDER(source), "TriggerSoftware", &err);
-        if (err)
+        int trigger_count = 1;
+        if (c == 'b')
         {
-            printf("!!! Could not trigger. !!!\n");
-            printf("Error while setting trigger: %s\n", err->message);
-            g_error_free(err);
-            err = NULL;
+            trigger_count = 100;
+            getchar(); /* enter */
         }
-        else
+
+        for (int i = 0; i < trigger_count; ++i)
         {
-            printf("=== Triggered image. ===\n");
+            tcam_property_provider_set_tcam_command(TCAM_PROPERTY_PROVIDER(source), "TriggerSoftware", &err);
+            if (err)
+            {
+                printf("!!! Could not trigger. !!!\n");
+                printf("Error while setting trigger: %s\n", err->message);
+                g_error_free(err);
+                err = NULL;
+                break;
+            }
+
+            if (trigger_count > 1)
+            {
+                /* give the device time to deliver the image */
+                g_usleep(100 * 1000);
+            }
+            else
+            {
+                printf("=== Triggered image. ===\n");
+            }
         }
     }
 
+    g_mutex_lock(&samples.mutex);
+    if (samples.count > 0)
+    {
+        printf("Trigger latency of %u images:\n", samples.count);
+        print_distribution("device", samples.device, samples.count);
+        print_distribution("pipeline", samples.pipeline, samples.count);
+    }
+    g_mutex_unlock(&samples.mutex);
+
     /* deactivate trigger mode */
     /* this is simply to prevent confusion when the camera ist started without wanting to trigger */
     tcam_property_provider_set_tcam_enumeration(TCAM_PROPERTY_PROVIDER(source), "TriggerMode", "Off", &err);
@@ -114,6 +237,7 @@ int main(int argc, char* argv[])
     gst_element_set_state(pipeline, GST_STATE_NULL);
 
     gst_object_unref(source);
+    g_mutex_clear(&samples.mutex);
     /* the pipeline automatically handles all elements that have been added to it.
        thus they do not have to be cleaned up manually */
     gst_object_unref(pipeline);
@@ -17,11 +17,14 @@
 #
 # This example will show you how to enable trigger-mode
 # and how to trigger images with via software trigger.
+# It also measures the time between the trigger and the arrival of the image.
 #
 
 import sys
 import gi
 import time
+import ctypes
+import threading
 
 gi.require_version("Tcam", "1.0")
 gi.require_version("Gst", "1.0")
@@ -29,6 +32,62 @@ gi.require_version("GLib", "2.0")
 
 from gi.repository import Tcam, Gst, GLib
 
+# see 10-metadata.py
+clib = ctypes.CDLL("libtcamgststatistics.so")
+clib.tcam_statistics_get_structure.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_size_t]
+clib.tcam_statistics_get_structure.restype = ctypes.c_bool
+
+meta_out_buffer_size = 1024
+meta_out_buffer = ctypes.create_string_buffer(meta_out_buffer_size)
+
+# trigger latencies in ns
+samples_lock = threading.Lock()
+device_latency = []  # trigger until tiscamera received the image
+pipeline_latency = []  # trigger until the image left tcamsrc
+
+
+def buffer_probe(pad, info):
+    meta = info.get_buffer().get_meta("TcamStatisticsMetaApi")
+    if not meta:
+        return Gst.PadProbeReturn.OK
+
+    if not clib.tcam_statistics_get_structure(hash(meta), meta_out_buffer, meta_out_buffer_size):
+        return Gst.PadProbeReturn.OK
+
+    struc = Gst.Structure.from_string(ctypes.string_at(meta_out_buffer).decode("utf-8"))[0]
+
+    # only images that answer a software trigger have these fields
+    ok_issue, issue = struc.get_uint64("trigger_issue_time_ns")
+    ok_arrival, arrival = struc.get_uint64("trigger_arrival_time_ns")
+    if not ok_issue or not ok_arrival:
+        return Gst.PadProbeReturn.OK
+
+    # both are CLOCK_MONOTONIC
+    now = time.monotonic_ns()
+
+    with samples_lock:
+        device_latency.append(arrival - issue)
+        pipeline_latency.append(now - issue)
+
+    print("Triggered image arrived after {:.3f} ms".format((arrival - issue) / 1000000))
+    return Gst.PadProbeReturn.OK
+
+
+def print_distribution(name, values):
+    values = sorted(values)
+    count = len(values)
+
+    def ms(index):
+        return values[index] / 1000000
+
+    print("{:<10} min {:8.3f} ms  median {:8.3f} ms  p90 {:8.3f} ms  p99 {:8.3f} ms  max {:8.3f} ms"
+          .format(name,
+                  ms(0),
+                  ms(count // 2),
+                  ms(count * 90 // 100),
+                  ms(count * 99 // 100),
+                  ms(-1)))
+
 
 def main():
 
@@ -58,14 +117,30 @@ def main():
     # this is simply to show that the device is running
     time.sleep(2)
 
+    # conversion elements may drop the meta data,
+    # so the probe is attached to the source inside of tcambin
+    inner_source = source.get_by_name("tcambin-source")
+    if inner_source:
+        inner_source.get_static_pad("src").add_probe(Gst.PadProbeType.BUFFER, buffer_probe)
+
     try:
         source.set_tcam_enumeration("TriggerMode", "On")
 
         wait = True
         while wait:
-            input_text = input("Press 'Enter' to trigger an image.\n q + enter to stop the stream.")
+            input_text = input("Press 'Enter' to trigger an image.\n"
+                               " b + enter to trigger 100 images and measure the latency.\n"
+                               " q + enter to stop the stream.")
             if input_text == "q":
                 break
+            elif input_text == "b":
+                try:
+                    for i in range(100):
+                        source.set_tcam_command("TriggerSoftware")
+                        # give the device time to deliver the image
+                        time.sleep(0.1)
+                except GLib.Error as err:
+                    print("!!! Could not trigger. {}!!!\n", err.message)
             else:
                 try:
                     source.set_tcam_command("TriggerSoftware")
@@ -74,6 +149,12 @@ def main():
                 except GLib.Error as err:
                     print("!!! Could not trigger. {}!!!\n", err.message)
 
+        with samples_lock:
+            if device_latency:
+                print("Trigger latency of {} images:".format(len(device_latency)))
+                print_distribution("device", device_latency)
+                print_distribution("pipeline", pipeline_latency)
+
         # deactivate trigger mode
         # this is simply to prevent confusion when the camera ist started without wanting to trigger
         source.set_tcam_enumeration("TriggerMode", "Off")
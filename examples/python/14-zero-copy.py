@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+
+# Copyright 2022 The Imaging Source Europe GmbH
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+#
+# This example will show you how to access image data and statistics
+# of an appsink sample without copies by using libtcamgstframe.
+#
+
+import sys
+import gi
+import time
+import ctypes
+import numpy
+
+gi.require_version("Gst", "1.0")
+
+from gi.repository import Gst
+
+
+class FrameLayout(ctypes.Structure):
+    """
+    Mirror of TcamFrameLayout in gsttcamframe.h
+    """
+    _fields_ = [("data", ctypes.c_void_p),
+                ("size", ctypes.c_size_t),
+                ("width", ctypes.c_uint),
+                ("height", ctypes.c_uint),
+                ("stride", ctypes.c_size_t),
+                ("channels", ctypes.c_uint),
+                ("bytes_per_channel", ctypes.c_uint),
+                ("format", ctypes.c_char * 32)]
+
+
+class FrameStatistics(ctypes.Structure):
+    """
+    Mirror of TcamFrameStatistics in gsttcamframe.h
+    """
+    _fields_ = [("frame_count", ctypes.c_uint64),
+                ("frames_dropped", ctypes.c_uint64),
+                ("capture_time_ns", ctypes.c_uint64),
+                ("camera_time_ns", ctypes.c_uint64),
+                ("resent_packets", ctypes.c_uint64),
+                ("missing_packets", ctypes.c_uint64),
+                ("underruns", ctypes.c_uint64),
+                ("receive_duration_ns", ctypes.c_uint64),
+                ("trigger_issue_time_ns", ctypes.c_uint64),
+                ("trigger_arrival_time_ns", ctypes.c_uint64),
+                ("parameter_set_id", ctypes.c_uint32),
+                ("roi_id", ctypes.c_uint32),
+                ("roi_offset_x", ctypes.c_uint32),
+                ("roi_offset_y", ctypes.c_uint32),
+                ("is_damaged", ctypes.c_int)]
+
+
+clib = ctypes.CDLL("libtcamgstframe.so")
+
+clib.tcam_frame_map.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+clib.tcam_frame_map.restype = ctypes.c_void_p
+clib.tcam_frame_get_layout.argtypes = [ctypes.c_void_p]
+clib.tcam_frame_get_layout.restype = ctypes.POINTER(FrameLayout)
+clib.tcam_frame_unmap.argtypes = [ctypes.c_void_p]
+clib.tcam_frame_unmap.restype = None
+clib.tcam_frame_get_statistics.argtypes = [ctypes.c_void_p, ctypes.POINTER(FrameStatistics)]
+clib.tcam_frame_get_statistics.restype = ctypes.c_int
+
+DTYPES = {1: numpy.uint8, 2: numpy.uint16, 4: numpy.float32}
+
+
+class MappedFrame:
+    """
+    Maps a Gst.Buffer for reading and exposes it as numpy.ndarray.
+    The array refers to the buffer memory and must not be used after the frame is closed.
+    """
+
+    def __init__(self, gst_buffer, caps):
+        # hash() returns the address of the wrapped C object
+        self.handle = clib.tcam_frame_map(hash(gst_buffer), hash(caps))
+        if not self.handle:
+            raise RuntimeError("Unable to map buffer")
+        self.layout = clib.tcam_frame_get_layout(self.handle).contents
+
+    def close(self):
+        if self.handle:
+            clib.tcam_frame_unmap(self.handle)
+            self.handle = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def array(self):
+        """
+        Returns an array of shape (height, width, channels).
+        Packed formats are returned as (height, stride) bytes.
+        """
+        layout = self.layout
+        memory = (ctypes.c_ubyte * layout.size).from_address(layout.data)
+
+        if layout.bytes_per_channel == 0:
+            return numpy.ndarray(shape=(layout.height, layout.stride),
+                                 dtype=numpy.uint8,
+                                 buffer=memory)
+
+        return numpy.ndarray(shape=(layout.height, layout.width, layout.channels),
+                             dtype=DTYPES[layout.bytes_per_channel],
+                             buffer=memory,
+                             strides=(layout.stride,
+                                      layout.channels * layout.bytes_per_channel,
+                                      layout.bytes_per_channel))
+
+
+def get_statistics(gst_buffer):
+    """
+    Returns FrameStatistics or None when the buffer has no TcamStatisticsMeta
+    """
+    statistics = FrameStatistics()
+    if clib.tcam_frame_get_statistics(hash(gst_buffer), ctypes.byref(statistics)):
+        return statistics
+    return None
+
+
+def callback(appsink, user_data):
+    """
+    This function will be called in a separate thread when our appsink
+    says there is data for us.
+    """
+    sample = appsink.emit("pull-sample")
+
+    if sample:
+        gst_buffer = sample.get_buffer()
+
+        with MappedFrame(gst_buffer, sample.get_caps()) as frame:
+            image = frame.array()
+
+            statistics = get_statistics(gst_buffer)
+            frame_count = statistics.frame_count if statistics else "-"
+
+            print("Frame {} format={} shape={} mean={:.1f}".format(frame_count,
+                                                                   frame.layout.format.decode(),
+                                                                   image.shape,
+                                                                   image.mean()),
+                  end="\r")
+
+    return Gst.FlowReturn.OK
+
+
+def main():
+
+    Gst.init(sys.argv)
+    serial = None
+
+    pipeline = Gst.parse_launch("tcambin name=source"
+                                " ! appsink name=sink")
+
+    # test for error
+    if not pipeline:
+        print("Could not create pipeline.")
+        sys.exit(1)
+
+    # The user has not given a serial, so we prompt for one
+    if serial is not None:
+        source = pipeline.get_by_name("source")
+        source.set_property("serial", serial)
+
+    sink = pipeline.get_by_name("sink")
+
+    # tell appsink to notify us when it receives an image
+    sink.set_property("emit-signals", True)
+
+    sink.connect("new-sample", callback, None)
+
+    pipeline.set_state(Gst.State.PLAYING)
+
+    print("Press Ctrl-C to stop.")
+
+    try:
+        while True:
+            time.sleep(1)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        pipeline.set_state(Gst.State.NULL)
+
+
+if __name__ == "__main__":
+    main()
@@ -83,6 +83,8 @@ namespace cpu
         CPU_ARM_A7              = 0x0002,  // supported by ARM Cortex-A7 processors (raspberry pi 2 + 3) (Note: this is not AARCH32)
         CPU_ARM_A8              = 0x0004,  // supported by ARM Cortex-A8 processors, this is AARCH32
         CPU_ARM_A64             = 0x0008,  // supported by ARM Cortex-A8+ processors 64-bit OS, this also known as AARCH64
+        CPU_ARM_SVE             = 0x0010,  // scalable vectors, e.g. Neoverse V1 (Graviton3), reported by the kernel through HWCAP_SVE
+        CPU_ARM_SVE2            = 0x0020,  // SVE2, e.g. Neoverse N2/V2, reported through HWCAP2_SVE2
 
         // Each step contains the previous + a new flag
         // even though a cpu might have features, a specification of this uses the lowest denominator
@@ -92,6 +94,8 @@ namespace cpu
         CPU_UsesARM_A7 = CPU_ARM_A7 | CPU_C,
         CPU_UsesARM_A8 = CPU_ARM_A8 | CPU_UsesARM_A7,
         CPU_UsesARM_A64 = CPU_ARM_A64 | CPU_UsesARM_A8,
+        CPU_UsesARM_SVE = CPU_ARM_SVE | CPU_UsesARM_A64,
+        CPU_UsesARM_SVE2 = CPU_ARM_SVE2 | CPU_UsesARM_SVE,
 
         CPU_JETSON_NANO = CPU_UsesARM_A64,                   // Cortex-A57, 64bit OS
         CPU_RPI4 = CPU_UsesARM_A8,                          // Cortex-A57, 64bit OS
@@ -147,6 +151,7 @@ namespace cpu
         CPU_UsesAVX2    = CPU_UsesAVX1 | CPU_AVX2 | CPU_FMA3,
             
         CPU_UsesAVX512_F = CPU_UsesAVX2 | CPU_AVX512_F,
+        CPU_UsesAVX512_BW = CPU_UsesAVX512_F | CPU_AVX512_BW,
         CPU_UsesAVX512_BASE0 = CPU_UsesAVX512_F | CPU_AVX512_CD | CPU_AVX512_VL | CPU_AVX512_DQ | CPU_AVX512_BW,
 
         CPU_UsesMaxAvailable = CPU_UsesAVX512_BASE0,
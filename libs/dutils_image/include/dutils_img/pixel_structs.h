@@ -78,6 +78,9 @@ namespace pixel_type {
     struct RGBf {
         float r, g, b;
     };
+    struct BGRf {
+        float b, g, r;
+    };
 
     struct Y8 {
         uint8_t y;
@@ -0,0 +1,333 @@
+#pragma once
+
+#include <dutils_img/image_fourcc_enum.h>
+#include <dutils_img/image_bayer_pattern.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace img_lib::fcc_traits
+{
+    using img::by_transform::by_pattern;
+
+    enum class packing : uint8_t
+    {
+        none,           // one pixel per 8/16/32-bit container
+        packed,         // 12p, 2 pixels in 3 bytes, the low nibbles share the middle byte
+        spacked,        // 10sp/12sp, consecutive bits
+        mipi,           // 10m/12m, the high bytes followed by a byte with the low bits
+    };
+
+    enum fcc_flags : uint16_t
+    {
+        flag_rgb = 0x01,
+        flag_yuv = 0x02,
+        flag_mono = 0x04,
+        flag_bayer = 0x08,          // set for all formats with a bayer pattern, including pwl and polarized bayer
+        flag_pwl = 0x10,
+        flag_polarized = 0x20,
+        flag_compressed = 0x40,
+        flag_float = 0x80,
+    };
+
+    /** Static description of a fourcc, used in place of chains of is_XX_fcc calls and string compares.
+     *
+     * bit_depth is the count of significant bits of a channel, e.g. 12 for MONO12_PACKED and BGGR12, 8 for BGRA32.
+     */
+    struct fcc_trait
+    {
+        img::fourcc     fcc = img::fourcc::FCC_NULL;
+        uint16_t        flags = 0;
+        uint8_t         bit_depth = 0;
+        packing         pack = packing::none;
+        by_pattern      pattern = by_pattern::BG;   // only valid when has_bayer_pattern()
+
+        const char*     gst_struct_name = nullptr;
+        const char*     gst_format = nullptr;       // nullptr when the caps have no format field, e.g. image/jpeg
+
+        constexpr bool  is_valid() const noexcept { return fcc != img::fourcc::FCC_NULL; }
+
+        constexpr bool  has_bayer_pattern() const noexcept { return flags & flag_bayer; }
+        constexpr bool  is_polarized() const noexcept { return flags & flag_polarized; }
+        constexpr bool  is_pwl_bayer() const noexcept { return flags & flag_pwl; }
+        constexpr bool  is_compressed() const noexcept { return flags & flag_compressed; }
+        constexpr bool  is_float() const noexcept { return flags & flag_float; }
+        constexpr bool  is_yuv() const noexcept { return flags & flag_yuv; }
+
+        // the plain formats, without polarized and pwl formats, these match img::is_bayer_fcc and img::is_mono_fcc
+        constexpr bool  is_bayer() const noexcept { return (flags & (flag_bayer | flag_pwl | flag_polarized)) == flag_bayer; }
+        constexpr bool  is_mono() const noexcept { return (flags & (flag_mono | flag_polarized)) == flag_mono; }
+        constexpr bool  is_rgb() const noexcept { return (flags & (flag_rgb | flag_polarized)) == flag_rgb; }
+
+        constexpr bool  is_polarized_bayer() const noexcept { return (flags & (flag_bayer | flag_polarized)) == (flag_bayer | flag_polarized); }
+        constexpr bool  is_polarized_mono() const noexcept { return (flags & (flag_mono | flag_polarized)) == (flag_mono | flag_polarized); }
+    };
+
+namespace detail
+{
+    constexpr const char*   gst_video_raw = "video/x-raw";
+    constexpr const char*   gst_video_bayer = "video/x-bayer";
+    constexpr const char*   gst_video_tis = "video/tis";
+    constexpr const char*   gst_image_jpeg = "image/jpeg";
+
+    constexpr fcc_trait     rgb( img::fourcc fcc, int bits, const char* fmt, uint16_t extra = 0 ) noexcept {
+        return { fcc, static_cast<uint16_t>( flag_rgb | extra ), static_cast<uint8_t>( bits ), packing::none, by_pattern::BG, gst_video_raw, fmt };
+    }
+    constexpr fcc_trait     yuv( img::fourcc fcc, const char* fmt ) noexcept {
+        return { fcc, flag_yuv, 8, packing::none, by_pattern::BG, gst_video_raw, fmt };
+    }
+    constexpr fcc_trait     mono( img::fourcc fcc, int bits, packing pack, const char* fmt, uint16_t extra = 0 ) noexcept {
+        return { fcc, static_cast<uint16_t>( flag_mono | extra ), static_cast<uint8_t>( bits ), pack, by_pattern::BG, gst_video_raw, fmt };
+    }
+    constexpr fcc_trait     bayer( img::fourcc fcc, by_pattern pattern, int bits, packing pack, const char* fmt, uint16_t extra = 0 ) noexcept {
+        return { fcc, static_cast<uint16_t>( flag_bayer | extra ), static_cast<uint8_t>( bits ), pack, pattern, gst_video_bayer, fmt };
+    }
+    constexpr fcc_trait     adi( img::fourcc fcc, uint16_t kind, int bits, const char* fmt ) noexcept {
+        return { fcc, static_cast<uint16_t>( kind | flag_polarized ), static_cast<uint8_t>( bits ), packing::none, by_pattern::BG, gst_video_tis, fmt };
+    }
+
+    using img::fourcc;
+    using pt = by_pattern;
+
+    // every fourcc and every (gst_struct_name, gst_format) pair must be unique, build_slots fails otherwise
+    constexpr fcc_trait     table[] =
+    {
+        rgb( fourcc::BGRA32,                8,  "BGRx" ),
+        rgb( fourcc::BGR24,                 8,  "BGR" ),
+        rgb( fourcc::BGRA64,                16, "RGBx64" ),
+        rgb( fourcc::BGRFloat,              32, "BGRfloat", flag_float ),
+
+        mono( fourcc::MONO8,                8,  packing::none,      "GRAY8" ),
+        mono( fourcc::MONO10,               10, packing::none,      "GRAY10" ),
+        mono( fourcc::MONO10_SPACKED,       10, packing::spacked,   "GRAY10sp" ),
+        mono( fourcc::MONO10_MIPI_PACKED,   10, packing::mipi,      "GRAY10m" ),
+        mono( fourcc::MONO12,               12, packing::none,      "GRAY12" ),
+        mono( fourcc::MONO12_PACKED,        12, packing::packed,    "GRAY12p" ),
+        mono( fourcc::MONO12_SPACKED,       12, packing::spacked,   "GRAY12sp" ),
+        mono( fourcc::MONO12_MIPI_PACKED,   12, packing::mipi,      "GRAY12m" ),
+        mono( fourcc::MONO16,               16, packing::none,      "GRAY16_LE" ),
+        mono( fourcc::MONOFloat,            32, packing::none,      "GREYf", flag_float ),
+
+        bayer( fourcc::GRBG8,               pt::GR, 8,  packing::none,      "grbg" ),
+        bayer( fourcc::RGGB8,               pt::RG, 8,  packing::none,      "rggb" ),
+        bayer( fourcc::GBRG8,               pt::GB, 8,  packing::none,      "gbrg" ),
+        bayer( fourcc::BGGR8,               pt::BG, 8,  packing::none,      "bggr" ),
+        bayer( fourcc::GBRG10,              pt::GB, 10, packing::none,      "gbrg10" ),
+        bayer( fourcc::BGGR10,              pt::BG, 10, packing::none,      "bggr10" ),
+        bayer( fourcc::GRBG10,              pt::GR, 10, packing::none,      "grbg10" ),
+        bayer( fourcc::RGGB10,              pt::RG, 10, packing::none,      "rggb10" ),
+        bayer( fourcc::GBRG10_SPACKED,      pt::GB, 10, packing::spacked,   "gbrg10sp" ),
+        bayer( fourcc::BGGR10_SPACKED,      pt::BG, 10, packing::spacked,   "bggr10sp" ),
+        bayer( fourcc::GRBG10_SPACKED,      pt::GR, 10, packing::spacked,   "grbg10sp" ),
+        bayer( fourcc::RGGB10_SPACKED,      pt::RG, 10, packing::spacked,   "rggb10sp" ),
+        bayer( fourcc::GBRG10_MIPI_PACKED,  pt::GB, 10, packing::mipi,      "gbrg10m" ),
+        bayer( fourcc::BGGR10_MIPI_PACKED,  pt::BG, 10, packing::mipi,      "bggr10m" ),
+        bayer( fourcc::GRBG10_MIPI_PACKED,  pt::GR, 10, packing::mipi,      "grbg10m" ),
+        bayer( fourcc::RGGB10_MIPI_PACKED,  pt::RG, 10, packing::mipi,      "rggb10m" ),
+        bayer( fourcc::GBRG12,              pt::GB, 12, packing::none,      "gbrg12" ),
+        bayer( fourcc::BGGR12,              pt::BG, 12, packing::none,      "bggr12" ),
+        bayer( fourcc::GRBG12,              pt::GR, 12, packing::none,      "grbg12" ),
+        bayer( fourcc::RGGB12,              pt::RG, 12, packing::none,      "rggb12" ),
+        bayer( fourcc::GBRG12_PACKED,       pt::GB, 12, packing::packed,    "gbrg12p" ),
+        bayer( fourcc::BGGR12_PACKED,       pt::BG, 12, packing::packed,    "bggr12p" ),
+        bayer( fourcc::GRBG12_PACKED,       pt::GR, 12, packing::packed,    "grbg12p" ),
+        bayer( fourcc::RGGB12_PACKED,       pt::RG, 12, packing::packed,    "rggb12p" ),
+        bayer( fourcc::GBRG12_SPACKED,      pt::GB, 12, packing::spacked,   "gbrg12sp" ),
+        bayer( fourcc::BGGR12_SPACKED,      pt::BG, 12, packing::spacked,   "bggr12sp" ),
+        bayer( fourcc::GRBG12_SPACKED,      pt::GR, 12, packing::spacked,   "grbg12sp" ),
+        bayer( fourcc::RGGB12_SPACKED,      pt::RG, 12, packing::spacked,   "rggb12sp" ),
+        bayer( fourcc::GBRG12_MIPI_PACKED,  pt::GB, 12, packing::mipi,      "gbrg12m" ),
+        bayer( fourcc::BGGR12_MIPI_PACKED,  pt::BG, 12, packing::mipi,      "bggr12m" ),
+        bayer( fourcc::GRBG12_MIPI_PACKED,  pt::GR, 12, packing::mipi,      "grbg12m" ),
+        bayer( fourcc::RGGB12_MIPI_PACKED,  pt::RG, 12, packing::mipi,      "rggb12m" ),
+        bayer( fourcc::GBRG16,              pt::GB, 16, packing::none,      "gbrg16" ),
+        bayer( fourcc::BGGR16,              pt::BG, 16, packing::none,      "bggr16" ),
+        bayer( fourcc::GRBG16,              pt::GR, 16, packing::none,      "grbg16" ),
+        bayer( fourcc::RGGB16,              pt::RG, 16, packing::none,      "rggb16" ),
+        bayer( fourcc::GBRGFloat,           pt::GB, 32, packing::none,      "gbrgf", flag_float ),
+        bayer( fourcc::BGGRFloat,           pt::BG, 32, packing::none,      "bggrf", flag_float ),
+        bayer( fourcc::GRBGFloat,           pt::GR, 32, packing::none,      "grbgf", flag_float ),
+        bayer( fourcc::RGGBFloat,           pt::RG, 32, packing::none,      "rggbf", flag_float ),
+
+        yuv( fourcc::YUY2,                  "YUY2" ),
+        yuv( fourcc::UYVY,                  "UYVY" ),
+        yuv( fourcc::Y411,                  "IYU1" ),
+        yuv( fourcc::NV12,                  "NV12" ),
+        yuv( fourcc::YV12,                  "YV12" ),
+        yuv( fourcc::I420,                  "I420" ),
+
+        { fourcc::MJPG, flag_compressed, 8, packing::none, pt::BG, gst_image_jpeg, nullptr },
+
+        mono( fourcc::POLARIZATION_MONO8_90_45_135_0,           8,  packing::none,      "polarized-GRAY8-v0", flag_polarized ),
+        mono( fourcc::POLARIZATION_MONO12_PACKED_90_45_135_0,   12, packing::packed,    "polarized-GRAY12p-v0", flag_polarized ),
+        mono( fourcc::POLARIZATION_MONO12_SPACKED_90_45_135_0,  12, packing::spacked,   "polarized-GRAY12sp-v0", flag_polarized ),
+        mono( fourcc::POLARIZATION_MONO16_90_45_135_0,          16, packing::none,      "polarized-GRAY16-v0", flag_polarized ),
+        bayer( fourcc::POLARIZATION_BG8_90_45_135_0,            pt::BG, 8,  packing::none,      "polarized-bggr8-v0", flag_polarized ),
+        bayer( fourcc::POLARIZATION_BG12_SPACKED_90_45_135_0,   pt::BG, 12, packing::spacked,   "polarized-bggr12sp-v0", flag_polarized ),
+        bayer( fourcc::POLARIZATION_BG12_PACKED_90_45_135_0,    pt::BG, 12, packing::packed,    "polarized-bggr12p-v0", flag_polarized ),
+        bayer( fourcc::POLARIZATION_BG16_90_45_135_0,           pt::BG, 16, packing::none,      "polarized-bggr16-v0", flag_polarized ),
+
+        adi( fourcc::POLARIZATION_ADI_MONO8,    flag_mono,  8,  "polarized-ADI-GRAY8" ),
+        adi( fourcc::POLARIZATION_ADI_MONO16,   flag_mono,  16, "polarized-ADI-GRAY16" ),
+        adi( fourcc::POLARIZATION_ADI_RGB8,     flag_rgb,   8,  "polarized-ADI-RGB8" ),
+        adi( fourcc::POLARIZATION_ADI_RGB16,    flag_rgb,   16, "polarized-ADI-RGB16" ),
+
+        mono( fourcc::POLARIZATION_PACKED8,                     8,  packing::none,      "polarized-packed-GRAY8", flag_polarized ),
+        mono( fourcc::POLARIZATION_PACKED16,                    16, packing::none,      "polarized-packed-GRAY16", flag_polarized ),
+        bayer( fourcc::POLARIZATION_PACKED8_BAYER_BG,           pt::BG, 8,  packing::none,      "polarized-packed-bggr8", flag_polarized ),
+        bayer( fourcc::POLARIZATION_PACKED16_BAYER_BG,          pt::BG, 16, packing::none,      "polarized-packed-bggr16", flag_polarized ),
+
+        bayer( fourcc::PWL_RG12_MIPI,       pt::RG, 12, packing::mipi,      "pwl-rggb12m", flag_pwl ),
+        bayer( fourcc::PWL_RG12,            pt::RG, 12, packing::none,      "pwl-rggb12", flag_pwl ),
+        bayer( fourcc::PWL_RG16H12,         pt::RG, 12, packing::none,      "pwl-rggb16H12", flag_pwl ),
+    };
+
+    constexpr size_t    table_size = std::size( table );
+
+    /* Both lookups use a perfect hash into a slot array of table indices, the seed is searched at compile time until
+     * no two entries share a slot. With 80 entries in 4096 slots about every third seed works.
+     */
+    constexpr int       slot_bits = 12;
+    constexpr size_t    slot_count = size_t( 1 ) << slot_bits;
+    constexpr uint8_t   empty_slot = 0xFF;
+
+    static_assert( table_size < empty_slot, "the slot arrays store table indices as uint8_t" );
+
+    constexpr uint32_t  mix( uint32_t h ) noexcept
+    {
+        h ^= h >> 16;
+        h *= 0x7feb352dU;
+        h ^= h >> 15;
+        h *= 0x846ca68bU;
+        h ^= h >> 16;
+        return h;
+    }
+
+    constexpr uint32_t  hash_fcc( img::fourcc fcc, uint32_t seed ) noexcept
+    {
+        return mix( static_cast<uint32_t>( fcc ) ^ (seed * 0x9E3779B9U) ) & (slot_count - 1);
+    }
+
+    constexpr uint32_t  fnv1a( uint32_t h, std::string_view str ) noexcept
+    {
+        for( char c : str ) {
+            h = (h ^ static_cast<uint8_t>( c )) * 16777619U;
+        }
+        return h;
+    }
+
+    constexpr uint32_t  hash_gst( std::string_view struct_name, std::string_view format, uint32_t seed ) noexcept
+    {
+        // the 0 separates "ab" + "c" from "a" + "bc"
+        const uint32_t h = fnv1a( fnv1a( 2166136261U ^ seed, struct_name ) * 16777619U, format );
+        return mix( h ^ (seed * 0x9E3779B9U) ) & (slot_count - 1);
+    }
+
+    constexpr std::string_view  format_of( const fcc_trait& t ) noexcept
+    {
+        return t.gst_format != nullptr ? std::string_view{ t.gst_format } : std::string_view{};
+    }
+
+    struct slot_array
+    {
+        uint32_t                            seed = 0;
+        bool                                is_perfect = false;
+        std::array<uint8_t, slot_count>     slots = {};
+    };
+
+    template<class TKeyHash>
+    constexpr slot_array    build_slots( TKeyHash key_hash ) noexcept
+    {
+        for( uint32_t seed = 0; seed < 256; ++seed )
+        {
+            slot_array res;
+            res.seed = seed;
+            for( auto& s : res.slots ) {
+                s = empty_slot;
+            }
+
+            bool collision = false;
+            for( size_t i = 0; i < table_size && !collision; ++i )
+            {
+                auto& s = res.slots[key_hash( table[i], seed )];
+                collision = s != empty_slot;
+                s = static_cast<uint8_t>( i );
+            }
+            if( !collision ) {
+                res.is_perfect = true;
+                return res;
+            }
+        }
+        return {};
+    }
+
+    constexpr slot_array    fcc_slots = build_slots( []( const fcc_trait& t, uint32_t seed ) { return hash_fcc( t.fcc, seed ); } );
+    constexpr slot_array    gst_slots = build_slots( []( const fcc_trait& t, uint32_t seed ) { return hash_gst( t.gst_struct_name, format_of( t ), seed ); } );
+
+    static_assert( fcc_slots.is_perfect, "no collision free seed found for the fourcc hash, check for duplicate fourccs in the table" );
+    static_assert( gst_slots.is_perfect, "no collision free seed found for the caps hash, check for duplicate caps strings in the table" );
+
+    constexpr fcc_trait     unknown_trait = {};
+} // namespace detail
+
+    /** Returns the trait of fcc or nullptr if it is not in the table. */
+    constexpr const fcc_trait*  find( img::fourcc fcc ) noexcept
+    {
+        const auto idx = detail::fcc_slots.slots[detail::hash_fcc( fcc, detail::fcc_slots.seed )];
+        if( idx == detail::empty_slot || detail::table[idx].fcc != fcc ) {
+            return nullptr;
+        }
+        return &detail::table[idx];
+    }
+
+    constexpr const fcc_trait*  find( uint32_t fcc ) noexcept { return find( static_cast<img::fourcc>( fcc ) ); }
+
+    /** Returns the trait of fcc, an empty trait (!is_valid(), all predicates false) if it is not in the table. */
+    constexpr const fcc_trait&  get( img::fourcc fcc ) noexcept
+    {
+        const auto* res = find( fcc );
+        return res != nullptr ? *res : detail::unknown_trait;
+    }
+
+    constexpr const fcc_trait&  get( uint32_t fcc ) noexcept { return get( static_cast<img::fourcc>( fcc ) ); }
+
+    /** Returns the trait for a GstStructure name and its 'format' field, or nullptr.
+     *
+     * Entries without a format field (image/jpeg) match any format_string.
+     */
+    constexpr const fcc_trait*  find_gst( std::string_view struct_name, std::string_view format_string ) noexcept
+    {
+        auto lookup = [struct_name]( std::string_view fmt ) -> const fcc_trait*
+        {
+            const auto idx = detail::gst_slots.slots[detail::hash_gst( struct_name, fmt, detail::gst_slots.seed )];
+            if( idx == detail::empty_slot ) {
+                return nullptr;
+            }
+            const auto& t = detail::table[idx];
+            if( struct_name != t.gst_struct_name || fmt != detail::format_of( t ) ) {
+                return nullptr;
+            }
+            return &t;
+        };
+
+        if( const auto* res = lookup( format_string ) ) {
+            return res;
+        }
+        if( format_string.empty() ) {
+            return nullptr;
+        }
+        const auto* res = lookup( {} );
+        return res != nullptr && res->gst_format == nullptr ? res : nullptr;
+    }
+
+    constexpr const fcc_trait&  get_gst( std::string_view struct_name, std::string_view format_string ) noexcept
+    {
+        const auto* res = find_gst( struct_name, format_string );
+        return res != nullptr ? *res : detail::unknown_trait;
+    }
+
+    // all entries, for callers that have to scan, e.g. to list the supported caps
+    constexpr const auto&       all() noexcept { return detail::table; }
+}
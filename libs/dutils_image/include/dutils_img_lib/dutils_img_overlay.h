@@ -7,6 +7,11 @@
 #include <dutils_img/dutils_img.h>
 #include <dutils_img/pixel_structs.h>
 
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
 namespace img_lib {
 namespace overlay
 {
@@ -49,6 +54,63 @@ namespace overlay
     void	render_text( const img::img_descriptor& dst, img::point pos, int scaling, const char* overlay_text, size_t overlay_text_len, rgba foreground_color, rgba background_color );
 
 
+    enum class render_region
+    {
+        all,
+        dirty,      // only the columns that changed since the last render call
+    };
+
+    /**
+     * Caches the rasterized rows of a text line, so that rendering only copies/blends pre-built rows into the image.
+     * The layout is the same as the one of render_text.
+     *
+     * set_text only re-rasterizes the characters that changed. With render_region::dirty only their columns are written,
+     * this is meant for images that keep the previous overlay, e.g. a preview overlay layer.
+     * When the text gets shorter, the columns behind the new end are not cleared.
+     *
+     * The rows are rebuilt when the format or the colors passed to render change.
+     * Formats that render_text supports, but that have no plain pixel struct (packed, YUV 4:2:2/4:1:1), use render_text.
+     */
+    class text_overlay
+    {
+    public:
+        text_overlay() = default;
+
+        void    set_text( std::string_view text, int scaling );
+
+        void    render( const img::img_descriptor& dst, img::point pos, rgba foreground_color, rgba background_color, render_region region = render_region::all );
+
+        const std::string&  text() const noexcept { return text_; }
+        int                 scaling() const noexcept { return scaling_; }
+        img::dim            dimensions() const noexcept;
+    private:
+        void    update_masks( int x_beg, int x_end );
+        void    update_rows( int x_beg, int x_end );
+        bool    update_colors( img::fourcc pixel_fcc, rgba foreground_color, rgba background_color );
+
+        std::string     text_;
+        int             scaling_ = 0;
+        int             width_ = 0;
+
+        std::vector<uint8_t>    masks_;     // 8 font rows of width_ entries, 1 == foreground
+
+        // the rows in the pixel format of the last render call, 8 font rows and 1 background row, see update_rows
+        img::fourcc     pixel_fcc_ = img::fourcc::FCC_NULL;
+        int             pixel_size_ = 0;
+        rgba            fg_ = {};
+        rgba            bg_ = {};
+        uint8_t         fg_bytes_[8] = {};
+        uint8_t         bg_bytes_[8] = {};
+        bool            fg_writes_ = false;
+        bool            bg_writes_ = false;
+
+        std::vector<uint8_t>    row_values_;
+        std::vector<uint8_t>    row_write_masks_;   // 0xFF for the bytes that are written
+
+        int             dirty_beg_ = 0;
+        int             dirty_end_ = 0;
+    };
+
     inline void	render_text_in_stream( const img::img_descriptor& dst, int index, const char* overlay_text, size_t overlay_text_len, 
         rgba foreground_color = color::red, rgba background_color = color::white )
     {
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace img_lib::scratch
+{
+    // alignment of all blocks, a cache line and the widest SIMD register
+    constexpr size_t    block_alignment = 64;
+
+    /** Scratch memory for lines, strips or frames, drawn from a process wide arena.
+     *
+     * Requests are rounded up to a size class (4 per power of two, starting at 4 KiB), released blocks are kept for the
+     * next request of the same class. Small blocks stay in a cache of the releasing thread, so the worker threads of a
+     * conversion get their strip buffers back without locking. Larger blocks go to the pool shared by all threads,
+     * which caps the memory it keeps.
+     *
+     * The block is returned to the arena when the buffer is destroyed.
+     */
+    class buffer
+    {
+    public:
+        buffer() = default;
+        ~buffer();
+
+        buffer( buffer&& other ) noexcept;
+        buffer& operator=( buffer&& other ) noexcept;
+
+        buffer( const buffer& ) = delete;
+        buffer& operator=( const buffer& ) = delete;
+
+        uint8_t*    data() const noexcept { return static_cast<uint8_t*>( ptr_ ); }
+        size_t      size() const noexcept { return size_; }
+
+        bool        empty() const noexcept { return ptr_ == nullptr; }
+
+        // returns the block to the arena
+        void        reset() noexcept;
+    private:
+        friend buffer   acquire( size_t size );
+
+        void*   ptr_ = nullptr;
+        size_t  size_ = 0;
+        int     size_class_ = -1;   // -1 for blocks larger than the largest class, these are not cached
+    };
+
+    /** Returns a block of at least size bytes, aligned to block_alignment. The content is undefined.
+     * size == 0 returns an empty buffer.
+     * Throws std::bad_alloc when the memory cannot be allocated.
+     */
+    buffer      acquire( size_t size );
+
+    struct arena_stats
+    {
+        size_t  bytes_allocated = 0;    // blocks currently allocated from the system, in use or cached
+        size_t  bytes_cached = 0;       // blocks in the shared pool
+    };
+
+    arena_stats get_stats() noexcept;
+
+    // Frees the blocks in the shared pool and in the cache of the calling thread
+    void        trim() noexcept;
+}
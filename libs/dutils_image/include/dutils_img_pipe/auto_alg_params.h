@@ -91,6 +91,7 @@ namespace auto_alg
             int         focus_device_speed = 500;   // Legacy and GigECam = 500 (will most likely never change ...)
             int         auto_step_divisor = 4;      // Legacy cam = 4, GigECam this is read from  IInteger 'FocusAutoStepDivisor' otherwise 4
             bool        suggest_sweep = false;      // Legacy cam = false, GigECam this is read from IInteger 'FocusAutoSweepHint' otherwise false
+            bool        predictive_search = true;   // coarse to fine search with peak interpolation, false uses the step/binary search (auto_step_divisor, suggest_sweep)
         } run_cmd_params;
     };
 
@@ -4,6 +4,7 @@
 #include <dutils_img/dutils_img.h>
 
 #include "auto_alg_params.h"
+#include "channel_statistics.h"
 #include "dll_export.h"
 #include "dutils_img_state_helper.h"
 
@@ -11,9 +12,11 @@ namespace auto_alg
 {
     namespace detail {
         struct auto_pass_state;
+        struct image_statistics;
     }
 
     using auto_pass_state = detail::auto_pass_state;
+    using image_statistics = detail::image_statistics;
 
     struct whitebalance_values 
     {
@@ -35,6 +38,19 @@ namespace auto_alg
         } temperature;
     };
 
+    struct exposure_metering_params
+    {
+        bool    use_histogram = false;          // when false, the average brightness is driven to the reference
+        float   percentile = 0.5f;              // the brightness below which this fraction of the samples lies is driven to the reference
+        float   max_clipped_fraction = 0.02f;   // at most this fraction of the samples may end up above ~240, this takes precedence over the percentile
+    };
+
+    struct exposure_step_params
+    {
+        float   damping = 2.f;          // a dampened step changes exposure by (dist + damping) / (damping + 1), and gain the same way when it is increased
+        float   max_model_step = 4.f;   // a model step changes exposure or gain by at most this factor
+    };
+
     struct auto_pass_params
     {
         int64_t                 frame_number = 0;
@@ -61,6 +77,12 @@ namespace auto_alg
 
         bool					enable_highlight_reduction = false; // only used, when exposure/gain/iris is enabled
 
+        exposure_metering_params    metering{};
+        exposure_step_params        exposure_step{};
+
+        bool                    exposure_in_flight = false;     // the image was taken before the last written exposure/gain was applied, brightness and whitebalance are not evaluated
+        bool                    exposure_model_step = false;    // only evaluated images show the current exposure/gain, so exposure and gain can step directly to the reference
+
         hdr_gain_selection      hdr_gain{};   // only used when pwl is the input format
     };
 
@@ -94,11 +116,35 @@ namespace auto_alg
         float   image_brightness = 0;
     };
 
+    /** Scene statistics taken from the samples of collect_image_statistics, for analytics consumers. */
+    struct scene_statistics
+    {
+        static constexpr int histogram_bin_count = 64;
+
+        int         sample_count = 0;               // 0 when the image was not sampled
+        float       brightness = 0.f;               // average brightness of the samples in [0;1]
+        float       mean_r = 0.f;                   // average channel values in [0;1], all equal to brightness for mono images
+        float       mean_g = 0.f;
+        float       mean_b = 0.f;
+        float       clipped_fraction = 0.f;         // fraction of the samples with a brightness above ~240
+        uint32_t    histogram[histogram_bin_count] = {};    // brightness histogram of the samples, 4 8-bit levels per bin
+    };
+
+    struct pid_gains
+    {
+        float   p = 0.f;
+        float   i = 0.f;
+        float   d = 0.f;
+        float   e_sum_limit = 0.f;
+    };
+
     struct timing_params
     {
         uint32_t     min_frame_count_between_runs = 2;          // The count of frames to at least wait between runs
         uint32_t     max_frame_count_between_runs = 5;          // The count of frames to at max wait between runs
         uint32_t     max_frame_time_between_runs_us = 100'000;  // The max time between runs (after min_frame_count)
+        uint32_t     focus_settle_time_us = 50'000;             // The time the focus motor needs to settle after reaching a new position, used by the predictive focus search
+        pid_gains    pwm_iris_pid = { 0.4f, 2.0f, 1.0f, 4000.f };  // The controller for pwm iris devices
     };
 
     /** This is the central function which executes the auto algorithm functions on the input img_descriptor
@@ -116,11 +162,42 @@ namespace auto_alg
      */
     auto_pass_results	auto_pass( auto_pass_state& state, const img::img_descriptor& data, const auto_pass_params& params );
     
+    /** Samples the image for the brightness, whitebalance and hdr gain algorithms.
+     * Only a sparse grid of pixels inside params.brightness_roi is read, so this is cheap enough to be run on the capture thread.
+     * The statistics can then be evaluated by auto_pass in another thread, without keeping the image alive.
+     */
+    void                collect_image_statistics( image_statistics& stats, const img::img_descriptor& data, const auto_pass_params& params );
+
+    /** Same as collect_image_statistics above, but takes the statistics accumulated by accumulate_channel_statistics while the image was converted.
+     * channels has to be taken after the whitebalance in params.wb was applied and without color matrix or gamma.
+     * The brightness is measured over the grid cells that overlap params.brightness_roi, the histogram always covers the whole image.
+     */
+    void                collect_image_statistics( image_statistics& stats, const channel_statistics& channels, const auto_pass_params& params );
+
+    /** Same as auto_pass above, but uses statistics collected by collect_image_statistics.
+     * focus_img is only used by the auto focus algorithm and may be empty when focus is not running.
+     */
+    auto_pass_results	auto_pass( auto_pass_state& state, const image_statistics& stats, const img::img_descriptor& focus_img, const auto_pass_params& params );
+
+    /** Fills result from statistics collected by collect_image_statistics.
+     * Returns false when nothing was sampled, e.g. for unsupported formats or when exposure_in_flight was set.
+     */
+    bool                get_scene_statistics( const image_statistics& stats, scene_statistics& result );
+
+    /** Returns the contrast sum the auto focus algorithm uses as sharpness, measured over the whole image.
+     * With decimation > 1 only every decimation-th pixel and line is read, values are only comparable for the same decimation.
+     * Only mono and bayer 8/16 bit images are supported, -1 is returned for other formats and images smaller than 64x64.
+     */
+    int                 calc_image_sharpness( const img::img_descriptor& data, int decimation = 1 );
+
     bool                should_prepare_auto_pass_step( auto_pass_state& state, const auto_pass_params& params ) noexcept;
 
     auto_pass_state*    allocate_auto_pass_state( const timing_params& create_params = {} );
     void                deallocate_auto_pass_state( auto_pass_state* context );
 
+    image_statistics*   allocate_image_statistics();
+    void                deallocate_image_statistics( image_statistics* stats );
+
     // should be called each time you re-/start the stream
     void                reset_auto_pass_context( auto_pass_state& context, const timing_params& create_param = {} );
 
@@ -132,4 +209,10 @@ namespace auto_alg
     inline state_ptr  make_state_ptr( timing_params params = {} ) {
         return state_ptr{ auto_alg::allocate_auto_pass_state( params ) };
     }
+
+    using statistics_ptr = dutils::state_ptr_type<auto_alg::image_statistics, auto_alg::deallocate_image_statistics>;
+
+    inline statistics_ptr  make_statistics_ptr() {
+        return statistics_ptr{ auto_alg::allocate_image_statistics() };
+    }
 }
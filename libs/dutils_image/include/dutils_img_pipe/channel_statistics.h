@@ -0,0 +1,54 @@
+
+#pragma once
+
+#include <dutils_img/dutils_img.h>
+
+#include <cstdint>
+
+namespace auto_alg
+{
+    /** Statistics of a BGRA32 image for the brightness and whitebalance algorithms, see collect_image_statistics.
+     * They are accumulated while the image is converted, so the image is not read a second time.
+     * All pixels of every line_step-th line are counted.
+     * The struct is trivially copyable, so it can be handed to another thread or element as is.
+     */
+    struct channel_statistics
+    {
+        static constexpr int histogram_bin_count = 64;  // 4 8-bit levels per bin
+        static constexpr int grid_size = 16;            // the image is split into grid_size x grid_size cells
+        static constexpr int line_step = 4;             // only the lines with y % line_step == 0 are counted
+
+        enum channel { r = 0, g = 1, b = 2 };
+
+        struct grid_cell
+        {
+            uint64_t    sum[3];             // indexed by channel
+            uint32_t    count;
+            uint32_t    count_above_240;    // pixels with a brightness >= 240, see calc_brightness_from_clr_avg
+        };
+
+        img::dim    dim = { 0, 0 };         // of the whole image, the grid is laid over it
+
+        uint64_t    pixel_count = 0;
+        uint64_t    count_above_240 = 0;
+
+        uint32_t    histogram[3][histogram_bin_count] = {};         // indexed by channel
+        uint32_t    brightness_histogram[histogram_bin_count] = {};
+
+        grid_cell   grid[grid_size][grid_size] = {};   // [row][column]
+
+        void    reset( img::dim image_dim ) noexcept;
+        void    merge( const channel_statistics& other ) noexcept;
+
+        bool    empty() const noexcept { return pixel_count == 0; }
+
+        // The mean of channel c in the cell in [0;1], 0 for cells without pixels
+        float   grid_mean( int row, int column, channel c ) const noexcept;
+    };
+
+    /** Adds bgra_lines, which are the lines [first_line;first_line + bgra_lines.dim.cy) of the image stats was reset for, to stats.
+     * The lines are expected top down and have to be BGRA32.
+     * Called by the debayer stage for each strip it wrote, while these are still in the cache.
+     */
+    void    accumulate_channel_statistics( channel_statistics& stats, const img::img_descriptor& bgra_lines, int first_line );
+}
@@ -6,9 +6,39 @@
 
 #if defined DUTILS_ARCH_ARM
 
+#if defined DUTILS_ARCH_ARM_A64 && defined __linux__
+
+#include <sys/auxv.h>
+
+// from asm/hwcap.h, which older toolchains do not provide
+#ifndef HWCAP_SVE
+#define HWCAP_SVE   (1 << 22)
+#endif
+#ifndef HWCAP2_SVE2
+#define HWCAP2_SVE2 (1 << 1)
+#endif
+
+static unsigned int     actual_get_features() noexcept
+{
+    using namespace img::cpu;
+
+    unsigned int features = CPU_UsesARM_A64;
+    if( getauxval( AT_HWCAP ) & HWCAP_SVE )
+    {
+        features |= CPU_ARM_SVE;
+        features |= (getauxval( AT_HWCAP2 ) & HWCAP2_SVE2) ? (unsigned)CPU_ARM_SVE2 : 0;
+    }
+    return features;
+}
+
+#endif
+
 unsigned int img_lib::cpu::get_features() noexcept
 {
-#if defined DUTILS_ARCH_ARM_A64
+#if defined DUTILS_ARCH_ARM_A64 && defined __linux__
+    static unsigned int cpu_features = actual_get_features();
+    return cpu_features;
+#elif defined DUTILS_ARCH_ARM_A64
     return img::cpu::CPU_UsesARM_A64;
 #elif defined  DUTILS_ARCH_ARM_A8
     return img::cpu::CPU_UsesARM_A8;
@@ -124,6 +154,16 @@ static bool is_AVX512F_supported() noexcept
     return supported;
 }
 
+static bool is_AVX512BW_supported() noexcept
+{
+    bool supported = false;
+#if defined _MSC_VER
+#elif defined __GNUC__
+    supported = __builtin_cpu_supports( "avx512bw" );
+#endif
+    return supported;
+}
+
 
 static unsigned int     actual_get_features() noexcept
 {
@@ -147,6 +187,7 @@ static unsigned int     actual_get_features() noexcept
         features |= is_AVX2_supported() ? (unsigned)CPU_AVX2 : 0;
         features |= is_FMA_supported() ? (unsigned)CPU_FMA3 : 0;
         features |= is_AVX512F_supported() ? (unsigned)CPU_AVX512_F : 0;
+        features |= is_AVX512BW_supported() ? (unsigned)CPU_AVX512_BW : 0;
     }
     return features;
 }
@@ -164,7 +205,9 @@ const char*     img_lib::cpu::to_string( img::cpu::cpu_features feat ) noexcept
     using namespace img::cpu;
 
 #if !defined DUTILS_ARCH_ARM
-    if( feat & CPU_AVX2 ) {
+    if( feat & CPU_AVX512_BW ) {
+        return "AVX-512 BW";
+    } else if( feat & CPU_AVX2 ) {
         return "AVX2";
     } else if( feat & CPU_AVX1 ) {
         return "AVX";
@@ -176,7 +219,11 @@ const char*     img_lib::cpu::to_string( img::cpu::cpu_features feat ) noexcept
         return "C";
     }
 #else
-    if( feat & CPU_ARM_A64 ) {
+    if( feat & CPU_ARM_SVE2 ) {
+        return "ARMv9 SVE2";
+    } else if( feat & CPU_ARM_SVE ) {
+        return "ARMv8 SVE";
+    } else if( feat & CPU_ARM_A64 ) {
         return "ARMv8 NEON A64";
     } else if( feat & CPU_ARM_A8 ) {
         return "ARMv8 NEON A32";
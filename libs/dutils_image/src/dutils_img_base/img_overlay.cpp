@@ -4,6 +4,16 @@
 
 #include "interop_private.h"
 
+#include <algorithm>
+#include <cstring>
+
+#if !defined DUTILS_ARCH_ARM && (defined __SSE2__ || defined _M_X64)
+#include <emmintrin.h>
+#define DUTILS_OVERLAY_SSE2 1
+#elif defined DUTILS_ARCH_ARM_A64
+#include <arm_neon.h>
+#endif
+
 namespace
 {
 //
@@ -348,7 +358,7 @@ FORCEINLINE void    write_pix_to_iter( BGRA32* base, int index, BGRA32 clr ) noe
 }
 FORCEINLINE void    write_pix_to_iter( BGR24* base, int index, BGRA32 clr ) noexcept
 {
-    base[index] = BGR24{ clr.g, clr.b, clr.r };
+    base[index] = BGR24{ clr.b, clr.g, clr.r };
 }
 FORCEINLINE void    write_pix_to_iter( BGRA64* base, int index, BGRA32 clr ) noexcept
 {
@@ -598,32 +608,22 @@ void	render_worker( const img::img_descriptor& data, const img::point start_pos,
     }
 }
 
+constexpr int   calc_text_width( size_t text_len, int scaling ) noexcept
+{
+    return (int)text_len * scaling * 8 + 1 + (int)text_len;
 }
 
-void	img_lib::overlay::render_text( const img::img_descriptor& data, img::point pos, int scaling, const char* pText, size_t text_len, rgba FgColor, rgba BgColor )
+constexpr int   calc_text_height( int scaling ) noexcept
 {
-    if( text_len == 0 || pText == nullptr )     return; // text len == 0, skip fully
-    if( scaling <= 0 )                          return; // scaling invalid
+    return 2 + scaling * 8; // 1 row over/under lines + 8 * scaling rows
+}
 
+// Moves centered overlays into place, returns false when pos is outside of the image
+bool    place_text( img::dim dim, img::point& pos, int text_width_in_pixel, int text_height_in_pixel ) noexcept
+{
     // When pos is outside of the image, skip
-    if( pos.x >= data.dim.cx )	return;
-    if( pos.y >= data.dim.cy )	return;
-
-
-    // The overlay is drawn in the form of 
-    //
-    // ---------
-    // |a|a|a|a|
-    // ---------
-    //
-    // - rows are 1 pixel high
-    // a rows are 8 (*s caling) pixel thick
-    // | columns are 1 pixel thick
-    // a columns are 8 (* scaling) pixel thick
-    //
-    // this calculates the exact dimensions needed
-    int text_width_in_pixel = (int)text_len * scaling * 8 + 1 + (int)text_len;
-    int text_height_in_pixel = 2 + scaling * 8; // 1 row over/under lines + 8 * scaling rows
+    if( pos.x >= dim.cx )	return false;
+    if( pos.y >= dim.cy )	return false;
 
     //
     // Adjust for center overlays.
@@ -631,25 +631,153 @@ void	img_lib::overlay::render_text( const img::img_descriptor& data, img::point
     // NOTE: If the overlay doesn't fit into the synthesis buffer, this
     // merely left aligns the overlay and clips off the right side.
     //
-    if( pos.x == POSITION_CENTER ) 
+    if( pos.x == img_lib::overlay::POSITION_CENTER )
     {
-        if( text_width_in_pixel >= data.dim.cx ) {
+        if( text_width_in_pixel >= dim.cx ) {
             pos.x = 0;
         } else {
-            pos.x = (data.dim.cx - text_width_in_pixel) / 2;
+            pos.x = (dim.cx - text_width_in_pixel) / 2;
         }
     }
-    if( pos.y == POSITION_CENTER )
+    if( pos.y == img_lib::overlay::POSITION_CENTER )
     {
-        if( text_height_in_pixel >= data.dim.cy ) {
+        if( text_height_in_pixel >= dim.cy ) {
             pos.y = 0;
         } else {
-            pos.y = (data.dim.cy - text_height_in_pixel) / 2;
+            pos.y = (dim.cy - text_height_in_pixel) / 2;
         }
     }
 
-    assert( pos.x < data.dim.cx );
-    assert( pos.y < data.dim.cy );
+    assert( pos.x < dim.cx );
+    assert( pos.y < dim.cy );
+    return true;
+}
+
+// The formats with one pixel struct per pixel, these are rendered from the cached rows of text_overlay
+img::fourcc     get_row_pixel_fcc( img::fourcc fcc ) noexcept
+{
+    switch( fcc )
+    {
+    case img::fourcc::BGRA32:
+    case img::fourcc::BGRA64:
+    case img::fourcc::BGR24:
+        return fcc;
+
+    case img::fourcc::MONO8:
+    case img::fourcc::YUV8PLANAR:
+    case img::fourcc::YV12:
+    case img::fourcc::I420:
+    case img::fourcc::NV12:
+    case img::fourcc::BGGR8:
+    case img::fourcc::GBRG8:
+    case img::fourcc::RGGB8:
+    case img::fourcc::GRBG8:
+        return img::fourcc::MONO8;
+
+    case img::fourcc::MONO16:
+    case img::fourcc::YUV16PLANAR:
+    case img::fourcc::BGGR16:
+    case img::fourcc::GBRG16:
+    case img::fourcc::RGGB16:
+    case img::fourcc::GRBG16:
+        return img::fourcc::MONO16;
+
+    default:
+        return img::fourcc::FCC_NULL;
+    }
+}
+
+template<img::fourcc Tfcc, class TPix>
+int     make_pixel_bytes( rgba clr, uint8_t* bytes, bool& writes ) noexcept
+{
+    const auto pix_clr = calc_color_for_type<Tfcc>( clr );
+    writes = !is_transparent( pix_clr );
+
+    TPix pix = {};
+    write_pix_to_iter( &pix, 0, pix_clr );
+    memcpy( bytes, &pix, sizeof( TPix ) );
+    return sizeof( TPix );
+}
+
+// Returns the size of a pixel of pixel_fcc, see get_row_pixel_fcc
+int     make_pixel_bytes( img::fourcc pixel_fcc, rgba clr, uint8_t* bytes, bool& writes ) noexcept
+{
+    switch( pixel_fcc )
+    {
+    case img::fourcc::BGRA32:   return make_pixel_bytes<img::fourcc::BGRA32, BGRA32>( clr, bytes, writes );
+    case img::fourcc::BGRA64:   return make_pixel_bytes<img::fourcc::BGRA64, BGRA64>( clr, bytes, writes );
+    case img::fourcc::BGR24:    return make_pixel_bytes<img::fourcc::BGR24, BGR24>( clr, bytes, writes );
+    case img::fourcc::MONO8:    return make_pixel_bytes<img::fourcc::MONO8, Y8>( clr, bytes, writes );
+    case img::fourcc::MONO16:   return make_pixel_bytes<img::fourcc::MONO16, Y16>( clr, bytes, writes );
+    default:
+        assert( false );
+        return 0;
+    }
+}
+
+// dst[i] = write_mask[i] ? values[i] : dst[i]
+void    blend_row( uint8_t* dst, const uint8_t* values, const uint8_t* write_mask, int bytes ) noexcept
+{
+    int i = 0;
+#if defined DUTILS_OVERLAY_SSE2
+    for( ; i + 16 <= bytes; i += 16 )
+    {
+        const __m128i m = _mm_loadu_si128( reinterpret_cast<const __m128i*>( write_mask + i ) );
+        const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( values + i ) );
+        const __m128i d = _mm_loadu_si128( reinterpret_cast<const __m128i*>( dst + i ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_or_si128( _mm_and_si128( m, v ), _mm_andnot_si128( m, d ) ) );
+    }
+#elif defined DUTILS_ARCH_ARM_A64
+    for( ; i + 16 <= bytes; i += 16 )
+    {
+        vst1q_u8( dst + i, vbslq_u8( vld1q_u8( write_mask + i ), vld1q_u8( values + i ), vld1q_u8( dst + i ) ) );
+    }
+#endif
+    for( ; i < bytes; ++i )
+    {
+        dst[i] = static_cast<uint8_t>( (values[i] & write_mask[i]) | (dst[i] & ~write_mask[i]) );
+    }
+}
+
+constexpr bool  is_same_color( rgba lhs, rgba rhs ) noexcept
+{
+    return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b && lhs.a == rhs.a;
+}
+
+}
+
+void	img_lib::overlay::render_text( const img::img_descriptor& data, img::point pos, int scaling, const char* pText, size_t text_len, rgba FgColor, rgba BgColor )
+{
+    if( text_len == 0 || pText == nullptr )     return; // text len == 0, skip fully
+    if( scaling <= 0 )                          return; // scaling invalid
+
+    if( get_row_pixel_fcc( data.fourcc_type() ) != img::fourcc::FCC_NULL )
+    {
+        text_overlay overlay;
+        overlay.set_text( std::string_view{ pText, text_len }, scaling );
+        overlay.render( data, pos, FgColor, BgColor );
+        return;
+    }
+
+
+    // The overlay is drawn in the form of 
+    //
+    // ---------
+    // |a|a|a|a|
+    // ---------
+    //
+    // - rows are 1 pixel high
+    // a rows are 8 (*s caling) pixel thick
+    // | columns are 1 pixel thick
+    // a columns are 8 (* scaling) pixel thick
+    //
+    // this calculates the exact dimensions needed
+    int text_width_in_pixel = calc_text_width( text_len, scaling );
+    const int text_height_in_pixel = calc_text_height( scaling );
+
+    if( !place_text( data.dim, pos, text_width_in_pixel, text_height_in_pixel ) ) {
+        return;
+    }
 
     if( text_width_in_pixel > (data.dim.cx - pos.x) ) // when the text is longer then the available space, we clip at dim_x
     {
@@ -660,22 +788,9 @@ void	img_lib::overlay::render_text( const img::img_descriptor& data, img::point
 
     img::img_descriptor cur_img = bFlip ? img::flip_image_in_img_desc( data ) : data;
 
+    // the formats of get_row_pixel_fcc are rendered by text_overlay
     switch( data.fourcc_type() )
     {
-    case img::fourcc::BGRA32:       render_worker<img::fourcc::BGRA32>( cur_img, pos, scaling, pText, text_len, BgColor, FgColor, text_width_in_pixel ); return;
-    case img::fourcc::BGRA64:       render_worker<img::fourcc::BGRA64>( cur_img, pos, scaling, pText, text_len, BgColor, FgColor, text_width_in_pixel ); return;
-    case img::fourcc::BGR24:        render_worker<img::fourcc::BGR24>( cur_img, pos, scaling, pText, text_len, BgColor, FgColor, text_width_in_pixel ); return;
-    case img::fourcc::MONO8:        render_worker<img::fourcc::MONO8>( cur_img, pos, scaling, pText, text_len, BgColor, FgColor, text_width_in_pixel ); return;
-    case img::fourcc::MONO16:       render_worker<img::fourcc::MONO16>( cur_img, pos, scaling, pText, text_len, BgColor, FgColor, text_width_in_pixel ); return;
-    case img::fourcc::YUV8PLANAR:   render_worker<img::fourcc::MONO8>( cur_img, pos, scaling, pText, text_len, BgColor, FgColor, text_width_in_pixel ); return;
-    case img::fourcc::YUV16PLANAR:  render_worker<img::fourcc::MONO16>( cur_img, pos, scaling, pText, text_len, BgColor, FgColor, text_width_in_pixel ); return;
-
-    case img::fourcc::YV12:
-    case img::fourcc::I420:
-    case img::fourcc::NV12:
-        render_worker<img::fourcc::MONO8>( cur_img, pos, scaling, pText, text_len, BgColor, FgColor, text_width_in_pixel );
-        return;
-
     case img::fourcc::MONO10:
     case img::fourcc::BGGR10:
     case img::fourcc::GRBG10:
@@ -744,21 +859,187 @@ void	img_lib::overlay::render_text( const img::img_descriptor& data, img::point
         render_worker<img::fourcc::YUY2>( cur_img, pos, scaling, pText, text_len, BgColor, FgColor, text_width_in_pixel );
         return;
 
-    case img::fourcc::BGGR8:
-    case img::fourcc::GBRG8:
-    case img::fourcc::RGGB8:
-    case img::fourcc::GRBG8:
-        render_worker<img::fourcc::MONO8>( cur_img, pos, scaling, pText, text_len, BgColor, FgColor, text_width_in_pixel );
+    default:
+        break;
+    }
+}
+
+img::dim    img_lib::overlay::text_overlay::dimensions() const noexcept
+{
+    if( width_ == 0 ) {
+        return img::dim{ 0, 0 };
+    }
+    return img::dim{ width_, calc_text_height( scaling_ ) };
+}
+
+void    img_lib::overlay::text_overlay::set_text( std::string_view text, int scaling )
+{
+    if( scaling <= 0 ) {
+        text = {};
+    }
+
+    if( text.size() != text_.size() || scaling != scaling_ )
+    {
+        text_.assign( text.data(), text.size() );
+        scaling_ = scaling;
+        width_ = text.empty() ? 0 : calc_text_width( text.size(), scaling );
+
+        masks_.assign( static_cast<size_t>( width_ ) * 8, 0 );
+        update_masks( 0, width_ );
+
+        pixel_fcc_ = img::fourcc::FCC_NULL; // the rows are rebuilt by the next render call
+        dirty_beg_ = 0;
+        dirty_end_ = width_;
         return;
+    }
 
-    case img::fourcc::BGGR16:
-    case img::fourcc::GBRG16:
-    case img::fourcc::RGGB16:
-    case img::fourcc::GRBG16:
-        render_worker<img::fourcc::MONO16>( cur_img, pos, scaling, pText, text_len, BgColor, FgColor, text_width_in_pixel );
+    // only the columns of the characters that changed
+    const int char_width = scaling_ * 8 + 1;
+    int x_beg = width_;
+    int x_end = 0;
+    for( size_t i = 0; i < text.size(); ++i )
+    {
+        if( text[i] == text_[i] ) {
+            continue;
+        }
+        text_[i] = text[i];
+        x_beg = std::min( x_beg, 1 + (int)i * char_width );
+        x_end = std::max( x_end, 1 + (int)i * char_width + scaling_ * 8 );
+    }
+    if( x_beg >= x_end ) {
         return;
+    }
 
-    default:
-        break;
+    update_masks( x_beg, x_end );
+    if( pixel_fcc_ != img::fourcc::FCC_NULL ) {
+        update_rows( x_beg, x_end );
+    }
+
+    if( dirty_beg_ < dirty_end_ ) {
+        dirty_beg_ = std::min( dirty_beg_, x_beg );
+        dirty_end_ = std::max( dirty_end_, x_end );
+    } else {
+        dirty_beg_ = x_beg;
+        dirty_end_ = x_end;
+    }
+}
+
+void    img_lib::overlay::text_overlay::update_masks( int x_beg, int x_end )
+{
+    // | glyph of 8 * scaling columns | 1 separator column | per character, after 1 leading column
+    const int char_width = scaling_ * 8 + 1;
+    for( int x = x_beg; x < x_end; ++x )
+    {
+        const int char_x = (x - 1) % char_width;
+        const bool is_glyph = x > 0 && char_x < scaling_ * 8;
+        const uint8_t letter = is_glyph ? (uint8_t)text_[(x - 1) / char_width] : 0;
+        const unsigned int bit = is_glyph ? 0x80u >> (char_x / scaling_) : 0;
+
+        for( int row = 0; row < 8; ++row ) {
+            masks_[row * width_ + x] = (g_font_data[letter][row] & bit) ? 1 : 0;
+        }
+    }
+}
+
+void    img_lib::overlay::text_overlay::update_rows( int x_beg, int x_end )
+{
+    // rows 0 - 7 are the font rows, row 8 the background row above and below the text
+    for( int row = 0; row < 9; ++row )
+    {
+        for( int x = x_beg; x < x_end; ++x )
+        {
+            const bool is_fg = row < 8 && masks_[row * width_ + x] != 0;
+            const size_t offset = (static_cast<size_t>( row ) * width_ + x) * pixel_size_;
+
+            memcpy( &row_values_[offset], is_fg ? fg_bytes_ : bg_bytes_, pixel_size_ );
+            memset( &row_write_masks_[offset], (is_fg ? fg_writes_ : bg_writes_) ? 0xFF : 0x00, pixel_size_ );
+        }
+    }
+}
+
+bool    img_lib::overlay::text_overlay::update_colors( img::fourcc pixel_fcc, rgba foreground_color, rgba background_color )
+{
+    if( pixel_fcc == pixel_fcc_ && is_same_color( foreground_color, fg_ ) && is_same_color( background_color, bg_ ) ) {
+        return false;
+    }
+
+    pixel_fcc_ = pixel_fcc;
+    fg_ = foreground_color;
+    bg_ = background_color;
+    pixel_size_ = make_pixel_bytes( pixel_fcc, foreground_color, fg_bytes_, fg_writes_ );
+    make_pixel_bytes( pixel_fcc, background_color, bg_bytes_, bg_writes_ );
+
+    const size_t row_bytes = static_cast<size_t>( width_ ) * pixel_size_;
+    row_values_.resize( row_bytes * 9 );
+    row_write_masks_.resize( row_bytes * 9 );
+    update_rows( 0, width_ );
+    return true;
+}
+
+void    img_lib::overlay::text_overlay::render( const img::img_descriptor& dst, img::point pos, rgba foreground_color, rgba background_color, render_region region )
+{
+    if( width_ == 0 ) {
+        return;
+    }
+
+    int x_beg = 0;
+    int x_end = width_;
+    if( region == render_region::dirty ) {
+        x_beg = dirty_beg_;
+        x_end = dirty_end_;
+    }
+    dirty_beg_ = 0;
+    dirty_end_ = 0;
+    if( x_beg >= x_end ) {
+        return;
+    }
+
+    const auto pixel_fcc = get_row_pixel_fcc( dst.fourcc_type() );
+    if( pixel_fcc == img::fourcc::FCC_NULL )
+    {
+        render_text( dst, pos, scaling_, text_.data(), text_.size(), foreground_color, background_color );
+        return;
+    }
+
+    const int text_height_in_pixel = calc_text_height( scaling_ );
+    if( !place_text( dst.dim, pos, width_, text_height_in_pixel ) ) {
+        return;
+    }
+
+    // a color change invalidates the dirty columns
+    if( update_colors( pixel_fcc, foreground_color, background_color ) ) {
+        x_beg = 0;
+        x_end = width_;
+    }
+    if( !fg_writes_ && !bg_writes_ ) {
+        return;
+    }
+
+    // when the text is longer then the available space, we clip at dim_x
+    x_end = std::min( x_end, dst.dim.cx - pos.x );
+    if( x_beg >= x_end ) {
+        return;
+    }
+
+    const auto cur_img = img::is_bottom_up_fcc( dst.fourcc_type() ) ? img::flip_image_in_img_desc( dst ) : dst;
+
+    const size_t row_bytes = static_cast<size_t>( width_ ) * pixel_size_;
+    const size_t offset = static_cast<size_t>( x_beg ) * pixel_size_;
+    const int bytes = (x_end - x_beg) * pixel_size_;
+    const bool writes_all = fg_writes_ && bg_writes_;
+
+    const int line_count = std::min( text_height_in_pixel, dst.dim.cy - pos.y );
+    for( int line = 0; line < line_count; ++line )
+    {
+        const bool is_border = line == 0 || line == text_height_in_pixel - 1;
+        const int row = is_border ? 8 : (line - 1) / scaling_;
+
+        uint8_t* dst_ptr = img::get_line_start( cur_img, pos.y + line ) + (static_cast<size_t>( pos.x ) + x_beg) * pixel_size_;
+        const uint8_t* values = row_values_.data() + row * row_bytes + offset;
+        if( writes_all ) {
+            memcpy( dst_ptr, values, bytes );
+        } else {
+            blend_row( dst_ptr, values, row_write_masks_.data() + row * row_bytes + offset, bytes );
+        }
     }
 }
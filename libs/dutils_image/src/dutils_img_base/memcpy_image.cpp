@@ -8,15 +8,184 @@
 #include "interop_private.h"
 
 #include <algorithm>
+#include <thread>
+#include <vector>
 
 #include <cstring>
 
+#if !defined DUTILS_ARCH_ARM && (defined __SSE2__ || defined _M_X64)
+#include <emmintrin.h>
+#define DUTILS_MEMCPY_STREAMING_SSE2 1
+#endif
+
+#if defined __linux__
+#include <unistd.h>
+#endif
+
 namespace
 {
 
-static FORCEINLINE void     internal_memcpy( void* dst, void* src, int bytes ) noexcept
+// below this, streaming stores do not pay off even if dst is not read again
+constexpr size_t streaming_min_bytes = 256 * 1024;
+
+// every thread of a parallel copy gets at least this much
+constexpr size_t parallel_min_bytes_per_thread = 4 * 1024 * 1024;
+
+struct copy_strategy
+{
+    bool streaming = false;
+    int threads = 1;
+};
+
+copy_strategy   select_strategy( size_t bytes, const img::memcpy_options& opt ) noexcept
+{
+    copy_strategy rval;
+
+    switch( opt.method )
+    {
+    case img::memcpy_method::regular:
+        rval.streaming = false;
+        break;
+    case img::memcpy_method::streaming:
+        rval.streaming = true;
+        break;
+    case img::memcpy_method::automatic:
+        // a copy larger than the cache evicts its own beginning, keeping dst cached is not possible
+        rval.streaming = bytes >= streaming_min_bytes && (!opt.dst_consumed_soon || bytes > img::get_last_level_cache_size());
+        break;
+    }
+
+    const auto max_threads_for_size = static_cast<int>( std::max<size_t>( bytes / parallel_min_bytes_per_thread, 1 ) );
+    rval.threads = std::clamp( opt.max_threads, 1, max_threads_for_size );
+    return rval;
+}
+
+#if defined DUTILS_ARCH_ARM_A64 || defined DUTILS_MEMCPY_STREAMING_SSE2
+
+// copies with non-temporal stores, callers have to call stream_fence before dst is handed to another thread
+void    stream_copy( uint8_t* dst, const uint8_t* src, size_t bytes ) noexcept
+{
+    constexpr size_t block_size = 64;
+
+    // the stores need an aligned dst, src may be unaligned
+    const size_t head = std::min( bytes, static_cast<size_t>( (block_size - reinterpret_cast<uintptr_t>(dst) % block_size) % block_size ) );
+    memcpy( dst, src, head );
+    dst += head;
+    src += head;
+    bytes -= head;
+
+    const size_t blocks = bytes / block_size;
+    for( size_t i = 0; i < blocks; ++i )
+    {
+#if defined DUTILS_ARCH_ARM_A64
+        asm volatile(
+            "ldp q0, q1, [%1]\n"
+            "ldp q2, q3, [%1, #32]\n"
+            "stnp q0, q1, [%0]\n"
+            "stnp q2, q3, [%0, #32]\n"
+            :
+            : "r"(dst), "r"(src)
+            : "v0", "v1", "v2", "v3", "memory" );
+#else
+        const __m128i v0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(src) + 0 );
+        const __m128i v1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(src) + 1 );
+        const __m128i v2 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(src) + 2 );
+        const __m128i v3 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(src) + 3 );
+        _mm_stream_si128( reinterpret_cast<__m128i*>(dst) + 0, v0 );
+        _mm_stream_si128( reinterpret_cast<__m128i*>(dst) + 1, v1 );
+        _mm_stream_si128( reinterpret_cast<__m128i*>(dst) + 2, v2 );
+        _mm_stream_si128( reinterpret_cast<__m128i*>(dst) + 3, v3 );
+#endif
+        dst += block_size;
+        src += block_size;
+    }
+
+    memcpy( dst, src, bytes % block_size );
+}
+
+void    stream_fence() noexcept
+{
+#if defined DUTILS_ARCH_ARM_A64
+    asm volatile( "dmb ishst" ::: "memory" );
+#else
+    _mm_sfence();
+#endif
+}
+
+#else
+
+// no non-temporal stores on this architecture
+void    stream_copy( uint8_t* dst, const uint8_t* src, size_t bytes ) noexcept
+{
+    memcpy( dst, src, bytes );
+}
+
+void    stream_fence() noexcept
+{
+}
+
+#endif
+
+static FORCEINLINE void     internal_memcpy( void* dst, const void* src, size_t bytes, bool streaming ) noexcept
+{
+    if( streaming ) {
+        stream_copy( static_cast<uint8_t*>(dst), static_cast<const uint8_t*>(src), bytes );
+    } else {
+        memcpy( dst, src, bytes );
+    }
+}
+
+// calls func( idx ) for idx in [0;threads), idx 0 on the calling thread
+// falls back to the calling thread for threads that cannot be started
+template<class TFunc>
+void    run_parallel( int threads, TFunc func ) noexcept
+{
+    std::vector<std::thread> workers;
+    try
+    {
+        workers.reserve( threads - 1 );
+        for( int i = 1; i < threads; ++i ) {
+            workers.emplace_back( func, i );
+        }
+    }
+    catch( ... )
+    {
+    }
+
+    func( 0 );
+
+    for( auto& w : workers ) {
+        w.join();
+    }
+    for( int i = 1 + static_cast<int>(workers.size()); i < threads; ++i ) {
+        func( i );
+    }
+}
+
+void    copy_linear( void* dst, const void* src, size_t bytes, copy_strategy strategy ) noexcept
 {
-    memcpy( dst, src, (size_t) bytes );
+    if( strategy.threads <= 1 )
+    {
+        internal_memcpy( dst, src, bytes, strategy.streaming );
+        if( strategy.streaming ) {
+            stream_fence();
+        }
+        return;
+    }
+
+    // page aligned chunks, so that no two threads write to the same cache line
+    constexpr size_t chunk_alignment = 4096;
+    const size_t chunk = (bytes / strategy.threads + chunk_alignment - 1) / chunk_alignment * chunk_alignment;
+
+    run_parallel( strategy.threads, [=]( int idx ) noexcept
+    {
+        const size_t begin = std::min( bytes, chunk * idx );
+        const size_t end = std::min( bytes, begin + chunk );
+        internal_memcpy( static_cast<uint8_t*>(dst) + begin, static_cast<const uint8_t*>(src) + begin, end - begin, strategy.streaming );
+        if( strategy.streaming ) {
+            stream_fence();
+        }
+    } );
 }
 
 inline void	flip_image_params( uint8_t*& ptr, int& pitch, int dim_y ) noexcept
@@ -44,16 +213,50 @@ static bool     is_linear_memcpy_able( const img::img_descriptor& dst, const img
     return bytes_per_line == src.pitch();
 }
 
-static void copy_image_lines( uint8_t* dst_ptr, int dst_pitch, uint8_t* src_ptr, int src_pitch, int bytes_per_line, int dim_y ) noexcept
+static void copy_image_lines( uint8_t* dst_ptr, int dst_pitch, const uint8_t* src_ptr, int src_pitch, int bytes_per_line, int dim_y, copy_strategy strategy ) noexcept
+{
+    const int threads = std::min( strategy.threads, std::max( dim_y, 1 ) );
+    const int lines_per_thread = (dim_y + threads - 1) / threads;
+
+    run_parallel( threads, [=]( int idx ) noexcept
+    {
+        const int begin = std::min( dim_y, lines_per_thread * idx );
+        const int end = std::min( dim_y, begin + lines_per_thread );
+        for( int y = begin; y < end; ++y )
+        {
+            internal_memcpy( dst_ptr + dst_pitch * y, src_ptr + src_pitch * y, bytes_per_line, strategy.streaming );
+        }
+        if( strategy.streaming ) {
+            stream_fence();
+        }
+    } );
+}
+
+static void copy_plane( img::img_plane dst, img::img_plane src, int dim_y, int bytes_per_line, const img::memcpy_options& opt ) noexcept
 {
-    for( int y = 0; y < dim_y; ++y )
+    assert( bytes_per_line >= 0 );
+    if( dim_y < 0 ) {
+        dim_y = -dim_y;
+        dst = flip_image_params( dst, dim_y );
+    }
+
+    const auto strategy = select_strategy( static_cast<size_t>(dim_y) * bytes_per_line, opt );
+    if( dst.pitch == src.pitch && dst.pitch == bytes_per_line ) {
+        copy_linear( dst.plane_ptr, src.plane_ptr, static_cast<size_t>(dim_y) * bytes_per_line, strategy );
+    }
+    else
     {
-        internal_memcpy( dst_ptr + dst_pitch * y, src_ptr + src_pitch * y, bytes_per_line );
+        copy_image_lines( static_cast<uint8_t*>( dst.plane_ptr ), dst.pitch, static_cast<const uint8_t*>( src.plane_ptr ), src.pitch, bytes_per_line, dim_y, strategy );
     }
 }
 }
 
 void img::memcpy_image( const img::img_descriptor& dst, const img::img_descriptor& src ) noexcept
+{
+    memcpy_image( dst, src, memcpy_options {} );
+}
+
+void img::memcpy_image( const img::img_descriptor& dst, const img::img_descriptor& src, const memcpy_options& opt ) noexcept
 {
     if( src.type != dst.type || src.dimensions() != dst.dimensions() ) {
         return;
@@ -61,7 +264,7 @@ void img::memcpy_image( const img::img_descriptor& dst, const img::img_descripto
 
     if( src.pitch() == 0 && dst.pitch() == 0 ) {
         auto min_len = std::min( src.data_length, dst.data_length );
-        internal_memcpy( dst.data(), src.data(), min_len );
+        copy_linear( dst.data(), src.data(), min_len, select_strategy( min_len, opt ) );
         return;
     }
 
@@ -71,7 +274,7 @@ void img::memcpy_image( const img::img_descriptor& dst, const img::img_descripto
         for( int plane_idx = 0; plane_idx < plane_info.plane_count; ++plane_idx )
         {
             int bytes_per_line = img::planar::get_plane_pitch_minimum( src.fourcc_type(), src.dim.cx, plane_idx );
-            memcpy_image( dst.plane( plane_idx ), src.plane( plane_idx ), src.dim.cy, bytes_per_line );
+            copy_plane( dst.plane( plane_idx ), src.plane( plane_idx ), src.dim.cy, bytes_per_line, opt );
         }
     }
     else
@@ -80,32 +283,18 @@ void img::memcpy_image( const img::img_descriptor& dst, const img::img_descripto
         if( is_linear_memcpy_able( dst, src, bytes_per_line ) )
         {
             auto len_to_copy = std::min( src.data_length, dst.data_length );
-            internal_memcpy( dst.data(), src.data(), len_to_copy );
+            copy_linear( dst.data(), src.data(), len_to_copy, select_strategy( len_to_copy, opt ) );
             return;
         }
 
-        copy_image_lines( dst.data(), dst.pitch(), src.data(), src.pitch(), bytes_per_line, dst.dim.cy );
+        const auto strategy = select_strategy( static_cast<size_t>(bytes_per_line) * dst.dim.cy, opt );
+        copy_image_lines( dst.data(), dst.pitch(), src.data(), src.pitch(), bytes_per_line, dst.dim.cy, strategy );
     }
 }
 
 void    img::memcpy_image( img_plane dst, img_plane src, int dim_y, int bytes_per_line ) noexcept
 {
-    assert( bytes_per_line >= 0 );
-    if( dim_y < 0 ) {
-        dim_y = -dim_y;
-        dst = flip_image_params( dst, dim_y );
-    }
-
-    if( dst.pitch == src.pitch && dst.pitch == bytes_per_line ) {
-        internal_memcpy( dst.plane_ptr, src.plane_ptr, dim_y * bytes_per_line );
-    }
-    else
-    {
-        for( int y = 0; y < dim_y; ++y )
-        {
-            internal_memcpy( static_cast<uint8_t*>( dst.plane_ptr ) + dst.pitch * y, static_cast<uint8_t*>( src.plane_ptr ) + src.pitch * y, bytes_per_line );
-        }
-    }
+    copy_plane( dst, src, dim_y, bytes_per_line, memcpy_options {} );
 }
 
 void img::memcpy_image( void* dst_ptr, int dst_pitch, void* src_ptr, int src_pitch, int bytes_per_line, int dim_y, bool bFlip ) noexcept
@@ -116,13 +305,14 @@ void img::memcpy_image( void* dst_ptr, int dst_pitch, void* src_ptr, int src_pit
         flip_image_params( actual_src_parameter, src_pitch, dim_y );
     }
 
+    const auto strategy = select_strategy( static_cast<size_t>(dim_y) * bytes_per_line, memcpy_options {} );
     if( src_pitch != dst_pitch || src_pitch < 0 || src_pitch != bytes_per_line )
     {
-        copy_image_lines( (uint8_t*)dst_ptr, dst_pitch, actual_src_parameter, src_pitch, bytes_per_line, dim_y );
+        copy_image_lines( (uint8_t*)dst_ptr, dst_pitch, actual_src_parameter, src_pitch, bytes_per_line, dim_y, strategy );
     }
     else // src_pitch == dst_pitch && pitch > 0 && pitch == bytes_per_line
     {
-        internal_memcpy( dst_ptr, actual_src_parameter, dim_y * bytes_per_line );
+        copy_linear( dst_ptr, actual_src_parameter, static_cast<size_t>(dim_y) * bytes_per_line, strategy );
     }
 }
 
@@ -136,6 +326,25 @@ void img::fill_image( const img_descriptor& data, uint8_t byte_value ) noexcept
     }
 }
 
+size_t img::get_last_level_cache_size() noexcept
+{
+    static const size_t cache_size = []() noexcept -> size_t
+    {
+#if defined __linux__ && defined _SC_LEVEL3_CACHE_SIZE
+        for( int name : { _SC_LEVEL3_CACHE_SIZE, _SC_LEVEL2_CACHE_SIZE } )
+        {
+            const long size = sysconf( name );
+            if( size > 0 ) {
+                return static_cast<size_t>(size);
+            }
+        }
+#endif
+        // typical for the arm boards, which often do not report their cache
+        return 2 * 1024 * 1024;
+    }();
+    return cache_size;
+}
+
 void img_lib::helper::memcpy_image( const img::img_descriptor& dst, const img::img_descriptor& src ) noexcept
 {
     img::memcpy_image( dst, src );
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <dutils_img/image_transform_base.h>
 
@@ -11,11 +12,32 @@ namespace img
 {
     struct img_descriptor;
 
+    enum class memcpy_method
+    {
+        automatic,  // streaming for copies that do not fit into, or should not stay in, the last level cache
+        regular,    // memcpy
+        streaming,  // non-temporal stores that bypass the cache, MOVNTDQ on x86, STNP on arm64
+    };
+
+    struct memcpy_options
+    {
+        memcpy_method method = memcpy_method::automatic;
+        // dst is read shortly after the copy, e.g. by the next conversion step.
+        // With automatic, copies that fit into the last level cache then use memcpy.
+        bool dst_consumed_soon = true;
+        // > 1 splits large copies into chunks that are copied in parallel
+        int max_threads = 1;
+    };
+
     void	memcpy_image( const img::img_descriptor& dst, const img::img_descriptor& src ) noexcept;
+    void	memcpy_image( const img::img_descriptor& dst, const img::img_descriptor& src, const memcpy_options& opt ) noexcept;
     void	memcpy_image( img::img_plane dst, img::img_plane src, int dim_y, int byter_per_line ) noexcept;
     void	memcpy_image( void* dst_ptr, int dst_pitch, void* src_ptr, int src_pitch, int bytes_per_line, int dim_y, bool bFlip ) noexcept;
 
     void    fill_image( const img::img_descriptor& data, uint8_t byte_value ) noexcept;
+
+    // size in bytes, from the OS or an estimate when that is unknown
+    size_t  get_last_level_cache_size() noexcept;
 }
 
 #endif // MEMCPY_IMAGE_H_INC_
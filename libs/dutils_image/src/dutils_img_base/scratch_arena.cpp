@@ -0,0 +1,306 @@
+
+#include <dutils_img_lib/dutils_scratch_arena.h>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace
+{
+
+// class 0 is 4 KiB, then 4 classes per power of two: 5, 6, 7, 8 KiB, 10, 12, 14, 16 KiB, ...
+constexpr int       min_class_shift = 12;
+constexpr int       max_class_shift = 31;   // the largest class is 2 GiB
+constexpr int       class_count = (max_class_shift - min_class_shift) * 4 + 1;
+
+// blocks up to this size are kept in the cache of the releasing thread
+constexpr size_t    thread_cache_max_block_size = 4 * 1024 * 1024;
+constexpr int       thread_cache_entries = 8;
+
+// the shared pool frees released blocks beyond this
+constexpr size_t    shared_pool_max_bytes = 256 * 1024 * 1024;
+
+constexpr int       log2_floor( size_t v ) noexcept
+{
+    int rval = 0;
+    while( v > 1 ) {
+        v >>= 1;
+        ++rval;
+    }
+    return rval;
+}
+
+constexpr size_t    class_size( int size_class ) noexcept
+{
+    if( size_class == 0 ) {
+        return size_t( 1 ) << min_class_shift;
+    }
+    const int e = min_class_shift + (size_class - 1) / 4;
+    const size_t m = (size_class - 1) % 4 + 1;
+    return (size_t( 1 ) << e) + m * (size_t( 1 ) << (e - 2));
+}
+
+// returns -1 for sizes larger than the largest class
+constexpr int       size_class_of( size_t size ) noexcept
+{
+    if( size <= class_size( 0 ) ) {
+        return 0;
+    }
+    if( size > class_size( class_count - 1 ) ) {
+        return -1;
+    }
+    const int e = log2_floor( size - 1 );   // 2^e < size <= 2^(e+1)
+    const size_t step = size_t( 1 ) << (e - 2);
+    const size_t m = (size - (size_t( 1 ) << e) + step - 1) / step;
+    return (e - min_class_shift) * 4 + static_cast<int>( m );
+}
+
+static_assert( class_size( size_class_of( 4096 ) ) == 4096 );
+static_assert( class_size( size_class_of( 4097 ) ) == 5120 );
+static_assert( class_size( size_class_of( 8192 ) ) == 8192 );
+static_assert( class_size( size_class_of( 1920 * 1080 * 4 ) ) >= 1920 * 1080 * 4 );
+static_assert( class_size( class_count - 1 ) == (size_t( 1 ) << max_class_shift) );
+
+std::atomic<size_t>     g_bytes_allocated { 0 };
+
+size_t  block_size( size_t size, int size_class ) noexcept
+{
+    return size_class < 0 ? size : class_size( size_class );
+}
+
+void*   allocate_block( size_t bytes )
+{
+    void* p = ::operator new( bytes, std::align_val_t{ img_lib::scratch::block_alignment } );
+    g_bytes_allocated += bytes;
+    return p;
+}
+
+void    free_block( void* p, size_t bytes ) noexcept
+{
+    ::operator delete( p, std::align_val_t{ img_lib::scratch::block_alignment } );
+    g_bytes_allocated -= bytes;
+}
+
+class shared_pool
+{
+public:
+    void*   pop( int size_class ) noexcept
+    {
+        std::lock_guard lck{ mtx_ };
+
+        auto& list = free_blocks_[size_class];
+        if( list.empty() ) {
+            return nullptr;
+        }
+        void* p = list.back();
+        list.pop_back();
+        bytes_cached_ -= class_size( size_class );
+        return p;
+    }
+
+    void    push( void* p, int size_class ) noexcept
+    {
+        const size_t bytes = class_size( size_class );
+        {
+            std::lock_guard lck{ mtx_ };
+            if( bytes_cached_ + bytes <= shared_pool_max_bytes )
+            {
+                try
+                {
+                    free_blocks_[size_class].push_back( p );
+                    bytes_cached_ += bytes;
+                    return;
+                }
+                catch( const std::bad_alloc& ) {}
+            }
+        }
+        free_block( p, bytes );
+    }
+
+    size_t  bytes_cached() noexcept
+    {
+        std::lock_guard lck{ mtx_ };
+        return bytes_cached_;
+    }
+
+    void    trim() noexcept
+    {
+        std::array<std::vector<void*>, class_count> blocks;
+        {
+            std::lock_guard lck{ mtx_ };
+            blocks.swap( free_blocks_ );
+            bytes_cached_ = 0;
+        }
+        for( int size_class = 0; size_class < class_count; ++size_class )
+        {
+            for( void* p : blocks[size_class] ) {
+                free_block( p, class_size( size_class ) );
+            }
+        }
+    }
+private:
+    std::mutex  mtx_;
+    std::array<std::vector<void*>, class_count> free_blocks_;
+    size_t      bytes_cached_ = 0;
+};
+
+// Never destroyed, the thread caches return their blocks at thread exit, which may be after static destruction
+shared_pool&    get_shared_pool() noexcept
+{
+    static auto* pool = new shared_pool;
+    return *pool;
+}
+
+class thread_cache
+{
+public:
+    ~thread_cache() { flush(); }
+
+    void*   pop( int size_class ) noexcept
+    {
+        for( int i = count_ - 1; i >= 0; --i )
+        {
+            if( entries_[i].size_class == size_class )
+            {
+                void* p = entries_[i].ptr;
+                entries_[i] = entries_[--count_];
+                return p;
+            }
+        }
+        return nullptr;
+    }
+
+    void    push( void* p, int size_class ) noexcept
+    {
+        if( count_ == thread_cache_entries )
+        {
+            // the oldest entry moves to the shared pool
+            get_shared_pool().push( entries_[0].ptr, entries_[0].size_class );
+            for( int i = 1; i < count_; ++i ) {
+                entries_[i - 1] = entries_[i];
+            }
+            --count_;
+        }
+        entries_[count_++] = entry{ p, size_class };
+    }
+
+    void    flush() noexcept
+    {
+        for( int i = 0; i < count_; ++i ) {
+            get_shared_pool().push( entries_[i].ptr, entries_[i].size_class );
+        }
+        count_ = 0;
+    }
+
+    void    trim() noexcept
+    {
+        for( int i = 0; i < count_; ++i ) {
+            free_block( entries_[i].ptr, class_size( entries_[i].size_class ) );
+        }
+        count_ = 0;
+    }
+private:
+    struct entry
+    {
+        void*   ptr;
+        int     size_class;
+    };
+
+    std::array<entry, thread_cache_entries> entries_ = {};
+    int     count_ = 0;
+};
+
+thread_cache&   get_thread_cache() noexcept
+{
+    thread_local thread_cache cache;
+    return cache;
+}
+
+bool    uses_thread_cache( int size_class ) noexcept
+{
+    return size_class >= 0 && class_size( size_class ) <= thread_cache_max_block_size;
+}
+
+}
+
+img_lib::scratch::buffer::~buffer()
+{
+    reset();
+}
+
+img_lib::scratch::buffer::buffer( buffer&& other ) noexcept
+    : ptr_( other.ptr_ ), size_( other.size_ ), size_class_( other.size_class_ )
+{
+    other.ptr_ = nullptr;
+    other.size_ = 0;
+}
+
+img_lib::scratch::buffer&   img_lib::scratch::buffer::operator=( buffer&& other ) noexcept
+{
+    if( this != &other )
+    {
+        reset();
+        ptr_ = other.ptr_;
+        size_ = other.size_;
+        size_class_ = other.size_class_;
+        other.ptr_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void    img_lib::scratch::buffer::reset() noexcept
+{
+    if( ptr_ == nullptr ) {
+        return;
+    }
+
+    if( size_class_ < 0 ) {
+        free_block( ptr_, size_ );
+    } else if( uses_thread_cache( size_class_ ) ) {
+        get_thread_cache().push( ptr_, size_class_ );
+    } else {
+        get_shared_pool().push( ptr_, size_class_ );
+    }
+    ptr_ = nullptr;
+    size_ = 0;
+}
+
+img_lib::scratch::buffer    img_lib::scratch::acquire( size_t size )
+{
+    buffer rval;
+    if( size == 0 ) {
+        return rval;
+    }
+
+    const int size_class = size_class_of( size );
+
+    void* p = nullptr;
+    if( uses_thread_cache( size_class ) ) {
+        p = get_thread_cache().pop( size_class );
+    }
+    if( p == nullptr && size_class >= 0 ) {
+        p = get_shared_pool().pop( size_class );
+    }
+    if( p == nullptr ) {
+        p = allocate_block( block_size( size, size_class ) );
+    }
+
+    rval.ptr_ = p;
+    rval.size_ = size;
+    rval.size_class_ = size_class;
+    return rval;
+}
+
+img_lib::scratch::arena_stats   img_lib::scratch::get_stats() noexcept
+{
+    return arena_stats{ g_bytes_allocated.load(), get_shared_pool().bytes_cached() };
+}
+
+void    img_lib::scratch::trim() noexcept
+{
+    get_thread_cache().trim();
+    get_shared_pool().trim();
+}
@@ -0,0 +1,37 @@
+
+#pragma once
+
+#include "../by_edge/by_edge.h"
+
+namespace img_filter {
+namespace transform {
+namespace by_binned
+{
+    /* Debayers while downscaling by 2 or 4, every 2x2 or 4x4 block of src becomes one dst pixel.
+     * Red and blue are the average of the red and blue pixels in the block, green the average of its green pixels.
+     *
+     * dst.dim has to be src.dim / 2 or src.dim / 4, a remainder of src is ignored.
+     * BY8 to BGRA32, BY16 to BGRA64 and BGRFloat.
+     * options::use_avg_green is ignored.
+     */
+    using function_type = img_filter::transform::by_edge::function_type;
+
+    function_type	get_transform_by_to_dst_binned_c( img::img_type dst, img::img_type src );
+
+    // Returns 2 or 4 when dst is a binned variant of src, otherwise 0
+    constexpr   int     calc_binning_factor( img::dim dst, img::dim src ) noexcept
+    {
+        if( dst.cx <= 0 || dst.cy <= 0 ) {
+            return 0;
+        }
+        for( int factor : { 2, 4 } )
+        {
+            if( src.cx / factor == dst.cx && src.cy / factor == dst.cy ) {
+                return factor;
+            }
+        }
+        return 0;
+    }
+}
+}
+}
@@ -0,0 +1,187 @@
+#include "by_binned.h"
+
+#include <dutils_img/pixel_structs.h>
+#include <dutils_img/image_bayer_pattern.h>
+
+/*
+ * Every block starts on an even line and column, so all blocks have the bayer pattern of the image.
+ * The sums of the 4 positions of the 2x2 pattern are calculated per block and the channels are taken from them.
+ */
+
+namespace
+{
+    using img::pixel_type::BGRA32;
+    using img::pixel_type::BGRA64;
+    using img::pixel_type::BGRf;
+
+    using namespace img::by_transform;
+
+    using options = img_filter::transform::by_edge::options;
+
+    struct pixel
+    {
+        int r, g, b;
+    };
+
+    // Index of the red pixel in the 2x2 pattern, { x0y0, x1y0, x0y1, x1y1 }, blue is the opposite one
+    constexpr int   red_index( by_pattern pattern ) noexcept
+    {
+        switch( pattern )
+        {
+        case by_pattern::BG:    return 3;
+        case by_pattern::GB:    return 2;
+        case by_pattern::GR:    return 1;
+        case by_pattern::RG:    return 0;
+        };
+        return 0;
+    }
+
+    template<class TIn> constexpr int max_value = 0xFF;
+    template<>          constexpr int max_value<uint16_t> = 0xFFFF;
+
+    template<class TIn>
+    FORCEINLINE pixel   apply_color_matrix( const img::color_matrix_int& clr, pixel val ) noexcept
+    {
+        const int r = (val.r * clr.r_rfac + val.g * clr.r_gfac + val.b * clr.r_bfac) >> 6;
+        const int g = (val.r * clr.g_rfac + val.g * clr.g_gfac + val.b * clr.g_bfac) >> 6;
+        const int b = (val.r * clr.b_rfac + val.g * clr.b_gfac + val.b * clr.b_bfac) >> 6;
+
+        return pixel{ CLIP( r, 0, max_value<TIn> ), CLIP( g, 0, max_value<TIn> ), CLIP( b, 0, max_value<TIn> ) };
+    }
+
+    template<class TOut>
+    void    store( void* out_line, int x, pixel val ) noexcept = delete;
+
+    template<>
+    FORCEINLINE void    store<BGRA32>( void* out_line, int x, pixel val ) noexcept
+    {
+        static_cast<BGRA32*>(out_line)[x] = BGRA32{ static_cast<uint8_t>(val.b), static_cast<uint8_t>(val.g), static_cast<uint8_t>(val.r), 0xFF };
+    }
+
+    template<>
+    FORCEINLINE void    store<BGRA64>( void* out_line, int x, pixel val ) noexcept
+    {
+        static_cast<BGRA64*>(out_line)[x] = BGRA64{ static_cast<uint16_t>(val.b), static_cast<uint16_t>(val.g), static_cast<uint16_t>(val.r), 0xFFFF };
+    }
+
+    template<>
+    FORCEINLINE void    store<BGRf>( void* out_line, int x, pixel val ) noexcept
+    {
+        constexpr float float_scale = 1.f / 0xFFFF;
+        static_cast<BGRf*>(out_line)[x] = BGRf{ val.b * float_scale, val.g * float_scale, val.r * float_scale };
+    }
+
+    template<class TIn, class TOut, by_pattern pattern, int factor, bool use_mtx>
+    void    conv_line( const options& opt, const TIn* const (&lines)[factor], void* out_line, int dim_x ) noexcept
+    {
+        // count of pixels per channel position in a block
+        constexpr int count = (factor / 2) * (factor / 2);
+        constexpr int r_index = red_index( pattern );
+        constexpr int b_index = 3 - r_index;
+
+        for( int x = 0; x < dim_x; ++x )
+        {
+            int sums[4] = {};
+            for( int y = 0; y < factor; y += 2 )
+            {
+                const TIn* line0 = lines[y + 0] + x * factor;
+                const TIn* line1 = lines[y + 1] + x * factor;
+                for( int i = 0; i < factor; i += 2 )
+                {
+                    sums[0] += line0[i + 0];
+                    sums[1] += line0[i + 1];
+                    sums[2] += line1[i + 0];
+                    sums[3] += line1[i + 1];
+                }
+            }
+
+            const int g_sum = sums[0] + sums[1] + sums[2] + sums[3] - sums[r_index] - sums[b_index];
+
+            // rounded averages
+            pixel val = {
+                (sums[r_index] + count / 2) / count,
+                (g_sum + count) / (2 * count),
+                (sums[b_index] + count / 2) / count,
+            };
+            if constexpr( use_mtx ) {
+                val = apply_color_matrix<TIn>( opt.color_mtx, val );
+            }
+            store<TOut>( out_line, x, val );
+        }
+    }
+
+    template<class TIn, class TOut, by_pattern pattern, int factor, bool use_mtx>
+    void    transform_binned_image( img::img_descriptor dst, img::img_descriptor src, const options& opt )
+    {
+        dst = img::flip_image_in_img_desc_if_allowed( dst );
+
+        for( int y = 0; y < dst.dim.cy; ++y )
+        {
+            const TIn* lines[factor] = {};
+            for( int i = 0; i < factor; ++i ) {
+                lines[i] = img::get_line_start<const TIn>( src, y * factor + i );
+            }
+            conv_line<TIn, TOut, pattern, factor, use_mtx>( opt, lines, img::get_line_start( dst, y ), dst.dim.cx );
+        }
+    }
+
+    template<class TIn, class TOut, by_pattern pattern, int factor>
+    void    transform_binned_image( img::img_descriptor dst, img::img_descriptor src, const options& opt )
+    {
+        if( opt.use_color_matrix ) {
+            transform_binned_image<TIn, TOut, pattern, factor, true>( dst, src, opt );
+        } else {
+            transform_binned_image<TIn, TOut, pattern, factor, false>( dst, src, opt );
+        }
+    }
+
+    template<class TIn, class TOut, int factor>
+    auto    select_pattern_func( by_pattern pattern ) noexcept -> img_filter::transform::by_binned::function_type
+    {
+        switch( pattern )
+        {
+        case by_pattern::BG:    return &transform_binned_image<TIn, TOut, by_pattern::BG, factor>;
+        case by_pattern::GB:    return &transform_binned_image<TIn, TOut, by_pattern::GB, factor>;
+        case by_pattern::GR:    return &transform_binned_image<TIn, TOut, by_pattern::GR, factor>;
+        case by_pattern::RG:    return &transform_binned_image<TIn, TOut, by_pattern::RG, factor>;
+        };
+        return nullptr;
+    }
+
+    template<class TIn, class TOut>
+    auto    select_func( by_pattern pattern, int factor ) noexcept -> img_filter::transform::by_binned::function_type
+    {
+        if( factor == 2 ) {
+            return select_pattern_func<TIn, TOut, 2>( pattern );
+        }
+        return select_pattern_func<TIn, TOut, 4>( pattern );
+    }
+}
+
+img_filter::transform::by_binned::function_type     img_filter::transform::by_binned::get_transform_by_to_dst_binned_c( img::img_type dst, img::img_type src )
+{
+    const int factor = calc_binning_factor( dst.dim, src.dim );
+    if( factor == 0 ) {
+        return nullptr;
+    }
+
+    const auto pattern = convert_bayer_fcc_to_pattern( src.fourcc_type() );
+    if( img::is_by8_fcc( src.fourcc_type() ) )
+    {
+        if( dst.fourcc_type() == img::fourcc::BGRA32 ) {
+            return select_func<uint8_t, BGRA32>( pattern, factor );
+        }
+        return nullptr;
+    }
+    if( img::is_by16_fcc( src.fourcc_type() ) )
+    {
+        switch( dst.fourcc_type() )
+        {
+        case img::fourcc::BGRA64:   return select_func<uint16_t, BGRA64>( pattern, factor );
+        case img::fourcc::BGRFloat: return select_func<uint16_t, BGRf>( pattern, factor );
+        default:
+            return nullptr;
+        };
+    }
+    return nullptr;
+}
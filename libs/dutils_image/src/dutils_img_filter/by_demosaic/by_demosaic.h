@@ -0,0 +1,47 @@
+
+#pragma once
+
+#include "../dutils_img_base.h"
+#include "../transform/transform_base.h"
+#include "../by_edge/by_edge.h"
+
+namespace img_filter {
+namespace transform {
+namespace by_demosaic
+{
+    /* Debayer algorithms besides the edge sensing one of by_edge, for BY8 to BGRA32/BGR24.
+     *
+     * nearest:     Every pixel of a 2x2 bayer cell gets the red, green and blue value of the cell, only the green value of its line differs.
+     *              The fastest variant, for previews and as input of ML preprocessing that scales the image down anyway.
+     * bilinear:    Missing colors are the average of the 2 or 4 nearest neighbours of that color.
+     * hq:          Gradient corrected bilinear interpolation (Malvar, He, Cutler) with a 5x5 kernel. Slower than by_edge, but fewer color
+     *              fringes on edges, for offline processing.
+     *
+     * Lines and columns outside of the image are mirrored at the border. With flags_no_wrap_beg/flags_no_wrap_end, the 2 lines in front
+     * of/after src are read instead, so converting an image in several parts gives the same result as converting it at once.
+     *
+     * The C and the SIMD variants return the same values.
+     */
+    enum class method
+    {
+        nearest,
+        bilinear,
+        hq,
+    };
+
+    // use_avg_green is not used
+    using options = by_edge::options;
+    using function_type = by_edge::function_type;
+
+    function_type	get_transform_by8_to_dst_c( img::img_type dst, img::img_type src, method m );
+
+    /* Variants without color matrix, where the bayer pattern of src, the dst format and the method are compile time parameters.
+     * The returned function only converts images of the fourcc of src. The SIMD variants only convert to BGRA32.
+     */
+    transform_function_type	get_transform_by8_to_dst_specialized_c( img::img_type dst, img::img_type src, method m );
+    transform_function_type	get_transform_by8_to_dst_specialized_sse41( img::img_type dst, img::img_type src, method m );
+    transform_function_type	get_transform_by8_to_dst_specialized_avx2( img::img_type dst, img::img_type src, method m );
+    transform_function_type	get_transform_by8_to_dst_specialized_neon( img::img_type dst, img::img_type src, method m );
+}
+}
+}
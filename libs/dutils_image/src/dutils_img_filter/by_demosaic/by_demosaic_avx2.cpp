@@ -0,0 +1,83 @@
+
+#include "by_demosaic.h"
+#include "by_demosaic_internal.h"
+
+#include "../simd_helper/use_simd_avx2.h"
+
+/*
+ * AVX2 variant of by_demosaic_c.cpp, 32 pixels per block.
+ *
+ * The even/odd split and the interleave work within 16-bit lanes, so only the BGRA32 store crosses the 128-bit lanes.
+ */
+
+namespace
+{
+    using namespace by_demosaic_internal;
+
+struct ops_avx2
+{
+    using vec = __m256i;
+
+    static constexpr int pixels_per_block = 32;
+
+    static FORCEINLINE void     load_pair( const uint8_t* p, vec& even, vec& odd ) noexcept
+    {
+        const auto v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(p) );
+        even = _mm256_and_si256( v, _mm256_set1_epi16( 0x00FF ) );
+        odd = _mm256_srli_epi16( v, 8 );
+    }
+
+    static FORCEINLINE vec  add( vec a, vec b ) noexcept { return _mm256_add_epi16( a, b ); }
+    static FORCEINLINE vec  sub( vec a, vec b ) noexcept { return _mm256_sub_epi16( a, b ); }
+    static FORCEINLINE vec  avg( vec a, vec b ) noexcept { return _mm256_avg_epu16( a, b ); }
+
+    template<int n>
+    static FORCEINLINE vec  shl( vec a ) noexcept { return _mm256_slli_epi16( a, n ); }
+
+    static FORCEINLINE vec  hq_result( vec k ) noexcept
+    {
+        const auto res = _mm256_srai_epi16( _mm256_add_epi16( k, _mm256_set1_epi16( 8 ) ), 4 );
+        return _mm256_min_epi16( _mm256_max_epi16( res, _mm256_setzero_si256() ), _mm256_set1_epi16( 0xFF ) );
+    }
+
+    // even and odd are in [0;0xFF]
+    static FORCEINLINE vec  interleave( vec even, vec odd ) noexcept
+    {
+        return _mm256_or_si256( even, _mm256_slli_epi16( odd, 8 ) );
+    }
+
+    static FORCEINLINE void     store_bgra32( void* out_line, int x, vec r_even, vec r_odd, vec g_even, vec g_odd, vec b_even, vec b_odd ) noexcept
+    {
+        const auto r = interleave( r_even, r_odd );
+        const auto g = interleave( g_even, g_odd );
+        const auto b = interleave( b_even, b_odd );
+
+        const auto full_ff = _mm256_set1_epi8( -1 );
+
+        const auto bg_lo = _mm256_unpacklo_epi8( b, g );       // lane0 = pixel [0;8[, lane1 = pixel [16;24[
+        const auto bg_hi = _mm256_unpackhi_epi8( b, g );       // lane0 = pixel [8;16[, lane1 = pixel [24;32[
+        const auto rf_lo = _mm256_unpacklo_epi8( r, full_ff );
+        const auto rf_hi = _mm256_unpackhi_epi8( r, full_ff );
+
+        const auto p0 = _mm256_unpacklo_epi16( bg_lo, rf_lo );  // pixel [0;4[ and [16;20[
+        const auto p1 = _mm256_unpackhi_epi16( bg_lo, rf_lo );  // pixel [4;8[ and [20;24[
+        const auto p2 = _mm256_unpacklo_epi16( bg_hi, rf_hi );  // pixel [8;12[ and [24;28[
+        const auto p3 = _mm256_unpackhi_epi16( bg_hi, rf_hi );  // pixel [12;16[ and [28;32[
+
+        auto* p_out = reinterpret_cast<__m256i*>(static_cast<BGRA32*>(out_line) + x);
+        _mm256_storeu_si256( p_out + 0, _mm256_permute2x128_si256( p0, p1, 0x20 ) );
+        _mm256_storeu_si256( p_out + 1, _mm256_permute2x128_si256( p2, p3, 0x20 ) );
+        _mm256_storeu_si256( p_out + 2, _mm256_permute2x128_si256( p0, p1, 0x31 ) );
+        _mm256_storeu_si256( p_out + 3, _mm256_permute2x128_si256( p2, p3, 0x31 ) );
+    }
+};
+
+}
+
+img_filter::transform_function_type     img_filter::transform::by_demosaic::get_transform_by8_to_dst_specialized_avx2( img::img_type dst, img::img_type src, method m )
+{
+    if( !is_accepted_simd( dst, src, 64 ) ) {
+        return nullptr;
+    }
+    return select_specialized_func<simd_kernel<ops_avx2>>( src.fourcc_type(), m );
+}
@@ -0,0 +1,99 @@
+
+#include "by_demosaic.h"
+#include "by_demosaic_internal.h"
+
+namespace
+{
+    using namespace by_demosaic_internal;
+
+template<class TOut>
+struct kernel_c
+{
+    template<method m, by_pattern pattern>
+    static void     convert_line( const line_data& lines, int dim_x ) noexcept
+    {
+        static const options no_opt = {};
+
+        conv_line_c<TOut, m, pattern, false>( no_opt, lines, 0, dim_x, dim_x );
+    }
+};
+
+template<class TOut, method m, by_pattern pattern, bool use_mtx>
+void    transform_image( const img::img_descriptor& dst, const img::img_descriptor& src, const options& opt )
+{
+    const int dim_x = src.dim.cx;
+    demosaic_image_loop<pattern>( dst, src, [&opt, dim_x]( auto line_pattern, const line_data& lines )
+    {
+        conv_line_c<TOut, m, decltype( line_pattern )::value, use_mtx>( opt, lines, 0, dim_x, dim_x );
+    } );
+}
+
+template<class TOut, method m, bool use_mtx>
+auto    select_pattern_func( by_pattern pattern ) noexcept -> decltype( &transform_image<TOut, m, by_pattern::BG, use_mtx> )
+{
+    switch( pattern )
+    {
+    case by_pattern::BG:    return &transform_image<TOut, m, by_pattern::BG, use_mtx>;
+    case by_pattern::GB:    return &transform_image<TOut, m, by_pattern::GB, use_mtx>;
+    case by_pattern::GR:    return &transform_image<TOut, m, by_pattern::GR, use_mtx>;
+    case by_pattern::RG:    return &transform_image<TOut, m, by_pattern::RG, use_mtx>;
+    };
+    return nullptr;
+}
+
+// The function_type of get_transform_by8_to_dst_c, the pattern and the options are resolved once per image
+template<class TOut, method m>
+void    transform_by8_image( img::img_descriptor dst, img::img_descriptor src, const options& opt )
+{
+    const auto pattern = convert_bayer_fcc_to_pattern( src.fourcc_type() );
+
+    const auto func = opt.use_color_matrix ? select_pattern_func<TOut, m, true>( pattern ) : select_pattern_func<TOut, m, false>( pattern );
+    func( img::flip_image_in_img_desc_if_allowed( dst ), src, opt );
+}
+
+template<class TOut>
+img_filter::transform::by_demosaic::function_type   select_method_func( method m ) noexcept
+{
+    switch( m )
+    {
+    case method::nearest:   return &transform_by8_image<TOut, method::nearest>;
+    case method::bilinear:  return &transform_by8_image<TOut, method::bilinear>;
+    case method::hq:        return &transform_by8_image<TOut, method::hq>;
+    };
+    return nullptr;
+}
+
+}
+
+img_filter::transform::by_demosaic::function_type   img_filter::transform::by_demosaic::get_transform_by8_to_dst_c( img::img_type dst, img::img_type src, method m )
+{
+    if( !img::is_by8_fcc( src.fourcc_type() ) || dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( dst.dim.cx < 4 || dst.dim.cy < 3 ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGRA32:   return select_method_func<BGRA32>( m );
+    case img::fourcc::BGR24:    return select_method_func<BGR24>( m );
+    default:
+        return nullptr;
+    };
+}
+
+img_filter::transform_function_type     img_filter::transform::by_demosaic::get_transform_by8_to_dst_specialized_c( img::img_type dst, img::img_type src, method m )
+{
+    if( get_transform_by8_to_dst_c( dst, src, m ) == nullptr ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGRA32:   return select_specialized_func<kernel_c<BGRA32>>( src.fourcc_type(), m );
+    case img::fourcc::BGR24:    return select_specialized_func<kernel_c<BGR24>>( src.fourcc_type(), m );
+    default:
+        return nullptr;
+    };
+}
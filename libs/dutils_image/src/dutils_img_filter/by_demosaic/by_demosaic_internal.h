@@ -0,0 +1,425 @@
+
+#pragma once
+
+#include "by_demosaic.h"
+
+#include <dutils_img/pixel_structs.h>
+#include <dutils_img/image_bayer_pattern.h>
+
+#include <type_traits>
+
+/*
+ * All averages of 2 values are rounded, (a + b + 1) / 2, and averages of 4 values are the average of two such averages.
+ * The hq kernels are calculated with 16 times the weights of the paper and rounded at the end.
+ * All intermediate values fit into int16_t, so the SIMD variants return the same values as the C variant.
+ *
+ * The SIMD variants work on 16-bit lanes, each lane holds the even and the odd pixel of a 2x2 cell.
+ * The even pixels of a block are the one pattern of the line, the odd pixels the other one.
+ */
+
+namespace by_demosaic_internal
+{
+    using img::pixel_type::BGRA32;
+    using img::pixel_type::BGR24;
+
+    using namespace img::by_transform;
+    using namespace img::by_transform::by_pattern_alg;
+
+    using img_filter::transform::by_demosaic::method;
+    using img_filter::transform::by_demosaic::options;
+
+    struct line_data
+    {
+        const uint8_t*  lines[5];   // { y - 2, y - 1, y, y + 1, y + 2 }
+        const uint8_t*  partner;    // the other line of the 2x2 cell of y
+
+        void*   out_line;           // pointer to the out line, must be converted to the actual type
+    };
+
+    // Mirrors lines outside of src, keeps them when the flags allow reading them
+    inline int      calc_src_line( int y, int dim_y, uint32_t flags ) noexcept
+    {
+        if( y < 0 && !(flags & img::img_descriptor::flags_no_wrap_beg) ) {
+            return -y;
+        }
+        if( y >= dim_y && !(flags & img::img_descriptor::flags_no_wrap_end) ) {
+            return 2 * (dim_y - 1) - y;
+        }
+        return y;
+    }
+
+    inline line_data    init_line_data( int y, const img::img_descriptor& dst, const img::img_descriptor& src ) noexcept
+    {
+        const int dim_y = src.dim.cy;
+        const auto line = [&src, dim_y]( int src_y ) -> const uint8_t* {
+            return img::get_line_start( src, calc_src_line( src_y, dim_y, src.flags ) );
+        };
+
+        int partner_y = y ^ 1;
+        if( partner_y >= dim_y && !(src.flags & img::img_descriptor::flags_no_wrap_end) ) {
+            partner_y = y - 1;
+        }
+
+        return line_data{
+            { line( y - 2 ), line( y - 1 ), line( y ), line( y + 1 ), line( y + 2 ) },
+            img::get_line_start( src, partner_y ),
+            img::get_line_start( dst, y ),
+        };
+    }
+
+    constexpr bool  is_red_line( by_pattern pat ) noexcept {
+        return pat == by_pattern::RG || pat == by_pattern::GR;
+    }
+    constexpr bool  is_green_pixel( by_pattern pat ) noexcept {
+        return pat == by_pattern::GR || pat == by_pattern::GB;
+    }
+
+    template<by_pattern pattern>
+    using pattern_tag = std::integral_constant<by_pattern, pattern>;
+
+    // Calls conv_line( pattern_tag<line_pattern>{}, lines ) for every line of src, pattern is the pattern of the first line
+    template<by_pattern pattern, class TLineFunc>
+    FORCEINLINE void    demosaic_image_loop( const img::img_descriptor& dst, const img::img_descriptor& src, TLineFunc conv_line )
+    {
+        constexpr auto pattern_nxt = next_line( pattern );
+
+        const int dim_y = src.dim.cy;
+        for( int y = 0; y < dim_y; y += 2 )
+        {
+            conv_line( pattern_tag<pattern>{}, init_line_data( y, dst, src ) );
+            if( y + 1 < dim_y ) {
+                conv_line( pattern_tag<pattern_nxt>{}, init_line_data( y + 1, dst, src ) );
+            }
+        }
+    }
+
+    FORCEINLINE int     avg( int a, int b ) noexcept
+    {
+        return (a + b + 1) >> 1;
+    }
+
+    FORCEINLINE int     hq_result( int k ) noexcept
+    {
+        return CLIP( (k + 8) >> 4, 0, 0xFF );
+    }
+
+    // c1 is the color of the line, c2 the other color
+    struct channels
+    {
+        int c1, g, c2;
+    };
+
+    // Column indices of the neighbours of x, mirrored at the line borders
+    struct columns
+    {
+        int m2, m1, c, p1, p2;
+    };
+
+    FORCEINLINE columns     make_columns( int x, int dim_x ) noexcept
+    {
+        const auto mirror = [dim_x]( int i ) {
+            return i < 0 ? -i : (i >= dim_x ? 2 * (dim_x - 1) - i : i);
+        };
+        return columns{ mirror( x - 2 ), mirror( x - 1 ), x, mirror( x + 1 ), mirror( x + 2 ) };
+    }
+
+    // first_in_cell is true for the even pixels of a line
+    template<method m, bool green_pixel, bool first_in_cell>
+    FORCEINLINE channels    calc_pixel( const line_data& lines, const columns& col ) noexcept
+    {
+        const uint8_t* n2 = lines.lines[0];
+        const uint8_t* n1 = lines.lines[1];
+        const uint8_t* cur = lines.lines[2];
+        const uint8_t* s1 = lines.lines[3];
+        const uint8_t* s2 = lines.lines[4];
+
+        if constexpr( m == method::nearest )
+        {
+            const int other = first_in_cell ? col.p1 : col.m1;
+            if constexpr( green_pixel ) {
+                return channels{ cur[other], cur[col.c], lines.partner[col.c] };
+            } else {
+                return channels{ cur[col.c], cur[other], lines.partner[other] };
+            }
+        }
+        else if constexpr( m == method::bilinear )
+        {
+            if constexpr( green_pixel ) {
+                return channels{ avg( cur[col.m1], cur[col.p1] ), cur[col.c], avg( n1[col.c], s1[col.c] ) };
+            } else {
+                const int g = avg( avg( cur[col.m1], cur[col.p1] ), avg( n1[col.c], s1[col.c] ) );
+                const int c2 = avg( avg( n1[col.m1], n1[col.p1] ), avg( s1[col.m1], s1[col.p1] ) );
+                return channels{ cur[col.c], g, c2 };
+            }
+        }
+        else
+        {
+            const int c = cur[col.c];
+            const int h1 = cur[col.m1] + cur[col.p1];
+            const int v1 = n1[col.c] + s1[col.c];
+            const int h2 = cur[col.m2] + cur[col.p2];
+            const int v2 = n2[col.c] + s2[col.c];
+            const int diag = n1[col.m1] + n1[col.p1] + s1[col.m1] + s1[col.p1];
+
+            if constexpr( green_pixel ) {
+                const int kh = 10 * c + 8 * h1 - 2 * diag - 2 * h2 + v2;
+                const int kv = 10 * c + 8 * v1 - 2 * diag - 2 * v2 + h2;
+                return channels{ hq_result( kh ), c, hq_result( kv ) };
+            } else {
+                const int kg = 8 * c + 4 * (h1 + v1) - 2 * (h2 + v2);
+                const int kd = 12 * c + 4 * diag - 3 * (h2 + v2);
+                return channels{ c, hq_result( kg ), hq_result( kd ) };
+            }
+        }
+    }
+
+    template<int base_index>
+    FORCEINLINE int     apply_color_matrix_chn( const img::color_matrix_int& clr, int r, int g, int b ) noexcept
+    {
+        return CLIP( (r * clr.fac[base_index + 0] + g * clr.fac[base_index + 1] + b * clr.fac[base_index + 2]) / 64, 0, 0xFF );
+    }
+
+    template<class TOut>
+    void    store( void* out_line, int x, int r, int g, int b ) noexcept = delete;
+
+    template<>
+    FORCEINLINE void    store<BGRA32>( void* out_line, int x, int r, int g, int b ) noexcept
+    {
+        static_cast<BGRA32*>(out_line)[x] = BGRA32{ static_cast<uint8_t>(b), static_cast<uint8_t>(g), static_cast<uint8_t>(r), 0xFF };
+    }
+
+    template<>
+    FORCEINLINE void    store<BGR24>( void* out_line, int x, int r, int g, int b ) noexcept
+    {
+        static_cast<BGR24*>(out_line)[x] = BGR24{ static_cast<uint8_t>(b), static_cast<uint8_t>(g), static_cast<uint8_t>(r) };
+    }
+
+    template<class TOut, method m, by_pattern pattern, bool use_mtx, bool first_in_cell>
+    FORCEINLINE void    conv_pixel( const options& opt, const line_data& lines, int x, int dim_x ) noexcept
+    {
+        const auto res = calc_pixel<m, is_green_pixel( pattern ), first_in_cell>( lines, make_columns( x, dim_x ) );
+
+        constexpr bool red_line = is_red_line( pattern );
+        const int r = red_line ? res.c1 : res.c2;
+        const int b = red_line ? res.c2 : res.c1;
+        if constexpr( use_mtx ) {
+            store<TOut>( lines.out_line, x,
+                apply_color_matrix_chn<0>( opt.color_mtx, r, res.g, b ),
+                apply_color_matrix_chn<3>( opt.color_mtx, r, res.g, b ),
+                apply_color_matrix_chn<6>( opt.color_mtx, r, res.g, b ) );
+        } else {
+            store<TOut>( lines.out_line, x, r, res.g, b );
+        }
+    }
+
+    // Converts the pixels [x;x_end[, x must be even and pattern is the pattern of pixel x
+    template<class TOut, method m, by_pattern pattern, bool use_mtx>
+    FORCEINLINE void    conv_line_c( const options& opt, const line_data& lines, int x, int x_end, int dim_x ) noexcept
+    {
+        constexpr auto nxt_pattern = next_pixel( pattern );
+
+        for( ; x < x_end; x += 2 )
+        {
+            conv_pixel<TOut, m, pattern, use_mtx, true>( opt, lines, x, dim_x );
+            if( x + 1 < x_end ) {
+                conv_pixel<TOut, m, nxt_pattern, use_mtx, false>( opt, lines, x + 1, dim_x );
+            }
+        }
+    }
+
+    /* TOps provides the vector operations of one instruction set:
+     *  vec                                             16-bit lanes
+     *  pixels_per_block                                2 * lane count
+     *  void load_pair( const uint8_t* p, vec& even, vec& odd )   even/odd pixels of [p;p + pixels_per_block[ as 16-bit lanes
+     *  vec add( vec, vec ), sub( vec, vec ), avg( vec, vec )     avg is the rounded average of unsigned values
+     *  template<int n> vec shl( vec )
+     *  vec hq_result( vec k )                          clamp( (k + 8) >> 4, 0, 0xFF ) of signed values
+     *  void store_bgra32( void* out_line, int x, r_even, r_odd, g_even, g_odd, b_even, b_odd )
+     */
+    template<class TOps>
+    struct simd_channels
+    {
+        typename TOps::vec c1, g, c2;
+    };
+
+    // v[k + 2] are the pixels x + k of the lanes for k in [-2;3]
+    template<class TOps>
+    FORCEINLINE void    load_row( const uint8_t* line, int x, typename TOps::vec (&v)[6] ) noexcept
+    {
+        TOps::load_pair( line + x - 2, v[0], v[1] );
+        TOps::load_pair( line + x + 0, v[2], v[3] );
+        TOps::load_pair( line + x + 2, v[4], v[5] );
+    }
+
+    template<class TOps, by_pattern pattern>
+    FORCEINLINE void    store_block( const line_data& lines, int x, const simd_channels<TOps>& even, const simd_channels<TOps>& odd ) noexcept
+    {
+        if constexpr( is_red_line( pattern ) ) {
+            TOps::store_bgra32( lines.out_line, x, even.c1, odd.c1, even.g, odd.g, even.c2, odd.c2 );
+        } else {
+            TOps::store_bgra32( lines.out_line, x, even.c2, odd.c2, even.g, odd.g, even.c1, odd.c1 );
+        }
+    }
+
+    // k is the index of the center pixel in the row arrays
+    template<class TOps, method m, bool green_pixel>
+    FORCEINLINE simd_channels<TOps>     calc_block_pixels( const typename TOps::vec (&n2)[6], const typename TOps::vec (&n1)[6], const typename TOps::vec (&cur)[6],
+                                                           const typename TOps::vec (&s1)[6], const typename TOps::vec (&s2)[6], int k ) noexcept
+    {
+        if constexpr( m == method::bilinear )
+        {
+            const auto lr = TOps::avg( cur[k - 1], cur[k + 1] );
+            const auto ob = TOps::avg( n1[k], s1[k] );
+            if constexpr( green_pixel ) {
+                return { lr, cur[k], ob };
+            } else {
+                const auto diag = TOps::avg( TOps::avg( n1[k - 1], n1[k + 1] ), TOps::avg( s1[k - 1], s1[k + 1] ) );
+                return { cur[k], TOps::avg( lr, ob ), diag };
+            }
+        }
+        else
+        {
+            const auto c = cur[k];
+            const auto h1 = TOps::add( cur[k - 1], cur[k + 1] );
+            const auto v1 = TOps::add( n1[k], s1[k] );
+            const auto h2 = TOps::add( cur[k - 2], cur[k + 2] );
+            const auto v2 = TOps::add( n2[k], s2[k] );
+            const auto diag = TOps::add( TOps::add( n1[k - 1], n1[k + 1] ), TOps::add( s1[k - 1], s1[k + 1] ) );
+
+            const auto c8 = TOps::template shl<3>( c );
+            const auto c2 = TOps::template shl<1>( c );
+            if constexpr( green_pixel )
+            {
+                // 10 * c + 8 * h1 - 2 * diag - 2 * h2 + v2 and 10 * c + 8 * v1 - 2 * diag - 2 * v2 + h2
+                const auto c10_diag = TOps::sub( TOps::add( c8, c2 ), TOps::template shl<1>( diag ) );
+                const auto kh = TOps::add( TOps::add( c10_diag, TOps::template shl<3>( h1 ) ), TOps::sub( v2, TOps::template shl<1>( h2 ) ) );
+                const auto kv = TOps::add( TOps::add( c10_diag, TOps::template shl<3>( v1 ) ), TOps::sub( h2, TOps::template shl<1>( v2 ) ) );
+                return { TOps::hq_result( kh ), c, TOps::hq_result( kv ) };
+            }
+            else
+            {
+                // 8 * c + 4 * (h1 + v1) - 2 * (h2 + v2) and 12 * c + 4 * diag - 3 * (h2 + v2)
+                const auto hv2 = TOps::add( h2, v2 );
+                const auto kg = TOps::sub( TOps::add( c8, TOps::template shl<2>( TOps::add( h1, v1 ) ) ), TOps::template shl<1>( hv2 ) );
+                const auto kd = TOps::sub( TOps::add( TOps::add( c8, TOps::template shl<2>( c ) ), TOps::template shl<2>( diag ) ),
+                                           TOps::add( TOps::template shl<1>( hv2 ), hv2 ) );
+                return { c, TOps::hq_result( kg ), TOps::hq_result( kd ) };
+            }
+        }
+    }
+
+    // pixel [x;x + pixels_per_block[, x must be even, reads [x - 2;x + pixels_per_block + 2[
+    template<class TOps, method m, by_pattern pattern>
+    FORCEINLINE void    conv_block( const line_data& lines, int x ) noexcept
+    {
+        using vec = typename TOps::vec;
+
+        // the even pixels have pattern, the odd pixels the next one
+        constexpr bool green_first = is_green_pixel( pattern );
+
+        if constexpr( m == method::nearest )
+        {
+            vec cur_even, cur_odd, par_even, par_odd;
+            TOps::load_pair( lines.lines[2] + x, cur_even, cur_odd );
+            TOps::load_pair( lines.partner + x, par_even, par_odd );
+
+            simd_channels<TOps> res;
+            if constexpr( green_first ) {
+                res = { cur_odd, cur_even, par_even };
+            } else {
+                res = { cur_even, cur_odd, par_odd };
+            }
+            store_block<TOps, pattern>( lines, x, res, res );
+        }
+        else
+        {
+            vec rows[5][6];
+            if constexpr( m == method::hq ) {
+                load_row<TOps>( lines.lines[0], x, rows[0] );
+                load_row<TOps>( lines.lines[4], x, rows[4] );
+            }
+            load_row<TOps>( lines.lines[1], x, rows[1] );
+            load_row<TOps>( lines.lines[2], x, rows[2] );
+            load_row<TOps>( lines.lines[3], x, rows[3] );
+
+            const auto even = calc_block_pixels<TOps, m, green_first>( rows[0], rows[1], rows[2], rows[3], rows[4], 2 );
+            const auto odd = calc_block_pixels<TOps, m, !green_first>( rows[0], rows[1], rows[2], rows[3], rows[4], 3 );
+            store_block<TOps, pattern>( lines, x, even, odd );
+        }
+    }
+
+    // Converts a line to BGRA32, the first 2 and the remaining pixels are converted by the C variant
+    template<class TOps, method m, by_pattern pattern>
+    void    conv_line_simd( const line_data& lines, int dim_x ) noexcept
+    {
+        static const options no_opt = {};
+
+        conv_line_c<BGRA32, m, pattern, false>( no_opt, lines, 0, 2, dim_x );
+
+        int x = 2;
+        for( ; x <= (dim_x - TOps::pixels_per_block - 2); x += TOps::pixels_per_block )
+        {
+            conv_block<TOps, m, pattern>( lines, x );
+        }
+        conv_line_c<BGRA32, m, pattern, false>( no_opt, lines, x, dim_x, dim_x );
+    }
+
+    /* TKernel must provide
+     *  template<method m, by_pattern pattern>
+     *  static void convert_line( const line_data& lines, int dim_x )
+     */
+    template<class TKernel, method m, by_pattern pattern>
+    void    transform_by8_image_specialized( img::img_descriptor dst, img::img_descriptor src )
+    {
+        const int dim_x = src.dim.cx;
+        demosaic_image_loop<pattern>( img::flip_image_in_img_desc_if_allowed( dst ), src, [dim_x]( auto line_pattern, const line_data& lines )
+        {
+            TKernel::template convert_line<m, decltype( line_pattern )::value>( lines, dim_x );
+        } );
+    }
+
+    template<class TKernel, method m>
+    img_filter::transform_function_type     select_specialized_func_( by_pattern pattern ) noexcept
+    {
+        switch( pattern )
+        {
+        case by_pattern::BG:    return &transform_by8_image_specialized<TKernel, m, by_pattern::BG>;
+        case by_pattern::GB:    return &transform_by8_image_specialized<TKernel, m, by_pattern::GB>;
+        case by_pattern::GR:    return &transform_by8_image_specialized<TKernel, m, by_pattern::GR>;
+        case by_pattern::RG:    return &transform_by8_image_specialized<TKernel, m, by_pattern::RG>;
+        };
+        return nullptr;
+    }
+
+    template<class TKernel>
+    img_filter::transform_function_type     select_specialized_func( img::fourcc src_fcc, method m ) noexcept
+    {
+        const auto pattern = convert_bayer_fcc_to_pattern( src_fcc );
+        switch( m )
+        {
+        case method::nearest:   return select_specialized_func_<TKernel, method::nearest>( pattern );
+        case method::bilinear:  return select_specialized_func_<TKernel, method::bilinear>( pattern );
+        case method::hq:        return select_specialized_func_<TKernel, method::hq>( pattern );
+        };
+        return nullptr;
+    }
+
+    template<class TOps>
+    struct simd_kernel
+    {
+        template<method m, by_pattern pattern>
+        static void     convert_line( const line_data& lines, int dim_x ) noexcept
+        {
+            conv_line_simd<TOps, m, pattern>( lines, dim_x );
+        }
+    };
+
+    // Checks for the SIMD variants, min_dim_x has to leave room for at least one block
+    inline bool     is_accepted_simd( img::img_type dst, img::img_type src, int min_dim_x ) noexcept
+    {
+        if( !img::is_by8_fcc( src.fourcc_type() ) || dst.dim != src.dim ) {
+            return false;
+        }
+        return dst.fourcc_type() == img::fourcc::BGRA32 && dst.dim.cx >= min_dim_x && dst.dim.cy >= 3;
+    }
+}
@@ -0,0 +1,65 @@
+
+#include "by_demosaic.h"
+#include "by_demosaic_internal.h"
+
+#include "../simd_helper/use_simd_A64.h"
+
+/*
+ * NEON variant of by_demosaic_c.cpp, 16 pixels per block.
+ */
+
+namespace
+{
+    using namespace by_demosaic_internal;
+
+struct ops_neon
+{
+    using vec = int16x8_t;
+
+    static constexpr int pixels_per_block = 16;
+
+    static FORCEINLINE void     load_pair( const uint8_t* p, vec& even, vec& odd ) noexcept
+    {
+        const auto v = vreinterpretq_u16_u8( vld1q_u8( p ) );
+        even = vreinterpretq_s16_u16( vandq_u16( v, vdupq_n_u16( 0x00FF ) ) );
+        odd = vreinterpretq_s16_u16( vshrq_n_u16( v, 8 ) );
+    }
+
+    static FORCEINLINE vec  add( vec a, vec b ) noexcept { return vaddq_s16( a, b ); }
+    static FORCEINLINE vec  sub( vec a, vec b ) noexcept { return vsubq_s16( a, b ); }
+    static FORCEINLINE vec  avg( vec a, vec b ) noexcept
+    {
+        return vreinterpretq_s16_u16( vrhaddq_u16( vreinterpretq_u16_s16( a ), vreinterpretq_u16_s16( b ) ) );
+    }
+
+    template<int n>
+    static FORCEINLINE vec  shl( vec a ) noexcept { return vshlq_n_s16( a, n ); }
+
+    static FORCEINLINE vec  hq_result( vec k ) noexcept
+    {
+        // (k + 8) >> 4 and saturated to [0;0xFF]
+        return vreinterpretq_s16_u16( vmovl_u8( vqrshrun_n_s16( k, 4 ) ) );
+    }
+
+    // even and odd are in [0;0xFF]
+    static FORCEINLINE uint8x16_t   interleave( vec even, vec odd ) noexcept
+    {
+        return vreinterpretq_u8_s16( vorrq_s16( even, vshlq_n_s16( odd, 8 ) ) );
+    }
+
+    static FORCEINLINE void     store_bgra32( void* out_line, int x, vec r_even, vec r_odd, vec g_even, vec g_odd, vec b_even, vec b_odd ) noexcept
+    {
+        simd::neon::storage::store_BGR32( static_cast<BGRA32*>(out_line) + x,
+            interleave( r_even, r_odd ), interleave( g_even, g_odd ), interleave( b_even, b_odd ) );
+    }
+};
+
+}
+
+img_filter::transform_function_type     img_filter::transform::by_demosaic::get_transform_by8_to_dst_specialized_neon( img::img_type dst, img::img_type src, method m )
+{
+    if( !is_accepted_simd( dst, src, 32 ) ) {
+        return nullptr;
+    }
+    return select_specialized_func<simd_kernel<ops_neon>>( src.fourcc_type(), m );
+}
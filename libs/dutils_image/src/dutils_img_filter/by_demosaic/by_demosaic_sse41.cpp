@@ -0,0 +1,76 @@
+
+#include "by_demosaic.h"
+#include "by_demosaic_internal.h"
+
+#include "../simd_helper/use_simd_sse41.h"
+
+/*
+ * SSE4.1 variant of by_demosaic_c.cpp, 16 pixels per block.
+ */
+
+namespace
+{
+    using namespace by_demosaic_internal;
+
+struct ops_sse41
+{
+    using vec = __m128i;
+
+    static constexpr int pixels_per_block = 16;
+
+    static FORCEINLINE void     load_pair( const uint8_t* p, vec& even, vec& odd ) noexcept
+    {
+        const auto v = _mm_loadu_si128( reinterpret_cast<const __m128i*>(p) );
+        even = _mm_and_si128( v, _mm_set1_epi16( 0x00FF ) );
+        odd = _mm_srli_epi16( v, 8 );
+    }
+
+    static FORCEINLINE vec  add( vec a, vec b ) noexcept { return _mm_add_epi16( a, b ); }
+    static FORCEINLINE vec  sub( vec a, vec b ) noexcept { return _mm_sub_epi16( a, b ); }
+    static FORCEINLINE vec  avg( vec a, vec b ) noexcept { return _mm_avg_epu16( a, b ); }
+
+    template<int n>
+    static FORCEINLINE vec  shl( vec a ) noexcept { return _mm_slli_epi16( a, n ); }
+
+    static FORCEINLINE vec  hq_result( vec k ) noexcept
+    {
+        const auto res = _mm_srai_epi16( _mm_add_epi16( k, _mm_set1_epi16( 8 ) ), 4 );
+        return _mm_min_epi16( _mm_max_epi16( res, _mm_setzero_si128() ), _mm_set1_epi16( 0xFF ) );
+    }
+
+    // even and odd are in [0;0xFF]
+    static FORCEINLINE vec  interleave( vec even, vec odd ) noexcept
+    {
+        return _mm_or_si128( even, _mm_slli_epi16( odd, 8 ) );
+    }
+
+    static FORCEINLINE void     store_bgra32( void* out_line, int x, vec r_even, vec r_odd, vec g_even, vec g_odd, vec b_even, vec b_odd ) noexcept
+    {
+        const auto r = interleave( r_even, r_odd );
+        const auto g = interleave( g_even, g_odd );
+        const auto b = interleave( b_even, b_odd );
+
+        const auto full_ff = _mm_set1_epi8( -1 );
+
+        const auto bg_lo = _mm_unpacklo_epi8( b, g );
+        const auto bg_hi = _mm_unpackhi_epi8( b, g );
+        const auto rf_lo = _mm_unpacklo_epi8( r, full_ff );
+        const auto rf_hi = _mm_unpackhi_epi8( r, full_ff );
+
+        auto* p_out = reinterpret_cast<__m128i*>(static_cast<BGRA32*>(out_line) + x);
+        _mm_storeu_si128( p_out + 0, _mm_unpacklo_epi16( bg_lo, rf_lo ) );
+        _mm_storeu_si128( p_out + 1, _mm_unpackhi_epi16( bg_lo, rf_lo ) );
+        _mm_storeu_si128( p_out + 2, _mm_unpacklo_epi16( bg_hi, rf_hi ) );
+        _mm_storeu_si128( p_out + 3, _mm_unpackhi_epi16( bg_hi, rf_hi ) );
+    }
+};
+
+}
+
+img_filter::transform_function_type     img_filter::transform::by_demosaic::get_transform_by8_to_dst_specialized_sse41( img::img_type dst, img::img_type src, method m )
+{
+    if( !is_accepted_simd( dst, src, 32 ) ) {
+        return nullptr;
+    }
+    return select_specialized_func<simd_kernel<ops_sse41>>( src.fourcc_type(), m );
+}
@@ -0,0 +1,282 @@
+#include "by_edge.h"
+#include "by16_edge_internal.h"
+
+#include "../simd_helper/use_simd_avx2.h"
+
+/*
+ * AVX2 variant of by16_edge_c.cpp
+ *
+ * 16 pixels are calculated per block. Every block starts on an even pixel, so the even pixels have
+ * the pattern of the line and the odd pixels the next pattern. The results for both are calculated for
+ * all pixels and then blended together.
+ */
+
+namespace
+{
+    using namespace by16_edge_internal;
+
+FORCEINLINE __m256i     load_u( const uint16_t* p )
+{
+    return _mm256_loadu_si256( reinterpret_cast<const __m256i*>(p) );
+}
+
+// takes the even 16-bit entries from a and the odd ones from b
+FORCEINLINE __m256i     blend_odd( __m256i a, __m256i b )
+{
+    return _mm256_blend_epi16( a, b, 0xAA );
+}
+
+FORCEINLINE __m256i     abs_diff_epu16( __m256i a, __m256i b )
+{
+    return _mm256_or_si256( _mm256_subs_epu16( a, b ), _mm256_subs_epu16( b, a ) );
+}
+
+// a < b for unsigned 16-bit values
+FORCEINLINE __m256i     cmplt_epu16( __m256i a, __m256i b )
+{
+    const auto bias = _mm256_set1_epi16( static_cast<short>(0x8000) );
+    return _mm256_cmpgt_epi16( _mm256_xor_si256( b, bias ), _mm256_xor_si256( a, bias ) );
+}
+
+FORCEINLINE __m256i     calc_edge_green( __m256i cur_l, __m256i cur_r, __m256i prv, __m256i nxt, __m256i lr, __m256i ob )
+{
+    auto dif_lr = abs_diff_epu16( cur_l, cur_r );
+    auto dif_ab = abs_diff_epu16( prv, nxt );
+
+    auto cmp_lt = cmplt_epu16( dif_lr, dif_ab );
+    auto cmp_eq = _mm256_cmpeq_epi16( dif_lr, dif_ab );
+
+    auto tmp0 = _mm256_blendv_epi8( ob, lr, cmp_lt );
+    return _mm256_blendv_epi8( tmp0, _mm256_avg_epu16( lr, ob ), cmp_eq );
+}
+
+FORCEINLINE __m256i     calc_avg_green( __m256i prv_l, __m256i prv_r, __m256i nxt_l, __m256i diagonal, __m256i cur )
+{
+    const auto threshold = _mm256_set1_epi16( avg_green_threshold );
+
+    auto dif_lr = abs_diff_epu16( prv_l, prv_r );
+    auto dif_ab = abs_diff_epu16( prv_l, nxt_l );
+
+    auto cond = _mm256_and_si256( cmplt_epu16( dif_lr, threshold ), cmplt_epu16( dif_ab, threshold ) );
+
+    return _mm256_blendv_epi8( cur, _mm256_avg_epu16( diagonal, cur ), cond );
+}
+
+struct kernel_avx2
+{
+    struct context_type
+    {
+        __m256i     clr_mtx[9];     // epi32
+
+        options     opt;
+    };
+
+    static context_type     make_context( const options& opt ) noexcept
+    {
+        context_type ctx = { {}, opt };
+        for( int i = 0; i < 9; ++i ) {
+            ctx.clr_mtx[i] = _mm256_set1_epi32( opt.color_mtx.fac[i] );
+        }
+        return ctx;
+    }
+
+    template<class TOut, by_pattern pattern, bool use_mtx, bool use_avg_green>
+    static void     convert_line( const context_type& ctx, const line_data& lines, int dim_x );
+};
+
+template<int base_index>
+FORCEINLINE __m256i     apply_color_matrix_chn_epi32( const kernel_avx2::context_type& ctx, __m256i r, __m256i g, __m256i b )
+{
+    auto t0 = _mm256_mullo_epi32( r, ctx.clr_mtx[base_index + 0] );
+    auto t1 = _mm256_mullo_epi32( g, ctx.clr_mtx[base_index + 1] );
+    auto t2 = _mm256_mullo_epi32( b, ctx.clr_mtx[base_index + 2] );
+
+    return _mm256_srai_epi32( _mm256_add_epi32( _mm256_add_epi32( t0, t1 ), t2 ), 6 );
+}
+
+template<int base_index>
+FORCEINLINE __m256i     apply_color_matrix_chn( const kernel_avx2::context_type& ctx, const __m256i (&r)[2], const __m256i (&g)[2], const __m256i (&b)[2] )
+{
+    auto lo = apply_color_matrix_chn_epi32<base_index>( ctx, r[0], g[0], b[0] );
+    auto hi = apply_color_matrix_chn_epi32<base_index>( ctx, r[1], g[1], b[1] );
+
+    // packus saturates to [0;0xFFFF] and works per lane
+    return _mm256_permute4x64_epi64( _mm256_packus_epi32( lo, hi ), 0xD8 );
+}
+
+FORCEINLINE void    unpack_epu16_to_epi32( __m256i v, __m256i (&res)[2] )
+{
+    res[0] = _mm256_cvtepu16_epi32( _mm256_castsi256_si128( v ) );
+    res[1] = _mm256_cvtepu16_epi32( _mm256_extracti128_si256( v, 1 ) );
+}
+
+FORCEINLINE void    apply_color_matrix( const kernel_avx2::context_type& ctx, __m256i& r, __m256i& g, __m256i& b )
+{
+    __m256i r32[2], g32[2], b32[2];
+    unpack_epu16_to_epi32( r, r32 );
+    unpack_epu16_to_epi32( g, g32 );
+    unpack_epu16_to_epi32( b, b32 );
+
+    r = apply_color_matrix_chn<0>( ctx, r32, g32, b32 );
+    g = apply_color_matrix_chn<3>( ctx, r32, g32, b32 );
+    b = apply_color_matrix_chn<6>( ctx, r32, g32, b32 );
+}
+
+template<class TOut>
+void    store_block( void* out_line, int x, __m256i r, __m256i g, __m256i b ) = delete;
+
+template<>
+FORCEINLINE void    store_block<BGRA64>( void* out_line, int x, __m256i r, __m256i g, __m256i b )
+{
+    const auto full_ff = _mm256_set1_epi16( -1 );
+
+    const auto bg_lo = _mm256_unpacklo_epi16( b, g );        // lane0 = pixel [0;4[, lane1 = pixel [8;12[
+    const auto bg_hi = _mm256_unpackhi_epi16( b, g );        // lane0 = pixel [4;8[, lane1 = pixel [12;16[
+    const auto rf_lo = _mm256_unpacklo_epi16( r, full_ff );
+    const auto rf_hi = _mm256_unpackhi_epi16( r, full_ff );
+
+    const auto p0 = _mm256_unpacklo_epi32( bg_lo, rf_lo );  // pixel [0;2[ and [8;10[
+    const auto p1 = _mm256_unpackhi_epi32( bg_lo, rf_lo );  // pixel [2;4[ and [10;12[
+    const auto p2 = _mm256_unpacklo_epi32( bg_hi, rf_hi );  // pixel [4;6[ and [12;14[
+    const auto p3 = _mm256_unpackhi_epi32( bg_hi, rf_hi );  // pixel [6;8[ and [14;16[
+
+    auto* p_out = reinterpret_cast<__m256i*>(static_cast<BGRA64*>(out_line) + x);
+    _mm256_storeu_si256( p_out + 0, _mm256_permute2x128_si256( p0, p1, 0x20 ) );
+    _mm256_storeu_si256( p_out + 1, _mm256_permute2x128_si256( p2, p3, 0x20 ) );
+    _mm256_storeu_si256( p_out + 2, _mm256_permute2x128_si256( p0, p1, 0x31 ) );
+    _mm256_storeu_si256( p_out + 3, _mm256_permute2x128_si256( p2, p3, 0x31 ) );
+}
+
+// stores 8 pixels
+FORCEINLINE void    store_bgrf_8( BGRf* p_out, __m256 b, __m256 g, __m256 r )
+{
+    // per lane { b0, g0, r0, b1 }, { g1, r1, b2, g2 }, { r2, b3, g3, r3 }
+    const auto rb = _mm256_shuffle_ps( r, b, _MM_SHUFFLE( 1, 1, 0, 0 ) );
+    const auto gr = _mm256_shuffle_ps( g, r, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+    const auto bg = _mm256_shuffle_ps( b, g, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+    const auto rb_hi = _mm256_shuffle_ps( r, b, _MM_SHUFFLE( 3, 3, 2, 2 ) );
+    const auto gr_hi = _mm256_shuffle_ps( g, r, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+
+    const auto q0 = _mm256_shuffle_ps( _mm256_unpacklo_ps( b, g ), rb, _MM_SHUFFLE( 2, 0, 1, 0 ) );
+    const auto q1 = _mm256_shuffle_ps( gr, bg, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+    const auto q2 = _mm256_shuffle_ps( rb_hi, gr_hi, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+
+    auto* p = reinterpret_cast<float*>(p_out);
+    _mm256_storeu_ps( p + 0, _mm256_permute2f128_ps( q0, q1, 0x20 ) );
+    _mm256_storeu_ps( p + 8, _mm256_permute2f128_ps( q2, q0, 0x30 ) );
+    _mm256_storeu_ps( p + 16, _mm256_permute2f128_ps( q1, q2, 0x31 ) );
+}
+
+template<>
+FORCEINLINE void    store_block<BGRf>( void* out_line, int x, __m256i r, __m256i g, __m256i b )
+{
+    const auto scale = _mm256_set1_ps( float_scale );
+
+    __m256i r32[2], g32[2], b32[2];
+    unpack_epu16_to_epi32( r, r32 );
+    unpack_epu16_to_epi32( g, g32 );
+    unpack_epu16_to_epi32( b, b32 );
+
+    auto* p_out = static_cast<BGRf*>(out_line) + x;
+    for( int i = 0; i < 2; ++i )
+    {
+        store_bgrf_8( p_out + i * 8,
+            _mm256_mul_ps( _mm256_cvtepi32_ps( b32[i] ), scale ),
+            _mm256_mul_ps( _mm256_cvtepi32_ps( g32[i] ), scale ),
+            _mm256_mul_ps( _mm256_cvtepi32_ps( r32[i] ), scale ) );
+    }
+}
+
+// pixel [x;x + 16[, reads [x - 1;x + 17[
+template<class TOut, by_pattern pattern, bool use_mtx, bool use_avg_green>
+FORCEINLINE void    conv_block( const kernel_avx2::context_type& ctx, const line_data& lines, int x )
+{
+    const auto prv_l = load_u( lines.lines[0] + x - 1 );
+    const auto prv_c = load_u( lines.lines[0] + x + 0 );
+    const auto prv_r = load_u( lines.lines[0] + x + 1 );
+    const auto cur_l = load_u( lines.lines[1] + x - 1 );
+    const auto cur_c = load_u( lines.lines[1] + x + 0 );
+    const auto cur_r = load_u( lines.lines[1] + x + 1 );
+    const auto nxt_l = load_u( lines.lines[2] + x - 1 );
+    const auto nxt_c = load_u( lines.lines[2] + x + 0 );
+    const auto nxt_r = load_u( lines.lines[2] + x + 1 );
+
+    const auto lr = _mm256_avg_epu16( cur_l, cur_r );
+    const auto ob = _mm256_avg_epu16( prv_c, nxt_c );
+    const auto diagonal = _mm256_avg_epu16( _mm256_avg_epu16( prv_l, prv_r ), _mm256_avg_epu16( nxt_l, nxt_r ) );
+
+    const auto g_on_xy = calc_edge_green( cur_l, cur_r, prv_c, nxt_c, lr, ob );
+    __m256i g_on_g;
+    if constexpr( use_avg_green ) {
+        g_on_g = calc_avg_green( prv_l, prv_r, nxt_l, diagonal, cur_c );
+    } else {
+        g_on_g = cur_c;
+    }
+
+    // x_chn is the color of the line, y_chn the other one
+    __m256i x_chn, y_chn, g_chn;
+    if constexpr( is_green_pixel( pattern ) ) {
+        x_chn = blend_odd( lr, cur_c );
+        y_chn = blend_odd( ob, diagonal );
+        g_chn = blend_odd( g_on_g, g_on_xy );
+    } else {
+        x_chn = blend_odd( cur_c, lr );
+        y_chn = blend_odd( diagonal, ob );
+        g_chn = blend_odd( g_on_xy, g_on_g );
+    }
+
+    __m256i r, b;
+    if constexpr( is_red_line( pattern ) ) {
+        r = x_chn;
+        b = y_chn;
+    } else {
+        r = y_chn;
+        b = x_chn;
+    }
+
+    if constexpr( use_mtx ) {
+        apply_color_matrix( ctx, r, g_chn, b );
+    }
+
+    store_block<TOut>( lines.out_line, x, r, g_chn, b );
+}
+
+template<class TOut, by_pattern pattern, bool use_mtx, bool use_avg_green>
+void    kernel_avx2::convert_line( const context_type& ctx, const line_data& lines, int dim_x )
+{
+    int x = 2;
+    for( ; x <= (dim_x - 18); x += 16 )
+    {
+        conv_block<TOut, pattern, use_mtx, use_avg_green>( ctx, lines, x );
+    }
+    conv_line_c<TOut, pattern, use_mtx, use_avg_green>( ctx.opt, lines, x, dim_x - 2 );
+    conv_line_borders<TOut, pattern, use_mtx, use_avg_green>( ctx.opt, lines, dim_x );
+}
+
+}
+
+img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::get_transform_by16_to_dst_avx2( img::img_type dst, img::img_type src )
+{
+    if( !img::is_by16_fcc( src.fourcc_type() ) || dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( dst.dim.cx < 32 || dst.dim.cx % 2 != 0 || dst.dim.cy < 2 ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGRA64:   return &transform_by16_image<kernel_avx2, BGRA64>;
+    case img::fourcc::BGRFloat: return &transform_by16_image<kernel_avx2, BGRf>;
+    default:
+        return nullptr;
+    };
+}
+
+img_filter::transform_function_type     img_filter::transform::by_edge::get_transform_by16_to_dst_specialized_avx2( img::img_type dst, img::img_type src, bool use_avg_green )
+{
+    if( get_transform_by16_to_dst_avx2( dst, src ) == nullptr ) {
+        return nullptr;
+    }
+    return select_specialized_func<kernel_avx2>( dst, src, use_avg_green );
+}
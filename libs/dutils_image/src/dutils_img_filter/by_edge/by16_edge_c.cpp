@@ -0,0 +1,50 @@
+
+#include "by_edge.h"
+
+#include "by16_edge_internal.h"
+
+namespace
+{
+using namespace by16_edge_internal;
+
+struct kernel_c
+{
+    using context_type = options;
+
+    static context_type     make_context( const options& opt ) noexcept { return opt; }
+
+    template<class TOut, by_pattern pattern, bool use_mtx, bool use_avg_green>
+    static void     convert_line( const context_type& ctx, const line_data& lines, int dim_x )
+    {
+        conv_line_c<TOut, pattern, use_mtx, use_avg_green>( ctx, lines, 2, dim_x - 2 );
+        conv_line_borders<TOut, pattern, use_mtx, use_avg_green>( ctx, lines, dim_x );
+    }
+};
+
+}
+
+img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::get_transform_by16_to_dst_c( img::img_type dst, img::img_type src )
+{
+    if( !img::is_by16_fcc( src.fourcc_type() ) || dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( dst.dim.cx < 4 || dst.dim.cx % 2 != 0 || dst.dim.cy < 2 ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGRA64:   return &transform_by16_image<kernel_c, BGRA64>;
+    case img::fourcc::BGRFloat: return &transform_by16_image<kernel_c, BGRf>;
+    default:
+        return nullptr;
+    };
+}
+
+img_filter::transform_function_type     img_filter::transform::by_edge::get_transform_by16_to_dst_specialized_c( img::img_type dst, img::img_type src, bool use_avg_green )
+{
+    if( get_transform_by16_to_dst_c( dst, src ) == nullptr ) {
+        return nullptr;
+    }
+    return select_specialized_func<kernel_c>( dst, src, use_avg_green );
+}
@@ -0,0 +1,339 @@
+#pragma once
+
+#include "by_edge.h"
+
+#include <dutils_img/pixel_structs.h>
+#include <dutils_img/image_bayer_pattern.h>
+
+#include <type_traits>
+
+/*
+ * Edge sensing debayer of BY16 images to BGRA64 and BGRFloat.
+ *
+ * This is the algorithm of by8_edge_c.cpp, but all averages of 2 values are rounded, (a + b + 1) / 2,
+ * and averages of 4 values are the average of two such averages.
+ * This is what _mm256_avg_epu16 and vrhaddq_u16 calculate, so the SIMD variants return the same values as the C variant.
+ *
+ * BGRFloat is calculated from the 16-bit values, so both formats carry the same information.
+ */
+
+namespace by16_edge_internal
+{
+    using img::pixel_type::BGRA64;
+    using img::pixel_type::BGRf;
+
+    using namespace img::by_transform;
+    using namespace img::by_transform::by_pattern_alg;
+
+    using options = img_filter::transform::by_edge::options;
+
+    // 0x07 of the 8-bit variant
+    constexpr int avg_green_threshold = 0x07 << 8;
+
+    constexpr float float_scale = 1.f / 0xFFFF;
+
+    struct line_data
+    {
+        const uint16_t*     lines[3];   // { prv, cur, nxt }
+
+        void*               out_line;   // pointer to the out line, must be converted to the actual type
+    };
+
+    struct pixel
+    {
+        uint16_t r, g, b;
+    };
+
+    inline line_data init_src_param( int y, const img::img_descriptor& dst, const img::img_descriptor& src, int offset_prev, int offset_next ) noexcept
+    {
+        line_data line0 = { {
+                img::get_line_start<const uint16_t>( src, (y + offset_prev) ),
+                img::get_line_start<const uint16_t>( src, (y + 0) ),
+                img::get_line_start<const uint16_t>( src, (y + offset_next) ),
+            },
+            img::get_line_start( dst, y ),
+        };
+        return line0;
+    }
+
+    constexpr bool  is_red_line( by_pattern pat ) noexcept {
+        return pat == by_pattern::RG || pat == by_pattern::GR;
+    }
+    constexpr bool  is_green_pixel( by_pattern pat ) noexcept {
+        return pat == by_pattern::GR || pat == by_pattern::GB;
+    }
+
+    FORCEINLINE int     avg( int a, int b ) noexcept
+    {
+        return (a + b + 1) >> 1;
+    }
+
+    FORCEINLINE int     abs_diff( int a, int b ) noexcept
+    {
+        return a > b ? a - b : b - a;
+    }
+
+    FORCEINLINE int     calc_lr( const uint16_t* cur ) noexcept
+    {
+        return avg( cur[-1], cur[+1] );
+    }
+
+    FORCEINLINE int     calc_ob( const uint16_t* prv, const uint16_t* nxt ) noexcept
+    {
+        return avg( prv[0], nxt[0] );
+    }
+
+    FORCEINLINE int     calc_diagonal( const uint16_t* prv, const uint16_t* nxt ) noexcept
+    {
+        return avg( avg( prv[-1], prv[+1] ), avg( nxt[-1], nxt[+1] ) );
+    }
+
+    // green on a red or blue pixel
+    FORCEINLINE int     calc_edge_green( const uint16_t* prv, const uint16_t* cur, const uint16_t* nxt ) noexcept
+    {
+        const int lr = calc_lr( cur );
+        const int ob = calc_ob( prv, nxt );
+
+        const int dH = abs_diff( cur[-1], cur[+1] );
+        const int dV = abs_diff( prv[0], nxt[0] );
+        if( dH < dV ) {
+            return lr;
+        }
+        if( dH > dV ) {
+            return ob;
+        }
+        return avg( lr, ob );
+    }
+
+    // green on a green pixel, when use_avg_green is set
+    FORCEINLINE int     calc_avg_green( const uint16_t* prv, const uint16_t* cur, const uint16_t* nxt ) noexcept
+    {
+        const int dH = abs_diff( prv[-1], prv[+1] );
+        const int dV = abs_diff( prv[-1], nxt[-1] );
+        if( dH < avg_green_threshold && dV < avg_green_threshold ) {
+            return avg( calc_diagonal( prv, nxt ), cur[0] );
+        }
+        return cur[0];
+    }
+
+    template<by_pattern pattern, bool use_avg_green>
+    FORCEINLINE pixel   conv_pixel( const line_data& lines, int x ) noexcept
+    {
+        const uint16_t* prv = lines.lines[0] + x;
+        const uint16_t* cur = lines.lines[1] + x;
+        const uint16_t* nxt = lines.lines[2] + x;
+
+        int x_chn, y_chn, g_chn;    // x_chn is the color of the line, y_chn the other one
+        if constexpr( is_green_pixel( pattern ) )
+        {
+            x_chn = calc_lr( cur );
+            y_chn = calc_ob( prv, nxt );
+            if constexpr( use_avg_green ) {
+                g_chn = calc_avg_green( prv, cur, nxt );
+            } else {
+                g_chn = cur[0];
+            }
+        }
+        else
+        {
+            x_chn = cur[0];
+            y_chn = calc_diagonal( prv, nxt );
+            g_chn = calc_edge_green( prv, cur, nxt );
+        }
+
+        if constexpr( is_red_line( pattern ) ) {
+            return pixel{ static_cast<uint16_t>(x_chn), static_cast<uint16_t>(g_chn), static_cast<uint16_t>(y_chn) };
+        } else {
+            return pixel{ static_cast<uint16_t>(y_chn), static_cast<uint16_t>(g_chn), static_cast<uint16_t>(x_chn) };
+        }
+    }
+
+    FORCEINLINE pixel   apply_color_matrix( const img::color_matrix_int& clr, pixel str ) noexcept
+    {
+        int r = ((int)str.r * clr.r_rfac + (int)str.g * clr.r_gfac + (int)str.b * clr.r_bfac) >> 6;
+        int g = ((int)str.r * clr.g_rfac + (int)str.g * clr.g_gfac + (int)str.b * clr.g_bfac) >> 6;
+        int b = ((int)str.r * clr.b_rfac + (int)str.g * clr.b_gfac + (int)str.b * clr.b_bfac) >> 6;
+
+        r = CLIP( r, 0, 0xFFFF );
+        g = CLIP( g, 0, 0xFFFF );
+        b = CLIP( b, 0, 0xFFFF );
+
+        return pixel{ static_cast<uint16_t>(r), static_cast<uint16_t>(g), static_cast<uint16_t>(b) };
+    }
+
+    template<class TOut>
+    void    store( void* out_line, int x, pixel val ) noexcept = delete;
+
+    template<>
+    FORCEINLINE void    store<BGRA64>( void* out_line, int x, pixel val ) noexcept
+    {
+        static_cast<BGRA64*>(out_line)[x] = BGRA64{ val.b, val.g, val.r, 0xFFFF };
+    }
+
+    template<>
+    FORCEINLINE void    store<BGRf>( void* out_line, int x, pixel val ) noexcept
+    {
+        static_cast<BGRf*>(out_line)[x] = BGRf{ val.b * float_scale, val.g * float_scale, val.r * float_scale };
+    }
+
+    template<by_pattern pattern, bool use_mtx, bool use_avg_green>
+    FORCEINLINE pixel   conv_pixel_with_clr( const options& opt, const line_data& lines, int x ) noexcept
+    {
+        const auto res = conv_pixel<pattern, use_avg_green>( lines, x );
+        if constexpr( use_mtx ) {
+            return apply_color_matrix( opt.color_mtx, res );
+        } else {
+            return res;
+        }
+    }
+
+    // Converts the pixels [x;x_end[, x must be even
+    template<class TOut, by_pattern pattern, bool use_mtx, bool use_avg_green>
+    FORCEINLINE void    conv_line_c( const options& opt, const line_data& lines, int x, int x_end ) noexcept
+    {
+        constexpr auto nxt_pattern = next_pixel( pattern );
+
+        for( ; x < x_end; x += 2 )
+        {
+            store<TOut>( lines.out_line, x + 0, conv_pixel_with_clr<pattern, use_mtx, use_avg_green>( opt, lines, x + 0 ) );
+            store<TOut>( lines.out_line, x + 1, conv_pixel_with_clr<nxt_pattern, use_mtx, use_avg_green>( opt, lines, x + 1 ) );
+        }
+    }
+
+    // The first and the last 2 pixels get the value of the inner one, like in the 8-bit variants
+    template<class TOut, by_pattern pattern, bool use_mtx, bool use_avg_green>
+    FORCEINLINE void    conv_line_borders( const options& opt, const line_data& lines, int dim_x ) noexcept
+    {
+        constexpr auto nxt_pattern = next_pixel( pattern );
+
+        const auto first = conv_pixel_with_clr<nxt_pattern, use_mtx, use_avg_green>( opt, lines, 1 );
+        store<TOut>( lines.out_line, 0, first );
+        store<TOut>( lines.out_line, 1, first );
+
+        const auto last = conv_pixel_with_clr<pattern, use_mtx, use_avg_green>( opt, lines, dim_x - 2 );
+        store<TOut>( lines.out_line, dim_x - 2, last );
+        store<TOut>( lines.out_line, dim_x - 1, last );
+    }
+
+    /* TKernel must provide:
+     *  context_type make_context( const options& )
+     *  template<class TOut, by_pattern pattern, bool use_mtx, bool use_avg_green>
+     *  void convert_line( const context_type& ctx, const line_data& lines, int dim_x )
+     *
+     * pattern is the pattern of the first pixel in the line.
+     * pattern_cur is the pattern of the first line, so the line functions are resolved at compile time.
+     */
+    template<class TKernel, class TOut, by_pattern pattern_cur, bool use_mtx, bool use_avg_green>
+    void    by16_edge_image_loop( const img::img_descriptor& dst, const img::img_descriptor& src, const typename TKernel::context_type& ctx )
+    {
+        constexpr auto pattern_nxt = next_line( pattern_cur );
+
+        const auto conv = [&ctx, dim_x = src.dim.cx]( auto line_pattern, const line_data& lines )
+        {
+            TKernel::template convert_line<TOut, decltype( line_pattern )::value, use_mtx, use_avg_green>( ctx, lines, dim_x );
+        };
+        using cur_tag = std::integral_constant<by_pattern, pattern_cur>;
+        using nxt_tag = std::integral_constant<by_pattern, pattern_nxt>;
+
+        const int dim_y = src.dim.cy;
+
+        const int offset_first = (src.flags & img::img_descriptor::flags_no_wrap_beg) ? -1 : +1;
+        conv( cur_tag{}, init_src_param( 0, dst, src, offset_first, +1 ) );
+
+        int y = 1;
+        for( ; y < (dim_y - 2); y += 2 )
+        {
+            conv( nxt_tag{}, init_src_param( y + 0, dst, src, -1, +1 ) );
+            conv( cur_tag{}, init_src_param( y + 1, dst, src, -1, +1 ) );
+        }
+        if( y < (dim_y - 1) )   // odd height
+        {
+            conv( nxt_tag{}, init_src_param( y, dst, src, -1, +1 ) );
+            ++y;
+        }
+
+        const int offset_last = (src.flags & img::img_descriptor::flags_no_wrap_end) ? +1 : -1;
+        if( y % 2 ) {
+            conv( nxt_tag{}, init_src_param( y, dst, src, -1, offset_last ) );
+        } else {
+            conv( cur_tag{}, init_src_param( y, dst, src, -1, offset_last ) );
+        }
+    }
+
+    // BGRFloat is top down
+    inline img::img_descriptor  flip_dst_if_bottom_up( const img::img_descriptor& dst ) noexcept
+    {
+        return img::is_bottom_up_fcc( dst.fourcc_type() ) ? img::flip_image_in_img_desc_if_allowed( dst ) : dst;
+    }
+
+    template<class TKernel, class TOut, bool use_mtx, bool use_avg_green>
+    auto    select_image_loop( by_pattern pattern ) noexcept
+        -> void (*)( const img::img_descriptor&, const img::img_descriptor&, const typename TKernel::context_type& )
+    {
+        switch( pattern )
+        {
+        case by_pattern::BG:    return &by16_edge_image_loop<TKernel, TOut, by_pattern::BG, use_mtx, use_avg_green>;
+        case by_pattern::GB:    return &by16_edge_image_loop<TKernel, TOut, by_pattern::GB, use_mtx, use_avg_green>;
+        case by_pattern::GR:    return &by16_edge_image_loop<TKernel, TOut, by_pattern::GR, use_mtx, use_avg_green>;
+        case by_pattern::RG:    return &by16_edge_image_loop<TKernel, TOut, by_pattern::RG, use_mtx, use_avg_green>;
+        };
+        return nullptr;
+    }
+
+    // The function_type of get_transform_by16_to_dst_*, the pattern and the options are resolved once per image
+    template<class TKernel, class TOut>
+    void    transform_by16_image( img::img_descriptor dst, img::img_descriptor src, const options& opt )
+    {
+        const auto pattern = img::by_transform::convert_bayer_fcc_to_pattern( src.fourcc_type() );
+
+        decltype( select_image_loop<TKernel, TOut, false, false>( pattern ) ) func = nullptr;
+        if( opt.use_color_matrix ) {
+            func = opt.use_avg_green ? select_image_loop<TKernel, TOut, true, true>( pattern ) : select_image_loop<TKernel, TOut, true, false>( pattern );
+        } else {
+            func = opt.use_avg_green ? select_image_loop<TKernel, TOut, false, true>( pattern ) : select_image_loop<TKernel, TOut, false, false>( pattern );
+        }
+        func( flip_dst_if_bottom_up( dst ), src, TKernel::make_context( opt ) );
+    }
+
+    // The transform_function_type of get_transform_by16_to_dst_specialized_*
+    template<class TKernel, class TOut, by_pattern pattern, bool use_avg_green>
+    void    transform_by16_image_specialized( img::img_descriptor dst, img::img_descriptor src )
+    {
+        static const options opt = { {}, false, use_avg_green };
+
+        by16_edge_image_loop<TKernel, TOut, pattern, false, use_avg_green>( flip_dst_if_bottom_up( dst ), src, TKernel::make_context( opt ) );
+    }
+
+    template<class TKernel, class TOut, bool use_avg_green>
+    img_filter::transform_function_type     select_specialized_func_( by_pattern pattern ) noexcept
+    {
+        switch( pattern )
+        {
+        case by_pattern::BG:    return &transform_by16_image_specialized<TKernel, TOut, by_pattern::BG, use_avg_green>;
+        case by_pattern::GB:    return &transform_by16_image_specialized<TKernel, TOut, by_pattern::GB, use_avg_green>;
+        case by_pattern::GR:    return &transform_by16_image_specialized<TKernel, TOut, by_pattern::GR, use_avg_green>;
+        case by_pattern::RG:    return &transform_by16_image_specialized<TKernel, TOut, by_pattern::RG, use_avg_green>;
+        };
+        return nullptr;
+    }
+
+    template<class TKernel>
+    img_filter::transform_function_type     select_specialized_func( img::img_type dst, img::img_type src, bool use_avg_green ) noexcept
+    {
+        const auto pattern = img::by_transform::convert_bayer_fcc_to_pattern( src.fourcc_type() );
+        switch( dst.fourcc_type() )
+        {
+        case img::fourcc::BGRA64:
+            return use_avg_green ? select_specialized_func_<TKernel, BGRA64, true>( pattern ) : select_specialized_func_<TKernel, BGRA64, false>( pattern );
+        case img::fourcc::BGRFloat:
+            return use_avg_green ? select_specialized_func_<TKernel, BGRf, true>( pattern ) : select_specialized_func_<TKernel, BGRf, false>( pattern );
+        default:
+            return nullptr;
+        };
+    }
+
+    inline bool     is_accepted_by16_dst( img::fourcc fcc ) noexcept
+    {
+        return fcc == img::fourcc::BGRA64 || fcc == img::fourcc::BGRFloat;
+    }
+}
@@ -0,0 +1,203 @@
+#include "by_edge.h"
+#include "by16_edge_internal.h"
+
+#include "../simd_helper/use_simd_A64.h"
+
+/*
+ * NEON variant of by16_edge_c.cpp, see by16_edge_avx2.cpp for the layout of the calculations.
+ *
+ * 8 pixels are calculated per block.
+ */
+
+namespace
+{
+    using namespace by16_edge_internal;
+
+// odd 16-bit entries set
+FORCEINLINE uint16x8_t      mask_odd()
+{
+    return vreinterpretq_u16_u32( vdupq_n_u32( 0xFFFF0000 ) );
+}
+
+// takes the even entries from a and the odd ones from b
+FORCEINLINE uint16x8_t      blend_odd( uint16x8_t a, uint16x8_t b )
+{
+    return vbslq_u16( mask_odd(), b, a );
+}
+
+FORCEINLINE uint16x8_t      calc_edge_green( uint16x8_t cur_l, uint16x8_t cur_r, uint16x8_t prv, uint16x8_t nxt, uint16x8_t lr, uint16x8_t ob )
+{
+    auto dif_lr = vabdq_u16( cur_l, cur_r );
+    auto dif_ab = vabdq_u16( prv, nxt );
+
+    auto tmp0 = vbslq_u16( vcltq_u16( dif_lr, dif_ab ), lr, ob );
+    return vbslq_u16( vceqq_u16( dif_lr, dif_ab ), vrhaddq_u16( lr, ob ), tmp0 );
+}
+
+FORCEINLINE uint16x8_t      calc_avg_green( uint16x8_t prv_l, uint16x8_t prv_r, uint16x8_t nxt_l, uint16x8_t diagonal, uint16x8_t cur )
+{
+    const auto threshold = vdupq_n_u16( avg_green_threshold );
+
+    auto dif_lr = vabdq_u16( prv_l, prv_r );
+    auto dif_ab = vabdq_u16( prv_l, nxt_l );
+
+    auto cond = vandq_u16( vcltq_u16( dif_lr, threshold ), vcltq_u16( dif_ab, threshold ) );
+
+    return vbslq_u16( cond, vrhaddq_u16( diagonal, cur ), cur );
+}
+
+struct kernel_neon
+{
+    using context_type = options;
+
+    static context_type     make_context( const options& opt ) noexcept { return opt; }
+
+    template<class TOut, by_pattern pattern, bool use_mtx, bool use_avg_green>
+    static void     convert_line( const context_type& ctx, const line_data& lines, int dim_x );
+};
+
+template<int base_index>
+FORCEINLINE uint16x4_t      apply_color_matrix_chn( const img::color_matrix_int& mtx, int32x4_t r, int32x4_t g, int32x4_t b )
+{
+    auto sum = vmulq_n_s32( r, mtx.fac[base_index + 0] );
+    sum = vmlaq_n_s32( sum, g, mtx.fac[base_index + 1] );
+    sum = vmlaq_n_s32( sum, b, mtx.fac[base_index + 2] );
+
+    return vqmovun_s32( vshrq_n_s32( sum, 6 ) );    // saturates to [0;0xFFFF]
+}
+
+FORCEINLINE int32x4_t       to_s32( uint16x4_t v )
+{
+    return vreinterpretq_s32_u32( vmovl_u16( v ) );
+}
+
+FORCEINLINE void    apply_color_matrix( const img::color_matrix_int& mtx, uint16x8_t& r, uint16x8_t& g, uint16x8_t& b )
+{
+    const int32x4_t r32[2] = { to_s32( vget_low_u16( r ) ), to_s32( vget_high_u16( r ) ) };
+    const int32x4_t g32[2] = { to_s32( vget_low_u16( g ) ), to_s32( vget_high_u16( g ) ) };
+    const int32x4_t b32[2] = { to_s32( vget_low_u16( b ) ), to_s32( vget_high_u16( b ) ) };
+
+    r = vcombine_u16( apply_color_matrix_chn<0>( mtx, r32[0], g32[0], b32[0] ), apply_color_matrix_chn<0>( mtx, r32[1], g32[1], b32[1] ) );
+    g = vcombine_u16( apply_color_matrix_chn<3>( mtx, r32[0], g32[0], b32[0] ), apply_color_matrix_chn<3>( mtx, r32[1], g32[1], b32[1] ) );
+    b = vcombine_u16( apply_color_matrix_chn<6>( mtx, r32[0], g32[0], b32[0] ), apply_color_matrix_chn<6>( mtx, r32[1], g32[1], b32[1] ) );
+}
+
+template<class TOut>
+void    store_block( void* out_line, int x, uint16x8_t r, uint16x8_t g, uint16x8_t b ) = delete;
+
+template<>
+FORCEINLINE void    store_block<BGRA64>( void* out_line, int x, uint16x8_t r, uint16x8_t g, uint16x8_t b )
+{
+    const uint16x8x4_t res = { { b, g, r, vdupq_n_u16( 0xFFFF ) } };
+    vst4q_u16( reinterpret_cast<uint16_t*>(static_cast<BGRA64*>(out_line) + x), res );
+}
+
+FORCEINLINE float32x4_t     to_float( uint16x4_t v )
+{
+    return vmulq_n_f32( vcvtq_f32_u32( vmovl_u16( v ) ), float_scale );
+}
+
+template<>
+FORCEINLINE void    store_block<BGRf>( void* out_line, int x, uint16x8_t r, uint16x8_t g, uint16x8_t b )
+{
+    auto* p_out = reinterpret_cast<float*>(static_cast<BGRf*>(out_line) + x);
+
+    const float32x4x3_t lo = { { to_float( vget_low_u16( b ) ), to_float( vget_low_u16( g ) ), to_float( vget_low_u16( r ) ) } };
+    const float32x4x3_t hi = { { to_float( vget_high_u16( b ) ), to_float( vget_high_u16( g ) ), to_float( vget_high_u16( r ) ) } };
+    vst3q_f32( p_out + 0, lo );
+    vst3q_f32( p_out + 12, hi );
+}
+
+// pixel [x;x + 8[, reads [x - 1;x + 9[
+template<class TOut, by_pattern pattern, bool use_mtx, bool use_avg_green>
+FORCEINLINE void    conv_block( const options& opt, const line_data& lines, int x )
+{
+    const auto prv_l = vld1q_u16( lines.lines[0] + x - 1 );
+    const auto prv_c = vld1q_u16( lines.lines[0] + x + 0 );
+    const auto prv_r = vld1q_u16( lines.lines[0] + x + 1 );
+    const auto cur_l = vld1q_u16( lines.lines[1] + x - 1 );
+    const auto cur_c = vld1q_u16( lines.lines[1] + x + 0 );
+    const auto cur_r = vld1q_u16( lines.lines[1] + x + 1 );
+    const auto nxt_l = vld1q_u16( lines.lines[2] + x - 1 );
+    const auto nxt_c = vld1q_u16( lines.lines[2] + x + 0 );
+    const auto nxt_r = vld1q_u16( lines.lines[2] + x + 1 );
+
+    const auto lr = vrhaddq_u16( cur_l, cur_r );
+    const auto ob = vrhaddq_u16( prv_c, nxt_c );
+    const auto diagonal = vrhaddq_u16( vrhaddq_u16( prv_l, prv_r ), vrhaddq_u16( nxt_l, nxt_r ) );
+
+    const auto g_on_xy = calc_edge_green( cur_l, cur_r, prv_c, nxt_c, lr, ob );
+    uint16x8_t g_on_g;
+    if constexpr( use_avg_green ) {
+        g_on_g = calc_avg_green( prv_l, prv_r, nxt_l, diagonal, cur_c );
+    } else {
+        g_on_g = cur_c;
+    }
+
+    // x_chn is the color of the line, y_chn the other one
+    uint16x8_t x_chn, y_chn, g_chn;
+    if constexpr( is_green_pixel( pattern ) ) {
+        x_chn = blend_odd( lr, cur_c );
+        y_chn = blend_odd( ob, diagonal );
+        g_chn = blend_odd( g_on_g, g_on_xy );
+    } else {
+        x_chn = blend_odd( cur_c, lr );
+        y_chn = blend_odd( diagonal, ob );
+        g_chn = blend_odd( g_on_xy, g_on_g );
+    }
+
+    uint16x8_t r, b;
+    if constexpr( is_red_line( pattern ) ) {
+        r = x_chn;
+        b = y_chn;
+    } else {
+        r = y_chn;
+        b = x_chn;
+    }
+
+    if constexpr( use_mtx ) {
+        apply_color_matrix( opt.color_mtx, r, g_chn, b );
+    }
+
+    store_block<TOut>( lines.out_line, x, r, g_chn, b );
+}
+
+template<class TOut, by_pattern pattern, bool use_mtx, bool use_avg_green>
+void    kernel_neon::convert_line( const context_type& ctx, const line_data& lines, int dim_x )
+{
+    int x = 2;
+    for( ; x <= (dim_x - 10); x += 8 )
+    {
+        conv_block<TOut, pattern, use_mtx, use_avg_green>( ctx, lines, x );
+    }
+    conv_line_c<TOut, pattern, use_mtx, use_avg_green>( ctx, lines, x, dim_x - 2 );
+    conv_line_borders<TOut, pattern, use_mtx, use_avg_green>( ctx, lines, dim_x );
+}
+
+}
+
+img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::get_transform_by16_to_dst_neon( img::img_type dst, img::img_type src )
+{
+    if( !img::is_by16_fcc( src.fourcc_type() ) || dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( dst.dim.cx < 16 || dst.dim.cx % 2 != 0 || dst.dim.cy < 2 ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGRA64:   return &transform_by16_image<kernel_neon, BGRA64>;
+    case img::fourcc::BGRFloat: return &transform_by16_image<kernel_neon, BGRf>;
+    default:
+        return nullptr;
+    };
+}
+
+img_filter::transform_function_type     img_filter::transform::by_edge::get_transform_by16_to_dst_specialized_neon( img::img_type dst, img::img_type src, bool use_avg_green )
+{
+    if( get_transform_by16_to_dst_neon( dst, src ) == nullptr ) {
+        return nullptr;
+    }
+    return select_specialized_func<kernel_neon>( dst, src, use_avg_green );
+}
@@ -0,0 +1,238 @@
+#include "by_edge.h"
+#include "by16_edge_internal.h"
+
+/*
+ * SVE2 variant of by16_edge_c.cpp, see by16_edge_avx2.cpp for the layout of the calculations.
+ *
+ * One vector length of pixels is calculated per block. The last block of a line is predicated, so the whole
+ * inner part of the line is done by the vector code and does not need the C line function.
+ * Every block starts on an even pixel, so the odd lanes hold the pixels with the next pattern.
+ *
+ * Without SVE2 support in the compiler the get functions return nullptr.
+ */
+
+#if defined __ARM_FEATURE_SVE2
+
+#include "../simd_helper/use_simd_sve2.h"
+
+namespace
+{
+    using namespace by16_edge_internal;
+
+// odd 16-bit lanes set
+FORCEINLINE svbool_t        mask_odd( svbool_t pg )
+{
+    return svcmpne_n_u16( pg, svand_n_u16_x( pg, svindex_u16( 0, 1 ), 1 ), 0 );
+}
+
+// takes the even entries from a and the odd ones from b
+FORCEINLINE svuint16_t      blend_odd( svbool_t odd, svuint16_t a, svuint16_t b )
+{
+    return svsel_u16( odd, b, a );
+}
+
+FORCEINLINE svuint16_t      calc_edge_green( svbool_t pg, svuint16_t cur_l, svuint16_t cur_r, svuint16_t prv, svuint16_t nxt, svuint16_t lr, svuint16_t ob )
+{
+    const auto dif_lr = svabd_u16_x( pg, cur_l, cur_r );
+    const auto dif_ab = svabd_u16_x( pg, prv, nxt );
+
+    const auto tmp0 = svsel_u16( svcmplt_u16( pg, dif_lr, dif_ab ), lr, ob );
+    return svsel_u16( svcmpeq_u16( pg, dif_lr, dif_ab ), svrhadd_u16_x( pg, lr, ob ), tmp0 );
+}
+
+FORCEINLINE svuint16_t      calc_avg_green( svbool_t pg, svuint16_t prv_l, svuint16_t prv_r, svuint16_t nxt_l, svuint16_t diagonal, svuint16_t cur )
+{
+    const auto dif_lr = svabd_u16_x( pg, prv_l, prv_r );
+    const auto dif_ab = svabd_u16_x( pg, prv_l, nxt_l );
+
+    const auto cond = svand_b_z( pg, svcmplt_n_u16( pg, dif_lr, avg_green_threshold ), svcmplt_n_u16( pg, dif_ab, avg_green_threshold ) );
+
+    return svsel_u16( cond, svrhadd_u16_x( pg, diagonal, cur ), cur );
+}
+
+struct kernel_sve2
+{
+    using context_type = options;
+
+    static context_type     make_context( const options& opt ) noexcept { return opt; }
+
+    template<class TOut, by_pattern pattern, bool use_mtx, bool use_avg_green>
+    static void     convert_line( const context_type& ctx, const line_data& lines, int dim_x );
+};
+
+// even and odd lanes are calculated separately and interleaved again by the narrowing
+template<int base_index>
+FORCEINLINE svint32_t       apply_color_matrix_chn( const img::color_matrix_int& mtx, svint32_t r, svint32_t g, svint32_t b )
+{
+    const svbool_t all = svptrue_b32();
+
+    auto sum = svmul_n_s32_x( all, r, mtx.fac[base_index + 0] );
+    sum = svmla_n_s32_x( all, sum, g, mtx.fac[base_index + 1] );
+    sum = svmla_n_s32_x( all, sum, b, mtx.fac[base_index + 2] );
+
+    return svasr_n_s32_x( all, sum, 6 );
+}
+
+FORCEINLINE svuint16_t      narrow_sat( svint32_t even, svint32_t odd )
+{
+    return svqxtunt_s32( svqxtunb_s32( even ), odd );      // saturates to [0;0xFFFF]
+}
+
+FORCEINLINE svint32_t       to_s32_even( svuint16_t v )
+{
+    return svreinterpret_s32_u32( svmovlb_u32( v ) );
+}
+
+FORCEINLINE svint32_t       to_s32_odd( svuint16_t v )
+{
+    return svreinterpret_s32_u32( svmovlt_u32( v ) );
+}
+
+FORCEINLINE void    apply_color_matrix( const img::color_matrix_int& mtx, svuint16_t& r, svuint16_t& g, svuint16_t& b )
+{
+    const svint32_t r32[2] = { to_s32_even( r ), to_s32_odd( r ) };
+    const svint32_t g32[2] = { to_s32_even( g ), to_s32_odd( g ) };
+    const svint32_t b32[2] = { to_s32_even( b ), to_s32_odd( b ) };
+
+    r = narrow_sat( apply_color_matrix_chn<0>( mtx, r32[0], g32[0], b32[0] ), apply_color_matrix_chn<0>( mtx, r32[1], g32[1], b32[1] ) );
+    g = narrow_sat( apply_color_matrix_chn<3>( mtx, r32[0], g32[0], b32[0] ), apply_color_matrix_chn<3>( mtx, r32[1], g32[1], b32[1] ) );
+    b = narrow_sat( apply_color_matrix_chn<6>( mtx, r32[0], g32[0], b32[0] ), apply_color_matrix_chn<6>( mtx, r32[1], g32[1], b32[1] ) );
+}
+
+// pixels [x;x_end[ of the block, pg is svwhilelt_b16( x, x_end )
+template<class TOut>
+void    store_block( svbool_t pg, void* out_line, int x, int x_end, svuint16_t r, svuint16_t g, svuint16_t b ) = delete;
+
+template<>
+FORCEINLINE void    store_block<BGRA64>( svbool_t pg, void* out_line, int x, int /*x_end*/, svuint16_t r, svuint16_t g, svuint16_t b )
+{
+    svst4_u16( pg, reinterpret_cast<uint16_t*>(static_cast<BGRA64*>(out_line) + x), svcreate4_u16( b, g, r, svdup_n_u16( 0xFFFF ) ) );
+}
+
+FORCEINLINE svfloat32_t     to_float( svuint32_t v )
+{
+    const svbool_t all = svptrue_b32();
+    return svmul_n_f32_x( all, svcvt_f32_u32_x( all, v ), float_scale );
+}
+
+template<>
+FORCEINLINE void    store_block<BGRf>( svbool_t /*pg*/, void* out_line, int x, int x_end, svuint16_t r, svuint16_t g, svuint16_t b )
+{
+    const int x_hi = x + static_cast<int>( svcntw() );
+
+    auto* p_out = reinterpret_cast<float*>(static_cast<BGRf*>(out_line));
+
+    svst3_f32( svwhilelt_b32( x, x_end ), p_out + x * 3,
+        svcreate3_f32( to_float( svunpklo_u32( b ) ), to_float( svunpklo_u32( g ) ), to_float( svunpklo_u32( r ) ) ) );
+    svst3_f32( svwhilelt_b32( x_hi, x_end ), p_out + x_hi * 3,
+        svcreate3_f32( to_float( svunpkhi_u32( b ) ), to_float( svunpkhi_u32( g ) ), to_float( svunpkhi_u32( r ) ) ) );
+}
+
+// pixels [x;x_end[, reads [x - 1;x_end + 1[
+template<class TOut, by_pattern pattern, bool use_mtx, bool use_avg_green>
+FORCEINLINE void    conv_block( const options& opt, const line_data& lines, int x, int x_end )
+{
+    const svbool_t pg = svwhilelt_b16( x, x_end );
+
+    const auto prv_l = svld1_u16( pg, lines.lines[0] + x - 1 );
+    const auto prv_c = svld1_u16( pg, lines.lines[0] + x + 0 );
+    const auto prv_r = svld1_u16( pg, lines.lines[0] + x + 1 );
+    const auto cur_l = svld1_u16( pg, lines.lines[1] + x - 1 );
+    const auto cur_c = svld1_u16( pg, lines.lines[1] + x + 0 );
+    const auto cur_r = svld1_u16( pg, lines.lines[1] + x + 1 );
+    const auto nxt_l = svld1_u16( pg, lines.lines[2] + x - 1 );
+    const auto nxt_c = svld1_u16( pg, lines.lines[2] + x + 0 );
+    const auto nxt_r = svld1_u16( pg, lines.lines[2] + x + 1 );
+
+    const auto lr = svrhadd_u16_x( pg, cur_l, cur_r );
+    const auto ob = svrhadd_u16_x( pg, prv_c, nxt_c );
+    const auto diagonal = svrhadd_u16_x( pg, svrhadd_u16_x( pg, prv_l, prv_r ), svrhadd_u16_x( pg, nxt_l, nxt_r ) );
+
+    const auto g_on_xy = calc_edge_green( pg, cur_l, cur_r, prv_c, nxt_c, lr, ob );
+    svuint16_t g_on_g;
+    if constexpr( use_avg_green ) {
+        g_on_g = calc_avg_green( pg, prv_l, prv_r, nxt_l, diagonal, cur_c );
+    } else {
+        g_on_g = cur_c;
+    }
+
+    const svbool_t odd = mask_odd( pg );
+
+    // x_chn is the color of the line, y_chn the other one
+    svuint16_t x_chn, y_chn, g_chn;
+    if constexpr( is_green_pixel( pattern ) ) {
+        x_chn = blend_odd( odd, lr, cur_c );
+        y_chn = blend_odd( odd, ob, diagonal );
+        g_chn = blend_odd( odd, g_on_g, g_on_xy );
+    } else {
+        x_chn = blend_odd( odd, cur_c, lr );
+        y_chn = blend_odd( odd, diagonal, ob );
+        g_chn = blend_odd( odd, g_on_xy, g_on_g );
+    }
+
+    svuint16_t r, b;
+    if constexpr( is_red_line( pattern ) ) {
+        r = x_chn;
+        b = y_chn;
+    } else {
+        r = y_chn;
+        b = x_chn;
+    }
+
+    if constexpr( use_mtx ) {
+        apply_color_matrix( opt.color_mtx, r, g_chn, b );
+    }
+
+    store_block<TOut>( pg, lines.out_line, x, x_end, r, g_chn, b );
+}
+
+template<class TOut, by_pattern pattern, bool use_mtx, bool use_avg_green>
+void    kernel_sve2::convert_line( const context_type& ctx, const line_data& lines, int dim_x )
+{
+    const int step = static_cast<int>( svcnth() );
+    const int x_end = dim_x - 2;
+
+    for( int x = 2; x < x_end; x += step )
+    {
+        conv_block<TOut, pattern, use_mtx, use_avg_green>( ctx, lines, x, x_end );
+    }
+    conv_line_borders<TOut, pattern, use_mtx, use_avg_green>( ctx, lines, dim_x );
+}
+
+}
+
+#endif
+
+img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::get_transform_by16_to_dst_sve2( [[maybe_unused]] img::img_type dst, [[maybe_unused]] img::img_type src )
+{
+#if defined __ARM_FEATURE_SVE2
+    if( !img::is_by16_fcc( src.fourcc_type() ) || dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( dst.dim.cx < 16 || dst.dim.cx % 2 != 0 || dst.dim.cy < 2 ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGRA64:   return &transform_by16_image<kernel_sve2, BGRA64>;
+    case img::fourcc::BGRFloat: return &transform_by16_image<kernel_sve2, BGRf>;
+    default:
+        return nullptr;
+    };
+#else
+    return nullptr;
+#endif
+}
+
+img_filter::transform_function_type     img_filter::transform::by_edge::get_transform_by16_to_dst_specialized_sve2( [[maybe_unused]] img::img_type dst, [[maybe_unused]] img::img_type src, [[maybe_unused]] bool use_avg_green )
+{
+#if defined __ARM_FEATURE_SVE2
+    if( get_transform_by16_to_dst_sve2( dst, src ) == nullptr ) {
+        return nullptr;
+    }
+    return select_specialized_func<kernel_sve2>( dst, src, use_avg_green );
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,424 @@
+
+#include "by_edge.h"
+#include "by_edge_internal.h"
+
+#include "../simd_helper/use_simd_avx2.h"
+
+#include "../../dutils_img_base/alignment_helper.h"
+
+
+#include <cstring>
+
+/*
+ * AVX2 port of by8_edge_sse4_1_v0.cpp
+ *
+ * All calculations work on neighbouring pixels of the same 128-bit lane, so they map 1:1 to
+ * the 256-bit instructions. The only lane crossing parts are the loads of the left/right neighbours,
+ * which are done as unaligned loads instead of _mm_alignr_epi8, and the final interleave to BGRA32.
+ */
+
+namespace
+{
+    using namespace by_edge_internal;
+    using namespace img::by_transform::by_pattern_alg;
+
+    struct alg_context_avx2
+    {
+        __m256i         clr_mtx[9];
+
+        bool use_color_matrix;
+        bool use_avg_green;
+    };
+
+    using alg_context = alg_context_avx2;
+
+
+FORCEINLINE __m256i     load_u( const uint8_t* p )
+{
+    return _mm256_loadu_si256( reinterpret_cast<const __m256i*>(p) );
+}
+
+FORCEINLINE __m256i     mask_0x00FF()
+{
+    return _mm256_set1_epi16( 0x00FF );
+}
+
+FORCEINLINE __m256i     mask_0xFF00()
+{
+    return _mm256_set1_epi16( static_cast<short>(0xFF00) );
+}
+
+// epu8[0] = 0, epu8[x] = v[x - 1] for x in [1;32[
+FORCEINLINE __m256i     shift_in_zero_byte( __m256i v )
+{
+    const auto lo_in_hi = _mm256_permute2x128_si256( v, v, 0x08 );    // [0, v.lo]
+    return _mm256_alignr_epi8( v, lo_in_hi, 15 );
+}
+
+template<bool use_nt_stores>
+FORCEINLINE void    store_bgra32( const line_data& lines, int x, __m256i r, __m256i g, __m256i b )
+{
+    const auto full_ff = _mm256_set1_epi8( -1 );
+
+    const auto bg_lo = _mm256_unpacklo_epi8( b, g );       // lane0 = pixel [0;8[, lane1 = pixel [16;24[
+    const auto bg_hi = _mm256_unpackhi_epi8( b, g );       // lane0 = pixel [8;16[, lane1 = pixel [24;32[
+    const auto rf_lo = _mm256_unpacklo_epi8( r, full_ff );
+    const auto rf_hi = _mm256_unpackhi_epi8( r, full_ff );
+
+    const auto p0 = _mm256_unpacklo_epi16( bg_lo, rf_lo );  // pixel [0;4[ and [16;20[
+    const auto p1 = _mm256_unpackhi_epi16( bg_lo, rf_lo );  // pixel [4;8[ and [20;24[
+    const auto p2 = _mm256_unpacklo_epi16( bg_hi, rf_hi );  // pixel [8;12[ and [24;28[
+    const auto p3 = _mm256_unpackhi_epi16( bg_hi, rf_hi );  // pixel [12;16[ and [28;32[
+
+    const __m256i res[4] = {
+        _mm256_permute2x128_si256( p0, p1, 0x20 ),
+        _mm256_permute2x128_si256( p2, p3, 0x20 ),
+        _mm256_permute2x128_si256( p0, p1, 0x31 ),
+        _mm256_permute2x128_si256( p2, p3, 0x31 ),
+    };
+
+    auto* p_out = reinterpret_cast<__m256i*>(reinterpret_cast<BGRA32*>(lines.out_line) + x);
+    for( int i = 0; i < 4; ++i )
+    {
+        if constexpr( use_nt_stores ) {
+            _mm256_stream_si256( p_out + i, res[i] );
+        } else {
+            _mm256_storeu_si256( p_out + i, res[i] );
+        }
+    }
+}
+
+
+template<int base_index>
+FORCEINLINE __m256i     apply_color_matrix_chn_epu16( const alg_context& ctx, __m256i r, __m256i g, __m256i b )
+{
+    auto t0 = _mm256_mullo_epi16( r, ctx.clr_mtx[base_index + 0] );
+    auto t1 = _mm256_mullo_epi16( g, ctx.clr_mtx[base_index + 1] );
+    auto t2 = _mm256_mullo_epi16( b, ctx.clr_mtx[base_index + 2] );
+
+    auto sum = _mm256_add_epi16( _mm256_add_epi16( t0, t1 ), t2 );
+    auto val = _mm256_srai_epi16( sum, 6 );
+
+    return _mm256_max_epi16( val, _mm256_setzero_si256() );        // saturate values < 0 to 0
+}
+
+template<int base_index>
+FORCEINLINE __m256i     apply_color_matrix_chn( const alg_context& ctx, __m256i r, __m256i g, __m256i b )
+{
+    // unpack and pack both work per lane, so the pixel order is kept
+    const auto zero = _mm256_setzero_si256();
+
+    auto val_lo = apply_color_matrix_chn_epu16<base_index>( ctx,
+        _mm256_unpacklo_epi8( r, zero ), _mm256_unpacklo_epi8( g, zero ), _mm256_unpacklo_epi8( b, zero ) );
+    auto val_hi = apply_color_matrix_chn_epu16<base_index>( ctx,
+        _mm256_unpackhi_epi8( r, zero ), _mm256_unpackhi_epi8( g, zero ), _mm256_unpackhi_epi8( b, zero ) );
+
+    return _mm256_packus_epi16( val_lo, val_hi );
+}
+
+FORCEINLINE void        apply_color_matrix( const alg_context& ctx, __m256i& r, __m256i& g, __m256i& b )
+{
+    auto in_r = r;
+    auto in_g = g;
+    auto in_b = b;
+
+    r = apply_color_matrix_chn<0>( ctx, in_r, in_g, in_b );
+    g = apply_color_matrix_chn<3>( ctx, in_r, in_g, in_b );
+    b = apply_color_matrix_chn<6>( ctx, in_r, in_g, in_b );
+}
+
+FORCEINLINE __m256i calc_x_from_xg_line( __m256i cur_p0, __m256i cur_p2 )
+{
+    auto avg_line = _mm256_avg_epu8( cur_p0, cur_p2 );
+    auto tmp2 = _mm256_slli_epi16( cur_p2, 8 );
+
+    return _mm256_blendv_epi8( tmp2, avg_line, mask_0x00FF() );
+}
+
+FORCEINLINE __m256i calc_x_from_gx_line( __m256i cur_p0, __m256i cur_p2 )
+{
+    auto avg_line = _mm256_avg_epu8( cur_p0, cur_p2 );
+    auto tmp2 = _mm256_srli_epi16( cur_p0, 8 );
+
+    return _mm256_blendv_epi8( tmp2, avg_line, mask_0xFF00() );
+}
+
+FORCEINLINE __m256i calc_y_from_xg_line( __m256i prv_p0, __m256i prv_p2, __m256i nxt_p0, __m256i nxt_p2 )
+{
+    auto prv_avg_line = _mm256_avg_epu8( prv_p0, prv_p2 );
+    auto nxt_avg_line = _mm256_avg_epu8( nxt_p0, nxt_p2 );
+    auto tmp1 = _mm256_avg_epu8( prv_avg_line, nxt_avg_line );
+
+    auto tmp0 = _mm256_avg_epu8( nxt_p0, prv_p0 );
+    auto tmp2 = _mm256_srli_epi16( tmp0, 8 );
+
+    return _mm256_blendv_epi8( tmp2, tmp1, mask_0xFF00() );
+}
+
+FORCEINLINE __m256i calc_y_from_gx_line( __m256i prv_p0, __m256i prv_p2, __m256i nxt_p0, __m256i nxt_p2 )
+{
+    auto prv_avg_line = _mm256_avg_epu8( prv_p0, prv_p2 );
+    auto nxt_avg_line = _mm256_avg_epu8( nxt_p0, nxt_p2 );
+    auto tmp1 = _mm256_avg_epu8( prv_avg_line, nxt_avg_line );
+
+    auto tmp0 = _mm256_avg_epu8( nxt_p2, prv_p2 );
+    auto tmp2 = _mm256_slli_epi16( tmp0, 8 );
+
+    return _mm256_blendv_epi8( tmp2, tmp1, mask_0x00FF() );
+}
+
+FORCEINLINE __m256i calc_edge_g( __m256i cur_g_p0, __m256i cur_g_p2, __m256i prv_g, __m256i nxt_g )
+{
+    auto sum_lr = _mm256_avg_epu8( cur_g_p0, cur_g_p2 );
+    auto sum_ab = _mm256_avg_epu8( prv_g, nxt_g );
+    auto sum_al = _mm256_avg_epu8( sum_lr, sum_ab );           // sum(prv[0],nxt[0],cur[-1],cur[+1]) / 4
+
+    auto dif_lr = _mm256_abs_epi16( _mm256_sub_epi16( cur_g_p0, cur_g_p2 ) );
+    auto dif_ab = _mm256_abs_epi16( _mm256_sub_epi16( prv_g, nxt_g ) );
+
+    auto cmp_lt = _mm256_cmpgt_epi16( dif_ab, dif_lr );        // dif_lr[x] <  dif_ab[x]
+    auto cmp_eq = _mm256_cmpeq_epi16( dif_lr, dif_ab );
+
+    auto tmp0 = _mm256_blendv_epi8( sum_ab, sum_lr, cmp_lt );
+    return _mm256_blendv_epi8( tmp0, sum_al, cmp_eq );
+}
+
+FORCEINLINE __m256i calc_g_from_xg_line( __m256i prv_p2, __m256i cur_p0, __m256i cur_p2, __m256i nxt_p2 )
+{
+    auto cur_g_p0 = _mm256_srli_epi16( cur_p0, 8 );
+    auto cur_g_p2 = _mm256_srli_epi16( cur_p2, 8 );
+
+    auto prv_g = _mm256_and_si256( prv_p2, mask_0x00FF() );
+    auto nxt_g = _mm256_and_si256( nxt_p2, mask_0x00FF() );
+
+    auto tmp1 = calc_edge_g( cur_g_p0, cur_g_p2, prv_g, nxt_g );
+    auto tmp2 = _mm256_slli_epi16( tmp1, 8 );
+    return _mm256_or_si256( cur_g_p0, tmp2 );
+}
+
+FORCEINLINE __m256i calc_g_from_gx_line( __m256i prv, __m256i cur_p0, __m256i cur_p2, __m256i nxt )
+{
+    auto cur_g_p0 = _mm256_and_si256( cur_p0, mask_0x00FF() );
+    auto cur_g_p2 = _mm256_and_si256( cur_p2, mask_0x00FF() );
+
+    auto prv_g = _mm256_srli_epi16( prv, 8 );
+    auto nxt_g = _mm256_srli_epi16( nxt, 8 );
+
+    auto tmp1 = calc_edge_g( cur_g_p0, cur_g_p2, prv_g, nxt_g );
+    auto tmp2 = _mm256_slli_epi16( cur_g_p2, 8 );
+
+    return _mm256_or_si256( tmp1, tmp2 );
+}
+
+FORCEINLINE __m256i calc_avgG_value( __m256i prv_g_p0, __m256i prv_g_p2, __m256i nxt_g_p0, __m256i nxt_g_p2, __m256i cur_g )
+{
+    const auto mask_0x0007 = _mm256_set1_epi16( 0x0007 );
+
+    auto dif_lr = _mm256_abs_epi16( _mm256_sub_epi16( prv_g_p0, prv_g_p2 ) );
+    auto dif_ab = _mm256_abs_epi16( _mm256_sub_epi16( prv_g_p0, nxt_g_p0 ) );
+
+    auto t0 = _mm256_avg_epu8( prv_g_p0, prv_g_p2 );
+    auto t1 = _mm256_avg_epu8( nxt_g_p0, nxt_g_p2 );
+
+    auto sum_all = _mm256_avg_epu8( t0, t1 );
+    sum_all = _mm256_avg_epu8( sum_all, cur_g );
+
+    auto diff_gt_7 = _mm256_cmpgt_epi16( mask_0x0007, dif_ab );
+    auto diff_lr_7 = _mm256_cmpgt_epi16( mask_0x0007, dif_lr );
+
+    auto cond_true = _mm256_and_si256( diff_gt_7, diff_lr_7 );
+
+    return _mm256_blendv_epi8( cur_g, sum_all, cond_true );
+}
+
+FORCEINLINE __m256i calc_g_from_xg_line_avgG( __m256i prv_p0, __m256i prv_p2, __m256i cur_p0, __m256i cur_p2, __m256i nxt_p0, __m256i nxt_p2 )
+{
+    auto cur_g_p0 = _mm256_srli_epi16( cur_p0, 8 );
+    auto cur_g_p2 = _mm256_srli_epi16( cur_p2, 8 );
+
+    auto prv_g_p0 = _mm256_and_si256( prv_p0, mask_0x00FF() );
+    auto nxt_g_p0 = _mm256_and_si256( nxt_p0, mask_0x00FF() );
+
+    auto prv_g_p2 = _mm256_and_si256( prv_p2, mask_0x00FF() );
+    auto nxt_g_p2 = _mm256_and_si256( nxt_p2, mask_0x00FF() );
+
+    auto tmp1 = calc_edge_g( cur_g_p0, cur_g_p2, prv_g_p2, nxt_g_p2 );
+    auto tmp2 = _mm256_slli_epi16( tmp1, 8 );
+
+    auto g_even = calc_avgG_value( prv_g_p0, prv_g_p2, nxt_g_p0, nxt_g_p2, cur_g_p0 );
+
+    return _mm256_or_si256( g_even, tmp2 );
+}
+
+FORCEINLINE __m256i calc_g_from_gx_line_avgG( __m256i prv_p0, __m256i prv_p2, __m256i cur_p0, __m256i cur_p2, __m256i nxt_p0, __m256i nxt_p2 )
+{
+    auto cur_g_p0 = _mm256_and_si256( cur_p0, mask_0x00FF() );
+    auto cur_g_p2 = _mm256_and_si256( cur_p2, mask_0x00FF() );
+
+    auto prv_g_p0 = _mm256_srli_epi16( prv_p0, 8 );
+    auto nxt_g_p0 = _mm256_srli_epi16( nxt_p0, 8 );
+
+    auto prv_g_p2 = _mm256_srli_epi16( prv_p2, 8 );
+    auto nxt_g_p2 = _mm256_srli_epi16( nxt_p2, 8 );
+
+    auto tmp1 = calc_edge_g( cur_g_p0, cur_g_p2, prv_g_p0, nxt_g_p0 );
+
+    auto g_even = calc_avgG_value( prv_g_p0, prv_g_p2, nxt_g_p0, nxt_g_p2, cur_g_p2 );
+    auto tmp2 = _mm256_slli_epi16( g_even, 8 );
+
+    return _mm256_or_si256( tmp1, tmp2 );
+}
+
+template<bool use_avg_green,by_pattern pat>
+FORCEINLINE void    conv_avx2_reg( __m256i& r, __m256i& g, __m256i& b,
+                const __m256i& prv_p0, const __m256i& cur_p0, const __m256i& nxt_p0,
+                const __m256i& prv_p2, const __m256i& cur_p2, const __m256i& nxt_p2 )
+{
+    __m256i x_chn, y_chn, g_chn;
+    if constexpr( is_gx_line( pat ) )
+    {
+        x_chn = calc_x_from_gx_line( cur_p0, cur_p2 );
+        y_chn = calc_y_from_gx_line( prv_p0, prv_p2, nxt_p0, nxt_p2 );
+
+        if( use_avg_green ) {
+            g_chn = calc_g_from_gx_line_avgG( prv_p0, prv_p2, cur_p0, cur_p2, nxt_p0, nxt_p2 );
+        } else {
+            g_chn = calc_g_from_gx_line( prv_p0, cur_p0, cur_p2, nxt_p0 );
+        }
+    } else {
+        x_chn = calc_x_from_xg_line( cur_p0, cur_p2 );
+        y_chn = calc_y_from_xg_line( prv_p0, prv_p2, nxt_p0, nxt_p2 );
+
+        if( use_avg_green ) {
+            g_chn = calc_g_from_xg_line_avgG( prv_p0, prv_p2, cur_p0, cur_p2, nxt_p0, nxt_p2 );
+        } else {
+            g_chn = calc_g_from_xg_line( prv_p2, cur_p0, cur_p2, nxt_p2 );
+        }
+    }
+
+    g = g_chn;
+    if constexpr( is_red_line( pat ) ) {
+        r = x_chn;
+        b = y_chn;
+    } else {
+        r = y_chn;
+        b = x_chn;
+    }
+}
+
+// p0 = pixel [x - 1;x + 31[, p2 = pixel [x + 1;x + 33[, results are pixel [x;x + 32[
+template<by_pattern pat, bool use_mtx, bool use_avg_green, bool use_nt_store>
+FORCEINLINE void    conv_block( const alg_context& clr, const line_data& lines, int x,
+                const __m256i& prv_p0, const __m256i& cur_p0, const __m256i& nxt_p0 )
+{
+    auto prv_p2 = load_u( lines.lines[0] + x + 1 );
+    auto cur_p2 = load_u( lines.lines[1] + x + 1 );
+    auto nxt_p2 = load_u( lines.lines[2] + x + 1 );
+
+    __m256i r, g, b;
+    conv_avx2_reg<use_avg_green, pat>( r, g, b, prv_p0, cur_p0, nxt_p0, prv_p2, cur_p2, nxt_p2 );
+
+    if( use_mtx ) {
+        apply_color_matrix( clr, r, g, b );
+    }
+
+    store_bgra32<use_nt_store>( lines, x, r, g, b );
+}
+
+template<by_pattern pat, bool use_mtx, bool use_avg_green, bool use_nt_store>
+void	    conv_line( const alg_context& clr, const line_data& lines, int dim_x )
+{
+    // p0 of pixel x starts at the odd pixel x - 1
+    constexpr auto nxt_pattern = next_pixel( pat );
+
+    // pixel [0;32[, pixel -1 is replaced by 0, pixel 0 is overwritten afterwards
+    conv_block<nxt_pattern, use_mtx, use_avg_green, use_nt_store>( clr, lines, 0,
+        shift_in_zero_byte( load_u( lines.lines[0] ) ),
+        shift_in_zero_byte( load_u( lines.lines[1] ) ),
+        shift_in_zero_byte( load_u( lines.lines[2] ) ) );
+
+    int x = 32;
+    for( ; x <= (dim_x - 33); x += 32 )       // reads [x - 1;x + 33[
+    {
+        conv_block<nxt_pattern, use_mtx, use_avg_green, use_nt_store>( clr, lines, x,
+            load_u( lines.lines[0] + x - 1 ),
+            load_u( lines.lines[1] + x - 1 ),
+            load_u( lines.lines[2] + x - 1 ) );
+    }
+
+    if( x < dim_x - 1 )
+    {
+        // pixel [dim_x - 33;dim_x - 1[, dim_x is even so p0 starts at an even pixel
+        const int last_x = dim_x - 33;
+        conv_block<pat, use_mtx, use_avg_green, false>( clr, lines, last_x,
+            load_u( lines.lines[0] + last_x - 1 ),
+            load_u( lines.lines[1] + last_x - 1 ),
+            load_u( lines.lines[2] + last_x - 1 ) );
+    }
+
+    // double last entry, to get the equivalent to pixel copy
+    auto* out_line = reinterpret_cast<BGRA32*>(lines.out_line);
+    memcpy( out_line + dim_x - 1, out_line + dim_x - 2, sizeof( BGRA32 ) );
+    memcpy( out_line, out_line + 1, sizeof( BGRA32 ) );
+}
+
+template<by_pattern pattern, bool use_mtx, bool use_avg_green>
+static void transform_line( const line_data& lines, int dim_x, const alg_context& ctx )
+{
+    if( simd::is_aligned_for_stream<32>( lines.out_line ) ) {
+        conv_line<pattern, use_mtx, use_avg_green, true>( ctx, lines, dim_x );
+    } else {
+        conv_line<pattern, use_mtx, use_avg_green, false>( ctx, lines, dim_x );
+    }
+}
+
+alg_context_avx2    fill_context( const img_filter::transform::by_edge::options& in_opt )
+{
+    auto ctx = alg_context_avx2{ {}, in_opt.use_color_matrix, in_opt.use_avg_green };
+    for( int i = 0; i < 9; ++i )
+    {
+        ctx.clr_mtx[i] = _mm256_set1_epi16( in_opt.color_mtx.fac[i] );
+    }
+    return ctx;
+}
+
+struct image_funcs
+{
+    template<by_pattern pattern, bool use_mtx, bool use_avg_green>
+    static void     func( const img::img_descriptor& dst, const img::img_descriptor& src, const img_filter::transform::by_edge::options& options )
+    {
+        const auto ctx = fill_context( options );
+        const int dim_x = src.dim.cx;
+        by8_edge_image_loop<pattern>( dst, src, [&ctx, dim_x]( auto line_pattern, const line_data& lines )
+        {
+            transform_line<decltype( line_pattern )::value, use_mtx, use_avg_green>( lines, dim_x, ctx );
+        } );
+        _mm_sfence();
+    }
+};
+
+}
+
+img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::get_transform_by8_to_dst_avx2( img::img_type dst, img::img_type src )
+{
+    if( !img::is_by8_fcc( src.fourcc_type() ) || dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( dst.dim.cx < 64 || dst.dim.cx % 2 != 0 || dst.dim.cy < 2 ) {
+        return nullptr;
+    }
+
+    // BGR24 is left to the SSE4.1 variant
+    if( dst.fourcc_type() == img::fourcc::BGRA32 ) {
+        return &transform_by8_image<image_funcs>;
+    }
+    return nullptr;
+}
+
+img_filter::transform_function_type     img_filter::transform::by_edge::get_transform_by8_to_dst_specialized_avx2( img::img_type dst, img::img_type src, bool use_avg_green )
+{
+    if( get_transform_by8_to_dst_avx2( dst, src ) == nullptr ) {
+        return nullptr;
+    }
+    return select_specialized_func<image_funcs>( src.fourcc_type(), use_avg_green );
+}
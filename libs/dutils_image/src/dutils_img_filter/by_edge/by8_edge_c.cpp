@@ -130,67 +130,19 @@ void	convert_by8_to_rgb_edge( const alg_context& clr, const line_data& lines, in
     store<TOut>( lines.out_line, x + 1, tmp );
 }
 
-template<class TOutDataType,bool use_mtx,bool avg_greenx>
-static void transform_line_( by_pattern pattern, const line_data& lines, int dim_x, const alg_context& ctx )
+template<class TOut>
+struct image_funcs
 {
-    switch( pattern )
+    template<by_pattern pattern, bool use_mtx, bool use_avg_green>
+    static void     func( const img::img_descriptor& dst, const img::img_descriptor& src, const alg_context& ctx )
     {
-    case by_pattern::BG:    convert_by8_to_rgb_edge<by_pattern::BG, TOutDataType,use_mtx, avg_greenx>( ctx, lines, dim_x );    break;
-    case by_pattern::GB:    convert_by8_to_rgb_edge<by_pattern::GB, TOutDataType,use_mtx, avg_greenx>( ctx, lines, dim_x );    break;
-    case by_pattern::GR:    convert_by8_to_rgb_edge<by_pattern::GR, TOutDataType,use_mtx, avg_greenx>( ctx, lines, dim_x );    break;
-    case by_pattern::RG:    convert_by8_to_rgb_edge<by_pattern::RG, TOutDataType,use_mtx, avg_greenx>( ctx, lines, dim_x );    break;
-    };
-}
-
-template<class TOutDataType>
-static void transform_line( by_pattern pattern, const line_data& lines, int dim_x, const alg_context& ctx )
-{
-    if( ctx.use_color_matrix ) {
-        if( ctx.use_avg_green ) {
-            transform_line_<TOutDataType, true,true>( pattern, lines, dim_x, ctx );
-        } else  {
-            transform_line_<TOutDataType, true,false>( pattern, lines, dim_x, ctx );
-        }
-    } else {
-        if( ctx.use_avg_green ) {
-            transform_line_<TOutDataType, false,true>( pattern, lines, dim_x, ctx );
-        } else  {
-            transform_line_<TOutDataType, false,false>( pattern, lines, dim_x, ctx );
-        }
+        const int dim_x = src.dim.cx;
+        by8_edge_image_loop<pattern>( dst, src, [&ctx, dim_x]( auto line_pattern, const line_data& lines )
+        {
+            convert_by8_to_rgb_edge<decltype( line_pattern )::value, TOut, use_mtx, use_avg_green>( ctx, lines, dim_x );
+        } );
     }
-}
-
-
-template<typename TRGBStr>
-static void by_edge_image_loop( img::img_descriptor dst_, img::img_descriptor src, const img_filter::transform::by_edge::options& in_opt )
-{
-    const auto dst = flip_image_in_img_desc_if_allowed( dst_ );
-
-    const by_pattern pattern_cur = img::by_transform::convert_bayer_fcc_to_pattern( src.fourcc_type() );
-    const by_pattern pattern_nxt = img::by_transform::by_pattern_alg::next_line( pattern_cur );
-
-    const int dim_y = src.dim.cy;
-
-    if( !(src.flags & img::img_descriptor::flags_no_wrap_beg) ) {
-        transform_line<TRGBStr>( pattern_cur, init_src_param( 0, dst, src, +1, +1 ), src.dim.cx, in_opt );
-    }
-    else {
-        transform_line<TRGBStr>( pattern_cur, init_src_param( 0, dst, src, -1, +1 ), src.dim.cx, in_opt );
-    }
-    int y = 1;
-    for( ; y < (dim_y - 1); y += 2 )
-    {
-        transform_line<TRGBStr>( pattern_nxt, init_src_param( y + 0, dst, src, -1, +1 ), src.dim.cx, in_opt );
-        transform_line<TRGBStr>( pattern_cur, init_src_param( y + 1, dst, src, -1, +1 ), src.dim.cx, in_opt );
-    }
-
-    if( !(src.flags & img::img_descriptor::flags_no_wrap_end) ) {
-        transform_line<TRGBStr>( pattern_nxt, init_src_param( y, dst, src, -1, -1 ), src.dim.cx, in_opt );
-    }
-    else {
-        transform_line<TRGBStr>( pattern_nxt, init_src_param( y, dst, src, -1, +1 ), src.dim.cx, in_opt );
-    }
-}
+};
 
 }
 
@@ -260,8 +212,23 @@ img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::
 
     switch( dst.fourcc_type() )
     {
-    case img::fourcc::BGRA32: return &by_edge_image_loop<BGRA32>;
-    case img::fourcc::BGR24: return &by_edge_image_loop<BGR24>;
+    case img::fourcc::BGRA32: return &transform_by8_image<image_funcs<BGRA32>>;
+    case img::fourcc::BGR24: return &transform_by8_image<image_funcs<BGR24>>;
+    default:
+        return nullptr;
+    };
+}
+
+img_filter::transform_function_type     img_filter::transform::by_edge::get_transform_by8_to_dst_specialized_c( img::img_type dst, img::img_type src, bool use_avg_green )
+{
+    if( get_transform_by8_to_dst_c( dst, src ) == nullptr ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGRA32: return select_specialized_func<image_funcs<BGRA32>>( src.fourcc_type(), use_avg_green );
+    case img::fourcc::BGR24: return select_specialized_func<image_funcs<BGR24>>( src.fourcc_type(), use_avg_green );
     default:
         return nullptr;
     };
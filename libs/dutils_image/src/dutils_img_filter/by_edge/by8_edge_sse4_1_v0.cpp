@@ -436,57 +436,22 @@ void	    conv_line( const alg_context& clr, const line_data& lines_, int dim_x )
     }
 }
 
-template<class TOut,bool ... TboolParams>
-void	convert_by8_to_rgb_edge_sse4_1_v2( by_pattern pattern, const line_data& lines, int dim_x, const alg_context& ctx )
+template<class TOut, by_pattern pattern, bool use_mtx, bool use_avg_green, bool use_nt_store>
+void	convert_by8_to_rgb_edge_sse4_1_v2( const line_data& lines, int dim_x, const alg_context& ctx )
 {
-    if( pattern == by_pattern::BG ) {
-        conv_line<TOut, by_pattern::BG, TboolParams...>( ctx, lines, dim_x );
-    } else if( pattern == by_pattern::GB ) {
-        conv_line<TOut, by_pattern::GB, TboolParams...>( ctx, lines, dim_x );
-    } else if( pattern == by_pattern::GR ) {
-        conv_line<TOut, by_pattern::GR, TboolParams...>( ctx, lines, dim_x );
-    } else if( pattern == by_pattern::RG ) {
-        conv_line<TOut, by_pattern::RG, TboolParams...>( ctx, lines, dim_x );
-    }
+    conv_line<TOut, pattern, use_mtx, use_avg_green, use_nt_store>( ctx, lines, dim_x );
 
     uint8_t* out_line = reinterpret_cast<uint8_t*>(lines.out_line);
     memcpy( out_line, out_line + sizeof( TOut ), sizeof( TOut ) );
 }
 
-template<class TOutDataType>
-static void transform_line( by_pattern pattern, const line_data& lines, int dim_x, const alg_context& ctx )
+template<class TOutDataType, by_pattern pattern, bool use_mtx, bool use_avg_green>
+static void transform_line( const line_data& lines, int dim_x, const alg_context& ctx )
 {
-    if( simd::is_aligned_for_stream<16>( lines.out_line ) ) 
-    {
-        if( ctx.use_color_matrix ) {
-            if( ctx.use_avg_green ) {
-                convert_by8_to_rgb_edge_sse4_1_v2<TOutDataType, true,true, true>( pattern, lines, dim_x, ctx );
-            } else  {
-                convert_by8_to_rgb_edge_sse4_1_v2<TOutDataType, true,false, true>( pattern, lines, dim_x, ctx );
-            }
-        } else {
-            if( ctx.use_avg_green ) {
-                convert_by8_to_rgb_edge_sse4_1_v2<TOutDataType, false,true, true>( pattern, lines, dim_x, ctx );
-            } else  {
-                convert_by8_to_rgb_edge_sse4_1_v2<TOutDataType, false,false, true>( pattern, lines, dim_x, ctx );
-            }
-        }
-    }
-    else
-    {
-        if( ctx.use_color_matrix ) {
-            if( ctx.use_avg_green ) {
-                convert_by8_to_rgb_edge_sse4_1_v2<TOutDataType, true,true, false>( pattern, lines, dim_x, ctx );
-            } else  {
-                convert_by8_to_rgb_edge_sse4_1_v2<TOutDataType, true,false, false>( pattern, lines, dim_x, ctx );
-            }
-        } else {
-            if( ctx.use_avg_green ) {
-                convert_by8_to_rgb_edge_sse4_1_v2<TOutDataType, false,true, false>( pattern, lines, dim_x, ctx );
-            } else  {
-                convert_by8_to_rgb_edge_sse4_1_v2<TOutDataType, false,false, false>( pattern, lines, dim_x, ctx );
-            }
-        }
+    if( simd::is_aligned_for_stream<16>( lines.out_line ) ) {
+        convert_by8_to_rgb_edge_sse4_1_v2<TOutDataType, pattern, use_mtx, use_avg_green, true>( lines, dim_x, ctx );
+    } else {
+        convert_by8_to_rgb_edge_sse4_1_v2<TOutDataType, pattern, use_mtx, use_avg_green, false>( lines, dim_x, ctx );
     }
 }
 
@@ -501,37 +466,20 @@ alg_context_sse     fill_context( const img_filter::transform::by_edge::options&
     return ctx;
 }
 
-template<typename TRGBStr>
-static void by_edge_image_loop_sse41( img::img_descriptor dst_, img::img_descriptor src, const img_filter::transform::by_edge::options& options )
+template<class TOut>
+struct image_funcs
 {
-    auto dst = flip_image_in_img_desc_if_allowed( dst_ );
-
-
-    by_pattern pattern_cur = img::by_transform::convert_bayer_fcc_to_pattern( src.fourcc_type() );
-    by_pattern pattern_nxt = img::by_transform::by_pattern_alg::next_line( pattern_cur );
-
-    auto in_opt = fill_context( options );
-
-    int dim_y = src.dim.cy;
-
-    if( !(src.flags & img::img_descriptor::flags_no_wrap_beg) ) {
-        transform_line<TRGBStr>( pattern_cur, init_src_param( 0, dst, src, +1, +1 ), src.dim.cx, in_opt );
-    } else {
-        transform_line<TRGBStr>( pattern_cur, init_src_param( 0, dst, src, -1, +1 ), src.dim.cx, in_opt );
-    }
-    int y = 1;
-    for( ; y < (dim_y - 1); y += 2 )
+    template<by_pattern pattern, bool use_mtx, bool use_avg_green>
+    static void     func( const img::img_descriptor& dst, const img::img_descriptor& src, const img_filter::transform::by_edge::options& options )
     {
-        transform_line<TRGBStr>( pattern_nxt, init_src_param( y + 0, dst, src, -1, +1 ), src.dim.cx, in_opt );
-        transform_line<TRGBStr>( pattern_cur, init_src_param( y + 1, dst, src, -1, +1 ), src.dim.cx, in_opt );
-    }
-
-    if( !(src.flags & img::img_descriptor::flags_no_wrap_end) ) {
-        transform_line<TRGBStr>( pattern_nxt, init_src_param( y, dst, src, -1, -1 ), src.dim.cx, in_opt );
-    } else {
-        transform_line<TRGBStr>( pattern_nxt, init_src_param( y, dst, src, -1, +1 ), src.dim.cx, in_opt );
+        const auto ctx = fill_context( options );
+        const int dim_x = src.dim.cx;
+        by8_edge_image_loop<pattern>( dst, src, [&ctx, dim_x]( auto line_pattern, const line_data& lines )
+        {
+            transform_line<TOut, decltype( line_pattern )::value, use_mtx, use_avg_green>( lines, dim_x, ctx );
+        } );
     }
-}
+};
 
 }
 
@@ -546,8 +494,25 @@ img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::
 
     switch( dst.fourcc_type() )
     {
-    case img::fourcc::BGRA32: return &by_edge_image_loop_sse41<BGRA32>;
-    case img::fourcc::BGR24: return &by_edge_image_loop_sse41<BGR24>;
+    case img::fourcc::BGRA32: return &transform_by8_image<image_funcs<BGRA32>>;
+    case img::fourcc::BGR24: return &transform_by8_image<image_funcs<BGR24>>;
+    default:
+        break;
+    };
+
+    return nullptr;
+}
+
+img_filter::transform_function_type     img_filter::transform::by_edge::get_transform_by8_to_dst_specialized_sse41( img::img_type dst, img::img_type src, bool use_avg_green )
+{
+    if( get_transform_by8_to_dst_sse41( dst, src ) == nullptr ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGRA32: return select_specialized_func<image_funcs<BGRA32>>( src.fourcc_type(), use_avg_green );
+    case img::fourcc::BGR24: return select_specialized_func<image_funcs<BGR24>>( src.fourcc_type(), use_avg_green );
     default:
         break;
     };
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "../dutils_img_base.h"
+#include "../transform/transform_base.h"
 #include <dutils_img/image_transform_data_structs.h>     // img::color_matrix
 
 namespace img_filter {
@@ -24,6 +25,25 @@ namespace by_edge
     function_type	get_transform_by8_to_dst_sse41( img::img_type dst, img::img_type src );
     function_type	get_transform_by8_to_dst_avx2( img::img_type dst, img::img_type src );
     function_type	get_transform_by8_to_dst_neon( img::img_type dst, img::img_type src );
+
+    /* Variants without color matrix, where the bayer pattern of src, the dst format and use_avg_green are compile time parameters.
+     * The returned function only converts images of the fourcc of src.
+     */
+    transform_function_type	get_transform_by8_to_dst_specialized_c( img::img_type dst, img::img_type src, bool use_avg_green );
+    transform_function_type	get_transform_by8_to_dst_specialized_sse41( img::img_type dst, img::img_type src, bool use_avg_green );
+    transform_function_type	get_transform_by8_to_dst_specialized_avx2( img::img_type dst, img::img_type src, bool use_avg_green );
+    transform_function_type	get_transform_by8_to_dst_specialized_neon( img::img_type dst, img::img_type src, bool use_avg_green );
+
+    // BY16 to BGRA64 or BGRFloat, BGRFloat values are in [0;1]
+    function_type	get_transform_by16_to_dst_c( img::img_type dst, img::img_type src );
+    function_type	get_transform_by16_to_dst_avx2( img::img_type dst, img::img_type src );
+    function_type	get_transform_by16_to_dst_neon( img::img_type dst, img::img_type src );
+    function_type	get_transform_by16_to_dst_sve2( img::img_type dst, img::img_type src );      // nullptr when not built with SVE2
+
+    transform_function_type	get_transform_by16_to_dst_specialized_c( img::img_type dst, img::img_type src, bool use_avg_green );
+    transform_function_type	get_transform_by16_to_dst_specialized_avx2( img::img_type dst, img::img_type src, bool use_avg_green );
+    transform_function_type	get_transform_by16_to_dst_specialized_neon( img::img_type dst, img::img_type src, bool use_avg_green );
+    transform_function_type	get_transform_by16_to_dst_specialized_sve2( img::img_type dst, img::img_type src, bool use_avg_green );
 }
 }
 }
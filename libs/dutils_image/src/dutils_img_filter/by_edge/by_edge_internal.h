@@ -6,6 +6,8 @@
 #include <dutils_img/pixel_structs.h>
 #include <dutils_img/image_bayer_pattern.h>
 
+#include <type_traits>
+
 namespace by_edge_internal
 {
     using img::pixel_type::BGRA32;
@@ -41,6 +43,108 @@ namespace by_edge_internal
         return pat == by_pattern::GR || pat == by_pattern::GB;
     }
 
+    template<by_pattern pattern>
+    using pattern_tag = std::integral_constant<by_pattern, pattern>;
+
+    /* Calls conv_line( pattern_tag<line_pattern>{}, lines ) for every line of src, line_pattern is the pattern of the first pixel in that line
+     * and pattern the one of the first line.
+     * So the line functions are resolved at compile time and nothing is decided per line.
+     */
+    template<by_pattern pattern, class TLineFunc>
+    FORCEINLINE void    by8_edge_image_loop( const img::img_descriptor& dst, const img::img_descriptor& src, TLineFunc conv_line )
+    {
+        constexpr auto pattern_nxt = by_pattern_alg::next_line( pattern );
+
+        const int dim_y = src.dim.cy;
+
+        const int offset_first = (src.flags & img::img_descriptor::flags_no_wrap_beg) ? -1 : +1;
+        conv_line( pattern_tag<pattern>{}, init_src_param( 0, dst, src, offset_first, +1 ) );
+
+        int y = 1;
+        for( ; y < (dim_y - 2); y += 2 )
+        {
+            conv_line( pattern_tag<pattern_nxt>{}, init_src_param( y + 0, dst, src, -1, +1 ) );
+            conv_line( pattern_tag<pattern>{}, init_src_param( y + 1, dst, src, -1, +1 ) );
+        }
+        if( y < (dim_y - 1) )   // odd height
+        {
+            conv_line( pattern_tag<pattern_nxt>{}, init_src_param( y, dst, src, -1, +1 ) );
+            ++y;
+        }
+
+        const int offset_last = (src.flags & img::img_descriptor::flags_no_wrap_end) ? +1 : -1;
+        if( y % 2 ) {
+            conv_line( pattern_tag<pattern_nxt>{}, init_src_param( y, dst, src, -1, offset_last ) );
+        } else {
+            conv_line( pattern_tag<pattern>{}, init_src_param( y, dst, src, -1, offset_last ) );
+        }
+    }
+
+    /* TImageFuncs must provide
+     *  template<by_pattern pattern, bool use_mtx, bool use_avg_green>
+     *  static void func( const img::img_descriptor& dst, const img::img_descriptor& src, const alg_context_c& opt )
+     * which converts src to the already flipped dst, pattern is the pattern of the first line of src.
+     */
+    template<class TImageFuncs, bool use_mtx, bool use_avg_green>
+    auto    select_pattern_func( by_pattern pattern ) noexcept -> decltype( &TImageFuncs::template func<by_pattern::BG, use_mtx, use_avg_green> )
+    {
+        switch( pattern )
+        {
+        case by_pattern::BG:    return &TImageFuncs::template func<by_pattern::BG, use_mtx, use_avg_green>;
+        case by_pattern::GB:    return &TImageFuncs::template func<by_pattern::GB, use_mtx, use_avg_green>;
+        case by_pattern::GR:    return &TImageFuncs::template func<by_pattern::GR, use_mtx, use_avg_green>;
+        case by_pattern::RG:    return &TImageFuncs::template func<by_pattern::RG, use_mtx, use_avg_green>;
+        };
+        return nullptr;
+    }
+
+    // The function_type of get_transform_by8_to_dst_*, the pattern and the options are resolved once per image
+    template<class TImageFuncs>
+    void    transform_by8_image( img::img_descriptor dst, img::img_descriptor src, const alg_context_c& opt )
+    {
+        const auto pattern = convert_bayer_fcc_to_pattern( src.fourcc_type() );
+
+        decltype( &TImageFuncs::template func<by_pattern::BG, false, false> ) func = nullptr;
+        if( opt.use_color_matrix ) {
+            func = opt.use_avg_green ? select_pattern_func<TImageFuncs, true, true>( pattern ) : select_pattern_func<TImageFuncs, true, false>( pattern );
+        } else {
+            func = opt.use_avg_green ? select_pattern_func<TImageFuncs, false, true>( pattern ) : select_pattern_func<TImageFuncs, false, false>( pattern );
+        }
+        func( img::flip_image_in_img_desc_if_allowed( dst ), src, opt );
+    }
+
+    // The transform_function_type of get_transform_by8_to_dst_specialized_*
+    template<class TImageFuncs, by_pattern pattern, bool use_avg_green>
+    void    transform_by8_image_specialized( img::img_descriptor dst, img::img_descriptor src )
+    {
+        static const alg_context_c opt = { {}, false, use_avg_green };
+
+        TImageFuncs::template func<pattern, false, use_avg_green>( img::flip_image_in_img_desc_if_allowed( dst ), src, opt );
+    }
+
+    template<class TImageFuncs, bool use_avg_green>
+    img_filter::transform_function_type     select_specialized_func_( by_pattern pattern ) noexcept
+    {
+        switch( pattern )
+        {
+        case by_pattern::BG:    return &transform_by8_image_specialized<TImageFuncs, by_pattern::BG, use_avg_green>;
+        case by_pattern::GB:    return &transform_by8_image_specialized<TImageFuncs, by_pattern::GB, use_avg_green>;
+        case by_pattern::GR:    return &transform_by8_image_specialized<TImageFuncs, by_pattern::GR, use_avg_green>;
+        case by_pattern::RG:    return &transform_by8_image_specialized<TImageFuncs, by_pattern::RG, use_avg_green>;
+        };
+        return nullptr;
+    }
+
+    template<class TImageFuncs>
+    img_filter::transform_function_type     select_specialized_func( img::fourcc src_fcc, bool use_avg_green ) noexcept
+    {
+        const auto pattern = convert_bayer_fcc_to_pattern( src_fcc );
+        if( use_avg_green ) {
+            return select_specialized_func_<TImageFuncs, true>( pattern );
+        }
+        return select_specialized_func_<TImageFuncs, false>( pattern );
+    }
+
     template<class TOut>    int	    conv_by8_line_c( by_pattern pattern, const alg_context_c& clr, const line_data& lines, int x, int dim_x );
     template<>              int	    conv_by8_line_c<BGRA32>( by_pattern pattern, const alg_context_c& clr, const line_data& lines, int x, int dim_x );
     template<>              int	    conv_by8_line_c<BGR24>( by_pattern pattern, const alg_context_c& clr, const line_data& lines, int x, int dim_x );
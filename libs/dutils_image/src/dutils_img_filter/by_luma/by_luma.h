@@ -0,0 +1,26 @@
+
+#pragma once
+
+#include "../dutils_img_base.h"
+#include "../transform/transform_base.h"
+
+namespace img_filter {
+namespace transform {
+namespace by_luma
+{
+    /* Luma of a bayer image without debayering it, for mono analytics on color cameras.
+     *
+     * Full resolution, dst.dim == src.dim:
+     *      Every pixel is the 3x3 binomial filter [1 2 1; 2 4 2; 1 2 1] / 16 around it. On every position of the pattern, this weights red and
+     *      blue with 1/4 and green with 1/2, so the result is (R + 2G + B) / 4 and does not depend on the pattern.
+     *      Lines and columns outside of the image are mirrored at the border. With flags_no_wrap_beg/flags_no_wrap_end, the line in front
+     *      of/after src is read instead, so converting an image in several parts gives the same result as converting it at once.
+     * Binned, dst.dim == src.dim / 2 or src.dim / 4:
+     *      Every pixel is the rounded average of a 2x2 or 4x4 block of src, which is (R + 2G + B) / 4 of the block. A remainder of src is ignored.
+     *
+     * BY8 to MONO8, BY16 to MONO16. dst is written top down, the flip flags are ignored.
+     */
+    transform_function_type     get_transform_by_to_luma_c( img::img_type dst, img::img_type src );
+}
+}
+}
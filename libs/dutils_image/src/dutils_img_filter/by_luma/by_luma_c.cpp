@@ -0,0 +1,116 @@
+
+#include "by_luma.h"
+
+#include "../by_binned/by_binned.h"
+
+/*
+ * The inner loops of the full resolution filter have no branches and no dependency between the pixels, so the compiler vectorizes them.
+ * The borders are done separately.
+ */
+
+namespace
+{
+    // Mirrors lines outside of src, keeps them when the flags allow reading them
+    template<class T>
+    FORCEINLINE const T*    src_line( const img::img_descriptor& src, int y ) noexcept
+    {
+        if( y < 0 && !(src.flags & img::img_descriptor::flags_no_wrap_beg) ) {
+            y = -y;
+        } else if( y >= src.dim.cy && !(src.flags & img::img_descriptor::flags_no_wrap_end) ) {
+            y = 2 * (src.dim.cy - 1) - y;
+        }
+        return img::get_line_start<const T>( src, y );
+    }
+
+    // Vertical part of the binomial filter
+    template<class T>
+    FORCEINLINE int     sum_column( const T* prev, const T* cur, const T* next, int x ) noexcept
+    {
+        return prev[x] + 2 * cur[x] + next[x];
+    }
+
+    template<class T>
+    FORCEINLINE T       round_luma( int sum16 ) noexcept
+    {
+        return static_cast<T>( (sum16 + 8) >> 4 );
+    }
+
+    template<class T>
+    void    luma_line( const T* prev, const T* cur, const T* next, T* out, int dim_x ) noexcept
+    {
+        // column -1 is column 1 and column dim_x is column dim_x - 2
+        out[0] = round_luma<T>( 2 * sum_column( prev, cur, next, 0 ) + 2 * sum_column( prev, cur, next, 1 ) );
+        for( int x = 1; x < dim_x - 1; ++x )
+        {
+            const int sum = sum_column( prev, cur, next, x - 1 ) + 2 * sum_column( prev, cur, next, x ) + sum_column( prev, cur, next, x + 1 );
+            out[x] = round_luma<T>( sum );
+        }
+        out[dim_x - 1] = round_luma<T>( 2 * sum_column( prev, cur, next, dim_x - 2 ) + 2 * sum_column( prev, cur, next, dim_x - 1 ) );
+    }
+
+    template<class T>
+    void    transform_luma_image( img::img_descriptor dst, img::img_descriptor src )
+    {
+        for( int y = 0; y < dst.dim.cy; ++y )
+        {
+            luma_line( src_line<T>( src, y - 1 ), src_line<T>( src, y ), src_line<T>( src, y + 1 ), img::get_line_start<T>( dst, y ), dst.dim.cx );
+        }
+    }
+
+    template<class T, int factor>
+    void    transform_luma_binned_image( img::img_descriptor dst, img::img_descriptor src )
+    {
+        constexpr int count = factor * factor;
+
+        for( int y = 0; y < dst.dim.cy; ++y )
+        {
+            const T* lines[factor] = {};
+            for( int i = 0; i < factor; ++i ) {
+                lines[i] = img::get_line_start<const T>( src, y * factor + i );
+            }
+
+            auto* out = img::get_line_start<T>( dst, y );
+            for( int x = 0; x < dst.dim.cx; ++x )
+            {
+                int sum = 0;
+                for( int i = 0; i < factor; ++i ) {
+                    for( int j = 0; j < factor; ++j ) {
+                        sum += lines[i][x * factor + j];
+                    }
+                }
+                out[x] = static_cast<T>( (sum + count / 2) / count );
+            }
+        }
+    }
+
+    template<class T>
+    img_filter::transform_function_type     select_func( img::dim dst_dim, img::dim src_dim ) noexcept
+    {
+        if( dst_dim == src_dim )
+        {
+            // the borders mirror the second line and column
+            if( src_dim.cx < 2 || src_dim.cy < 2 ) {
+                return nullptr;
+            }
+            return &transform_luma_image<T>;
+        }
+        switch( img_filter::transform::by_binned::calc_binning_factor( dst_dim, src_dim ) )
+        {
+        case 2:     return &transform_luma_binned_image<T, 2>;
+        case 4:     return &transform_luma_binned_image<T, 4>;
+        default:
+            return nullptr;
+        };
+    }
+}
+
+img_filter::transform_function_type     img_filter::transform::by_luma::get_transform_by_to_luma_c( img::img_type dst, img::img_type src )
+{
+    if( img::is_by8_fcc( src.fourcc_type() ) && dst.fourcc_type() == img::fourcc::MONO8 ) {
+        return select_func<uint8_t>( dst.dim, src.dim );
+    }
+    if( img::is_by16_fcc( src.fourcc_type() ) && dst.fourcc_type() == img::fourcc::MONO16 ) {
+        return select_func<uint16_t>( dst.dim, src.dim );
+    }
+    return nullptr;
+}
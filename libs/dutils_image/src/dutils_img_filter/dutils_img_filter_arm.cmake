@@ -5,13 +5,23 @@ add_library( dutils_img_filter_neon STATIC
 	"by_edge/by_edge.h"
 	"by_edge/by_edge_internal.h"
 	"by_edge/by8_edge_neonv8_v0.cpp"
+	"by_edge/by16_edge_internal.h"
+	"by_edge/by16_edge_neon.cpp"
+	"by_edge/by16_edge_sve2.cpp"
+
+	"by_demosaic/by_demosaic.h"
+	"by_demosaic/by_demosaic_internal.h"
+	"by_demosaic/by_demosaic_neon.cpp"
 
 	"transform/fcc1x_packed/fcc1x_packed_to_fcc.h"
 	"transform/fcc1x_packed/fcc1x_packed_to_fcc8_neon_v0.cpp"
 	"transform/fcc1x_packed/fcc1x_packed_to_fcc16_neon_v0.cpp"
+	"transform/fcc1x_packed/fcc1x_packed_to_fcc8_sve2.cpp"
+	"transform/fcc1x_packed/fcc1x_packed_to_fcc16_sve2.cpp"
 
 	"transform/fcc1x_packed/transform_fcc1x_to_fcc8.h"
 	"transform/fcc1x_packed/transform_fcc1x_to_fcc8_neon.cpp"
+	"transform/fcc1x_packed/transform_fcc1x_mono_to_dst_neon.cpp"
 
 
 
@@ -19,10 +29,18 @@ add_library( dutils_img_filter_neon STATIC
 	"filter/whitebalance/wb_apply_neon.cpp"
 	"filter/whitebalance/wb_apply_by8_neon.cpp"
 	"filter/whitebalance/wb_apply_by16_neon.cpp"
+	"filter/whitebalance/wb_apply_byfloat_neon.cpp"
+	"filter/whitebalance/wb_apply_sve2.cpp"
 
 	"transform/mono_to_bgr/transform_mono_to_bgr_neon.cpp"
 
+	"transform/bgra_to_yuv/transform_bgra_to_yuv_neon.cpp"
+
 	"transform/fcc8_fcc16/transform_fcc8_fcc16_neon_v0.cpp"
+
+	"transform/pwl/transform_pwl_to_bayerfloat_neon.cpp"
+
+	"transform/polarization/transform_polarization_neon.cpp"
 )
 
 target_link_libraries( dutils_img_filter_neon
@@ -35,6 +53,22 @@ PRIVATE
 
 if( ${CMAKE_SYSTEM_PROCESSOR} MATCHES "aarch64" )
 
+# The SVE2 files only contain the kernels when built with SVE2, otherwise their get functions return nullptr.
+# The kernels are only selected at runtime when the cpu reports SVE2, see CPU_UsesARM_SVE2.
+include( CheckCXXCompilerFlag )
+check_cxx_compiler_flag( "-march=armv8-a+sve2" DUTILS_IMG_COMPILER_SUPPORTS_SVE2 )
+
+if( DUTILS_IMG_COMPILER_SUPPORTS_SVE2 )
+set_source_files_properties(
+	"by_edge/by16_edge_sve2.cpp"
+	"transform/fcc1x_packed/fcc1x_packed_to_fcc8_sve2.cpp"
+	"transform/fcc1x_packed/fcc1x_packed_to_fcc16_sve2.cpp"
+	"filter/whitebalance/wb_apply_sve2.cpp"
+PROPERTIES
+	COMPILE_FLAGS "-march=armv8-a+sve2"
+)
+endif()
+
 elseif( ${CMAKE_SYSTEM_PROCESSOR} MATCHES "arm" )
 
 target_compile_options( dutils_img_filter_neon PUBLIC -mfpu=neon-vfpv4 )	# This is needed as a minimum for building this neon code in arm32 mode
@@ -5,9 +5,19 @@ add_library( dutils_img_filter_sse41 STATIC
 	"by_edge/by_edge.h"
 	"by_edge/by_edge_internal.h"
 	"by_edge/by8_edge_sse4_1_v0.cpp"
+	"by_edge/by8_edge_avx2_v0.cpp"
+	"by_edge/by16_edge_internal.h"
+	"by_edge/by16_edge_avx2.cpp"
+
+	"by_demosaic/by_demosaic.h"
+	"by_demosaic/by_demosaic_internal.h"
+	"by_demosaic/by_demosaic_sse41.cpp"
+	"by_demosaic/by_demosaic_avx2.cpp"
 
 	"transform/fcc1x_packed/fcc1x_packed_to_fcc16_ssse3_v0.cpp"
 	"transform/fcc1x_packed/fcc1x_packed_to_fcc8_ssse3_v0.cpp"
+	"transform/fcc1x_packed/fcc1x_packed_to_fcc8_avx2_v0.cpp"
+	"transform/fcc1x_packed/transform_fcc1x_mono_to_dst_avx2.cpp"
 
 	"transform/fcc8_fcc16/transform_fcc8_fcc16_sse4_v0.cpp"
 
@@ -15,8 +25,22 @@ add_library( dutils_img_filter_sse41 STATIC
 	"filter/whitebalance/wb_apply_sse41.cpp"
 	"filter/whitebalance/wb_apply_by16_sse4_1.cpp"
 	"filter/whitebalance/wb_apply_by8_sse2.cpp"
+	"filter/whitebalance/wb_apply_avx2.cpp"
+	"filter/whitebalance/wb_apply_avx512.cpp"
+	"filter/whitebalance/wb_apply_byfloat_sse41.cpp"
+	"filter/whitebalance/wb_apply_byfloat_avx2.cpp"
 
 	"transform/mono_to_bgr/transform_mono_to_bgr_sse41.cpp"
+
+	"transform/bgra_to_yuv/transform_bgra_to_yuv_avx2.cpp"
+
+	"transform/pwl/transform_pwl_to_bayerfloat_avx2.cpp"
+
+	"transform/polarization/transform_polarization_avx2.cpp"
+
+	"filter/hdr_merge/hdr_merge_avx2.cpp"
+	"filter/calib_correct/calib_correct_avx2.cpp"
+	"transform/binning/binning_avx2.cpp"
 )
 
 target_link_libraries( dutils_img_filter_sse41
@@ -27,6 +51,39 @@ PRIVATE
 	dutils_img::project_warnings
 )
 
-target_compile_options( dutils_img_filter_sse41 PUBLIC -msse4.1 )
+# The variants are selected at runtime, so the instruction set must not leak into consumers
+target_compile_options( dutils_img_filter_sse41 PRIVATE -msse4.1 )
+
+set_source_files_properties(
+	"transform/fcc1x_packed/fcc1x_packed_to_fcc16_ssse3_v0.cpp"
+	"transform/fcc1x_packed/fcc1x_packed_to_fcc8_ssse3_v0.cpp"
+PROPERTIES
+	COMPILE_FLAGS "-mno-sse4.1 -mssse3"	# -mno-sse4.1 also drops SSE3/SSSE3 in gcc
+)
+
+# AVX2/AVX-512 variants are only called after checking the cpu features
+set_source_files_properties(
+	"by_edge/by8_edge_avx2_v0.cpp"
+	"by_edge/by16_edge_avx2.cpp"
+	"by_demosaic/by_demosaic_avx2.cpp"
+	"transform/fcc1x_packed/fcc1x_packed_to_fcc8_avx2_v0.cpp"
+	"transform/fcc1x_packed/transform_fcc1x_mono_to_dst_avx2.cpp"
+	"filter/whitebalance/wb_apply_avx2.cpp"
+	"filter/whitebalance/wb_apply_byfloat_avx2.cpp"
+	"transform/bgra_to_yuv/transform_bgra_to_yuv_avx2.cpp"
+	"transform/pwl/transform_pwl_to_bayerfloat_avx2.cpp"
+	"transform/polarization/transform_polarization_avx2.cpp"
+	"filter/hdr_merge/hdr_merge_avx2.cpp"
+	"filter/calib_correct/calib_correct_avx2.cpp"
+	"transform/binning/binning_avx2.cpp"
+PROPERTIES
+	COMPILE_FLAGS "-mavx2"
+)
+
+set_source_files_properties(
+	"filter/whitebalance/wb_apply_avx512.cpp"
+PROPERTIES
+	COMPILE_FLAGS "-mavx512f -mavx512bw"
+)
 
 add_library( dutils_img::img_filter_optimized ALIAS dutils_img_filter_sse41 )
@@ -28,10 +28,22 @@ namespace img_filter
 
     struct pwl12_to_fcc8_wb_map_data;
 
+    namespace lut {
+        struct by8_lut_data;
+        struct mono_lut_data;
+    }
+    namespace filter::tone_map {
+        struct gain_map;
+    }
+
     struct filter_params
     {
         whitebalance_params             whitebalance;
-        pwl12_to_fcc8_wb_map_data*      pwl12_to_fcc8_wb_lut = nullptr;
+        img::pwl_transform_params       pwl_transform = {};         // hdr gain for the PWL -> fcc8/fcc16 transforms
+        pwl12_to_fcc8_wb_map_data*      pwl12_to_fcc8_wb_lut = nullptr;     // updated from whitebalance and pwl_transform by the C PWL -> fcc8 transform
+        const lut::by8_lut_data*        by8_lut = nullptr;          // see filter/lut/by8_lut.h
+        const lut::mono_lut_data*       mono_lut = nullptr;         // see filter/lut/mono_lut.h
+        const filter::tone_map::gain_map*   tone_gain = nullptr;    // local tone mapping of the table lookups, see filter/tone_map/tone_map.h
     };
 
     struct bayer_pattern_parameters
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "../../dutils_img_base.h"
+
+namespace img_filter::filter::calib_correct
+{
+    // gain map value of 1.f, the maps cover [0;16)
+    constexpr int       gain_shift = 12;
+    constexpr uint16_t  gain_one = 1 << gain_shift;
+
+    struct defect_pixel
+    {
+        int     x = 0;
+        int     y = 0;
+    };
+
+    /* Sensor calibration, the maps have map_dim and cover the whole sensor image.
+     * Missing parts are nullptr or 0.
+     */
+    struct params
+    {
+        img::dim    map_dim;
+        // position of the first pixel of the image in the maps, e.g. of a region of interest
+        int         offset_x = 0;
+        int         offset_y = 0;
+
+        // Dark frame in the range of the 16-bit formats, 8-bit images subtract the upper 8 bits
+        const uint16_t*     dark = nullptr;
+        // Per pixel gain of the flat-field correction, gain_one is 1.f
+        const uint16_t*     gain = nullptr;
+
+        // Sorted by y, then by x
+        const defect_pixel* defects = nullptr;
+        int                 defect_count = 0;
+    };
+
+    /** Corrects raw sensor images with a dark frame, a flat-field gain map and a defect pixel list.
+     *
+     * MONO8, MONO16, bayer 8/16-bit, dst and src have the same type, dst may be src.
+     *
+     * dst = (src - dark) * gain, clipped to the range of the format.
+     * Defect pixels are replaced by the average of the corrected horizontal neighbours of the same color,
+     * x +/- 1 for mono and x +/- 2 for bayer formats. As no other lines are read, the function can be called for any range of lines,
+     * y_beg is the line of the image the first line of src is.
+     */
+    using function_type = void (*)( const img::img_descriptor& dst, const img::img_descriptor& src, int y_beg, const params& p );
+
+    function_type   get_calib_correct_c( const img::img_type& dst, const img::img_type& src );
+    function_type   get_calib_correct_avx2( const img::img_type& dst, const img::img_type& src );
+
+    // True when p contains a correction
+    constexpr bool  is_active( const params& p ) noexcept
+    {
+        return p.dark != nullptr || p.gain != nullptr || p.defect_count > 0;
+    }
+}
@@ -0,0 +1,111 @@
+
+#include "calib_correct.h"
+#include "calib_correct_internal.h"
+
+#include "../../simd_helper/use_simd_avx2.h"
+
+/*
+ * Each step corrects 16 pixels in 16-bit lanes, the products of the gain are calculated in 32-bit lanes.
+ * The rest of a line is done by the C line function, both round the same way.
+ */
+
+namespace
+{
+
+using namespace calib_correct_internal;
+
+FORCEINLINE __m256i     load_16( const uint8_t* src ) noexcept
+{
+    return _mm256_cvtepu8_epi16( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) ) );
+}
+
+FORCEINLINE __m256i     load_16( const uint16_t* src ) noexcept
+{
+    return _mm256_loadu_si256( reinterpret_cast<const __m256i*>( src ) );
+}
+
+FORCEINLINE void        store_16( uint8_t* dst, __m256i val ) noexcept
+{
+    const __m256i clipped = _mm256_min_epu16( val, _mm256_set1_epi16( 0xFF ) );
+    // packus works on both 128-bit lanes, the permute moves the lower 8 bytes of each lane together
+    const __m256i packed = _mm256_permute4x64_epi64( _mm256_packus_epi16( clipped, clipped ), 0x08 );
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( dst ), _mm256_castsi256_si128( packed ) );
+}
+
+FORCEINLINE void        store_16( uint16_t* dst, __m256i val ) noexcept
+{
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst ), val );
+}
+
+// (val * gain + round) >> gain_shift, saturated to 0xFFFF
+FORCEINLINE __m256i     apply_gain_16( __m256i val, __m256i gain ) noexcept
+{
+    const __m256i round = _mm256_set1_epi32( 1 << (gain_shift - 1) );
+
+    const __m256i lo = _mm256_mullo_epi16( val, gain );
+    const __m256i hi = _mm256_mulhi_epu16( val, gain );
+    const __m256i prod0 = _mm256_srli_epi32( _mm256_add_epi32( _mm256_unpacklo_epi16( lo, hi ), round ), gain_shift );
+    const __m256i prod1 = _mm256_srli_epi32( _mm256_add_epi32( _mm256_unpackhi_epi16( lo, hi ), round ), gain_shift );
+    // the unpacks and the pack both work per 128-bit lane, so the order of the pixels is kept
+    return _mm256_packus_epi32( prod0, prod1 );
+}
+
+template<class T, bool has_dark, bool has_gain>
+FORCEINLINE void        correct_line_avx2( T* dst_line, const T* src_line, const uint16_t* dark_line, const uint16_t* gain_line, int dim_x ) noexcept
+{
+    int x = 0;
+    for( ; x + 16 <= dim_x; x += 16 )
+    {
+        __m256i val = load_16( src_line + x );
+        if constexpr( has_dark )
+        {
+            __m256i dark = load_16( dark_line + x );
+            if constexpr( sizeof( T ) == 1 ) {
+                dark = _mm256_srli_epi16( dark, 8 );
+            }
+            val = _mm256_subs_epu16( val, dark );
+        }
+        if constexpr( has_gain ) {
+            val = apply_gain_16( val, load_16( gain_line + x ) );
+        }
+        store_16( dst_line + x, val );
+    }
+    correct_line_c( dst_line, src_line, dark_line, gain_line, x, dim_x );
+}
+
+template<class T, bool has_dark, bool has_gain>
+void calib_correct_avx2( const img::img_descriptor& dst, const img::img_descriptor& src, int y_beg, const params& p )
+{
+    for_each_correct_line<T>( dst, src, y_beg, p,
+        [dim_x = src.dim.cx]( T* dst_line, const T* src_line, const uint16_t* dark_line, const uint16_t* gain_line )
+        {
+            correct_line_avx2<T, has_dark, has_gain>( dst_line, src_line, dark_line, gain_line, dim_x );
+        } );
+}
+
+template<class T>
+void calib_correct_avx2( const img::img_descriptor& dst, const img::img_descriptor& src, int y_beg, const params& p )
+{
+    if( p.dark && p.gain ) {
+        calib_correct_avx2<T, true, true>( dst, src, y_beg, p );
+    } else if( p.dark ) {
+        calib_correct_avx2<T, true, false>( dst, src, y_beg, p );
+    } else if( p.gain ) {
+        calib_correct_avx2<T, false, true>( dst, src, y_beg, p );
+    } else {
+        calib_correct_avx2<T, false, false>( dst, src, y_beg, p );
+    }
+}
+
+}
+
+img_filter::filter::calib_correct::function_type     img_filter::filter::calib_correct::get_calib_correct_avx2( const img::img_type& dst, const img::img_type& src )
+{
+    if( !can_correct( dst, src ) ) {
+        return nullptr;
+    }
+    if( img::get_bits_per_pixel( src.fourcc_type() ) == 8 ) {
+        return ::calib_correct_avx2<uint8_t>;
+    }
+    return ::calib_correct_avx2<uint16_t>;
+}
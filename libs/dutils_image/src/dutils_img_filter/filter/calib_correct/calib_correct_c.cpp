@@ -0,0 +1,31 @@
+
+#include "calib_correct.h"
+#include "calib_correct_internal.h"
+
+namespace
+{
+
+using namespace calib_correct_internal;
+
+template<class T>
+void calib_correct_c( const img::img_descriptor& dst, const img::img_descriptor& src, int y_beg, const params& p )
+{
+    for_each_correct_line<T>( dst, src, y_beg, p,
+        [dim_x = src.dim.cx]( T* dst_line, const T* src_line, const uint16_t* dark_line, const uint16_t* gain_line )
+        {
+            correct_line_c( dst_line, src_line, dark_line, gain_line, 0, dim_x );
+        } );
+}
+
+}
+
+img_filter::filter::calib_correct::function_type     img_filter::filter::calib_correct::get_calib_correct_c( const img::img_type& dst, const img::img_type& src )
+{
+    if( !can_correct( dst, src ) ) {
+        return nullptr;
+    }
+    if( img::get_bits_per_pixel( src.fourcc_type() ) == 8 ) {
+        return ::calib_correct_c<uint8_t>;
+    }
+    return ::calib_correct_c<uint16_t>;
+}
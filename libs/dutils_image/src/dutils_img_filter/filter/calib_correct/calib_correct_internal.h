@@ -0,0 +1,119 @@
+#pragma once
+
+#include "calib_correct.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace calib_correct_internal
+{
+    using namespace img_filter::filter::calib_correct;
+
+    constexpr bool  can_correct( const img::img_type& dst, const img::img_type& src ) noexcept
+    {
+        if( dst.fourcc_type() != src.fourcc_type() || dst.dim != src.dim || src.dim.cx < 1 ) {
+            return false;
+        }
+        const auto fcc = src.fourcc_type();
+        return fcc == img::fourcc::MONO8 || fcc == img::fourcc::MONO16 || img::is_by8_fcc( fcc ) || img::is_by16_fcc( fcc );
+    }
+
+    template<class T>
+    constexpr uint32_t  get_max_value() noexcept
+    {
+        return sizeof( T ) == 1 ? 0xFF : 0xFFFF;
+    }
+
+    // 8-bit images use the upper 8 bits of the dark frame
+    template<class T>
+    FORCEINLINE uint32_t    to_dark_value( uint16_t dark ) noexcept
+    {
+        return sizeof( T ) == 1 ? dark >> 8 : dark;
+    }
+
+    // The SIMD variants calculate the same values, the products fit into 32 bits
+    template<class T>
+    FORCEINLINE T   correct_pixel( T src, const uint16_t* dark_line, const uint16_t* gain_line, int x ) noexcept
+    {
+        uint32_t val = src;
+        if( dark_line )
+        {
+            const uint32_t dark = to_dark_value<T>( dark_line[x] );
+            val = val > dark ? val - dark : 0;
+        }
+        if( gain_line ) {
+            val = (val * gain_line[x] + (1u << (gain_shift - 1))) >> gain_shift;
+        }
+        return static_cast<T>( std::min( val, get_max_value<T>() ) );
+    }
+
+    template<class T>
+    FORCEINLINE void    correct_line_c( T* dst_line, const T* src_line, const uint16_t* dark_line, const uint16_t* gain_line, int x_beg, int x_end ) noexcept
+    {
+        for( int x = x_beg; x < x_end; ++x ) {
+            dst_line[x] = correct_pixel( src_line[x], dark_line, gain_line, x );
+        }
+    }
+
+    // Replaces the defects of the line with their corrected neighbours, returns the first defect of a later line
+    template<class T>
+    FORCEINLINE const defect_pixel*     fix_defects( T* dst_line, const defect_pixel* it, const defect_pixel* end, int map_y, int offset_x, int dim_x, int step ) noexcept
+    {
+        for( ; it != end && it->y == map_y; ++it )
+        {
+            const int x = it->x - offset_x;
+            if( x < 0 || x >= dim_x ) {
+                continue;
+            }
+            const bool has_left = x - step >= 0;
+            const bool has_right = x + step < dim_x;
+            if( has_left && has_right ) {
+                dst_line[x] = static_cast<T>( (dst_line[x - step] + dst_line[x + step] + 1) / 2 );
+            } else if( has_left ) {
+                dst_line[x] = dst_line[x - step];
+            } else if( has_right ) {
+                dst_line[x] = dst_line[x + step];
+            }
+        }
+        return it;
+    }
+
+    // Calls func( dst_line, src_line, dark_line, gain_line ) for every line and fixes the defects afterwards.
+    // Lines outside of the maps are only copied.
+    template<class T, class TLineFunc>
+    FORCEINLINE void    for_each_correct_line( const img::img_descriptor& dst, const img::img_descriptor& src, int y_beg, const params& p, TLineFunc&& func ) noexcept
+    {
+        const int dim_x = src.dim.cx;
+        const int map_y_beg = p.offset_y + y_beg;
+        const bool fits_maps = p.offset_x >= 0 && map_y_beg >= 0
+            && p.offset_x + dim_x <= p.map_dim.cx && map_y_beg + src.dim.cy <= p.map_dim.cy;
+        if( !fits_maps )
+        {
+            if( dst.data() != src.data() )
+            {
+                for( int y = 0; y < src.dim.cy; ++y ) {
+                    memcpy( img::get_line_start<T>( dst, y ), img::get_line_start<const T>( src, y ), dim_x * sizeof( T ) );
+                }
+            }
+            return;
+        }
+
+        const int step = img::is_bayer_fcc( src.fourcc_type() ) ? 2 : 1;
+        const defect_pixel* defects_end = p.defects + p.defect_count;
+        const defect_pixel* defect = std::lower_bound( p.defects, defects_end, map_y_beg,
+            []( const defect_pixel& d, int y ) { return d.y < y; } );
+
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            const int map_y = map_y_beg + y;
+            const size_t map_offset = static_cast<size_t>( map_y ) * p.map_dim.cx + p.offset_x;
+
+            T* dst_line = img::get_line_start<T>( dst, y );
+            func( dst_line, img::get_line_start<const T>( src, y ),
+                p.dark ? p.dark + map_offset : nullptr,
+                p.gain ? p.gain + map_offset : nullptr );
+
+            defect = fix_defects( dst_line, defect, defects_end, map_y, p.offset_x, dim_x, step );
+        }
+    }
+}
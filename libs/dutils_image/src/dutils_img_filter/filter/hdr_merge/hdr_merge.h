@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../../dutils_img_base.h"
+
+namespace img_filter::filter::hdr_merge
+{
+    constexpr int   max_frame_count = 4;
+
+    struct params
+    {
+        // 2 to max_frame_count images of the bracket
+        int     count = 0;
+        // exposure of src[i], only the ratios are used
+        float   exposure[max_frame_count] = {};
+
+        // values above this fraction of the maximum of the source format are treated as clipped
+        float   saturation = 0.95f;
+        // Deviation of a frame from the reference, relative to the reference value, above which the frame is not used for a pixel.
+        // Keeps moving objects from being blended into ghosts.
+        float   ghost_tolerance = 0.125f;
+    };
+
+    /** Merges an exposure bracket into one linear HDR image.
+     *
+     * MONO8, MONO16 ->                 MONO16, MONOFloat
+     * bayer 8/16-bit ->                bayer 16-bit, bayer float, both with the pattern of the source
+     *
+     * All src images have the type of the source and the dimensions of dst.
+     * The values are scaled to the shortest exposure, its maximum becomes 0xFFFF or 1.f, so the result does not clip.
+     * Each pixel is the average of the frames that are not clipped, weighted by their exposure.
+     * The shortest exposure is the reference, frames that deviate from it by more than ghost_tolerance are left out for that pixel.
+     */
+    using function_type = void (*)( const img::img_descriptor& dst, const img::img_descriptor* src, const params& p );
+
+    function_type   get_hdr_merge_c( const img::img_type& dst, const img::img_type& src );
+    function_type   get_hdr_merge_avx2( const img::img_type& dst, const img::img_type& src );
+
+    // The 16-bit type merges of src are written to, 0 when src cannot be merged
+    img::fourcc     get_hdr_merge_dst_fcc16( img::fourcc src );
+}
@@ -0,0 +1,101 @@
+
+#include "hdr_merge.h"
+#include "hdr_merge_internal.h"
+
+#include "../../simd_helper/use_simd_avx2.h"
+
+/*
+ * Each step merges 8 pixels in float lanes, the rest of a line is done by the C line function.
+ * The calculations are done in the same order as in hdr_merge_internal::merge_pixel.
+ *
+ * No static __m256 constants are used, these would be initialized before the cpu features are checked.
+ */
+
+namespace
+{
+
+using namespace hdr_merge_internal;
+
+FORCEINLINE __m256      load_8( const uint8_t* src ) noexcept
+{
+    return _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( src ) ) ) );
+}
+
+FORCEINLINE __m256      load_8( const uint16_t* src ) noexcept
+{
+    return _mm256_cvtepi32_ps( _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) ) ) );
+}
+
+FORCEINLINE void        store_8( uint16_t* dst, __m256 val ) noexcept
+{
+    const __m256 scaled = _mm256_add_ps( _mm256_mul_ps( val, _mm256_set1_ps( 65535.f ) ), _mm256_set1_ps( 0.5f ) );
+    const __m256 clamped = _mm256_min_ps( _mm256_max_ps( scaled, _mm256_setzero_ps() ), _mm256_set1_ps( 65535.f ) );
+    // truncation, like the static_cast of the C variant
+    const __m256i v32 = _mm256_cvttps_epi32( clamped );
+    const __m128i v16 = _mm_packus_epi32( _mm256_castsi256_si128( v32 ), _mm256_extracti128_si256( v32, 1 ) );
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( dst ), v16 );
+}
+
+FORCEINLINE void        store_8( float* dst, __m256 val ) noexcept
+{
+    _mm256_storeu_ps( dst, val );
+}
+
+template<class TSrc>
+FORCEINLINE __m256      merge_8( const TSrc* const* lines, int x, const merge_factors& f ) noexcept
+{
+    const __m256 abs_mask = _mm256_castsi256_ps( _mm256_set1_epi32( 0x7FFFFFFF ) );
+
+    const __m256 ref = _mm256_mul_ps( load_8( lines[f.ref] + x ), _mm256_set1_ps( f.scale[f.ref] ) );
+    const __m256 tol = _mm256_add_ps( _mm256_mul_ps( ref, _mm256_set1_ps( f.ghost_tolerance ) ), _mm256_set1_ps( f.noise_floor ) );
+
+    __m256 sum = _mm256_mul_ps( ref, _mm256_set1_ps( f.weight[f.ref] ) );
+    __m256 wsum = _mm256_set1_ps( f.weight[f.ref] );
+    for( int i = 0; i < f.count; ++i )
+    {
+        if( i == f.ref ) {
+            continue;
+        }
+        const __m256 raw = load_8( lines[i] + x );
+        const __m256 val = _mm256_mul_ps( raw, _mm256_set1_ps( f.scale[i] ) );
+        const __m256 dev = _mm256_and_ps( _mm256_sub_ps( val, ref ), abs_mask );
+        const __m256 use = _mm256_and_ps( _mm256_cmp_ps( raw, _mm256_set1_ps( f.clip_level[i] ), _CMP_LE_OQ ),
+                                          _mm256_cmp_ps( dev, tol, _CMP_LE_OQ ) );
+        const __m256 w = _mm256_and_ps( use, _mm256_set1_ps( f.weight[i] ) );
+        sum = _mm256_add_ps( sum, _mm256_mul_ps( val, w ) );
+        wsum = _mm256_add_ps( wsum, w );
+    }
+    return _mm256_div_ps( sum, wsum );
+}
+
+template<class TSrc, class TDst>
+void hdr_merge_avx2( const img::img_descriptor& dst, const img::img_descriptor* src, const params& p )
+{
+    const merge_factors f = calc_factors( p, get_max_value<TSrc>() );
+    for_each_merge_line<TSrc, TDst>( dst, src, f.count,
+        [&f, dim_x = dst.dim.cx]( TDst* dst_line, const TSrc* const* lines )
+        {
+            int x = 0;
+            for( ; x + 8 <= dim_x; x += 8 )
+            {
+                store_8( dst_line + x, merge_8( lines, x, f ) );
+            }
+            merge_line_c( dst_line, lines, x, dim_x, f );
+        } );
+}
+
+}
+
+img_filter::filter::hdr_merge::function_type     img_filter::filter::hdr_merge::get_hdr_merge_avx2( const img::img_type& dst, const img::img_type& src )
+{
+    if( !can_merge( dst, src ) ) {
+        return nullptr;
+    }
+
+    const bool src8 = img::get_bits_per_pixel( src.fourcc_type() ) == 8;
+    const bool dst16 = dst.fourcc_type() == to_fcc16( src.fourcc_type() );
+    if( src8 ) {
+        return dst16 ? ::hdr_merge_avx2<uint8_t, uint16_t> : ::hdr_merge_avx2<uint8_t, float>;
+    }
+    return dst16 ? ::hdr_merge_avx2<uint16_t, uint16_t> : ::hdr_merge_avx2<uint16_t, float>;
+}
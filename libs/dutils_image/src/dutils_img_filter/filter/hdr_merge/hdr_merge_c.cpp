@@ -0,0 +1,40 @@
+
+#include "hdr_merge.h"
+#include "hdr_merge_internal.h"
+
+namespace
+{
+
+using namespace hdr_merge_internal;
+
+template<class TSrc, class TDst>
+void hdr_merge_c( const img::img_descriptor& dst, const img::img_descriptor* src, const params& p )
+{
+    const merge_factors f = calc_factors( p, get_max_value<TSrc>() );
+    for_each_merge_line<TSrc, TDst>( dst, src, f.count,
+        [&f, dim_x = dst.dim.cx]( TDst* dst_line, const TSrc* const* lines )
+        {
+            merge_line_c( dst_line, lines, 0, dim_x, f );
+        } );
+}
+
+}
+
+img_filter::filter::hdr_merge::function_type     img_filter::filter::hdr_merge::get_hdr_merge_c( const img::img_type& dst, const img::img_type& src )
+{
+    if( !can_merge( dst, src ) ) {
+        return nullptr;
+    }
+
+    const bool src8 = img::get_bits_per_pixel( src.fourcc_type() ) == 8;
+    const bool dst16 = dst.fourcc_type() == to_fcc16( src.fourcc_type() );
+    if( src8 ) {
+        return dst16 ? ::hdr_merge_c<uint8_t, uint16_t> : ::hdr_merge_c<uint8_t, float>;
+    }
+    return dst16 ? ::hdr_merge_c<uint16_t, uint16_t> : ::hdr_merge_c<uint16_t, float>;
+}
+
+img::fourcc     img_filter::filter::hdr_merge::get_hdr_merge_dst_fcc16( img::fourcc src )
+{
+    return to_fcc16( src );
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "hdr_merge.h"
+
+#include <dutils_img/image_bayer_pattern.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace hdr_merge_internal
+{
+    using namespace img_filter::filter::hdr_merge;
+
+    constexpr img::fourcc   to_fcc16( img::fourcc src ) noexcept
+    {
+        if( src == img::fourcc::MONO8 || src == img::fourcc::MONO16 ) {
+            return img::fourcc::MONO16;
+        }
+        if( img::is_by8_fcc( src ) || img::is_by16_fcc( src ) ) {
+            return img::by_transform::convert_bayer_fcc_to_bayer16_fcc( src );
+        }
+        return img::fourcc::FCC_NULL;
+    }
+
+    constexpr img::fourcc   to_fccfloat( img::fourcc src ) noexcept
+    {
+        if( src == img::fourcc::MONO8 || src == img::fourcc::MONO16 ) {
+            return img::fourcc::MONOFloat;
+        }
+        if( !img::is_by8_fcc( src ) && !img::is_by16_fcc( src ) ) {
+            return img::fourcc::FCC_NULL;
+        }
+        switch( img::by_transform::convert_bayer_fcc_to_pattern( src ) )
+        {
+        case img::by_transform::by_pattern::BG:     return img::fourcc::BGGRFloat;
+        case img::by_transform::by_pattern::GB:     return img::fourcc::GBRGFloat;
+        case img::by_transform::by_pattern::GR:     return img::fourcc::GRBGFloat;
+        case img::by_transform::by_pattern::RG:     return img::fourcc::RGGBFloat;
+        }
+        return img::fourcc::FCC_NULL;
+    }
+
+    constexpr bool  can_merge( const img::img_type& dst, const img::img_type& src ) noexcept
+    {
+        if( dst.dim != src.dim || src.dim.cx < 1 || src.dim.cy < 1 ) {
+            return false;
+        }
+        const auto fcc = dst.fourcc_type();
+        return fcc != img::fourcc::FCC_NULL && (fcc == to_fcc16( src.fourcc_type() ) || fcc == to_fccfloat( src.fourcc_type() ));
+    }
+
+    // Per frame factors, calculated once per image. The SIMD variants use the same values.
+    struct merge_factors
+    {
+        int     count = 0;
+        int     ref = 0;
+
+        // raw value * scale = value relative to the maximum of the shortest exposure
+        float   scale[max_frame_count] = {};
+        // relative to the shortest exposure
+        float   weight[max_frame_count] = {};
+        // raw values above are clipped
+        float   clip_level[max_frame_count] = {};
+
+        float   ghost_tolerance = 0.f;
+        // 2 raw steps of the reference, so that its noise in dark areas does not reject the other frames
+        float   noise_floor = 0.f;
+    };
+
+    inline merge_factors    calc_factors( const params& p, float max_value ) noexcept
+    {
+        merge_factors f;
+        f.count = std::clamp( p.count, 1, max_frame_count );
+
+        for( int i = 1; i < f.count; ++i ) {
+            if( p.exposure[i] < p.exposure[f.ref] ) {
+                f.ref = i;
+            }
+        }
+
+        const float e_ref = std::max( p.exposure[f.ref], 1e-6f );
+        for( int i = 0; i < f.count; ++i )
+        {
+            const float rel = std::max( p.exposure[i], 1e-6f ) / e_ref;
+            f.scale[i] = 1.f / (max_value * rel);
+            f.weight[i] = rel;
+            f.clip_level[i] = p.saturation * max_value;
+        }
+        f.ghost_tolerance = p.ghost_tolerance;
+        f.noise_floor = 2.f / max_value;
+        return f;
+    }
+
+    template<class TSrc>
+    FORCEINLINE float   merge_pixel( const TSrc* const* lines, int x, const merge_factors& f ) noexcept
+    {
+        const float ref = lines[f.ref][x] * f.scale[f.ref];
+        const float tol = ref * f.ghost_tolerance + f.noise_floor;
+
+        // the reference is always used, it is the only frame left in the highlights
+        float sum = ref * f.weight[f.ref];
+        float wsum = f.weight[f.ref];
+        for( int i = 0; i < f.count; ++i )
+        {
+            if( i == f.ref ) {
+                continue;
+            }
+            const float raw = lines[i][x];
+            const float val = raw * f.scale[i];
+            if( raw <= f.clip_level[i] && std::fabs( val - ref ) <= tol )
+            {
+                sum += val * f.weight[i];
+                wsum += f.weight[i];
+            }
+        }
+        return sum / wsum;
+    }
+
+    FORCEINLINE void    store_pixel( uint16_t* dst, float val ) noexcept
+    {
+        *dst = static_cast<uint16_t>( std::clamp( val * 65535.f + 0.5f, 0.f, 65535.f ) );
+    }
+
+    FORCEINLINE void    store_pixel( float* dst, float val ) noexcept
+    {
+        *dst = val;
+    }
+
+    template<class TSrc, class TDst>
+    FORCEINLINE void    merge_line_c( TDst* dst, const TSrc* const* lines, int x_beg, int x_end, const merge_factors& f ) noexcept
+    {
+        for( int x = x_beg; x < x_end; ++x ) {
+            store_pixel( dst + x, merge_pixel( lines, x, f ) );
+        }
+    }
+
+    template<class TSrc, class TDst, class TLineFunc>
+    FORCEINLINE void    for_each_merge_line( const img::img_descriptor& dst, const img::img_descriptor* src, int count, TLineFunc&& func ) noexcept
+    {
+        const TSrc* lines[max_frame_count] = {};
+        for( int y = 0; y < dst.dim.cy; ++y )
+        {
+            for( int i = 0; i < count; ++i ) {
+                lines[i] = img::get_line_start<const TSrc>( src[i], y );
+            }
+            func( img::get_line_start<TDst>( dst, y ), lines );
+        }
+    }
+
+    template<class TSrc>
+    constexpr float     get_max_value() noexcept
+    {
+        return sizeof( TSrc ) == 1 ? 255.f : 65535.f;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "../../dutils_img_base.h"
+#include "../../transform/transform_base.h"
+#include "../tone_map/tone_map.h"
+
+namespace img_filter::lut
+{
+    /* Lookup tables that white balance and gamma correct bayer images while converting them to 8 bit.
+     * There is one table per position in the 2x2 bayer tile, in the order x0y0, x1y0, x0y1, x1y1.
+     * by8 sources are looked up with their 8-bit value, all other sources with the 12 most significant bits of their 16-bit value.
+     */
+    struct by8_lut_data
+    {
+        static constexpr int index_bits16 = 12;
+
+        uint8_t     table8[4][256];
+        uint8_t     table16[4][1 << index_bits16];
+    };
+
+    /* out = 256 * (in * wb) ^ (1 / gamma), clipped to [0;255], with in in [0;1[.
+     * With gamma == 1 this is the result of the white balance functions.
+     */
+    void    fill_by8_lut( by8_lut_data& lut, img::by_transform::by_pattern pattern, const whitebalance_params& wb, float gamma ) noexcept;
+
+    /* out = 256 * curve( in * wb ) ^ (1 / gamma) for the 16-bit tables, the 8-bit tables are filled without the curve. */
+    void    fill_by8_lut( by8_lut_data& lut, img::by_transform::by_pattern pattern, const whitebalance_params& wb, float gamma,
+        const filter::tone_map::curve& curve ) noexcept;
+
+    /* dst must be a 8-bit bayer format with the pattern of src.
+     * src may be a by8 format (then dst may be src), a by16 format or a 10/12-bit (packed) bayer format.
+     * The tables are taken from params.by8_lut, which must be filled for the pattern of src.
+     * When params.tone_gain is set, its gains are applied to the values of the sources with more than 8 bits before they are looked up.
+     */
+    transform_function_param_type     get_transform_by_to_by8_lut_c( const img::img_type& dst, const img::img_type& src );
+}
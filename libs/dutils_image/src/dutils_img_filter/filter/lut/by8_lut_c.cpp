@@ -0,0 +1,226 @@
+
+#include "by8_lut.h"
+
+#include "../../transform/fcc1x_packed/fcc1x_packed_to_fcc16_internal.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace fcc1x_packed_internal;
+using img_filter::lut::by8_lut_data;
+using filter_params = img_filter::filter_params;
+namespace tone_map = img_filter::filter::tone_map;
+
+namespace
+{
+    constexpr int gain_chunk_size = 256;
+
+    /* The linear part is calculated like in the white balance functions, so that a gamma of 1 yields the same values.
+     * idx_count is 256 for the 8-bit table and 1 << index_bits16 for the 16-bit table. fac is the white balance factor with 64 ^= 1.f.
+     */
+    uint8_t calc_entry( int idx, int idx_count, int fac, float inv_gamma ) noexcept
+    {
+        const int lin = idx * fac;
+        const int max_lin = idx_count * 64;
+
+        int res = 0;
+        if( inv_gamma == 1.f ) {
+            res = lin / (max_lin / 256);
+        } else {
+            res = static_cast<int>( 256.f * std::pow( static_cast<float>( lin ) / max_lin, inv_gamma ) );
+        }
+        return res > 0xFF ? 0xFF : static_cast<uint8_t>( res );
+    }
+
+    void    fill_table( uint8_t* table, int idx_count, int fac, float inv_gamma ) noexcept
+    {
+        for( int idx = 0; idx < idx_count; ++idx ) {
+            table[idx] = calc_entry( idx, idx_count, fac, inv_gamma );
+        }
+    }
+
+    template<class TFunc>
+    FORCEINLINE void    apply_lut_lines( const img::img_descriptor& dst, const img::img_descriptor& src, TFunc apply_line )
+    {
+        int y = 0;
+        for( ; y < (src.dim.cy - 1); y += 2 )
+        {
+            apply_line( img::get_line_start<uint8_t>( dst, y + 0 ), img::get_line_start<const uint8_t>( src, y + 0 ), 0 );
+            apply_line( img::get_line_start<uint8_t>( dst, y + 1 ), img::get_line_start<const uint8_t>( src, y + 1 ), 2 );
+        }
+        if( y == (src.dim.cy - 1) )
+        {
+            apply_line( img::get_line_start<uint8_t>( dst, y + 0 ), img::get_line_start<const uint8_t>( src, y + 0 ), 0 );
+        }
+    }
+
+    void    transform_by8_lut_c( const img::img_descriptor& dst, const img::img_descriptor& src, filter_params& params )
+    {
+        assert( dst.dim == src.dim );
+        assert( params.by8_lut != nullptr );
+
+        const auto& lut = *params.by8_lut;
+        const int width = src.dim.cx;
+
+        apply_lut_lines( dst, src, [&lut, width]( uint8_t* dst_line, const uint8_t* src_line, int table_idx )
+        {
+            const uint8_t* t0 = lut.table8[table_idx + 0];
+            const uint8_t* t1 = lut.table8[table_idx + 1];
+
+            int x = 0;
+            for( ; x < (width - 1); x += 2 )
+            {
+                dst_line[x + 0] = t0[src_line[x + 0]];
+                dst_line[x + 1] = t1[src_line[x + 1]];
+            }
+            if( x == (width - 1) ) {
+                dst_line[x] = t0[src_line[x]];
+            }
+        } );
+    }
+
+    FORCEINLINE uint16_t    read_fcc16( const void* src_line, int x ) noexcept
+    {
+        return static_cast<const uint16_t*>( src_line )[x];
+    }
+
+    template<auto func>
+    void    transform_fcc16_lut_gain_c( const img::img_descriptor& dst, const img::img_descriptor& src, const by8_lut_data& lut, const tone_map::gain_map& gain_map )
+    {
+        constexpr int shift = 16 - by8_lut_data::index_bits16;
+
+        apply_lut_lines( dst, src, [&lut, &gain_map, width = src.dim.cx]( uint8_t* dst_line, const uint8_t* src_line, int table_idx )
+        {
+            const uint8_t* tables[2] = { lut.table16[table_idx + 0], lut.table16[table_idx + 1] };
+
+            uint16_t gains[gain_chunk_size];
+            for( int x_beg = 0; x_beg < width; x_beg += gain_chunk_size )
+            {
+                const int count = std::min( gain_chunk_size, width - x_beg );
+                tone_map::calc_line_gains( gain_map, src_line, x_beg, count, gains );
+                for( int i = 0; i < count; ++i )
+                {
+                    const int x = x_beg + i;
+                    dst_line[x] = tables[x & 1][tone_map::apply_gain( func( src_line, x ), gains[i] ) >> shift];
+                }
+            }
+        } );
+    }
+
+    template<auto func>
+    void    transform_fcc16_lut_c( const img::img_descriptor& dst, const img::img_descriptor& src, filter_params& params )
+    {
+        assert( dst.dim == src.dim );
+        assert( params.by8_lut != nullptr );
+
+        constexpr int shift = 16 - by8_lut_data::index_bits16;
+
+        const auto& lut = *params.by8_lut;
+        const int width = src.dim.cx;
+
+        if( params.tone_gain != nullptr )
+        {
+            transform_fcc16_lut_gain_c<func>( dst, src, lut, *params.tone_gain );
+            return;
+        }
+
+        apply_lut_lines( dst, src, [&lut, width]( uint8_t* dst_line, const uint8_t* src_line, int table_idx )
+        {
+            const uint8_t* t0 = lut.table16[table_idx + 0];
+            const uint8_t* t1 = lut.table16[table_idx + 1];
+
+            int x = 0;
+            for( ; x < (width - 1); x += 2 )
+            {
+                dst_line[x + 0] = t0[func( src_line, x + 0 ) >> shift];
+                dst_line[x + 1] = t1[func( src_line, x + 1 ) >> shift];
+            }
+            if( x == (width - 1) ) {
+                dst_line[x] = t0[func( src_line, x ) >> shift];
+            }
+        } );
+    }
+}
+
+void    img_filter::lut::fill_by8_lut( by8_lut_data& lut, img::by_transform::by_pattern pattern, const whitebalance_params& wb, float gamma ) noexcept
+{
+    fill_by8_lut( lut, pattern, wb, gamma, tone_map::curve{} );
+}
+
+void    img_filter::lut::fill_by8_lut( by8_lut_data& lut, img::by_transform::by_pattern pattern, const whitebalance_params& wb, float gamma,
+    const tone_map::curve& curve ) noexcept
+{
+    assert( gamma > 0.f );
+
+    constexpr int idx_count16 = 1 << by8_lut_data::index_bits16;
+
+    const img_filter::bayer_pattern_parameters wb_params{ pattern, wb };
+
+    const float gains[4] = { wb_params.wb_x0y0, wb_params.wb_x1y0, wb_params.wb_x0y1, wb_params.wb_x1y1 };
+    const float inv_gamma = 1.f / gamma;
+
+    // With a curve, it and the gamma are evaluated once per index and the white balance only moves the index
+    uint8_t mapped[idx_count16];
+    const bool apply_curve = !curve.is_identity();
+    if( apply_curve )
+    {
+        for( int idx = 0; idx < idx_count16; ++idx )
+        {
+            const float res = 256.f * std::pow( curve.eval( static_cast<float>( idx ) / idx_count16 ), inv_gamma );
+            mapped[idx] = static_cast<uint8_t>( CLIP( res, 0.f, 255.f ) );
+        }
+    }
+
+    for( int i = 0; i < 4; ++i )
+    {
+        const int fac8 = static_cast<int>( CLIP( gains[i] * 64.f, 0.f, 255.f ) );   // see wrap_apply_func_to_u8
+        const int fac16 = static_cast<int>( gains[i] * 64.f );                       // see transform_fcc1x_to_fcc8_c
+
+        fill_table( lut.table8[i], 256, fac8, inv_gamma );
+        if( !apply_curve ) {
+            fill_table( lut.table16[i], idx_count16, fac16, inv_gamma );
+            continue;
+        }
+        for( int idx = 0; idx < idx_count16; ++idx ) {
+            lut.table16[i][idx] = mapped[std::min( idx * fac16 / 64, idx_count16 - 1 )];
+        }
+    }
+}
+
+auto    img_filter::lut::get_transform_by_to_by8_lut_c( const img::img_type& dst, const img::img_type& src ) -> transform_function_param_type
+{
+    if( src.dim != dst.dim ) {
+        return nullptr;
+    }
+    if( !img::is_by8_fcc( dst.fourcc_type() ) ) {
+        return nullptr;
+    }
+    const auto pattern = img::by_transform::convert_bayer_fcc_to_pattern( src.fourcc_type() );
+    if( !img::is_bayer_fcc( src.fourcc_type() ) || pattern != img::by_transform::convert_bayer_fcc_to_pattern( dst.fourcc_type() ) ) {
+        return nullptr;
+    }
+
+    if( img::is_by8_fcc( src.fourcc_type() ) ) {
+        return &transform_by8_lut_c;
+    }
+    if( img::is_by16_fcc( src.fourcc_type() ) ) {
+        return &transform_fcc16_lut_c<&read_fcc16>;
+    }
+
+    using namespace img::fcc1x_packed;
+
+    switch( get_fcc1x_pack_type( src.fourcc_type() ) )
+    {
+    case fccXX_pack_type::fcc12:            return &transform_fcc16_lut_c<&calc_fcc12_to_fcc16>;
+    case fccXX_pack_type::fcc12_mipi:       return &transform_fcc16_lut_c<&calc_fcc12_mipi_to_fcc16>;
+    case fccXX_pack_type::fcc12_packed:     return &transform_fcc16_lut_c<&calc_fcc12_packed_to_fcc16>;
+    case fccXX_pack_type::fcc12_spacked:    return &transform_fcc16_lut_c<&calc_fcc12_spacked_to_fcc16>;
+
+    case fccXX_pack_type::fcc10:            return &transform_fcc16_lut_c<&calc_fcc10_to_fcc16>;
+    case fccXX_pack_type::fcc10_spacked:    return &transform_fcc16_lut_c<&calc_fcc10_spacked_to_fcc16>;
+    case fccXX_pack_type::fcc10_mipi:       return &transform_fcc16_lut_c<&calc_fcc10_packed_mipi_to_fcc16>;
+
+    case fccXX_pack_type::invalid:          return nullptr;
+    };
+    return nullptr;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "../../dutils_img_base.h"
+#include "../../transform/transform_base.h"
+#include "../tone_map/tone_map.h"
+
+namespace img_filter::lut
+{
+    /* Lookup tables for the conversions of MONO10/MONO12 (packed) and MONO16 to MONO8, MONO16, BGRA32 and MONOFloat.
+     * The sources are looked up with the 12 most significant bits of their 16-bit value.
+     */
+    struct mono_lut_data
+    {
+        static constexpr int index_bits = 12;
+
+        uint8_t     table8[1 << index_bits];
+        uint16_t    table16[1 << index_bits];
+        float       tablef[1 << index_bits];
+    };
+
+    /* Contrast stretching, the 16-bit values [black;white] are mapped to the whole range of the output, values outside are clipped.
+     * 0 <= black < white <= 0xFFFF
+     */
+    void    fill_mono_lut_contrast_stretch( mono_lut_data& lut, int black, int white ) noexcept;
+
+    /* Contrast stretching followed by the tone mapping curve, which gets the stretched values. */
+    void    fill_mono_lut_contrast_stretch( mono_lut_data& lut, int black, int white, const filter::tone_map::curve& curve ) noexcept;
+
+    /* src must be MONO10/MONO12 (packed) or MONO16, dst MONO8, MONO16, BGRA32 or MONOFloat.
+     * The tables are taken from params.mono_lut, which must be filled.
+     * BGRA32 gets table8, MONOFloat tablef.
+     * When params.tone_gain is set, its gains are applied to the 16-bit values before they are looked up.
+     */
+    transform_function_param_type     get_transform_mono_to_dst_lut_c( const img::img_type& dst, const img::img_type& src );
+}
@@ -0,0 +1,142 @@
+#include "mono_lut.h"
+
+#include "../../transform/fcc1x_packed/transform_fcc1x_mono_to_dst_internal.h"
+
+#include <algorithm>
+
+using namespace fcc1x_packed_internal;
+using img_filter::lut::mono_lut_data;
+using filter_params = img_filter::filter_params;
+namespace tone_map = img_filter::filter::tone_map;
+
+namespace
+{
+    using namespace img::pixel_type;
+    using fcc1x_mono_to_dst_internal::read_fcc16;
+
+    constexpr int index_shift = 16 - mono_lut_data::index_bits;
+    constexpr int gain_chunk_size = 256;
+
+    FORCEINLINE void    store_lut_pixel( uint8_t* dst_line, int x, const mono_lut_data& lut, int idx ) noexcept
+    {
+        dst_line[x] = lut.table8[idx];
+    }
+
+    FORCEINLINE void    store_lut_pixel( BGRA32* dst_line, int x, const mono_lut_data& lut, int idx ) noexcept
+    {
+        const uint8_t v = lut.table8[idx];
+        dst_line[x] = BGRA32{ v, v, v, 0xFF };
+    }
+
+    FORCEINLINE void    store_lut_pixel( uint16_t* dst_line, int x, const mono_lut_data& lut, int idx ) noexcept
+    {
+        dst_line[x] = lut.table16[idx];
+    }
+
+    FORCEINLINE void    store_lut_pixel( float* dst_line, int x, const mono_lut_data& lut, int idx ) noexcept
+    {
+        dst_line[x] = lut.tablef[idx];
+    }
+
+    // Every pixel is read before it is written, so MONO16 -> MONO8/MONO16 can be done in place
+    template<auto calc, class TDst>
+    void    transform_mono_lut_c( const img::img_descriptor& dst, const img::img_descriptor& src, filter_params& params )
+    {
+        assert( params.mono_lut != nullptr );
+
+        const auto& lut = *params.mono_lut;
+
+        if( params.tone_gain == nullptr )
+        {
+            fcc1x_mono_to_dst_internal::for_each_mono_line<TDst>( dst, src, [&lut, width = src.dim.cx]( TDst* dst_line, const uint8_t* src_line )
+            {
+                for( int x = 0; x < width; ++x ) {
+                    store_lut_pixel( dst_line, x, lut, calc( src_line, x ) >> index_shift );
+                }
+            } );
+            return;
+        }
+
+        const auto& gain_map = *params.tone_gain;
+        fcc1x_mono_to_dst_internal::for_each_mono_line<TDst>( dst, src, [&lut, &gain_map, width = src.dim.cx]( TDst* dst_line, const uint8_t* src_line )
+        {
+            uint16_t gains[gain_chunk_size];
+            for( int x_beg = 0; x_beg < width; x_beg += gain_chunk_size )
+            {
+                const int count = std::min( gain_chunk_size, width - x_beg );
+                tone_map::calc_line_gains( gain_map, src_line, x_beg, count, gains );
+                for( int i = 0; i < count; ++i ) {
+                    store_lut_pixel( dst_line, x_beg + i, lut, tone_map::apply_gain( calc( src_line, x_beg + i ), gains[i] ) >> index_shift );
+                }
+            }
+        } );
+    }
+
+    template<class TDst>
+    img_filter::transform_function_param_type     select_mono_lut_c( img::fourcc src_fcc )
+    {
+        if( src_fcc == img::fourcc::MONO16 ) {
+            return &transform_mono_lut_c<&read_fcc16, TDst>;
+        }
+
+        using namespace img::fcc1x_packed;
+
+        switch( get_fcc1x_pack_type( src_fcc ) )
+        {
+        case fccXX_pack_type::fcc12:            return &transform_mono_lut_c<&calc_fcc12_to_fcc16, TDst>;
+        case fccXX_pack_type::fcc12_mipi:       return &transform_mono_lut_c<&calc_fcc12_mipi_to_fcc16, TDst>;
+        case fccXX_pack_type::fcc12_packed:     return &transform_mono_lut_c<&calc_fcc12_packed_to_fcc16, TDst>;
+        case fccXX_pack_type::fcc12_spacked:    return &transform_mono_lut_c<&calc_fcc12_spacked_to_fcc16, TDst>;
+
+        case fccXX_pack_type::fcc10:            return &transform_mono_lut_c<&calc_fcc10_to_fcc16, TDst>;
+        case fccXX_pack_type::fcc10_spacked:    return &transform_mono_lut_c<&calc_fcc10_spacked_to_fcc16, TDst>;
+        case fccXX_pack_type::fcc10_mipi:       return &transform_mono_lut_c<&calc_fcc10_packed_mipi_to_fcc16, TDst>;
+
+        case fccXX_pack_type::invalid:          return nullptr;
+        };
+        return nullptr;
+    }
+}
+
+void    img_filter::lut::fill_mono_lut_contrast_stretch( mono_lut_data& lut, int black, int white ) noexcept
+{
+    fill_mono_lut_contrast_stretch( lut, black, white, tone_map::curve{} );
+}
+
+void    img_filter::lut::fill_mono_lut_contrast_stretch( mono_lut_data& lut, int black, int white, const tone_map::curve& curve ) noexcept
+{
+    assert( 0 <= black && black < white && white <= 0xFFFF );
+
+    const bool apply_curve = !curve.is_identity();
+
+    const float scale = 1.f / static_cast<float>( white - black );
+    for( int idx = 0; idx < (1 << mono_lut_data::index_bits); ++idx )
+    {
+        const int val = idx << index_shift;
+        float n = std::clamp( static_cast<float>( val - black ) * scale, 0.f, 1.f );
+        if( apply_curve ) {
+            n = curve.eval( n );
+        }
+
+        lut.table8[idx] = static_cast<uint8_t>( n * 255.f + 0.5f );
+        lut.table16[idx] = static_cast<uint16_t>( n * 65535.f + 0.5f );
+        lut.tablef[idx] = n;
+    }
+}
+
+auto    img_filter::lut::get_transform_mono_to_dst_lut_c( const img::img_type& dst, const img::img_type& src ) -> transform_function_param_type
+{
+    if( src.dim != dst.dim || !fcc1x_mono_to_dst_internal::is_accepted_src_fcc( src.fourcc_type() ) ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::MONO8:        return select_mono_lut_c<uint8_t>( src.fourcc_type() );
+    case img::fourcc::BGRA32:       return select_mono_lut_c<BGRA32>( src.fourcc_type() );
+    case img::fourcc::MONO16:       return select_mono_lut_c<uint16_t>( src.fourcc_type() );
+    case img::fourcc::MONOFloat:    return select_mono_lut_c<float>( src.fourcc_type() );
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "../../dutils_img_base.h"
+
+namespace img_filter::filter::tone_map
+{
+    /* Global operators, they map the linear values x in [0;1] of a source with more than 8 bits to [0;1] before the values are reduced.
+     * w is the white point of the image and a its log-average, see calc_curve.
+     */
+    enum class op
+    {
+        linear,         // x / w
+        gamma,          // (x / w) ^ (1 / 2.2)
+        log,            // log( 1 + x / a ) / log( 1 + w / a )
+        reinhard,       // extended Reinhard, L * (1 + L / Lw^2) / (1 + L) with L = 0.18 * x / a and Lw = 0.18 * w / a
+    };
+
+    /* Sparse statistics of one image, shared by the global curve and the local gains.
+     * Only every 8th 2x2 block in x and y is sampled, so collecting them reads 1/16 of the pixels.
+     */
+    struct statistics
+    {
+        static constexpr int bin_bits = 10;     // the histogram has the 10 most significant bits of the 16-bit values
+        static constexpr int max_tiles = 8;
+
+        uint32_t    bins[1 << bin_bits];
+        uint32_t    count = 0;
+
+        // the image is split into tiles_x * tiles_y tiles of at least 64x64 pixels
+        img::dim    dim;
+        int         tiles_x = 0;
+        int         tiles_y = 0;
+        float       tile_log_sum[max_tiles][max_tiles];
+        uint32_t    tile_count[max_tiles][max_tiles];
+    };
+
+    /* src must be a MONO16 or 16-bit bayer format or a 10/12-bit (packed) mono or bayer format.
+     * The 2x2 blocks are averaged, so the statistics of bayer images do not depend on the pattern.
+     */
+    using statistics_function_type = void (*)( statistics& stats, const img::img_descriptor& src );
+
+    statistics_function_type    get_collect_statistics_c( img::fourcc src );
+
+    struct curve
+    {
+        op      oper = op::linear;
+        float   white = 1.f;        // w
+        float   log_avg = 0.18f;    // a
+
+        bool    is_identity() const noexcept { return oper == op::linear && white == 1.f; }
+
+        bool    operator==( const curve& other ) const noexcept { return oper == other.oper && white == other.white && log_avg == other.log_avg; }
+        bool    operator!=( const curve& other ) const noexcept { return !(*this == other); }
+
+        // x is a linear value in [0;1], the result is clipped to [0;1]
+        float   eval( float x ) const noexcept;
+    };
+
+    /* The white point of gamma, log and reinhard is the 99.5th percentile of the histogram, the white point of linear stays 1.
+     * Without samples, w = 1 and a = 0.18.
+     */
+    curve   calc_curve( op oper, const statistics& stats ) noexcept;
+
+    /* Gains that lift or darken every tile towards the log-average of the image, bilinearly interpolated between the tile centers.
+     * Applied to the 16-bit values before the global curve.
+     */
+    struct gain_map
+    {
+        static constexpr int frac_bits = 8;     // 1 << frac_bits ^= 1.f
+
+        img::dim    dim;
+        int         tiles_x = 1;
+        int         tiles_y = 1;
+        uint16_t    gain[statistics::max_tiles][statistics::max_tiles] = {};
+
+        // first line and pitch of the image the gains belong to, the lines passed to calc_line_gains are located by their address
+        const uint8_t*  origin = nullptr;
+        int             pitch = 0;
+    };
+
+    /* gain = (a / a_tile) ^ strength, clipped to [1/8;8]. strength in [0;1], 0 yields a gain of 1 for every tile. */
+    void    calc_gain_map( gain_map& map, const statistics& stats, float strength ) noexcept;
+
+    /* Writes the gains of the pixels [x_beg;x_beg + count) of the line line_start of the image of map.origin to gains. */
+    void    calc_line_gains( const gain_map& map, const void* line_start, int x_beg, int count, uint16_t* gains ) noexcept;
+
+    FORCEINLINE uint16_t    apply_gain( uint16_t val, uint16_t gain ) noexcept
+    {
+        const uint32_t res = (static_cast<uint32_t>( val ) * gain) >> gain_map::frac_bits;
+        return res > 0xFFFF ? 0xFFFF : static_cast<uint16_t>( res );
+    }
+}
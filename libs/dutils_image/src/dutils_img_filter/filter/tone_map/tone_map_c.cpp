@@ -0,0 +1,240 @@
+
+#include "tone_map.h"
+
+#include "../../transform/fcc1x_packed/fcc1x_packed_to_fcc16_internal.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+using namespace fcc1x_packed_internal;
+using namespace img_filter::filter::tone_map;
+
+namespace
+{
+    constexpr int   bin_count = 1 << statistics::bin_bits;
+    constexpr int   sample_step = 8;
+    constexpr int   min_tile_size = 64;
+
+    // log of the center of every bin, so the samples do not need a log each
+    const std::array<float, bin_count>&     get_log_table() noexcept
+    {
+        static const auto table = []
+        {
+            std::array<float, bin_count> rval = {};
+            for( int i = 0; i < bin_count; ++i ) {
+                rval[i] = std::log( (i + 0.5f) / bin_count );
+            }
+            return rval;
+        }();
+        return table;
+    }
+
+    FORCEINLINE uint16_t    read_fcc16( const void* src_line, int x ) noexcept
+    {
+        return static_cast<const uint16_t*>( src_line )[x];
+    }
+
+    template<auto read>
+    void    collect_statistics_c( statistics& stats, const img::img_descriptor& src )
+    {
+        const auto& log_table = get_log_table();
+
+        // the 4 samples of a block add 2 bits
+        constexpr int shift = 16 + 2 - statistics::bin_bits;
+
+        std::fill( std::begin( stats.bins ), std::end( stats.bins ), 0u );
+        std::fill( &stats.tile_log_sum[0][0], &stats.tile_log_sum[0][0] + statistics::max_tiles * statistics::max_tiles, 0.f );
+        std::fill( &stats.tile_count[0][0], &stats.tile_count[0][0] + statistics::max_tiles * statistics::max_tiles, 0u );
+
+        stats.dim = src.dim;
+        stats.tiles_x = std::clamp( src.dim.cx / min_tile_size, 1, statistics::max_tiles );
+        stats.tiles_y = std::clamp( src.dim.cy / min_tile_size, 1, statistics::max_tiles );
+
+        uint32_t count = 0;
+        for( int y = 0; y < (src.dim.cy - 1); y += sample_step )
+        {
+            const auto* line0 = img::get_line_start<const uint8_t>( src, y + 0 );
+            const auto* line1 = img::get_line_start<const uint8_t>( src, y + 1 );
+            const int ty = y * stats.tiles_y / src.dim.cy;
+
+            for( int x = 0; x < (src.dim.cx - 1); x += sample_step )
+            {
+                const uint32_t sum = read( line0, x + 0 ) + read( line0, x + 1 ) + read( line1, x + 0 ) + read( line1, x + 1 );
+                const uint32_t bin = sum >> shift;
+                const int tx = x * stats.tiles_x / src.dim.cx;
+
+                ++stats.bins[bin];
+                stats.tile_log_sum[ty][tx] += log_table[bin];
+                ++stats.tile_count[ty][tx];
+                ++count;
+            }
+        }
+        stats.count = count;
+    }
+}
+
+auto    img_filter::filter::tone_map::get_collect_statistics_c( img::fourcc src ) -> statistics_function_type
+{
+    if( src == img::fourcc::MONO16 || img::is_by16_fcc( src ) ) {
+        return &collect_statistics_c<&read_fcc16>;
+    }
+
+    using namespace img::fcc1x_packed;
+
+    switch( get_fcc1x_pack_type( src ) )
+    {
+    case fccXX_pack_type::fcc12:            return &collect_statistics_c<&calc_fcc12_to_fcc16>;
+    case fccXX_pack_type::fcc12_mipi:       return &collect_statistics_c<&calc_fcc12_mipi_to_fcc16>;
+    case fccXX_pack_type::fcc12_packed:     return &collect_statistics_c<&calc_fcc12_packed_to_fcc16>;
+    case fccXX_pack_type::fcc12_spacked:    return &collect_statistics_c<&calc_fcc12_spacked_to_fcc16>;
+
+    case fccXX_pack_type::fcc10:            return &collect_statistics_c<&calc_fcc10_to_fcc16>;
+    case fccXX_pack_type::fcc10_spacked:    return &collect_statistics_c<&calc_fcc10_spacked_to_fcc16>;
+    case fccXX_pack_type::fcc10_mipi:       return &collect_statistics_c<&calc_fcc10_packed_mipi_to_fcc16>;
+
+    case fccXX_pack_type::invalid:          return nullptr;
+    };
+    return nullptr;
+}
+
+float   img_filter::filter::tone_map::curve::eval( float x ) const noexcept
+{
+    constexpr float key = 0.18f;
+
+    float res = 0.f;
+    switch( oper )
+    {
+    case op::linear:
+        res = x / white;
+        break;
+    case op::gamma:
+        res = std::pow( std::min( x / white, 1.f ), 1.f / 2.2f );
+        break;
+    case op::log:
+        res = std::log1p( x / log_avg ) / std::log1p( white / log_avg );
+        break;
+    case op::reinhard:
+    {
+        const float l = key * x / log_avg;
+        const float l_white = key * white / log_avg;
+        res = l * (1.f + l / (l_white * l_white)) / (1.f + l);
+        break;
+    }
+    };
+    return std::clamp( res, 0.f, 1.f );
+}
+
+curve   img_filter::filter::tone_map::calc_curve( op oper, const statistics& stats ) noexcept
+{
+    curve rval;
+    rval.oper = oper;
+    if( stats.count == 0 ) {
+        return rval;
+    }
+
+    const auto& log_table = get_log_table();
+
+    double log_sum = 0.;
+    for( int i = 0; i < bin_count; ++i ) {
+        log_sum += stats.bins[i] * static_cast<double>( log_table[i] );
+    }
+    rval.log_avg = static_cast<float>( std::exp( log_sum / stats.count ) );
+
+    if( oper != op::linear )
+    {
+        // 0.5% of the samples are allowed to clip
+        const uint32_t clipped = stats.count / 200;
+
+        uint32_t above = 0;
+        int i = bin_count - 1;
+        for( ; i > 0; --i )
+        {
+            above += stats.bins[i];
+            if( above > clipped ) {
+                break;
+            }
+        }
+        rval.white = std::max( static_cast<float>( i + 1 ) / bin_count, rval.log_avg );
+    }
+    return rval;
+}
+
+void    img_filter::filter::tone_map::calc_gain_map( gain_map& map, const statistics& stats, float strength ) noexcept
+{
+    constexpr float one = 1 << gain_map::frac_bits;
+
+    map.dim = stats.dim;
+    map.tiles_x = std::max( stats.tiles_x, 1 );
+    map.tiles_y = std::max( stats.tiles_y, 1 );
+
+    float log_sum = 0.f;
+    for( int ty = 0; ty < stats.tiles_y; ++ty ) {
+        for( int tx = 0; tx < stats.tiles_x; ++tx ) {
+            log_sum += stats.tile_log_sum[ty][tx];
+        }
+    }
+    const float log_avg = stats.count ? log_sum / stats.count : 0.f;
+
+    for( int ty = 0; ty < map.tiles_y; ++ty )
+    {
+        for( int tx = 0; tx < map.tiles_x; ++tx )
+        {
+            float gain = 1.f;
+            if( ty < stats.tiles_y && tx < stats.tiles_x && stats.tile_count[ty][tx] != 0 )
+            {
+                const float tile_log_avg = stats.tile_log_sum[ty][tx] / stats.tile_count[ty][tx];
+                gain = std::clamp( std::exp( strength * (log_avg - tile_log_avg) ), 1.f / 8.f, 8.f );
+            }
+            map.gain[ty][tx] = static_cast<uint16_t>( gain * one + 0.5f );
+        }
+    }
+}
+
+void    img_filter::filter::tone_map::calc_line_gains( const gain_map& map, const void* line_start, int x_beg, int count, uint16_t* gains ) noexcept
+{
+    const auto offset = static_cast<const uint8_t*>( line_start ) - map.origin;
+    const int y = std::clamp( static_cast<int>( offset / map.pitch ), 0, map.dim.cy - 1 );
+
+    // the gains of the tiles are at their centers, the gains of this line are interpolated between the tile rows
+    const float tile_cy = static_cast<float>( map.dim.cy ) / map.tiles_y;
+    const float fy = std::clamp( (y + 0.5f) / tile_cy - 0.5f, 0.f, static_cast<float>( map.tiles_y - 1 ) );
+    const int ty0 = static_cast<int>( fy );
+    const int ty1 = std::min( ty0 + 1, map.tiles_y - 1 );
+    const float wy = fy - ty0;
+
+    // gains of this line at the tile centers, with 16 more fractional bits
+    int32_t row[statistics::max_tiles];
+    int centers[statistics::max_tiles];
+    const float tile_cx = static_cast<float>( map.dim.cx ) / map.tiles_x;
+    for( int tx = 0; tx < map.tiles_x; ++tx )
+    {
+        const float gain = map.gain[ty0][tx] + (map.gain[ty1][tx] - map.gain[ty0][tx]) * wy + 0.5f;
+        row[tx] = static_cast<int32_t>( gain * 65536.f );
+        centers[tx] = static_cast<int>( (tx + 0.5f) * tile_cx );
+    }
+
+    // Segment k lies between the centers k and k + 1, the gains are constant before the first and after the last center.
+    // The segments are plain integer loops the compiler can vectorize.
+    const int x_end = x_beg + count;
+    int x = x_beg;
+    for( int k = -1; k < map.tiles_x && x < x_end; ++k )
+    {
+        const int seg_end = k + 1 < map.tiles_x ? std::min( centers[k + 1], x_end ) : x_end;
+        if( k < 0 || k + 1 == map.tiles_x )
+        {
+            const auto gain = static_cast<uint16_t>( row[k < 0 ? 0 : k] >> 16 );
+            for( ; x < seg_end; ++x ) {
+                gains[x - x_beg] = gain;
+            }
+        }
+        else
+        {
+            const int32_t step = (row[k + 1] - row[k]) / (centers[k + 1] - centers[k]);
+            int32_t acc = row[k] + step * (x - centers[k]);
+            for( ; x < seg_end; ++x, acc += step ) {
+                gains[x - x_beg] = static_cast<uint16_t>( acc >> 16 );
+            }
+        }
+    }
+}
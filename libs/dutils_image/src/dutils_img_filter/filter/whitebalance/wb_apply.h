@@ -18,13 +18,22 @@ namespace img_filter::whitebalance
     {
         void		apply_wb_by8_c( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb );
         void		apply_wb_by8_sse2( const img::img_descriptor& data, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb );
+        void		apply_wb_by8_avx2( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb );
+        void		apply_wb_by8_avx512( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb );
         void		apply_wb_by8_neon( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb );
+        void		apply_wb_by8_sve2( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb );
 
         void		apply_wb_by16_c( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb );
         void		apply_wb_by16_sse4_1( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb );
+        void		apply_wb_by16_avx2( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb );
+        void		apply_wb_by16_avx512( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb );
         void		apply_wb_by16_neon( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb );
+        void		apply_wb_by16_sve2( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb );
 
         void		apply_wb_byfloat_c( const img::img_descriptor& dst, const apply_params& params );
+        void		apply_wb_byfloat_sse41( const img::img_descriptor& dst, const apply_params& params );
+        void		apply_wb_byfloat_avx2( const img::img_descriptor& dst, const apply_params& params );
+        void		apply_wb_byfloat_neon( const img::img_descriptor& dst, const apply_params& params );
     }
 
     using old_func_type = void (*)(const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb);
@@ -44,6 +53,9 @@ namespace img_filter::whitebalance
 
     func_type  get_apply_img_c( img::img_type dst );
     func_type  get_apply_img_sse41( img::img_type dst );
+    func_type  get_apply_img_avx2( img::img_type dst );
+    func_type  get_apply_img_avx512( img::img_type dst );     // needs AVX-512 F and BW
     func_type  get_apply_img_neon( img::img_type dst );
+    func_type  get_apply_img_sve2( img::img_type dst );       // BY8 and BY16, returns nullptr when not built with SVE2
 }
 
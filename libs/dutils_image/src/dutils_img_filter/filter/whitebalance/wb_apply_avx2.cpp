@@ -0,0 +1,125 @@
+
+#include "wb_apply.h"
+
+#include "../../simd_helper/use_simd_avx2.h"
+
+namespace {
+
+FORCEINLINE
+__m256i	    wb_by8_avx2_step_( __m256i src, __m256i mul ) noexcept
+{
+    // unpack/pack both work per 128-bit lane, so the pixel order is preserved
+    const __m256i lo = _mm256_unpacklo_epi8( src, _mm256_setzero_si256() );
+    const __m256i hi = _mm256_unpackhi_epi8( src, _mm256_setzero_si256() );
+
+    const __m256i res_lo = _mm256_srli_epi16( _mm256_mullo_epi16( lo, mul ), 6 );
+    const __m256i res_hi = _mm256_srli_epi16( _mm256_mullo_epi16( hi, mul ), 6 );
+
+    return _mm256_packus_epi16( res_lo, res_hi );
+}
+
+FORCEINLINE
+__m256i	    wb_by16_avx2_step_( __m256i src, __m256i mul ) noexcept
+{
+    const __m256i lo = _mm256_unpacklo_epi16( src, _mm256_setzero_si256() );
+    const __m256i hi = _mm256_unpackhi_epi16( src, _mm256_setzero_si256() );
+
+    const __m256i res_lo = _mm256_srli_epi32( _mm256_mullo_epi32( lo, mul ), 6 );
+    const __m256i res_hi = _mm256_srli_epi32( _mm256_mullo_epi32( hi, mul ), 6 );
+
+    return _mm256_packus_epi32( res_lo, res_hi );
+}
+
+template<typename TPixel, __m256i (*step)( __m256i, __m256i )>
+static void    wb_line_avx2( TPixel* line, int dim_x, __m256i f0, __m256i f1 ) noexcept
+{
+    constexpr int pixel_per_step = sizeof( __m256i ) / sizeof( TPixel );
+
+    assert( dim_x >= pixel_per_step );
+
+    // the last block overlaps the main loop, so it has to be loaded before the loop writes to it
+    const __m256i last = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( line + dim_x - pixel_per_step ) );
+
+    int x = 0;
+    for( ; x < (dim_x - (pixel_per_step - 1)); x += pixel_per_step )
+    {
+        const __m256i src = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( line + x ) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( line + x ), step( src, f0 ) );
+    }
+
+    if( x != dim_x )
+    {
+        const __m256i res = step( last, (dim_x % 2 == 0) ? f0 : f1 );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( line + dim_x - pixel_per_step ), res );
+    }
+}
+
+template<typename TPixel, __m256i (*step)( __m256i, __m256i )>
+static void	wb_image_avx2( img::img_descriptor dst, __m256i factor00, __m256i factor01, __m256i factor10, __m256i factor11 ) noexcept
+{
+    int y = 0;
+    for( ; y < (dst.dim.cy - 1); y += 2 )
+    {
+        wb_line_avx2<TPixel, step>( img::get_line_start<TPixel>( dst, y + 0 ), dst.dim.cx, factor00, factor01 );
+        wb_line_avx2<TPixel, step>( img::get_line_start<TPixel>( dst, y + 1 ), dst.dim.cx, factor10, factor11 );
+    }
+    if( y == (dst.dim.cy - 1) )
+    {
+        wb_line_avx2<TPixel, step>( img::get_line_start<TPixel>( dst, y + 0 ), dst.dim.cx, factor00, factor01 );
+    }
+}
+
+template<typename TPixel>
+static __m256i fill_factors( uint8_t fac0, uint8_t fac1 ) noexcept
+{
+    if constexpr( sizeof( TPixel ) == 1 ) {
+        return _mm256_set1_epi32( (fac1 << 16) | fac0 );
+    } else {
+        return _mm256_set1_epi64x( (int64_t( fac1 ) << 32) | fac0 );
+    }
+}
+
+template<typename TPixel, __m256i (*step)( __m256i, __m256i )>
+static void	apply_wb_avx2( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb ) noexcept
+{
+    if( wb_r == 64 && wb_gr == 64 && wb_b == 64 && wb_gb == 64 ) {
+        return;
+    }
+
+    const __m256i bg = fill_factors<TPixel>( wb_b, wb_gb );
+    const __m256i gb = fill_factors<TPixel>( wb_gb, wb_b );
+    const __m256i gr = fill_factors<TPixel>( wb_gr, wb_r );
+    const __m256i rg = fill_factors<TPixel>( wb_r, wb_gr );
+
+    switch( img::by_transform::convert_bayer_fcc_to_pattern( dst.fourcc_type() ) )
+    {
+    case img::by_transform::by_pattern::BG:	wb_image_avx2<TPixel, step>( dst, bg, gb, gr, rg ); break;
+    case img::by_transform::by_pattern::GB:	wb_image_avx2<TPixel, step>( dst, gb, bg, rg, gr ); break;
+    case img::by_transform::by_pattern::GR:	wb_image_avx2<TPixel, step>( dst, gr, rg, bg, gb ); break;
+    case img::by_transform::by_pattern::RG:	wb_image_avx2<TPixel, step>( dst, rg, gr, gb, bg ); break;
+    };
+}
+
+}
+
+void		img_filter::whitebalance::detail::apply_wb_by8_avx2( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb )
+{
+    apply_wb_avx2<uint8_t, wb_by8_avx2_step_>( dst, wb_r, wb_gr, wb_b, wb_gb );
+}
+
+void		img_filter::whitebalance::detail::apply_wb_by16_avx2( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb )
+{
+    apply_wb_avx2<uint16_t, wb_by16_avx2_step_>( dst, wb_r, wb_gr, wb_b, wb_gb );
+}
+
+auto    img_filter::whitebalance::get_apply_img_avx2( img::img_type dst ) -> img_filter::whitebalance::func_type
+{
+    if( img::is_by8_fcc( dst.fourcc_type() ) && dst.dim.cx >= 32 ) {
+        return &wrap_apply_func_to_u8<detail::apply_wb_by8_avx2>;
+    } else if( img::is_by16_fcc( dst.fourcc_type() ) && dst.dim.cx >= 16 ) {
+        return &wrap_apply_func_to_u8<detail::apply_wb_by16_avx2>;
+    } else if( img::is_byfloat_fcc( dst.fourcc_type() ) ) {
+        return detail::apply_wb_byfloat_avx2;
+    }
+    return nullptr;
+}
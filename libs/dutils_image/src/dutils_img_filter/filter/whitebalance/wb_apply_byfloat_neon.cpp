@@ -0,0 +1,68 @@
+#include "wb_apply.h"
+
+#include "../../simd_helper/use_simd_A64.h"
+
+namespace {
+
+FORCEINLINE float wb_pixel_byf( float pixel, float factor ) noexcept
+{
+    float val = pixel * factor;
+    return val > 1.f ? 1.f : val;
+}
+
+void wb_line_byf_neon( float* dst_line, int dim_x, float factor_00, float factor_01 ) noexcept
+{
+    // even pixels get factor_00, odd pixels factor_01, each step starts at an even pixel
+    const float32x4_t factors = vcombine_f32( vset_lane_f32( factor_01, vdup_n_f32( factor_00 ), 1 ), vset_lane_f32( factor_01, vdup_n_f32( factor_00 ), 1 ) );
+    const float32x4_t one = vdupq_n_f32( 1.f );
+
+    int x = 0;
+    for( ; x < (dim_x - (4 - 1)); x += 4 )
+    {
+        const float32x4_t val = vmulq_f32( vld1q_f32( dst_line + x ), factors );
+        // min( one, val ) keeps NaNs like the C variant
+        vst1q_f32( dst_line + x, vminq_f32( one, val ) );
+    }
+    for( ; x < (dim_x - 1); x += 2 )
+    {
+        dst_line[x + 0] = wb_pixel_byf( dst_line[x + 0], factor_00 );
+        dst_line[x + 1] = wb_pixel_byf( dst_line[x + 1], factor_01 );
+    }
+    if( x == (dim_x - 1) )
+    {
+        dst_line[x] = wb_pixel_byf( dst_line[x], factor_00 );
+    }
+}
+
+void	wb_image_byf_neon( img::img_descriptor dst, float factor_00, float factor_01, float factor_10, float factor_11 ) noexcept
+{
+    int y = 0;
+    for( ; y < (dst.dim.cy - 1); y += 2 )
+    {
+        wb_line_byf_neon( img::get_line_start<float>( dst, y + 0 ), dst.dim.cx, factor_00, factor_01 );		// even line
+        wb_line_byf_neon( img::get_line_start<float>( dst, y + 1 ), dst.dim.cx, factor_10, factor_11 );		// odd line
+    }
+    if( y == (dst.dim.cy - 1) )
+    {
+        wb_line_byf_neon( img::get_line_start<float>( dst, y + 0 ), dst.dim.cx, factor_00, factor_01 );
+    }
+}
+
+}
+
+void		img_filter::whitebalance::detail::apply_wb_byfloat_neon( const img::img_descriptor& dst, const apply_params& params )
+{
+    if( params.wb_rr == 1.f && params.wb_gr == 1.f && params.wb_bb == 1.f && params.wb_gb == 1.f ) {
+        return;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGGRFloat:	wb_image_byf_neon( dst, params.wb_bb, params.wb_gb, params.wb_gr, params.wb_rr ); break;
+    case img::fourcc::GBRGFloat:	wb_image_byf_neon( dst, params.wb_gb, params.wb_bb, params.wb_rr, params.wb_gr ); break;
+    case img::fourcc::GRBGFloat:	wb_image_byf_neon( dst, params.wb_gr, params.wb_rr, params.wb_bb, params.wb_gb ); break;
+    case img::fourcc::RGGBFloat:	wb_image_byf_neon( dst, params.wb_rr, params.wb_gr, params.wb_gb, params.wb_bb ); break;
+    default:
+        return;
+    };
+}
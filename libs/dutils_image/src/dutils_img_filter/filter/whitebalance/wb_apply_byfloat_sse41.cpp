@@ -0,0 +1,68 @@
+#include "wb_apply.h"
+
+#include "../../simd_helper/use_simd_sse41.h"
+
+namespace {
+
+FORCEINLINE float wb_pixel_byf( float pixel, float factor ) noexcept
+{
+    float val = pixel * factor;
+    return val > 1.f ? 1.f : val;
+}
+
+void wb_line_byf_sse41( float* dst_line, int dim_x, float factor_00, float factor_01 ) noexcept
+{
+    // even pixels get factor_00, odd pixels factor_01, each step starts at an even pixel
+    const __m128 factors = _mm_setr_ps( factor_00, factor_01, factor_00, factor_01 );
+    const __m128 one = _mm_set1_ps( 1.f );
+
+    int x = 0;
+    for( ; x < (dim_x - (4 - 1)); x += 4 )
+    {
+        const __m128 val = _mm_mul_ps( _mm_loadu_ps( dst_line + x ), factors );
+        // min( one, val ) keeps NaNs like the C variant
+        _mm_storeu_ps( dst_line + x, _mm_min_ps( one, val ) );
+    }
+    for( ; x < (dim_x - 1); x += 2 )
+    {
+        dst_line[x + 0] = wb_pixel_byf( dst_line[x + 0], factor_00 );
+        dst_line[x + 1] = wb_pixel_byf( dst_line[x + 1], factor_01 );
+    }
+    if( x == (dim_x - 1) )
+    {
+        dst_line[x] = wb_pixel_byf( dst_line[x], factor_00 );
+    }
+}
+
+void	wb_image_byf_sse41( img::img_descriptor dst, float factor_00, float factor_01, float factor_10, float factor_11 ) noexcept
+{
+    int y = 0;
+    for( ; y < (dst.dim.cy - 1); y += 2 )
+    {
+        wb_line_byf_sse41( img::get_line_start<float>( dst, y + 0 ), dst.dim.cx, factor_00, factor_01 );		// even line
+        wb_line_byf_sse41( img::get_line_start<float>( dst, y + 1 ), dst.dim.cx, factor_10, factor_11 );		// odd line
+    }
+    if( y == (dst.dim.cy - 1) )
+    {
+        wb_line_byf_sse41( img::get_line_start<float>( dst, y + 0 ), dst.dim.cx, factor_00, factor_01 );
+    }
+}
+
+}
+
+void		img_filter::whitebalance::detail::apply_wb_byfloat_sse41( const img::img_descriptor& dst, const apply_params& params )
+{
+    if( params.wb_rr == 1.f && params.wb_gr == 1.f && params.wb_bb == 1.f && params.wb_gb == 1.f ) {
+        return;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGGRFloat:	wb_image_byf_sse41( dst, params.wb_bb, params.wb_gb, params.wb_gr, params.wb_rr ); break;
+    case img::fourcc::GBRGFloat:	wb_image_byf_sse41( dst, params.wb_gb, params.wb_bb, params.wb_rr, params.wb_gr ); break;
+    case img::fourcc::GRBGFloat:	wb_image_byf_sse41( dst, params.wb_gr, params.wb_rr, params.wb_bb, params.wb_gb ); break;
+    case img::fourcc::RGGBFloat:	wb_image_byf_sse41( dst, params.wb_rr, params.wb_gr, params.wb_gb, params.wb_bb ); break;
+    default:
+        return;
+    };
+}
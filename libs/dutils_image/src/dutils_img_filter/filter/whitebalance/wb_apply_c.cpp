@@ -9,7 +9,7 @@ auto    img_filter::whitebalance::get_apply_img_c( img::img_type dst ) -> img_fi
         return &wrap_apply_func_to_u8<detail::apply_wb_by8_c>;
     } else if( img::is_by16_fcc( dst.fourcc_type() ) ) {
         return &wrap_apply_func_to_u8<detail::apply_wb_by16_c>;
-    } else if( dst.fourcc_type() == img::fourcc::RGGBFloat ) {
+    } else if( img::is_byfloat_fcc( dst.fourcc_type() ) ) {
         return detail::apply_wb_byfloat_c;
     }
     return nullptr;
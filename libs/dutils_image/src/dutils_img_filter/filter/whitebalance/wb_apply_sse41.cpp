@@ -3,6 +3,10 @@
 
 auto    img_filter::whitebalance::get_apply_img_sse41( img::img_type dst ) -> img_filter::whitebalance::func_type
 {
+    // the float variant handles short lines itself
+    if( img::is_byfloat_fcc( dst.fourcc_type() ) ) {
+        return detail::apply_wb_byfloat_sse41;
+    }
     if( dst.dim.cx < 16 ) {
         return nullptr;
     }
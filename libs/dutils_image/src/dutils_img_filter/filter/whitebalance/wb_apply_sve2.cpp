@@ -0,0 +1,115 @@
+
+#include "wb_apply.h"
+
+/*
+ * The lines are processed in vectors of the hardware vector length, the last one is predicated, so there is no minimum width.
+ * The even pixels of a line get a different factor than the odd ones. The widening multiplies of SVE2 work on the even (bottom)
+ * and the odd (top) lanes separately and the narrowing shifts write the results back to the same lanes.
+ *
+ * Without SVE2 support in the compiler this only provides get_apply_img_sve2, which returns nullptr.
+ */
+
+#if defined __ARM_FEATURE_SVE2
+
+#include "../../simd_helper/use_simd_sve2.h"
+
+#include <dutils_img/image_bayer_pattern.h>
+
+namespace
+{
+
+struct line_factors
+{
+    uint8_t     even;
+    uint8_t     odd;
+};
+
+FORCEINLINE void    wb_by8_line_sve2( uint8_t* line, int dim_x, line_factors f ) noexcept
+{
+    const int step = static_cast<int>( svcntb() );
+    for( int x = 0; x < dim_x; x += step )
+    {
+        const svbool_t pg = svwhilelt_b8( x, dim_x );
+        const svuint8_t src = svld1_u8( pg, line + x );
+
+        // (src * factor) >> 6, saturated to 0xFF
+        const svuint8_t res_even = svqshrnb_n_u16( svmullb_n_u16( src, f.even ), 6 );
+        const svuint8_t res = svqshrnt_n_u16( res_even, svmullt_n_u16( src, f.odd ), 6 );
+
+        svst1_u8( pg, line + x, res );
+    }
+}
+
+FORCEINLINE void    wb_by16_line_sve2( uint16_t* line, int dim_x, line_factors f ) noexcept
+{
+    const int step = static_cast<int>( svcnth() );
+    for( int x = 0; x < dim_x; x += step )
+    {
+        const svbool_t pg = svwhilelt_b16( x, dim_x );
+        const svuint16_t src = svld1_u16( pg, line + x );
+
+        // (src * factor) >> 6, saturated to 0xFFFF
+        const svuint16_t res_even = svqshrnb_n_u32( svmullb_n_u32( src, f.even ), 6 );
+        const svuint16_t res = svqshrnt_n_u32( res_even, svmullt_n_u32( src, f.odd ), 6 );
+
+        svst1_u16( pg, line + x, res );
+    }
+}
+
+template<class TPixel, void (*line_func)( TPixel*, int, line_factors )>
+void    wb_image_sve2( const img::img_descriptor& dst, line_factors line0, line_factors line1 ) noexcept
+{
+    for( int y = 0; y < dst.dim.cy; ++y )
+    {
+        line_func( img::get_line_start<TPixel>( dst, y ), dst.dim.cx, (y % 2 == 0) ? line0 : line1 );
+    }
+}
+
+template<class TPixel, void (*line_func)( TPixel*, int, line_factors )>
+void    wb_pattern_sve2( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb ) noexcept
+{
+    const line_factors bg = { wb_b, wb_gb };
+    const line_factors gb = { wb_gb, wb_b };
+    const line_factors gr = { wb_gr, wb_r };
+    const line_factors rg = { wb_r, wb_gr };
+
+    switch( img::by_transform::convert_bayer_fcc_to_pattern( dst.fourcc_type() ) )
+    {
+    case img::by_transform::by_pattern::BG:     wb_image_sve2<TPixel, line_func>( dst, bg, gr ); break;
+    case img::by_transform::by_pattern::GB:     wb_image_sve2<TPixel, line_func>( dst, gb, rg ); break;
+    case img::by_transform::by_pattern::GR:     wb_image_sve2<TPixel, line_func>( dst, gr, bg ); break;
+    case img::by_transform::by_pattern::RG:     wb_image_sve2<TPixel, line_func>( dst, rg, gb ); break;
+    };
+}
+
+}
+
+void		img_filter::whitebalance::detail::apply_wb_by8_sve2( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb )
+{
+    if( wb_r == 64 && wb_gr == 64 && wb_b == 64 && wb_gb == 64 ) {
+        return;
+    }
+    wb_pattern_sve2<uint8_t, &wb_by8_line_sve2>( dst, wb_r, wb_gr, wb_b, wb_gb );
+}
+
+void		img_filter::whitebalance::detail::apply_wb_by16_sve2( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb )
+{
+    if( wb_r == 64 && wb_gr == 64 && wb_b == 64 && wb_gb == 64 ) {
+        return;
+    }
+    wb_pattern_sve2<uint16_t, &wb_by16_line_sve2>( dst, wb_r, wb_gr, wb_b, wb_gb );
+}
+
+#endif
+
+auto    img_filter::whitebalance::get_apply_img_sve2( [[maybe_unused]] img::img_type dst ) -> img_filter::whitebalance::func_type
+{
+#if defined __ARM_FEATURE_SVE2
+    if( img::is_by8_fcc( dst.fourcc_type() ) ) {
+        return wrap_apply_func_to_u8<&detail::apply_wb_by8_sve2>;
+    } else if( img::is_by16_fcc( dst.fourcc_type() ) ) {
+        return wrap_apply_func_to_u8<&detail::apply_wb_by16_sve2>;
+    }
+#endif
+    return nullptr;
+}
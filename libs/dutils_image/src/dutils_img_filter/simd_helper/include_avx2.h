@@ -0,0 +1,13 @@
+
+#pragma once
+
+#include "see_intrin_base.h"
+
+
+#if !defined DUTILS_SIMD_USAGE_LEVEL || (DUTILS_SIMD_USAGE_LEVEL < DUTILS_SIMD_USAGE_LEVEL_AVX2)
+#error "This file needs AVX2 intrinsics. The current TU is marked as <= AVX1."
+#endif
+
+#include <immintrin.h>	// AVX/AVX2
+
+#include "include_sse41.h"
@@ -0,0 +1,11 @@
+
+#pragma once
+
+#include "see_intrin_base.h"
+
+
+#if !defined DUTILS_SIMD_USAGE_LEVEL || (DUTILS_SIMD_USAGE_LEVEL < DUTILS_SIMD_USAGE_LEVEL_AVX512)
+#error "This file needs AVX-512 F/BW intrinsics. The current TU is marked as <= AVX2."
+#endif
+
+#include "include_avx2.h"
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "see_intrin_base.h"
+
+#if !defined DUTILS_ARCH_ARM || (DUTILS_SIMD_USAGE_LEVEL < DUTILS_SIMD_USAGE_LEVEL_ARM_SVE2) || !defined __ARM_FEATURE_SVE2
+#error "This file needs SVE2 intrinsics. The current TU is not build with SVE2 activated (-march=armv8-a+sve2)."
+#endif
+
+#include <arm_sve.h>
+#include "include_A64.h"
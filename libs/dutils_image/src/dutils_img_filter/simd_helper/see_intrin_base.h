@@ -14,11 +14,13 @@
 
 #define DUTILS_SIMD_USAGE_LEVEL_AVX1    5
 #define DUTILS_SIMD_USAGE_LEVEL_AVX2    6
+#define DUTILS_SIMD_USAGE_LEVEL_AVX512  7
 
 #else
 
 #define DUTILS_SIMD_USAGE_LEVEL_ARM_A8      1
 #define DUTILS_SIMD_USAGE_LEVEL_ARM_A64     2
+#define DUTILS_SIMD_USAGE_LEVEL_ARM_SVE2    3
 
 #endif
 
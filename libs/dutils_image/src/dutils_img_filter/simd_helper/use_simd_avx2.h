@@ -0,0 +1,23 @@
+#ifndef USE_SIMD_AVX2_H_INC__
+#define USE_SIMD_AVX2_H_INC__
+
+#pragma once
+
+#include "see_intrin_base.h"
+
+#ifdef DUTILS_SIMD_USAGE_LEVEL
+#error "SIMD usage level already defined"
+#endif // DUTILS_SIMD_USAGE_LEVEL
+
+#define DUTILS_SIMD_USAGE_LEVEL     DUTILS_SIMD_USAGE_LEVEL_AVX2
+
+/*
+ * Sources including this are compiled with -mavx2 and only called after the cpu features were checked.
+ * So they must not define static or namespace scope __m256i constants, their initializers would run
+ * with AVX2 instructions at load time, before that check. Constants are set up inside the functions.
+ */
+
+#include "include_avx2.h"
+
+
+#endif // USE_SIMD_AVX2_H_INC__
@@ -0,0 +1,17 @@
+#ifndef USE_SIMD_AVX512_H_INC__
+#define USE_SIMD_AVX512_H_INC__
+
+#pragma once
+
+#include "see_intrin_base.h"
+
+#ifdef DUTILS_SIMD_USAGE_LEVEL
+#error "SIMD usage level already defined"
+#endif // DUTILS_SIMD_USAGE_LEVEL
+
+#define DUTILS_SIMD_USAGE_LEVEL     DUTILS_SIMD_USAGE_LEVEL_AVX512
+
+#include "include_avx512.h"
+
+
+#endif // USE_SIMD_AVX512_H_INC__
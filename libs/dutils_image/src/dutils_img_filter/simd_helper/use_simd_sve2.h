@@ -0,0 +1,11 @@
+#pragma once
+
+#include "see_intrin_base.h"
+
+#ifdef DUTILS_SIMD_USAGE_LEVEL
+#error "SIMD usage level already defined"
+#endif // DUTILS_SIMD_USAGE_LEVEL
+
+#define DUTILS_SIMD_USAGE_LEVEL     DUTILS_SIMD_USAGE_LEVEL_ARM_SVE2
+
+#include "include_sve2.h"
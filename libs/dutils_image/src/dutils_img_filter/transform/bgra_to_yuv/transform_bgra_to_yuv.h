@@ -0,0 +1,24 @@
+
+#pragma once
+
+#include "../transform_base.h"
+
+namespace img_filter {
+namespace transform {
+
+    enum class yuv_colorimetry
+    {
+        bt601,          // limited range, Y in [16;235], U/V in [16;240]
+        bt709,
+        bt601_full,     // full range, Y/U/V in [0;255]
+        bt709_full,
+    };
+
+    // BGRA32 -> NV12/I420/YUY2
+    // Chroma is the average of the 2x2 (NV12/I420) or 2x1 (YUY2) pixels it covers. The alpha channel is ignored.
+    // The height has to be even for NV12/I420, the width has to be even for all formats.
+    transform_function_type         get_transform_bgra_to_yuv_c( const img::img_type& dst, const img::img_type& src, yuv_colorimetry clr );
+    transform_function_type         get_transform_bgra_to_yuv_avx2( const img::img_type& dst, const img::img_type& src, yuv_colorimetry clr );
+    transform_function_type         get_transform_bgra_to_yuv_neon( const img::img_type& dst, const img::img_type& src, yuv_colorimetry clr );
+}
+}
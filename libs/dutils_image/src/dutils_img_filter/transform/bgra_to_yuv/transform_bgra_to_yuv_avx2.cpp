@@ -0,0 +1,251 @@
+
+#include "transform_bgra_to_yuv.h"
+#include "transform_bgra_to_yuv_internal.h"
+
+#include "../../simd_helper/use_simd_avx2.h"
+
+/*
+ * Works on blocks of 32 pixels per line, the rest of a line is done by the C line functions.
+ *
+ * The weighted sums are done with _mm256_maddubs_epi16 + _mm256_hadd_epi16, which works per 128-bit lane.
+ * The resulting lane order is fixed by one _mm256_permutevar8x32_epi32 per output register.
+ */
+
+namespace
+{
+
+using namespace transform_bgra_to_yuv_internal;
+
+struct coeff_avx2
+{
+    __m256i wy;
+    __m256i wu;
+    __m256i wv;
+    __m256i y_offset;
+};
+
+FORCEINLINE __m256i     make_weight_vec( const int8_t (&w)[3] )
+{
+    // the alpha channel gets a weight of 0
+    const uint32_t packed = static_cast<uint8_t>( w[0] ) | (static_cast<uint8_t>( w[1] ) << 8) | (static_cast<uint8_t>( w[2] ) << 16);
+    return _mm256_set1_epi32( static_cast<int>( packed ) );
+}
+
+FORCEINLINE coeff_avx2  make_coeff_avx2( const yuv_coefficients& c )
+{
+    return coeff_avx2{ make_weight_vec( c.y ), make_weight_vec( c.u ), make_weight_vec( c.v ), _mm256_set1_epi16( c.y_offset ) };
+}
+
+FORCEINLINE __m256i     load_u( const BGRA32* p )
+{
+    return _mm256_loadu_si256( reinterpret_cast<const __m256i*>(p) );
+}
+
+FORCEINLINE void        store_u( uint8_t* p, __m256i v )
+{
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>(p), v );
+}
+
+// Fixes the lane order after _mm256_hadd_epi16 + _mm256_packus_epi16
+FORCEINLINE __m256i     order_pack_result( __m256i v )
+{
+    return _mm256_permutevar8x32_epi32( v, _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 ) );
+}
+
+// Weighted sum of the 8 pixels in pix0 and the 8 pixels in pix1
+// Result order is [pix0[0..3], pix1[0..3]], [pix0[4..7], pix1[4..7]]
+FORCEINLINE __m256i     weighted_sum_16( __m256i pix0, __m256i pix1, __m256i w )
+{
+    return _mm256_hadd_epi16( _mm256_maddubs_epi16( pix0, w ), _mm256_maddubs_epi16( pix1, w ) );
+}
+
+FORCEINLINE __m256i     calc_y_16( __m256i pix0, __m256i pix1, const coeff_avx2& c )
+{
+    const auto sum = weighted_sum_16( pix0, pix1, c.wy );
+    return _mm256_add_epi16( _mm256_srli_epi16( _mm256_add_epi16( sum, _mm256_set1_epi16( 64 ) ), 7 ), c.y_offset );
+}
+
+FORCEINLINE __m256i     calc_chroma_16( __m256i pix0, __m256i pix1, __m256i w )
+{
+    const auto sum = weighted_sum_16( pix0, pix1, w );
+    return _mm256_add_epi16( _mm256_srai_epi16( _mm256_add_epi16( sum, _mm256_set1_epi16( 64 ) ), 7 ), _mm256_set1_epi16( 128 ) );
+}
+
+// Y of 32 pixels
+FORCEINLINE __m256i     calc_y_32( const BGRA32* src, const coeff_avx2& c )
+{
+    const auto y0 = calc_y_16( load_u( src + 0 ), load_u( src + 8 ), c );
+    const auto y1 = calc_y_16( load_u( src + 16 ), load_u( src + 24 ), c );
+    return order_pack_result( _mm256_packus_epi16( y0, y1 ) );
+}
+
+// Averages the pixel pairs of pix0 and pix1
+// Result order is [pix0 pairs 0/1, pix1 pairs 0/1], [pix0 pairs 2/3, pix1 pairs 2/3]
+FORCEINLINE __m256i     avg_pixel_pairs( __m256i pix0, __m256i pix1 )
+{
+    const auto even = _mm256_shuffle_ps( _mm256_castsi256_ps( pix0 ), _mm256_castsi256_ps( pix1 ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+    const auto odd = _mm256_shuffle_ps( _mm256_castsi256_ps( pix0 ), _mm256_castsi256_ps( pix1 ), _MM_SHUFFLE( 3, 1, 3, 1 ) );
+    return _mm256_avg_epu8( _mm256_castps_si256( even ), _mm256_castps_si256( odd ) );
+}
+
+// Interleaved U/V of 16 chroma pixels
+// chroma0 and chroma1 are the lane ordered outputs of avg_pixel_pairs
+FORCEINLINE __m256i     calc_uv_16( __m256i chroma0, __m256i chroma1, const coeff_avx2& c )
+{
+    const auto u = calc_chroma_16( chroma0, chroma1, c.wu );
+    const auto v = calc_chroma_16( chroma0, chroma1, c.wv );
+
+    return order_pack_result( _mm256_packus_epi16( _mm256_unpacklo_epi16( u, v ), _mm256_unpackhi_epi16( u, v ) ) );
+}
+
+// Interleaved U/V of the 2x2 blocks of 32 pixels of 2 lines
+FORCEINLINE __m256i     calc_uv_2x2_32( const BGRA32* src_line0, const BGRA32* src_line1, const coeff_avx2& c )
+{
+    __m256i vert[4];
+    for( int i = 0; i < 4; ++i ) {
+        vert[i] = _mm256_avg_epu8( load_u( src_line0 + i * 8 ), load_u( src_line1 + i * 8 ) );
+    }
+    return calc_uv_16( avg_pixel_pairs( vert[0], vert[1] ), avg_pixel_pairs( vert[2], vert[3] ), c );
+}
+
+FORCEINLINE __m256i     calc_uv_2x1_32( const BGRA32* src_line, const coeff_avx2& c )
+{
+    const auto chroma0 = avg_pixel_pairs( load_u( src_line + 0 ), load_u( src_line + 8 ) );
+    const auto chroma1 = avg_pixel_pairs( load_u( src_line + 16 ), load_u( src_line + 24 ) );
+    return calc_uv_16( chroma0, chroma1, c );
+}
+
+template<yuv_colorimetry clr>
+void transform_bgra32_to_nv12_avx2( img::img_descriptor dst, img::img_descriptor src_ )
+{
+    auto src = img::flip_image_in_img_desc_if_allowed( src_ );
+
+    assert( dst.dim == src.dim );
+    assert( dst.fourcc_type() == img::fourcc::NV12 && src.fourcc_type() == img::fourcc::BGRA32 );
+
+    constexpr auto coeff = get_coefficients( clr );
+    const auto coeff_vec = make_coeff_avx2( coeff );
+
+    for( int y = 0; y < dst.dim.cy; y += 2 )
+    {
+        auto* src_line0 = img::get_line_start<const BGRA32>( src, y + 0 );
+        auto* src_line1 = img::get_line_start<const BGRA32>( src, y + 1 );
+        auto* y_line0 = img::get_line_start_of_plane<uint8_t>( dst, y + 0, 0 );
+        auto* y_line1 = img::get_line_start_of_plane<uint8_t>( dst, y + 1, 0 );
+        auto* uv_line = img::get_line_start_of_plane<uint8_t>( dst, y / 2, 1 );
+
+        int x = 0;
+        for( ; x <= dst.dim.cx - 32; x += 32 )
+        {
+            store_u( y_line0 + x, calc_y_32( src_line0 + x, coeff_vec ) );
+            store_u( y_line1 + x, calc_y_32( src_line1 + x, coeff_vec ) );
+            store_u( uv_line + x, calc_uv_2x2_32( src_line0 + x, src_line1 + x, coeff_vec ) );
+        }
+        transform_BGRA32_to_NV12_c_line( coeff, x, dst.dim.cx, src_line0, src_line1, y_line0, y_line1, uv_line );
+    }
+}
+
+template<yuv_colorimetry clr>
+void transform_bgra32_to_i420_avx2( img::img_descriptor dst, img::img_descriptor src_ )
+{
+    auto src = img::flip_image_in_img_desc_if_allowed( src_ );
+
+    assert( dst.dim == src.dim );
+    assert( dst.fourcc_type() == img::fourcc::I420 && src.fourcc_type() == img::fourcc::BGRA32 );
+
+    constexpr auto coeff = get_coefficients( clr );
+    const auto coeff_vec = make_coeff_avx2( coeff );
+
+    // per lane [U0, V0, U1, V1, ...] -> [U0, U1, ..., V0, V1, ...]
+    const auto deinterleave_mask = _mm256_setr_epi8(
+        0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15,
+        0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15 );
+
+    for( int y = 0; y < dst.dim.cy; y += 2 )
+    {
+        auto* src_line0 = img::get_line_start<const BGRA32>( src, y + 0 );
+        auto* src_line1 = img::get_line_start<const BGRA32>( src, y + 1 );
+        auto* y_line0 = img::get_line_start_of_plane<uint8_t>( dst, y + 0, 0 );
+        auto* y_line1 = img::get_line_start_of_plane<uint8_t>( dst, y + 1, 0 );
+        auto* u_line = img::get_line_start_of_plane<uint8_t>( dst, y / 2, 1 );
+        auto* v_line = img::get_line_start_of_plane<uint8_t>( dst, y / 2, 2 );
+
+        int x = 0;
+        for( ; x <= dst.dim.cx - 32; x += 32 )
+        {
+            store_u( y_line0 + x, calc_y_32( src_line0 + x, coeff_vec ) );
+            store_u( y_line1 + x, calc_y_32( src_line1 + x, coeff_vec ) );
+
+            const auto uv = calc_uv_2x2_32( src_line0 + x, src_line1 + x, coeff_vec );
+            const auto u_v = _mm256_permute4x64_epi64( _mm256_shuffle_epi8( uv, deinterleave_mask ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(u_line + x / 2), _mm256_castsi256_si128( u_v ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(v_line + x / 2), _mm256_extracti128_si256( u_v, 1 ) );
+        }
+        transform_BGRA32_to_I420_c_line( coeff, x, dst.dim.cx, src_line0, src_line1, y_line0, y_line1, u_line, v_line );
+    }
+}
+
+template<yuv_colorimetry clr>
+void transform_bgra32_to_yuy2_avx2( img::img_descriptor dst, img::img_descriptor src_ )
+{
+    auto src = img::flip_image_in_img_desc_if_allowed( src_ );
+
+    assert( dst.dim == src.dim );
+    assert( dst.fourcc_type() == img::fourcc::YUY2 && src.fourcc_type() == img::fourcc::BGRA32 );
+
+    constexpr auto coeff = get_coefficients( clr );
+    const auto coeff_vec = make_coeff_avx2( coeff );
+
+    for( int y = 0; y < dst.dim.cy; ++y )
+    {
+        auto* src_line = img::get_line_start<const BGRA32>( src, y );
+        auto* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+        int x = 0;
+        for( ; x <= dst.dim.cx - 32; x += 32 )
+        {
+            const auto luma = calc_y_32( src_line + x, coeff_vec );
+            const auto uv = calc_uv_2x1_32( src_line + x, coeff_vec );
+
+            // [Y0, U0, Y1, V0, ...] for the pixels [0;8[, [16;24[ and [8;16[, [24;32[
+            const auto lo = _mm256_unpacklo_epi8( luma, uv );
+            const auto hi = _mm256_unpackhi_epi8( luma, uv );
+
+            store_u( dst_line + x * 2 + 0, _mm256_permute2x128_si256( lo, hi, 0x20 ) );
+            store_u( dst_line + x * 2 + 32, _mm256_permute2x128_si256( lo, hi, 0x31 ) );
+        }
+        transform_BGRA32_to_YUY2_c_line( coeff, x, dst.dim.cx, src_line, dst_line );
+    }
+}
+
+template<yuv_colorimetry clr>
+img_filter::transform_function_type     select_func( img::fourcc dst_fcc )
+{
+    switch( dst_fcc )
+    {
+    case img::fourcc::NV12:     return transform_bgra32_to_nv12_avx2<clr>;
+    case img::fourcc::I420:     return transform_bgra32_to_i420_avx2<clr>;
+    case img::fourcc::YUY2:     return transform_bgra32_to_yuy2_avx2<clr>;
+    default:
+        return nullptr;
+    }
+}
+
+}
+
+img_filter::transform_function_type     img_filter::transform::get_transform_bgra_to_yuv_avx2( const img::img_type& dst, const img::img_type& src, yuv_colorimetry clr )
+{
+    if( !can_convert( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( clr )
+    {
+    case yuv_colorimetry::bt601:        return select_func<yuv_colorimetry::bt601>( dst.fourcc_type() );
+    case yuv_colorimetry::bt709:        return select_func<yuv_colorimetry::bt709>( dst.fourcc_type() );
+    case yuv_colorimetry::bt601_full:   return select_func<yuv_colorimetry::bt601_full>( dst.fourcc_type() );
+    case yuv_colorimetry::bt709_full:   return select_func<yuv_colorimetry::bt709_full>( dst.fourcc_type() );
+    }
+    return nullptr;
+}
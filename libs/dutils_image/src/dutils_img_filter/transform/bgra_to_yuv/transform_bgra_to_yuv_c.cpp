@@ -0,0 +1,103 @@
+
+#include "transform_bgra_to_yuv.h"
+#include "transform_bgra_to_yuv_internal.h"
+
+namespace
+{
+
+using namespace transform_bgra_to_yuv_internal;
+
+template<yuv_colorimetry clr>
+void transform_bgra32_to_nv12_c( img::img_descriptor dst, img::img_descriptor src_ )
+{
+    auto src = img::flip_image_in_img_desc_if_allowed( src_ );
+
+    assert( dst.dim == src.dim );
+    assert( dst.fourcc_type() == img::fourcc::NV12 && src.fourcc_type() == img::fourcc::BGRA32 );
+
+    constexpr auto coeff = get_coefficients( clr );
+
+    for( int y = 0; y < dst.dim.cy; y += 2 )
+    {
+        auto* src_line0 = img::get_line_start<const BGRA32>( src, y + 0 );
+        auto* src_line1 = img::get_line_start<const BGRA32>( src, y + 1 );
+        auto* y_line0 = img::get_line_start_of_plane<uint8_t>( dst, y + 0, 0 );
+        auto* y_line1 = img::get_line_start_of_plane<uint8_t>( dst, y + 1, 0 );
+        auto* uv_line = img::get_line_start_of_plane<uint8_t>( dst, y / 2, 1 );
+
+        transform_BGRA32_to_NV12_c_line( coeff, 0, dst.dim.cx, src_line0, src_line1, y_line0, y_line1, uv_line );
+    }
+}
+
+template<yuv_colorimetry clr>
+void transform_bgra32_to_i420_c( img::img_descriptor dst, img::img_descriptor src_ )
+{
+    auto src = img::flip_image_in_img_desc_if_allowed( src_ );
+
+    assert( dst.dim == src.dim );
+    assert( dst.fourcc_type() == img::fourcc::I420 && src.fourcc_type() == img::fourcc::BGRA32 );
+
+    constexpr auto coeff = get_coefficients( clr );
+
+    for( int y = 0; y < dst.dim.cy; y += 2 )
+    {
+        auto* src_line0 = img::get_line_start<const BGRA32>( src, y + 0 );
+        auto* src_line1 = img::get_line_start<const BGRA32>( src, y + 1 );
+        auto* y_line0 = img::get_line_start_of_plane<uint8_t>( dst, y + 0, 0 );
+        auto* y_line1 = img::get_line_start_of_plane<uint8_t>( dst, y + 1, 0 );
+        auto* u_line = img::get_line_start_of_plane<uint8_t>( dst, y / 2, 1 );
+        auto* v_line = img::get_line_start_of_plane<uint8_t>( dst, y / 2, 2 );
+
+        transform_BGRA32_to_I420_c_line( coeff, 0, dst.dim.cx, src_line0, src_line1, y_line0, y_line1, u_line, v_line );
+    }
+}
+
+template<yuv_colorimetry clr>
+void transform_bgra32_to_yuy2_c( img::img_descriptor dst, img::img_descriptor src_ )
+{
+    auto src = img::flip_image_in_img_desc_if_allowed( src_ );
+
+    assert( dst.dim == src.dim );
+    assert( dst.fourcc_type() == img::fourcc::YUY2 && src.fourcc_type() == img::fourcc::BGRA32 );
+
+    constexpr auto coeff = get_coefficients( clr );
+
+    for( int y = 0; y < dst.dim.cy; ++y )
+    {
+        auto* src_line = img::get_line_start<const BGRA32>( src, y );
+        auto* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+        transform_BGRA32_to_YUY2_c_line( coeff, 0, dst.dim.cx, src_line, dst_line );
+    }
+}
+
+template<yuv_colorimetry clr>
+img_filter::transform_function_type     select_func( img::fourcc dst_fcc )
+{
+    switch( dst_fcc )
+    {
+    case img::fourcc::NV12:     return transform_bgra32_to_nv12_c<clr>;
+    case img::fourcc::I420:     return transform_bgra32_to_i420_c<clr>;
+    case img::fourcc::YUY2:     return transform_bgra32_to_yuy2_c<clr>;
+    default:
+        return nullptr;
+    }
+}
+
+}
+
+img_filter::transform_function_type     img_filter::transform::get_transform_bgra_to_yuv_c( const img::img_type& dst, const img::img_type& src, yuv_colorimetry clr )
+{
+    if( !can_convert( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( clr )
+    {
+    case yuv_colorimetry::bt601:        return select_func<yuv_colorimetry::bt601>( dst.fourcc_type() );
+    case yuv_colorimetry::bt709:        return select_func<yuv_colorimetry::bt709>( dst.fourcc_type() );
+    case yuv_colorimetry::bt601_full:   return select_func<yuv_colorimetry::bt601_full>( dst.fourcc_type() );
+    case yuv_colorimetry::bt709_full:   return select_func<yuv_colorimetry::bt709_full>( dst.fourcc_type() );
+    }
+    return nullptr;
+}
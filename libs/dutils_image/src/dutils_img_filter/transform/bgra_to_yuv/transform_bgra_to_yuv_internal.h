@@ -0,0 +1,144 @@
+
+#pragma once
+
+#include "transform_bgra_to_yuv.h"
+
+#include <dutils_img/pixel_structs.h>
+
+namespace transform_bgra_to_yuv_internal
+{
+    using namespace img::pixel_type;
+    using img_filter::transform::yuv_colorimetry;
+
+    // Weights of B, G and R scaled by 128, so that the SIMD variants can use 8-bit multiply-add instructions.
+    // The G weight is adjusted so that the weights of Y sum up to the range and the weights of U/V sum up to 0.
+    struct yuv_coefficients
+    {
+        int8_t  y[3];
+        int8_t  u[3];
+        int8_t  v[3];
+        uint8_t y_offset;
+    };
+
+    constexpr yuv_coefficients  get_coefficients( yuv_colorimetry clr ) noexcept
+    {
+        switch( clr )
+        {
+        case yuv_colorimetry::bt601:        return { { 13, 64, 33 }, { 56, -37, -19 }, { -9, -47, 56 }, 16 };
+        case yuv_colorimetry::bt709:        return { { 8, 79, 23 }, { 56, -43, -13 }, { -5, -51, 56 }, 16 };
+        case yuv_colorimetry::bt601_full:   return { { 15, 75, 38 }, { 64, -42, -22 }, { -10, -54, 64 }, 0 };
+        case yuv_colorimetry::bt709_full:   return { { 9, 92, 27 }, { 64, -49, -15 }, { -6, -58, 64 }, 0 };
+        }
+        return {};
+    }
+
+    constexpr bool  is_supported_yuv_fcc( img::fourcc fcc ) noexcept
+    {
+        return fcc == img::fourcc::NV12 || fcc == img::fourcc::I420 || fcc == img::fourcc::YUY2;
+    }
+
+    constexpr bool  can_convert( const img::img_type& dst, const img::img_type& src ) noexcept
+    {
+        if( src.fourcc_type() != img::fourcc::BGRA32 || !is_supported_yuv_fcc( dst.fourcc_type() ) ) {
+            return false;
+        }
+        if( dst.dim != src.dim || dst.dim.cx % 2 != 0 ) {
+            return false;
+        }
+        if( dst.fourcc_type() != img::fourcc::YUY2 && dst.dim.cy % 2 != 0 ) {
+            return false;
+        }
+        return true;
+    }
+
+    FORCEINLINE uint8_t     clip_to_u8( int val ) noexcept
+    {
+        return static_cast<uint8_t>( val < 0 ? 0 : (val > 255 ? 255 : val) );
+    }
+
+    // Same rounding as _mm_avg_epu8/vrhadd_u8
+    FORCEINLINE uint8_t     avg_u8( uint8_t a, uint8_t b ) noexcept
+    {
+        return static_cast<uint8_t>( (a + b + 1) >> 1 );
+    }
+
+    FORCEINLINE BGRA32      avg_pixel( BGRA32 a, BGRA32 b ) noexcept
+    {
+        return BGRA32{ avg_u8( a.b, b.b ), avg_u8( a.g, b.g ), avg_u8( a.r, b.r ), avg_u8( a.a, b.a ) };
+    }
+
+    FORCEINLINE int         weighted_sum( const int8_t (&w)[3], BGRA32 pix ) noexcept
+    {
+        return w[0] * pix.b + w[1] * pix.g + w[2] * pix.r;
+    }
+
+    FORCEINLINE uint8_t     calc_y( const yuv_coefficients& c, BGRA32 pix ) noexcept
+    {
+        return clip_to_u8( ((weighted_sum( c.y, pix ) + 64) >> 7) + c.y_offset );
+    }
+
+    FORCEINLINE uint8_t     calc_u( const yuv_coefficients& c, BGRA32 pix ) noexcept
+    {
+        return clip_to_u8( ((weighted_sum( c.u, pix ) + 64) >> 7) + 128 );
+    }
+
+    FORCEINLINE uint8_t     calc_v( const yuv_coefficients& c, BGRA32 pix ) noexcept
+    {
+        return clip_to_u8( ((weighted_sum( c.v, pix ) + 64) >> 7) + 128 );
+    }
+
+    // The chroma pixel of a 2x2 block, the lines are averaged first
+    FORCEINLINE BGRA32      avg_block( const BGRA32* src_line0, const BGRA32* src_line1, int x ) noexcept
+    {
+        return avg_pixel( avg_pixel( src_line0[x], src_line1[x] ), avg_pixel( src_line0[x + 1], src_line1[x + 1] ) );
+    }
+
+    // x_beg and x_end have to be even
+    FORCEINLINE
+    void    transform_BGRA32_to_NV12_c_line( const yuv_coefficients& c, int x_beg, int x_end,
+        const BGRA32* src_line0, const BGRA32* src_line1, uint8_t* y_line0, uint8_t* y_line1, uint8_t* uv_line )
+    {
+        for( int x = x_beg; x < x_end; x += 2 )
+        {
+            y_line0[x + 0] = calc_y( c, src_line0[x + 0] );
+            y_line0[x + 1] = calc_y( c, src_line0[x + 1] );
+            y_line1[x + 0] = calc_y( c, src_line1[x + 0] );
+            y_line1[x + 1] = calc_y( c, src_line1[x + 1] );
+
+            const auto chroma = avg_block( src_line0, src_line1, x );
+            uv_line[x + 0] = calc_u( c, chroma );
+            uv_line[x + 1] = calc_v( c, chroma );
+        }
+    }
+
+    FORCEINLINE
+    void    transform_BGRA32_to_I420_c_line( const yuv_coefficients& c, int x_beg, int x_end,
+        const BGRA32* src_line0, const BGRA32* src_line1, uint8_t* y_line0, uint8_t* y_line1, uint8_t* u_line, uint8_t* v_line )
+    {
+        for( int x = x_beg; x < x_end; x += 2 )
+        {
+            y_line0[x + 0] = calc_y( c, src_line0[x + 0] );
+            y_line0[x + 1] = calc_y( c, src_line0[x + 1] );
+            y_line1[x + 0] = calc_y( c, src_line1[x + 0] );
+            y_line1[x + 1] = calc_y( c, src_line1[x + 1] );
+
+            const auto chroma = avg_block( src_line0, src_line1, x );
+            u_line[x / 2] = calc_u( c, chroma );
+            v_line[x / 2] = calc_v( c, chroma );
+        }
+    }
+
+    FORCEINLINE
+    void    transform_BGRA32_to_YUY2_c_line( const yuv_coefficients& c, int x_beg, int x_end, const BGRA32* src_line, uint8_t* dst_line )
+    {
+        for( int x = x_beg; x < x_end; x += 2 )
+        {
+            const auto chroma = avg_pixel( src_line[x + 0], src_line[x + 1] );
+
+            dst_line[x * 2 + 0] = calc_y( c, src_line[x + 0] );
+            dst_line[x * 2 + 1] = calc_u( c, chroma );
+            dst_line[x * 2 + 2] = calc_y( c, src_line[x + 1] );
+            dst_line[x * 2 + 3] = calc_v( c, chroma );
+        }
+    }
+}
@@ -0,0 +1,192 @@
+
+#include "transform_bgra_to_yuv.h"
+#include "transform_bgra_to_yuv_internal.h"
+
+#include "../../simd_helper/use_simd_A64.h"
+
+namespace
+{
+
+using namespace transform_bgra_to_yuv_internal;
+
+FORCEINLINE uint8x16x4_t    load_pixels_16( const BGRA32* p )
+{
+    return vld4q_u8( reinterpret_cast<const uint8_t*>(p) );
+}
+
+FORCEINLINE uint8x8_t   calc_y_8( uint8x8_t b, uint8x8_t g, uint8x8_t r, const yuv_coefficients& c )
+{
+    uint16x8_t sum = vmull_u8( b, vdup_n_u8( static_cast<uint8_t>( c.y[0] ) ) );
+    sum = vmlal_u8( sum, g, vdup_n_u8( static_cast<uint8_t>( c.y[1] ) ) );
+    sum = vmlal_u8( sum, r, vdup_n_u8( static_cast<uint8_t>( c.y[2] ) ) );
+
+    // vrshrq_n_u16 adds 64 before shifting
+    return vqmovn_u16( vaddq_u16( vrshrq_n_u16( sum, 7 ), vdupq_n_u16( c.y_offset ) ) );
+}
+
+FORCEINLINE uint8x16_t  calc_y_16( const uint8x16x4_t& pix, const yuv_coefficients& c )
+{
+    const auto lo = calc_y_8( vget_low_u8( pix.val[0] ), vget_low_u8( pix.val[1] ), vget_low_u8( pix.val[2] ), c );
+    const auto hi = calc_y_8( vget_high_u8( pix.val[0] ), vget_high_u8( pix.val[1] ), vget_high_u8( pix.val[2] ), c );
+    return vcombine_u8( lo, hi );
+}
+
+FORCEINLINE uint8x8_t   calc_chroma_8( uint8x8_t b, uint8x8_t g, uint8x8_t r, const int8_t (&w)[3] )
+{
+    int16x8_t sum = vmulq_n_s16( vreinterpretq_s16_u16( vmovl_u8( b ) ), w[0] );
+    sum = vmlaq_n_s16( sum, vreinterpretq_s16_u16( vmovl_u8( g ) ), w[1] );
+    sum = vmlaq_n_s16( sum, vreinterpretq_s16_u16( vmovl_u8( r ) ), w[2] );
+
+    return vqmovun_s16( vaddq_s16( vrshrq_n_s16( sum, 7 ), vdupq_n_s16( 128 ) ) );
+}
+
+// Averages the neighbouring pixels of a channel
+FORCEINLINE uint8x8_t   avg_pairs( uint8x16_t v )
+{
+    const auto even_odd = vuzpq_u8( v, v );
+    return vrhadd_u8( vget_low_u8( even_odd.val[0] ), vget_low_u8( even_odd.val[1] ) );
+}
+
+// U/V of 8 chroma pixels
+FORCEINLINE uint8x8x2_t calc_uv_8( uint8x16_t b, uint8x16_t g, uint8x16_t r, const yuv_coefficients& c )
+{
+    const auto avg_b = avg_pairs( b );
+    const auto avg_g = avg_pairs( g );
+    const auto avg_r = avg_pairs( r );
+
+    return uint8x8x2_t{ { calc_chroma_8( avg_b, avg_g, avg_r, c.u ), calc_chroma_8( avg_b, avg_g, avg_r, c.v ) } };
+}
+
+FORCEINLINE uint8x8x2_t calc_uv_2x2_16( const uint8x16x4_t& pix0, const uint8x16x4_t& pix1, const yuv_coefficients& c )
+{
+    return calc_uv_8( vrhaddq_u8( pix0.val[0], pix1.val[0] ), vrhaddq_u8( pix0.val[1], pix1.val[1] ), vrhaddq_u8( pix0.val[2], pix1.val[2] ), c );
+}
+
+template<yuv_colorimetry clr>
+void transform_bgra32_to_nv12_neon( img::img_descriptor dst, img::img_descriptor src_ )
+{
+    auto src = img::flip_image_in_img_desc_if_allowed( src_ );
+
+    assert( dst.dim == src.dim );
+    assert( dst.fourcc_type() == img::fourcc::NV12 && src.fourcc_type() == img::fourcc::BGRA32 );
+
+    constexpr auto coeff = get_coefficients( clr );
+
+    for( int y = 0; y < dst.dim.cy; y += 2 )
+    {
+        auto* src_line0 = img::get_line_start<const BGRA32>( src, y + 0 );
+        auto* src_line1 = img::get_line_start<const BGRA32>( src, y + 1 );
+        auto* y_line0 = img::get_line_start_of_plane<uint8_t>( dst, y + 0, 0 );
+        auto* y_line1 = img::get_line_start_of_plane<uint8_t>( dst, y + 1, 0 );
+        auto* uv_line = img::get_line_start_of_plane<uint8_t>( dst, y / 2, 1 );
+
+        int x = 0;
+        for( ; x <= dst.dim.cx - 16; x += 16 )
+        {
+            const auto pix0 = load_pixels_16( src_line0 + x );
+            const auto pix1 = load_pixels_16( src_line1 + x );
+
+            vst1q_u8( y_line0 + x, calc_y_16( pix0, coeff ) );
+            vst1q_u8( y_line1 + x, calc_y_16( pix1, coeff ) );
+            vst2_u8( uv_line + x, calc_uv_2x2_16( pix0, pix1, coeff ) );
+        }
+        transform_BGRA32_to_NV12_c_line( coeff, x, dst.dim.cx, src_line0, src_line1, y_line0, y_line1, uv_line );
+    }
+}
+
+template<yuv_colorimetry clr>
+void transform_bgra32_to_i420_neon( img::img_descriptor dst, img::img_descriptor src_ )
+{
+    auto src = img::flip_image_in_img_desc_if_allowed( src_ );
+
+    assert( dst.dim == src.dim );
+    assert( dst.fourcc_type() == img::fourcc::I420 && src.fourcc_type() == img::fourcc::BGRA32 );
+
+    constexpr auto coeff = get_coefficients( clr );
+
+    for( int y = 0; y < dst.dim.cy; y += 2 )
+    {
+        auto* src_line0 = img::get_line_start<const BGRA32>( src, y + 0 );
+        auto* src_line1 = img::get_line_start<const BGRA32>( src, y + 1 );
+        auto* y_line0 = img::get_line_start_of_plane<uint8_t>( dst, y + 0, 0 );
+        auto* y_line1 = img::get_line_start_of_plane<uint8_t>( dst, y + 1, 0 );
+        auto* u_line = img::get_line_start_of_plane<uint8_t>( dst, y / 2, 1 );
+        auto* v_line = img::get_line_start_of_plane<uint8_t>( dst, y / 2, 2 );
+
+        int x = 0;
+        for( ; x <= dst.dim.cx - 16; x += 16 )
+        {
+            const auto pix0 = load_pixels_16( src_line0 + x );
+            const auto pix1 = load_pixels_16( src_line1 + x );
+
+            vst1q_u8( y_line0 + x, calc_y_16( pix0, coeff ) );
+            vst1q_u8( y_line1 + x, calc_y_16( pix1, coeff ) );
+
+            const auto uv = calc_uv_2x2_16( pix0, pix1, coeff );
+            vst1_u8( u_line + x / 2, uv.val[0] );
+            vst1_u8( v_line + x / 2, uv.val[1] );
+        }
+        transform_BGRA32_to_I420_c_line( coeff, x, dst.dim.cx, src_line0, src_line1, y_line0, y_line1, u_line, v_line );
+    }
+}
+
+template<yuv_colorimetry clr>
+void transform_bgra32_to_yuy2_neon( img::img_descriptor dst, img::img_descriptor src_ )
+{
+    auto src = img::flip_image_in_img_desc_if_allowed( src_ );
+
+    assert( dst.dim == src.dim );
+    assert( dst.fourcc_type() == img::fourcc::YUY2 && src.fourcc_type() == img::fourcc::BGRA32 );
+
+    constexpr auto coeff = get_coefficients( clr );
+
+    for( int y = 0; y < dst.dim.cy; ++y )
+    {
+        auto* src_line = img::get_line_start<const BGRA32>( src, y );
+        auto* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+        int x = 0;
+        for( ; x <= dst.dim.cx - 16; x += 16 )
+        {
+            const auto pix = load_pixels_16( src_line + x );
+
+            const auto luma = calc_y_16( pix, coeff );
+            const auto uv = calc_uv_8( pix.val[0], pix.val[1], pix.val[2], coeff );
+
+            const auto luma_even_odd = vuzp_u8( vget_low_u8( luma ), vget_high_u8( luma ) );
+            vst4_u8( dst_line + x * 2, uint8x8x4_t{ { luma_even_odd.val[0], uv.val[0], luma_even_odd.val[1], uv.val[1] } } );
+        }
+        transform_BGRA32_to_YUY2_c_line( coeff, x, dst.dim.cx, src_line, dst_line );
+    }
+}
+
+template<yuv_colorimetry clr>
+img_filter::transform_function_type     select_func( img::fourcc dst_fcc )
+{
+    switch( dst_fcc )
+    {
+    case img::fourcc::NV12:     return transform_bgra32_to_nv12_neon<clr>;
+    case img::fourcc::I420:     return transform_bgra32_to_i420_neon<clr>;
+    case img::fourcc::YUY2:     return transform_bgra32_to_yuy2_neon<clr>;
+    default:
+        return nullptr;
+    }
+}
+
+}
+
+img_filter::transform_function_type     img_filter::transform::get_transform_bgra_to_yuv_neon( const img::img_type& dst, const img::img_type& src, yuv_colorimetry clr )
+{
+    if( !can_convert( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( clr )
+    {
+    case yuv_colorimetry::bt601:        return select_func<yuv_colorimetry::bt601>( dst.fourcc_type() );
+    case yuv_colorimetry::bt709:        return select_func<yuv_colorimetry::bt709>( dst.fourcc_type() );
+    case yuv_colorimetry::bt601_full:   return select_func<yuv_colorimetry::bt601_full>( dst.fourcc_type() );
+    case yuv_colorimetry::bt709_full:   return select_func<yuv_colorimetry::bt709_full>( dst.fourcc_type() );
+    }
+    return nullptr;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../../dutils_img_base.h"
+#include "../transform_base.h"
+
+namespace img_filter::transform::binning
+{
+    enum class mode
+    {
+        average,    // average of the factor x factor pixels
+        sum,        // sum of the factor x factor pixels, clipped to the range of the format
+        skip,       // the first pixel of every factor x factor block
+    };
+
+    constexpr int   min_factor = 2;
+    constexpr int   max_factor = 4;
+
+    /* Dimensions of a raw image downscaled by factor.
+     * Bayer images keep their pattern, their 2x2 cells are combined, so the result has even dimensions.
+     */
+    constexpr img::dim  calc_binned_dim( img::fourcc fcc, img::dim src, int factor ) noexcept
+    {
+        if( factor < 1 ) {
+            return {};
+        }
+        if( img::is_bayer_fcc( fcc ) ) {
+            return img::dim{ (src.cx / (2 * factor)) * 2, (src.cy / (2 * factor)) * 2 };
+        }
+        return img::dim{ src.cx / factor, src.cy / factor };
+    }
+
+    /** Downscales raw images by 2, 3 or 4, in software for cameras without binning or skipping.
+     *
+     * MONO8, MONO16, bayer 8/16-bit, dst and src have the same format, dst.dim is calc_binned_dim( src ).
+     * Mono images combine factor x factor blocks of pixels.
+     * Bayer images combine the pixels of the same color in 2*factor x 2*factor blocks, so every cell of dst gets
+     * factor x factor pixels per color.
+     *
+     * dst can be a range of lines of the result, when src is the matching range of source lines, starting at an even dst line.
+     */
+    using function_type = img_filter::transform_function_type;
+
+    function_type   get_binning_c( const img::img_type& dst, const img::img_type& src, int factor, mode m );
+    function_type   get_binning_avx2( const img::img_type& dst, const img::img_type& src, int factor, mode m );
+}
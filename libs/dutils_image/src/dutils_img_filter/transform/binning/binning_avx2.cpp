@@ -0,0 +1,74 @@
+
+#include "binning.h"
+#include "binning_internal.h"
+
+#include "../../simd_helper/use_simd_avx2.h"
+
+/*
+ * The lines of a block are summed with AVX2 into the column sums of a chunk, which is most of the memory traffic.
+ * The horizontal step only reads 1/factor of the sums per dst line and is shared with the C variant.
+ * Skipping only copies single pixels, so both variants use the same loop.
+ */
+
+namespace
+{
+
+using namespace binning_internal;
+
+FORCEINLINE void    sum_lines_avx2( uint16_t* acc, const uint8_t* const* lines, int line_count, int sx_beg, int sx_end ) noexcept
+{
+    int x = sx_beg;
+    for( ; x + 16 <= sx_end; x += 16 )
+    {
+        __m256i sum = _mm256_setzero_si256();
+        for( int j = 0; j < line_count; ++j ) {
+            sum = _mm256_add_epi16( sum, _mm256_cvtepu8_epi16( _mm_loadu_si128( reinterpret_cast<const __m128i*>( lines[j] + x ) ) ) );
+        }
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( acc + x - sx_beg ), sum );
+    }
+    sum_lines_c( acc + x - sx_beg, lines, line_count, x, sx_end );
+}
+
+FORCEINLINE void    sum_lines_avx2( uint32_t* acc, const uint16_t* const* lines, int line_count, int sx_beg, int sx_end ) noexcept
+{
+    int x = sx_beg;
+    for( ; x + 8 <= sx_end; x += 8 )
+    {
+        __m256i sum = _mm256_setzero_si256();
+        for( int j = 0; j < line_count; ++j ) {
+            sum = _mm256_add_epi32( sum, _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( lines[j] + x ) ) ) );
+        }
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( acc + x - sx_beg ), sum );
+    }
+    sum_lines_c( acc + x - sx_beg, lines, line_count, x, sx_end );
+}
+
+template<class T, bool bayer, int factor, mode m>
+struct binning_avx2
+{
+    static void apply( img::img_descriptor dst, img::img_descriptor src )
+    {
+        if constexpr( m == mode::skip )
+        {
+            skip_image<T, bayer, factor>( dst, src );
+        }
+        else
+        {
+            bin_image<T, bayer, factor, m>( dst, src,
+                []( acc_type<T>* acc, const T* const* lines, int line_count, int sx_beg, int sx_end )
+                {
+                    sum_lines_avx2( acc, lines, line_count, sx_beg, sx_end );
+                } );
+        }
+    }
+};
+
+}
+
+img_filter::transform::binning::function_type     img_filter::transform::binning::get_binning_avx2( const img::img_type& dst, const img::img_type& src, int factor, mode m )
+{
+    if( !can_bin( dst, src, factor ) ) {
+        return nullptr;
+    }
+    return select_binning_func<::binning_avx2>( src, factor, m );
+}
@@ -0,0 +1,38 @@
+
+#include "binning.h"
+#include "binning_internal.h"
+
+namespace
+{
+
+using namespace binning_internal;
+
+template<class T, bool bayer, int factor, mode m>
+struct binning_c
+{
+    static void apply( img::img_descriptor dst, img::img_descriptor src )
+    {
+        if constexpr( m == mode::skip )
+        {
+            skip_image<T, bayer, factor>( dst, src );
+        }
+        else
+        {
+            bin_image<T, bayer, factor, m>( dst, src,
+                []( acc_type<T>* acc, const T* const* lines, int line_count, int sx_beg, int sx_end )
+                {
+                    sum_lines_c( acc, lines, line_count, sx_beg, sx_end );
+                } );
+        }
+    }
+};
+
+}
+
+img_filter::transform::binning::function_type     img_filter::transform::binning::get_binning_c( const img::img_type& dst, const img::img_type& src, int factor, mode m )
+{
+    if( !can_bin( dst, src, factor ) ) {
+        return nullptr;
+    }
+    return select_binning_func<::binning_c>( src, factor, m );
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "binning.h"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace binning_internal
+{
+    using namespace img_filter::transform::binning;
+
+    constexpr bool  can_bin( const img::img_type& dst, const img::img_type& src, int factor ) noexcept
+    {
+        if( factor < min_factor || factor > max_factor || dst.fourcc_type() != src.fourcc_type() ) {
+            return false;
+        }
+        const auto fcc = src.fourcc_type();
+        if( fcc != img::fourcc::MONO8 && fcc != img::fourcc::MONO16 && !img::is_by8_fcc( fcc ) && !img::is_by16_fcc( fcc ) ) {
+            return false;
+        }
+        return dst.dim == calc_binned_dim( fcc, src.dim, factor ) && dst.dim.cx > 0 && dst.dim.cy > 0;
+    }
+
+    // sums of up to max_factor lines, 8-bit values fit into 16 bits
+    template<class T>
+    using acc_type = std::conditional_t<sizeof( T ) == 1, uint16_t, uint32_t>;
+
+    // dst pixels per chunk, the column sums of a chunk stay in the L1 cache
+    constexpr int   chunk_pixels = 256;
+
+    // Position of sample i of dst pixel x (or line y) in src
+    template<bool bayer, int factor>
+    FORCEINLINE int     src_pos( int x, int i ) noexcept
+    {
+        if constexpr( bayer ) {
+            return ((x >> 1) * factor + i) * 2 + (x & 1);
+        } else {
+            return x * factor + i;
+        }
+    }
+
+    template<class T, int factor, mode m>
+    FORCEINLINE T   finish_pixel( uint32_t sum ) noexcept
+    {
+        constexpr uint32_t max_value = sizeof( T ) == 1 ? 0xFF : 0xFFFF;
+        constexpr uint32_t count = factor * factor;
+        if constexpr( m == mode::sum ) {
+            return static_cast<T>( std::min( sum, max_value ) );
+        } else {
+            return static_cast<T>( (sum + count / 2) / count );
+        }
+    }
+
+    // acc[x - sx_beg] = sum of the lines at x, for x in [sx_beg, sx_end)
+    template<class T>
+    FORCEINLINE void    sum_lines_c( acc_type<T>* acc, const T* const* lines, int line_count, int sx_beg, int sx_end ) noexcept
+    {
+        for( int x = sx_beg; x < sx_end; ++x )
+        {
+            acc_type<T> sum = 0;
+            for( int j = 0; j < line_count; ++j ) {
+                sum += lines[j][x];
+            }
+            acc[x - sx_beg] = sum;
+        }
+    }
+
+    // The column sums are combined horizontally, the pixels of dst [dx_beg, dx_end) read acc from src column sx_beg on
+    template<class T, bool bayer, int factor, mode m>
+    FORCEINLINE void    reduce_chunk( T* dst_line, const acc_type<T>* acc, int dx_beg, int dx_end, int sx_beg ) noexcept
+    {
+        for( int x = dx_beg; x < dx_end; ++x )
+        {
+            uint32_t sum = 0;
+            for( int i = 0; i < factor; ++i ) {
+                sum += acc[src_pos<bayer, factor>( x, i ) - sx_beg];
+            }
+            dst_line[x] = finish_pixel<T, factor, m>( sum );
+        }
+    }
+
+    template<class T, bool bayer, int factor>
+    FORCEINLINE void    skip_image( const img::img_descriptor& dst, const img::img_descriptor& src ) noexcept
+    {
+        for( int y = 0; y < dst.dim.cy; ++y )
+        {
+            const T* src_line = img::get_line_start<const T>( src, src_pos<bayer, factor>( y, 0 ) );
+            T* dst_line = img::get_line_start<T>( dst, y );
+            for( int x = 0; x < dst.dim.cx; ++x ) {
+                dst_line[x] = src_line[src_pos<bayer, factor>( x, 0 )];
+            }
+        }
+    }
+
+    // Sums the factor source lines of every dst line in chunks with sum_lines( acc, lines, line_count, sx_beg, sx_end )
+    // and reduces the chunks horizontally
+    template<class T, bool bayer, int factor, mode m, class TSumLines>
+    FORCEINLINE void    bin_image( const img::img_descriptor& dst, const img::img_descriptor& src, TSumLines&& sum_lines ) noexcept
+    {
+        acc_type<T> acc[chunk_pixels * max_factor];
+
+        for( int y = 0; y < dst.dim.cy; ++y )
+        {
+            const T* lines[max_factor] = {};
+            for( int j = 0; j < factor; ++j ) {
+                lines[j] = img::get_line_start<const T>( src, src_pos<bayer, factor>( y, j ) );
+            }
+            T* dst_line = img::get_line_start<T>( dst, y );
+
+            // chunks start on even pixels, so bayer cells are not split
+            for( int dx_beg = 0; dx_beg < dst.dim.cx; dx_beg += chunk_pixels )
+            {
+                const int dx_end = std::min( dst.dim.cx, dx_beg + chunk_pixels );
+                const int sx_beg = src_pos<bayer, factor>( dx_beg, 0 );
+                const int sx_end = src_pos<bayer, factor>( dx_end - 1, factor - 1 ) + 1;
+
+                sum_lines( acc, lines, factor, sx_beg, sx_end );
+                reduce_chunk<T, bayer, factor, m>( dst_line, acc, dx_beg, dx_end, sx_beg );
+            }
+        }
+    }
+
+    // Selects the instantiation of TFunc<T, bayer, factor, m>
+    template<template<class, bool, int, mode> class TFunc>
+    function_type   select_binning_func( const img::img_type& src, int factor, mode m ) noexcept
+    {
+        auto by_mode = [m]( auto t, auto bayer, auto f ) -> function_type
+        {
+            using T = decltype( t );
+            switch( m )
+            {
+            case mode::average:     return TFunc<T, bayer, f, mode::average>::apply;
+            case mode::sum:         return TFunc<T, bayer, f, mode::sum>::apply;
+            case mode::skip:        return TFunc<T, bayer, f, mode::skip>::apply;
+            }
+            return nullptr;
+        };
+        auto by_factor = [&]( auto t, auto bayer ) -> function_type
+        {
+            switch( factor )
+            {
+            case 2:     return by_mode( t, bayer, std::integral_constant<int, 2>{} );
+            case 3:     return by_mode( t, bayer, std::integral_constant<int, 3>{} );
+            case 4:     return by_mode( t, bayer, std::integral_constant<int, 4>{} );
+            }
+            return nullptr;
+        };
+        auto by_pattern = [&]( auto t ) -> function_type
+        {
+            if( img::is_bayer_fcc( src.fourcc_type() ) ) {
+                return by_factor( t, std::true_type{} );
+            }
+            return by_factor( t, std::false_type{} );
+        };
+
+        if( img::get_bits_per_pixel( src.fourcc_type() ) == 8 ) {
+            return by_pattern( uint8_t{} );
+        }
+        return by_pattern( uint16_t{} );
+    }
+}
@@ -24,10 +24,13 @@ namespace fcc1x_packed
     transform_function_type     get_transform_fcc10or12_packed_to_fcc16_c( const img::img_type& dst, const img::img_type& src );
     transform_function_type     get_transform_fcc10or12_packed_to_fcc16_ssse3( const img::img_type& dst, const img::img_type& src );
     transform_function_type     get_transform_fcc10or12_packed_to_fcc16_neon_v0( const img::img_type& dst, const img::img_type& src );
+    transform_function_type     get_transform_fcc10or12_packed_to_fcc16_sve2( const img::img_type& dst, const img::img_type& src );    // no 10-bit packed formats
 
 	transform_function_type     get_transform_fcc10or12_packed_to_fcc8_c( const img::img_type& dst, const img::img_type& src );
 	transform_function_type     get_transform_fcc10or12_packed_to_fcc8_ssse3( const img::img_type& dst, const img::img_type& src );
+	transform_function_type     get_transform_fcc10or12_packed_to_fcc8_avx2( const img::img_type& dst, const img::img_type& src );
 	transform_function_type     get_transform_fcc10or12_packed_to_fcc8_neon_v0( const img::img_type& dst, const img::img_type& src );
+	transform_function_type     get_transform_fcc10or12_packed_to_fcc8_sve2( const img::img_type& dst, const img::img_type& src );      // no 10-bit packed formats
 
 }
 }
@@ -0,0 +1,183 @@
+
+#include "fcc1x_packed_to_fcc.h"
+
+#include "fcc1x_packed_to_fcc8_internal_loop.h"
+
+#include "../../simd_helper/use_simd_avx2.h"
+
+using namespace fcc1x_packed_internal;
+
+namespace
+{
+
+// The packed formats do not map to 32 byte blocks, so each 128-bit lane loads its own
+// group of pixels and the pshufb patterns of the SSSE3 variant can be reused per lane.
+FORCEINLINE __m256i load_lanes( const uint8_t* lane0, const uint8_t* lane1 ) noexcept
+{
+    const __m128i lo = _mm_loadu_si128( reinterpret_cast<const __m128i*>( lane0 ) );
+    const __m128i hi = _mm_loadu_si128( reinterpret_cast<const __m128i*>( lane1 ) );
+    return _mm256_inserti128_si256( _mm256_castsi128_si256( lo ), hi, 1 );
+}
+
+// epu8[0;8[ of both lanes => 16 consecutive bytes
+FORCEINLINE void store_lanes_8( uint8_t* dst, __m256i v ) noexcept
+{
+    const __m256i res = _mm256_permute4x64_epi64( v, 0b00'00'10'00 );
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( dst ), _mm256_castsi256_si128( res ) );
+}
+
+// epu8[0;12[ of both lanes => 24 consecutive bytes, the following 8 bytes are clobbered
+FORCEINLINE void store_lanes_12( uint8_t* dst, __m256i v ) noexcept
+{
+    const __m256i res = _mm256_permutevar8x32_epi32( v, _mm256_setr_epi32( 0, 1, 2, 4, 5, 6, 3, 7 ) );
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst ), res );
+}
+
+// 16 pixels are 24 bytes, the lanes start at byte 0 and 12
+template<__m256i (*step)( __m256i ), class TFunc>
+FORCEINLINE void transform_fcc12_to_fcc8_avx2_loop( img::img_descriptor dst, img::img_descriptor src, TFunc line_func ) noexcept
+{
+    for( int y = 0; y < src.dim.cy; ++y )
+    {
+        const uint8_t* src_line = img::get_line_start<uint8_t>( src, y );
+        uint8_t* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+        int x = 0;
+        for( ; x < (src.dim.cx - 32); x += 16 )     // lane 1 reads 16 bytes starting at (x / 2) * 3 + 12
+        {
+            const uint8_t* p = src_line + (x / 2) * 3;
+            store_lanes_8( dst_line + x, step( load_lanes( p, p + 12 ) ) );
+        }
+
+        line_func( src_line + (x / 2) * 3, dst_line + x, src.dim.cx - x );
+    }
+}
+
+// 24 pixels are 30 bytes, the lanes start at byte 0 and 15
+template<__m256i (*step)( __m256i ), class TFunc>
+FORCEINLINE void transform_fcc10_to_fcc8_avx2_loop( img::img_descriptor dst, img::img_descriptor src, TFunc line_func ) noexcept
+{
+    for( int y = 0; y < src.dim.cy; ++y )
+    {
+        const uint8_t* src_line = img::get_line_start<uint8_t>( src, y );
+        uint8_t* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+        int x = 0;
+        for( ; x < (src.dim.cx - 32); x += 24 )     // stores 32 bytes, reads 16 bytes starting at (x / 4) * 5 + 15
+        {
+            const uint8_t* p = src_line + (x / 4) * 5;
+            store_lanes_12( dst_line + x, step( load_lanes( p, p + 15 ) ) );
+        }
+
+        line_func( src_line + (x / 4) * 5, dst_line + x, src.dim.cx - x );
+    }
+}
+
+FORCEINLINE __m256i fcc12_packed_step( __m256i v ) noexcept
+{
+    const __m256i scatter_upper = _mm256_broadcastsi128_si256( _mm_setr_epi8( 0, 2, 3, 5, 6, 8, 9, 11, -1, -1, -1, -1, -1, -1, -1, -1 ) );
+    return _mm256_shuffle_epi8( v, scatter_upper );
+}
+
+FORCEINLINE __m256i fcc12_mipi_step( __m256i v ) noexcept
+{
+    const __m256i scatter_upper = _mm256_broadcastsi128_si256( _mm_setr_epi8( 0, 1, 3, 4, 6, 7, 9, 10, -1, -1, -1, -1, -1, -1, -1, -1 ) );
+    return _mm256_shuffle_epi8( v, scatter_upper );
+}
+
+FORCEINLINE __m256i fcc12_spacked_step( __m256i v ) noexcept
+{
+    // p0 = ((src[0] & 0xF0) >> 4) | ((src[1] & 0x0F) << 4), p1 = src[2]
+    const __m256i scatter_p0 = _mm256_broadcastsi128_si256( _mm_setr_epi8( 0, 1, 3, 4, 6, 7, 9, 10, -1, -1, -1, -1, -1, -1, -1, -1 ) );
+    const __m256i scatter_p1 = _mm256_broadcastsi128_si256( _mm_setr_epi8( -1, 2, -1, 5, -1, 8, -1, 11, -1, -1, -1, -1, -1, -1, -1, -1 ) );
+
+    const __m256i tmp0 = _mm256_srli_epi16( _mm256_shuffle_epi8( v, scatter_p0 ), 4 );     // u16=0FFF
+    const __m256i tmp1 = _mm256_and_si256( tmp0, _mm256_set1_epi16( 0x00FF ) );            // u16=00FF
+    return _mm256_or_si256( _mm256_shuffle_epi8( v, scatter_p1 ), tmp1 );
+}
+
+FORCEINLINE __m256i fcc10_mipi_step( __m256i v ) noexcept
+{
+    const __m256i scatter_upper = _mm256_broadcastsi128_si256( _mm_setr_epi8( 0, 1, 2, 3, 5, 6, 7, 8, 10, 11, 12, 13, -1, -1, -1, -1 ) );
+    return _mm256_shuffle_epi8( v, scatter_upper );
+}
+
+FORCEINLINE __m256i fcc10_spacked_step( __m256i v ) noexcept
+{
+    //  cluster bits = 33333333'33222222'22221111'11111100'00000000
+    // u16[] = the 2 bytes holding the upper 8 bits of each pixel, [0;4[ cluster 0, [4;8[ cluster 1, [8;12[ cluster 2
+    const __m256i scatter_lo = _mm256_broadcastsi128_si256( _mm_setr_epi8( 0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9 ) );
+    const __m256i scatter_hi = _mm256_broadcastsi128_si256( _mm_setr_epi8( 10, 11, 11, 12, 12, 13, 13, 14, -1, -1, -1, -1, -1, -1, -1, -1 ) );
+    // shift each u16 by 2,4,6,8 so that the upper 8 bits end up in the low byte
+    const __m256i shift = _mm256_broadcastsi128_si256( _mm_setr_epi16( 1 << 6, 1 << 4, 1 << 2, 1 << 0, 1 << 6, 1 << 4, 1 << 2, 1 << 0 ) );
+
+    const __m256i lo = _mm256_srli_epi16( _mm256_mullo_epi16( _mm256_shuffle_epi8( v, scatter_lo ), shift ), 8 );
+    const __m256i hi = _mm256_srli_epi16( _mm256_mullo_epi16( _mm256_shuffle_epi8( v, scatter_hi ), shift ), 8 );
+
+    return _mm256_packus_epi16( lo, hi );
+}
+
+void transform_fcc12_packed_to_fcc8_avx2_v0( img::img_descriptor dst, img::img_descriptor src )
+{
+    assert( src.dim.cx % 2 == 0 );
+
+    transform_fcc12_to_fcc8_avx2_loop<fcc12_packed_step>( dst, src, transform_fcc12_packed_to_fcc8_c_line );
+}
+
+void transform_fcc12_mipi_to_fcc8_avx2_v0( img::img_descriptor dst, img::img_descriptor src )
+{
+    assert( src.dim.cx % 2 == 0 );
+
+    transform_fcc12_to_fcc8_avx2_loop<fcc12_mipi_step>( dst, src, transform_fcc12_mipi_to_fcc8_c_line );
+}
+
+void transform_fcc12_spacked_to_fcc8_avx2_v0( img::img_descriptor dst, img::img_descriptor src )
+{
+    assert( src.dim.cx % 2 == 0 );
+
+    transform_fcc12_to_fcc8_avx2_loop<fcc12_spacked_step>( dst, src, transform_fcc12_spacked_to_fcc8_c_line );
+}
+
+void transform_fcc10_mipi_to_fcc8_avx2_v0( img::img_descriptor dst, img::img_descriptor src )
+{
+    assert( src.dim.cx % 4 == 0 );
+
+    transform_fcc10_to_fcc8_avx2_loop<fcc10_mipi_step>( dst, src, transform_fcc10_mipi_to_fcc8_c_line );
+}
+
+void transform_fcc10_spacked_to_fcc8_avx2_v0( img::img_descriptor dst, img::img_descriptor src )
+{
+    assert( src.dim.cx % 4 == 0 );
+
+    transform_fcc10_to_fcc8_avx2_loop<fcc10_spacked_step>( dst, src, transform_fcc10_spacked_to_fcc8_c_line );
+}
+}
+
+auto img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_avx2( const img::img_type& dst, const img::img_type& src ) -> transform_function_type
+{
+    if( src.dim != dst.dim ) {
+        return nullptr;
+    }
+
+    using namespace img::fcc1x_packed;
+
+    if( !is_accepted_dst_fcc8( dst.fourcc_type() ) ) {
+        return nullptr;
+    }
+
+    switch( get_fcc1x_pack_type( src.fourcc_type() ) )
+    {
+    case fccXX_pack_type::fcc12:                return nullptr;
+    case fccXX_pack_type::fcc12_packed:         return ::transform_fcc12_packed_to_fcc8_avx2_v0;
+    case fccXX_pack_type::fcc12_mipi:           return ::transform_fcc12_mipi_to_fcc8_avx2_v0;
+    case fccXX_pack_type::fcc12_spacked:        return ::transform_fcc12_spacked_to_fcc8_avx2_v0;
+
+    case fccXX_pack_type::fcc10:                return nullptr;
+    case fccXX_pack_type::fcc10_spacked:        return ::transform_fcc10_spacked_to_fcc8_avx2_v0;
+    case fccXX_pack_type::fcc10_mipi:           return ::transform_fcc10_mipi_to_fcc8_avx2_v0;
+
+    case fccXX_pack_type::invalid:              return nullptr;
+    };
+
+    return nullptr;
+}
@@ -0,0 +1,121 @@
+
+#include "fcc1x_packed_to_fcc.h"
+
+/*
+ * SVE2 variant of fcc1x_packed_to_fcc8_neon_v0.cpp for the 12-bit formats and the 16-bit containers.
+ *
+ * Each step converts the pixels of one vector length, the last step of a line is predicated, so nothing is read or written
+ * outside of the line. The 12-bit packed formats are loaded with svld3 and the upper 8 bits of the pixel pairs are stored with svst2.
+ * The 16-bit containers are shifted and stored with the truncating svst1b.
+ *
+ * Without SVE2 support in the compiler get_transform_fcc10or12_packed_to_fcc8_sve2 returns nullptr.
+ */
+
+#if defined __ARM_FEATURE_SVE2
+
+#include "../../simd_helper/use_simd_sve2.h"
+
+#include "fcc1x_packed_to_fcc8_internal.h"
+
+using namespace fcc1x_packed_internal;
+
+namespace
+{
+
+using decode_fcc12_func = svuint8x2_t (*)( svuint8_t b0, svuint8_t b1, svuint8_t b2 );
+
+FORCEINLINE svuint8x2_t     decode_fcc12_packed( svuint8_t b0, svuint8_t /*b1*/, svuint8_t b2 ) noexcept
+{
+    // [p0_hi][p0_lo | p1_lo << 4][p1_hi]
+    return svcreate2_u8( b0, b2 );
+}
+
+FORCEINLINE svuint8x2_t     decode_fcc12_mipi( svuint8_t b0, svuint8_t b1, svuint8_t /*b2*/ ) noexcept
+{
+    // [p0_hi][p1_hi][p0_lo | p1_lo << 4]
+    return svcreate2_u8( b0, b1 );
+}
+
+FORCEINLINE svuint8x2_t     decode_fcc12_spacked( svuint8_t b0, svuint8_t b1, svuint8_t b2 ) noexcept
+{
+    // p0 = b0 >> 4 | b1 << 4, p1 = b2
+    return svcreate2_u8( svsli_n_u8( svlsr_n_u8_x( svptrue_b8(), b0, 4 ), b1, 4 ), b2 );
+}
+
+template<decode_fcc12_func decode, auto calc>
+void    transform_fcc12_packed_to_fcc8_sve2( img::img_descriptor dst, img::img_descriptor src )
+{
+    const int dim_x = src.dim.cx;
+    const int pairs = dim_x / 2;
+    const int step = static_cast<int>( svcntb() );     // pixel pairs per step
+
+    for( int y = 0; y < src.dim.cy; ++y )
+    {
+        const auto* src_line = img::get_line_start<const uint8_t>( src, y );
+        auto* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+        for( int p = 0; p < pairs; p += step )
+        {
+            const svbool_t pg = svwhilelt_b8( p, pairs );
+            const svuint8x3_t vals = svld3_u8( pg, src_line + p * 3 );
+
+            svst2_u8( pg, dst_line + p * 2, decode( svget3_u8( vals, 0 ), svget3_u8( vals, 1 ), svget3_u8( vals, 2 ) ) );
+        }
+        if( dim_x % 2 != 0 ) {
+            dst_line[dim_x - 1] = calc( src_line, dim_x - 1 );
+        }
+    }
+}
+
+template<int shift>
+void    transform_fcc16_shift_right_to_fcc8_sve2( img::img_descriptor dst, img::img_descriptor src )
+{
+    const int dim_x = src.dim.cx;
+    const int step = static_cast<int>( svcnth() );
+
+    for( int y = 0; y < src.dim.cy; ++y )
+    {
+        const auto* src_line = img::get_line_start<const uint16_t>( src, y );
+        auto* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+        for( int x = 0; x < dim_x; x += step )
+        {
+            const svbool_t pg = svwhilelt_b16( x, dim_x );
+            svst1b_u16( pg, dst_line + x, svlsr_n_u16_x( pg, svld1_u16( pg, src_line + x ), shift ) );
+        }
+    }
+}
+
+}
+
+#endif
+
+auto img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_sve2( [[maybe_unused]] const img::img_type& dst, [[maybe_unused]] const img::img_type& src ) -> transform_function_type
+{
+#if defined __ARM_FEATURE_SVE2
+    if( src.dim != dst.dim ) {
+        return nullptr;
+    }
+
+    using namespace img::fcc1x_packed;
+
+    if( !is_accepted_dst_fcc8( dst.fourcc_type() ) ) {
+        return nullptr;
+    }
+
+    switch( get_fcc1x_pack_type( src.fourcc_type() ) )
+    {
+    case fccXX_pack_type::fcc12:            return &transform_fcc16_shift_right_to_fcc8_sve2<4>;
+    case fccXX_pack_type::fcc12_packed:     return &transform_fcc12_packed_to_fcc8_sve2<&decode_fcc12_packed, &calc_fcc12_packed_to_fcc8>;
+    case fccXX_pack_type::fcc12_mipi:       return &transform_fcc12_packed_to_fcc8_sve2<&decode_fcc12_mipi, &calc_fcc12_mipi_to_fcc8>;
+    case fccXX_pack_type::fcc12_spacked:    return &transform_fcc12_packed_to_fcc8_sve2<&decode_fcc12_spacked, &calc_fcc12_spacked_to_fcc8>;
+
+    case fccXX_pack_type::fcc10:            return &transform_fcc16_shift_right_to_fcc8_sve2<2>;
+    case fccXX_pack_type::fcc10_spacked:    return nullptr;
+    case fccXX_pack_type::fcc10_mipi:       return nullptr;
+
+    case fccXX_pack_type::invalid:          return nullptr;
+    };
+#endif
+    return nullptr;
+}
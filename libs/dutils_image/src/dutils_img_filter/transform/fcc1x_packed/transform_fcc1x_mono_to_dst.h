@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../transform_base.h"
+
+namespace img_filter::transform::fcc1x_packed
+{
+    /** Converts MONO10/MONO12 (packed) and MONO16 directly to BGRA32, MONO16 or MONOFloat, without an intermediate MONO8 or MONO16 image.
+     *
+     * The source pixels are expanded to 16 bit like in get_transform_fcc10or12_packed_to_fcc16_c, then
+     *  BGRA32:     gets the upper 8 bits, so the result is the same as MONOXX -> MONO8 -> BGRA32
+     *  MONO16:     the 16-bit value
+     *  MONOFloat:  value / 0xFFFF, in [0;1]
+     *
+     * The SIMD variants return nullptr for the 10-bit packed formats, these are done by the C variant.
+     * For conversions with contrast stretching see img_filter::lut::get_transform_mono_to_dst_lut_c.
+     */
+    transform_function_type     get_transform_fcc1x_mono_to_dst_c( const img::img_type& dst, const img::img_type& src );
+    transform_function_type     get_transform_fcc1x_mono_to_dst_avx2( const img::img_type& dst, const img::img_type& src );
+    transform_function_type     get_transform_fcc1x_mono_to_dst_neon( const img::img_type& dst, const img::img_type& src );
+}
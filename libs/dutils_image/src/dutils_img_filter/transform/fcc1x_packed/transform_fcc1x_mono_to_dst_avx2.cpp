@@ -0,0 +1,162 @@
+
+#include "transform_fcc1x_mono_to_dst.h"
+#include "transform_fcc1x_mono_to_dst_internal.h"
+
+#include "../../simd_helper/use_simd_avx2.h"
+
+/*
+ * Each step expands 16 pixels to 16-bit values in pixel order, which are then stored in the dst format.
+ * For the 12-bit packed formats each 128-bit lane loads the 12 bytes of 8 pixels, like in fcc1x_packed_to_fcc8_avx2_v0.cpp.
+ * The rest of a line is done by the C line function.
+ */
+
+using namespace fcc1x_packed_internal;
+
+namespace
+{
+
+using namespace fcc1x_mono_to_dst_internal;
+
+FORCEINLINE __m256i load_lanes( const uint8_t* lane0, const uint8_t* lane1 ) noexcept
+{
+    const __m128i lo = _mm_loadu_si128( reinterpret_cast<const __m128i*>( lane0 ) );
+    const __m128i hi = _mm_loadu_si128( reinterpret_cast<const __m128i*>( lane1 ) );
+    return _mm256_inserti128_si256( _mm256_castsi128_si256( lo ), hi, 1 );
+}
+
+// lane 1 reads 16 bytes starting at (x / 2) * 3 + 12, so 4 more pixels than the 16 of the step have to be in the line
+constexpr int fcc12_packed_overread = 4;
+
+FORCEINLINE __m256i load_fcc12_packed_lanes( const uint8_t* src_line, int x ) noexcept
+{
+    const uint8_t* p = src_line + (x / 2) * 3;
+    return load_lanes( p, p + 12 );
+}
+
+// After the shuffle, the u16 of an even pixel holds its upper 8 bits in the high byte and its lower 4 bits in the low nibble,
+// the u16 of an odd pixel holds its upper 8 bits in the high byte and its lower 4 bits in the high nibble.
+FORCEINLINE __m256i expand_fcc12_pairs( __m256i v ) noexcept
+{
+    const __m256i even = _mm256_or_si256( _mm256_and_si256( v, _mm256_set1_epi16( static_cast<short>( 0xFF00 ) ) ),
+        _mm256_and_si256( _mm256_slli_epi16( v, 4 ), _mm256_set1_epi16( 0x00F0 ) ) );
+    const __m256i odd = _mm256_and_si256( v, _mm256_set1_epi16( static_cast<short>( 0xFFF0 ) ) );
+    return _mm256_blend_epi16( even, odd, 0xAA );
+}
+
+FORCEINLINE __m256i decode_fcc12_packed( const uint8_t* src_line, int x ) noexcept
+{
+    // [p0_hi][p0_lo | p1_lo << 4][p1_hi] => u16 p0 = p0_hi << 8 | b1, u16 p1 = p1_hi << 8 | b1
+    const __m256i spread = _mm256_broadcastsi128_si256( _mm_setr_epi8( 1, 0, 1, 2, 4, 3, 4, 5, 7, 6, 7, 8, 10, 9, 10, 11 ) );
+    return expand_fcc12_pairs( _mm256_shuffle_epi8( load_fcc12_packed_lanes( src_line, x ), spread ) );
+}
+
+FORCEINLINE __m256i decode_fcc12_mipi( const uint8_t* src_line, int x ) noexcept
+{
+    // [p0_hi][p1_hi][p0_lo | p1_lo << 4] => u16 p0 = p0_hi << 8 | b2, u16 p1 = p1_hi << 8 | b2
+    const __m256i spread = _mm256_broadcastsi128_si256( _mm_setr_epi8( 2, 0, 2, 1, 5, 3, 5, 4, 8, 6, 8, 7, 11, 9, 11, 10 ) );
+    return expand_fcc12_pairs( _mm256_shuffle_epi8( load_fcc12_packed_lanes( src_line, x ), spread ) );
+}
+
+FORCEINLINE __m256i decode_fcc12_spacked( const uint8_t* src_line, int x ) noexcept
+{
+    // u16 p0 = b1 << 8 | b0 => p0 << 4, u16 p1 = b2 << 8 | b1 => p1 & 0xFFF0
+    const __m256i spread = _mm256_broadcastsi128_si256( _mm_setr_epi8( 0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11 ) );
+    const __m256i v = _mm256_shuffle_epi8( load_fcc12_packed_lanes( src_line, x ), spread );
+
+    const __m256i even = _mm256_slli_epi16( v, 4 );
+    const __m256i odd = _mm256_and_si256( v, _mm256_set1_epi16( static_cast<short>( 0xFFF0 ) ) );
+    return _mm256_blend_epi16( even, odd, 0xAA );
+}
+
+template<int shift>
+FORCEINLINE __m256i decode_fcc16( const uint8_t* src_line, int x ) noexcept
+{
+    const __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( src_line + x * 2 ) );
+    return _mm256_slli_epi16( v, shift );
+}
+
+FORCEINLINE void    store_16( BGRA32* dst, __m256i v ) noexcept
+{
+    const __m256i y = _mm256_srli_epi16( v, 8 );
+    const __m256i bg = _mm256_or_si256( y, _mm256_slli_epi16( y, 8 ) );
+    const __m256i ra = _mm256_or_si256( y, _mm256_set1_epi16( static_cast<short>( 0xFF00 ) ) );
+
+    const __m256i lo = _mm256_unpacklo_epi16( bg, ra );     // pixels [0;4[ and [8;12[
+    const __m256i hi = _mm256_unpackhi_epi16( bg, ra );     // pixels [4;8[ and [12;16[
+
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + 0 ), _mm256_permute2x128_si256( lo, hi, 0x20 ) );
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + 8 ), _mm256_permute2x128_si256( lo, hi, 0x31 ) );
+}
+
+FORCEINLINE void    store_16( uint16_t* dst, __m256i v ) noexcept
+{
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst ), v );
+}
+
+FORCEINLINE void    store_16( float* dst, __m256i v ) noexcept
+{
+    const __m256 scale = _mm256_set1_ps( float_scale );
+
+    const __m256i lo = _mm256_cvtepu16_epi32( _mm256_castsi256_si128( v ) );
+    const __m256i hi = _mm256_cvtepu16_epi32( _mm256_extracti128_si256( v, 1 ) );
+
+    _mm256_storeu_ps( dst + 0, _mm256_mul_ps( _mm256_cvtepi32_ps( lo ), scale ) );
+    _mm256_storeu_ps( dst + 8, _mm256_mul_ps( _mm256_cvtepi32_ps( hi ), scale ) );
+}
+
+template<__m256i (*decode)( const uint8_t*, int ), int overread, auto calc, class TDst>
+void    transform_mono_to_dst_avx2( img::img_descriptor dst, img::img_descriptor src )
+{
+    for_each_mono_line<TDst>( dst, src, [width = src.dim.cx]( TDst* dst_line, const uint8_t* src_line )
+        {
+            int x = 0;
+            for( ; x <= (width - 16 - overread); x += 16 )
+            {
+                store_16( dst_line + x, decode( src_line, x ) );
+            }
+            transform_mono_to_dst_line_c<calc>( dst_line, src_line, x, width );
+        } );
+}
+
+template<class TDst>
+img_filter::transform_function_type     select_mono_to_dst_avx2( img::fourcc src_fcc )
+{
+    if( src_fcc == img::fourcc::MONO16 ) {
+        return &transform_mono_to_dst_avx2<&decode_fcc16<0>, 0, &read_fcc16, TDst>;
+    }
+
+    using namespace img::fcc1x_packed;
+
+    switch( get_fcc1x_pack_type( src_fcc ) )
+    {
+    case fccXX_pack_type::fcc12:            return &transform_mono_to_dst_avx2<&decode_fcc16<4>, 0, &calc_fcc12_to_fcc16, TDst>;
+    case fccXX_pack_type::fcc12_mipi:       return &transform_mono_to_dst_avx2<&decode_fcc12_mipi, fcc12_packed_overread, &calc_fcc12_mipi_to_fcc16, TDst>;
+    case fccXX_pack_type::fcc12_packed:     return &transform_mono_to_dst_avx2<&decode_fcc12_packed, fcc12_packed_overread, &calc_fcc12_packed_to_fcc16, TDst>;
+    case fccXX_pack_type::fcc12_spacked:    return &transform_mono_to_dst_avx2<&decode_fcc12_spacked, fcc12_packed_overread, &calc_fcc12_spacked_to_fcc16, TDst>;
+
+    case fccXX_pack_type::fcc10:            return &transform_mono_to_dst_avx2<&decode_fcc16<6>, 0, &calc_fcc10_to_fcc16, TDst>;
+    case fccXX_pack_type::fcc10_spacked:    return nullptr;
+    case fccXX_pack_type::fcc10_mipi:       return nullptr;
+
+    case fccXX_pack_type::invalid:          return nullptr;
+    };
+    return nullptr;
+}
+
+}
+
+auto    img_filter::transform::fcc1x_packed::get_transform_fcc1x_mono_to_dst_avx2( const img::img_type& dst, const img::img_type& src ) -> transform_function_type
+{
+    if( !can_transform_mono_to_dst( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGRA32:       return select_mono_to_dst_avx2<BGRA32>( src.fourcc_type() );
+    case img::fourcc::MONO16:       return select_mono_to_dst_avx2<uint16_t>( src.fourcc_type() );
+    case img::fourcc::MONOFloat:    return select_mono_to_dst_avx2<float>( src.fourcc_type() );
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,62 @@
+
+#include "transform_fcc1x_mono_to_dst.h"
+#include "transform_fcc1x_mono_to_dst_internal.h"
+
+using namespace fcc1x_packed_internal;
+
+namespace
+{
+
+using namespace fcc1x_mono_to_dst_internal;
+
+template<auto calc, class TDst>
+void transform_mono_to_dst_c( img::img_descriptor dst, img::img_descriptor src )
+{
+    for_each_mono_line<TDst>( dst, src, [width = src.dim.cx]( TDst* dst_line, const uint8_t* src_line )
+        {
+            transform_mono_to_dst_line_c<calc>( dst_line, src_line, 0, width );
+        } );
+}
+
+template<class TDst>
+img_filter::transform_function_type     select_mono_to_dst_c( img::fourcc src_fcc )
+{
+    if( src_fcc == img::fourcc::MONO16 ) {
+        return &transform_mono_to_dst_c<&read_fcc16, TDst>;
+    }
+
+    using namespace img::fcc1x_packed;
+
+    switch( get_fcc1x_pack_type( src_fcc ) )
+    {
+    case fccXX_pack_type::fcc12:            return &transform_mono_to_dst_c<&calc_fcc12_to_fcc16, TDst>;
+    case fccXX_pack_type::fcc12_mipi:       return &transform_mono_to_dst_c<&calc_fcc12_mipi_to_fcc16, TDst>;
+    case fccXX_pack_type::fcc12_packed:     return &transform_mono_to_dst_c<&calc_fcc12_packed_to_fcc16, TDst>;
+    case fccXX_pack_type::fcc12_spacked:    return &transform_mono_to_dst_c<&calc_fcc12_spacked_to_fcc16, TDst>;
+
+    case fccXX_pack_type::fcc10:            return &transform_mono_to_dst_c<&calc_fcc10_to_fcc16, TDst>;
+    case fccXX_pack_type::fcc10_spacked:    return &transform_mono_to_dst_c<&calc_fcc10_spacked_to_fcc16, TDst>;
+    case fccXX_pack_type::fcc10_mipi:       return &transform_mono_to_dst_c<&calc_fcc10_packed_mipi_to_fcc16, TDst>;
+
+    case fccXX_pack_type::invalid:          return nullptr;
+    };
+    return nullptr;
+}
+
+}
+
+auto    img_filter::transform::fcc1x_packed::get_transform_fcc1x_mono_to_dst_c( const img::img_type& dst, const img::img_type& src ) -> transform_function_type
+{
+    if( !can_transform_mono_to_dst( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGRA32:       return select_mono_to_dst_c<BGRA32>( src.fourcc_type() );
+    case img::fourcc::MONO16:       return select_mono_to_dst_c<uint16_t>( src.fourcc_type() );
+    case img::fourcc::MONOFloat:    return select_mono_to_dst_c<float>( src.fourcc_type() );
+    default:
+        return nullptr;
+    }
+}
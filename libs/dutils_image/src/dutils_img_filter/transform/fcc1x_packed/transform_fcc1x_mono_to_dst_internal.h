@@ -0,0 +1,76 @@
+#pragma once
+
+#include "transform_fcc1x_mono_to_dst.h"
+#include "fcc1x_packed_to_fcc16_internal.h"
+
+#include <dutils_img/pixel_structs.h>
+
+namespace fcc1x_mono_to_dst_internal
+{
+    using namespace img::pixel_type;
+
+    constexpr bool  is_accepted_src_fcc( img::fourcc fcc ) noexcept
+    {
+        if( fcc == img::fourcc::MONO16 ) {
+            return true;
+        }
+        const auto info = img::fcc1x_packed::get_fcc1x_pack_info( fcc );
+        return info.is_mono && info.pack_type != img::fcc1x_packed::fccXX_pack_type::invalid;
+    }
+
+    constexpr bool  can_transform_mono_to_dst( const img::img_type& dst, const img::img_type& src ) noexcept
+    {
+        if( dst.dim != src.dim || !is_accepted_src_fcc( src.fourcc_type() ) ) {
+            return false;
+        }
+        return img::is_fcc_in_fcclist( dst.fourcc_type(), { img::fourcc::BGRA32, img::fourcc::MONO16, img::fourcc::MONOFloat } );
+    }
+
+    inline uint16_t     read_fcc16( const void* src_line, int offset ) noexcept
+    {
+        return static_cast<const uint16_t*>( src_line )[offset];
+    }
+
+    constexpr float float_scale = 1.f / 0xFFFF;     // see by16_edge_internal.h
+
+    FORCEINLINE void    store_pixel( BGRA32* dst_line, int x, uint16_t val ) noexcept
+    {
+        const auto v = static_cast<uint8_t>( val >> 8 );
+        dst_line[x] = BGRA32{ v, v, v, 0xFF };
+    }
+
+    FORCEINLINE void    store_pixel( uint16_t* dst_line, int x, uint16_t val ) noexcept
+    {
+        dst_line[x] = val;
+    }
+
+    FORCEINLINE void    store_pixel( float* dst_line, int x, uint16_t val ) noexcept
+    {
+        dst_line[x] = static_cast<float>( val ) * float_scale;
+    }
+
+    // calc is one of the calc_XX_to_fcc16 functions of fcc1x_packed_to_fcc16_internal.h or read_fcc16
+    template<auto calc, class TDst>
+    FORCEINLINE void    transform_mono_to_dst_line_c( TDst* dst_line, const uint8_t* src_line, int x_begin, int width ) noexcept
+    {
+        for( int x = x_begin; x < width; ++x ) {
+            store_pixel( dst_line, x, calc( src_line, x ) );
+        }
+    }
+
+    /** Calls func( dst_line, src_line ) for all lines.
+     * BGRA32 is flipped if allowed.
+     */
+    template<class TDst, class TLineFunc>
+    FORCEINLINE void    for_each_mono_line( const img::img_descriptor& dst_, const img::img_descriptor& src, TLineFunc&& func ) noexcept
+    {
+        const auto dst = dst_.fourcc_type() == img::fourcc::BGRA32 ? img::flip_image_in_img_desc_if_allowed( dst_ ) : dst_;
+
+        assert( dst.dim == src.dim );
+
+        for( int y = 0; y < dst.dim.cy; ++y )
+        {
+            func( img::get_line_start<TDst>( dst, y ), img::get_line_start<const uint8_t>( src, y ) );
+        }
+    }
+}
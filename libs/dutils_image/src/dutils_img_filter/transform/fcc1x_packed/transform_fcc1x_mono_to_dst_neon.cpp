@@ -0,0 +1,139 @@
+
+#include "transform_fcc1x_mono_to_dst.h"
+#include "transform_fcc1x_mono_to_dst_internal.h"
+
+#include "../../simd_helper/use_simd_A64.h"
+
+/*
+ * Each step expands 16 pixels to 16-bit values in pixel order, which are then stored in the dst format.
+ * The 12-bit packed formats are loaded with vld3, which splits the 3 bytes of the pixel pairs, the
+ * even and odd pixels are interleaved again with vzip.
+ * The rest of a line is done by the C line function.
+ */
+
+using namespace fcc1x_packed_internal;
+
+namespace
+{
+
+using namespace fcc1x_mono_to_dst_internal;
+
+FORCEINLINE uint16x8x2_t    decode_fcc12_packed( const uint8_t* src_line, int x ) noexcept
+{
+    // [p0_hi][p0_lo | p1_lo << 4][p1_hi]
+    const uint8x8x3_t b = vld3_u8( src_line + (x / 2) * 3 );
+
+    const uint16x8_t even = vorrq_u16( vshll_n_u8( b.val[0], 8 ), vshll_n_u8( vand_u8( b.val[1], vdup_n_u8( 0x0F ) ), 4 ) );
+    const uint16x8_t odd = vorrq_u16( vshll_n_u8( b.val[2], 8 ), vmovl_u8( vand_u8( b.val[1], vdup_n_u8( 0xF0 ) ) ) );
+    return vzipq_u16( even, odd );
+}
+
+FORCEINLINE uint16x8x2_t    decode_fcc12_mipi( const uint8_t* src_line, int x ) noexcept
+{
+    // [p0_hi][p1_hi][p0_lo | p1_lo << 4]
+    const uint8x8x3_t b = vld3_u8( src_line + (x / 2) * 3 );
+
+    const uint16x8_t even = vorrq_u16( vshll_n_u8( b.val[0], 8 ), vshll_n_u8( vand_u8( b.val[2], vdup_n_u8( 0x0F ) ), 4 ) );
+    const uint16x8_t odd = vorrq_u16( vshll_n_u8( b.val[1], 8 ), vmovl_u8( vand_u8( b.val[2], vdup_n_u8( 0xF0 ) ) ) );
+    return vzipq_u16( even, odd );
+}
+
+FORCEINLINE uint16x8x2_t    decode_fcc12_spacked( const uint8_t* src_line, int x ) noexcept
+{
+    // p0 = b0 << 4 | (b1 & 0x0F) << 12, p1 = (b1 & 0xF0) | b2 << 8
+    const uint8x8x3_t b = vld3_u8( src_line + (x / 2) * 3 );
+
+    const uint16x8_t even = vorrq_u16( vshll_n_u8( b.val[0], 4 ), vshlq_n_u16( vmovl_u8( vand_u8( b.val[1], vdup_n_u8( 0x0F ) ) ), 12 ) );
+    const uint16x8_t odd = vorrq_u16( vshll_n_u8( b.val[2], 8 ), vmovl_u8( vand_u8( b.val[1], vdup_n_u8( 0xF0 ) ) ) );
+    return vzipq_u16( even, odd );
+}
+
+template<int shift>
+FORCEINLINE uint16x8x2_t    decode_fcc16( const uint8_t* src_line, int x ) noexcept
+{
+    const uint16_t* p = reinterpret_cast<const uint16_t*>( src_line ) + x;
+    return uint16x8x2_t{ { vshlq_n_u16( vld1q_u16( p + 0 ), shift ), vshlq_n_u16( vld1q_u16( p + 8 ), shift ) } };
+}
+
+FORCEINLINE void    store_16( BGRA32* dst, uint16x8x2_t v ) noexcept
+{
+    const uint8x16_t y = vcombine_u8( vshrn_n_u16( v.val[0], 8 ), vshrn_n_u16( v.val[1], 8 ) );
+    vst4q_u8( reinterpret_cast<uint8_t*>( dst ), uint8x16x4_t{ { y, y, y, vdupq_n_u8( 0xFF ) } } );
+}
+
+FORCEINLINE void    store_16( uint16_t* dst, uint16x8x2_t v ) noexcept
+{
+    vst1q_u16( dst + 0, v.val[0] );
+    vst1q_u16( dst + 8, v.val[1] );
+}
+
+FORCEINLINE void    store_8( float* dst, uint16x8_t v ) noexcept
+{
+    const float32x4_t scale = vdupq_n_f32( float_scale );
+
+    vst1q_f32( dst + 0, vmulq_f32( vcvtq_f32_u32( vmovl_u16( vget_low_u16( v ) ) ), scale ) );
+    vst1q_f32( dst + 4, vmulq_f32( vcvtq_f32_u32( vmovl_u16( vget_high_u16( v ) ) ), scale ) );
+}
+
+FORCEINLINE void    store_16( float* dst, uint16x8x2_t v ) noexcept
+{
+    store_8( dst + 0, v.val[0] );
+    store_8( dst + 8, v.val[1] );
+}
+
+template<uint16x8x2_t (*decode)( const uint8_t*, int ), auto calc, class TDst>
+void    transform_mono_to_dst_neon( img::img_descriptor dst, img::img_descriptor src )
+{
+    for_each_mono_line<TDst>( dst, src, [width = src.dim.cx]( TDst* dst_line, const uint8_t* src_line )
+        {
+            int x = 0;
+            for( ; x <= (width - 16); x += 16 )
+            {
+                store_16( dst_line + x, decode( src_line, x ) );
+            }
+            transform_mono_to_dst_line_c<calc>( dst_line, src_line, x, width );
+        } );
+}
+
+template<class TDst>
+img_filter::transform_function_type     select_mono_to_dst_neon( img::fourcc src_fcc )
+{
+    if( src_fcc == img::fourcc::MONO16 ) {
+        return &transform_mono_to_dst_neon<&decode_fcc16<0>, &read_fcc16, TDst>;
+    }
+
+    using namespace img::fcc1x_packed;
+
+    switch( get_fcc1x_pack_type( src_fcc ) )
+    {
+    case fccXX_pack_type::fcc12:            return &transform_mono_to_dst_neon<&decode_fcc16<4>, &calc_fcc12_to_fcc16, TDst>;
+    case fccXX_pack_type::fcc12_mipi:       return &transform_mono_to_dst_neon<&decode_fcc12_mipi, &calc_fcc12_mipi_to_fcc16, TDst>;
+    case fccXX_pack_type::fcc12_packed:     return &transform_mono_to_dst_neon<&decode_fcc12_packed, &calc_fcc12_packed_to_fcc16, TDst>;
+    case fccXX_pack_type::fcc12_spacked:    return &transform_mono_to_dst_neon<&decode_fcc12_spacked, &calc_fcc12_spacked_to_fcc16, TDst>;
+
+    case fccXX_pack_type::fcc10:            return &transform_mono_to_dst_neon<&decode_fcc16<6>, &calc_fcc10_to_fcc16, TDst>;
+    case fccXX_pack_type::fcc10_spacked:    return nullptr;
+    case fccXX_pack_type::fcc10_mipi:       return nullptr;
+
+    case fccXX_pack_type::invalid:          return nullptr;
+    };
+    return nullptr;
+}
+
+}
+
+auto    img_filter::transform::fcc1x_packed::get_transform_fcc1x_mono_to_dst_neon( const img::img_type& dst, const img::img_type& src ) -> transform_function_type
+{
+    if( !can_transform_mono_to_dst( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGRA32:       return select_mono_to_dst_neon<BGRA32>( src.fourcc_type() );
+    case img::fourcc::MONO16:       return select_mono_to_dst_neon<uint16_t>( src.fourcc_type() );
+    case img::fourcc::MONOFloat:    return select_mono_to_dst_neon<float>( src.fourcc_type() );
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,61 @@
+
+#pragma once
+
+#include "../../dutils_img_base.h"
+#include "../transform_base.h"
+
+namespace img_filter::transform::orientation
+{
+    enum class mode
+    {
+        identity,
+        rotate_90,          // clockwise
+        rotate_180,
+        rotate_270,         // clockwise, so 90 degrees counter-clockwise
+        flip_horizontal,
+        flip_vertical,
+    };
+
+    constexpr bool  swaps_dim( mode m ) noexcept
+    {
+        return m == mode::rotate_90 || m == mode::rotate_270;
+    }
+
+    /* Dimensions of an image with the dimensions src after it was oriented by m, also the inverse. */
+    constexpr img::dim  calc_oriented_dim( img::dim src, mode m ) noexcept
+    {
+        return swaps_dim( m ) ? img::dim{ src.cy, src.cx } : src;
+    }
+
+    /* Formats with whole pixels per byte group, bayer formats would change their pattern and YUY2 shares the chroma of 2 pixels. */
+    constexpr bool  can_orient( img::fourcc fcc ) noexcept
+    {
+        switch( fcc )
+        {
+        case img::fourcc::MONO8:
+        case img::fourcc::MONO16:
+        case img::fourcc::MONOFloat:
+        case img::fourcc::BGRA32:
+        case img::fourcc::BGRA64:
+        case img::fourcc::BGRFloat:
+        case img::fourcc::NV12:
+        case img::fourcc::I420:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /** Moves a range of lines of an image to their rotated or flipped position in dst.
+     *
+     * src are the lines [y_beg, y_beg + src.dim.cy) of an image with the dimensions calc_oriented_dim( dst.dim, m ),
+     * dst is the whole oriented image. So a conversion can orient every strip while it is still in the cache, instead of
+     * a second pass over the whole image.
+     * dst and src have the same format of can_orient and are addressed as they are laid out in memory, the flip flags are ignored.
+     * For NV12 and I420, y_beg and the number of lines have to be even.
+     */
+    using function_type = void (*)( img::img_descriptor dst, img::img_descriptor src, int y_beg );
+
+    /* src is the type of the whole image before it is oriented */
+    function_type   get_orientation_c( const img::img_type& dst, const img::img_type& src, mode m );
+}
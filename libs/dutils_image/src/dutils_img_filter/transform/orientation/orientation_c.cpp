@@ -0,0 +1,121 @@
+
+#include "orientation.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    using namespace img_filter::transform::orientation;
+
+struct pixel96
+{
+    uint32_t    v[3];
+};
+
+template<class T>
+FORCEINLINE T*      line_start( void* ptr, int pitch, int y ) noexcept
+{
+    return reinterpret_cast<T*>( static_cast<uint8_t*>( ptr ) + static_cast<int64_t>( y ) * pitch );
+}
+
+/* dim_x and height are the dimensions of the whole plane before it is oriented, src holds the lines [y_beg, y_beg + lines). */
+template<class TPixel, mode m>
+void    orient_plane( img::img_plane dst, img::img_plane src, int dim_x, int height, int y_beg, int lines ) noexcept
+{
+    if constexpr( m == mode::identity || m == mode::flip_vertical )
+    {
+        for( int y = 0; y < lines; ++y )
+        {
+            const int dst_y = m == mode::identity ? y_beg + y : height - 1 - (y_beg + y);
+            std::memcpy( line_start<TPixel>( dst.plane_ptr, dst.pitch, dst_y ), line_start<TPixel>( src.plane_ptr, src.pitch, y ), dim_x * sizeof( TPixel ) );
+        }
+    }
+    else if constexpr( m == mode::flip_horizontal || m == mode::rotate_180 )
+    {
+        for( int y = 0; y < lines; ++y )
+        {
+            const int dst_y = m == mode::flip_horizontal ? y_beg + y : height - 1 - (y_beg + y);
+            const auto* src_line = line_start<TPixel>( src.plane_ptr, src.pitch, y );
+            std::reverse_copy( src_line, src_line + dim_x, line_start<TPixel>( dst.plane_ptr, dst.pitch, dst_y ) );
+        }
+    }
+    else
+    {
+        // Column x of src becomes a dst line. The lines of src are few and in the cache, so they are read across
+        // and every dst line is written in one go.
+        for( int x = 0; x < dim_x; ++x )
+        {
+            const int dst_y = m == mode::rotate_90 ? x : dim_x - 1 - x;
+            auto* dst_line = line_start<TPixel>( dst.plane_ptr, dst.pitch, dst_y );
+            for( int y = 0; y < lines; ++y )
+            {
+                const int dst_x = m == mode::rotate_90 ? height - 1 - (y_beg + y) : y_beg + y;
+                dst_line[dst_x] = line_start<TPixel>( src.plane_ptr, src.pitch, y )[x];
+            }
+        }
+    }
+}
+
+template<mode m>
+void    orient_lines( img::img_descriptor dst, img::img_descriptor src, int y_beg )
+{
+    const auto fcc = src.fourcc_type();
+    const auto image_dim = calc_oriented_dim( dst.dim, m );
+
+    const int plane_count = img::planar::get_plane_count( fcc );
+    for( int index = 0; index < plane_count; ++index )
+    {
+        int bits_per_pixel = img::get_bits_per_pixel( fcc );
+        float scale_x = 1.f;
+        float scale_y = 1.f;
+        if( plane_count > 1 )
+        {
+            const auto info = img::planar::get_fcc_info( fcc, index );
+            bits_per_pixel = info.bits_per_pixel;
+            scale_x = info.scale_dim_x;
+            scale_y = info.scale_dim_y;
+        }
+
+        const int dim_x = static_cast<int>( image_dim.cx * scale_x );
+        const int height = static_cast<int>( image_dim.cy * scale_y );
+        const int plane_y_beg = static_cast<int>( y_beg * scale_y );
+        const int lines = static_cast<int>( src.dim.cy * scale_y );
+
+        const auto d = dst.plane( index );
+        const auto s = src.plane( index );
+        switch( bits_per_pixel )
+        {
+        case 8:     orient_plane<uint8_t, m>( d, s, dim_x, height, plane_y_beg, lines ); break;
+        case 16:    orient_plane<uint16_t, m>( d, s, dim_x, height, plane_y_beg, lines ); break;
+        case 32:    orient_plane<uint32_t, m>( d, s, dim_x, height, plane_y_beg, lines ); break;
+        case 64:    orient_plane<uint64_t, m>( d, s, dim_x, height, plane_y_beg, lines ); break;
+        case 96:    orient_plane<pixel96, m>( d, s, dim_x, height, plane_y_beg, lines ); break;
+        default:
+            break;
+        }
+    }
+}
+
+}
+
+img_filter::transform::orientation::function_type   img_filter::transform::orientation::get_orientation_c( const img::img_type& dst, const img::img_type& src, mode m )
+{
+    if( !can_orient( src.fourcc_type() ) || dst.fourcc_type() != src.fourcc_type() || dst.dim != calc_oriented_dim( src.dim, m ) ) {
+        return nullptr;
+    }
+    if( img::is_multi_plane_format( src.fourcc_type() ) && (src.dim.cx % 2 != 0 || src.dim.cy % 2 != 0) ) {
+        return nullptr;
+    }
+
+    switch( m )
+    {
+    case mode::identity:        return &orient_lines<mode::identity>;
+    case mode::rotate_90:       return &orient_lines<mode::rotate_90>;
+    case mode::rotate_180:      return &orient_lines<mode::rotate_180>;
+    case mode::rotate_270:      return &orient_lines<mode::rotate_270>;
+    case mode::flip_horizontal: return &orient_lines<mode::flip_horizontal>;
+    case mode::flip_vertical:   return &orient_lines<mode::flip_vertical>;
+    };
+    return nullptr;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "../transform_base.h"
+
+namespace img_filter {
+namespace transform {
+namespace polarization
+{
+    /** Conversions of the polarized mono formats with the 2x2 filter layout [90, 45] / [135, 0].
+     *
+     * POLARIZATION_MONO8_90_45_135_0 ->  POLARIZATION_PACKED8, POLARIZATION_ADI_MONO8, BGRA32, BGRFloat
+     * POLARIZATION_MONO16_90_45_135_0 -> POLARIZATION_PACKED16, POLARIZATION_ADI_MONO16, BGRA32, BGRFloat
+     *
+     * Every pixel gets all 4 angles from the 2x2 window starting at it, the last column and line use the window in front of them.
+     * dst.dim lines are converted, src may have one more line than dst, which is then used as the neighbour of the last dst line.
+     * This allows converting bands of an image, bands have to start on even lines.
+     *
+     * POLARIZATION_PACKED8/16:     the 4 angles
+     * POLARIZATION_ADI_MONO8/16:   AoLP scaled from [0, pi) to [0, max], DoLP scaled from [0, 1] to [0, max], the mean intensity
+     * BGRA32:                      false colour visualization, hue = AoLP, saturation = DoLP, value = intensity
+     * BGRFloat:                    the stokes parameters b = S0, g = S1, r = S2, divided by 2 * max, so that S0 is in [0, 1]
+     *
+     * The 12-bit packed formats have to be unpacked to POLARIZATION_MONO16_90_45_135_0 first.
+     */
+    transform_function_type     get_transform_polarization_c( const img::img_type& dst, const img::img_type& src );
+    transform_function_type     get_transform_polarization_avx2( const img::img_type& dst, const img::img_type& src );
+    transform_function_type     get_transform_polarization_neon( const img::img_type& dst, const img::img_type& src );
+}
+}
+}
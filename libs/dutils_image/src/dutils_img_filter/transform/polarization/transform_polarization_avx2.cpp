@@ -0,0 +1,276 @@
+
+#include "transform_polarization.h"
+#include "transform_polarization_internal.h"
+
+#include "../../simd_helper/use_simd_avx2.h"
+
+/*
+ * Each step converts 8 pixels starting at an even pixel, in 32-bit lanes. The windows of the odd pixels have the
+ * angles of the even pixels swapped horizontally, which is a fixed blend per lane.
+ * The steps read the pixels [x, x + 8], the rest of a line is done by the C line function.
+ *
+ * The floating point calculations are done in the same order as in transform_polarization_internal.
+ */
+
+namespace
+{
+
+using namespace transform_polarization_internal;
+
+struct quad_8
+{
+    __m256i i0;
+    __m256i i45;
+    __m256i i90;
+    __m256i i135;
+};
+
+FORCEINLINE __m256i     load_8( const uint8_t* src ) noexcept
+{
+    return _mm256_cvtepu8_epi32( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( src ) ) );
+}
+
+FORCEINLINE __m256i     load_8( const uint16_t* src ) noexcept
+{
+    return _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) ) );
+}
+
+template<class TSrc>
+FORCEINLINE quad_8      read_quad_8( const TSrc* line0, const TSrc* line1, int x, bool odd_line ) noexcept
+{
+    const __m256i a = load_8( line0 + x );
+    const __m256i b = load_8( line0 + x + 1 );
+    const __m256i c = load_8( line1 + x );
+    const __m256i d = load_8( line1 + x + 1 );
+
+    // the odd lanes start at odd pixels, so a/b and c/d are swapped there
+    const __m256i e0 = _mm256_blend_epi32( a, b, 0xAA );
+    const __m256i e1 = _mm256_blend_epi32( b, a, 0xAA );
+    const __m256i f0 = _mm256_blend_epi32( c, d, 0xAA );
+    const __m256i f1 = _mm256_blend_epi32( d, c, 0xAA );
+    if( odd_line ) {
+        return quad_8{ e1, f1, f0, e0 };
+    }
+    return quad_8{ f1, e1, e0, f0 };
+}
+
+struct stokes_8
+{
+    __m256i sum;
+    __m256  s0;
+    __m256  s1;
+    __m256  s2;
+};
+
+FORCEINLINE stokes_8    calc_stokes( const quad_8& q ) noexcept
+{
+    const __m256i sum = _mm256_add_epi32( _mm256_add_epi32( q.i0, q.i45 ), _mm256_add_epi32( q.i90, q.i135 ) );
+    return stokes_8{
+        sum,
+        _mm256_mul_ps( _mm256_cvtepi32_ps( sum ), _mm256_set1_ps( 0.5f ) ),
+        _mm256_cvtepi32_ps( _mm256_sub_epi32( q.i0, q.i90 ) ),
+        _mm256_cvtepi32_ps( _mm256_sub_epi32( q.i45, q.i135 ) ),
+    };
+}
+
+FORCEINLINE __m256      calc_aolp( __m256 s1, __m256 s2 ) noexcept
+{
+    const __m256 sign_mask = _mm256_set1_ps( -0.f );
+    const __m256 zero = _mm256_setzero_ps();
+
+    const __m256 ax = _mm256_andnot_ps( sign_mask, s1 );
+    const __m256 ay = _mm256_andnot_ps( sign_mask, s2 );
+    const __m256 t = _mm256_div_ps( _mm256_min_ps( ax, ay ), _mm256_max_ps( _mm256_max_ps( ax, ay ), _mm256_set1_ps( FLT_MIN ) ) );
+
+    const __m256 t2 = _mm256_mul_ps( t, t );
+    __m256 p = _mm256_set1_ps( -0.01172120f );
+    p = _mm256_add_ps( _mm256_mul_ps( p, t2 ), _mm256_set1_ps( 0.05265332f ) );
+    p = _mm256_sub_ps( _mm256_mul_ps( p, t2 ), _mm256_set1_ps( 0.11643287f ) );
+    p = _mm256_add_ps( _mm256_mul_ps( p, t2 ), _mm256_set1_ps( 0.19354346f ) );
+    p = _mm256_sub_ps( _mm256_mul_ps( p, t2 ), _mm256_set1_ps( 0.33262347f ) );
+    p = _mm256_add_ps( _mm256_mul_ps( p, t2 ), _mm256_set1_ps( 0.99997726f ) );
+
+    __m256 r = _mm256_mul_ps( p, t );
+    r = _mm256_blendv_ps( r, _mm256_sub_ps( _mm256_set1_ps( pi / 2 ), r ), _mm256_cmp_ps( ay, ax, _CMP_GT_OQ ) );
+    r = _mm256_blendv_ps( r, _mm256_sub_ps( _mm256_set1_ps( pi ), r ), _mm256_cmp_ps( s1, zero, _CMP_LT_OQ ) );
+    r = _mm256_blendv_ps( r, _mm256_sub_ps( _mm256_set1_ps( 2 * pi ), r ), _mm256_cmp_ps( s2, zero, _CMP_LT_OQ ) );
+    return _mm256_mul_ps( r, _mm256_set1_ps( 0.5f ) );
+}
+
+FORCEINLINE __m256      calc_dolp( const stokes_8& st ) noexcept
+{
+    const __m256 mag = _mm256_sqrt_ps( _mm256_add_ps( _mm256_mul_ps( st.s1, st.s1 ), _mm256_mul_ps( st.s2, st.s2 ) ) );
+    const __m256 dolp = _mm256_div_ps( mag, _mm256_max_ps( st.s0, _mm256_set1_ps( FLT_MIN ) ) );
+    return _mm256_min_ps( dolp, _mm256_set1_ps( 1.f ) );
+}
+
+FORCEINLINE __m256i     round_to_int( __m256 v ) noexcept
+{
+    return _mm256_cvttps_epi32( _mm256_add_ps( v, _mm256_set1_ps( 0.5f ) ) );
+}
+
+FORCEINLINE __m256      calc_hsv_channel( float n, __m256 h6, __m256 s, __m256 v ) noexcept
+{
+    const __m256 six = _mm256_set1_ps( 6.f );
+
+    __m256 k = _mm256_add_ps( _mm256_set1_ps( n ), h6 );
+    k = _mm256_blendv_ps( k, _mm256_sub_ps( k, six ), _mm256_cmp_ps( k, six, _CMP_GE_OQ ) );
+    __m256 w = _mm256_min_ps( k, _mm256_sub_ps( _mm256_set1_ps( 4.f ), k ) );
+    w = _mm256_min_ps( _mm256_max_ps( w, _mm256_setzero_ps() ), _mm256_set1_ps( 1.f ) );
+    return _mm256_sub_ps( v, _mm256_mul_ps( _mm256_mul_ps( v, s ), w ) );
+}
+
+// c0..c3 hold 8 bit values
+FORCEINLINE void        store_4x8( void* dst, __m256i c0, __m256i c1, __m256i c2, __m256i c3 ) noexcept
+{
+    const __m256i v = _mm256_or_si256(
+        _mm256_or_si256( c0, _mm256_slli_epi32( c1, 8 ) ),
+        _mm256_or_si256( _mm256_slli_epi32( c2, 16 ), _mm256_slli_epi32( c3, 24 ) ) );
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst ), v );
+}
+
+// c0..c3 hold 16 bit values
+FORCEINLINE void        store_4x16( void* dst, __m256i c0, __m256i c1, __m256i c2, __m256i c3 ) noexcept
+{
+    const __m256i lo = _mm256_or_si256( c0, _mm256_slli_epi32( c1, 16 ) );
+    const __m256i hi = _mm256_or_si256( c2, _mm256_slli_epi32( c3, 16 ) );
+
+    // [p0, p1, p4, p5], [p2, p3, p6, p7]
+    const __m256i v0 = _mm256_unpacklo_epi32( lo, hi );
+    const __m256i v1 = _mm256_unpackhi_epi32( lo, hi );
+
+    auto* dst_ptr = reinterpret_cast<__m256i*>( dst );
+    _mm256_storeu_si256( dst_ptr + 0, _mm256_permute2x128_si256( v0, v1, 0x20 ) );
+    _mm256_storeu_si256( dst_ptr + 1, _mm256_permute2x128_si256( v0, v1, 0x31 ) );
+}
+
+template<class TSrc>
+FORCEINLINE void        store_4( void* dst, __m256i c0, __m256i c1, __m256i c2, __m256i c3 ) noexcept
+{
+    if constexpr( sizeof( TSrc ) == 1 ) {
+        store_4x8( dst, c0, c1, c2, c3 );
+    } else {
+        store_4x16( dst, c0, c1, c2, c3 );
+    }
+}
+
+template<class TSrc, class TDst>
+struct to_packed_avx2_op
+{
+    using c_op = to_packed_op<TSrc, TDst>;
+
+    FORCEINLINE void    operator()( TDst* dst, const quad_8& q ) const noexcept
+    {
+        store_4<TSrc>( dst, q.i0, q.i45, q.i90, q.i135 );
+    }
+};
+
+template<class TSrc, class TDst>
+struct to_adi_avx2_op
+{
+    using c_op = to_adi_op<TSrc, TDst>;
+
+    FORCEINLINE void    operator()( TDst* dst, const quad_8& q ) const noexcept
+    {
+        const stokes_8 st = calc_stokes( q );
+
+        const __m256i aolp = _mm256_min_epi32( round_to_int( _mm256_mul_ps( calc_aolp( st.s1, st.s2 ), _mm256_set1_ps( c_op::aolp_scale ) ) ),
+            _mm256_set1_epi32( max_value<TSrc> ) );
+        const __m256i dolp = round_to_int( _mm256_mul_ps( calc_dolp( st ), _mm256_set1_ps( c_op::max_val ) ) );
+        const __m256i intensity = _mm256_srli_epi32( _mm256_add_epi32( st.sum, _mm256_set1_epi32( 2 ) ), 2 );
+
+        store_4<TSrc>( dst, aolp, dolp, intensity, _mm256_setzero_si256() );
+    }
+};
+
+template<class TSrc>
+struct to_bgra32_avx2_op
+{
+    using c_op = to_bgra32_op<TSrc>;
+
+    FORCEINLINE void    operator()( BGRA32* dst, const quad_8& q ) const noexcept
+    {
+        const stokes_8 st = calc_stokes( q );
+
+        const __m256 h6 = _mm256_mul_ps( calc_aolp( st.s1, st.s2 ), _mm256_set1_ps( c_op::hue_scale ) );
+        const __m256 s = calc_dolp( st );
+        const __m256 v = _mm256_mul_ps( _mm256_cvtepi32_ps( st.sum ), _mm256_set1_ps( c_op::value_scale ) );
+
+        const __m256i b = round_to_int( calc_hsv_channel( 1.f, h6, s, v ) );
+        const __m256i g = round_to_int( calc_hsv_channel( 3.f, h6, s, v ) );
+        const __m256i r = round_to_int( calc_hsv_channel( 5.f, h6, s, v ) );
+        store_4x8( dst, b, g, r, _mm256_set1_epi32( 0xFF ) );
+    }
+};
+
+template<class TSrc>
+struct to_stokes_avx2_op
+{
+    using c_op = to_stokes_op<TSrc>;
+
+    FORCEINLINE void    operator()( BGRf* dst, const quad_8& q ) const noexcept
+    {
+        const stokes_8 st = calc_stokes( q );
+        const __m256 norm = _mm256_set1_ps( c_op::norm );
+
+        alignas(32) float tmp[3][8];
+        _mm256_store_ps( tmp[0], _mm256_mul_ps( st.s0, norm ) );
+        _mm256_store_ps( tmp[1], _mm256_mul_ps( st.s1, norm ) );
+        _mm256_store_ps( tmp[2], _mm256_mul_ps( st.s2, norm ) );
+        for( int i = 0; i < 8; ++i ) {
+            dst[i] = BGRf{ tmp[0][i], tmp[1][i], tmp[2][i] };
+        }
+    }
+};
+
+template<class TSrc, class TOp>
+void transform_polarization_avx2( img::img_descriptor dst, img::img_descriptor src )
+{
+    using c_op = typename TOp::c_op;
+
+    const TOp op;
+    const c_op tail_op;
+    for_each_polarization_line<TSrc, typename c_op::dst_type>( dst, src,
+        [&op, &tail_op, dim_x = dst.dim.cx]( auto* dst_line, const TSrc* line0, const TSrc* line1, bool odd_line )
+        {
+            int x = 0;
+            for( ; x + 9 <= dim_x; x += 8 )
+            {
+                op( dst_line + x, read_quad_8( line0, line1, x, odd_line ) );
+            }
+            transform_polarization_line_c( dst_line, line0, line1, x, dim_x, odd_line, tail_op );
+        } );
+}
+
+}
+
+img_filter::transform_function_type     img_filter::transform::polarization::get_transform_polarization_avx2( const img::img_type& dst, const img::img_type& src )
+{
+    using namespace img::pixel_type::polarization;
+
+    if( !can_transform_polarization( dst, src ) ) {
+        return nullptr;
+    }
+
+    if( src.fourcc_type() == img::fourcc::POLARIZATION_MONO8_90_45_135_0 )
+    {
+        switch( dst.fourcc_type() )
+        {
+        case img::fourcc::POLARIZATION_PACKED8:     return ::transform_polarization_avx2<uint8_t, to_packed_avx2_op<uint8_t, POL_PACKED8>>;
+        case img::fourcc::POLARIZATION_ADI_MONO8:   return ::transform_polarization_avx2<uint8_t, to_adi_avx2_op<uint8_t, ADI_MONO8>>;
+        case img::fourcc::BGRA32:                   return ::transform_polarization_avx2<uint8_t, to_bgra32_avx2_op<uint8_t>>;
+        case img::fourcc::BGRFloat:                 return ::transform_polarization_avx2<uint8_t, to_stokes_avx2_op<uint8_t>>;
+        default:
+            return nullptr;
+        }
+    }
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::POLARIZATION_PACKED16:    return ::transform_polarization_avx2<uint16_t, to_packed_avx2_op<uint16_t, POL_PACKED16_LE>>;
+    case img::fourcc::POLARIZATION_ADI_MONO16:  return ::transform_polarization_avx2<uint16_t, to_adi_avx2_op<uint16_t, ADI_MONO16_LE>>;
+    case img::fourcc::BGRA32:                   return ::transform_polarization_avx2<uint16_t, to_bgra32_avx2_op<uint16_t>>;
+    case img::fourcc::BGRFloat:                 return ::transform_polarization_avx2<uint16_t, to_stokes_avx2_op<uint16_t>>;
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,52 @@
+
+#include "transform_polarization.h"
+#include "transform_polarization_internal.h"
+
+namespace
+{
+
+using namespace transform_polarization_internal;
+
+template<class TSrc, class TOp>
+void transform_polarization_c( img::img_descriptor dst, img::img_descriptor src )
+{
+    const TOp op;
+    for_each_polarization_line<TSrc, typename TOp::dst_type>( dst, src,
+        [&op, dim_x = dst.dim.cx]( auto* dst_line, const TSrc* line0, const TSrc* line1, bool odd_line )
+        {
+            transform_polarization_line_c( dst_line, line0, line1, 0, dim_x, odd_line, op );
+        } );
+}
+
+}
+
+img_filter::transform_function_type     img_filter::transform::polarization::get_transform_polarization_c( const img::img_type& dst, const img::img_type& src )
+{
+    using namespace img::pixel_type::polarization;
+
+    if( !can_transform_polarization( dst, src ) ) {
+        return nullptr;
+    }
+
+    if( src.fourcc_type() == img::fourcc::POLARIZATION_MONO8_90_45_135_0 )
+    {
+        switch( dst.fourcc_type() )
+        {
+        case img::fourcc::POLARIZATION_PACKED8:     return ::transform_polarization_c<uint8_t, to_packed_op<uint8_t, POL_PACKED8>>;
+        case img::fourcc::POLARIZATION_ADI_MONO8:   return ::transform_polarization_c<uint8_t, to_adi_op<uint8_t, ADI_MONO8>>;
+        case img::fourcc::BGRA32:                   return ::transform_polarization_c<uint8_t, to_bgra32_op<uint8_t>>;
+        case img::fourcc::BGRFloat:                 return ::transform_polarization_c<uint8_t, to_stokes_op<uint8_t>>;
+        default:
+            return nullptr;
+        }
+    }
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::POLARIZATION_PACKED16:    return ::transform_polarization_c<uint16_t, to_packed_op<uint16_t, POL_PACKED16_LE>>;
+    case img::fourcc::POLARIZATION_ADI_MONO16:  return ::transform_polarization_c<uint16_t, to_adi_op<uint16_t, ADI_MONO16_LE>>;
+    case img::fourcc::BGRA32:                   return ::transform_polarization_c<uint16_t, to_bgra32_op<uint16_t>>;
+    case img::fourcc::BGRFloat:                 return ::transform_polarization_c<uint16_t, to_stokes_op<uint16_t>>;
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "transform_polarization.h"
+
+#include <dutils_img/pixel_structs.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace transform_polarization_internal
+{
+    using namespace img::pixel_type;
+
+    constexpr bool  can_transform_polarization( const img::img_type& dst, const img::img_type& src ) noexcept
+    {
+        if( dst.dim != src.dim || src.dim.cx < 2 || src.dim.cy < 2 ) {
+            return false;
+        }
+        switch( src.fourcc_type() )
+        {
+        case img::fourcc::POLARIZATION_MONO8_90_45_135_0:
+            return img::is_fcc_in_fcclist( dst.fourcc_type(), { img::fourcc::POLARIZATION_PACKED8, img::fourcc::POLARIZATION_ADI_MONO8,
+                img::fourcc::BGRA32, img::fourcc::BGRFloat } );
+        case img::fourcc::POLARIZATION_MONO16_90_45_135_0:
+            return img::is_fcc_in_fcclist( dst.fourcc_type(), { img::fourcc::POLARIZATION_PACKED16, img::fourcc::POLARIZATION_ADI_MONO16,
+                img::fourcc::BGRA32, img::fourcc::BGRFloat } );
+        default:
+            return false;
+        }
+    }
+
+    struct polarization_quad
+    {
+        int i0;
+        int i45;
+        int i90;
+        int i135;
+    };
+
+    /** Reads the 2x2 window starting at x, x has to be <= dim_x - 2.
+     * Even lines hold [90, 45], odd lines [135, 0], so the angles of the window depend on the parity of x and of the line.
+     */
+    template<class TSrc>
+    FORCEINLINE polarization_quad   read_quad( const TSrc* line0, const TSrc* line1, int x, bool odd_line ) noexcept
+    {
+        int a = line0[x];
+        int b = line0[x + 1];
+        int c = line1[x];
+        int d = line1[x + 1];
+        if( x & 1 ) {
+            std::swap( a, b );
+            std::swap( c, d );
+        }
+        if( odd_line ) {
+            return polarization_quad{ b, d, c, a };
+        }
+        return polarization_quad{ d, b, a, c };
+    }
+
+    constexpr float pi = 3.14159265358979f;
+
+    // The SIMD variants repeat these calculations in the same order, so that the results are the same.
+
+    // atan( t ) for t in [0, 1], the error is below 1e-5
+    FORCEINLINE float   calc_atan_0_1( float t ) noexcept
+    {
+        const float t2 = t * t;
+        float p = -0.01172120f;
+        p = p * t2 + 0.05265332f;
+        p = p * t2 - 0.11643287f;
+        p = p * t2 + 0.19354346f;
+        p = p * t2 - 0.33262347f;
+        p = p * t2 + 0.99997726f;
+        return p * t;
+    }
+
+    // AoLP in [0, pi), i.e. atan2( s2, s1 ) / 2 with the negative angles moved up by 2 * pi
+    FORCEINLINE float   calc_aolp( float s1, float s2 ) noexcept
+    {
+        const float ax = std::abs( s1 );
+        const float ay = std::abs( s2 );
+        const float t = std::min( ax, ay ) / std::max( std::max( ax, ay ), FLT_MIN );
+
+        float r = calc_atan_0_1( t );
+        r = ay > ax ? (pi / 2) - r : r;
+        r = s1 < 0 ? pi - r : r;
+        r = s2 < 0 ? (2 * pi) - r : r;
+        return r * 0.5f;
+    }
+
+    // DoLP in [0, 1]
+    FORCEINLINE float   calc_dolp( float s0, float s1, float s2 ) noexcept
+    {
+        const float mag = std::sqrt( s1 * s1 + s2 * s2 );
+        return std::min( mag / std::max( s0, FLT_MIN ), 1.f );
+    }
+
+    FORCEINLINE int     round_to_int( float v ) noexcept
+    {
+        return static_cast<int>( v + 0.5f );
+    }
+
+    template<class TSrc>
+    constexpr int   max_value = std::numeric_limits<TSrc>::max();
+
+    template<class TSrc, class TDst>
+    struct to_packed_op
+    {
+        using dst_type = TDst;
+        using value_type = decltype( TDst::angle0 );
+
+        FORCEINLINE TDst    operator()( const polarization_quad& q ) const noexcept
+        {
+            return TDst{ static_cast<value_type>( q.i0 ), static_cast<value_type>( q.i45 ), static_cast<value_type>( q.i90 ), static_cast<value_type>( q.i135 ) };
+        }
+    };
+
+    template<class TSrc, class TDst>
+    struct to_adi_op
+    {
+        using dst_type = TDst;
+        using value_type = decltype( TDst::intensity );
+
+        static constexpr float  max_val = static_cast<float>( max_value<TSrc> );
+        static constexpr float  aolp_scale = max_val / pi;
+
+        FORCEINLINE TDst    operator()( const polarization_quad& q ) const noexcept
+        {
+            const int sum = q.i0 + q.i45 + q.i90 + q.i135;
+            const float s0 = static_cast<float>( sum ) * 0.5f;
+            const float s1 = static_cast<float>( q.i0 - q.i90 );
+            const float s2 = static_cast<float>( q.i45 - q.i135 );
+
+            const int aolp = std::min( round_to_int( calc_aolp( s1, s2 ) * aolp_scale ), max_value<TSrc> );
+            const int dolp = round_to_int( calc_dolp( s0, s1, s2 ) * max_val );
+            const int intensity = (sum + 2) >> 2;
+            return TDst{ static_cast<value_type>( aolp ), static_cast<value_type>( dolp ), static_cast<value_type>( intensity ), 0 };
+        }
+    };
+
+    // hsv to rgb for one channel, n = 5 for r, 3 for g and 1 for b
+    FORCEINLINE float   calc_hsv_channel( float n, float h6, float s, float v ) noexcept
+    {
+        float k = n + h6;
+        k = k >= 6.f ? k - 6.f : k;
+        const float w = std::min( std::max( std::min( k, 4.f - k ), 0.f ), 1.f );
+        return v - v * s * w;
+    }
+
+    template<class TSrc>
+    struct to_bgra32_op
+    {
+        using dst_type = BGRA32;
+
+        static constexpr float  hue_scale = 6.f / pi;
+        static constexpr float  value_scale = 255.f / (4.f * max_value<TSrc>);
+
+        FORCEINLINE BGRA32  operator()( const polarization_quad& q ) const noexcept
+        {
+            const int sum = q.i0 + q.i45 + q.i90 + q.i135;
+            const float s0 = static_cast<float>( sum ) * 0.5f;
+            const float s1 = static_cast<float>( q.i0 - q.i90 );
+            const float s2 = static_cast<float>( q.i45 - q.i135 );
+
+            const float h6 = calc_aolp( s1, s2 ) * hue_scale;
+            const float s = calc_dolp( s0, s1, s2 );
+            const float v = static_cast<float>( sum ) * value_scale;
+
+            return BGRA32{
+                static_cast<uint8_t>( round_to_int( calc_hsv_channel( 1.f, h6, s, v ) ) ),
+                static_cast<uint8_t>( round_to_int( calc_hsv_channel( 3.f, h6, s, v ) ) ),
+                static_cast<uint8_t>( round_to_int( calc_hsv_channel( 5.f, h6, s, v ) ) ),
+                0xFF
+            };
+        }
+    };
+
+    template<class TSrc>
+    struct to_stokes_op
+    {
+        using dst_type = BGRf;
+
+        static constexpr float  norm = 1.f / (2.f * max_value<TSrc>);
+
+        FORCEINLINE BGRf    operator()( const polarization_quad& q ) const noexcept
+        {
+            const int sum = q.i0 + q.i45 + q.i90 + q.i135;
+            const float s0 = static_cast<float>( sum ) * 0.5f;
+            const float s1 = static_cast<float>( q.i0 - q.i90 );
+            const float s2 = static_cast<float>( q.i45 - q.i135 );
+            return BGRf{ s0 * norm, s1 * norm, s2 * norm };
+        }
+    };
+
+    template<class TSrc, class TOp>
+    FORCEINLINE void    transform_polarization_line_c( typename TOp::dst_type* dst_line, const TSrc* line0, const TSrc* line1, int x_begin, int dim_x, bool odd_line, const TOp& op ) noexcept
+    {
+        for( int x = x_begin; x < dim_x; ++x )
+        {
+            const int xs = std::min( x, dim_x - 2 );
+            dst_line[x] = op( read_quad( line0, line1, xs, odd_line ) );
+        }
+    }
+
+    /** Calls func( dst_line, line0, line1, odd_line ) for all dst lines, see get_transform_polarization_c for the handling of the last line.
+     * BGRA32 is flipped if allowed.
+     */
+    template<class TSrc, class TDst, class TLineFunc>
+    FORCEINLINE void    for_each_polarization_line( const img::img_descriptor& dst_, const img::img_descriptor& src, TLineFunc&& func ) noexcept
+    {
+        const auto dst = img::is_bottom_up_fcc( dst_.fourcc_type() ) ? img::flip_image_in_img_desc_if_allowed( dst_ ) : dst_;
+
+        assert( dst.dim.cx == src.dim.cx );
+        assert( src.dim.cy == dst.dim.cy || src.dim.cy == dst.dim.cy + 1 );
+
+        for( int y = 0; y < dst.dim.cy; ++y )
+        {
+            const int ys = std::min( y, src.dim.cy - 2 );
+            func( img::get_line_start<TDst>( dst, y ),
+                img::get_line_start<const TSrc>( src, ys ),
+                img::get_line_start<const TSrc>( src, ys + 1 ),
+                (ys & 1) != 0 );
+        }
+    }
+}
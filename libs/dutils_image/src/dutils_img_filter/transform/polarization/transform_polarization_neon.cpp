@@ -0,0 +1,285 @@
+
+#include "transform_polarization.h"
+#include "transform_polarization_internal.h"
+
+#include "../../simd_helper/use_simd_A64.h"
+
+/*
+ * Each step converts 8 pixels starting at an even pixel. The windows of the odd pixels have the
+ * angles of the even pixels swapped horizontally, which is a fixed select per lane.
+ * The steps read the pixels [x, x + 8], the rest of a line is done by the C line function.
+ *
+ * The floating point calculations are done in 2 halves of 4 pixels, in the same order as in transform_polarization_internal.
+ * The stores interleave the channels with vst3/vst4.
+ */
+
+namespace
+{
+
+using namespace transform_polarization_internal;
+
+struct quad_8
+{
+    uint16x8_t i0;
+    uint16x8_t i45;
+    uint16x8_t i90;
+    uint16x8_t i135;
+};
+
+FORCEINLINE uint16x8_t  load_8( const uint8_t* src ) noexcept
+{
+    return vmovl_u8( vld1_u8( src ) );
+}
+
+FORCEINLINE uint16x8_t  load_8( const uint16_t* src ) noexcept
+{
+    return vld1q_u16( src );
+}
+
+template<class TSrc>
+FORCEINLINE quad_8      read_quad_8( const TSrc* line0, const TSrc* line1, int x, bool odd_line ) noexcept
+{
+    const uint16x8_t a = load_8( line0 + x );
+    const uint16x8_t b = load_8( line0 + x + 1 );
+    const uint16x8_t c = load_8( line1 + x );
+    const uint16x8_t d = load_8( line1 + x + 1 );
+
+    // the odd lanes start at odd pixels, so a/b and c/d are swapped there
+    const uint16x8_t odd_lanes = vreinterpretq_u16_u32( vdupq_n_u32( 0xFFFF0000 ) );
+    const uint16x8_t e0 = vbslq_u16( odd_lanes, b, a );
+    const uint16x8_t e1 = vbslq_u16( odd_lanes, a, b );
+    const uint16x8_t f0 = vbslq_u16( odd_lanes, d, c );
+    const uint16x8_t f1 = vbslq_u16( odd_lanes, c, d );
+    if( odd_line ) {
+        return quad_8{ e1, f1, f0, e0 };
+    }
+    return quad_8{ f1, e1, e0, f0 };
+}
+
+struct stokes_4
+{
+    int32x4_t   sum;
+    float32x4_t s0;
+    float32x4_t s1;
+    float32x4_t s2;
+};
+
+FORCEINLINE int32x4_t   widen_half( uint16x8_t v, int half ) noexcept
+{
+    return vreinterpretq_s32_u32( vmovl_u16( half == 0 ? vget_low_u16( v ) : vget_high_u16( v ) ) );
+}
+
+FORCEINLINE stokes_4    calc_stokes( const quad_8& q, int half ) noexcept
+{
+    const int32x4_t i0 = widen_half( q.i0, half );
+    const int32x4_t i45 = widen_half( q.i45, half );
+    const int32x4_t i90 = widen_half( q.i90, half );
+    const int32x4_t i135 = widen_half( q.i135, half );
+
+    const int32x4_t sum = vaddq_s32( vaddq_s32( i0, i45 ), vaddq_s32( i90, i135 ) );
+    return stokes_4{
+        sum,
+        vmulq_f32( vcvtq_f32_s32( sum ), vdupq_n_f32( 0.5f ) ),
+        vcvtq_f32_s32( vsubq_s32( i0, i90 ) ),
+        vcvtq_f32_s32( vsubq_s32( i45, i135 ) ),
+    };
+}
+
+FORCEINLINE float32x4_t     calc_aolp( float32x4_t s1, float32x4_t s2 ) noexcept
+{
+    const float32x4_t zero = vdupq_n_f32( 0.f );
+
+    const float32x4_t ax = vabsq_f32( s1 );
+    const float32x4_t ay = vabsq_f32( s2 );
+    const float32x4_t t = vdivq_f32( vminq_f32( ax, ay ), vmaxq_f32( vmaxq_f32( ax, ay ), vdupq_n_f32( FLT_MIN ) ) );
+
+    const float32x4_t t2 = vmulq_f32( t, t );
+    float32x4_t p = vdupq_n_f32( -0.01172120f );
+    p = vaddq_f32( vmulq_f32( p, t2 ), vdupq_n_f32( 0.05265332f ) );
+    p = vsubq_f32( vmulq_f32( p, t2 ), vdupq_n_f32( 0.11643287f ) );
+    p = vaddq_f32( vmulq_f32( p, t2 ), vdupq_n_f32( 0.19354346f ) );
+    p = vsubq_f32( vmulq_f32( p, t2 ), vdupq_n_f32( 0.33262347f ) );
+    p = vaddq_f32( vmulq_f32( p, t2 ), vdupq_n_f32( 0.99997726f ) );
+
+    float32x4_t r = vmulq_f32( p, t );
+    r = vbslq_f32( vcgtq_f32( ay, ax ), vsubq_f32( vdupq_n_f32( pi / 2 ), r ), r );
+    r = vbslq_f32( vcltq_f32( s1, zero ), vsubq_f32( vdupq_n_f32( pi ), r ), r );
+    r = vbslq_f32( vcltq_f32( s2, zero ), vsubq_f32( vdupq_n_f32( 2 * pi ), r ), r );
+    return vmulq_f32( r, vdupq_n_f32( 0.5f ) );
+}
+
+FORCEINLINE float32x4_t     calc_dolp( const stokes_4& st ) noexcept
+{
+    const float32x4_t mag = vsqrtq_f32( vaddq_f32( vmulq_f32( st.s1, st.s1 ), vmulq_f32( st.s2, st.s2 ) ) );
+    const float32x4_t dolp = vdivq_f32( mag, vmaxq_f32( st.s0, vdupq_n_f32( FLT_MIN ) ) );
+    return vminq_f32( dolp, vdupq_n_f32( 1.f ) );
+}
+
+FORCEINLINE int32x4_t   round_to_int( float32x4_t v ) noexcept
+{
+    // vcvtq_s32_f32 truncates like the C variant
+    return vcvtq_s32_f32( vaddq_f32( v, vdupq_n_f32( 0.5f ) ) );
+}
+
+FORCEINLINE float32x4_t     calc_hsv_channel( float n, float32x4_t h6, float32x4_t s, float32x4_t v ) noexcept
+{
+    const float32x4_t six = vdupq_n_f32( 6.f );
+
+    float32x4_t k = vaddq_f32( vdupq_n_f32( n ), h6 );
+    k = vbslq_f32( vcgeq_f32( k, six ), vsubq_f32( k, six ), k );
+    float32x4_t w = vminq_f32( k, vsubq_f32( vdupq_n_f32( 4.f ), k ) );
+    w = vminq_f32( vmaxq_f32( w, vdupq_n_f32( 0.f ) ), vdupq_n_f32( 1.f ) );
+    return vsubq_f32( v, vmulq_f32( vmulq_f32( v, s ), w ) );
+}
+
+FORCEINLINE uint16x8_t  combine_halves( int32x4_t lo, int32x4_t hi ) noexcept
+{
+    return vcombine_u16( vqmovun_s32( lo ), vqmovun_s32( hi ) );
+}
+
+template<class TSrc>
+FORCEINLINE void        store_4( void* dst, uint16x8_t c0, uint16x8_t c1, uint16x8_t c2, uint16x8_t c3 ) noexcept
+{
+    if constexpr( sizeof( TSrc ) == 1 ) {
+        vst4_u8( static_cast<uint8_t*>( dst ), uint8x8x4_t{ { vmovn_u16( c0 ), vmovn_u16( c1 ), vmovn_u16( c2 ), vmovn_u16( c3 ) } } );
+    } else {
+        vst4q_u16( static_cast<uint16_t*>( dst ), uint16x8x4_t{ { c0, c1, c2, c3 } } );
+    }
+}
+
+template<class TSrc, class TDst>
+struct to_packed_neon_op
+{
+    using c_op = to_packed_op<TSrc, TDst>;
+
+    FORCEINLINE void    operator()( TDst* dst, const quad_8& q ) const noexcept
+    {
+        store_4<TSrc>( dst, q.i0, q.i45, q.i90, q.i135 );
+    }
+};
+
+template<class TSrc, class TDst>
+struct to_adi_neon_op
+{
+    using c_op = to_adi_op<TSrc, TDst>;
+
+    FORCEINLINE void    operator()( TDst* dst, const quad_8& q ) const noexcept
+    {
+        int32x4_t aolp[2];
+        int32x4_t dolp[2];
+        int32x4_t intensity[2];
+        for( int half = 0; half < 2; ++half )
+        {
+            const stokes_4 st = calc_stokes( q, half );
+
+            aolp[half] = vminq_s32( round_to_int( vmulq_f32( calc_aolp( st.s1, st.s2 ), vdupq_n_f32( c_op::aolp_scale ) ) ),
+                vdupq_n_s32( max_value<TSrc> ) );
+            dolp[half] = round_to_int( vmulq_f32( calc_dolp( st ), vdupq_n_f32( c_op::max_val ) ) );
+            intensity[half] = vshrq_n_s32( vaddq_s32( st.sum, vdupq_n_s32( 2 ) ), 2 );
+        }
+        store_4<TSrc>( dst,
+            combine_halves( aolp[0], aolp[1] ),
+            combine_halves( dolp[0], dolp[1] ),
+            combine_halves( intensity[0], intensity[1] ),
+            vdupq_n_u16( 0 ) );
+    }
+};
+
+template<class TSrc>
+struct to_bgra32_neon_op
+{
+    using c_op = to_bgra32_op<TSrc>;
+
+    FORCEINLINE void    operator()( BGRA32* dst, const quad_8& q ) const noexcept
+    {
+        int32x4_t b[2];
+        int32x4_t g[2];
+        int32x4_t r[2];
+        for( int half = 0; half < 2; ++half )
+        {
+            const stokes_4 st = calc_stokes( q, half );
+
+            const float32x4_t h6 = vmulq_f32( calc_aolp( st.s1, st.s2 ), vdupq_n_f32( c_op::hue_scale ) );
+            const float32x4_t s = calc_dolp( st );
+            const float32x4_t v = vmulq_f32( vcvtq_f32_s32( st.sum ), vdupq_n_f32( c_op::value_scale ) );
+
+            b[half] = round_to_int( calc_hsv_channel( 1.f, h6, s, v ) );
+            g[half] = round_to_int( calc_hsv_channel( 3.f, h6, s, v ) );
+            r[half] = round_to_int( calc_hsv_channel( 5.f, h6, s, v ) );
+        }
+        vst4_u8( reinterpret_cast<uint8_t*>( dst ), uint8x8x4_t{ {
+            vmovn_u16( combine_halves( b[0], b[1] ) ),
+            vmovn_u16( combine_halves( g[0], g[1] ) ),
+            vmovn_u16( combine_halves( r[0], r[1] ) ),
+            vdup_n_u8( 0xFF ) } } );
+    }
+};
+
+template<class TSrc>
+struct to_stokes_neon_op
+{
+    using c_op = to_stokes_op<TSrc>;
+
+    FORCEINLINE void    operator()( BGRf* dst, const quad_8& q ) const noexcept
+    {
+        const float32x4_t norm = vdupq_n_f32( c_op::norm );
+        for( int half = 0; half < 2; ++half )
+        {
+            const stokes_4 st = calc_stokes( q, half );
+            vst3q_f32( reinterpret_cast<float*>( dst + half * 4 ),
+                float32x4x3_t{ { vmulq_f32( st.s0, norm ), vmulq_f32( st.s1, norm ), vmulq_f32( st.s2, norm ) } } );
+        }
+    }
+};
+
+template<class TSrc, class TOp>
+void transform_polarization_neon( img::img_descriptor dst, img::img_descriptor src )
+{
+    using c_op = typename TOp::c_op;
+
+    const TOp op;
+    const c_op tail_op;
+    for_each_polarization_line<TSrc, typename c_op::dst_type>( dst, src,
+        [&op, &tail_op, dim_x = dst.dim.cx]( auto* dst_line, const TSrc* line0, const TSrc* line1, bool odd_line )
+        {
+            int x = 0;
+            for( ; x + 9 <= dim_x; x += 8 )
+            {
+                op( dst_line + x, read_quad_8( line0, line1, x, odd_line ) );
+            }
+            transform_polarization_line_c( dst_line, line0, line1, x, dim_x, odd_line, tail_op );
+        } );
+}
+
+}
+
+img_filter::transform_function_type     img_filter::transform::polarization::get_transform_polarization_neon( const img::img_type& dst, const img::img_type& src )
+{
+    using namespace img::pixel_type::polarization;
+
+    if( !can_transform_polarization( dst, src ) ) {
+        return nullptr;
+    }
+
+    if( src.fourcc_type() == img::fourcc::POLARIZATION_MONO8_90_45_135_0 )
+    {
+        switch( dst.fourcc_type() )
+        {
+        case img::fourcc::POLARIZATION_PACKED8:     return ::transform_polarization_neon<uint8_t, to_packed_neon_op<uint8_t, POL_PACKED8>>;
+        case img::fourcc::POLARIZATION_ADI_MONO8:   return ::transform_polarization_neon<uint8_t, to_adi_neon_op<uint8_t, ADI_MONO8>>;
+        case img::fourcc::BGRA32:                   return ::transform_polarization_neon<uint8_t, to_bgra32_neon_op<uint8_t>>;
+        case img::fourcc::BGRFloat:                 return ::transform_polarization_neon<uint8_t, to_stokes_neon_op<uint8_t>>;
+        default:
+            return nullptr;
+        }
+    }
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::POLARIZATION_PACKED16:    return ::transform_polarization_neon<uint16_t, to_packed_neon_op<uint16_t, POL_PACKED16_LE>>;
+    case img::fourcc::POLARIZATION_ADI_MONO16:  return ::transform_polarization_neon<uint16_t, to_adi_neon_op<uint16_t, ADI_MONO16_LE>>;
+    case img::fourcc::BGRA32:                   return ::transform_polarization_neon<uint16_t, to_bgra32_neon_op<uint16_t>>;
+    case img::fourcc::BGRFloat:                 return ::transform_polarization_neon<uint16_t, to_stokes_neon_op<uint16_t>>;
+    default:
+        return nullptr;
+    }
+}
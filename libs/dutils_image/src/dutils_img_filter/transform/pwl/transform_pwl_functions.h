@@ -25,9 +25,19 @@ namespace pwl
     transform_function_type      get_transform_pwl_to_fccfloat_ref( const img::img_type& dst, const img::img_type& src );
     transform_function_type      get_transform_pwl_to_fccfloat_c( const img::img_type& dst, const img::img_type& src );
     transform_function_type      get_transform_pwl_to_fccfloat_c_v1( const img::img_type& dst, const img::img_type& src );
-    //transform_function_type      get_transform_pwl_to_bayerfloat_neon( img::img_type dst, img::img_type src );
+    transform_function_type      get_transform_pwl_to_fccfloat_avx2( const img::img_type& dst, const img::img_type& src );
+    transform_function_type      get_transform_pwl_to_fccfloat_neon( const img::img_type& dst, const img::img_type& src );
 
+    /* PWL -> RGGB8/RGGB16 with white balance, using filter_params::whitebalance and filter_params::pwl_transform.
+     * The C fcc8 variant needs filter_params::pwl12_to_fcc8_wb_lut, the SIMD variants evaluate the values without the luts.
+     */
     transform_function_param_type      get_transform_pwl12_to_fcc8_c( const img::img_type& dst, const img::img_type& src );
+    transform_function_param_type      get_transform_pwl12_to_fcc8_avx2( const img::img_type& dst, const img::img_type& src );
+    transform_function_param_type      get_transform_pwl12_to_fcc8_neon( const img::img_type& dst, const img::img_type& src );
+
+    transform_function_param_type      get_transform_pwl12_to_fcc16_c( const img::img_type& dst, const img::img_type& src );
+    transform_function_param_type      get_transform_pwl12_to_fcc16_avx2( const img::img_type& dst, const img::img_type& src );
+    transform_function_param_type      get_transform_pwl12_to_fcc16_neon( const img::img_type& dst, const img::img_type& src );
 
 
 
@@ -50,7 +60,10 @@ namespace pwl
         void    transform_pwl16H12_to_fcc8_c_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params );
     }
 
+    // PWL -> fccfloat with filter_params::whitebalance applied, the values are clipped to 1.f like in apply_wb_byfloat_c
     transform_function_param_type      get_transform_pwl_to_fccfloat_wb_c( const img::img_type& dst, const img::img_type& src );
+    transform_function_param_type      get_transform_pwl_to_fccfloat_wb_avx2( const img::img_type& dst, const img::img_type& src );
+    transform_function_param_type      get_transform_pwl_to_fccfloat_wb_neon( const img::img_type& dst, const img::img_type& src );
 
 
     transform_func_type      get_transform_fccfloat_to_fcc8_c( img::img_type dst, img::img_type src );
@@ -0,0 +1,270 @@
+
+#include "transform_pwl_functions.h"
+#include "transform_pwl_to_bayerfloat_internal.h"
+
+#include "../fcc1x_packed/fcc1x_packed_to_fcc16_internal.h"
+
+#include "../../simd_helper/use_simd_avx2.h"
+
+/*
+ * The PWL values are mapped with _mm256_i32gather_ps from the 4096 entry float lut, which fits into the L1 cache.
+ * Each step converts 16 pixels starting at an even pixel, so one white balance vector covers a whole line.
+ * The rest of a line is done by the C line function.
+ */
+
+namespace
+{
+
+using namespace transform_pwl_internal;
+
+struct pwl12_loader
+{
+    static constexpr int overread = 0;
+
+    static constexpr auto index_func = calc_pwl12_to_fcc12;
+
+    FORCEINLINE static __m256i  load( const void* src_line, int x ) noexcept
+    {
+        const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( static_cast<const uint16_t*>( src_line ) + x ) );
+        // invalid values must not read outside of the lut
+        return _mm256_and_si256( _mm256_cvtepu16_epi32( v ), _mm256_set1_epi32( 0xFFF ) );
+    }
+};
+
+struct pwl16H12_loader
+{
+    static constexpr int overread = 0;
+
+    static constexpr auto index_func = fcc1x_packed_internal::calc_fcc16H12_to_fcc12;
+
+    FORCEINLINE static __m256i  load( const void* src_line, int x ) noexcept
+    {
+        const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( static_cast<const uint16_t*>( src_line ) + x ) );
+        return _mm256_srli_epi32( _mm256_cvtepu16_epi32( v ), 4 );
+    }
+};
+
+struct pwl12_mipi_loader
+{
+    // 8 pixels are 12 bytes, but 16 bytes are read
+    static constexpr int overread = 3;
+
+    static constexpr auto index_func = fcc1x_packed_internal::calc_fcc12_mipi_to_fcc12;
+
+    FORCEINLINE static __m256i  load( const void* src_line, int x ) noexcept
+    {
+        const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( static_cast<const uint8_t*>( src_line ) + (x / 2) * 3 ) );
+
+        // u32[i] = upper 8 bits | (byte holding the lower 4 bits of both pixels) << 8
+        const __m256i scatter = _mm256_setr_epi8(
+            0, 2, -1, -1, 1, 2, -1, -1, 3, 5, -1, -1, 4, 5, -1, -1,
+            6, 8, -1, -1, 7, 8, -1, -1, 9, 11, -1, -1, 10, 11, -1, -1 );
+        const __m256i tmp = _mm256_shuffle_epi8( _mm256_broadcastsi128_si256( v ), scatter );
+
+        const __m256i upper = _mm256_slli_epi32( _mm256_and_si256( tmp, _mm256_set1_epi32( 0xFF ) ), 4 );
+        // even pixels use the low nibble, odd pixels the high nibble
+        const __m256i lower = _mm256_and_si256( _mm256_srlv_epi32( tmp, _mm256_setr_epi32( 8, 12, 8, 12, 8, 12, 8, 12 ) ), _mm256_set1_epi32( 0x0F ) );
+        return _mm256_or_si256( upper, lower );
+    }
+};
+
+// packs 2x8 int32 to 16 uint16 in pixel order
+FORCEINLINE __m256i     pack_to_u16( __m256i v0, __m256i v1 ) noexcept
+{
+    return _mm256_permute4x64_epi64( _mm256_packus_epi32( v0, v1 ), 0xD8 );
+}
+
+struct to_float_op
+{
+    using dst_type = float;
+
+    pwl_to_float_pixel_op pixel_op;
+
+    FORCEINLINE void    store( float* dst, __m256 v0, __m256 v1 ) const noexcept
+    {
+        // min( one, val ) keeps NaNs like the C variant
+        const __m256 one = _mm256_set1_ps( 1.f );
+        _mm256_storeu_ps( dst + 0, _mm256_min_ps( one, v0 ) );
+        _mm256_storeu_ps( dst + 8, _mm256_min_ps( one, v1 ) );
+    }
+};
+
+// the multiplications are done in the same order as transform_RawFloat_to_Raw8_c, so the results match the C variant
+FORCEINLINE __m256i     scale_to_int( __m256 v, __m256 gradient, __m256 max_val ) noexcept
+{
+    const __m256 tmp = _mm256_add_ps( _mm256_mul_ps( _mm256_mul_ps( v, gradient ), max_val ), _mm256_set1_ps( 0.5f ) );
+    // clipping before the conversion, larger values would convert to INT_MIN
+    return _mm256_cvttps_epi32( _mm256_max_ps( _mm256_min_ps( tmp, max_val ), _mm256_setzero_ps() ) );
+}
+
+struct to_fcc8_op
+{
+    using dst_type = uint8_t;
+
+    pwl_to_fcc8_pixel_op pixel_op;
+
+    FORCEINLINE void    store( uint8_t* dst, __m256 v0, __m256 v1 ) const noexcept
+    {
+        const __m256 gradient = _mm256_set1_ps( pixel_op.hdr_gain_params.gradient );
+        const __m256 max_val = _mm256_set1_ps( 255.f );
+
+        const __m256i v = pack_to_u16( scale_to_int( v0, gradient, max_val ), scale_to_int( v1, gradient, max_val ) );
+        const __m128i res = _mm_packus_epi16( _mm256_castsi256_si128( v ), _mm256_extracti128_si256( v, 1 ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst ), res );
+    }
+};
+
+struct to_fcc16_op
+{
+    using dst_type = uint16_t;
+
+    pwl_to_fcc16_pixel_op pixel_op;
+
+    FORCEINLINE void    store( uint16_t* dst, __m256 v0, __m256 v1 ) const noexcept
+    {
+        const __m256 gradient = _mm256_set1_ps( pixel_op.hdr_gain_params.gradient );
+        const __m256 max_val = _mm256_set1_ps( 65535.f );
+
+        const __m256i v = pack_to_u16( scale_to_int( v0, gradient, max_val ), scale_to_int( v1, gradient, max_val ) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst ), v );
+    }
+};
+
+template<class TLoader, class TOp>
+void    transform_pwl_line_avx2( const void* src_line, typename TOp::dst_type* dst_line, int dim_x, float wb_even, float wb_odd, const TOp& op ) noexcept
+{
+    const float* lut = get_lut_for_transform_pwl_to_float();
+
+    const __m256 factors = _mm256_setr_ps( wb_even, wb_odd, wb_even, wb_odd, wb_even, wb_odd, wb_even, wb_odd );
+
+    int x = 0;
+    for( ; x < (dim_x - (15 + TLoader::overread)); x += 16 )
+    {
+        const __m256 v0 = _mm256_i32gather_ps( lut, TLoader::load( src_line, x + 0 ), 4 );
+        const __m256 v1 = _mm256_i32gather_ps( lut, TLoader::load( src_line, x + 8 ), 4 );
+
+        op.store( dst_line + x, _mm256_mul_ps( v0, factors ), _mm256_mul_ps( v1, factors ) );
+    }
+    transform_pwl_wb_line_c<TLoader::index_func>( src_line, dst_line, x, dim_x, wb_even, wb_odd, op.pixel_op );
+}
+
+template<class TLoader, class TOp>
+void    transform_pwl_image_avx2( const img::img_descriptor& dst, const img::img_descriptor& src, const img_filter::bayer_pattern_parameters& wb, const TOp& op ) noexcept
+{
+    for( int y = 0; y < src.dim.cy; ++y )
+    {
+        auto* src_line = img::get_line_start<uint8_t>( src, y );
+        auto* dst_line = img::get_line_start<typename TOp::dst_type>( dst, y );
+
+        if( y % 2 ) {
+            transform_pwl_line_avx2<TLoader>( src_line, dst_line, src.dim.cx, wb.wb_x0y1, wb.wb_x1y1, op );
+        } else {
+            transform_pwl_line_avx2<TLoader>( src_line, dst_line, src.dim.cx, wb.wb_x0y0, wb.wb_x1y0, op );
+        }
+    }
+}
+
+template<class TLoader>
+void    transform_pwl_to_fccfloat_avx2_v0( img::img_descriptor dst, img::img_descriptor src )
+{
+    // a factor of 1.f does not change the lut values, which are < 1.f
+    transform_pwl_image_avx2<TLoader>( dst, src, img_filter::bayer_pattern_parameters{ img::by_transform::by_pattern::RG, img_filter::whitebalance_params{} }, to_float_op{} );
+}
+
+template<class TLoader>
+void    transform_pwl_to_fccfloat_wb_avx2_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+{
+    transform_pwl_image_avx2<TLoader>( dst, src, get_pwl_wb_factors( src.fourcc_type(), params.whitebalance ), to_float_op{} );
+}
+
+template<class TLoader>
+void    transform_pwl_to_fcc8_avx2_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+{
+    const to_fcc8_op op{ { compute_fccfloat_to_fcc8_parameter( params.pwl_transform ) } };
+    transform_pwl_image_avx2<TLoader>( dst, src, get_pwl_wb_factors( src.fourcc_type(), params.whitebalance ), op );
+}
+
+template<class TLoader>
+void    transform_pwl_to_fcc16_avx2_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+{
+    const to_fcc16_op op{ { compute_fccfloat_to_fcc8_parameter( params.pwl_transform ) } };
+    transform_pwl_image_avx2<TLoader>( dst, src, get_pwl_wb_factors( src.fourcc_type(), params.whitebalance ), op );
+}
+
+}
+
+img_filter::transform_function_type  img_filter::transform::pwl::get_transform_pwl_to_fccfloat_avx2( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( transform_pwl_internal::can_transform_pwl_to_fcc32f( dst, src ) )
+    {
+        switch( src.fourcc_type() )
+        {
+        case img::fourcc::PWL_RG12_MIPI:        return transform_pwl_to_fccfloat_avx2_v0<pwl12_mipi_loader>;
+        case img::fourcc::PWL_RG12:             return transform_pwl_to_fccfloat_avx2_v0<pwl12_loader>;
+        case img::fourcc::PWL_RG16H12:          return transform_pwl_to_fccfloat_avx2_v0<pwl16H12_loader>;
+        default:
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+img_filter::transform_function_param_type  img_filter::transform::pwl::get_transform_pwl_to_fccfloat_wb_avx2( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( transform_pwl_internal::can_transform_pwl_to_fcc32f( dst, src ) )
+    {
+        switch( src.fourcc_type() )
+        {
+        case img::fourcc::PWL_RG12_MIPI:        return transform_pwl_to_fccfloat_wb_avx2_v0<pwl12_mipi_loader>;
+        case img::fourcc::PWL_RG12:             return transform_pwl_to_fccfloat_wb_avx2_v0<pwl12_loader>;
+        case img::fourcc::PWL_RG16H12:          return transform_pwl_to_fccfloat_wb_avx2_v0<pwl16H12_loader>;
+        default:
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+img_filter::transform_function_param_type  img_filter::transform::pwl::get_transform_pwl12_to_fcc8_avx2( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( transform_pwl_internal::can_transform_pwl_to_fcc8( dst, src ) )
+    {
+        switch( src.fourcc_type() )
+        {
+        case img::fourcc::PWL_RG12_MIPI:        return transform_pwl_to_fcc8_avx2_v0<pwl12_mipi_loader>;
+        case img::fourcc::PWL_RG12:             return transform_pwl_to_fcc8_avx2_v0<pwl12_loader>;
+        case img::fourcc::PWL_RG16H12:          return transform_pwl_to_fcc8_avx2_v0<pwl16H12_loader>;
+        default:
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+img_filter::transform_function_param_type  img_filter::transform::pwl::get_transform_pwl12_to_fcc16_avx2( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( transform_pwl_internal::can_transform_pwl_to_fcc16( dst, src ) )
+    {
+        switch( src.fourcc_type() )
+        {
+        case img::fourcc::PWL_RG12_MIPI:        return transform_pwl_to_fcc16_avx2_v0<pwl12_mipi_loader>;
+        case img::fourcc::PWL_RG12:             return transform_pwl_to_fcc16_avx2_v0<pwl12_loader>;
+        case img::fourcc::PWL_RG16H12:          return transform_pwl_to_fcc16_avx2_v0<pwl16H12_loader>;
+        default:
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
@@ -39,6 +39,88 @@ namespace
         }
     }
 
+    template<uint16_t (*TIndexFunc)( const void*, int ) noexcept, class TOp>
+    void    transform_pwl_wb_image_c( const img::img_descriptor& dst, const img::img_descriptor& src, const TOp& op, const img_filter::whitebalance_params& wb_params )
+    {
+        const auto wb = transform_pwl_internal::get_pwl_wb_factors( src.fourcc_type(), wb_params );
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            auto* src_line = img::get_line_start<uint8_t>( src, y );
+            auto* dst_line = img::get_line_start<typename TOp::dst_type>( dst, y );
+
+            if( y % 2 ) {
+                transform_pwl_internal::transform_pwl_wb_line_c<TIndexFunc>( src_line, dst_line, 0, src.dim.cx, wb.wb_x0y1, wb.wb_x1y1, op );
+            } else {
+                transform_pwl_internal::transform_pwl_wb_line_c<TIndexFunc>( src_line, dst_line, 0, src.dim.cx, wb.wb_x0y0, wb.wb_x1y0, op );
+            }
+        }
+    }
+
+    template<uint16_t (*TIndexFunc)( const void*, int ) noexcept>
+    void    transform_pwl_to_fcc8_lut_image_c( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+    {
+        assert( params.pwl12_to_fcc8_wb_lut != nullptr );
+
+        auto& data = *params.pwl12_to_fcc8_wb_lut;
+        img_filter::transform::pwl::update_pwl12_to_fcc8_wb_map_data( data, params.pwl_transform, params.whitebalance );
+
+        // all PWL formats are RG
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            auto* src_line = img::get_line_start<uint8_t>( src, y );
+            auto* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+            const uint8_t* lut_even = (y % 2) ? data.lut_gb : data.lut_rr;
+            const uint8_t* lut_odd = (y % 2) ? data.lut_bb : data.lut_gr;
+
+            int x = 0;
+            for( ; x < (src.dim.cx - 1); x += 2 )
+            {
+                dst_line[x + 0] = lut_even[TIndexFunc( src_line, x + 0 )];
+                dst_line[x + 1] = lut_odd[TIndexFunc( src_line, x + 1 )];
+            }
+            if( x == (src.dim.cx - 1) ) {
+                dst_line[x] = lut_even[TIndexFunc( src_line, x )];
+            }
+        }
+    }
+
+    template<uint16_t (*TIndexFunc)( const void*, int ) noexcept>
+    void    transform_pwl_to_fcc16_c_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+    {
+        const transform_pwl_internal::pwl_to_fcc16_pixel_op op{ transform_pwl_internal::compute_fccfloat_to_fcc8_parameter( params.pwl_transform ) };
+        transform_pwl_wb_image_c<TIndexFunc>( dst, src, op, params.whitebalance );
+    }
+}
+
+void    img_filter::transform::pwl::detail::transform_pwl12_to_fccfloat_wb_c_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+{
+    transform_pwl_wb_image_c<transform_pwl_internal::calc_pwl12_to_fcc12>( dst, src, transform_pwl_internal::pwl_to_float_pixel_op{}, params.whitebalance );
+}
+
+void    img_filter::transform::pwl::detail::transform_pwl12_mipi_to_fccfloat_wb_c_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+{
+    transform_pwl_wb_image_c<fcc1x_packed_internal::calc_fcc12_mipi_to_fcc12>( dst, src, transform_pwl_internal::pwl_to_float_pixel_op{}, params.whitebalance );
+}
+
+void    img_filter::transform::pwl::detail::transform_pwl16H12_to_fccfloat_wb_c_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+{
+    transform_pwl_wb_image_c<fcc1x_packed_internal::calc_fcc16H12_to_fcc12>( dst, src, transform_pwl_internal::pwl_to_float_pixel_op{}, params.whitebalance );
+}
+
+void    img_filter::transform::pwl::detail::transform_pwl12_to_fcc8_c_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+{
+    transform_pwl_to_fcc8_lut_image_c<transform_pwl_internal::calc_pwl12_to_fcc12>( dst, src, params );
+}
+
+void    img_filter::transform::pwl::detail::transform_pwl12_mipi_to_fcc8_c_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+{
+    transform_pwl_to_fcc8_lut_image_c<fcc1x_packed_internal::calc_fcc12_mipi_to_fcc12>( dst, src, params );
+}
+
+void    img_filter::transform::pwl::detail::transform_pwl16H12_to_fcc8_c_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+{
+    transform_pwl_to_fcc8_lut_image_c<fcc1x_packed_internal::calc_fcc16H12_to_fcc12>( dst, src, params );
 }
 
 void    img_filter::transform::pwl::detail::transform_pwl12_mipi_to_fccfloat_c_v0( img::img_descriptor dst, img::img_descriptor src )
@@ -122,3 +204,60 @@ img_filter::transform_function_type  img_filter::transform::pwl::get_transform_p
     }
     return nullptr;
 }
+
+img_filter::transform_function_param_type  img_filter::transform::pwl::get_transform_pwl_to_fccfloat_wb_c( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( transform_pwl_internal::can_transform_pwl_to_fcc32f( dst, src ) )
+    {
+        switch( src.fourcc_type() )
+        {
+        case img::fourcc::PWL_RG12_MIPI:        return detail::transform_pwl12_mipi_to_fccfloat_wb_c_v0;
+        case img::fourcc::PWL_RG12:             return detail::transform_pwl12_to_fccfloat_wb_c_v0;
+        case img::fourcc::PWL_RG16H12:          return detail::transform_pwl16H12_to_fccfloat_wb_c_v0;
+        default:
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+img_filter::transform_function_param_type  img_filter::transform::pwl::get_transform_pwl12_to_fcc8_c( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( transform_pwl_internal::can_transform_pwl_to_fcc8( dst, src ) )
+    {
+        switch( src.fourcc_type() )
+        {
+        case img::fourcc::PWL_RG12_MIPI:        return detail::transform_pwl12_mipi_to_fcc8_c_v0;
+        case img::fourcc::PWL_RG12:             return detail::transform_pwl12_to_fcc8_c_v0;
+        case img::fourcc::PWL_RG16H12:          return detail::transform_pwl16H12_to_fcc8_c_v0;
+        default:
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+img_filter::transform_function_param_type  img_filter::transform::pwl::get_transform_pwl12_to_fcc16_c( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( transform_pwl_internal::can_transform_pwl_to_fcc16( dst, src ) )
+    {
+        switch( src.fourcc_type() )
+        {
+        case img::fourcc::PWL_RG12_MIPI:        return transform_pwl_to_fcc16_c_v0<fcc1x_packed_internal::calc_fcc12_mipi_to_fcc12>;
+        case img::fourcc::PWL_RG12:             return transform_pwl_to_fcc16_c_v0<transform_pwl_internal::calc_pwl12_to_fcc12>;
+        case img::fourcc::PWL_RG16H12:          return transform_pwl_to_fcc16_c_v0<fcc1x_packed_internal::calc_fcc16H12_to_fcc12>;
+        default:
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
@@ -40,6 +40,31 @@ namespace
         }
         return lut;
     }
+
+    std::unique_ptr<transform_pwl_internal::pwl_segment[]> create_pwl_segments()
+    {
+        static_assert( std::size( transform_pwl_control_points ) == transform_pwl_internal::pwl_segment_count );
+
+        std::unique_ptr<transform_pwl_internal::pwl_segment[]> segments( new transform_pwl_internal::pwl_segment[transform_pwl_internal::pwl_segment_count] );
+        for( int i = 0; i < transform_pwl_internal::pwl_segment_count; ++i )
+        {
+            const auto& cp = transform_pwl_control_points[i];
+
+            auto& seg = segments[i];
+            seg.y_start = float( cp.y + pedestal_level );
+            if( cp.gain )
+            {
+                seg.slope = float( double( gain1 ) / cp.gain / output_value_range );
+                seg.offset = float( double( cp.x ) / output_value_range );
+            }
+            else
+            {
+                seg.slope = 0.f;
+                seg.offset = float( output_value_range - 1 ) / float( output_value_range );
+            }
+        }
+        return segments;
+    }
 }
 
 uint32_t transform_pwl_internal::transform_pwl_to_int_single_value( int value )
@@ -78,3 +103,9 @@ const float*      transform_pwl_internal::get_lut_for_transform_pwl_to_float()
     static auto lut = create_lut_for_transform_pwl_to_float();
     return lut.get();
 }
+
+const transform_pwl_internal::pwl_segment*    transform_pwl_internal::get_pwl_segments()
+{
+    static auto segments = create_pwl_segments();
+    return segments.get();
+}
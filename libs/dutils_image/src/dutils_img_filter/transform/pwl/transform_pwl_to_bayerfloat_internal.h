@@ -14,6 +14,21 @@ namespace transform_pwl_internal
 
     const float*    get_lut_for_transform_pwl_to_float();
 
+    /** The PWL curve as float segments, for SIMD variants that evaluate the curve instead of using the lut.
+     * For a PWL value v the segment is the last one with y_start <= v, the result is max( offset + (v - y_start) * slope, 0.f ).
+     * The pedestal is already part of y_start.
+     */
+    struct pwl_segment
+    {
+        float y_start;
+        float slope;
+        float offset;
+    };
+
+    constexpr int   pwl_segment_count = 10;
+
+    const pwl_segment*  get_pwl_segments();
+
     constexpr bool can_transform_pwl_to_fcc32f( img::img_type dst, img::img_type src ) noexcept
     {
         return img::by_transform::convert_pwl_to_fcc32f( src.fourcc_type() ) == dst.fourcc_type();
@@ -33,6 +48,16 @@ namespace transform_pwl_internal
         return false;
     }
 
+    constexpr bool can_transform_pwl_to_fcc16( img::img_type dst, img::img_type src ) noexcept
+    {
+        if( src.fourcc_type() == img::fourcc::PWL_RG12_MIPI ||
+            src.fourcc_type() == img::fourcc::PWL_RG12 ||
+            src.fourcc_type() == img::fourcc::PWL_RG16H12 ) {
+            return dst.fourcc_type() == img::fourcc::RGGB16;
+        }
+        return false;
+    }
+
     struct internal_transform_params
     {
         float gradient;
@@ -44,10 +69,89 @@ namespace transform_pwl_internal
         return (uint8_t)CLIP( rval, 0, 255 );
     }
 
+    FORCEINLINE constexpr uint16_t transform_RawFloat_to_Raw16_c(float value, const internal_transform_params& internal_params) noexcept
+    {
+        int rval = (int)(value * internal_params.gradient * 65535.f + 0.5f);
+        return (uint16_t)CLIP( rval, 0, 65535 );
+    }
+
     FORCEINLINE internal_transform_params compute_fccfloat_to_fcc8_parameter(const img::pwl_transform_params& params) noexcept
     {
         const auto gradient = std::pow(10.0f, params.hdr_gain / 20.0f);
 
         return { gradient };
     }
+
+    FORCEINLINE uint16_t    calc_pwl12_to_fcc12( const void* src, int offset ) noexcept
+    {
+        return static_cast<const uint16_t*>( src )[offset];
+    }
+
+    // The pixel operations of the white balanced transforms, the SIMD variants use these for the rest of a line
+    struct pwl_to_float_pixel_op
+    {
+        using dst_type = float;
+
+        FORCEINLINE float operator()( float value, float wb ) const noexcept
+        {
+            const float val = value * wb;
+            return val > 1.f ? 1.f : val;       // same as img_filter::whitebalance::detail::apply_wb_byfloat_c
+        }
+    };
+
+    struct pwl_to_fcc8_pixel_op
+    {
+        using dst_type = uint8_t;
+
+        internal_transform_params hdr_gain_params;
+
+        FORCEINLINE uint8_t operator()( float value, float wb ) const noexcept
+        {
+            return transform_RawFloat_to_Raw8_c( value * wb, hdr_gain_params );
+        }
+    };
+
+    struct pwl_to_fcc16_pixel_op
+    {
+        using dst_type = uint16_t;
+
+        internal_transform_params hdr_gain_params;
+
+        FORCEINLINE uint16_t operator()( float value, float wb ) const noexcept
+        {
+            return transform_RawFloat_to_Raw16_c( value * wb, hdr_gain_params );
+        }
+    };
+
+    /** Transforms the pixels [x_begin;dim_x[ of a line, x_begin must be even.
+     * Even pixels get wb_even, odd pixels wb_odd.
+     */
+    template<uint16_t (*TIndexFunc)( const void*, int ) noexcept, class TOp>
+    FORCEINLINE void    transform_pwl_wb_line_c( const void* src_line, typename TOp::dst_type* dst_line, int x_begin, int dim_x,
+        float wb_even, float wb_odd, const TOp& op ) noexcept
+    {
+        const float* lut = get_lut_for_transform_pwl_to_float();
+
+        int x = x_begin;
+        for( ; x < (dim_x - 1); x += 2 )
+        {
+            const uint16_t v0 = TIndexFunc( src_line, x + 0 );
+            const uint16_t v1 = TIndexFunc( src_line, x + 1 );
+            assert( v0 < 0x1000 && v1 < 0x1000 );
+            dst_line[x + 0] = op( lut[v0], wb_even );
+            dst_line[x + 1] = op( lut[v1], wb_odd );
+        }
+        if( x == (dim_x - 1) )
+        {
+            const uint16_t v0 = TIndexFunc( src_line, x );
+            assert( v0 < 0x1000 );
+            dst_line[x] = op( lut[v0], wb_even );
+        }
+    }
+
+    // The white balance factors for the PWL formats, these are normalized like for the fcc8 luts
+    inline img_filter::bayer_pattern_parameters    get_pwl_wb_factors( img::fourcc src_fcc, const img_filter::whitebalance_params& wb_params ) noexcept
+    {
+        return img_filter::bayer_pattern_parameters( img::by_transform::convert_bayer_fcc_to_pattern( src_fcc ), img_filter::normalize( wb_params ) );
+    }
 }
@@ -0,0 +1,289 @@
+
+#include "transform_pwl_functions.h"
+#include "transform_pwl_to_bayerfloat_internal.h"
+
+#include "../fcc1x_packed/fcc1x_packed_to_fcc16_internal.h"
+
+#include "../../simd_helper/use_simd_A64.h"
+
+/*
+ * NEON has no gather and vtbl/vqtbl cannot index the 4096 entry lut, so the PWL curve is evaluated per pixel.
+ * The segment of each pixel is selected by comparing against the segment starts, see transform_pwl_internal::get_pwl_segments.
+ * The results may differ from the lut in the last bits, because the lut truncates to integer values first.
+ *
+ * Each step converts 16 pixels. The loads and stores de-interleave/interleave the even and odd pixels,
+ * so each white balance factor is applied to a whole register.
+ */
+
+namespace
+{
+
+using namespace transform_pwl_internal;
+
+struct pixels_16
+{
+    uint16x8_t even;
+    uint16x8_t odd;
+};
+
+struct pwl12_loader
+{
+    static constexpr auto index_func = calc_pwl12_to_fcc12;
+
+    FORCEINLINE static pixels_16    load( const void* src_line, int x ) noexcept
+    {
+        const uint16x8x2_t v = vld2q_u16( static_cast<const uint16_t*>( src_line ) + x );
+        return { v.val[0], v.val[1] };
+    }
+};
+
+struct pwl16H12_loader
+{
+    static constexpr auto index_func = fcc1x_packed_internal::calc_fcc16H12_to_fcc12;
+
+    FORCEINLINE static pixels_16    load( const void* src_line, int x ) noexcept
+    {
+        const uint16x8x2_t v = vld2q_u16( static_cast<const uint16_t*>( src_line ) + x );
+        return { vshrq_n_u16( v.val[0], 4 ), vshrq_n_u16( v.val[1], 4 ) };
+    }
+};
+
+struct pwl12_mipi_loader
+{
+    static constexpr auto index_func = fcc1x_packed_internal::calc_fcc12_mipi_to_fcc12;
+
+    FORCEINLINE static pixels_16    load( const void* src_line, int x ) noexcept
+    {
+        // val[0] = upper bits of the even pixels, val[1] = upper bits of the odd pixels, val[2] = the lower bits of both
+        const uint8x8x3_t v = vld3_u8( static_cast<const uint8_t*>( src_line ) + (x / 2) * 3 );
+
+        const uint16x8_t even = vorrq_u16( vshlq_n_u16( vmovl_u8( v.val[0] ), 4 ), vmovl_u8( vand_u8( v.val[2], vdup_n_u8( 0x0F ) ) ) );
+        const uint16x8_t odd = vorrq_u16( vshlq_n_u16( vmovl_u8( v.val[1] ), 4 ), vmovl_u8( vshr_n_u8( v.val[2], 4 ) ) );
+        return { even, odd };
+    }
+};
+
+FORCEINLINE float32x4_t     eval_pwl( uint32x4_t pwl_values, const pwl_segment* segments ) noexcept
+{
+    const float32x4_t v = vcvtq_f32_u32( pwl_values );
+
+    float32x4_t y_start = vdupq_n_f32( segments[0].y_start );
+    float32x4_t slope = vdupq_n_f32( segments[0].slope );
+    float32x4_t offset = vdupq_n_f32( segments[0].offset );
+    for( int i = 1; i < pwl_segment_count; ++i )
+    {
+        const uint32x4_t mask = vcgeq_f32( v, vdupq_n_f32( segments[i].y_start ) );
+        y_start = vbslq_f32( mask, vdupq_n_f32( segments[i].y_start ), y_start );
+        slope = vbslq_f32( mask, vdupq_n_f32( segments[i].slope ), slope );
+        offset = vbslq_f32( mask, vdupq_n_f32( segments[i].offset ), offset );
+    }
+    // values below the pedestal get negative results in segment 0
+    return vmaxq_f32( vmlaq_f32( offset, vsubq_f32( v, y_start ), slope ), vdupq_n_f32( 0.f ) );
+}
+
+// the white balanced values of 16 pixels, [0] are pixel 0,2,4,6, [1] 8,10,12,14
+struct values_16
+{
+    float32x4_t even[2];
+    float32x4_t odd[2];
+};
+
+struct to_float_op
+{
+    using dst_type = float;
+
+    pwl_to_float_pixel_op pixel_op;
+
+    FORCEINLINE void    store( float* dst, const values_16& v ) const noexcept
+    {
+        // min( one, val ) keeps NaNs like the C variant
+        const float32x4_t one = vdupq_n_f32( 1.f );
+        vst2q_f32( dst + 0, float32x4x2_t{ { vminq_f32( one, v.even[0] ), vminq_f32( one, v.odd[0] ) } } );
+        vst2q_f32( dst + 8, float32x4x2_t{ { vminq_f32( one, v.even[1] ), vminq_f32( one, v.odd[1] ) } } );
+    }
+};
+
+FORCEINLINE uint16x8_t      scale_to_u16( const float32x4_t (&v)[2], float32x4_t gradient, float32x4_t max_val ) noexcept
+{
+    const float32x4_t half = vdupq_n_f32( 0.5f );
+    const float32x4_t v0 = vminq_f32( vaddq_f32( vmulq_f32( vmulq_f32( v[0], gradient ), max_val ), half ), max_val );
+    const float32x4_t v1 = vminq_f32( vaddq_f32( vmulq_f32( vmulq_f32( v[1], gradient ), max_val ), half ), max_val );
+    // vcvtq_u32_f32 truncates like the C variant
+    return vcombine_u16( vmovn_u32( vcvtq_u32_f32( v0 ) ), vmovn_u32( vcvtq_u32_f32( v1 ) ) );
+}
+
+struct to_fcc8_op
+{
+    using dst_type = uint8_t;
+
+    pwl_to_fcc8_pixel_op pixel_op;
+
+    FORCEINLINE void    store( uint8_t* dst, const values_16& v ) const noexcept
+    {
+        const float32x4_t gradient = vdupq_n_f32( pixel_op.hdr_gain_params.gradient );
+        const float32x4_t max_val = vdupq_n_f32( 255.f );
+
+        const uint8x8_t even = vmovn_u16( scale_to_u16( v.even, gradient, max_val ) );
+        const uint8x8_t odd = vmovn_u16( scale_to_u16( v.odd, gradient, max_val ) );
+        vst2_u8( dst, uint8x8x2_t{ { even, odd } } );
+    }
+};
+
+struct to_fcc16_op
+{
+    using dst_type = uint16_t;
+
+    pwl_to_fcc16_pixel_op pixel_op;
+
+    FORCEINLINE void    store( uint16_t* dst, const values_16& v ) const noexcept
+    {
+        const float32x4_t gradient = vdupq_n_f32( pixel_op.hdr_gain_params.gradient );
+        const float32x4_t max_val = vdupq_n_f32( 65535.f );
+
+        vst2q_u16( dst, uint16x8x2_t{ { scale_to_u16( v.even, gradient, max_val ), scale_to_u16( v.odd, gradient, max_val ) } } );
+    }
+};
+
+template<class TLoader, class TOp>
+void    transform_pwl_line_neon( const void* src_line, typename TOp::dst_type* dst_line, int dim_x, float wb_even, float wb_odd, const TOp& op ) noexcept
+{
+    const pwl_segment* segments = get_pwl_segments();
+
+    const float32x4_t factor_even = vdupq_n_f32( wb_even );
+    const float32x4_t factor_odd = vdupq_n_f32( wb_odd );
+
+    int x = 0;
+    for( ; x < (dim_x - 15); x += 16 )
+    {
+        const pixels_16 pix = TLoader::load( src_line, x );
+
+        values_16 v;
+        v.even[0] = vmulq_f32( eval_pwl( vmovl_u16( vget_low_u16( pix.even ) ), segments ), factor_even );
+        v.even[1] = vmulq_f32( eval_pwl( vmovl_u16( vget_high_u16( pix.even ) ), segments ), factor_even );
+        v.odd[0] = vmulq_f32( eval_pwl( vmovl_u16( vget_low_u16( pix.odd ) ), segments ), factor_odd );
+        v.odd[1] = vmulq_f32( eval_pwl( vmovl_u16( vget_high_u16( pix.odd ) ), segments ), factor_odd );
+
+        op.store( dst_line + x, v );
+    }
+    transform_pwl_wb_line_c<TLoader::index_func>( src_line, dst_line, x, dim_x, wb_even, wb_odd, op.pixel_op );
+}
+
+template<class TLoader, class TOp>
+void    transform_pwl_image_neon( const img::img_descriptor& dst, const img::img_descriptor& src, const img_filter::bayer_pattern_parameters& wb, const TOp& op ) noexcept
+{
+    for( int y = 0; y < src.dim.cy; ++y )
+    {
+        auto* src_line = img::get_line_start<uint8_t>( src, y );
+        auto* dst_line = img::get_line_start<typename TOp::dst_type>( dst, y );
+
+        if( y % 2 ) {
+            transform_pwl_line_neon<TLoader>( src_line, dst_line, src.dim.cx, wb.wb_x0y1, wb.wb_x1y1, op );
+        } else {
+            transform_pwl_line_neon<TLoader>( src_line, dst_line, src.dim.cx, wb.wb_x0y0, wb.wb_x1y0, op );
+        }
+    }
+}
+
+template<class TLoader>
+void    transform_pwl_to_fccfloat_neon_v0( img::img_descriptor dst, img::img_descriptor src )
+{
+    transform_pwl_image_neon<TLoader>( dst, src, img_filter::bayer_pattern_parameters{ img::by_transform::by_pattern::RG, img_filter::whitebalance_params{} }, to_float_op{} );
+}
+
+template<class TLoader>
+void    transform_pwl_to_fccfloat_wb_neon_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+{
+    transform_pwl_image_neon<TLoader>( dst, src, get_pwl_wb_factors( src.fourcc_type(), params.whitebalance ), to_float_op{} );
+}
+
+template<class TLoader>
+void    transform_pwl_to_fcc8_neon_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+{
+    const to_fcc8_op op{ { compute_fccfloat_to_fcc8_parameter( params.pwl_transform ) } };
+    transform_pwl_image_neon<TLoader>( dst, src, get_pwl_wb_factors( src.fourcc_type(), params.whitebalance ), op );
+}
+
+template<class TLoader>
+void    transform_pwl_to_fcc16_neon_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+{
+    const to_fcc16_op op{ { compute_fccfloat_to_fcc8_parameter( params.pwl_transform ) } };
+    transform_pwl_image_neon<TLoader>( dst, src, get_pwl_wb_factors( src.fourcc_type(), params.whitebalance ), op );
+}
+
+}
+
+img_filter::transform_function_type  img_filter::transform::pwl::get_transform_pwl_to_fccfloat_neon( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( transform_pwl_internal::can_transform_pwl_to_fcc32f( dst, src ) )
+    {
+        switch( src.fourcc_type() )
+        {
+        case img::fourcc::PWL_RG12_MIPI:        return transform_pwl_to_fccfloat_neon_v0<pwl12_mipi_loader>;
+        case img::fourcc::PWL_RG12:             return transform_pwl_to_fccfloat_neon_v0<pwl12_loader>;
+        case img::fourcc::PWL_RG16H12:          return transform_pwl_to_fccfloat_neon_v0<pwl16H12_loader>;
+        default:
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+img_filter::transform_function_param_type  img_filter::transform::pwl::get_transform_pwl_to_fccfloat_wb_neon( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( transform_pwl_internal::can_transform_pwl_to_fcc32f( dst, src ) )
+    {
+        switch( src.fourcc_type() )
+        {
+        case img::fourcc::PWL_RG12_MIPI:        return transform_pwl_to_fccfloat_wb_neon_v0<pwl12_mipi_loader>;
+        case img::fourcc::PWL_RG12:             return transform_pwl_to_fccfloat_wb_neon_v0<pwl12_loader>;
+        case img::fourcc::PWL_RG16H12:          return transform_pwl_to_fccfloat_wb_neon_v0<pwl16H12_loader>;
+        default:
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+img_filter::transform_function_param_type  img_filter::transform::pwl::get_transform_pwl12_to_fcc8_neon( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( transform_pwl_internal::can_transform_pwl_to_fcc8( dst, src ) )
+    {
+        switch( src.fourcc_type() )
+        {
+        case img::fourcc::PWL_RG12_MIPI:        return transform_pwl_to_fcc8_neon_v0<pwl12_mipi_loader>;
+        case img::fourcc::PWL_RG12:             return transform_pwl_to_fcc8_neon_v0<pwl12_loader>;
+        case img::fourcc::PWL_RG16H12:          return transform_pwl_to_fcc8_neon_v0<pwl16H12_loader>;
+        default:
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+img_filter::transform_function_param_type  img_filter::transform::pwl::get_transform_pwl12_to_fcc16_neon( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( transform_pwl_internal::can_transform_pwl_to_fcc16( dst, src ) )
+    {
+        switch( src.fourcc_type() )
+        {
+        case img::fourcc::PWL_RG12_MIPI:        return transform_pwl_to_fcc16_neon_v0<pwl12_mipi_loader>;
+        case img::fourcc::PWL_RG12:             return transform_pwl_to_fcc16_neon_v0<pwl12_loader>;
+        case img::fourcc::PWL_RG16H12:          return transform_pwl_to_fcc16_neon_v0<pwl16H12_loader>;
+        default:
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
@@ -51,6 +51,8 @@ static auto_alg::impl::resulting_brightness		calc_resulting_brightness_params_(
 {
     assert( points.cnt > 0 );
 
+    auto_alg::impl::resulting_brightness rval;
+
     int gt_240_counter = 0;
     int brightness_accu = 0;
     for( int idx = 0; idx < points.cnt; ++idx )
@@ -60,17 +62,22 @@ static auto_alg::impl::resulting_brightness		calc_resulting_brightness_params_(
             ++gt_240_counter;
         }
         brightness_accu += y;
+        rval.histogram.add_u8( y );
     }
 
     float div = 1.f / points.cnt;
 
-    return { brightness_accu / 255.f * div, gt_240_counter * div };
+    rval.brightness = brightness_accu / 255.f * div;
+    rval.factor_y_vgt240 = gt_240_counter * div;
+    return rval;
 }
 
 static auto_alg::impl::resulting_brightness	        calc_resulting_brightness_params_( const auto_alg::impl::image_sampling_points_rgbf& points )
 {
     assert( points.cnt > 0 );
 
+    auto_alg::impl::resulting_brightness rval;
+
     int gt_240_counter = 0;
     float brightness_accu = 0;
     for( int idx = 0; idx < points.cnt; ++idx )
@@ -80,11 +87,14 @@ static auto_alg::impl::resulting_brightness	        calc_resulting_brightness_pa
             ++gt_240_counter;
         }
         brightness_accu += y;
+        rval.histogram.add( y );
     }
 
     float div = 1.f / points.cnt;
 
-    return { brightness_accu * div, gt_240_counter * div };
+    rval.brightness = brightness_accu * div;
+    rval.factor_y_vgt240 = gt_240_counter * div;
+    return rval;
 }
 
 auto_alg::impl::resulting_brightness		auto_alg::impl::calc_resulting_brightness_params( const image_sampling_data& sampling_data )
@@ -109,6 +119,26 @@ auto_alg::impl::resulting_brightness		auto_alg::impl::calc_resulting_brightness_
     }
 }
 
+float   auto_alg::impl::calc_brightness_percentile( const brightness_histogram& histogram, float p ) noexcept
+{
+    if( histogram.cnt <= 0 ) {
+        return -1.f;
+    }
+
+    const float target = CLIP( p, 0.f, 1.f ) * histogram.cnt;
+
+    float accu = 0;
+    for( int i = 0; i < brightness_histogram::bin_count; ++i )
+    {
+        const float bin = static_cast<float>( histogram.bins[i] );
+        if( bin > 0 && accu + bin >= target ) {
+            return (i + (target - accu) / bin) / brightness_histogram::bin_count;
+        }
+        accu += bin;
+    }
+    return 1.f;
+}
+
 void auto_alg::impl::apply_software_params_to_sampling_data( image_sampling_data& sampling_data, const auto_alg::color_matrix_params& clr_mtx, const auto_alg::wb_channel_factors& wb_params )
 {
     DUTIL_PROFILE_FUNCTION();
@@ -42,6 +42,9 @@ namespace auto_alg::impl
     }
 
     resulting_brightness    calc_resulting_brightness_params( const image_sampling_data& sampling_data );
+
+    /** Returns the brightness in [0;1] below which the fraction p of the samples lies, interpolated inside the bin. */
+    float                   calc_brightness_percentile( const brightness_histogram& histogram, float p ) noexcept;
     void                    apply_software_params_to_sampling_data( image_sampling_data& sampling_data, const auto_alg::color_matrix_params& clr_mtx, const auto_alg::wb_channel_factors& wb_params );
     void                    apply_software_clrmtx_to_sampling_data( image_sampling_data& sampling_data, const auto_alg::color_matrix_params& clr_mtx );
     void                    apply_software_wb_to_sampling_data( image_sampling_data& sampling_data, const auto_alg::wb_channel_factors& wb_params );
@@ -6,6 +6,7 @@
 #include "auto_alg.h"
 #include "auto_wb_temperature.h"
 #include "auto_wb_temperature_sensor_data.h"
+#include "image_statistics.h"
 
 #include <cmath>
 #include <cstdlib>
@@ -28,7 +29,7 @@ namespace detail {
     struct auto_pass_state
     {
         auto_pass_state( const auto_alg::timing_params& params )
-            : pwm_iris_controller( 0.4f, 2.0f, 1.0f, 4000 )
+            : pwm_iris_controller( params.pwm_iris_pid.p, params.pwm_iris_pid.i, params.pwm_iris_pid.d, params.pwm_iris_pid.e_sum_limit )
         {
             memset( &image_sampling_points.points_float, 0, sizeof( image_sampling_points.points_float ) );
             reset( params );
@@ -60,6 +61,9 @@ namespace detail {
 
         auto_alg::impl::image_sampling_data image_sampling_points;
 
+        // used by the auto_pass overload that takes the image
+        auto_alg::detail::image_statistics  statistics;
+
 
 		void    reset( auto_alg::timing_params params )
 		{
@@ -75,8 +79,9 @@ namespace detail {
 			auto_ref.current_reference = 128;
 			wb_temperature.one_push_step_count = 0;
 
-			pwm_iris_controller.reset();
+			pwm_iris_controller = auto_alg::detail::pid_controller( params.pwm_iris_pid.p, params.pwm_iris_pid.i, params.pwm_iris_pid.d, params.pwm_iris_pid.e_sum_limit );
 			focus_onepush_provider.reset();
+			focus_onepush_provider.set_settle_time( params.focus_settle_time_us );
 		}
     };
 }
@@ -157,21 +162,42 @@ static int		calc_auto_reference( const auto_alg::auto_pass_params& params, auto_
     return params.exposure_reference.val;
 }
 
+/*
+ * Returns the brightness that is driven to the reference.
+ * For histogram metering this is the percentile, raised when the brightest max_clipped_fraction of the samples would otherwise end up above the highlight level.
+ */
+static float    calc_metered_brightness( const auto_alg::exposure_metering_params& metering, const auto_alg::impl::resulting_brightness& brightness_params, float reference )
+{
+    if( !metering.use_histogram || brightness_params.histogram.cnt <= 0 ) {
+        return brightness_params.brightness;
+    }
+
+    const float highlight_level = 240.f / 255.f;
+
+    const float percentile_brightness = auto_alg::impl::calc_brightness_percentile( brightness_params.histogram, metering.percentile );
+    const float highlight_brightness = auto_alg::impl::calc_brightness_percentile( brightness_params.histogram, 1.f - metering.max_clipped_fraction );
+
+    // clipped samples are at least as bright as the bin, so this stops overexposure at least as fast as needed
+    return std::max( percentile_brightness, highlight_brightness * reference / highlight_level );
+}
+
 static auto_alg::impl::gain_exposure_iris_values		auto_alg_for_brightness_adjust( auto_alg::auto_pass_state& state, 
                                                                                         const auto_alg::auto_pass_params& exp,
                                                                                         const auto_alg::impl::resulting_brightness& brightness_params )
 {
     const int reference = calc_auto_reference( exp, state, brightness_params.factor_y_vgt240 );
+    const float metered_brightness = calc_metered_brightness( exp.metering, brightness_params, reference / 255.f );
     auto_alg::property_cont_iris iris_tmp = exp.iris;
     if( exp.iris.is_pwm_iris )
     {
         iris_tmp.auto_enabled = false;
     }
 
-    auto_alg::impl::gain_exposure_iris_values res = auto_alg::impl::calc_auto_gain_exposure_iris( brightness_params.brightness, reference / 255.f, exp.gain, exp.exposure, iris_tmp );
+    auto_alg::impl::gain_exposure_iris_values res = auto_alg::impl::calc_auto_gain_exposure_iris( metered_brightness, reference / 255.f, exp.gain, exp.exposure, iris_tmp,
+                                                                                                  exp.exposure_step, exp.exposure_model_step );
     if( exp.iris.is_pwm_iris && exp.iris.auto_enabled )
     {
-        float corrected_brightness = brightness_params.brightness * 255;
+        float corrected_brightness = metered_brightness * 255;
 
         // If gain and/or exposure are on auto, reduce the brightness according to how much lower they could go
         if( exp.gain.auto_enabled )
@@ -256,6 +282,16 @@ static auto auto_whitebalance_temperature( auto_alg::auto_pass_state& state,
     return auto_whitebalance_temperature_result{ new_temperature, keep_onepush_running };
 }
 
+// The wb steps jump to the gray-world gains at once. In continuous mode the estimate moves a little with every
+// frame, so the gains are only changed, and for device wb written, when one of them moves by more than this fraction.
+static const constexpr float WB_CONTINUOUS_MIN_CHANGE = 0.02f;
+
+static bool is_significant_wb_change( const auto_alg::wb_channel_factors& cur, const auto_alg::wb_channel_factors& next ) noexcept
+{
+    auto exceeds = []( float a, float b ) { return std::abs( b - a ) > WB_CONTINUOUS_MIN_CHANGE * std::max( a, 1.f ); };
+    return exceeds( cur.r, next.r ) || exceeds( cur.g, next.g ) || exceeds( cur.b, next.b );
+}
+
 static auto_alg::wb_results     exec_auto_whitebalance_steps_on_pixels( auto_alg::auto_pass_state& state,
     const auto_alg::impl::auto_sample_points& points, 
     const auto_alg::whitebalance_values& wb
@@ -291,7 +327,9 @@ static auto_alg::wb_results     exec_auto_whitebalance_steps_on_pixels( auto_alg
         rval.channels = res_rgb;
         if( wb.one_push_enabled ) {
 			rval.one_push_still_running = !done;
-		}
+		} else if( !is_significant_wb_change( wb.channels, res_rgb ) ) {
+            rval.channels = wb.channels;
+        }
         param_changed = rval.channels.r != wb.channels.r || rval.channels.g != wb.channels.g || rval.channels.b != wb.channels.b;
     }
     
@@ -310,6 +348,9 @@ static auto_alg::wb_results     exec_auto_whitebalance_steps_on_pixels_float(
     assert( wb.is_software_whitebalance );   // others currently not implemented
 
     auto [done, res_rgb] = auto_alg::impl::auto_whitebalance_soft( points, wb.channels );
+    if( !wb.one_push_enabled && !is_significant_wb_change( wb.channels, res_rgb ) ) {
+        res_rgb = wb.channels;
+    }
 
     const bool rgb_values_changed = res_rgb.r != wb.channels.r || res_rgb.g != wb.channels.g || res_rgb.b != wb.channels.b;
 
@@ -343,16 +384,17 @@ struct color_img_auto_results
 
 
 static color_img_auto_results     exec_color_image_auto( auto_alg::auto_pass_state& state,
-    const img::img_descriptor& img_data,
+    const auto_alg::image_statistics& stats,
     const auto_alg::auto_pass_params& params
 )
 {
-    // 1. calculate the sampling points
+    // 1. take the sampling points, the following steps modify them
 
     color_img_auto_results rval;
-    if( !auto_alg::impl::auto_sample_by_img( img_data, state.image_sampling_points ) ) {
+    if( !stats.has_sampling_points ) {
         return rval;
     }
+    state.image_sampling_points = stats.sampling_points;
 
     // 2. apply color matrix values to it
     apply_software_clrmtx_to_sampling_data( state.image_sampling_points, params.clr );
@@ -367,7 +409,7 @@ static color_img_auto_results     exec_color_image_auto( auto_alg::auto_pass_sta
         rval.wb_res.channels = params.wb.channels;  // we copy the passed in whitebalance values here for the is_software_whitebalance step
     }
 
-    if( !(need_brightness_calc( params ) || need_hdr_gain_calc( img_data.fourcc_type(), params )) ) {
+    if( !(need_brightness_calc( params ) || need_hdr_gain_calc( stats.fcc, params )) ) {
         return rval;
     }
 
@@ -377,7 +419,7 @@ static color_img_auto_results     exec_color_image_auto( auto_alg::auto_pass_sta
         apply_software_wb_to_sampling_data( state.image_sampling_points, rval.wb_res.channels );
     }
 
-    if( need_hdr_gain_calc( img_data.fourcc_type(), params ) )
+    if( need_hdr_gain_calc( stats.fcc, params ) )
     {
         // if we need to calc pwl window data, we do it here
         assert( state.image_sampling_points.is_float );
@@ -396,6 +438,124 @@ static color_img_auto_results     exec_color_image_auto( auto_alg::auto_pass_sta
     return rval;
 }
 
+static bool overlaps( const img::rect& a, const img::rect& b ) noexcept
+{
+    return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+/*
+ * The brightness of the grid cells that overlap roi, the histogram is the one of the whole image.
+ */
+static auto_alg::impl::resulting_brightness     calc_channel_statistics_brightness( const auto_alg::channel_statistics& channels, const img::rect& roi )
+{
+    using stats_type = auto_alg::channel_statistics;
+    constexpr int grid_size = stats_type::grid_size;
+
+    uint64_t sum_r = 0, sum_g = 0, sum_b = 0;
+    uint64_t cnt = 0, above = 0;
+    for( int row = 0; row < grid_size; ++row )
+    {
+        for( int column = 0; column < grid_size; ++column )
+        {
+            const img::rect cell_rect = {
+                column * channels.dim.cx / grid_size, row * channels.dim.cy / grid_size,
+                (column + 1) * channels.dim.cx / grid_size, (row + 1) * channels.dim.cy / grid_size
+            };
+            if( !roi.is_null() && !overlaps( roi, cell_rect ) ) {
+                continue;
+            }
+
+            const auto& cell = channels.grid[row][column];
+            sum_r += cell.sum[stats_type::r];
+            sum_g += cell.sum[stats_type::g];
+            sum_b += cell.sum[stats_type::b];
+            cnt += cell.count;
+            above += cell.count_above_240;
+        }
+    }
+    if( cnt == 0 ) {
+        return auto_alg::impl::resulting_brightness::invalid();
+    }
+
+    const auto_alg::impl::RGBf mean = { sum_r / (cnt * 255.f), sum_g / (cnt * 255.f), sum_b / (cnt * 255.f) };
+
+    auto_alg::impl::resulting_brightness rval;
+    rval.brightness = auto_alg::impl::calc_brightness_from_clr_avgf( mean );
+    rval.factor_y_vgt240 = above / (float)cnt;
+
+    static_assert( stats_type::histogram_bin_count == auto_alg::impl::brightness_histogram::bin_count );
+    for( int bin = 0; bin < stats_type::histogram_bin_count; ++bin )
+    {
+        rval.histogram.bins[bin] = channels.brightness_histogram[bin];
+        rval.histogram.cnt += channels.brightness_histogram[bin];
+    }
+    return rval;
+}
+
+/*
+ * The whitebalance algorithms get the mean of every grid cell as one sample point.
+ * The channel statistics are taken after the whitebalance was applied, so a software whitebalance is removed again to get
+ * the values the sampling points of the raw image would have.
+ */
+static void     fill_grid_sampling_points( const auto_alg::channel_statistics& channels, const auto_alg::whitebalance_values& wb, auto_alg::impl::auto_sample_points& points )
+{
+    using stats_type = auto_alg::channel_statistics;
+
+    const float div_r = wb.is_software_whitebalance ? std::max( wb.channels.r, 0.01f ) : 1.f;
+    const float div_g = wb.is_software_whitebalance ? std::max( wb.channels.g, 0.01f ) : 1.f;
+    const float div_b = wb.is_software_whitebalance ? std::max( wb.channels.b, 0.01f ) : 1.f;
+
+    static_assert( stats_type::grid_size * stats_type::grid_size <= sizeof( points.samples ) / sizeof( points.samples[0] ) );
+
+    points.cnt = 0;
+    for( int row = 0; row < stats_type::grid_size; ++row )
+    {
+        for( int column = 0; column < stats_type::grid_size; ++column )
+        {
+            const auto& cell = channels.grid[row][column];
+            if( cell.count == 0 ) {
+                continue;
+            }
+
+            const float scale = 1.f / cell.count;
+            auto& sample = points.samples[points.cnt++];
+            sample.rr = (uint8_t)CLIP( std::lround( cell.sum[stats_type::r] * scale / div_r ), 0, 0xFF );
+            sample.gr = (uint8_t)CLIP( std::lround( cell.sum[stats_type::g] * scale / div_g ), 0, 0xFF );
+            sample.bb = (uint8_t)CLIP( std::lround( cell.sum[stats_type::b] * scale / div_b ), 0, 0xFF );
+            sample.gb = sample.gr;
+        }
+    }
+}
+
+/*
+ * Same as exec_color_image_auto for channel statistics.
+ * The brightness is the one with the whitebalance of the image, not with the one calculated here.
+ */
+static color_img_auto_results     exec_channel_statistics_auto( auto_alg::auto_pass_state& state,
+    const auto_alg::image_statistics& stats,
+    const auto_alg::auto_pass_params& params
+)
+{
+    color_img_auto_results rval;
+    if( need_whitebalance_calc( params ) )
+    {
+        state.image_sampling_points.is_float = false;
+        fill_grid_sampling_points( stats.channels, params.wb, state.image_sampling_points.points_int );
+        apply_software_clrmtx_to_sampling_data( state.image_sampling_points, params.clr );
+
+        rval.wb_res = exec_auto_whitebalance_steps_on_pixels( state, state.image_sampling_points, params.wb );
+    }
+    else
+    {
+        rval.wb_res.channels = params.wb.channels;
+    }
+
+    if( need_brightness_calc( params ) ) {
+        rval.brightness_res = calc_channel_statistics_brightness( stats.channels, stats.brightness_roi );
+    }
+    return rval;
+}
+
 static bool is_accepted_mono( img::fourcc fcc ) noexcept
 {
     switch( fcc )
@@ -417,26 +577,34 @@ static bool is_accepted_mono( img::fourcc fcc ) noexcept
 }
 
 static color_img_auto_results     exec_brightness_and_wb_calc( auto_alg::auto_pass_state& state,
-                                                                        const img::img_descriptor& img_data,
+                                                                        const auto_alg::image_statistics& stats,
                                                                         const auto_alg::auto_pass_params& params )
 {
-    if( is_accepted_mono( img_data.fourcc_type() ) )
+    if( stats.has_channel_statistics )
+    {
+        if( need_whitebalance_calc( params ) || need_brightness_calc( params ) ) {
+            return exec_channel_statistics_auto( state, stats, params );
+        }
+        return {};
+    }
+
+    if( is_accepted_mono( stats.fcc ) )
     {
         // Mono-image
         if( need_brightness_calc( params ) ) {
-            return color_img_auto_results{ auto_alg::impl::auto_sample_mono_img( img_data ) };
+            return color_img_auto_results{ stats.mono_brightness };
         }
     }
-    else if( img::is_pwl_fcc( img_data.fourcc_type() ) )
+    else if( img::is_pwl_fcc( stats.fcc ) )
     {
         if( need_whitebalance_calc( params ) || params.hdr_gain.enable_auto_hdr_gain_selection || need_brightness_calc( params ) ) {
-            return exec_color_image_auto( state, img_data, params );
+            return exec_color_image_auto( state, stats, params );
         }
     }
-    else if( auto_alg::impl::can_auto_sample_by_img( img_data.fourcc_type() ) )
+    else if( auto_alg::impl::can_auto_sample_by_img( stats.fcc ) )
     {
         if( need_whitebalance_calc( params ) || need_brightness_calc( params ) ) {
-            return exec_color_image_auto( state, img_data, params );
+            return exec_color_image_auto( state, stats, params );
         }
     }
 
@@ -444,6 +612,11 @@ static color_img_auto_results     exec_brightness_and_wb_calc( auto_alg::auto_pa
     return {};
 }
 
+static bool need_statistics( const img::fourcc fcc, const auto_alg::auto_pass_params& params ) noexcept
+{
+    return need_whitebalance_calc( params ) || need_brightness_calc( params ) || need_hdr_gain_calc( fcc, params );
+}
+
 }
 
 /*
@@ -479,23 +652,174 @@ bool auto_alg::should_prepare_auto_pass_step( auto_pass_state& state, const auto
     return is_auto_pass_run( state, params.time_point, params.frame_number ) || state.focus_onepush_provider.is_auto_alg_run_needed( params.focus_onepush_params );
 }
 
-auto_alg::auto_pass_results	    auto_alg::auto_pass( auto_pass_state& state, const img::img_descriptor& img_data, const auto_pass_params& params )
+void    auto_alg::collect_image_statistics( image_statistics& stats, const img::img_descriptor& img_data, const auto_pass_params& params )
 {
-    auto_pass_results rval = {};
+    DUTIL_PROFILE_FUNCTION();
 
-    if( state.focus_onepush_provider.is_auto_alg_run_needed( params.focus_onepush_params ) )
+    stats.fcc = img_data.fourcc_type();
+    stats.has_sampling_points = false;
+    stats.has_channel_statistics = false;
+    stats.mono_brightness = auto_alg::impl::resulting_brightness::invalid();
+    stats.exposure_in_flight = params.exposure_in_flight;
+
+    if( img_data.empty() || params.exposure_in_flight ) {
+        return;
+    }
+
+    img::img_descriptor img_data_roi = img_data;
+
+    img::rect brightness_roi = img::clip_to_img_desc_region( params.brightness_roi, params.sensor_offset, params.pixel_dim, img_data );
+    if( !brightness_roi.is_null() )
+    {
+        img_data_roi = img::make_safe_img_view( img_data, brightness_roi );
+    }
+
+    if( is_accepted_mono( stats.fcc ) )
+    {
+        stats.mono_brightness = auto_alg::impl::auto_sample_mono_img( img_data_roi );
+    }
+    else if( img::is_pwl_fcc( stats.fcc ) || auto_alg::impl::can_auto_sample_by_img( stats.fcc ) )
     {
-        rval.focus_value = params.focus_onepush_params.device_focus_val;
+        stats.has_sampling_points = auto_alg::impl::auto_sample_by_img( img_data_roi, stats.sampling_points );
+    }
+}
 
-        state.focus_onepush_provider.auto_alg_run( params.time_point, img_data, params.focus_onepush_params, params.sensor_offset, params.pixel_dim, rval.focus_value );
+void    auto_alg::collect_image_statistics( image_statistics& stats, const channel_statistics& channels, const auto_pass_params& params )
+{
+    stats.fcc = img::fourcc::BGRA32;
+    stats.has_sampling_points = false;
+    stats.has_channel_statistics = false;
+    stats.mono_brightness = auto_alg::impl::resulting_brightness::invalid();
+    stats.exposure_in_flight = params.exposure_in_flight;
 
-        rval.focus_onepush_still_running = state.focus_onepush_provider.is_running();
-        rval.focus_changed = rval.focus_value != params.focus_onepush_params.device_focus_val;
+    if( channels.empty() || params.exposure_in_flight ) {
+        return;
     }
 
+    stats.channels = channels;
+    stats.brightness_roi = img::clip_to_img_desc_region( params.brightness_roi, params.sensor_offset, params.pixel_dim, channels.dim );
+    stats.has_channel_statistics = true;
+}
+
+static void fill_channel_means( const auto_alg::impl::image_sampling_data& data, auto_alg::scene_statistics& result )
+{
+    float r = 0.f, g = 0.f, b = 0.f;
+    int cnt = 0;
+    if( data.is_float )
+    {
+        cnt = data.points_float.cnt;
+        for( int idx = 0; idx < cnt; ++idx )
+        {
+            const auto& s = data.points_float.samples[idx];
+            r += s.r;
+            g += s.g;
+            b += s.b;
+        }
+    }
+    else
+    {
+        cnt = data.points_int.cnt;
+        for( int idx = 0; idx < cnt; ++idx )
+        {
+            const auto& s = data.points_int.samples[idx];
+            r += s.rr;
+            g += (s.gr + s.gb) * 0.5f;
+            b += s.bb;
+        }
+        r /= 255.f;
+        g /= 255.f;
+        b /= 255.f;
+    }
+
+    const float div = 1.f / cnt;
+    result.mean_r = r * div;
+    result.mean_g = g * div;
+    result.mean_b = b * div;
+}
+
+bool    auto_alg::get_scene_statistics( const image_statistics& stats, scene_statistics& result )
+{
+    result = {};
+
+    auto_alg::impl::resulting_brightness brightness = stats.mono_brightness;
+    if( stats.has_sampling_points )
+    {
+        brightness = auto_alg::impl::calc_resulting_brightness_params( stats.sampling_points );
+    }
+    else if( stats.has_channel_statistics )
+    {
+        brightness = calc_channel_statistics_brightness( stats.channels, {} );
+    }
+    if( brightness.brightness < 0 || brightness.histogram.cnt <= 0 ) {
+        return false;
+    }
+
+    result.sample_count = brightness.histogram.cnt;
+    result.brightness = brightness.brightness;
+    result.clipped_fraction = brightness.factor_y_vgt240;
+    static_assert( sizeof( result.histogram ) == sizeof( brightness.histogram.bins ) );
+    memcpy( result.histogram, brightness.histogram.bins, sizeof( result.histogram ) );
+
+    if( stats.has_sampling_points )
+    {
+        fill_channel_means( stats.sampling_points, result );
+    }
+    else if( stats.has_channel_statistics )
+    {
+        const auto& channels = stats.channels;
+        uint64_t sum[3] = {};
+        for( const auto& grid_row : channels.grid ) {
+            for( const auto& cell : grid_row ) {
+                for( int c = 0; c < 3; ++c ) {
+                    sum[c] += cell.sum[c];
+                }
+            }
+        }
+        const float div = 1.f / (channels.pixel_count * 255.f);
+        result.mean_r = sum[auto_alg::channel_statistics::r] * div;
+        result.mean_g = sum[auto_alg::channel_statistics::g] * div;
+        result.mean_b = sum[auto_alg::channel_statistics::b] * div;
+    }
+    else
+    {
+        result.mean_r = result.mean_g = result.mean_b = result.brightness;
+    }
+    return true;
+}
+
+int     auto_alg::calc_image_sharpness( const img::img_descriptor& data, int decimation )
+{
+    DUTIL_PROFILE_FUNCTION();
+
+    return auto_alg::impl::calc_image_sharpness( data, decimation );
+}
+
+static bool run_focus_step( auto_alg::auto_pass_state& state, const img::img_descriptor& img_data, const auto_alg::auto_pass_params& params, auto_alg::auto_pass_results& rval )
+{
+    if( !state.focus_onepush_provider.is_auto_alg_run_needed( params.focus_onepush_params ) ) {
+        return false;
+    }
+    if( img_data.empty() ) {
+        return false;
+    }
+
+    rval.focus_value = params.focus_onepush_params.device_focus_val;
+
+    state.focus_onepush_provider.auto_alg_run( params.time_point, img_data, params.focus_onepush_params, params.sensor_offset, params.pixel_dim, rval.focus_value );
+
+    rval.focus_onepush_still_running = state.focus_onepush_provider.is_running();
+    rval.focus_changed = rval.focus_value != params.focus_onepush_params.device_focus_val;
+    return true;
+}
+
+/*
+ * Returns false when the brightness and whitebalance steps are skipped for this frame.
+ */
+static bool prepare_statistics_pass( auto_alg::auto_pass_state& state, const img::fourcc fcc, const auto_alg::auto_pass_params& params )
+{
     if( state.frame_number_ != params.frame_number ) {
         if( !is_auto_pass_run( state, params.time_point, params.frame_number ) ) {
-            return rval;
+            return false;
         }
     }
 
@@ -503,25 +827,15 @@ auto_alg::auto_pass_results	    auto_alg::auto_pass( auto_pass_state& state, con
     state.last_frame_time_ = params.time_point;
     state.last_frame_number_ = params.frame_number;
 
-    const bool need_brightness_calculations = need_brightness_calc( params );
-    const bool need_whitebalance_calculations = need_whitebalance_calc( params );
-
-    if( !need_whitebalance_calculations && !need_brightness_calculations && !need_hdr_gain_calc( img_data.fourcc_type(), params ) ) {
-        return rval;
-    }
+    return need_statistics( fcc, params );
+}
 
+static void run_statistics_pass( auto_alg::auto_pass_state& state, const auto_alg::image_statistics& stats, const auto_alg::auto_pass_params& params, auto_alg::auto_pass_results& rval )
+{
     DUTIL_PROFILE_SECTION( "auto_alg::auto_pass running auto-stuff" );
 
-    img::img_descriptor img_data_roi = img_data;
-
-    img::rect brightness_roi = img::clip_to_img_desc_region( params.brightness_roi, params.sensor_offset, params.pixel_dim, img_data );
-    if( !brightness_roi.is_null() )
-    {
-        img_data_roi = img::make_safe_img_view( img_data, brightness_roi );
-    }
-
     // This assigns rval.wb if needed and calculates brightness as needed
-    const auto results = exec_brightness_and_wb_calc( state, img_data_roi, params );
+    const auto results = exec_brightness_and_wb_calc( state, stats, params );
     rval.wb = results.wb_res;
     if( results.pwl_res.value_changed ) {
         rval.hdr_gain_selection_changed = true;
@@ -529,7 +843,7 @@ auto_alg::auto_pass_results	    auto_alg::auto_pass( auto_pass_state& state, con
     }
 
     if( results.brightness_res.brightness < 0.f ) { // we can quit here if brightness is not needed
-        return rval;
+        return;
     }
 
     rval.image_brightness = results.brightness_res.brightness;
@@ -547,6 +861,45 @@ auto_alg::auto_pass_results	    auto_alg::auto_pass( auto_pass_state& state, con
 		rval.iris_changed = true;
 		rval.iris_value = res.iris;
 	}
+}
+
+auto_alg::auto_pass_results	    auto_alg::auto_pass( auto_pass_state& state, const img::img_descriptor& img_data, const auto_pass_params& params )
+{
+    auto_pass_results rval = {};
+
+    run_focus_step( state, img_data, params, rval );
+
+    // this does not count as a run, so the next image that shows the new values is evaluated right away
+    if( params.exposure_in_flight ) {
+        return rval;
+    }
+
+    if( !prepare_statistics_pass( state, img_data.fourcc_type(), params ) ) {
+        return rval;
+    }
+
+    // only sample when the statistics are actually used
+    collect_image_statistics( state.statistics, img_data, params );
+
+    run_statistics_pass( state, state.statistics, params, rval );
+    return rval;
+}
+
+auto_alg::auto_pass_results	    auto_alg::auto_pass( auto_pass_state& state, const image_statistics& stats, const img::img_descriptor& focus_img, const auto_pass_params& params )
+{
+    auto_pass_results rval = {};
+
+    run_focus_step( state, focus_img, params, rval );
+
+    if( stats.exposure_in_flight ) {
+        return rval;
+    }
+
+    if( !prepare_statistics_pass( state, stats.fcc, params ) ) {
+        return rval;
+    }
+
+    run_statistics_pass( state, stats, params, rval );
     return rval;
 }
 
@@ -575,3 +928,13 @@ void auto_alg::deallocate_auto_pass_state( auto_pass_state* context )
     delete context;
 }
 
+auto_alg::image_statistics* auto_alg::allocate_image_statistics()
+{
+    return new auto_alg::detail::image_statistics();
+}
+
+void auto_alg::deallocate_image_statistics( image_statistics* stats )
+{
+    delete stats;
+}
+
@@ -18,9 +18,26 @@ static float calc_dist( float reference_val, float brightness_ref ) noexcept
     return reference_val / div;
 }
 
-static unsigned int calc_exposure( float dist, int exposure, const auto_alg::property_cont_exposure& range )
+// limits a single model step, because brightness is not proportional for clipped or very dark images
+static float clip_model_step( float dist, const auto_alg::exposure_step_params& step ) noexcept
 {
-    dist = ( dist + 2.f ) / 3;
+    const float max_step = std::max( step.max_model_step, 1.f );
+    return CLIP( dist, 1.f / max_step, max_step );
+}
+
+static float dampen_step( float dist, const auto_alg::exposure_step_params& step ) noexcept
+{
+    const float damping = std::max( step.damping, 0.f );
+    return (dist + damping) / (damping + 1.f);
+}
+
+static unsigned int calc_exposure( float dist, int exposure, const auto_alg::property_cont_exposure& range, const auto_alg::exposure_step_params& step, bool model_step )
+{
+    if( model_step ) {
+        dist = clip_model_step( dist, step );
+    } else {
+        dist = dampen_step( dist, step );
+    }
     exposure = static_cast<int>( exposure * dist );
 
     // If we do not do a significant change (on the sensor-scale), don't change anything
@@ -32,10 +49,12 @@ static unsigned int calc_exposure( float dist, int exposure, const auto_alg::pro
     return CLIP( exposure, range.min, range.max );
 }
 
-static float calc_gain_db( float dist, float gain, const auto_alg::property_cont_gain& range )
+static float calc_gain_db( float dist, float gain, const auto_alg::property_cont_gain& range, const auto_alg::exposure_step_params& step, bool model_step )
 {
-    if( dist >= 1.f ) {	// when we have to reduce, we reduce it faster
-        dist = (dist + 2.f) / 3.f;	// this dampens the change in dist factor
+    if( model_step ) {
+        dist = clip_model_step( dist, step );
+    } else if( dist >= 1.f ) {	// when we have to reduce, we reduce it faster
+        dist = dampen_step( dist, step );
     }
 
     float val = log2f( dist ) * range.gain_db_multiplier;
@@ -45,10 +64,12 @@ static float calc_gain_db( float dist, float gain, const auto_alg::property_cont
 }
 
 // This gets used for DFK 72 and stuff where gain is used as a multiplier
-static float calc_gain_multiplier( float dist, float gain, const auto_alg::property_cont_gain& range )
+static float calc_gain_multiplier( float dist, float gain, const auto_alg::property_cont_gain& range, const auto_alg::exposure_step_params& step, bool model_step )
 {
-    if( dist >= 1.f ) {	// when we have to reduce, we reduce it faster
-        dist = (dist + 2.f) / 3.f;	// this dampens the change in dist factor
+    if( model_step ) {
+        dist = clip_model_step( dist, step );
+    } else if( dist >= 1.f ) {	// when we have to reduce, we reduce it faster
+        dist = dampen_step( dist, step );
     }
 
     if( gain == 0 ) {
@@ -59,12 +80,12 @@ static float calc_gain_multiplier( float dist, float gain, const auto_alg::prope
     return CLIP( gain, range.min, range.max );
 }
 
-static float calc_gain( float dist, float gain, const auto_alg::property_cont_gain& range )
+static float calc_gain( float dist, float gain, const auto_alg::property_cont_gain& range, const auto_alg::exposure_step_params& step, bool model_step )
 {
     if( range.is_gain_db ) {
-        return calc_gain_db( dist, gain, range );
+        return calc_gain_db( dist, gain, range, step, model_step );
     } else {
-        return calc_gain_multiplier( dist, gain, range );
+        return calc_gain_multiplier( dist, gain, range, step, model_step );
     }
 }
 
@@ -86,7 +107,7 @@ auto_alg::impl::gain_exposure_iris_values		auto_alg::impl::calc_auto_gain_exposu
     float brightness, float reference_value, 
     const auto_alg::property_cont_gain& gain_desc,
     const auto_alg::property_cont_exposure& exposure_desc, 
-    const auto_alg::property_cont_iris& iris_desc )
+    const auto_alg::property_cont_iris& iris_desc, const auto_alg::exposure_step_params& step, bool model_step )
 {
     auto_alg::impl::gain_exposure_iris_values rval = {};
     if( exposure_desc.auto_enabled ) {
@@ -118,7 +139,7 @@ auto_alg::impl::gain_exposure_iris_values		auto_alg::impl::calc_auto_gain_exposu
         if( gain_desc.auto_enabled )
         {
             // reduce gain, if possible
-            tmp_gain = calc_gain( dist, gain, gain_desc );
+            tmp_gain = calc_gain( dist, gain, gain_desc, step, model_step );
             if( tmp_gain < gain )
             {
                 rval.gain = tmp_gain;
@@ -142,7 +163,7 @@ auto_alg::impl::gain_exposure_iris_values		auto_alg::impl::calc_auto_gain_exposu
         if( exposure_desc.auto_enabled )
         {
             // exposure
-            tmp_exposure = calc_exposure( dist, exposure, exposure_desc );
+            tmp_exposure = calc_exposure( dist, exposure, exposure_desc, step, model_step );
             if( tmp_exposure != exposure )
             {
                 rval.exposure = tmp_exposure;
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <dutils_img_pipe/auto_alg_params.h>
+#include <dutils_img_pipe/auto_alg_pass.h>
 #include "pid_controller.h"
 
 namespace auto_alg::impl
@@ -13,7 +14,11 @@ namespace auto_alg::impl
 		int		iris;
 	};
 
+	/* With model_step, the image brightness is expected to be proportional to exposure and gain and the step is not dampened.
+	 * This is only stable when brightness is measured on images that were taken with the current values.
+	 */
 	gain_exposure_iris_values	calc_auto_gain_exposure_iris( float brightness, float reference_value, const auto_alg::property_cont_gain& gain_desc, 
-									const auto_alg::property_cont_exposure& exposure_desc, const auto_alg::property_cont_iris& iris_desc );
+									const auto_alg::property_cont_exposure& exposure_desc, const auto_alg::property_cont_iris& iris_desc,
+									const auto_alg::exposure_step_params& step = {}, bool model_step = false );
 	int							calc_auto_pwm_iris( float corrected_brightness, int reference_value, const auto_alg::property_cont_iris& iris_desc, detail::pid_controller& iris_controller );
 }
@@ -4,13 +4,17 @@
 
 
 #include <algorithm>
+#include <vector>
 
 #include "../../dutils_img_base/img_rect_tools.h"
+#include "auto_focus_contrast.h"
 
 namespace
 {
     using std::max;
 
+    namespace focus = auto_alg::impl::focus;
+
 const int REGION_SIZE = 128;
 const int SWEEP_SHARPNESS_THRESHOLD = 300;
 
@@ -58,86 +62,110 @@ static int		CalcRegionCenterDistance( const img::img_descriptor& image, const Re
     return sqrt_(ndx * ndx + ndy * ndy);
 }
 
-template<class TDataType>
-inline TDataType*	get_ptr_at( void* region_base, int x, int y, int stride )
+// Largest contrast between the neighboring 8x4 blocks (block_sums[k] + block_sums[k+1]) and (block_sums[k+2] + block_sums[k+3])
+static int  get_max_block_contrast( const int* block_sums, int step_count )
 {
-    return ((TDataType*)(((uint8_t*)region_base) + y * stride)) + x;
+    int max_contrast = 0;
+    for( int k = 0; k < step_count; ++k )
+    {
+        int a = (block_sums[k] + block_sums[k + 1]) / 16;
+        int b = (block_sums[k + 2] + block_sums[k + 3]) / 16;
+
+        int contrast = abs_(a-b);
+        max_contrast = max(contrast, max_contrast);
+    }
+    return max_contrast;
 }
 
-template<typename TChannelType>
-static int autofocus_get_contrast_( const img::img_descriptor& image, const RegionInfo& region )
+// Number of block comparisons at every 4th pixel with (x+16) < length
+static int  get_contrast_step_count( int length )
+{
+    return length > 16 ? (length - 16 + 3) / 4 : 0;
+}
+
+/*
+ * Sums up the largest contrast of LINE_COUNT horizontal and vertical lines in the region.
+ * The contrast of a line is measured between neighboring 8x4 blocks at every 4th pixel, see auto_focus_contrast.h.
+ *
+ * With decimation > 1, the region is measured as if it was scaled down by this factor, by only reading every decimation-th
+ * pixel and line. The values are only comparable to values measured with the same decimation.
+ */
+template<typename TChannelType, typename TBlockSumFunc>
+static int autofocus_get_contrast_( const img::img_descriptor& image, const RegionInfo& region, TBlockSumFunc block_sum, int decimation )
 {
     const int LINE_COUNT = 7;
 
-    void* region_start = img::get_line_start<TChannelType>( image, region.y ) + region.x;
-    int stride = image.pitch();
+    const TChannelType* region_start = img::get_line_start<TChannelType>( image, region.y ) + region.x;
+    const int stride = image.pitch() * decimation;
 
-    int step_y = region.height / (LINE_COUNT + 1) + 1;
-    int step_x = region.width / (LINE_COUNT + 1) + 1;
+    const int width = region.width / decimation;
+    const int height = region.height / decimation;
 
-    int sharpness = 0;
-    for( int y = step_y; (y+4) < region.height; y += step_y )
-    {
-        int max_contrast = 0;
+    int step_y = height / (LINE_COUNT + 1) + 1;
+    int step_x = width / (LINE_COUNT + 1) + 1;
 
-        for( int x = 0; (x+16) < region.width; x += 4 )
-        {
-            int a = 0;
-            for( int i = 0; i < 8; ++i )
-                for( int j = 0; j < 4; ++j )
-                    a += *get_ptr_at<TChannelType>( region_start, x + i, y + j, stride );
+    thread_local std::vector<int> block_sums;
 
-            a /= 16;
+    int sharpness = 0;
 
-            int b = 0;
-            for( int i = 8; i < 16; ++i )
-                for( int j = 0; j< 4;++j )
-                    b += *get_ptr_at<TChannelType>( region_start, x + i, y + j, stride );
+    const int h_step_count = get_contrast_step_count( width );
+    if( h_step_count > 0 )
+    {
+        block_sums.resize( h_step_count + 3 );
 
-            b /= 16;
+        for( int y = step_y; (y+4) < height; y += step_y )
+        {
+            const TChannelType* line = focus::line_offset( region_start, y, stride );
+            if( decimation == 1 ) {
+                block_sum( line, stride, h_step_count + 3, block_sums.data() );
+            } else {
+                focus::block_sum_c( line, stride, h_step_count + 3, block_sums.data(), decimation );
+            }
 
-            int contrast = abs_(a-b);
-            max_contrast = max(contrast, max_contrast);
+            sharpness += get_max_block_contrast( block_sums.data(), h_step_count );
         }
-        sharpness += max_contrast;
     }
-    for( int x = step_x; (x+4) < region.width; x += step_x )
-    {
-        int max_contrast = 0;
-
-        for( int y = 0; (y+16) < region.height; y += 4 )
-        {
-            int a = 0;
-            for( int i = 0; i < 8; ++i )
-                for( int j = 0; j< 4;++j )
-                    a += *get_ptr_at<TChannelType>( region_start, x + j, y + i, stride );
 
-            a /= 16;
+    const int v_step_count = get_contrast_step_count( height );
+    if( v_step_count > 0 )
+    {
+        int columns[LINE_COUNT + 1] = {};
+        int column_count = 0;
+        for( int x = step_x; (x+4) < width; x += step_x ) {
+            columns[column_count++] = x * decimation;
+        }
 
-            int b = 0;
-            for( int i = 8; i < 16; ++i )
-                for( int j = 0; j< 4;++j )
-                    b += *get_ptr_at<TChannelType>( region_start, x + j, y + i, stride );
+        // walk the lines once for all columns, block_sums holds the blocks of each column one after another
+        const int block_count = v_step_count + 3;
+        block_sums.assign( column_count * block_count, 0 );
 
-            b /= 16;
+        const int d = decimation;
+        for( int y = 0; y < block_count * 4; ++y )
+        {
+            const TChannelType* line = focus::line_offset( region_start, y, stride );
+            for( int c = 0; c < column_count; ++c )
+            {
+                const TChannelType* p = line + columns[c];
+                block_sums[c * block_count + y / 4] += p[0] + p[d] + p[2 * d] + p[3 * d];
+            }
+        }
 
-            int contrast = abs_(a-b);
-            max_contrast = max(contrast, max_contrast);
+        for( int c = 0; c < column_count; ++c ) {
+            sharpness += get_max_block_contrast( block_sums.data() + c * block_count, v_step_count );
         }
-        sharpness += max_contrast;
     }
     return sharpness;
 }
 
-static int autofocus_get_contrast( const img::img_descriptor& image, const RegionInfo& region )
+static int autofocus_get_contrast( const img::img_descriptor& image, const RegionInfo& region, int decimation = 1 )
 {
     if( image.fourcc_type() == img::fourcc::MONO16 || img::is_by16_fcc( image.fourcc_type() ) )
     {
-        return autofocus_get_contrast_<uint16_t>( image, region );
+        return autofocus_get_contrast_<uint16_t>( image, region, focus::get_block_sum_u16_func(), decimation );
     }
     else
     {
-        return autofocus_get_contrast_<uint8_t>( image, region );
+        return autofocus_get_contrast_<uint8_t>( image, region, focus::get_block_sum_u8_func(), decimation );
     }
 }
 
@@ -236,9 +264,9 @@ static void	autofocus_find_region( const img::img_descriptor& image, RegionInfo&
     delete[] regions;
 }
 
-static int autofocus_get_sharpness( const img::img_descriptor& image, const RegionInfo& region )
+static int autofocus_get_sharpness( const img::img_descriptor& image, const RegionInfo& region, int decimation = 1 )
 {
-    return autofocus_get_contrast( image, region );
+    return autofocus_get_contrast( image, region, decimation );
 }
 
 static bool is_user_roi_valid( const img::img_descriptor& image, const img::rect& r )
@@ -282,6 +310,7 @@ void auto_alg::impl::auto_focus::setup_run( int focus_val, const auto_alg::auto_
     min_time_to_wait_for_focus_change_ = 300;
     auto_step_divisor_ = params.auto_step_divisor;
     sweep_suggested_ = params.suggest_sweep;
+    predictive_search_ = params.predictive_search;
 
     data.focus_val = focus_val;
 
@@ -319,6 +348,22 @@ bool auto_alg::impl::supports_auto_focus( const img::img_type& img ) noexcept
 }
 
 
+int auto_alg::impl::calc_image_sharpness( const img::img_descriptor& image, int decimation ) noexcept
+{
+    const auto fcc = image.fourcc_type();
+    if( fcc != img::fourcc::MONO8 && fcc != img::fourcc::MONO16 && !img::is_by8_fcc( fcc ) && !img::is_by16_fcc( fcc ) ) {
+        return -1;
+    }
+    if( image.dim.cx < 64 || image.dim.cy < 64 ) {
+        return -1;
+    }
+
+    decimation = max( decimation, 1 );
+    const RegionInfo region = { 0, 0, image.dim.cx, image.dim.cy, 0, 0 };
+    return autofocus_get_contrast( image, region, decimation );
+}
+
+
 bool auto_alg::impl::auto_focus::is_auto_alg_run_needed( const auto_alg::auto_focus_params& params ) const noexcept
 {
     if( !params.enable_focus ) {
@@ -412,7 +457,16 @@ void	debug_out( char* format, ... )
 bool	auto_alg::impl::auto_focus::analyze_frame( uint64_t now, const img::img_descriptor& img, int& new_focus_val )
 {
     bool rearm_timer = false;
-    if( data.state == data_holder::init )
+    if( data.state == data_holder::init && predictive_search_ )
+    {
+        RegionInfo info;
+        find_region( img, user_roi_, info );
+        restart_roi( info );
+
+        start_predictive_search( new_focus_val );
+        rearm_timer = data.state != data_holder::ended;
+    }
+    else if( data.state == data_holder::init )
     {
         RegionInfo info;
         find_region( img, user_roi_, info );
@@ -464,6 +518,10 @@ bool	auto_alg::impl::auto_focus::analyze_frame( uint64_t now, const img::img_des
 
 bool	auto_alg::impl::auto_focus::analyze_frame_( const img::img_descriptor& img, int& new_focus_val )
 {
+    if( data.state == data_holder::coarse_scan || data.state == data_holder::fine_scan ) {
+        return analyze_frame_predictive( img, new_focus_val );
+    }
+
     data.stepCount += 1;
     if( (data.stepCount == 4 || data.stepCount == 8) )
     {
@@ -588,6 +646,207 @@ bool	auto_alg::impl::auto_focus::analyze_frame_( const img::img_descriptor& img,
     return false;
 }
 
+namespace
+{
+    // Vertex of the parabola through the 3 samples, which are sorted by focus. Falls back to the center sample when the samples do
+    // not form a peak.
+    template<class TSample>
+    int     interpolate_peak( const TSample& s0, const TSample& s1, const TSample& s2 )
+    {
+        const double x0 = s0.focus, x1 = s1.focus, x2 = s2.focus;
+        const double y0 = s0.sharpness, y1 = s1.sharpness, y2 = s2.sharpness;
+
+        const double denom = (x0 - x1) * (x0 - x2) * (x1 - x2);
+        if( denom == 0 ) {
+            return s1.focus;
+        }
+        const double a = (x2 * (y1 - y0) + x1 * (y0 - y2) + x0 * (y2 - y1)) / denom;
+        const double b = (x2 * x2 * (y0 - y1) + x1 * x1 * (y2 - y0) + x0 * x0 * (y1 - y2)) / denom;
+        if( a >= 0 ) {
+            return s1.focus;
+        }
+        const double vertex = -b / (2 * a);
+        return static_cast<int>( std::clamp( vertex, x0, x2 ) + 0.5 );
+    }
+
+    template<class TSample>
+    int     find_best_sample( const TSample* samples, int count )
+    {
+        int best = 0;
+        for( int i = 1; i < count; ++i )
+        {
+            if( samples[i].sharpness > samples[best].sharpness ) {
+                best = i;
+            }
+        }
+        return best;
+    }
+}
+
+void    auto_alg::impl::auto_focus::start_predictive_search( int& new_focus_val )
+{
+    const int range = data.right - data.left;
+    if( range <= 0 )
+    {
+        data.state = data_holder::ended;
+        return;
+    }
+
+    // a big roi does not need full resolution to find the coarse peak
+    coarse_decimation_ = std::clamp( std::min( data.width, data.height ) / (2 * REGION_SIZE), 1, 4 );
+
+    coarse_step_ = std::max( range / (COARSE_POSITION_COUNT - 1), 1 );
+
+    search_position_count_ = 0;
+    for( int i = 0; i < COARSE_POSITION_COUNT; ++i )
+    {
+        int pos = std::min( data.left + i * coarse_step_, data.right );
+        if( i == COARSE_POSITION_COUNT - 1 ) {
+            pos = data.right;
+        }
+        if( search_position_count_ > 0 && search_positions_[search_position_count_ - 1] == pos ) {
+            continue;
+        }
+        search_positions_[search_position_count_++] = pos;
+    }
+
+    // start at the end that is closer to the current position
+    if( (data.focus_val - data.left) > (data.right - data.focus_val) ) {
+        std::reverse( search_positions_, search_positions_ + search_position_count_ );
+    }
+
+    search_sample_count_ = 0;
+    search_next_ = 1;
+    data.state = data_holder::coarse_scan;
+    data.prev_focus = data.focus_val;
+
+    new_focus_val = search_positions_[0];
+
+    debug_out( "COARSE SCAN: step = %d, decimation = %d, new_focus_val = %d\n", coarse_step_, coarse_decimation_, new_focus_val );
+}
+
+bool	auto_alg::impl::auto_focus::analyze_frame_predictive( const img::img_descriptor& img, int& new_focus_val )
+{
+    RegionInfo info = {};
+    info.x = data.x;
+    info.y = data.y;
+    info.width = data.width;
+    info.height = data.height;
+
+    const int decimation = data.state == data_holder::coarse_scan ? coarse_decimation_ : 1;
+    const int sq = autofocus_get_sharpness( img, info, decimation );
+
+    search_samples_[search_sample_count_++] = { data.focus_val, sq };
+    data.prev_focus = data.focus_val;
+
+    if( data.state == data_holder::coarse_scan )
+    {
+        // the sharpness curve has a single peak, so once it dropped clearly on the last two positions the rest can be skipped
+        const int best = find_best_sample( search_samples_, search_sample_count_ );
+        const int best_sharpness = search_samples_[best].sharpness;
+        const bool passed_peak = best <= search_sample_count_ - 3
+            && search_samples_[search_sample_count_ - 1].sharpness * 10 < best_sharpness * 6
+            && search_samples_[search_sample_count_ - 2].sharpness * 10 < best_sharpness * 6;
+
+        if( !passed_peak && search_next_ < search_position_count_ )
+        {
+            new_focus_val = search_positions_[search_next_++];
+
+            debug_out( "COARSE SCAN: focus_val = %d, sharpness = %d => new_focus_val = %d\n", data.focus_val, sq, new_focus_val );
+            return true;
+        }
+        return start_fine_search( new_focus_val );
+    }
+
+    if( search_next_ < search_position_count_ )
+    {
+        new_focus_val = search_positions_[search_next_++];
+
+        debug_out( "FINE SCAN: focus_val = %d, sharpness = %d => new_focus_val = %d\n", data.focus_val, sq, new_focus_val );
+        return true;
+    }
+    return finish_fine_search( new_focus_val );
+}
+
+bool	auto_alg::impl::auto_focus::start_fine_search( int& new_focus_val )
+{
+    std::sort( search_samples_, search_samples_ + search_sample_count_,
+        []( const search_sample& lhs, const search_sample& rhs ) { return lhs.focus < rhs.focus; } );
+
+    const int best = find_best_sample( search_samples_, search_sample_count_ );
+
+    int center = search_samples_[best].focus;
+    if( best > 0 && best < search_sample_count_ - 1 ) {
+        center = interpolate_peak( search_samples_[best - 1], search_samples_[best], search_samples_[best + 1] );
+    }
+
+    fine_step_ = coarse_step_ / 4;
+    if( fine_step_ < 2 )
+    {
+        // the coarse scan already had the resolution of the fine scan
+        new_focus_val = std::clamp( center, data.left, data.right );
+        data.state = data_holder::ended;
+
+        debug_out( "COARSE SCAN DONE: new_focus_val = %d\n", new_focus_val );
+        return true;
+    }
+
+    // scan in one direction, so that the fine positions are approached the same way
+    search_position_count_ = 0;
+    for( int pos : { center - fine_step_, center, center + fine_step_ } ) {
+        search_positions_[search_position_count_++] = std::clamp( pos, data.left, data.right );
+    }
+
+    search_sample_count_ = 0;
+    search_next_ = 1;
+    fine_extensions_ = 0;
+    data.state = data_holder::fine_scan;
+
+    new_focus_val = search_positions_[0];
+
+    debug_out( "FINE SCAN: center = %d, step = %d, new_focus_val = %d\n", center, fine_step_, new_focus_val );
+    return true;
+}
+
+bool	auto_alg::impl::auto_focus::finish_fine_search( int& new_focus_val )
+{
+    std::sort( search_samples_, search_samples_ + search_sample_count_,
+        []( const search_sample& lhs, const search_sample& rhs ) { return lhs.focus < rhs.focus; } );
+
+    const int best = find_best_sample( search_samples_, search_sample_count_ );
+
+    // the interpolated coarse peak was off by more than a fine step, extend the scan in that direction
+    if( fine_extensions_ < MAX_FINE_EXTENSIONS && search_position_count_ < MAX_SEARCH_POSITIONS )
+    {
+        const bool extend_left = best == 0 && search_samples_[best].focus > data.left;
+        const bool extend_right = best == search_sample_count_ - 1 && search_samples_[best].focus < data.right;
+        if( extend_left || extend_right )
+        {
+            const int next = extend_left ? std::max( search_samples_[best].focus - fine_step_, data.left )
+                                         : std::min( search_samples_[best].focus + fine_step_, data.right );
+
+            ++fine_extensions_;
+            search_positions_[search_position_count_++] = next;
+            search_next_ = search_position_count_;
+            new_focus_val = next;
+
+            debug_out( "FINE SCAN EXTEND: new_focus_val = %d\n", new_focus_val );
+            return true;
+        }
+    }
+
+    int result = search_samples_[best].focus;
+    if( best > 0 && best < search_sample_count_ - 1 ) {
+        result = interpolate_peak( search_samples_[best - 1], search_samples_[best], search_samples_[best + 1] );
+    }
+
+    new_focus_val = std::clamp( result, data.left, data.right );
+    data.state = data_holder::ended;
+
+    debug_out( "FINE SCAN DONE: new_focus_val = %d\n", new_focus_val );
+    return true;
+}
+
 int auto_alg::impl::auto_focus::get_sharpness( const img::img_descriptor& img )
 {
     RegionInfo	info = {};
@@ -647,6 +906,20 @@ bool auto_alg::impl::auto_focus::check_wait_condition( uint64_t now )
 
 void auto_alg::impl::auto_focus::arm_focus_timer( uint64_t now, int diff )
 {
+    if( predictive_search_ )
+    {
+        // the travel time is estimated from the device speed, then the motor needs settle_time_us_ to come to rest
+        uint64_t us_to_use = settle_time_us_;
+        if( diff > 0 && focus_max_ > focus_min_ )
+        {
+            us_to_use += (uint64_t)diff * max_time_to_wait_for_focus_change_ * 1000 / (focus_max_ - focus_min_);
+        }
+        img_wait_endtime_ = now + us_to_use;
+
+        img_wait_cnt_ = 2;	// images in flight were exposed before the move
+        return;
+    }
+
     int ms_to_use = 0;
     if( diff > 0 )
     {
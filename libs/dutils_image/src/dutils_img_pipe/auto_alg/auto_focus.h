@@ -14,6 +14,9 @@ namespace auto_alg::impl
 {
     bool    supports_auto_focus( const img::img_type& img ) noexcept;
 
+    // contrast sum over the whole image, -1 for unsupported formats, see auto_alg::calc_image_sharpness
+    int     calc_image_sharpness( const img::img_descriptor& image, int decimation ) noexcept;
+
     class auto_focus
     {
     public:
@@ -26,6 +29,9 @@ namespace auto_alg::impl
         bool	is_running() const;
 
         void    reset() { end(); }
+
+        // time the focus motor needs to settle after it reached a new position, used by the predictive search
+        void    set_settle_time( uint32_t settle_time_us ) { settle_time_us_ = settle_time_us; }
     private:
         /* 
          * Beware that this function currently only works for bayer-8 images and RGB32
@@ -38,6 +44,12 @@ namespace auto_alg::impl
         void	end();
         bool	analyze_frame_( const img::img_descriptor& img, int& new_focus_vale );
 
+        // coarse to fine search with parabolic peak interpolation
+        void	start_predictive_search( int& new_focus_vale );
+        bool	analyze_frame_predictive( const img::img_descriptor& img, int& new_focus_vale );
+        bool	start_fine_search( int& new_focus_vale );
+        bool	finish_fine_search( int& new_focus_vale );
+
         void	restart_roi( const RegionInfo& info );
         void	find_region( const img::img_descriptor& image, img::rect roi, RegionInfo& region );
 
@@ -71,9 +83,39 @@ namespace auto_alg::impl
                 sweep_1,
                 sweep_2,
                 binary_search,
+                coarse_scan,
+                fine_scan,
             } state;
         } data;
 
+        struct search_sample
+        {
+            int     focus;
+            int     sharpness;
+        };
+
+        static constexpr int COARSE_POSITION_COUNT = 9;
+        static constexpr int FINE_POSITION_COUNT = 3;
+        static constexpr int MAX_FINE_EXTENSIONS = 2;
+        static constexpr int MAX_SEARCH_POSITIONS = COARSE_POSITION_COUNT;
+
+        // positions of the current scan phase and the sharpness measured at the actual device focus values
+        int             search_positions_[MAX_SEARCH_POSITIONS] = {};
+        int             search_position_count_ = 0;
+        int             search_next_ = 0;
+        search_sample   search_samples_[MAX_SEARCH_POSITIONS] = {};
+        int             search_sample_count_ = 0;
+
+        int             coarse_step_ = 0;
+        int             fine_step_ = 0;
+        int             fine_extensions_ = 0;
+
+        // decimation of the contrast measure in the coarse scan
+        int             coarse_decimation_ = 1;
+
+        bool            predictive_search_ = true;
+        uint32_t        settle_time_us_ = 50'000;
+
         img::rect	    user_roi_;
 
         img::dim	    init_dim_;
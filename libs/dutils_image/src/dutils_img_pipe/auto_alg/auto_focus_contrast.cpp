@@ -0,0 +1,60 @@
+
+#include "auto_focus_contrast.h"
+
+#include <dutils_img_lib/dutils_get_cpu_features.h>
+
+using namespace auto_alg::impl;
+
+void    focus::block_sum_u8_c( const uint8_t* line, int stride, int block_count, int* dst ) noexcept
+{
+    block_sum_c( line, stride, block_count, dst );
+}
+
+void    focus::block_sum_u16_c( const uint16_t* line, int stride, int block_count, int* dst ) noexcept
+{
+    block_sum_c( line, stride, block_count, dst );
+}
+
+auto    focus::get_block_sum_u8_func() noexcept -> block_sum_u8_func
+{
+    static const block_sum_u8_func func = []() -> block_sum_u8_func
+    {
+        [[maybe_unused]] const unsigned int features = img_lib::cpu::get_features();
+#if defined DUTILS_ARCH_ARM_A64
+        if( features & img::cpu::CPU_ARM_A64 ) {
+            return &block_sum_u8_neon;
+        }
+#elif !defined DUTILS_ARCH_ARM
+        if( features & img::cpu::CPU_AVX2 ) {
+            return &block_sum_u8_avx2;
+        }
+        if( features & img::cpu::CPU_SSE41 ) {
+            return &block_sum_u8_sse41;
+        }
+#endif
+        return &block_sum_u8_c;
+    }();
+    return func;
+}
+
+auto    focus::get_block_sum_u16_func() noexcept -> block_sum_u16_func
+{
+    static const block_sum_u16_func func = []() -> block_sum_u16_func
+    {
+        [[maybe_unused]] const unsigned int features = img_lib::cpu::get_features();
+#if defined DUTILS_ARCH_ARM_A64
+        if( features & img::cpu::CPU_ARM_A64 ) {
+            return &block_sum_u16_neon;
+        }
+#elif !defined DUTILS_ARCH_ARM
+        if( features & img::cpu::CPU_AVX2 ) {
+            return &block_sum_u16_avx2;
+        }
+        if( features & img::cpu::CPU_SSE41 ) {
+            return &block_sum_u16_sse41;
+        }
+#endif
+        return &block_sum_u16_c;
+    }();
+    return func;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <dutils_img/dutils_cpu_features.h>
+
+namespace auto_alg::impl::focus
+{
+    /*
+     * The contrast measure of the auto focus compares the sums of neighboring 8x4 pixel blocks at every 4th pixel.
+     * Both blocks are made up of two 4x4 blocks on the 4 pixel raster, so the line passes only compute the 4x4 block sums once
+     * and combine them afterwards.
+     *
+     * Sums the 4x4 blocks of the 4 lines starting at line, dst[i] receives the sum of the pixels [4*i, 4*i + 4) of these lines.
+     * @param stride    in bytes
+     */
+    using block_sum_u8_func = void (*)( const uint8_t* line, int stride, int block_count, int* dst );
+    using block_sum_u16_func = void (*)( const uint16_t* line, int stride, int block_count, int* dst );
+
+    void    block_sum_u8_c( const uint8_t* line, int stride, int block_count, int* dst ) noexcept;
+    void    block_sum_u16_c( const uint16_t* line, int stride, int block_count, int* dst ) noexcept;
+
+#if defined DUTILS_ARCH_ARM_A64
+    void    block_sum_u8_neon( const uint8_t* line, int stride, int block_count, int* dst ) noexcept;
+    void    block_sum_u16_neon( const uint16_t* line, int stride, int block_count, int* dst ) noexcept;
+#elif !defined DUTILS_ARCH_ARM
+    void    block_sum_u8_sse41( const uint8_t* line, int stride, int block_count, int* dst ) noexcept;
+    void    block_sum_u16_sse41( const uint16_t* line, int stride, int block_count, int* dst ) noexcept;
+
+    void    block_sum_u8_avx2( const uint8_t* line, int stride, int block_count, int* dst ) noexcept;
+    void    block_sum_u16_avx2( const uint16_t* line, int stride, int block_count, int* dst ) noexcept;
+#endif
+
+    // Selects the fastest variant the cpu supports, the result is cached.
+    block_sum_u8_func   get_block_sum_u8_func() noexcept;
+    block_sum_u16_func  get_block_sum_u16_func() noexcept;
+
+    template<typename TChannelType>
+    inline const TChannelType*  line_offset( const TChannelType* ptr, int lines, int stride ) noexcept
+    {
+        return reinterpret_cast<const TChannelType*>( reinterpret_cast<const uint8_t*>( ptr ) + lines * stride );
+    }
+
+    // pixel_step > 1 only uses every pixel_step-th pixel of the lines, see the decimation of the contrast measure
+    template<typename TChannelType>
+    inline void     block_sum_c( const TChannelType* line, int stride, int block_count, int* dst, int pixel_step = 1 ) noexcept
+    {
+        const TChannelType* l0 = line;
+        const TChannelType* l1 = line_offset( line, 1, stride );
+        const TChannelType* l2 = line_offset( line, 2, stride );
+        const TChannelType* l3 = line_offset( line, 3, stride );
+
+        for( int i = 0; i < block_count; ++i )
+        {
+            int sum = 0;
+            for( int x = i * 4 * pixel_step; x < (i * 4 + 4) * pixel_step; x += pixel_step ) {
+                sum += l0[x] + l1[x] + l2[x] + l3[x];
+            }
+            dst[i] = sum;
+        }
+    }
+}
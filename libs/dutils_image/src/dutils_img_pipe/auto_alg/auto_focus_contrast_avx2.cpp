@@ -0,0 +1,74 @@
+
+#include "auto_focus_contrast.h"
+
+#include "../../dutils_img_filter/simd_helper/use_simd_avx2.h"
+
+using namespace auto_alg::impl;
+
+void    focus::block_sum_u8_avx2( const uint8_t* line, int stride, int block_count, int* dst ) noexcept
+{
+    const uint8_t* l0 = line;
+    const uint8_t* l1 = line_offset( line, 1, stride );
+    const uint8_t* l2 = line_offset( line, 2, stride );
+    const uint8_t* l3 = line_offset( line, 3, stride );
+
+    const __m256i ones_u8 = _mm256_set1_epi8( 1 );
+    const __m256i ones_i16 = _mm256_set1_epi16( 1 );
+
+    // 32 pixels make up 8 blocks, maddubs/madd work per element so the order is preserved
+    int i = 0;
+    for( ; i + 8 <= block_count; i += 8 )
+    {
+        const int x = i * 4;
+
+        __m256i pairs = _mm256_maddubs_epi16( _mm256_loadu_si256( (const __m256i*)(l0 + x) ), ones_u8 );
+        pairs = _mm256_add_epi16( pairs, _mm256_maddubs_epi16( _mm256_loadu_si256( (const __m256i*)(l1 + x) ), ones_u8 ) );
+        pairs = _mm256_add_epi16( pairs, _mm256_maddubs_epi16( _mm256_loadu_si256( (const __m256i*)(l2 + x) ), ones_u8 ) );
+        pairs = _mm256_add_epi16( pairs, _mm256_maddubs_epi16( _mm256_loadu_si256( (const __m256i*)(l3 + x) ), ones_u8 ) );
+
+        _mm256_storeu_si256( (__m256i*)(dst + i), _mm256_madd_epi16( pairs, ones_i16 ) );
+    }
+    block_sum_c( line + i * 4, stride, block_count - i, dst + i );
+}
+
+namespace
+{
+    // sums neighboring pixels of the 4 lines, the result is biased by -4 * 65536 per pair
+    FORCEINLINE
+    __m256i     pair_sum_u16_biased( const uint16_t* l0, const uint16_t* l1, const uint16_t* l2, const uint16_t* l3 ) noexcept
+    {
+        const __m256i bias = _mm256_set1_epi16( (short)0x8000 );
+        const __m256i ones = _mm256_set1_epi16( 1 );
+
+        __m256i sum = _mm256_madd_epi16( _mm256_xor_si256( _mm256_loadu_si256( (const __m256i*)l0 ), bias ), ones );
+        sum = _mm256_add_epi32( sum, _mm256_madd_epi16( _mm256_xor_si256( _mm256_loadu_si256( (const __m256i*)l1 ), bias ), ones ) );
+        sum = _mm256_add_epi32( sum, _mm256_madd_epi16( _mm256_xor_si256( _mm256_loadu_si256( (const __m256i*)l2 ), bias ), ones ) );
+        sum = _mm256_add_epi32( sum, _mm256_madd_epi16( _mm256_xor_si256( _mm256_loadu_si256( (const __m256i*)l3 ), bias ), ones ) );
+        return sum;
+    }
+}
+
+void    focus::block_sum_u16_avx2( const uint16_t* line, int stride, int block_count, int* dst ) noexcept
+{
+    const uint16_t* l0 = line;
+    const uint16_t* l1 = line_offset( line, 1, stride );
+    const uint16_t* l2 = line_offset( line, 2, stride );
+    const uint16_t* l3 = line_offset( line, 3, stride );
+
+    const __m256i unbias = _mm256_set1_epi32( 16 * 32768 );
+
+    int i = 0;
+    for( ; i + 8 <= block_count; i += 8 )
+    {
+        const int x = i * 4;
+
+        const __m256i lo = pair_sum_u16_biased( l0 + x, l1 + x, l2 + x, l3 + x );
+        const __m256i hi = pair_sum_u16_biased( l0 + x + 16, l1 + x + 16, l2 + x + 16, l3 + x + 16 );
+
+        // hadd works per lane, this results in the blocks 0 1 4 5 | 2 3 6 7
+        const __m256i blocks = _mm256_permute4x64_epi64( _mm256_hadd_epi32( lo, hi ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+
+        _mm256_storeu_si256( (__m256i*)(dst + i), _mm256_add_epi32( blocks, unbias ) );
+    }
+    block_sum_c( line + i * 4, stride, block_count - i, dst + i );
+}
@@ -0,0 +1,55 @@
+
+#include "auto_focus_contrast.h"
+
+#include "../../dutils_img_filter/simd_helper/use_simd_A64.h"
+
+using namespace auto_alg::impl;
+
+void    focus::block_sum_u8_neon( const uint8_t* line, int stride, int block_count, int* dst ) noexcept
+{
+    const uint8_t* l0 = line;
+    const uint8_t* l1 = line_offset( line, 1, stride );
+    const uint8_t* l2 = line_offset( line, 2, stride );
+    const uint8_t* l3 = line_offset( line, 3, stride );
+
+    int i = 0;
+    for( ; i + 4 <= block_count; i += 4 )
+    {
+        const int x = i * 4;
+
+        uint16x8_t pairs = vpaddlq_u8( vld1q_u8( l0 + x ) );
+        pairs = vpadalq_u8( pairs, vld1q_u8( l1 + x ) );
+        pairs = vpadalq_u8( pairs, vld1q_u8( l2 + x ) );
+        pairs = vpadalq_u8( pairs, vld1q_u8( l3 + x ) );
+
+        vst1q_s32( dst + i, vreinterpretq_s32_u32( vpaddlq_u16( pairs ) ) );
+    }
+    block_sum_c( line + i * 4, stride, block_count - i, dst + i );
+}
+
+void    focus::block_sum_u16_neon( const uint16_t* line, int stride, int block_count, int* dst ) noexcept
+{
+    const uint16_t* l0 = line;
+    const uint16_t* l1 = line_offset( line, 1, stride );
+    const uint16_t* l2 = line_offset( line, 2, stride );
+    const uint16_t* l3 = line_offset( line, 3, stride );
+
+    int i = 0;
+    for( ; i + 4 <= block_count; i += 4 )
+    {
+        const int x = i * 4;
+
+        uint32x4_t lo = vpaddlq_u16( vld1q_u16( l0 + x ) );
+        lo = vpadalq_u16( lo, vld1q_u16( l1 + x ) );
+        lo = vpadalq_u16( lo, vld1q_u16( l2 + x ) );
+        lo = vpadalq_u16( lo, vld1q_u16( l3 + x ) );
+
+        uint32x4_t hi = vpaddlq_u16( vld1q_u16( l0 + x + 8 ) );
+        hi = vpadalq_u16( hi, vld1q_u16( l1 + x + 8 ) );
+        hi = vpadalq_u16( hi, vld1q_u16( l2 + x + 8 ) );
+        hi = vpadalq_u16( hi, vld1q_u16( l3 + x + 8 ) );
+
+        vst1q_s32( dst + i, vreinterpretq_s32_u32( vpaddq_u32( lo, hi ) ) );
+    }
+    block_sum_c( line + i * 4, stride, block_count - i, dst + i );
+}
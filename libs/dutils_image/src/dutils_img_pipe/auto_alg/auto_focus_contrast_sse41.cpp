@@ -0,0 +1,73 @@
+
+#include "auto_focus_contrast.h"
+
+#include "../../dutils_img_filter/simd_helper/use_simd_sse41.h"
+
+using namespace auto_alg::impl;
+
+void    focus::block_sum_u8_sse41( const uint8_t* line, int stride, int block_count, int* dst ) noexcept
+{
+    const uint8_t* l0 = line;
+    const uint8_t* l1 = line_offset( line, 1, stride );
+    const uint8_t* l2 = line_offset( line, 2, stride );
+    const uint8_t* l3 = line_offset( line, 3, stride );
+
+    const __m128i ones_u8 = _mm_set1_epi8( 1 );
+    const __m128i ones_i16 = _mm_set1_epi16( 1 );
+
+    // 16 pixels make up 4 blocks
+    int i = 0;
+    for( ; i + 4 <= block_count; i += 4 )
+    {
+        const int x = i * 4;
+
+        // pair sums of all 4 lines, at most 4 * 510, so this fits into int16
+        __m128i pairs = _mm_maddubs_epi16( _mm_loadu_si128( (const __m128i*)(l0 + x) ), ones_u8 );
+        pairs = _mm_add_epi16( pairs, _mm_maddubs_epi16( _mm_loadu_si128( (const __m128i*)(l1 + x) ), ones_u8 ) );
+        pairs = _mm_add_epi16( pairs, _mm_maddubs_epi16( _mm_loadu_si128( (const __m128i*)(l2 + x) ), ones_u8 ) );
+        pairs = _mm_add_epi16( pairs, _mm_maddubs_epi16( _mm_loadu_si128( (const __m128i*)(l3 + x) ), ones_u8 ) );
+
+        _mm_storeu_si128( (__m128i*)(dst + i), _mm_madd_epi16( pairs, ones_i16 ) );
+    }
+    block_sum_c( line + i * 4, stride, block_count - i, dst + i );
+}
+
+namespace
+{
+    // sums neighboring pixels of the 4 lines, the result is biased by -4 * 65536 per pair
+    FORCEINLINE
+    __m128i     pair_sum_u16_biased( const uint16_t* l0, const uint16_t* l1, const uint16_t* l2, const uint16_t* l3 ) noexcept
+    {
+        // _mm_madd_epi16 is signed, so move the values into the int16 range
+        const __m128i bias = _mm_set1_epi16( (short)0x8000 );
+        const __m128i ones = _mm_set1_epi16( 1 );
+
+        __m128i sum = _mm_madd_epi16( _mm_xor_si128( _mm_loadu_si128( (const __m128i*)l0 ), bias ), ones );
+        sum = _mm_add_epi32( sum, _mm_madd_epi16( _mm_xor_si128( _mm_loadu_si128( (const __m128i*)l1 ), bias ), ones ) );
+        sum = _mm_add_epi32( sum, _mm_madd_epi16( _mm_xor_si128( _mm_loadu_si128( (const __m128i*)l2 ), bias ), ones ) );
+        sum = _mm_add_epi32( sum, _mm_madd_epi16( _mm_xor_si128( _mm_loadu_si128( (const __m128i*)l3 ), bias ), ones ) );
+        return sum;
+    }
+}
+
+void    focus::block_sum_u16_sse41( const uint16_t* line, int stride, int block_count, int* dst ) noexcept
+{
+    const uint16_t* l0 = line;
+    const uint16_t* l1 = line_offset( line, 1, stride );
+    const uint16_t* l2 = line_offset( line, 2, stride );
+    const uint16_t* l3 = line_offset( line, 3, stride );
+
+    const __m128i unbias = _mm_set1_epi32( 16 * 32768 );
+
+    int i = 0;
+    for( ; i + 4 <= block_count; i += 4 )
+    {
+        const int x = i * 4;
+
+        const __m128i lo = pair_sum_u16_biased( l0 + x, l1 + x, l2 + x, l3 + x );
+        const __m128i hi = pair_sum_u16_biased( l0 + x + 8, l1 + x + 8, l2 + x + 8, l3 + x + 8 );
+
+        _mm_storeu_si128( (__m128i*)(dst + i), _mm_add_epi32( _mm_hadd_epi32( lo, hi ), unbias ) );
+    }
+    block_sum_c( line + i * 4, stride, block_count - i, dst + i );
+}
@@ -2,6 +2,7 @@
 #include "auto_hdr_gain.h"
 
 #include "auto_alg.h"
+#include "auto_sample_sums.h"
 
 #include "../../dutils_img_filter/transform/pwl/transform_pwl_to_bayerfloat_internal.h"
 
@@ -18,17 +19,13 @@ auto_alg::impl::auto_hdr_gain_result auto_alg::impl::auto_hdr_gain( const auto_a
     const auto prev_value = std::clamp( params.transform_param.hdr_gain, 0.f, 120.f ); // clip to range to prevent values out of range
 
     const auto internal_params = transform_pwl_internal::compute_fccfloat_to_fcc8_parameter( params.transform_param );
-    int sum_of_covnerted_gray_values = 0;
 
     float reference_value = params.hdr_gain_auto_reference * 256.f;
 
-    for( int i = 0; i < points.cnt; ++i )
-    {
-        // first convert to gray
-        const float gray_value = auto_alg::impl::calc_brightness_from_clr_avgf( points.samples[i] );
-        const uint8_t converted_gray_value = transform_pwl_internal::transform_RawFloat_to_Raw8_c( gray_value, internal_params );
-        sum_of_covnerted_gray_values += converted_gray_value;
-    }
+    // converts the samples to gray and then to 8 bit like transform_RawFloat_to_Raw8_c
+    static const auto gray_u8_sum = auto_alg::impl::sample_sums::get_gray_u8_sum_func();
+
+    const int sum_of_covnerted_gray_values = gray_u8_sum( points.samples, points.cnt, internal_params.gradient );
 
     float new_hdrgain_value = 0.f;
     if( sum_of_covnerted_gray_values <= 0 )
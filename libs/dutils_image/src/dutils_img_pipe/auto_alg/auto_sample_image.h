@@ -46,12 +46,35 @@ namespace auto_alg::impl
         };
     };
 
+    /** Histogram of the brightness of the sample points, 4 8-bit levels per bin. */
+    struct brightness_histogram
+    {
+        static constexpr int bin_count = 64;
+
+        int         cnt = 0;
+        uint32_t    bins[bin_count] = {};
+
+        void    add_u8( int y ) noexcept
+        {
+            ++bins[y >> 2];
+            ++cnt;
+        }
+        void    add( float y ) noexcept
+        {
+            const int bin = static_cast<int>( y * bin_count );
+            ++bins[bin < 0 ? 0 : (bin >= bin_count ? bin_count - 1 : bin)];
+            ++cnt;
+        }
+    };
+
     struct resulting_brightness
     {
         float   brightness = 0.5f;
         float   factor_y_vgt240 = 0.f;
 
-        static constexpr resulting_brightness invalid() noexcept { return resulting_brightness{ -1.f, -1.f }; }
+        brightness_histogram    histogram;
+
+        static constexpr resulting_brightness invalid() noexcept { return resulting_brightness{ -1.f, -1.f, {} }; }
     };
 
     // Sampling functions
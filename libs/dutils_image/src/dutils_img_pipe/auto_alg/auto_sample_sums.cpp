@@ -0,0 +1,29 @@
+
+#include "auto_sample_sums.h"
+
+#include <dutils_img_lib/dutils_get_cpu_features.h>
+
+using namespace auto_alg::impl;
+
+int     sample_sums::gray_u8_sum_c( const RGBf* samples, int cnt, float gradient ) noexcept
+{
+    return gray_u8_sum_range_c( samples, 0, cnt, gradient );
+}
+
+auto    sample_sums::get_gray_u8_sum_func() noexcept -> gray_u8_sum_func
+{
+    static const gray_u8_sum_func func = []() -> gray_u8_sum_func
+    {
+        [[maybe_unused]] const unsigned int features = img_lib::cpu::get_features();
+#if !defined DUTILS_ARCH_ARM
+        if( features & img::cpu::CPU_AVX2 ) {
+            return &gray_u8_sum_avx2;
+        }
+        if( features & img::cpu::CPU_SSE41 ) {
+            return &gray_u8_sum_sse41;
+        }
+#endif
+        return &gray_u8_sum_c;
+    }();
+    return func;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <dutils_img/dutils_cpu_features.h>
+
+#include "auto_alg.h"
+#include "auto_sample_image.h"
+
+namespace auto_alg::impl::sample_sums
+{
+    /*
+     * Reductions over the sample points of the auto algorithms, used by the auto hdr gain.
+     * The SIMD variants evaluate in the same order as the C variants and return the same sums.
+     */
+
+    // Sums the gray values of samples[0;cnt) after the float to 8 bit transform with gradient, see transform_RawFloat_to_Raw8_c
+    using gray_u8_sum_func = int (*)( const RGBf* samples, int cnt, float gradient );
+
+    int             gray_u8_sum_c( const RGBf* samples, int cnt, float gradient ) noexcept;
+
+#if !defined DUTILS_ARCH_ARM
+    int             gray_u8_sum_sse41( const RGBf* samples, int cnt, float gradient ) noexcept;
+    int             gray_u8_sum_avx2( const RGBf* samples, int cnt, float gradient ) noexcept;
+#endif
+
+    // Selects the fastest variant the cpu supports, the result is cached.
+    gray_u8_sum_func    get_gray_u8_sum_func() noexcept;
+
+    // value * gradient * 255 rounded and clipped to [0;255], written so that the SIMD variants can match it exactly
+    inline int      to_gray_u8( float value, float gradient ) noexcept
+    {
+        const float v = value * gradient * 255.f + 0.5f;
+        return (int)( v < 0.f ? 0.f : (v > 255.f ? 255.f : v) );
+    }
+
+    inline int      gray_u8_sum_range_c( const RGBf* samples, int begin, int end, float gradient ) noexcept
+    {
+        int sum = 0;
+        for( int i = begin; i < end; ++i ) {
+            sum += to_gray_u8( calc_brightness_from_clr_avgf( samples[i] ), gradient );
+        }
+        return sum;
+    }
+}
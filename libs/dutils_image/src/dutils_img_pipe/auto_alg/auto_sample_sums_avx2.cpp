@@ -0,0 +1,67 @@
+
+#include "auto_sample_sums.h"
+
+#include "../../dutils_img_filter/simd_helper/use_simd_avx2.h"
+
+using namespace auto_alg::impl;
+
+namespace
+{
+    FORCEINLINE int     hsum_epi32( __m256i v256 ) noexcept
+    {
+        __m128i v = _mm_add_epi32( _mm256_castsi256_si128( v256 ), _mm256_extracti128_si256( v256, 1 ) );
+        v = _mm_add_epi32( v, _mm_shuffle_epi32( v, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+        v = _mm_add_epi32( v, _mm_shuffle_epi32( v, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+        return _mm_cvtsi128_si32( v );
+    }
+
+    // loads samples [0;4) into the low and [4;8) into the high lane, 3 floats per sample
+    FORCEINLINE __m256  load_lanes( const float* ptr ) noexcept
+    {
+        return _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( ptr ) ), _mm_loadu_ps( ptr + 12 ), 1 );
+    }
+
+    // per lane the same shuffles as the sse4.1 variant
+    FORCEINLINE void    deinterleave_rgbf( __m256 v0, __m256 v1, __m256 v2, __m256& r, __m256& g, __m256& b ) noexcept
+    {
+        const __m256 r_tmp = _mm256_shuffle_ps( v1, v2, _MM_SHUFFLE( 0, 1, 0, 2 ) );
+        r = _mm256_shuffle_ps( v0, r_tmp, _MM_SHUFFLE( 2, 0, 3, 0 ) );
+
+        const __m256 g_lo = _mm256_shuffle_ps( v0, v1, _MM_SHUFFLE( 3, 0, 0, 1 ) );
+        const __m256 g_hi = _mm256_shuffle_ps( v1, v2, _MM_SHUFFLE( 2, 2, 3, 3 ) );
+        g = _mm256_shuffle_ps( g_lo, g_hi, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+
+        const __m256 b_lo = _mm256_shuffle_ps( v0, v1, _MM_SHUFFLE( 1, 1, 2, 2 ) );
+        const __m256 b_hi = _mm256_shuffle_ps( v2, v2, _MM_SHUFFLE( 3, 3, 0, 0 ) );
+        b = _mm256_shuffle_ps( b_lo, b_hi, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+    }
+}
+
+int     sample_sums::gray_u8_sum_avx2( const RGBf* samples, int cnt, float gradient ) noexcept
+{
+    const __m256 factor_r = _mm256_set1_ps( 0.299f );
+    const __m256 factor_g = _mm256_set1_ps( 0.587f );
+    const __m256 factor_b = _mm256_set1_ps( 0.114f );
+    const __m256 grad = _mm256_set1_ps( gradient );
+    const __m256 scale = _mm256_set1_ps( 255.f );
+    const __m256 half = _mm256_set1_ps( 0.5f );
+    const __m256 zero = _mm256_setzero_ps();
+
+    __m256i sum = _mm256_setzero_si256();
+
+    int i = 0;
+    for( ; i + 8 <= cnt; i += 8 )
+    {
+        const float* ptr = &samples[i].r;
+
+        __m256 r, g, b;
+        deinterleave_rgbf( load_lanes( ptr ), load_lanes( ptr + 4 ), load_lanes( ptr + 8 ), r, g, b );
+
+        const __m256 gray = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( r, factor_r ), _mm256_mul_ps( g, factor_g ) ), _mm256_mul_ps( b, factor_b ) );
+        __m256 v = _mm256_add_ps( _mm256_mul_ps( _mm256_mul_ps( gray, grad ), scale ), half );
+        v = _mm256_min_ps( _mm256_max_ps( v, zero ), scale );
+
+        sum = _mm256_add_epi32( sum, _mm256_cvttps_epi32( v ) );
+    }
+    return hsum_epi32( sum ) + gray_u8_sum_range_c( samples, i, cnt, gradient );
+}
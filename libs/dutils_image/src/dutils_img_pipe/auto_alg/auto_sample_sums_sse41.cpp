@@ -0,0 +1,60 @@
+
+#include "auto_sample_sums.h"
+
+#include "../../dutils_img_filter/simd_helper/use_simd_sse41.h"
+
+using namespace auto_alg::impl;
+
+namespace
+{
+    FORCEINLINE int     hsum_epi32( __m128i v ) noexcept
+    {
+        v = _mm_add_epi32( v, _mm_shuffle_epi32( v, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+        v = _mm_add_epi32( v, _mm_shuffle_epi32( v, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+        return _mm_cvtsi128_si32( v );
+    }
+
+    // 4 RGBf samples from 3 registers into one register per channel
+    FORCEINLINE void    deinterleave_rgbf( __m128 v0, __m128 v1, __m128 v2, __m128& r, __m128& g, __m128& b ) noexcept
+    {
+        const __m128 r_tmp = _mm_shuffle_ps( v1, v2, _MM_SHUFFLE( 0, 1, 0, 2 ) );
+        r = _mm_shuffle_ps( v0, r_tmp, _MM_SHUFFLE( 2, 0, 3, 0 ) );
+
+        const __m128 g_lo = _mm_shuffle_ps( v0, v1, _MM_SHUFFLE( 3, 0, 0, 1 ) );
+        const __m128 g_hi = _mm_shuffle_ps( v1, v2, _MM_SHUFFLE( 2, 2, 3, 3 ) );
+        g = _mm_shuffle_ps( g_lo, g_hi, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+
+        const __m128 b_lo = _mm_shuffle_ps( v0, v1, _MM_SHUFFLE( 1, 1, 2, 2 ) );
+        const __m128 b_hi = _mm_shuffle_ps( v2, v2, _MM_SHUFFLE( 3, 3, 0, 0 ) );
+        b = _mm_shuffle_ps( b_lo, b_hi, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+    }
+}
+
+int     sample_sums::gray_u8_sum_sse41( const RGBf* samples, int cnt, float gradient ) noexcept
+{
+    const __m128 factor_r = _mm_set1_ps( 0.299f );
+    const __m128 factor_g = _mm_set1_ps( 0.587f );
+    const __m128 factor_b = _mm_set1_ps( 0.114f );
+    const __m128 grad = _mm_set1_ps( gradient );
+    const __m128 scale = _mm_set1_ps( 255.f );
+    const __m128 half = _mm_set1_ps( 0.5f );
+    const __m128 zero = _mm_setzero_ps();
+
+    __m128i sum = _mm_setzero_si128();
+
+    int i = 0;
+    for( ; i + 4 <= cnt; i += 4 )
+    {
+        const float* ptr = &samples[i].r;
+
+        __m128 r, g, b;
+        deinterleave_rgbf( _mm_loadu_ps( ptr ), _mm_loadu_ps( ptr + 4 ), _mm_loadu_ps( ptr + 8 ), r, g, b );
+
+        const __m128 gray = _mm_add_ps( _mm_add_ps( _mm_mul_ps( r, factor_r ), _mm_mul_ps( g, factor_g ) ), _mm_mul_ps( b, factor_b ) );
+        __m128 v = _mm_add_ps( _mm_mul_ps( _mm_mul_ps( gray, grad ), scale ), half );
+        v = _mm_min_ps( _mm_max_ps( v, zero ), scale );
+
+        sum = _mm_add_epi32( sum, _mm_cvttps_epi32( v ) );
+    }
+    return hsum_epi32( sum ) + gray_u8_sum_range_c( samples, i, cnt, gradient );
+}
@@ -11,14 +11,6 @@ namespace
 
     using std::abs;
 
-static int calc_step( int delta ) noexcept
-{
-    int step = abs(delta) / 4;
-    if( step < 1 ) step = 1;
-
-    return step;
-}
-
 static bool wb_auto_step( const rgb_tripel& clr, rgb_tripel& wb ) noexcept
 {
     int avg = ((clr.r + clr.g + clr.b) / 3);
@@ -34,38 +26,8 @@ static bool wb_auto_step( const rgb_tripel& clr, rgb_tripel& wb ) noexcept
         return true;
     }
 
-    if( (clr.r > avg) && (wb.r > WB_IDENTITY) ) 
-    {
-        wb.r -= calc_step(dr);
-    }
-    if ((clr.g > avg) && (wb.g > WB_IDENTITY))
-    {
-        wb.g -= calc_step(dg);
-    }
-    if ((clr.b > avg) && (wb.b > WB_IDENTITY))
-    {
-        wb.b -= calc_step(db);
-    }
-
-    if( (clr.r < avg) && (wb.r < WB_MAX) )
-    {
-        wb.r += calc_step(dr);
-    }
-    if( (clr.g < avg) && (wb.g < WB_MAX) )
-    {
-        wb.g += calc_step(dg);
-    }
-    if( (clr.b < avg) && (wb.b < WB_MAX) )
-    {
-        wb.b += calc_step(db);
-    }
-
-    if( (wb.r > WB_IDENTITY) && (wb.g > WB_IDENTITY) && (wb.b > WB_IDENTITY) )
-    {
-        wb.r -= 1;
-        wb.g -= 1;
-        wb.b -= 1;
-    }
+    // The camera applied wb to the samples, so clr already contains it
+    wb = calc_gray_world_wb( clr, wb );
     return false;
 }
 
@@ -128,13 +90,10 @@ auto auto_alg::impl::auto_whitebalance_cam( const auto_alg::impl::auto_sample_po
 		return { false, to_wb_channel_factors( wb ) };
 	}
 
-    //unsigned int steps = 0;
-    //while( steps++ < MAX_STEPS )
-    {
-        rgb_tripel tmp = calc_wb_for_frame( data );
-        if( wb_auto_step( tmp, wb ) ) {
-			return { true, to_wb_channel_factors( wb ) };
-        }
+    // One step per frame, the next frame shows the result of the new values
+    rgb_tripel tmp = calc_wb_for_frame( data );
+    if( wb_auto_step( tmp, wb ) ) {
+        return { true, to_wb_channel_factors( wb ) };
     }
     wb.r = clip_to_wb( wb.r );
     wb.g = clip_to_wb( wb.g );
@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include "auto_sample_image.h"
 
@@ -40,6 +41,25 @@ namespace auto_alg::impl::wb
 	};
 
 
+	/** Returns the gains that make clr gray in one go, instead of stepping towards them over many frames.
+	 * clr is the gray-world estimate of the samples with wb already applied, so the correction avg / clr is relative to wb.
+	 * The gains are scaled such that the smallest one is WB_IDENTITY.
+	 */
+	inline rgb_tripel calc_gray_world_wb( const rgb_tripel& clr, const rgb_tripel& wb ) noexcept
+	{
+		const float avg = (clr.r + clr.g + clr.b) / 3.f;
+		if( avg < 1.f ) {
+			return wb;
+		}
+
+		const float r = wb.r * avg / std::max( clr.r, 1 );
+		const float g = wb.g * avg / std::max( clr.g, 1 );
+		const float b = wb.b * avg / std::max( clr.b, 1 );
+		const float scale = WB_IDENTITY / std::min( { r, g, b } );
+
+		return { clip_to_wb( (int)std::lround( r * scale ) ), clip_to_wb( (int)std::lround( g * scale ) ), clip_to_wb( (int)std::lround( b * scale ) ) };
+	}
+
 	constexpr auto to_wb_channel_factors( rgb_tripel tripel ) -> wb_channel_factors {
 		return { tripel.r / 64.f, tripel.g / 64.f, tripel.b / 64.f };
 	}
@@ -8,8 +8,8 @@ namespace
 {
     const constexpr float WB_IDENTITY = 1.f;
     const constexpr float WB_MAX = 4.f;
-    const constexpr int MAX_STEPS = 40;
-    const constexpr float WB_STEPSIZE = 0.001f;
+    const constexpr int MAX_STEPS = 8;
+    const constexpr float WB_STEPSIZE = 0.001f;     // changes below this are not worth another pass
 
     const constexpr float BREAK_DIFF = 0.001;//2 / 255.f;
 
@@ -84,56 +84,53 @@ namespace
         return (devR < NEARGRAY_MAX_COLOR_DEVIATION) && (devG < NEARGRAY_MAX_COLOR_DEVIATION) && (devB < NEARGRAY_MAX_COLOR_DEVIATION);
     }
 
-static float calc_step( float /*delta*/ ) noexcept
+// Returns the gains that make clr gray, clr being the estimate of the samples with wb already applied.
+// The gains are scaled such that the smallest one is WB_IDENTITY.
+static wb_components calc_gray_world_wb( const wb_components& clr, const wb_components& wb ) noexcept
 {
-    return WB_STEPSIZE;
+    constexpr float min_component = 1.0f / (1 << 16);
+
+    const float avg = (clr.r + clr.g + clr.b) / 3;
+    if( avg < min_component ) {
+        return wb;
+    }
+
+    const wb_components res = {
+        wb.r * avg / std::max( clr.r, min_component ),
+        wb.g * avg / std::max( clr.g, min_component ),
+        wb.b * avg / std::max( clr.b, min_component ),
+    };
+    const float scale = WB_IDENTITY / std::min( { res.r, res.g, res.b } );
+    return {
+        clip_to_wb_range( res.r * scale ),
+        clip_to_wb_range( res.g * scale ),
+        clip_to_wb_range( res.b * scale ),
+    };
 }
 
 static bool wb_auto_step( const wb_components& clr, wb_components& wb ) noexcept
 {
-    // first normalize components such that the average is always 1.0f
     const float avg = ((clr.r + clr.g + clr.b) / 3);
-    const float normalization_factor = 1.0f / avg;
-    wb_components normalized_color = { clr.r * normalization_factor , clr.g * normalization_factor, clr.b * normalization_factor };
-
-    const float dr = avg - normalized_color.r;
-    const float dg = avg - normalized_color.g;
-    const float db = avg - normalized_color.b;
-
-    if( abs( dr ) < BREAK_DIFF && abs( dg ) < BREAK_DIFF && abs( db ) < BREAK_DIFF )
-    {
+    if( avg <= 0.f ) {
         return true;
     }
 
-    if( (clr.r > avg) && (wb.r > WB_IDENTITY) )
-    {
-        wb.r -= calc_step( dr );
-    }
-    else if( (clr.r < avg) && (wb.r < WB_MAX) )
-    {
-        wb.r += calc_step( dr );
-    }
+    // relative deviation of each component from the average
+    const float dr = 1.f - clr.r / avg;
+    const float dg = 1.f - clr.g / avg;
+    const float db = 1.f - clr.b / avg;
 
-    if( (clr.g > avg) && (wb.g > WB_IDENTITY) )
-    {
-        wb.g -= calc_step( dg );
-    }
-    else if( (clr.g < avg) && (wb.g < WB_MAX) )
+    if( abs( dr ) < BREAK_DIFF && abs( dg ) < BREAK_DIFF && abs( db ) < BREAK_DIFF )
     {
-        wb.g += calc_step( dg );
+        return true;
     }
 
-    if( (clr.b > avg) && (wb.b > WB_IDENTITY) )
-    {
-        wb.b -= calc_step( db );
-    }
-    else if( (clr.b < avg) && (wb.b < WB_MAX) )
-    {
-        wb.b += calc_step( db );
-    }
+    const wb_components new_wb = calc_gray_world_wb( clr, wb );
 
-    wb = adjust_to_identity( wb );
-    return false;
+    // Nothing left to correct, e.g. because a gain is clipped
+    const bool unchanged = abs( new_wb.r - wb.r ) < WB_STEPSIZE && abs( new_wb.g - wb.g ) < WB_STEPSIZE && abs( new_wb.b - wb.b ) < WB_STEPSIZE;
+    wb = new_wb;
+    return unchanged;
 }
 
 static wb_components simulate_whitebalance( const auto_alg::impl::image_sampling_points_rgbf& data, const wb_components& wb ) noexcept
@@ -189,6 +186,8 @@ auto auto_alg::impl::auto_whitebalance_soft( const auto_alg::impl::image_samplin
 
     assert( data.cnt > 0 );
     
+    // Each pass jumps to the gray-world gains, the following ones only correct for the samples that start
+    // or stop being near gray or clipped with the new gains. So this usually ends after 1-3 passes.
     for( int steps = 0; steps < MAX_STEPS; ++steps )
     {
         wb_components tmp = simulate_whitebalance( data, wb );
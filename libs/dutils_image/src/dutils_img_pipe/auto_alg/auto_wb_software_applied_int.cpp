@@ -25,11 +25,6 @@ namespace
         return wb;
     }
 
-static int calc_step( int /*delta*/ ) noexcept
-{
-    return 1;
-}
-
 static bool wb_auto_step( const rgb_tripel& clr, rgb_tripel& wb ) noexcept
 {
     int avg = ((clr.r + clr.g + clr.b) / 3);
@@ -45,34 +40,12 @@ static bool wb_auto_step( const rgb_tripel& clr, rgb_tripel& wb ) noexcept
         return true;
     }
 
-    if( (clr.r > avg) && (wb.r > WB_IDENTITY) ) 
-    {
-        wb.r -= calc_step(dr);
-    }
-    if ((clr.g > avg) && (wb.g > WB_IDENTITY))
-    {
-        wb.g -= calc_step(dg);
-    }
-    if ((clr.b > avg) && (wb.b > WB_IDENTITY))
-    {
-        wb.b -= calc_step(db);
-    }
+    const rgb_tripel new_wb = calc_gray_world_wb( clr, wb );
 
-    if( (clr.r < avg) && (wb.r < WB_MAX) )
-    {
-        wb.r += calc_step(dr);
-    }
-    if( (clr.g < avg) && (wb.g < WB_MAX) )
-    {
-        wb.g += calc_step(dg);
-    }
-    if( (clr.b < avg) && (wb.b < WB_MAX) )
-    {
-        wb.b += calc_step(db);
-    }
-
-    wb = adjust_to_identity( wb );
-    return false;
+    // Nothing left to correct, e.g. because a gain is clipped or the rounding to 1/64 steps
+    const bool unchanged = new_wb.r == wb.r && new_wb.g == wb.g && new_wb.b == wb.b;
+    wb = new_wb;
+    return unchanged;
 }
 
 static rgb_tripel simulate_whitebalance( const auto_alg::impl::auto_sample_points& data, const rgb_tripel& wb ) noexcept
@@ -131,6 +104,8 @@ auto auto_alg::impl::auto_whitebalance_soft( const auto_alg::impl::auto_sample_p
 		return { false, to_wb_channel_factors( wb ) };
 	}
 
+    // Each pass jumps to the gray-world gains, the following ones only correct for the samples that start
+    // or stop being near gray or clipped with the new gains. So this usually ends after 1-3 passes.
     unsigned int steps = 0;
     while( steps++ < MAX_STEPS )
     {
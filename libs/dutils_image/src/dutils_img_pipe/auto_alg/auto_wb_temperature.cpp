@@ -1,6 +1,8 @@
 
 #include "auto_wb_temperature.h"
 
+#include <dutils_img_lib/dutils_get_cpu_features.h>
+
 #include <cmath>
 
 using namespace auto_alg;
@@ -28,40 +30,64 @@ static int clip( int x )
 	return x;
 }
 
+}
 
-static int SimulateWhiteBalance( const auto_alg::impl::auto_sample_points& points, wb_channel_factors factors )
+void	auto_alg::impl::wb_temperature::fill_sample_planes( const auto_sample_points& points, sample_planes& planes ) noexcept
 {
-	const float min_c = 0.925f;
-	const float max_c = 1.0f / min_c;
-
-	int whiteCnt = 0;
-
 	for( int i = 0; i < points.cnt; ++i )
 	{
 		const auto pix = points.samples[i].to_pixel();
 
-		const int r = clip( (int)((float)pix.r * factors.r) );
-		const int g = clip( (int)((float)pix.g * factors.g) );
-		const int b = clip( (int)((float)pix.b * factors.b) );
+		planes.r[i] = pix.r;
+		planes.g[i] = pix.g;
+		planes.b[i] = pix.b;
+	}
+	planes.cnt = points.cnt;
+}
+
+int		auto_alg::impl::wb_temperature::count_white_c( const sample_planes& planes, int first, wb_channel_factors factors ) noexcept
+{
+	int whiteCnt = 0;
+
+	for( int i = first; i < planes.cnt; ++i )
+	{
+		const int r = clip( (int)((float)planes.r[i] * factors.r) );
+		const int g = clip( (int)((float)planes.g[i] * factors.g) );
+		const int b = clip( (int)((float)planes.b[i] * factors.b) );
 		const int y = ((r * 79 + g * 150 + b * 27) >> 8);
-		if( y > 50 && y < 240 )
-		{
 
-			float qrg = (float)r / (float)g;
-			float qbg = (float)b / (float)g;
-			float qrb = (float)r / (float)b;
+		const float rf = (float)r;
+		const float gf = (float)g;
+		const float bf = (float)b;
 
-			if( qrb > min_c && qrb < max_c &&
-				qbg > min_c && qbg < max_c &&
-				qrg > min_c && qrg < max_c )
-			{
-				whiteCnt++;
-			}
-		}
+		// same as testing r/b, b/g and r/g against the range, for all 8 bit values
+		const bool is_white = y > 50 && y < 240
+			&& rf > white_ratio_min * bf && rf < white_ratio_max * bf
+			&& bf > white_ratio_min * gf && bf < white_ratio_max * gf
+			&& rf > white_ratio_min * gf && rf < white_ratio_max * gf;
+
+		whiteCnt += is_white ? 1 : 0;
 	}
 	return whiteCnt;
 }
 
+int		auto_alg::impl::wb_temperature::count_white_c( const sample_planes& planes, wb_channel_factors factors ) noexcept
+{
+	return count_white_c( planes, 0, factors );
+}
+
+auto	auto_alg::impl::wb_temperature::get_count_white_func() noexcept -> count_white_func
+{
+	static const count_white_func func = []() -> count_white_func
+	{
+#if !defined DUTILS_ARCH_ARM
+		if( img_lib::cpu::get_features() & img::cpu::CPU_SSE41 ) {
+			return &count_white_sse41;
+		}
+#endif
+		return &count_white_c;
+	}();
+	return func;
 }
 
 int		auto_alg::impl::calc_temperature_for_pixels( const auto_alg::impl::auto_sample_points& points, int min_temperature, int max_temperature, const wb_channel_factors* arr )
@@ -69,11 +95,16 @@ int		auto_alg::impl::calc_temperature_for_pixels( const auto_alg::impl::auto_sam
 	int maxWhiteTemp = -1;
 	float maxWhiteValue = -1;
 
+	wb_temperature::sample_planes planes;
+	wb_temperature::fill_sample_planes( points, planes );
+
+	const auto count_white = wb_temperature::get_count_white_func();
+
 	//  Get temperature with most potentially white pixels
 	for( int temperature_iter = min_temperature; temperature_iter < max_temperature; temperature_iter += 100 )
 	{
 		wb_channel_factors wb_factors = GetFactorsFromTemperature( temperature_iter, arr );
-		const int white_count = SimulateWhiteBalance( points, wb_factors );
+		const int white_count = count_white( planes, wb_factors );
 		const float whiteValue = (float)white_count;
 
 		// normal distribution around center
@@ -4,6 +4,8 @@
 
 #include "auto_alg.h"
 
+#include <dutils_img/dutils_cpu_features.h>
+
 namespace auto_alg::impl
 {
 	// calculates a wb-temperature based on the previous temperature, so that changes smaller
@@ -13,4 +15,34 @@ namespace auto_alg::impl
 	int			calc_temperature_for_pixels( const auto_sample_points& points, int min_temperature, int max_temperature, const wb_channel_factors* arr );
 
 	wb_channel_factors	calc_whitebalance_values( int temperature, const wb_channel_factors* arr );
+
+	namespace wb_temperature
+	{
+		// a pixel counts as white when all channel ratios are in [white_ratio_min;white_ratio_max]
+		constexpr float	white_ratio_min = 0.925f;
+		constexpr float	white_ratio_max = 1.0f / white_ratio_min;
+
+		/** The sample points split into channel planes, so that the white pixel count for all temperatures can be vectorized. */
+		struct sample_planes
+		{
+			int		cnt = 0;
+			uint8_t	r[1500];
+			uint8_t	g[1500];
+			uint8_t	b[1500];
+		};
+
+		void		fill_sample_planes( const auto_sample_points& points, sample_planes& planes ) noexcept;
+
+		// returns the count of pixels that are white after applying factors
+		using count_white_func = int( * )( const sample_planes& planes, wb_channel_factors factors ) noexcept;
+
+		int			count_white_c( const sample_planes& planes, wb_channel_factors factors ) noexcept;
+#if !defined DUTILS_ARCH_ARM
+		int			count_white_sse41( const sample_planes& planes, wb_channel_factors factors ) noexcept;
+#endif
+		count_white_func	get_count_white_func() noexcept;
+
+		// for the variants that process the remaining pixels with the c version
+		int			count_white_c( const sample_planes& planes, int first, wb_channel_factors factors ) noexcept;
+	}
 }
\ No newline at end of file
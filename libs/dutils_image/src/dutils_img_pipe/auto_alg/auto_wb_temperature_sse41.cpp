@@ -0,0 +1,82 @@
+#include "auto_wb_temperature.h"
+
+#include "../../dutils_img_filter/simd_helper/use_simd_sse41.h"
+
+#include <cstring>
+
+using namespace auto_alg::impl;
+
+namespace
+{
+    FORCEINLINE
+    __m128i     load_4_u8_as_i32( const uint8_t* src ) noexcept
+    {
+        int32_t tmp;
+        memcpy( &tmp, src, sizeof( tmp ) );
+        return _mm_cvtepu8_epi32( _mm_cvtsi32_si128( tmp ) );
+    }
+
+    // clip( (int)(v * factor) ), as in count_white_c
+    FORCEINLINE
+    __m128i     apply_factor( __m128i v, __m128 factor ) noexcept
+    {
+        const __m128i res = _mm_cvttps_epi32( _mm_mul_ps( _mm_cvtepi32_ps( v ), factor ) );
+        return _mm_max_epi32( _mm_min_epi32( res, _mm_set1_epi32( 255 ) ), _mm_setzero_si128() );
+    }
+
+    // a in ]min * b; max * b[
+    FORCEINLINE
+    __m128      in_ratio_range( __m128 a, __m128 b, __m128 min_c, __m128 max_c ) noexcept
+    {
+        return _mm_and_ps( _mm_cmpgt_ps( a, _mm_mul_ps( min_c, b ) ), _mm_cmplt_ps( a, _mm_mul_ps( max_c, b ) ) );
+    }
+}
+
+int     wb_temperature::count_white_sse41( const sample_planes& planes, wb_channel_factors factors ) noexcept
+{
+    const __m128 fr = _mm_set1_ps( factors.r );
+    const __m128 fg = _mm_set1_ps( factors.g );
+    const __m128 fb = _mm_set1_ps( factors.b );
+
+    const __m128 min_c = _mm_set1_ps( white_ratio_min );
+    const __m128 max_c = _mm_set1_ps( white_ratio_max );
+
+    const __m128i y_factor_r = _mm_set1_epi32( 79 );
+    const __m128i y_factor_g = _mm_set1_epi32( 150 );
+    const __m128i y_factor_b = _mm_set1_epi32( 27 );
+    const __m128i y_min = _mm_set1_epi32( 50 );
+    const __m128i y_max = _mm_set1_epi32( 240 );
+
+    // the compare masks are -1, so this counts down
+    __m128i accu = _mm_setzero_si128();
+
+    int i = 0;
+    for( ; i + 4 <= planes.cnt; i += 4 )
+    {
+        const __m128i r = apply_factor( load_4_u8_as_i32( planes.r + i ), fr );
+        const __m128i g = apply_factor( load_4_u8_as_i32( planes.g + i ), fg );
+        const __m128i b = apply_factor( load_4_u8_as_i32( planes.b + i ), fb );
+
+        __m128i y = _mm_mullo_epi32( r, y_factor_r );
+        y = _mm_add_epi32( y, _mm_mullo_epi32( g, y_factor_g ) );
+        y = _mm_add_epi32( y, _mm_mullo_epi32( b, y_factor_b ) );
+        y = _mm_srai_epi32( y, 8 );
+
+        const __m128i y_mask = _mm_and_si128( _mm_cmpgt_epi32( y, y_min ), _mm_cmplt_epi32( y, y_max ) );
+
+        const __m128 rf = _mm_cvtepi32_ps( r );
+        const __m128 gf = _mm_cvtepi32_ps( g );
+        const __m128 bf = _mm_cvtepi32_ps( b );
+
+        __m128 ratio_mask = in_ratio_range( rf, bf, min_c, max_c );
+        ratio_mask = _mm_and_ps( ratio_mask, in_ratio_range( bf, gf, min_c, max_c ) );
+        ratio_mask = _mm_and_ps( ratio_mask, in_ratio_range( rf, gf, min_c, max_c ) );
+
+        accu = _mm_add_epi32( accu, _mm_and_si128( y_mask, _mm_castps_si128( ratio_mask ) ) );
+    }
+
+    accu = _mm_add_epi32( accu, _mm_shuffle_epi32( accu, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+    accu = _mm_add_epi32( accu, _mm_shuffle_epi32( accu, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+
+    return -_mm_cvtsi128_si32( accu ) + count_white_c( planes, i, factors );
+}
@@ -0,0 +1,128 @@
+
+#include "channel_statistics.h"
+
+#include <dutils_img_lib/dutils_get_cpu_features.h>
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+
+using namespace auto_alg::impl;
+
+void    auto_alg::channel_statistics::reset( img::dim image_dim ) noexcept
+{
+    static_assert( std::is_trivially_copyable_v<channel_statistics> );
+
+    *this = channel_statistics{};
+    dim = image_dim;
+}
+
+void    auto_alg::channel_statistics::merge( const channel_statistics& other ) noexcept
+{
+    pixel_count += other.pixel_count;
+    count_above_240 += other.count_above_240;
+
+    for( int c = 0; c < 3; ++c ) {
+        for( int bin = 0; bin < histogram_bin_count; ++bin ) {
+            histogram[c][bin] += other.histogram[c][bin];
+        }
+    }
+    for( int bin = 0; bin < histogram_bin_count; ++bin ) {
+        brightness_histogram[bin] += other.brightness_histogram[bin];
+    }
+
+    for( int row = 0; row < grid_size; ++row )
+    {
+        for( int column = 0; column < grid_size; ++column )
+        {
+            auto& cell = grid[row][column];
+            const auto& other_cell = other.grid[row][column];
+            for( int c = 0; c < 3; ++c ) {
+                cell.sum[c] += other_cell.sum[c];
+            }
+            cell.count += other_cell.count;
+            cell.count_above_240 += other_cell.count_above_240;
+        }
+    }
+}
+
+float   auto_alg::channel_statistics::grid_mean( int row, int column, channel c ) const noexcept
+{
+    const auto& cell = grid[row][column];
+    if( cell.count == 0 ) {
+        return 0.f;
+    }
+    return static_cast<float>( cell.sum[c] ) / ( cell.count * 255.f );
+}
+
+void    channel_stats::accumulate_c( channel_statistics& stats, const uint8_t* line, int x_beg, int x_end, channel_statistics::grid_cell& cell ) noexcept
+{
+    uint64_t sum_b = 0, sum_g = 0, sum_r = 0;
+    uint32_t above = 0;
+    for( int x = x_beg; x < x_end; ++x )
+    {
+        const int b = line[x * 4 + 0];
+        const int g = line[x * 4 + 1];
+        const int r = line[x * 4 + 2];
+        const int y = calc_brightness_from_clr_avg( r, g, b );
+
+        sum_b += b;
+        sum_g += g;
+        sum_r += r;
+        above += y >= 240 ? 1 : 0;
+
+        add_to_histograms( stats, b, g, r, y );
+    }
+
+    cell.sum[channel_statistics::b] += sum_b;
+    cell.sum[channel_statistics::g] += sum_g;
+    cell.sum[channel_statistics::r] += sum_r;
+    cell.count += x_end - x_beg;
+    cell.count_above_240 += above;
+    stats.count_above_240 += above;
+}
+
+auto    channel_stats::get_accumulate_func() noexcept -> accumulate_func
+{
+    static const accumulate_func func = []() -> accumulate_func
+    {
+        [[maybe_unused]] const unsigned int features = img_lib::cpu::get_features();
+#if !defined DUTILS_ARCH_ARM
+        if( features & img::cpu::CPU_SSE41 ) {
+            return &accumulate_sse41;
+        }
+#endif
+        return &accumulate_c;
+    }();
+    return func;
+}
+
+void    auto_alg::accumulate_channel_statistics( channel_statistics& stats, const img::img_descriptor& bgra_lines, int first_line )
+{
+    assert( bgra_lines.fourcc_type() == img::fourcc::BGRA32 );
+
+    constexpr int grid_size = channel_statistics::grid_size;
+    constexpr int line_step = channel_statistics::line_step;
+
+    const auto func = channel_stats::get_accumulate_func();
+
+    const int width = std::min( bgra_lines.dim.cx, stats.dim.cx );
+    const int line_end = std::min( bgra_lines.dim.cy, stats.dim.cy - first_line );
+
+    // the counted lines are the same for every split of the image into strips
+    for( int y = (line_step - first_line % line_step) % line_step; y < line_end; y += line_step )
+    {
+        auto* grid_row = stats.grid[(first_line + y) * grid_size / stats.dim.cy];
+        const uint8_t* line = img::get_line_start( bgra_lines, y );
+
+        for( int column = 0; column < grid_size; ++column )
+        {
+            const int x_beg = column * stats.dim.cx / grid_size;
+            const int x_end = std::min( width, (column + 1) * stats.dim.cx / grid_size );
+            if( x_beg < x_end ) {
+                func( stats, line, x_beg, x_end, grid_row[column] );
+            }
+        }
+        stats.pixel_count += width;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <dutils_img/dutils_cpu_features.h>
+#include <dutils_img_pipe/channel_statistics.h>
+
+#include "auto_alg.h"
+
+namespace auto_alg::impl::channel_stats
+{
+    /*
+     * Adds the BGRA32 pixels [x_beg;x_end) of line to cell, to the histograms and to the count of bright pixels of stats.
+     * The SIMD variants return the same statistics as the C variant.
+     */
+    using accumulate_func = void (*)( channel_statistics& stats, const uint8_t* line, int x_beg, int x_end, channel_statistics::grid_cell& cell );
+
+    void    accumulate_c( channel_statistics& stats, const uint8_t* line, int x_beg, int x_end, channel_statistics::grid_cell& cell ) noexcept;
+
+#if !defined DUTILS_ARCH_ARM
+    void    accumulate_sse41( channel_statistics& stats, const uint8_t* line, int x_beg, int x_end, channel_statistics::grid_cell& cell ) noexcept;
+#endif
+
+    // Selects the fastest variant the cpu supports, the result is cached.
+    accumulate_func     get_accumulate_func() noexcept;
+
+    // the histograms take scattered increments, so all variants add them per pixel
+    inline void     add_to_histograms( channel_statistics& stats, int b, int g, int r, int y ) noexcept
+    {
+        ++stats.histogram[channel_statistics::b][b >> 2];
+        ++stats.histogram[channel_statistics::g][g >> 2];
+        ++stats.histogram[channel_statistics::r][r >> 2];
+        ++stats.brightness_histogram[y >> 2];
+    }
+}
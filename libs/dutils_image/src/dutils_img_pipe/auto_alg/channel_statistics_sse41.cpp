@@ -0,0 +1,78 @@
+#include "channel_statistics.h"
+
+#include "../../dutils_img_filter/simd_helper/use_simd_sse41.h"
+
+using namespace auto_alg::impl;
+
+namespace
+{
+    FORCEINLINE uint64_t    hsum_epi64( __m128i v ) noexcept
+    {
+        alignas(16) uint64_t tmp[2];
+        _mm_store_si128( (__m128i*)tmp, v );
+        return tmp[0] + tmp[1];
+    }
+
+    FORCEINLINE uint32_t    hsum_epi32( __m128i v ) noexcept
+    {
+        v = _mm_add_epi32( v, _mm_shuffle_epi32( v, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+        v = _mm_add_epi32( v, _mm_shuffle_epi32( v, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+        return static_cast<uint32_t>( _mm_cvtsi128_si32( v ) );
+    }
+}
+
+void    channel_stats::accumulate_sse41( channel_statistics& stats, const uint8_t* line, int x_beg, int x_end, channel_statistics::grid_cell& cell ) noexcept
+{
+    // the factors of calc_brightness_from_clr_avg for b, g, r and 0 for a
+    const int16_t r_factor = (int16_t)((1 << 8) * 0.299f);
+    const int16_t g_factor = (int16_t)((1 << 8) * 0.587f);
+    const int16_t b_factor = (int16_t)((1 << 8) * 0.114f);
+    const __m128i factors = _mm_setr_epi16( b_factor, g_factor, r_factor, 0, b_factor, g_factor, r_factor, 0 );
+
+    const __m128i mask_b = _mm_set1_epi32( 0x0000FF );
+    const __m128i mask_g = _mm_set1_epi32( 0x00FF00 );
+    const __m128i mask_r = _mm_set1_epi32( 0xFF0000 );
+    const __m128i threshold = _mm_set1_epi32( 239 );
+    const __m128i zero = _mm_setzero_si128();
+
+    // sad_epu8 sums the bytes of each half into a 64 bit lane, so the masked channels are summed with their values
+    __m128i sum_b = _mm_setzero_si128();
+    __m128i sum_g = _mm_setzero_si128();
+    __m128i sum_r = _mm_setzero_si128();
+    __m128i above = _mm_setzero_si128();
+
+    alignas(16) uint32_t y_vals[4];
+
+    int x = x_beg;
+    for( ; x + 4 <= x_end; x += 4 )
+    {
+        const uint8_t* px = line + x * 4;
+        const __m128i v = _mm_loadu_si128( (const __m128i*)px );
+
+        sum_b = _mm_add_epi64( sum_b, _mm_sad_epu8( _mm_and_si128( v, mask_b ), zero ) );
+        sum_g = _mm_add_epi64( sum_g, _mm_sad_epu8( _mm_and_si128( v, mask_g ), zero ) );
+        sum_r = _mm_add_epi64( sum_r, _mm_sad_epu8( _mm_and_si128( v, mask_r ), zero ) );
+
+        // b * b_factor + g * g_factor and r * r_factor per pixel, added by the hadd
+        const __m128i lo = _mm_madd_epi16( _mm_cvtepu8_epi16( v ), factors );
+        const __m128i hi = _mm_madd_epi16( _mm_cvtepu8_epi16( _mm_srli_si128( v, 8 ) ), factors );
+        const __m128i y = _mm_srli_epi32( _mm_hadd_epi32( lo, hi ), 8 );
+
+        above = _mm_sub_epi32( above, _mm_cmpgt_epi32( y, threshold ) );
+
+        _mm_store_si128( (__m128i*)y_vals, y );
+        for( int i = 0; i < 4; ++i ) {
+            add_to_histograms( stats, px[i * 4 + 0], px[i * 4 + 1], px[i * 4 + 2], (int)y_vals[i] );
+        }
+    }
+
+    const uint32_t above_cnt = hsum_epi32( above );
+    cell.sum[channel_statistics::b] += hsum_epi64( sum_b );
+    cell.sum[channel_statistics::g] += hsum_epi64( sum_g );
+    cell.sum[channel_statistics::r] += hsum_epi64( sum_r );
+    cell.count += x - x_beg;
+    cell.count_above_240 += above_cnt;
+    stats.count_above_240 += above_cnt;
+
+    accumulate_c( stats, line, x, x_end, cell );
+}
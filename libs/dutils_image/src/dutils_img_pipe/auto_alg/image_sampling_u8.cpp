@@ -202,6 +202,8 @@ static auto_alg::impl::resulting_brightness	        auto_sample_mono_img_( const
         return auto_alg::impl::resulting_brightness::invalid();
     }
 
+    auto_alg::impl::resulting_brightness rval;
+
     int cnt = 0;
 
     int cnt_y_gt_240 = 0;
@@ -218,6 +220,7 @@ static auto_alg::impl::resulting_brightness	        auto_sample_mono_img_( const
             if( val >= 240 ) {
                 ++cnt_y_gt_240;
             }
+            rval.histogram.add_u8( val );
         }
     }
 
@@ -225,7 +228,9 @@ static auto_alg::impl::resulting_brightness	        auto_sample_mono_img_( const
 
     float div = 1.f / cnt;
 
-    return { pixel_accu / 255.f * div, cnt_y_gt_240 * div };
+    rval.brightness = pixel_accu / 255.f * div;
+    rval.factor_y_vgt240 = cnt_y_gt_240 * div;
+    return rval;
 }
 
 auto_alg::impl::resulting_brightness	auto_alg::impl::auto_sample_mono_imgu8( const img::img_descriptor& image )
@@ -0,0 +1,38 @@
+
+#pragma  once
+
+#include "auto_sample_image.h"
+
+#include <dutils_img/image_fourcc_enum.h>
+#include <dutils_img_pipe/channel_statistics.h>
+
+#include <cstring>
+
+namespace auto_alg::detail
+{
+    /** Sparse samples or the channel statistics of one image, everything the brightness/whitebalance algorithms need. */
+    struct image_statistics
+    {
+        image_statistics()
+        {
+            memset( &sampling_points.points_float, 0, sizeof( sampling_points.points_float ) );
+        }
+
+        img::fourcc     fcc = img::fourcc::FCC_NULL;
+
+        // auto_pass_params::exposure_in_flight was set, nothing was sampled
+        bool            exposure_in_flight = false;
+
+        // color and pwl images
+        bool                                has_sampling_points = false;
+        auto_alg::impl::image_sampling_data sampling_points;
+
+        // mono images
+        auto_alg::impl::resulting_brightness mono_brightness = auto_alg::impl::resulting_brightness::invalid();
+
+        // taken by the debayer stage, used instead of the sampling points
+        bool                                has_channel_statistics = false;
+        auto_alg::channel_statistics        channels;
+        img::rect                           brightness_roi = { 0, 0, 0, 0 };    // in image coordinates, { 0, 0, 0, 0 } for the whole image
+    };
+}
@@ -38,6 +38,16 @@ namespace gst_helper
      */
     std::vector<std::string>         convert_GSList_to_string_vector_consume( GSList* lst );
 
+    /** Scales the "width"/"height" fields of the structure, fixed values, ranges and lists, by numerator / denominator.
+     * Results are clamped to [1, G_MAXINT]. Missing fields are left alone.
+     */
+    void            scale_gst_struct_image_dim( GstStructure& structure, int numerator, int denominator ) noexcept;
+
+    /** Exchanges the "width" and "height" fields of the structure, e.g. for an image that is rotated by 90 degrees.
+     * Nothing is changed when one of the fields is missing.
+     */
+    void            swap_gst_struct_image_dim( GstStructure& structure ) noexcept;
+
 
     inline std::string get_string_entry(GstStructure& struc, const std::string& entry_name)
     {
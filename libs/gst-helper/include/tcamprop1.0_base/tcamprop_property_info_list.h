@@ -40,6 +40,9 @@ namespace tcamprop1::prop_list
     extern const prop_static_info_float ExposureAutoUpperLimit;
     extern const prop_static_info_boolean ExposureAutoUpperLimitAuto;
     extern const prop_static_info_boolean ExposureAutoHighlightReduction;
+    extern const prop_static_info_boolean HDRBracketingEnable;
+    extern const prop_static_info_integer HDRBracketingCount;
+    extern const prop_static_info_float HDRBracketingExposureRatio;
 
     extern const prop_static_info_enumeration BalanceWhiteAuto;
 
@@ -86,6 +89,7 @@ namespace tcamprop1::prop_list
     extern const prop_static_info_integer AutoFunctionsROIWidth;
     extern const prop_static_info_integer AutoFunctionsROITop;
     extern const prop_static_info_integer AutoFunctionsROILeft;
+    extern const prop_static_info_integer AutoFunctionsGroup;
 
     extern const prop_static_info_integer Denoise;
     extern const prop_static_info_integer Sharpness;
@@ -110,6 +114,7 @@ namespace tcamprop1::prop_list
     extern const prop_static_info_float ColorTransformation_Value_Gain20;
     extern const prop_static_info_float ColorTransformation_Value_Gain21;
     extern const prop_static_info_float ColorTransformation_Value_Gain22;
+    extern const prop_static_info_boolean ClaimColorTransformationSoftware;
 
     // GenICam standard property
     extern const prop_static_info_integer SensorWidth;
@@ -23,6 +23,8 @@ namespace tcamprop1_gobj
      * 
      * The gobject must populate a tcamprop1::property_list_interface derived container and then pass this to tcam_property_provider::create_list.
      * Until a list is created, all methods return TCAM_ERROR_NO_DEVICE_OPEN.
+     * The wrapper objects and the list of names are created once per list.
+     * Call invalidate_names when a change (e.g. of the format) may implement or hide properties.
      * Call clear_list to inform all GObjects handed out to mark themselves as 'lost' and to return TCAM_ERROR_DEVICE_LOST.
      * After calling clear_list, the registered tcamprop1::property_list_interface is internally cleared and can be deleted (same goes for the property_interface derived interfaces handed
      * out by the property_list_interface.
@@ -54,6 +56,7 @@ namespace tcamprop1_gobj
 
         void    create_list( tcamprop1::property_list_interface* );
         void    clear_list();
+        void    invalidate_names();
 
         static auto get_tcam_property_names( tcam_property_provider* cont, GError** err ) -> GSList*;
         static auto get_tcam_property( tcam_property_provider* cont, const char* name, GError** err ) -> TcamPropertyBase*;
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <Tcam-1.0.h>
+#include <string_view>
 
 namespace tcamprop1_gobj
 {
@@ -17,4 +18,7 @@ gint64          provider_get_tcam_integer( TcamPropertyProvider* self, const gch
 gdouble         provider_get_tcam_float( TcamPropertyProvider* self, const gchar* name, GError** err );
 const gchar*    provider_get_tcam_enumeration( TcamPropertyProvider* self, const gchar* name, GError** err );
 
+// Emits "tcam-property-changed" with the property name as detail, an empty name is emitted without detail
+void            provider_emit_property_changed( TcamPropertyProvider* self, std::string_view name );
+
 }
\ No newline at end of file
@@ -2,7 +2,9 @@
 #include <gst-helper/gst_gvalue_helper.h>
 #include <gst-helper/gvalue_helper.h>
 
+#include <algorithm>
 #include <cassert>
+#include <limits>
 
 std::vector<std::string> gst_helper::gst_string_list_to_vector( const GValue& gst_list )
 {
@@ -132,3 +134,74 @@ GSList* gst_helper::gst_string_vector_to_GSList( const std::vector<std::string>&
     }
     return ret;
 }
+
+static gint scale_dim_value( gint value, int numerator, int denominator ) noexcept
+{
+    const gint64 res = static_cast<gint64>( value ) * numerator / denominator;
+    return static_cast<gint>( std::clamp<gint64>( res, 1, std::numeric_limits<gint>::max() ) );
+}
+
+static void scale_dim_gvalue( GValue& value, int numerator, int denominator ) noexcept
+{
+    if( G_VALUE_TYPE( &value ) == G_TYPE_INT )
+    {
+        g_value_set_int( &value, scale_dim_value( g_value_get_int( &value ), numerator, denominator ) );
+    }
+    else if( G_VALUE_TYPE( &value ) == GST_TYPE_INT_RANGE )
+    {
+        const auto min = scale_dim_value( gst_value_get_int_range_min( &value ), numerator, denominator );
+        const auto max = scale_dim_value( gst_value_get_int_range_max( &value ), numerator, denominator );
+        gst_value_set_int_range( &value, min, max );
+    }
+    else if( G_VALUE_TYPE( &value ) == GST_TYPE_LIST )
+    {
+        GValue list = G_VALUE_INIT;
+        g_value_init( &list, GST_TYPE_LIST );
+        for( guint i = 0; i < gst_value_list_get_size( &value ); ++i )
+        {
+            const GValue* src_entry = gst_value_list_get_value( &value, i );
+
+            GValue entry = G_VALUE_INIT;
+            g_value_init( &entry, G_VALUE_TYPE( src_entry ) );
+            g_value_copy( src_entry, &entry );
+            scale_dim_gvalue( entry, numerator, denominator );
+            gst_value_list_append_and_take_value( &list, &entry );
+        }
+        g_value_unset( &value );
+        value = list;
+    }
+}
+
+void gst_helper::scale_gst_struct_image_dim( GstStructure& structure, int numerator, int denominator ) noexcept
+{
+    for( const char* name : { "width", "height" } )
+    {
+        const GValue* field = gst_structure_get_value( &structure, name );
+        if( field == nullptr ) {
+            continue;
+        }
+        GValue value = G_VALUE_INIT;
+        g_value_init( &value, G_VALUE_TYPE( field ) );
+        g_value_copy( field, &value );
+
+        scale_dim_gvalue( value, numerator, denominator );
+
+        gst_structure_take_value( &structure, name, &value );
+    }
+}
+
+void gst_helper::swap_gst_struct_image_dim( GstStructure& structure ) noexcept
+{
+    const GValue* width = gst_structure_get_value( &structure, "width" );
+    const GValue* height = gst_structure_get_value( &structure, "height" );
+    if( width == nullptr || height == nullptr ) {
+        return;
+    }
+
+    GValue old_width = G_VALUE_INIT;
+    g_value_init( &old_width, G_VALUE_TYPE( width ) );
+    g_value_copy( width, &old_width );
+
+    gst_structure_set_value( &structure, "width", height );
+    gst_structure_take_value( &structure, "height", &old_width );
+}
@@ -2,6 +2,9 @@
 #include "tcamprop1.0_base/tcamprop_property_info.h"
 #include "tcamprop1.0_base/tcamprop_property_info_list.h"
 
+#include <iterator>
+#include <unordered_map>
+
 namespace lst = tcamprop1::prop_list;
 
 using namespace tcamprop1;
@@ -25,6 +28,9 @@ static const constexpr tcamprop1::prop_static_info_find_result static_prop_list[
     to_( lst::ExposureAutoUpperLimit ),
     to_( lst::ExposureAutoUpperLimitAuto ),
     to_( lst::ExposureAutoHighlightReduction ),
+    to_( lst::HDRBracketingEnable ),
+    to_( lst::HDRBracketingCount ),
+    to_( lst::HDRBracketingExposureRatio ),
     to_( lst::BalanceWhiteAuto ),
     to_( lst::BalanceWhiteMode ),
     to_( lst::BalanceWhiteAutoPreset ),
@@ -64,6 +70,7 @@ static const constexpr tcamprop1::prop_static_info_find_result static_prop_list[
     to_( lst::AutoFunctionsROIWidth ),
     to_( lst::AutoFunctionsROITop ),
     to_( lst::AutoFunctionsROILeft ),
+    to_( lst::AutoFunctionsGroup ),
 
     to_( lst::Denoise ),
     to_( lst::Sharpness ),
@@ -85,6 +92,7 @@ static const constexpr tcamprop1::prop_static_info_find_result static_prop_list[
     to_( lst::ColorTransformation_Value_Gain20 ),
     to_( lst::ColorTransformation_Value_Gain21 ),
     to_( lst::ColorTransformation_Value_Gain22 ),
+    to_( lst::ClaimColorTransformationSoftware ),
     to_( lst::StrobeEnable ),
     to_( lst::StrobePolarity ),
     to_( lst::StrobeOperation ),
@@ -149,10 +157,20 @@ static const constexpr tcamprop1::prop_static_info_find_result static_prop_list[
 
 auto tcamprop1::find_prop_static_info( std::string_view name ) noexcept -> prop_static_info_find_result
 {
-    for( auto&& e : static_prop_list ) {
-        if( e.info_ptr->name == name ) {
-            return e;
+    // this is called for every property of every opened device, so the list is indexed once
+    static const auto index = []
+    {
+        std::unordered_map<std::string_view, prop_static_info_find_result> rval;
+        rval.reserve( std::size( static_prop_list ) );
+        for( auto&& e : static_prop_list ) {
+            rval.emplace( e.info_ptr->name, e );
         }
+        return rval;
+    }();
+
+    auto f = index.find( name );
+    if( f != index.end() ) {
+        return f->second;
     }
     return {};
 }
@@ -69,6 +69,25 @@ const prop_static_info_boolean lst::ExposureAutoHighlightReduction = make_Boolea
     "Lets the ExposureAuto/GainAuto algorithm try to avoid over-exposures."
 );
 
+const prop_static_info_boolean lst::HDRBracketingEnable = make_Boolean(
+    "HDRBracketingEnable",
+    "Exposure", "HDR Bracketing Enable",
+    "Cycles the exposure time through HDRBracketingCount values frame by frame, starting at ExposureTime. tcamconvert merges each bracket into one HDR image.",
+    Visibility_t::Expert
+);
+const prop_static_info_integer lst::HDRBracketingCount = make_Integer(
+    "HDRBracketingCount",
+    "Exposure", "HDR Bracketing Count",
+    "Number of exposures of a bracket.",
+    {}, IntRepresentation_t::Linear, Visibility_t::Expert
+);
+const prop_static_info_float lst::HDRBracketingExposureRatio = make_Float(
+    "HDRBracketingExposureRatio",
+    "Exposure", "HDR Bracketing Exposure Ratio",
+    "Ratio between the exposure times of successive images of a bracket.",
+    {}, FloatRepresentation_t::Linear, Visibility_t::Expert
+);
+
 const prop_static_info_enumeration lst::BalanceWhiteAuto = make_Enumeration(
     "BalanceWhiteAuto",
     "Color", "Auto White Balance",
@@ -263,6 +282,12 @@ const prop_static_info_integer lst::AutoFunctionsROILeft = make_Integer(
     "Auto ROI", "Auto Functions ROI Left",
     "Horizontal offset of the auto functions region of interest."
 );
+const prop_static_info_integer lst::AutoFunctionsGroup = make_Integer(
+    "AutoFunctionsGroup",
+    "Auto ROI", "Auto Functions Group",
+    "Cameras of one process with the same group share the exposure, gain and white balance of the first camera that joined the group. 0 disables grouping.",
+    {}, IntRepresentation_t::Linear, Visibility_t::Expert
+);
 
 const prop_static_info_integer lst::Denoise = make_Integer(
     "Denoise",
@@ -378,6 +403,11 @@ const prop_static_info_float lst::ColorTransformation_Value_Gain22 = make_Float(
     "Changes the color transformation for one factor on a pixel.", Visibility_t::Guru
 );
 
+const prop_static_info_boolean lst::ClaimColorTransformationSoftware = make_Boolean(
+    "ClaimColorTransformationSoftware",
+    "Color Correction", {}, {}, Visibility_t::Invisible
+);
+
 const prop_static_info_integer lst::SensorWidth = make_Integer(
     "SensorWidth",
     "Sensor", "Sensor Width",
@@ -5,7 +5,10 @@
 #include "tcam_propnode_impl.h"
 #include <gst-helper/gvalue_helper.h>
 
+#include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
+#include <vector>
 #include <tcamprop1.0_base/tcamprop_property_interface.h>
 
 static bool is_err( GError** err ) {
@@ -54,9 +57,9 @@ static TcamPropertyBase* tcamprop_impl_create_node( tcamprop1::property_list_int
     return nullptr;
 }
 
-static GSList* tcamprop_impl_fetch_names( tcamprop1::property_list_interface& prop_list_itf )
+static std::vector<std::string> tcamprop_impl_fetch_names( tcamprop1::property_list_interface& prop_list_itf )
 {
-    GSList* names = nullptr;
+    std::vector<std::string> names;
     for( const auto& prop_name : prop_list_itf.get_property_list() )
     {
         auto prop_itf = prop_list_itf.find_property( prop_name );
@@ -80,11 +83,21 @@ static GSList* tcamprop_impl_fetch_names( tcamprop1::property_list_interface& pr
         {
             continue;
         }
-        names = g_slist_append( names, gvalue::g_strdup_string( prop_name ) );
+        names.emplace_back( prop_name );
     }
     return names;
 }
 
+static GSList* tcamprop_impl_to_GSList( const std::vector<std::string>& names )
+{
+    // prepend in reverse, g_slist_append walks the whole list for every entry
+    GSList* rval = nullptr;
+    for( auto it = names.rbegin(); it != names.rend(); ++it ) {
+        rval = g_slist_prepend( rval, gvalue::g_strdup_string( *it ) );
+    }
+    return rval;
+}
+
 namespace tcamprop1_gobj::impl
 {
     class tcam_property_provider_impl_data
@@ -112,12 +125,15 @@ namespace tcamprop1_gobj::impl
                 tcamprop1_gobj::set_gerror( err, tcamprop1::status::device_closed );
                 return nullptr;
             }
-            auto f = flyweight_container_.find( name );
-            if( f != flyweight_container_.end() )
             {
-                auto rval = f->second;
-                g_object_ref( rval );
-                return rval;
+                std::shared_lock items_lck{ items_mtx_ };
+                auto f = flyweight_container_.find( name );
+                if( f != flyweight_container_.end() )
+                {
+                    auto rval = f->second;
+                    g_object_ref( rval );
+                    return rval;
+                }
             }
 
             auto new_node = tcamprop_impl_create_node( *prop_list_itf_, guard_, name, err );
@@ -125,10 +141,15 @@ namespace tcamprop1_gobj::impl
                 return nullptr;
             }
 
-            /*auto [iter,added] =*/ flyweight_container_.emplace( name, new_node );
+            std::lock_guard items_lck{ items_mtx_ };
+            auto [iter, added] = flyweight_container_.emplace( name, new_node );
+            if( !added ) {
+                // another thread created the same node in the meantime
+                g_object_unref( new_node );
+            }
 
-            g_object_ref( new_node );
-            return new_node;
+            g_object_ref( iter->second );
+            return iter->second;
         }
 
         GSList* fetch_names( GError** err )
@@ -138,14 +159,32 @@ namespace tcamprop1_gobj::impl
                 tcamprop1_gobj::set_gerror( err, tcamprop1::status::device_closed );
                 return nullptr;
             }
-            return tcamprop_impl_fetch_names( *prop_list_itf_ );
+
+            std::lock_guard names_lck{ names_mtx_ };
+            if( !names_valid_ )
+            {
+                names_ = tcamprop_impl_fetch_names( *prop_list_itf_ );
+                names_valid_ = true;
+            }
+            return tcamprop_impl_to_GSList( names_ );
         }
 
+        void invalidate_names()
+        {
+            std::lock_guard names_lck{ names_mtx_ };
+            names_valid_ = false;
+        }
 
     private:
         tcamprop1_gobj::impl::guard_state_handle            guard_ = tcamprop1_gobj::impl::create_guard_state_handle();
         tcamprop1::property_list_interface*                 prop_list_itf_ = nullptr;
+        std::shared_mutex                                   items_mtx_;
         std::unordered_map<std::string, TcamPropertyBase*>  flyweight_container_;
+
+        // the visible names only change when the implemented/hidden flags do, see invalidate_names
+        std::mutex                  names_mtx_;
+        std::vector<std::string>    names_;
+        bool                        names_valid_ = false;
     };
 }
 
@@ -170,6 +209,14 @@ void tcamprop1_gobj::tcam_property_provider::clear_list()
     data_ = nullptr;
 }
 
+void tcamprop1_gobj::tcam_property_provider::invalidate_names()
+{
+    std::shared_lock lck0{ data_mtx_ };
+    if( data_ ) {
+        data_->invalidate_names();
+    }
+}
+
 TcamPropertyBase* tcamprop1_gobj::tcam_property_provider::get_tcam_property( tcam_property_provider* cont, const char* name, GError** err )
 {
     if( !cont ) {
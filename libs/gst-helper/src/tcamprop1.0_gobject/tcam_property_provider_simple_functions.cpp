@@ -2,6 +2,7 @@
 #include "../../include/tcamprop1.0_gobject/tcam_property_provider_simple_functions.h"
 #include "../../include/tcamprop1.0_gobject/tcam_gerror.h"
 
+#include <string>
 #include <tcam-property-1.0.h>
 
 void tcamprop1_gobj::provider_set_tcam_boolean( TcamPropertyProvider* self, const gchar* name, gboolean value, GError** err )
@@ -173,3 +174,16 @@ const gchar* tcamprop1_gobj::provider_get_tcam_enumeration( TcamPropertyProvider
     g_object_unref( ptr_base );
     return rval;
 }
+
+void tcamprop1_gobj::provider_emit_property_changed( TcamPropertyProvider* self, std::string_view name )
+{
+    const std::string name_str { name };
+    if( name_str.empty() )
+    {
+        g_signal_emit_by_name( self, "tcam-property-changed", "" );
+        return;
+    }
+
+    const std::string signal_name = "tcam-property-changed::" + name_str;
+    g_signal_emit_by_name( self, signal_name.c_str(), name_str.c_str() );
+}
@@ -0,0 +1,311 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gsttcamframe.h"
+
+#include "../meta/gstmetatcamframe.h"
+#include "../meta/gstmetatcamstatistics.h"
+
+#include <cstring>
+#include <gst/video/video.h>
+
+struct _TcamFrame
+{
+    GstBuffer* buffer;
+    GstMapInfo map;
+
+    TcamFrameLayout layout;
+};
+
+namespace
+{
+
+struct sample_layout
+{
+    guint channels;
+    guint bytes_per_channel;
+};
+
+struct raw_format
+{
+    const char* format;
+    sample_layout layout;
+};
+
+// video/x-raw formats libtcam and tcamconvert produce
+constexpr raw_format raw_formats[] = {
+    { "GRAY8", { 1, 1 } },
+    { "GRAY10", { 1, 2 } },
+    { "GRAY12", { 1, 2 } },
+    { "GRAY16_LE", { 1, 2 } },
+    { "GREYf", { 1, 4 } },
+    { "BGRx", { 4, 1 } },
+    { "BGRA", { 4, 1 } },
+    { "BGR", { 3, 1 } },
+    { "RGBx64", { 4, 2 } },
+    { "BGRfloat", { 3, 4 } },
+    { "YUY2", { 2, 1 } },
+    { "UYVY", { 2, 1 } },
+};
+
+
+// video/x-bayer formats are [pwl-]<pattern><suffix>
+sample_layout get_bayer_layout(const char* format)
+{
+    if (g_str_has_prefix(format, "pwl-"))
+    {
+        format += strlen("pwl-");
+    }
+
+    static const char* patterns[] = { "rggb", "bggr", "gbrg", "grbg" };
+
+    for (const char* pattern : patterns)
+    {
+        if (!g_str_has_prefix(format, pattern))
+        {
+            continue;
+        }
+
+        const char* suffix = format + strlen(pattern);
+
+        if (suffix[0] == '\0')
+        {
+            return { 1, 1 };
+        }
+        if (strcmp(suffix, "f") == 0)
+        {
+            return { 1, 4 };
+        }
+        if (strcmp(suffix, "10") == 0 || strcmp(suffix, "12") == 0 || strcmp(suffix, "16") == 0
+            || strcmp(suffix, "16H12") == 0)
+        {
+            return { 1, 2 };
+        }
+        break;
+    }
+    // packed and polarized formats
+    return { 1, 0 };
+}
+
+
+sample_layout get_sample_layout(const GstStructure& structure, const char* format)
+{
+    if (gst_structure_has_name(&structure, "video/x-bayer"))
+    {
+        return get_bayer_layout(format);
+    }
+
+    for (const auto& entry : raw_formats)
+    {
+        if (strcmp(entry.format, format) == 0)
+        {
+            return entry.layout;
+        }
+    }
+    return { 1, 0 };
+}
+
+
+guint64 get_uint64(const GstStructure& structure, const char* field)
+{
+    guint64 value = 0;
+    if (!gst_structure_get_uint64(&structure, field, &value))
+    {
+        return 0;
+    }
+    return value;
+}
+
+
+guint32 get_uint(const GstStructure& structure, const char* field)
+{
+    guint value = 0;
+    if (!gst_structure_get_uint(&structure, field, &value))
+    {
+        return 0;
+    }
+    return value;
+}
+
+} // namespace
+
+
+TcamFrame* tcam_frame_map(GstBuffer* buffer, const GstCaps* caps)
+{
+    g_return_val_if_fail(GST_IS_BUFFER(buffer), nullptr);
+    g_return_val_if_fail(GST_IS_CAPS(caps), nullptr);
+
+    if (!gst_caps_is_fixed(caps))
+    {
+        return nullptr;
+    }
+
+    const GstStructure* structure = gst_caps_get_structure(caps, 0);
+
+    int width = 0;
+    int height = 0;
+    const char* format = gst_structure_get_string(structure, "format");
+
+    if (!gst_structure_get_int(structure, "width", &width)
+        || !gst_structure_get_int(structure, "height", &height) || !format || width <= 0
+        || height <= 0)
+    {
+        return nullptr;
+    }
+
+    auto frame = g_new0(TcamFrame, 1);
+
+    if (!gst_buffer_map(buffer, &frame->map, GST_MAP_READ))
+    {
+        g_free(frame);
+        return nullptr;
+    }
+    frame->buffer = gst_buffer_ref(buffer);
+
+    auto layout = get_sample_layout(*structure, format);
+
+    TcamFrameLayout& out = frame->layout;
+
+    out.data = frame->map.data;
+    out.size = frame->map.size;
+    out.width = width;
+    out.height = height;
+    out.channels = layout.channels;
+    out.bytes_per_channel = layout.bytes_per_channel;
+    g_strlcpy(out.format, format, sizeof(out.format));
+
+    // tcammainsrc buffers have no padding, other elements may describe theirs in a GstVideoMeta
+    if (auto video_meta = gst_buffer_get_video_meta(buffer))
+    {
+        out.data += video_meta->offset[0];
+        out.size -= video_meta->offset[0];
+        out.stride = video_meta->stride[0];
+    }
+    else if (layout.bytes_per_channel != 0)
+    {
+        out.stride = (gsize)width * layout.channels * layout.bytes_per_channel;
+    }
+    else
+    {
+        out.stride = out.size / height;
+    }
+
+    // never describe more lines than there is data
+    if (layout.bytes_per_channel != 0
+        && (out.stride < (gsize)width * layout.channels * layout.bytes_per_channel
+            || out.stride * (height - 1) + (gsize)width * layout.channels * layout.bytes_per_channel
+                   > out.size))
+    {
+        tcam_frame_unmap(frame);
+        return nullptr;
+    }
+
+    return frame;
+}
+
+
+const TcamFrameLayout* tcam_frame_get_layout(const TcamFrame* frame)
+{
+    g_return_val_if_fail(frame, nullptr);
+
+    return &frame->layout;
+}
+
+
+void tcam_frame_unmap(TcamFrame* frame)
+{
+    if (!frame)
+    {
+        return;
+    }
+
+    gst_buffer_unmap(frame->buffer, &frame->map);
+    gst_buffer_unref(frame->buffer);
+    g_free(frame);
+}
+
+
+gboolean tcam_frame_get_statistics(GstBuffer* buffer, TcamFrameStatistics* statistics)
+{
+    g_return_val_if_fail(GST_IS_BUFFER(buffer), FALSE);
+    g_return_val_if_fail(statistics, FALSE);
+
+    TcamFrameMetaData data;
+    if (tcam_frame_meta_get_data(buffer, &data, sizeof(data)))
+    {
+        *statistics = {};
+
+        statistics->frame_count = data.frame_count;
+        statistics->frames_dropped = data.frames_dropped;
+        statistics->capture_time_ns = data.capture_time_ns;
+        statistics->camera_time_ns = data.camera_time_ns;
+
+        statistics->resent_packets = data.resent_packets;
+        statistics->missing_packets = data.missing_packets;
+        statistics->underruns = data.underruns;
+        statistics->receive_duration_ns = data.receive_duration_ns;
+
+        statistics->trigger_issue_time_ns = data.trigger_issue_time_ns;
+        statistics->trigger_arrival_time_ns = data.trigger_arrival_time_ns;
+
+        statistics->parameter_set_id = data.parameter_set_id;
+        statistics->roi_id = data.roi_id;
+        statistics->roi_offset_x = data.roi_offset_x;
+        statistics->roi_offset_y = data.roi_offset_y;
+
+        statistics->is_damaged = data.is_damaged;
+
+        return TRUE;
+    }
+
+    // elements that only add the GstStructure based meta
+    auto meta = gst_buffer_get_tcam_statistics_meta(buffer);
+
+    if (!meta || !meta->structure)
+    {
+        return FALSE;
+    }
+
+    const GstStructure& struc = *meta->structure;
+
+    *statistics = {};
+
+    statistics->frame_count = get_uint64(struc, "frame_count");
+    statistics->frames_dropped = get_uint64(struc, "frames_dropped");
+    statistics->capture_time_ns = get_uint64(struc, "capture_time_ns");
+    statistics->camera_time_ns = get_uint64(struc, "camera_time_ns");
+
+    statistics->resent_packets = get_uint64(struc, "resent_packets");
+    statistics->missing_packets = get_uint64(struc, "missing_packets");
+    statistics->underruns = get_uint64(struc, "underruns");
+    statistics->receive_duration_ns = get_uint64(struc, "receive_duration_ns");
+
+    statistics->trigger_issue_time_ns = get_uint64(struc, "trigger_issue_time_ns");
+    statistics->trigger_arrival_time_ns = get_uint64(struc, "trigger_arrival_time_ns");
+
+    statistics->parameter_set_id = get_uint(struc, "parameter_set_id");
+    statistics->roi_id = get_uint(struc, "roi_id");
+    statistics->roi_offset_x = get_uint(struc, "roi_offset_x");
+    statistics->roi_offset_y = get_uint(struc, "roi_offset_y");
+
+    gboolean is_damaged = FALSE;
+    if (gst_structure_get_boolean(&struc, "is_damaged", &is_damaged))
+    {
+        statistics->is_damaged = is_damaged;
+    }
+
+    return TRUE;
+}
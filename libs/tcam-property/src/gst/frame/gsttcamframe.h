@@ -0,0 +1,119 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GST_TCAM_FRAME_H
+#define GST_TCAM_FRAME_H
+
+
+#include <gst/gst.h>
+
+_Pragma("GCC visibility push (default)")
+
+#if __cplusplus
+extern "C" {
+#endif
+
+G_BEGIN_DECLS
+
+/*
+ * Plain structs for language bindings that want the image data and the statistics of
+ * a GstBuffer without copies or GstStructure parsing, e.g. python via ctypes and numpy.
+ * The layout of both structs is part of the ABI and only grows at the end.
+ */
+
+#define TCAM_FRAME_FORMAT_LENGTH 32
+
+typedef struct _TcamFrameLayout TcamFrameLayout;
+
+struct _TcamFrameLayout
+{
+    // start of the first line, valid until tcam_frame_unmap
+    guint8* data;
+    gsize size;
+
+    guint width;
+    guint height;
+
+    // bytes per line, may be larger than width * channels * bytes_per_channel
+    gsize stride;
+
+    // 1 for mono and bayer formats, 2 for YUY2/UYVY, 3 for BGR, 4 for BGRx/BGRA
+    guint channels;
+    // 1 or 2 for integer samples in native endian, 4 for float formats (e.g. GREYf)
+    // 0 for packed and planar formats (e.g. rggb12p, I420), the first plane is then height lines
+    // of stride bytes
+    guint bytes_per_channel;
+
+    // GstStructure format field, e.g. "GRAY16_LE" or "rggb"
+    gchar format[TCAM_FRAME_FORMAT_LENGTH];
+};
+
+typedef struct _TcamFrame TcamFrame;
+
+/**
+ * Maps buffer for reading.
+ * The frame keeps a reference to buffer until tcam_frame_unmap is called.
+ * @return NULL when caps are not fixed video caps or buffer cannot be mapped
+ */
+TcamFrame* tcam_frame_map(GstBuffer* buffer, const GstCaps* caps);
+
+const TcamFrameLayout* tcam_frame_get_layout(const TcamFrame* frame);
+
+void tcam_frame_unmap(TcamFrame* frame);
+
+
+typedef struct _TcamFrameStatistics TcamFrameStatistics;
+
+// See tcam::tcam_stream_statistics, fields that are not present in the meta are 0
+struct _TcamFrameStatistics
+{
+    guint64 frame_count;
+    guint64 frames_dropped;
+    guint64 capture_time_ns;
+    guint64 camera_time_ns;
+
+    guint64 resent_packets;
+    guint64 missing_packets;
+    guint64 underruns;
+    guint64 receive_duration_ns;
+
+    guint64 trigger_issue_time_ns;
+    guint64 trigger_arrival_time_ns;
+
+    guint32 parameter_set_id;
+    guint32 roi_id;
+    guint32 roi_offset_x;
+    guint32 roi_offset_y;
+
+    gboolean is_damaged;
+};
+
+/**
+ * Fills statistics from the TcamFrameMeta of buffer, or the TcamStatisticsMeta when it has none.
+ * @return FALSE when buffer has neither meta
+ */
+gboolean tcam_frame_get_statistics(GstBuffer* buffer, TcamFrameStatistics* statistics);
+
+G_END_DECLS
+
+#if __cplusplus
+} // extern "C"
+#endif
+
+_Pragma("GCC visibility pop")
+
+#endif /* GST_TCAM_FRAME_H */
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gstmetatcamframe.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+GType tcam_frame_meta_api_get_type(void)
+{
+    static GType type;
+    static const gchar* tags[] = { NULL };
+
+    if (g_once_init_enter(&type))
+    {
+        GType _type = gst_meta_api_type_register("TcamFrameMetaApi", tags);
+        g_once_init_leave(&type, _type);
+    }
+    return type;
+}
+
+
+static gboolean tcam_frame_meta_init(GstMeta* meta,
+                                     gpointer /* params */,
+                                     GstBuffer* /* buffer */)
+{
+    TcamFrameMeta* tcam = (TcamFrameMeta*)meta;
+
+    tcam->version = TCAM_FRAME_META_VERSION;
+    memset(&tcam->data, 0, sizeof(tcam->data));
+
+    return TRUE;
+}
+
+
+static gboolean tcam_frame_meta_transform(GstBuffer* trans_buffer,
+                                          GstMeta* meta,
+                                          GstBuffer* /* buffer */,
+                                          GQuark type,
+                                          gpointer /* data */)
+{
+    g_return_val_if_fail(GST_IS_BUFFER(trans_buffer), FALSE);
+
+    TcamFrameMeta* tcam = (TcamFrameMeta*)meta;
+
+    if (GST_META_TRANSFORM_IS_COPY(type))
+    {
+        TcamFrameMeta* trans_tcam =
+            (TcamFrameMeta*)gst_buffer_add_meta(trans_buffer, TCAM_FRAME_META_INFO, nullptr);
+
+        if (!trans_tcam)
+        {
+            return FALSE;
+        }
+
+        trans_tcam->version = tcam->version;
+        trans_tcam->data = tcam->data;
+    }
+    return TRUE;
+}
+
+
+const GstMetaInfo* tcam_frame_meta_get_info(void)
+{
+    static const GstMetaInfo* meta_info = nullptr;
+
+    if (g_once_init_enter(&meta_info))
+    {
+        const GstMetaInfo* mi = gst_meta_register(TCAM_FRAME_META_API_TYPE,
+                                                  "TcamFrameMeta",
+                                                  sizeof(TcamFrameMeta),
+                                                  tcam_frame_meta_init,
+                                                  nullptr,
+                                                  tcam_frame_meta_transform);
+        g_once_init_leave(&meta_info, mi);
+    }
+
+    return meta_info;
+}
+
+
+TcamFrameMeta* gst_buffer_add_tcam_frame_meta(GstBuffer* buffer)
+{
+    g_return_val_if_fail(GST_IS_BUFFER(buffer), nullptr);
+
+    return (TcamFrameMeta*)gst_buffer_add_meta(buffer, TCAM_FRAME_META_INFO, nullptr);
+}
+
+
+// bytes of TcamFrameMetaData that are valid for a producer of version
+static gsize get_data_size(guint32 version)
+{
+    if (version < 1)
+    {
+        return 0;
+    }
+    if (version == 1)
+    {
+        return offsetof(TcamFrameMetaData, push_delay_ns);
+    }
+    if (version == 2)
+    {
+        return offsetof(TcamFrameMetaData, missing_lines);
+    }
+    return sizeof(TcamFrameMetaData);
+}
+
+
+gboolean tcam_frame_meta_get_data(GstBuffer* buffer, TcamFrameMetaData* data, gsize data_size)
+{
+    if (!buffer || !data)
+    {
+        return FALSE;
+    }
+
+    const TcamFrameMeta* meta = gst_buffer_get_tcam_frame_meta(buffer);
+    if (!meta)
+    {
+        return FALSE;
+    }
+
+    const gsize valid = std::min(data_size, get_data_size(meta->version));
+
+    memcpy(data, &meta->data, valid);
+    memset(reinterpret_cast<guint8*>(data) + valid, 0, data_size - valid);
+
+    return TRUE;
+}
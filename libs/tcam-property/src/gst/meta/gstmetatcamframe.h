@@ -0,0 +1,148 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GST_META_TCAM_FRAME_H
+#define GST_META_TCAM_FRAME_H
+
+
+#include <gst/gst.h>
+
+_Pragma("GCC visibility push (default)")
+
+#if __cplusplus
+extern "C" {
+#endif
+
+G_BEGIN_DECLS
+
+/*
+ * Fixed layout variant of the TcamStatisticsMeta.
+ * The values are written and read as plain struct members, without GstStructure field lookups.
+ * New fields are only appended, version is incremented with every addition.
+ */
+
+#define TCAM_FRAME_META_VERSION 3
+
+// bits of TcamFrameMetaData.chunk_flags, set for the chunks the camera sent
+#define TCAM_FRAME_META_CHUNK_EXPOSURE_TIME (1u << 0)
+#define TCAM_FRAME_META_CHUNK_GAIN (1u << 1)
+#define TCAM_FRAME_META_CHUNK_FRAME_ID (1u << 2)
+
+// size of TcamFrameMetaData.missing_line_ranges, in ranges
+#define TCAM_FRAME_META_MAX_MISSING_LINE_RANGES 8
+
+typedef struct _TcamFrameMetaData TcamFrameMetaData;
+
+// See tcam::tcam_stream_statistics, the fields have the same names as in the TcamStatisticsMeta
+struct _TcamFrameMetaData
+{
+    guint64 frame_count;
+    guint64 frames_dropped;
+    guint64 capture_time_ns;
+    guint64 camera_time_ns;
+
+    // transport counters, totals since the stream was started
+    guint64 resent_packets;
+    guint64 missing_packets;
+    guint64 underruns;
+    guint64 receive_duration_ns;
+
+    // 0 for images that do not answer a software trigger
+    guint64 trigger_issue_time_ns;
+    guint64 trigger_arrival_time_ns;
+
+    // 0 when the camera clock is not synchronized by PTP
+    guint64 ptp_time_ns;
+
+    guint32 parameter_set_id;
+    guint32 roi_id;
+    guint32 roi_offset_x;
+    guint32 roi_offset_y;
+
+    // hdr_bracket_count is 0 for images that do not belong to an exposure bracket
+    guint32 hdr_bracket_index;
+    guint32 hdr_bracket_count;
+    gdouble hdr_exposure_time;
+
+    gboolean is_damaged;
+
+    // chunk-data=true, see TCAM_FRAME_META_CHUNK_*
+    guint32 chunk_flags;
+    gdouble chunk_exposure_time;
+    gdouble chunk_gain;
+    guint64 chunk_frame_id;
+
+    // CLOCK_MONOTONIC stage times, 0 while TCAM_STAGE_TIMING is not enabled
+    guint32 stream_id;
+    guint64 stage_backend_dequeue_ns;
+    guint64 stage_push_image_enter_ns;
+    guint64 stage_push_image_exit_ns;
+    guint64 stage_pool_callback_ns;
+    guint64 stage_create_return_ns;
+
+    // version 2
+    // time the image waited in tcamsrc before it was pushed, e.g. during a burst
+    guint64 push_delay_ns;
+
+    // version 3
+    // lines of a damaged image that were not received, 0 when they are unknown
+    guint32 missing_lines;
+    // missing_line_ranges holds this many pairs of first line and line count, sorted by line
+    guint32 missing_line_range_count;
+    guint32 missing_line_ranges[TCAM_FRAME_META_MAX_MISSING_LINE_RANGES * 2];
+};
+
+typedef struct _GstMetaTcamFrame TcamFrameMeta;
+
+struct _GstMetaTcamFrame
+{
+    GstMeta meta;
+
+    // TCAM_FRAME_META_VERSION of the element that added the meta
+    guint32 version;
+    TcamFrameMetaData data;
+};
+
+GType tcam_frame_meta_api_get_type(void);
+#define TCAM_FRAME_META_API_TYPE (tcam_frame_meta_api_get_type())
+
+#define gst_buffer_get_tcam_frame_meta(b) \
+    ((TcamFrameMeta*)gst_buffer_get_meta((b), TCAM_FRAME_META_API_TYPE))
+
+const GstMetaInfo* tcam_frame_meta_get_info(void);
+#define TCAM_FRAME_META_INFO (tcam_frame_meta_get_info())
+
+// Adds a zeroed meta
+TcamFrameMeta* gst_buffer_add_tcam_frame_meta(GstBuffer* buffer);
+
+/**
+ * Copies the TcamFrameMeta of buffer into data.
+ * data_size is sizeof(TcamFrameMetaData) of the caller, fields the producer did not know are 0,
+ * so applications keep working with older and newer versions of this library.
+ * @return FALSE when buffer has no TcamFrameMeta
+ */
+gboolean tcam_frame_meta_get_data(GstBuffer* buffer, TcamFrameMetaData* data, gsize data_size);
+
+G_END_DECLS
+
+#if __cplusplus
+} // extern "C"
+#endif
+
+_Pragma("GCC visibility pop")
+
+#endif /* GST_META_TCAM_FRAME_H */
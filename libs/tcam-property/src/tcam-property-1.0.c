@@ -808,8 +808,29 @@ void tcam_property_string_set_value(TcamPropertyString* self, const char* value,
 
 G_DEFINE_INTERFACE( TcamPropertyProvider, tcam_property_provider, G_TYPE_OBJECT )
 
-static void tcam_property_provider_default_init( __attribute__( (unused) )TcamPropertyProviderInterface* klass )
-{}
+static void tcam_property_provider_default_init( TcamPropertyProviderInterface* klass )
+{
+    /**
+     * TcamPropertyProvider::tcam-property-changed:
+     * @self: the #TcamPropertyProvider
+     * @name: (type utf8): name of the property that changed or an empty string when any property may have changed
+     *
+     * Emitted when the value, range or flags of a property changed, e.g. because an auto algorithm wrote it.
+     * The property name is used as the signal detail, so "tcam-property-changed::ExposureTime" only
+     * receives changes of ExposureTime and the empty name.
+     * May be emitted from any thread.
+     */
+    g_signal_new( "tcam-property-changed",
+                  G_TYPE_FROM_INTERFACE( klass ),
+                  G_SIGNAL_RUN_LAST | G_SIGNAL_DETAILED,
+                  0,
+                  NULL,
+                  NULL,
+                  NULL,
+                  G_TYPE_NONE,
+                  1,
+                  G_TYPE_STRING );
+}
 
 /**
  * tcam_property_provider_get_tcam_property_names:
@@ -1053,4 +1074,486 @@ const gchar* tcam_property_provider_get_tcam_enumeration( TcamPropertyProvider*
         rval = iface->get_tcam_enumeration( self, name, err );
     }
     return rval;
-}
\ No newline at end of file
+}
+ //---------------------------------
+ // Asynchronous provider operations
+
+/*
+ * Every provider gets one worker thread that executes the queued operations in order.
+ * Callers do not block on device round trips and the device still sees the writes in
+ * the order they were issued.
+ */
+
+#define TCAM_PROPERTY_ASYNC_WORKER_KEY "tcam-property-async-worker"
+
+typedef enum
+{
+    TCAM_ASYNC_SET_BOOLEAN,
+    TCAM_ASYNC_SET_INTEGER,
+    TCAM_ASYNC_SET_FLOAT,
+    TCAM_ASYNC_SET_ENUMERATION,
+    TCAM_ASYNC_SET_COMMAND,
+    TCAM_ASYNC_GET_BOOLEAN,
+    TCAM_ASYNC_GET_INTEGER,
+    TCAM_ASYNC_GET_FLOAT,
+    TCAM_ASYNC_GET_ENUMERATION,
+} TcamAsyncOperation;
+
+typedef struct
+{
+    TcamAsyncOperation  op;
+    gchar*              name;
+
+    gboolean            bool_value;
+    gint64              int_value;
+    gdouble             float_value;
+    gchar*              str_value;
+} TcamAsyncData;
+
+static GMutex tcam_async_worker_mutex;
+
+static void tcam_async_data_free( gpointer ptr )
+{
+    TcamAsyncData* data = ptr;
+    g_free( data->name );
+    g_free( data->str_value );
+    g_free( data );
+}
+
+static TcamAsyncData* tcam_async_data_new( TcamAsyncOperation op, const gchar* name )
+{
+    TcamAsyncData* data = g_new0( TcamAsyncData, 1 );
+    data->op = op;
+    data->name = g_strdup( name );
+    return data;
+}
+
+static void tcam_async_worker_func( gpointer task_ptr, __attribute__ ((unused)) gpointer user_data )
+{
+    GTask* task = G_TASK( task_ptr );
+
+    if( g_task_return_error_if_cancelled( task ) )
+    {
+        g_object_unref( task );
+        return;
+    }
+
+    TcamPropertyProvider* self = TCAM_PROPERTY_PROVIDER( g_task_get_source_object( task ) );
+    TcamAsyncData* data = g_task_get_task_data( task );
+
+    GError* err = NULL;
+    switch( data->op )
+    {
+        case TCAM_ASYNC_SET_BOOLEAN:
+            tcam_property_provider_set_tcam_boolean( self, data->name, data->bool_value, &err );
+            break;
+        case TCAM_ASYNC_SET_INTEGER:
+            tcam_property_provider_set_tcam_integer( self, data->name, data->int_value, &err );
+            break;
+        case TCAM_ASYNC_SET_FLOAT:
+            tcam_property_provider_set_tcam_float( self, data->name, data->float_value, &err );
+            break;
+        case TCAM_ASYNC_SET_ENUMERATION:
+            tcam_property_provider_set_tcam_enumeration( self, data->name, data->str_value, &err );
+            break;
+        case TCAM_ASYNC_SET_COMMAND:
+            tcam_property_provider_set_tcam_command( self, data->name, &err );
+            break;
+        case TCAM_ASYNC_GET_BOOLEAN:
+            data->bool_value = tcam_property_provider_get_tcam_boolean( self, data->name, &err );
+            break;
+        case TCAM_ASYNC_GET_INTEGER:
+            data->int_value = tcam_property_provider_get_tcam_integer( self, data->name, &err );
+            break;
+        case TCAM_ASYNC_GET_FLOAT:
+            data->float_value = tcam_property_provider_get_tcam_float( self, data->name, &err );
+            break;
+        case TCAM_ASYNC_GET_ENUMERATION:
+        {
+            const gchar* value = tcam_property_provider_get_tcam_enumeration( self, data->name, &err );
+            data->str_value = g_strdup( value );
+            break;
+        }
+    }
+
+    if( err )
+    {
+        g_task_return_error( task, err );
+    }
+    else
+    {
+        g_task_return_boolean( task, TRUE );
+    }
+    g_object_unref( task );
+}
+
+static void tcam_async_worker_free( gpointer pool )
+{
+    // the queue is empty, queued tasks keep a reference to the provider
+    g_thread_pool_free( pool, FALSE, FALSE );
+}
+
+static GThreadPool* tcam_async_get_worker( TcamPropertyProvider* self )
+{
+    g_mutex_lock( &tcam_async_worker_mutex );
+
+    GThreadPool* pool = g_object_get_data( G_OBJECT( self ), TCAM_PROPERTY_ASYNC_WORKER_KEY );
+    if( pool == NULL )
+    {
+        pool = g_thread_pool_new( tcam_async_worker_func, NULL, 1, FALSE, NULL );
+        g_object_set_data_full( G_OBJECT( self ), TCAM_PROPERTY_ASYNC_WORKER_KEY, pool, tcam_async_worker_free );
+    }
+
+    g_mutex_unlock( &tcam_async_worker_mutex );
+    return pool;
+}
+
+static void tcam_async_queue( TcamPropertyProvider* self, TcamAsyncData* data, gpointer source_tag,
+                              GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data )
+{
+    GTask* task = g_task_new( self, cancellable, callback, user_data );
+    g_task_set_source_tag( task, source_tag );
+    g_task_set_task_data( task, data, tcam_async_data_free );
+
+    g_thread_pool_push( tcam_async_get_worker( self ), task, NULL );
+}
+
+static TcamAsyncData* tcam_async_finish( TcamPropertyProvider* self, GAsyncResult* result, gpointer source_tag, GError** err )
+{
+    g_return_val_if_fail( g_task_is_valid( result, self ), NULL );
+    g_return_val_if_fail( g_task_get_source_tag( G_TASK( result ) ) == source_tag, NULL );
+
+    if( !g_task_propagate_boolean( G_TASK( result ), err ) )
+    {
+        return NULL;
+    }
+    return g_task_get_task_data( G_TASK( result ) );
+}
+
+/**
+ * tcam_property_provider_set_tcam_boolean_async:
+ * @self: a #TcamPropertyProvider
+ * @name: (not nullable): name of the property on which the value should be set
+ * @value: New value for the property
+ * @cancellable: (nullable): a #GCancellable, cancelled operations that did not start yet are not executed
+ * @callback: (scope async): called in the thread-default main context of the caller when the operation finished
+ * @user_data: (closure): data passed to @callback
+ *
+ * Queues tcam_property_provider_set_tcam_boolean() to the worker thread of @self.
+ * The operations of one provider are executed in the order they were queued.
+ */
+void        tcam_property_provider_set_tcam_boolean_async( TcamPropertyProvider* self, const gchar* name, gboolean value,
+                                                           GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data )
+{
+    g_return_if_fail( self != NULL );
+    g_return_if_fail( name != NULL );
+    g_return_if_fail( TCAM_IS_PROPERTY_PROVIDER( self ) );
+
+    TcamAsyncData* data = tcam_async_data_new( TCAM_ASYNC_SET_BOOLEAN, name );
+    data->bool_value = value;
+    tcam_async_queue( self, data, tcam_property_provider_set_tcam_boolean_async, cancellable, callback, user_data );
+}
+
+/**
+ * tcam_property_provider_set_tcam_boolean_finish:
+ * @self: a #TcamPropertyProvider
+ * @result: the #GAsyncResult passed to the callback
+ * @err: return location for a GError, or NULL
+ *
+ * Returns: TRUE if the value was set
+ */
+gboolean    tcam_property_provider_set_tcam_boolean_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err )
+{
+    return tcam_async_finish( self, result, tcam_property_provider_set_tcam_boolean_async, err ) != NULL;
+}
+
+/**
+ * tcam_property_provider_set_tcam_integer_async:
+ * @self: a #TcamPropertyProvider
+ * @name: (not nullable): name of the property on which the value should be set
+ * @value: New value for the property
+ * @cancellable: (nullable): a #GCancellable, cancelled operations that did not start yet are not executed
+ * @callback: (scope async): called in the thread-default main context of the caller when the operation finished
+ * @user_data: (closure): data passed to @callback
+ *
+ * Queues tcam_property_provider_set_tcam_integer() to the worker thread of @self.
+ * The operations of one provider are executed in the order they were queued.
+ */
+void        tcam_property_provider_set_tcam_integer_async( TcamPropertyProvider* self, const gchar* name, gint64 value,
+                                                           GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data )
+{
+    g_return_if_fail( self != NULL );
+    g_return_if_fail( name != NULL );
+    g_return_if_fail( TCAM_IS_PROPERTY_PROVIDER( self ) );
+
+    TcamAsyncData* data = tcam_async_data_new( TCAM_ASYNC_SET_INTEGER, name );
+    data->int_value = value;
+    tcam_async_queue( self, data, tcam_property_provider_set_tcam_integer_async, cancellable, callback, user_data );
+}
+
+/**
+ * tcam_property_provider_set_tcam_integer_finish:
+ * @self: a #TcamPropertyProvider
+ * @result: the #GAsyncResult passed to the callback
+ * @err: return location for a GError, or NULL
+ *
+ * Returns: TRUE if the value was set
+ */
+gboolean    tcam_property_provider_set_tcam_integer_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err )
+{
+    return tcam_async_finish( self, result, tcam_property_provider_set_tcam_integer_async, err ) != NULL;
+}
+
+/**
+ * tcam_property_provider_set_tcam_float_async:
+ * @self: a #TcamPropertyProvider
+ * @name: (not nullable): name of the property on which the value should be set
+ * @value: New value for the property
+ * @cancellable: (nullable): a #GCancellable, cancelled operations that did not start yet are not executed
+ * @callback: (scope async): called in the thread-default main context of the caller when the operation finished
+ * @user_data: (closure): data passed to @callback
+ *
+ * Queues tcam_property_provider_set_tcam_float() to the worker thread of @self.
+ * The operations of one provider are executed in the order they were queued.
+ */
+void        tcam_property_provider_set_tcam_float_async( TcamPropertyProvider* self, const gchar* name, gdouble value,
+                                                         GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data )
+{
+    g_return_if_fail( self != NULL );
+    g_return_if_fail( name != NULL );
+    g_return_if_fail( TCAM_IS_PROPERTY_PROVIDER( self ) );
+
+    TcamAsyncData* data = tcam_async_data_new( TCAM_ASYNC_SET_FLOAT, name );
+    data->float_value = value;
+    tcam_async_queue( self, data, tcam_property_provider_set_tcam_float_async, cancellable, callback, user_data );
+}
+
+/**
+ * tcam_property_provider_set_tcam_float_finish:
+ * @self: a #TcamPropertyProvider
+ * @result: the #GAsyncResult passed to the callback
+ * @err: return location for a GError, or NULL
+ *
+ * Returns: TRUE if the value was set
+ */
+gboolean    tcam_property_provider_set_tcam_float_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err )
+{
+    return tcam_async_finish( self, result, tcam_property_provider_set_tcam_float_async, err ) != NULL;
+}
+
+/**
+ * tcam_property_provider_set_tcam_enumeration_async:
+ * @self: a #TcamPropertyProvider
+ * @name: (not nullable): name of the property on which the value should be set
+ * @value: (not nullable): New value for the property
+ * @cancellable: (nullable): a #GCancellable, cancelled operations that did not start yet are not executed
+ * @callback: (scope async): called in the thread-default main context of the caller when the operation finished
+ * @user_data: (closure): data passed to @callback
+ *
+ * Queues tcam_property_provider_set_tcam_enumeration() to the worker thread of @self.
+ * The operations of one provider are executed in the order they were queued.
+ */
+void        tcam_property_provider_set_tcam_enumeration_async( TcamPropertyProvider* self, const gchar* name, const gchar* value,
+                                                               GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data )
+{
+    g_return_if_fail( self != NULL );
+    g_return_if_fail( name != NULL );
+    g_return_if_fail( value != NULL );
+    g_return_if_fail( TCAM_IS_PROPERTY_PROVIDER( self ) );
+
+    TcamAsyncData* data = tcam_async_data_new( TCAM_ASYNC_SET_ENUMERATION, name );
+    data->str_value = g_strdup( value );
+    tcam_async_queue( self, data, tcam_property_provider_set_tcam_enumeration_async, cancellable, callback, user_data );
+}
+
+/**
+ * tcam_property_provider_set_tcam_enumeration_finish:
+ * @self: a #TcamPropertyProvider
+ * @result: the #GAsyncResult passed to the callback
+ * @err: return location for a GError, or NULL
+ *
+ * Returns: TRUE if the value was set
+ */
+gboolean    tcam_property_provider_set_tcam_enumeration_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err )
+{
+    return tcam_async_finish( self, result, tcam_property_provider_set_tcam_enumeration_async, err ) != NULL;
+}
+
+/**
+ * tcam_property_provider_set_tcam_command_async:
+ * @self: a #TcamPropertyProvider
+ * @name: (not nullable): name of the property on where set_command should be called
+ * @cancellable: (nullable): a #GCancellable, cancelled operations that did not start yet are not executed
+ * @callback: (scope async): called in the thread-default main context of the caller when the operation finished
+ * @user_data: (closure): data passed to @callback
+ *
+ * Queues tcam_property_provider_set_tcam_command() to the worker thread of @self.
+ * The operations of one provider are executed in the order they were queued.
+ */
+void        tcam_property_provider_set_tcam_command_async( TcamPropertyProvider* self, const gchar* name,
+                                                           GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data )
+{
+    g_return_if_fail( self != NULL );
+    g_return_if_fail( name != NULL );
+    g_return_if_fail( TCAM_IS_PROPERTY_PROVIDER( self ) );
+
+    TcamAsyncData* data = tcam_async_data_new( TCAM_ASYNC_SET_COMMAND, name );
+    tcam_async_queue( self, data, tcam_property_provider_set_tcam_command_async, cancellable, callback, user_data );
+}
+
+/**
+ * tcam_property_provider_set_tcam_command_finish:
+ * @self: a #TcamPropertyProvider
+ * @result: the #GAsyncResult passed to the callback
+ * @err: return location for a GError, or NULL
+ *
+ * Returns: TRUE if the command was executed
+ */
+gboolean    tcam_property_provider_set_tcam_command_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err )
+{
+    return tcam_async_finish( self, result, tcam_property_provider_set_tcam_command_async, err ) != NULL;
+}
+
+/**
+ * tcam_property_provider_get_tcam_boolean_async:
+ * @self: a #TcamPropertyProvider
+ * @name: (not nullable): name of the property whose value will be returned.
+ * @cancellable: (nullable): a #GCancellable, cancelled operations that did not start yet are not executed
+ * @callback: (scope async): called in the thread-default main context of the caller when the operation finished
+ * @user_data: (closure): data passed to @callback
+ *
+ * Queues tcam_property_provider_get_tcam_boolean() to the worker thread of @self.
+ * The operations of one provider are executed in the order they were queued.
+ */
+void        tcam_property_provider_get_tcam_boolean_async( TcamPropertyProvider* self, const gchar* name,
+                                                           GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data )
+{
+    g_return_if_fail( self != NULL );
+    g_return_if_fail( name != NULL );
+    g_return_if_fail( TCAM_IS_PROPERTY_PROVIDER( self ) );
+
+    TcamAsyncData* data = tcam_async_data_new( TCAM_ASYNC_GET_BOOLEAN, name );
+    tcam_async_queue( self, data, tcam_property_provider_get_tcam_boolean_async, cancellable, callback, user_data );
+}
+
+/**
+ * tcam_property_provider_get_tcam_boolean_finish:
+ * @self: a #TcamPropertyProvider
+ * @result: the #GAsyncResult passed to the callback
+ * @err: return location for a GError, or NULL
+ *
+ * Returns: Returns the value of the property.
+ */
+gboolean    tcam_property_provider_get_tcam_boolean_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err )
+{
+    TcamAsyncData* data = tcam_async_finish( self, result, tcam_property_provider_get_tcam_boolean_async, err );
+    return data ? data->bool_value : FALSE;
+}
+
+/**
+ * tcam_property_provider_get_tcam_integer_async:
+ * @self: a #TcamPropertyProvider
+ * @name: (not nullable): name of the property whose value will be returned.
+ * @cancellable: (nullable): a #GCancellable, cancelled operations that did not start yet are not executed
+ * @callback: (scope async): called in the thread-default main context of the caller when the operation finished
+ * @user_data: (closure): data passed to @callback
+ *
+ * Queues tcam_property_provider_get_tcam_integer() to the worker thread of @self.
+ * The operations of one provider are executed in the order they were queued.
+ */
+void        tcam_property_provider_get_tcam_integer_async( TcamPropertyProvider* self, const gchar* name,
+                                                           GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data )
+{
+    g_return_if_fail( self != NULL );
+    g_return_if_fail( name != NULL );
+    g_return_if_fail( TCAM_IS_PROPERTY_PROVIDER( self ) );
+
+    TcamAsyncData* data = tcam_async_data_new( TCAM_ASYNC_GET_INTEGER, name );
+    tcam_async_queue( self, data, tcam_property_provider_get_tcam_integer_async, cancellable, callback, user_data );
+}
+
+/**
+ * tcam_property_provider_get_tcam_integer_finish:
+ * @self: a #TcamPropertyProvider
+ * @result: the #GAsyncResult passed to the callback
+ * @err: return location for a GError, or NULL
+ *
+ * Returns: Returns the value of the property.
+ */
+gint64      tcam_property_provider_get_tcam_integer_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err )
+{
+    TcamAsyncData* data = tcam_async_finish( self, result, tcam_property_provider_get_tcam_integer_async, err );
+    return data ? data->int_value : 0;
+}
+
+/**
+ * tcam_property_provider_get_tcam_float_async:
+ * @self: a #TcamPropertyProvider
+ * @name: (not nullable): name of the property whose value will be returned.
+ * @cancellable: (nullable): a #GCancellable, cancelled operations that did not start yet are not executed
+ * @callback: (scope async): called in the thread-default main context of the caller when the operation finished
+ * @user_data: (closure): data passed to @callback
+ *
+ * Queues tcam_property_provider_get_tcam_float() to the worker thread of @self.
+ * The operations of one provider are executed in the order they were queued.
+ */
+void        tcam_property_provider_get_tcam_float_async( TcamPropertyProvider* self, const gchar* name,
+                                                         GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data )
+{
+    g_return_if_fail( self != NULL );
+    g_return_if_fail( name != NULL );
+    g_return_if_fail( TCAM_IS_PROPERTY_PROVIDER( self ) );
+
+    TcamAsyncData* data = tcam_async_data_new( TCAM_ASYNC_GET_FLOAT, name );
+    tcam_async_queue( self, data, tcam_property_provider_get_tcam_float_async, cancellable, callback, user_data );
+}
+
+/**
+ * tcam_property_provider_get_tcam_float_finish:
+ * @self: a #TcamPropertyProvider
+ * @result: the #GAsyncResult passed to the callback
+ * @err: return location for a GError, or NULL
+ *
+ * Returns: Returns the value of the property.
+ */
+gdouble     tcam_property_provider_get_tcam_float_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err )
+{
+    TcamAsyncData* data = tcam_async_finish( self, result, tcam_property_provider_get_tcam_float_async, err );
+    return data ? data->float_value : 0.0;
+}
+
+/**
+ * tcam_property_provider_get_tcam_enumeration_async:
+ * @self: a #TcamPropertyProvider
+ * @name: (not nullable): name of the property whose value will be returned.
+ * @cancellable: (nullable): a #GCancellable, cancelled operations that did not start yet are not executed
+ * @callback: (scope async): called in the thread-default main context of the caller when the operation finished
+ * @user_data: (closure): data passed to @callback
+ *
+ * Queues tcam_property_provider_get_tcam_enumeration() to the worker thread of @self.
+ * The operations of one provider are executed in the order they were queued.
+ */
+void        tcam_property_provider_get_tcam_enumeration_async( TcamPropertyProvider* self, const gchar* name,
+                                                               GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data )
+{
+    g_return_if_fail( self != NULL );
+    g_return_if_fail( name != NULL );
+    g_return_if_fail( TCAM_IS_PROPERTY_PROVIDER( self ) );
+
+    TcamAsyncData* data = tcam_async_data_new( TCAM_ASYNC_GET_ENUMERATION, name );
+    tcam_async_queue( self, data, tcam_property_provider_get_tcam_enumeration_async, cancellable, callback, user_data );
+}
+
+/**
+ * tcam_property_provider_get_tcam_enumeration_finish:
+ * @self: a #TcamPropertyProvider
+ * @result: the #GAsyncResult passed to the callback
+ * @err: return location for a GError, or NULL
+ *
+ * Returns: (transfer full) (nullable): The value of the property, free with g_free()
+ */
+gchar*      tcam_property_provider_get_tcam_enumeration_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err )
+{
+    TcamAsyncData* data = tcam_async_finish( self, result, tcam_property_provider_get_tcam_enumeration_async, err );
+    return data ? g_steal_pointer( &data->str_value ) : NULL;
+}
@@ -19,6 +19,8 @@
 
 #include "Tcam-1.0.h"
 
+#include <gio/gio.h>
+
 G_BEGIN_DECLS
 
 GType   tcam_error_get_type(void);
@@ -82,6 +84,35 @@ gint64          tcam_property_provider_get_tcam_integer( TcamPropertyProvider* s
 gdouble         tcam_property_provider_get_tcam_float( TcamPropertyProvider* self, const gchar* name, GError** err );
 const gchar*    tcam_property_provider_get_tcam_enumeration( TcamPropertyProvider* self, const gchar* name, GError** err );
 
+void            tcam_property_provider_set_tcam_boolean_async( TcamPropertyProvider* self, const gchar* name, gboolean value,
+                                                               GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data );
+gboolean        tcam_property_provider_set_tcam_boolean_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err );
+void            tcam_property_provider_set_tcam_integer_async( TcamPropertyProvider* self, const gchar* name, gint64 value,
+                                                               GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data );
+gboolean        tcam_property_provider_set_tcam_integer_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err );
+void            tcam_property_provider_set_tcam_float_async( TcamPropertyProvider* self, const gchar* name, gdouble value,
+                                                             GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data );
+gboolean        tcam_property_provider_set_tcam_float_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err );
+void            tcam_property_provider_set_tcam_enumeration_async( TcamPropertyProvider* self, const gchar* name, const gchar* value,
+                                                                   GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data );
+gboolean        tcam_property_provider_set_tcam_enumeration_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err );
+void            tcam_property_provider_set_tcam_command_async( TcamPropertyProvider* self, const gchar* name,
+                                                               GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data );
+gboolean        tcam_property_provider_set_tcam_command_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err );
+
+void            tcam_property_provider_get_tcam_boolean_async( TcamPropertyProvider* self, const gchar* name,
+                                                               GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data );
+gboolean        tcam_property_provider_get_tcam_boolean_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err );
+void            tcam_property_provider_get_tcam_integer_async( TcamPropertyProvider* self, const gchar* name,
+                                                               GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data );
+gint64          tcam_property_provider_get_tcam_integer_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err );
+void            tcam_property_provider_get_tcam_float_async( TcamPropertyProvider* self, const gchar* name,
+                                                             GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data );
+gdouble         tcam_property_provider_get_tcam_float_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err );
+void            tcam_property_provider_get_tcam_enumeration_async( TcamPropertyProvider* self, const gchar* name,
+                                                                   GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data );
+gchar*          tcam_property_provider_get_tcam_enumeration_finish( TcamPropertyProvider* self, GAsyncResult* result, GError** err );
+
 G_END_DECLS
 
 #endif /* TCAMPROP_1_0_IMPL_H */
@@ -0,0 +1,95 @@
+#!/usr/bin/env bash
+
+# Copyright 2022 The Imaging Source Europe GmbH
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Prints histograms of the time images spend between the stages of libtcam and tcamsrc.
+# Uses the tcam:stage tracepoint, see doc/pages/tracing.rst.
+#
+# usage: sudo tcam-stage-latency.sh [path/to/libtcam.so]
+# Stop with Ctrl-C to print the histograms.
+
+lib="${1:-$(ldconfig -p | awk '/libtcam\.so\.[0-9]+ / { print $NF; exit }')}"
+
+if [ -z "$lib" ] || [ ! -e "$lib" ]; then
+    echo "libtcam not found, pass the path of libtcam.so as argument" >&2
+    exit 1
+fi
+
+if ! command -v bpftrace > /dev/null; then
+    echo "bpftrace is required" >&2
+    exit 1
+fi
+
+# stages, see tcam::timing::stage
+# 0 backend_dequeue, 1 push_image_enter, 2 push_image_exit,
+# 3 auto_pass_begin, 4 auto_pass_end, 5 pool_callback, 6 create_return
+#
+# the times are kept for the last 256 frames of every stream to bound the map size
+program=$(cat <<'EOF'
+usdt:@LIB@:tcam:stage
+/arg0 == 0/
+{
+    $slot = arg2 % 256;
+    @t[arg1, $slot, 1] = 0;
+    @t[arg1, $slot, 2] = 0;
+    @t[arg1, $slot, 5] = 0;
+}
+
+usdt:@LIB@:tcam:stage
+/arg0 != 3 && arg0 != 4/
+{
+    @t[arg1, arg2 % 256, arg0] = arg3;
+}
+
+usdt:@LIB@:tcam:stage
+/arg0 == 6/
+{
+    $slot = arg2 % 256;
+    $dequeue = @t[arg1, $slot, 0];
+    $enter = @t[arg1, $slot, 1];
+    $exit = @t[arg1, $slot, 2];
+    $callback = @t[arg1, $slot, 5];
+
+    if ($dequeue != 0 && $enter != 0)
+    {
+        @backend_to_push_image_us = hist(($enter - $dequeue) / 1000);
+    }
+    if ($enter != 0 && $exit != 0)
+    {
+        @push_image_us = hist(($exit - $enter) / 1000);
+    }
+    if ($exit != 0 && $callback != 0)
+    {
+        @push_image_to_tcamsrc_us = hist(($callback - $exit) / 1000);
+    }
+    if ($callback != 0)
+    {
+        @tcamsrc_queue_us = hist((arg3 - $callback) / 1000);
+    }
+    if ($dequeue != 0)
+    {
+        @total_us = hist((arg3 - $dequeue) / 1000);
+    }
+    @t[arg1, $slot, 0] = 0;
+}
+
+END
+{
+    clear(@t);
+}
+EOF
+)
+
+exec bpftrace -e "${program//@LIB@/$lib}"
@@ -15,52 +15,12 @@
  */
 
 #include "Allocator.h"
-#include <memory>
-
-namespace
-{
-
-    struct DefaultAllocator: public tcam::AllocatorInterface, public std::enable_shared_from_this<DefaultAllocator>
-    {
-
-    std::vector<tcam::TCAM_MEMORY_TYPE> get_supported_memory_types() const final
-    {
-        return {tcam::TCAM_MEMORY_TYPE_USERPTR};
-    }
 
-        void* allocate(tcam::TCAM_MEMORY_TYPE t, size_t length, int /*fd*/) final
-    {
-        if (t != tcam::TCAM_MEMORY_TYPE_USERPTR)
-        {
-            return nullptr;
-        }
-        return malloc(length);
-    }
+#include "SlabAllocator.h"
 
-    void free(tcam::TCAM_MEMORY_TYPE, void* ptr, size_t, int /*fd*/) final
-    {
-        if (ptr)
-        {
-            std::free(ptr);
-        }
-    }
-
-    std::vector<std::shared_ptr<tcam::Memory>> allocate(size_t buffer_count, tcam::TCAM_MEMORY_TYPE, size_t length, int /*fd*/)
-    {
-        std::vector<std::shared_ptr<tcam::Memory>> buffer;
-        buffer.reserve(buffer_count);
-        for (unsigned int i = 0; i < buffer_count; ++i)
-        {
-            buffer.push_back(std::make_shared<tcam::Memory>(shared_from_this(), tcam::TCAM_MEMORY_TYPE_USERPTR, length));
-        }
-        return buffer;
-    }
-    };
-
-} // namespace
+#include <memory>
 
 std::shared_ptr<tcam::AllocatorInterface> tcam::get_default_allocator()
 {
-    return std::make_shared<DefaultAllocator>();
-
+    return std::make_shared<SlabAllocator>();
 }
@@ -43,6 +43,12 @@ public:
 
     virtual std::vector<std::shared_ptr<Memory>> allocate(size_t buffer_count, TCAM_MEMORY_TYPE, size_t, int fd=0) = 0;
 
+    // size a buffer needs to hold an image of image_size bytes
+    // larger for devices that pad their lines
+    virtual size_t get_buffer_length(size_t image_size) const
+    {
+        return image_size;
+    }
 };
 
 std::shared_ptr<AllocatorInterface> get_default_allocator();
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BufferBudget.h"
+
+#include "logging.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <unistd.h>
+
+namespace
+{
+
+constexpr auto default_hold_time = std::chrono::milliseconds(250);
+
+std::atomic<size_t> reserved_bytes = 0;
+
+size_t get_default_budget() noexcept
+{
+    if (auto mb = tcam::get_environment_variable_int("TCAM_BUFFER_BUDGET_MB"); mb && *mb > 0)
+    {
+        return static_cast<size_t>(*mb) * 1024 * 1024;
+    }
+
+    const long pages = sysconf(_SC_PHYS_PAGES);
+    const long page_size = sysconf(_SC_PAGESIZE);
+    if (pages <= 0 || page_size <= 0)
+    {
+        return SIZE_MAX;
+    }
+    return static_cast<size_t>(pages) * static_cast<size_t>(page_size) / 2;
+}
+
+std::atomic<size_t>& budget_bytes() noexcept
+{
+    static std::atomic<size_t> budget = get_default_budget();
+    return budget;
+}
+
+} // namespace
+
+
+size_t tcam::buffer_budget::calc_buffer_count(double framerate,
+                                              std::chrono::microseconds hold_time) noexcept
+{
+    if (!(framerate > 0))
+    {
+        return 10;
+    }
+    if (hold_time.count() <= 0)
+    {
+        hold_time = default_hold_time;
+    }
+
+    const double held = std::ceil(framerate * std::chrono::duration<double>(hold_time).count());
+    const double count = std::min(held, static_cast<double>(max_buffer_count)) + in_flight_buffers;
+
+    return std::clamp(static_cast<size_t>(count), min_buffer_count, max_buffer_count);
+}
+
+
+size_t tcam::buffer_budget::get_budget() noexcept
+{
+    return budget_bytes().load();
+}
+
+
+void tcam::buffer_budget::set_budget(size_t bytes) noexcept
+{
+    budget_bytes() = bytes;
+}
+
+
+size_t tcam::buffer_budget::get_reserved() noexcept
+{
+    return reserved_bytes.load();
+}
+
+
+size_t tcam::buffer_budget::reserve_buffers(size_t buffer_size,
+                                            size_t count,
+                                            size_t min_count) noexcept
+{
+    if (buffer_size == 0)
+    {
+        return count;
+    }
+    min_count = std::min(min_count, count);
+
+    const size_t budget = get_budget();
+    size_t cur = reserved_bytes.load();
+    size_t granted = 0;
+    do
+    {
+        const size_t available = budget > cur ? budget - cur : 0;
+        granted = std::clamp(available / buffer_size, min_count, count);
+    } while (!reserved_bytes.compare_exchange_weak(cur, cur + granted * buffer_size));
+
+    if (granted < count)
+    {
+        SPDLOG_WARN("Buffer memory budget of {} MiB is exhausted, using {} instead of {} buffers.",
+                    budget / (1024 * 1024),
+                    granted,
+                    count);
+    }
+    return granted;
+}
+
+
+bool tcam::buffer_budget::try_reserve(size_t bytes) noexcept
+{
+    const size_t budget = get_budget();
+    size_t cur = reserved_bytes.load();
+    do
+    {
+        if (cur > budget || bytes > budget - cur)
+        {
+            return false;
+        }
+    } while (!reserved_bytes.compare_exchange_weak(cur, cur + bytes));
+    return true;
+}
+
+
+void tcam::buffer_budget::release(size_t bytes) noexcept
+{
+    size_t cur = reserved_bytes.load();
+    while (!reserved_bytes.compare_exchange_weak(cur, cur > bytes ? cur - bytes : 0)) {}
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace tcam::buffer_budget
+{
+
+//
+// Automatic buffer counts and a process wide memory budget for image buffers.
+//
+// The count of a pool follows from the frame rate and the time downstream holds a buffer.
+// All pools of the process draw from one budget, so that many large cameras on a small
+// system get fewer buffers each instead of running out of memory.
+// The budget is TCAM_BUFFER_BUDGET_MB, or half of the physical memory.
+//
+
+constexpr size_t min_buffer_count = 4;
+constexpr size_t max_buffer_count = 256;
+// buffer filled by the device, one waiting in the device queue and one on its way downstream
+constexpr size_t in_flight_buffers = 3;
+
+// Buffers needed to stream at framerate while downstream holds each buffer for hold_time.
+// An unknown hold_time of 0 assumes 250 ms, an unknown framerate of 0 gives the old default of 10.
+size_t calc_buffer_count(double framerate, std::chrono::microseconds hold_time) noexcept;
+
+// in bytes
+size_t get_budget() noexcept;
+void set_budget(size_t bytes) noexcept;
+size_t get_reserved() noexcept;
+
+// Reserves count buffers of buffer_size bytes, fewer when the budget is exhausted.
+// min_count buffers are always granted, even beyond the budget.
+// Returns the granted count, release granted * buffer_size bytes when the buffers are freed.
+size_t reserve_buffers(size_t buffer_size, size_t count, size_t min_count) noexcept;
+
+// All or nothing, false when bytes do not fit into the budget anymore
+bool try_reserve(size_t bytes) noexcept;
+void release(size_t bytes) noexcept;
+
+} // namespace tcam::buffer_budget
@@ -17,7 +17,13 @@
 
 #include "BufferPool.h"
 
+#include "CompressedBufferSize.h"
+
 #include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include "logging.h"
 
@@ -39,7 +45,12 @@ tcam::BufferPool::~BufferPool() {}
 outcome::result<void> tcam::BufferPool::configure(const VideoFormat& format,
                                                   size_t buffer_count)
 {
-    auto ret = clear();
+    buffer_.clear();
+
+    if (!can_reuse_memory(format, buffer_count))
+    {
+        memory_.clear();
+    }
 
     format_ = format;
     count_ = buffer_count;
@@ -47,12 +58,39 @@ outcome::result<void> tcam::BufferPool::configure(const VideoFormat& format,
     return outcome::success();
 }
 
-outcome::result<void> tcam::BufferPool::allocate(const VideoFormat& format,
-                                                 size_t buffer_count)
+bool tcam::BufferPool::can_reuse_memory(const VideoFormat& format, size_t buffer_count) const
 {
+    if (memory_type_ == TCAM_MEMORY_TYPE_DMA_IMPORT)
+    {
+        return false;
+    }
+
+    if (memory_.empty() || memory_.size() != buffer_count)
+    {
+        return false;
+    }
+
+    // driver buffers are bound to the format the device had when allocating
+    if (memory_type_ != TCAM_MEMORY_TYPE_USERPTR
+        && (format.get_fourcc() != memory_format_.get_fourcc()
+            || format.get_size() != memory_format_.get_size()))
+    {
+        return false;
+    }
+
+    const size_t required =
+        allocator_->get_buffer_length(compressed::get_buffer_size(format)) + padding_;
 
-    auto memory = allocator_->allocate(buffer_count, memory_type_, format.get_required_buffer_size());
+    return std::all_of(memory_.begin(),
+                       memory_.end(),
+                       [required](const auto& m) { return m->length() >= required; });
+}
 
+outcome::result<void> tcam::BufferPool::create_buffer(
+    const VideoFormat& format,
+    std::vector<std::shared_ptr<Memory>>&& memory,
+    size_t buffer_count)
+{
     if (memory.size() != buffer_count)
     {
         SPDLOG_ERROR("Could only allocate {} of {} requested buffer", memory.size(), buffer_count);
@@ -64,38 +102,104 @@ outcome::result<void> tcam::BufferPool::allocate(const VideoFormat& format,
 
     for (auto& m : memory)
     {
-        buffer_.push_back(std::make_shared<ImageBuffer>(format, m));
+        auto buf = std::make_shared<ImageBuffer>(format, m);
+        buf->set_pool_slot(buffer_.size());
+        buffer_.push_back(buf);
     }
 
     return outcome::success();
 }
 
-outcome::result<void> tcam::BufferPool::allocate()
+outcome::result<void> tcam::BufferPool::allocate(const VideoFormat& format,
+                                                 size_t buffer_count)
 {
+    if (memory_type_ == TCAM_MEMORY_TYPE_DMA_IMPORT)
+    {
+        auto memory = external_memory_;
+        return create_buffer(format, std::move(memory), buffer_count);
+    }
 
-    auto memory = allocator_->allocate(count_, memory_type_, format_.get_required_buffer_size());
-
-    if (memory.size() != count_)
+    if (can_reuse_memory(format, buffer_count))
     {
-        SPDLOG_ERROR("Could only allocate {} of {} requested buffer", memory.size(), count_);
-        return status::UndefinedError;
+        SPDLOG_DEBUG("Reusing {} existing buffer for new format", memory_.size());
+
+        auto memory = memory_;
+        return create_buffer(format, std::move(memory), buffer_count);
     }
 
+    // release the old memory before requesting new one to keep the peak usage low
     buffer_.clear();
-    buffer_.reserve(memory.size());
+    memory_.clear();
 
-    for (auto& m : memory)
-    {
-        buffer_.push_back(std::make_shared<ImageBuffer>(format_, m));
-    }
+    memory_ = allocator_->allocate(
+        buffer_count,
+        memory_type_,
+        allocator_->get_buffer_length(compressed::get_buffer_size(format)) + padding_);
+    memory_format_ = format;
 
-    return outcome::success();
+    auto memory = memory_;
+    return create_buffer(format, std::move(memory), buffer_count);
+}
+
+outcome::result<void> tcam::BufferPool::allocate()
+{
+    return allocate(format_, count_);
 }
 
 
 outcome::result<void> tcam::BufferPool::clear()
 {
     buffer_.clear();
+    memory_.clear();
+
+    return outcome::success();
+}
+
+void tcam::BufferPool::clear_buffer()
+{
+    buffer_.clear();
+}
+
+void tcam::BufferPool::set_external_memory(std::vector<std::shared_ptr<Memory>> memory)
+{
+    external_memory_ = std::move(memory);
+}
+
+outcome::result<void> tcam::BufferPool::prefault(bool lock_memory)
+{
+    if (buffer_.empty())
+    {
+        return status::UndefinedError;
+    }
+
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+
+    for (auto& buf : buffer_)
+    {
+        auto ptr = static_cast<volatile char*>(buf->get_image_buffer_ptr());
+        const size_t size = buf->get_image_buffer_size();
+
+        if (!ptr || size == 0)
+        {
+            continue;
+        }
+
+        // a write is required, reading anonymous memory only maps the zero page
+        for (size_t offset = 0; offset < size; offset += page_size) { ptr[offset] = ptr[offset]; }
+        ptr[size - 1] = ptr[size - 1];
+
+        if (lock_memory)
+        {
+            if (mlock(buf->get_image_buffer_ptr(), size) != 0)
+            {
+                SPDLOG_INFO("Unable to lock buffer memory: {}. Check RLIMIT_MEMLOCK.",
+                            strerror(errno));
+                lock_memory = false;
+            }
+        }
+    }
+
+    SPDLOG_DEBUG("Prefaulted {} buffer", buffer_.size());
 
     return outcome::success();
 }
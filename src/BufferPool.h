@@ -39,22 +39,67 @@ class BufferPool
 private:
 
     size_t count_ = 0;
+    size_t padding_ = 0;
     TCAM_MEMORY_TYPE memory_type_ = TCAM_MEMORY_TYPE_USERPTR;
     tcam::VideoFormat format_;
     std::shared_ptr<AllocatorInterface> allocator_ = nullptr;
 
     std::vector<std::shared_ptr<ImageBuffer>> buffer_;
 
+    // memory backing buffer_
+    // kept across configure calls so that it can be reused for formats that fit
+    std::vector<std::shared_ptr<Memory>> memory_;
+    // format memory_ was allocated for
+    tcam::VideoFormat memory_format_;
+
+    // memory provided by a third party, e.g. an imported dmabuf pool
+    std::vector<std::shared_ptr<Memory>> external_memory_;
+
+    outcome::result<void> create_buffer(const VideoFormat& format,
+                                        std::vector<std::shared_ptr<Memory>>&& memory,
+                                        size_t buffer_count);
+
+    bool can_reuse_memory(const VideoFormat& format, size_t buffer_count) const;
+
 public:
     BufferPool(TCAM_MEMORY_TYPE, std::shared_ptr<AllocatorInterface>);
     ~BufferPool();
 
     // allocate <buffer_count> buffer that support format
+    //
+    // configure/allocate keep the existing memory when the new format
+    // fits into it and the buffer count is unchanged.
+    // This makes renegotiation to smaller formats cheap.
+    // Driver allocated memory (MMAP/DMA) is only kept for the same fourcc and size,
+    // as drivers refuse format changes while their buffers exist.
     outcome::result<void> configure(const VideoFormat& format, size_t buffer_count);
     outcome::result<void> allocate(const VideoFormat& format, size_t buffer_count);
     outcome::result<void> allocate();
+    // release all buffers and memory
     outcome::result<void> clear();
+    // release all buffers, the memory is kept for the next configure/allocate
+    void clear_buffer();
+
+    // Use the given memory blocks instead of the allocator
+    // Required for TCAM_MEMORY_TYPE_DMA_IMPORT
+    // Each block has to hold at least format.get_required_buffer_size() bytes
+    void set_external_memory(std::vector<std::shared_ptr<Memory>> memory);
+
+    // Additional bytes allocated behind each image, e.g. for GigE chunk data
+    // Applied with the next configure/allocate
+    void set_buffer_size_padding(size_t bytes)
+    {
+        padding_ = bytes;
+    }
+
+    // Touch every page of every buffer so that no page faults
+    // happen in the capture path.
+    // When lock_memory is true, the buffers are additionally mlock'ed.
+    // Locking is best effort, failures are only logged.
+    outcome::result<void> prefault(bool lock_memory);
 
+    // buffers are returned in slot order
+    // ImageBuffer::get_pool_slot() is the index into this list
     std::vector<std::weak_ptr<ImageBuffer>> get_buffer();
 
     TCAM_MEMORY_TYPE get_memory_type() const
@@ -18,9 +18,13 @@
 
 #include "CaptureDeviceImpl.h"
 #include "DeviceIndex.h"
+#include "DeviceInterface.h"
+#include "devicelibrary.h"
 #include "logging.h"
 #include "utils.h"
 
+#include <algorithm>
+
 using namespace tcam;
 
 CaptureDevice::CaptureDevice(const DeviceInfo& info) : impl(std::make_shared<CaptureDeviceImpl>(info))
@@ -87,9 +91,10 @@ VideoFormat CaptureDevice::get_active_video_format() const
 
 bool CaptureDevice::configure_stream(const VideoFormat& format,
                                      std::shared_ptr<ImageSink>& sink,
-                                     std::shared_ptr<BufferPool> pool)
+                                     std::shared_ptr<BufferPool> pool,
+                                     bool warm_start)
 {
-    return impl->configure_stream(format, sink, pool);
+    return impl->configure_stream(format, sink, pool, warm_start);
 }
 
 bool CaptureDevice::free_stream()
@@ -114,11 +119,130 @@ void CaptureDevice::set_drop_incomplete_frames(bool b)
     impl->set_drop_incomplete_frames(b);
 }
 
+void CaptureDevice::set_salvage_threshold(double max_loss)
+{
+    impl->set_salvage_threshold(max_loss);
+}
+
+void CaptureDevice::set_stream_transport_options(const tcam_stream_transport_options& opt)
+{
+    impl->set_stream_transport_options(opt);
+}
+
+void CaptureDevice::set_chunk_data_enabled(bool b)
+{
+    impl->set_chunk_data_enabled(b);
+}
+
+void CaptureDevice::set_progressive_delivery_enabled(bool b)
+{
+    impl->set_progressive_delivery_enabled(b);
+}
+
 outcome::result<tcam::framerate_info> CaptureDevice::get_framerate_info(const VideoFormat& fmt)
 {
     return impl->get_framerate_info(fmt);
 }
 
+uint64_t CaptureDevice::get_first_frame_latency_ns() const
+{
+    return impl->get_first_frame_latency_ns();
+}
+
+std::shared_ptr<tcam::property::PropertyNotifier> CaptureDevice::get_property_notifier() const
+{
+    return impl->get_property_notifier();
+}
+
+
+outcome::result<void> CaptureDevice::trigger_software()
+{
+    return impl->trigger_software();
+}
+
+
+outcome::result<void> CaptureDevice::queue_parameter_set(const parameter_set& set)
+{
+    return impl->queue_parameter_set(set);
+}
+
+
+void CaptureDevice::clear_parameter_sets()
+{
+    impl->clear_parameter_sets();
+}
+
+
+void CaptureDevice::set_parameter_apply_ahead(uint32_t frames)
+{
+    impl->set_parameter_apply_ahead(frames);
+}
+
+
+void CaptureDevice::set_decimation(uint32_t factor, uint32_t auto_sampling)
+{
+    impl->set_decimation(factor, auto_sampling);
+}
+
+outcome::result<void> CaptureDevice::set_auto_functions_roi_override(
+    const std::optional<tcam_image_roi>& roi)
+{
+    return impl->set_auto_functions_roi_override(roi);
+}
+
+outcome::result<void> CaptureDevice::set_action_start(
+    const std::optional<tcam_action_command>& cmd)
+{
+    return impl->set_action_start(cmd);
+}
+
+outcome::result<tcam_ptp_status> CaptureDevice::get_ptp_status()
+{
+    return impl->get_ptp_status();
+}
+
+outcome::result<void> CaptureDevice::set_device_event_callback(
+    const std::vector<std::string>& events,
+    tcam_device_event_callback callback)
+{
+    return impl->set_device_event_callback(events, std::move(callback));
+}
+
+outcome::result<void> CaptureDevice::submit_channel_statistics(
+    uint64_t frame_count,
+    const auto_alg::channel_statistics& stats)
+{
+    return impl->submit_channel_statistics(frame_count, stats);
+}
+
+outcome::result<void> CaptureDevice::move_roi(uint32_t offset_x, uint32_t offset_y)
+{
+    return impl->move_roi(offset_x, offset_y);
+}
+
+outcome::result<std::vector<uint8_t>> CaptureDevice::save_property_snapshot(
+    std::string_view user_set)
+{
+    return impl->save_property_snapshot(user_set);
+}
+
+outcome::result<std::vector<std::string>> CaptureDevice::load_property_snapshot(
+    const std::vector<uint8_t>& snapshot)
+{
+    return impl->load_property_snapshot(snapshot);
+}
+
+void CaptureDevice::set_auto_reconnect(bool enable)
+{
+    impl->set_auto_reconnect(enable);
+}
+
+outcome::result<void> CaptureDevice::reconnect(std::chrono::milliseconds timeout,
+                                               const std::function<bool()>& should_abort)
+{
+    return impl->reconnect(timeout, should_abort);
+}
+
 std::shared_ptr<tcam::AllocatorInterface> CaptureDevice::get_allocator()
 {
     return impl->get_allocator();
@@ -139,6 +263,38 @@ std::shared_ptr<CaptureDevice> tcam::open_device(const std::string& serial, TCAM
     };
 
 
+    // Asking the backends directly skips the enumeration of all backends by the Indexer,
+    // local backends first as their lookups do not touch the network.
+    // With a given type no other backend is initialized at all.
+    if (!serial.empty())
+    {
+        std::vector<BackendInterface*> backends;
+        if (type != TCAM_DEVICE_TYPE_UNKNOWN)
+        {
+            if (auto backend = tcam::get_backend(type); backend)
+            {
+                backends.push_back(backend);
+            }
+        }
+        else
+        {
+            backends = tcam::get_backend_list();
+        }
+        std::stable_partition(backends.begin(),
+                              backends.end(),
+                              [](const BackendInterface* b)
+                              { return b->get_type() != TCAM_DEVICE_TYPE_ARAVIS; });
+
+        for (auto backend : backends)
+        {
+            if (auto info = backend->find_device(serial); info)
+            {
+                return _open(*info);
+            }
+        }
+        return nullptr;
+    }
+
     DeviceIndex index;
     for (const auto& d : index.get_device_list())
     {
@@ -19,18 +19,28 @@
 
 #include "DeviceInfo.h"
 #include "ImageSink.h"
+#include "ParameterSequencer.h"
 #include "PropertyInterfaces.h"
 #include "SinkInterface.h"
 #include "VideoFormat.h"
 #include "VideoFormatDescription.h"
 #include "compiler_defines.h"
 
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 VISIBILITY_DEFAULT
 
+namespace auto_alg
+{
+struct channel_statistics;
+}
+
 namespace tcam
 {
 
@@ -102,9 +112,11 @@ public:
 
     // playback related:
 
+    // warm_start - prefault and lock all buffers before the stream starts
     bool configure_stream(const VideoFormat& format,
                           std::shared_ptr<ImageSink>& sink,
-                          std::shared_ptr<BufferPool> pool);
+                          std::shared_ptr<BufferPool> pool,
+                          bool warm_start = false);
 
     bool free_stream();
 
@@ -123,8 +135,108 @@ public:
 
     void set_drop_incomplete_frames(bool b);
 
+    // Deliver damaged images that lack at most max_loss (0.0 - 1.0) of their lines,
+    // see DeviceInterface::set_salvage_threshold
+    void set_salvage_threshold(double max_loss);
+
+    // Receive settings of network streams, applied with the next start_stream
+    void set_stream_transport_options(const tcam_stream_transport_options& opt);
+
+    // Deliver GigE chunk data with every buffer, applied with the next configure_stream.
+    // External pools have to reserve chunk_data_buffer_padding bytes behind each image.
+    void set_chunk_data_enabled(bool b);
+
+    // Hand out buffers while the backend fills them, applied with the next start_stream.
+    // See ImageSink::set_partial_image_callback and ImageBuffer::wait_for_completed_lines.
+    // Currently only AFU420 (USB 3) devices deliver partial images.
+    void set_progressive_delivery_enabled(bool b);
+
     outcome::result<tcam::framerate_info> get_framerate_info(const VideoFormat& fmt);
 
+    // time between start_stream and the first image in ns, 0 until the first image arrived
+    uint64_t get_first_frame_latency_ns() const;
+
+    // Informs about property changes that were not made through the calling code,
+    // e.g. by auto algorithms, other processes or dependencies between properties.
+    std::shared_ptr<tcam::property::PropertyNotifier> get_property_notifier() const;
+
+    // Issues TriggerSoftware on the shortest path the backend has, GigE devices do not wait for
+    // the acknowledge. The resulting image carries tcam_stream_statistics::trigger_issue_time_ns
+    // and trigger_arrival_time_ns.
+    outcome::result<void> trigger_software();
+
+    // Applied with the next start_stream, the acquisition then starts with the GigE Vision
+    // action command instead of right away. Fails with PropertyNotImplemented when the device
+    // does not support action commands. Used by DeviceGroup.
+    outcome::result<void> set_action_start(const std::optional<tcam_action_command>& cmd);
+
+    // Reads the PTP state, offset and clock of the device. Images report their camera time as
+    // tcam_stream_statistics::ptp_time_ns when the device was synchronized at stream start.
+    outcome::result<tcam_ptp_status> get_ptp_status();
+
+    // Delivers the GenICam events in events, e.g. "ExposureEnd", "FrameTransferEnd" or
+    // "FrameTriggerWait", as soon as the device sends them, without waiting for the image.
+    // callback runs on the event receive thread. Replaces the previous selection, an empty list
+    // turns the events off. Only GigE devices with a message channel support events.
+    outcome::result<void> set_device_event_callback(const std::vector<std::string>& events,
+                                                    tcam_device_event_callback callback);
+
+    // Writes the values in time for the image with parameter_set::frame as frame_count.
+    // Images report the id of the set they were taken with as
+    // tcam_stream_statistics::parameter_set_id. Queued sets are dropped by start_stream.
+    outcome::result<void> queue_parameter_set(const parameter_set& set);
+    void clear_parameter_sets();
+
+    // Images the device needs until written values are used, default 2.
+    void set_parameter_apply_ahead(uint32_t frames);
+
+    // Delivers only every factor-th image, the others are requeued right away by the stream
+    // thread. Every auto_sampling-th skipped image is still analyzed by the auto functions,
+    // 0 lets them see only the delivered images. factor 1 delivers all images.
+    void set_decimation(uint32_t factor, uint32_t auto_sampling = 1);
+
+    // Brightness ROI for auto exposure/gain/iris/white balance that is used instead of the
+    // AutoFunctionsROI properties, in pixels of the current format. Cheap enough to be called
+    // for every image. nullopt or an empty ROI hands control back to the properties.
+    outcome::result<void> set_auto_functions_roi_override(
+        const std::optional<tcam_image_roi>& roi);
+
+    // Statistics tcamconvert collected while converting the image with frame_count, the auto
+    // algorithms then do not sample that image themselves.
+    // Fails with NotImplemented when they are not used, e.g. while no auto function is enabled.
+    outcome::result<void> submit_channel_statistics(uint64_t frame_count,
+                                                    const auto_alg::channel_statistics& stats);
+
+    // Moves the image on the sensor by writing OffsetX/OffsetY, without a stream restart.
+    // Fails with PropertyNotWriteable when the camera does not allow this while streaming.
+    // Images report the offset they were taken with as tcam_stream_statistics::roi_offset_x/y,
+    // the move is assumed to take effect after the parameter apply ahead.
+    outcome::result<void> move_roi(uint32_t offset_x, uint32_t offset_y);
+
+    // Binary snapshot of the writable property values, see property_snapshot.h.
+    // With a user_set the camera also stores its settings in that GenICam user set,
+    // loading the snapshot then only needs UserSetLoad.
+    outcome::result<std::vector<uint8_t>> save_property_snapshot(std::string_view user_set = {});
+
+    // Writes the values that differ from the current ones and returns their names.
+    // Fails with InvalidParameter for snapshots of other models or firmwares.
+    outcome::result<std::vector<std::string>> load_property_snapshot(
+        const std::vector<uint8_t>& snapshot);
+
+    // Saves a property snapshot with every start_stream, reconnect restores it.
+    // Values written while streaming are not part of it.
+    void set_auto_reconnect(bool enable);
+
+    // Replaces a lost device with a new instance of the same serial.
+    // The device is looked up with exponential backoff until timeout passed or should_abort
+    // returns true. Stream settings, the property snapshot of set_auto_reconnect and the format
+    // are applied, a started stream resumes with the same buffer pool and sink.
+    // The pool buffers must not be in use, properties returned by get_properties before refer to
+    // the lost device. Not thread safe, the device must not be used meanwhile.
+    // Fails with DeviceLost when the device did not return in time.
+    outcome::result<void> reconnect(std::chrono::milliseconds timeout,
+                                    const std::function<bool()>& should_abort = {});
+
 private:
     std::shared_ptr<CaptureDeviceImpl> impl;
 
@@ -16,9 +16,16 @@
 
 #include "CaptureDeviceImpl.h"
 
+#include "CompressedBufferSize.h"
+#include "devicelibrary.h"
 #include "logging.h"
+#include "property_snapshot.h"
+#include "replay/replay_file.h"
+#include "utils.h"
 
+#include <algorithm>
 #include <exception>
+#include <thread>
 
 using namespace tcam;
 
@@ -35,7 +42,8 @@ bool prevent_software_properties (const DeviceInfo& dev)
             return true;
         }
     }
-    else if (dev.get_device_type() == tcam::TCAM_DEVICE_TYPE_VIRTCAM)
+    else if (dev.get_device_type() == tcam::TCAM_DEVICE_TYPE_VIRTCAM
+             || dev.get_device_type() == tcam::TCAM_DEVICE_TYPE_REPLAY)
     {
         return true;
     }
@@ -43,6 +51,44 @@ bool prevent_software_properties (const DeviceInfo& dev)
     return false;
 }
 
+// triggers without image are forgotten once this many are pending,
+// e.g. because trigger mode was off or the device dropped the images
+constexpr size_t max_pending_triggers = 16;
+
+uint64_t monotonic_time_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// wait between two lookups of a lost device, doubled after every attempt
+constexpr std::chrono::milliseconds reconnect_first_delay { 50 };
+constexpr std::chrono::milliseconds reconnect_max_delay { 1000 };
+
+// backends without multi-region readout would ignore the regions of format
+bool are_regions_supported(const DeviceInterface& device, const VideoFormat& format)
+{
+    const auto& regions = format.get_regions();
+    if (regions.empty())
+    {
+        return true;
+    }
+    if (regions.size() > device.get_max_region_count())
+    {
+        SPDLOG_ERROR("The device reads out at most {} regions, {} were requested.",
+                     device.get_max_region_count(),
+                     regions.size());
+        return false;
+    }
+    if (format.get_size() != calc_region_image_size(regions))
+    {
+        SPDLOG_ERROR("The format size does not match the stacked regions: {}", format.to_string());
+        return false;
+    }
+    return true;
+}
+
 } // namepsace
 
 
@@ -75,10 +121,24 @@ CaptureDeviceImpl::CaptureDeviceImpl(const DeviceInfo& device_desc)
 
     if (apply_software_properties_)
     {
-        property_filter_.setup(device_->get_properties(), available_output_formats_);
+        property_filter_.setup(device_->get_properties(),
+                               available_output_formats_,
+                               device_->get_property_notifier(),
+                               device_desc);
     }
     const auto serial = device_->get_device_description().get_serial();
     index_.register_device_lost(deviceindex_lost_cb, this, serial);
+
+    const metrics::label_list labels = { { "serial", serial } };
+    metrics_.delivered = metrics::get_counter("tcam_frames_delivered", "Images delivered", labels);
+    metrics_.dropped =
+        metrics::get_counter("tcam_frames_dropped", "Images lost by the device or transport", labels);
+    metrics_.damaged =
+        metrics::get_counter("tcam_frames_damaged", "Images delivered incomplete", labels);
+    metrics_.resent = metrics::get_counter(
+        "tcam_packets_resent", "Packets received after a resend request", labels);
+    metrics_.missing =
+        metrics::get_counter("tcam_packets_missing", "Packets that were never received", labels);
 }
 
 CaptureDeviceImpl::~CaptureDeviceImpl()
@@ -142,6 +202,10 @@ std::vector<VideoFormatDescription> CaptureDeviceImpl::get_available_video_forma
 
 bool CaptureDeviceImpl::set_video_format(const VideoFormat& new_format)
 {
+    if (!are_regions_supported(*device_, new_format))
+    {
+        return false;
+    }
     return device_->set_video_format(new_format);
 }
 
@@ -153,9 +217,10 @@ VideoFormat CaptureDeviceImpl::get_active_video_format() const
 
 bool CaptureDeviceImpl::configure_stream(const VideoFormat& format,
                                          std::shared_ptr<ImageSink>& sink,
-                                         std::shared_ptr<BufferPool> pool)
+                                         std::shared_ptr<BufferPool> pool,
+                                         bool warm_start)
 {
-    if (!device_->set_video_format(format))
+    if (!are_regions_supported(*device_, format) || !device_->set_video_format(format))
     {
         return false;
     }
@@ -168,7 +233,14 @@ bool CaptureDeviceImpl::configure_stream(const VideoFormat& format,
     // default to userptr as all devices support that
     if (!pool)
     {
-        pool_ = std::make_shared<BufferPool>(TCAM_MEMORY_TYPE_USERPTR, device_->get_allocator());
+        // keep the internal pool, it reuses its memory when the new format fits
+        if (!internal_pool_)
+        {
+            internal_pool_ =
+                std::make_shared<BufferPool>(TCAM_MEMORY_TYPE_USERPTR, device_->get_allocator());
+        }
+        pool_ = internal_pool_;
+        pool_->set_buffer_size_padding(chunk_data_enabled_ ? chunk_data_buffer_padding : 0);
         auto ret = pool_->allocate(device_->get_active_video_format(), 10);
 
         // TODO: error handling
@@ -191,6 +263,24 @@ bool CaptureDeviceImpl::configure_stream(const VideoFormat& format,
         }
     }
 
+    if (warm_start)
+    {
+        // pay for page faults now and not with the first images
+        auto ret = pool_->prefault(true);
+        if (!ret)
+        {
+            SPDLOG_WARN("Unable to prefault buffers: {}", ret.error().message());
+        }
+    }
+
+    for (const auto& b : pool_->get_buffer())
+    {
+        if (auto buffer = b.lock())
+        {
+            buffer->set_stream_id(stream_id_);
+        }
+    }
+
     device_->initialize_buffers(pool_);
 
     sink_ = sink;
@@ -218,11 +308,47 @@ bool CaptureDeviceImpl::start_stream()
         return false;
     }
 
+    // before the first image can arrive
+    decimation_counter_ = 0;
+    decimation_skipped_ = 0;
+
     if (!sink_->start_stream(device_))
     {
         return false;
     }
 
+    first_frame_latency_ns_ = 0;
+    stream_start_time_ = std::chrono::steady_clock::now();
+    {
+        std::scoped_lock lck { trigger_mtx_ };
+        pending_triggers_.clear();
+    }
+    // frame_count starts again
+    sequencer_.clear();
+    reset_roi_state();
+    metrics_.last = {};
+
+    if (auto_reconnect_)
+    {
+        // the values the stream was started with, a lost device can not be read anymore
+        auto snapshot = save_property_snapshot({});
+        if (snapshot)
+        {
+            reconnect_snapshot_ = std::move(snapshot.value());
+        }
+        else
+        {
+            SPDLOG_WARN("Unable to save the properties for a reconnect: {}",
+                        snapshot.error().message());
+            reconnect_snapshot_.clear();
+        }
+    }
+
+    recorder_.reset();
+    record_path_ = tcam::get_environment_variable("TCAM_REPLAY_RECORD", "");
+    record_compressed_ =
+        tcam::get_environment_variable_int("TCAM_REPLAY_COMPRESS").value_or(0) != 0;
+
     if (!device_->start_stream(shared_from_this()))
     {
         SPDLOG_ERROR("Unable to start stream from device.");
@@ -231,31 +357,461 @@ bool CaptureDeviceImpl::start_stream()
 
         return false;
     }
+    is_stream_started_ = true;
     return true;
 }
 
 void CaptureDeviceImpl::stop_stream()
 {
+    is_stream_started_ = false;
     device_->stop_stream();
+
+    // the stream thread is gone, this finishes the file
+    recorder_.reset();
     //device_->release_buffers();
     //sink_.reset();
 }
 
 void CaptureDeviceImpl::set_drop_incomplete_frames(bool b)
 {
+    device_settings_.drop_incomplete_frames = b;
     device_->set_drop_incomplete_frames(b);
 }
 
+void CaptureDeviceImpl::set_salvage_threshold(double max_loss)
+{
+    device_settings_.salvage_threshold = max_loss;
+    device_->set_salvage_threshold(max_loss);
+}
+
+void CaptureDeviceImpl::set_stream_transport_options(const tcam_stream_transport_options& opt)
+{
+    device_settings_.transport_options = opt;
+    device_->set_stream_transport_options(opt);
+}
+
+void CaptureDeviceImpl::set_chunk_data_enabled(bool b)
+{
+    chunk_data_enabled_ = b;
+    device_->set_chunk_data_enabled(b);
+}
+
+void CaptureDeviceImpl::set_progressive_delivery_enabled(bool b)
+{
+    device_settings_.progressive_delivery = b;
+    device_->set_progressive_delivery_enabled(b);
+}
+
+void CaptureDeviceImpl::push_partial_image(const std::shared_ptr<ImageBuffer>& buffer)
+{
+    // software properties and statistics are only applied to the complete image in push_image
+    if (sink_)
+    {
+        sink_->push_partial_image(buffer);
+    }
+}
+
 void CaptureDeviceImpl::push_image(const std::shared_ptr<ImageBuffer>& buffer)
 {
+    buffer->record_stage(timing::stage::push_image_enter);
+
+    if (first_frame_latency_ns_ == 0)
+    {
+        auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - stream_start_time_)
+                           .count();
+        first_frame_latency_ns_ = std::max<uint64_t>(latency, 1);
+        SPDLOG_INFO("First image arrived {} us after stream start.", latency / 1000);
+    }
+
+    if (compressed::is_compressed_format(buffer->get_format().get_fourcc()))
+    {
+        compressed::record_frame_size(buffer->get_format(), buffer->get_valid_data_length());
+    }
+
+    auto stats = buffer->get_statistics();
+    {
+        std::scoped_lock lck { trigger_mtx_ };
+        if (!pending_triggers_.empty())
+        {
+            stats.trigger_issue_time_ns = pending_triggers_.front();
+            stats.trigger_arrival_time_ns = monotonic_time_ns();
+
+            pending_triggers_.pop_front();
+        }
+    }
+    // writes the due parameter sets, before the buffer is handed on and requeued
+    stats.parameter_set_id = sequencer_.on_image(stats.frame_count);
+    {
+        std::scoped_lock lck { roi_mtx_ };
+        last_frame_count_ = stats.frame_count;
+        while (!pending_rois_.empty() && pending_rois_.front().first <= stats.frame_count)
+        {
+            active_roi_ = pending_rois_.front().second;
+            pending_rois_.pop_front();
+        }
+        stats.roi_id = active_roi_.id;
+        stats.roi_offset_x = active_roi_.offset_x;
+        stats.roi_offset_y = active_roi_.offset_y;
+    }
+    buffer->set_statistics(stats);
+
+    if (const uint32_t decimation = decimation_.load(std::memory_order_relaxed);
+        decimation > 1 && decimation_counter_++ % decimation != 0)
+    {
+        // triggers, parameter sets and roi moves above still count this image
+        const uint32_t sampling = decimation_auto_sampling_.load(std::memory_order_relaxed);
+        if (apply_software_properties_ && sampling != 0 && decimation_skipped_++ % sampling == 0)
+        {
+            property_filter_.apply(*buffer);
+        }
+        sink_->requeue_buffer(buffer);
+        return;
+    }
+
+    if (metrics_.delivered)
+    {
+        update_metrics(stats);
+    }
+
+    if (!record_path_.empty())
+    {
+        record_image(*buffer);
+    }
+
     if (apply_software_properties_)
     {
         property_filter_.apply(*buffer);
     }
 
+    buffer->record_stage(timing::stage::push_image_exit);
+
     sink_->push_image(buffer);
 }
 
+void CaptureDeviceImpl::update_metrics(const tcam_stream_statistics& stats) noexcept
+{
+    auto add_delta = [](metrics::counter* c, uint64_t current, uint64_t& last)
+    {
+        // a smaller total means the backend started counting again
+        c->inc(current >= last ? current - last : current);
+        last = current;
+    };
+
+    metrics_.delivered->inc();
+    if (stats.is_damaged)
+    {
+        metrics_.damaged->inc();
+    }
+    add_delta(metrics_.dropped, stats.frames_dropped, metrics_.last.frames_dropped);
+    add_delta(metrics_.resent, stats.resent_packets, metrics_.last.resent_packets);
+    add_delta(metrics_.missing, stats.missing_packets, metrics_.last.missing_packets);
+}
+
+void CaptureDeviceImpl::record_image(const ImageBuffer& buffer)
+{
+    // images are recorded as the device delivered them, before the software properties
+    if (!recorder_)
+    {
+        auto rec = replay::replay_recorder::create(record_path_,
+                                                   device_->get_active_video_format(),
+                                                   buffer.get_image_buffer_size(),
+                                                   record_compressed_
+                                                       ? replay::file_compression::lossless
+                                                       : replay::file_compression::none);
+        if (!rec)
+        {
+            SPDLOG_ERROR("Unable to record to '{}': {}", record_path_, rec.error().message());
+            record_path_.clear();
+            return;
+        }
+        recorder_ = std::move(rec.value());
+        SPDLOG_INFO("Recording images to '{}'", record_path_);
+    }
+
+    if (!recorder_->write_frame(buffer))
+    {
+        SPDLOG_ERROR("Recording to '{}' stopped after {} images.",
+                     record_path_,
+                     recorder_->get_frame_count());
+        record_path_.clear();
+        recorder_.reset();
+    }
+}
+
+outcome::result<void> CaptureDeviceImpl::trigger_software()
+{
+    const uint64_t issue_time = monotonic_time_ns();
+    {
+        std::scoped_lock lck { trigger_mtx_ };
+        if (pending_triggers_.size() >= max_pending_triggers)
+        {
+            pending_triggers_.pop_front();
+        }
+        // before the trigger, the image may arrive before trigger_software returns
+        pending_triggers_.push_back(issue_time);
+    }
+
+    auto ret = device_->trigger_software();
+    if (!ret)
+    {
+        std::scoped_lock lck { trigger_mtx_ };
+        auto iter = std::find(pending_triggers_.begin(), pending_triggers_.end(), issue_time);
+        if (iter != pending_triggers_.end())
+        {
+            pending_triggers_.erase(iter);
+        }
+    }
+    return ret;
+}
+
+outcome::result<void> CaptureDeviceImpl::set_action_start(
+    const std::optional<tcam_action_command>& cmd)
+{
+    return device_->set_action_start(cmd);
+}
+
+outcome::result<tcam_ptp_status> CaptureDeviceImpl::get_ptp_status()
+{
+    return device_->get_ptp_status();
+}
+
+outcome::result<void> CaptureDeviceImpl::set_device_event_callback(
+    const std::vector<std::string>& events,
+    tcam_device_event_callback callback)
+{
+    OUTCOME_TRY(device_->set_device_event_callback(events, callback));
+
+    device_settings_.events = events;
+    device_settings_.event_callback = std::move(callback);
+    return outcome::success();
+}
+
+outcome::result<void> CaptureDeviceImpl::queue_parameter_set(const parameter_set& set)
+{
+    return sequencer_.queue(set, get_properties());
+}
+
+void CaptureDeviceImpl::clear_parameter_sets()
+{
+    sequencer_.clear();
+}
+
+void CaptureDeviceImpl::set_parameter_apply_ahead(uint32_t frames)
+{
+    sequencer_.set_apply_ahead(frames);
+}
+
+void CaptureDeviceImpl::set_decimation(uint32_t factor, uint32_t auto_sampling)
+{
+    decimation_ = std::max<uint32_t>(factor, 1);
+    decimation_auto_sampling_ = auto_sampling;
+}
+
+outcome::result<void> CaptureDeviceImpl::set_auto_functions_roi_override(
+    const std::optional<tcam_image_roi>& roi)
+{
+    if (!apply_software_properties_)
+    {
+        return tcam::status::NotImplemented;
+    }
+    property_filter_.set_brightness_roi_override(roi);
+    return outcome::success();
+}
+
+outcome::result<void> CaptureDeviceImpl::submit_channel_statistics(
+    uint64_t frame_count,
+    const auto_alg::channel_statistics& stats)
+{
+    if (!apply_software_properties_
+        || !property_filter_.submit_channel_statistics(frame_count, stats))
+    {
+        return tcam::status::NotImplemented;
+    }
+    return outcome::success();
+}
+
+outcome::result<void> CaptureDeviceImpl::move_roi(uint32_t offset_x, uint32_t offset_y)
+{
+    OUTCOME_TRY(device_->move_roi(offset_x, offset_y));
+
+    std::scoped_lock lck { roi_mtx_ };
+
+    roi_state roi { active_roi_.id + 1, offset_x, offset_y };
+    if (!pending_rois_.empty())
+    {
+        roi.id = pending_rois_.back().second.id + 1;
+    }
+    // same model as the parameter sets, the images of the next frames are already exposed
+    pending_rois_.emplace_back(last_frame_count_ + sequencer_.get_apply_ahead(), roi);
+
+    return outcome::success();
+}
+
+outcome::result<std::vector<uint8_t>> CaptureDeviceImpl::save_property_snapshot(
+    std::string_view user_set)
+{
+    return tcam::property::capture_snapshot(*device_, get_properties(), user_set);
+}
+
+outcome::result<std::vector<std::string>> CaptureDeviceImpl::load_property_snapshot(
+    const std::vector<uint8_t>& snapshot)
+{
+    OUTCOME_TRY(auto result, tcam::property::restore_snapshot(*device_, get_properties(), snapshot));
+
+    SPDLOG_INFO("Restored property snapshot{}, wrote {}, {} unchanged, {} failed.",
+                result.loaded_user_set ? " from the user set" : "",
+                result.written.size(),
+                result.unchanged,
+                result.failed);
+
+    return std::move(result.written);
+}
+
+void CaptureDeviceImpl::set_auto_reconnect(bool enable)
+{
+    auto_reconnect_ = enable;
+    if (!enable)
+    {
+        reconnect_snapshot_.clear();
+    }
+}
+
+outcome::result<void> CaptureDeviceImpl::reconnect(std::chrono::milliseconds timeout,
+                                                   const std::function<bool()>& should_abort)
+{
+    const auto info = device_->get_device_description();
+    const auto format = device_->get_active_video_format();
+    const bool resume_stream = is_stream_started_;
+
+    // the buffers are handed to the new device
+    stop_stream();
+    device_->release_buffers();
+
+    auto backend = tcam::get_backend(info.get_device_type());
+    if (!backend)
+    {
+        return tcam::status::DeviceCouldNotBeOpened;
+    }
+
+    SPDLOG_INFO("Reconnecting to {} - {}.", info.get_name(), info.get_serial());
+
+    std::shared_ptr<DeviceInterface> dev;
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto delay = reconnect_first_delay;
+    while (true)
+    {
+        if (auto found = backend->find_device(info.get_serial()))
+        {
+            dev = tcam::open_device_interface(*found);
+            if (dev)
+            {
+                break;
+            }
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline || (should_abort && should_abort()))
+        {
+            SPDLOG_ERROR("Unable to reconnect to {}.", info.get_serial());
+            return tcam::status::DeviceLost;
+        }
+        std::this_thread::sleep_for(
+            std::min<std::chrono::steady_clock::duration>(delay, deadline - now));
+        delay = std::min(delay * 2, reconnect_max_delay);
+    }
+
+    device_ = dev;
+
+    if (device_lost_callback_data_.callback)
+    {
+        device_->register_device_lost_callback(device_lost_callback_data_.callback,
+                                               device_lost_callback_data_.user_data);
+    }
+    device_->set_drop_incomplete_frames(device_settings_.drop_incomplete_frames);
+    device_->set_salvage_threshold(device_settings_.salvage_threshold);
+    device_->set_stream_transport_options(device_settings_.transport_options);
+    device_->set_chunk_data_enabled(chunk_data_enabled_);
+    device_->set_progressive_delivery_enabled(device_settings_.progressive_delivery);
+    if (!device_settings_.events.empty())
+    {
+        auto res = device_->set_device_event_callback(device_settings_.events,
+                                                      device_settings_.event_callback);
+        if (!res)
+        {
+            SPDLOG_WARN("Unable to enable the device events again: {}", res.error().message());
+        }
+    }
+
+    if (apply_software_properties_)
+    {
+        property_filter_.setup(device_->get_properties(),
+                               available_output_formats_,
+                               device_->get_property_notifier(),
+                               device_->get_device_description());
+    }
+
+    if (!reconnect_snapshot_.empty())
+    {
+        auto res = load_property_snapshot(reconnect_snapshot_);
+        if (!res)
+        {
+            SPDLOG_WARN("Unable to restore the properties: {}", res.error().message());
+        }
+    }
+
+    if (format.is_empty())
+    {
+        return outcome::success();
+    }
+    if (!device_->set_video_format(format))
+    {
+        return tcam::status::FormatInvalid;
+    }
+    if (apply_software_properties_)
+    {
+        property_filter_.setVideoFormat(device_->get_active_video_format());
+    }
+
+    if (!resume_stream || !pool_)
+    {
+        return outcome::success();
+    }
+
+    // the pool keeps its memory, the new device only needs to know the buffers
+    device_->initialize_buffers(pool_);
+    if (!start_stream())
+    {
+        return tcam::status::UndefinedError;
+    }
+    SPDLOG_INFO("Reconnected to {}, stream resumed.", info.get_serial());
+    return outcome::success();
+}
+
+void CaptureDeviceImpl::reset_roi_state()
+{
+    roi_state roi;
+
+    auto props = device_->get_properties();
+    auto prop_x = tcam::property::find_property<tcam::property::IPropertyInteger>(props, "OffsetX");
+    auto prop_y = tcam::property::find_property<tcam::property::IPropertyInteger>(props, "OffsetY");
+    if (prop_x && prop_y)
+    {
+        auto x = prop_x->get_value();
+        auto y = prop_y->get_value();
+        if (x && y)
+        {
+            roi.offset_x = x.value();
+            roi.offset_y = y.value();
+        }
+    }
+
+    std::scoped_lock lck { roi_mtx_ };
+    active_roi_ = roi;
+    pending_rois_.clear();
+    last_frame_count_ = 0;
+}
+
 outcome::result<tcam::framerate_info> CaptureDeviceImpl::get_framerate_info(const VideoFormat& fmt)
 {
     return device_->get_framerate_info(fmt);
@@ -265,3 +821,13 @@ std::shared_ptr<tcam::AllocatorInterface> CaptureDeviceImpl::get_allocator()
 {
     return device_->get_allocator();
 }
+
+uint64_t CaptureDeviceImpl::get_first_frame_latency_ns() const
+{
+    return first_frame_latency_ns_;
+}
+
+std::shared_ptr<tcam::property::PropertyNotifier> CaptureDeviceImpl::get_property_notifier() const
+{
+    return device_->get_property_notifier();
+}
@@ -21,11 +21,19 @@
 #include "DeviceInfo.h"
 #include "DeviceInterface.h"
 #include "ImageSink.h"
+#include "Metrics.h"
 #include "VideoFormat.h"
 #include "PropertyFilter.h"
 #include "BufferPool.h"
+#include "ParameterSequencer.h"
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -37,6 +45,11 @@ namespace tcam
 class PipelineManager;
 class DeviceInterface;
 
+namespace replay
+{
+class replay_recorder;
+}
+
 class CaptureDeviceImpl :
     public IImageBufferSink,
     public std::enable_shared_from_this<CaptureDeviceImpl>
@@ -96,11 +109,13 @@ public:
      * @param format - VideoFormat that shall be used
      * @param sink - SinkInterface that shall be called for new images
      * @param pool - BufferPool that shall be used
+     * @param warm_start - prefault and lock all buffers before the stream starts
      * @return true if stream could successfully be configured
      */
     bool configure_stream(const VideoFormat& format,
                           std::shared_ptr<ImageSink>& sink,
-                          std::shared_ptr<BufferPool> pool = nullptr);
+                          std::shared_ptr<BufferPool> pool = nullptr,
+                          bool warm_start = false);
 
     /**
      * @brief explicitly free all stream resources
@@ -120,13 +135,90 @@ public:
     void stop_stream();
 
     void set_drop_incomplete_frames(bool b);
+    void set_salvage_threshold(double max_loss);
+    void set_stream_transport_options(const tcam_stream_transport_options& opt);
+    void set_chunk_data_enabled(bool b);
+    void set_progressive_delivery_enabled(bool b);
 
     outcome::result<tcam::framerate_info> get_framerate_info(const VideoFormat& fmt);
 
     std::shared_ptr<tcam::AllocatorInterface> get_allocator();
 
+    /**
+     * @return time between start_stream and the arrival of the first image in ns
+     *         0 if no image has arrived yet
+     */
+    uint64_t get_first_frame_latency_ns() const;
+
+    std::shared_ptr<tcam::property::PropertyNotifier> get_property_notifier() const;
+
+    /**
+     * Issue a software trigger, may return before the device acknowledged it.
+     * The next image is tagged with the time of this call and its arrival,
+     * see tcam_stream_statistics::trigger_issue_time_ns.
+     */
+    outcome::result<void> trigger_software();
+
+    // see DeviceInterface::set_action_start
+    outcome::result<void> set_action_start(const std::optional<tcam_action_command>& cmd);
+    outcome::result<tcam_ptp_status> get_ptp_status();
+
+    // see DeviceInterface::set_device_event_callback
+    outcome::result<void> set_device_event_callback(const std::vector<std::string>& events,
+                                                    tcam_device_event_callback callback);
+
+    /**
+     * Queue property values for the image with the given frame_count.
+     * The values are written in the stream thread, see ParameterSequencer.
+     * Images carry the id of the set they were taken with in the statistics.
+     * Queued sets are dropped when a new stream starts.
+     */
+    outcome::result<void> queue_parameter_set(const parameter_set& set);
+    void clear_parameter_sets();
+
+    // number of images the device needs until written values are used, default 2
+    void set_parameter_apply_ahead(uint32_t frames);
+
+    /**
+     * Deliver every factor-th image, skipped images are requeued in push_image.
+     * Every auto_sampling-th skipped image still goes through the auto pass, 0 for none.
+     */
+    void set_decimation(uint32_t factor, uint32_t auto_sampling);
+
+    /**
+     * Brightness ROI for the auto algorithms that replaces the AutoFunctionsROI properties.
+     * Lock free, meant to be called for every image, e.g. by an object tracker.
+     * nullopt hands control back to the properties.
+     */
+    outcome::result<void> set_auto_functions_roi_override(
+        const std::optional<tcam_image_roi>& roi);
+
+    // see CaptureDevice::submit_channel_statistics
+    outcome::result<void> submit_channel_statistics(uint64_t frame_count,
+                                                    const auto_alg::channel_statistics& stats);
+
+    /**
+     * Write OffsetX/OffsetY while streaming.
+     * Images are tagged with the new offset from the apply ahead of the parameter sequencer on.
+     */
+    outcome::result<void> move_roi(uint32_t offset_x, uint32_t offset_y);
+
+    outcome::result<std::vector<uint8_t>> save_property_snapshot(std::string_view user_set);
+    outcome::result<std::vector<std::string>> load_property_snapshot(
+        const std::vector<uint8_t>& snapshot);
+
+    // see CaptureDevice::set_auto_reconnect
+    void set_auto_reconnect(bool enable);
+    outcome::result<void> reconnect(std::chrono::milliseconds timeout,
+                                    const std::function<bool()>& should_abort);
+
 private:
     void push_image(const std::shared_ptr<ImageBuffer>& buffer) final;
+    void push_partial_image(const std::shared_ptr<ImageBuffer>& buffer) final;
+
+    // TCAM_REPLAY_RECORD, see replay::replay_recorder
+    void record_image(const ImageBuffer& buffer);
+    void update_metrics(const tcam_stream_statistics& stats) noexcept;
 
     static void deviceindex_lost_cb(const DeviceInfo&, void* user_data);
 
@@ -144,12 +236,86 @@ private:
 
     std::vector<VideoFormatDescription> available_output_formats_;
 
+    // settings of device_ that a reconnected device receives again, see reconnect
+    struct device_settings
+    {
+        bool drop_incomplete_frames = true;
+        double salvage_threshold = 0.0;
+        tcam_stream_transport_options transport_options;
+        bool progressive_delivery = false;
+        std::vector<std::string> events;
+        tcam_device_event_callback event_callback;
+    };
+    device_settings device_settings_;
+
+    // see set_auto_reconnect, taken by start_stream
+    bool auto_reconnect_ = false;
+    std::vector<uint8_t> reconnect_snapshot_;
+    // between start_stream and stop_stream, reconnect resumes the stream
+    bool is_stream_started_ = false;
+
     std::shared_ptr<ImageSink> sink_;
     std::shared_ptr<BufferPool> pool_ = nullptr;
+    std::shared_ptr<BufferPool> internal_pool_ = nullptr;
+    bool chunk_data_enabled_ = false;
 
     bool apply_software_properties_ = true;
+
+    // see set_decimation
+    std::atomic<uint32_t> decimation_ = 1;
+    std::atomic<uint32_t> decimation_auto_sampling_ = 1;
+    // images since start_stream, only touched by the stream thread
+    uint64_t decimation_counter_ = 0;
+    uint64_t decimation_skipped_ = 0;
+
+    std::chrono::steady_clock::time_point stream_start_time_;
+    std::atomic<uint64_t> first_frame_latency_ns_ = 0;
+
+    // issue times of triggers that did not yet receive their image, oldest first
+    std::mutex trigger_mtx_;
+    std::deque<uint64_t> pending_triggers_;
+
+    ParameterSequencer sequencer_;
+
+    struct roi_state
+    {
+        uint32_t id = 0;
+        uint32_t offset_x = 0;
+        uint32_t offset_y = 0;
+    };
+    // reads OffsetX/OffsetY, called by start_stream
+    void reset_roi_state();
+
+    std::mutex roi_mtx_;
+    roi_state active_roi_;
+    // moves with the frame_count from which on they are effective, oldest first
+    std::deque<std::pair<uint64_t, roi_state>> pending_rois_;
+    uint64_t last_frame_count_ = 0;
     tcam::stream::filter::SoftwarePropertyWrapper property_filter_;
 
+    // tags the pool buffers, see tcam::timing
+    const uint32_t stream_id_ = timing::new_stream_id();
+
+    // TCAM_REPLAY_RECORD, the recorder is created with the first image
+    std::string record_path_;
+    // TCAM_REPLAY_COMPRESS
+    bool record_compressed_ = false;
+    std::unique_ptr<replay::replay_recorder> recorder_;
+
+    // TCAM_METRICS_PORT, the counters are nullptr while metrics are disabled
+    struct stream_metrics
+    {
+        metrics::counter* delivered = nullptr;
+        metrics::counter* dropped = nullptr;
+        metrics::counter* damaged = nullptr;
+        metrics::counter* resent = nullptr;
+        metrics::counter* missing = nullptr;
+
+        // the backends report totals since stream start, the counters get the differences
+        tcam_stream_statistics last = {};
+    };
+    stream_metrics metrics_;
+
 }; /* class CaptureDeviceImpl */
 
 } /* namespace tcam */
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "CompressedBufferSize.h"
+
+#include "logging.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <dutils_img/image_fourcc.h>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace
+{
+
+// largest frame seen per resolution
+std::mutex size_mtx;
+std::map<std::pair<uint32_t, uint32_t>, size_t> max_frame_size;
+
+// in percent of the largest observed frame, negative values disable the tracking
+int get_headroom()
+{
+    static const int headroom =
+        tcam::get_environment_variable_int("TCAM_MJPEG_BUFFER_HEADROOM").value_or(50);
+    return headroom;
+}
+
+size_t round_to_page(size_t size)
+{
+    constexpr size_t page = 4096;
+    return (size + page - 1) / page * page;
+}
+
+} // namespace
+
+
+bool tcam::compressed::is_compressed_format(uint32_t fourcc) noexcept
+{
+    return fourcc == FOURCC_MJPG;
+}
+
+
+size_t tcam::compressed::get_buffer_size(const VideoFormat& format)
+{
+    const size_t worst_case = format.get_required_buffer_size();
+
+    if (!is_compressed_format(format.get_fourcc()) || get_headroom() < 0)
+    {
+        return worst_case;
+    }
+
+    size_t observed = 0;
+    {
+        std::scoped_lock lck { size_mtx };
+        auto iter = max_frame_size.find({ format.get_size().width, format.get_size().height });
+        if (iter != max_frame_size.end())
+        {
+            observed = iter->second;
+        }
+    }
+
+    // nothing seen yet, even high quality jpeg stays well below 12 bit per pixel
+    if (observed == 0)
+    {
+        return round_to_page(worst_case / 2);
+    }
+
+    const size_t size = observed + observed * get_headroom() / 100;
+    return std::min(worst_case, round_to_page(size));
+}
+
+
+void tcam::compressed::record_frame_size(const VideoFormat& format, size_t frame_size)
+{
+    std::scoped_lock lck { size_mtx };
+
+    auto& entry = max_frame_size[{ format.get_size().width, format.get_size().height }];
+    if (frame_size > entry)
+    {
+        if (entry != 0)
+        {
+            SPDLOG_DEBUG("Largest {} frame for {}x{} is now {} bytes",
+                         format.get_fourcc_string(),
+                         format.get_size().width,
+                         format.get_size().height,
+                         frame_size);
+        }
+        entry = frame_size;
+    }
+}
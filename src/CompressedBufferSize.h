@@ -0,0 +1,43 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "VideoFormat.h"
+
+#include <cstddef>
+
+namespace tcam::compressed
+{
+
+//
+// Buffer sizing for compressed formats like MJPG.
+//
+// get_required_buffer_size assumes the worst case of a raw image, a compressed frame is
+// usually a fraction of that. Buffers are sized by the largest frame observed for the
+// resolution so far plus headroom, process wide so that the next stream benefits from the last.
+//
+
+bool is_compressed_format(uint32_t fourcc) noexcept;
+
+// size to allocate per buffer, equals get_required_buffer_size for raw formats
+size_t get_buffer_size(const VideoFormat& format);
+
+// called for every compressed frame, devices also report frames that did not fit a buffer
+void record_frame_size(const VideoFormat& format, size_t frame_size);
+
+} // namespace tcam::compressed
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CudaHostAllocator.h"
+
+#include "Memory.h"
+#include "logging.h"
+
+#include <dlfcn.h>
+
+namespace
+{
+
+// subset of cuda_runtime_api.h, cudaError_t is an enum with cudaSuccess = 0
+using cuda_error = int;
+constexpr cuda_error cuda_success = 0;
+
+constexpr unsigned int cuda_host_alloc_portable = 0x01;
+constexpr unsigned int cuda_host_alloc_mapped = 0x02;
+
+struct cuda_runtime
+{
+    void* handle = nullptr;
+
+    cuda_error (*host_alloc)(void** ptr, size_t size, unsigned int flags) = nullptr;
+    cuda_error (*free_host)(void* ptr) = nullptr;
+    cuda_error (*get_device_count)(int* count) = nullptr;
+    const char* (*get_error_string)(cuda_error error) = nullptr;
+
+    bool is_valid() const noexcept
+    {
+        return host_alloc && free_host && get_device_count && get_error_string;
+    }
+};
+
+
+template<class T> void load_symbol(void* handle, const char* name, T& func)
+{
+    func = reinterpret_cast<T>(dlsym(handle, name));
+}
+
+
+cuda_runtime load_cuda_runtime()
+{
+    // the unversioned name is only installed with the development package
+    static const char* library_names[] = {
+        "libcudart.so", "libcudart.so.12", "libcudart.so.11.0", "libcudart.so.10.2",
+    };
+
+    cuda_runtime ret;
+    for (auto name : library_names)
+    {
+        ret.handle = dlopen(name, RTLD_LAZY | RTLD_LOCAL);
+        if (ret.handle)
+        {
+            break;
+        }
+    }
+    if (!ret.handle)
+    {
+        SPDLOG_DEBUG("libcudart is not available: {}", dlerror());
+        return ret;
+    }
+
+    load_symbol(ret.handle, "cudaHostAlloc", ret.host_alloc);
+    load_symbol(ret.handle, "cudaFreeHost", ret.free_host);
+    load_symbol(ret.handle, "cudaGetDeviceCount", ret.get_device_count);
+    load_symbol(ret.handle, "cudaGetErrorString", ret.get_error_string);
+
+    if (!ret.is_valid())
+    {
+        SPDLOG_WARN("libcudart does not provide the host allocation functions.");
+        return ret;
+    }
+
+    int count = 0;
+    if (auto err = ret.get_device_count(&count); err != cuda_success || count == 0)
+    {
+        SPDLOG_INFO("No CUDA device available, pinned memory is not used.");
+        ret.host_alloc = nullptr;
+    }
+    return ret;
+}
+
+
+// the library stays loaded, buffers may be freed during static destruction
+const cuda_runtime& get_cuda_runtime()
+{
+    static const cuda_runtime runtime = load_cuda_runtime();
+    return runtime;
+}
+
+} // namespace
+
+
+bool tcam::CudaHostAllocator::is_available()
+{
+    return get_cuda_runtime().is_valid();
+}
+
+
+void* tcam::CudaHostAllocator::allocate(TCAM_MEMORY_TYPE t, size_t length, int /*fd*/)
+{
+    const auto& cuda = get_cuda_runtime();
+    if (t != TCAM_MEMORY_TYPE_USERPTR || length == 0 || !cuda.is_valid())
+    {
+        return nullptr;
+    }
+
+    void* ptr = nullptr;
+    auto err = cuda.host_alloc(&ptr, length, cuda_host_alloc_portable | cuda_host_alloc_mapped);
+    if (err != cuda_success)
+    {
+        SPDLOG_ERROR("Unable to allocate {} bytes of pinned memory: {}",
+                     length,
+                     cuda.get_error_string(err));
+        return nullptr;
+    }
+    return ptr;
+}
+
+
+void tcam::CudaHostAllocator::free(TCAM_MEMORY_TYPE /*t*/, void* ptr, size_t /*length*/, int /*fd*/)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    const auto& cuda = get_cuda_runtime();
+    if (auto err = cuda.free_host(ptr); err != cuda_success)
+    {
+        SPDLOG_WARN("Unable to free pinned memory: {}", cuda.get_error_string(err));
+    }
+}
+
+
+std::vector<std::shared_ptr<tcam::Memory>> tcam::CudaHostAllocator::allocate(size_t buffer_count,
+                                                                             TCAM_MEMORY_TYPE t,
+                                                                             size_t length,
+                                                                             int fd)
+{
+    if (t != TCAM_MEMORY_TYPE_USERPTR || buffer_count == 0 || length == 0)
+    {
+        return {};
+    }
+
+    std::vector<std::shared_ptr<tcam::Memory>> buffer;
+    buffer.reserve(buffer_count);
+
+    for (size_t i = 0; i < buffer_count; ++i)
+    {
+        auto ptr = allocate(t, length, fd);
+        if (!ptr)
+        {
+            break;
+        }
+        buffer.push_back(std::make_shared<tcam::Memory>(shared_from_this(), t, length, ptr));
+    }
+
+    return buffer;
+}
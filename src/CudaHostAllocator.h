@@ -0,0 +1,55 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Allocator.h"
+
+#include <memory>
+
+namespace tcam
+{
+
+//
+// Allocates every buffer as page locked host memory with cudaHostAlloc, so that CUDA
+// consumers can DMA straight from the image buffers instead of staging them through an
+// internal pinned copy. The memory is also mapped into the device address space, which
+// makes it zero copy memory on Jetson.
+//
+// libcudart is loaded with dlopen on first use, tcam does not depend on CUDA.
+//
+class CudaHostAllocator : public AllocatorInterface,
+                          public std::enable_shared_from_this<CudaHostAllocator>
+{
+public:
+    // false when libcudart could not be loaded or there is no CUDA device
+    static bool is_available();
+
+    std::vector<TCAM_MEMORY_TYPE> get_supported_memory_types() const final
+    {
+        return { TCAM_MEMORY_TYPE_USERPTR };
+    }
+
+    void* allocate(TCAM_MEMORY_TYPE, size_t, int fd = 0) final;
+    void free(TCAM_MEMORY_TYPE, void* ptr, size_t, int fd = 0) final;
+
+    std::vector<std::shared_ptr<Memory>> allocate(size_t buffer_count,
+                                                  TCAM_MEMORY_TYPE,
+                                                  size_t,
+                                                  int fd = 0) final;
+};
+
+} // namespace tcam
@@ -0,0 +1,360 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DeviceGroup.h"
+
+#include "BufferPool.h"
+#include "DeviceInterface.h"
+#include "devicelibrary.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace tcam;
+
+namespace
+{
+
+// calls func(i) for every member in its own thread and waits for all of them
+template<class TFunc> void run_parallel(size_t count, TFunc&& func)
+{
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (size_t i = 0; i < count; ++i) { threads.emplace_back(func, i); }
+    for (auto& t : threads) { t.join(); }
+}
+
+bool all_of(const std::vector<char>& flags, const std::vector<char>& mask)
+{
+    for (size_t i = 0; i < flags.size(); ++i)
+    {
+        if (mask[i] && !flags[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+
+DeviceGroup::DeviceGroup(const device_group_options& options) : options_(options) {}
+
+
+DeviceGroup::~DeviceGroup()
+{
+    stop();
+}
+
+
+outcome::result<void> DeviceGroup::add_member(const device_group_member& member)
+{
+    if (running_)
+    {
+        return tcam::status::DeviceAccessBlocked;
+    }
+    if (!member.device || !member.sink)
+    {
+        return tcam::status::InvalidParameter;
+    }
+    members_.push_back(member);
+    return outcome::success();
+}
+
+
+outcome::result<void> DeviceGroup::start()
+{
+    if (running_)
+    {
+        return outcome::success();
+    }
+    if (members_.empty())
+    {
+        return tcam::status::InvalidParameter;
+    }
+
+    const size_t count = members_.size();
+    const std::vector<char> every(count, 1);
+
+    // char instead of bool, the threads write their own entry concurrently
+    std::vector<char> configured(count, 0);
+    std::vector<char> armed(count, 0);
+    std::vector<char> started(count, 0);
+
+    auto rollback = [&]()
+    {
+        run_parallel(count,
+                     [&](size_t i)
+                     {
+                         auto& dev = *members_[i].device;
+                         if (started[i])
+                         {
+                             dev.stop_stream();
+                         }
+                         if (configured[i])
+                         {
+                             dev.free_stream();
+                         }
+                         if (armed[i])
+                         {
+                             (void)dev.set_action_start(std::nullopt);
+                         }
+                     });
+    };
+
+    run_parallel(count,
+                 [&](size_t i)
+                 {
+                     auto& m = members_[i];
+                     auto pool = m.pool;
+                     if (!pool)
+                     {
+                         pool = std::make_shared<BufferPool>(TCAM_MEMORY_TYPE_USERPTR,
+                                                             m.device->get_allocator());
+                         if (!pool->configure(m.format, m.buffer_count))
+                         {
+                             return;
+                         }
+                     }
+                     auto sink = m.sink;
+                     configured[i] = m.device->configure_stream(m.format, sink, pool);
+
+                     if (configured[i] && options_.use_action_command)
+                     {
+                         armed[i] = m.device->set_action_start(options_.action).has_value();
+                     }
+                 });
+
+    if (!all_of(configured, every))
+    {
+        SPDLOG_ERROR("Unable to configure all members of the device group.");
+        rollback();
+        return tcam::status::FormatInvalid;
+    }
+
+    // armed members create their streams now and then wait for the action command
+    run_parallel(count,
+                 [&](size_t i)
+                 {
+                     if (armed[i])
+                     {
+                         started[i] = members_[i].device->start_stream();
+                     }
+                 });
+
+    if (!all_of(started, armed))
+    {
+        SPDLOG_ERROR("Unable to arm all members of the device group.");
+        rollback();
+        return tcam::status::UndefinedError;
+    }
+
+    // The remaining members wait in their own thread, so that all of them are released at once
+    // together with the action command.
+    std::mutex gate_mtx;
+    std::condition_variable gate_cv;
+    size_t waiting = 0;
+    bool open = false;
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (armed[i])
+        {
+            continue;
+        }
+        threads.emplace_back(
+            [&, i]()
+            {
+                {
+                    std::unique_lock<std::mutex> lck(gate_mtx);
+                    waiting++;
+                    gate_cv.notify_all();
+                    gate_cv.wait(lck, [&open] { return open; });
+                }
+                started[i] = members_[i].device->start_stream();
+            });
+    }
+
+    {
+        std::unique_lock<std::mutex> lck(gate_mtx);
+        gate_cv.wait(lck, [&] { return waiting == threads.size(); });
+        open = true;
+    }
+    gate_cv.notify_all();
+
+    bool action_sent = true;
+    if (std::find(armed.begin(), armed.end(), 1) != armed.end())
+    {
+        action_sent = send_action_command(armed, options_.action).has_value();
+    }
+
+    for (auto& t : threads) { t.join(); }
+
+    if (!action_sent || !all_of(started, every))
+    {
+        SPDLOG_ERROR("Unable to start all members of the device group.");
+        rollback();
+        return tcam::status::UndefinedError;
+    }
+
+    // the next start of a member on its own begins right away again,
+    // the camera keeps the trigger until its stream is stopped
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (armed[i])
+        {
+            (void)members_[i].device->set_action_start(std::nullopt);
+        }
+    }
+
+    action_started_count_ = std::count(armed.begin(), armed.end(), 1);
+    running_ = true;
+
+    SPDLOG_INFO("Started device group with {} members, {} by action command.",
+                count,
+                action_started_count_);
+
+    return outcome::success();
+}
+
+
+outcome::result<void> DeviceGroup::send_action_command(const std::vector<char>& include,
+                                                       const tcam_action_command& cmd)
+{
+    // one broadcast per backend reaches all of its devices
+    std::set<TCAM_DEVICE_TYPE> types;
+    for (size_t i = 0; i < members_.size(); ++i)
+    {
+        if (include[i])
+        {
+            types.insert(members_[i].device->get_device().get_device_type());
+        }
+    }
+
+    for (auto type : types)
+    {
+        auto backend = tcam::get_backend(type);
+        if (!backend)
+        {
+            return tcam::status::NotImplemented;
+        }
+        if (auto res = backend->send_action_command(cmd); !res)
+        {
+            SPDLOG_ERROR("Unable to send the action command: {}", res.error().message());
+            return res.error();
+        }
+    }
+    return outcome::success();
+}
+
+
+outcome::result<void> DeviceGroup::enable_action_trigger()
+{
+    using namespace tcam::property;
+
+    const auto& action = options_.action;
+
+    for (auto& m : members_)
+    {
+        auto props = m.device->get_properties();
+
+        auto set_int = [&props](const char* name, int64_t value) -> outcome::result<void>
+        {
+            auto prop = find_property<IPropertyInteger>(props, name);
+            if (!prop)
+            {
+                return tcam::status::PropertyNotImplemented;
+            }
+            return prop->set_value(value);
+        };
+        auto set_enum = [&props](const char* name, std::string_view value) -> outcome::result<void>
+        {
+            auto prop = find_property<IPropertyEnum>(props, name);
+            if (!prop)
+            {
+                return tcam::status::PropertyNotImplemented;
+            }
+            return prop->set_value(value);
+        };
+
+        // Action1 is configured by ActionSelector 1, older cameras only have the one action
+        if (find_property(props, "ActionSelector"))
+        {
+            OUTCOME_TRY(set_int("ActionSelector", 1));
+        }
+        OUTCOME_TRY(set_int("ActionDeviceKey", action.device_key));
+        OUTCOME_TRY(set_int("ActionGroupKey", action.group_key));
+        OUTCOME_TRY(set_int("ActionGroupMask", action.group_mask));
+        if (find_property(props, "TriggerSelector"))
+        {
+            OUTCOME_TRY(set_enum("TriggerSelector", "FrameStart"));
+        }
+        OUTCOME_TRY(set_enum("TriggerSource", "Action1"));
+        OUTCOME_TRY(set_enum("TriggerMode", "On"));
+    }
+    return outcome::success();
+}
+
+
+outcome::result<void> DeviceGroup::send_action(uint64_t ptp_time_ns)
+{
+    if (members_.empty())
+    {
+        return tcam::status::InvalidParameter;
+    }
+
+    auto cmd = options_.action;
+    cmd.action_time_ns = ptp_time_ns;
+    return send_action_command(std::vector<char>(members_.size(), 1), cmd);
+}
+
+
+outcome::result<uint64_t> DeviceGroup::get_ptp_time_ns()
+{
+    for (auto& m : members_)
+    {
+        auto status = m.device->get_ptp_status();
+        if (status && status.value().is_synchronized() && status.value().time_ns != 0)
+        {
+            return status.value().time_ns;
+        }
+    }
+    return tcam::status::PropertyNotImplemented;
+}
+
+
+void DeviceGroup::stop()
+{
+    if (!running_)
+    {
+        return;
+    }
+
+    run_parallel(members_.size(),
+                 [this](size_t i)
+                 {
+                     members_[i].device->stop_stream();
+                     members_[i].device->free_stream();
+                 });
+
+    running_ = false;
+}
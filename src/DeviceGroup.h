@@ -0,0 +1,124 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TCAM_DEVICEGROUP_H
+#define TCAM_DEVICEGROUP_H
+
+#include "CaptureDevice.h"
+#include "ImageSink.h"
+#include "VideoFormat.h"
+#include "base_types.h"
+#include "compiler_defines.h"
+#include "error.h"
+
+#include <memory>
+#include <vector>
+
+VISIBILITY_DEFAULT
+
+namespace tcam
+{
+
+class BufferPool;
+
+struct device_group_member
+{
+    std::shared_ptr<CaptureDevice> device;
+    VideoFormat format;
+    std::shared_ptr<ImageSink> sink;
+    // nullptr - a USERPTR pool with buffer_count buffers is created by start
+    std::shared_ptr<BufferPool> pool;
+    size_t buffer_count = 10;
+};
+
+
+struct device_group_options
+{
+    // Start the members that support it with a single broadcast action command.
+    // Members without action commands are started at the same moment from their own thread.
+    bool use_action_command = true;
+    // all members share the keys, other applications on the network should use different ones
+    // action_time_ns schedules the start at that PTP time
+    tcam_action_command action = { 0x7463616D, 1, 1, 0 };
+};
+
+
+/// @class DeviceGroup
+/// @brief Starts and stops several devices together
+///
+/// Streams are configured and stopped in parallel, one thread per member.
+/// The acquisition of all members is then started as close to simultaneously as possible,
+/// so that the first frames of the members are aligned.
+class DeviceGroup
+{
+public:
+    explicit DeviceGroup(const device_group_options& options = {});
+
+    DeviceGroup(const DeviceGroup&) = delete;
+    DeviceGroup& operator=(const DeviceGroup&) = delete;
+
+    ~DeviceGroup();
+
+    // Fails with DeviceAccessBlocked while the group is running.
+    outcome::result<void> add_member(const device_group_member& member);
+
+    size_t get_member_count() const noexcept
+    {
+        return members_.size();
+    }
+
+    // All or nothing, members that were already started are stopped again on failure.
+    outcome::result<void> start();
+    void stop();
+
+    bool is_running() const noexcept
+    {
+        return running_;
+    }
+
+    // members that were started by the action command with the last start
+    size_t get_action_started_count() const noexcept
+    {
+        return action_started_count_;
+    }
+
+    // Lets the group action command trigger FrameStart on all members, replaces hardware
+    // trigger lines. Writes the action keys, TriggerSource=Action1 and TriggerMode=On.
+    outcome::result<void> enable_action_trigger();
+
+    // Sends the group action command once. With a ptp_time_ns in the future the members
+    // execute it at that time of their PTP synchronized clocks, see get_ptp_time_ns.
+    outcome::result<void> send_action(uint64_t ptp_time_ns = 0);
+
+    // Clock of the first member that is synchronized by PTP, base for send_action.
+    outcome::result<uint64_t> get_ptp_time_ns();
+
+private:
+    outcome::result<void> send_action_command(const std::vector<char>& include,
+                                              const tcam_action_command& cmd);
+
+    device_group_options options_;
+    std::vector<device_group_member> members_;
+
+    bool running_ = false;
+    size_t action_started_count_ = 0;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
+
+#endif /* TCAM_DEVICEGROUP_H */
@@ -73,3 +73,15 @@ std::vector<DeviceInfo> DeviceIndex::get_device_list() const
 
     return indexer_->get_device_list();
 }
+
+void DeviceIndex::get_device_list(
+    const std::function<void(const std::vector<DeviceInfo>&)>& callback) const
+{
+    if (!indexer_)
+    {
+        SPDLOG_ERROR("No Indexer present. Unable to retrieve device list");
+        return;
+    }
+
+    indexer_->get_device_list(callback);
+}
@@ -20,6 +20,7 @@
 #include "DeviceInfo.h"
 #include "base_types.h"
 
+#include <functional>
 #include <memory>
 #include <vector>
 #include <string>
@@ -53,6 +54,14 @@ public:
 
     std::vector<DeviceInfo> get_device_list() const;
 
+    /**
+     * @name get_device_list
+     * @param callback - called with the devices of each backend as soon as it is enumerated
+     * @brief Returns once all backends have been reported. Local devices are thereby available
+     *        while GigE discovery is still running.
+     */
+    void get_device_list(const std::function<void(const std::vector<DeviceInfo>&)>& callback) const;
+
 
     /**
      * @name register_device_lost
@@ -17,10 +17,17 @@
 #include "DeviceInterface.h"
 
 #include "base_types.h"
+#include "devicelibrary.h"
 #include "logging.h"
+#include "public_utils.h"
+#include "ThreadPolicy.h"
+#include "utils.h"
 
 #include <algorithm>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 
 #ifdef HAVE_ARAVIS
@@ -39,98 +46,209 @@
 #include "virtcam/virtcam_api.h"
 #endif
 
+#ifdef HAVE_REPLAY
+#include "replay/replay_api.h"
+#endif
+
 
 using namespace tcam;
 
 
-std::vector<DeviceInfo> tcam::get_device_list()
+std::vector<DeviceInfo> tcam::get_device_list(std::chrono::milliseconds timeout)
 {
     std::vector<DeviceInfo> ret;
 
-#ifdef HAVE_ARAVIS
+    get_device_list([&ret](const std::vector<DeviceInfo>& devices)
+                    { ret.insert(ret.end(), devices.begin(), devices.end()); },
+                    timeout);
 
-    auto arv_list = AravisBackend::get_instance()->get_device_list();
-    ret.insert(ret.end(), arv_list.begin(), arv_list.end());
+    return ret;
+}
 
-#endif
 
-#ifdef HAVE_V4L2
+void tcam::get_device_list(const device_list_callback& callback,
+                           std::chrono::milliseconds timeout)
+{
+    enumerate_backends(
+        get_backend_list(),
+        [&callback](BackendInterface* /*backend*/, std::vector<DeviceInfo>&& devices)
+        { callback(devices); },
+        timeout);
+}
 
-    auto v4l2_list = V4L2Backend::get_instance()->get_device_list();
-    ret.insert(ret.end(), v4l2_list.begin(), v4l2_list.end());
 
-#endif
+namespace
+{
+// shared with the enumeration threads, which may outlive enumerate_backends on timeout
+struct enumeration_state
+{
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<std::pair<BackendInterface*, std::vector<DeviceInfo>>> results;
+    size_t pending = 0;
+};
+} // namespace
 
-#ifdef HAVE_LIBUSB
 
-    auto usb_list = LibUsbBackend::get_instance()->get_device_list();
-    ret.insert(ret.end(), usb_list.begin(), usb_list.end());
+std::vector<BackendInterface*> tcam::enumerate_backends(
+    const std::vector<BackendInterface*>& backends,
+    const backend_device_list_callback& callback,
+    std::chrono::milliseconds timeout)
+{
+    auto state = std::make_shared<enumeration_state>();
+    state->pending = backends.size();
 
-#endif
+    for (auto backend : backends)
+    {
+        std::thread(
+            [state, backend]()
+            {
+                tcam::thread_policy::setup_thread("tcam_enum");
 
-#ifdef HAVE_VIRTCAM
+                std::vector<DeviceInfo> devices;
+                try
+                {
+                    devices = backend->get_device_list();
+                }
+                catch (const std::exception& err)
+                {
+                    SPDLOG_ERROR("Backend {} failed to enumerate devices: {}",
+                                 tcam::tcam_device_type_to_string(backend->get_type()),
+                                 err.what());
+                }
 
-    auto virtcam_list = virtcam::VirtBackend::get_instance()->get_device_list();
-    ret.insert(ret.end(), virtcam_list.begin(), virtcam_list.end());
+                {
+                    std::scoped_lock lock(state->mtx);
+                    state->results.emplace_back(backend, std::move(devices));
+                    state->pending--;
+                }
+                state->cv.notify_all();
+            })
+            .detach();
+    }
 
-#endif
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
 
-    return ret;
+    std::unique_lock<std::mutex> lock(state->mtx);
+
+    std::vector<BackendInterface*> finished;
+    while (true)
+    {
+        auto have_work = [&state] { return !state->results.empty() || state->pending == 0; };
+
+        if (timeout == no_enumeration_timeout)
+        {
+            state->cv.wait(lock, have_work);
+        }
+        else if (!state->cv.wait_until(lock, deadline, have_work))
+        {
+            break;
+        }
+
+        if (state->results.empty())
+        {
+            break;
+        }
+
+        auto results = std::move(state->results);
+        state->results.clear();
+
+        // the callback must not be able to stall the enumeration threads
+        lock.unlock();
+        for (auto& [backend, devices] : results)
+        {
+            finished.push_back(backend);
+            callback(backend, std::move(devices));
+        }
+        lock.lock();
+    }
+
+    std::vector<BackendInterface*> timed_out;
+    for (auto backend : backends)
+    {
+        if (std::find(finished.begin(), finished.end(), backend) == finished.end())
+        {
+            SPDLOG_WARN("Backend {} did not finish enumeration within {} ms. Ignoring it.",
+                        tcam::tcam_device_type_to_string(backend->get_type()),
+                        timeout.count());
+            timed_out.push_back(backend);
+        }
+    }
+
+    return timed_out;
 }
 
 
-std::shared_ptr<DeviceInterface> tcam::open_device_interface(const DeviceInfo& device)
+BackendInterface* tcam::get_backend(TCAM_DEVICE_TYPE type)
 {
-    try
+    if (!is_backend_enabled(type))
+    {
+        return nullptr;
+    }
+
+    // the backends are function local statics, only the requested one is constructed
+    switch (type)
     {
-        switch (device.get_device_type())
-        {
-            case TCAM_DEVICE_TYPE_ARAVIS:
-            {
 #ifdef HAVE_ARAVIS
-                return AravisBackend::get_instance()->open_device(device);
-#else
-                SPDLOG_ERROR("Aravis has not been enabled as a backend. Compile tiscamera with "
-                             "aravis enabled.");
+        case TCAM_DEVICE_TYPE_ARAVIS:
+            return AravisBackend::get_instance();
 #endif
-            }
-            case TCAM_DEVICE_TYPE_V4L2:
-            {
-
 #ifdef HAVE_V4L2
-                return V4L2Backend::get_instance()->open_device(device);
-#else
-                SPDLOG_ERROR("V4L2 has not been enabled as a backend. Compile tiscamera with "
-                             "v4l2 enabled.");
+        case TCAM_DEVICE_TYPE_V4L2:
+            return V4L2Backend::get_instance();
 #endif
-            }
-            case TCAM_DEVICE_TYPE_LIBUSB:
-            {
-
 #ifdef HAVE_LIBUSB
-                return LibUsbBackend::get_instance()->open_device(device);
-#else
-                SPDLOG_ERROR("LibUsb has not been enabled as a backend. Compile tiscamera with "
-                             "libusb enabled.");
+        case TCAM_DEVICE_TYPE_LIBUSB:
+            return LibUsbBackend::get_instance();
 #endif
-            }
-            case TCAM_DEVICE_TYPE_VIRTCAM:
-            {
-
 #ifdef HAVE_VIRTCAM
-                return virtcam::VirtBackend::get_instance()->open_device(device);
-#else
-                SPDLOG_ERROR("Virtcam has not been enabled as a backend. Compile tiscamera with "
-                             "virtcam enabled.");
+        case TCAM_DEVICE_TYPE_VIRTCAM:
+            return virtcam::VirtBackend::get_instance();
 #endif
-            }
-            default:
-            {
-                SPDLOG_ERROR("Device type not handled.");
-                break;
-            }
+#ifdef HAVE_REPLAY
+        case TCAM_DEVICE_TYPE_REPLAY:
+            return replay::ReplayBackend::get_instance();
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+
+std::vector<BackendInterface*> tcam::get_backend_list()
+{
+    std::vector<BackendInterface*> ret;
+
+    for (auto type : { TCAM_DEVICE_TYPE_ARAVIS,
+                       TCAM_DEVICE_TYPE_V4L2,
+                       TCAM_DEVICE_TYPE_LIBUSB,
+                       TCAM_DEVICE_TYPE_VIRTCAM,
+                       TCAM_DEVICE_TYPE_REPLAY })
+    {
+        if (auto backend = get_backend(type); backend)
+        {
+            ret.push_back(backend);
         }
     }
+
+    return ret;
+}
+
+
+std::shared_ptr<DeviceInterface> tcam::open_device_interface(const DeviceInfo& device)
+{
+    auto backend = get_backend(device.get_device_type());
+    if (!backend)
+    {
+        SPDLOG_ERROR("Backend {} has not been compiled into tiscamera or is disabled.",
+                     tcam_device_type_to_string(device.get_device_type()));
+        return nullptr;
+    }
+
+    try
+    {
+        return backend->open_device(device);
+    }
     catch (const std::runtime_error& err)
     {
         SPDLOG_ERROR("Encountered Error while creating device interface. {}", err.what());
@@ -158,3 +276,113 @@ outcome::result<tcam::framerate_info> DeviceInterface::get_framerate_info(const
     }
     return tcam::status::FormatInvalid;
 }
+
+outcome::result<void> DeviceInterface::move_roi(uint32_t offset_x, uint32_t offset_y)
+{
+    auto props = get_properties();
+
+    auto prop_x = tcam::property::find_property<tcam::property::IPropertyInteger>(props, "OffsetX");
+    auto prop_y = tcam::property::find_property<tcam::property::IPropertyInteger>(props, "OffsetY");
+    if (!prop_x || !prop_y)
+    {
+        return tcam::status::PropertyNotImplemented;
+    }
+
+    // OffsetAutoCenter locks the offsets
+    if (prop_x->get_flags() & tcam::property::PropertyFlags::Locked
+        || prop_y->get_flags() & tcam::property::PropertyFlags::Locked)
+    {
+        return tcam::status::PropertyNotWriteable;
+    }
+
+    auto is_valid = [](const tcam::property::IPropertyInteger& prop, int64_t value)
+    {
+        const auto range = prop.get_range();
+        if (value < range.min || value > range.max)
+        {
+            return false;
+        }
+        return range.stp <= 1 || (value - range.min) % range.stp == 0;
+    };
+
+    if (!is_valid(*prop_x, offset_x) || !is_valid(*prop_y, offset_y))
+    {
+        return tcam::status::PropertyValueOutOfBounds;
+    }
+
+    OUTCOME_TRY(prop_x->set_value(offset_x));
+    OUTCOME_TRY(prop_y->set_value(offset_y));
+
+    return outcome::success();
+}
+
+
+std::string DeviceInterface::get_firmware_version() const
+{
+    return {};
+}
+
+uint32_t DeviceInterface::get_max_region_count() const
+{
+    return 0;
+}
+
+
+outcome::result<void> DeviceInterface::save_user_set(std::string_view /*user_set*/)
+{
+    return tcam::status::PropertyNotImplemented;
+}
+
+
+outcome::result<void> DeviceInterface::load_user_set(std::string_view /*user_set*/)
+{
+    return tcam::status::PropertyNotImplemented;
+}
+
+outcome::result<void> DeviceInterface::set_action_start(
+    const std::optional<tcam_action_command>& cmd)
+{
+    if (cmd)
+    {
+        return tcam::status::PropertyNotImplemented;
+    }
+    return outcome::success();
+}
+
+outcome::result<tcam_ptp_status> DeviceInterface::get_ptp_status()
+{
+    return tcam::status::PropertyNotImplemented;
+}
+
+outcome::result<void> DeviceInterface::set_device_event_callback(
+    const std::vector<std::string>& events,
+    tcam_device_event_callback callback)
+{
+    if (!events.empty() && callback)
+    {
+        return tcam::status::PropertyNotImplemented;
+    }
+    return outcome::success();
+}
+
+outcome::result<void> DeviceInterface::trigger_software()
+{
+    if (!trigger_software_)
+    {
+        for (auto& prop : get_properties())
+        {
+            if (prop->get_name() == "TriggerSoftware"
+                && prop->get_type() == tcamprop1::prop_type::Command)
+            {
+                trigger_software_ =
+                    std::dynamic_pointer_cast<tcam::property::IPropertyCommand>(prop);
+                break;
+            }
+        }
+        if (!trigger_software_)
+        {
+            return tcam::status::PropertyNotImplemented;
+        }
+    }
+    return trigger_software_->execute();
+}
@@ -27,7 +27,12 @@
 #include "VideoFormatDescription.h"
 #include "compiler_defines.h"
 
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 
 VISIBILITY_INTERNAL
@@ -36,8 +41,43 @@ namespace tcam
 {
 
 class DeviceInterface;
+class BackendInterface;
 
-    std::vector<DeviceInfo> get_device_list();
+    // backends that did not answer within this time are left out of the device list
+    constexpr auto default_enumeration_timeout = std::chrono::milliseconds(5000);
+    // wait for all backends, used by the Indexer thread
+    constexpr auto no_enumeration_timeout = std::chrono::milliseconds::max();
+
+    // enumerates all backends concurrently and returns the merged result
+    std::vector<DeviceInfo> get_device_list(
+        std::chrono::milliseconds timeout = default_enumeration_timeout);
+
+    // called once per backend with the devices it found, in the order the backends finish
+    using device_list_callback = std::function<void(const std::vector<DeviceInfo>&)>;
+
+    // like get_device_list, but hands out the devices of each backend as soon as it finished,
+    // so that local devices can be shown while GigE discovery is still running
+    void get_device_list(const device_list_callback& callback,
+                         std::chrono::milliseconds timeout = default_enumeration_timeout);
+
+    using backend_device_list_callback =
+        std::function<void(BackendInterface* backend, std::vector<DeviceInfo>&& devices)>;
+
+    // Calls get_device_list of every backend in its own thread.
+    // callback is invoked on the calling thread, never concurrently.
+    // Returns the backends that did not finish within timeout, their results are discarded.
+    std::vector<BackendInterface*> enumerate_backends(
+        const std::vector<BackendInterface*>& backends,
+        const backend_device_list_callback& callback,
+        std::chrono::milliseconds timeout);
+
+    // all backends this library was compiled with and that are enabled,
+    // see set_enabled_backends and TCAM_BACKENDS
+    std::vector<BackendInterface*> get_backend_list();
+
+    // the backend for type, created on first use
+    // nullptr when it was not compiled in or is disabled
+    BackendInterface* get_backend(TCAM_DEVICE_TYPE type);
 
     // open device interface correlating to device
     // returns nullptr and logs error on failure
@@ -114,11 +154,88 @@ public:
         drop_incomplete_frames_ = b;
     }
 
+    // Damaged images that lack at most max_loss (0.0 - 1.0) of their lines are delivered
+    // although set_drop_incomplete_frames is active, with the lines listed in their
+    // tcam_missing_line_map. 0 drops every damaged image.
+    // Backends that cannot tell which lines are missing ignore this.
+    void set_salvage_threshold(double max_loss)
+    {
+        salvage_threshold_ = max_loss;
+    }
+
+    // Applied with the next start_stream
+    void set_stream_transport_options(const tcam_stream_transport_options& opt)
+    {
+        stream_transport_options_ = opt;
+    }
+
+    // Applied with the next set_video_format/start_stream.
+    // Buffers have to provide chunk_data_buffer_padding bytes behind the image.
+    void set_chunk_data_enabled(bool b)
+    {
+        chunk_data_enabled_ = b;
+    }
+
+    // Applied with the next start_stream.
+    // Backends that receive frames in parts hand out the buffers with
+    // IImageBufferSink::push_partial_image and publish the lines as they arrive.
+    // Other backends ignore this.
+    void set_progressive_delivery_enabled(bool b)
+    {
+        progressive_delivery_enabled_ = b;
+    }
+
     virtual outcome::result<tcam::framerate_info> get_framerate_info(const VideoFormat& fmt);
 
+    // Executes TriggerSoftware without looking the property up every time.
+    // Backends override this when the protocol allows to not wait for the device,
+    // i.e. success may only mean that the trigger was issued.
+    virtual outcome::result<void> trigger_software();
+
+    // Writes OffsetX/OffsetY without touching the format, also while streaming.
+    // Backends override this to reject the move when the camera locks the offsets during
+    // acquisition.
+    virtual outcome::result<void> move_roi(uint32_t offset_x, uint32_t offset_y);
+
+    // Firmware identification of the device, empty when the backend does not know it.
+    virtual std::string get_firmware_version() const;
+
+    // Number of sensor regions set_video_format accepts in VideoFormat::get_regions.
+    // 0 when the device only reads out a single rectangle.
+    virtual uint32_t get_max_region_count() const;
+
+    // Store the current settings in / restore them from a camera side parameter set,
+    // e.g. the GenICam UserSet selected by user_set.
+    // Backends without user sets return PropertyNotImplemented.
+    virtual outcome::result<void> save_user_set(std::string_view user_set);
+    virtual outcome::result<void> load_user_set(std::string_view user_set);
+
+    // Applied with the next start_stream. The device then arms the acquisition start and only
+    // begins to expose when it receives the action command, see BackendInterface::send_action_command.
+    // Backends without action commands return PropertyNotImplemented for anything but nullopt.
+    virtual outcome::result<void> set_action_start(const std::optional<tcam_action_command>& cmd);
+
+    // Backends without PTP return PropertyNotImplemented.
+    virtual outcome::result<tcam_ptp_status> get_ptp_status();
+
+    // Enables the notification of the GenICam events in events and delivers them to callback,
+    // replacing the previous selection. An empty list or callback turns all events off.
+    // Backends without an event channel return PropertyNotImplemented.
+    virtual outcome::result<void> set_device_event_callback(const std::vector<std::string>& events,
+                                                            tcam_device_event_callback callback);
+
+    // Receives changes the device detects on its own, e.g. through control events.
+    std::shared_ptr<tcam::property::PropertyNotifier> get_property_notifier() const
+    {
+        return property_notifier_;
+    }
+
 protected:
     DeviceInfo device;
 
+    std::shared_ptr<tcam::property::PropertyNotifier> property_notifier_ =
+        std::make_shared<tcam::property::PropertyNotifier>();
+
     void notify_device_lost()
     {
         auto dev = device.get_info();
@@ -127,6 +244,10 @@ protected:
     }
 
     bool drop_incomplete_frames_ = true;
+    double salvage_threshold_ = 0.0;
+    tcam_stream_transport_options stream_transport_options_;
+    bool chunk_data_enabled_ = false;
+    bool progressive_delivery_enabled_ = false;
 
 private:
     struct callback_container
@@ -136,6 +257,9 @@ private:
     };
 
     std::vector<callback_container> lost_callbacks;
+
+    // cached by trigger_software
+    std::shared_ptr<tcam::property::IPropertyCommand> trigger_software_;
 }; /* class Camera_Interface */
 
 
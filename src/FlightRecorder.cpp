@@ -0,0 +1,296 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FlightRecorder.h"
+
+#include "SlabAllocator.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+using namespace tcam;
+
+namespace tcam::detail
+{
+
+// Shared by the FlightRecorder and the frozen images it handed out, which may outlive it.
+struct flight_recorder_state : std::enable_shared_from_this<flight_recorder_state>
+{
+    size_t pre_trigger_frames = 0;
+    size_t post_trigger_frames = 0;
+
+    std::vector<std::shared_ptr<ImageBuffer>> slots;
+
+    mutable std::mutex mtx;
+    std::condition_variable cv;
+
+    std::vector<size_t> free_slots;
+    // recorded images, oldest first, the front is overwritten next
+    std::deque<size_t> history;
+
+    // window that still collects its post trigger images
+    bool collecting = false;
+    size_t post_remaining = 0;
+    std::vector<size_t> window;
+
+    // images of completed windows, oldest first
+    std::deque<size_t> frozen;
+    bool interrupted = false;
+
+    flight_recorder_statistics statistics;
+
+    // mtx is held
+    void complete_window()
+    {
+        frozen.insert(frozen.end(), window.begin(), window.end());
+        window.clear();
+        collecting = false;
+        cv.notify_all();
+    }
+
+    // mtx is held
+    std::optional<size_t> claim_slot()
+    {
+        if (!free_slots.empty())
+        {
+            const size_t slot = free_slots.back();
+            free_slots.pop_back();
+            return slot;
+        }
+        if (!history.empty())
+        {
+            const size_t slot = history.front();
+            history.pop_front();
+            return slot;
+        }
+        return std::nullopt;
+    }
+
+    void record(const ImageBuffer& buffer)
+    {
+        std::optional<size_t> slot;
+        {
+            std::scoped_lock lck { mtx };
+            slot = claim_slot();
+            if (!slot)
+            {
+                statistics.overruns++;
+                // the window is completed even when its images could not be kept
+                if (collecting && --post_remaining == 0)
+                {
+                    complete_window();
+                }
+                return;
+            }
+        }
+
+        // the slot is neither free nor in history, so the copy runs without the lock
+        auto& dst = *slots[*slot];
+        const size_t length =
+            std::min(buffer.get_valid_data_length(), dst.get_image_buffer_size());
+        memcpy(dst.get_image_buffer_ptr(), buffer.get_image_buffer_ptr(), length);
+        dst.set_valid_data_length(length);
+        dst.set_statistics(buffer.get_statistics());
+        dst.set_chunk_data(buffer.get_chunk_data());
+        dst.set_stream_id(buffer.get_stream_id());
+        dst.set_pitch(buffer.get_pitch());
+
+        std::scoped_lock lck { mtx };
+        statistics.recorded++;
+        if (collecting)
+        {
+            window.push_back(*slot);
+            if (--post_remaining == 0)
+            {
+                complete_window();
+            }
+        }
+        else
+        {
+            history.push_back(*slot);
+        }
+    }
+
+    bool trigger()
+    {
+        std::scoped_lock lck { mtx };
+        if (collecting)
+        {
+            statistics.ignored_triggers++;
+            return false;
+        }
+        statistics.triggers++;
+
+        const size_t count = std::min(pre_trigger_frames, history.size());
+        window.assign(history.end() - count, history.end());
+        history.erase(history.end() - count, history.end());
+
+        collecting = true;
+        post_remaining = post_trigger_frames;
+        if (post_remaining == 0)
+        {
+            complete_window();
+        }
+        return true;
+    }
+
+    std::shared_ptr<ImageBuffer> pop_frozen(std::chrono::milliseconds timeout)
+    {
+        std::unique_lock lck { mtx };
+        cv.wait_for(lck, timeout, [this] { return !frozen.empty() || interrupted; });
+        if (frozen.empty())
+        {
+            return nullptr;
+        }
+
+        const size_t slot = frozen.front();
+        frozen.pop_front();
+
+        // the slot returns to the ring once the caller releases the image
+        return std::shared_ptr<ImageBuffer>(
+            slots[slot].get(), [self = shared_from_this(), slot](ImageBuffer*) {
+                std::scoped_lock lck { self->mtx };
+                self->free_slots.push_back(slot);
+            });
+    }
+
+    void interrupt()
+    {
+        std::scoped_lock lck { mtx };
+        interrupted = true;
+        cv.notify_all();
+    }
+};
+
+} // namespace tcam::detail
+
+
+FlightRecorder::FlightRecorder(const flight_recorder_options& options) : options_(options) {}
+
+
+FlightRecorder::~FlightRecorder()
+{
+    if (state_)
+    {
+        state_->interrupt();
+    }
+}
+
+
+outcome::result<void> FlightRecorder::allocate(const VideoFormat& format, size_t buffer_size)
+{
+    const size_t count =
+        options_.pre_trigger_frames + options_.post_trigger_frames + options_.spare_frames;
+    if (count == 0 || buffer_size == 0)
+    {
+        return tcam::status::InvalidParameter;
+    }
+
+    if (state_)
+    {
+        // images of the old ring that are still held keep their state alive
+        state_->interrupt();
+        state_ = nullptr;
+    }
+
+    auto config = get_slab_allocator_config();
+    if (options_.use_hugetlb)
+    {
+        config.use_huge_pages = slab_allocator_config::huge_pages::hugetlb;
+    }
+    auto allocator = std::make_shared<SlabAllocator>(config);
+
+    auto memory = allocator->allocate(count, TCAM_MEMORY_TYPE_USERPTR, buffer_size);
+    if (memory.size() != count)
+    {
+        SPDLOG_ERROR("Unable to allocate {} flight recorder buffers of {} bytes.", count, buffer_size);
+        return tcam::status::UndefinedError;
+    }
+
+    auto state = std::make_shared<detail::flight_recorder_state>();
+    state->pre_trigger_frames = options_.pre_trigger_frames;
+    state->post_trigger_frames = options_.post_trigger_frames;
+    state->slots.reserve(count);
+    state->free_slots.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        state->slots.push_back(std::make_shared<ImageBuffer>(format, memory[i]));
+        state->free_slots.push_back(count - 1 - i);
+    }
+
+    SPDLOG_INFO("Flight recorder keeps {} images before and {} after a trigger, {} MiB.",
+                options_.pre_trigger_frames,
+                options_.post_trigger_frames,
+                count * buffer_size / (1024 * 1024));
+
+    state_ = std::move(state);
+    return outcome::success();
+}
+
+
+void FlightRecorder::record(const ImageBuffer& buffer)
+{
+    if (state_)
+    {
+        state_->record(buffer);
+    }
+}
+
+
+bool FlightRecorder::trigger()
+{
+    if (!state_)
+    {
+        return false;
+    }
+    return state_->trigger();
+}
+
+
+std::shared_ptr<ImageBuffer> FlightRecorder::pop_frozen(std::chrono::milliseconds timeout)
+{
+    if (!state_)
+    {
+        return nullptr;
+    }
+    return state_->pop_frozen(timeout);
+}
+
+
+void FlightRecorder::interrupt()
+{
+    if (state_)
+    {
+        state_->interrupt();
+    }
+}
+
+
+flight_recorder_statistics FlightRecorder::get_statistics() const
+{
+    if (!state_)
+    {
+        return {};
+    }
+    std::scoped_lock lck { state_->mtx };
+    return state_->statistics;
+}
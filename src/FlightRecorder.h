@@ -0,0 +1,114 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TCAM_FLIGHTRECORDER_H
+#define TCAM_FLIGHTRECORDER_H
+
+#include "ImageBuffer.h"
+#include "VideoFormat.h"
+#include "compiler_defines.h"
+#include "error.h"
+
+#include <chrono>
+#include <memory>
+
+VISIBILITY_DEFAULT
+
+namespace tcam
+{
+
+namespace detail
+{
+struct flight_recorder_state;
+}
+
+struct flight_recorder_options
+{
+    // images before the trigger that are kept, e.g. framerate * seconds
+    size_t pre_trigger_frames = 0;
+    // images after the trigger that complete the window
+    size_t post_trigger_frames = 0;
+    // slots beyond one window, recording continues in them while a frozen window is drained
+    size_t spare_frames = 4;
+
+    // back the ring with MAP_HUGETLB, falls back to transparent huge pages
+    bool use_hugetlb = true;
+};
+
+
+struct flight_recorder_statistics
+{
+    size_t recorded = 0;
+    // images that found no free slot, because frozen windows fill the ring
+    size_t overruns = 0;
+    size_t triggers = 0;
+    // triggers while a window was still collecting its post trigger images
+    size_t ignored_triggers = 0;
+};
+
+
+/// @class FlightRecorder
+/// @brief Keeps the last images of a stream in a preallocated ring
+///
+/// record copies every image into the ring, so the device buffer can be requeued right away.
+/// trigger freezes the pre_trigger_frames images before it and the post_trigger_frames images
+/// after it. The frozen window is handed out with pop_frozen and leaves the ring until the
+/// returned buffers are released, while the remaining slots keep recording.
+class FlightRecorder
+{
+public:
+    explicit FlightRecorder(const flight_recorder_options& options);
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    ~FlightRecorder();
+
+    // Allocates pre + post + spare slots of buffer_size bytes and forgets all recorded images.
+    // Buffers of an earlier allocation that are still held stay valid.
+    outcome::result<void> allocate(const VideoFormat& format, size_t buffer_size);
+
+    // Called for every image, usually from the device thread.
+    void record(const ImageBuffer& buffer);
+
+    // Freezes the current window. Returns false while the last window still collects images.
+    bool trigger();
+
+    // Oldest image of a frozen window, nullptr when nothing arrived within timeout.
+    // The slot returns to the ring when the last reference is gone.
+    std::shared_ptr<ImageBuffer> pop_frozen(std::chrono::milliseconds timeout);
+
+    // Lets a waiting pop_frozen return, e.g. when the stream stops
+    void interrupt();
+
+    flight_recorder_statistics get_statistics() const;
+
+    const flight_recorder_options& get_options() const noexcept
+    {
+        return options_;
+    }
+
+private:
+    flight_recorder_options options_;
+
+    std::shared_ptr<detail::flight_recorder_state> state_;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
+
+#endif /* TCAM_FLIGHTRECORDER_H */
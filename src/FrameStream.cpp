@@ -0,0 +1,327 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FrameStream.h"
+
+#include "BufferPool.h"
+#include "ImageSink.h"
+#include "logging.h"
+#include "spsc_queue.h"
+#include "ThreadPolicy.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <dutils_img/image_transform_base.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace tcam;
+
+namespace tcam::detail
+{
+
+// Shared by the FrameStream and all Frames it handed out, so that frames may outlive the stream.
+struct frame_stream_state : std::enable_shared_from_this<frame_stream_state>
+{
+    std::shared_ptr<ImageSink> sink;
+
+    // The backend thread is the only producer. Workers claim entries with a CAS in pop,
+    // so that all of them can consume from the queue.
+    spsc_queue<std::shared_ptr<ImageBuffer>> queue { overflow_policy::drop_oldest };
+
+    std::atomic<bool> running = false;
+
+    // the mutex/cv pair is only touched when a worker has to sleep
+    std::atomic<int> waiting_workers = 0;
+    std::mutex wait_mtx;
+    std::condition_variable wait_cv;
+
+    // images of the conversion stage that are not held by a Frame
+    std::mutex converted_mtx;
+    std::vector<std::shared_ptr<ImageBuffer>> free_converted;
+    std::atomic<size_t> conversion_drops = 0;
+
+    FrameStream::frame_callback callback;
+    frame_convert_func convert;
+
+    std::vector<std::thread> workers;
+
+    // backend thread
+    void push(const std::shared_ptr<ImageBuffer>& buffer)
+    {
+        if (auto dropped = queue.push(std::shared_ptr<ImageBuffer>(buffer)); dropped && *dropped)
+        {
+            sink->requeue_buffer(*dropped);
+        }
+
+        // pairs with the fence in worker_loop, either we see the waiting worker or it sees the
+        // new entry
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_workers.load() > 0)
+        {
+            std::lock_guard<std::mutex> lck(wait_mtx);
+            wait_cv.notify_one();
+        }
+    }
+
+    void worker_loop()
+    {
+        tcam::thread_policy::setup_thread("tcam_frames");
+
+        while (true)
+        {
+            auto buffer = queue.pop();
+            if (!buffer)
+            {
+                if (!running)
+                {
+                    return;
+                }
+
+                std::unique_lock<std::mutex> lck(wait_mtx);
+                waiting_workers++;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                wait_cv.wait(lck, [this] { return !queue.empty() || !running; });
+                waiting_workers--;
+                continue;
+            }
+
+            deliver(std::move(*buffer));
+        }
+    }
+
+    void deliver(std::shared_ptr<ImageBuffer>&& buffer)
+    {
+        std::shared_ptr<ImageBuffer> converted;
+        if (convert)
+        {
+            {
+                std::scoped_lock lck { converted_mtx };
+                if (!free_converted.empty())
+                {
+                    converted = std::move(free_converted.back());
+                    free_converted.pop_back();
+                }
+            }
+            if (!converted)
+            {
+                // all converted images are held by the user
+                conversion_drops++;
+                requeue(std::move(buffer), nullptr);
+                return;
+            }
+
+            convert(converted->get_img_descriptor(), buffer->get_img_descriptor());
+            converted->set_statistics(buffer->get_statistics());
+        }
+
+        try
+        {
+            callback(Frame(shared_from_this(), std::move(buffer), std::move(converted)));
+        }
+        catch (const std::exception& err)
+        {
+            SPDLOG_ERROR("Frame callback threw: {}", err.what());
+        }
+    }
+
+    void requeue(std::shared_ptr<ImageBuffer>&& buffer, std::shared_ptr<ImageBuffer>&& converted)
+    {
+        if (buffer && running)
+        {
+            sink->requeue_buffer(buffer);
+        }
+        if (converted)
+        {
+            std::scoped_lock lck { converted_mtx };
+            free_converted.push_back(std::move(converted));
+        }
+    }
+
+    void stop_workers()
+    {
+        running = false;
+        {
+            std::lock_guard<std::mutex> lck(wait_mtx);
+            wait_cv.notify_all();
+        }
+        for (auto& w : workers)
+        {
+            if (w.joinable())
+            {
+                w.join();
+            }
+        }
+        workers.clear();
+
+        // the device no longer takes buffers back
+        while (queue.pop()) {}
+    }
+};
+
+} // namespace tcam::detail
+
+
+Frame::Frame(std::shared_ptr<detail::frame_stream_state> state,
+             std::shared_ptr<ImageBuffer> buffer,
+             std::shared_ptr<ImageBuffer> converted) noexcept
+    : state_(std::move(state)), buffer_(std::move(buffer)), converted_(std::move(converted))
+{
+}
+
+
+Frame& Frame::operator=(Frame&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        state_ = std::move(other.state_);
+        buffer_ = std::move(other.buffer_);
+        converted_ = std::move(other.converted_);
+    }
+    return *this;
+}
+
+
+Frame::~Frame()
+{
+    release();
+}
+
+
+void Frame::release() noexcept
+{
+    if (state_)
+    {
+        state_->requeue(std::move(buffer_), std::move(converted_));
+        state_.reset();
+    }
+}
+
+
+FrameStream::FrameStream(std::shared_ptr<CaptureDevice> device, const frame_stream_options& options)
+    : device_(std::move(device)), options_(options)
+{
+    options_.buffer_count = std::max<size_t>(options_.buffer_count, 1);
+    options_.worker_count = std::max<size_t>(options_.worker_count, 1);
+    options_.queue_size = std::max<size_t>(options_.queue_size, 1);
+}
+
+
+FrameStream::~FrameStream()
+{
+    stop();
+}
+
+
+outcome::result<void> FrameStream::start(const VideoFormat& format, const frame_callback& callback)
+{
+    if (!device_ || !callback)
+    {
+        return tcam::status::InvalidParameter;
+    }
+    if (options_.convert && !options_.convert_format)
+    {
+        return tcam::status::InvalidParameter;
+    }
+
+    stop();
+
+    auto state = std::make_shared<detail::frame_stream_state>();
+    state->callback = callback;
+    state->convert = options_.convert;
+    state->queue.reset(options_.queue_size);
+
+    if (state->convert)
+    {
+        // every frame that is queued, being delivered or held needs its own image
+        const auto& fmt = *options_.convert_format;
+        const size_t count = options_.buffer_count + options_.worker_count;
+        try
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                state->free_converted.push_back(
+                    ImageBuffer::make_alloc_buffer(fmt, fmt.get_required_buffer_size()));
+            }
+        }
+        catch (const std::bad_alloc&)
+        {
+            return tcam::status::UndefinedError;
+        }
+    }
+
+    // the sink belongs to state, frames keep state alive
+    state->sink = std::make_shared<ImageSink>(
+        [s = state.get()](const std::shared_ptr<ImageBuffer>& buffer) { s->push(buffer); },
+        format,
+        options_.buffer_count);
+
+    auto pool = std::make_shared<BufferPool>(TCAM_MEMORY_TYPE_USERPTR, device_->get_allocator());
+    if (auto res = pool->configure(format, options_.buffer_count); !res)
+    {
+        return res.error();
+    }
+
+    if (!device_->configure_stream(format, state->sink, pool))
+    {
+        return tcam::status::FormatInvalid;
+    }
+
+    state->running = true;
+    for (size_t i = 0; i < options_.worker_count; ++i)
+    {
+        state->workers.emplace_back(&detail::frame_stream_state::worker_loop, state.get());
+    }
+
+    if (!device_->start_stream())
+    {
+        state->stop_workers();
+        device_->free_stream();
+        return tcam::status::UndefinedError;
+    }
+
+    state_ = state;
+    return outcome::success();
+}
+
+
+void FrameStream::stop()
+{
+    if (!state_)
+    {
+        return;
+    }
+
+    device_->stop_stream();
+    state_->stop_workers();
+    device_->free_stream();
+
+    state_.reset();
+}
+
+
+size_t FrameStream::get_dropped_count() const noexcept
+{
+    if (!state_)
+    {
+        return 0;
+    }
+    return state_->queue.get_dropped_count() + state_->conversion_drops.load();
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TCAM_FRAMESTREAM_H
+#define TCAM_FRAMESTREAM_H
+
+#include "CaptureDevice.h"
+#include "ImageBuffer.h"
+#include "VideoFormat.h"
+#include "compiler_defines.h"
+#include "error.h"
+
+#include <functional>
+#include <memory>
+#include <optional>
+
+namespace img
+{
+struct img_descriptor;
+}
+
+VISIBILITY_DEFAULT
+
+namespace tcam
+{
+
+namespace detail
+{
+struct frame_stream_state;
+}
+
+/// @class Frame
+/// @brief Image handed out by FrameStream
+///
+/// The device buffer is requeued when the handle is destroyed or released.
+/// Every handle that is kept around is a buffer the device cannot fill.
+class Frame
+{
+public:
+    Frame(Frame&&) noexcept = default;
+    Frame& operator=(Frame&& other) noexcept;
+    Frame(const Frame&) = delete;
+    Frame& operator=(const Frame&) = delete;
+
+    ~Frame();
+
+    /// @return the image as delivered by the device
+    const ImageBuffer& get_buffer() const noexcept
+    {
+        return *buffer_;
+    }
+
+    /// @return the converted image, the device image when no conversion is configured
+    const ImageBuffer& get_image() const noexcept
+    {
+        return converted_ ? *converted_ : *buffer_;
+    }
+
+    tcam_stream_statistics get_statistics() const noexcept
+    {
+        return buffer_->get_statistics();
+    }
+
+    /// @brief hands the buffers back, the frame must not be accessed afterwards
+    void release() noexcept;
+
+private:
+    friend struct detail::frame_stream_state;
+
+    Frame(std::shared_ptr<detail::frame_stream_state> state,
+          std::shared_ptr<ImageBuffer> buffer,
+          std::shared_ptr<ImageBuffer> converted) noexcept;
+
+    std::shared_ptr<detail::frame_stream_state> state_;
+    std::shared_ptr<ImageBuffer> buffer_;
+    std::shared_ptr<ImageBuffer> converted_;
+};
+
+
+// Writes the device image src into dst, which has the format frame_stream_options::convert_format.
+// The signature fits the dutils_img transform functions, see img_filter::transform_function_type.
+using frame_convert_func =
+    std::function<void(const img::img_descriptor& dst, const img::img_descriptor& src)>;
+
+
+struct frame_stream_options
+{
+    // buffers the device fills
+    size_t buffer_count = 10;
+    // threads that run the callback, with more than one frames may be delivered out of order
+    size_t worker_count = 1;
+    // frames waiting for a worker, when it is full the oldest waiting frame is dropped
+    size_t queue_size = 4;
+
+    // optional conversion stage, runs on the worker thread before the callback
+    std::optional<VideoFormat> convert_format;
+    frame_convert_func convert;
+};
+
+
+/// @class FrameStream
+/// @brief Streams a CaptureDevice without GStreamer
+///
+/// The backend thread only moves the buffer into a bounded lock free queue.
+/// The callback and the conversion run on worker_count threads owned by the FrameStream.
+class FrameStream
+{
+public:
+    using frame_callback = std::function<void(Frame&& frame)>;
+
+    explicit FrameStream(std::shared_ptr<CaptureDevice> device,
+                         const frame_stream_options& options = {});
+
+    FrameStream(const FrameStream&) = delete;
+    FrameStream& operator=(const FrameStream&) = delete;
+
+    ~FrameStream();
+
+    outcome::result<void> start(const VideoFormat& format, const frame_callback& callback);
+
+    // Waits for the workers, frames that are still held keep their buffers until released.
+    void stop();
+
+    // frames dropped because the queue was full, since start
+    size_t get_dropped_count() const noexcept;
+
+private:
+    std::shared_ptr<CaptureDevice> device_;
+    frame_stream_options options_;
+
+    std::shared_ptr<detail::frame_stream_state> state_;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
+
+#endif /* TCAM_FRAMESTREAM_H */
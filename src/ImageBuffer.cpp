@@ -87,6 +87,40 @@ bool ImageBuffer::copy_block(const void* data, size_t size, unsigned int offset)
     return true;
 }
 
+void ImageBuffer::reset_completed_lines() noexcept
+{
+    std::scoped_lock lck { progress_mtx_ };
+    completed_lines_ = 0;
+    progress_final_ = false;
+}
+
+void ImageBuffer::set_completed_lines(int lines, bool is_final) noexcept
+{
+    {
+        std::scoped_lock lck { progress_mtx_ };
+        completed_lines_ = lines;
+        progress_final_ = is_final;
+    }
+    progress_cv_.notify_all();
+}
+
+int ImageBuffer::wait_for_completed_lines(int lines, std::chrono::microseconds timeout) const
+{
+    std::unique_lock lck { progress_mtx_ };
+    progress_cv_.wait_for(
+        lck, timeout, [&] { return completed_lines_ >= lines || progress_final_; });
+    return completed_lines_;
+}
+
+void ImageBuffer::record_stage(timing::stage s) noexcept
+{
+    if (s == timing::stage::backend_dequeue)
+    {
+        stage_timing_ = {};
+    }
+    stage_timing_[s] = timing::record(s, stream_id_, statistics_.frame_count);
+}
+
 std::shared_ptr<tcam::ImageBuffer> tcam::ImageBuffer::make_alloc_buffer(const VideoFormat& fmt,
                                                                         size_t actual_buffer_size)
 {
@@ -95,5 +129,14 @@ std::shared_ptr<tcam::ImageBuffer> tcam::ImageBuffer::make_alloc_buffer(const Vi
 
 img::img_descriptor ImageBuffer::get_img_descriptor() const noexcept
 {
-    return img::make_img_desc_from_linear_memory(format_.get_img_type(), get_image_buffer_ptr());
+    const auto type = format_.get_img_type();
+    if (pitch_ == 0 || img::is_multi_plane_format(type.fourcc_type()))
+    {
+        return img::make_img_desc_from_linear_memory(type, get_image_buffer_ptr());
+    }
+
+    return img::make_img_desc_raw(type.fourcc_type(),
+                                  type.dim,
+                                  pitch_ * type.dim.cy,
+                                  img::img_plane { get_image_buffer_ptr(), pitch_ });
 }
@@ -20,8 +20,12 @@
 #include "VideoFormat.h"
 #include "base_types.h"
 #include "Memory.h"
+#include "StageTiming.h"
 
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 
 
 namespace img
@@ -75,6 +79,11 @@ public:
 
     img::img_descriptor get_img_descriptor() const noexcept;
 
+    const VideoFormat& get_format() const noexcept
+    {
+        return format_;
+    }
+
     /**
      * @return Pointer to actual image data
      */
@@ -91,6 +100,14 @@ public:
         return buffer_->length();
     }
 
+    /// @name get_file_descriptor
+    /// @brief Get the DMA file descriptor of the internal memory
+    /// @return file descriptor or -1 if the memory is not DMA backed
+    int get_file_descriptor() const noexcept
+    {
+        return buffer_->file_descriptor();
+    }
+
     /// @name get_image_size
     /// @brief Get size of the image in bytes
     /// @return size of the image in bytes
@@ -114,6 +131,79 @@ public:
         statistics_ = stats;
     }
 
+    tcam_chunk_data get_chunk_data() const noexcept
+    {
+        return chunk_data_;
+    }
+
+    void set_chunk_data(const tcam_chunk_data& data) noexcept
+    {
+        chunk_data_ = data;
+    }
+
+    /// @name get_missing_line_map
+    /// @brief Lines that were not received, only filled for damaged images
+    tcam_missing_line_map get_missing_line_map() const noexcept
+    {
+        return missing_line_map_;
+    }
+
+    void set_missing_line_map(const tcam_missing_line_map& map) noexcept
+    {
+        missing_line_map_ = map;
+    }
+
+    static constexpr size_t invalid_pool_slot = static_cast<size_t>(-1);
+
+    /// @name get_pool_slot
+    /// @brief Index of this buffer in the BufferPool that allocated it
+    /// @return slot index or invalid_pool_slot when the buffer is not pool owned
+    size_t get_pool_slot() const noexcept
+    {
+        return pool_slot_;
+    }
+
+    void set_pool_slot(size_t slot) noexcept
+    {
+        pool_slot_ = slot;
+    }
+
+    /// @name record_stage
+    /// @brief Record that the image reached stage s, see tcam::timing
+    /// timing::stage::backend_dequeue starts a new image and forgets the stages of the last one.
+    /// Uses the frame_count of the current statistics.
+    void record_stage(timing::stage s) noexcept;
+
+    const timing::frame_timing& get_stage_timing() const noexcept
+    {
+        return stage_timing_;
+    }
+
+    /// @name get_stream_id
+    /// @brief Id of the device stream the buffer belongs to, see timing::new_stream_id
+    uint32_t get_stream_id() const noexcept
+    {
+        return stream_id_;
+    }
+
+    void set_stream_id(uint32_t id) noexcept
+    {
+        stream_id_ = id;
+    }
+
+    /// @name get_pitch
+    /// @brief Bytes per line when the lines of the image are padded
+    /// @return pitch or 0 when the lines are tightly packed
+    int get_pitch() const noexcept
+    {
+        return pitch_;
+    }
+
+    void set_pitch(int pitch) noexcept
+    {
+        pitch_ = pitch;
+    }
+
     /// @name copy_block
     /// @brief write data to the internal buffer
     /// @param data - pointer to the data that shall be written
@@ -122,13 +212,43 @@ public:
     /// @return true when data could be written
     bool copy_block(const void* data, size_t size, unsigned int offset) noexcept;
 
+    /// @name reset_completed_lines
+    /// @brief Start publishing the fill progress, called by the backend before the first data arrives
+    void reset_completed_lines() noexcept;
+
+    /// @name set_completed_lines
+    /// @brief Publish that the first lines of the image are completely written
+    /// @param lines - number of complete lines from the top of the image
+    /// @param is_final - no further lines will be written, e.g. the frame is done or was aborted
+    void set_completed_lines(int lines, bool is_final) noexcept;
+
+    /// @name wait_for_completed_lines
+    /// @brief Blocks until at least lines lines are complete, the frame is final or timeout expired
+    /// Only meaningful for buffers handed out by IImageBufferSink::push_partial_image.
+    /// @return number of complete lines
+    int wait_for_completed_lines(int lines, std::chrono::microseconds timeout) const;
+
 private:
     VideoFormat format_;
     tcam_stream_statistics statistics_ = {};
+    tcam_chunk_data chunk_data_ = {};
+    tcam_missing_line_map missing_line_map_ = {};
 
     size_t valid_data_length_ = 0;
     std::shared_ptr<Memory> buffer_ = nullptr;
 
+    size_t pool_slot_ = invalid_pool_slot;
+
+    uint32_t stream_id_ = 0;
+    timing::frame_timing stage_timing_ = {};
+
+    int pitch_ = 0;
+
+    mutable std::mutex progress_mtx_;
+    mutable std::condition_variable progress_cv_;
+    int completed_lines_ = 0;
+    bool progress_final_ = false;
+
     const bool is_own_memory_ = false;
 };
 
@@ -45,6 +45,14 @@ void ImageSink::push_image(const std::shared_ptr<ImageBuffer>& buffer)
     sh_callback_(buffer);
 }
 
+void ImageSink::push_partial_image(const std::shared_ptr<ImageBuffer>& buffer)
+{
+    if (partial_callback_)
+    {
+        partial_callback_(buffer);
+    }
+}
+
 void ImageSink::requeue_buffer(const std::shared_ptr<ImageBuffer>& buffer)
 {
     if (auto ptr = requeue_pool_.lock())
@@ -87,6 +87,14 @@ public:
     void stop_stream();
 
     void push_image(const std::shared_ptr<ImageBuffer>&) final;
+    void push_partial_image(const std::shared_ptr<ImageBuffer>&) final;
+
+    // Receives the buffers of progressive delivery while they are filled, must not block and has
+    // to be set before start_stream
+    void set_partial_image_callback(const image_buffer_cb& cb)
+    {
+        partial_callback_ = cb;
+    }
 
     void requeue_buffer(const std::shared_ptr<ImageBuffer>&);
 
@@ -98,6 +106,7 @@ private:
     std::weak_ptr<IImageBufferPool> requeue_pool_;
 
     image_buffer_cb sh_callback_;
+    image_buffer_cb partial_callback_;
 
     ImageSinkBufferPool buffer_list_;
 };
@@ -2,8 +2,10 @@
 #include "Indexer.h"
 
 #include "logging.h"
+#include "ThreadPolicy.h"
 #include "utils.h"
 #include "DeviceInterface.h"
+#include "devicelibrary.h"
 
 #include <algorithm>
 
@@ -14,14 +16,28 @@ std::weak_ptr<Indexer> Indexer::indexer_ptr;
 Indexer::Indexer()
     : continue_thread_(true), wait_period_(2), have_list_(false)
 {
+    for (auto backend : tcam::get_backend_list())
+    {
+        backend_entry entry;
+        entry.backend = backend;
+        backends_.push_back(entry);
+    }
+
     work_thread_ = std::thread(&Indexer::update_device_list_thread, this);
 }
 
 
 Indexer::~Indexer()
 {
-    continue_thread_ = false;
+    // no callbacks after this, they reference this object
+    for (auto& entry : backends_) { entry.backend->stop_monitoring(); }
+
+    {
+        std::scoped_lock lock(mtx_);
+        continue_thread_ = false;
+    }
     wait_for_next_run_.notify_all();
+    wait_for_list_.notify_all();
 
     try
     {
@@ -61,52 +77,135 @@ std::shared_ptr<Indexer> Indexer::get_instance()
 
 void Indexer::update_device_list_thread()
 {
-    tcam::set_thread_name("tcam_indexer");
-    auto first_list = fetch_device_list_backend();
+    tcam::thread_policy::setup_thread("tcam_indexer");
+
+    // Monitoring starts before the first enumeration, so that no change is missed in between.
+    std::vector<bool> monitored;
+    for (size_t i = 0; i < backends_.size(); ++i)
+    {
+        backend_monitor_callbacks callbacks;
+        callbacks.device_list_changed = [this, i]()
+        {
+            on_device_list_changed(i);
+        };
+        callbacks.device_lost = [this](const std::string& serial)
+        {
+            on_device_lost(serial);
+        };
+        callbacks.monitoring_lost = [this, i]()
+        {
+            on_monitoring_lost(i);
+        };
+
+        monitored.push_back(backends_[i].backend->start_monitoring(callbacks));
+    }
 
     std::unique_lock<std::mutex> lock(mtx_);
-    device_list_ = first_list;
-    have_list_ = true;
-    wait_for_list_.notify_all();
+
+    for (size_t i = 0; i < backends_.size(); ++i) { backends_[i].is_monitored = monitored[i]; }
 
     while (continue_thread_)
     {
-        wait_for_next_run_.wait_for(lock, std::chrono::seconds(wait_period_));
+        wait_for_next_run_.wait(lock, [this] { return !continue_thread_ || has_pending_updates(); });
         if (!continue_thread_)
         {
             break;
         }
 
-        lock.unlock();
+        const auto now = std::chrono::steady_clock::now();
 
-        auto tmp_dev_list = fetch_device_list_backend();
+        std::vector<size_t> to_update;
+        for (size_t i = 0; i < backends_.size(); ++i)
+        {
+            if (backends_[i].needs_update)
+            {
+                backends_[i].needs_update = false;
+                to_update.push_back(i);
+            }
+        }
+        auto lost_serials = std::move(lost_serials_);
+        lost_serials_.clear();
 
-        lock.lock();
+        lock.unlock();
 
         std::vector<DeviceInfo> lost_list;
 
-        for (const auto& d : device_list_)
-        {
-            auto f = [&d](const DeviceInfo& info)
+        // only backends_[i].backend is accessed, which never changes
+        std::vector<BackendInterface*> to_enumerate;
+        for (auto i : to_update) { to_enumerate.push_back(backends_[i].backend); }
+
+        // every backend is merged as soon as it is done, so that streaming readers
+        // do not have to wait for the slowest backend
+        tcam::enumerate_backends(
+            to_enumerate,
+            [this, &to_update, &lost_list, now](BackendInterface* backend,
+                                               std::vector<DeviceInfo>&& tmp_dev_list)
             {
-                if (d.get_serial().compare(info.get_serial()) == 0)
+                std::scoped_lock backend_lock(mtx_);
+
+                auto index = std::find_if(to_update.begin(),
+                                          to_update.end(),
+                                          [this, backend](size_t i)
+                                          { return backends_[i].backend == backend; });
+                auto& entry = backends_[*index];
+
+                for (const auto& d : entry.devices)
                 {
-                    return true;
+                    auto f = [&d](const DeviceInfo& info)
+                    {
+                        if (d.get_serial().compare(info.get_serial()) == 0)
+                        {
+                            return true;
+                        }
+                        return false;
+                    };
+
+                    auto found = std::find_if(tmp_dev_list.begin(), tmp_dev_list.end(), f);
+
+                    if (found == tmp_dev_list.end())
+                    {
+                        lost_list.push_back(d);
+                    }
                 }
-                return false;
-            };
 
-            auto found = std::find_if(tmp_dev_list.begin(), tmp_dev_list.end(), f);
+                entry.devices = std::move(tmp_dev_list);
+                // the time of the request, so that get_device_list knows the list is new enough
+                entry.last_update = now;
+                entry.has_list = true;
 
-            if (found == tmp_dev_list.end())
+                wait_for_list_.notify_all();
+            },
+            tcam::no_enumeration_timeout);
+
+        lock.lock();
+
+        for (const auto& serial : lost_serials)
+        {
+            for (auto& entry : backends_)
             {
-                SPDLOG_INFO(
-                    "Lost device {} - {}. Contacting callbacks", d.get_name(), d.get_serial());
-                lost_list.push_back(d);
+                auto iter = std::find_if(entry.devices.begin(),
+                                         entry.devices.end(),
+                                         [&serial](const DeviceInfo& info)
+                                         { return info.get_serial() == serial; });
+                if (iter == entry.devices.end())
+                {
+                    continue;
+                }
+
+                lost_list.push_back(*iter);
+                entry.devices.erase(iter);
             }
         }
 
-        device_list_ = std::move(tmp_dev_list);
+        device_list_.clear();
+        for (const auto& entry : backends_)
+        {
+            device_list_.insert(device_list_.end(), entry.devices.begin(), entry.devices.end());
+        }
+        sort_device_list(device_list_);
+
+        have_list_ = true;
+        wait_for_list_.notify_all();
 
         auto cbs = callbacks_;
 
@@ -114,6 +213,8 @@ void Indexer::update_device_list_thread()
 
         for (auto&& d : lost_list)
         {
+            SPDLOG_INFO("Lost device {} - {}. Contacting callbacks", d.get_name(), d.get_serial());
+
             for (auto& c : cbs)
             {
                 if (c.serial.empty() || c.serial.compare(d.get_serial()) == 0)
@@ -128,12 +229,47 @@ void Indexer::update_device_list_thread()
 }
 
 
-std::vector<DeviceInfo> Indexer::fetch_device_list_backend() const
+bool Indexer::has_pending_updates() const
 {
-    auto tmp_dev_list = tcam::get_device_list();
+    if (!lost_serials_.empty())
+    {
+        return true;
+    }
+    return std::any_of(backends_.begin(),
+                       backends_.end(),
+                       [](const backend_entry& entry) { return entry.needs_update; });
+}
+
 
-    sort_device_list(tmp_dev_list);
-    return tmp_dev_list;
+void Indexer::on_device_list_changed(size_t backend_index)
+{
+    {
+        std::scoped_lock lock(mtx_);
+        backends_.at(backend_index).needs_update = true;
+    }
+    wait_for_next_run_.notify_all();
+}
+
+
+void Indexer::on_monitoring_lost(size_t backend_index)
+{
+    {
+        std::scoped_lock lock(mtx_);
+        auto& entry = backends_.at(backend_index);
+        entry.is_monitored = false;
+        entry.needs_update = true;
+    }
+    wait_for_next_run_.notify_all();
+}
+
+
+void Indexer::on_device_lost(const std::string& serial)
+{
+    {
+        std::scoped_lock lock(mtx_);
+        lost_serials_.push_back(serial);
+    }
+    wait_for_next_run_.notify_all();
 }
 
 
@@ -163,19 +299,103 @@ void Indexer::sort_device_list(std::vector<DeviceInfo>& lst)
 }
 
 
-std::vector<DeviceInfo> Indexer::get_device_list() const
+std::vector<DeviceInfo> Indexer::get_device_list()
 {
+    std::unique_lock<std::mutex> lock(mtx_);
 
     // wait for work_thread to deliver first valid list
     // since get_aravis_device_list is a blocking function
     // our thread would retrieve an empty list without this wait loop
+    while (!have_list_ && continue_thread_)
+    {
+        wait_for_list_.wait_for(lock, std::chrono::seconds(wait_period_));
+    }
+
+    // backends that do not report their changes are enumerated again, when their last list is
+    // too old to be trusted
+    const auto now = std::chrono::steady_clock::now();
+    bool need_update = false;
+    for (auto& entry : backends_)
+    {
+        if (!entry.is_monitored && now - entry.last_update > std::chrono::seconds(wait_period_))
+        {
+            entry.needs_update = true;
+            need_update = true;
+        }
+    }
+
+    if (need_update)
+    {
+        wait_for_next_run_.notify_all();
+
+        auto is_updated = [this, now]()
+        {
+            if (!continue_thread_)
+            {
+                return true;
+            }
+            for (const auto& entry : backends_)
+            {
+                if (!entry.is_monitored && (entry.needs_update || entry.last_update < now))
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+        while (!is_updated()) { wait_for_list_.wait(lock); }
+    }
 
-    std::unique_lock<std::mutex> lock(mtx_);
-    while (!have_list_) { wait_for_list_.wait_for(lock, std::chrono::seconds(wait_period_)); }
     return device_list_;
 }
 
 
+void Indexer::get_device_list(
+    const std::function<void(const std::vector<DeviceInfo>&)>& callback)
+{
+    std::unique_lock<std::mutex> lock(mtx_);
+
+    if (have_list_)
+    {
+        auto lst = device_list_;
+        lock.unlock();
+        callback(lst);
+        return;
+    }
+
+    std::vector<bool> delivered(backends_.size(), false);
+
+    while (continue_thread_)
+    {
+        std::vector<DeviceInfo> lst;
+        for (size_t i = 0; i < backends_.size(); ++i)
+        {
+            if (!delivered[i] && backends_[i].has_list)
+            {
+                delivered[i] = true;
+                lst.insert(lst.end(), backends_[i].devices.begin(), backends_[i].devices.end());
+            }
+        }
+
+        if (!lst.empty())
+        {
+            sort_device_list(lst);
+
+            lock.unlock();
+            callback(lst);
+            lock.lock();
+        }
+
+        if (std::all_of(delivered.begin(), delivered.end(), [](bool b) { return b; }))
+        {
+            break;
+        }
+
+        wait_for_list_.wait(lock);
+    }
+}
+
+
 void Indexer::register_device_lost(dev_callback cb, void* user_data)
 {
     std::lock_guard<std::mutex> lock(mtx_);
@@ -5,9 +5,12 @@
 #include "DeviceInfo.h"
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -18,6 +21,8 @@
 namespace tcam
 {
 
+class BackendInterface;
+
 #ifndef dev_callback
 
 typedef void (*dev_callback)(const DeviceInfo&, void* user_data);
@@ -30,7 +35,11 @@ class Indexer
 public:
     static std::shared_ptr<Indexer> get_instance();
 
-    std::vector<DeviceInfo> get_device_list() const;
+    std::vector<DeviceInfo> get_device_list();
+
+    // Hands out the devices of every backend once it has been enumerated for the first time.
+    // Returns once all backends have been delivered.
+    void get_device_list(const std::function<void(const std::vector<DeviceInfo>&)>& callback);
 
     void register_device_lost(dev_callback cb, void* user_data);
 
@@ -53,18 +62,40 @@ private:
     Indexer();
     ~Indexer();
 
+    // Backends that support it report changes through backend_monitor_callbacks, only these
+    // backends are enumerated again. All others are enumerated on demand by get_device_list,
+    // when their list is older than wait_period_.
+    struct backend_entry
+    {
+        tcam::BackendInterface* backend = nullptr;
+        bool is_monitored = false;
+        bool needs_update = true;
+        // set once the first enumeration of this backend finished
+        bool has_list = false;
+        std::chrono::steady_clock::time_point last_update;
+        std::vector<DeviceInfo> devices;
+    };
+
     void update_device_list_thread();
-    std::vector<DeviceInfo> fetch_device_list_backend() const;
+    bool has_pending_updates() const;
     static void sort_device_list(std::vector<DeviceInfo>& lst);
 
+    void on_device_list_changed(size_t backend_index);
+    void on_monitoring_lost(size_t backend_index);
+    void on_device_lost(const std::string& serial);
+
     bool continue_thread_ = true;
     mutable std::mutex mtx_;
     unsigned int wait_period_ = 2;
     std::atomic<bool> have_list_ = false;
     std::thread work_thread_;
 
-    mutable std::condition_variable wait_for_list_;
-    mutable std::condition_variable wait_for_next_run_;
+    std::condition_variable wait_for_list_;
+    std::condition_variable wait_for_next_run_;
+
+    std::vector<backend_entry> backends_;
+    // serials of open devices the backends reported as lost
+    std::vector<std::string> lost_serials_;
 
     std::vector<DeviceInfo> device_list_;
 
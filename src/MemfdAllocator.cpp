@@ -0,0 +1,145 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MemfdAllocator.h"
+
+#include "Memory.h"
+#include "logging.h"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+int tcam::create_memfd(const char* name, size_t size)
+{
+    // glibc only offers memfd_create since 2.27
+#if defined(SYS_memfd_create)
+    int fd = static_cast<int>(syscall(SYS_memfd_create, name, MFD_CLOEXEC));
+#else
+    (void)name;
+    errno = ENOSYS;
+    int fd = -1;
+#endif
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    return fd;
+}
+
+
+void* tcam::MemfdAllocator::allocate(TCAM_MEMORY_TYPE t, size_t length, int /*fd*/)
+{
+    if (t != TCAM_MEMORY_TYPE_USERPTR || length == 0)
+    {
+        return nullptr;
+    }
+
+    int fd = create_memfd("tcam-image", length);
+    if (fd < 0)
+    {
+        SPDLOG_ERROR("Unable to create memfd of {} bytes: {}", length, strerror(errno));
+        return nullptr;
+    }
+
+    void* ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED)
+    {
+        SPDLOG_ERROR("Unable to map memfd: {}", strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+
+    std::scoped_lock lck { mtx_ };
+    fds_[ptr] = fd;
+
+    return ptr;
+}
+
+
+void tcam::MemfdAllocator::free(TCAM_MEMORY_TYPE /*t*/, void* ptr, size_t length, int /*fd*/)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    std::scoped_lock lck { mtx_ };
+    auto iter = fds_.find(ptr);
+    if (iter == fds_.end())
+    {
+        SPDLOG_WARN("Freeing memory that was not allocated as memfd.");
+        return;
+    }
+
+    munmap(ptr, length);
+    close(iter->second);
+    fds_.erase(iter);
+}
+
+
+std::vector<std::shared_ptr<tcam::Memory>> tcam::MemfdAllocator::allocate(size_t buffer_count,
+                                                                          TCAM_MEMORY_TYPE t,
+                                                                          size_t length,
+                                                                          int fd)
+{
+    if (t != TCAM_MEMORY_TYPE_USERPTR || buffer_count == 0 || length == 0)
+    {
+        return {};
+    }
+
+    std::vector<std::shared_ptr<tcam::Memory>> buffer;
+    buffer.reserve(buffer_count);
+
+    for (size_t i = 0; i < buffer_count; ++i)
+    {
+        auto ptr = allocate(t, length, fd);
+        if (!ptr)
+        {
+            break;
+        }
+        buffer.push_back(
+            std::make_shared<tcam::Memory>(shared_from_this(), t, length, ptr, get_fd(ptr)));
+    }
+
+    return buffer;
+}
+
+
+int tcam::MemfdAllocator::get_fd(void* ptr) const
+{
+    std::scoped_lock lck { mtx_ };
+    auto iter = fds_.find(ptr);
+    if (iter == fds_.end())
+    {
+        return -1;
+    }
+    return iter->second;
+}
@@ -56,13 +56,16 @@ public:
     //   t: Memory type to use
     //   length: size of the memory block
     //   ptr: Pointer to existing memory, optional
+    //   fd: DMA file descriptor, optional
+    //       for TCAM_MEMORY_TYPE_DMA_IMPORT this is the fd that shall be mapped
     // throws:
     //   std::runtime_error in case of fatal error
     //
     Memory(std::shared_ptr<AllocatorInterface> alloc,
            TCAM_MEMORY_TYPE t,
            size_t length,
-           void* ptr = nullptr);
+           void* ptr = nullptr,
+           int fd = -1);
 
     // Memory(TCAM_MEMORY_TYPE t, void* ptr, size_t length)
     //     : type_(t), ptr_(ptr), length_(length), external_(true)
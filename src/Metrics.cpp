@@ -0,0 +1,489 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "Metrics.h"
+
+#include "logging.h"
+#include "ThreadPolicy.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace tcam::metrics;
+
+namespace
+{
+
+enum class metric_type
+{
+    counter,
+    gauge,
+    histogram,
+};
+
+const char* to_string(metric_type t) noexcept
+{
+    switch (t)
+    {
+        case metric_type::counter:
+            return "counter";
+        case metric_type::gauge:
+            return "gauge";
+        case metric_type::histogram:
+            return "histogram";
+    }
+    return "unknown";
+}
+
+struct family
+{
+    metric_type type;
+    std::string help;
+
+    // keyed by the rendered label list
+    std::map<std::string, std::unique_ptr<counter>> counters;
+    std::map<std::string, std::unique_ptr<gauge>> gauges;
+    std::map<std::string, std::unique_ptr<histogram>> histograms;
+};
+
+struct registry
+{
+    std::mutex mtx;
+    std::map<std::string, family, std::less<>> families;
+};
+
+registry& get_registry()
+{
+    // never destroyed, the server thread and static objects may still use it at exit
+    static auto reg = new registry;
+    return *reg;
+}
+
+void append_escaped(std::string& out, std::string_view str)
+{
+    for (char c : str)
+    {
+        switch (c)
+        {
+            case '\\':
+                out += "\\\\";
+                break;
+            case '"':
+                out += "\\\"";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            default:
+                out += c;
+        }
+    }
+}
+
+// 'name="value",...' without the braces
+std::string render_labels(const label_list& labels)
+{
+    std::string rval;
+    for (const auto& [name, value] : labels)
+    {
+        if (!rval.empty())
+        {
+            rval += ',';
+        }
+        rval += name;
+        rval += "=\"";
+        append_escaped(rval, value);
+        rval += '"';
+    }
+    return rval;
+}
+
+void append_sample(std::string& out,
+                   std::string_view name,
+                   std::string_view suffix,
+                   const std::string& labels,
+                   std::string_view extra_label,
+                   const std::string& value)
+{
+    out += name;
+    out += suffix;
+    if (!labels.empty() || !extra_label.empty())
+    {
+        out += '{';
+        out += labels;
+        if (!labels.empty() && !extra_label.empty())
+        {
+            out += ',';
+        }
+        out += extra_label;
+        out += '}';
+    }
+    out += ' ';
+    out += value;
+    out += '\n';
+}
+
+std::string format_double(double v)
+{
+    return fmt::format("{}", v);
+}
+
+// Returns the family or nullptr when it exists with another type.
+family* find_family(registry& reg, std::string_view name, std::string_view help, metric_type type)
+{
+    auto iter = reg.families.find(name);
+    if (iter == reg.families.end())
+    {
+        iter = reg.families.emplace(std::string(name), family { type, std::string(help), {}, {}, {} })
+                   .first;
+    }
+    if (iter->second.type != type)
+    {
+        SPDLOG_ERROR("Metric '{}' is already registered as {}.", name, to_string(iter->second.type));
+        return nullptr;
+    }
+    return &iter->second;
+}
+
+std::string handle_request(std::string_view request)
+{
+    std::string_view path;
+    if (request.substr(0, 4) == "GET ")
+    {
+        request.remove_prefix(4);
+        path = request.substr(0, request.find_first_of(" ?\r\n"));
+    }
+
+    if (path != "/metrics" && path != "/")
+    {
+        return "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    }
+
+    auto body = render();
+    return fmt::format("HTTP/1.0 200 OK\r\n"
+                       "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                       "Content-Length: {}\r\n"
+                       "Connection: close\r\n\r\n{}",
+                       body.size(),
+                       body);
+}
+
+void serve_client(int fd)
+{
+    // keeps a stalled client from blocking the server
+    timeval timeout = { 1, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192)
+    {
+        auto n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0)
+        {
+            break;
+        }
+        request.append(buf, static_cast<size_t>(n));
+    }
+
+    const auto response = handle_request(request);
+
+    size_t sent = 0;
+    while (sent < response.size())
+    {
+        auto n = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            break;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    close(fd);
+}
+
+void server_thread_func(int listen_fd)
+{
+    tcam::thread_policy::setup_thread("tcam_metrics");
+
+    while (true)
+    {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            SPDLOG_ERROR("Metrics server stopped: {}", strerror(errno));
+            close(listen_fd);
+            return;
+        }
+        serve_client(fd);
+    }
+}
+
+void start_server(int port)
+{
+    const auto address = tcam::get_environment_variable("TCAM_METRICS_ADDRESS", "127.0.0.1");
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1)
+    {
+        SPDLOG_ERROR("TCAM_METRICS_ADDRESS '{}' is not an IPv4 address.", address);
+        return;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        SPDLOG_ERROR("Unable to create metrics socket: {}", strerror(errno));
+        return;
+    }
+
+    int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 8) != 0)
+    {
+        // e.g. another process with the same environment already serves this port
+        SPDLOG_WARN("Unable to serve metrics on {}:{}: {}", address, port, strerror(errno));
+        close(fd);
+        return;
+    }
+
+    SPDLOG_INFO("Serving metrics on http://{}:{}/metrics", address, port);
+
+    // runs until the process exits
+    std::thread(server_thread_func, fd).detach();
+}
+
+int get_port() noexcept
+{
+    static const int port = []
+    {
+        int p = tcam::get_environment_variable_int("TCAM_METRICS_PORT").value_or(0);
+        if (p < 0 || p > 65535)
+        {
+            SPDLOG_ERROR("TCAM_METRICS_PORT {} is not a valid port, metrics are disabled.", p);
+            return 0;
+        }
+        return p;
+    }();
+    return port;
+}
+
+registry* get_active_registry()
+{
+    if (!is_enabled())
+    {
+        return nullptr;
+    }
+
+    static std::once_flag server_started;
+    std::call_once(server_started, [] { start_server(get_port()); });
+
+    return &get_registry();
+}
+
+} // namespace
+
+
+histogram::histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)), buckets_(std::make_unique<std::atomic<uint64_t>[]>(bounds_.size() + 1))
+{
+    std::sort(bounds_.begin(), bounds_.end());
+    for (size_t i = 0; i <= bounds_.size(); ++i) { buckets_[i].store(0, std::memory_order_relaxed); }
+}
+
+
+void histogram::observe(double v) noexcept
+{
+    const auto index = static_cast<size_t>(
+        std::lower_bound(bounds_.begin(), bounds_.end(), v) - bounds_.begin());
+    buckets_[index].fetch_add(1, std::memory_order_relaxed);
+
+    double sum = sum_.load(std::memory_order_relaxed);
+    while (!sum_.compare_exchange_weak(sum, sum + v, std::memory_order_relaxed)) {}
+}
+
+
+histogram::snapshot histogram::get() const
+{
+    snapshot rval;
+    rval.bounds = bounds_;
+    rval.buckets.resize(bounds_.size() + 1);
+
+    uint64_t total = 0;
+    for (size_t i = 0; i <= bounds_.size(); ++i)
+    {
+        total += buckets_[i].load(std::memory_order_relaxed);
+        rval.buckets[i] = total;
+    }
+    rval.sum = sum_.load(std::memory_order_relaxed);
+    rval.count = total;
+
+    return rval;
+}
+
+
+std::vector<double> tcam::metrics::duration_buckets()
+{
+    return { 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005,
+             0.01,    0.025,  0.05,    0.1,    0.25,  0.5,    1.0 };
+}
+
+
+bool tcam::metrics::is_enabled() noexcept
+{
+    return get_port() != 0;
+}
+
+
+counter* tcam::metrics::get_counter(std::string_view name,
+                                    std::string_view help,
+                                    const label_list& labels)
+{
+    auto reg = get_active_registry();
+    if (!reg)
+    {
+        return nullptr;
+    }
+
+    std::scoped_lock lck { reg->mtx };
+    auto fam = find_family(*reg, name, help, metric_type::counter);
+    if (!fam)
+    {
+        return nullptr;
+    }
+    auto& ptr = fam->counters[render_labels(labels)];
+    if (!ptr)
+    {
+        ptr = std::make_unique<counter>();
+    }
+    return ptr.get();
+}
+
+
+gauge* tcam::metrics::get_gauge(std::string_view name,
+                                std::string_view help,
+                                const label_list& labels)
+{
+    auto reg = get_active_registry();
+    if (!reg)
+    {
+        return nullptr;
+    }
+
+    std::scoped_lock lck { reg->mtx };
+    auto fam = find_family(*reg, name, help, metric_type::gauge);
+    if (!fam)
+    {
+        return nullptr;
+    }
+    auto& ptr = fam->gauges[render_labels(labels)];
+    if (!ptr)
+    {
+        ptr = std::make_unique<gauge>();
+    }
+    return ptr.get();
+}
+
+
+histogram* tcam::metrics::get_histogram(std::string_view name,
+                                        std::string_view help,
+                                        const label_list& labels,
+                                        const std::vector<double>& bounds)
+{
+    auto reg = get_active_registry();
+    if (!reg)
+    {
+        return nullptr;
+    }
+
+    std::scoped_lock lck { reg->mtx };
+    auto fam = find_family(*reg, name, help, metric_type::histogram);
+    if (!fam)
+    {
+        return nullptr;
+    }
+    auto& ptr = fam->histograms[render_labels(labels)];
+    if (!ptr)
+    {
+        ptr = std::make_unique<histogram>(bounds);
+    }
+    return ptr.get();
+}
+
+
+std::string tcam::metrics::render()
+{
+    std::string out;
+
+    auto& reg = get_registry();
+    std::scoped_lock lck { reg.mtx };
+
+    for (const auto& [name, fam] : reg.families)
+    {
+        out += fmt::format("# TYPE {} {}\n", name, to_string(fam.type));
+        if (!fam.help.empty())
+        {
+            out += fmt::format("# HELP {} ", name);
+            append_escaped(out, fam.help);
+            out += '\n';
+        }
+
+        for (const auto& [labels, c] : fam.counters)
+        {
+            append_sample(out, name, "_total", labels, {}, std::to_string(c->get()));
+        }
+        for (const auto& [labels, g] : fam.gauges)
+        {
+            append_sample(out, name, {}, labels, {}, std::to_string(g->get()));
+        }
+        for (const auto& [labels, h] : fam.histograms)
+        {
+            const auto snap = h->get();
+            for (size_t i = 0; i < snap.buckets.size(); ++i)
+            {
+                const auto le = i < snap.bounds.size() ? format_double(snap.bounds[i]) : "+Inf";
+                append_sample(out,
+                              name,
+                              "_bucket",
+                              labels,
+                              fmt::format("le=\"{}\"", le),
+                              std::to_string(snap.buckets[i]));
+            }
+            append_sample(out, name, "_sum", labels, {}, format_double(snap.sum));
+            append_sample(out, name, "_count", labels, {}, std::to_string(snap.count));
+        }
+    }
+    out += "# EOF\n";
+
+    return out;
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace tcam::metrics
+{
+
+//
+// Process wide counters, gauges and histograms in the OpenMetrics text format.
+//
+// Only active when TCAM_METRICS_PORT is set, the first registration then starts a thread that
+// answers 'GET /metrics' on that port. While inactive the get_* functions return nullptr and
+// nothing is collected, callers keep the returned pointers and skip their updates when they
+// are null.
+//
+// Metrics are never removed, the returned pointers stay valid until the process exits.
+// Updates are lock free.
+//
+
+using label_list = std::vector<std::pair<std::string, std::string>>;
+
+class counter
+{
+public:
+    void inc(uint64_t n = 1) noexcept
+    {
+        value_.fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t get() const noexcept
+    {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> value_ = 0;
+};
+
+class gauge
+{
+public:
+    void set(int64_t v) noexcept
+    {
+        value_.store(v, std::memory_order_relaxed);
+    }
+    int64_t get() const noexcept
+    {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<int64_t> value_ = 0;
+};
+
+class histogram
+{
+public:
+    // bounds are the ascending upper bounds of the buckets, +Inf is implicit
+    explicit histogram(std::vector<double> bounds);
+
+    void observe(double v) noexcept;
+
+    void observe(std::chrono::nanoseconds duration) noexcept
+    {
+        observe(std::chrono::duration<double>(duration).count());
+    }
+
+    struct snapshot
+    {
+        std::vector<double> bounds;
+        // cumulative, one more than bounds for +Inf
+        std::vector<uint64_t> buckets;
+        double sum = 0;
+        uint64_t count = 0;
+    };
+    snapshot get() const;
+
+private:
+    std::vector<double> bounds_;
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+    std::atomic<double> sum_ = 0;
+};
+
+// in seconds, 50 us up to 1 s
+std::vector<double> duration_buckets();
+
+bool is_enabled() noexcept;
+
+// Returns the metric with the given name and labels, creates it on first use.
+// The names follow the OpenMetrics conventions, counters are exposed with a '_total' suffix.
+// All metrics of one name have to be of the same type, nullptr otherwise or when disabled.
+counter* get_counter(std::string_view name, std::string_view help, const label_list& labels);
+gauge* get_gauge(std::string_view name, std::string_view help, const label_list& labels);
+histogram* get_histogram(std::string_view name,
+                         std::string_view help,
+                         const label_list& labels,
+                         const std::vector<double>& bounds = duration_buckets());
+
+// all metrics in the OpenMetrics text format, including the terminating '# EOF'
+std::string render();
+
+// adds the time between construction and destruction to the histogram, when there is one
+class scoped_timer
+{
+public:
+    explicit scoped_timer(histogram* h) noexcept : histogram_(h)
+    {
+        if (histogram_)
+        {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+    ~scoped_timer()
+    {
+        if (histogram_)
+        {
+            histogram_->observe(std::chrono::steady_clock::now() - start_);
+        }
+    }
+
+    scoped_timer(const scoped_timer&) = delete;
+    scoped_timer& operator=(const scoped_timer&) = delete;
+
+private:
+    histogram* histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace tcam::metrics
@@ -0,0 +1,257 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ParameterSequencer.h"
+
+#include "logging.h"
+
+#include <algorithm>
+
+using namespace tcam;
+
+namespace
+{
+
+bool is_compatible(tcamprop1::prop_type type, const parameter_value& value)
+{
+    switch (type)
+    {
+        case tcamprop1::prop_type::Integer:
+        {
+            return std::holds_alternative<int64_t>(value);
+        }
+        case tcamprop1::prop_type::Float:
+        {
+            return std::holds_alternative<double>(value) || std::holds_alternative<int64_t>(value);
+        }
+        case tcamprop1::prop_type::Boolean:
+        {
+            return std::holds_alternative<bool>(value);
+        }
+        case tcamprop1::prop_type::Enumeration:
+        {
+            return std::holds_alternative<std::string>(value);
+        }
+        case tcamprop1::prop_type::Command:
+        case tcamprop1::prop_type::String:
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+
+outcome::result<void> write_value(tcam::property::IPropertyBase& prop, const parameter_value& value)
+{
+    using namespace tcam::property;
+
+    switch (prop.get_type())
+    {
+        case tcamprop1::prop_type::Integer:
+        {
+            return static_cast<IPropertyInteger&>(prop).set_value(std::get<int64_t>(value));
+        }
+        case tcamprop1::prop_type::Float:
+        {
+            double v = std::holds_alternative<double>(value)
+                           ? std::get<double>(value)
+                           : static_cast<double>(std::get<int64_t>(value));
+            return static_cast<IPropertyFloat&>(prop).set_value(v);
+        }
+        case tcamprop1::prop_type::Boolean:
+        {
+            return static_cast<IPropertyBool&>(prop).set_value(std::get<bool>(value));
+        }
+        case tcamprop1::prop_type::Enumeration:
+        {
+            return static_cast<IPropertyEnum&>(prop).set_value(std::get<std::string>(value));
+        }
+        case tcamprop1::prop_type::Command:
+        case tcamprop1::prop_type::String:
+        {
+            break;
+        }
+    }
+    return tcam::status::PropertyNotImplemented;
+}
+
+} // namespace
+
+
+outcome::result<void> ParameterSequencer::queue(
+    parameter_set set,
+    const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& properties)
+{
+    if (set.id == 0)
+    {
+        return tcam::status::InvalidParameter;
+    }
+
+    resolved_set resolved;
+    resolved.id = set.id;
+    resolved.frame = set.frame;
+
+    for (auto& [name, value] : set.values)
+    {
+        auto prop = tcam::property::find_property(properties, name);
+        if (!prop)
+        {
+            SPDLOG_ERROR("Parameter set {}: No property '{}'", set.id, name);
+            return tcam::status::PropertyNotImplemented;
+        }
+        if (!is_compatible(prop->get_type(), value))
+        {
+            SPDLOG_ERROR("Parameter set {}: Value has the wrong type for '{}'", set.id, name);
+            return tcam::status::InvalidParameter;
+        }
+        resolved.values.emplace_back(prop, std::move(value));
+    }
+
+    std::scoped_lock lck { mtx_ };
+
+    // sets for the same frame are applied in the order they were queued
+    auto iter = std::upper_bound(queued_.begin(),
+                                 queued_.end(),
+                                 resolved.frame,
+                                 [](uint64_t frame, const resolved_set& s)
+                                 { return frame < s.frame; });
+    queued_.insert(iter, std::move(resolved));
+
+    return outcome::success();
+}
+
+
+void ParameterSequencer::clear()
+{
+    std::scoped_lock lck { mtx_ };
+
+    queued_.clear();
+    written_.clear();
+    active_id_ = 0;
+}
+
+
+void ParameterSequencer::set_apply_ahead(uint32_t frames)
+{
+    std::scoped_lock lck { mtx_ };
+    apply_ahead_ = frames;
+}
+
+
+uint32_t ParameterSequencer::get_apply_ahead() const
+{
+    std::scoped_lock lck { mtx_ };
+    return apply_ahead_;
+}
+
+
+void ParameterSequencer::write(const resolved_set& set)
+{
+    auto get_batch = [](tcam::property::IPropertyBase* prop)
+        -> std::shared_ptr<tcam::property::IPropertyWriteBatch>
+    {
+        auto provider = dynamic_cast<tcam::property::IPropertyWriteBatchProvider*>(prop);
+        return provider ? provider->get_write_batch() : nullptr;
+    };
+
+    // write everything in one transaction when the backend allows it,
+    // so that the device cannot start an image with half of the set
+    std::shared_ptr<tcam::property::IPropertyWriteBatch> batch;
+    for (const auto& [prop, value] : set.values)
+    {
+        auto prop_batch = get_batch(prop.get());
+        if (!prop_batch || (batch && prop_batch != batch))
+        {
+            batch = nullptr;
+            break;
+        }
+        batch = prop_batch;
+    }
+
+    if (batch && set.values.size() > 1)
+    {
+        batch->begin_writes();
+    }
+    else
+    {
+        batch = nullptr;
+    }
+
+    for (const auto& [prop, value] : set.values)
+    {
+        auto res = write_value(*prop, value);
+        if (!res)
+        {
+            SPDLOG_ERROR("Parameter set {}: Unable to set {}: {}",
+                         set.id,
+                         prop->get_name(),
+                         res.error().message());
+        }
+    }
+
+    if (batch)
+    {
+        auto res = batch->commit_writes();
+        if (!res)
+        {
+            SPDLOG_ERROR("Parameter set {}: Unable to write: {}", set.id, res.error().message());
+        }
+    }
+}
+
+
+uint32_t ParameterSequencer::on_image(uint64_t frame_count)
+{
+    std::unique_lock lck { mtx_ };
+
+    const uint64_t effective_frame = frame_count + apply_ahead_;
+
+    std::vector<resolved_set> due;
+    while (!queued_.empty() && queued_.front().frame <= effective_frame)
+    {
+        due.push_back(std::move(queued_.front()));
+        queued_.pop_front();
+    }
+
+    if (!due.empty())
+    {
+        // writes can take milliseconds, do not block queue()
+        lck.unlock();
+        for (const auto& set : due)
+        {
+            if (set.frame < effective_frame)
+            {
+                SPDLOG_WARN("Parameter set {} for frame {} only applies from frame {}.",
+                            set.id,
+                            set.frame,
+                            effective_frame);
+            }
+            write(set);
+        }
+        lck.lock();
+
+        for (const auto& set : due) { written_.push_back({ set.id, effective_frame }); }
+    }
+
+    while (!written_.empty() && written_.front().effective_frame <= frame_count)
+    {
+        active_id_ = written_.front().id;
+        written_.pop_front();
+    }
+
+    return active_id_;
+}
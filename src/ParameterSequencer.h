@@ -0,0 +1,103 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "PropertyInterfaces.h"
+#include "error.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace tcam
+{
+
+// Integer takes int64_t, Float double or int64_t, Boolean bool and Enumeration std::string
+using parameter_value = std::variant<bool, int64_t, double, std::string>;
+
+struct parameter_set
+{
+    // reported as tcam_stream_statistics::parameter_set_id, must not be 0
+    uint32_t id = 0;
+    // frame_count of the first image that shall be taken with these values
+    uint64_t frame = 0;
+    std::vector<std::pair<std::string, parameter_value>> values;
+};
+
+//
+// Applies parameter sets in the stream thread, keyed to the frame_count of the images.
+//
+// Properties only take effect some images after they were written, because the following
+// images are already being exposed or transferred. A set is therefore written when the image
+// apply_ahead frames before its frame arrives. The images are tagged with the set that was
+// written at least apply_ahead frames before them, so sets that could only be written late
+// are reported from the image they really apply to.
+//
+class ParameterSequencer
+{
+public:
+    // validates the set against properties and sorts it into the queue
+    outcome::result<void> queue(
+        parameter_set set,
+        const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& properties);
+
+    // drops all queued sets and forgets the active one, e.g. because a new stream starts
+    void clear();
+
+    void set_apply_ahead(uint32_t frames);
+    uint32_t get_apply_ahead() const;
+
+    // Called for every image in the stream thread.
+    // Writes the sets that are due and returns the id of the set the image was taken with,
+    // 0 when no set became active yet.
+    uint32_t on_image(uint64_t frame_count);
+
+private:
+    struct resolved_set
+    {
+        uint32_t id = 0;
+        uint64_t frame = 0;
+        std::vector<std::pair<std::shared_ptr<tcam::property::IPropertyBase>, parameter_value>>
+            values;
+    };
+
+    struct written_set
+    {
+        uint32_t id = 0;
+        uint64_t effective_frame = 0;
+    };
+
+    static void write(const resolved_set& set);
+
+    mutable std::mutex mtx_;
+
+    uint32_t apply_ahead_ = 2;
+
+    // sorted by frame
+    std::deque<resolved_set> queued_;
+    // written, but the images taken with them did not arrive yet
+    std::deque<written_set> written_;
+
+    uint32_t active_id_ = 0;
+};
+
+} // namespace tcam
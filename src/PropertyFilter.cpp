@@ -1,24 +1,31 @@
 
 #include "PropertyFilter.h"
 
+#include "DeviceInfo.h"
 #include "ImageBuffer.h"
 #include "SoftwareProperties.h"
 #include "VideoFormatDescription.h"
 #include "logging.h"
+#include "tracepoints.h"
+#include "ThreadPolicy.h"
+#include "utils.h"
 
+#include <algorithm>
+#include <cstring>
 #include <dutils_img/image_fourcc_func.h>
+#include <dutils_img_lib/dutils_fcc_traits.h>
 
 namespace tcam::stream::filter
 {
 
+// images after the last submitted statistics, that apply() leaves to tcamconvert
+static constexpr uint64_t external_statistics_timeout = 8;
+
 static bool has_bayer_format(const std::vector<VideoFormatDescription>& device_formats)
 {
     for (const auto& format : device_formats)
     {
-        auto fcc = (img::fourcc)format.get_fourcc();
-        if (img::is_by8_fcc(fcc) || img::is_by10_packed_fcc(fcc) || img::is_by12_packed_fcc(fcc)
-            || img::is_by16_fcc(fcc) || img::is_by12_fcc(fcc) || img::is_by10_fcc(fcc)
-            || img::is_byfloat_fcc(fcc))
+        if (img_lib::fcc_traits::get(format.get_fourcc()).is_bayer())
         {
             return true;
         }
@@ -26,12 +33,64 @@ static bool has_bayer_format(const std::vector<VideoFormatDescription>& device_f
     return false;
 }
 
+SoftwarePropertyWrapper::~SoftwarePropertyWrapper()
+{
+    stop_worker();
+}
+
+
+void SoftwarePropertyWrapper::stop_worker()
+{
+    {
+        std::lock_guard lck { m_worker_mtx };
+        m_stop_worker = true;
+    }
+    m_worker_cv.notify_all();
+
+    if (m_worker.joinable())
+    {
+        m_worker.join();
+    }
+
+    m_stop_worker = false;
+    m_input_pending = false;
+
+    std::lock_guard lck { m_external_mtx };
+    m_frame_params.fill(std::nullopt);
+    m_last_external_frame.reset();
+    m_accepts_channel_statistics = false;
+}
+
+
 void SoftwarePropertyWrapper::setup(
     const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& props,
-    const std::vector<VideoFormatDescription>& device_formats)
+    const std::vector<VideoFormatDescription>& device_formats,
+    const std::shared_ptr<tcam::property::PropertyNotifier>& notifier,
+    const DeviceInfo& device)
 {
+    stop_worker();
+
     bool has_bayer = has_bayer_format(device_formats);
-    m_impl = tcam::property::SoftwareProperties::create(props, has_bayer);
+    m_impl = tcam::property::SoftwareProperties::create(
+        props, has_bayer, notifier, tcam::property::emulated::find_auto_tuning_profile(device));
+
+    const metrics::label_list labels = { { "serial", device.get_serial() } };
+    m_pass_duration = metrics::get_histogram(
+        "tcam_auto_pass_duration_seconds", "Duration of the auto algorithm passes", labels);
+    m_impl->set_write_latency_metric(
+        metrics::get_histogram("tcam_property_write_duration_seconds",
+                               "Duration of property writes",
+                               { { "serial", device.get_serial() }, { "source", "auto" } }));
+
+    for (auto input : { &m_capture_input, &m_pending_input, &m_work_input, &m_external_input })
+    {
+        if (!input->statistics)
+        {
+            input->statistics = auto_alg::make_statistics_ptr();
+        }
+    }
+
+    m_worker = std::thread(&SoftwarePropertyWrapper::worker_thread_func, this);
 }
 
 
@@ -39,11 +98,159 @@ void SoftwarePropertyWrapper::apply(ImageBuffer& buffer)
 {
     img::img_descriptor src = buffer.get_img_descriptor();
 
-    m_impl->auto_pass(src);
+    if (src.empty())
+    {
+        return;
+    }
+
+    auto& input = m_capture_input;
+    input.stream_id = buffer.get_stream_id();
+    input.frame_count = buffer.get_statistics().frame_count;
+
+    const auto chunk = buffer.get_chunk_data();
+    const auto chunk_exposure = chunk.has_exposure_time
+                                    ? std::optional<double>(chunk.exposure_time_us)
+                                    : std::nullopt;
+
+    auto stats = buffer.get_statistics();
+    const auto bracket = m_impl->on_image_bracketing(stats.frame_count, chunk_exposure);
+    if (bracket.count != 0 || stats.hdr_bracket_count != 0)
+    {
+        stats.hdr_bracket_index = bracket.index;
+        stats.hdr_bracket_count = bracket.count;
+        stats.hdr_exposure_us = bracket.exposure_us;
+        buffer.set_statistics(stats);
+    }
+
+    const auto params = m_impl->on_frame(stats.frame_count, chunk_exposure);
+    const bool focus_image_needed = m_impl->is_focus_image_needed();
+
+    {
+        std::lock_guard lck { m_external_mtx };
+
+        m_frame_params[stats.frame_count % m_frame_params.size()] =
+            frame_params { stats.frame_count, input.stream_id, params };
+
+        // the hdr gain of pwl images needs the float samples of the image
+        m_accepts_channel_statistics =
+            !focus_image_needed && img_lib::fcc_traits::get(src.fourcc_type()).is_bayer();
+        if (m_accepts_channel_statistics && m_last_external_frame
+            && stats.frame_count - *m_last_external_frame <= external_statistics_timeout)
+        {
+            // the statistics of this image follow with submit_channel_statistics
+            return;
+        }
+    }
+
+    m_impl->collect_statistics(src, params, *input.statistics);
+
+    if (focus_image_needed)
+    {
+        const size_t length = src.to_img_type().buffer_length;
+
+        input.focus_frame.resize(length);
+        memcpy(input.focus_frame.data(), src.data(), std::min(length, src.size()));
+
+        input.focus_image =
+            img::make_img_desc_from_linear_memory(src.to_img_type(), input.focus_frame.data());
+    }
+    else
+    {
+        input.focus_image = {};
+    }
+
+    {
+        std::lock_guard lck { m_worker_mtx };
+        std::swap(m_capture_input, m_pending_input);
+        m_input_pending = true;
+    }
+    m_worker_cv.notify_one();
+}
+
+
+bool SoftwarePropertyWrapper::submit_channel_statistics(
+    uint64_t frame_count,
+    const auto_alg::channel_statistics& channels)
+{
+    if (!m_impl || !m_impl->is_statistics_needed())
+    {
+        return false;
+    }
+
+    std::lock_guard lck { m_external_mtx };
+
+    if (!m_accepts_channel_statistics)
+    {
+        return false;
+    }
+
+    const auto& entry = m_frame_params[frame_count % m_frame_params.size()];
+    if (!entry || entry->frame_count != frame_count)
+    {
+        // too old, the following ones are still used
+        return true;
+    }
+    m_last_external_frame = frame_count;
+
+    auto& input = m_external_input;
+    input.stream_id = entry->stream_id;
+    input.frame_count = frame_count;
+    input.focus_image = {};
+
+    m_impl->collect_statistics(channels, entry->params, *input.statistics);
+
+    {
+        std::lock_guard worker_lck { m_worker_mtx };
+        std::swap(m_external_input, m_pending_input);
+        m_input_pending = true;
+    }
+    m_worker_cv.notify_one();
+    return true;
+}
+
+
+void SoftwarePropertyWrapper::worker_thread_func()
+{
+    tcam::thread_policy::setup_thread("tcam_auto_alg");
+
+    std::unique_lock lck { m_worker_mtx };
+
+    while (true)
+    {
+        m_worker_cv.wait(lck, [this] { return m_input_pending || m_stop_worker; });
+
+        if (m_stop_worker)
+        {
+            return;
+        }
+
+        std::swap(m_pending_input, m_work_input);
+        m_input_pending = false;
+
+        lck.unlock();
+        {
+            std::lock_guard pass_lck { m_pass_mtx };
+            tcam::timing::record(tcam::timing::stage::auto_pass_begin,
+                                 m_work_input.stream_id,
+                                 m_work_input.frame_count);
+            TCAM_TRACE2(auto_pass_begin, m_work_input.stream_id, m_work_input.frame_count);
+            {
+                metrics::scoped_timer timer { m_pass_duration };
+                m_impl->auto_pass(*m_work_input.statistics, m_work_input.focus_image);
+            }
+            TCAM_TRACE2(auto_pass_end, m_work_input.stream_id, m_work_input.frame_count);
+            tcam::timing::record(tcam::timing::stage::auto_pass_end,
+                                 m_work_input.stream_id,
+                                 m_work_input.frame_count);
+        }
+        lck.lock();
+    }
 }
 
+
 void SoftwarePropertyWrapper::setVideoFormat(const VideoFormat& in)
 {
+    std::lock_guard pass_lck { m_pass_mtx };
     m_impl->update_to_new_format(in);
 }
 
@@ -52,4 +259,13 @@ std::vector<std::shared_ptr<tcam::property::IPropertyBase>> SoftwarePropertyWrap
     return m_impl->get_properties();
 }
 
+void SoftwarePropertyWrapper::set_brightness_roi_override(
+    const std::optional<tcam_image_roi>& roi) noexcept
+{
+    if (m_impl)
+    {
+        m_impl->set_brightness_roi_override(roi);
+    }
+}
+
 } // namespace tcam::stream::filter
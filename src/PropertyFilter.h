@@ -1,15 +1,26 @@
 #pragma once
 
+#include "Metrics.h"
 #include "PropertyInterfaces.h"
+#include "base_types.h"
 #include "compiler_defines.h"
 
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <dutils_img/image_transform_base.h>
+#include <dutils_img_pipe/auto_alg_pass.h>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include <vector>
 
 VISIBILITY_INTERNAL
 
 namespace tcam
 {
+class DeviceInfo;
 class VideoFormat;
 class VideoFormatDescription;
 class ImageBuffer;
@@ -23,14 +34,28 @@ class SoftwareProperties;
 namespace tcam::stream::filter
 {
 
+// Runs the auto algorithms (exposure, gain, iris, focus, white balance)
+// in a dedicated worker thread.
+// apply() only collects sparse image statistics for the worker, so that slow
+// device property writes do not stall image delivery.
+// The full image is only copied while auto focus is running.
+// When the worker is busy, newer statistics replace ones it has not picked up yet.
+// While tcamconvert hands in the statistics it collects during the conversion, see
+// submit_channel_statistics, apply() does not sample the bayer images itself.
 class SoftwarePropertyWrapper
 {
 public:
     SoftwarePropertyWrapper() = default;
+    ~SoftwarePropertyWrapper();
+
+    SoftwarePropertyWrapper(const SoftwarePropertyWrapper&) = delete;
+    SoftwarePropertyWrapper& operator=(const SoftwarePropertyWrapper&) = delete;
 
     void    setup(
         const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& props,
-        const std::vector<VideoFormatDescription>& device_formats);
+        const std::vector<VideoFormatDescription>& device_formats,
+        const std::shared_ptr<tcam::property::PropertyNotifier>& notifier,
+        const DeviceInfo& device);
 
     void apply(ImageBuffer&);
 
@@ -38,8 +63,67 @@ public:
 
     std::vector<std::shared_ptr<tcam::property::IPropertyBase>> getProperties();
 
+    // see SoftwareProperties::set_brightness_roi_override
+    void set_brightness_roi_override(const std::optional<tcam_image_roi>& roi) noexcept;
+
+    // Statistics of the image with frame_count, collected by tcamconvert while converting it.
+    // Returns false when they are not used, e.g. while no auto function is enabled or the image is
+    // not bayer. Called from another thread than apply().
+    bool submit_channel_statistics(uint64_t frame_count,
+                                   const auto_alg::channel_statistics& channels);
+
 private:
+    void worker_thread_func();
+    void stop_worker();
+
     std::shared_ptr<tcam::property::SoftwareProperties> m_impl;
+
+    std::thread m_worker;
+    std::mutex m_worker_mtx;
+    std::condition_variable m_worker_cv;
+    bool m_stop_worker = false;
+
+    struct auto_pass_input
+    {
+        auto_alg::statistics_ptr statistics;
+        // of the image the statistics were collected from, see tcam::timing
+        uint32_t stream_id = 0;
+        uint64_t frame_count = 0;
+        std::vector<uint8_t> focus_frame;
+        // empty when auto focus does not need the image
+        img::img_descriptor focus_image = {};
+    };
+
+    // triple buffer, only swapped under m_worker_mtx
+    auto_pass_input m_capture_input; // only touched by apply()
+    auto_pass_input m_pending_input;
+    auto_pass_input m_work_input; // only touched by the worker
+    // true while m_pending_input holds statistics that have not been evaluated yet
+    bool m_input_pending = false;
+
+    // held by the worker while it runs an auto pass
+    std::mutex m_pass_mtx;
+
+    // the parameters of the last images, indexed by frame_count % size, for the statistics that
+    // submit_channel_statistics receives a few images later
+    struct frame_params
+    {
+        uint64_t frame_count = 0;
+        uint32_t stream_id = 0;
+        auto_alg::auto_pass_params params;
+    };
+
+    // guards the members below, taken before m_worker_mtx
+    std::mutex m_external_mtx;
+    std::array<std::optional<frame_params>, 16> m_frame_params;
+    // the frame_count of the last statistics that were submitted
+    std::optional<uint64_t> m_last_external_frame;
+    // false while the images are not bayer or auto focus needs them
+    bool m_accepts_channel_statistics = false;
+    // filled by submit_channel_statistics, then swapped with m_pending_input
+    auto_pass_input m_external_input;
+
+    metrics::histogram* m_pass_duration = nullptr;
 };
 
 
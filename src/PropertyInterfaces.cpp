@@ -17,3 +17,34 @@ std::shared_ptr<tcam::property::IPropertyBase> tcam::property::find_property(
     }
     return (*iter);
 }
+
+
+int tcam::property::PropertyNotifier::subscribe(callback_t cb)
+{
+    std::scoped_lock lck { mtx_ };
+
+    const int id = next_id_++;
+    callbacks_.emplace_back(id, std::move(cb));
+    return id;
+}
+
+
+void tcam::property::PropertyNotifier::unsubscribe(int id)
+{
+    std::scoped_lock lck { mtx_ };
+
+    callbacks_.erase(std::remove_if(callbacks_.begin(),
+                                    callbacks_.end(),
+                                    [id](const auto& entry) { return entry.first == id; }),
+                     callbacks_.end());
+}
+
+
+void tcam::property::PropertyNotifier::notify(std::string_view name) const
+{
+    std::scoped_lock lck { mtx_ };
+
+    // callbacks may unsubscribe themselves
+    const auto callbacks = callbacks_;
+    for (const auto& [id, cb] : callbacks) { cb(name); }
+}
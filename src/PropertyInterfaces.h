@@ -20,7 +20,9 @@
 #include "base_types.h"
 #include "error.h"
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <tcamprop1.0_base/tcamprop_base.h>
@@ -156,6 +158,50 @@ public:
     virtual outcome::result<std::string> get_value() const = 0;
 };
 
+// Distributes notifications about properties whose value, range or flags may have changed.
+// An empty name means that any property may have changed, e.g. because the backend cannot tell
+// which properties depend on the one that was written.
+// Callbacks are invoked from the thread that detected the change.
+class PropertyNotifier
+{
+public:
+    using callback_t = std::function<void(std::string_view name)>;
+
+    // Returns an id for unsubscribe.
+    int subscribe(callback_t cb);
+
+    // When this returns the callback is not running and will not be invoked again.
+    void unsubscribe(int id);
+
+    void notify(std::string_view name) const;
+
+private:
+    mutable std::recursive_mutex mtx_;
+    int next_id_ = 1;
+    std::vector<std::pair<int, callback_t>> callbacks_;
+};
+
+// Implemented by device backends that can apply several property writes in one transaction.
+class IPropertyWriteBatch
+{
+public:
+    virtual ~IPropertyWriteBatch() = default;
+
+    // Writes from the calling thread are collected until commit_writes is called.
+    virtual void begin_writes() = 0;
+    virtual outcome::result<void> commit_writes() = 0;
+};
+
+// Optionally implemented by device properties.
+// Properties that return the same batch can be written together.
+class IPropertyWriteBatchProvider
+{
+public:
+    virtual ~IPropertyWriteBatchProvider() = default;
+
+    virtual std::shared_ptr<IPropertyWriteBatch> get_write_batch() const = 0;
+};
+
 
 template<class Tprop_type>
 inline std::shared_ptr<Tprop_type> find_property(
@@ -0,0 +1,718 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RawCodec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+constexpr int block_size = 32;
+
+enum class sample_layout
+{
+    invalid,
+    u8,
+    u16,
+    p10_mipi,
+    p10_spacked,
+    p12_mipi,
+    p12_packed,
+    p12_spacked,
+};
+
+struct codec_format
+{
+    sample_layout layout = sample_layout::invalid;
+    // distance to the same color neighbors, 2 for bayer patterns
+    int step = 1;
+    // pixels per packed group, the width has to be a multiple of it
+    int group = 1;
+};
+
+codec_format get_codec_format(img::fourcc fcc) noexcept
+{
+    const int step = img::is_bayer_fcc(fcc) ? 2 : 1;
+
+    switch (fcc)
+    {
+        case img::fourcc::MONO8:
+        case img::fourcc::BGGR8:
+        case img::fourcc::GBRG8:
+        case img::fourcc::RGGB8:
+        case img::fourcc::GRBG8:
+            return { sample_layout::u8, step, 1 };
+        case img::fourcc::MONO16:
+        case img::fourcc::BGGR16:
+        case img::fourcc::GBRG16:
+        case img::fourcc::RGGB16:
+        case img::fourcc::GRBG16:
+        case img::fourcc::MONO10:
+        case img::fourcc::BGGR10:
+        case img::fourcc::GBRG10:
+        case img::fourcc::RGGB10:
+        case img::fourcc::GRBG10:
+        case img::fourcc::MONO12:
+        case img::fourcc::BGGR12:
+        case img::fourcc::GBRG12:
+        case img::fourcc::RGGB12:
+        case img::fourcc::GRBG12:
+            return { sample_layout::u16, step, 1 };
+        case img::fourcc::MONO10_MIPI_PACKED:
+        case img::fourcc::BGGR10_MIPI_PACKED:
+        case img::fourcc::GBRG10_MIPI_PACKED:
+        case img::fourcc::RGGB10_MIPI_PACKED:
+        case img::fourcc::GRBG10_MIPI_PACKED:
+            return { sample_layout::p10_mipi, step, 4 };
+        case img::fourcc::MONO10_SPACKED:
+        case img::fourcc::BGGR10_SPACKED:
+        case img::fourcc::GBRG10_SPACKED:
+        case img::fourcc::RGGB10_SPACKED:
+        case img::fourcc::GRBG10_SPACKED:
+            return { sample_layout::p10_spacked, step, 4 };
+        case img::fourcc::MONO12_MIPI_PACKED:
+        case img::fourcc::BGGR12_MIPI_PACKED:
+        case img::fourcc::GBRG12_MIPI_PACKED:
+        case img::fourcc::RGGB12_MIPI_PACKED:
+        case img::fourcc::GRBG12_MIPI_PACKED:
+            return { sample_layout::p12_mipi, step, 2 };
+        case img::fourcc::MONO12_PACKED:
+        case img::fourcc::BGGR12_PACKED:
+        case img::fourcc::GBRG12_PACKED:
+        case img::fourcc::RGGB12_PACKED:
+        case img::fourcc::GRBG12_PACKED:
+            return { sample_layout::p12_packed, step, 2 };
+        case img::fourcc::MONO12_SPACKED:
+        case img::fourcc::BGGR12_SPACKED:
+        case img::fourcc::GBRG12_SPACKED:
+        case img::fourcc::RGGB12_SPACKED:
+        case img::fourcc::GRBG12_SPACKED:
+            return { sample_layout::p12_spacked, step, 2 };
+        default:
+            return {};
+    }
+}
+
+bool is_packed(sample_layout layout) noexcept
+{
+    return layout != sample_layout::u8 && layout != sample_layout::u16;
+}
+
+bool is_valid_dim(const codec_format& fmt, img::dim dim) noexcept
+{
+    return fmt.layout != sample_layout::invalid && dim.cx > 0 && dim.cy > 0
+           && dim.cx % fmt.group == 0;
+}
+
+
+void unpack_line(sample_layout layout, const uint8_t* src, uint16_t* dst, int width) noexcept
+{
+    switch (layout)
+    {
+        case sample_layout::p10_mipi:
+        {
+            for (int x = 0; x < width; x += 4, src += 5)
+            {
+                for (int i = 0; i < 4; ++i)
+                {
+                    dst[x + i] = static_cast<uint16_t>(src[i] << 2 | ((src[4] >> (2 * i)) & 0x3));
+                }
+            }
+            break;
+        }
+        case sample_layout::p10_spacked:
+        {
+            for (int x = 0; x < width; x += 4, src += 5)
+            {
+                uint64_t v = 0;
+                memcpy(&v, src, 5);
+                for (int i = 0; i < 4; ++i)
+                {
+                    dst[x + i] = static_cast<uint16_t>((v >> (10 * i)) & 0x3FF);
+                }
+            }
+            break;
+        }
+        case sample_layout::p12_mipi:
+        {
+            for (int x = 0; x < width; x += 2, src += 3)
+            {
+                dst[x] = static_cast<uint16_t>(src[0] << 4 | (src[2] & 0xF));
+                dst[x + 1] = static_cast<uint16_t>(src[1] << 4 | src[2] >> 4);
+            }
+            break;
+        }
+        case sample_layout::p12_packed:
+        {
+            for (int x = 0; x < width; x += 2, src += 3)
+            {
+                dst[x] = static_cast<uint16_t>(src[0] << 4 | (src[1] & 0xF));
+                dst[x + 1] = static_cast<uint16_t>(src[2] << 4 | src[1] >> 4);
+            }
+            break;
+        }
+        case sample_layout::p12_spacked:
+        {
+            for (int x = 0; x < width; x += 2, src += 3)
+            {
+                dst[x] = static_cast<uint16_t>(src[0] | (src[1] & 0xF) << 8);
+                dst[x + 1] = static_cast<uint16_t>(src[1] >> 4 | src[2] << 4);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+
+void pack_line(sample_layout layout, const uint16_t* src, uint8_t* dst, int width) noexcept
+{
+    switch (layout)
+    {
+        case sample_layout::p10_mipi:
+        {
+            for (int x = 0; x < width; x += 4, dst += 5)
+            {
+                uint8_t low = 0;
+                for (int i = 0; i < 4; ++i)
+                {
+                    dst[i] = static_cast<uint8_t>(src[x + i] >> 2);
+                    low |= static_cast<uint8_t>((src[x + i] & 0x3) << (2 * i));
+                }
+                dst[4] = low;
+            }
+            break;
+        }
+        case sample_layout::p10_spacked:
+        {
+            for (int x = 0; x < width; x += 4, dst += 5)
+            {
+                uint64_t v = 0;
+                for (int i = 0; i < 4; ++i)
+                {
+                    v |= static_cast<uint64_t>(src[x + i] & 0x3FF) << (10 * i);
+                }
+                memcpy(dst, &v, 5);
+            }
+            break;
+        }
+        case sample_layout::p12_mipi:
+        {
+            for (int x = 0; x < width; x += 2, dst += 3)
+            {
+                dst[0] = static_cast<uint8_t>(src[x] >> 4);
+                dst[1] = static_cast<uint8_t>(src[x + 1] >> 4);
+                dst[2] = static_cast<uint8_t>((src[x] & 0xF) | (src[x + 1] & 0xF) << 4);
+            }
+            break;
+        }
+        case sample_layout::p12_packed:
+        {
+            for (int x = 0; x < width; x += 2, dst += 3)
+            {
+                dst[0] = static_cast<uint8_t>(src[x] >> 4);
+                dst[1] = static_cast<uint8_t>((src[x] & 0xF) | (src[x + 1] & 0xF) << 4);
+                dst[2] = static_cast<uint8_t>(src[x + 1] >> 4);
+            }
+            break;
+        }
+        case sample_layout::p12_spacked:
+        {
+            for (int x = 0; x < width; x += 2, dst += 3)
+            {
+                dst[0] = static_cast<uint8_t>(src[x]);
+                dst[1] = static_cast<uint8_t>((src[x] >> 8 & 0xF) | (src[x + 1] & 0xF) << 4);
+                dst[2] = static_cast<uint8_t>(src[x + 1] >> 4);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+
+// maps small negative and positive residuals to small unsigned values, 0, -1, 1, -2, ...
+template<class T> T zigzag(T value) noexcept
+{
+    using signed_type = std::make_signed_t<T>;
+    const auto s = static_cast<signed_type>(value);
+    return static_cast<T>(static_cast<T>(value << 1) ^ static_cast<T>(s >> (sizeof(T) * 8 - 1)));
+}
+
+template<class T> T unzigzag(T value) noexcept
+{
+    return static_cast<T>((value >> 1) ^ static_cast<T>(-(value & 1)));
+}
+
+
+// Full blocks are packed with a width known at compile time. The values are expanded
+// with index sequences, so every shift and word index is a constant and the words stay in
+// registers. The last block of a line is shorter and takes the generic path.
+
+template<int Width> constexpr size_t block_words = (block_size * Width + 63) / 64;
+
+template<class T, int Width, size_t Index>
+void pack_value(const T* values, uint64_t (&words)[block_words<Width>]) noexcept
+{
+    constexpr size_t bit = Index * Width;
+    constexpr size_t shift = bit % 64;
+
+    const auto value = static_cast<uint64_t>(values[Index]);
+    words[bit / 64] |= value << shift;
+    if constexpr (shift + Width > 64)
+    {
+        words[bit / 64 + 1] |= value >> (64 - shift);
+    }
+}
+
+
+template<class T, int Width, size_t Index>
+void unpack_value(const uint64_t (&words)[block_words<Width>], T* values) noexcept
+{
+    constexpr size_t bit = Index * Width;
+    constexpr size_t shift = bit % 64;
+    constexpr uint64_t mask = (uint64_t(1) << Width) - 1;
+
+    uint64_t value = words[bit / 64] >> shift;
+    if constexpr (shift + Width > 64)
+    {
+        value |= words[bit / 64 + 1] << (64 - shift);
+    }
+    values[Index] = static_cast<T>(value & mask);
+}
+
+
+template<class T, int Width, size_t... Index>
+void pack_full_block(const T* values, uint8_t* out, std::index_sequence<Index...>) noexcept
+{
+    uint64_t words[block_words<Width>] = {};
+    (pack_value<T, Width, Index>(values, words), ...);
+    memcpy(out, words, block_size / 8 * Width);
+}
+
+
+// reads up to 4 bytes beyond the block, see stream_padding
+template<class T, int Width, size_t... Index>
+void unpack_full_block(const uint8_t* in, T* values, std::index_sequence<Index...>) noexcept
+{
+    uint64_t words[block_words<Width>];
+    memcpy(words, in, sizeof(words));
+    (unpack_value<T, Width, Index>(words, values), ...);
+}
+
+
+template<class T, int Width> void pack_full_block(const T* values, uint8_t* out) noexcept
+{
+    pack_full_block<T, Width>(values, out, std::make_index_sequence<block_size>());
+}
+
+
+template<class T, int Width> void unpack_full_block(const uint8_t* in, T* values) noexcept
+{
+    unpack_full_block<T, Width>(in, values, std::make_index_sequence<block_size>());
+}
+
+
+template<class T> struct block_functions
+{
+    using pack_fn = void (*)(const T*, uint8_t*) noexcept;
+    using unpack_fn = void (*)(const uint8_t*, T*) noexcept;
+
+    // index is the width - 1, blocks of width 0 have no data
+    template<size_t... Width> static constexpr auto make_pack(std::index_sequence<Width...>)
+    {
+        return std::array<pack_fn, sizeof...(Width)> { &pack_full_block<T, int(Width) + 1>... };
+    }
+    template<size_t... Width> static constexpr auto make_unpack(std::index_sequence<Width...>)
+    {
+        return std::array<unpack_fn, sizeof...(Width)> { &unpack_full_block<T, int(Width) + 1>... };
+    }
+
+    static constexpr auto pack = make_pack(std::make_index_sequence<sizeof(T) * 8>());
+    static constexpr auto unpack = make_unpack(std::make_index_sequence<sizeof(T) * 8>());
+};
+
+
+// block: bit width, followed by count values of that width, LSB first
+template<class T> uint8_t* write_block(const T* values, int count, uint8_t* out) noexcept
+{
+    unsigned combined = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        combined |= values[i];
+    }
+    const int width = combined ? 32 - __builtin_clz(combined) : 0;
+
+    *out++ = static_cast<uint8_t>(width);
+    if (width == 0)
+    {
+        return out;
+    }
+    if (count == block_size)
+    {
+        block_functions<T>::pack[width - 1](values, out);
+        return out + block_size / 8 * width;
+    }
+
+    uint64_t acc = 0;
+    int fill = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        acc |= static_cast<uint64_t>(values[i]) << fill;
+        fill += width;
+        if (fill >= 32)
+        {
+            const auto word = static_cast<uint32_t>(acc);
+            memcpy(out, &word, sizeof(word));
+            out += sizeof(word);
+            acc >>= 32;
+            fill -= 32;
+        }
+    }
+    for (; fill > 0; fill -= 8)
+    {
+        *out++ = static_cast<uint8_t>(acc);
+        acc >>= 8;
+    }
+    return out;
+}
+
+
+// nullptr when the stream is damaged
+template<class T>
+const uint8_t* read_block(const uint8_t* in, const uint8_t* end, T* values, int count) noexcept
+{
+    if (in >= end)
+    {
+        return nullptr;
+    }
+    const int width = *in++;
+    if (width > static_cast<int>(sizeof(T) * 8))
+    {
+        return nullptr;
+    }
+
+    // values are read with 32 bit loads, stream_padding covers the last ones
+    const size_t bytes = (static_cast<size_t>(count) * width + 7) / 8;
+    if (static_cast<size_t>(end - in) < bytes + tcam::raw_codec::stream_padding)
+    {
+        return nullptr;
+    }
+
+    if (width == 0)
+    {
+        std::fill(values, values + count, T(0));
+        return in;
+    }
+    if (count == block_size)
+    {
+        block_functions<T>::unpack[width - 1](in, values);
+        return in + bytes;
+    }
+
+    const uint32_t mask = (1u << width) - 1;
+    for (int i = 0; i < count; ++i)
+    {
+        const size_t bit = static_cast<size_t>(i) * width;
+        uint32_t word;
+        memcpy(&word, in + bit / 8, sizeof(word));
+        values[i] = static_cast<T>((word >> (bit % 8)) & mask);
+    }
+    return in + bytes;
+}
+
+
+// residual of the gradient predictor: cur - above - (left - above left)
+template<class T>
+uint8_t* encode_line(const T* cur, const T* above, int width, int step, T* residuals, uint8_t* out)
+{
+    for (int x = 0; x < step; ++x)
+    {
+        residuals[x] = zigzag(static_cast<T>(cur[x] - above[x]));
+    }
+    for (int x = step; x < width; ++x)
+    {
+        residuals[x] =
+            zigzag(static_cast<T>((cur[x] - above[x]) - (cur[x - step] - above[x - step])));
+    }
+
+    for (int x = 0; x < width; x += block_size)
+    {
+        out = write_block(residuals + x, std::min(block_size, width - x), out);
+    }
+    return out;
+}
+
+
+// Step is the distance to the same color neighbors, the running sums of cur - above
+// for every color are kept in registers.
+template<class T, int Step>
+const uint8_t* decode_line(const uint8_t* in,
+                           const uint8_t* end,
+                           const T* above,
+                           int width,
+                           T* cur) noexcept
+{
+    T residuals[block_size];
+    T left[Step] = {};
+
+    for (int x = 0; x < width; x += block_size)
+    {
+        const int count = std::min(block_size, width - x);
+        in = read_block(in, end, residuals, count);
+        if (!in)
+        {
+            return nullptr;
+        }
+
+        // block_size is a multiple of Step, so i and x + i have the same color
+        for (int i = 0; i < count; ++i)
+        {
+            T& diff = left[i % Step];
+            diff = static_cast<T>(diff + unzigzag(residuals[i]));
+            cur[x + i] = static_cast<T>(diff + above[x + i]);
+        }
+    }
+    return in;
+}
+
+
+// lines of an image as T values, packed formats are unpacked into a ring of 3 lines
+template<class T> class line_access
+{
+public:
+    line_access(const img::img_descriptor& img, sample_layout layout)
+        : img_(img), layout_(layout), packed_(is_packed(layout)), width_(img.dim.cx),
+          buffer_(static_cast<size_t>(width_) * (packed_ ? 5 : 2), T(0))
+    {
+    }
+
+    const T* zero_line() const noexcept
+    {
+        return buffer_.data();
+    }
+
+    T* residuals() noexcept
+    {
+        return buffer_.data() + width_;
+    }
+
+    // packed lines are unpacked by load, unpacked lines are used in place
+    const T* load(int y) noexcept
+    {
+        if (!packed_)
+        {
+            return img::get_line_start<T>(img_, y);
+        }
+        T* line = ring(y);
+        if constexpr (sizeof(T) == 2)
+        {
+            unpack_line(layout_, img::get_line_start(img_, y), line, width_);
+        }
+        return line;
+    }
+
+    // a line that was loaded or stored before
+    const T* get(int y) noexcept
+    {
+        return packed_ ? ring(y) : img::get_line_start<T>(img_, y);
+    }
+
+    T* begin_store(int y) noexcept
+    {
+        return packed_ ? ring(y) : img::get_line_start<T>(img_, y);
+    }
+
+    void end_store(int y) noexcept
+    {
+        if constexpr (sizeof(T) == 2)
+        {
+            if (packed_)
+            {
+                pack_line(layout_, ring(y), img::get_line_start(img_, y), width_);
+            }
+        }
+    }
+
+private:
+    T* ring(int y) noexcept
+    {
+        return buffer_.data() + static_cast<size_t>(width_) * (2 + y % 3);
+    }
+
+    img::img_descriptor img_;
+    sample_layout layout_;
+    bool packed_;
+    int width_;
+    // zero line, residuals, ring
+    std::vector<T> buffer_;
+};
+
+
+template<class T>
+uint8_t* compress_image(const img::img_descriptor& src,
+                        const codec_format& fmt,
+                        uint8_t* out)
+{
+    line_access<T> lines(src, fmt.layout);
+
+    for (int y = 0; y < src.dim.cy; ++y)
+    {
+        const T* cur = lines.load(y);
+        const T* above = y >= fmt.step ? lines.get(y - fmt.step) : lines.zero_line();
+        out = encode_line(cur, above, src.dim.cx, fmt.step, lines.residuals(), out);
+    }
+    return out;
+}
+
+
+template<class T>
+bool decompress_image(const uint8_t* in,
+                      const uint8_t* end,
+                      const codec_format& fmt,
+                      const img::img_descriptor& dst)
+{
+    line_access<T> lines(dst, fmt.layout);
+
+    for (int y = 0; y < dst.dim.cy; ++y)
+    {
+        const T* above = y >= fmt.step ? lines.get(y - fmt.step) : lines.zero_line();
+        T* cur = lines.begin_store(y);
+        in = fmt.step == 2 ? decode_line<T, 2>(in, end, above, dst.dim.cx, cur)
+                           : decode_line<T, 1>(in, end, above, dst.dim.cx, cur);
+        if (!in)
+        {
+            return false;
+        }
+        lines.end_store(y);
+    }
+    return true;
+}
+
+} // namespace
+
+
+bool tcam::raw_codec::is_supported(img::fourcc fcc) noexcept
+{
+    return get_codec_format(fcc).layout != sample_layout::invalid;
+}
+
+
+size_t tcam::raw_codec::calc_max_compressed_size(const img::img_type& type) noexcept
+{
+    const auto fmt = get_codec_format(type.fourcc_type());
+    if (!is_valid_dim(fmt, type.dim))
+    {
+        return 0;
+    }
+
+    const size_t width = type.dim.cx;
+    const size_t bits = fmt.layout == sample_layout::u8 ? 8 : 16;
+    const size_t line = (width + block_size - 1) / block_size + (width * bits + 7) / 8;
+
+    return sizeof(stream_header) + line * type.dim.cy + stream_padding;
+}
+
+
+size_t tcam::raw_codec::compress(const img::img_descriptor& src,
+                                 void* dst,
+                                 size_t dst_size) noexcept
+{
+    const auto fmt = get_codec_format(src.fourcc_type());
+    if (!is_valid_dim(fmt, src.dim)
+        || src.pitch() < img::calc_minimum_pitch(src.fourcc_type(), src.dim.cx)
+        || dst_size < calc_max_compressed_size(src.to_img_type()))
+    {
+        return 0;
+    }
+
+    stream_header header = {};
+    header.magic = stream_magic;
+    header.fourcc = src.type;
+    header.width = src.dim.cx;
+    header.height = src.dim.cy;
+
+    auto begin = static_cast<uint8_t*>(dst);
+    memcpy(begin, &header, sizeof(header));
+
+    uint8_t* out = begin + sizeof(header);
+    try
+    {
+        if (fmt.layout == sample_layout::u8)
+        {
+            out = compress_image<uint8_t>(src, fmt, out);
+        }
+        else
+        {
+            out = compress_image<uint16_t>(src, fmt, out);
+        }
+    }
+    catch (const std::bad_alloc&)
+    {
+        return 0;
+    }
+
+    memset(out, 0, stream_padding);
+    out += stream_padding;
+
+    return out - begin;
+}
+
+
+bool tcam::raw_codec::decompress(const void* src,
+                                 size_t src_size,
+                                 const img::img_descriptor& dst) noexcept
+{
+    const auto fmt = get_codec_format(dst.fourcc_type());
+    if (!is_valid_dim(fmt, dst.dim)
+        || dst.pitch() < img::calc_minimum_pitch(dst.fourcc_type(), dst.dim.cx)
+        || src_size < sizeof(stream_header) + stream_padding)
+    {
+        return false;
+    }
+
+    stream_header header;
+    memcpy(&header, src, sizeof(header));
+    if (header.magic != stream_magic || header.fourcc != dst.type
+        || header.width != static_cast<uint32_t>(dst.dim.cx)
+        || header.height != static_cast<uint32_t>(dst.dim.cy))
+    {
+        return false;
+    }
+
+    auto in = static_cast<const uint8_t*>(src) + sizeof(header);
+    auto end = static_cast<const uint8_t*>(src) + src_size;
+    try
+    {
+        if (fmt.layout == sample_layout::u8)
+        {
+            return decompress_image<uint8_t>(in, end, fmt, dst);
+        }
+        return decompress_image<uint16_t>(in, end, fmt, dst);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return false;
+    }
+}
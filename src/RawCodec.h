@@ -0,0 +1,73 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "compiler_defines.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <dutils_img/image_transform_base.h>
+
+VISIBILITY_DEFAULT
+
+namespace tcam::raw_codec
+{
+
+//
+// Lossless compression of raw mono and bayer images, for recordings.
+//
+// Every pixel is predicted from the same color pixels left, above and above left of it
+// (a gradient predictor, bayer images use their 2x2 pattern as neighborhood). The residuals
+// are stored in blocks of 32, each block is bit packed with the width of its largest residual.
+// Compression and decompression are a single pass over the image without tables, so both run
+// at memory speed for typical sensor noise.
+//
+// Packed 10 and 12 bit formats (MIPI, PACKED, SPACKED) are compressed from their
+// 10/12 bit values and restored bit exact. Line padding beyond the minimum pitch is not kept.
+//
+// A compressed image starts with a stream_header and ends with stream_padding zero bytes
+// the decoder may read but does not use. All values are little endian.
+//
+
+constexpr uint32_t stream_magic = 0x31435254; // "TRC1"
+constexpr size_t stream_padding = 4;
+
+struct stream_header
+{
+    uint32_t magic;
+    uint32_t fourcc;
+    uint32_t width;
+    uint32_t height;
+};
+
+bool is_supported(img::fourcc fcc) noexcept;
+
+// upper bound of compress for an image of type, 0 when the type is not supported
+size_t calc_max_compressed_size(const img::img_type& type) noexcept;
+
+// Returns the size of the compressed image in dst, 0 when the image is not supported
+// or dst_size is smaller than calc_max_compressed_size.
+size_t compress(const img::img_descriptor& src, void* dst, size_t dst_size) noexcept;
+
+// dst has to have the format and dimensions of the compressed image.
+// false when the stream is damaged or does not match dst.
+bool decompress(const void* src, size_t src_size, const img::img_descriptor& dst) noexcept;
+
+} // namespace tcam::raw_codec
+
+VISIBILITY_POP
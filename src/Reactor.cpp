@@ -0,0 +1,456 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Reactor.h"
+
+#include "logging.h"
+#include "ThreadPolicy.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace tcam;
+
+namespace
+{
+
+size_t get_worker_count()
+{
+    const int fallback = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, 4);
+    return std::max(
+        tcam::get_environment_variable_int("TCAM_REACTOR_THREADS").value_or(fallback), 1);
+}
+
+} // namespace
+
+
+class Reactor::strand
+{
+public:
+    std::deque<task> tasks;
+    // set while the strand is in ready_ or a worker processes it
+    bool is_scheduled = false;
+};
+
+
+struct Reactor::entry
+{
+    std::shared_ptr<strand> s;
+
+    int fd = -1;
+    uint32_t events = 0;
+    std::function<void(uint32_t)> fd_handler;
+
+    std::function<void()> timer_handler;
+    bool is_armed = false;
+    clock::time_point deadline;
+
+    // the worker that currently runs the handler
+    std::thread::id running_in;
+};
+
+
+bool Reactor::is_enabled()
+{
+    static const bool enabled = tcam::get_environment_variable_int("TCAM_REACTOR").value_or(0) != 0;
+    return enabled;
+}
+
+
+Reactor& Reactor::get_instance()
+{
+    static Reactor instance;
+    return instance;
+}
+
+
+Reactor::Reactor()
+{
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0)
+    {
+        SPDLOG_ERROR("Unable to create epoll instance: {}", strerror(errno));
+        return;
+    }
+
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake_fd_ < 0)
+    {
+        SPDLOG_ERROR("Unable to create eventfd: {}", strerror(errno));
+        return;
+    }
+
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = 0;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) < 0)
+    {
+        SPDLOG_ERROR("Unable to add eventfd to epoll: {}", strerror(errno));
+    }
+}
+
+
+Reactor::~Reactor()
+{
+    {
+        std::scoped_lock lck { mtx_ };
+        running_ = false;
+    }
+    wake();
+    work_cv_.notify_all();
+
+    if (reactor_thread_.joinable())
+    {
+        reactor_thread_.join();
+    }
+    for (auto& w : workers_)
+    {
+        if (w.joinable())
+        {
+            w.join();
+        }
+    }
+
+    if (wake_fd_ >= 0)
+    {
+        close(wake_fd_);
+    }
+    if (epoll_fd_ >= 0)
+    {
+        close(epoll_fd_);
+    }
+}
+
+
+std::shared_ptr<Reactor::strand> Reactor::create_strand()
+{
+    return std::make_shared<strand>();
+}
+
+
+void Reactor::start_threads()
+{
+    if (running_)
+    {
+        return;
+    }
+    running_ = true;
+
+    reactor_thread_ = std::thread(&Reactor::reactor_main, this);
+
+    const auto count = get_worker_count();
+    SPDLOG_DEBUG("Starting reactor with {} worker threads.", count);
+    for (size_t i = 0; i < count; ++i) { workers_.emplace_back(&Reactor::worker_main, this); }
+}
+
+
+Reactor::handle Reactor::add_entry(std::shared_ptr<entry> e)
+{
+    start_threads();
+
+    auto h = next_handle_++;
+    entries_.emplace(h, std::move(e));
+    return h;
+}
+
+
+Reactor::handle Reactor::watch_fd(int fd,
+                                  uint32_t events,
+                                  const std::shared_ptr<strand>& s,
+                                  std::function<void(uint32_t events)> handler)
+{
+    auto e = std::make_shared<entry>();
+    e->s = s;
+    e->fd = fd;
+    e->events = events;
+    e->fd_handler = std::move(handler);
+
+    std::scoped_lock lck { mtx_ };
+
+    auto h = add_entry(e);
+
+    epoll_event ev = {};
+    ev.events = events | EPOLLONESHOT;
+    ev.data.u64 = h;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+        SPDLOG_ERROR("Unable to add fd {} to epoll: {}", fd, strerror(errno));
+        entries_.erase(h);
+        return 0;
+    }
+    return h;
+}
+
+
+Reactor::handle Reactor::add_timer(const std::shared_ptr<strand>& s, std::function<void()> handler)
+{
+    auto e = std::make_shared<entry>();
+    e->s = s;
+    e->timer_handler = std::move(handler);
+
+    std::scoped_lock lck { mtx_ };
+    return add_entry(std::move(e));
+}
+
+
+void Reactor::arm_timer(handle h, clock::time_point deadline)
+{
+    bool is_earliest = false;
+    {
+        std::scoped_lock lck { mtx_ };
+
+        auto iter = entries_.find(h);
+        if (iter == entries_.end())
+        {
+            return;
+        }
+        auto& e = *iter->second;
+
+        if (e.is_armed)
+        {
+            auto [begin, end] = timers_.equal_range(e.deadline);
+            auto t = std::find_if(begin, end, [h](const auto& t) { return t.second == h; });
+            if (t != end)
+            {
+                timers_.erase(t);
+            }
+        }
+        is_earliest = timers_.empty() || deadline < timers_.begin()->first;
+        e.is_armed = true;
+        e.deadline = deadline;
+        timers_.emplace(deadline, h);
+    }
+
+    // streams rearm their timer with every image, only wake when the wait has to be shorter
+    if (is_earliest)
+    {
+        wake();
+    }
+}
+
+
+void Reactor::remove(handle h)
+{
+    std::unique_lock lck { mtx_ };
+
+    auto iter = entries_.find(h);
+    if (iter == entries_.end())
+    {
+        return;
+    }
+    auto e = iter->second;
+    entries_.erase(iter);
+
+    if (e->fd >= 0 && epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, e->fd, nullptr) < 0)
+    {
+        SPDLOG_ERROR("Unable to remove fd {} from epoll: {}", e->fd, strerror(errno));
+    }
+
+    if (e->is_armed)
+    {
+        auto [begin, end] = timers_.equal_range(e->deadline);
+        auto t = std::find_if(begin, end, [h](const auto& t) { return t.second == h; });
+        if (t != end)
+        {
+            timers_.erase(t);
+        }
+    }
+
+    if (e->running_in != std::this_thread::get_id())
+    {
+        done_cv_.wait(lck, [&e] { return e->running_in == std::thread::id {}; });
+    }
+}
+
+
+void Reactor::wake()
+{
+    uint64_t val = 1;
+    if (wake_fd_ >= 0 && write(wake_fd_, &val, sizeof(val)) != sizeof(val))
+    {
+        SPDLOG_ERROR("Unable to wake reactor thread: {}", strerror(errno));
+    }
+}
+
+
+void Reactor::post(const std::shared_ptr<strand>& s, task t)
+{
+    s->tasks.push_back(t);
+    if (!s->is_scheduled)
+    {
+        s->is_scheduled = true;
+        ready_.push_back(s);
+        work_cv_.notify_one();
+    }
+}
+
+
+void Reactor::rearm_fd(handle h, const entry& e)
+{
+    epoll_event ev = {};
+    ev.events = e.events | EPOLLONESHOT;
+    ev.data.u64 = h;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, e.fd, &ev) < 0)
+    {
+        SPDLOG_ERROR("Unable to rearm fd {}: {}", e.fd, strerror(errno));
+    }
+}
+
+
+void Reactor::run_task(std::unique_lock<std::mutex>& lck, const task& t)
+{
+    auto iter = entries_.find(t.h);
+    if (iter == entries_.end())
+    {
+        // removed after the event was queued
+        return;
+    }
+    auto e = iter->second;
+
+    e->running_in = std::this_thread::get_id();
+    lck.unlock();
+
+    if (e->fd >= 0)
+    {
+        e->fd_handler(t.events);
+    }
+    else
+    {
+        e->timer_handler();
+    }
+
+    lck.lock();
+    e->running_in = {};
+    done_cv_.notify_all();
+
+    if (e->fd >= 0 && entries_.count(t.h) > 0)
+    {
+        rearm_fd(t.h, *e);
+    }
+}
+
+
+void Reactor::reactor_main()
+{
+    tcam::thread_policy::setup_thread("tcam_reactor");
+
+    std::vector<epoll_event> events(32);
+
+    while (true)
+    {
+        int timeout_ms = -1;
+        {
+            std::scoped_lock lck { mtx_ };
+            if (!running_)
+            {
+                break;
+            }
+            if (!timers_.empty())
+            {
+                auto diff = timers_.begin()->first - clock::now();
+                // round up, waking early would only spin until the deadline
+                auto ms = std::chrono::ceil<std::chrono::milliseconds>(diff).count();
+                timeout_ms = static_cast<int>(std::max<decltype(ms)>(ms, 0));
+            }
+        }
+
+        int ret = epoll_wait(epoll_fd_, events.data(), events.size(), timeout_ms);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            SPDLOG_ERROR("Error during epoll_wait. errno: {} ({})", errno, strerror(errno));
+            break;
+        }
+
+        std::scoped_lock lck { mtx_ };
+
+        for (int i = 0; i < ret; ++i)
+        {
+            const auto h = events[i].data.u64;
+            if (h == 0)
+            {
+                uint64_t val = 0;
+                if (read(wake_fd_, &val, sizeof(val)) < 0 && errno != EAGAIN)
+                {
+                    SPDLOG_ERROR("Unable to read eventfd: {}", strerror(errno));
+                }
+                continue;
+            }
+
+            auto iter = entries_.find(h);
+            if (iter != entries_.end())
+            {
+                post(iter->second->s, task { h, events[i].events });
+            }
+        }
+
+        const auto now = clock::now();
+        while (!timers_.empty() && timers_.begin()->first <= now)
+        {
+            const auto h = timers_.begin()->second;
+            timers_.erase(timers_.begin());
+
+            auto iter = entries_.find(h);
+            if (iter != entries_.end())
+            {
+                iter->second->is_armed = false;
+                post(iter->second->s, task { h, 0 });
+            }
+        }
+    }
+}
+
+
+void Reactor::worker_main()
+{
+    tcam::thread_policy::setup_thread("tcam_reactor_wk");
+
+    std::unique_lock lck { mtx_ };
+    while (true)
+    {
+        work_cv_.wait(lck, [this] { return !running_ || !ready_.empty(); });
+        if (!running_)
+        {
+            break;
+        }
+
+        auto s = ready_.front();
+        ready_.pop_front();
+
+        auto t = s->tasks.front();
+        s->tasks.pop_front();
+
+        run_task(lck, t);
+
+        // one task per turn, so that a busy device does not starve the others
+        if (s->tasks.empty())
+        {
+            s->is_scheduled = false;
+        }
+        else
+        {
+            ready_.push_back(s);
+            work_cv_.notify_one();
+        }
+    }
+}
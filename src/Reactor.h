@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tcam
+{
+
+//
+// Process wide event loop for the stream handling of all devices.
+//
+// One thread waits with epoll on the fds of all devices and on their timers, a small pool of
+// workers runs the handlers. Handlers of one strand never run concurrently and run in the
+// order of their events, so the state of a device needs no further locking when all of its
+// handlers share a strand. Handlers of different strands run in parallel.
+//
+// Used instead of a thread per device when TCAM_REACTOR=1. The pool has TCAM_REACTOR_THREADS
+// workers, by default one per core, at most 4.
+//
+class Reactor
+{
+public:
+    using clock = std::chrono::steady_clock;
+    using handle = uint64_t;
+
+    // serializes the handlers registered with it
+    class strand;
+
+    // reads TCAM_REACTOR
+    static bool is_enabled();
+
+    static Reactor& get_instance();
+
+    std::shared_ptr<strand> create_strand();
+
+    // The handler is called with the epoll events whenever fd is ready.
+    // The fd is not watched while its handler runs, level triggered events are reported again
+    // afterwards. fd has to stay open until remove returned.
+    handle watch_fd(int fd,
+                    uint32_t events,
+                    const std::shared_ptr<strand>& s,
+                    std::function<void(uint32_t events)> handler);
+
+    // The handler is called once per arm_timer, when the deadline has passed.
+    handle add_timer(const std::shared_ptr<strand>& s, std::function<void()> handler);
+    // replaces an earlier deadline that did not fire yet
+    void arm_timer(handle h, clock::time_point deadline);
+
+    // No handler of h is started after this returned and a running one has finished.
+    // May be called from within the handler of h, then only later calls are prevented.
+    void remove(handle h);
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+private:
+    Reactor();
+    ~Reactor();
+
+    struct entry;
+    struct task
+    {
+        handle h;
+        uint32_t events;
+    };
+
+    // mtx_ has to be held for all of these
+    void start_threads();
+    handle add_entry(std::shared_ptr<entry> e);
+    void post(const std::shared_ptr<strand>& s, task t);
+    void run_task(std::unique_lock<std::mutex>& lck, const task& t);
+    void rearm_fd(handle h, const entry& e);
+
+    void wake();
+    void reactor_main();
+    void worker_main();
+
+    std::mutex mtx_;
+    std::map<handle, std::shared_ptr<entry>> entries_;
+    handle next_handle_ = 1;
+    std::multimap<clock::time_point, handle> timers_;
+
+    // strands with pending tasks that are not processed by a worker
+    std::deque<std::shared_ptr<strand>> ready_;
+    std::condition_variable work_cv_;
+    // signaled whenever a handler finished
+    std::condition_variable done_cv_;
+
+    bool running_ = false;
+    std::thread reactor_thread_;
+    std::vector<std::thread> workers_;
+
+    int epoll_fd_ = -1;
+    // written to interrupt epoll_wait, registered with handle 0
+    int wake_fd_ = -1;
+};
+
+} // namespace tcam
@@ -32,6 +32,13 @@ public:
     virtual ~IImageBufferSink() = default;
 
     virtual void push_image(const std::shared_ptr<ImageBuffer>&) = 0;
+
+    // Progressive delivery, see DeviceInterface::set_progressive_delivery_enabled.
+    // Called from the receive thread when the backend starts filling the buffer, the image lines
+    // are published with ImageBuffer::set_completed_lines. The buffer is pushed with push_image
+    // when it is complete, or requeued when it was aborted.
+    // Implementations must not block.
+    virtual void push_partial_image(const std::shared_ptr<ImageBuffer>&) {}
 };
 
 class IImageBufferPool
@@ -0,0 +1,339 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SlabAllocator.h"
+
+#include "Memory.h"
+#include "logging.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+
+constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+// from linux/mempolicy.h, not available everywhere
+constexpr int mpol_bind = 2;
+
+size_t round_up(size_t value, size_t multiple)
+{
+    return ((value + multiple - 1) / multiple) * multiple;
+}
+
+bool bind_to_numa_node(void* ptr, size_t size, int node)
+{
+    constexpr size_t mask_bits = sizeof(unsigned long) * 8;
+    if (node < 0 || static_cast<size_t>(node) >= mask_bits)
+    {
+        SPDLOG_WARN("NUMA node {} is out of range. Memory will not be bound.", node);
+        return false;
+    }
+
+    unsigned long mask = 1ul << node;
+
+    if (syscall(SYS_mbind, ptr, size, mpol_bind, &mask, mask_bits + 1, 0) != 0)
+    {
+        SPDLOG_WARN("Unable to bind memory to NUMA node {}: {}", node, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+
+tcam::slab_allocator_config tcam::get_slab_allocator_config()
+{
+    slab_allocator_config config = {};
+
+    auto huge = get_environment_variable("TCAM_ALLOCATOR_HUGEPAGES", "transparent");
+    if (huge == "off")
+    {
+        config.use_huge_pages = slab_allocator_config::huge_pages::off;
+    }
+    else if (huge == "hugetlb")
+    {
+        config.use_huge_pages = slab_allocator_config::huge_pages::hugetlb;
+    }
+    else if (huge != "transparent")
+    {
+        SPDLOG_WARN("Unknown value for TCAM_ALLOCATOR_HUGEPAGES '{}'. Using 'transparent'.", huge);
+    }
+
+    if (auto node = get_environment_variable_int("TCAM_ALLOCATOR_NUMA_NODE"))
+    {
+        config.numa_node = node.value();
+    }
+
+    if (auto alignment = get_environment_variable_int("TCAM_ALLOCATOR_ALIGNMENT"))
+    {
+        const auto value = alignment.value();
+        if (value >= 64 && (value & (value - 1)) == 0)
+        {
+            config.alignment = value;
+        }
+        else
+        {
+            SPDLOG_WARN("TCAM_ALLOCATOR_ALIGNMENT {} is not a power of two >= 64. Using {}.",
+                        value,
+                        config.alignment);
+        }
+    }
+
+    if (auto lock = get_environment_variable_int("TCAM_ALLOCATOR_MLOCK"))
+    {
+        config.lock_memory = lock.value() != 0;
+    }
+
+    return config;
+}
+
+
+int tcam::get_numa_node_of_sysfs_device(const std::string& sysfs_device_path)
+{
+    std::ifstream file(sysfs_device_path + "/numa_node");
+
+    int node = -1;
+    if (!(file >> node))
+    {
+        return -1;
+    }
+    // the kernel reports -1 for devices without affinity
+    return node;
+}
+
+
+tcam::SlabAllocator::SlabAllocator(const slab_allocator_config& config) : config_(config)
+{
+    if (config_.alignment == 0)
+    {
+        config_.alignment = 64;
+    }
+}
+
+
+tcam::SlabAllocator::~SlabAllocator()
+{
+    // Memory holds a reference to us, so all slabs should be gone by now
+    for (const auto& s : slabs_) { unmap_slab(s); }
+}
+
+
+size_t tcam::SlabAllocator::get_buffer_stride(size_t length) const noexcept
+{
+    return round_up(length, config_.alignment);
+}
+
+
+char* tcam::SlabAllocator::map_slab(size_t& size)
+{
+    void* ptr = MAP_FAILED;
+
+    if (config_.use_huge_pages == slab_allocator_config::huge_pages::hugetlb)
+    {
+        size_t huge_size = round_up(size, huge_page_size);
+        ptr = mmap(nullptr,
+                   huge_size,
+                   PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                   -1,
+                   0);
+        if (ptr != MAP_FAILED)
+        {
+            size = huge_size;
+        }
+        else
+        {
+            SPDLOG_INFO("MAP_HUGETLB failed ({}). Falling back to transparent huge pages.",
+                        strerror(errno));
+        }
+    }
+
+    if (ptr == MAP_FAILED)
+    {
+        if (config_.use_huge_pages == slab_allocator_config::huge_pages::off)
+        {
+            ptr = mmap(
+                nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        }
+        else
+        {
+            // over-allocate so that the slab can start on a huge page boundary
+            size_t huge_size = round_up(size, huge_page_size);
+            size_t map_size = huge_size + huge_page_size;
+
+            auto raw = static_cast<char*>(mmap(
+                nullptr, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+            if (raw == MAP_FAILED)
+            {
+                SPDLOG_ERROR("mmap for {} bytes failed: {}", map_size, strerror(errno));
+                return nullptr;
+            }
+
+            auto aligned = reinterpret_cast<char*>(
+                round_up(reinterpret_cast<uintptr_t>(raw), huge_page_size));
+
+            size_t head = aligned - raw;
+            size_t tail = map_size - head - huge_size;
+            if (head)
+            {
+                munmap(raw, head);
+            }
+            if (tail)
+            {
+                munmap(aligned + huge_size, tail);
+            }
+
+            if (madvise(aligned, huge_size, MADV_HUGEPAGE) != 0)
+            {
+                SPDLOG_DEBUG("madvise(MADV_HUGEPAGE) failed: {}", strerror(errno));
+            }
+            ptr = aligned;
+            size = huge_size;
+        }
+    }
+
+    if (ptr == MAP_FAILED)
+    {
+        SPDLOG_ERROR("mmap for {} bytes failed: {}", size, strerror(errno));
+        return nullptr;
+    }
+
+    // binding has to happen before the first touch
+    if (config_.numa_node >= 0)
+    {
+        bind_to_numa_node(ptr, size, config_.numa_node);
+    }
+
+    if (config_.lock_memory)
+    {
+        // mlock also faults in all pages
+        if (mlock(ptr, size) != 0)
+        {
+            SPDLOG_INFO("Unable to lock {} bytes of buffer memory: {}. Check RLIMIT_MEMLOCK.",
+                        size,
+                        strerror(errno));
+        }
+    }
+
+    return static_cast<char*>(ptr);
+}
+
+
+void tcam::SlabAllocator::unmap_slab(const slab& s)
+{
+    if (config_.lock_memory)
+    {
+        munlock(s.base, s.size);
+    }
+    munmap(s.base, s.size);
+}
+
+
+void* tcam::SlabAllocator::allocate(TCAM_MEMORY_TYPE t, size_t length, int /*fd*/)
+{
+    if (t != TCAM_MEMORY_TYPE_USERPTR || length == 0)
+    {
+        return nullptr;
+    }
+
+    size_t size = get_buffer_stride(length);
+    char* base = map_slab(size);
+    if (!base)
+    {
+        return nullptr;
+    }
+
+    std::scoped_lock lck { mtx_ };
+    slabs_.push_back({ base, size, 1 });
+
+    return base;
+}
+
+
+void tcam::SlabAllocator::free(TCAM_MEMORY_TYPE, void* ptr, size_t, int /*fd*/)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    std::scoped_lock lck { mtx_ };
+
+    auto p = static_cast<char*>(ptr);
+    auto iter = std::find_if(slabs_.begin(),
+                             slabs_.end(),
+                             [p](const slab& s) { return p >= s.base && p < s.base + s.size; });
+
+    if (iter == slabs_.end())
+    {
+        SPDLOG_ERROR("Trying to free memory that is not part of any slab. ptr={}", ptr);
+        return;
+    }
+
+    if (--iter->buffer_in_use == 0)
+    {
+        unmap_slab(*iter);
+        slabs_.erase(iter);
+    }
+}
+
+
+std::vector<std::shared_ptr<tcam::Memory>> tcam::SlabAllocator::allocate(size_t buffer_count,
+                                                                         TCAM_MEMORY_TYPE t,
+                                                                         size_t length,
+                                                                         int /*fd*/)
+{
+    if (t != TCAM_MEMORY_TYPE_USERPTR || buffer_count == 0 || length == 0)
+    {
+        return {};
+    }
+
+    const size_t stride = get_buffer_stride(length);
+
+    size_t size = stride * buffer_count;
+    char* base = map_slab(size);
+    if (!base)
+    {
+        return {};
+    }
+
+    {
+        std::scoped_lock lck { mtx_ };
+        slabs_.push_back({ base, size, buffer_count });
+    }
+
+    SPDLOG_DEBUG("Allocated slab of {} bytes for {} buffer with stride {}", size, buffer_count, stride);
+
+    std::vector<std::shared_ptr<tcam::Memory>> buffer;
+    buffer.reserve(buffer_count);
+
+    for (size_t i = 0; i < buffer_count; ++i)
+    {
+        buffer.push_back(std::make_shared<tcam::Memory>(
+            shared_from_this(), TCAM_MEMORY_TYPE_USERPTR, length, base + i * stride));
+    }
+
+    return buffer;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Allocator.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tcam
+{
+
+struct slab_allocator_config
+{
+    enum class huge_pages
+    {
+        off,
+        transparent, // madvise(MADV_HUGEPAGE)
+        hugetlb, // MAP_HUGETLB, falls back to transparent
+    };
+
+    huge_pages use_huge_pages = huge_pages::transparent;
+
+    // node the memory is bound to, -1 for no binding
+    int numa_node = -1;
+
+    // mlock the slab, so that it never pages out
+    // this is best effort, failures are only logged
+    bool lock_memory = true;
+
+    // alignment of every buffer in the slab
+    size_t alignment = 64;
+};
+
+// Default config with the TCAM_ALLOCATOR_* environment variables applied
+slab_allocator_config get_slab_allocator_config();
+
+// Returns the numa node of the device at the given sysfs path,
+// e.g. /sys/class/net/eth0/device
+// Returns -1 when unknown
+int get_numa_node_of_sysfs_device(const std::string& sysfs_device_path);
+
+
+//
+// Allocates all buffers of one allocate(buffer_count, ...) call
+// from a single contiguous mapping.
+// The mapping is released once all Memory objects referencing it are gone.
+//
+class SlabAllocator : public AllocatorInterface, public std::enable_shared_from_this<SlabAllocator>
+{
+public:
+    explicit SlabAllocator(const slab_allocator_config& config = get_slab_allocator_config());
+    ~SlabAllocator();
+
+    std::vector<TCAM_MEMORY_TYPE> get_supported_memory_types() const final
+    {
+        return { TCAM_MEMORY_TYPE_USERPTR };
+    }
+
+    void* allocate(TCAM_MEMORY_TYPE, size_t, int fd = 0) final;
+    void free(TCAM_MEMORY_TYPE, void* ptr, size_t, int fd = 0) final;
+
+    std::vector<std::shared_ptr<Memory>> allocate(size_t buffer_count,
+                                                  TCAM_MEMORY_TYPE,
+                                                  size_t,
+                                                  int fd = 0) final;
+
+    // offset between two buffers in a slab for the given buffer size
+    size_t get_buffer_stride(size_t length) const noexcept;
+
+private:
+    struct slab
+    {
+        char* base = nullptr;
+        size_t size = 0;
+        size_t buffer_in_use = 0;
+    };
+
+    char* map_slab(size_t& size);
+    void unmap_slab(const slab& s);
+
+    slab_allocator_config config_;
+
+    std::mutex mtx_;
+    std::vector<slab> slabs_;
+};
+
+} // namespace tcam
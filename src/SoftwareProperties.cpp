@@ -4,6 +4,7 @@
 
 #include "SoftwarePropertiesImpl.h"
 #include "logging.h"
+#include "tracepoints.h"
 
 #include <algorithm>
 #include <chrono>
@@ -15,9 +16,15 @@ using namespace tcam;
 using sp = tcam::property::emulated::software_prop;
 
 tcam::property::SoftwareProperties::SoftwareProperties(
-    const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& dev_properties)
-    : m_properties(dev_properties), p_state(auto_alg::make_state_ptr())
+    const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& dev_properties,
+    const std::shared_ptr<PropertyNotifier>& notifier,
+    const emulated::auto_tuning_profile& tuning)
+    : m_properties(dev_properties), m_notifier(notifier), m_tuning(tuning),
+      p_state(auto_alg::make_state_ptr(tuning.timing))
 {
+    m_auto_params.exposure_step = m_tuning.exposure_step;
+    m_auto_params.exposure_reference.val = m_tuning.exposure_reference;
+
     auto ptr = find_property(m_properties, "SensorWidth");
     if (!ptr)
     {
@@ -45,10 +52,13 @@ tcam::property::SoftwareProperties::SoftwareProperties(
 
 std::shared_ptr<tcam::property::SoftwareProperties> tcam::property::SoftwareProperties::create(
     const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& dev_properties,
-    bool has_bayer)
+    bool has_bayer,
+    const std::shared_ptr<PropertyNotifier>& notifier,
+    const emulated::auto_tuning_profile& tuning)
 {
-    auto ptr = std::make_shared<SoftwareProperties>(dev_properties);
+    auto ptr = std::make_shared<SoftwareProperties>(dev_properties, notifier, tuning);
     ptr->generate_public_properties(has_bayer);
+    ptr->publish_auto_params();
     return ptr;
 }
 
@@ -60,82 +70,339 @@ static uint64_t time_now_in_us() noexcept
 }
 
 
-void tcam::property::SoftwareProperties::auto_pass(const img::img_descriptor& image)
+auto_alg::auto_pass_params tcam::property::SoftwareProperties::get_auto_params_locked() const
 {
-    auto_alg::auto_pass_params tmp_params;
+    auto_alg::auto_pass_params tmp_params = m_auto_params;
+
+    tmp_params.exposure.max = m_exposure_auto_upper_limit;
+
+    if (m_active_brightness_roi)
     {
-        std::scoped_lock lock(m_property_mtx);
+        tmp_params.brightness_roi = { m_brightness_left,
+                                      m_brightness_top,
+                                      m_brightness_left + m_brightness_width,
+                                      m_brightness_top + m_brightness_height };
+    }
+    else
+    {
+        tmp_params.brightness_roi = {};
+    }
+    tmp_params.focus_onepush_params.run_cmd_params.roi = {
+        m_focus_left, m_focus_top, m_focus_left + m_focus_width, m_focus_top + m_focus_height
+    };
+    return tmp_params;
+}
+
+
+void tcam::property::SoftwareProperties::publish_auto_params()
+{
+    std::scoped_lock lock(m_property_mtx);
+    publish_auto_params_locked();
+}
+
+
+void tcam::property::SoftwareProperties::publish_auto_params_locked()
+{
+    m_auto_params_snapshot.store(get_auto_params_locked());
+}
+
+
+// the auto pass only evaluates the statistics for these
+static bool is_statistics_needed(const auto_alg::auto_pass_params& params) noexcept
+{
+    return params.exposure.auto_enabled || params.gain.auto_enabled || params.iris.auto_enabled
+           || params.wb.auto_enabled || params.wb.one_push_enabled
+           || params.hdr_gain.enable_auto_hdr_gain_selection;
+}
+
+
+bool tcam::property::SoftwareProperties::is_statistics_needed() const
+{
+    return ::is_statistics_needed(m_auto_params_snapshot.load());
+}
+
 
-        tmp_params = m_auto_params;
+auto_alg::auto_pass_params tcam::property::SoftwareProperties::on_frame(
+    uint64_t frame_count,
+    std::optional<double> chunk_exposure_us)
+{
+    auto tmp_params = m_auto_params_snapshot.load();
+
+    if (auto roi = m_brightness_roi_override.get())
+    {
+        tmp_params.brightness_roi = *roi;
+    }
 
-        m_auto_params.focus_onepush_params.is_run_cmd = false;
-        tmp_params.exposure.max = m_exposure_auto_upper_limit;
+    tmp_params.exposure_in_flight = m_exposure_latency.on_frame(frame_count, chunk_exposure_us);
+
+    // group members use the values of the leader, sampling is skipped like for images that
+    // do not show the last written exposure
+    if (m_auto_group_follower && !tmp_params.iris.auto_enabled)
+    {
+        tmp_params.exposure_in_flight = true;
+    }
+    return tmp_params;
+}
+
+
+void tcam::property::SoftwareProperties::collect_statistics(
+    const img::img_descriptor& image,
+    const auto_alg::auto_pass_params& params,
+    auto_alg::image_statistics& stats)
+{
+    if (!::is_statistics_needed(params))
+    {
+        // counts as not sampled
+        auto_alg::collect_image_statistics(stats, img::img_descriptor {}, params);
+        return;
+    }
+    auto_alg::collect_image_statistics(stats, image, params);
+}
+
+
+void tcam::property::SoftwareProperties::collect_statistics(
+    const auto_alg::channel_statistics& channels,
+    const auto_alg::auto_pass_params& params,
+    auto_alg::image_statistics& stats)
+{
+    auto_alg::collect_image_statistics(stats, channels, params);
+}
+
+
+tcam::property::emulated::hdr_bracketing::image_tag tcam::property::SoftwareProperties::
+    on_image_bracketing(uint64_t frame_count, std::optional<double> chunk_exposure_us)
+{
+    if (!m_dev_bracketing_exposure)
+    {
+        return {};
+    }
+    return m_hdr_bracketing.on_image(*m_dev_bracketing_exposure,
+                                     frame_count,
+                                     m_exposure_latency.get_latency_frames(),
+                                     chunk_exposure_us);
+}
+
+
+bool tcam::property::SoftwareProperties::is_focus_image_needed() const
+{
+    const auto focus = m_auto_params_snapshot.load().focus_onepush_params;
+    return focus.enable_focus && (focus.is_run_cmd || focus.is_end_cmd || m_focus_running);
+}
 
-        if (m_active_brightness_roi)
+
+void tcam::property::SoftwareProperties::auto_pass(const auto_alg::image_statistics& stats,
+                                                   const img::img_descriptor& focus_image)
+{
+    auto tmp_params = m_auto_params_snapshot.load();
+
+    if (tmp_params.focus_onepush_params.is_run_cmd)
+    {
+        // the run command is only consumed when there is an image to run it on
+        if (!focus_image.empty())
         {
-            tmp_params.brightness_roi = { m_brightness_left,
-                                          m_brightness_top,
-                                          m_brightness_left + m_brightness_width,
-                                          m_brightness_top + m_brightness_height };
+            std::scoped_lock lock(m_property_mtx);
+            m_auto_params.focus_onepush_params.is_run_cmd = false;
+            publish_auto_params_locked();
         }
         else
         {
-            tmp_params.brightness_roi = {};
+            tmp_params.focus_onepush_params.is_run_cmd = false;
         }
-        tmp_params.focus_onepush_params.run_cmd_params.roi = {
-            m_focus_left, m_focus_top, m_focus_left + m_focus_width, m_focus_top + m_focus_height
-        };
+    }
+
+    // the bracketing owns the exposure and its images mix several exposures
+    if (m_hdr_bracketing.is_active())
+    {
+        tmp_params.exposure.auto_enabled = false;
+        tmp_params.gain.auto_enabled = false;
+    }
+
+    std::shared_ptr<emulated::auto_group_member> group;
+    {
+        std::scoped_lock lock(m_property_mtx);
+        group = m_auto_group;
+    }
+    const bool is_group_leader = group && group->is_leader();
+    m_auto_group_follower = group && !is_group_leader;
+
+    // the algorithms of a member only run for what the leader does not control
+    std::optional<emulated::auto_group_values> leader_values;
+    bool follow_exposure = false;
+    bool follow_gain = false;
+    bool follow_wb = false;
+    if (m_auto_group_follower)
+    {
+        leader_values = group->get_leader_values();
+    }
+    if (leader_values)
+    {
+        follow_exposure = tmp_params.exposure.auto_enabled && leader_values->exposure_us;
+        follow_gain = tmp_params.gain.auto_enabled && leader_values->gain;
+        follow_wb = tmp_params.wb.auto_enabled && leader_values->wb;
+
+        tmp_params.exposure.auto_enabled &= !follow_exposure;
+        tmp_params.gain.auto_enabled &= !follow_gain;
+        tmp_params.wb.auto_enabled &= !follow_wb;
     }
 
     tmp_params.frame_number = m_frame_counter++;
     tmp_params.time_point = time_now_in_us();
+    // without a measured latency, the default may be too short, e.g. for GigE
+    tmp_params.exposure_model_step = m_exposure_latency.is_latency_measured();
 
-    auto auto_pass_ret = auto_alg::auto_pass(*p_state, image, tmp_params);
+    auto auto_pass_ret = auto_alg::auto_pass(*p_state, stats, focus_image, tmp_params);
 
-    if (auto_pass_ret.exposure_changed)
+    if (is_group_leader)
     {
-        m_auto_params.exposure.val = auto_pass_ret.exposure_value;
-        auto set_exp = m_dev_exposure->set_value(auto_pass_ret.exposure_value);
-        if (!set_exp)
+        emulated::auto_group_values values;
+        if (tmp_params.exposure.auto_enabled)
+        {
+            values.exposure_us = auto_pass_ret.exposure_changed ? auto_pass_ret.exposure_value
+                                                                : tmp_params.exposure.val;
+        }
+        if (tmp_params.gain.auto_enabled)
         {
-            SPDLOG_ERROR("Unable to set exposure: {}", set_exp.error().message());
+            values.gain =
+                auto_pass_ret.gain_changed ? auto_pass_ret.gain_value : tmp_params.gain.value;
         }
+        if (tmp_params.wb.auto_enabled)
+        {
+            values.wb =
+                auto_pass_ret.wb.wb_changed ? auto_pass_ret.wb.channels : tmp_params.wb.channels;
+        }
+        group->publish(values);
     }
 
-    if (auto_pass_ret.gain_changed)
+    // the values of the leader pass the same write filters as the results of the own algorithms
+    if (follow_exposure)
     {
-        m_auto_params.gain.value = auto_pass_ret.gain_value;
-        auto set_gain = m_dev_gain->set_value(auto_pass_ret.gain_value);
-        if (!set_gain)
+        const int exposure = std::clamp(
+            *leader_values->exposure_us, tmp_params.exposure.min, tmp_params.exposure.max);
+        if (exposure != tmp_params.exposure.val)
         {
-            SPDLOG_ERROR("Unable to set gain: {}", set_gain.error().message());
+            auto_pass_ret.exposure_changed = true;
+            auto_pass_ret.exposure_value = exposure;
         }
     }
+    if (follow_gain)
+    {
+        const float gain =
+            std::clamp(*leader_values->gain, tmp_params.gain.min, tmp_params.gain.max);
+        if (gain != tmp_params.gain.value)
+        {
+            auto_pass_ret.gain_changed = true;
+            auto_pass_ret.gain_value = gain;
+        }
+    }
+    // a running one push of this camera takes precedence
+    if (follow_wb && !auto_pass_ret.wb.wb_changed)
+    {
+        const auto& wb = *leader_values->wb;
+        const auto& cur = tmp_params.wb.channels;
+        if (wb.r != cur.r || wb.g != cur.g || wb.b != cur.b)
+        {
+            auto_pass_ret.wb.wb_changed = true;
+            auto_pass_ret.wb.channels = wb;
+            auto_pass_ret.wb.one_push_still_running = tmp_params.wb.one_push_enabled;
+        }
+    }
+
+    if (!focus_image.empty())
+    {
+        const bool was_running = m_focus_running.exchange(auto_pass_ret.focus_onepush_still_running);
+        if (was_running && !auto_pass_ret.focus_onepush_still_running)
+        {
+            notify_written(sp::FocusAuto);
+        }
+    }
+
+    // the algorithm continues from its results, setters may change the same fields
+    bool wb_one_push_ended = false;
+    if (auto_pass_ret.exposure_changed || auto_pass_ret.gain_changed || auto_pass_ret.iris_changed
+        || auto_pass_ret.focus_changed || auto_pass_ret.wb.wb_changed)
+    {
+        std::scoped_lock lock(m_property_mtx);
+
+        if (auto_pass_ret.exposure_changed)
+        {
+            m_auto_params.exposure.val = auto_pass_ret.exposure_value;
+        }
+        if (auto_pass_ret.gain_changed)
+        {
+            m_auto_params.gain.value = auto_pass_ret.gain_value;
+        }
+        if (auto_pass_ret.iris_changed)
+        {
+            m_auto_params.iris.val = auto_pass_ret.iris_value;
+        }
+        if (auto_pass_ret.focus_changed)
+        {
+            m_auto_params.focus_onepush_params.device_focus_val = auto_pass_ret.focus_value;
+        }
+        if (auto_pass_ret.wb.wb_changed)
+        {
+            m_auto_params.wb.channels = auto_pass_ret.wb.channels;
+
+            wb_one_push_ended =
+                m_auto_params.wb.one_push_enabled && !auto_pass_ret.wb.one_push_still_running;
+            m_auto_params.wb.one_push_enabled = auto_pass_ret.wb.one_push_still_running;
+        }
+
+        publish_auto_params_locked();
+    }
+
+    const auto now = emulated::auto_write_filter::clock::now();
+
+    if (auto_pass_ret.exposure_changed)
+    {
+        m_exposure_write.submit(auto_pass_ret.exposure_value);
+    }
+
+    if (auto_pass_ret.gain_changed)
+    {
+        m_gain_write.submit(auto_pass_ret.gain_value);
+    }
+
+    auto exposure_due = m_dev_exposure ? m_exposure_write.take_due(now) : std::nullopt;
+    auto gain_due = m_dev_gain ? m_gain_write.take_due(now) : std::nullopt;
+    if (exposure_due || gain_due)
+    {
+        m_exposure_latency.on_write(exposure_due);
+    }
+
+    write_auto_values({ { m_dev_exposure.get(), exposure_due }, { m_dev_gain.get(), gain_due } });
 
     if (auto_pass_ret.iris_changed)
     {
-        m_auto_params.iris.val = auto_pass_ret.iris_value;
-        auto set_iris = m_dev_iris->set_value(auto_pass_ret.iris_value);
+        m_iris_write.submit(auto_pass_ret.iris_value);
+    }
+
+    if (auto iris = m_iris_write.take_due(now); iris)
+    {
+        auto set_iris = m_dev_iris->set_value(static_cast<int64_t>(*iris));
         if (!set_iris)
         {
             SPDLOG_ERROR("Unable to set iris: {}", set_iris.error().message());
         }
+        notify(m_dev_iris->get_name());
     }
 
     if (auto_pass_ret.focus_changed)
     {
-        m_auto_params.focus_onepush_params.device_focus_val = auto_pass_ret.focus_value;
         auto set_foc = m_dev_focus->set_value(auto_pass_ret.focus_value);
         if (!set_foc)
         {
             SPDLOG_ERROR("Unable to set focus: {}", set_foc.error().message());
         }
+        notify(m_dev_focus->get_name());
     }
 
     if (auto_pass_ret.wb.wb_changed)
     {
-        m_auto_params.wb.channels = auto_pass_ret.wb.channels;
-        m_auto_params.wb.one_push_enabled = auto_pass_ret.wb.one_push_still_running;
+        if (wb_one_push_ended)
+        {
+            notify_written(sp::BalanceWhiteAuto);
+        }
 
         // SPDLOG_DEBUG("WB r: {}", auto_pass_ret.wb.channels.r);
         // SPDLOG_DEBUG("WB g: {}", auto_pass_ret.wb.channels.g);
@@ -143,31 +410,166 @@ void tcam::property::SoftwareProperties::auto_pass(const img::img_descriptor& im
 
         if (m_wb.is_dev_wb())
         {
-            auto res = set_whitebalance_channel(emulated::software_prop::BalanceWhiteRed,
-                                                auto_pass_ret.wb.channels.r);
+            m_wb_write[0].submit(auto_pass_ret.wb.channels.r);
+            m_wb_write[1].submit(auto_pass_ret.wb.channels.g);
+            m_wb_write[2].submit(auto_pass_ret.wb.channels.b);
+        }
+    }
 
-            if (!res)
+    if (m_wb.is_dev_wb())
+    {
+        write_auto_values({ { m_wb.m_dev_wb_r.get(), m_wb_write[0].take_due(now) },
+                            { m_wb.m_dev_wb_g.get(), m_wb_write[1].take_due(now) },
+                            { m_wb.m_dev_wb_b.get(), m_wb_write[2].take_due(now) } });
+    }
+}
+
+
+void tcam::property::SoftwareProperties::write_auto_values(
+    std::initializer_list<auto_write_entry> entries)
+{
+    auto get_batch = [](IPropertyFloat* prop) -> std::shared_ptr<IPropertyWriteBatch>
+    {
+        auto provider = dynamic_cast<IPropertyWriteBatchProvider*>(prop);
+        return provider ? provider->get_write_batch() : nullptr;
+    };
+
+    // one batch is only possible when all properties share the backend
+    std::shared_ptr<IPropertyWriteBatch> batch;
+    int value_count = 0;
+    bool batch_possible = true;
+    for (const auto& entry : entries)
+    {
+        if (!entry.prop || !entry.value)
+        {
+            continue;
+        }
+        auto entry_batch = get_batch(entry.prop);
+        if (!entry_batch || (batch && entry_batch != batch))
+        {
+            batch_possible = false;
+        }
+        batch = entry_batch;
+        value_count++;
+    }
+
+    if (value_count < 2 || !batch_possible)
+    {
+        batch = nullptr;
+    }
+
+    {
+        metrics::scoped_timer timer { value_count > 0 ? m_write_latency : nullptr };
+
+        if (batch)
+        {
+            batch->begin_writes();
+        }
+
+        for (const auto& entry : entries)
+        {
+            if (!entry.prop || !entry.value)
             {
-                SPDLOG_DEBUG("Setting whitebalance caused an error: {}",
-                             res.as_failure().error().message());
+                continue;
             }
-            res = set_whitebalance_channel(emulated::software_prop::BalanceWhiteGreen,
-                                           auto_pass_ret.wb.channels.g);
+            const auto name = entry.prop->get_name();
+            TCAM_TRACE3(property_write_begin, name.data(), name.size(), 1);
+            auto res = entry.prop->set_value(*entry.value);
+            TCAM_TRACE3(property_write_end, name.data(), name.size(), 1);
             if (!res)
             {
-                SPDLOG_DEBUG("Setting whitebalance caused an error: {}",
-                             res.as_failure().error().message());
+                SPDLOG_ERROR("Unable to set {}: {}", entry.prop->get_name(), res.error().message());
             }
+        }
 
-            res = set_whitebalance_channel(emulated::software_prop::BalanceWhiteBlue,
-                                           auto_pass_ret.wb.channels.b);
+        if (batch)
+        {
+            auto res = batch->commit_writes();
             if (!res)
             {
-                SPDLOG_DEBUG("Setting whitebalance caused an error: {}",
-                             res.as_failure().error().message());
+                SPDLOG_ERROR("Unable to write auto values: {}", res.error().message());
             }
         }
     }
+
+    for (const auto& entry : entries)
+    {
+        if (entry.prop && entry.value)
+        {
+            notify(entry.prop->get_name());
+        }
+    }
+}
+
+
+void tcam::property::SoftwareProperties::notify(std::string_view name) const
+{
+    if (m_notifier)
+    {
+        m_notifier->notify(name);
+    }
+}
+
+
+void tcam::property::SoftwareProperties::notify_written(emulated::software_prop prop_id) const
+{
+    if (!m_notifier)
+    {
+        return;
+    }
+
+    auto notify_id = [this](sp id)
+    {
+        if (auto iter = m_prop_names.find(id); iter != m_prop_names.end())
+        {
+            m_notifier->notify(iter->second);
+        }
+    };
+
+    notify_id(prop_id);
+
+    switch (prop_id)
+    {
+        case sp::ExposureAuto:
+            notify_id(sp::ExposureTime);
+            break;
+        case sp::ExposureAutoUpperLimitAuto:
+            notify_id(sp::ExposureAutoUpperLimit);
+            break;
+        case sp::GainAuto:
+            notify_id(sp::Gain);
+            break;
+        case sp::IrisAuto:
+            notify_id(sp::Iris);
+            break;
+        case sp::BalanceWhiteAuto:
+            notify_id(sp::BalanceWhiteRed);
+            notify_id(sp::BalanceWhiteGreen);
+            notify_id(sp::BalanceWhiteBlue);
+            break;
+        case sp::AutoFunctionsROIPreset:
+            notify_id(sp::AutoFunctionsROILeft);
+            notify_id(sp::AutoFunctionsROITop);
+            notify_id(sp::AutoFunctionsROIWidth);
+            notify_id(sp::AutoFunctionsROIHeight);
+            break;
+        case sp::AutoFunctionsROILeft:
+        case sp::AutoFunctionsROITop:
+        case sp::AutoFunctionsROIWidth:
+        case sp::AutoFunctionsROIHeight:
+            notify_id(sp::AutoFunctionsROIPreset);
+            notify_id(sp::AutoFunctionsROIWidth);
+            notify_id(sp::AutoFunctionsROIHeight);
+            break;
+        case sp::FocusAutoLeft:
+            notify_id(sp::FocusAutoWidth);
+            break;
+        case sp::FocusAutoTop:
+            notify_id(sp::FocusAutoHeight);
+            break;
+        default:
+            break;
+    }
 }
 
 void tcam::property::SoftwareProperties::generate_public_properties(bool has_bayer)
@@ -177,6 +579,7 @@ void tcam::property::SoftwareProperties::generate_public_properties(bool has_bay
     generate_exposure_auto();
     generate_gain_auto();
     generate_iris_auto();
+    generate_hdr_bracketing();
 
     generate_auto_functions_roi();
 
@@ -189,7 +592,9 @@ void tcam::property::SoftwareProperties::generate_public_properties(bool has_bay
         }
     }
 
-    generate_color_transformation();
+    generate_auto_functions_group();
+
+    generate_color_transformation(has_bayer);
 
     m_properties = m_properties;
 }
@@ -202,6 +607,7 @@ outcome::result<int64_t> tcam::property::SoftwareProperties::get_int(
     switch (prop_id)
     {
         case emulated::software_prop::ExposureTime:
+        case emulated::software_prop::HDRBracketingExposureRatio:
         case emulated::software_prop::ExposureAutoLowerLimit:
         case emulated::software_prop::ExposureAutoUpperLimit:
         case emulated::software_prop::Gain:
@@ -230,6 +636,10 @@ outcome::result<int64_t> tcam::property::SoftwareProperties::get_int(
             return m_auto_params.exposure_reference.val;
         case emulated::software_prop::ExposureAutoHighlightReduction:
             return m_auto_params.enable_highlight_reduction ? 1 : 0;
+        case emulated::software_prop::HDRBracketingEnable:
+            return m_hdr_bracketing.get_config().enabled ? 1 : 0;
+        case emulated::software_prop::HDRBracketingCount:
+            return m_hdr_bracketing.get_config().count;
 
         case emulated::software_prop::GainAuto:
             return m_auto_params.gain.auto_enabled ? 1 : 0;
@@ -246,6 +656,8 @@ outcome::result<int64_t> tcam::property::SoftwareProperties::get_int(
             return m_brightness_width;
         case emulated::software_prop::AutoFunctionsROIHeight:
             return m_brightness_height;
+        case emulated::software_prop::AutoFunctionsGroup:
+            return m_auto_group ? m_auto_group->group_id() : 0;
         case emulated::software_prop::Iris:
             return m_auto_params.iris.val;
         case emulated::software_prop::IrisAuto:
@@ -276,9 +688,11 @@ outcome::result<int64_t> tcam::property::SoftwareProperties::get_int(
         }
         case emulated::software_prop::ClaimBalanceWhiteSoftware:
             return m_wb.m_wb_is_claimed;
+        case emulated::software_prop::ClaimColorTransformationSoftware:
+            return m_color_transform.is_claimed;
         case emulated::software_prop::ColorTransformEnable:
         {
-            auto res = m_dev_color_transform_enable->get_value();
+            auto res = get_color_transform_enable();
             if (res.has_failure())
             {
                 return res.as_failure();
@@ -292,12 +706,26 @@ outcome::result<int64_t> tcam::property::SoftwareProperties::get_int(
 
 outcome::result<void> tcam::property::SoftwareProperties::set_int(emulated::software_prop prop_id,
                                                                   int64_t new_val)
+{
+    auto res = set_int_impl(prop_id, new_val);
+    // failed writes may still have changed related parameters
+    publish_auto_params();
+    OUTCOME_TRY(res);
+    notify_written(prop_id);
+    return outcome::success();
+}
+
+
+outcome::result<void> tcam::property::SoftwareProperties::set_int_impl(
+    emulated::software_prop prop_id,
+    int64_t new_val)
 {
     std::scoped_lock lock(m_property_mtx);
 
     switch (prop_id)
     {
         case emulated::software_prop::ExposureTime:
+        case emulated::software_prop::HDRBracketingExposureRatio:
         case emulated::software_prop::ExposureAutoLowerLimit:
         case emulated::software_prop::ExposureAutoUpperLimit:
         case emulated::software_prop::Gain:
@@ -345,6 +773,18 @@ outcome::result<void> tcam::property::SoftwareProperties::set_int(emulated::soft
             m_auto_params.enable_highlight_reduction = new_val != 0;
             return outcome::success();
         }
+        case emulated::software_prop::HDRBracketingEnable:
+        {
+            auto cfg = m_hdr_bracketing.get_config();
+            cfg.enabled = new_val != 0;
+            return set_hdr_bracketing(cfg);
+        }
+        case emulated::software_prop::HDRBracketingCount:
+        {
+            auto cfg = m_hdr_bracketing.get_config();
+            cfg.count = static_cast<int>(new_val);
+            return set_hdr_bracketing(cfg);
+        }
         case emulated::software_prop::GainAuto:
         {
             m_auto_params.gain.auto_enabled = new_val;
@@ -400,6 +840,25 @@ outcome::result<void> tcam::property::SoftwareProperties::set_int(emulated::soft
             m_brightness_roi_mode = AutoFunctionsROIPreset_Modes::custom;
             return outcome::success();
         }
+        case emulated::software_prop::AutoFunctionsGroup:
+        {
+            if (new_val < 0 || new_val > emulated::auto_group_member::max_group_id)
+            {
+                return tcam::status::PropertyValueOutOfBounds;
+            }
+            if (new_val == 0)
+            {
+                m_auto_group.reset();
+                m_auto_group_follower = false;
+            }
+            else if (!m_auto_group || m_auto_group->group_id() != new_val)
+            {
+                // leave the old group first, so this camera does not lead two groups at once
+                m_auto_group.reset();
+                m_auto_group = std::make_shared<emulated::auto_group_member>(new_val);
+            }
+            return outcome::success();
+        }
         case emulated::software_prop::Iris:
         {
             if (m_auto_params.iris.auto_enabled)
@@ -407,6 +866,7 @@ outcome::result<void> tcam::property::SoftwareProperties::set_int(emulated::soft
                 return tcam::status::PropertyNotWriteable;
             }
             m_auto_params.iris.val = new_val;
+            m_iris_write.invalidate();
             return m_dev_iris->set_value(new_val);
         }
         case emulated::software_prop::IrisAuto:
@@ -484,9 +944,14 @@ outcome::result<void> tcam::property::SoftwareProperties::set_int(emulated::soft
             m_wb.m_wb_is_claimed = new_val;
             return outcome::success();
         }
+        case emulated::software_prop::ClaimColorTransformationSoftware:
+        {
+            m_color_transform.is_claimed = new_val;
+            return outcome::success();
+        }
         case emulated::software_prop::ColorTransformEnable:
         {
-            return m_dev_color_transform_enable->set_value(new_val);
+            return set_color_transform_enable(new_val);
         }
     }
     SPDLOG_WARN("Not implemented. ID: {} value: {}", prop_id, new_val);
@@ -505,6 +970,8 @@ outcome::result<double> tcam::property::SoftwareProperties::get_double(
         case emulated::software_prop::ExposureAutoUpperLimitAuto:
         case emulated::software_prop::ExposureAutoReference:
         case emulated::software_prop::ExposureAutoHighlightReduction:
+        case emulated::software_prop::HDRBracketingEnable:
+        case emulated::software_prop::HDRBracketingCount:
         case emulated::software_prop::GainAuto:
         case emulated::software_prop::AutoFunctionsROIEnable:
         case emulated::software_prop::AutoFunctionsROIPreset:
@@ -512,6 +979,7 @@ outcome::result<double> tcam::property::SoftwareProperties::get_double(
         case emulated::software_prop::AutoFunctionsROITop:
         case emulated::software_prop::AutoFunctionsROIWidth:
         case emulated::software_prop::AutoFunctionsROIHeight:
+        case emulated::software_prop::AutoFunctionsGroup:
         case emulated::software_prop::Iris:
         case emulated::software_prop::IrisAuto:
         case emulated::software_prop::Focus:
@@ -522,6 +990,7 @@ outcome::result<double> tcam::property::SoftwareProperties::get_double(
         case emulated::software_prop::FocusAutoWidth:
         case emulated::software_prop::BalanceWhiteAuto:
         case emulated::software_prop::ClaimBalanceWhiteSoftware:
+        case emulated::software_prop::ClaimColorTransformationSoftware:
         case emulated::software_prop::ColorTransformEnable:
             return tcam::status::PropertyNotImplemented;
 
@@ -541,6 +1010,10 @@ outcome::result<double> tcam::property::SoftwareProperties::get_double(
         {
             return m_exposure_auto_upper_limit;
         }
+        case emulated::software_prop::HDRBracketingExposureRatio:
+        {
+            return m_hdr_bracketing.get_config().ratio;
+        }
         case emulated::software_prop::Gain:
         {
             if (!m_auto_params.gain.auto_enabled)
@@ -578,7 +1051,7 @@ outcome::result<double> tcam::property::SoftwareProperties::get_double(
         case emulated::software_prop::ColorTransformRedToBlue:
         case emulated::software_prop::ColorTransformGreenToBlue:
         case emulated::software_prop::ColorTransformBlueToBlue:
-            return get_device_color_transform(prop_id);
+            return get_color_transform(prop_id);
     }
 
     SPDLOG_WARN("not implemented {}", prop_id);
@@ -589,6 +1062,18 @@ outcome::result<double> tcam::property::SoftwareProperties::get_double(
 outcome::result<void> tcam::property::SoftwareProperties::set_double(
     emulated::software_prop prop_id,
     double new_val)
+{
+    auto res = set_double_impl(prop_id, new_val);
+    publish_auto_params();
+    OUTCOME_TRY(res);
+    notify_written(prop_id);
+    return outcome::success();
+}
+
+
+outcome::result<void> tcam::property::SoftwareProperties::set_double_impl(
+    emulated::software_prop prop_id,
+    double new_val)
 {
     std::scoped_lock lock(m_property_mtx);
 
@@ -598,6 +1083,8 @@ outcome::result<void> tcam::property::SoftwareProperties::set_double(
         case emulated::software_prop::ExposureAutoUpperLimitAuto:
         case emulated::software_prop::ExposureAutoReference:
         case emulated::software_prop::ExposureAutoHighlightReduction:
+        case emulated::software_prop::HDRBracketingEnable:
+        case emulated::software_prop::HDRBracketingCount:
         case emulated::software_prop::GainAuto:
         case emulated::software_prop::AutoFunctionsROIEnable:
         case emulated::software_prop::AutoFunctionsROIPreset:
@@ -605,6 +1092,7 @@ outcome::result<void> tcam::property::SoftwareProperties::set_double(
         case emulated::software_prop::AutoFunctionsROITop:
         case emulated::software_prop::AutoFunctionsROIWidth:
         case emulated::software_prop::AutoFunctionsROIHeight:
+        case emulated::software_prop::AutoFunctionsGroup:
         case emulated::software_prop::Iris:
         case emulated::software_prop::IrisAuto:
         case emulated::software_prop::Focus:
@@ -615,6 +1103,7 @@ outcome::result<void> tcam::property::SoftwareProperties::set_double(
         case emulated::software_prop::FocusAutoHeight:
         case emulated::software_prop::BalanceWhiteAuto:
         case emulated::software_prop::ClaimBalanceWhiteSoftware:
+        case emulated::software_prop::ClaimColorTransformationSoftware:
         case emulated::software_prop::ColorTransformEnable:
             return tcam::status::PropertyNotImplemented;
 
@@ -625,6 +1114,7 @@ outcome::result<void> tcam::property::SoftwareProperties::set_double(
                 return tcam::status::PropertyNotWriteable;
             }
             m_auto_params.exposure.val = new_val;
+            m_exposure_write.invalidate();
             return m_dev_exposure->set_value(new_val);
         }
         case emulated::software_prop::ExposureAutoLowerLimit:
@@ -641,6 +1131,12 @@ outcome::result<void> tcam::property::SoftwareProperties::set_double(
             m_exposure_auto_upper_limit = new_val;
             return outcome::success();
         }
+        case emulated::software_prop::HDRBracketingExposureRatio:
+        {
+            auto cfg = m_hdr_bracketing.get_config();
+            cfg.ratio = new_val;
+            return set_hdr_bracketing(cfg);
+        }
         case emulated::software_prop::Gain:
         {
             if (m_auto_params.gain.auto_enabled)
@@ -648,6 +1144,7 @@ outcome::result<void> tcam::property::SoftwareProperties::set_double(
                 return tcam::status::PropertyNotWriteable;
             }
             m_auto_params.gain.value = new_val;
+            m_gain_write.invalidate();
             return m_dev_gain->set_value(new_val);
         }
         case emulated::software_prop::GainAutoLowerLimit:
@@ -682,7 +1179,7 @@ outcome::result<void> tcam::property::SoftwareProperties::set_double(
         case emulated::software_prop::ColorTransformGreenToBlue:
         case emulated::software_prop::ColorTransformBlueToBlue:
         {
-            return set_device_color_transform(prop_id, new_val);
+            return set_color_transform(prop_id, new_val);
         }
     }
     SPDLOG_WARN("not implemented {}", prop_id);
@@ -719,6 +1216,10 @@ tcam::property::PropertyFlags tcam::property::SoftwareProperties::get_flags(
             return default_flags;
         case emulated::software_prop::ExposureAutoHighlightReduction:
             return default_flags;
+        case emulated::software_prop::HDRBracketingEnable:
+        case emulated::software_prop::HDRBracketingCount:
+        case emulated::software_prop::HDRBracketingExposureRatio:
+            return default_flags;
 
         case emulated::software_prop::Gain:
             return add_locked(m_auto_params.gain.auto_enabled);
@@ -734,6 +1235,7 @@ tcam::property::PropertyFlags tcam::property::SoftwareProperties::get_flags(
         case emulated::software_prop::AutoFunctionsROITop:
         case emulated::software_prop::AutoFunctionsROIWidth:
         case emulated::software_prop::AutoFunctionsROIHeight:
+        case emulated::software_prop::AutoFunctionsGroup:
             return default_flags;
         case emulated::software_prop::Iris:
             return add_locked(m_auto_params.iris.auto_enabled);
@@ -783,6 +1285,14 @@ tcam::property::PropertyFlags tcam::property::SoftwareProperties::get_flags(
         case emulated::software_prop::ColorTransformGreenToBlue:
         case emulated::software_prop::ColorTransformBlueToBlue:
         {
+            if (m_color_transform.is_software && !m_color_transform.is_claimed)
+            {
+                return PropertyFlags::Implemented;
+            }
+            if (m_color_transform.is_software)
+            {
+                return add_locked(!m_color_transform.enabled);
+            }
             auto res = m_dev_color_transform_enable->get_value();
             if (!res)
             {
@@ -791,7 +1301,16 @@ tcam::property::PropertyFlags tcam::property::SoftwareProperties::get_flags(
             return add_locked(!res.value());
         }
         case emulated::software_prop::ColorTransformEnable:
+        {
+            // without tcamconvert nobody applies the software transformation
+            if (m_color_transform.is_software && !m_color_transform.is_claimed)
+            {
+                return PropertyFlags::Implemented;
+            }
             return default_flags;
+        }
+        case emulated::software_prop::ClaimColorTransformationSoftware:
+            return default_flags | PropertyFlags::Hidden;
     }
     return PropertyFlags::None;
 }
@@ -800,6 +1319,8 @@ tcam::property::PropertyFlags tcam::property::SoftwareProperties::get_flags(
 void tcam::property::SoftwareProperties::update_to_new_format(const tcam::VideoFormat& new_format)
 {
     m_frame_counter = 0;
+    m_exposure_latency.reset(
+        emulated::exposure_latency_tracker::get_default_latency(m_tuning.exposure_latency_frames));
     m_format = new_format;
 
     auto auto_upper = get_int(sp::ExposureAutoUpperLimitAuto);
@@ -834,6 +1355,8 @@ void tcam::property::SoftwareProperties::update_to_new_format(const tcam::VideoF
         m_prop_focus_width->set_range(x_range);
         m_prop_focus_height->set_range(y_range);
     }
+
+    publish_auto_params();
 }
 
 void property::SoftwareProperties::add_prop_entry(prop_ptr_vec& v,
@@ -2,15 +2,28 @@
 
 #pragma once
 
+#include "Metrics.h"
 #include "PropertyInterfaces.h"
+#include "SoftwarePropertiesAutoGroup.h"
 #include "SoftwarePropertiesBase.h"
+#include "SoftwarePropertiesExposureLatency.h"
+#include "SoftwarePropertiesHdrBracketing.h"
 #include "SoftwarePropertiesImpl.h"
+#include "SoftwarePropertiesRoiSource.h"
+#include "SoftwarePropertiesTuning.h"
+#include "SoftwarePropertiesWriteFilter.h"
 #include "VideoFormat.h"
 #include "compiler_defines.h"
+#include "seqlock.h"
 
+#include <array>
+#include <atomic>
 #include <dutils_img_pipe/auto_alg_pass.h>
+#include <initializer_list>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <vector>
 namespace tcam::property
 {
@@ -32,19 +45,71 @@ class SoftwareProperties :
 {
 public:
     SoftwareProperties(
-        const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& dev_properties);
+        const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& dev_properties,
+        const std::shared_ptr<PropertyNotifier>& notifier,
+        const emulated::auto_tuning_profile& tuning);
 
 public:
+    // notifier receives writes of the auto algorithms and dependent software properties,
+    // may be nullptr
+    // tuning supplies the start values of the auto algorithms, see find_auto_tuning_profile
     static std::shared_ptr<SoftwareProperties> create(
         const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& dev_properties,
-        bool has_bayer);
+        bool has_bayer,
+        const std::shared_ptr<PropertyNotifier>& notifier = nullptr,
+        const emulated::auto_tuning_profile& tuning = emulated::get_default_auto_tuning_profile());
 
     std::vector<std::shared_ptr<tcam::property::IPropertyBase>> get_properties()
     {
         return m_properties;
     }
 
-    void auto_pass(const img::img_descriptor& image);
+    // Called for every image in the capture thread, returns the parameters its statistics are
+    // collected with.
+    // chunk_exposure_us is the ExposureTime chunk of the image, if the device sent it.
+    auto_alg::auto_pass_params on_frame(uint64_t frame_count,
+                                        std::optional<double> chunk_exposure_us);
+
+    // Sparse sampling of the image for the auto algorithms.
+    // Cheap enough for the capture thread.
+    // Images that were taken before the last exposure/gain write was applied are not sampled,
+    // nothing is sampled while no auto function is enabled.
+    void collect_statistics(const img::img_descriptor& image,
+                            const auto_alg::auto_pass_params& params,
+                            auto_alg::image_statistics& stats);
+    // Same for the statistics tcamconvert collected while converting the image
+    void collect_statistics(const auto_alg::channel_statistics& channels,
+                            const auto_alg::auto_pass_params& params,
+                            auto_alg::image_statistics& stats);
+
+    // false while exposure, gain, iris, white balance and hdr gain are not automatic
+    bool is_statistics_needed() const;
+
+    // Brightness ROI for the following images, used instead of the AutoFunctionsROI properties
+    // until it is reset with nullopt. Lock free, may be called for every image.
+    void set_brightness_roi_override(const std::optional<tcam_image_roi>& roi) noexcept
+    {
+        m_brightness_roi_override.set(roi);
+    }
+
+    // Called for every image in the capture thread, before collect_statistics.
+    // Writes the exposure of the following images while HDRBracketingEnable is set and returns
+    // the position of this image in its bracket.
+    emulated::hdr_bracketing::image_tag on_image_bracketing(
+        uint64_t frame_count,
+        std::optional<double> chunk_exposure_us);
+
+    // true when the next auto_pass needs the full image for auto focus
+    bool is_focus_image_needed() const;
+
+    // receives the time the device writes of an auto pass take, may be nullptr
+    void set_write_latency_metric(metrics::histogram* h) noexcept
+    {
+        m_write_latency = h;
+    }
+
+    // focus_image may be empty when is_focus_image_needed() returned false
+    void auto_pass(const auto_alg::image_statistics& stats, const img::img_descriptor& focus_image);
 
     outcome::result<int64_t> get_int(emulated::software_prop prop_id) final;
     outcome::result<void> set_int(emulated::software_prop prop_id, int64_t new_val) final;
@@ -60,14 +125,34 @@ private:
 
     static constexpr int ROI_STEP_SIZE = 4;
 
+    outcome::result<void> set_int_impl(emulated::software_prop prop_id, int64_t new_val);
+    outcome::result<void> set_double_impl(emulated::software_prop prop_id, double new_val);
+
+    // notifies prop_id and the properties whose value or lock state follow it
+    void notify_written(emulated::software_prop prop_id) const;
+    void notify(std::string_view name) const;
+
+    // copy of m_auto_params with the current ROIs applied
+    // m_property_mtx has to be held
+    auto_alg::auto_pass_params get_auto_params_locked() const;
+
+    // makes changes to m_auto_params and the ROIs visible to the auto algorithm threads
+    // publish_auto_params_locked needs m_property_mtx to be held
+    void publish_auto_params();
+    void publish_auto_params_locked();
+
     // encapsulation for internal property generation
     void generate_public_properties(bool has_bayer);
 
     void generate_exposure_auto();
     void generate_gain_auto();
     void generate_iris_auto();
+    void generate_hdr_bracketing();
+
+    outcome::result<void> set_hdr_bracketing(const emulated::hdr_bracketing::config& cfg);
 
     void generate_auto_functions_roi();
+    void generate_auto_functions_group();
     void set_auto_functions_preset_mode(AutoFunctionsROIPreset_Modes mode);
 
     void generate_focus_auto();
@@ -78,18 +163,34 @@ private:
     outcome::result<void> set_whitebalance_channel(emulated::software_prop prop_id,
                                                    double new_value);
 
-    void generate_color_transformation();
+    void generate_color_transformation(bool has_bayer);
+
+    outcome::result<double> get_color_transform(emulated::software_prop prop_id);
+
+    outcome::result<void> set_color_transform(emulated::software_prop prop_id,
+                                              double new_value_tmp);
 
-    outcome::result<double> get_device_color_transform(emulated::software_prop prop_id);
+    outcome::result<bool> get_color_transform_enable();
+    outcome::result<void> set_color_transform_enable(bool enable);
 
-    outcome::result<void> set_device_color_transform(emulated::software_prop prop_id,
-                                                     double new_value_tmp);
+    struct auto_write_entry
+    {
+        IPropertyFloat* prop = nullptr;
+        std::optional<double> value;
+    };
+
+    // Writes all entries that have a value.
+    // Uses one backend transaction when all properties support the same IPropertyWriteBatch.
+    void write_auto_values(std::initializer_list<auto_write_entry> entries);
 
     using prop_ptr_vec = std::vector<std::shared_ptr<tcam::property::IPropertyBase>>;
 
     // property-list
     std::vector<std::shared_ptr<tcam::property::IPropertyBase>> m_properties;
 
+    std::shared_ptr<PropertyNotifier> m_notifier;
+    std::map<emulated::software_prop, std::string_view> m_prop_names;
+
     mutable std::mutex m_property_mtx;
 
     tcam_image_size sensor_dimensions_ = {};
@@ -142,27 +243,75 @@ private:
     };
     wb_setter m_wb;
 
+    // filter the values of the auto algorithms before they are written to the device
+    const double write_deadband = emulated::auto_write_filter::get_default_deadband();
+    const std::chrono::microseconds write_interval =
+        emulated::auto_write_filter::get_default_interval();
+
+    emulated::auto_write_filter m_exposure_write;
+    emulated::auto_write_filter m_gain_write;
+    emulated::auto_write_filter m_iris_write;
+    emulated::auto_write_filter m_wb_write[3]; // r, g, b
+
+    emulated::exposure_latency_tracker m_exposure_latency;
+
+    // the device ExposureTime, also when the device has its own ExposureAuto
+    std::shared_ptr<tcam::property::IPropertyFloat> m_dev_bracketing_exposure = nullptr;
+    emulated::hdr_bracketing m_hdr_bracketing;
+    // ExposureTime when bracketing was enabled, the shortest exposure of the bracket
+    double m_hdr_bracketing_base_us = 0;
+
+    emulated::auto_tuning_profile m_tuning;
+
     // color transforms stuff
 
     std::shared_ptr<tcam::property::IPropertyBool> m_dev_color_transform_enable = nullptr;
     std::shared_ptr<tcam::property::IPropertyFloat> m_dev_color_transform_value = nullptr;
     std::shared_ptr<tcam::property::IPropertyEnum> m_dev_color_transform_value_selector = nullptr;
 
+    // Devices without color transformation get a software one, that tcamconvert applies
+    // in its debayer step after it claimed it. Row major, i.e. values[1] is Gain01.
+    struct color_transform_software
+    {
+        bool is_software = false;
+        bool is_claimed = false;
+        bool enabled = false;
+        std::array<double, 9> values = { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+    };
+    color_transform_software m_color_transform;
+
     // general stuff
 
     auto_alg::auto_pass_params m_auto_params;
     bool m_active_brightness_roi = false;
+    // result of get_auto_params_locked, read by the capture and auto algorithm threads without
+    // taking m_property_mtx
+    tcam::seqlock<auto_alg::auto_pass_params> m_auto_params_snapshot;
+    emulated::brightness_roi_source m_brightness_roi_override;
     auto_alg::state_ptr p_state;
     tcam::VideoFormat m_format;
 
     int64_t m_frame_counter = 0;
 
+    metrics::histogram* m_write_latency = nullptr;
+
+    // nullptr while AutoFunctionsGroup is 0
+    std::shared_ptr<emulated::auto_group_member> m_auto_group;
+    // the group leader runs the exposure and white balance algorithms, the images of the other
+    // members are only sampled for IrisAuto
+    std::atomic<bool> m_auto_group_follower = false;
+
+    // one push auto focus is running and needs further images
+    std::atomic<bool> m_focus_running = false;
+
 
     template<class Tprop_info_type, typename... Tparams>
     auto make_prop_entry(emulated::software_prop id,
                          const Tprop_info_type* prop_info,
                          Tparams&&... params) -> std::shared_ptr<IPropertyBase>
     {
+        m_prop_names[id] = prop_info->name;
+
         if constexpr (Tprop_info_type::property_type == tcamprop1::prop_type::Boolean)
         {
             return std::make_shared<tcam::property::emulated::SoftwarePropertyBoolImpl>(
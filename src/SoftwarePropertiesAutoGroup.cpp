@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "SoftwarePropertiesAutoGroup.h"
+
+#include "logging.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <vector>
+
+using namespace tcam::property::emulated;
+
+
+struct auto_group_member::group
+{
+    mutable std::mutex mtx;
+
+    // in the order they joined, the first one is the leader
+    std::vector<const auto_group_member*> members;
+    std::optional<auto_group_values> leader_values;
+};
+
+
+namespace
+{
+
+// the groups are only kept alive by their members
+std::mutex registry_mtx;
+std::map<int, std::weak_ptr<auto_group_member::group>> registry;
+
+} // namespace
+
+
+auto_group_member::auto_group_member(int group_id) : group_id_(group_id)
+{
+    {
+        std::scoped_lock lck { registry_mtx };
+
+        group_ = registry[group_id].lock();
+        if (!group_)
+        {
+            group_ = std::make_shared<group>();
+            registry[group_id] = group_;
+        }
+    }
+
+    std::scoped_lock lck { group_->mtx };
+    group_->members.push_back(this);
+
+    SPDLOG_DEBUG("Joined auto functions group {} as member {}", group_id, group_->members.size());
+}
+
+
+auto_group_member::~auto_group_member()
+{
+    {
+        std::scoped_lock lck { group_->mtx };
+
+        auto& members = group_->members;
+        const bool was_leader = !members.empty() && members.front() == this;
+
+        members.erase(std::remove(members.begin(), members.end(), this), members.end());
+
+        // the values of the new leader replace the old ones with its next auto pass
+        if (was_leader)
+        {
+            group_->leader_values.reset();
+        }
+    }
+
+    std::scoped_lock lck { registry_mtx };
+    // the last member removes the group
+    if (group_.use_count() == 1)
+    {
+        registry.erase(group_id_);
+    }
+}
+
+
+bool auto_group_member::is_leader() const
+{
+    std::scoped_lock lck { group_->mtx };
+    return !group_->members.empty() && group_->members.front() == this;
+}
+
+
+void auto_group_member::publish(const auto_group_values& values)
+{
+    std::scoped_lock lck { group_->mtx };
+    if (group_->members.empty() || group_->members.front() != this)
+    {
+        return;
+    }
+    group_->leader_values = values;
+}
+
+
+std::optional<auto_group_values> auto_group_member::get_leader_values() const
+{
+    std::scoped_lock lck { group_->mtx };
+    if (group_->members.empty() || group_->members.front() == this)
+    {
+        return std::nullopt;
+    }
+    return group_->leader_values;
+}
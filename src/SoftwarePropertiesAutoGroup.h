@@ -0,0 +1,77 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <dutils_img_pipe/auto_alg_params.h>
+#include <memory>
+#include <optional>
+
+namespace tcam::property::emulated
+{
+
+struct auto_group_values
+{
+    // nullopt when the leader does not run the algorithm
+    std::optional<int> exposure_us;
+    std::optional<float> gain;
+    std::optional<auto_alg::wb_channel_factors> wb;
+};
+
+//
+// Membership in a group of cameras of this process that share exposure, gain and white balance,
+// e.g. the cameras of a stereo rig.
+//
+// The member that joined first is the leader. Only the leader runs the exposure, gain and white
+// balance algorithms, the other members write its results to their devices instead of sampling
+// their own images. When the leader leaves, the next member takes over.
+//
+class auto_group_member
+{
+public:
+    static constexpr int max_group_id = 16;
+
+    // group_id in [1;max_group_id]
+    explicit auto_group_member(int group_id);
+    ~auto_group_member();
+
+    auto_group_member(const auto_group_member&) = delete;
+    auto_group_member& operator=(const auto_group_member&) = delete;
+
+    int group_id() const noexcept
+    {
+        return group_id_;
+    }
+
+    bool is_leader() const;
+
+    // Called by the leader after every auto pass, ignored for the other members.
+    void publish(const auto_group_values& values);
+
+    // The values last published by the leader, nullopt for the leader itself and before the
+    // leader ran its first auto pass.
+    std::optional<auto_group_values> get_leader_values() const;
+
+    // state shared by the members of one group_id
+    struct group;
+
+private:
+    int group_id_ = 0;
+    std::shared_ptr<group> group_;
+};
+
+} // namespace tcam::property::emulated
@@ -58,6 +58,10 @@ void SoftwareProperties::generate_balance_white_auto()
         m_wb.m_dev_wb_g = base_g;
         m_wb.m_dev_wb_b = base_b;
 
+        m_wb_write[0].configure(base_r->get_range().stp, write_deadband, write_interval);
+        m_wb_write[1].configure(base_g->get_range().stp, write_deadband, write_interval);
+        m_wb_write[2].configure(base_b->get_range().stp, write_deadband, write_interval);
+
         auto wb_r = make_prop_entry(sp::BalanceWhiteRed,
                                     &tcamprop1::prop_list::BalanceWhiteRed,
                                     emulated::to_range(*m_wb.m_dev_wb_r));
@@ -139,6 +143,7 @@ outcome::result<void> SoftwareProperties::set_whitebalance_channel(emulated::sof
     if (prop_id == emulated::software_prop::BalanceWhiteRed)
     {
         m_auto_params.wb.channels.r = new_value_tmp;
+        m_wb_write[0].invalidate();
         if (m_wb.m_dev_wb_r)
             return m_wb.m_dev_wb_r->set_value(new_value_tmp);
         return outcome::success();
@@ -146,6 +151,7 @@ outcome::result<void> SoftwareProperties::set_whitebalance_channel(emulated::sof
     else if (prop_id == emulated::software_prop::BalanceWhiteGreen)
     {
         m_auto_params.wb.channels.g = new_value_tmp;
+        m_wb_write[1].invalidate();
         if (m_wb.m_dev_wb_g)
             return m_wb.m_dev_wb_g->set_value(new_value_tmp);
         return outcome::success();
@@ -153,6 +159,7 @@ outcome::result<void> SoftwareProperties::set_whitebalance_channel(emulated::sof
     else if (prop_id == emulated::software_prop::BalanceWhiteBlue)
     {
         m_auto_params.wb.channels.b = new_value_tmp;
+        m_wb_write[2].invalidate();
         if (m_wb.m_dev_wb_b)
             return m_wb.m_dev_wb_b->set_value(new_value_tmp);
         return outcome::success();
@@ -19,6 +19,10 @@ enum class software_prop
     ExposureAutoUpperLimitAuto,
     ExposureAutoHighlightReduction,
 
+    HDRBracketingEnable,
+    HDRBracketingCount,
+    HDRBracketingExposureRatio,
+
     Gain,
     GainAuto,
     GainAutoLowerLimit,
@@ -33,6 +37,7 @@ enum class software_prop
     AutoFunctionsROITop,
     AutoFunctionsROIWidth,
     AutoFunctionsROIHeight,
+    AutoFunctionsGroup,
 
     Focus,
     FocusAuto,
@@ -58,6 +63,7 @@ enum class software_prop
     ColorTransformRedToBlue,
     ColorTransformGreenToBlue,
     ColorTransformBlueToBlue,
+    ClaimColorTransformationSoftware,
 };
 
 struct prop_range_integer_def
@@ -10,54 +10,66 @@ using namespace tcam;
 using sp = tcam::property::emulated::software_prop;
 
 
-static std::string_view to_transform_name(tcam::property::emulated::software_prop prop)
+namespace
 {
-    if (prop == sp::ColorTransformRedToRed)
-    {
-        return "Gain00";
-    }
-    if (prop == sp::ColorTransformGreenToRed)
-    {
-        return "Gain01";
-    }
-    if (prop == sp::ColorTransformBlueToRed)
-    {
-        return "Gain02";
-    }
-    if (prop == sp::ColorTransformRedToGreen)
-    {
-        return "Gain10";
-    }
-    if (prop == sp::ColorTransformGreenToGreen)
-    {
-        return "Gain11";
-    }
-    if (prop == sp::ColorTransformBlueToGreen)
-    {
-        return "Gain12";
-    }
-    if (prop == sp::ColorTransformRedToBlue)
-    {
-        return "Gain20";
-    }
-    if (prop == sp::ColorTransformGreenToBlue)
-    {
-        return "Gain21";
-    }
-    if (prop == sp::ColorTransformBlueToBlue)
+
+struct color_transform_entry
+{
+    sp id;
+    const tcamprop1::prop_static_info_float* info;
+    // ColorTransformationValueSelector entry of the device
+    std::string_view device_name;
+};
+
+// row major, the index is the position in the matrix
+// clang-format off
+static const color_transform_entry color_transform_entries[] = {
+    { sp::ColorTransformRedToRed, &tcamprop1::prop_list::ColorTransformation_Value_Gain00, "Gain00" },
+    { sp::ColorTransformGreenToRed, &tcamprop1::prop_list::ColorTransformation_Value_Gain01, "Gain01" },
+    { sp::ColorTransformBlueToRed, &tcamprop1::prop_list::ColorTransformation_Value_Gain02, "Gain02" },
+    { sp::ColorTransformRedToGreen, &tcamprop1::prop_list::ColorTransformation_Value_Gain10, "Gain10" },
+    { sp::ColorTransformGreenToGreen, &tcamprop1::prop_list::ColorTransformation_Value_Gain11, "Gain11" },
+    { sp::ColorTransformBlueToGreen, &tcamprop1::prop_list::ColorTransformation_Value_Gain12, "Gain12" },
+    { sp::ColorTransformRedToBlue, &tcamprop1::prop_list::ColorTransformation_Value_Gain20, "Gain20" },
+    { sp::ColorTransformGreenToBlue, &tcamprop1::prop_list::ColorTransformation_Value_Gain21, "Gain21" },
+    { sp::ColorTransformBlueToBlue, &tcamprop1::prop_list::ColorTransformation_Value_Gain22, "Gain22" },
+};
+// clang-format on
+
+// range of the software transformation, the same as the cameras offer
+static constexpr tcamprop1::prop_range_float color_transform_software_range = { -4.0, 4.0, 0.01 };
+
+std::optional<size_t> to_matrix_index(sp prop)
+{
+    for (size_t i = 0; i < std::size(color_transform_entries); ++i)
     {
-        return "Gain22";
+        if (color_transform_entries[i].id == prop)
+        {
+            return i;
+        }
     }
-    return {};
+    return std::nullopt;
 }
 
+} // namespace
+
 
-outcome::result<double> tcam::property::SoftwareProperties::get_device_color_transform(
+outcome::result<double> tcam::property::SoftwareProperties::get_color_transform(
     emulated::software_prop prop_id)
 {
-    auto channel = to_transform_name(prop_id);
+    auto index = to_matrix_index(prop_id);
+    if (!index)
+    {
+        return tcam::status::PropertyNotImplemented;
+    }
+
+    if (m_color_transform.is_software)
+    {
+        return m_color_transform.values[*index];
+    }
 
-    auto res = m_dev_color_transform_value_selector->set_value(channel);
+    auto res = m_dev_color_transform_value_selector->set_value(
+        color_transform_entries[*index].device_name);
 
     if (!res)
     {
@@ -68,13 +80,29 @@ outcome::result<double> tcam::property::SoftwareProperties::get_device_color_tra
 }
 
 
-outcome::result<void> tcam::property::SoftwareProperties::set_device_color_transform(
+outcome::result<void> tcam::property::SoftwareProperties::set_color_transform(
     emulated::software_prop prop_id,
     double new_value_tmp)
 {
-    auto channel = to_transform_name(prop_id);
+    auto index = to_matrix_index(prop_id);
+    if (!index)
+    {
+        return tcam::status::PropertyNotImplemented;
+    }
+
+    if (m_color_transform.is_software)
+    {
+        if (new_value_tmp < color_transform_software_range.min
+            || new_value_tmp > color_transform_software_range.max)
+        {
+            return tcam::status::PropertyValueOutOfBounds;
+        }
+        m_color_transform.values[*index] = new_value_tmp;
+        return outcome::success();
+    }
 
-    auto res = m_dev_color_transform_value_selector->set_value(channel);
+    auto res = m_dev_color_transform_value_selector->set_value(
+        color_transform_entries[*index].device_name);
 
     if (!res)
     {
@@ -85,8 +113,31 @@ outcome::result<void> tcam::property::SoftwareProperties::set_device_color_trans
 }
 
 
-void tcam::property::SoftwareProperties::generate_color_transformation()
+outcome::result<bool> tcam::property::SoftwareProperties::get_color_transform_enable()
+{
+    if (m_color_transform.is_software)
+    {
+        return m_color_transform.enabled;
+    }
+    return m_dev_color_transform_enable->get_value();
+}
+
+
+outcome::result<void> tcam::property::SoftwareProperties::set_color_transform_enable(bool enable)
 {
+    if (m_color_transform.is_software)
+    {
+        m_color_transform.enabled = enable;
+        return outcome::success();
+    }
+    return m_dev_color_transform_enable->set_value(enable);
+}
+
+
+void tcam::property::SoftwareProperties::generate_color_transformation(bool has_bayer)
+{
+    m_color_transform = {};
+
     auto enable =
         tcam::property::find_property<IPropertyBool>(m_properties, "ColorTransformationEnable");
     auto value =
@@ -96,6 +147,33 @@ void tcam::property::SoftwareProperties::generate_color_transformation()
 
     if (!enable || !value || !value_selector)
     {
+        if (!has_bayer)
+        {
+            return;
+        }
+
+        // fused into the debayer step of tcamconvert
+        SPDLOG_INFO("Adding ColorTransformation software based.");
+
+        m_color_transform.is_software = true;
+
+        add_prop_entry(m_properties,
+                       sp::ColorTransformEnable,
+                       &tcamprop1::prop_list::ColorTransformationEnable,
+                       false);
+        add_prop_entry(m_properties,
+                       sp::ClaimColorTransformationSoftware,
+                       &tcamprop1::prop_list::ClaimColorTransformationSoftware,
+                       false);
+        for (size_t i = 0; i < std::size(color_transform_entries); ++i)
+        {
+            const auto& entry = color_transform_entries[i];
+            add_prop_entry(m_properties,
+                           entry.id,
+                           entry.info,
+                           emulated::prop_range_float_def { color_transform_software_range,
+                                                            m_color_transform.values[i] });
+        }
         return;
     }
 
@@ -122,50 +200,10 @@ void tcam::property::SoftwareProperties::generate_color_transformation()
     auto new_enable_item = make_prop_entry(
         sp::ColorTransformEnable, &tcamprop1::prop_list::ColorTransformationEnable, false);
 
-    add_prop_entry(new_list,
-                   sp::ColorTransformRedToRed,
-                   &tcamprop1::prop_list::ColorTransformation_Value_Gain00,
-                   range);
-
-    add_prop_entry(new_list,
-                   sp::ColorTransformBlueToRed,
-                   &tcamprop1::prop_list::ColorTransformation_Value_Gain01,
-                   range);
-
-    add_prop_entry(new_list,
-                   sp::ColorTransformGreenToRed,
-                   &tcamprop1::prop_list::ColorTransformation_Value_Gain02,
-                   range);
-
-    add_prop_entry(new_list,
-                   sp::ColorTransformRedToGreen,
-                   &tcamprop1::prop_list::ColorTransformation_Value_Gain10,
-                   range);
-
-    add_prop_entry(new_list,
-                   sp::ColorTransformGreenToGreen,
-                   &tcamprop1::prop_list::ColorTransformation_Value_Gain11,
-                   range);
-
-    add_prop_entry(new_list,
-                   sp::ColorTransformBlueToGreen,
-                   &tcamprop1::prop_list::ColorTransformation_Value_Gain12,
-                   range);
-
-    add_prop_entry(new_list,
-                   sp::ColorTransformRedToBlue,
-                   &tcamprop1::prop_list::ColorTransformation_Value_Gain20,
-                   range);
-
-    add_prop_entry(new_list,
-                   sp::ColorTransformGreenToBlue,
-                   &tcamprop1::prop_list::ColorTransformation_Value_Gain21,
-                   range);
-
-    add_prop_entry(new_list,
-                   sp::ColorTransformBlueToBlue,
-                   &tcamprop1::prop_list::ColorTransformation_Value_Gain22,
-                   range);
+    for (const auto& entry : color_transform_entries)
+    {
+        add_prop_entry(new_list, entry.id, entry.info, range);
+    }
 
     remove_entry(m_properties, "ColorTransformationValue");
     remove_entry(m_properties, "ColorTransformationValueSelector");
@@ -1,13 +1,39 @@
 
 #include "SoftwareProperties.h"
 #include "logging.h"
+#include "utils.h"
 
+#include <algorithm>
 #include <tcamprop1.0_base/tcamprop_property_info_list.h>
 
 using namespace tcam;
 
 using sp = tcam::property::emulated::software_prop;
 
+namespace
+{
+auto_alg::exposure_metering_params get_metering_from_environment()
+{
+    auto_alg::exposure_metering_params rval;
+
+    // in percent, 0 meters the average brightness
+    const auto percentile =
+        tcam::get_environment_variable_int("TCAM_EXPOSURE_AUTO_PERCENTILE").value_or(0);
+    if (percentile > 0 && percentile < 100)
+    {
+        rval.use_histogram = true;
+        rval.percentile = percentile / 100.f;
+    }
+
+    // in 1/1000 of the samples
+    const auto max_clipped =
+        tcam::get_environment_variable_int("TCAM_EXPOSURE_AUTO_MAX_CLIPPED").value_or(20);
+    rval.max_clipped_fraction = std::clamp(max_clipped, 0, 1000) / 1000.f;
+
+    return rval;
+}
+} // namespace
+
 
 void tcam::property::SoftwareProperties::generate_exposure_auto()
 {
@@ -38,12 +64,20 @@ void tcam::property::SoftwareProperties::generate_exposure_auto()
     SPDLOG_INFO("Adding software ExposureAuto.");
 
     m_auto_params.exposure.granularity = m_dev_exposure->get_range().stp;
+    m_exposure_write.configure(m_dev_exposure->get_range().stp, write_deadband, write_interval);
 
     m_auto_params.exposure.min = m_dev_exposure->get_range().min;
     m_auto_params.exposure.max = m_dev_exposure->get_range().max;
 
     m_auto_params.exposure.auto_enabled = true;
 
+    m_auto_params.metering = get_metering_from_environment();
+    if (m_auto_params.metering.use_histogram)
+    {
+        SPDLOG_INFO("ExposureAuto meters the {:.0f}% brightness percentile.",
+                    m_auto_params.metering.percentile * 100);
+    }
+
     m_exposure_auto_upper_limit = m_auto_params.exposure.max;
 
     const auto prop_range = emulated::to_range(*m_dev_exposure);
@@ -65,7 +99,7 @@ void tcam::property::SoftwareProperties::generate_exposure_auto()
     add_prop_entry(new_list,
                    sp::ExposureAutoReference,
                    &tcamprop1::prop_list::ExposureAutoReference,
-                   emulated::prop_range_integer_def { 0, 255, 1, 128 });
+                   emulated::prop_range_integer_def { 0, 255, 1, m_tuning.exposure_reference });
     add_prop_entry(new_list,
                    sp::ExposureAutoLowerLimit,
                    &tcamprop1::prop_list::ExposureAutoLowerLimit,
@@ -87,6 +121,73 @@ void tcam::property::SoftwareProperties::generate_exposure_auto()
     add_prop_entry(m_properties, new_exposure_time->get_name(), new_list);
 }
 
+void tcam::property::SoftwareProperties::generate_hdr_bracketing()
+{
+    m_dev_bracketing_exposure =
+        m_dev_exposure
+            ? m_dev_exposure
+            : tcam::property::find_property<tcam::property::IPropertyFloat>(m_properties,
+                                                                             "ExposureTime");
+    if (!m_dev_bracketing_exposure)
+    {
+        return;
+    }
+
+    const emulated::hdr_bracketing::config cfg;
+    m_hdr_bracketing.configure(cfg, 0, 0, 0);
+
+    prop_ptr_vec new_list;
+
+    add_prop_entry(
+        new_list, sp::HDRBracketingEnable, &tcamprop1::prop_list::HDRBracketingEnable, false);
+    add_prop_entry(new_list,
+                   sp::HDRBracketingCount,
+                   &tcamprop1::prop_list::HDRBracketingCount,
+                   emulated::prop_range_integer_def { emulated::hdr_bracketing::min_count,
+                                                      emulated::hdr_bracketing::max_count,
+                                                      1,
+                                                      cfg.count });
+    add_prop_entry(new_list,
+                   sp::HDRBracketingExposureRatio,
+                   &tcamprop1::prop_list::HDRBracketingExposureRatio,
+                   emulated::prop_range_float_def { { 1.0, 64.0, 0.1 }, cfg.ratio });
+
+    // behind the software ExposureAuto properties, when there are any
+    if (find_property(m_properties, "ExposureAutoHighlightReduction"))
+    {
+        add_prop_entry(m_properties, "ExposureAutoHighlightReduction", new_list);
+    }
+    else
+    {
+        add_prop_entry(m_properties, m_dev_bracketing_exposure->get_name(), new_list);
+    }
+}
+
+
+outcome::result<void> tcam::property::SoftwareProperties::set_hdr_bracketing(
+    const emulated::hdr_bracketing::config& cfg)
+{
+    if (!m_dev_bracketing_exposure)
+    {
+        return tcam::status::PropertyNotImplemented;
+    }
+
+    if (cfg.enabled && !m_hdr_bracketing.get_config().enabled)
+    {
+        auto exposure = m_dev_bracketing_exposure->get_value();
+        if (!exposure)
+        {
+            return exposure.as_failure();
+        }
+        m_hdr_bracketing_base_us = exposure.value();
+    }
+
+    const auto range = m_dev_bracketing_exposure->get_range();
+    m_hdr_bracketing.configure(cfg, m_hdr_bracketing_base_us, range.min, range.max);
+    return outcome::success();
+}
+
+
 void tcam::property::SoftwareProperties::generate_gain_auto()
 {
     auto has_exposure_auto = find_property(m_properties, "GainAuto") != nullptr;
@@ -117,6 +218,7 @@ void tcam::property::SoftwareProperties::generate_gain_auto()
     m_auto_params.gain.auto_enabled = true;
     m_auto_params.gain.min = m_dev_gain->get_range().min;
     m_auto_params.gain.max = m_dev_gain->get_range().max;
+    m_gain_write.configure(m_dev_gain->get_range().stp, write_deadband, write_interval);
 
     const auto prop_range = emulated::to_range(*m_dev_gain);
     const auto prop_range_lower_limit =
@@ -184,7 +286,7 @@ void tcam::property::SoftwareProperties::generate_iris_auto()
 
     SPDLOG_INFO("Adding software IrisAuto.");
 
-    // #TODO: granularity/step
+    m_iris_write.configure(std::max<int64_t>(iris_range.stp, 1), write_deadband, write_interval);
 
     auto new_iris =
         make_prop_entry(sp::Iris, &tcamprop1::prop_list::Iris, emulated::to_range(*m_dev_iris));
@@ -258,6 +360,31 @@ void tcam::property::SoftwareProperties::generate_auto_functions_roi()
 }
 
 
+void tcam::property::SoftwareProperties::generate_auto_functions_group()
+{
+    // only the software algorithms can be shared
+    if (!m_dev_exposure && !m_dev_gain && !m_wb.m_is_software_auto_wb)
+    {
+        return;
+    }
+
+    auto new_group = make_prop_entry(
+        sp::AutoFunctionsGroup,
+        &tcamprop1::prop_list::AutoFunctionsGroup,
+        emulated::prop_range_integer_def { { 0, emulated::auto_group_member::max_group_id, 1 },
+                                           0 });
+
+    if (find_property(m_properties, "AutoFunctionsROILeft"))
+    {
+        add_prop_entry(m_properties, "AutoFunctionsROILeft", { new_group });
+    }
+    else
+    {
+        m_properties.push_back(new_group);
+    }
+}
+
+
 void tcam::property::SoftwareProperties::set_auto_functions_preset_mode(
     AutoFunctionsROIPreset_Modes mode)
 {
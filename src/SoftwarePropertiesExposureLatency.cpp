@@ -0,0 +1,92 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "SoftwarePropertiesExposureLatency.h"
+
+#include "utils.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace tcam::property::emulated;
+
+
+void exposure_latency_tracker::reset(int default_latency_frames) noexcept
+{
+    write_pending_ = false;
+    last_frame_ = 0;
+    latency_frames_ = std::clamp<int>(default_latency_frames, 0, max_latency_frames);
+    latency_measured_ = false;
+}
+
+
+void exposure_latency_tracker::on_write(std::optional<double> exposure_us) noexcept
+{
+    write_exposure_us_ = exposure_us.value_or(0);
+    write_has_exposure_ = exposure_us.has_value();
+    write_frame_ = last_frame_.load();
+    write_pending_.store(true, std::memory_order_release);
+}
+
+
+bool exposure_latency_tracker::on_frame(uint64_t frame_count,
+                                        std::optional<double> chunk_exposure_us) noexcept
+{
+    last_frame_ = frame_count;
+
+    if (!write_pending_.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    const uint64_t write_frame = write_frame_;
+    const uint64_t frames_since_write = frame_count > write_frame ? frame_count - write_frame : 0;
+
+    if (frames_since_write > max_latency_frames)
+    {
+        write_pending_ = false;
+        return false;
+    }
+
+    if (chunk_exposure_us && write_has_exposure_)
+    {
+        // devices round to their step size
+        const double written = write_exposure_us_;
+        if (std::abs(*chunk_exposure_us - written) > std::max(2.0, written * 0.02))
+        {
+            return true;
+        }
+
+        latency_frames_ = static_cast<int>(frames_since_write);
+        latency_measured_ = true;
+        write_pending_ = false;
+        return false;
+    }
+
+    if (frames_since_write < static_cast<uint64_t>(latency_frames_.load()))
+    {
+        return true;
+    }
+    write_pending_ = false;
+    return false;
+}
+
+
+int exposure_latency_tracker::get_default_latency(int fallback)
+{
+    return tcam::get_environment_variable_int("TCAM_EXPOSURE_LATENCY_FRAMES").value_or(fallback);
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+namespace tcam::property::emulated
+{
+
+//
+// Tracks how many frames it takes until exposure/gain written by the auto algorithms show up in
+// the images.
+//
+// With ExposureTime chunk data the first image taken with a written exposure is recognized, which
+// also measures the latency. Without chunk data, images are considered in flight for the last
+// measured latency, or the default latency when nothing was measured.
+//
+// on_write is meant for the auto algorithm thread, on_frame for the capture thread.
+//
+class exposure_latency_tracker
+{
+public:
+    void reset(int default_latency_frames) noexcept;
+
+    // exposure_us is the written exposure, nullopt when only gain was written
+    void on_write(std::optional<double> exposure_us) noexcept;
+
+    // Returns true when the image was taken before the last write was applied.
+    bool on_frame(uint64_t frame_count, std::optional<double> chunk_exposure_us) noexcept;
+
+    int get_latency_frames() const noexcept
+    {
+        return latency_frames_;
+    }
+
+    // true once the latency was measured with chunk data
+    bool is_latency_measured() const noexcept
+    {
+        return latency_measured_;
+    }
+
+    // reads TCAM_EXPOSURE_LATENCY_FRAMES, fallback is used when it is not set
+    static int get_default_latency(int fallback = 3);
+
+private:
+    // a write that never shows up, e.g. because the device rounds more than expected, ends here
+    static constexpr uint64_t max_latency_frames = 30;
+
+    std::atomic<uint64_t> last_frame_ = 0;
+
+    std::atomic<bool> write_pending_ = false;
+    std::atomic<uint64_t> write_frame_ = 0;
+    std::atomic<double> write_exposure_us_ = 0;
+    std::atomic<bool> write_has_exposure_ = false;
+
+    std::atomic<int> latency_frames_ = 3;
+    std::atomic<bool> latency_measured_ = false;
+};
+
+} // namespace tcam::property::emulated
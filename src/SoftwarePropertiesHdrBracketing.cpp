@@ -0,0 +1,125 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "SoftwarePropertiesHdrBracketing.h"
+
+#include "logging.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace tcam::property::emulated;
+
+
+void hdr_bracketing::configure(const config& cfg, double base_us, double min_us, double max_us)
+{
+    std::scoped_lock lck { mtx_ };
+
+    const bool was_enabled = cfg_.enabled;
+
+    cfg_ = cfg;
+    cfg_.count = std::clamp(cfg_.count, min_count, max_count);
+    base_us_ = base_us;
+
+    double value = base_us;
+    for (auto& v : values_)
+    {
+        v = std::clamp(value, min_us, max_us);
+        value *= cfg_.ratio;
+    }
+
+    written_.fill({});
+
+    if (cfg_.enabled)
+    {
+        active_ = true;
+        restore_pending_ = false;
+    }
+    else if (was_enabled)
+    {
+        restore_pending_ = true;
+    }
+}
+
+
+hdr_bracketing::config hdr_bracketing::get_config() const
+{
+    std::scoped_lock lck { mtx_ };
+    return cfg_;
+}
+
+
+hdr_bracketing::image_tag hdr_bracketing::on_image(IPropertyFloat& exposure,
+                                                   uint64_t frame_count,
+                                                   int latency_frames,
+                                                   std::optional<double> chunk_exposure_us)
+{
+    if (!active_)
+    {
+        return {};
+    }
+
+    std::scoped_lock lck { mtx_ };
+
+    if (!cfg_.enabled)
+    {
+        if (restore_pending_)
+        {
+            restore_pending_ = false;
+            if (auto res = exposure.set_value(base_us_); !res)
+            {
+                SPDLOG_ERROR("Unable to restore ExposureTime: {}", res.error().message());
+            }
+        }
+        active_ = false;
+        return {};
+    }
+
+    const auto count = static_cast<uint32_t>(cfg_.count);
+
+    // frame_count keeps the cycle stable over dropped frames
+    const uint64_t target = frame_count + static_cast<uint64_t>(std::max(latency_frames, 0));
+    const auto target_index = static_cast<uint32_t>(target % count);
+    if (auto res = exposure.set_value(values_[target_index]); res)
+    {
+        written_[target % written_.size()] = { target, target_index };
+    }
+    else
+    {
+        SPDLOG_ERROR("Unable to set bracketing ExposureTime: {}", res.error().message());
+    }
+
+    if (chunk_exposure_us)
+    {
+        // devices round to their step size
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (std::abs(*chunk_exposure_us - values_[i]) <= std::max(2.0, values_[i] * 0.02))
+            {
+                return { count, i, *chunk_exposure_us };
+            }
+        }
+        return {};
+    }
+
+    const auto& entry = written_[frame_count % written_.size()];
+    if (entry.frame != frame_count)
+    {
+        return {};
+    }
+    return { count, entry.index, values_[entry.index] };
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "PropertyInterfaces.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+namespace tcam::property::emulated
+{
+
+//
+// Cycles ExposureTime through count values frame by frame, value i is base * ratio^i.
+//
+// The exposure of the image latency_frames ahead is written from the capture thread, so the
+// cycle does not wait for the auto algorithm thread. The images are tagged with the index of
+// their exposure, taken from the ExposureTime chunk when the device sends it, otherwise from
+// the frame the value was written for. Images of frames whose write was missed, e.g. because
+// of dropped frames, are not tagged.
+//
+class hdr_bracketing
+{
+public:
+    static constexpr int min_count = 2;
+    static constexpr int max_count = 4;
+
+    struct config
+    {
+        bool enabled = false;
+        int count = 3;
+        double ratio = 4.0;
+    };
+
+    struct image_tag
+    {
+        // 0 for images that are not part of a bracket
+        uint32_t count = 0;
+        uint32_t index = 0;
+        double exposure_us = 0;
+    };
+
+    // base_us is the shortest exposure, it is written back when bracketing is disabled
+    // The values are clamped to [min_us;max_us].
+    void configure(const config& cfg, double base_us, double min_us, double max_us);
+
+    config get_config() const;
+
+    // true while the exposure belongs to the bracketing, including the write of the base value
+    bool is_active() const noexcept
+    {
+        return active_;
+    }
+
+    // Called for every image in the capture thread.
+    image_tag on_image(IPropertyFloat& exposure,
+                       uint64_t frame_count,
+                       int latency_frames,
+                       std::optional<double> chunk_exposure_us);
+
+private:
+    mutable std::mutex mtx_;
+
+    config cfg_;
+    double base_us_ = 0;
+    std::array<double, max_count> values_ = {};
+
+    std::atomic<bool> active_ = false;
+    bool restore_pending_ = false;
+
+    struct written_value
+    {
+        uint64_t frame = UINT64_MAX;
+        uint32_t index = 0;
+    };
+    // keyed by frame % size, larger than exposure_latency_tracker::max_latency_frames
+    std::array<written_value, 32> written_ = {};
+};
+
+} // namespace tcam::property::emulated
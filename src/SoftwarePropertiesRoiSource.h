@@ -0,0 +1,80 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "base_types.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <dutils_img/image_helper_types.h>
+#include <optional>
+
+namespace tcam::property::emulated
+{
+
+//
+// Brightness ROI that replaces the AutoFunctionsROI properties while it is set, e.g. to let the
+// auto exposure follow a tracked object.
+//
+// The ROI is packed into one atomic word, so set can be called from any thread for every image
+// without taking the property mutex, and get is cheap enough for the capture thread.
+//
+class brightness_roi_source
+{
+public:
+    // nullopt or an empty ROI hands control back to the AutoFunctionsROI properties
+    void set(const std::optional<tcam_image_roi>& roi) noexcept
+    {
+        if (!roi || roi->width == 0 || roi->height == 0)
+        {
+            roi_.store(0, std::memory_order_relaxed);
+            return;
+        }
+        roi_.store(pack(*roi), std::memory_order_relaxed);
+    }
+
+    // returns nullopt when no ROI is set
+    std::optional<img::rect> get() const noexcept
+    {
+        const uint64_t v = roi_.load(std::memory_order_relaxed);
+        if (v == 0)
+        {
+            return std::nullopt;
+        }
+        const int left = static_cast<int>(v & 0xFFFF);
+        const int top = static_cast<int>((v >> 16) & 0xFFFF);
+        const int width = static_cast<int>((v >> 32) & 0xFFFF);
+        const int height = static_cast<int>(v >> 48);
+        return img::rect { left, top, left + width, top + height };
+    }
+
+private:
+    // 16 bits per value, the auto algorithms clip the ROI to the image anyway
+    static uint64_t pack(const tcam_image_roi& roi) noexcept
+    {
+        auto clamp = [](uint32_t val) -> uint64_t { return std::min<uint32_t>(val, 0xFFFF); };
+
+        return clamp(roi.left) | clamp(roi.top) << 16 | std::max<uint64_t>(clamp(roi.width), 1) << 32
+               | std::max<uint64_t>(clamp(roi.height), 1) << 48;
+    }
+
+    std::atomic<uint64_t> roi_ = 0;
+};
+
+} // namespace tcam::property::emulated
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "SoftwarePropertiesTuning.h"
+
+#include "DeviceInfo.h"
+#include "logging.h"
+#include "v4l2/sensor_id_33u.h"
+
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+using namespace tcam::property::emulated;
+
+namespace
+{
+
+constexpr int any_sensor = -1;
+
+enum class transport
+{
+    any,
+    usb3,
+    gige,
+};
+
+struct auto_tuning_entry
+{
+    transport link;
+    int sensor_id; // PRODUCT_ID_SENSOR_*, only known for 33U/37U/38U devices on v4l2
+    std::string_view model; // part of the model name, empty matches all
+
+    auto_tuning_profile profile;
+};
+
+constexpr auto_tuning_profile default_profile = {
+    "default", auto_alg::timing_params {}, auto_alg::exposure_step_params {}, 3, 128,
+};
+
+// The sensor latches exposure for the next frame, so dampened steps can be larger.
+constexpr auto_tuning_profile usb3_global_shutter_profile = {
+    "usb3-global-shutter",
+    auto_alg::timing_params { 2, 5, 100'000 },
+    auto_alg::exposure_step_params { 1.f, 4.f },
+    2,
+    128,
+};
+
+constexpr auto_tuning_profile usb3_rolling_shutter_profile = {
+    "usb3-rolling-shutter",
+    auto_alg::timing_params { 2, 5, 100'000 },
+    auto_alg::exposure_step_params { 2.f, 4.f },
+    3,
+    128,
+};
+
+// Writes take a GVCP round trip and the images are buffered in the camera.
+constexpr auto_tuning_profile gige_profile = {
+    "gige",
+    auto_alg::timing_params { 3, 6, 150'000 },
+    auto_alg::exposure_step_params { 2.f, 3.f },
+    4,
+    128,
+};
+
+// first match wins, so specific entries go first
+const auto_tuning_entry tuning_table[] = {
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX174, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX249, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX250, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX252, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX253, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX255, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX264, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX265, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX267, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX273, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX287, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX304, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX540, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX541, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX542, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX545, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX546, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX547, "", usb3_global_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_AR0234, "", usb3_global_shutter_profile },
+
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX178, "", usb3_rolling_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX183, "", usb3_rolling_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX226, "", usb3_rolling_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX290, "", usb3_rolling_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_IMX462, "", usb3_rolling_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_AR0521, "", usb3_rolling_shutter_profile },
+    { transport::usb3, PRODUCT_ID_SENSOR_MT9J003, "", usb3_rolling_shutter_profile },
+
+    { transport::gige, any_sensor, "", gige_profile },
+};
+
+
+// sensor part of the USB product id, when this is a 33U/37U/38U device
+int get_sensor_id(const tcam::DeviceInfo& device)
+{
+    if (device.get_device_type() != tcam::TCAM_DEVICE_TYPE_V4L2)
+    {
+        return any_sensor;
+    }
+
+    const std::string product_str = device.get_info().additional_identifier;
+    if (product_str.empty())
+    {
+        return any_sensor;
+    }
+
+    char* end = nullptr;
+    const auto product_id = std::strtoul(product_str.c_str(), &end, 16);
+    if (end == product_str.c_str() || *end != '\0')
+    {
+        return any_sensor;
+    }
+
+    switch (product_id & PRODUCT_ID_BASE_MASK)
+    {
+        case PRODUCT_ID_BASE_DEFAULT:
+        case PRODUCT_ID_BASE_37U:
+        case PRODUCT_ID_BASE_38U:
+            return static_cast<int>(product_id & PRODUCT_ID_SENSOR_MASK);
+        default:
+            return any_sensor;
+    }
+}
+
+
+transport get_transport(const tcam::DeviceInfo& device)
+{
+    switch (device.get_device_type())
+    {
+        case tcam::TCAM_DEVICE_TYPE_V4L2:
+            return transport::usb3;
+        case tcam::TCAM_DEVICE_TYPE_ARAVIS:
+            // aravis also opens USB3 Vision devices
+            return std::string_view(device.get_info().additional_identifier) == "USB3"
+                       ? transport::usb3
+                       : transport::gige;
+        default:
+            return transport::any;
+    }
+}
+
+
+bool matches(const auto_tuning_entry& entry,
+             transport link,
+             int sensor_id,
+             std::string_view model)
+{
+    if (entry.link != transport::any && entry.link != link)
+    {
+        return false;
+    }
+    if (entry.sensor_id != any_sensor && entry.sensor_id != sensor_id)
+    {
+        return false;
+    }
+    return entry.model.empty() || model.find(entry.model) != std::string_view::npos;
+}
+
+} // namespace
+
+
+const auto_tuning_profile& tcam::property::emulated::find_auto_tuning_profile(
+    const tcam::DeviceInfo& device)
+{
+    const auto link = get_transport(device);
+    const int sensor_id = get_sensor_id(device);
+    const std::string model = device.get_name();
+
+    for (const auto& entry : tuning_table)
+    {
+        if (matches(entry, link, sensor_id, model))
+        {
+            SPDLOG_DEBUG("Using auto algorithm tuning '{}' for '{}'.", entry.profile.name, model);
+            return entry.profile;
+        }
+    }
+    return default_profile;
+}
+
+
+const auto_tuning_profile& tcam::property::emulated::get_default_auto_tuning_profile()
+{
+    return default_profile;
+}
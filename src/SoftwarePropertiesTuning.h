@@ -0,0 +1,50 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <dutils_img_pipe/auto_alg_pass.h>
+
+namespace tcam
+{
+class DeviceInfo;
+}
+
+namespace tcam::property::emulated
+{
+
+//
+// Starting values for the software auto algorithms of one camera family.
+//
+struct auto_tuning_profile
+{
+    const char* name;
+
+    auto_alg::timing_params timing;
+    auto_alg::exposure_step_params exposure_step;
+
+    // frames until a written exposure shows up, used until chunk data measured it
+    int exposure_latency_frames;
+    int exposure_reference;
+};
+
+// Returns the first entry of the tuning table that matches the device.
+const auto_tuning_profile& find_auto_tuning_profile(const tcam::DeviceInfo& device);
+
+const auto_tuning_profile& get_default_auto_tuning_profile();
+
+} // namespace tcam::property::emulated
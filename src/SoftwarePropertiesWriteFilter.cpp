@@ -0,0 +1,98 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SoftwarePropertiesWriteFilter.h"
+
+#include "utils.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace tcam::property::emulated;
+
+
+void auto_write_filter::configure(double step,
+                                  double deadband,
+                                  std::chrono::microseconds min_interval)
+{
+    step_ = std::max(step, 0.0);
+    deadband_ = std::max(deadband, 0.0);
+    min_interval_ = min_interval;
+
+    last_written_.reset();
+    pending_.reset();
+    invalidated_ = false;
+}
+
+
+void auto_write_filter::submit(double new_value)
+{
+    if (invalidated_.exchange(false))
+    {
+        last_written_.reset();
+    }
+
+    if (!last_written_)
+    {
+        pending_ = new_value;
+        return;
+    }
+
+    const double threshold = std::max(step_, deadband_ * std::abs(*last_written_));
+    if (std::abs(new_value - *last_written_) < threshold)
+    {
+        // the device already has a value close enough, this also drops older held back values
+        pending_.reset();
+        return;
+    }
+    pending_ = new_value;
+}
+
+
+std::optional<double> auto_write_filter::take_due(clock::time_point now)
+{
+    if (!pending_)
+    {
+        return std::nullopt;
+    }
+
+    if (last_written_ && !invalidated_ && now - last_write_time_ < min_interval_)
+    {
+        return std::nullopt;
+    }
+
+    auto rval = pending_;
+    pending_.reset();
+
+    last_written_ = rval;
+    last_write_time_ = now;
+
+    return rval;
+}
+
+
+double auto_write_filter::get_default_deadband()
+{
+    // in 1/1000 of the current value
+    return tcam::get_environment_variable_int("TCAM_AUTO_WRITE_DEADBAND").value_or(5) / 1000.0;
+}
+
+
+std::chrono::microseconds auto_write_filter::get_default_interval()
+{
+    return std::chrono::milliseconds(
+        tcam::get_environment_variable_int("TCAM_AUTO_WRITE_INTERVAL_MS").value_or(20));
+}
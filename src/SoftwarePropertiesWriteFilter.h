@@ -0,0 +1,70 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+
+namespace tcam::property::emulated
+{
+
+//
+// Decides which of the values an auto algorithm produces are actually written to the device.
+//
+// Values that differ from the last written value by less than the device step or the deadband
+// are dropped. Values that arrive before min_interval elapsed since the last write are held back
+// and returned by take_due once the interval is over, newer values replace held back ones.
+//
+// submit/take_due are meant for the auto algorithm thread, invalidate may be called from any
+// thread.
+//
+class auto_write_filter
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    // deadband is relative to the last written value, e.g. 0.005 for 0.5%
+    void configure(double step, double deadband, std::chrono::microseconds min_interval);
+
+    void submit(double new_value);
+
+    std::optional<double> take_due(clock::time_point now);
+
+    // forget the last write, e.g. because the value was written by someone else
+    void invalidate() noexcept
+    {
+        invalidated_ = true;
+    }
+
+    // reads TCAM_AUTO_WRITE_DEADBAND and TCAM_AUTO_WRITE_INTERVAL_MS
+    static double get_default_deadband();
+    static std::chrono::microseconds get_default_interval();
+
+private:
+    double step_ = 0;
+    double deadband_ = 0;
+    std::chrono::microseconds min_interval_ {};
+
+    std::optional<double> last_written_;
+    clock::time_point last_write_time_;
+    std::optional<double> pending_;
+
+    std::atomic<bool> invalidated_ = false;
+};
+
+} // namespace tcam::property::emulated
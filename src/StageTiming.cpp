@@ -0,0 +1,228 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "StageTiming.h"
+
+#include "tracepoints.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace
+{
+
+using namespace tcam::timing;
+
+struct event_slot
+{
+    // odd while the writer updates the slot, 0 when the slot was never written
+    std::atomic<uint64_t> seq = 0;
+
+    std::atomic<uint64_t> time_ns = 0;
+    std::atomic<uint64_t> frame_count = 0;
+    // stream_id << 8 | stage
+    std::atomic<uint64_t> id = 0;
+};
+
+struct thread_ring;
+
+struct ring_registry
+{
+    std::mutex mtx;
+    std::vector<thread_ring*> rings;
+};
+
+ring_registry& get_registry()
+{
+    // never destroyed, thread_local rings may unregister after static destruction
+    static auto registry = new ring_registry;
+    return *registry;
+}
+
+struct thread_ring
+{
+    std::array<event_slot, ring_size> slots;
+    // only touched by the owning thread
+    uint64_t next = 0;
+
+    thread_ring()
+    {
+        auto& registry = get_registry();
+        std::scoped_lock lck { registry.mtx };
+        registry.rings.push_back(this);
+    }
+
+    ~thread_ring()
+    {
+        auto& registry = get_registry();
+        std::scoped_lock lck { registry.mtx };
+        registry.rings.erase(std::remove(registry.rings.begin(), registry.rings.end(), this),
+                             registry.rings.end());
+    }
+
+    thread_ring(const thread_ring&) = delete;
+    thread_ring& operator=(const thread_ring&) = delete;
+
+    void write(uint64_t time_ns, uint64_t frame_count, uint64_t id) noexcept
+    {
+        const uint64_t pos = next++;
+        event_slot& slot = slots[pos % ring_size];
+
+        const uint64_t seq = 2 * pos + 1;
+        slot.seq.store(seq, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.time_ns.store(time_ns, std::memory_order_relaxed);
+        slot.frame_count.store(frame_count, std::memory_order_relaxed);
+        slot.id.store(id, std::memory_order_relaxed);
+
+        slot.seq.store(seq + 1, std::memory_order_release);
+    }
+
+    template<typename F> void read(F&& func) const
+    {
+        for (const auto& slot : slots)
+        {
+            const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+            if (seq == 0 || (seq & 1))
+            {
+                continue;
+            }
+
+            stage_event e = {};
+            e.time_ns = slot.time_ns.load(std::memory_order_relaxed);
+            e.frame_count = slot.frame_count.load(std::memory_order_relaxed);
+            const uint64_t id = slot.id.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != seq)
+            {
+                // overwritten while copying
+                continue;
+            }
+
+            e.stream_id = static_cast<uint32_t>(id >> 8);
+            e.id = static_cast<stage>(id & 0xff);
+            func(e);
+        }
+    }
+};
+
+thread_ring& get_thread_ring()
+{
+    thread_local thread_ring ring;
+    return ring;
+}
+
+template<typename F> void for_each_event(F&& func)
+{
+    auto& registry = get_registry();
+    // keeps threads from destroying their ring while it is read
+    std::scoped_lock lck { registry.mtx };
+    for (const auto ring : registry.rings) { ring->read(func); }
+}
+
+} // namespace
+
+
+const char* tcam::timing::to_string(stage s) noexcept
+{
+    switch (s)
+    {
+        case stage::backend_dequeue:
+            return "backend_dequeue";
+        case stage::push_image_enter:
+            return "push_image_enter";
+        case stage::push_image_exit:
+            return "push_image_exit";
+        case stage::auto_pass_begin:
+            return "auto_pass_begin";
+        case stage::auto_pass_end:
+            return "auto_pass_end";
+        case stage::pool_callback:
+            return "pool_callback";
+        case stage::create_return:
+            return "create_return";
+    }
+    return "unknown";
+}
+
+
+bool tcam::timing::is_enabled() noexcept
+{
+    static const bool enabled =
+        tcam::get_environment_variable_int("TCAM_STAGE_TIMING").value_or(1) != 0;
+    return enabled;
+}
+
+
+uint32_t tcam::timing::new_stream_id() noexcept
+{
+    static std::atomic<uint32_t> next_id = 1;
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+uint64_t tcam::timing::record(stage s, uint32_t stream_id, uint64_t frame_count) noexcept
+{
+    if (!is_enabled())
+    {
+        return 0;
+    }
+
+    const uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now().time_since_epoch())
+                             .count();
+
+    get_thread_ring().write(
+        now, frame_count, static_cast<uint64_t>(stream_id) << 8 | static_cast<uint64_t>(s));
+
+    TCAM_TRACE4(stage, static_cast<int>(s), stream_id, frame_count, now);
+
+    return now;
+}
+
+
+std::vector<tcam::timing::stage_event> tcam::timing::get_events()
+{
+    std::vector<stage_event> rval;
+    for_each_event([&rval](const stage_event& e) { rval.push_back(e); });
+
+    std::sort(rval.begin(),
+              rval.end(),
+              [](const stage_event& a, const stage_event& b) { return a.time_ns < b.time_ns; });
+    return rval;
+}
+
+
+tcam::timing::frame_timing tcam::timing::get_frame_timing(uint32_t stream_id, uint64_t frame_count)
+{
+    frame_timing rval;
+    for_each_event(
+        [&rval, stream_id, frame_count](const stage_event& e)
+        {
+            if (e.stream_id == stream_id && e.frame_count == frame_count)
+            {
+                rval[e.id] = e.time_ns;
+            }
+        });
+    return rval;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tcam::timing
+{
+
+//
+// Per image timestamps of the stages an image passes, always compiled in.
+//
+// Every thread that records gets its own ring of the last ring_size events, recording
+// takes a clock read and a few stores and never blocks. Readers copy the rings without
+// stopping the writers, events that are overwritten while being copied are skipped.
+//
+// TCAM_STAGE_TIMING=0 disables recording.
+//
+
+enum class stage : uint8_t
+{
+    backend_dequeue, // the backend has the completed image
+    push_image_enter, // CaptureDeviceImpl::push_image
+    push_image_exit,
+    auto_pass_begin, // auto algorithms, runs in its own thread
+    auto_pass_end,
+    pool_callback, // tcamsrc received the image
+    create_return, // tcamsrc hands the image to GStreamer
+};
+
+constexpr size_t stage_count = 7;
+
+constexpr size_t ring_size = 512;
+
+const char* to_string(stage s) noexcept;
+
+struct stage_event
+{
+    uint64_t time_ns; // steady clock, i.e. CLOCK_MONOTONIC
+    uint64_t frame_count; // tcam_stream_statistics::frame_count
+    uint32_t stream_id;
+    stage id;
+};
+
+// stage times of one image, 0 for stages that were not recorded
+struct frame_timing
+{
+    uint64_t time_ns[stage_count] = {};
+
+    uint64_t& operator[](stage s) noexcept
+    {
+        return time_ns[static_cast<size_t>(s)];
+    }
+    uint64_t operator[](stage s) const noexcept
+    {
+        return time_ns[static_cast<size_t>(s)];
+    }
+};
+
+bool is_enabled() noexcept;
+
+// process unique id that distinguishes the images of several devices
+uint32_t new_stream_id() noexcept;
+
+// Returns the recorded time, 0 when recording is disabled.
+uint64_t record(stage s, uint32_t stream_id, uint64_t frame_count) noexcept;
+
+// The events still held by the rings of all threads, ordered by time.
+std::vector<stage_event> get_events();
+
+// Collects the events of one image from all rings.
+frame_timing get_frame_timing(uint32_t stream_id, uint64_t frame_count);
+
+} // namespace tcam::timing
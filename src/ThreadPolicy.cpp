@@ -0,0 +1,360 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ThreadPolicy.h"
+
+#include "logging.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace tcam::thread_policy;
+
+namespace
+{
+
+struct sched_name
+{
+    const char* name;
+    int policy;
+};
+
+constexpr sched_name sched_names[] = {
+    { "other", SCHED_OTHER }, { "batch", SCHED_BATCH }, { "idle", SCHED_IDLE },
+    { "fifo", SCHED_FIFO },   { "rr", SCHED_RR },
+};
+
+
+bool is_realtime(int policy)
+{
+    return policy == SCHED_FIFO || policy == SCHED_RR;
+}
+
+
+std::optional<int> parse_int(const std::string& str)
+{
+    try
+    {
+        size_t pos = 0;
+        int ret = std::stoi(str, &pos);
+        if (pos != str.size())
+        {
+            return std::nullopt;
+        }
+        return ret;
+    }
+    catch (const std::exception&)
+    {
+        return std::nullopt;
+    }
+}
+
+
+std::optional<rule> parse_rule(const std::string& str, const std::string& default_serial)
+{
+    auto fields = tcam::split_string(str, ":");
+
+    rule ret;
+    ret.role = fields.at(0);
+    if (auto at = ret.role.find('@'); at != std::string::npos)
+    {
+        ret.serial = ret.role.substr(at + 1);
+        ret.role.erase(at);
+    }
+    else
+    {
+        ret.serial = default_serial;
+    }
+    if (ret.role.empty())
+    {
+        return std::nullopt;
+    }
+
+    for (size_t i = 1; i < fields.size(); ++i)
+    {
+        auto eq = fields[i].find('=');
+        if (eq == std::string::npos)
+        {
+            return std::nullopt;
+        }
+        auto key = fields[i].substr(0, eq);
+        auto value = fields[i].substr(eq + 1);
+
+        if (key == "cpus")
+        {
+            auto cpus = tcam::parse_cpu_list(value);
+            if (!cpus || cpus->empty())
+            {
+                return std::nullopt;
+            }
+            ret.cpus = value;
+        }
+        else if (key == "sched")
+        {
+            auto iter = std::find_if(std::begin(sched_names),
+                                     std::end(sched_names),
+                                     [&value](const auto& s) { return value == s.name; });
+            if (iter == std::end(sched_names))
+            {
+                return std::nullopt;
+            }
+            ret.sched_policy = iter->policy;
+        }
+        else if (key == "prio")
+        {
+            ret.priority = parse_int(value);
+            if (!ret.priority)
+            {
+                return std::nullopt;
+            }
+        }
+        else
+        {
+            return std::nullopt;
+        }
+    }
+    return ret;
+}
+
+
+// 0 when the rule does not match, higher values for more specific rules
+size_t match_score(const rule& r, const std::string& role, const std::string& serial)
+{
+    if (!r.serial.empty() && r.serial != serial)
+    {
+        return 0;
+    }
+
+    const size_t prefix_len = r.role.size() - 1;
+
+    size_t score = 0;
+    if (r.role == role)
+    {
+        score = role.size() + 2;
+    }
+    else if (r.role.back() == '*' && role.compare(0, prefix_len, r.role, 0, prefix_len) == 0)
+    {
+        score = r.role.size();
+    }
+    else
+    {
+        return 0;
+    }
+
+    // a device rule beats every rule for all devices
+    if (!r.serial.empty())
+    {
+        score += 1024;
+    }
+    return score;
+}
+
+
+struct registry
+{
+    std::mutex mtx;
+    std::vector<rule> rules;
+
+    registry()
+    {
+        auto config = tcam::get_environment_variable("TCAM_THREAD_POLICY", "");
+        if (config.empty())
+        {
+            return;
+        }
+        auto parsed = parse_rules(config);
+        if (!parsed)
+        {
+            SPDLOG_WARN("Unable to parse TCAM_THREAD_POLICY '{}'. It is ignored.", config);
+            return;
+        }
+        rules = std::move(*parsed);
+    }
+};
+
+
+registry& get_registry()
+{
+    static registry instance;
+    return instance;
+}
+
+
+void apply_affinity(const char* role, const std::string& cpus)
+{
+    auto cpu_list = tcam::parse_cpu_list(cpus);
+    if (!cpu_list)
+    {
+        return;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : *cpu_list)
+    {
+        if (cpu < CPU_SETSIZE)
+        {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set); err != 0)
+    {
+        SPDLOG_WARN("Unable to pin thread {} to cpus '{}': {}", role, cpus, strerror(err));
+    }
+}
+
+
+void apply_scheduling(const char* role, int policy, std::optional<int> priority)
+{
+    sched_param param = {};
+    if (is_realtime(policy))
+    {
+        param.sched_priority = std::clamp(priority.value_or(sched_get_priority_min(policy)),
+                                          sched_get_priority_min(policy),
+                                          sched_get_priority_max(policy));
+    }
+    if (int err = pthread_setschedparam(pthread_self(), policy, &param); err != 0)
+    {
+        SPDLOG_WARN("Unable to set scheduling policy {} for thread {}: {}",
+                    policy,
+                    role,
+                    strerror(err));
+        return;
+    }
+
+    if (!is_realtime(policy) && priority)
+    {
+        // the nice value is per thread on linux
+        pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+        if (setpriority(PRIO_PROCESS, tid, *priority) != 0)
+        {
+            SPDLOG_WARN("Unable to set nice value {} for thread {}: {}",
+                        *priority,
+                        role,
+                        strerror(errno));
+        }
+    }
+}
+
+} // namespace
+
+
+std::optional<std::vector<rule>> tcam::thread_policy::parse_rules(const std::string& config,
+                                                                  const std::string& default_serial)
+{
+    std::vector<rule> ret;
+    for (const auto& str : tcam::split_string(config, ";"))
+    {
+        if (str.empty())
+        {
+            continue;
+        }
+        auto r = parse_rule(str, default_serial);
+        if (!r)
+        {
+            return std::nullopt;
+        }
+        ret.push_back(std::move(*r));
+    }
+    return ret;
+}
+
+
+void tcam::thread_policy::add_rules(const std::vector<rule>& rules)
+{
+    auto& reg = get_registry();
+    std::scoped_lock lck { reg.mtx };
+
+    for (const auto& r : rules)
+    {
+        auto is_same = [&r](const rule& existing)
+        {
+            return existing.role == r.role && existing.serial == r.serial;
+        };
+        auto iter = std::find_if(reg.rules.begin(), reg.rules.end(), is_same);
+        if (iter != reg.rules.end())
+        {
+            *iter = r;
+        }
+        else
+        {
+            reg.rules.push_back(r);
+        }
+    }
+}
+
+
+std::optional<rule> tcam::thread_policy::find_rule(const std::string& role,
+                                                   const std::string& serial)
+{
+    auto& reg = get_registry();
+    std::scoped_lock lck { reg.mtx };
+
+    const rule* best = nullptr;
+    size_t best_score = 0;
+    for (const auto& r : reg.rules)
+    {
+        auto score = match_score(r, role, serial);
+        if (score > best_score)
+        {
+            best = &r;
+            best_score = score;
+        }
+    }
+    if (!best)
+    {
+        return std::nullopt;
+    }
+    return *best;
+}
+
+
+void tcam::thread_policy::setup_thread(const char* role, const std::string& serial)
+{
+    tcam::set_thread_name(role);
+
+    auto r = find_rule(role, serial);
+    if (!r)
+    {
+        return;
+    }
+
+    if (!r->cpus.empty())
+    {
+        apply_affinity(role, r->cpus);
+    }
+    if (r->sched_policy)
+    {
+        apply_scheduling(role, *r->sched_policy, r->priority);
+    }
+    else if (r->priority)
+    {
+        apply_scheduling(role, SCHED_OTHER, r->priority);
+    }
+
+    SPDLOG_DEBUG("Thread {} uses the policy of '{}{}{}'",
+                 role,
+                 r->role,
+                 r->serial.empty() ? "" : "@",
+                 r->serial);
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace tcam::thread_policy
+{
+
+//
+// Cpu affinity and scheduling of the threads tcam creates.
+//
+// Every thread has a role, which is also its thread name (tcam_v4l2_strm, tcam_usbhand, ...).
+// Rules assign a cpu list and a scheduling policy to a role, optionally only for the threads of
+// one device. They come from TCAM_THREAD_POLICY and from the tcammainsrc property thread-policy.
+//
+// Syntax, rules are separated by ';':
+//   role[@serial][:cpus=<cpu list>][:sched=other|batch|idle|fifo|rr][:prio=<n>]
+// A role ending with '*' matches all roles with that prefix. prio is the real time priority
+// for fifo and rr and the nice value for other and batch.
+//
+// e.g. "tcam_v4l2_strm@12345678:cpus=2-3:sched=fifo:prio=50;tcamconvert:cpus=4-7"
+//
+// A thread uses the most specific matching rule: a rule for its device before a rule for all
+// devices, an exact role before a prefix, a longer prefix before a shorter one.
+//
+
+struct rule
+{
+    std::string role;
+    // empty for all devices
+    std::string serial;
+
+    // empty keeps the affinity
+    std::string cpus;
+
+    std::optional<int> sched_policy; // SCHED_*
+    std::optional<int> priority;
+};
+
+// nullopt when config is not valid
+// rules without a serial get default_serial
+std::optional<std::vector<rule>> parse_rules(const std::string& config,
+                                             const std::string& default_serial = {});
+
+// A rule replaces an earlier one for the same role and serial.
+// Threads that are already running keep their settings.
+void add_rules(const std::vector<rule>& rules);
+
+// nullopt when no rule matches
+std::optional<rule> find_rule(const std::string& role, const std::string& serial = {});
+
+// Names the calling thread after role and applies the rule for role and serial.
+// Errors are logged, the thread keeps running with its previous settings.
+void setup_thread(const char* role, const std::string& serial = {});
+
+} // namespace tcam::thread_policy
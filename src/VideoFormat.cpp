@@ -16,6 +16,7 @@
 
 #include "VideoFormat.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <dutils_img/fcc_to_string.h> // img::fcc_to_string
@@ -37,7 +38,7 @@ VideoFormat::VideoFormat(uint32_t fourcc,
 bool VideoFormat::operator==(const VideoFormat& other) const noexcept
 {
     return format.fourcc == other.format.fourcc && format.width == other.format.width
-           && format.height == other.format.height;
+           && format.height == other.format.height && regions_ == other.regions_;
     //&& compare_double(format.framerate, other.format.framerate);
 }
 
@@ -112,6 +113,17 @@ std::string VideoFormat::to_string() const
          + std::to_string(format.scaling.skipping_v) + ",";
     s += "framerate=" + std::to_string(format.framerate);
 
+    if (!regions_.empty())
+    {
+        s += ",regions=";
+        for (const auto& region : regions_)
+        {
+            s += std::to_string(region.offset_x) + ":" + std::to_string(region.offset_y) + ":"
+                 + std::to_string(region.width) + "x" + std::to_string(region.height) + ";";
+        }
+        s.pop_back();
+    }
+
     return s;
 }
 
@@ -132,6 +144,17 @@ std::string VideoFormat::get_fourcc_string() const
     return img::fcc_to_string(get_fourcc());
 }
 
+tcam_image_size tcam::calc_region_image_size(const std::vector<tcam_image_region>& regions) noexcept
+{
+    tcam_image_size size = {};
+    for (const auto& region : regions)
+    {
+        size.width = std::max(size.width, region.width);
+        size.height += region.height;
+    }
+    return size;
+}
+
 img::img_type VideoFormat::get_img_type() const noexcept
 {
     return img::make_img_type(
@@ -20,6 +20,7 @@
 #include "base_types.h"
 
 #include <string>
+#include <vector>
 
 namespace img
 {
@@ -80,6 +81,20 @@ public:
 
     void set_size(unsigned int width, unsigned int height) noexcept;
 
+    /**
+     * Sensor regions of a multi-region readout, empty when the whole format is one region.
+     * The image then holds the regions stacked from top to bottom in this order, each starting
+     * in the first column, so its size has to be calc_region_image_size(regions).
+     */
+    const std::vector<tcam_image_region>& get_regions() const noexcept
+    {
+        return regions_;
+    }
+    void set_regions(std::vector<tcam_image_region> regions)
+    {
+        regions_ = std::move(regions);
+    }
+
     std::string to_string() const;
 
     /**
@@ -101,8 +116,15 @@ public:
     img::img_type get_img_type() const noexcept;
 private:
     tcam_video_format format = {};
+    std::vector<tcam_image_region> regions_;
 };
 
+/**
+ * Size of an image that holds the regions stacked from top to bottom,
+ * the widest region and the sum of all heights.
+ */
+tcam_image_size calc_region_image_size(const std::vector<tcam_image_region>& regions) noexcept;
+
 
 } /*namespace tcam */
 
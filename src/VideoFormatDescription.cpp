@@ -18,18 +18,55 @@
 
 #include "FormatHandlerInterface.h"
 #include "logging.h"
+#include "scaling_table.h"
 #include "utils.h"
 
 #include <algorithm>
 #include <cstring>
+#include <tuple>
 
 using namespace tcam;
 
 
+namespace
+{
+
+bool fixed_less(const image_scaling& lhs_scaling,
+                const tcam_image_size& lhs_size,
+                const image_scaling& rhs_scaling,
+                const tcam_image_size& rhs_size)
+{
+    if (!(lhs_scaling == rhs_scaling))
+    {
+        return tcam::scaling_less(lhs_scaling, rhs_scaling);
+    }
+    return std::tie(lhs_size.width, lhs_size.height) < std::tie(rhs_size.width, rhs_size.height);
+}
+
+} // namespace
+
+
 VideoFormatDescription::VideoFormatDescription(const tcam_video_format_description& f,
                                                const std::vector<framerate_mapping>& r)
     : format(f), res(r)
 {
+    for (size_t i = 0; i < res.size(); ++i)
+    {
+        if (res[i].resolution.type == TCAM_RESOLUTION_TYPE_FIXED)
+        {
+            fixed_index_.push_back(i);
+        }
+    }
+
+    std::stable_sort(fixed_index_.begin(),
+                     fixed_index_.end(),
+                     [this](size_t lhs, size_t rhs)
+                     {
+                         return fixed_less(res[lhs].resolution.scaling,
+                                           res[lhs].resolution.min_size,
+                                           res[rhs].resolution.scaling,
+                                           res[rhs].resolution.min_size);
+                     });
 }
 
 bool VideoFormatDescription::operator==(const VideoFormatDescription& other) const
@@ -95,6 +132,24 @@ std::vector<double> VideoFormatDescription::get_framerates(const VideoFormat& fm
     }
 
     auto s = fmt.get_size();
+    const auto scaling = fmt.get_scaling();
+
+    // caps generation asks for every fixed resolution, avoid walking the whole list for each
+    auto iter = std::partition_point(fixed_index_.begin(),
+                                     fixed_index_.end(),
+                                     [this, &scaling, &s](size_t i)
+                                     {
+                                         return fixed_less(res[i].resolution.scaling,
+                                                           res[i].resolution.min_size,
+                                                           scaling,
+                                                           s);
+                                     });
+    if (iter != fixed_index_.end() && res[*iter].resolution.scaling == scaling
+        && res[*iter].resolution.min_size == s)
+    {
+        return res[*iter].framerates;
+    }
+
     for (const auto& r : res)
     {
         if (r.resolution.type == TCAM_RESOLUTION_TYPE_FIXED)
@@ -105,12 +105,25 @@ public:
 
     std::vector<tcam_resolution_description> get_resolutions() const;
 
+    const tcam_video_format_description& get_format_description() const
+    {
+        return format;
+    }
+
+    const std::vector<framerate_mapping>& get_framerate_mappings() const
+    {
+        return res;
+    }
+
     std::vector<double> get_framerates(const VideoFormat& s) const;
 
 private:
     tcam_video_format_description format;
 
     std::vector<framerate_mapping> res;
+
+    // indices of the fixed resolutions in res, sorted by scaling and size for get_framerates
+    std::vector<size_t> fixed_index_;
 };
 
 } /* namespace tcam */
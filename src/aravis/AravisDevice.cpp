@@ -18,8 +18,10 @@
 
 #include "../logging.h"
 #include "../utils.h"
+#include "../SlabAllocator.h"
 #include "AravisPropertyBackend.h"
-#include "AravisAllocator.h"
+#include "aravis_api.h"
+#include "aravis_format_cache.h"
 #include "aravis_utils.h"
 
 #include <algorithm>
@@ -46,6 +48,29 @@ AravisDevice::AravisDevice(const DeviceInfo& device_desc)
         throw std::runtime_error("Error while creating ArvCamera");
     }
 
+    // opened by ip address, see tcam::find_gige_device
+    if (device.get_serial().empty())
+    {
+        auto info = device.get_info();
+        auto arv_device = arv_camera_get_device(arv_camera_);
+
+        auto serial = arv_device_get_string_feature_value(arv_device, "DeviceSerialNumber", &err);
+        if (serial)
+        {
+            strncpy(info.serial_number, serial, sizeof(info.serial_number) - 1);
+        }
+        g_clear_error(&err);
+
+        auto model = arv_device_get_string_feature_value(arv_device, "DeviceModelName", &err);
+        if (model)
+        {
+            strncpy(info.name, model, sizeof(info.name) - 1);
+        }
+        g_clear_error(&err);
+
+        device = DeviceInfo(info);
+    }
+
     if (arv_camera_is_gv_device(this->arv_camera_))
     {
         if (!arv_gv_device_is_controller((ArvGvDevice*)arv_camera_get_device(this->arv_camera_)))
@@ -60,19 +85,57 @@ AravisDevice::AravisDevice(const DeviceInfo& device_desc)
     backend_ = std::make_shared<tcam::aravis::AravisPropertyBackend>(*this);
 
     genicam_ = arv_device_get_genicam(arv_camera_get_device(this->arv_camera_));
+    backend_->configure_register_cache();
 
     index_genicam();
 
+    for (const char* name : { "DeviceFirmwareVersion", "DeviceVersion" })
+    {
+        if (!has_genicam_property(name))
+        {
+            continue;
+        }
+        auto value = arv_device_get_string_feature_value(
+            arv_camera_get_device(arv_camera_), name, &err);
+        if (err)
+        {
+            g_clear_error(&err);
+            continue;
+        }
+        if (value && value[0] != '\0')
+        {
+            firmware_version_ = value;
+            break;
+        }
+    }
+
     // make aravis notify us when the device can not be reached
     g_signal_connect(
         arv_camera_get_device(arv_camera_), "control-lost", G_CALLBACK(device_lost), this);
 
-    allocator_ = std::make_shared<tcam::aravis::AravisAllocator>();
+    // keep the buffers close to the NIC, unless the user decided otherwise
+    auto alloc_config = tcam::get_slab_allocator_config();
+    if (alloc_config.numa_node < 0)
+    {
+        alloc_config.numa_node = tcam::aravis::get_numa_node(arv_camera_);
+    }
+    allocator_ = std::make_shared<tcam::SlabAllocator>(alloc_config);
 }
 
 
 AravisDevice::~AravisDevice()
 {
+    stop_trigger_thread();
+
+    if (arv_camera_ != NULL && !is_lost_)
+    {
+        disable_device_events();
+    }
+
+    // the stream and its buffers outlive stop_stream
+    release_buffers();
+    release_chunk_parser();
+
     if (arv_camera_ != NULL)
     {
         g_object_unref(arv_camera_);
@@ -418,6 +481,131 @@ outcome::result<tcam::framerate_info> tcam::AravisDevice::get_framerate_info(con
         return fetch_FPS_enum_framerates(dev);
     }
 
+    if (tcam::get_environment_variable_int("TCAM_FRAMERATE_MODEL").value_or(1) != 0)
+    {
+        if (auto model = get_framerate_model(fmt))
+        {
+            return tcam::framerate_info { model->min_fps, model->max_for(fmt.get_size()) };
+        }
+    }
+
+    return probe_framerate_bounds(fmt);
+}
+
+
+double tcam::AravisDevice::framerate_model::max_for(const tcam_image_size& size) const
+{
+    const double frame_time = base + line * size.height + pixel * size.width * size.height;
+    if (frame_time <= 0.)
+    {
+        return max_fps;
+    }
+    return std::clamp(1. / frame_time, min_fps, max_fps);
+}
+
+
+auto tcam::AravisDevice::get_framerate_model(const VideoFormat& fmt)
+    -> std::optional<framerate_model>
+{
+    const auto scaling = fmt.get_scaling();
+    const framerate_model_key key { fmt.get_fourcc(),
+                                    scaling.binning_h,
+                                    scaling.binning_v,
+                                    scaling.skipping_h,
+                                    scaling.skipping_v };
+
+    if (auto iter = framerate_models_.find(key); iter != framerate_models_.end())
+    {
+        return iter->second;
+    }
+
+    // the range the format is offered with, the model is only valid within it
+    std::optional<tcam_resolution_description> range;
+    for (const auto& desc : available_videoformats_)
+    {
+        if (desc.get_fourcc() != fmt.get_fourcc())
+        {
+            continue;
+        }
+        for (const auto& r : desc.get_resolutions())
+        {
+            if (r.type == TCAM_RESOLUTION_TYPE_RANGE && r.scaling == scaling)
+            {
+                range = r;
+            }
+        }
+    }
+
+    const auto size = fmt.get_size();
+    if (!range || size.width < range->min_size.width || size.width > range->max_size.width
+        || size.height < range->min_size.height || size.height > range->max_size.height)
+    {
+        return std::nullopt;
+    }
+
+    // stream_ is checked by probe_framerate_bounds
+    const auto min = range->min_size;
+    const auto max = range->max_size;
+
+    auto probe = [this, &fmt](unsigned int width, unsigned int height)
+        -> std::optional<tcam::framerate_info>
+    {
+        auto res = probe_framerate_bounds(VideoFormat { fmt.get_fourcc(),
+                                                        { width, height },
+                                                        fmt.get_scaling(),
+                                                        0 });
+        if (res.has_error() || res.value().max() <= 0.)
+        {
+            return std::nullopt;
+        }
+        return res.value();
+    };
+
+    auto short_frame = probe(max.width, min.height);
+    auto full_frame = probe(max.width, max.height);
+    auto narrow_frame = probe(min.width, max.height);
+    if (!short_frame || !full_frame || !narrow_frame)
+    {
+        return std::nullopt;
+    }
+
+    const double t_short = 1. / short_frame->max();
+    const double t_full = 1. / full_frame->max();
+    const double t_narrow = 1. / narrow_frame->max();
+
+    framerate_model model;
+
+    if (max.width > min.width)
+    {
+        model.pixel =
+            std::max(0., (t_full - t_narrow) / (double(max.height) * (max.width - min.width)));
+    }
+    if (max.height > min.height)
+    {
+        model.line = std::max(
+            0., (t_full - t_short) / (max.height - min.height) - model.pixel * max.width);
+    }
+    model.base = t_full - model.line * max.height - model.pixel * max.width * max.height;
+
+    model.min_fps = std::min({ short_frame->min(), full_frame->min(), narrow_frame->min() });
+    model.max_fps = std::max({ short_frame->max(), full_frame->max(), narrow_frame->max() });
+
+    SPDLOG_DEBUG("Framerate model for {}: base {}s line {}s pixel {}s",
+                 fmt.get_fourcc_string(),
+                 model.base,
+                 model.line,
+                 model.pixel);
+
+    framerate_models_.emplace(key, model);
+    return model;
+}
+
+
+auto tcam::AravisDevice::probe_framerate_bounds(const VideoFormat& fmt)
+    -> outcome::result<tcam::framerate_info>
+{
+    std::scoped_lock lck0 { arv_camera_access_mutex_ };
+
     if (stream_)
     {
         // this means a stream is active do not touch settings
@@ -494,17 +682,32 @@ outcome::result<tcam::framerate_info> tcam::AravisDevice::get_framerate_info(con
 }
 
 
-void AravisDevice::disable_chunk_mode()
+void AravisDevice::configure_chunk_mode()
 {
     GError* err = nullptr;
-    arv_camera_set_chunk_mode(arv_camera_, false, &err);
+    arv_camera_set_chunk_mode(arv_camera_, chunk_data_enabled_, &err);
     if (err)
     {
-        SPDLOG_DEBUG("Failed to set 'ChunkModeActive' to false. Ignoring for now. Err: {}",
-                    err->message);
+        SPDLOG_DEBUG("Failed to set 'ChunkModeActive' to {}. Ignoring for now. Err: {}",
+                     chunk_data_enabled_,
+                     err->message);
         g_clear_error(&err);
     }
 
+    if (chunk_data_enabled_)
+    {
+        // not every camera offers all of these, the missing ones are simply not delivered
+        for (const char* chunk : { "ExposureTime", "Gain", "FrameID" })
+        {
+            arv_camera_set_chunk_state(arv_camera_, chunk, TRUE, &err);
+            if (err)
+            {
+                SPDLOG_DEBUG("Unable to enable chunk '{}'. Err: {}", chunk, err->message);
+                g_clear_error(&err);
+            }
+        }
+    }
+
     auto prop_GevGVSPExtendedIDMode =
         find_cam_property<tcam::property::IPropertyEnum>("GevGVSPExtendedIDMode");
     if (prop_GevGVSPExtendedIDMode)
@@ -529,7 +732,9 @@ bool AravisDevice::set_video_format(const VideoFormat& new_format)
 
 //    SPDLOG_DEBUG("Setting format to '{}'", new_format.to_string());
 
-    disable_chunk_mode();
+    backend_->invalidate_register_cache();
+
+    configure_chunk_mode();
 
     bool ret = false;
     GError* err = nullptr;
@@ -561,7 +766,17 @@ bool AravisDevice::set_video_format(const VideoFormat& new_format)
         goto set_video_format_finish;
     }
 
-    if (has_offset_)
+    if ((!new_format.get_regions().empty() || !active_video_format_.get_regions().empty())
+        && !apply_regions(new_format.get_regions()))
+    {
+        goto set_video_format_finish;
+    }
+
+    if (!new_format.get_regions().empty())
+    {
+        // apply_regions has set the size of every region
+    }
+    else if (has_offset_)
     {
         // preserve current offset
         int offset_x;
@@ -609,9 +824,23 @@ bool AravisDevice::set_video_format(const VideoFormat& new_format)
         goto set_video_format_finish;
     }
 
+    if (!new_format.get_regions().empty()
+        && !verify_region_payload(new_format.get_size(), new_format.get_fourcc()))
+    {
+        apply_regions({});
+        active_video_format_ = read_camera_current_video_format();
+        goto set_video_format_finish;
+    }
+
     set_frame_rate(arv_camera_, new_format.get_framerate());
 
     active_video_format_ = read_camera_current_video_format();
+    if (!new_format.get_regions().empty())
+    {
+        // Width/Height only describe Region0
+        active_video_format_.set_size(new_format.get_size().width, new_format.get_size().height);
+        active_video_format_.set_regions(new_format.get_regions());
+    }
     //SPDLOG_DEBUG("Active format is now '{}'", active_video_format_.to_string());
     ret = true;
 
@@ -741,6 +970,8 @@ void AravisDevice::device_lost(ArvGvDevice* device __attribute__((unused)), void
 
     self->is_lost_ = true;
 
+    AravisBackend::get_instance()->report_device_lost(self->device.get_serial());
+
     self->notify_device_lost();
 }
 
@@ -783,11 +1014,22 @@ void AravisDevice::index_genicam()
         return true;
     }();
 
+    determine_region_count();
+
     generate_scaling_information();
 
     active_video_format_ = read_camera_current_video_format();
 
-    generate_video_formats();
+    const auto format_cache_key = tcam::aravis::get_format_cache_key(arv_camera_);
+    if (auto cached_formats = tcam::aravis::load_format_cache(format_cache_key); cached_formats)
+    {
+        available_videoformats_ = std::move(cached_formats.value());
+    }
+    else
+    {
+        generate_video_formats();
+        tcam::aravis::store_format_cache(format_cache_key, available_videoformats_);
+    }
 
     set_video_format(this->active_video_format_); // reset after generate_video_formats
 }
@@ -996,17 +1238,18 @@ void AravisDevice::generate_video_formats()
 
         SPDLOG_DEBUG("Adding format desc: {} ({:x}) ", desc.description, desc.fourcc);
 
-        if(scale_.scaling_info_list.empty())
+        if(scale_.table.empty())
         {
             res_vec.push_back(rf);
         }
         else
         {
-            for (const auto& scaling_info : scale_.scaling_info_list)
+            for (const auto& [scaling_info, scaling_max_size] : scale_.table.entries())
             {
                 if (rf.resolution.type == TCAM_RESOLUTION_TYPE_FIXED)
                 {
-                    if (scaling_info.legal_resolution(sensor_size, rf.resolution.max_size))
+                    if (rf.resolution.max_size.width <= scaling_max_size.width
+                        && rf.resolution.max_size.height <= scaling_max_size.height)
                     {
                         auto new_rf = rf;
 
@@ -1018,7 +1261,7 @@ void AravisDevice::generate_video_formats()
                 else
                 {
                     // TODO: use TestBinning etc to have values calculated via genicam
-                    auto binned_max_size = scaling_info.allowed_max(sensor_size);
+                    auto binned_max_size = scaling_max_size;
 
                     // ensure max is divisible by step
                     binned_max_size.width -= binned_max_size.width % width_step;
@@ -1087,3 +1330,61 @@ ArvGcNode* AravisDevice::get_genicam_property_node(const char* name) const
 {
     return arv_gc_get_node(genicam_, name);
 }
+
+
+std::string AravisDevice::get_firmware_version() const
+{
+    return firmware_version_;
+}
+
+
+outcome::result<void> AravisDevice::execute_user_set_command(std::string_view user_set,
+                                                              const char* command)
+{
+    if (is_lost_)
+    {
+        return tcam::status::DeviceLost;
+    }
+
+    std::scoped_lock lck { arv_camera_access_mutex_ };
+
+    if (!has_genicam_property("UserSetSelector") || !has_genicam_property(command))
+    {
+        return tcam::status::PropertyNotImplemented;
+    }
+
+    auto dev = arv_camera_get_device(arv_camera_);
+
+    GError* err = nullptr;
+    arv_device_set_string_feature_value(dev, "UserSetSelector", std::string(user_set).c_str(), &err);
+    if (err)
+    {
+        SPDLOG_ERROR("Unable to select user set '{}': {}", user_set, err->message);
+        return tcam::aravis::consume_GError(err);
+    }
+
+    arv_device_execute_command(dev, command, &err);
+    if (err)
+    {
+        SPDLOG_ERROR("{} for user set '{}' failed: {}", command, user_set, err->message);
+        return tcam::aravis::consume_GError(err);
+    }
+    return outcome::success();
+}
+
+
+outcome::result<void> AravisDevice::save_user_set(std::string_view user_set)
+{
+    return execute_user_set_command(user_set, "UserSetSave");
+}
+
+
+outcome::result<void> AravisDevice::load_user_set(std::string_view user_set)
+{
+    OUTCOME_TRY(execute_user_set_command(user_set, "UserSetLoad"));
+
+    // every property may have a new value now
+    property_notifier_->notify({});
+
+    return outcome::success();
+}
@@ -18,13 +18,18 @@
 #define TCAM_ARAVISDEVICE_H
 
 #include "../DeviceInterface.h"
-#include "AravisAllocator.h"
 #include "../FormatHandlerInterface.h"
+#include "../scaling_table.h"
+#include "aravis_event_channel.h"
 
 #include <arv.h>
 #include <atomic>
+#include <condition_variable>
+#include <map>
 #include <mutex>
 #include <optional>
+#include <thread>
+#include <tuple>
 
 VISIBILITY_INTERNAL
 
@@ -32,7 +37,6 @@ VISIBILITY_INTERNAL
 namespace tcam::aravis
 {
 class AravisPropertyBackend;
-class AravisAllocator;
 }
 
 namespace tcam
@@ -87,6 +91,38 @@ public:
 
     outcome::result<tcam::framerate_info> get_framerate_info(const VideoFormat& fmt) final;
 
+    // Queues the trigger for trigger_thread_, so that the caller does not wait for the
+    // acknowledge of the control channel. Errors are only logged.
+    outcome::result<void> trigger_software() final;
+
+    // Rejects the move when the camera locks OffsetX/OffsetY during acquisition
+    // (TLParamsLocked), the GenICam description tells which features are streamable.
+    outcome::result<void> move_roi(uint32_t offset_x, uint32_t offset_y) final;
+
+    // DeviceFirmwareVersion, DeviceVersion for cameras that do not have it
+    std::string get_firmware_version() const final;
+
+    // Number of Region<n> entries of the SFNC RegionSelector, when the camera has RegionMode
+    uint32_t get_max_region_count() const final;
+
+    // UserSetSelector, UserSetSave and UserSetLoad are not published as properties
+    // as loading a user set changes the format behind the back of the stream.
+    outcome::result<void> save_user_set(std::string_view user_set) final;
+    outcome::result<void> load_user_set(std::string_view user_set) final;
+
+    // Needs ActionDeviceKey/ActionGroupKey/ActionGroupMask and the Action1 trigger source.
+    // start_stream then triggers AcquisitionStart with Action1, stop_stream turns it off again.
+    outcome::result<void> set_action_start(const std::optional<tcam_action_command>& cmd) final;
+
+    // SFNC Ptp* features, GevIEEE1588* for older cameras.
+    // Latches the data set with PtpDataSetLatch and the clock with TimestampLatch.
+    outcome::result<tcam_ptp_status> get_ptp_status() final;
+
+    // SFNC EventSelector/EventNotification, the events arrive on the GVCP message channel.
+    // Event ids are read from Event<name>, e.g. EventExposureEnd, or the EventSelector entry.
+    outcome::result<void> set_device_event_callback(const std::vector<std::string>& events,
+                                                    tcam_device_event_callback callback) final;
+
 private:
     tcam::VideoFormat read_camera_current_video_format();
 
@@ -108,7 +144,7 @@ private:
     ArvStream* stream_ = nullptr;
     ArvGc* genicam_ = nullptr;
 
-    std::shared_ptr<tcam::aravis::AravisAllocator> allocator_ = nullptr;
+    std::shared_ptr<tcam::AllocatorInterface> allocator_ = nullptr;
     std::weak_ptr<IImageBufferSink> sink_;
 
     std::vector<std::shared_ptr<tcam::property::IPropertyBase>> properties_;
@@ -128,16 +164,88 @@ private:
         // otherwise this is != nullptr
         ArvBuffer* arv_buffer = nullptr;
 
-#if !defined NDEBUG
+        // true while arv_buffer is owned by stream_
         bool is_queued = false;
-#endif
+        // the image contains the loss marks, see mark_lost_regions
+        bool is_marked = false;
     };
 
     static void clear_buffer_info_arb_buffer(buffer_info& info);
+    static ArvBuffer* create_arv_buffer(buffer_info& info);
+
+    // The ArvStream and the ArvBuffers survive stop_stream, so that a restart only has to start
+    // the acquisition. They are recreated when the pool memory or the transport options change.
+    bool can_reuse_arv_buffers(const std::vector<std::weak_ptr<ImageBuffer>>& new_list) const;
+    bool create_stream();
+    // The stream frees the ArvBuffers it owns
+    void destroy_stream();
+    void push_unqueued_buffers();
+    // Queues info.arv_buffer in stream_, needs buffer_list_mtx_
+    void push_arv_buffer(buffer_info& info);
+    // Queues a buffer the receive thread did not deliver
+    void repush_arv_buffer(ArvBuffer* buffer);
+
+    // Aravis only reports that packets of a frame are missing, not which ones.
+    // With salvage_threshold_ set, marks are written into the image before it is queued,
+    // those that are still present after a damaged frame locate the lost packets.
+    void mark_lost_regions(buffer_info& info);
+    std::optional<tcam_missing_line_map> find_missing_lines(ArvBuffer* buffer);
+    // distance of the marks, 0 when the stream cannot lose packets
+    size_t loss_mark_stride_ = 0;
+    // upper limit of the image data in one packet
+    size_t max_packet_payload_ = 0;
 
     std::vector<buffer_info> buffer_list_;
     std::mutex buffer_list_mtx_;
 
+    // stream_transport_options_ with the environment defaults applied, used by the receive thread
+    tcam_stream_transport_options receive_thread_options_;
+    // of usbfs_memory_mb, see tcam_stream_transport_options::usbfs_memory_mb
+    int usbfs_reserved_mb_ = 0;
+
+    bool is_streaming_ = false;
+
+    // see set_action_start
+    bool arm_action_start();
+    void disarm_action_start();
+
+    std::optional<tcam_action_command> action_start_;
+    bool action_armed_ = false;
+    // TriggerSelector before arming, restored by disarm_action_start
+    std::string trigger_selector_before_action_;
+
+    // see get_ptp_status, needs arv_camera_access_mutex_
+    outcome::result<tcam_ptp_status> read_ptp_status();
+    outcome::result<uint64_t> read_device_time_ns();
+    // read by the receive thread, see tcam_stream_statistics::ptp_time_ns
+    std::atomic<bool> ptp_synchronized_ = false;
+
+    // id of the stream in aravis::BandwidthManager, 0 when not registered
+    uint64_t bandwidth_stream_id_ = 0;
+
+    // Parses the chunk data of the received buffers, only used by the receive thread.
+    // Has its own genicam instance, so that no locking with the control channel is needed.
+    ArvChunkParser* chunk_parser_ = nullptr;
+    // cleared when the camera does not send the chunk, to not query it for every frame
+    bool chunk_has_exposure_time_ = false;
+    bool chunk_has_gain_ = false;
+    bool chunk_has_frame_id_ = false;
+
+    // see trigger_software
+    void trigger_thread_main();
+    void stop_trigger_thread();
+
+    ArvGcNode* trigger_software_node_ = nullptr;
+    std::thread trigger_thread_;
+    std::mutex trigger_mtx_;
+    std::condition_variable trigger_cv_;
+    unsigned int trigger_requests_ = 0;
+    bool trigger_thread_stop_ = false;
+
+    void create_chunk_parser();
+    void release_chunk_parser();
+    tcam_chunk_data parse_chunk_data(ArvBuffer* buffer);
+
     long frames_delivered_ = 0;
     long frames_dropped_ = 0;
     std::atomic<bool> is_lost_ = false;
@@ -147,6 +255,8 @@ private:
         std::vector<std::shared_ptr<tcam::property::IPropertyBase>> properties;
 
         std::vector<image_scaling> scaling_info_list;
+        // scaling_info_list with the maximum resolution of each entry
+        scaling_table table;
 
         ImageScalingType scale_type = ImageScalingType::Unknown;
     };
@@ -159,6 +269,16 @@ private:
     bool set_scaling(const image_scaling& scale);
     image_scaling get_current_scaling();
 
+    // multi-region readout, see AravisDeviceRegions.cpp
+    uint32_t max_region_count_ = 0;
+
+    void determine_region_count();
+    // Enables one GenICam region per entry and disables the others. An empty list leaves
+    // Region0 as the only region, which then holds the roi of the format.
+    bool apply_regions(const std::vector<tcam_image_region>& regions);
+    // Checks that the camera transmits the enabled regions stacked into one image of size
+    bool verify_region_payload(tcam_image_size size, uint32_t fourcc);
+
     VideoFormat active_video_format_;
 
     std::vector<VideoFormatDescription> available_videoformats_;
@@ -171,7 +291,9 @@ private:
 
     tcam_image_size get_sensor_size() const;
 
-    void complete_aravis_stream_buffer(ArvBuffer* buffer, bool is_incomplete);
+    void complete_aravis_stream_buffer(ArvBuffer* buffer,
+                                       bool is_incomplete,
+                                       const tcam_missing_line_map& missing_lines = {});
 
     bool has_offset_ = false;
 
@@ -183,10 +305,46 @@ private:
     bool has_FPS_enum_interface_ = false;
 
     auto fetch_test_itf_framerates(const VideoFormat& fmt) -> outcome::result<tcam::framerate_info>;
+    // sets the format on the camera and reads the AcquisitionFrameRate bounds
+    auto probe_framerate_bounds(const VideoFormat& fmt) -> outcome::result<tcam::framerate_info>;
+
+    // Frame time model for cameras without the test format interface.
+    // Every probe has to write the format to the camera, so a format range is probed at three
+    // corners and the frame time of all other sizes is derived from
+    //     1 / max_fps = base + line * height + pixel * width * height
+    // TCAM_FRAMERATE_MODEL=0 probes every size instead.
+    struct framerate_model
+    {
+        double base = 0.;
+        double line = 0.;
+        double pixel = 0.;
+        double min_fps = 0.;
+        // the model never reports more than was measured
+        double max_fps = 0.;
+
+        double max_for(const tcam_image_size& size) const;
+    };
+
+    auto get_framerate_model(const VideoFormat& fmt) -> std::optional<framerate_model>;
+
+    // fourcc, binning h/v, skipping h/v
+    using framerate_model_key = std::tuple<uint32_t, int, int, int, int>;
+    std::map<framerate_model_key, framerate_model> framerate_models_;
 
     bool has_genicam_property(const char* name) const;
     ArvGcNode* get_genicam_property_node(const char* name) const;
 
+    outcome::result<void> execute_user_set_command(std::string_view user_set, const char* command);
+
+    std::string firmware_version_;
+
+    // see set_device_event_callback, need arv_camera_access_mutex_
+    void disable_device_events();
+    outcome::result<uint16_t> get_event_id(const std::string& name);
+
+    aravis::EventChannel event_channel_;
+    std::vector<std::string> enabled_events_;
+
     template<class TItf> std::shared_ptr<TItf> find_cam_property(std::string_view name) const
     {
         auto ptr = tcam::property::find_property<TItf>(properties_, name);
@@ -195,7 +353,9 @@ private:
         return tcam::property::find_property<TItf>(internal_properties_, name);
     }
 
-    void disable_chunk_mode();
+    // Enables chunk mode with the ExposureTime, Gain and FrameID chunks when chunk_data_enabled_
+    // is set, otherwise disables it.
+    void configure_chunk_mode();
 
 }; /* class GigeCapture */
 
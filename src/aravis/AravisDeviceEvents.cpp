@@ -0,0 +1,242 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../logging.h"
+#include "AravisDevice.h"
+#include "aravis_utils.h"
+
+#include <arpa/inet.h> // inet_pton
+#include <chrono>
+#include <map>
+
+using namespace tcam;
+
+namespace
+{
+
+// GigE Vision bootstrap registers
+constexpr uint32_t reg_number_of_message_channels = 0x0900;
+constexpr uint32_t reg_message_channel_port = 0x0B00;
+constexpr uint32_t reg_message_channel_destination = 0x0B10;
+
+struct event_dispatch
+{
+    std::map<uint16_t, std::string> names;
+    double ns_per_tick = 1.0;
+    tcam_device_event_callback callback;
+
+    void operator()(const aravis::gvcp_event& ev) const
+    {
+        auto name = names.find(ev.event_id);
+        if (name == names.end())
+        {
+            // events enabled by other applications before this one opened the device
+            return;
+        }
+
+        tcam_device_event event;
+        event.name = name->second;
+        event.event_id = ev.event_id;
+        event.stream_channel = ev.stream_channel;
+        event.block_id = ev.block_id;
+        event.timestamp_ns = static_cast<uint64_t>(ev.timestamp * ns_per_tick);
+        event.arrival_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now().time_since_epoch())
+                                    .count();
+        callback(event);
+    }
+};
+
+} // namespace
+
+
+outcome::result<uint16_t> AravisDevice::get_event_id(const std::string& name)
+{
+    auto dev = arv_camera_get_device(arv_camera_);
+    GError* err = nullptr;
+
+    // SFNC, e.g. EventExposureEnd holds the id of the ExposureEnd event
+    const std::string id_feature = "Event" + name;
+    if (has_genicam_property(id_feature.c_str()))
+    {
+        auto id = arv_device_get_integer_feature_value(dev, id_feature.c_str(), &err);
+        if (err)
+        {
+            return tcam::aravis::consume_GError(err);
+        }
+        return static_cast<uint16_t>(id);
+    }
+
+    // older descriptions use the event id as value of the selector entry
+    auto selector = get_genicam_property_node("EventSelector");
+    if (!selector || !ARV_IS_GC_ENUMERATION(selector))
+    {
+        return tcam::status::PropertyNotImplemented;
+    }
+    for (auto entry = arv_gc_enumeration_get_entries(ARV_GC_ENUMERATION(selector));
+         entry != nullptr;
+         entry = entry->next)
+    {
+        auto node = ARV_GC_ENUM_ENTRY(entry->data);
+        if (g_strcmp0(name.c_str(), arv_gc_feature_node_get_name(ARV_GC_FEATURE_NODE(node))) != 0)
+        {
+            continue;
+        }
+        auto id = arv_gc_enum_entry_get_value(node, &err);
+        if (err)
+        {
+            return tcam::aravis::consume_GError(err);
+        }
+        return static_cast<uint16_t>(id);
+    }
+
+    SPDLOG_ERROR("The device does not know the event '{}'.", name);
+    return tcam::status::InvalidParameter;
+}
+
+
+outcome::result<void> AravisDevice::set_device_event_callback(
+    const std::vector<std::string>& events,
+    tcam_device_event_callback callback)
+{
+    if (is_lost_)
+    {
+        return tcam::status::DeviceLost;
+    }
+
+    std::scoped_lock lck { arv_camera_access_mutex_ };
+
+    disable_device_events();
+
+    if (events.empty() || !callback)
+    {
+        return outcome::success();
+    }
+
+    auto dev = arv_camera_get_device(arv_camera_);
+    if (!ARV_IS_GV_DEVICE(dev) || !has_genicam_property("EventSelector")
+        || !has_genicam_property("EventNotification"))
+    {
+        return tcam::status::PropertyNotImplemented;
+    }
+
+    GError* err = nullptr;
+    guint32 channel_count = 0;
+    arv_device_read_register(dev, reg_number_of_message_channels, &channel_count, &err);
+    if (err)
+    {
+        return tcam::aravis::consume_GError(err);
+    }
+    if (channel_count == 0)
+    {
+        SPDLOG_ERROR("The device has no message channel.");
+        return tcam::status::PropertyNotImplemented;
+    }
+
+    event_dispatch dispatch;
+    dispatch.callback = std::move(callback);
+    for (const auto& name : events)
+    {
+        OUTCOME_TRY(auto id, get_event_id(name));
+        dispatch.names[id] = name;
+    }
+    if (has_genicam_property("GevTimestampTickFrequency"))
+    {
+        auto frequency =
+            arv_device_get_integer_feature_value(dev, "GevTimestampTickFrequency", &err);
+        if (!err && frequency > 0)
+        {
+            dispatch.ns_per_tick = 1'000'000'000.0 / frequency;
+        }
+        g_clear_error(&err);
+    }
+
+    const auto address = tcam::aravis::get_interface_address(arv_camera_);
+    in_addr host = {};
+    if (address.empty() || inet_pton(AF_INET, address.c_str(), &host) != 1)
+    {
+        SPDLOG_ERROR("Unable to determine the interface of the device for its message channel.");
+        return tcam::status::UndefinedError;
+    }
+
+    const uint16_t port = event_channel_.start(address, std::move(dispatch));
+    if (port == 0)
+    {
+        return tcam::status::UndefinedError;
+    }
+
+    arv_device_write_register(dev, reg_message_channel_destination, ntohl(host.s_addr), &err);
+    if (!err)
+    {
+        arv_device_write_register(dev, reg_message_channel_port, port, &err);
+    }
+    if (err)
+    {
+        SPDLOG_ERROR("Unable to open the message channel: {}", err->message);
+        event_channel_.stop();
+        return tcam::aravis::consume_GError(err);
+    }
+
+    for (const auto& name : events)
+    {
+        arv_device_set_string_feature_value(dev, "EventSelector", name.c_str(), &err);
+        if (!err)
+        {
+            arv_device_set_string_feature_value(dev, "EventNotification", "On", &err);
+        }
+        if (err)
+        {
+            SPDLOG_ERROR("Unable to enable the event '{}': {}", name, err->message);
+            auto res = tcam::aravis::consume_GError(err);
+            disable_device_events();
+            return res;
+        }
+        enabled_events_.push_back(name);
+    }
+
+    SPDLOG_DEBUG("Receiving {} device events on {}:{}", events.size(), address, port);
+    return outcome::success();
+}
+
+
+void AravisDevice::disable_device_events()
+{
+    auto dev = arv_camera_get_device(arv_camera_);
+    GError* err = nullptr;
+
+    for (const auto& name : enabled_events_)
+    {
+        arv_device_set_string_feature_value(dev, "EventSelector", name.c_str(), &err);
+        if (!err)
+        {
+            arv_device_set_string_feature_value(dev, "EventNotification", "Off", &err);
+        }
+        if (err)
+        {
+            SPDLOG_WARN("Unable to disable the event '{}': {}", name, err->message);
+            g_clear_error(&err);
+        }
+    }
+    enabled_events_.clear();
+
+    if (event_channel_.is_running())
+    {
+        // port 0 closes the message channel
+        arv_device_write_register(dev, reg_message_channel_port, 0, &err);
+        g_clear_error(&err);
+        event_channel_.stop();
+    }
+}
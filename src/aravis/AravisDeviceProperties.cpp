@@ -22,6 +22,7 @@
 #include "aravis_property_impl.h"
 #include "aravis_utils.h"
 
+#include <unordered_set>
 
 using namespace tcam::property;
 
@@ -143,6 +144,9 @@ static const aravis_property_name_map aravis_property_name_mapping_list[] =
     { "BalanceRatioRaw", map_type::priv },
     { "FocusAuto", map_type::priv },
     { "IrisAuto", map_type::priv },
+    { "PtpStatus", map_type::priv },
+    { "PtpOffsetFromMaster", map_type::priv },
+    { "PtpDataSetLatch", map_type::priv },
 
     // private/blacklisted because of potential problems with e.g. Width
     { "UserSetSelector", map_type::blacklist },
@@ -295,11 +299,13 @@ void tcam::AravisDevice::create_property_list_from_genicam_categories()
     std::vector<node_cat_entry> lst;
     create_ordered_property_list(lst, genicam_, nullptr, "Root");
 
-    auto find_node = [&](std::string_view name) -> bool
-    {
-        return std::any_of(
-            lst.begin(), lst.end(), [name](const node_cat_entry& e) { return e.name == name; });
-    };
+    // the name index is built up front, nodes are only touched when a property is accessed
+    std::unordered_set<std::string_view> node_names;
+    node_names.reserve(lst.size());
+    for (const auto& e : lst) { node_names.insert(e.name); }
+
+    auto find_node = [&node_names](std::string_view name) -> bool
+    { return node_names.count(name) != 0; };
 
     for (auto&& entry : lst)
     {
@@ -454,4 +460,39 @@ void tcam::AravisDevice::generate_properties_from_genicam()
             "Iris",
             std::make_shared<tcam::aravis::iris_auto_enum_override>(iris_auto, backend_));
     }
+
+    auto ptp_latch = find_cam_property<tcam::property::IPropertyCommand>("PtpDataSetLatch");
+    if (ptp_latch)
+    {
+        // inserted in reverse, both end up behind PtpEnable
+        auto ptp_offset =
+            find_cam_property<tcam::property::IPropertyInteger>("PtpOffsetFromMaster");
+        if (ptp_offset)
+        {
+            add_property_after(
+                properties_,
+                "PtpEnable",
+                std::make_shared<tcam::aravis::ptp_latched_integer>(ptp_offset, ptp_latch));
+        }
+        auto ptp_status = find_cam_property<tcam::property::IPropertyEnum>("PtpStatus");
+        if (ptp_status)
+        {
+            add_property_after(
+                properties_,
+                "PtpEnable",
+                std::make_shared<tcam::aravis::ptp_latched_enum>(ptp_status, ptp_latch));
+        }
+    }
+    else
+    {
+        // nothing to latch, the values are read as they are
+        for (auto name : { "PtpOffsetFromMaster", "PtpStatus" })
+        {
+            auto prop = tcam::property::find_property(internal_properties_, name);
+            if (prop)
+            {
+                add_property_after(properties_, "PtpEnable", prop);
+            }
+        }
+    }
 }
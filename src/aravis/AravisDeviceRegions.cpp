@@ -0,0 +1,162 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../logging.h"
+#include "AravisDevice.h"
+#include "aravis_utils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <string_view>
+
+using namespace tcam;
+
+// Multi-region readout with the SFNC RegionSelector/RegionMode features.
+// Width, Height, OffsetX and OffsetY are selected by RegionSelector. Cameras that are supported
+// transmit the enabled regions stacked into one image, which verify_region_payload checks.
+
+void AravisDevice::determine_region_count()
+{
+    max_region_count_ = 0;
+    if (!has_genicam_property("RegionSelector") || !has_genicam_property("RegionMode"))
+    {
+        return;
+    }
+
+    GError* err = nullptr;
+    guint n_entries = 0;
+    const char** entries = arv_camera_dup_available_enumerations_as_strings(
+        arv_camera_, "RegionSelector", &n_entries, &err);
+    if (err)
+    {
+        SPDLOG_WARN("Unable to list the RegionSelector entries: {}", err->message);
+        g_clear_error(&err);
+        return;
+    }
+
+    // 'All' and other entries that do not select a single region are not counted
+    for (guint i = 0; i < n_entries; ++i)
+    {
+        const std::string_view entry = entries[i];
+        if (entry.size() > 6 && entry.substr(0, 6) == "Region"
+            && std::isdigit(static_cast<unsigned char>(entry[6])))
+        {
+            ++max_region_count_;
+        }
+    }
+    g_free(entries);
+
+    if (max_region_count_ < 2)
+    {
+        max_region_count_ = 0;
+        return;
+    }
+    SPDLOG_DEBUG("Camera reads out up to {} regions", max_region_count_);
+
+    // regions left enabled by an earlier application would change the layout of every image
+    apply_regions({});
+}
+
+
+uint32_t AravisDevice::get_max_region_count() const
+{
+    return max_region_count_;
+}
+
+
+bool AravisDevice::apply_regions(const std::vector<tcam_image_region>& regions)
+{
+    if (max_region_count_ == 0)
+    {
+        return regions.empty();
+    }
+
+    auto dev = arv_camera_get_device(arv_camera_);
+    GError* err = nullptr;
+
+    auto set_int = [dev, &err](const char* name, int64_t value)
+    {
+        if (!err)
+        {
+            arv_device_set_integer_feature_value(dev, name, value, &err);
+        }
+    };
+
+    const size_t enabled_count = std::max<size_t>(regions.size(), 1);
+    for (uint32_t i = 0; i < max_region_count_; ++i)
+    {
+        const auto selector = "Region" + std::to_string(i);
+        arv_device_set_string_feature_value(dev, "RegionSelector", selector.c_str(), &err);
+        if (!err)
+        {
+            arv_device_set_string_feature_value(
+                dev, "RegionMode", i < enabled_count ? "On" : "Off", &err);
+        }
+        if (i < regions.size())
+        {
+            const auto& region = regions[i];
+            // the offsets are cleared first, so that the new size is within its bounds
+            set_int("OffsetX", 0);
+            set_int("OffsetY", 0);
+            set_int("Width", region.width);
+            set_int("Height", region.height);
+            set_int("OffsetX", region.offset_x);
+            set_int("OffsetY", region.offset_y);
+        }
+        if (err)
+        {
+            SPDLOG_ERROR("Unable to configure {}: {}", selector, err->message);
+            g_clear_error(&err);
+            return false;
+        }
+    }
+
+    // Width/Height of the format and the offset properties refer to Region0 again
+    arv_device_set_string_feature_value(dev, "RegionSelector", "Region0", &err);
+    if (err)
+    {
+        SPDLOG_ERROR("Unable to select Region0: {}", err->message);
+        g_clear_error(&err);
+        return false;
+    }
+    return true;
+}
+
+
+bool AravisDevice::verify_region_payload(tcam_image_size size, uint32_t fourcc)
+{
+    GError* err = nullptr;
+    const uint64_t payload = arv_camera_get_payload(arv_camera_, &err);
+    if (err)
+    {
+        SPDLOG_ERROR("Unable to read the payload size: {}", err->message);
+        g_clear_error(&err);
+        return false;
+    }
+
+    // chunk data is appended behind the image
+    const uint64_t expected = VideoFormat(fourcc, size).get_required_buffer_size();
+    if (payload != expected && !(chunk_data_enabled_ && payload > expected))
+    {
+        SPDLOG_ERROR("The camera transmits {} bytes for the regions instead of {} bytes of "
+                     "stacked regions, the layout is not supported.",
+                     payload,
+                     expected);
+        return false;
+    }
+    return true;
+}
@@ -17,6 +17,8 @@
 #include "../logging.h"
 #include "AravisDevice.h"
 
+#include <set>
+
 using namespace tcam;
 
 void AravisDevice::determine_scaling_type()
@@ -234,18 +236,8 @@ void AravisDevice::generate_scaling_information()
         auto bh = dynamic_cast<tcam::property::IPropertyInteger*>(binning_h.get());
         auto bv = dynamic_cast<tcam::property::IPropertyInteger*>(binning_v.get());
 
-        auto scale_is_known = [=](const tcam::image_scaling& s)
-        {
-            auto find = std::find_if(scale_.scaling_info_list.begin(),
-                                     scale_.scaling_info_list.end(),
-                                     [s](const tcam::image_scaling& vs) { return (s == vs); });
-
-            if (find == scale_.scaling_info_list.end())
-            {
-                return false;
-            }
-            return true;
-        };
+        std::set<tcam::image_scaling, decltype(&tcam::scaling_less)> known_scales(
+            &tcam::scaling_less);
 
         auto is_valid = [] (int value) -> bool
         {
@@ -291,7 +283,7 @@ void AravisDevice::generate_scaling_information()
 
                         // no need for duplicates
                         // setting skipping 1x2 or 2x1 might both result in 2x2
-                        if (scale_is_known(is))
+                        if (!known_scales.insert(is).second)
                         {
                             continue;
                         }
@@ -302,6 +294,8 @@ void AravisDevice::generate_scaling_information()
             }
         }
     }
+
+    scale_.table = tcam::scaling_table(get_sensor_size(), scale_.scaling_info_list);
 }
 
 
@@ -16,14 +16,76 @@
 
 #include "../ImageBuffer.h"
 #include "../logging.h"
+#include "../tracepoints.h"
 #include "../utils.h"
 #include "AravisDevice.h"
+#include "AravisPropertyBackend.h"
+#include "aravis_bandwidth_manager.h"
+#include "aravis_utils.h"
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <memory>
+#include <pthread.h>
+#include <sched.h>
 #include <vector>
 
 using namespace tcam;
 
+namespace
+{
+
+// see AravisDevice::mark_lost_regions, "tcamlost" in memory
+constexpr uint64_t loss_mark = 0x74736f6c6d616374;
+constexpr size_t loss_mark_size = sizeof(loss_mark);
+
+// IP (20) + UDP (8) + GVSP (8) headers, extended ids add 12 bytes to the GVSP header
+constexpr size_t gvsp_min_packet_overhead = 36;
+constexpr size_t gvsp_max_packet_overhead = 48;
+
+// Every data packet but the last carries at least stride + loss_mark_size bytes,
+// so a lost packet always covers a mark completely.
+// The last packet may be shorter, the tail of the image has its own mark.
+size_t calc_loss_mark_stride(size_t packet_size)
+{
+    if (packet_size <= gvsp_max_packet_overhead + 2 * loss_mark_size)
+    {
+        return 0;
+    }
+    return (packet_size - gvsp_max_packet_overhead - loss_mark_size) & ~(loss_mark_size - 1);
+}
+
+template<typename TFunc> void for_each_loss_mark(size_t size, size_t stride, TFunc func)
+{
+    for (size_t offset = 0; offset + loss_mark_size <= size; offset += stride) { func(offset); }
+    func(size - loss_mark_size);
+}
+
+void add_missing_lines(tcam_missing_line_map& map, uint32_t first, uint32_t last)
+{
+    if (map.range_count > 0)
+    {
+        auto& prev = map.ranges[map.range_count - 1];
+        const uint32_t prev_end = prev.first_line + prev.line_count;
+        if (first <= prev_end || map.range_count == tcam_missing_line_map::max_ranges)
+        {
+            prev.line_count = std::max(prev_end, last + 1) - prev.first_line;
+            return;
+        }
+    }
+    map.ranges[map.range_count++] = { first, last - first + 1 };
+}
+
+uint32_t count_missing_lines(const tcam_missing_line_map& map)
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < map.range_count; ++i) { count += map.ranges[i].line_count; }
+    return count;
+}
+
+} // namespace
+
 void tcam::AravisDevice::clear_buffer_info_arb_buffer(buffer_info& info)
 {
     std::scoped_lock lck { info.parent->buffer_list_mtx_ };
@@ -31,6 +93,40 @@ void tcam::AravisDevice::clear_buffer_info_arb_buffer(buffer_info& info)
     info.arv_buffer = nullptr;
 }
 
+ArvBuffer* AravisDevice::create_arv_buffer(buffer_info& info)
+{
+    auto buffer_destroy_notfiy = [](void* buffer_info_ptr) {
+        auto& info = *static_cast<buffer_info*>(buffer_info_ptr);
+        clear_buffer_info_arb_buffer(info);
+    };
+
+    return arv_buffer_new_full(info.buffer->get_image_buffer_size(),
+                               info.buffer->get_image_buffer_ptr(),
+                               &info,
+                               buffer_destroy_notfiy);
+}
+
+bool AravisDevice::can_reuse_arv_buffers(const std::vector<std::weak_ptr<ImageBuffer>>& new_list) const
+{
+    if (stream_ == nullptr || new_list.size() != buffer_list_.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < new_list.size(); ++i)
+    {
+        auto buffer = new_list[i].lock();
+        const auto& info = buffer_list_[i];
+        if (!buffer || !info.buffer || info.arv_buffer == nullptr
+            || buffer->get_image_buffer_ptr() != info.buffer->get_image_buffer_ptr()
+            || buffer->get_image_buffer_size() != info.buffer->get_image_buffer_size())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool AravisDevice::initialize_buffers(std::shared_ptr<BufferPool> pool)
 {
     auto new_list = pool->get_buffer();
@@ -39,9 +135,6 @@ bool AravisDevice::initialize_buffers(std::shared_ptr<BufferPool> pool)
 
     GError* err = nullptr;
 
-    this->buffer_list_.clear();
-    this->buffer_list_.reserve(new_list.size());
-
     size_t payload = arv_camera_get_payload(this->arv_camera_, &err);
     if (err)
     {
@@ -50,25 +143,39 @@ bool AravisDevice::initialize_buffers(std::shared_ptr<BufferPool> pool)
         return false;
     }
 
-    auto buffer_destroy_notfiy = [](void* buffer_info_ptr) {
-        auto& info = *static_cast<buffer_info*>(buffer_info_ptr);
-        clear_buffer_info_arb_buffer(info);
-    };
-
     size_t buffer_size = new_list.front().lock()->get_image_buffer_size();
     if( buffer_size < payload)
     {
         SPDLOG_WARN("Aravis payload-size ({}) > image_buffer_size ({})", payload, buffer_size);
     }
 
+    // the pool reused its memory, so the ArvBuffers still point to the right place
+    // only the ImageBuffer objects are new
+    if (!is_streaming_ && can_reuse_arv_buffers(new_list))
+    {
+        {
+            std::scoped_lock lck2 { buffer_list_mtx_ };
+            for (size_t i = 0; i < new_list.size(); ++i)
+            {
+                buffer_list_[i].buffer = new_list[i].lock();
+            }
+        }
+        // ImageBuffers of the old pool are not requeued anymore, take their ArvBuffers back
+        push_unqueued_buffers();
+
+        SPDLOG_DEBUG("Reusing ArvStream and {} ArvBuffers", buffer_list_.size());
+        return true;
+    }
+
+    release_buffers();
+
+    this->buffer_list_.reserve(new_list.size());
+
     // we build the according items in a 2 step process, so we are able to pass &info to arv_buffer_new_full
+    // new_list is in pool slot order, so buffer_list_[ImageBuffer::get_pool_slot()] is the matching entry
     for (auto&& buffer : new_list) { this->buffer_list_.push_back(buffer_info { this, buffer.lock() }); }
 
-    for (auto& info : buffer_list_)
-    {
-        info.arv_buffer = arv_buffer_new_full(
-            buffer_size, info.buffer->get_image_buffer_ptr(), &info, buffer_destroy_notfiy);
-    }
+    for (auto& info : buffer_list_) { info.arv_buffer = create_arv_buffer(info); }
     return true;
 }
 
@@ -76,6 +183,9 @@ bool AravisDevice::release_buffers()
 {
     std::scoped_lock lck { arv_camera_access_mutex_ };
 
+    // frees all arv_buffer objects the stream still owns
+    destroy_stream();
+
     // this should not be taken here, because the g_object_unref triggers the
     // destroy notify of the arv_buffer which in turn takes the mutex
     //std::scoped_lock lck { buffer_list_mtx_ };
@@ -93,19 +203,139 @@ bool AravisDevice::release_buffers()
     return true;
 }
 
-void AravisDevice::requeue_buffer(const std::shared_ptr<ImageBuffer>& buffer)
+void AravisDevice::push_unqueued_buffers()
 {
-    std::scoped_lock lck0 { arv_camera_access_mutex_ };
+    std::scoped_lock lck { buffer_list_mtx_ };
+
+    if (stream_ == nullptr)
+    {
+        return;
+    }
+
+    for (auto& info : buffer_list_)
+    {
+        if (info.is_queued || !info.buffer)
+        {
+            continue;
+        }
+        if (info.arv_buffer == nullptr)
+        {
+            info.arv_buffer = create_arv_buffer(info);
+        }
+        push_arv_buffer(info);
+    }
+}
+
+void AravisDevice::push_arv_buffer(buffer_info& info)
+{
+    mark_lost_regions(info);
+    info.is_queued = true;
+    arv_stream_push_buffer(stream_, info.arv_buffer);
+}
 
+void AravisDevice::repush_arv_buffer(ArvBuffer* buffer)
+{
     std::scoped_lock lck { buffer_list_mtx_ };
-    for (auto& b : buffer_list_)
+
+    if (stream_ == nullptr)
+    {
+        return;
+    }
+
+    auto& info = *const_cast<buffer_info*>(
+        static_cast<const buffer_info*>(arv_buffer_get_user_data(buffer)));
+    if (info.arv_buffer != buffer || !info.buffer)
+    {
+        arv_stream_push_buffer(stream_, buffer);
+        return;
+    }
+    push_arv_buffer(info);
+}
+
+void AravisDevice::mark_lost_regions(buffer_info& info)
+{
+    info.is_marked = false;
+
+    // without salvage only the frames delivered with drop_incomplete_frames_=false need them
+    if (loss_mark_stride_ == 0 || (drop_incomplete_frames_ && salvage_threshold_ <= 0.0))
+    {
+        return;
+    }
+
+    const size_t size = std::min(static_cast<size_t>(active_video_format_.get_pitch_size())
+                                     * active_video_format_.get_size().height,
+                                 info.buffer->get_image_buffer_size());
+    if (size < loss_mark_size)
+    {
+        return;
+    }
+
+    auto data = static_cast<uint8_t*>(info.buffer->get_image_buffer_ptr());
+    for_each_loss_mark(size,
+                       loss_mark_stride_,
+                       [data](size_t offset)
+                       { std::memcpy(data + offset, &loss_mark, loss_mark_size); });
+    info.is_marked = true;
+}
+
+std::optional<tcam_missing_line_map> AravisDevice::find_missing_lines(ArvBuffer* buffer)
+{
+    std::shared_ptr<ImageBuffer> image;
     {
-        if (b.buffer == buffer && b.arv_buffer != nullptr)
+        std::scoped_lock lck { buffer_list_mtx_ };
+
+        const auto& info = *static_cast<const buffer_info*>(arv_buffer_get_user_data(buffer));
+        if (!info.is_marked)
         {
-#if !defined NDEBUG
-            b.is_queued = true;
-#endif
-            arv_stream_push_buffer(this->stream_, b.arv_buffer);
+            return std::nullopt;
+        }
+        image = info.buffer;
+    }
+
+    const size_t pitch = active_video_format_.get_pitch_size();
+    const uint32_t height = active_video_format_.get_size().height;
+    const size_t size = std::min(pitch * height, image->get_image_buffer_size());
+    if (pitch == 0 || height == 0 || size < loss_mark_size)
+    {
+        return std::nullopt;
+    }
+
+    const auto data = static_cast<const uint8_t*>(image->get_image_buffer_ptr());
+
+    tcam_missing_line_map map;
+    for_each_loss_mark(size,
+                       loss_mark_stride_,
+                       [&](size_t offset)
+                       {
+                           if (std::memcmp(data + offset, &loss_mark, loss_mark_size) != 0)
+                           {
+                               return;
+                           }
+                           // the lost packet starts and ends within max_packet_payload_
+                           const size_t end = std::min(size, offset + max_packet_payload_);
+                           const size_t begin = offset + loss_mark_size > max_packet_payload_
+                                                    ? offset + loss_mark_size - max_packet_payload_
+                                                    : 0;
+                           add_missing_lines(map,
+                                             static_cast<uint32_t>(begin / pitch),
+                                             static_cast<uint32_t>((end - 1) / pitch));
+                       });
+    return map;
+}
+
+void AravisDevice::requeue_buffer(const std::shared_ptr<ImageBuffer>& buffer)
+{
+    // arv_camera_access_mutex_ is not required here,
+    // stream_ is only reset while holding buffer_list_mtx_
+    std::scoped_lock lck { buffer_list_mtx_ };
+
+    const size_t slot = buffer->get_pool_slot();
+    if (stream_ && slot < buffer_list_.size())
+    {
+        auto& b = buffer_list_[slot];
+        if (b.buffer == buffer && b.arv_buffer != nullptr && !b.is_queued)
+        {
+            push_arv_buffer(b);
             return;
         }
     }
@@ -278,172 +508,763 @@ static bool set_stream_options(ArvStream* stream)
 }
 
 
-bool AravisDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
+// Settings that are not set by the application are taken from the environment
+static tcam_stream_transport_options apply_environment_defaults(tcam_stream_transport_options opt)
 {
-    std::scoped_lock lck0 { arv_camera_access_mutex_ };
-
-    if (arv_camera_ == nullptr)
+    if (opt.packet_socket < 0)
     {
-        SPDLOG_ERROR("ArvCamera missing!");
-        return false;
+        opt.packet_socket = tcam::get_environment_variable_int("TCAM_ARV_PACKET_SOCKET").value_or(-1);
     }
-
-    assert(stream_ == nullptr);
-    if (stream_)
+    if (opt.receive_thread_cpu_affinity.empty())
     {
-        SPDLOG_ERROR("Stop was not called previously");
-        return false;
+        opt.receive_thread_cpu_affinity =
+            tcam::get_environment_variable("TCAM_ARV_STREAM_THREAD_AFFINITY", "");
     }
-
-    if (buffer_list_.size() < 2)
+    if (opt.receive_thread_priority < 0)
     {
-        SPDLOG_ERROR("Need at least two buffers.");
-        return false;
+        opt.receive_thread_priority =
+            tcam::get_environment_variable_int("TCAM_ARV_STREAM_THREAD_PRIORITY").value_or(-1);
+    }
+    if (opt.usb_async_transfers < 0)
+    {
+        opt.usb_async_transfers =
+            tcam::get_environment_variable_int("TCAM_ARV_USB_ASYNC").value_or(-1);
+    }
+    if (opt.usbfs_memory_mb < 0)
+    {
+        opt.usbfs_memory_mb =
+            tcam::get_environment_variable_int("TCAM_ARV_USBFS_MEMORY_MB").value_or(-1);
     }
+    return opt;
+}
 
 
-    // install callback to initialize the capture thread as real time
-    auto stream_cb = [](void* /*user_data*/, ArvStreamCallbackType type, ArvBuffer* /*buffer*/)
-    {
-        if (type == ARV_STREAM_CALLBACK_TYPE_INIT)
-        {
-            if (!arv_make_thread_realtime(10))
-            {
-                if (!arv_make_thread_high_priority(-10))
-                {
-                    SPDLOG_INFO("Unable to make aravis capture thread real time or high priority");
-                }
-                else
-                {
-                    SPDLOG_INFO("Aravis capture thread is running in high priority mode");
-                }
-            }
-            else
-            {
-                SPDLOG_INFO("Aravis capture thread is running as a real time thread");
-            }
-        }
-    };
+#if defined(HAVE_ARAVIS_USB)
 
-    disable_chunk_mode();
+// ARV_UV_STREAM_MAXIMUM_TRANSFER_SIZE, larger payloads are split into several transfers
+static constexpr uint64_t usb_max_transfer_size = 1024 * 1024;
 
-    GError* err = nullptr;
+static const char* usbfs_memory_path = "/sys/module/usbcore/parameters/usbfs_memory_mb";
 
-    this->stream_ = arv_camera_create_stream(this->arv_camera_, stream_cb, NULL, &err);
+// usbfs_memory_mb is shared by all devices, the streams of this process add up their needs
+static std::mutex usbfs_mtx;
+static int usbfs_reserved_mb = 0;
 
-    if (err)
+
+static void raise_usbfs_memory(int required_mb)
+{
+    int current = 0;
     {
-        SPDLOG_ERROR("Unable to create stream: {}", err->message);
-        g_clear_error(&err);
-        return false;
+        std::ifstream in(usbfs_memory_path);
+        if (!(in >> current))
+        {
+            return; // no usbfs
+        }
     }
-
-    if (this->stream_ == nullptr)
+    // 0 is unlimited
+    if (current == 0 || current >= required_mb)
     {
-        SPDLOG_ERROR("Unable to create ArvStream.");
-        return false;
+        return;
     }
 
-    if (ARV_IS_GV_STREAM(this->stream_))
+    std::ofstream out(usbfs_memory_path);
+    if (out << required_mb << std::flush)
     {
-        set_stream_options(this->stream_);
+        SPDLOG_INFO("Raised usbfs_memory_mb from {} to {} MB.", current, required_mb);
+        return;
     }
+    SPDLOG_WARN("usbfs_memory_mb is {} MB, the USB3 Vision streams need {} MB. Images may be "
+                "dropped. Raise it as root with 'echo {} > {}'.",
+                current,
+                required_mb,
+                required_mb,
+                usbfs_memory_path);
+}
 
-    for (auto& buf : buffer_list_) { arv_stream_push_buffer(this->stream_, buf.arv_buffer); }
 
-    arv_stream_set_emit_signals(this->stream_, TRUE);
+// Has to be called before the stream is created, returns the usbfs memory reserved for it
+static int set_usb_stream_options(ArvCamera* camera, const tcam_stream_transport_options& opt)
+{
+    ArvDevice* device = arv_camera_get_device(camera);
+    if (!ARV_IS_UV_DEVICE(device))
+    {
+        return 0;
+    }
 
-    arv_camera_set_acquisition_mode(this->arv_camera_, ARV_ACQUISITION_MODE_CONTINUOUS, &err);
+    GError* err = nullptr;
+    const uint64_t payload = arv_camera_get_payload(camera, &err);
+    g_clear_error(&err);
+
+    // Synchronous bulk reads have a gap between the transfers of a frame, xHCI controllers with
+    // small buffers then drop data at full bandwidth. Small payloads are a single transfer anyway.
+    const bool async = opt.usb_async_transfers < 0 ? payload > usb_max_transfer_size
+                                                    : opt.usb_async_transfers != 0;
+#if ARAVIS_CHECK_VERSION(0, 8, 17)
+    arv_uv_device_set_usb_mode(ARV_UV_DEVICE(device),
+                               async ? ARV_UV_USB_MODE_ASYNC : ARV_UV_USB_MODE_SYNC);
+#endif
 
-    if (err)
+    if (opt.usbfs_memory_mb == 0)
     {
-        SPDLOG_ERROR("Unable to set acquisition mode: {}", err->message);
-        g_clear_error(&err);
-        return false;
+        return 0;
     }
 
-    // a work thread is not required as aravis already pushes the images asynchronously
+    // asynchronous transfers keep a whole frame in flight, the next one is submitted meanwhile
+    const int needed_mb = async ? static_cast<int>(2 * ((payload + (1 << 20) - 1) >> 20)) : 1;
 
-    g_signal_connect(stream_, "new-buffer", G_CALLBACK(aravis_new_buffer_callback), this);
+    std::scoped_lock lck { usbfs_mtx };
+    usbfs_reserved_mb += needed_mb;
+    // the kernel default of 16 MB serves other devices
+    raise_usbfs_memory(std::max(opt.usbfs_memory_mb, usbfs_reserved_mb + 16));
+    return needed_mb;
+}
 
-    SPDLOG_INFO("Starting actual stream...");
 
-    frames_delivered_ = 0;
-    frames_dropped_ = 0;
+static void release_usbfs_memory(int reserved_mb)
+{
+    std::scoped_lock lck { usbfs_mtx };
+    usbfs_reserved_mb -= reserved_mb;
+}
 
-    sink_ = sink;
+#else
 
-    arv_camera_start_acquisition(this->arv_camera_, &err);
+static int set_usb_stream_options(ArvCamera*, const tcam_stream_transport_options&)
+{
+    return 0;
+}
 
-    if (err)
-    {
-        SPDLOG_ERROR("Unable to start stream: {}", err->message);
-        g_clear_error(&err);
+static void release_usbfs_memory(int) {}
 
-        stop_stream();
+#endif
 
-        return false;
+// Has to be called before the stream is created
+static void set_packet_socket_option(ArvCamera* camera, const tcam_stream_transport_options& opt)
+{
+    ArvDevice* device = arv_camera_get_device(camera);
+    if (!ARV_IS_GV_DEVICE(device))
+    {
+        return;
     }
 
-    return true;
+    // aravis uses a packet socket when the process has the permissions for it
+    arv_gv_device_set_stream_options(ARV_GV_DEVICE(device),
+                                     opt.packet_socket == 0
+                                         ? ARV_GV_STREAM_OPTION_PACKET_SOCKET_DISABLED
+                                         : ARV_GV_STREAM_OPTION_NONE);
 }
 
-
-void AravisDevice::stop_stream()
+static void set_gv_stream_transport_options(ArvStream* stream,
+                                            const tcam_stream_transport_options& opt)
 {
-    std::scoped_lock lck0 { arv_camera_access_mutex_ };
-
-    if (arv_camera_ == NULL)
+    if (opt.socket_buffer_size == 0)
     {
-        return;
+        g_object_set(stream, "socket-buffer", ARV_GV_STREAM_SOCKET_BUFFER_AUTO, nullptr);
     }
-    GError* err = nullptr;
-
-    if (stream_)
+    else if (opt.socket_buffer_size > 0)
     {
-        // emit_signals has to be disabled to prevent
-        // to prevent a warning
-        // disable it before stop_acquisition
-        // as under _some_ circumstances it may end
-        // up locking up in the mutex
-        arv_stream_set_emit_signals(this->stream_, FALSE);
+        g_object_set(stream,
+                     "socket-buffer",
+                     ARV_GV_STREAM_SOCKET_BUFFER_FIXED,
+                     "socket-buffer-size",
+                     opt.socket_buffer_size,
+                     nullptr);
     }
-
-    arv_camera_stop_acquisition(arv_camera_, &err);
-
-    if (err)
+    if (opt.packet_resend >= 0)
     {
-        SPDLOG_ERROR("Unable to stop stream: {}", err->message);
-        g_clear_error(&err);
-        return;
+        g_object_set(stream,
+                     "packet-resend",
+                     opt.packet_resend == 0 ? ARV_GV_STREAM_PACKET_RESEND_NEVER
+                                            : ARV_GV_STREAM_PACKET_RESEND_ALWAYS,
+                     nullptr);
     }
-
-    if (this->stream_ != nullptr)
+    if (opt.packet_timeout_us >= 0)
     {
-        g_object_unref(this->stream_);
-        this->stream_ = NULL;
+        g_object_set(stream, "packet-timeout", static_cast<guint>(opt.packet_timeout_us), nullptr);
+    }
+    if (opt.frame_retention_us >= 0)
+    {
+        g_object_set(
+            stream, "frame-retention", static_cast<guint>(opt.frame_retention_us), nullptr);
     }
-
-    // releasing the stream deletes all arv_buffer objects currently pending in the arv_stream, so we cannot re-use the actaul ImageBuffers here
-
-    sink_.reset();
-
-    release_buffers();
 }
 
-static auto translate_arv_buffer_status(ArvBufferStatus status) -> const char*
+// Runs in the receive thread of aravis
+static void configure_receive_thread(const tcam_stream_transport_options& opt)
 {
-    switch (status)
+    if (!opt.receive_thread_cpu_affinity.empty())
     {
-        case ARV_BUFFER_STATUS_SUCCESS:
-        {
-            return "the buffer is cleared";
-        }
-        case ARV_BUFFER_STATUS_TIMEOUT:
+        auto cpu_list = tcam::parse_cpu_list(opt.receive_thread_cpu_affinity);
+        if (!cpu_list || cpu_list->empty())
         {
-            return "Timeout has been reached before all packets were received";
+            SPDLOG_WARN("Unable to parse the cpu affinity of the aravis capture thread: '{}'",
+                        opt.receive_thread_cpu_affinity);
         }
-        case ARV_BUFFER_STATUS_MISSING_PACKETS:
+        else
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int cpu : *cpu_list)
+            {
+                if (cpu < CPU_SETSIZE)
+                {
+                    CPU_SET(cpu, &set);
+                }
+            }
+            if (int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set); err != 0)
+            {
+                SPDLOG_WARN("Unable to pin aravis capture thread to cpus '{}': {}",
+                            opt.receive_thread_cpu_affinity,
+                            strerror(err));
+            }
+            else
+            {
+                SPDLOG_INFO("Aravis capture thread is pinned to cpus '{}'",
+                            opt.receive_thread_cpu_affinity);
+            }
+        }
+    }
+
+    if (opt.receive_thread_priority == 0)
+    {
+        SPDLOG_INFO("Aravis capture thread is running with the default scheduling");
+        return;
+    }
+    if (opt.receive_thread_priority > 0)
+    {
+        sched_param param = {};
+        param.sched_priority = std::clamp(opt.receive_thread_priority,
+                                          sched_get_priority_min(SCHED_FIFO),
+                                          sched_get_priority_max(SCHED_FIFO));
+        if (int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param); err != 0)
+        {
+            SPDLOG_WARN("Unable to set SCHED_FIFO priority {} for the aravis capture thread: {}",
+                        param.sched_priority,
+                        strerror(err));
+        }
+        else
+        {
+            SPDLOG_INFO("Aravis capture thread is running with SCHED_FIFO priority {}",
+                        param.sched_priority);
+            return;
+        }
+    }
+
+    if (!arv_make_thread_realtime(10))
+    {
+        if (!arv_make_thread_high_priority(-10))
+        {
+            SPDLOG_INFO("Unable to make aravis capture thread real time or high priority");
+        }
+        else
+        {
+            SPDLOG_INFO("Aravis capture thread is running in high priority mode");
+        }
+    }
+    else
+    {
+        SPDLOG_INFO("Aravis capture thread is running as a real time thread");
+    }
+}
+
+
+static bool same_transport_options(const tcam_stream_transport_options& lhs,
+                                   const tcam_stream_transport_options& rhs)
+{
+    return lhs.packet_socket == rhs.packet_socket
+           && lhs.socket_buffer_size == rhs.socket_buffer_size
+           && lhs.packet_resend == rhs.packet_resend
+           && lhs.packet_timeout_us == rhs.packet_timeout_us
+           && lhs.frame_retention_us == rhs.frame_retention_us
+           && lhs.receive_thread_cpu_affinity == rhs.receive_thread_cpu_affinity
+           && lhs.receive_thread_priority == rhs.receive_thread_priority
+           && lhs.usb_async_transfers == rhs.usb_async_transfers
+           && lhs.usbfs_memory_mb == rhs.usbfs_memory_mb;
+}
+
+
+bool AravisDevice::create_stream()
+{
+    // install callback to initialize the capture thread as real time
+    // user_data points to receive_thread_options_, which is not changed while the stream exists
+    auto stream_cb = [](void* user_data, ArvStreamCallbackType type, ArvBuffer* /*buffer*/)
+    {
+        if (type == ARV_STREAM_CALLBACK_TYPE_INIT)
+        {
+            configure_receive_thread(*static_cast<const tcam_stream_transport_options*>(user_data));
+        }
+    };
+
+    set_packet_socket_option(this->arv_camera_, receive_thread_options_);
+    usbfs_reserved_mb_ = set_usb_stream_options(this->arv_camera_, receive_thread_options_);
+
+    GError* err = nullptr;
+
+    ArvStream* new_stream =
+        arv_camera_create_stream(this->arv_camera_, stream_cb, &receive_thread_options_, &err);
+    {
+        std::scoped_lock lck { buffer_list_mtx_ };
+        this->stream_ = new_stream;
+    }
+
+    if (err)
+    {
+        SPDLOG_ERROR("Unable to create stream: {}", err->message);
+        g_clear_error(&err);
+        return false;
+    }
+
+    if (this->stream_ == nullptr)
+    {
+        SPDLOG_ERROR("Unable to create ArvStream.");
+        return false;
+    }
+
+    loss_mark_stride_ = 0;
+    if (ARV_IS_GV_STREAM(this->stream_))
+    {
+        set_stream_options(this->stream_);
+        // explicitly set options take precedence over TCAM_ARV_STREAM_OPTIONS
+        set_gv_stream_transport_options(this->stream_, receive_thread_options_);
+
+        const size_t packet_size = arv_camera_gv_get_packet_size(this->arv_camera_, &err);
+        if (err)
+        {
+            SPDLOG_DEBUG("Unable to read the packet size: {}", err->message);
+            g_clear_error(&err);
+        }
+        else
+        {
+            loss_mark_stride_ = calc_loss_mark_stride(packet_size);
+            max_packet_payload_ = packet_size - gvsp_min_packet_overhead;
+        }
+    }
+
+    // a work thread is not required as aravis already pushes the images asynchronously
+    g_signal_connect(stream_, "new-buffer", G_CALLBACK(aravis_new_buffer_callback), this);
+
+    push_unqueued_buffers();
+
+    return true;
+}
+
+
+void AravisDevice::destroy_stream()
+{
+    ArvStream* stream = nullptr;
+    {
+        // requeue_buffer only holds buffer_list_mtx_
+        // the unref has to happen without the lock, because the
+        // arv_buffer destroy notify takes buffer_list_mtx_
+        std::scoped_lock lck { buffer_list_mtx_ };
+        std::swap(stream, this->stream_);
+    }
+    // also reserved when create_stream failed
+    release_usbfs_memory(usbfs_reserved_mb_);
+    usbfs_reserved_mb_ = 0;
+
+    if (stream == nullptr)
+    {
+        return;
+    }
+    g_object_unref(stream);
+
+    // the stream released the ArvBuffers it owned, push_unqueued_buffers replaces them
+    std::scoped_lock lck { buffer_list_mtx_ };
+    for (auto& info : buffer_list_) { info.is_queued = false; }
+}
+
+
+bool AravisDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
+{
+    std::scoped_lock lck0 { arv_camera_access_mutex_ };
+
+    // TLParamsLocked changes, so do the locked flags of all features
+    backend_->invalidate_register_cache();
+
+    if (arv_camera_ == nullptr)
+    {
+        SPDLOG_ERROR("ArvCamera missing!");
+        return false;
+    }
+
+    assert(!is_streaming_);
+    if (is_streaming_)
+    {
+        SPDLOG_ERROR("Stop was not called previously");
+        return false;
+    }
+
+    if (buffer_list_.size() < 2)
+    {
+        SPDLOG_ERROR("Need at least two buffers.");
+        return false;
+    }
+
+    configure_chunk_mode();
+    create_chunk_parser();
+
+    const auto new_receive_options = apply_environment_defaults(stream_transport_options_);
+    if (stream_ != nullptr && !same_transport_options(new_receive_options, receive_thread_options_))
+    {
+        SPDLOG_DEBUG("Stream transport options changed. Creating a new ArvStream.");
+        destroy_stream();
+    }
+
+    if (stream_ == nullptr)
+    {
+        receive_thread_options_ = new_receive_options;
+        if (!create_stream())
+        {
+            return false;
+        }
+    }
+
+    GError* err = nullptr;
+
+    arv_stream_set_emit_signals(this->stream_, TRUE);
+
+    arv_camera_set_acquisition_mode(this->arv_camera_, ARV_ACQUISITION_MODE_CONTINUOUS, &err);
+
+    if (err)
+    {
+        SPDLOG_ERROR("Unable to set acquisition mode: {}", err->message);
+        g_clear_error(&err);
+        return false;
+    }
+
+    if (action_start_ && !arm_action_start())
+    {
+        disarm_action_start();
+        return false;
+    }
+
+    {
+        auto ptp = read_ptp_status();
+        ptp_synchronized_ = ptp && ptp.value().is_synchronized();
+    }
+
+    // shares the link with the other cameras on the same interface
+    bandwidth_stream_id_ = aravis::BandwidthManager::get_instance().register_stream(arv_camera_);
+
+    SPDLOG_INFO("Starting actual stream...");
+
+    frames_delivered_ = 0;
+    frames_dropped_ = 0;
+
+    sink_ = sink;
+    is_streaming_ = true;
+
+    arv_camera_start_acquisition(this->arv_camera_, &err);
+
+    if (err)
+    {
+        SPDLOG_ERROR("Unable to start stream: {}", err->message);
+        g_clear_error(&err);
+
+        stop_stream();
+
+        return false;
+    }
+
+    return true;
+}
+
+
+void AravisDevice::stop_stream()
+{
+    std::scoped_lock lck0 { arv_camera_access_mutex_ };
+
+    // see start_stream
+    backend_->invalidate_register_cache();
+
+    if (arv_camera_ == NULL)
+    {
+        return;
+    }
+    GError* err = nullptr;
+
+    if (stream_)
+    {
+        // emit_signals has to be disabled to prevent
+        // to prevent a warning
+        // disable it before stop_acquisition
+        // as under _some_ circumstances it may end
+        // up locking up in the mutex
+        arv_stream_set_emit_signals(this->stream_, FALSE);
+    }
+
+    if (!is_streaming_)
+    {
+        return;
+    }
+    is_streaming_ = false;
+
+    arv_camera_stop_acquisition(arv_camera_, &err);
+
+    aravis::BandwidthManager::get_instance().unregister_stream(bandwidth_stream_id_);
+    bandwidth_stream_id_ = 0;
+
+    if (action_armed_)
+    {
+        disarm_action_start();
+    }
+
+    if (err)
+    {
+        SPDLOG_ERROR("Unable to stop stream: {}", err->message);
+        g_clear_error(&err);
+        return;
+    }
+
+    if (this->stream_ != nullptr)
+    {
+        // frames that were completed but not delivered are captured again after the restart
+        while (ArvBuffer* buffer = arv_stream_try_pop_buffer(stream_))
+        {
+            repush_arv_buffer(buffer);
+        }
+    }
+
+    // the stream stays alive, so that the next start_stream only has to start the acquisition
+    // it is released with the buffers
+
+    release_chunk_parser();
+
+    sink_.reset();
+}
+
+outcome::result<void> AravisDevice::set_action_start(
+    const std::optional<tcam_action_command>& cmd)
+{
+    std::scoped_lock lck { arv_camera_access_mutex_ };
+
+    if (cmd
+        && (!has_genicam_property("ActionDeviceKey") || !has_genicam_property("ActionGroupKey")
+            || !has_genicam_property("ActionGroupMask") || !has_genicam_property("TriggerSource")))
+    {
+        return tcam::status::PropertyNotImplemented;
+    }
+
+    action_start_ = cmd;
+    return outcome::success();
+}
+
+
+bool AravisDevice::arm_action_start()
+{
+    auto dev = arv_camera_get_device(arv_camera_);
+    GError* err = nullptr;
+
+    const char* selector = arv_device_get_string_feature_value(dev, "TriggerSelector", &err);
+    if (err)
+    {
+        g_clear_error(&err);
+    }
+    trigger_selector_before_action_ = selector ? selector : "";
+    action_armed_ = true;
+
+    auto set_int = [dev, &err](const char* name, int64_t value)
+    {
+        arv_device_set_integer_feature_value(dev, name, value, &err);
+        if (err)
+        {
+            SPDLOG_ERROR("Unable to set '{}' for the action command: {}", name, err->message);
+            g_clear_error(&err);
+            return false;
+        }
+        return true;
+    };
+    auto set_string = [dev, &err](const char* name, const char* value)
+    {
+        arv_device_set_string_feature_value(dev, name, value, &err);
+        if (err)
+        {
+            SPDLOG_ERROR(
+                "Unable to set '{}' to '{}' for the action command: {}", name, value, err->message);
+            g_clear_error(&err);
+            return false;
+        }
+        return true;
+    };
+
+    // Action1 is configured by ActionSelector 1, older cameras only have the one action
+    if (has_genicam_property("ActionSelector") && !set_int("ActionSelector", 1))
+    {
+        return false;
+    }
+
+    return set_int("ActionDeviceKey", action_start_->device_key)
+           && set_int("ActionGroupKey", action_start_->group_key)
+           && set_int("ActionGroupMask", action_start_->group_mask)
+           && set_string("TriggerSelector", "AcquisitionStart")
+           && set_string("TriggerSource", "Action1") && set_string("TriggerMode", "On");
+}
+
+
+void AravisDevice::disarm_action_start()
+{
+    auto dev = arv_camera_get_device(arv_camera_);
+    GError* err = nullptr;
+
+    action_armed_ = false;
+
+    arv_device_set_string_feature_value(dev, "TriggerSelector", "AcquisitionStart", &err);
+    if (!err)
+    {
+        arv_device_set_string_feature_value(dev, "TriggerMode", "Off", &err);
+    }
+    if (!err && !trigger_selector_before_action_.empty())
+    {
+        arv_device_set_string_feature_value(
+            dev, "TriggerSelector", trigger_selector_before_action_.c_str(), &err);
+    }
+    if (err)
+    {
+        SPDLOG_WARN("Unable to disable the AcquisitionStart trigger: {}", err->message);
+        g_clear_error(&err);
+    }
+}
+
+
+outcome::result<tcam_ptp_status> AravisDevice::get_ptp_status()
+{
+    if (is_lost_)
+    {
+        return tcam::status::DeviceLost;
+    }
+
+    std::scoped_lock lck { arv_camera_access_mutex_ };
+
+    OUTCOME_TRY(auto status, read_ptp_status());
+    if (is_streaming_)
+    {
+        // devices that lose the master while streaming no longer deliver PTP times
+        ptp_synchronized_ = ptp_synchronized_ && status.is_synchronized();
+    }
+    return status;
+}
+
+
+outcome::result<tcam_ptp_status> AravisDevice::read_ptp_status()
+{
+    const bool sfnc = has_genicam_property("PtpEnable");
+    if (!sfnc && !has_genicam_property("GevIEEE1588"))
+    {
+        return tcam::status::PropertyNotImplemented;
+    }
+
+    auto dev = arv_camera_get_device(arv_camera_);
+    GError* err = nullptr;
+
+    tcam_ptp_status status;
+    status.enabled =
+        arv_device_get_boolean_feature_value(dev, sfnc ? "PtpEnable" : "GevIEEE1588", &err);
+    if (err)
+    {
+        return tcam::aravis::consume_GError(err);
+    }
+
+    // the SFNC values are only updated by the latch
+    if (sfnc && has_genicam_property("PtpDataSetLatch"))
+    {
+        arv_device_execute_command(dev, "PtpDataSetLatch", &err);
+        if (err)
+        {
+            return tcam::aravis::consume_GError(err);
+        }
+    }
+
+    const char* state =
+        arv_device_get_string_feature_value(dev, sfnc ? "PtpStatus" : "GevIEEE1588Status", &err);
+    if (err)
+    {
+        return tcam::aravis::consume_GError(err);
+    }
+    status.state = state ? state : "";
+
+    if (has_genicam_property("PtpOffsetFromMaster"))
+    {
+        status.offset_from_master_ns =
+            arv_device_get_integer_feature_value(dev, "PtpOffsetFromMaster", &err);
+        if (err)
+        {
+            return tcam::aravis::consume_GError(err);
+        }
+    }
+
+    if (auto time = read_device_time_ns())
+    {
+        status.time_ns = time.value();
+    }
+
+    return status;
+}
+
+
+outcome::result<uint64_t> AravisDevice::read_device_time_ns()
+{
+    auto dev = arv_camera_get_device(arv_camera_);
+    GError* err = nullptr;
+
+    uint64_t value = 0;
+    if (has_genicam_property("TimestampLatch") && has_genicam_property("TimestampLatchValue"))
+    {
+        arv_device_execute_command(dev, "TimestampLatch", &err);
+        if (!err)
+        {
+            value = arv_device_get_integer_feature_value(dev, "TimestampLatchValue", &err);
+        }
+    }
+    else if (has_genicam_property("GevTimestampControlLatch")
+             && has_genicam_property("GevTimestampValue"))
+    {
+        arv_device_execute_command(dev, "GevTimestampControlLatch", &err);
+        if (!err)
+        {
+            value = arv_device_get_integer_feature_value(dev, "GevTimestampValue", &err);
+        }
+    }
+    else
+    {
+        return tcam::status::PropertyNotImplemented;
+    }
+
+    if (err)
+    {
+        return tcam::aravis::consume_GError(err);
+    }
+
+    // PTP cameras tick with 1 GHz, older ones have their own frequency
+    if (has_genicam_property("GevTimestampTickFrequency"))
+    {
+        const auto freq =
+            arv_device_get_integer_feature_value(dev, "GevTimestampTickFrequency", &err);
+        if (err)
+        {
+            g_clear_error(&err);
+        }
+        else if (freq > 0 && freq != 1000000000)
+        {
+            value = static_cast<uint64_t>(value * (1e9 / freq));
+        }
+    }
+    return value;
+}
+
+
+static auto translate_arv_buffer_status(ArvBufferStatus status) -> const char*
+{
+    switch (status)
+    {
+        case ARV_BUFFER_STATUS_SUCCESS:
+        {
+            return "the buffer is cleared";
+        }
+        case ARV_BUFFER_STATUS_TIMEOUT:
+        {
+            return "Timeout has been reached before all packets were received";
+        }
+        case ARV_BUFFER_STATUS_MISSING_PACKETS:
         {
             return "Stream has missing packets";
         }
@@ -499,6 +1320,7 @@ void AravisDevice::aravis_new_buffer_callback(ArvStream* stream __attribute__((u
     }
 
     ArvBufferStatus status = arv_buffer_get_status(buffer);
+    TCAM_TRACE2(aravis_new_buffer, arv_buffer_get_frame_id(buffer), static_cast<int>(status));
 
     if (status == ARV_BUFFER_STATUS_SUCCESS)
     {
@@ -506,57 +1328,184 @@ void AravisDevice::aravis_new_buffer_callback(ArvStream* stream __attribute__((u
     }
     else if (status == ARV_BUFFER_STATUS_MISSING_PACKETS)
     {
-        if (self->drop_incomplete_frames_)
+        const auto missing_lines = self->find_missing_lines(buffer);
+
+        bool salvage = false;
+        if (missing_lines && self->salvage_threshold_ > 0.0)
+        {
+            const double height = self->active_video_format_.get_size().height;
+            salvage = count_missing_lines(*missing_lines) <= self->salvage_threshold_ * height;
+        }
+
+        if (self->drop_incomplete_frames_ && !salvage)
         {
-            SPDLOG_DEBUG("Image has missing packets. Dropping incomplete frame as requested.");
+            TCAM_LOG_RATELIMITED(spdlog::level::debug,
+                                 1000,
+                                 "Image has missing packets. Dropping incomplete frame as requested.");
 
             ++self->frames_dropped_;
 
-            arv_stream_push_buffer(stream, buffer);
+            self->repush_arv_buffer(buffer);
         }
         else
         {
-            SPDLOG_DEBUG("Image has missing packets. Sending incomplete buffer as requested.");
+            if (salvage)
+            {
+                TCAM_LOG_RATELIMITED(spdlog::level::debug,
+                                     1000,
+                                     "Image misses {} lines. Salvaging incomplete frame.",
+                                     count_missing_lines(*missing_lines));
+            }
+            else
+            {
+                TCAM_LOG_RATELIMITED(
+                    spdlog::level::debug,
+                    1000,
+                    "Image has missing packets. Sending incomplete buffer as requested.");
+            }
 
-            self->complete_aravis_stream_buffer(buffer, true);
+            self->complete_aravis_stream_buffer(
+                buffer, true, missing_lines.value_or(tcam_missing_line_map {}));
         }
     }
     else
     {
         ++self->frames_dropped_;
 
-        arv_stream_push_buffer(self->stream_, buffer);
+        self->repush_arv_buffer(buffer);
         auto ptr = translate_arv_buffer_status(status);
         if (ptr)
         {
-            SPDLOG_DEBUG("arvBufferStatus: {}", ptr);
+            TCAM_LOG_RATELIMITED(spdlog::level::debug, 1000, "arvBufferStatus: {}", ptr);
+        }
+    }
+}
+
+// Fills the transport counters of stats from the stream and the completed buffer
+static void fill_transport_statistics(ArvStream* stream,
+                                      ArvBuffer* buffer,
+                                      tcam_stream_statistics& stats)
+{
+    guint64 n_completed_buffers = 0;
+    guint64 n_failures = 0;
+    guint64 n_underruns = 0;
+    arv_stream_get_statistics(stream, &n_completed_buffers, &n_failures, &n_underruns);
+    stats.underruns = n_underruns;
+
+    if (ARV_IS_GV_STREAM(stream))
+    {
+        guint64 n_resent_packets = 0;
+        guint64 n_missing_packets = 0;
+        arv_gv_stream_get_statistics(ARV_GV_STREAM(stream), &n_resent_packets, &n_missing_packets);
+        stats.resent_packets = n_resent_packets;
+        stats.missing_packets = n_missing_packets;
+    }
+
+    // aravis takes the system timestamp when the first packet of a frame arrives
+    const uint64_t now_ns = static_cast<uint64_t>(g_get_real_time()) * 1000;
+    const uint64_t first_packet_ns = arv_buffer_get_system_timestamp(buffer);
+    stats.receive_duration_ns = now_ns > first_packet_ns ? now_ns - first_packet_ns : 0;
+}
+
+void AravisDevice::create_chunk_parser()
+{
+    release_chunk_parser();
+
+    if (!chunk_data_enabled_)
+    {
+        return;
+    }
+
+    size_t xml_size = 0;
+    const char* xml = arv_device_get_genicam_xml(arv_camera_get_device(arv_camera_), &xml_size);
+    if (!xml)
+    {
+        SPDLOG_WARN("Unable to retrieve the genicam xml. Chunk data is not delivered.");
+        return;
+    }
+
+    chunk_parser_ = arv_chunk_parser_new(xml, xml_size);
+
+    chunk_has_exposure_time_ = true;
+    chunk_has_gain_ = true;
+    chunk_has_frame_id_ = true;
+}
+
+void AravisDevice::release_chunk_parser()
+{
+    if (chunk_parser_)
+    {
+        g_object_unref(chunk_parser_);
+        chunk_parser_ = nullptr;
+    }
+}
+
+tcam_chunk_data AravisDevice::parse_chunk_data(ArvBuffer* buffer)
+{
+    tcam_chunk_data data;
+
+    if (!chunk_parser_ || !arv_buffer_has_chunks(buffer))
+    {
+        return data;
+    }
+
+    // returns false and stops querying the chunk when the camera does not provide it
+    auto check_error = [](GError*& err, const char* name, bool& has_chunk)
+    {
+        if (!err)
+        {
+            return true;
         }
+        SPDLOG_DEBUG("Unable to read '{}' from the chunk data: {}", name, err->message);
+        g_clear_error(&err);
+        has_chunk = false;
+        return false;
+    };
+
+    GError* err = nullptr;
+    if (chunk_has_exposure_time_)
+    {
+        data.exposure_time_us =
+            arv_chunk_parser_get_float_value(chunk_parser_, buffer, "ChunkExposureTime", &err);
+        data.has_exposure_time = check_error(err, "ChunkExposureTime", chunk_has_exposure_time_);
+    }
+    if (chunk_has_gain_)
+    {
+        data.gain = arv_chunk_parser_get_float_value(chunk_parser_, buffer, "ChunkGain", &err);
+        data.has_gain = check_error(err, "ChunkGain", chunk_has_gain_);
+    }
+    if (chunk_has_frame_id_)
+    {
+        data.frame_id = static_cast<uint64_t>(
+            arv_chunk_parser_get_integer_value(chunk_parser_, buffer, "ChunkFrameID", &err));
+        data.has_frame_id = check_error(err, "ChunkFrameID", chunk_has_frame_id_);
     }
+    return data;
 }
 
-void AravisDevice::complete_aravis_stream_buffer(ArvBuffer* buffer, bool is_incomplete)
+void AravisDevice::complete_aravis_stream_buffer(ArvBuffer* buffer,
+                                                 bool is_incomplete,
+                                                 const tcam_missing_line_map& missing_lines)
 {
     // receives the actual ImageBuffer from the ArvBuffer
     std::shared_ptr<ImageBuffer> completed_buffer;
     {
-        //std::scoped_lock lck { buffer_list_mtx_ };
+        std::scoped_lock lck { buffer_list_mtx_ };
 
         buffer_info& arv_user_data = *const_cast<buffer_info*>(
             static_cast<const buffer_info*>(arv_buffer_get_user_data(buffer)));
 
-#if !defined NDEBUG
-        arv_user_data.is_queued = false;
-#endif
         completed_buffer = arv_user_data.buffer;
-    }
-
-    if (completed_buffer == nullptr) // this should never happen
-    {
-        ++frames_dropped_;
+        if (completed_buffer == nullptr) // this should never happen
+        {
+            ++frames_dropped_;
 
-        SPDLOG_ERROR("Failed to find the associated ImageBuffer for the completed arv buffer.");
-        arv_stream_push_buffer(stream_, buffer);
-        return;
+            SPDLOG_ERROR(
+                "Failed to find the associated ImageBuffer for the completed arv buffer.");
+            arv_stream_push_buffer(stream_, buffer);
+            return;
+        }
+        arv_user_data.is_queued = false;
     }
 
     if (auto ptr = sink_.lock())
@@ -567,15 +1516,30 @@ void AravisDevice::complete_aravis_stream_buffer(ArvBuffer* buffer, bool is_inco
         size_t image_size = 0;
         arv_buffer_get_data(buffer, &image_size);
 
+        // the chunks follow the image data
+        auto chunk_data = parse_chunk_data(buffer);
+        if (arv_buffer_has_chunks(buffer))
+        {
+            image_size = std::min(
+                image_size, static_cast<size_t>(active_video_format_.get_required_buffer_size()));
+        }
+
         tcam_stream_statistics stats = {};
         stats.capture_time_ns = arv_buffer_get_system_timestamp(buffer);
         stats.camera_time_ns = arv_buffer_get_timestamp(buffer);
+        // aravis converts the ticks to ns, with PTP the camera clock is the PTP clock
+        stats.ptp_time_ns = ptp_synchronized_ ? stats.camera_time_ns : 0;
         stats.frame_count = frames_delivered_;
         stats.frames_dropped = frames_dropped_;
         stats.is_damaged = is_incomplete;
+        stats.missing_lines = count_missing_lines(missing_lines);
+        fill_transport_statistics(stream_, buffer, stats);
 
         completed_buffer->set_statistics(stats);
+        completed_buffer->set_chunk_data(chunk_data);
+        completed_buffer->set_missing_line_map(missing_lines);
         completed_buffer->set_valid_data_length(image_size);
+        completed_buffer->record_stage(timing::stage::backend_dequeue);
         ptr->push_image(completed_buffer);
     }
     else
@@ -587,3 +1551,121 @@ void AravisDevice::complete_aravis_stream_buffer(ArvBuffer* buffer, bool is_inco
         requeue_buffer(completed_buffer);
     }
 }
+
+
+outcome::result<void> AravisDevice::trigger_software()
+{
+    if (is_lost_)
+    {
+        return tcam::status::DeviceLost;
+    }
+
+    std::scoped_lock lck { trigger_mtx_ };
+
+    if (!trigger_software_node_)
+    {
+        std::scoped_lock arv_lck { arv_camera_access_mutex_ };
+
+        auto node = get_genicam_property_node("TriggerSoftware");
+        if (!node || !ARV_IS_GC_COMMAND(node))
+        {
+            return tcam::status::PropertyNotImplemented;
+        }
+        trigger_software_node_ = node;
+    }
+
+    if (!trigger_thread_.joinable())
+    {
+        trigger_thread_stop_ = false;
+        trigger_thread_ = std::thread(&AravisDevice::trigger_thread_main, this);
+    }
+
+    trigger_requests_++;
+    trigger_cv_.notify_one();
+
+    return outcome::success();
+}
+
+
+outcome::result<void> AravisDevice::move_roi(uint32_t offset_x, uint32_t offset_y)
+{
+    if (is_lost_)
+    {
+        return tcam::status::DeviceLost;
+    }
+
+    {
+        std::scoped_lock arv_lck { arv_camera_access_mutex_ };
+
+        for (const char* name : { "OffsetX", "OffsetY" })
+        {
+            auto node = get_genicam_property_node(name);
+            if (!node || !ARV_IS_GC_FEATURE_NODE(node))
+            {
+                return tcam::status::PropertyNotImplemented;
+            }
+
+            GError* err = nullptr;
+            const bool is_locked = arv_gc_feature_node_is_locked(ARV_GC_FEATURE_NODE(node), &err);
+            if (err)
+            {
+                SPDLOG_ERROR("Unable to query lock state of '{}': {}", name, err->message);
+                return tcam::aravis::consume_GError(err);
+            }
+            if (is_locked)
+            {
+                SPDLOG_DEBUG("'{}' is locked, the ROI can only be moved with a stream restart.",
+                             name);
+                return tcam::status::PropertyNotWriteable;
+            }
+        }
+    }
+
+    return DeviceInterface::move_roi(offset_x, offset_y);
+}
+
+
+void AravisDevice::trigger_thread_main()
+{
+    std::unique_lock lck { trigger_mtx_ };
+
+    while (true)
+    {
+        trigger_cv_.wait(lck, [this] { return trigger_thread_stop_ || trigger_requests_ > 0; });
+        if (trigger_thread_stop_)
+        {
+            return;
+        }
+        trigger_requests_--;
+        lck.unlock();
+
+        {
+            std::scoped_lock arv_lck { arv_camera_access_mutex_ };
+
+            GError* err = nullptr;
+            arv_gc_command_execute(ARV_GC_COMMAND(trigger_software_node_), &err);
+            if (err)
+            {
+                SPDLOG_ERROR("Unable to execute TriggerSoftware: {}", err->message);
+                g_clear_error(&err);
+            }
+        }
+
+        lck.lock();
+    }
+}
+
+
+void AravisDevice::stop_trigger_thread()
+{
+    {
+        std::scoped_lock lck { trigger_mtx_ };
+        trigger_thread_stop_ = true;
+    }
+    trigger_cv_.notify_one();
+
+    if (trigger_thread_.joinable())
+    {
+        trigger_thread_.join();
+    }
+}
@@ -17,13 +17,102 @@
 #include "AravisPropertyBackend.h"
 
 #include "../logging.h"
+#include "../utils.h"
 #include "AravisDevice.h"
 #include "aravis_utils.h"
 
 #include <arv.h>
+#include <optional>
 
 using namespace tcam::aravis;
 
+namespace
+{
+
+std::optional<register_cache_mode> to_register_cache_mode(std::string_view str) noexcept
+{
+    if (str == "disable")
+        return register_cache_mode::disable;
+    if (str == "locked")
+        return register_cache_mode::locked;
+    if (str == "enable")
+        return register_cache_mode::enable;
+    if (str == "debug")
+        return register_cache_mode::debug;
+    return {};
+}
+
+const char* to_string(register_cache_mode mode) noexcept
+{
+    switch (mode)
+    {
+        case register_cache_mode::disable:
+            return "disable";
+        case register_cache_mode::locked:
+            return "locked";
+        case register_cache_mode::enable:
+            return "enable";
+        case register_cache_mode::debug:
+            return "debug";
+    }
+    return "";
+}
+
+// TCAM_ARV_REGISTER_CACHE=<mode>,<serial>=<mode>,...
+register_cache_mode read_register_cache_mode(const std::string& serial)
+{
+    auto mode = register_cache_mode::locked;
+
+    const auto env = tcam::get_environment_variable("TCAM_ARV_REGISTER_CACHE", "");
+    if (env.empty())
+    {
+        return mode;
+    }
+
+    std::optional<register_cache_mode> device_mode;
+    for (const auto& entry : tcam::split_string(env, ","))
+    {
+        auto pos = entry.find('=');
+        auto value = pos == std::string::npos ? entry : entry.substr(pos + 1);
+
+        auto entry_mode = to_register_cache_mode(value);
+        if (!entry_mode)
+        {
+            SPDLOG_WARN("TCAM_ARV_REGISTER_CACHE: Unknown cache mode '{}'.", value);
+            continue;
+        }
+
+        if (pos == std::string::npos)
+        {
+            mode = *entry_mode;
+        }
+        else if (entry.substr(0, pos) == serial)
+        {
+            device_mode = entry_mode;
+        }
+    }
+    return device_mode.value_or(mode);
+}
+
+ArvRegisterCachePolicy to_idle_policy(register_cache_mode mode) noexcept
+{
+    // reads outside of properties (formats, stream setup) keep the uncached behavior,
+    // unless all features are cached
+    switch (mode)
+    {
+        case register_cache_mode::enable:
+            return ARV_REGISTER_CACHE_POLICY_ENABLE;
+        case register_cache_mode::debug:
+            return ARV_REGISTER_CACHE_POLICY_DEBUG;
+        case register_cache_mode::disable:
+        case register_cache_mode::locked:
+            break;
+    }
+    return ARV_REGISTER_CACHE_POLICY_DISABLE;
+}
+
+} // namespace
+
 AravisPropertyBackend::AravisPropertyBackend(tcam::AravisDevice& parent)
     : parent_(parent)
 {
@@ -34,6 +123,58 @@ std::recursive_mutex& AravisPropertyBackend::get_mutex() noexcept
     return parent_.arv_camera_access_mutex_;
 }
 
+void AravisPropertyBackend::notify_changed(std::string_view name)
+{
+    invalidate_register_cache();
+
+    auto notifier = parent_.get_property_notifier();
+    notifier->notify(name);
+    notifier->notify({});
+}
+
+void AravisPropertyBackend::configure_register_cache()
+{
+    cache_mode_ = read_register_cache_mode(parent_.device.get_serial());
+    if (cache_mode_ != register_cache_mode::locked)
+    {
+        SPDLOG_INFO("Register cache mode for {}: {}",
+                    parent_.device.get_serial(),
+                    to_string(cache_mode_));
+    }
+
+    arv_gc_set_register_cache_policy(parent_.genicam_, to_idle_policy(cache_mode_));
+}
+
+ArvRegisterCachePolicy AravisPropertyBackend::begin_read(bool has_locked_value,
+                                                         uint64_t& read_generation) noexcept
+{
+    auto previous = arv_gc_get_register_cache_policy(parent_.genicam_);
+    if (cache_mode_ == register_cache_mode::disable)
+    {
+        return previous;
+    }
+
+    // A read with the disabled policy still refreshes the cached register content,
+    // so after an invalidation every value is read from the device exactly once.
+    bool use_cache = read_generation == cache_generation_
+                     && (cache_mode_ != register_cache_mode::locked || has_locked_value);
+    read_generation = cache_generation_;
+
+    auto policy = ARV_REGISTER_CACHE_POLICY_DISABLE;
+    if (use_cache)
+    {
+        policy = cache_mode_ == register_cache_mode::debug ? ARV_REGISTER_CACHE_POLICY_DEBUG :
+                                                             ARV_REGISTER_CACHE_POLICY_ENABLE;
+    }
+    arv_gc_set_register_cache_policy(parent_.genicam_, policy);
+    return previous;
+}
+
+void AravisPropertyBackend::end_read(ArvRegisterCachePolicy previous) noexcept
+{
+    arv_gc_set_register_cache_policy(parent_.genicam_, previous);
+}
+
 tcamprop1::Visibility_t tcam::aravis::to_Visibility(ArvGcVisibility v) noexcept
 {
     switch (v)
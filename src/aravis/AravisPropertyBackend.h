@@ -19,6 +19,7 @@
 #include "../error.h"
 
 #include <arv.h>
+#include <cstdint>
 #include <mutex>
 #include <tcamprop1.0_base/tcamprop_base.h>
 
@@ -34,6 +35,15 @@ bool is_private_setting(std::string_view name);
 tcamprop1::Visibility_t to_Visibility(ArvGcVisibility v) noexcept;
 tcamprop1::Access_t to_Access(ArvGcAccessMode v) noexcept;
 
+// How property reads use the aravis register cache, see TCAM_ARV_REGISTER_CACHE
+enum class register_cache_mode
+{
+    disable, // every read goes to the device
+    locked, // only features with a pIsLocked, i.e. that cannot change while streaming
+    enable, // all features, cache validity follows the Cachable attribute of the registers
+    debug, // as enable, aravis reads the registers anyway and logs stale values
+};
+
 class AravisPropertyBackend
 {
 public:
@@ -41,8 +51,31 @@ public:
 
     std::recursive_mutex& get_mutex() noexcept;
 
+    // GenICam has no change events for dependent features, so every write notifies the written
+    // feature and everything else.
+    void notify_changed(std::string_view name);
+
+    // Reads the cache mode for the device and applies it to the genicam.
+    // Has to be called once the genicam of the parent exists.
+    void configure_register_cache();
+
+    // Invalidates all cached reads, the next read of every property goes to the device.
+    // Called after every write, the device may have changed any feature in response.
+    void invalidate_register_cache() noexcept
+    {
+        ++cache_generation_;
+    }
+
+    // Selects the cache policy for a single read and returns the policy to restore afterwards.
+    // read_generation is the cache generation of the previous read of the value and is updated.
+    ArvRegisterCachePolicy begin_read(bool has_locked_value, uint64_t& read_generation) noexcept;
+    void end_read(ArvRegisterCachePolicy previous) noexcept;
+
 private:
     AravisDevice& parent_;
+
+    register_cache_mode cache_mode_ = register_cache_mode::disable;
+    uint64_t cache_generation_ = 1;
 };
 
 } // namespace tcam::aravis
@@ -16,6 +16,10 @@
 
 #include "aravis_api.h"
 
+#include "../../tools/tcam-gige-daemon/gige-daemon.h"
+#include "../logging.h"
+#include "../ThreadPolicy.h"
+#include "../utils.h"
 #include "AravisDevice.h"
 #include "aravis_utils.h"
 
@@ -31,3 +35,126 @@ std::vector<tcam::DeviceInfo> tcam::AravisBackend::get_device_list()
 {
     return get_gige_device_list();
 }
+
+
+std::optional<tcam::DeviceInfo> tcam::AravisBackend::find_device(const std::string& serial)
+{
+    return find_gige_device(serial);
+}
+
+
+bool tcam::AravisBackend::start_monitoring(const backend_monitor_callbacks& callbacks)
+{
+    std::scoped_lock lck { monitor_mtx_ };
+    monitor_callbacks_ = callbacks;
+
+    if (daemon_monitor_thread_.joinable())
+    {
+        return false;
+    }
+
+    daemon_list_ = attach_gige_daemon_list();
+    if (!daemon_list_)
+    {
+        return false;
+    }
+
+    SPDLOG_DEBUG("Subscribed to gige-daemon device list changes");
+
+    run_daemon_monitor_ = true;
+    daemon_monitor_thread_ = std::thread(&AravisBackend::monitor_gige_daemon, this);
+    return true;
+}
+
+
+void tcam::AravisBackend::stop_monitoring()
+{
+    if (daemon_monitor_thread_.joinable())
+    {
+        run_daemon_monitor_ = false;
+        // also wakes the subscribers of other processes, they simply wait again
+        tcam::tools::gige_daemon::notify_change(daemon_list_->change_count);
+        daemon_monitor_thread_.join();
+
+        detach_gige_daemon_list(daemon_list_);
+        daemon_list_ = nullptr;
+    }
+
+    std::scoped_lock lck { monitor_mtx_ };
+    monitor_callbacks_ = {};
+}
+
+
+void tcam::AravisBackend::monitor_gige_daemon()
+{
+    namespace gige_daemon = tcam::tools::gige_daemon;
+
+    tcam::thread_policy::setup_thread("tcam_arv_mon");
+
+    auto& list = *daemon_list_;
+
+    list.subscriber_count.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t last_change = list.change_count.load(std::memory_order_acquire);
+
+    while (run_daemon_monitor_)
+    {
+        gige_daemon::wait_for_change(
+            list.change_count, last_change, gige_daemon::SCAN_INTERVAL_IDLE_MS);
+
+        if (!run_daemon_monitor_)
+        {
+            break;
+        }
+
+        // a killed or restarted daemon does not update this segment anymore
+        const auto age_ms = gige_daemon::get_device_list_time_ms()
+                            - list.last_update_ms.load(std::memory_order_acquire);
+        if (age_ms > gige_daemon::DEVICE_LIST_MAX_AGE_MS)
+        {
+            SPDLOG_INFO("gige-daemon stopped updating its device list. Falling back to polling.");
+
+            std::scoped_lock lck { monitor_mtx_ };
+            if (monitor_callbacks_.monitoring_lost)
+            {
+                monitor_callbacks_.monitoring_lost();
+            }
+            break;
+        }
+
+        const uint32_t change = list.change_count.load(std::memory_order_acquire);
+        if (change == last_change)
+        {
+            continue;
+        }
+        last_change = change;
+
+        std::scoped_lock lck { monitor_mtx_ };
+        if (monitor_callbacks_.device_list_changed)
+        {
+            monitor_callbacks_.device_list_changed();
+        }
+    }
+
+    list.subscriber_count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+
+outcome::result<void> tcam::AravisBackend::send_action_command(const tcam_action_command& cmd)
+{
+    if (auto ret = aravis::send_action_command(cmd); ret != tcam::status::Success)
+    {
+        return ret;
+    }
+    return outcome::success();
+}
+
+
+void tcam::AravisBackend::report_device_lost(const std::string& serial)
+{
+    std::scoped_lock lck { monitor_mtx_ };
+    if (monitor_callbacks_.device_lost)
+    {
+        monitor_callbacks_.device_lost(serial);
+    }
+}
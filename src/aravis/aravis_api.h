@@ -18,6 +18,15 @@
 
 #include "../devicelibrary.h"
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace tcam::tools::gige_daemon
+{
+struct tcam_gige_device_list;
+}
+
 namespace tcam
 {
 
@@ -28,13 +37,37 @@ public:
     TCAM_DEVICE_TYPE get_type() const final {return TCAM_DEVICE_TYPE_ARAVIS;};
     std::shared_ptr<DeviceInterface> open_device (const tcam::DeviceInfo&) final;
     std::vector<DeviceInfo> get_device_list() final;
+    // accepts ip addresses as well, see find_gige_device
+    std::optional<DeviceInfo> find_device(const std::string& serial) final;
+
+    // Aravis cannot notice new or unplugged devices without a discovery.
+    // When a tcam-gige-daemon runs, its changes are reported, otherwise only lost devices are.
+    // These are the open devices that emit control-lost, i.e. that missed their heartbeats.
+    bool start_monitoring(const backend_monitor_callbacks& callbacks) final;
+    void stop_monitoring() final;
+
+    // UDP broadcast on all interfaces, see aravis::send_action_command
+    outcome::result<void> send_action_command(const tcam_action_command& cmd) final;
 
-    static BackendInterface* get_instance()
+    // called by AravisDevice
+    void report_device_lost(const std::string& serial);
+
+    static AravisBackend* get_instance()
     {
         static AravisBackend b;
         return &b;
     };
 
+private:
+    void monitor_gige_daemon();
+
+    std::mutex monitor_mtx_;
+    backend_monitor_callbacks monitor_callbacks_;
+
+    std::atomic<bool> run_daemon_monitor_ = false;
+    tcam::tools::gige_daemon::tcam_gige_device_list* daemon_list_ = nullptr;
+    std::thread daemon_monitor_thread_;
+
 };
 
 } // namespace tcam
@@ -0,0 +1,296 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "aravis_bandwidth_manager.h"
+
+#include "../logging.h"
+#include "../utils.h"
+#include "aravis_utils.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace
+{
+// IP (20) + UDP (8) + GVSP (8) headers, these are part of GevSCPSPacketSize
+constexpr uint64_t gvsp_packet_header_size = 36;
+// Ethernet header (14) + FCS (4) + preamble (8) + inter frame gap (12)
+constexpr uint64_t ethernet_overhead = 38;
+
+constexpr uint64_t default_link_speed_bps = 1'000'000'000;
+
+uint64_t calc_frame_bits_on_wire(const tcam::aravis::stream_bandwidth_request& req) noexcept
+{
+    const uint64_t data_per_packet = req.packet_size - gvsp_packet_header_size;
+    // + leader and trailer
+    const uint64_t packets = (req.payload_size + data_per_packet - 1) / data_per_packet + 2;
+    return packets * (req.packet_size + ethernet_overhead) * 8;
+}
+
+uint64_t read_link_speed_bps(const std::string& interface_name)
+{
+    std::ifstream file("/sys/class/net/" + interface_name + "/speed");
+
+    // in Mbit/s, -1 when the link is down or the driver does not know
+    long long speed_mbps = -1;
+    if (!(file >> speed_mbps) || speed_mbps <= 0)
+    {
+        return default_link_speed_bps;
+    }
+    return static_cast<uint64_t>(speed_mbps) * 1'000'000;
+}
+
+uint64_t get_usable_bandwidth(uint64_t link_speed_bps)
+{
+    const int percent = std::clamp(
+        tcam::get_environment_variable_int("TCAM_GIGE_BANDWIDTH_USAGE").value_or(90), 1, 100);
+    return link_speed_bps / 100 * percent;
+}
+} // namespace
+
+
+std::vector<tcam::aravis::stream_bandwidth_budget> tcam::aravis::calc_stream_budgets(
+    const std::vector<stream_bandwidth_request>& requests,
+    uint64_t link_speed_bps,
+    uint64_t usable_bps)
+{
+    std::vector<double> needed_bps;
+    needed_bps.reserve(requests.size());
+    for (const auto& req : requests)
+    {
+        if (req.packet_size <= gvsp_packet_header_size || req.framerate <= 0.0)
+        {
+            needed_bps.push_back(static_cast<double>(usable_bps));
+            continue;
+        }
+        needed_bps.push_back(static_cast<double>(calc_frame_bits_on_wire(req)) * req.framerate);
+    }
+
+    double needed_sum = 0.0;
+    for (auto bps : needed_bps) { needed_sum += bps; }
+
+    std::vector<stream_bandwidth_budget> rval(requests.size());
+    if (needed_sum <= 0.0 || link_speed_bps == 0)
+    {
+        return rval;
+    }
+
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        const auto& req = requests[i];
+        if (req.packet_size <= gvsp_packet_header_size)
+        {
+            continue;
+        }
+
+        const double share_bps = static_cast<double>(usable_bps) * needed_bps[i] / needed_sum;
+        const double packet_bits = static_cast<double>((req.packet_size + ethernet_overhead) * 8);
+
+        // the camera sends a packet at link speed, then waits, so that it averages to share_bps
+        const double delay_s =
+            packet_bits / share_bps - packet_bits / static_cast<double>(link_speed_bps);
+
+        rval[i].packet_delay_ns = std::max<int64_t>(0, static_cast<int64_t>(delay_s * 1e9));
+        rval[i].max_framerate = share_bps / static_cast<double>(calc_frame_bits_on_wire(req));
+    }
+    return rval;
+}
+
+
+tcam::aravis::BandwidthManager& tcam::aravis::BandwidthManager::get_instance()
+{
+    static BandwidthManager instance;
+    return instance;
+}
+
+
+uint64_t tcam::aravis::BandwidthManager::register_stream(ArvCamera* camera)
+{
+    if (tcam::get_environment_variable_int("TCAM_GIGE_BANDWIDTH_MANAGER").value_or(1) == 0)
+    {
+        return 0;
+    }
+    if (!arv_camera_is_gv_device(camera))
+    {
+        return 0;
+    }
+
+    stream_entry entry;
+    entry.interface_name = get_interface_name(camera);
+    if (entry.interface_name.empty())
+    {
+        SPDLOG_DEBUG("Unable to determine the network interface of the camera. The stream "
+                     "bandwidth is not managed.");
+        return 0;
+    }
+
+    GError* err = nullptr;
+    entry.request.payload_size = arv_camera_get_payload(camera, &err);
+    if (err)
+    {
+        SPDLOG_WARN("Unable to retrieve payload: {}", err->message);
+        g_clear_error(&err);
+        return 0;
+    }
+    entry.request.packet_size = arv_camera_gv_get_packet_size(camera, &err);
+    if (err)
+    {
+        SPDLOG_WARN("Unable to retrieve packet size: {}", err->message);
+        g_clear_error(&err);
+        return 0;
+    }
+
+    entry.can_set_framerate =
+        arv_camera_is_feature_available(camera, "AcquisitionFrameRate", &err);
+    g_clear_error(&err);
+    if (entry.can_set_framerate)
+    {
+        entry.request.framerate = arv_camera_get_float(camera, "AcquisitionFrameRate", &err);
+        if (err)
+        {
+            entry.can_set_framerate = false;
+            entry.request.framerate = 0.0;
+            g_clear_error(&err);
+        }
+    }
+
+    entry.camera = ARV_CAMERA(g_object_ref(camera));
+
+    std::scoped_lock lck { mtx_ };
+
+    entry.id = next_id_++;
+    entries_.push_back(entry);
+
+    rebalance(entry.interface_name);
+
+    return entry.id;
+}
+
+
+void tcam::aravis::BandwidthManager::unregister_stream(uint64_t id)
+{
+    if (id == 0)
+    {
+        return;
+    }
+
+    std::scoped_lock lck { mtx_ };
+
+    auto iter = std::find_if(
+        entries_.begin(), entries_.end(), [id](const stream_entry& e) { return e.id == id; });
+    if (iter == entries_.end())
+    {
+        return;
+    }
+
+    if (iter->framerate_lowered)
+    {
+        GError* err = nullptr;
+        arv_camera_set_float(iter->camera, "AcquisitionFrameRate", iter->request.framerate, &err);
+        g_clear_error(&err);
+    }
+
+    const std::string interface_name = iter->interface_name;
+    g_object_unref(iter->camera);
+    entries_.erase(iter);
+
+    rebalance(interface_name);
+}
+
+
+void tcam::aravis::BandwidthManager::rebalance(const std::string& interface_name)
+{
+    std::vector<stream_entry*> streams;
+    std::vector<stream_bandwidth_request> requests;
+    for (auto& e : entries_)
+    {
+        if (e.interface_name == interface_name)
+        {
+            streams.push_back(&e);
+            requests.push_back(e.request);
+        }
+    }
+    if (streams.empty())
+    {
+        return;
+    }
+
+    const uint64_t link_speed_bps = read_link_speed_bps(interface_name);
+    const auto budgets =
+        calc_stream_budgets(requests, link_speed_bps, get_usable_bandwidth(link_speed_bps));
+
+    SPDLOG_INFO("Distributing {} Mbit/s of '{}' between {} streams",
+                get_usable_bandwidth(link_speed_bps) / 1'000'000,
+                interface_name,
+                streams.size());
+
+    // only aravis is called here, the cameras are not locked, so this cannot dead lock with a
+    // device that starts or stops its stream at the same time
+    for (size_t i = 0; i < streams.size(); ++i)
+    {
+        auto& e = *streams[i];
+        const auto& budget = budgets[i];
+
+        GError* err = nullptr;
+        arv_camera_gv_set_packet_delay(e.camera, budget.packet_delay_ns, &err);
+        if (err)
+        {
+            SPDLOG_WARN("Unable to set packet delay: {}", err->message);
+            g_clear_error(&err);
+        }
+        else
+        {
+            SPDLOG_DEBUG("Set packet delay to {} ns", budget.packet_delay_ns);
+        }
+
+        if (!e.can_set_framerate || e.request.framerate <= 0.0)
+        {
+            continue;
+        }
+
+        if (budget.max_framerate < e.request.framerate)
+        {
+            arv_camera_set_float(e.camera, "AcquisitionFrameRate", budget.max_framerate, &err);
+            if (err)
+            {
+                SPDLOG_WARN("Unable to lower the frame rate to {}: {}",
+                            budget.max_framerate,
+                            err->message);
+                g_clear_error(&err);
+                continue;
+            }
+            SPDLOG_WARN("'{}' is oversubscribed. Lowered frame rate from {} to {}",
+                        interface_name,
+                        e.request.framerate,
+                        budget.max_framerate);
+            e.framerate_lowered = true;
+        }
+        else if (e.framerate_lowered)
+        {
+            arv_camera_set_float(e.camera, "AcquisitionFrameRate", e.request.framerate, &err);
+            if (err)
+            {
+                SPDLOG_WARN("Unable to restore the frame rate to {}: {}",
+                            e.request.framerate,
+                            err->message);
+                g_clear_error(&err);
+                continue;
+            }
+            SPDLOG_INFO("Restored frame rate to {}", e.request.framerate);
+            e.framerate_lowered = false;
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <arv.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tcam::aravis
+{
+
+struct stream_bandwidth_request
+{
+    uint64_t payload_size = 0; // bytes per frame
+    uint64_t packet_size = 0; // GevSCPSPacketSize, includes the IP/UDP/GVSP headers
+    double framerate = 0.0; // 0 when unknown, the stream then asks for the whole link
+};
+
+struct stream_bandwidth_budget
+{
+    int64_t packet_delay_ns = 0;
+    double max_framerate = 0.0;
+};
+
+// Splits usable_bps between the streams, proportional to the bandwidth they need on the wire.
+// The result has one entry per request.
+std::vector<stream_bandwidth_budget> calc_stream_budgets(
+    const std::vector<stream_bandwidth_request>& requests,
+    uint64_t link_speed_bps,
+    uint64_t usable_bps);
+
+
+/*
+ * Coordinates the GigE streams that share a network interface.
+ *
+ * Each stream gets a share of the link proportional to what it needs. The share is enforced by the
+ * inter-packet delay (GevSCPD), so that the bursts of different cameras do not overflow the switch
+ * and the NIC. When the interface is oversubscribed, the frame rate of the cameras is lowered to
+ * what fits into their share and restored once other streams stop.
+ * Budgets are recalculated every time a stream on the interface starts or stops.
+ *
+ * TCAM_GIGE_BANDWIDTH_MANAGER=0 disables this, TCAM_GIGE_BANDWIDTH_USAGE sets the percentage of
+ * the link speed that is distributed (default 90).
+ */
+class BandwidthManager
+{
+public:
+    static BandwidthManager& get_instance();
+
+    // Has to be called after the stream format is set, before the acquisition starts.
+    // Returns the id for unregister_stream, 0 when the camera is not managed.
+    uint64_t register_stream(ArvCamera* camera);
+    void unregister_stream(uint64_t id);
+
+private:
+    struct stream_entry
+    {
+        uint64_t id = 0;
+        ArvCamera* camera = nullptr; // holds a reference
+        std::string interface_name;
+        stream_bandwidth_request request;
+        bool can_set_framerate = false;
+        bool framerate_lowered = false;
+    };
+
+    void rebalance(const std::string& interface_name);
+
+    std::mutex mtx_;
+    std::vector<stream_entry> entries_;
+    uint64_t next_id_ = 1;
+};
+
+} // namespace tcam::aravis
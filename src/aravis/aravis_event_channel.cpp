@@ -0,0 +1,226 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "aravis_event_channel.h"
+
+#include "../logging.h"
+#include "../ThreadPolicy.h"
+#include "../utils.h"
+
+#include <algorithm>
+#include <arpa/inet.h> // inet_pton
+#include <cerrno>
+#include <cstring> // strerror
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h> // close
+
+namespace
+{
+
+// GigE Vision 2.0, 16.6
+constexpr uint8_t gvcp_magic = 0x42;
+constexpr uint16_t event_cmd = 0x00C0;
+constexpr uint16_t event_ack = 0x00C1;
+constexpr uint16_t eventdata_cmd = 0x00C2;
+
+constexpr uint8_t flag_ack_required = 0x01;
+constexpr uint8_t flag_extended_id = 0x10;
+
+constexpr size_t header_size = 8;
+// the first field is reserved in GigE Vision 1.x and the event size in 2.0
+constexpr size_t event_size = 16;
+constexpr size_t extended_event_size = 24;
+
+uint16_t get16(const uint8_t* p) noexcept
+{
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t get32(const uint8_t* p) noexcept
+{
+    return (static_cast<uint32_t>(get16(p)) << 16) | get16(p + 2);
+}
+
+uint64_t get64(const uint8_t* p) noexcept
+{
+    return (static_cast<uint64_t>(get32(p)) << 32) | get32(p + 4);
+}
+
+} // namespace
+
+
+bool tcam::aravis::parse_event_packet(const uint8_t* packet,
+                                      size_t size,
+                                      std::vector<gvcp_event>& events,
+                                      uint16_t& ack_id)
+{
+    ack_id = 0;
+    if (size < header_size || packet[0] != gvcp_magic)
+    {
+        return false;
+    }
+
+    const uint8_t flags = packet[1];
+    const uint16_t command = get16(packet + 2);
+    if (command != event_cmd && command != eventdata_cmd)
+    {
+        return false;
+    }
+
+    if (flags & flag_ack_required)
+    {
+        ack_id = get16(packet + 6);
+    }
+
+    const bool extended = flags & flag_extended_id;
+    const size_t min_size = extended ? extended_event_size : event_size;
+
+    const size_t length = std::min<size_t>(get16(packet + 4), size - header_size);
+    const uint8_t* p = packet + header_size;
+    const uint8_t* end = p + length;
+
+    while (static_cast<size_t>(end - p) >= min_size)
+    {
+        gvcp_event ev;
+        ev.event_id = get16(p + 2);
+        ev.stream_channel = get16(p + 4);
+        if (extended)
+        {
+            ev.block_id = get64(p + 8);
+            ev.timestamp = get64(p + 16);
+        }
+        else
+        {
+            ev.block_id = get16(p + 6);
+            ev.timestamp = get64(p + 8);
+        }
+        events.push_back(ev);
+
+        // EVENTDATA_CMD carries a single event followed by its data
+        if (command == eventdata_cmd)
+        {
+            break;
+        }
+        p += std::max<size_t>(get16(p), min_size);
+    }
+    return true;
+}
+
+
+uint16_t tcam::aravis::EventChannel::start(const std::string& interface_address, callback cb)
+{
+    stop();
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = 0;
+    if (inet_pton(AF_INET, interface_address.c_str(), &addr.sin_addr) != 1)
+    {
+        SPDLOG_ERROR("Invalid interface address '{}' for the event channel.", interface_address);
+        return 0;
+    }
+
+    fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd_ < 0)
+    {
+        SPDLOG_ERROR("Unable to create the event channel socket: {}", strerror(errno));
+        return 0;
+    }
+
+    socklen_t len = sizeof(addr);
+    if (bind(fd_, (sockaddr*)&addr, sizeof(addr)) != 0
+        || getsockname(fd_, (sockaddr*)&addr, &len) != 0)
+    {
+        SPDLOG_ERROR(
+            "Unable to bind the event channel to {}: {}", interface_address, strerror(errno));
+        close(fd_);
+        fd_ = -1;
+        return 0;
+    }
+
+    callback_ = std::move(cb);
+    stop_ = false;
+    thread_ = std::thread(&EventChannel::receive_thread_main, this);
+
+    return ntohs(addr.sin_port);
+}
+
+
+void tcam::aravis::EventChannel::stop()
+{
+    if (fd_ < 0)
+    {
+        return;
+    }
+
+    stop_ = true;
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+    close(fd_);
+    fd_ = -1;
+    callback_ = nullptr;
+}
+
+
+void tcam::aravis::EventChannel::receive_thread_main()
+{
+    tcam::thread_policy::setup_thread("tcam_arv_event");
+
+    // the poll timeout is only the reaction time of stop
+    constexpr int poll_timeout_ms = 100;
+
+    uint8_t packet[576];
+    std::vector<gvcp_event> events;
+
+    while (!stop_)
+    {
+        pollfd pfd = { fd_, POLLIN, 0 };
+        if (poll(&pfd, 1, poll_timeout_ms) <= 0)
+        {
+            continue;
+        }
+
+        sockaddr_in sender = {};
+        socklen_t len = sizeof(sender);
+        auto size = recvfrom(fd_, packet, sizeof(packet), 0, (sockaddr*)&sender, &len);
+        if (size <= 0)
+        {
+            continue;
+        }
+
+        events.clear();
+        uint16_t ack_id = 0;
+        if (!parse_event_packet(packet, size, events, ack_id))
+        {
+            continue;
+        }
+
+        // acknowledge first, the device resends unacknowledged events after GevMCTT
+        if (ack_id != 0)
+        {
+            const uint8_t ack[header_size] = {
+                0, 0, event_ack >> 8, event_ack & 0xFF, 0, 0, uint8_t(ack_id >> 8), uint8_t(ack_id),
+            };
+            sendto(fd_, ack, sizeof(ack), 0, (sockaddr*)&sender, len);
+        }
+
+        for (const auto& ev : events) { callback_(ev); }
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tcam::aravis
+{
+
+// event of a GVCP EVENT_CMD or EVENTDATA_CMD, GigE Vision 2.0, 16.6
+struct gvcp_event
+{
+    uint16_t event_id = 0;
+    uint16_t stream_channel = 0;
+    uint64_t block_id = 0;
+    uint64_t timestamp = 0; // in ticks of the device clock
+};
+
+// Appends the events of packet to events.
+// Returns false when packet is no event command. ack_id is set when the device wants an
+// acknowledge, 0 otherwise.
+bool parse_event_packet(const uint8_t* packet,
+                        size_t size,
+                        std::vector<gvcp_event>& events,
+                        uint16_t& ack_id);
+
+
+/*
+ * Receives the events a GigE device sends on its message channel.
+ *
+ * Aravis does not open the message channel, this is a separate UDP socket with its own thread,
+ * so that events reach the callback without waiting for the control channel or the stream.
+ * The owner writes the port to GevMCPHostPort/GevMCDA and enables the events.
+ */
+class EventChannel
+{
+public:
+    using callback = std::function<void(const gvcp_event&)>;
+
+    EventChannel() = default;
+    EventChannel(const EventChannel&) = delete;
+    EventChannel& operator=(const EventChannel&) = delete;
+
+    ~EventChannel()
+    {
+        stop();
+    }
+
+    // Binds a socket to interface_address and starts the receive thread.
+    // Returns the port, 0 on error.
+    uint16_t start(const std::string& interface_address, callback cb);
+    void stop();
+
+    bool is_running() const noexcept
+    {
+        return fd_ >= 0;
+    }
+
+private:
+    void receive_thread_main();
+
+    int fd_ = -1;
+    callback callback_;
+    std::thread thread_;
+    std::atomic<bool> stop_ = false;
+};
+
+} // namespace tcam::aravis
@@ -0,0 +1,291 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "aravis_format_cache.h"
+
+#include "../../external/json/json.hpp"
+#include "../logging.h"
+#include "../utils.h"
+
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+using json = nlohmann::json;
+
+namespace
+{
+// increment when the layout of the entries changes
+constexpr int format_cache_version = 1;
+
+std::filesystem::path get_cache_dir()
+{
+    auto dir = tcam::get_environment_variable("TCAM_FORMAT_CACHE_DIR", "");
+    if (!dir.empty())
+    {
+        return dir;
+    }
+    dir = tcam::get_environment_variable("XDG_CACHE_HOME", "");
+    if (!dir.empty())
+    {
+        return std::filesystem::path(dir) / "tiscamera";
+    }
+    dir = tcam::get_environment_variable("HOME", "");
+    if (!dir.empty())
+    {
+        return std::filesystem::path(dir) / ".cache" / "tiscamera";
+    }
+    return {};
+}
+
+std::filesystem::path get_cache_file(const std::string& key)
+{
+    auto dir = get_cache_dir();
+    if (dir.empty())
+    {
+        return {};
+    }
+    return dir / ("formats-" + key + ".json");
+}
+
+// FNV-1a, stable across builds, unlike std::hash
+uint64_t hash_data(const char* data, size_t size) noexcept
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// keeps the key usable as a file name
+std::string sanitize(std::string str)
+{
+    for (auto& c : str)
+    {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '_')
+        {
+            c = '_';
+        }
+    }
+    return str;
+}
+
+std::string get_string_feature(ArvDevice* dev, const char* name)
+{
+    GError* err = nullptr;
+    const char* value = arv_device_get_string_feature_value(dev, name, &err);
+    if (err)
+    {
+        g_clear_error(&err);
+        return {};
+    }
+    return value ? value : "";
+}
+
+json to_json(const tcam::VideoFormatDescription& desc)
+{
+    json resolutions = json::array();
+    for (const auto& m : desc.get_framerate_mappings())
+    {
+        const auto& r = m.resolution;
+        resolutions.push_back({
+            { "type", static_cast<int>(r.type) },
+            { "min", { r.min_size.width, r.min_size.height } },
+            { "max", { r.max_size.width, r.max_size.height } },
+            { "step", { r.width_step_size, r.height_step_size } },
+            { "scaling",
+              { r.scaling.binning_h, r.scaling.binning_v, r.scaling.skipping_h, r.scaling.skipping_v } },
+            { "framerates", m.framerates },
+        });
+    }
+
+    const auto& fmt = desc.get_format_description();
+    return { { "fourcc", fmt.fourcc },
+             { "description", fmt.description },
+             { "resolutions", resolutions } };
+}
+
+tcam::VideoFormatDescription from_json(const json& j)
+{
+    tcam::tcam_video_format_description desc = {};
+    desc.fourcc = j.at("fourcc").get<uint32_t>();
+    const auto description = j.at("description").get<std::string>();
+    strncpy(desc.description, description.c_str(), sizeof(desc.description) - 1);
+
+    std::vector<tcam::framerate_mapping> mappings;
+    for (const auto& res : j.at("resolutions"))
+    {
+        tcam::framerate_mapping m = {};
+        auto& r = m.resolution;
+        r.type = static_cast<tcam::TCAM_RESOLUTION_TYPE>(res.at("type").get<int>());
+        r.min_size = { res.at("min").at(0).get<uint32_t>(), res.at("min").at(1).get<uint32_t>() };
+        r.max_size = { res.at("max").at(0).get<uint32_t>(), res.at("max").at(1).get<uint32_t>() };
+        r.width_step_size = res.at("step").at(0).get<unsigned int>();
+        r.height_step_size = res.at("step").at(1).get<unsigned int>();
+
+        const auto& scaling = res.at("scaling");
+        r.scaling.binning_h = scaling.at(0).get<int32_t>();
+        r.scaling.binning_v = scaling.at(1).get<int32_t>();
+        r.scaling.skipping_h = scaling.at(2).get<int32_t>();
+        r.scaling.skipping_v = scaling.at(3).get<int32_t>();
+
+        m.framerates = res.at("framerates").get<std::vector<double>>();
+
+        mappings.push_back(m);
+    }
+    return tcam::VideoFormatDescription(nullptr, desc, mappings);
+}
+
+} // namespace
+
+
+std::string tcam::aravis::get_format_cache_key(ArvCamera* camera)
+{
+    if (tcam::get_environment_variable_int("TCAM_FORMAT_CACHE").value_or(1) == 0)
+    {
+        return {};
+    }
+
+    auto dev = arv_camera_get_device(camera);
+    if (dev == nullptr)
+    {
+        return {};
+    }
+
+    size_t xml_size = 0;
+    const char* xml = arv_device_get_genicam_xml(dev, &xml_size);
+    if (xml == nullptr || xml_size == 0)
+    {
+        return {};
+    }
+
+    auto model = get_string_feature(dev, "DeviceModelName");
+    auto firmware = get_string_feature(dev, "DeviceFirmwareVersion");
+    if (firmware.empty())
+    {
+        firmware = get_string_feature(dev, "DeviceVersion");
+    }
+    if (model.empty() || firmware.empty())
+    {
+        return {};
+    }
+
+    return fmt::format(
+        "{}-{}-{:016x}", sanitize(model), sanitize(firmware), hash_data(xml, xml_size));
+}
+
+
+std::optional<std::vector<tcam::VideoFormatDescription>> tcam::aravis::load_format_cache(
+    const std::string& key)
+{
+    if (key.empty())
+    {
+        return std::nullopt;
+    }
+
+    const auto file_path = get_cache_file(key);
+    if (file_path.empty())
+    {
+        return std::nullopt;
+    }
+
+    std::ifstream file(file_path);
+    if (!file)
+    {
+        return std::nullopt;
+    }
+
+    try
+    {
+        json j = json::parse(file);
+        if (j.at("version").get<int>() != format_cache_version)
+        {
+            return std::nullopt;
+        }
+
+        std::vector<tcam::VideoFormatDescription> rval;
+        for (const auto& f : j.at("formats")) { rval.push_back(from_json(f)); }
+
+        if (rval.empty())
+        {
+            return std::nullopt;
+        }
+
+        SPDLOG_DEBUG("Loaded {} video formats from '{}'", rval.size(), file_path.string());
+        return rval;
+    }
+    catch (const std::exception& ex)
+    {
+        SPDLOG_WARN("Ignoring invalid format cache '{}': {}", file_path.string(), ex.what());
+    }
+    return std::nullopt;
+}
+
+
+void tcam::aravis::store_format_cache(const std::string& key,
+                                      const std::vector<tcam::VideoFormatDescription>& formats)
+{
+    if (key.empty() || formats.empty())
+    {
+        return;
+    }
+
+    const auto file_path = get_cache_file(key);
+    if (file_path.empty())
+    {
+        return;
+    }
+
+    json j;
+    j["version"] = format_cache_version;
+    j["formats"] = json::array();
+    for (const auto& f : formats) { j["formats"].push_back(to_json(f)); }
+
+    std::error_code ec;
+    std::filesystem::create_directories(file_path.parent_path(), ec);
+    if (ec)
+    {
+        SPDLOG_DEBUG("Unable to create format cache directory '{}': {}",
+                     file_path.parent_path().string(),
+                     ec.message());
+        return;
+    }
+
+    // other processes may read the file at the same time, so it is replaced in one step
+    auto tmp_path = file_path;
+    tmp_path += fmt::format(".{}.tmp", getpid());
+    {
+        std::ofstream file(tmp_path);
+        if (!(file << j.dump()))
+        {
+            SPDLOG_DEBUG("Unable to write format cache '{}'", tmp_path.string());
+            std::filesystem::remove(tmp_path, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tmp_path, file_path, ec);
+    if (ec)
+    {
+        SPDLOG_DEBUG("Unable to write format cache '{}': {}", file_path.string(), ec.message());
+        std::filesystem::remove(tmp_path, ec);
+    }
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../VideoFormatDescription.h"
+
+#include <arv.h>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace tcam::aravis
+{
+
+/*
+ * On disk cache of the video formats generated from a GenICam camera.
+ *
+ * Probing the formats sets every pixel format and scaling and reads the resulting bounds and
+ * frame rates, which takes seconds over the network. The result only depends on the model, the
+ * firmware and the GenICam description, which together form the key of a cache entry.
+ *
+ * Entries are stored in $TCAM_FORMAT_CACHE_DIR, $XDG_CACHE_HOME/tiscamera or
+ * $HOME/.cache/tiscamera. TCAM_FORMAT_CACHE=0 disables the cache.
+ */
+
+// Returns an empty string when the cache is disabled or the key cannot be determined
+std::string get_format_cache_key(ArvCamera* camera);
+
+std::optional<std::vector<tcam::VideoFormatDescription>> load_format_cache(const std::string& key);
+
+void store_format_cache(const std::string& key,
+                        const std::vector<tcam::VideoFormatDescription>& formats);
+
+} // namespace tcam::aravis
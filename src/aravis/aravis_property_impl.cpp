@@ -41,7 +41,7 @@ tcamprop1::prop_static_info_str get_static_feature_node_info(ArvGcFeatureNode* n
     rval.display_name = to_stdstring(arv_gc_feature_node_get_display_name(node));
     rval.description = to_stdstring(arv_gc_feature_node_get_description(node));
     rval.visibility = to_Visibility(arv_gc_feature_node_get_visibility(node));
-    rval.access = to_Access(arv_gc_feature_node_get_actual_access_mode(node));
+    // access is filled in by prop_base_impl, which already evaluated it
     return rval;
 }
 
@@ -212,11 +212,23 @@ tcam::property::PropertyFlags arv_gc_get_tcam_flags(ArvGcFeatureNode* node,
 
     return flags;
 }
+bool has_pIsLocked(ArvGcFeatureNode* node)
+{
+    for (auto child = arv_dom_node_get_first_child(ARV_DOM_NODE(node)); child != nullptr;
+         child = arv_dom_node_get_next_sibling(child))
+    {
+        if (g_strcmp0(arv_dom_node_get_node_name(child), "pIsLocked") == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
 } // namespace
 
 tcam::property::PropertyFlags prop_base_impl::get_flags_impl() const
 {
-    aravis_backend_guard lck = acquire_backend_guard();
+    aravis_backend_guard lck = acquire_read_guard(read_kind::flags);
     if (!lck)
     {
         return tcam::property::PropertyFlags::None;
@@ -230,11 +242,19 @@ aravis_backend_guard prop_base_impl::acquire_backend_guard() const noexcept
     return aravis_backend_guard { backend_ };
 }
 
+aravis_backend_guard prop_base_impl::acquire_read_guard(read_kind kind) const noexcept
+{
+    return aravis_backend_guard { backend_,
+                                  has_locked_value_,
+                                  read_generation_[static_cast<int>(kind)] };
+}
+
 tcamprop1::prop_static_info_str prop_base_impl::build_static_info(
     std::string_view category,
     std::string_view name_override) const noexcept
 {
     auto res = get_static_feature_node_info(feature_node_);
+    res.access = access_mode_;
     if (!name_override.empty())
         res.name = name_override;
     res.iccategory = category;
@@ -246,6 +266,7 @@ prop_base_impl::prop_base_impl(const std::shared_ptr<AravisPropertyBackend>& cam
     : backend_ { cam }, feature_node_ { feature_node }
 {
     access_mode_ = to_Access(arv_gc_feature_node_get_actual_access_mode(feature_node_));
+    has_locked_value_ = has_pIsLocked(feature_node_);
 }
 
 AravisPropertyIntegerImpl::AravisPropertyIntegerImpl(
@@ -265,7 +286,7 @@ AravisPropertyIntegerImpl::AravisPropertyIntegerImpl(
 
 outcome::result<int64_t> AravisPropertyIntegerImpl::get_value() const
 {
-    aravis_backend_guard lck = acquire_backend_guard();
+    aravis_backend_guard lck = acquire_read_guard(read_kind::value);
     if (!lck)
     {
         SPDLOG_ERROR("Unable to lock backend.");
@@ -292,12 +313,13 @@ outcome::result<void> AravisPropertyIntegerImpl::set_value(int64_t new_value)
     arv_gc_integer_set_value(arv_gc_node_, new_value, &err);
     if (err)
         return consume_GError(err);
+    lck.notify_changed(get_name());
     return outcome::success();
 }
 
 tcamprop1::prop_range_integer AravisPropertyIntegerImpl::get_range() const
 {
-    aravis_backend_guard lck = acquire_backend_guard();
+    aravis_backend_guard lck = acquire_read_guard(read_kind::range);
     if (!lck)
     {
         return {};
@@ -361,12 +383,13 @@ outcome::result<void> AravisPropertyDoubleImpl::set_value(double new_value)
     arv_gc_float_set_value(arv_gc_node_, new_value, &err);
     if (err)
         return consume_GError(err);
+    lck.notify_changed(get_name());
     return outcome::success();
 }
 
 outcome::result<double> AravisPropertyDoubleImpl::get_value() const
 {
-    auto lck = acquire_backend_guard();
+    auto lck = acquire_read_guard(read_kind::value);
     if (!lck)
     {
         SPDLOG_ERROR("Unable to lock backend.");
@@ -381,7 +404,7 @@ outcome::result<double> AravisPropertyDoubleImpl::get_value() const
 
 tcamprop1::prop_range_float AravisPropertyDoubleImpl::get_range() const
 {
-    aravis_backend_guard lck = acquire_backend_guard();
+    aravis_backend_guard lck = acquire_read_guard(read_kind::range);
     if (!lck)
     {
         SPDLOG_ERROR("Unable to lock backend.");
@@ -426,7 +449,7 @@ AravisPropertyBoolImpl::AravisPropertyBoolImpl(
 
 outcome::result<bool> AravisPropertyBoolImpl::get_value() const
 {
-    auto lck = acquire_backend_guard();
+    auto lck = acquire_read_guard(read_kind::value);
     if (!lck)
     {
         SPDLOG_ERROR("Unable to lock backend.");
@@ -452,6 +475,7 @@ outcome::result<void> AravisPropertyBoolImpl::set_value(bool new_value)
     arv_gc_boolean_set_value(arv_gc_node_, new_value, &err);
     if (err)
         return consume_GError(err);
+    lck.notify_changed(get_name());
     return outcome::success();
 }
 
@@ -478,7 +502,10 @@ outcome::result<void> AravisPropertyCommandImpl::execute()
     }
     GError* err = nullptr;
     arv_gc_command_execute(arv_gc_node_, &err);
-    return consume_GError(err);
+    if (err)
+        return consume_GError(err);
+    lck.notify_changed(get_name());
+    return outcome::success();
 }
 
 
@@ -491,6 +518,17 @@ AravisPropertyEnumImpl::AravisPropertyEnumImpl(
 {
     static_info_ = build_static_info(category, name);
 
+    update_with_tcamprop1_static_info(name, static_info_, tcamprop1::prop_type::Enumeration);
+}
+
+auto AravisPropertyEnumImpl::get_enum_entries() const -> const std::vector<enum_entry>&
+{
+    std::scoped_lock lck { entries_mtx_ };
+    if (entries_resolved_)
+    {
+        return entries_;
+    }
+
     GError* err = nullptr;
     auto entries = arv_gc_enumeration_get_entries(arv_gc_node_);
     for (auto entry = entries; entry != nullptr; entry = entry->next)
@@ -513,8 +551,23 @@ AravisPropertyEnumImpl::AravisPropertyEnumImpl(
         }
         entries_.push_back(enum_entry { entry_name, value });
     }
+    entries_resolved_ = true;
 
-    update_with_tcamprop1_static_info(name, static_info_, tcamprop1::prop_type::Enumeration);
+    return entries_;
+}
+
+std::vector<std::string> AravisPropertyEnumImpl::get_entries() const
+{
+    auto lck = acquire_backend_guard();
+    if (!lck)
+    {
+        SPDLOG_ERROR("Unable to lock backend.");
+        return {};
+    }
+
+    std::vector<std::string> rval;
+    for (auto& e : get_enum_entries()) { rval.push_back(e.display_name); }
+    return rval;
 }
 
 outcome::result<std::string_view> AravisPropertyEnumImpl::get_default() const
@@ -530,7 +583,7 @@ outcome::result<void> AravisPropertyEnumImpl::set_value(std::string_view new_val
         SPDLOG_ERROR("Unable to lock backend.");
         return tcam::status::ResourceNotLockable;
     }
-    for (auto& e : entries_)
+    for (auto& e : get_enum_entries())
     {
         if (e.display_name == new_value)
         {
@@ -538,6 +591,7 @@ outcome::result<void> AravisPropertyEnumImpl::set_value(std::string_view new_val
             arv_gc_enumeration_set_int_value(arv_gc_node_, e.value, &err);
             if (err)
                 return consume_GError(err);
+            lck.notify_changed(get_name());
             return outcome::success();
         }
     }
@@ -546,7 +600,7 @@ outcome::result<void> AravisPropertyEnumImpl::set_value(std::string_view new_val
 
 outcome::result<std::string_view> AravisPropertyEnumImpl::get_value() const
 {
-    auto lck = acquire_backend_guard();
+    auto lck = acquire_read_guard(read_kind::value);
     if (!lck)
     {
         SPDLOG_ERROR("Unable to lock backend.");
@@ -557,7 +611,7 @@ outcome::result<std::string_view> AravisPropertyEnumImpl::get_value() const
     if (err)
         return consume_GError(err);
 
-    for (auto& e : entries_)
+    for (auto& e : get_enum_entries())
     {
         if (e.value == current_value)
             return e.display_name;
@@ -589,12 +643,13 @@ std::error_code AravisPropertyStringImpl::set_value(std::string_view new_value)
     arv_gc_string_set_value(arv_gc_node_, std::string { new_value }.c_str(), &err);
     if (err)
         return consume_GError(err);
+    lck.notify_changed(get_name());
     return {};
 }
 
 outcome::result<std::string> AravisPropertyStringImpl::get_value() const
 {
-    auto lck = acquire_backend_guard();
+    auto lck = acquire_read_guard(read_kind::value);
     if (!lck)
     {
         SPDLOG_ERROR("Unable to lock backend.");
@@ -792,3 +847,27 @@ std::vector<std::string> iris_auto_enum_override::get_entries() const
 {
     return std::vector<std::string> { "Off", "Continuous" };
 }
+
+ptp_latched_integer::ptp_latched_integer(const std::shared_ptr<IPropertyInteger>& value,
+                                         const std::shared_ptr<IPropertyCommand>& latch)
+    : value_(value), latch_(latch)
+{
+}
+
+outcome::result<int64_t> ptp_latched_integer::get_value() const
+{
+    OUTCOME_TRY(latch_->execute());
+    return value_->get_value();
+}
+
+ptp_latched_enum::ptp_latched_enum(const std::shared_ptr<IPropertyEnum>& value,
+                                   const std::shared_ptr<IPropertyCommand>& latch)
+    : value_(value), latch_(latch)
+{
+}
+
+outcome::result<std::string_view> ptp_latched_enum::get_value() const
+{
+    OUTCOME_TRY(latch_->execute());
+    return value_->get_value();
+}
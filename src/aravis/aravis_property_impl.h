@@ -21,6 +21,7 @@
 #include "AravisPropertyBackend.h"
 
 #include <arv.h>
+#include <mutex>
 #include <tcamprop1.0_base/tcamprop_property_info.h>
 
 VISIBILITY_INTERNAL
@@ -40,8 +41,24 @@ struct aravis_backend_guard
             backend_mtx_->lock();
         }
     }
+    // Guard for a read, selects the register cache policy, see AravisPropertyBackend::begin_read
+    aravis_backend_guard(const std::weak_ptr<AravisPropertyBackend>& cam,
+                         bool has_locked_value,
+                         uint64_t& read_generation)
+        : aravis_backend_guard(cam)
+    {
+        if (owner_)
+        {
+            restore_policy_ = owner_->begin_read(has_locked_value, read_generation);
+            restore_ = true;
+        }
+    }
     ~aravis_backend_guard()
     {
+        if (restore_)
+        {
+            owner_->end_read(restore_policy_);
+        }
         if (backend_mtx_)
         {
             backend_mtx_->unlock();
@@ -49,11 +66,20 @@ struct aravis_backend_guard
         owner_.reset();
     }
 
+    aravis_backend_guard(const aravis_backend_guard&) = delete;
+    aravis_backend_guard& operator=(const aravis_backend_guard&) = delete;
+
     explicit operator bool() const noexcept
     {
         return owner_ != nullptr;
     }
 
+    // Only valid when the guard holds the backend.
+    void notify_changed(std::string_view name) const
+    {
+        owner_->notify_changed(name);
+    }
+
     static aravis_backend_guard acquire(const std::weak_ptr<AravisPropertyBackend>& cam) noexcept
     {
         return aravis_backend_guard { cam };
@@ -62,6 +88,9 @@ struct aravis_backend_guard
 private:
     std::shared_ptr<AravisPropertyBackend> owner_;
     std::recursive_mutex* backend_mtx_ = nullptr;
+
+    bool restore_ = false;
+    ArvRegisterCachePolicy restore_policy_ = ARV_REGISTER_CACHE_POLICY_DISABLE;
 };
 
 class prop_base_impl
@@ -75,6 +104,16 @@ protected:
 
     aravis_backend_guard acquire_backend_guard() const noexcept;
 
+    // Values are cached separately, a flags read must not mark the value as read
+    enum class read_kind
+    {
+        flags,
+        value,
+        range,
+    };
+    // Guard for getters, may serve the read from the register cache
+    aravis_backend_guard acquire_read_guard(read_kind kind) const noexcept;
+
     tcamprop1::prop_static_info_str build_static_info(
         std::string_view category,
         std::string_view name_override) const noexcept;
@@ -89,6 +128,10 @@ private:
     ArvGcFeatureNode* feature_node_ = nullptr;
 
     tcamprop1::Access_t access_mode_ = tcamprop1::Access_t::RW;
+
+    // the feature has a pIsLocked, so its value only changes through writes
+    bool has_locked_value_ = false;
+    mutable uint64_t read_generation_[3] = {};
 };
 
 class AravisPropertyIntegerImpl : public prop_base_impl, public IPropertyInteger
@@ -254,12 +297,7 @@ public:
 
     outcome::result<std::string_view> get_default() const final;
 
-    std::vector<std::string> get_entries() const final
-    {
-        std::vector<std::string> rval;
-        for (auto& e : entries_) { rval.push_back(e.display_name); }
-        return rval;
-    }
+    std::vector<std::string> get_entries() const final;
 
 private:
     tcamprop1::prop_static_info_str static_info_;
@@ -271,7 +309,13 @@ private:
         int64_t value;
     };
 
-    std::vector<enum_entry> entries_;
+    // Entry values may be backed by registers, so they are read on first use instead of when
+    // the property list is built. The backend lock has to be held by the caller.
+    const std::vector<enum_entry>& get_enum_entries() const;
+
+    mutable std::mutex entries_mtx_;
+    mutable bool entries_resolved_ = false;
+    mutable std::vector<enum_entry> entries_;
 };
 
 
@@ -426,6 +470,84 @@ private:
     std::shared_ptr<IPropertyBool> property_to_override_;
 };
 
+// PtpStatus and PtpOffsetFromMaster only change with PtpDataSetLatch,
+// these execute the latch before every read.
+class ptp_latched_integer : public IPropertyInteger
+{
+public:
+    ptp_latched_integer(const std::shared_ptr<IPropertyInteger>& value,
+                        const std::shared_ptr<IPropertyCommand>& latch);
+
+    tcamprop1::prop_static_info get_static_info() const final
+    {
+        return value_->get_static_info();
+    }
+    PropertyFlags get_flags() const final
+    {
+        return value_->get_flags();
+    }
+    std::string_view get_unit() const final
+    {
+        return value_->get_unit();
+    }
+    tcamprop1::IntRepresentation_t get_representation() const final
+    {
+        return value_->get_representation();
+    }
+    tcamprop1::prop_range_integer get_range() const final
+    {
+        return value_->get_range();
+    }
+    outcome::result<int64_t> get_default() const final
+    {
+        return value_->get_default();
+    }
+
+    outcome::result<int64_t> get_value() const final;
+    outcome::result<void> set_value(int64_t new_value) final
+    {
+        return value_->set_value(new_value);
+    }
+
+private:
+    std::shared_ptr<IPropertyInteger> value_;
+    std::shared_ptr<IPropertyCommand> latch_;
+};
+
+class ptp_latched_enum : public IPropertyEnum
+{
+public:
+    ptp_latched_enum(const std::shared_ptr<IPropertyEnum>& value,
+                     const std::shared_ptr<IPropertyCommand>& latch);
+
+    tcamprop1::prop_static_info get_static_info() const final
+    {
+        return value_->get_static_info();
+    }
+    PropertyFlags get_flags() const final
+    {
+        return value_->get_flags();
+    }
+
+    outcome::result<void> set_value(std::string_view new_value) final
+    {
+        return value_->set_value(new_value);
+    }
+    outcome::result<std::string_view> get_value() const final;
+    outcome::result<std::string_view> get_default() const final
+    {
+        return value_->get_default();
+    }
+    std::vector<std::string> get_entries() const final
+    {
+        return value_->get_entries();
+    }
+
+private:
+    std::shared_ptr<IPropertyEnum> value_;
+    std::shared_ptr<IPropertyCommand> latch_;
+};
+
 } // namespace tcam::aravis
 
 VISIBILITY_POP
@@ -16,19 +16,29 @@
 
 #include "aravis_utils.h"
 
+#include "../SlabAllocator.h"
 #include "../logging.h"
 #include "../utils.h"
 
 #include <algorithm> // std::find
+#include <arpa/inet.h> // inet_ntop
 #include <arv.h>
+#include <atomic>
+#include <cstring> // strerror
 #include <dutils_img/image_fourcc.h>
+#include <ifaddrs.h>
+#include <mutex>
+#include <net/if.h> // IFF_BROADCAST
+#include <netinet/in.h>
 #include <optional>
 #include <regex>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h> // close
 
 // gige-daemon communication
 
 #include "../../tools/tcam-gige-daemon/gige-daemon.h"
-#include "../tcam-semaphores.h"
 
 #include <sys/ipc.h>
 #include <sys/msg.h>
@@ -175,40 +185,67 @@ bool is_blacklisted_gige(const std::string& manufacturer_info)
 }
 
 
-static std::optional<std::vector<DeviceInfo>> fetch_gige_daemon_device_list()
+namespace
+{
+
+// The segment stays attached between queries, the list is only copied again when the
+// generation of the daemon changed.
+struct gige_daemon_connection
 {
-    try
+    int shm_id = -1;
+    const gige_daemon::tcam_gige_device_list* list = nullptr;
+
+    bool have_devices = false;
+    uint64_t generation = 0;
+    std::vector<DeviceInfo> devices;
+
+    void detach()
     {
-        key_t shmkey = ftok(gige_daemon::LOCK_FILE, 'G');
-        if (shmkey == -1)
+        if (list)
         {
-            if (!not_using_gige_deamon_message_reported) // print this message only once and not every time we are queried
-            {
-                SPDLOG_INFO("Failed to create shmkey. Not using gige-daemon to enumerate devices.");
-                not_using_gige_deamon_message_reported = true;
-            }
-            return std::nullopt;
+            shmdt(list);
         }
+        *this = {};
+    }
+};
 
-        not_using_gige_deamon_message_reported =
-            false; // reset message when fetching the lock worked
+std::mutex gige_daemon_mtx;
+gige_daemon_connection gige_daemon_con;
+
+} // namespace
 
-        key_t shm_semaphore_key = ftok(gige_daemon::LOCK_FILE, 'S');
-        if (shm_semaphore_key == -1)
-        {
-            SPDLOG_INFO("Failed to create shmkey. errno={}.", errno);
-            return std::nullopt;
-        }
 
-        int shm_mem_id = shmget(shmkey, sizeof(gige_daemon::tcam_gige_device_list), 0644);
-        if (shm_mem_id < 0)
+static std::optional<std::vector<DeviceInfo>> fetch_gige_daemon_device_list()
+{
+    key_t shmkey = ftok(gige_daemon::LOCK_FILE, 'G');
+    if (shmkey == -1)
+    {
+        if (!not_using_gige_deamon_message_reported) // print this message only once and not every time we are queried
         {
-            SPDLOG_INFO("Unable to connect to gige-daemon. Using internal methods");
-            return std::nullopt;
+            SPDLOG_INFO("Failed to create shmkey. Not using gige-daemon to enumerate devices.");
+            not_using_gige_deamon_message_reported = true;
         }
+        return std::nullopt;
+    }
 
-        semaphore semaphore_instance = semaphore::create(shm_semaphore_key);
-        std::lock_guard<semaphore> lck(semaphore_instance);
+    not_using_gige_deamon_message_reported =
+        false; // reset message when fetching the lock worked
+
+    std::lock_guard<std::mutex> lck(gige_daemon_mtx);
+    auto& con = gige_daemon_con;
+
+    int shm_mem_id = shmget(shmkey, sizeof(gige_daemon::tcam_gige_device_list), 0644);
+    if (shm_mem_id < 0)
+    {
+        SPDLOG_INFO("Unable to connect to gige-daemon. Using internal methods");
+        con.detach();
+        return std::nullopt;
+    }
+
+    // the daemon was restarted
+    if (shm_mem_id != con.shm_id)
+    {
+        con.detach();
 
         auto ptr = shmat(shm_mem_id, NULL, 0);
         if (ptr == ((void*)-1))
@@ -216,32 +253,100 @@ static std::optional<std::vector<DeviceInfo>> fetch_gige_daemon_device_list()
             SPDLOG_ERROR("shmat failed to map memory. errno={}", errno);
             return std::nullopt;
         }
-        const gige_daemon::tcam_gige_device_list* shared_mem_list =
-            static_cast<const gige_daemon::tcam_gige_device_list*>(ptr);
-        if (shared_mem_list == nullptr)
+        con.shm_id = shm_mem_id;
+        con.list = static_cast<const gige_daemon::tcam_gige_device_list*>(ptr);
+    }
+
+    const auto* shared_mem_list = con.list;
+
+    const auto age_ms = gige_daemon::get_device_list_time_ms()
+                        - shared_mem_list->last_update_ms.load(std::memory_order_acquire);
+    if (age_ms > gige_daemon::DEVICE_LIST_MAX_AGE_MS)
+    {
+        SPDLOG_INFO("gige-daemon did not update its device list for {} ms. Using internal methods",
+                    age_ms);
+        return std::nullopt;
+    }
+
+    // the daemon holds the generation odd only for the duration of a memcpy
+    for (int attempt = 0; attempt < 100; ++attempt)
+    {
+        const uint64_t generation = shared_mem_list->generation.load(std::memory_order_acquire);
+
+        if (con.have_devices && generation == con.generation)
+        {
+            return con.devices;
+        }
+        if (generation % 2 != 0)
         {
-            SPDLOG_ERROR("shmat returned nullptr.");
-            return std::nullopt;
+            std::this_thread::yield();
+            continue;
         }
 
-        std::vector<DeviceInfo> ret;
-
-        ret.reserve(shared_mem_list->device_count);
+        const unsigned int count =
+            std::min<unsigned int>(shared_mem_list->device_count, gige_daemon::TCAM_DEVICE_LIST_MAX);
+        std::vector<tcam_device_info> infos(shared_mem_list->devices,
+                                            shared_mem_list->devices + count);
 
-        for (unsigned int i = 0; i < shared_mem_list->device_count; ++i)
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (shared_mem_list->generation.load(std::memory_order_relaxed) != generation)
         {
-            ret.push_back(DeviceInfo(shared_mem_list->devices[i]));
+            continue;
         }
 
-        shmdt(shared_mem_list);
+        con.devices.clear();
+        con.devices.reserve(infos.size());
+        for (const auto& info : infos) { con.devices.push_back(DeviceInfo(info)); }
+        con.generation = generation;
+        con.have_devices = true;
 
-        return ret;
+        return con.devices;
     }
-    catch (const std::exception& ex)
+
+    SPDLOG_INFO("Unable to read a consistent device list from gige-daemon. Using internal methods");
+    return std::nullopt;
+}
+
+gige_daemon::tcam_gige_device_list* tcam::attach_gige_daemon_list()
+{
+    key_t shmkey = ftok(gige_daemon::LOCK_FILE, 'G');
+    if (shmkey == -1)
     {
-        SPDLOG_INFO("Failed to fetch devices from gige-daemon, due to exception={}.", ex.what());
+        return nullptr;
+    }
+
+    int shm_mem_id = shmget(shmkey, sizeof(gige_daemon::tcam_gige_device_list), 0644);
+    if (shm_mem_id < 0)
+    {
+        return nullptr;
+    }
+
+    auto ptr = shmat(shm_mem_id, NULL, 0);
+    if (ptr == ((void*)-1))
+    {
+        SPDLOG_ERROR("shmat failed to map memory. errno={}", errno);
+        return nullptr;
+    }
+
+    auto list = static_cast<gige_daemon::tcam_gige_device_list*>(ptr);
+
+    const auto age_ms = gige_daemon::get_device_list_time_ms()
+                        - list->last_update_ms.load(std::memory_order_acquire);
+    if (age_ms > gige_daemon::DEVICE_LIST_MAX_AGE_MS)
+    {
+        shmdt(ptr);
+        return nullptr;
+    }
+    return list;
+}
+
+
+void tcam::detach_gige_daemon_list(gige_daemon::tcam_gige_device_list* list)
+{
+    if (list)
+    {
+        shmdt(list);
     }
-    return std::nullopt;
 }
 
 /*
@@ -264,17 +369,16 @@ static std::vector<dev_life_tracking> dev_life_tracking_list;
 
 std::vector<DeviceInfo> tcam::get_gige_device_list()
 {
-    std::vector<DeviceInfo> current_devices;
     auto dev_list = fetch_gige_daemon_device_list();
     if (dev_list)
     {
-        current_devices = dev_list.value();
-    }
-    else
-    {
-        current_devices = get_aravis_device_list();
+        // the daemon already tolerates missed discoveries
+        // and reports a removal to its subscribers only once
+        return dev_list.value();
     }
 
+    std::vector<DeviceInfo> current_devices = get_aravis_device_list();
+
     // check for new devices
     // to be added to out watch current_devices
     // after everything else is done
@@ -342,6 +446,45 @@ std::vector<DeviceInfo> tcam::get_gige_device_list()
     return current_devices;
 }
 
+std::optional<DeviceInfo> tcam::find_gige_device(const std::string& serial_or_ip)
+{
+    auto matches = [&serial_or_ip](const DeviceInfo& dev)
+    {
+        return dev.get_serial() == serial_or_ip
+               || serial_or_ip.compare(dev.get_info().additional_identifier) == 0;
+    };
+
+    // the daemon might not have seen a camera that just booted, so a miss is not final
+    if (auto dev_list = fetch_gige_daemon_device_list(); dev_list)
+    {
+        auto iter = std::find_if(dev_list->begin(), dev_list->end(), matches);
+        if (iter != dev_list->end())
+        {
+            return *iter;
+        }
+    }
+
+    in_addr addr = {};
+    if (inet_pton(AF_INET, serial_or_ip.c_str(), &addr) == 1)
+    {
+        tcam_device_info info = { TCAM_DEVICE_TYPE_ARAVIS, "", "", "", "" };
+        strncpy(info.identifier, serial_or_ip.c_str(), sizeof(info.identifier) - 1);
+        strncpy(info.additional_identifier,
+                serial_or_ip.c_str(),
+                sizeof(info.additional_identifier) - 1);
+        return DeviceInfo(info);
+    }
+
+    // one discovery of aravis only, instead of the device index of all backends
+    auto dev_list = get_aravis_device_list();
+    auto iter = std::find_if(dev_list.begin(), dev_list.end(), matches);
+    if (iter != dev_list.end())
+    {
+        return *iter;
+    }
+    return std::nullopt;
+}
+
 unsigned int tcam::get_gige_device_count()
 {
     return get_gige_device_list().size();
@@ -493,3 +636,168 @@ tcam::status tcam::aravis::consume_GError(GError*& err)
 
     return code;
 }
+
+
+std::string tcam::aravis::get_interface_address(ArvCamera* camera)
+{
+    ArvDevice* device = arv_camera_get_device(camera);
+    if (!ARV_IS_GV_DEVICE(device))
+    {
+        return {};
+    }
+
+    GSocketAddress* socket_address = arv_gv_device_get_interface_address(ARV_GV_DEVICE(device));
+    if (!socket_address)
+    {
+        return {};
+    }
+
+    char* str = g_inet_address_to_string(
+        g_inet_socket_address_get_address(G_INET_SOCKET_ADDRESS(socket_address)));
+    std::string interface_address = str;
+    g_free(str);
+    g_object_unref(socket_address);
+
+    return interface_address;
+}
+
+
+std::string tcam::aravis::get_interface_name(ArvCamera* camera)
+{
+    const auto interface_address = get_interface_address(camera);
+    if (interface_address.empty())
+    {
+        return {};
+    }
+
+    struct ifaddrs* addrs = nullptr;
+    if (getifaddrs(&addrs) != 0)
+    {
+        return {};
+    }
+
+    std::string name;
+    for (auto ifa = addrs; ifa != nullptr; ifa = ifa->ifa_next)
+    {
+        if (!ifa->ifa_addr || ifa->ifa_addr->sa_family != AF_INET)
+        {
+            continue;
+        }
+
+        char buf[INET_ADDRSTRLEN] = {};
+        inet_ntop(AF_INET, &((struct sockaddr_in*)ifa->ifa_addr)->sin_addr, buf, sizeof(buf));
+
+        if (interface_address == buf)
+        {
+            name = ifa->ifa_name;
+            break;
+        }
+    }
+    freeifaddrs(addrs);
+
+    return name;
+}
+
+
+int tcam::aravis::get_numa_node(ArvCamera* camera)
+{
+    const auto interface_name = get_interface_name(camera);
+    if (interface_name.empty())
+    {
+        return -1;
+    }
+    return tcam::get_numa_node_of_sysfs_device("/sys/class/net/" + interface_name + "/device");
+}
+
+
+tcam::status tcam::aravis::send_action_command(const tcam_action_command& cmd)
+{
+    // GigE Vision 2.0, 16.5.1
+    constexpr uint16_t gvcp_port = 3956;
+    constexpr uint8_t gvcp_magic = 0x42;
+    constexpr uint16_t action_cmd = 0x0100;
+
+    static std::atomic<uint16_t> req_id = 0;
+    uint16_t id = ++req_id;
+    if (id == 0)
+    {
+        id = ++req_id;
+    }
+
+    // scheduled action commands carry the 64 bit action_time behind the mask
+    constexpr uint8_t scheduled_action_flag = 0x80;
+
+    uint8_t packet[28] = {};
+    auto put16 = [&packet](size_t pos, uint16_t v)
+    {
+        packet[pos] = v >> 8;
+        packet[pos + 1] = v & 0xFF;
+    };
+    auto put32 = [&put16](size_t pos, uint32_t v)
+    {
+        put16(pos, v >> 16);
+        put16(pos + 2, v & 0xFFFF);
+    };
+
+    const bool scheduled = cmd.action_time_ns != 0;
+    const size_t packet_size = scheduled ? 28 : 20;
+
+    packet[0] = gvcp_magic;
+    packet[1] = scheduled ? scheduled_action_flag : 0; // no acknowledge
+    put16(2, action_cmd);
+    put16(4, packet_size - 8);
+    put16(6, id);
+    put32(8, cmd.device_key);
+    put32(12, cmd.group_key);
+    put32(16, cmd.group_mask);
+    if (scheduled)
+    {
+        put32(20, cmd.action_time_ns >> 32);
+        put32(24, cmd.action_time_ns & 0xFFFFFFFF);
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+    {
+        SPDLOG_ERROR("Unable to create socket for the action command: {}", strerror(errno));
+        return tcam::status::UndefinedError;
+    }
+
+    int val = 1;
+    setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &val, sizeof(val));
+
+    struct ifaddrs* addrs = nullptr;
+    if (getifaddrs(&addrs) != 0)
+    {
+        close(fd);
+        return tcam::status::UndefinedError;
+    }
+
+    int sent = 0;
+    for (auto ifa = addrs; ifa != nullptr; ifa = ifa->ifa_next)
+    {
+        if (!ifa->ifa_broadaddr || !ifa->ifa_addr || ifa->ifa_addr->sa_family != AF_INET
+            || !(ifa->ifa_flags & IFF_BROADCAST) || !(ifa->ifa_flags & IFF_UP))
+        {
+            continue;
+        }
+
+        struct sockaddr_in dest = *(struct sockaddr_in*)ifa->ifa_broadaddr;
+        dest.sin_port = htons(gvcp_port);
+
+        if (sendto(fd, packet, packet_size, 0, (struct sockaddr*)&dest, sizeof(dest)) < 0)
+        {
+            SPDLOG_WARN("Unable to send action command on {}: {}", ifa->ifa_name, strerror(errno));
+            continue;
+        }
+        sent++;
+    }
+    freeifaddrs(addrs);
+    close(fd);
+
+    if (sent == 0)
+    {
+        return tcam::status::UndefinedError;
+    }
+    return tcam::status::Success;
+}
@@ -22,11 +22,18 @@
 #include "../error.h" // tcam::status
 
 #include <arv.h> // ArvGcError/.../GError
+#include <optional>
+#include <string>
 #include <string_view>
 #include <vector>
 
 VISIBILITY_DEFAULT
 
+namespace tcam::tools::gige_daemon
+{
+struct tcam_gige_device_list;
+}
+
 namespace tcam
 {
 
@@ -39,6 +46,19 @@ std::vector<DeviceInfo> get_gige_device_list();
 
 std::vector<DeviceInfo> get_aravis_device_list();
 
+/* Looks for a single camera by serial or ip address.
+* Uses the list of a running tcam-gige-daemon when possible.
+* Ip addresses are returned as is, aravis contacts them directly when the device is opened.
+* Serial and name of such a DeviceInfo are empty until AravisDevice opened it.
+*/
+std::optional<DeviceInfo> find_gige_device(const std::string& serial_or_ip);
+
+/* Attaches the device list segment of a running tcam-gige-daemon, to wait for its changes.
+* Returns nullptr when no daemon is running or its list is stale.
+*/
+tools::gige_daemon::tcam_gige_device_list* attach_gige_daemon_list();
+void detach_gige_daemon_list(tools::gige_daemon::tcam_gige_device_list* list);
+
 } /* namespace tcam */
 
 namespace tcam::aravis
@@ -50,6 +70,28 @@ tcam::status translate_error(ArvDeviceError err);
 * If err == nullptr, tcam::status::success is returned.
 */
 tcam::status consume_GError(GError*& err);
+
+/* Returns the local IPv4 address used to reach the camera, e.g. "192.168.0.10".
+* Returns an empty string when unknown or when the camera is not a GigE device.
+*/
+std::string get_interface_address(ArvCamera* camera);
+
+/* Returns the name of the network interface used to reach the camera, e.g. "eth0".
+* Returns an empty string when unknown or when the camera is not a GigE device.
+*/
+std::string get_interface_name(ArvCamera* camera);
+
+/* Returns the NUMA node of the network interface used to reach the camera.
+* Returns -1 when unknown or when the camera is not a GigE device.
+*/
+int get_numa_node(ArvCamera* camera);
+
+/* Broadcasts a GVCP ACTION_CMD on all IPv4 interfaces that support broadcasts.
+* The command is sent without requesting an acknowledge, so that all devices execute it at once.
+* With cmd.action_time_ns a scheduled action command is sent, executed at that PTP time.
+* Succeeds when it could be sent on at least one interface.
+*/
+tcam::status send_action_command(const tcam_action_command& cmd);
 } // namespace tcam::aravis
 
 VISIBILITY_POP
@@ -24,6 +24,8 @@
 
 #include <cstdint>
 #include <cstring>
+#include <functional>
+#include <string>
 
 
 namespace tcam
@@ -50,6 +52,7 @@ enum TCAM_DEVICE_TYPE
     TCAM_DEVICE_TYPE_MIPI, /**< mipi cameras*/
     TCAM_DEVICE_TYPE_TEGRA, /**< tegra fpd/mipi cameras*/
     TCAM_DEVICE_TYPE_VIRTCAM, /**< virtual camera */
+    TCAM_DEVICE_TYPE_REPLAY, /**< recorded images from a file */
 };
 
 
@@ -98,6 +101,36 @@ struct tcam_image_size
     }
 };
 
+/**
+ * @name tcam_image_roi
+ * rectangle in pixels of the current video format
+ */
+struct tcam_image_roi
+{
+    uint32_t left;
+    uint32_t top;
+    uint32_t width;
+    uint32_t height;
+};
+
+/**
+ * @name tcam_image_region
+ * rectangle in sensor pixels of a multi-region readout, see VideoFormat::get_regions
+ */
+struct tcam_image_region
+{
+    uint32_t offset_x;
+    uint32_t offset_y;
+    uint32_t width;
+    uint32_t height;
+
+    bool operator==(const tcam_image_region& other) const noexcept
+    {
+        return offset_x == other.offset_x && offset_y == other.offset_y && width == other.width
+               && height == other.height;
+    }
+};
+
 inline bool is_inside_dim_range(tcam_image_size min, tcam_image_size max, tcam_image_size check) noexcept
 {
     if( min.width > check.width || max.width < check.width )
@@ -262,9 +295,154 @@ struct tcam_stream_statistics
     uint64_t capture_time_ns; // capture time reported by lib
     uint64_t camera_time_ns; //capture time reported by camera; empty if not supported
     bool is_damaged; // flag indicating if the associated buffer had lost packages or other problems
+
+    // Transport counters, totals since the stream was started. Zero when not supported by the backend.
+    uint64_t resent_packets; // packets that were received after a resend request
+    uint64_t missing_packets; // packets that were never received
+    uint64_t underruns; // frames lost, because no buffer was queued in the receive thread
+    uint64_t receive_duration_ns; // time between the first packet and the completion of this frame
+
+    // Set for images that answer CaptureDevice::trigger_software, zero otherwise.
+    // CLOCK_MONOTONIC in ns, taken by libtcam when the trigger was requested and when the image
+    // was handed over by the backend.
+    uint64_t trigger_issue_time_ns;
+    uint64_t trigger_arrival_time_ns;
+
+    // id of the parameter set the image was taken with, see CaptureDevice::queue_parameter_set
+    // 0 when no set is active
+    uint32_t parameter_set_id;
+
+    // Offset of the image on the sensor, see CaptureDevice::move_roi.
+    // roi_id counts the moves since the stream started, 0 for the offset the stream started with.
+    uint32_t roi_id;
+    uint32_t roi_offset_x;
+    uint32_t roi_offset_y;
+
+    // camera_time_ns when the camera clock was synchronized by PTP (IEEE 1588) at stream start,
+    // i.e. comparable between cameras of the same PTP domain. 0 otherwise.
+    uint64_t ptp_time_ns;
+
+    // Position of the image in its exposure bracket while HDRBracketingEnable is set,
+    // hdr_bracket_count is 0 for images that do not belong to a bracket.
+    uint32_t hdr_bracket_index;
+    uint32_t hdr_bracket_count;
+    double hdr_exposure_us; // exposure the image was taken with
+
+    // Lines of a damaged image that were not received, 0 when the backend cannot tell.
+    // The affected lines are listed in the tcam_missing_line_map of the ImageBuffer.
+    uint32_t missing_lines;
+};
+
+
+/**
+ * Lines of a damaged image that were not received, see DeviceInterface::set_salvage_threshold.
+ * Lines that were partially lost count as missing.
+ */
+struct tcam_missing_line_map
+{
+    static constexpr size_t max_ranges = 8;
+
+    struct line_range
+    {
+        uint32_t first_line;
+        uint32_t line_count;
+    };
+
+    // sorted by first_line, further gaps are merged into the last range
+    uint32_t range_count = 0;
+    line_range ranges[max_ranges] = {};
+};
+
+
+/**
+ * Values the camera transmitted together with the image (GigE Vision chunk data).
+ * Only filled when chunk data is enabled, the has_* flags mark what the camera sent.
+ */
+struct tcam_chunk_data
+{
+    bool has_exposure_time = false;
+    bool has_gain = false;
+    bool has_frame_id = false;
+
+    double exposure_time_us = 0.0;
+    double gain = 0.0;
+    uint64_t frame_id = 0;
+};
+
+// Space reserved behind the image in every buffer when chunk data is enabled
+constexpr size_t chunk_data_buffer_padding = 4096;
+
+
+/**
+ * Receive settings for network and USB3 Vision streams, only used by the aravis backend.
+ * Negative values and empty strings keep the aravis defaults.
+ */
+struct tcam_stream_transport_options
+{
+    int packet_socket = -1; // 0 = regular udp socket, 1 = packet socket (packet_mmap) when permitted
+    int socket_buffer_size = -1; // in bytes, 0 = let aravis size the socket buffer
+    int packet_resend = -1; // 0 = never request resends, 1 = always
+    int packet_timeout_us = -1; // time before a missing packet is requested again
+    int frame_retention_us = -1; // time before an incomplete frame is given up
+    std::string receive_thread_cpu_affinity; // cpu list of the receive thread, e.g. "0,2-3"
+    int receive_thread_priority = -1; // SCHED_FIFO priority, 0 = no real time scheduling
+    // USB3 Vision: 0 = one synchronous bulk transfer at a time, 1 = concurrent asynchronous
+    // transfers, -1 = asynchronous for payloads that need more than one transfer
+    int usb_async_transfers = -1;
+    // USB3 Vision: minimum of /sys/module/usbcore/parameters/usbfs_memory_mb in MB,
+    // 0 = leave it alone, -1 = enough for the transfers of all open streams
+    int usbfs_memory_mb = -1;
+};
+
+
+// GigE Vision action command, devices execute it when the keys match and the masks overlap
+struct tcam_action_command
+{
+    uint32_t device_key = 0;
+    uint32_t group_key = 0;
+    uint32_t group_mask = 0;
+    // PTP time in ns at which the devices execute the action, 0 executes it on arrival
+    uint64_t action_time_ns = 0;
+};
+
+
+// PTP (IEEE 1588) state of a device, see CaptureDevice::get_ptp_status
+struct tcam_ptp_status
+{
+    bool enabled = false;
+    // PtpStatus, e.g. "Initializing", "Listening", "Master" or "Slave"
+    std::string state;
+    // difference to the master clock, 0 for the master itself
+    int64_t offset_from_master_ns = 0;
+    // device clock when the status was read, 0 when the device cannot latch it
+    uint64_t time_ns = 0;
+
+    bool is_synchronized() const noexcept
+    {
+        return enabled && (state == "Master" || state == "Slave");
+    }
 };
 
 
+// GenICam event sent by a device, see CaptureDevice::set_device_event_callback
+struct tcam_device_event
+{
+    // entry of EventSelector, e.g. "ExposureEnd" or "FrameTransferEnd"
+    std::string name;
+    uint16_t event_id = 0;
+    uint16_t stream_channel = 0;
+    // id of the image the event belongs to, 0 when the device does not tell
+    uint64_t block_id = 0;
+    // device clock when the event occurred
+    uint64_t timestamp_ns = 0;
+    // steady clock of the host when the event was received
+    uint64_t arrival_time_ns = 0;
+};
+
+// called from the receive thread of the backend, has to return quickly
+using tcam_device_event_callback = std::function<void(const tcam_device_event&)>;
+
+
 struct tcam_value_int
 {
     int64_t min;
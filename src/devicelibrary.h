@@ -17,9 +17,13 @@
 #pragma once
 
 #include "DeviceInfo.h"
+#include "error.h"
 
-#include <vector>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace tcam
 {
@@ -27,6 +31,20 @@ namespace tcam
 // forward declaration
 class DeviceInterface;
 
+/*
+ * Used by backends to tell the Indexer about changes as they happen.
+ * Both may be called from any thread, but not after stop_monitoring returned.
+ */
+struct backend_monitor_callbacks
+{
+    // devices were added or removed, get_device_list has to be called again
+    std::function<void()> device_list_changed;
+    // an open device stopped responding
+    std::function<void(const std::string& serial)> device_lost;
+    // the backend can no longer report changes, get_device_list has to be polled again
+    std::function<void()> monitoring_lost;
+};
+
 /*
  * This class is meant as the definition of backend accessibility
  */
@@ -37,6 +55,35 @@ public:
     virtual TCAM_DEVICE_TYPE get_type() const = 0;
     virtual std::shared_ptr<DeviceInterface> open_device(const tcam::DeviceInfo&) = 0;
     virtual std::vector<DeviceInfo> get_device_list()= 0;
+
+    // Looks for a single device without a complete enumeration, used by tcam::open_device.
+    // The default searches get_device_list.
+    virtual std::optional<DeviceInfo> find_device(const std::string& serial)
+    {
+        for (auto&& dev : get_device_list())
+        {
+            if (dev.get_serial() == serial)
+            {
+                return dev;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Returns true when the backend reports all additions and removals via device_list_changed.
+    // Otherwise the device list of the backend is only retrieved on demand.
+    virtual bool start_monitoring(const backend_monitor_callbacks& /*callbacks*/)
+    {
+        return false;
+    }
+    virtual void stop_monitoring() {}
+
+    // Sends the action command once to all devices of this backend that can be reached,
+    // see DeviceInterface::set_action_start.
+    virtual outcome::result<void> send_action_command(const tcam_action_command& /*cmd*/)
+    {
+        return tcam::status::NotImplemented;
+    }
 };
 
 } // namespace tcam
@@ -22,14 +22,17 @@
 #include "../tcamgstbase/tcamgstbase.h"
 #include "../tcamgstbase/tcamgstjson.h"
 #include "gst/gstchildproxy.h"
+#include "tcambin_calibration.h"
 #include "tcambin_data.h"
 #include "tcambin_tcamprop_impl.h"
 
 #include <cassert>
 #include <cstring>
+#include <dutils_img_lib/dutils_fcc_traits.h>
 #include <gst-helper/gst_gvalue_helper.h>
 #include <gst-helper/helper_functions.h>
 #include <string>
+#include <tcamprop1.0_gobject/tcam_property_provider_simple_functions.h>
 #include <tcamprop1.0_gobject/tcam_property_serialize.h>
 #include <unistd.h>
 
@@ -46,6 +49,100 @@ G_DEFINE_TYPE_WITH_CODE(GstTcamBin,
 
 static void gst_tcambin_clear_source(GstTcamBin* self);
 
+
+GType gst_tcambin_latency_profile_get_type(void)
+{
+    static GType tcambin_latency_profile = 0;
+
+    if (!tcambin_latency_profile)
+    {
+        static const GEnumValue latency_profiles[] = {
+            { GST_TCAMBIN_LATENCY_PROFILE_DEFAULT,
+              "GST_TCAMBIN_LATENCY_PROFILE_DEFAULT",
+              "default" },
+            { GST_TCAMBIN_LATENCY_PROFILE_LOW, "GST_TCAMBIN_LATENCY_PROFILE_LOW", "low-latency" },
+
+            { 0, NULL, NULL }
+        };
+        tcambin_latency_profile =
+            g_enum_register_static("GstTcamBinLatencyProfile", latency_profiles);
+    }
+    return tcambin_latency_profile;
+}
+
+GType gst_tcambin_debayer_method_get_type(void)
+{
+    static GType tcambin_debayer_method = 0;
+
+    if (!tcambin_debayer_method)
+    {
+        static const GEnumValue debayer_methods[] = {
+            { GST_TCAMBIN_DEBAYER_NEAREST, "GST_TCAMBIN_DEBAYER_NEAREST", "nearest" },
+            { GST_TCAMBIN_DEBAYER_BILINEAR, "GST_TCAMBIN_DEBAYER_BILINEAR", "bilinear" },
+            { GST_TCAMBIN_DEBAYER_EDGE, "GST_TCAMBIN_DEBAYER_EDGE", "edge" },
+            { GST_TCAMBIN_DEBAYER_HQ, "GST_TCAMBIN_DEBAYER_HQ", "hq" },
+
+            { 0, NULL, NULL }
+        };
+        tcambin_debayer_method =
+            g_enum_register_static("GstTcamBinDebayerMethod", debayer_methods);
+    }
+    return tcambin_debayer_method;
+}
+
+static const char* debayer_method_nick(GstTcamBinDebayerMethod method)
+{
+    GEnumClass* enum_class =
+        static_cast<GEnumClass*>(g_type_class_ref(GST_TYPE_TCAMBIN_DEBAYER_METHOD));
+    const GEnumValue* value = g_enum_get_value(enum_class, method);
+    g_type_class_unref(enum_class);
+
+    return value ? value->value_nick : "edge";
+}
+
+// tcamconvert lives in its own plugin, so the value is passed by nick instead of by enum type
+static void apply_debayer_method(GstElement* converter, GstTcamBinDebayerMethod method)
+{
+    gst_util_set_object_arg(G_OBJECT(converter), "debayer-method", debayer_method_nick(method));
+}
+
+GType gst_tcambin_video_direction_get_type(void)
+{
+    static GType tcambin_video_direction = 0;
+
+    if (!tcambin_video_direction)
+    {
+        static const GEnumValue video_directions[] = {
+            { GST_TCAMBIN_VIDEO_DIRECTION_IDENTITY,
+              "GST_TCAMBIN_VIDEO_DIRECTION_IDENTITY",
+              "identity" },
+            { GST_TCAMBIN_VIDEO_DIRECTION_90R, "GST_TCAMBIN_VIDEO_DIRECTION_90R", "90r" },
+            { GST_TCAMBIN_VIDEO_DIRECTION_180, "GST_TCAMBIN_VIDEO_DIRECTION_180", "180" },
+            { GST_TCAMBIN_VIDEO_DIRECTION_90L, "GST_TCAMBIN_VIDEO_DIRECTION_90L", "90l" },
+            { GST_TCAMBIN_VIDEO_DIRECTION_HORIZ, "GST_TCAMBIN_VIDEO_DIRECTION_HORIZ", "horiz" },
+            { GST_TCAMBIN_VIDEO_DIRECTION_VERT, "GST_TCAMBIN_VIDEO_DIRECTION_VERT", "vert" },
+
+            { 0, NULL, NULL }
+        };
+        tcambin_video_direction =
+            g_enum_register_static("GstTcamBinVideoDirection", video_directions);
+    }
+    return tcambin_video_direction;
+}
+
+// tcamconvert uses GstVideoOrientationMethod, which has the same nicks
+static void apply_video_direction(GstElement* converter, GstTcamBinVideoDirection direction)
+{
+    GEnumClass* enum_class =
+        static_cast<GEnumClass*>(g_type_class_ref(GST_TYPE_TCAMBIN_VIDEO_DIRECTION));
+    const GEnumValue* value = g_enum_get_value(enum_class, direction);
+    g_type_class_unref(enum_class);
+
+    gst_util_set_object_arg(
+        G_OBJECT(converter), "video-direction", value ? value->value_nick : "identity");
+}
+
+
 enum
 {
     PROP_0,
@@ -57,6 +154,11 @@ enum
     PROP_TCAM_PROPERTIES_JSON,
     PROP_TCAMDEVICE,
     PROP_TCAM_PROPERTIES_GSTSTRUCT,
+    PROP_DOWNSCALE,
+    PROP_DEBAYER_METHOD,
+    PROP_VIDEO_DIRECTION,
+    PROP_LATENCY_PROFILE,
+    PROP_EXPECTED_LATENCY,
 };
 
 
@@ -66,6 +168,9 @@ static const char* name_converter = "tcambin-converter";
 static const char* name_jpeg = "tcambin-jpegdec";
 static const char* name_videoconvert = "tcambin-videoconvert";
 
+// one buffer is filled by the device, one is queued, one is converted and one is held by the sink
+static const int low_latency_camera_buffers = 4;
+
 
 static GstStaticPadTemplate src_template =
     GST_STATIC_PAD_TEMPLATE("src", GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
@@ -98,9 +203,10 @@ static gst_helper::gst_ptr<GstCaps> tcambin_filter_unsupported_caps(GstTcamBin*
         if (gst_structure_has_field(structure, "format"))
         {
             auto format = gst_structure_get_string(structure, "format");
+            const auto& info = img_lib::fcc_traits::get_gst(gst_structure_get_name(structure),
+                                                            format != nullptr ? format : "");
 
-            if (g_strcmp0(format, "BGR") == 0
-                || tcam::gst::format_is_yuv(gst_structure_get_name(structure), format))
+            if (info.fcc == img::fourcc::BGR24 || info.is_yuv())
             {
                 return FALSE;
             }
@@ -116,6 +222,135 @@ static gst_helper::gst_ptr<GstCaps> tcambin_filter_unsupported_caps(GstTcamBin*
     return available_caps;
 }
 
+
+static bool is_low_latency(const tcambin_data& data) noexcept
+{
+    return data.latency_profile == GST_TCAMBIN_LATENCY_PROFILE_LOW;
+}
+
+
+// tcamdutils-cuda can DMA from page locked capture buffers instead of staging every image
+// an io-mode the user selected is kept
+static void use_cuda_pinned_memory(GstTcamBin* self, const tcambin_data& data)
+{
+    if (!data.src_element || !gst_helper::gobject_has_property(data.src_element.get(), "io-mode"))
+    {
+        return;
+    }
+
+    gint io_mode = 0;
+    g_object_get(G_OBJECT(data.src_element.get()), "io-mode", &io_mode, NULL);
+    if (io_mode != 0) // GST_TCAM_IO_AUTO
+    {
+        return;
+    }
+
+    GST_INFO_OBJECT(self, "Using io-mode 'cuda-pinned' for tcamdutils-cuda");
+    gst_util_set_object_arg(G_OBJECT(data.src_element.get()), "io-mode", "cuda-pinned");
+}
+
+
+static gst_helper::gst_ptr<GstCaps> remove_jpeg_caps(const GstCaps& caps)
+{
+    auto filter_func = [](GstCapsFeatures* /*features*/,
+                          GstStructure* structure,
+                          gpointer /*user_data*/) -> gboolean
+    {
+        return !gst_structure_has_name(structure, "image/jpeg");
+    };
+
+    auto ret = gst_helper::make_ptr(gst_caps_copy(&caps));
+
+    gst_caps_filter_and_map_in_place(ret.get(), filter_func, nullptr);
+
+    return ret;
+}
+
+
+static GstClockTime get_frame_duration(const GstCaps* caps)
+{
+    if (!caps || gst_caps_is_empty(caps))
+    {
+        return GST_CLOCK_TIME_NONE;
+    }
+
+    int num = 0;
+    int den = 0;
+    if (!gst_structure_get_fraction(gst_caps_get_structure(caps, 0), "framerate", &num, &den)
+        || num <= 0 || den <= 0)
+    {
+        return GST_CLOCK_TIME_NONE;
+    }
+    return gst_util_uint64_scale_int(GST_SECOND, den, num);
+}
+
+
+static void enable_qos(GstElement* element)
+{
+    if (element && gst_helper::gobject_has_property(element, "qos"))
+    {
+        g_object_set(element, "qos", TRUE, NULL);
+    }
+}
+
+
+// A late frame is worth less than the next one, let the sink drop frames that are more than
+// one frame late instead of rendering a growing backlog.
+// Only the element that is directly linked to tcambin is changed.
+static void configure_low_latency_sink(GstTcamBin* self, GstPad& sinkpad)
+{
+    const GstClockTime frame_duration = get_frame_duration(self->data->src_caps.get());
+
+    GstElement* sink = gst_pad_get_parent_element(&sinkpad);
+    if (!sink)
+    {
+        return;
+    }
+
+    if (GST_CLOCK_TIME_IS_VALID(frame_duration)
+        && gst_helper::gobject_has_property(sink, "max-lateness", G_TYPE_INT64))
+    {
+        g_object_set(sink, "max-lateness", (gint64)frame_duration, NULL);
+        enable_qos(sink);
+
+        GST_INFO_OBJECT(self,
+                        "Set max-lateness of '%s' to %" GST_TIME_FORMAT,
+                        GST_ELEMENT_NAME(sink),
+                        GST_TIME_ARGS(frame_duration));
+    }
+    gst_object_unref(sink);
+}
+
+
+// The latency the internal pipeline reports, i.e. the time between the start of the exposure
+// and the moment a buffer leaves tcambin.
+// Before the source has negotiated a framerate this falls back to one frame of the selected caps.
+static GstClockTime tcambin_get_expected_latency(GstTcamBin* self)
+{
+    auto& data = get_tcambin_data(self);
+
+    if (!data.target_pad)
+    {
+        return GST_CLOCK_TIME_NONE;
+    }
+
+    GstClockTime min_latency = GST_CLOCK_TIME_NONE;
+
+    GstQuery* query = gst_query_new_latency();
+    if (gst_pad_query(data.target_pad.get(), query))
+    {
+        gboolean live = FALSE;
+        gst_query_parse_latency(query, &live, &min_latency, nullptr);
+    }
+    gst_query_unref(query);
+
+    if (!GST_CLOCK_TIME_IS_VALID(min_latency))
+    {
+        min_latency = get_frame_duration(data.src_caps.get());
+    }
+    return min_latency;
+}
+
 void gst_tcambin_apply_properties(GstTcamBin* self, const GstStructure& strct)
 {
     tcamprop1_gobj::apply_properties(
@@ -130,6 +365,12 @@ void gst_tcambin_apply_properties(GstTcamBin* self, const GstStructure& strct)
         });
 }
 
+static void emit_property_changed(GstElement* /*object*/, const char* name, void* user_data)
+{
+    // user-data is the tcambin instance
+    tcamprop1_gobj::provider_emit_property_changed(TCAM_PROPERTY_PROVIDER(user_data), name);
+}
+
 static bool tcambin_create_source(GstTcamBin* self)
 {
     gst_tcambin_clear_source(self);
@@ -166,6 +407,22 @@ static bool tcambin_create_source(GstTcamBin* self)
         return false;
     }
 
+    g_signal_connect(G_OBJECT(src_element.get()),
+                     "tcam-property-changed",
+                     G_CALLBACK(emit_property_changed),
+                     self);
+
+    if (is_low_latency(data))
+    {
+        GST_INFO_OBJECT(self,
+                        "Using %d camera buffers for profile 'low-latency'",
+                        low_latency_camera_buffers);
+        g_object_set(G_OBJECT(src_element.get()),
+                     "camera-buffers",
+                     low_latency_camera_buffers,
+                     NULL);
+    }
+
     gst_bin_add(GST_BIN(self), src_element.get());
 
     GstChildProxy* proxy = GST_CHILD_PROXY(self);
@@ -212,6 +469,7 @@ static void gst_tcambin_clear_source(GstTcamBin* self)
         GstChildProxy* proxy = GST_CHILD_PROXY(self);
         gst_child_proxy_child_removed(proxy, G_OBJECT(data.src_element.get()), name_source);
         gst_bin_remove(GST_BIN(self), data.src_element.get());
+        data.property_owners.clear();
         data.src_element = nullptr;
     }
 }
@@ -247,6 +505,7 @@ static void gst_tcambin_clear_elements(GstTcamBin* self)
 
     if (data.tcam_converter)
     {
+        data.property_owners.clear();
         remove_element(data.tcam_converter, name_converter);
         data.tcam_converter = nullptr;
     }
@@ -263,38 +522,37 @@ static void gst_tcambin_clear_elements(GstTcamBin* self)
         }
     }
 
+    data.pipeline_description.clear();
     data.elements_created = false;
 }
 
 
-// check element existence and compatibility
-// assuming all transform elements exist the order is:
-// tcamdutils -> tcamdutils-cuda -> tcamconvert
-// manual overwrite disregards all checks and forces an element!
-// this can cause errors and non functioning pipelines!
-static void select_transform_element(TcamBinConversionElement& user_selector,
-                                     TcamBinConversionElement& internal_selector)
+namespace
 {
-    static bool compatibility_checked;
-
-    static bool dutils_cuda_exists;
-    static bool dutils_cuda_is_compatible;
+struct conversion_modules
+{
+    bool dutils_cuda_exists = false;
+    bool dutils_cuda_is_compatible = false;
 
-    static bool dutils_exists;
-    static bool dutils_is_compatible;
+    bool dutils_exists = false;
+    bool dutils_is_compatible = false;
+};
 
-    // one time check
-    if (!compatibility_checked)
+const conversion_modules& get_conversion_modules()
+{
+    // one time check, the registry does not change while the process runs
+    // and the version check has to load the plugins
+    static const conversion_modules available = []
     {
-        compatibility_checked = true;
+        conversion_modules ret;
+
         auto factory_cuda = gst_element_factory_find("tcamdutils-cuda");
         if (factory_cuda != nullptr)
         {
-            dutils_cuda_exists = true;
+            ret.dutils_cuda_exists = true;
             if (tcam::gst::is_version_compatible_with_tiscamera("tcamdutils-cuda"))
             {
-                //data.conversion_info.selected_conversion = TCAM_BIN_CONVERSION_CUDA;
-                dutils_cuda_is_compatible = true;
+                ret.dutils_cuda_is_compatible = true;
             }
             else
             {
@@ -308,10 +566,10 @@ static void select_transform_element(TcamBinConversionElement& user_selector,
         auto factory = gst_element_factory_find("tcamdutils");
         if (factory != nullptr)
         {
-            dutils_exists = true;
+            ret.dutils_exists = true;
             if (tcam::gst::is_version_compatible_with_tiscamera("tcamdutils"))
             {
-                dutils_is_compatible = true;
+                ret.dutils_is_compatible = true;
             }
             else
             {
@@ -321,7 +579,28 @@ static void select_transform_element(TcamBinConversionElement& user_selector,
             }
             gst_object_unref(factory);
         }
-    }
+        return ret;
+    }();
+
+    return available;
+}
+} // namespace
+
+
+// check element existence and compatibility
+// assuming all transform elements exist the order is:
+// tcamdutils -> tcamdutils-cuda -> tcamconvert
+// manual overwrite disregards all checks and forces an element!
+// this can cause errors and non functioning pipelines!
+static void select_transform_element(TcamBinConversionElement& user_selector,
+                                     TcamBinConversionElement& internal_selector)
+{
+    const auto& available = get_conversion_modules();
+
+    const bool dutils_cuda_exists = available.dutils_cuda_exists;
+    const bool dutils_cuda_is_compatible = available.dutils_cuda_is_compatible;
+    const bool dutils_exists = available.dutils_exists;
+    const bool dutils_is_compatible = available.dutils_is_compatible;
 
     if (user_selector == TCAM_BIN_CONVERSION_CUDA)
     {
@@ -386,6 +665,64 @@ static void select_transform_element(TcamBinConversionElement& user_selector,
 }
 
 
+// TCAM_BIN_CALIBRATE
+// replaces the static auto selection with the candidate that converts the device format the fastest
+static void calibrate_transform_element(GstTcamBin* self)
+{
+    auto& data = get_tcambin_data(self);
+
+    if (!data.available_caps)
+    {
+        return;
+    }
+
+    gst_helper::gst_ptr<GstCaps> caps;
+    if (data.user_caps)
+    {
+        caps = gst_helper::make_ptr(
+            gst_caps_intersect(data.user_caps.get(), data.available_caps.get()));
+    }
+    if (!caps || gst_caps_is_empty(caps.get()))
+    {
+        caps = gst_helper::make_ptr(gst_caps_copy(data.available_caps.get()));
+    }
+    if (gst_caps_is_empty(caps.get()) || tcam::gst::contains_jpeg(caps.get()))
+    {
+        return;
+    }
+
+    // output caps are unknown before negotiation, the first format is the one that will most
+    // likely be negotiated
+    caps = gst_helper::make_ptr(gst_caps_copy_nth(caps.get(), 0));
+    caps = gst_helper::make_ptr(gst_caps_fixate(caps.release()));
+
+    const auto& available = get_conversion_modules();
+
+    std::vector<TcamBinConversionElement> candidates = { TCAM_BIN_CONVERSION_CONVERT };
+    if (available.dutils_exists && available.dutils_is_compatible)
+    {
+        candidates.push_back(TCAM_BIN_CONVERSION_DUTILS);
+    }
+    if (available.dutils_cuda_exists && available.dutils_cuda_is_compatible)
+    {
+        candidates.push_back(TCAM_BIN_CONVERSION_CUDA);
+    }
+
+    auto fastest = tcambin::calibration::select_fastest(candidates, *caps);
+    if (fastest == TCAM_BIN_CONVERSION_AUTO)
+    {
+        GST_INFO_OBJECT(self, "Calibration did not measure anything, keeping the auto selection");
+        return;
+    }
+
+    if (fastest != data.conversion_info.selected_conversion)
+    {
+        GST_INFO_OBJECT(self, "Calibration replaced the auto selected transform element");
+    }
+    data.conversion_info.selected_conversion = fastest;
+    data.conversion_info.user_selector = fastest;
+}
+
 static gboolean create_and_add_element(GstElement** element,
                                        const char* factory_name,
                                        const char* element_name,
@@ -456,9 +793,33 @@ static bool tcambin_create_elements(GstTcamBin* self)
         return false;
     }
 
-    if (tcam::gst::contains_jpeg(data.available_caps.get()))
+    bool use_jpegdec = tcam::gst::contains_jpeg(data.available_caps.get());
+
+    if (use_jpegdec && is_low_latency(data)
+        && !(data.user_caps && tcam::gst::contains_jpeg(data.user_caps.get())))
+    {
+        // jpeg has to be decoded and converted, prefer any format tcamconvert handles directly
+        auto raw_caps = remove_jpeg_caps(*data.available_caps);
+        if (!gst_caps_is_empty(raw_caps.get()))
+        {
+            GST_INFO_OBJECT(self, "Ignoring image/jpeg caps for profile 'low-latency'");
+            data.available_caps = raw_caps;
+            use_jpegdec = false;
+        }
+    }
+
+    if (use_jpegdec)
     {
-        if (!create_and_add_element(&data.jpegdec, "jpegdec", name_jpeg, GST_BIN(self)))
+        // e.g. v4l2jpegdec, to decode on V4L2 M2M hardware instead of the cpu
+        const char* decoder = g_getenv("TCAM_BIN_JPEG_DECODER");
+        if (decoder && *decoder
+            && !create_and_add_element(&data.jpegdec, decoder, name_jpeg, GST_BIN(self)))
+        {
+            GST_WARNING_OBJECT(self, "Unable to create jpeg decoder '%s'. Using jpegdec.", decoder);
+        }
+
+        if (!data.jpegdec
+            && !create_and_add_element(&data.jpegdec, "jpegdec", name_jpeg, GST_BIN(self)))
         {
             GST_ELEMENT_ERROR(
                 self, CORE, MISSING_PLUGIN, ("Could not create element 'jpegdec'."), (NULL));
@@ -474,24 +835,41 @@ static bool tcambin_create_elements(GstTcamBin* self)
             return false;
         }
 
-        // always add videoconvert
-        // this is necessaryto ensure output BGRx as output works
-        if (!create_and_add_element(
-                &data.videoconvert, "videoconvert", "tcambin-videoconvert", GST_BIN(self)))
+        if (is_low_latency(data))
         {
-            GST_ELEMENT_ERROR(
-                self, CORE, MISSING_PLUGIN, ("Could not create element 'videoconvert'."), (NULL));
-            return false;
-        }
+            // the sink has to accept what the decoder produces, e.g. I420
+            GST_INFO_OBJECT(self, "Omitting videoconvert for profile 'low-latency'");
+            enable_qos(data.jpegdec);
 
-        if (!link_elements(data.jpegdec, data.videoconvert, pipeline_string, name_videoconvert))
-        {
-            GST_ELEMENT_ERROR(
-                self, CORE, NEGOTIATION, ("Could not link element '%s'.", "videoconvert"), (NULL));
-            return false;
+            data.target_pad = gst_helper::get_static_pad(*self->data->jpegdec, "src");
         }
+        else
+        {
+            // always add videoconvert
+            // this is necessaryto ensure output BGRx as output works
+            if (!create_and_add_element(
+                    &data.videoconvert, "videoconvert", "tcambin-videoconvert", GST_BIN(self)))
+            {
+                GST_ELEMENT_ERROR(self,
+                                  CORE,
+                                  MISSING_PLUGIN,
+                                  ("Could not create element 'videoconvert'."),
+                                  (NULL));
+                return false;
+            }
 
-        data.target_pad = gst_helper::get_static_pad(*self->data->videoconvert, "src");
+            if (!link_elements(data.jpegdec, data.videoconvert, pipeline_string, name_videoconvert))
+            {
+                GST_ELEMENT_ERROR(self,
+                                  CORE,
+                                  NEGOTIATION,
+                                  ("Could not link element '%s'.", "videoconvert"),
+                                  (NULL));
+                return false;
+            }
+
+            data.target_pad = gst_helper::get_static_pad(*self->data->videoconvert, "src");
+        }
     }
     else
     {
@@ -522,6 +900,8 @@ static bool tcambin_create_elements(GstTcamBin* self)
                 return false;
             }
             element_name = "tcamdutils-cuda";
+
+            use_cuda_pinned_memory(self, data);
         }
         else // default selection
         {
@@ -537,6 +917,19 @@ static bool tcambin_create_elements(GstTcamBin* self)
                 return false;
             }
             element_name = "tcamconvert";
+
+            g_object_set(data.tcam_converter, "downscale", data.downscale, NULL);
+            apply_debayer_method(data.tcam_converter, data.debayer_method);
+            apply_video_direction(data.tcam_converter, data.video_direction);
+        }
+
+        if (data.downscale != 1
+            && data.conversion_info.selected_conversion != TCAM_BIN_CONVERSION_CONVERT)
+        {
+            GST_WARNING_OBJECT(self,
+                               "Property 'downscale' is only supported by tcamconvert, ignoring "
+                               "it for '%s'.",
+                               element_name.c_str());
         }
 
         if (!link_elements(data.pipeline_caps, data.tcam_converter, pipeline_string, element_name))
@@ -548,17 +941,47 @@ static bool tcambin_create_elements(GstTcamBin* self)
                               (NULL));
             return false;
         }
+        if (is_low_latency(data))
+        {
+            enable_qos(data.tcam_converter);
+        }
         data.target_pad = gst_helper::get_static_pad(*self->data->tcam_converter, "src");
     }
 
     GST_DEBUG_OBJECT(self, "Internal pipeline: %s", pipeline_string.c_str());
+    data.pipeline_description = pipeline_string;
 
+    // the new converter may provide properties that were looked up in the source
+    data.property_owners.clear();
     data.elements_created = true;
 
     return true;
 }
 
 
+/**
+ * @return bytes per second the device link can carry, 0 when the device does not tell
+ */
+static uint64_t query_link_capacity(GstElement& src)
+{
+    if (!TCAM_IS_PROPERTY_PROVIDER(&src))
+    {
+        return 0;
+    }
+
+    // SFNC, in bytes per second
+    GError* err = nullptr;
+    const gint64 speed = tcam_property_provider_get_tcam_integer(
+        TCAM_PROPERTY_PROVIDER(&src), "DeviceLinkSpeed", &err);
+    if (err)
+    {
+        g_error_free(err);
+        return 0;
+    }
+    return speed > 0 ? static_cast<uint64_t>(speed) : 0;
+}
+
+
 static void set_target_pad(GstTcamBin* self)
 {
     auto& data = get_tcambin_data(self);
@@ -598,6 +1021,8 @@ static GstStateChangeReturn gst_tcam_bin_change_state(GstElement* element, GstSt
             // this checks compatibilities
             // informs the user about them
             // and gives us the infos we need for create_elements
+            const bool auto_selection =
+                self->data->conversion_info.user_selector == TCAM_BIN_CONVERSION_AUTO;
             select_transform_element(self->data->conversion_info.user_selector,
                                      self->data->conversion_info.selected_conversion);
 
@@ -606,6 +1031,11 @@ static GstStateChangeReturn gst_tcam_bin_change_state(GstElement* element, GstSt
                 return GST_STATE_CHANGE_FAILURE;
             }
 
+            if (auto_selection && tcambin::calibration::is_enabled())
+            {
+                calibrate_transform_element(self);
+            }
+
             if (!tcambin_create_elements(self))
             {
                 gst_tcambin_clear_source(self);
@@ -668,9 +1098,54 @@ static GstStateChangeReturn gst_tcam_bin_change_state(GstElement* element, GstSt
                 }
             }
 
+            if (data.downscale != 1
+                && data.conversion_info.selected_conversion == TCAM_BIN_CONVERSION_CONVERT
+                && !gst_caps_is_empty(data.target_caps.get()))
+            {
+                // tcamconvert shrinks the image, so the device has to deliver the scaled up size
+                auto scaled_caps =
+                    gst_helper::make_ptr(gst_caps_make_writable(data.target_caps.release()));
+                for (guint i = 0; i < gst_caps_get_size(scaled_caps.get()); ++i)
+                {
+                    gst_helper::scale_gst_struct_image_dim(
+                        *gst_caps_get_structure(scaled_caps.get(), i), data.downscale, 1);
+                }
+                data.target_caps = std::move(scaled_caps);
+            }
+
+            if ((data.video_direction == GST_TCAMBIN_VIDEO_DIRECTION_90R
+                 || data.video_direction == GST_TCAMBIN_VIDEO_DIRECTION_90L)
+                && data.conversion_info.selected_conversion == TCAM_BIN_CONVERSION_CONVERT
+                && !gst_caps_is_empty(data.target_caps.get()))
+            {
+                // tcamconvert rotates the image, so the device delivers it with width and height
+                // exchanged
+                auto rotated_caps =
+                    gst_helper::make_ptr(gst_caps_make_writable(data.target_caps.release()));
+                for (guint i = 0; i < gst_caps_get_size(rotated_caps.get()); ++i)
+                {
+                    gst_helper::swap_gst_struct_image_dim(
+                        *gst_caps_get_structure(rotated_caps.get(), i));
+                }
+                data.target_caps = std::move(rotated_caps);
+            }
+
             auto src_caps =
                 gst_helper::query_caps(*gst_helper::get_static_pad(*data.src_element, "src"));
 
+            if (!data.jpegdec && tcam::gst::contains_jpeg(src_caps.get()))
+            {
+                // tcambin_create_elements decided against decoding jpeg
+                src_caps = remove_jpeg_caps(*src_caps);
+            }
+
+            tcam::gst::format_cost_params cost_params;
+            cost_params.link_capacity = query_link_capacity(*data.src_element);
+            if (tcambin::calibration::is_enabled())
+            {
+                cost_params.measured_costs = tcambin::calibration::get_measured_costs();
+            }
+
             if (data.user_caps)
             {
                 GstCaps* tmp =
@@ -701,7 +1176,8 @@ static GstStateChangeReturn gst_tcam_bin_change_state(GstElement* element, GstSt
                     gst_helper::make_ptr(find_input_caps(data.user_caps.get(),
                                                          data.target_caps.get(),
                                                          data.modules,
-                                                         data.conversion_info.selected_conversion));
+                                                         data.conversion_info.selected_conversion,
+                                                         cost_params));
             }
             else
             {
@@ -709,7 +1185,8 @@ static GstStateChangeReturn gst_tcam_bin_change_state(GstElement* element, GstSt
                     gst_helper::make_ptr(find_input_caps(src_caps.get(),
                                                          data.target_caps.get(),
                                                          data.modules,
-                                                         data.conversion_info.selected_conversion));
+                                                         data.conversion_info.selected_conversion,
+                                                         cost_params));
             }
 
             if (!data.src_caps || gst_caps_is_empty(data.src_caps.get()))
@@ -723,6 +1200,11 @@ static GstStateChangeReturn gst_tcam_bin_change_state(GstElement* element, GstSt
             // this applies the caps to tcamsrc
             g_object_set(self->data->pipeline_caps, "caps", self->data->src_caps.get(), NULL);
 
+            if (is_low_latency(data) && sinkpad)
+            {
+                configure_low_latency_sink(self, *sinkpad);
+            }
+
             /*
              * We send this message as a means of always notifying
              * applications of the output caps we use.
@@ -739,6 +1221,15 @@ static GstStateChangeReturn gst_tcam_bin_change_state(GstElement* element, GstSt
             g_free(caps_info_string);
             gst_element_post_message(element, msg);
 
+            if (is_low_latency(data))
+            {
+                GST_INFO_OBJECT(self,
+                                "Internal pipeline '%s' has an expected latency of "
+                                "%" GST_TIME_FORMAT,
+                                data.pipeline_description.c_str(),
+                                GST_TIME_ARGS(tcambin_get_expected_latency(self)));
+            }
+
             ret = GST_STATE_CHANGE_NO_PREROLL;
             break;
         }
@@ -868,6 +1359,31 @@ static void gst_tcambin_get_property(GObject* object,
             g_value_set_enum(value, self->data->conversion_info.user_selector);
             break;
         }
+        case PROP_DOWNSCALE:
+        {
+            g_value_set_int(value, state.downscale);
+            break;
+        }
+        case PROP_DEBAYER_METHOD:
+        {
+            g_value_set_enum(value, state.debayer_method);
+            break;
+        }
+        case PROP_VIDEO_DIRECTION:
+        {
+            g_value_set_enum(value, state.video_direction);
+            break;
+        }
+        case PROP_LATENCY_PROFILE:
+        {
+            g_value_set_enum(value, state.latency_profile);
+            break;
+        }
+        case PROP_EXPECTED_LATENCY:
+        {
+            g_value_set_uint64(value, tcambin_get_expected_latency(self));
+            break;
+        }
         case PROP_TCAM_PROPERTIES_JSON:
         {
             if (!state.is_open())
@@ -980,6 +1496,77 @@ static void gst_tcambin_set_property(GObject* object,
 
             break;
         }
+        case PROP_DOWNSCALE:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(
+                    self,
+                    "GObject property 'downscale' is not writable in state >= GST_STATE_PAUSED.");
+                return;
+            }
+
+            const int downscale = g_value_get_int(value);
+            if (downscale != 1 && downscale != 2 && downscale != 4)
+            {
+                GST_ERROR_OBJECT(
+                    self, "Invalid downscale factor %d, only 1, 2 and 4 are supported.", downscale);
+                return;
+            }
+            state.downscale = downscale;
+            if (state.tcam_converter
+                && state.conversion_info.selected_conversion == TCAM_BIN_CONVERSION_CONVERT)
+            {
+                g_object_set(state.tcam_converter, "downscale", state.downscale, NULL);
+            }
+            break;
+        }
+        case PROP_DEBAYER_METHOD:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'debayer-method' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.debayer_method = (GstTcamBinDebayerMethod)g_value_get_enum(value);
+            if (state.tcam_converter
+                && state.conversion_info.selected_conversion == TCAM_BIN_CONVERSION_CONVERT)
+            {
+                apply_debayer_method(state.tcam_converter, state.debayer_method);
+            }
+            break;
+        }
+        case PROP_VIDEO_DIRECTION:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'video-direction' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.video_direction = (GstTcamBinVideoDirection)g_value_get_enum(value);
+            if (state.tcam_converter
+                && state.conversion_info.selected_conversion == TCAM_BIN_CONVERSION_CONVERT)
+            {
+                apply_video_direction(state.tcam_converter, state.video_direction);
+            }
+            break;
+        }
+        case PROP_LATENCY_PROFILE:
+        {
+            if (!is_state_null(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'latency-profile' is not writable in state >= "
+                                 "GST_STATE_READY.");
+                return;
+            }
+            state.latency_profile = (GstTcamBinLatencyProfile)g_value_get_enum(value);
+            break;
+        }
         case PROP_TCAMDEVICE:
         {
             if (!is_state_null(self))
@@ -1165,6 +1752,64 @@ static void gst_tcambin_class_init(GstTcamBinClass* klass)
                                                       TCAM_BIN_CONVERSION_AUTO,
                                                       static_cast<GParamFlags>(G_PARAM_READWRITE)));
 
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DOWNSCALE,
+        g_param_spec_int("downscale",
+                         "Downscale",
+                         "Shrinks the output by this factor while debayering. This is only "
+                         "supported with tcamconvert as the conversion element. Valid values are "
+                         "1, 2 and 4.",
+                         1,
+                         4,
+                         1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DEBAYER_METHOD,
+        g_param_spec_enum("debayer-method",
+                          "Debayer method",
+                          "Interpolation used by tcamconvert for 8-bit bayer formats. This is only "
+                          "supported with tcamconvert as the conversion element.",
+                          GST_TYPE_TCAMBIN_DEBAYER_METHOD,
+                          GST_TCAMBIN_DEBAYER_EDGE,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_VIDEO_DIRECTION,
+        g_param_spec_enum("video-direction",
+                          "Video direction",
+                          "Rotation or flip of the output by tcamconvert. This is only supported "
+                          "with tcamconvert as the conversion element.",
+                          GST_TYPE_TCAMBIN_VIDEO_DIRECTION,
+                          GST_TCAMBIN_VIDEO_DIRECTION_IDENTITY,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_LATENCY_PROFILE,
+        g_param_spec_enum("latency-profile",
+                          "Latency profile",
+                          "low-latency avoids conversion chains, uses the minimum number of "
+                          "camera buffers and lets the sink drop late frames",
+                          GST_TYPE_TCAMBIN_LATENCY_PROFILE,
+                          GST_TCAMBIN_LATENCY_PROFILE_DEFAULT,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_EXPECTED_LATENCY,
+        g_param_spec_uint64("expected-latency",
+                            "Expected latency",
+                            "Latency of the internal pipeline in ns, from the start of the "
+                            "exposure until the buffer leaves tcambin",
+                            0,
+                            G_MAXUINT64,
+                            GST_CLOCK_TIME_NONE,
+                            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
     g_object_class_install_property(
         gobject_class,
         PROP_TCAM_PROPERTIES_JSON,
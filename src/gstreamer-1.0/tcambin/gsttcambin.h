@@ -21,6 +21,40 @@
 
 G_BEGIN_DECLS
 
+typedef enum
+{
+    GST_TCAMBIN_LATENCY_PROFILE_DEFAULT,
+    GST_TCAMBIN_LATENCY_PROFILE_LOW,
+} GstTcamBinLatencyProfile;
+
+GType gst_tcambin_latency_profile_get_type(void);
+#define GST_TYPE_TCAMBIN_LATENCY_PROFILE (gst_tcambin_latency_profile_get_type())
+
+// same order and nicks as GstTCamConvertDebayerMethod
+typedef enum
+{
+    GST_TCAMBIN_DEBAYER_NEAREST,
+    GST_TCAMBIN_DEBAYER_BILINEAR,
+    GST_TCAMBIN_DEBAYER_EDGE,
+    GST_TCAMBIN_DEBAYER_HQ,
+} GstTcamBinDebayerMethod;
+
+GType gst_tcambin_debayer_method_get_type(void);
+#define GST_TYPE_TCAMBIN_DEBAYER_METHOD (gst_tcambin_debayer_method_get_type())
+
+// same values and nicks as the first entries of GstVideoOrientationMethod
+typedef enum
+{
+    GST_TCAMBIN_VIDEO_DIRECTION_IDENTITY,
+    GST_TCAMBIN_VIDEO_DIRECTION_90R,
+    GST_TCAMBIN_VIDEO_DIRECTION_180,
+    GST_TCAMBIN_VIDEO_DIRECTION_90L,
+    GST_TCAMBIN_VIDEO_DIRECTION_HORIZ,
+    GST_TCAMBIN_VIDEO_DIRECTION_VERT,
+} GstTcamBinVideoDirection;
+
+GType gst_tcambin_video_direction_get_type(void);
+#define GST_TYPE_TCAMBIN_VIDEO_DIRECTION (gst_tcambin_video_direction_get_type())
 
 #define GST_TYPE_TCAMBIN          (gst_tcambin_get_type())
 #define GST_TCAMBIN(obj)          (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_TCAMBIN, GstTcamBin))
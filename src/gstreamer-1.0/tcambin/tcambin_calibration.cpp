@@ -0,0 +1,436 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tcambin_calibration.h"
+
+#include "../../../external/json/json.hpp"
+#include "../../utils.h"
+#include "../../version.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gst-helper/gst_ptr.h>
+#include <gst-helper/gstcaps_dutils_interop.h>
+#include <gst-helper/helper_functions.h>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+
+using json = nlohmann::json;
+
+GST_DEBUG_CATEGORY_EXTERN(gst_tcambin_debug);
+#define GST_CAT_DEFAULT gst_tcambin_debug
+
+namespace
+{
+// increment when the meaning of the results changes
+constexpr int calibration_version = 1;
+
+constexpr int warmup_frames = 5;
+constexpr int measured_frames = 30;
+
+// a single candidate may not block the state change forever
+constexpr auto benchmark_timeout = std::chrono::seconds(10);
+
+// stored for candidates that could not convert the format
+constexpr double result_failed = -1.0;
+
+const char* get_factory_name(TcamBinConversionElement element)
+{
+    switch (element)
+    {
+        case TCAM_BIN_CONVERSION_CONVERT:
+            return "tcamconvert";
+        case TCAM_BIN_CONVERSION_DUTILS:
+            return "tcamdutils";
+        case TCAM_BIN_CONVERSION_CUDA:
+            return "tcamdutils-cuda";
+        case TCAM_BIN_CONVERSION_AUTO:
+        default:
+            return nullptr;
+    }
+}
+
+std::filesystem::path get_cache_file()
+{
+    auto dir = tcam::get_environment_variable("XDG_CACHE_HOME", "");
+    if (!dir.empty())
+    {
+        return std::filesystem::path(dir) / "tiscamera" / "conversion-calibration.json";
+    }
+    dir = tcam::get_environment_variable("HOME", "");
+    if (!dir.empty())
+    {
+        return std::filesystem::path(dir) / ".cache" / "tiscamera"
+               / "conversion-calibration.json";
+    }
+    return {};
+}
+
+// framerates do not change the conversion cost
+std::string get_cache_key(const GstCaps& caps)
+{
+    auto tmp = gst_helper::make_ptr(gst_caps_copy(&caps));
+    gst_structure_remove_field(gst_caps_get_structure(tmp.get(), 0), "framerate");
+    return gst_helper::to_string(*tmp);
+}
+
+json load_cache(const std::filesystem::path& file)
+{
+    std::ifstream in(file);
+    if (!in)
+    {
+        return {};
+    }
+
+    auto j = json::parse(in, nullptr, false);
+    if (j.is_discarded() || !j.is_object() || j.value("version", 0) != calibration_version
+        || j.value("tiscamera", std::string {}) != get_version() || !j.contains("results")
+        || !j["results"].is_object())
+    {
+        GST_INFO("Ignoring outdated conversion calibration '%s'", file.c_str());
+        return {};
+    }
+    return j;
+}
+
+void store_cache(const std::filesystem::path& file, const json& j)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(file.parent_path(), ec);
+    if (ec)
+    {
+        GST_WARNING("Unable to create '%s': %s", file.parent_path().c_str(), ec.message().c_str());
+        return;
+    }
+
+    // concurrent processes may calibrate at the same time, the last one wins
+    auto tmp_file = file;
+    tmp_file += "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream out(tmp_file, std::ios::trunc);
+        if (!out || !(out << j.dump(4)))
+        {
+            GST_WARNING("Unable to write conversion calibration '%s'", tmp_file.c_str());
+            std::filesystem::remove(tmp_file, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(tmp_file, file, ec);
+    if (ec)
+    {
+        GST_WARNING("Unable to store conversion calibration '%s': %s",
+                    file.c_str(),
+                    ec.message().c_str());
+        std::filesystem::remove(tmp_file, ec);
+    }
+}
+
+
+struct handoff_state
+{
+    std::mutex mtx;
+    std::vector<std::chrono::steady_clock::time_point> times;
+};
+
+void on_handoff(GstElement* /*sink*/, GstBuffer* /*buffer*/, GstPad* /*pad*/, gpointer user_data)
+{
+    auto& state = *static_cast<handoff_state*>(user_data);
+
+    std::lock_guard lck(state.mtx);
+    state.times.push_back(std::chrono::steady_clock::now());
+}
+
+// Converts synthetic frames with factory_name into BGRx.
+// Returns the average time per frame in microseconds.
+std::optional<double> run_benchmark(const char* factory_name, const GstCaps& input_caps)
+{
+    auto type = gst_helper::get_img_type_from_fixated_gstcaps(input_caps);
+    if (type.buffer_length <= 0)
+    {
+        return std::nullopt;
+    }
+
+    auto pipeline = gst_helper::make_ptr(gst_pipeline_new("tcambin-calibration"));
+    auto src = gst_element_factory_make("appsrc", nullptr);
+    auto convert = gst_element_factory_make(factory_name, nullptr);
+    auto filter = gst_element_factory_make("capsfilter", nullptr);
+    auto sink = gst_element_factory_make("fakesink", nullptr);
+
+    if (!pipeline || !src || !convert || !filter || !sink)
+    {
+        for (auto e : { src, convert, filter, sink })
+        {
+            if (e)
+            {
+                gst_object_unref(e);
+            }
+        }
+        return std::nullopt;
+    }
+
+    gst_bin_add_many(GST_BIN(pipeline.get()), src, convert, filter, sink, nullptr);
+    if (!gst_element_link_many(src, convert, filter, sink, nullptr))
+    {
+        return std::nullopt;
+    }
+
+    auto* s = gst_caps_get_structure(&input_caps, 0);
+    int width = 0;
+    int height = 0;
+    gst_structure_get_int(s, "width", &width);
+    gst_structure_get_int(s, "height", &height);
+
+    auto output_caps = gst_helper::make_ptr(gst_caps_new_simple("video/x-raw",
+                                                                "format",
+                                                                G_TYPE_STRING,
+                                                                "BGRx",
+                                                                "width",
+                                                                G_TYPE_INT,
+                                                                width,
+                                                                "height",
+                                                                G_TYPE_INT,
+                                                                height,
+                                                                nullptr));
+
+    g_object_set(G_OBJECT(src),
+                 "caps",
+                 &input_caps,
+                 "format",
+                 GST_FORMAT_TIME,
+                 "max-bytes",
+                 (guint64)0,
+                 nullptr);
+    g_object_set(G_OBJECT(filter), "caps", output_caps.get(), nullptr);
+    g_object_set(G_OBJECT(sink), "sync", FALSE, "signal-handoffs", TRUE, nullptr);
+
+    handoff_state state;
+    state.times.reserve(warmup_frames + measured_frames);
+    g_signal_connect(sink, "handoff", G_CALLBACK(on_handoff), &state);
+
+    if (gst_element_set_state(pipeline.get(), GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    {
+        gst_element_set_state(pipeline.get(), GST_STATE_NULL);
+        return std::nullopt;
+    }
+
+    // some pseudo random content, constant frames may hit shortcuts in the conversion
+    auto buffer =
+        gst_helper::make_ptr(gst_buffer_new_allocate(nullptr, type.buffer_length, nullptr));
+    GstMapInfo info;
+    if (gst_buffer_map(buffer.get(), &info, GST_MAP_WRITE))
+    {
+        uint32_t val = 0x9e3779b9;
+        for (gsize i = 0; i < info.size; ++i)
+        {
+            val = val * 1664525u + 1013904223u;
+            info.data[i] = static_cast<guint8>(val >> 24);
+        }
+        gst_buffer_unmap(buffer.get(), &info);
+    }
+
+    for (int i = 0; i < warmup_frames + measured_frames; ++i)
+    {
+        // the content is never written, so all frames can share the memory
+        auto frame = gst_buffer_copy(buffer.get());
+        GST_BUFFER_PTS(frame) = i * GST_MSECOND;
+        GstFlowReturn flow = GST_FLOW_OK;
+        g_signal_emit_by_name(src, "push-buffer", frame, &flow);
+        gst_buffer_unref(frame);
+        if (flow != GST_FLOW_OK)
+        {
+            break;
+        }
+    }
+    GstFlowReturn flow = GST_FLOW_OK;
+    g_signal_emit_by_name(src, "end-of-stream", &flow);
+
+    auto bus = gst_helper::make_ptr(gst_element_get_bus(pipeline.get()));
+    auto msg = gst_bus_timed_pop_filtered(
+        bus.get(),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(benchmark_timeout).count(),
+        (GstMessageType)(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+
+    bool success = msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS;
+    if (msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR)
+    {
+        GError* err = nullptr;
+        gst_message_parse_error(msg, &err, nullptr);
+        GST_INFO("Calibration of %s failed: %s", factory_name, err ? err->message : "");
+        g_clear_error(&err);
+    }
+    else if (!msg)
+    {
+        GST_WARNING("Calibration of %s timed out", factory_name);
+    }
+    if (msg)
+    {
+        gst_message_unref(msg);
+    }
+
+    gst_element_set_state(pipeline.get(), GST_STATE_NULL);
+
+    std::lock_guard lck(state.mtx);
+    if (!success || state.times.size() < (size_t)(warmup_frames + measured_frames))
+    {
+        return std::nullopt;
+    }
+
+    // appsrc queues all frames up front, so the distance between two handoffs is the time
+    // the conversion needs for one frame
+    auto duration = state.times.back() - state.times.at(warmup_frames - 1);
+    return std::chrono::duration<double, std::micro>(duration).count() / measured_frames;
+}
+
+} // namespace
+
+
+bool tcambin::calibration::is_enabled()
+{
+    return tcam::get_environment_variable_int("TCAM_BIN_CALIBRATE").value_or(0) != 0;
+}
+
+
+TcamBinConversionElement tcambin::calibration::select_fastest(
+    const std::vector<TcamBinConversionElement>& candidates,
+    const GstCaps& input_caps)
+{
+    if (candidates.empty() || !gst_caps_is_fixed(&input_caps))
+    {
+        return TCAM_BIN_CONVERSION_AUTO;
+    }
+    if (candidates.size() == 1)
+    {
+        return candidates.front();
+    }
+
+    // multiple tcambin instances in one process calibrate one after another
+    static std::mutex calibration_mtx;
+    std::lock_guard lck(calibration_mtx);
+
+    const auto cache_file = get_cache_file();
+    const auto key = get_cache_key(input_caps);
+
+    json cache;
+    if (!cache_file.empty())
+    {
+        cache = load_cache(cache_file);
+    }
+    if (cache.empty())
+    {
+        cache = { { "version", calibration_version },
+                  { "tiscamera", get_version() },
+                  { "results", json::object() } };
+    }
+
+    auto& results = cache["results"][key];
+    bool modified = false;
+
+    TcamBinConversionElement fastest = TCAM_BIN_CONVERSION_AUTO;
+    double fastest_time = 0.0;
+
+    for (auto candidate : candidates)
+    {
+        const char* name = get_factory_name(candidate);
+        if (!name)
+        {
+            continue;
+        }
+
+        double us_per_frame = result_failed;
+        if (results.contains(name) && results[name].is_number())
+        {
+            us_per_frame = results[name].get<double>();
+        }
+        else
+        {
+            GST_INFO("Calibrating %s for %s", name, key.c_str());
+
+            us_per_frame = run_benchmark(name, input_caps).value_or(result_failed);
+            results[name] = us_per_frame;
+            modified = true;
+        }
+
+        GST_INFO("%s needs %.1f us per frame for %s", name, us_per_frame, key.c_str());
+
+        if (us_per_frame >= 0.0
+            && (fastest == TCAM_BIN_CONVERSION_AUTO || us_per_frame < fastest_time))
+        {
+            fastest = candidate;
+            fastest_time = us_per_frame;
+        }
+    }
+
+    if (modified && !cache_file.empty())
+    {
+        store_cache(cache_file, cache);
+    }
+
+    return fastest;
+}
+
+
+std::map<uint32_t, double> tcambin::calibration::get_measured_costs()
+{
+    std::map<uint32_t, double> ret;
+
+    const auto cache_file = get_cache_file();
+    if (cache_file.empty())
+    {
+        return ret;
+    }
+
+    const json cache = load_cache(cache_file);
+    if (cache.empty())
+    {
+        return ret;
+    }
+
+    for (const auto& [key, results] : cache["results"].items())
+    {
+        auto caps = gst_helper::make_ptr(gst_caps_from_string(key.c_str()));
+        if (!caps || !gst_caps_is_fixed(caps.get()) || !results.is_object())
+        {
+            continue;
+        }
+
+        const auto type = gst_helper::get_img_type_from_fixated_gstcaps(*caps);
+        const double pixels = static_cast<double>(type.dim.cx) * type.dim.cy;
+        if (type.empty() || pixels <= 0)
+        {
+            continue;
+        }
+
+        for (const auto& [name, us_per_frame] : results.items())
+        {
+            if (!us_per_frame.is_number() || us_per_frame.get<double>() < 0.0)
+            {
+                continue;
+            }
+
+            const double ns_per_pixel = us_per_frame.get<double>() * 1000.0 / pixels;
+            auto iter = ret.find(type.type);
+            if (iter == ret.end() || ns_per_pixel < iter->second)
+            {
+                ret[type.type] = ns_per_pixel;
+            }
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../tcamgstbase/tcambinconversion.h"
+
+#include <cstdint>
+#include <gst/gst.h>
+#include <map>
+#include <vector>
+
+namespace tcambin::calibration
+{
+
+// TCAM_BIN_CALIBRATE
+bool is_enabled();
+
+// Returns the candidate that converts the format of input_caps into BGRx the fastest.
+// Every candidate is measured once per host and format on synthetic frames, the results are
+// kept in $XDG_CACHE_HOME/tiscamera/conversion-calibration.json.
+// input_caps has to be fixed, TCAM_BIN_CONVERSION_AUTO is returned when no candidate could be
+// measured.
+TcamBinConversionElement select_fastest(const std::vector<TcamBinConversionElement>& candidates,
+                                        const GstCaps& input_caps);
+
+// Conversion cost per fourcc in ns per pixel, of the fastest candidate of the formats that
+// were calibrated so far. Nothing is measured here.
+std::map<uint32_t, double> get_measured_costs();
+
+} // namespace tcambin::calibration
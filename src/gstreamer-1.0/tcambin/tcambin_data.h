@@ -7,7 +7,10 @@
 
 #include <gst-helper/helper_functions.h>
 #include <gst/gst.h>
+#include <mutex>
 #include <string>
+#include <tcam-property-1.0.h>
+#include <unordered_map>
 
 
 struct tcambin_conversion
@@ -17,6 +20,34 @@ struct tcambin_conversion
 };
 
 
+// The element (source or converter) that provides a property.
+// Cleared whenever these elements are created or removed.
+class tcambin_property_owners
+{
+public:
+    TcamPropertyProvider* find(const char* name) const
+    {
+        std::lock_guard lck { mtx_ };
+        auto iter = owners_.find(name);
+        return iter != owners_.end() ? iter->second : nullptr;
+    }
+    void insert(const char* name, TcamPropertyProvider* owner)
+    {
+        std::lock_guard lck { mtx_ };
+        owners_[name] = owner;
+    }
+    void clear()
+    {
+        std::lock_guard lck { mtx_ };
+        owners_.clear();
+    }
+
+private:
+    mutable std::mutex mtx_;
+    std::unordered_map<std::string, TcamPropertyProvider*> owners_;
+};
+
+
 struct tcambin_data
 {
     // source init variables, used only in tcambin_create_source
@@ -51,6 +82,19 @@ struct tcambin_data
 
     tcambin_conversion conversion_info = {};
 
+    tcambin_property_owners property_owners;
+
+    // passed to tcamconvert, the device caps are selected at downscale times the output size
+    int downscale = 1;
+    // passed to tcamconvert as 'debayer-method'
+    GstTcamBinDebayerMethod debayer_method = GST_TCAMBIN_DEBAYER_EDGE;
+    // passed to tcamconvert as 'video-direction'
+    GstTcamBinVideoDirection video_direction = GST_TCAMBIN_VIDEO_DIRECTION_IDENTITY;
+
+    GstTcamBinLatencyProfile latency_profile = GST_TCAMBIN_LATENCY_PROFILE_DEFAULT;
+    // e.g. 'tcamsrc ! capsfilter ! tcamconvert', filled by tcambin_create_elements
+    std::string pipeline_description;
+
     bool elements_created = false;
     bool target_set = false;
 
@@ -36,14 +36,16 @@ static GSList* gst_tcambin_get_tcam_property_names(TcamPropertyProvider* iface,
         return nullptr;
     }
 
-    std::vector<std::string> convert_name_list;
-    // if dutils(-cuda) is present then first fetch the names from that
-    // tcamconvert does not offer properties
-    if (self.tcam_converter && TCAM_IS_PROPERTY_PROVIDER(self.tcam_converter))
+    // tcamconvert does not offer properties, the list of the source is handed out as is
+    if (!self.tcam_converter || !TCAM_IS_PROPERTY_PROVIDER(self.tcam_converter))
     {
-        convert_name_list = tcamprop1_consumer::get_property_names_noerror(
-            TCAM_PROPERTY_PROVIDER(self.tcam_converter));
+        return tcam_property_provider_get_tcam_property_names(
+            TCAM_PROPERTY_PROVIDER(self.src_element.get()), err);
     }
+
+    // if dutils(-cuda) is present then first fetch the names from that
+    auto convert_name_list = tcamprop1_consumer::get_property_names_noerror(
+        TCAM_PROPERTY_PROVIDER(self.tcam_converter));
     auto src_prop_list_res =
         tcamprop1_consumer::get_property_names(TCAM_PROPERTY_PROVIDER(self.src_element.get()));
     if (src_prop_list_res.has_error())
@@ -97,18 +99,33 @@ static TcamPropertyBase* gst_tcambin_get_tcam_property(TcamPropertyProvider* ifa
         return nullptr;
     }
 
+    // skip the lookup in the converter for properties that are known to belong to the source
+    if (auto owner = self.property_owners.find(name))
+    {
+        if (auto res = tcam_property_provider_get_tcam_property(owner, name, nullptr))
+        {
+            return res;
+        }
+    }
+
     if (self.tcam_converter && TCAM_IS_PROPERTY_PROVIDER(self.tcam_converter))
     {
-        auto res = tcam_property_provider_get_tcam_property(
-            TCAM_PROPERTY_PROVIDER(self.tcam_converter), name, nullptr);
+        auto converter = TCAM_PROPERTY_PROVIDER(self.tcam_converter);
+        auto res = tcam_property_provider_get_tcam_property(converter, name, nullptr);
         if (res)
         {
+            self.property_owners.insert(name, converter);
             return res;
         }
     }
 
-    return tcam_property_provider_get_tcam_property(
-        TCAM_PROPERTY_PROVIDER(self.src_element.get()), name, err);
+    auto src = TCAM_PROPERTY_PROVIDER(self.src_element.get());
+    auto res = tcam_property_provider_get_tcam_property(src, name, err);
+    if (res)
+    {
+        self.property_owners.insert(name, src);
+    }
+    return res;
 }
 
 
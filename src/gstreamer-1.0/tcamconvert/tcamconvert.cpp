@@ -16,9 +16,12 @@
 
 #include "tcamconvert.h"
 
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamframe.h"
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
 #include "../../version.h"
 #include "tcamconvert_context.h"
 
+#include <algorithm>
 #include <dutils_img/dutils_img.h>
 #include <dutils_img/fcc_to_string.h>
 #include <dutils_img_lib/dutils_gst_interop.h>
@@ -26,11 +29,33 @@
 #include <gst-helper/gstcaps_dutils_interop.h>
 #include <gst-helper/helper_functions.h>
 #include <gst/video/gstvideometa.h>
+#include <gst/video/gstvideopool.h>
+#include <iterator>
+#include <optional>
 #include <vector>
 
 enum
 {
     PROP_0,
+    PROP_N_THREADS,
+    PROP_CPU_AFFINITY,
+    PROP_GAMMA,
+    PROP_CONTRAST_MIN,
+    PROP_CONTRAST_MAX,
+    PROP_COLOR_MATRIX,
+    PROP_ROI,
+    PROP_DOWNSCALE,
+    PROP_OPENCL,
+    PROP_DARK_FRAME,
+    PROP_FLAT_FIELD,
+    PROP_DEFECT_PIXELS,
+    PROP_DOWNSCALE_MODE,
+    PROP_DEBAYER_METHOD,
+    PROP_VIDEO_DIRECTION,
+    PROP_TONE_MAP,
+    PROP_TONE_MAP_LOCAL,
+    PROP_ADAPTIVE_QUALITY,
+    PROP_WORKER_PRIORITY,
 };
 
 GST_DEBUG_CATEGORY_STATIC(gst_tcamconvert_debug_category);
@@ -40,6 +65,89 @@ GST_DEBUG_CATEGORY_STATIC(gst_tcamconvert_debug_category);
 G_DEFINE_TYPE(GstTCamConvert, gst_tcamconvert, GST_TYPE_BASE_TRANSFORM)
 
 
+GType gst_tcamconvert_downscale_mode_get_type(void)
+{
+    static GType tcamconvert_downscale_mode = 0;
+
+    if (!tcamconvert_downscale_mode)
+    {
+        static const GEnumValue downscale_modes[] = {
+            { GST_TCAMCONVERT_DOWNSCALE_DEBAYER, "GST_TCAMCONVERT_DOWNSCALE_DEBAYER", "debayer" },
+            { GST_TCAMCONVERT_DOWNSCALE_AVERAGE, "GST_TCAMCONVERT_DOWNSCALE_AVERAGE", "average" },
+            { GST_TCAMCONVERT_DOWNSCALE_SUM, "GST_TCAMCONVERT_DOWNSCALE_SUM", "sum" },
+            { GST_TCAMCONVERT_DOWNSCALE_SKIP, "GST_TCAMCONVERT_DOWNSCALE_SKIP", "skip" },
+
+            { 0, NULL, NULL }
+        };
+        tcamconvert_downscale_mode =
+            g_enum_register_static("GstTCamConvertDownscaleMode", downscale_modes);
+    }
+    return tcamconvert_downscale_mode;
+}
+
+GType gst_tcamconvert_debayer_method_get_type(void)
+{
+    static GType tcamconvert_debayer_method = 0;
+
+    if (!tcamconvert_debayer_method)
+    {
+        static const GEnumValue debayer_methods[] = {
+            { GST_TCAMCONVERT_DEBAYER_NEAREST, "GST_TCAMCONVERT_DEBAYER_NEAREST", "nearest" },
+            { GST_TCAMCONVERT_DEBAYER_BILINEAR, "GST_TCAMCONVERT_DEBAYER_BILINEAR", "bilinear" },
+            { GST_TCAMCONVERT_DEBAYER_EDGE, "GST_TCAMCONVERT_DEBAYER_EDGE", "edge" },
+            { GST_TCAMCONVERT_DEBAYER_HQ, "GST_TCAMCONVERT_DEBAYER_HQ", "hq" },
+
+            { 0, NULL, NULL }
+        };
+        tcamconvert_debayer_method =
+            g_enum_register_static("GstTCamConvertDebayerMethod", debayer_methods);
+    }
+    return tcamconvert_debayer_method;
+}
+
+GType gst_tcamconvert_tone_map_get_type(void)
+{
+    static GType tcamconvert_tone_map = 0;
+
+    if (!tcamconvert_tone_map)
+    {
+        static const GEnumValue tone_maps[] = {
+            { GST_TCAMCONVERT_TONE_MAP_LINEAR, "GST_TCAMCONVERT_TONE_MAP_LINEAR", "linear" },
+            { GST_TCAMCONVERT_TONE_MAP_GAMMA, "GST_TCAMCONVERT_TONE_MAP_GAMMA", "gamma" },
+            { GST_TCAMCONVERT_TONE_MAP_LOG, "GST_TCAMCONVERT_TONE_MAP_LOG", "log" },
+            { GST_TCAMCONVERT_TONE_MAP_REINHARD, "GST_TCAMCONVERT_TONE_MAP_REINHARD", "reinhard" },
+
+            { 0, NULL, NULL }
+        };
+        tcamconvert_tone_map = g_enum_register_static("GstTCamConvertToneMap", tone_maps);
+    }
+    return tcamconvert_tone_map;
+}
+
+GType gst_tcamconvert_worker_priority_get_type(void)
+{
+    static GType tcamconvert_worker_priority = 0;
+
+    if (!tcamconvert_worker_priority)
+    {
+        static const GEnumValue worker_priorities[] = {
+            { GST_TCAMCONVERT_WORKER_PRIORITY_LOW, "GST_TCAMCONVERT_WORKER_PRIORITY_LOW", "low" },
+            { GST_TCAMCONVERT_WORKER_PRIORITY_NORMAL,
+              "GST_TCAMCONVERT_WORKER_PRIORITY_NORMAL",
+              "normal" },
+            { GST_TCAMCONVERT_WORKER_PRIORITY_HIGH,
+              "GST_TCAMCONVERT_WORKER_PRIORITY_HIGH",
+              "high" },
+
+            { 0, NULL, NULL }
+        };
+        tcamconvert_worker_priority =
+            g_enum_register_static("GstTCamConvertWorkerPriority", worker_priorities);
+    }
+    return tcamconvert_worker_priority;
+}
+
+
 static tcamconvert::tcamconvert_context_base& get_gst_elem_reference(GstTCamConvert* iface)
 {
     GstTCamConvert* self = GST_TCAMCONVERT(iface);
@@ -48,34 +156,277 @@ static tcamconvert::tcamconvert_context_base& get_gst_elem_reference(GstTCamConv
     return *self->context_;
 }
 
-/* No properties are implemented, so only a warning is produced */
-static void gst_tcamconvert_set_property(GObject* object __attribute__((unused)),
+static void gst_tcamconvert_set_property(GObject* object,
                                          guint prop_id,
-                                         const GValue* value __attribute__((unused)),
+                                         const GValue* value,
                                          GParamSpec* pspec)
 {
+    auto& elem = get_gst_elem_reference(GST_TCAMCONVERT(object));
+
     switch (prop_id)
     {
+        case PROP_N_THREADS:
+        {
+            elem.set_thread_count(g_value_get_int(value));
+            break;
+        }
+        case PROP_CPU_AFFINITY:
+        {
+            const char* str = g_value_get_string(value);
+            if (!elem.set_cpu_affinity(str ? str : ""))
+            {
+                GST_WARNING_OBJECT(object, "Unable to parse cpu-affinity '%s'", str);
+            }
+            break;
+        }
+        case PROP_GAMMA:
+        {
+            elem.set_gamma(g_value_get_double(value));
+            break;
+        }
+        case PROP_CONTRAST_MIN:
+        {
+            elem.set_contrast_min(g_value_get_double(value));
+            break;
+        }
+        case PROP_CONTRAST_MAX:
+        {
+            elem.set_contrast_max(g_value_get_double(value));
+            break;
+        }
+        case PROP_TONE_MAP:
+        {
+            // GstTCamConvertToneMap has the order of img_filter::filter::tone_map::op
+            elem.set_tone_map(
+                static_cast<img_filter::filter::tone_map::op>(g_value_get_enum(value)));
+            break;
+        }
+        case PROP_TONE_MAP_LOCAL:
+        {
+            elem.set_tone_map_local(g_value_get_double(value));
+            break;
+        }
+        case PROP_COLOR_MATRIX:
+        {
+            const char* str = g_value_get_string(value);
+            if (!elem.set_color_matrix(str ? str : ""))
+            {
+                GST_WARNING_OBJECT(object, "Unable to parse color-matrix '%s'", str);
+            }
+            break;
+        }
+        case PROP_ROI:
+        {
+            const char* str = g_value_get_string(value);
+            if (!elem.set_roi(str ? str : ""))
+            {
+                GST_WARNING_OBJECT(object, "Unable to parse roi '%s'", str);
+            }
+            break;
+        }
+        case PROP_DOWNSCALE:
+        {
+            if (!elem.set_downscale(g_value_get_int(value)))
+            {
+                GST_WARNING_OBJECT(
+                    object, "Unsupported downscale factor %d", g_value_get_int(value));
+            }
+            break;
+        }
+        case PROP_DOWNSCALE_MODE:
+        {
+            // GstTCamConvertDownscaleMode has the order of tcamconvert::downscale_mode
+            elem.set_downscale_mode(
+                static_cast<tcamconvert::downscale_mode>(g_value_get_enum(value)));
+            break;
+        }
+        case PROP_DEBAYER_METHOD:
+        {
+            // GstTCamConvertDebayerMethod has the order of tcamconvert::debayer_method
+            elem.set_debayer_method(
+                static_cast<tcamconvert::debayer_method>(g_value_get_enum(value)));
+            break;
+        }
+        case PROP_VIDEO_DIRECTION:
+        {
+            // identity to vert have the order of img_filter::transform::orientation::mode
+            const auto method = static_cast<GstVideoOrientationMethod>(g_value_get_enum(value));
+            if (method > GST_VIDEO_ORIENTATION_VERT)
+            {
+                GST_WARNING_OBJECT(object, "Unsupported video-direction %d", method);
+                break;
+            }
+            elem.set_orientation(static_cast<img_filter::transform::orientation::mode>(method));
+            break;
+        }
+        case PROP_OPENCL:
+        {
+            elem.set_use_opencl(g_value_get_boolean(value));
+            break;
+        }
+        case PROP_DARK_FRAME:
+        {
+            const char* str = g_value_get_string(value);
+            elem.set_dark_frame(str ? str : "");
+            break;
+        }
+        case PROP_FLAT_FIELD:
+        {
+            const char* str = g_value_get_string(value);
+            elem.set_flat_field(str ? str : "");
+            break;
+        }
+        case PROP_DEFECT_PIXELS:
+        {
+            const char* str = g_value_get_string(value);
+            elem.set_defect_pixels(str ? str : "");
+            break;
+        }
+        case PROP_ADAPTIVE_QUALITY:
+        {
+            elem.set_adaptive_quality(g_value_get_boolean(value));
+            break;
+        }
+        case PROP_WORKER_PRIORITY:
+        {
+            // GstTCamConvertWorkerPriority has the order of tcamconvert::worker_priority
+            elem.set_worker_priority(
+                static_cast<tcamconvert::worker_priority>(g_value_get_enum(value)));
+            break;
+        }
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
     }
 }
 
-static void gst_tcamconvert_get_property(GObject* object __attribute__((unused)),
+static void gst_tcamconvert_get_property(GObject* object,
                                          guint prop_id,
-                                         GValue* value __attribute__((unused)),
+                                         GValue* value,
                                          GParamSpec* pspec)
 {
+    auto& elem = get_gst_elem_reference(GST_TCAMCONVERT(object));
 
     switch (prop_id)
     {
+        case PROP_N_THREADS:
+        {
+            g_value_set_int(value, elem.get_thread_count());
+            break;
+        }
+        case PROP_CPU_AFFINITY:
+        {
+            g_value_set_string(value, elem.get_cpu_affinity().c_str());
+            break;
+        }
+        case PROP_GAMMA:
+        {
+            g_value_set_double(value, elem.get_gamma());
+            break;
+        }
+        case PROP_CONTRAST_MIN:
+        {
+            g_value_set_double(value, elem.get_contrast_min());
+            break;
+        }
+        case PROP_CONTRAST_MAX:
+        {
+            g_value_set_double(value, elem.get_contrast_max());
+            break;
+        }
+        case PROP_TONE_MAP:
+        {
+            g_value_set_enum(value, static_cast<gint>(elem.get_tone_map()));
+            break;
+        }
+        case PROP_TONE_MAP_LOCAL:
+        {
+            g_value_set_double(value, elem.get_tone_map_local());
+            break;
+        }
+        case PROP_COLOR_MATRIX:
+        {
+            g_value_set_string(value, elem.get_color_matrix().c_str());
+            break;
+        }
+        case PROP_ROI:
+        {
+            g_value_set_string(value, elem.get_roi().c_str());
+            break;
+        }
+        case PROP_DOWNSCALE:
+        {
+            g_value_set_int(value, elem.get_downscale());
+            break;
+        }
+        case PROP_DOWNSCALE_MODE:
+        {
+            g_value_set_enum(value, static_cast<gint>(elem.get_downscale_mode()));
+            break;
+        }
+        case PROP_DEBAYER_METHOD:
+        {
+            g_value_set_enum(value, static_cast<gint>(elem.get_debayer_method()));
+            break;
+        }
+        case PROP_VIDEO_DIRECTION:
+        {
+            g_value_set_enum(value, static_cast<gint>(elem.get_orientation()));
+            break;
+        }
+        case PROP_OPENCL:
+        {
+            g_value_set_boolean(value, elem.get_use_opencl());
+            break;
+        }
+        case PROP_DARK_FRAME:
+        {
+            g_value_set_string(value, elem.get_dark_frame().c_str());
+            break;
+        }
+        case PROP_FLAT_FIELD:
+        {
+            g_value_set_string(value, elem.get_flat_field().c_str());
+            break;
+        }
+        case PROP_DEFECT_PIXELS:
+        {
+            g_value_set_string(value, elem.get_defect_pixels().c_str());
+            break;
+        }
+        case PROP_ADAPTIVE_QUALITY:
+        {
+            g_value_set_boolean(value, elem.get_adaptive_quality());
+            break;
+        }
+        case PROP_WORKER_PRIORITY:
+        {
+            g_value_set_enum(value, static_cast<gint>(elem.get_worker_priority()));
+            break;
+        }
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
     }
 }
 
+static auto get_yuv_colorimetry(GstTCamConvert* self, const GstVideoColorimetry& clr)
+    -> img_filter::transform::yuv_colorimetry
+{
+    using img_filter::transform::yuv_colorimetry;
+
+    const bool full_range = clr.range == GST_VIDEO_COLOR_RANGE_0_255;
+    if (clr.matrix == GST_VIDEO_COLOR_MATRIX_BT601)
+    {
+        return full_range ? yuv_colorimetry::bt601_full : yuv_colorimetry::bt601;
+    }
+    if (clr.matrix != GST_VIDEO_COLOR_MATRIX_BT709)
+    {
+        GST_WARNING_OBJECT(self, "Unsupported color matrix %d, using BT.709", clr.matrix);
+    }
+    return full_range ? yuv_colorimetry::bt709_full : yuv_colorimetry::bt709;
+}
+
 static gboolean gst_tcamconvert_set_caps(GstBaseTransform* base, GstCaps* incaps, GstCaps* outcaps)
 {
     GstTCamConvert* self = GST_TCAMCONVERT(base);
@@ -97,7 +448,21 @@ static gboolean gst_tcamconvert_set_caps(GstBaseTransform* base, GstCaps* incaps
         return FALSE;
     }
 
-    if (!elem.setup(src, dst))
+    // GStreamer fills in the default colorimetry when the caps do not contain one
+    auto yuv_clr = img_filter::transform::yuv_colorimetry::bt709;
+    elem.dst_video_info_.reset();
+    if (tcamconvert::tcamconvert_is_yuv_output_fcc(dst.fourcc_type()))
+    {
+        GstVideoInfo info;
+        if (!gst_video_info_from_caps(&info, outcaps))
+        {
+            return FALSE;
+        }
+        yuv_clr = get_yuv_colorimetry(self, GST_VIDEO_INFO_COLORIMETRY(&info));
+        elem.dst_video_info_ = info;
+    }
+
+    if (!elem.setup(src, dst, yuv_clr))
     {
         GST_ELEMENT_ERROR(self,
                           STREAM,
@@ -108,15 +473,81 @@ static gboolean gst_tcamconvert_set_caps(GstBaseTransform* base, GstCaps* incaps
                           (NULL));
         return FALSE;
     }
+
+    // Conversions that do not need more room than the source write into the input buffer, so
+    // no output buffer has to be allocated and written cold
+    const bool in_place = src != dst && elem.can_transform_in_place();
+    gst_base_transform_set_in_place(base, in_place);
+    if (elem.get_active_orientation() != img_filter::transform::orientation::mode::identity)
+    {
+        // equal caps do not mean the image stays the same
+        gst_base_transform_set_passthrough(base, FALSE);
+    }
+    GST_DEBUG_OBJECT(self, "Converting %s", in_place ? "in place" : "into new buffers");
     return TRUE;
 }
 
 
+// Dimensions on the other side of a raw downscale, see calc_binned_dim.
+// A fixed output size is produced by a range of input sizes.
+static void scale_raw_downscale_dim(GstStructure& structure,
+                                    img::fourcc raw_fcc,
+                                    int factor,
+                                    GstPadDirection direction)
+{
+    int width = 0;
+    int height = 0;
+    if (!gst_structure_get_int(&structure, "width", &width)
+        || !gst_structure_get_int(&structure, "height", &height))
+    {
+        // ranges and lists are only scaled, setup checks the exact dimensions
+        if (direction == GST_PAD_SRC)
+        {
+            gst_helper::scale_gst_struct_image_dim(structure, factor, 1);
+        }
+        else
+        {
+            gst_helper::scale_gst_struct_image_dim(structure, 1, factor);
+        }
+        return;
+    }
+
+    if (direction == GST_PAD_SRC)
+    {
+        // the remaining columns and lines of the input are dropped
+        const int remainder = img::is_bayer_fcc(raw_fcc) ? 2 * factor - 1 : factor - 1;
+        gst_structure_set(&structure,
+                          "width",
+                          GST_TYPE_INT_RANGE,
+                          width * factor,
+                          width * factor + remainder,
+                          "height",
+                          GST_TYPE_INT_RANGE,
+                          height * factor,
+                          height * factor + remainder,
+                          nullptr);
+    }
+    else
+    {
+        const auto dim = img_filter::transform::binning::calc_binned_dim(
+            raw_fcc, img::dim { width, height }, factor);
+        gst_structure_set(
+            &structure, "width", G_TYPE_INT, dim.cx, "height", G_TYPE_INT, dim.cy, nullptr);
+    }
+}
+
+
 static void create_fmt(GstCaps* res_caps,
                        const GstStructure* structure,
                        img::fourcc fourcc,
-                       GstPadDirection direction)
+                       GstPadDirection direction,
+                       const img::rect& roi,
+                       int downscale,
+                       tcamconvert::downscale_mode mode,
+                       img_filter::transform::orientation::mode orientation)
 {
+    const bool orients = orientation != img_filter::transform::orientation::mode::identity;
+
     std::vector<img::fourcc> vec;
     if (direction == GST_PAD_SRC)
     {
@@ -129,6 +560,29 @@ static void create_fmt(GstCaps* res_caps,
 
     for (const auto& fcc : vec)
     {
+        const auto src_fcc = direction == GST_PAD_SRC ? fcc : fourcc;
+        const auto dst_fcc = direction == GST_PAD_SRC ? fourcc : fcc;
+        const bool downscales_raw = downscale != 1 && mode != tcamconvert::downscale_mode::debayer;
+        const auto raw_fcc = downscales_raw
+                                 ? tcamconvert::tcamconvert_get_raw_downscale_fcc(src_fcc, dst_fcc)
+                                 : img::fourcc::FCC_NULL;
+        if (downscales_raw)
+        {
+            if (raw_fcc == img::fourcc::FCC_NULL)
+            {
+                continue;
+            }
+        }
+        else if (downscale != 1
+                 && (downscale == 3 || !tcamconvert::tcamconvert_can_downscale(src_fcc, dst_fcc)))
+        {
+            continue;
+        }
+        if (orients && !img_filter::transform::orientation::can_orient(dst_fcc))
+        {
+            continue;
+        }
+
         auto caps_fmt = img_lib::gst::fourcc_to_gst_caps_descr(fcc);
 
         if (!caps_fmt.gst_struct_name)
@@ -150,6 +604,60 @@ static void create_fmt(GstCaps* res_caps,
             gst_structure_set(tmp_struc, "format", G_TYPE_STRING, caps_fmt.format_entry, nullptr);
         }
 
+        // the roi and downscale refer to the output before it is rotated
+        const bool swaps_dim = img_filter::transform::orientation::swaps_dim(orientation);
+        if (swaps_dim && direction == GST_PAD_SRC)
+        {
+            gst_helper::swap_gst_struct_image_dim(*tmp_struc);
+        }
+
+        // With a roi the output has its dimensions and the input has to contain it
+        if (!roi.is_null())
+        {
+            if (direction == GST_PAD_SRC)
+            {
+                gst_structure_set(tmp_struc,
+                                  "width",
+                                  GST_TYPE_INT_RANGE,
+                                  roi.right,
+                                  G_MAXINT,
+                                  "height",
+                                  GST_TYPE_INT_RANGE,
+                                  roi.bottom,
+                                  G_MAXINT,
+                                  nullptr);
+            }
+            else
+            {
+                const auto dim = downscales_raw
+                                     ? img_filter::transform::binning::calc_binned_dim(
+                                         raw_fcc, roi.dimensions(), downscale)
+                                     : roi.dimensions() / downscale;
+                gst_structure_set(
+                    tmp_struc, "width", G_TYPE_INT, dim.cx, "height", G_TYPE_INT, dim.cy, nullptr);
+            }
+        }
+        else if (downscales_raw)
+        {
+            scale_raw_downscale_dim(*tmp_struc, raw_fcc, downscale, direction);
+        }
+        else if (downscale != 1)
+        {
+            if (direction == GST_PAD_SRC)
+            {
+                gst_helper::scale_gst_struct_image_dim(*tmp_struc, downscale, 1);
+            }
+            else
+            {
+                gst_helper::scale_gst_struct_image_dim(*tmp_struc, 1, downscale);
+            }
+        }
+
+        if (swaps_dim && direction == GST_PAD_SINK)
+        {
+            gst_helper::swap_gst_struct_image_dim(*tmp_struc);
+        }
+
         // gst_caps_new_full takes ownership of tmp_struc
         GstCaps* caps_to_add = gst_caps_new_full(tmp_struc, nullptr);
 
@@ -157,7 +665,12 @@ static void create_fmt(GstCaps* res_caps,
     }
 }
 
-static GstCaps* transform_caps(GstCaps* caps, GstPadDirection direction)
+static GstCaps* transform_caps(GstCaps* caps,
+                               GstPadDirection direction,
+                               const img::rect& roi,
+                               int downscale,
+                               tcamconvert::downscale_mode mode,
+                               img_filter::transform::orientation::mode orientation)
 {
     GstCaps* res_caps = gst_caps_new_empty();
 
@@ -169,7 +682,10 @@ static GstCaps* transform_caps(GstCaps* caps, GstPadDirection direction)
         auto fcc_vec = gst_helper::convert_GstStructure_to_fcc_list(*structure);
 
         // for every entry in fcc_vec create a GstCaps that is appended to res_caps
-        for (auto&& fcc : fcc_vec) { create_fmt(res_caps, structure, fcc, direction); }
+        for (auto&& fcc : fcc_vec)
+        {
+            create_fmt(res_caps, structure, fcc, direction, roi, downscale, mode, orientation);
+        }
     }
 
     // res_caps = gst_caps_simplify(res_caps); // This seems to simplify in a 'curious' way, so we should not use this here
@@ -195,7 +711,15 @@ static GstCaps* gst_tcamconvert_transform_caps(GstBaseTransform* base,
         return dir == GST_PAD_SRC ? "GST_PAD_SRC" : "GST_PAD_SINK";
     };
 
-    GstCaps* res_caps = transform_caps(caps, direction);
+    const auto& elem = get_gst_elem_reference(GST_TCAMCONVERT(base));
+
+    GstCaps* res_caps =
+        transform_caps(caps,
+                       direction,
+                       elem.get_roi_rect(),
+                       elem.get_downscale(),
+                       elem.get_downscale_mode(),
+                       elem.get_software_orientation());
     if (filter)
     {
         GstCaps* tmp_caps = res_caps;
@@ -233,6 +757,15 @@ static gboolean gst_tcamconvert_get_unit_size(GstBaseTransform* trans, GstCaps*
         return FALSE;
     }
     size_t img_size = img::calc_minimum_img_size(type.fourcc_type(), type.dim);
+    if (tcamconvert::tcamconvert_is_yuv_output_fcc(type.fourcc_type()))
+    {
+        // GStreamer pads the planes of some widths
+        GstVideoInfo info;
+        if (gst_video_info_from_caps(&info, caps))
+        {
+            img_size = GST_VIDEO_INFO_SIZE(&info);
+        }
+    }
     if (img_size == 0)
     {
         GST_ELEMENT_ERROR(trans,
@@ -280,6 +813,297 @@ static img::img_descriptor make_img_desc_from_input_buffer(const img::img_type&
         src_type, map_in_data); // no explicit stride mentioned, so assume linear memory
 }
 
+static img::img_descriptor make_img_desc_from_video_info(const img::img_type& type,
+                                                         const GstVideoInfo& info,
+                                                         guint8* data)
+{
+    img::img_planar_layout_data planes = {};
+    for (guint i = 0; i < GST_VIDEO_INFO_N_PLANES(&info) && i < std::size(planes.planes); ++i)
+    {
+        planes.planes[i] = img::img_plane { data + GST_VIDEO_INFO_PLANE_OFFSET(&info, i),
+                                            GST_VIDEO_INFO_PLANE_STRIDE(&info, i) };
+    }
+    return img::make_img_desc_raw(
+        type.fourcc_type(), type.dim, static_cast<int>(GST_VIDEO_INFO_SIZE(&info)), planes);
+}
+
+// Buffers from a GstVideoBufferPool carry the layout of their planes in a GstVideoMeta
+static img::img_descriptor make_img_desc_from_output_buffer(
+    const tcamconvert::tcamconvert_context_base& elem,
+    guint8* map_out_data,
+    GstBuffer* outbuf)
+{
+    const auto& type = elem.dst_type_;
+
+    auto video_meta_ptr = reinterpret_cast<GstVideoMeta*>(
+        gst_buffer_get_meta(outbuf, gst_video_meta_api_get_type()));
+    if (video_meta_ptr != nullptr && video_meta_ptr->stride[0] != 0)
+    {
+        img::img_planar_layout_data planes = {};
+        for (guint i = 0; i < video_meta_ptr->n_planes && i < std::size(planes.planes); ++i)
+        {
+            planes.planes[i] = img::img_plane { map_out_data + video_meta_ptr->offset[i],
+                                                video_meta_ptr->stride[i] };
+        }
+        return img::make_img_desc_raw(type.fourcc_type(),
+                                      type.dim,
+                                      static_cast<int>(gst_buffer_get_size(outbuf)),
+                                      planes);
+    }
+    if (elem.dst_video_info_)
+    {
+        return make_img_desc_from_video_info(type, *elem.dst_video_info_, map_out_data);
+    }
+    return img::make_img_desc_from_linear_memory(type, map_out_data);
+}
+
+// The region metas copied from the input buffer refer to the whole input image, so they are moved
+// into the coordinates of the converted roi and clipped to it
+static void move_roi_metas_into_output(GstBuffer* outbuf, const img::rect& roi)
+{
+    if (roi.is_null())
+    {
+        return;
+    }
+
+    gpointer state = nullptr;
+    GstMeta* meta = nullptr;
+    while ((meta = gst_buffer_iterate_meta_filtered(
+                outbuf, &state, GST_VIDEO_REGION_OF_INTEREST_META_API_TYPE)))
+    {
+        auto* roi_meta = reinterpret_cast<GstVideoRegionOfInterestMeta*>(meta);
+
+        const auto region = img::rect { img::point { static_cast<int>(roi_meta->x) - roi.left,
+                                                     static_cast<int>(roi_meta->y) - roi.top },
+                                        img::dim { static_cast<int>(roi_meta->w),
+                                                   static_cast<int>(roi_meta->h) } };
+        const auto clipped = img::intersect_with_image_dim(region, roi.dimensions());
+
+        roi_meta->x = clipped.left;
+        roi_meta->y = clipped.top;
+        roi_meta->w = clipped.dimensions().cx;
+        roi_meta->h = clipped.dimensions().cy;
+    }
+}
+
+// The region metas refer to the output before it was rotated or flipped, dim are its dimensions
+static void orient_roi_metas(GstBuffer* outbuf,
+                             const img::dim& dim,
+                             img_filter::transform::orientation::mode orientation)
+{
+    using img_filter::transform::orientation::mode;
+    if (orientation == mode::identity)
+    {
+        return;
+    }
+
+    gpointer state = nullptr;
+    GstMeta* meta = nullptr;
+    while ((meta = gst_buffer_iterate_meta_filtered(
+                outbuf, &state, GST_VIDEO_REGION_OF_INTEREST_META_API_TYPE)))
+    {
+        auto* roi_meta = reinterpret_cast<GstVideoRegionOfInterestMeta*>(meta);
+
+        const int x = roi_meta->x;
+        const int y = roi_meta->y;
+        const int w = roi_meta->w;
+        const int h = roi_meta->h;
+        switch (orientation)
+        {
+            case mode::rotate_90:
+                roi_meta->x = std::max(0, dim.cy - (y + h));
+                roi_meta->y = x;
+                std::swap(roi_meta->w, roi_meta->h);
+                break;
+            case mode::rotate_180:
+                roi_meta->x = std::max(0, dim.cx - (x + w));
+                roi_meta->y = std::max(0, dim.cy - (y + h));
+                break;
+            case mode::rotate_270:
+                roi_meta->x = y;
+                roi_meta->y = std::max(0, dim.cx - (x + w));
+                std::swap(roi_meta->w, roi_meta->h);
+                break;
+            case mode::flip_horizontal:
+                roi_meta->x = std::max(0, dim.cx - (x + w));
+                break;
+            case mode::flip_vertical:
+                roi_meta->y = std::max(0, dim.cy - (y + h));
+                break;
+            case mode::identity:
+                break;
+        }
+    }
+}
+
+// Position of buf in the exposure bracket of tcamsrc, nullopt when HDR bracketing is off
+static std::optional<tcamconvert::hdr_bracket_info> get_hdr_bracket_info(GstBuffer* buf)
+{
+    if (auto frame_meta = gst_buffer_get_tcam_frame_meta(buf))
+    {
+        const auto& data = frame_meta->data;
+        if (data.hdr_bracket_count < 2)
+        {
+            return std::nullopt;
+        }
+
+        tcamconvert::hdr_bracket_info info;
+        info.index = static_cast<int>(data.hdr_bracket_index);
+        info.count = static_cast<int>(data.hdr_bracket_count);
+        info.exposure_us = data.hdr_exposure_time;
+        info.frame_count = data.frame_count + data.frames_dropped;
+        return info;
+    }
+
+    auto meta = gst_buffer_get_tcam_statistics_meta(buf);
+    if (!meta || !meta->structure)
+    {
+        return std::nullopt;
+    }
+
+    guint index = 0;
+    guint count = 0;
+    if (!gst_structure_get_uint(meta->structure, "hdr_bracket_index", &index)
+        || !gst_structure_get_uint(meta->structure, "hdr_bracket_count", &count) || count < 2)
+    {
+        return std::nullopt;
+    }
+
+    tcamconvert::hdr_bracket_info info;
+    info.index = static_cast<int>(index);
+    info.count = static_cast<int>(count);
+    gst_structure_get_double(meta->structure, "hdr_exposure_time", &info.exposure_us);
+
+    // frames the device produced, so that dropped images break the bracket
+    guint64 frame_count = 0;
+    guint64 frames_dropped = 0;
+    gst_structure_get_uint64(meta->structure, "frame_count", &frame_count);
+    gst_structure_get_uint64(meta->structure, "frames_dropped", &frames_dropped);
+    info.frame_count = frame_count + frames_dropped;
+    return info;
+}
+
+static void post_degradation_report(GstTCamConvert* self,
+                                    const tcamconvert::degradation_report& report)
+{
+    GST_INFO_OBJECT(self,
+                    "Conversion quality changed from %s to %s",
+                    tcamconvert::to_string(report.previous),
+                    tcamconvert::to_string(report.level));
+
+    GstStructure* struc = gst_structure_new("tcamconvert-quality",
+                                            "level",
+                                            G_TYPE_STRING,
+                                            tcamconvert::to_string(report.level),
+                                            "previous-level",
+                                            G_TYPE_STRING,
+                                            tcamconvert::to_string(report.previous),
+                                            "frames-converted",
+                                            G_TYPE_UINT64,
+                                            static_cast<guint64>(report.frames_converted),
+                                            "frames-degraded",
+                                            G_TYPE_UINT64,
+                                            static_cast<guint64>(report.frames_degraded),
+                                            "frames-skipped",
+                                            G_TYPE_UINT64,
+                                            static_cast<guint64>(report.frames_skipped),
+                                            "qos-proportion",
+                                            G_TYPE_DOUBLE,
+                                            report.qos_proportion,
+                                            "conversion-time-us",
+                                            G_TYPE_DOUBLE,
+                                            report.conversion_time_us,
+                                            "frame-interval-us",
+                                            G_TYPE_DOUBLE,
+                                            report.frame_interval_us,
+                                            nullptr);
+
+    gst_element_post_message(GST_ELEMENT(self), gst_message_new_element(GST_OBJECT(self), struc));
+}
+
+// The frame_count tcamsrc gave inbuf, 0 when the buffer does not come from tcamsrc
+static guint64 get_frame_count(GstBuffer* buf)
+{
+    if (auto frame_meta = gst_buffer_get_tcam_frame_meta(buf))
+    {
+        return frame_meta->data.frame_count;
+    }
+
+    guint64 frame_count = 0;
+    auto meta = gst_buffer_get_tcam_statistics_meta(buf);
+    if (meta && meta->structure)
+    {
+        gst_structure_get_uint64(meta->structure, "frame_count", &frame_count);
+    }
+    return frame_count;
+}
+
+// Sends the statistics the conversion of inbuf collected upstream, so that the auto algorithms of
+// tcamsrc do not have to read the image again
+static void push_image_statistics(GstTCamConvert* self,
+                                  tcamconvert::tcamconvert_context_base& elem,
+                                  GstBuffer* inbuf)
+{
+    auto stats = elem.get_statistics();
+    if (!stats)
+    {
+        return;
+    }
+    const auto frame_count = get_frame_count(inbuf);
+    if (frame_count == 0)
+    {
+        elem.on_statistics_pushed(false);
+        return;
+    }
+
+    GBytes* bytes = g_bytes_new(stats, sizeof(*stats));
+    GstStructure* struc = gst_structure_new("tcam-image-statistics",
+                                            "frame-count",
+                                            G_TYPE_UINT64,
+                                            frame_count,
+                                            "statistics",
+                                            G_TYPE_BYTES,
+                                            bytes,
+                                            nullptr);
+    g_bytes_unref(bytes);
+
+    // false when no element upstream uses them, e.g. when all auto functions are off
+    GstEvent* event = gst_event_new_custom(GST_EVENT_CUSTOM_UPSTREAM, struc);
+    elem.on_statistics_pushed(gst_pad_push_event(GST_BASE_TRANSFORM_SINK_PAD(self), event));
+}
+
+// Converts src into dst, or merges it with the other images of its exposure bracket.
+// Returns false when src was only stored or skipped by the adaptive quality and nothing is pushed
+// downstream.
+static bool convert_image(GstTCamConvert* self,
+                          tcamconvert::tcamconvert_context_base& elem,
+                          GstBuffer* inbuf,
+                          const img::img_descriptor& src,
+                          const img::img_descriptor& dst)
+{
+    if (elem.can_merge_hdr())
+    {
+        if (auto info = get_hdr_bracket_info(inbuf))
+        {
+            return elem.transform_hdr(src, dst, *info);
+        }
+    }
+
+    const auto pts = GST_BUFFER_PTS(inbuf);
+    const bool convert = elem.begin_frame(GST_CLOCK_TIME_IS_VALID(pts) ? static_cast<int64_t>(pts)
+                                                                       : -1);
+    if (convert)
+    {
+        elem.transform(src, dst);
+        push_image_statistics(self, elem, inbuf);
+    }
+    if (auto report = elem.take_degradation_report())
+    {
+        post_degradation_report(self, *report);
+    }
+    return convert;
+}
+
 static GstFlowReturn gst_tcamconvert_transform(GstBaseTransform* base,
                                                GstBuffer* inbuf,
                                                GstBuffer* outbuf)
@@ -304,19 +1128,82 @@ static GstFlowReturn gst_tcamconvert_transform(GstBaseTransform* base,
     }
 
     auto src = make_img_desc_from_input_buffer(elem.src_type_, map_in.data, inbuf);
-    auto dst = img::make_img_desc_from_linear_memory(elem.dst_type_, map_out.data);
+    auto dst = make_img_desc_from_output_buffer(elem, map_out.data, outbuf);
 
-    elem.transform(src, dst);
+    const bool converted = convert_image(self, elem, inbuf, src, dst);
 
     gst_buffer_unmap(outbuf, &map_out);
     gst_buffer_unmap(inbuf, &map_in);
 
+    if (!converted)
+    {
+        return GST_BASE_TRANSFORM_FLOW_DROPPED;
+    }
+
+    move_roi_metas_into_output(outbuf, elem.get_active_roi());
+    const auto orientation = elem.get_active_orientation();
+    orient_roi_metas(outbuf,
+                     img_filter::transform::orientation::calc_oriented_dim(elem.dst_type_.dim,
+                                                                           orientation),
+                     orientation);
+
+    return GST_FLOW_OK;
+}
+
+// Converts inbuf into itself, see tcamconvert_context_base::can_transform_in_place
+static GstFlowReturn transform_in_place(GstTCamConvert* self, GstBuffer* inbuf)
+{
+    auto& elem = get_gst_elem_reference(self);
+
+    const auto dst_size =
+        img::calc_minimum_img_size(elem.dst_type_.fourcc_type(), elem.dst_type_.dim);
+    if (gst_buffer_get_size(inbuf) < dst_size)
+    {
+        GST_ERROR_OBJECT(self, "Input buffer is too small for an in place conversion");
+        return GST_FLOW_ERROR;
+    }
+
+    GstMapInfo map_in;
+    if (!gst_buffer_map(inbuf, &map_in, GST_MAP_READWRITE))
+    {
+        GST_ERROR_OBJECT(self, "Input buffer could not be mapped");
+        return GST_FLOW_OK;
+    }
+
+    auto src = make_img_desc_from_input_buffer(elem.src_type_, map_in.data, inbuf);
+    auto dst = img::make_img_desc_from_linear_memory(elem.dst_type_, map_in.data);
+
+    const bool converted = convert_image(self, elem, inbuf, src, dst);
+
+    gst_buffer_unmap(inbuf, &map_in);
+
+    if (!converted)
+    {
+        return GST_BASE_TRANSFORM_FLOW_DROPPED;
+    }
+
+    gst_buffer_resize(inbuf, 0, static_cast<gssize>(dst_size));
+
+    // the result is linear, so the stride of the source no longer applies
+    auto video_meta_ptr = reinterpret_cast<GstVideoMeta*>(
+        gst_buffer_get_meta(inbuf, gst_video_meta_api_get_type()));
+    if (video_meta_ptr != nullptr)
+    {
+        video_meta_ptr->offset[0] = 0;
+        video_meta_ptr->stride[0] = dst.pitch();
+    }
     return GST_FLOW_OK;
 }
 
 static GstFlowReturn gst_tcamconvert_transform_ip(GstBaseTransform* base, GstBuffer* inbuf)
 {
-    auto& elem = get_gst_elem_reference(GST_TCAMCONVERT(base));
+    auto* self = GST_TCAMCONVERT(base);
+    auto& elem = get_gst_elem_reference(self);
+
+    if (elem.src_type_ != elem.dst_type_)
+    {
+        return transform_in_place(self, inbuf);
+    }
 
     GstMapInfo map_in;
     if (!gst_buffer_map(inbuf, &map_in, GST_MAP_READWRITE))
@@ -334,6 +1221,113 @@ static GstFlowReturn gst_tcamconvert_transform_ip(GstBaseTransform* base, GstBuf
     return GST_FLOW_OK;
 }
 
+// Upstream may add strides to its buffers, we read them from the GstVideoMeta
+static gboolean gst_tcamconvert_propose_allocation(GstBaseTransform* base,
+                                                   GstQuery* decide_query,
+                                                   GstQuery* query)
+{
+    if (!GST_BASE_TRANSFORM_CLASS(parent_class)->propose_allocation(base, decide_query, query))
+    {
+        return FALSE;
+    }
+    // without decide_query we are in passthrough mode and downstream answered the query
+    if (decide_query)
+    {
+        gst_query_add_allocation_meta(query, GST_VIDEO_META_API_TYPE, nullptr);
+    }
+    return TRUE;
+}
+
+// Output buffers come from a pool, so they are recycled instead of being allocated per image.
+// For raw video formats this is a GstVideoBufferPool, which adds video metas when downstream
+// supports them.
+static gboolean gst_tcamconvert_decide_allocation(GstBaseTransform* base, GstQuery* query)
+{
+    auto* self = GST_TCAMCONVERT(base);
+
+    GstCaps* caps = nullptr;
+    gst_query_parse_allocation(query, &caps, nullptr);
+    if (!caps)
+    {
+        return FALSE;
+    }
+
+    gsize required_size = 0;
+    if (!gst_tcamconvert_get_unit_size(base, caps, &required_size))
+    {
+        return FALSE;
+    }
+
+    GstVideoInfo info;
+    const bool is_raw_video = gst_video_info_from_caps(&info, caps);
+
+    GstBufferPool* pool = nullptr;
+    guint size = 0;
+    guint min_buffers = 0;
+    guint max_buffers = 0;
+    const bool has_pool = gst_query_get_n_allocation_pools(query) > 0;
+    if (has_pool)
+    {
+        gst_query_parse_nth_allocation_pool(query, 0, &pool, &size, &min_buffers, &max_buffers);
+    }
+    if (!pool)
+    {
+        pool = is_raw_video ? gst_video_buffer_pool_new() : gst_buffer_pool_new();
+        // one buffer is converted while downstream works on the other
+        min_buffers = std::max(min_buffers, 2u);
+    }
+    size = std::max(size, static_cast<guint>(required_size));
+
+    GstStructure* config = gst_buffer_pool_get_config(pool);
+    gst_buffer_pool_config_set_params(config, caps, size, min_buffers, max_buffers);
+
+    if (is_raw_video
+        && gst_buffer_pool_has_option(pool, GST_BUFFER_POOL_OPTION_VIDEO_META)
+        && gst_query_find_allocation_meta(query, GST_VIDEO_META_API_TYPE, nullptr))
+    {
+        gst_buffer_pool_config_add_option(config, GST_BUFFER_POOL_OPTION_VIDEO_META);
+
+        if (gst_buffer_pool_has_option(pool, GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT))
+        {
+            // lines start on 32 byte boundaries, so the SIMD functions can use aligned stores
+            GstVideoAlignment align;
+            gst_video_alignment_reset(&align);
+            for (guint i = 0; i < GST_VIDEO_INFO_N_PLANES(&info); ++i)
+            {
+                align.stride_align[i] = 31;
+            }
+
+            gst_buffer_pool_config_add_option(config, GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT);
+            gst_buffer_pool_config_set_video_alignment(config, &align);
+        }
+    }
+
+    if (!gst_buffer_pool_set_config(pool, config))
+    {
+        // the pool may have changed the config, try again with its proposal
+        config = gst_buffer_pool_get_config(pool);
+        if (!gst_buffer_pool_config_validate_params(config, caps, size, min_buffers, max_buffers)
+            || !gst_buffer_pool_set_config(pool, config))
+        {
+            GST_ERROR_OBJECT(self, "Failed to configure the buffer pool");
+            gst_object_unref(pool);
+            return FALSE;
+        }
+    }
+
+    if (has_pool)
+    {
+        gst_query_set_nth_allocation_pool(query, 0, pool, size, min_buffers, max_buffers);
+    }
+    else
+    {
+        gst_query_add_allocation_pool(query, pool, size, min_buffers, max_buffers);
+    }
+    gst_object_unref(pool);
+
+    return GST_BASE_TRANSFORM_CLASS(parent_class)->decide_allocation(base, query);
+}
+
 /**
  * Helper function for copy_metadata
  */
@@ -388,6 +1382,22 @@ static gboolean gst_tcamconvert_copy_metadata(GstBaseTransform* base,
     return TRUE;
 }
 
+// QoS events of downstream drive the adaptive quality, see tcamconvert_context_base::on_qos
+static gboolean gst_tcamconvert_src_event(GstBaseTransform* base, GstEvent* event)
+{
+    if (GST_EVENT_TYPE(event) == GST_EVENT_QOS)
+    {
+        GstQOSType type;
+        gdouble proportion = 1.0;
+        GstClockTimeDiff diff = 0;
+        GstClockTime timestamp = GST_CLOCK_TIME_NONE;
+        gst_event_parse_qos(event, &type, &proportion, &diff, &timestamp);
+
+        get_gst_elem_reference(GST_TCAMCONVERT(base)).on_qos(proportion);
+    }
+    return GST_BASE_TRANSFORM_CLASS(parent_class)->src_event(base, event);
+}
+
 static GstStateChangeReturn gst_tcamconvert_change_state(GstElement* element, GstStateChange trans)
 {
     auto& elem = get_gst_elem_reference(GST_TCAMCONVERT(element));
@@ -457,6 +1467,214 @@ static void gst_tcamconvert_class_init(GstTCamConvertClass* klass)
     gobject_class->dispose = gst_tcamconvert_dispose;
     gobject_class->finalize = gst_tcamconvert_finalize;
 
+    g_object_class_install_property(
+        gobject_class,
+        PROP_N_THREADS,
+        g_param_spec_int("n-threads",
+                         "Number of threads",
+                         "Number of threads used for conversions (0 = one per cpu core). Without "
+                         "cpu-affinity they come from a pool shared by all tcamconvert instances",
+                         0,
+                         64,
+                         1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_CPU_AFFINITY,
+        g_param_spec_string(
+            "cpu-affinity",
+            "CPU affinity",
+            "Comma separated list of cpu cores own conversion threads are pinned to, e.g. '0,2-3'. "
+            "Empty uses the shared pool",
+            "",
+            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_GAMMA,
+        g_param_spec_double(
+            "gamma",
+            "Gamma",
+            "Gamma applied to the BGRx and yuv output of bayer formats (1 = disabled)",
+            0.1,
+            5.0,
+            1.0,
+            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_CONTRAST_MIN,
+        g_param_spec_double("contrast-min",
+                            "Contrast minimum",
+                            "Mono 10/12/16-bit values at or below this fraction of the range "
+                            "become black (0 and contrast-max 1 = disabled)",
+                            0.0,
+                            1.0,
+                            0.0,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_CONTRAST_MAX,
+        g_param_spec_double("contrast-max",
+                            "Contrast maximum",
+                            "Mono 10/12/16-bit values at or above this fraction of the range "
+                            "become white (1 and contrast-min 0 = disabled)",
+                            0.0,
+                            1.0,
+                            1.0,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TONE_MAP,
+        g_param_spec_enum("tone-map",
+                          "Tone map",
+                          "Curve that maps 10/12/16-bit and merged HDR images to the output, with "
+                          "the white point and the average brightness of every image. Applies to "
+                          "GRAY outputs and the BGRx and yuv output of bayer formats",
+                          GST_TYPE_TCAMCONVERT_TONE_MAP,
+                          GST_TCAMCONVERT_TONE_MAP_LINEAR,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TONE_MAP_LOCAL,
+        g_param_spec_double("tone-map-local",
+                            "Local tone mapping",
+                            "Strength with which dark regions are brightened and bright regions "
+                            "darkened before tone-map, in tiles of the image (0 = disabled)",
+                            0.0,
+                            1.0,
+                            0.0,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_COLOR_MATRIX,
+        g_param_spec_string("color-matrix",
+                            "Color matrix",
+                            "Color matrix applied while debayering, 9 comma separated factors in "
+                            "row order, e.g. '1,0,0,0,1,0,0,0,1'. Empty disables the matrix",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_ROI,
+        g_param_spec_string("roi",
+                            "Region of interest",
+                            "Region of the input image that is converted, 'x,y,width,height'. The "
+                            "region starts at a multiple of 8 in x and an even line, its size is "
+                            "even. Empty converts the whole image",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                     | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DOWNSCALE,
+        g_param_spec_int("downscale",
+                         "Downscale",
+                         "Output at 1/downscale of the input width and height (1 = disabled). "
+                         "See downscale-mode, debayer supports 2 and 4",
+                         1,
+                         4,
+                         1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                  | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DOWNSCALE_MODE,
+        g_param_spec_enum("downscale-mode",
+                          "Downscale mode",
+                          "debayer: bayer formats are debayered to BGRx, RGBx64, BGRfloat and "
+                          "GRAY8/16, every 2x2 or 4x4 block becomes one pixel. average, sum, skip: raw mono "
+                          "and bayer images are binned or skipped in software before they are "
+                          "converted, bayer images keep their pattern",
+                          GST_TYPE_TCAMCONVERT_DOWNSCALE_MODE,
+                          GST_TCAMCONVERT_DOWNSCALE_DEBAYER,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                   | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DEBAYER_METHOD,
+        g_param_spec_enum("debayer-method",
+                          "Debayer method",
+                          "Debayer algorithm for 8-bit bayer formats to BGRx and yuv. nearest and "
+                          "bilinear are faster than edge, for previews and ML preprocessing. hq "
+                          "is slower, with fewer color fringes on edges",
+                          GST_TYPE_TCAMCONVERT_DEBAYER_METHOD,
+                          GST_TCAMCONVERT_DEBAYER_EDGE,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                   | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_VIDEO_DIRECTION,
+        g_param_spec_enum("video-direction",
+                          "Video direction",
+                          "Rotation or flip of the output, identity to vert are supported. Flips "
+                          "use ReverseX/ReverseY of the source when it has them, the other modes "
+                          "are applied while converting to MONO, BGRx and yuv formats",
+                          GST_TYPE_VIDEO_ORIENTATION_METHOD,
+                          GST_VIDEO_ORIENTATION_IDENTITY,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                   | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_OPENCL,
+        g_param_spec_boolean("opencl",
+                             "OpenCL",
+                             "Debayer 8 and 16-bit bayer formats to BGRx and NV12 on an OpenCL "
+                             "GPU. Other conversions use the cpu",
+                             FALSE,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                      | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DARK_FRAME,
+        g_param_spec_string("dark-frame",
+                            "Dark frame",
+                            "File with one 16-bit value per pixel of the input image that is "
+                            "subtracted from the raw mono and bayer images. Empty = disabled",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                     | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_FLAT_FIELD,
+        g_param_spec_string("flat-field",
+                            "Flat-field",
+                            "File with one float gain per pixel of the input image that the raw "
+                            "mono and bayer images are multiplied with. Empty = disabled",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                     | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DEFECT_PIXELS,
+        g_param_spec_string("defect-pixels",
+                            "Defect pixels",
+                            "Text file with one 'x,y' per defect pixel, these are replaced by "
+                            "their horizontal neighbours of the same color. Empty = disabled",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                     | GST_PARAM_MUTABLE_READY)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_ADAPTIVE_QUALITY,
+        g_param_spec_boolean("adaptive-quality",
+                             "Adaptive quality",
+                             "Switch to the bilinear and then the nearest debayer, and finally "
+                             "skip every other image while downstream is late or the conversion "
+                             "takes longer than the image interval. Posts a tcamconvert-quality "
+                             "element message on every change",
+                             TRUE,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_WORKER_PRIORITY,
+        g_param_spec_enum("worker-priority",
+                          "Worker priority",
+                          "Order in which the conversion threads shared by all tcamconvert "
+                          "instances of the process help the instances, e.g. high for a recording "
+                          "and low for a live view",
+                          GST_TYPE_TCAMCONVERT_WORKER_PRIORITY,
+                          GST_TCAMCONVERT_WORKER_PRIORITY_NORMAL,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
     gst_element_class_set_static_metadata(
         gstelement_class,
@@ -487,6 +1705,11 @@ static void gst_tcamconvert_class_init(GstTCamConvertClass* klass)
     gst_base_transform_class->transform = GST_DEBUG_FUNCPTR(gst_tcamconvert_transform);
     gst_base_transform_class->transform_ip = GST_DEBUG_FUNCPTR(gst_tcamconvert_transform_ip);
     gst_base_transform_class->copy_metadata = GST_DEBUG_FUNCPTR(gst_tcamconvert_copy_metadata);
+    gst_base_transform_class->propose_allocation =
+        GST_DEBUG_FUNCPTR(gst_tcamconvert_propose_allocation);
+    gst_base_transform_class->decide_allocation =
+        GST_DEBUG_FUNCPTR(gst_tcamconvert_decide_allocation);
+    gst_base_transform_class->src_event = GST_DEBUG_FUNCPTR(gst_tcamconvert_src_event);
     gstelement_class->change_state = GST_DEBUG_FUNCPTR(gst_tcamconvert_change_state);
 
     // Mark this transform element as 'calling tranform_ip when src and sink caps are the same
@@ -27,6 +27,53 @@ class tcamconvert_context_base;
 
 G_BEGIN_DECLS
 
+// same order as tcamconvert::downscale_mode
+typedef enum
+{
+    GST_TCAMCONVERT_DOWNSCALE_DEBAYER,
+    GST_TCAMCONVERT_DOWNSCALE_AVERAGE,
+    GST_TCAMCONVERT_DOWNSCALE_SUM,
+    GST_TCAMCONVERT_DOWNSCALE_SKIP,
+} GstTCamConvertDownscaleMode;
+
+GType gst_tcamconvert_downscale_mode_get_type(void);
+#define GST_TYPE_TCAMCONVERT_DOWNSCALE_MODE (gst_tcamconvert_downscale_mode_get_type())
+
+// same order as tcamconvert::debayer_method
+typedef enum
+{
+    GST_TCAMCONVERT_DEBAYER_NEAREST,
+    GST_TCAMCONVERT_DEBAYER_BILINEAR,
+    GST_TCAMCONVERT_DEBAYER_EDGE,
+    GST_TCAMCONVERT_DEBAYER_HQ,
+} GstTCamConvertDebayerMethod;
+
+GType gst_tcamconvert_debayer_method_get_type(void);
+#define GST_TYPE_TCAMCONVERT_DEBAYER_METHOD (gst_tcamconvert_debayer_method_get_type())
+
+// same order as img_filter::filter::tone_map::op
+typedef enum
+{
+    GST_TCAMCONVERT_TONE_MAP_LINEAR,
+    GST_TCAMCONVERT_TONE_MAP_GAMMA,
+    GST_TCAMCONVERT_TONE_MAP_LOG,
+    GST_TCAMCONVERT_TONE_MAP_REINHARD,
+} GstTCamConvertToneMap;
+
+GType gst_tcamconvert_tone_map_get_type(void);
+#define GST_TYPE_TCAMCONVERT_TONE_MAP (gst_tcamconvert_tone_map_get_type())
+
+// same order as tcamconvert::worker_priority
+typedef enum
+{
+    GST_TCAMCONVERT_WORKER_PRIORITY_LOW,
+    GST_TCAMCONVERT_WORKER_PRIORITY_NORMAL,
+    GST_TCAMCONVERT_WORKER_PRIORITY_HIGH,
+} GstTCamConvertWorkerPriority;
+
+GType gst_tcamconvert_worker_priority_get_type(void);
+#define GST_TYPE_TCAMCONVERT_WORKER_PRIORITY (gst_tcamconvert_worker_priority_get_type())
+
 #define GST_TYPE_TCAMCONVERT (gst_tcamconvert_get_type())
 #define GST_TCAMCONVERT(obj) \
     (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_TCAMCONVERT, GstTCamConvert))
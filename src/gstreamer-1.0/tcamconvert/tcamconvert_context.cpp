@@ -16,8 +16,21 @@
 
 #include "tcamconvert_context.h"
 
+#include "../../../libs/dutils_image/src/dutils_img_base/img_rect_tools.h"
+#include "../../utils.h"
+
+#if defined TCAM_CONVERT_OPENCL
+#include "transform_opencl.h"
+#endif
+
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <dutils_img/fcc_to_string.h>
 #include <gst-helper/gstelement_helper.h>
+#include <optional>
+#include <sstream>
+#include <thread>
 #include <tcamprop1.0_consumer/tcamprop1_consumer.h>
 
 namespace
@@ -28,13 +41,128 @@ static constexpr const char* BalanceWhiteRed_name = "BalanceWhiteRed";
 static constexpr const char* BalanceWhiteGreen_name = "BalanceWhiteGreen";
 static constexpr const char* BalanceWhiteBlue_name = "BalanceWhiteBlue";
 
+// Parses 9 comma separated floats
+static auto parse_color_matrix(const std::string& str) -> std::optional<img::color_matrix_float>
+{
+    img::color_matrix_float rval = {};
+
+    std::istringstream stream(str);
+    std::string entry;
+    int count = 0;
+    while (std::getline(stream, entry, ','))
+    {
+        if (count == 9)
+        {
+            return std::nullopt;
+        }
+        try
+        {
+            size_t pos = 0;
+            rval.fac[count] = std::stof(entry, &pos);
+            if (entry.find_first_not_of(' ', pos) != std::string::npos)
+            {
+                return std::nullopt;
+            }
+        }
+        catch (const std::exception&)
+        {
+            return std::nullopt;
+        }
+        ++count;
+    }
+    if (count != 9)
+    {
+        return std::nullopt;
+    }
+    return rval;
+}
+
+// Parses "x,y,width,height"
+static auto parse_roi(const std::string& str) -> std::optional<img::rect>
+{
+    int values[4] = {};
+
+    std::istringstream stream(str);
+    std::string entry;
+    int count = 0;
+    while (std::getline(stream, entry, ','))
+    {
+        if (count == 4)
+        {
+            return std::nullopt;
+        }
+        try
+        {
+            size_t pos = 0;
+            values[count] = std::stoi(entry, &pos);
+            if (entry.find_first_not_of(' ', pos) != std::string::npos)
+            {
+                return std::nullopt;
+            }
+        }
+        catch (const std::exception&)
+        {
+            return std::nullopt;
+        }
+        ++count;
+    }
+    if (count != 4 || values[0] < 0 || values[1] < 0 || values[2] <= 0 || values[3] <= 0)
+    {
+        return std::nullopt;
+    }
+    return img::rect { img::point { values[0], values[1] }, img::dim { values[2], values[3] } };
+}
+
+// Even offsets keep the bayer pattern of the source, x is also a multiple of the pixel groups of
+// the packed formats
+static auto align_roi(const img::rect& roi) -> img::rect
+{
+    const auto pos = img::point { roi.left & ~7, roi.top & ~1 };
+    const auto dim = img::dim { (roi.right - pos.x) & ~1, (roi.bottom - pos.y) & ~1 };
+    return img::rect { pos, dim };
+}
+
+// only meaningful for the modes other than downscale_mode::debayer
+// Images converted without statistics after the source did not take them, see
+// tcamconvert_context_base::on_statistics_pushed
+static constexpr int statistics_retry_frames = 100;
+
+// The auto algorithms expect the linear values after the white balance
+static bool is_linear(const tcamconvert::color_correction_params& params) noexcept
+{
+    return params.gamma == 1.f && !params.use_color_matrix
+           && params.tone_map == img_filter::filter::tone_map::op::linear
+           && params.tone_map_local <= 0.f;
+}
+
+static auto to_binning_mode(tcamconvert::downscale_mode mode)
+    -> img_filter::transform::binning::mode
+{
+    switch (mode)
+    {
+        case tcamconvert::downscale_mode::sum:
+            return img_filter::transform::binning::mode::sum;
+        case tcamconvert::downscale_mode::skip:
+            return img_filter::transform::binning::mode::skip;
+        case tcamconvert::downscale_mode::debayer:
+        case tcamconvert::downscale_mode::average:
+            break;
+    }
+    return img_filter::transform::binning::mode::average;
+}
+
 } // namespace
 
 tcamconvert::tcamconvert_context_base::tcamconvert_context_base(GstTCamConvert* self)
     : self_reference_(self)
 {
+    trans_impl_.set_worker_pool(&worker_pool_);
+    hdr_trans_impl_.set_worker_pool(&worker_pool_);
+    for (auto& ctx : degraded_trans_impl_) { ctx.set_worker_pool(&worker_pool_); }
 }
 
+tcamconvert::tcamconvert_context_base::~tcamconvert_context_base() = default;
+
 void tcamconvert::tcamconvert_context_base::init_from_source()
 {
     whitebalance_params_.apply = false;
@@ -73,6 +201,47 @@ void tcamconvert::tcamconvert_context_base::init_from_source()
         }
     }
 
+    auto ct_claim_ptr = provider.get_property_ptr<tcamprop1::property_interface_boolean>(
+        "ClaimColorTransformationSoftware");
+    if (ct_claim_ptr && !ct_claim_ptr->set_property_value(true))
+    {
+        static constexpr const char* ct_value_names[] = {
+            "ColorTransformation_Value_Gain00", "ColorTransformation_Value_Gain01",
+            "ColorTransformation_Value_Gain02", "ColorTransformation_Value_Gain10",
+            "ColorTransformation_Value_Gain11", "ColorTransformation_Value_Gain12",
+            "ColorTransformation_Value_Gain20", "ColorTransformation_Value_Gain21",
+            "ColorTransformation_Value_Gain22",
+        };
+
+        ct_enable_ = provider.get_property_ptr<tcamprop1::property_interface_boolean>(
+            "ColorTransformationEnable");
+        for (size_t i = 0; i < ct_values_.size(); ++i)
+        {
+            ct_values_[i] =
+                provider.get_property_ptr<tcamprop1::property_interface_float>(ct_value_names[i]);
+        }
+    }
+
+    reverse_x_ = provider.get_property_ptr<tcamprop1::property_interface_boolean>("ReverseX");
+    reverse_y_ = provider.get_property_ptr<tcamprop1::property_interface_boolean>("ReverseY");
+    apply_sensor_orientation();
+
+    if (tcam::metrics::is_enabled())
+    {
+        std::string serial;
+        if (g_object_class_find_property(G_OBJECT_GET_CLASS(src_element_ptr_.get()), "serial"))
+        {
+            gchar* str = nullptr;
+            g_object_get(G_OBJECT(src_element_ptr_.get()), "serial", &str, nullptr);
+            serial = str ? str : "";
+            g_free(str);
+        }
+        conversion_duration_ = tcam::metrics::get_histogram(
+            "tcam_convert_duration_seconds",
+            "Duration of the tcamconvert conversions",
+            { { "serial", serial }, { "element", GST_ELEMENT_NAME(self_reference_) } });
+    }
+
     init_from_source_done_ = true;
 }
 
@@ -115,6 +284,37 @@ auto tcamconvert::tcamconvert_context_base::fetch_balancewhite_values_from_sourc
     return whitebalance_params_ = factors;
 }
 
+void tcamconvert::tcamconvert_context_base::fetch_color_transformation_from_source()
+{
+    // the color-matrix property of the element takes precedence
+    if (!ct_enable_ || !color_matrix_str_.empty())
+    {
+        return;
+    }
+
+    auto enabled = ct_enable_->get_property_value();
+    if (!enabled || !enabled.value())
+    {
+        color_correction_.use_color_matrix = false;
+        return;
+    }
+
+    auto mtx = img::color_matrix_float::get_neutral();
+    for (size_t i = 0; i < ct_values_.size(); ++i)
+    {
+        if (!ct_values_[i])
+        {
+            continue;
+        }
+        if (auto res = ct_values_[i]->get_property_value(); res)
+        {
+            mtx.fac[i] = static_cast<float>(res.value());
+        }
+    }
+    color_correction_.use_color_matrix = true;
+    color_correction_.color_mtx = mtx;
+}
+
 
 static bool is_compatible_source_element(GstElement& element)
 {
@@ -200,6 +400,21 @@ void tcamconvert::tcamconvert_context_base::on_device_closed()
     wb_red_.reset();
     wb_green_.reset();
     wb_blue_.reset();
+    ct_enable_.reset();
+    for (auto& ptr : ct_values_) { ptr.reset(); }
+    reverse_x_.reset();
+    reverse_y_.reset();
+    {
+        std::scoped_lock lck { caps_config_mtx_ };
+        sensor_flips_ = false;
+    }
+    {
+        std::scoped_lock lck { color_correction_mtx_ };
+        if (color_matrix_str_.empty())
+        {
+            color_correction_.use_color_matrix = false;
+        }
+    }
 }
 
 void tcamconvert::tcamconvert_context_base::on_input_pad_linked()
@@ -215,25 +430,633 @@ void tcamconvert::tcamconvert_context_base::on_input_pad_unlinked()
     src_element_ptr_ = nullptr;
 }
 
-bool tcamconvert::tcamconvert_context_base::setup(img::img_type src_type, img::img_type dst_type)
+bool tcamconvert::tcamconvert_context_base::setup(img::img_type src_type,
+                                                  img::img_type dst_type,
+                                                  img_filter::transform::yuv_colorimetry yuv_clr)
 {
-    if (trans_impl_.setup(src_type, dst_type))
+    const auto roi = get_roi_rect();
+
+    calibration_files files;
+    {
+        std::scoped_lock lck { caps_config_mtx_ };
+        files = calibration_files_;
+    }
+    std::string error_message;
+    if (!calibration_.load(files, src_type.dim, error_message))
     {
-        this->src_type_ = src_type;
-        this->dst_type_ = dst_type;
+        GST_ERROR_OBJECT(
+            self_reference_, "Unable to load the calibration: %s", error_message.c_str());
+        return false;
+    }
+    calib_params_ = calibration_.make_params(roi.left, roi.top);
+    trans_impl_.set_calibration(calibration_.empty() ? nullptr : &calib_params_);
+
+    const auto mode = get_downscale_mode();
+    const int raw_downscale = mode != downscale_mode::debayer ? get_downscale() : 1;
+    trans_impl_.set_raw_downscale(to_binning_mode(mode), raw_downscale);
+    hdr_trans_impl_.set_raw_downscale(to_binning_mode(mode), raw_downscale);
+
+    trans_impl_.set_debayer_method(get_debayer_method());
+    hdr_trans_impl_.set_debayer_method(get_debayer_method());
+
+    const auto orientation = get_software_orientation();
+    trans_impl_.set_orientation(orientation);
+    hdr_trans_impl_.set_orientation(orientation);
+
+    auto roi_src_type = src_type;
+    if (!roi.is_null())
+    {
+        if (roi.right > src_type.dim.cx || roi.bottom > src_type.dim.cy)
+        {
+            GST_ERROR_OBJECT(self_reference_,
+                             "The roi '%s' does not fit into the %dx%d input image",
+                             get_roi().c_str(),
+                             src_type.dim.cx,
+                             src_type.dim.cy);
+            return false;
+        }
+        roi_src_type = img::make_img_type(src_type.type, roi.dimensions());
+    }
+
+    if (!trans_impl_.setup(roi_src_type, dst_type, yuv_clr))
+    {
+        return false;
+    }
+
+    this->src_type_ = src_type;
+    this->dst_type_ = dst_type;
+    this->active_roi_ = roi;
+    this->active_orientation_ = orientation;
+
+    const bool calibrated = trans_impl_.uses_calibration();
+    if (!calibration_.empty() && !calibrated)
+    {
+        GST_WARNING_OBJECT(self_reference_,
+                           "The calibration cannot be applied to %s images.",
+                           img::fcc_to_string(src_type.fourcc_type()).c_str());
+    }
+
+    // merged brackets and the OpenCL conversions are not corrected
+    hdr_active_ = roi.is_null() && !calibrated && hdr_merger_.setup(src_type)
+                  && hdr_trans_impl_.setup(hdr_merger_.get_merged_type(), dst_type, yuv_clr);
+
+    opencl_active_ = false;
+    if (get_use_opencl())
+    {
+#if defined TCAM_CONVERT_OPENCL
+        if (!opencl_)
+        {
+            opencl_ = std::make_unique<opencl_transform>();
+        }
+        opencl_active_ = roi.is_null() && !calibrated && raw_downscale == 1
+                         && orientation == img_filter::transform::orientation::mode::identity
+                         && opencl_->setup(src_type, dst_type, yuv_clr);
+        if (!opencl_active_)
+        {
+            GST_WARNING_OBJECT(self_reference_,
+                               "OpenCL does not support this conversion, using the cpu.");
+        }
+#else
+        GST_WARNING_OBJECT(self_reference_, "Built without OpenCL support, using the cpu.");
+#endif
+    }
+
+    static constexpr std::array<debayer_method, 2> degraded_methods = {
+        debayer_method::bilinear,
+        debayer_method::nearest,
+    };
+    const auto method = get_debayer_method();
+    for (size_t i = 0; i < degraded_methods.size(); ++i)
+    {
+        degraded_active_[i] = false;
+        if (opencl_active_ || !trans_impl_.uses_debayer_method() || degraded_methods[i] >= method)
+        {
+            continue;
+        }
+        auto& ctx = degraded_trans_impl_[i];
+        ctx.set_calibration(calibration_.empty() ? nullptr : &calib_params_);
+        ctx.set_raw_downscale(to_binning_mode(mode), raw_downscale);
+        ctx.set_debayer_method(degraded_methods[i]);
+        ctx.set_orientation(orientation);
+        degraded_active_[i] = ctx.setup(roi_src_type, dst_type, yuv_clr);
+    }
+    degradation_.reset(degraded_active_[0], degraded_active_[1]);
+    return true;
+}
+
+void tcamconvert::tcamconvert_context_base::set_thread_count(int count)
+{
+    std::scoped_lock lck { thread_config_mtx_ };
+    thread_count_ = count;
+    thread_config_changed_ = true;
+}
+
+int tcamconvert::tcamconvert_context_base::get_thread_count() const
+{
+    std::scoped_lock lck { thread_config_mtx_ };
+    return thread_count_;
+}
+
+void tcamconvert::tcamconvert_context_base::set_worker_priority(worker_priority priority)
+{
+    worker_pool_.set_priority(priority);
+}
+
+auto tcamconvert::tcamconvert_context_base::get_worker_priority() const -> worker_priority
+{
+    return worker_pool_.get_priority();
+}
+
+bool tcamconvert::tcamconvert_context_base::set_cpu_affinity(const std::string& cpu_list)
+{
+    auto list = tcam::parse_cpu_list(cpu_list);
+    if (!list)
+    {
+        return false;
+    }
+
+    std::scoped_lock lck { thread_config_mtx_ };
+    cpu_affinity_ = cpu_list;
+    cpu_list_ = std::move(list.value());
+    thread_config_changed_ = true;
+    return true;
+}
+
+std::string tcamconvert::tcamconvert_context_base::get_cpu_affinity() const
+{
+    std::scoped_lock lck { thread_config_mtx_ };
+    return cpu_affinity_;
+}
+
+void tcamconvert::tcamconvert_context_base::set_gamma(double gamma)
+{
+    std::scoped_lock lck { color_correction_mtx_ };
+    color_correction_.gamma = static_cast<float>(gamma);
+}
+
+double tcamconvert::tcamconvert_context_base::get_gamma() const
+{
+    std::scoped_lock lck { color_correction_mtx_ };
+    return color_correction_.gamma;
+}
+
+void tcamconvert::tcamconvert_context_base::set_contrast_min(double val)
+{
+    std::scoped_lock lck { color_correction_mtx_ };
+    color_correction_.contrast_min = static_cast<float>(val);
+}
+
+double tcamconvert::tcamconvert_context_base::get_contrast_min() const
+{
+    std::scoped_lock lck { color_correction_mtx_ };
+    return color_correction_.contrast_min;
+}
+
+void tcamconvert::tcamconvert_context_base::set_contrast_max(double val)
+{
+    std::scoped_lock lck { color_correction_mtx_ };
+    color_correction_.contrast_max = static_cast<float>(val);
+}
+
+double tcamconvert::tcamconvert_context_base::get_contrast_max() const
+{
+    std::scoped_lock lck { color_correction_mtx_ };
+    return color_correction_.contrast_max;
+}
+
+void tcamconvert::tcamconvert_context_base::set_tone_map(img_filter::filter::tone_map::op oper)
+{
+    std::scoped_lock lck { color_correction_mtx_ };
+    color_correction_.tone_map = oper;
+}
+
+auto tcamconvert::tcamconvert_context_base::get_tone_map() const -> img_filter::filter::tone_map::op
+{
+    std::scoped_lock lck { color_correction_mtx_ };
+    return color_correction_.tone_map;
+}
+
+void tcamconvert::tcamconvert_context_base::set_tone_map_local(double strength)
+{
+    std::scoped_lock lck { color_correction_mtx_ };
+    color_correction_.tone_map_local = static_cast<float>(strength);
+}
+
+double tcamconvert::tcamconvert_context_base::get_tone_map_local() const
+{
+    std::scoped_lock lck { color_correction_mtx_ };
+    return color_correction_.tone_map_local;
+}
+
+bool tcamconvert::tcamconvert_context_base::set_color_matrix(const std::string& str)
+{
+    if (str.empty())
+    {
+        std::scoped_lock lck { color_correction_mtx_ };
+        color_matrix_str_.clear();
+        color_correction_.use_color_matrix = false;
+        color_correction_.color_mtx = img::color_matrix_float::get_neutral();
         return true;
     }
 
-    return false;
+    auto mtx = parse_color_matrix(str);
+    if (!mtx)
+    {
+        return false;
+    }
+
+    std::scoped_lock lck { color_correction_mtx_ };
+    color_matrix_str_ = str;
+    color_correction_.use_color_matrix = true;
+    color_correction_.color_mtx = mtx.value();
+    return true;
+}
+
+std::string tcamconvert::tcamconvert_context_base::get_color_matrix() const
+{
+    std::scoped_lock lck { color_correction_mtx_ };
+    return color_matrix_str_;
+}
+
+bool tcamconvert::tcamconvert_context_base::set_roi(const std::string& str)
+{
+    if (str.empty())
+    {
+        std::scoped_lock lck { caps_config_mtx_ };
+        roi_str_.clear();
+        roi_ = {};
+        return true;
+    }
+
+    auto roi = parse_roi(str);
+    if (!roi)
+    {
+        return false;
+    }
+    const auto aligned = align_roi(roi.value());
+    if (img::is_empty_rect(aligned))
+    {
+        return false;
+    }
+
+    std::scoped_lock lck { caps_config_mtx_ };
+    roi_str_ = str;
+    roi_ = aligned;
+    return true;
+}
+
+std::string tcamconvert::tcamconvert_context_base::get_roi() const
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    return roi_str_;
+}
+
+img::rect tcamconvert::tcamconvert_context_base::get_roi_rect() const
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    return roi_;
+}
+
+bool tcamconvert::tcamconvert_context_base::set_downscale(int factor)
+{
+    if (factor < 1 || factor > img_filter::transform::binning::max_factor)
+    {
+        return false;
+    }
+
+    std::scoped_lock lck { caps_config_mtx_ };
+    downscale_ = factor;
+    return true;
+}
+
+int tcamconvert::tcamconvert_context_base::get_downscale() const
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    return downscale_;
+}
+
+void tcamconvert::tcamconvert_context_base::set_downscale_mode(downscale_mode mode)
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    downscale_mode_ = mode;
+}
+
+auto tcamconvert::tcamconvert_context_base::get_downscale_mode() const -> downscale_mode
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    return downscale_mode_;
+}
+
+void tcamconvert::tcamconvert_context_base::set_debayer_method(debayer_method method)
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    debayer_method_ = method;
+}
+
+auto tcamconvert::tcamconvert_context_base::get_debayer_method() const -> debayer_method
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    return debayer_method_;
+}
+
+void tcamconvert::tcamconvert_context_base::set_orientation(
+    img_filter::transform::orientation::mode mode)
+{
+    {
+        std::scoped_lock lck { caps_config_mtx_ };
+        orientation_ = mode;
+    }
+    if (init_from_source_done_)
+    {
+        apply_sensor_orientation();
+    }
+}
+
+auto tcamconvert::tcamconvert_context_base::get_orientation() const
+    -> img_filter::transform::orientation::mode
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    return orientation_;
+}
+
+auto tcamconvert::tcamconvert_context_base::get_software_orientation() const
+    -> img_filter::transform::orientation::mode
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    return sensor_flips_ ? img_filter::transform::orientation::mode::identity : orientation_;
+}
+
+void tcamconvert::tcamconvert_context_base::apply_sensor_orientation()
+{
+    using img_filter::transform::orientation::mode;
+
+    const auto orientation = get_orientation();
+    const bool reverse_x = orientation == mode::flip_horizontal || orientation == mode::rotate_180;
+    const bool reverse_y = orientation == mode::flip_vertical || orientation == mode::rotate_180;
+
+    bool was_flipping = false;
+    {
+        std::scoped_lock lck { caps_config_mtx_ };
+        was_flipping = sensor_flips_;
+    }
+    // a ReverseX/ReverseY the user set on the source is left alone
+    if (!reverse_x_ || !reverse_y_ || (!reverse_x && !reverse_y && !was_flipping))
+    {
+        return;
+    }
+
+    bool flips = false;
+    if (!reverse_x_->set_property_value(reverse_x) && !reverse_y_->set_property_value(reverse_y))
+    {
+        flips = reverse_x || reverse_y;
+    }
+    else
+    {
+        GST_INFO_OBJECT(self_reference_,
+                        "Unable to set ReverseX/ReverseY, the image is flipped in software.");
+        reverse_x_->set_property_value(false);
+        reverse_y_->set_property_value(false);
+    }
+
+    std::scoped_lock lck { caps_config_mtx_ };
+    sensor_flips_ = flips;
+}
+
+void tcamconvert::tcamconvert_context_base::set_use_opencl(bool use)
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    use_opencl_ = use;
+}
+
+bool tcamconvert::tcamconvert_context_base::get_use_opencl() const
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    return use_opencl_;
+}
+
+void tcamconvert::tcamconvert_context_base::set_dark_frame(const std::string& path)
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    calibration_files_.dark_frame = path;
+}
+
+std::string tcamconvert::tcamconvert_context_base::get_dark_frame() const
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    return calibration_files_.dark_frame;
+}
+
+void tcamconvert::tcamconvert_context_base::set_flat_field(const std::string& path)
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    calibration_files_.flat_field = path;
+}
+
+std::string tcamconvert::tcamconvert_context_base::get_flat_field() const
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    return calibration_files_.flat_field;
+}
+
+void tcamconvert::tcamconvert_context_base::set_defect_pixels(const std::string& path)
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    calibration_files_.defect_pixels = path;
+}
+
+std::string tcamconvert::tcamconvert_context_base::get_defect_pixels() const
+{
+    std::scoped_lock lck { caps_config_mtx_ };
+    return calibration_files_.defect_pixels;
+}
+
+void tcamconvert::tcamconvert_context_base::apply_thread_config()
+{
+    if (!thread_config_changed_.exchange(false))
+    {
+        return;
+    }
+
+    int count = 1;
+    std::vector<int> cpu_list;
+    {
+        std::scoped_lock lck { thread_config_mtx_ };
+        count = thread_count_;
+        cpu_list = cpu_list_;
+    }
+    if (count == 0)
+    {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    worker_pool_.start(count, cpu_list);
+
+    GST_INFO_OBJECT(self_reference_,
+                    "Using %d %s threads for conversions",
+                    worker_pool_.thread_count(),
+                    cpu_list.empty() ? "shared" : "pinned");
+}
+
+void tcamconvert::tcamconvert_context_base::set_adaptive_quality(bool enable)
+{
+    degradation_.set_enabled(enable);
+}
+
+bool tcamconvert::tcamconvert_context_base::get_adaptive_quality() const
+{
+    return degradation_.is_enabled();
+}
+
+void tcamconvert::tcamconvert_context_base::on_qos(double proportion)
+{
+    degradation_.on_qos(proportion);
+}
+
+bool tcamconvert::tcamconvert_context_base::begin_frame(int64_t pts_ns)
+{
+    return degradation_.begin_frame(pts_ns);
+}
+
+auto tcamconvert::tcamconvert_context_base::take_degradation_report()
+    -> std::optional<degradation_report>
+{
+    return degradation_.take_report();
 }
 
 void tcamconvert::tcamconvert_context_base::transform(const img::img_descriptor& src,
                                                       const img::img_descriptor& dst)
 {
-    trans_impl_.transform(src, dst, fetch_balancewhite_values_from_source());
+    const auto start = std::chrono::steady_clock::now();
+
+    convert(src, dst);
+
+    const auto duration = std::chrono::steady_clock::now() - start;
+    degradation_.on_converted(std::chrono::duration<double, std::micro>(duration).count());
+}
+
+void tcamconvert::tcamconvert_context_base::convert(const img::img_descriptor& src,
+                                                    const img::img_descriptor& dst)
+{
+    apply_thread_config();
+
+    statistics_ctx_ = nullptr;
+    if (statistics_backoff_ > 0)
+    {
+        --statistics_backoff_;
+    }
+
+    tcam::metrics::scoped_timer timer { conversion_duration_.load(std::memory_order_relaxed) };
+
+#if defined TCAM_CONVERT_OPENCL
+    if (opencl_active_)
+    {
+        color_correction_params color_correction;
+        {
+            std::scoped_lock lck { color_correction_mtx_ };
+            fetch_color_transformation_from_source();
+            color_correction = color_correction_;
+        }
+        // the tone mapping of 16-bit sources is folded into the tables of the cpu conversion
+        const bool tone_maps =
+            img::get_bits_per_pixel(src.fourcc_type()) > 8
+            && (color_correction.tone_map != img_filter::filter::tone_map::op::linear
+                || color_correction.tone_map_local > 0.f);
+        if (!tone_maps)
+        {
+            if (opencl_->transform(
+                    src, dst, fetch_balancewhite_values_from_source(), color_correction))
+            {
+                return;
+            }
+            GST_ERROR_OBJECT(self_reference_,
+                             "OpenCL conversion failed, using the cpu from now on.");
+            opencl_active_ = false;
+        }
+    }
+#endif
+
+    // skip_frames keeps the cheapest conversion that is available
+    auto* ctx = &trans_impl_;
+    switch (degradation_.get_level())
+    {
+        case degradation_level::full:
+            break;
+        case degradation_level::fast_debayer:
+            ctx = degraded_active_[0] ? &degraded_trans_impl_[0] : ctx;
+            break;
+        case degradation_level::binned_preview:
+        case degradation_level::skip_frames:
+            ctx = degraded_active_[0] ? &degraded_trans_impl_[0] : ctx;
+            ctx = degraded_active_[1] ? &degraded_trans_impl_[1] : ctx;
+            break;
+    }
+
+    {
+        std::scoped_lock lck { color_correction_mtx_ };
+        fetch_color_transformation_from_source();
+        ctx->set_color_correction(color_correction_);
+
+        // the statistics are in the coordinates of the source image
+        const bool collect =
+            statistics_backoff_ == 0 && active_roi_.is_null() && is_linear(color_correction_);
+        ctx->set_collect_statistics(collect);
+        statistics_ctx_ = collect ? ctx : nullptr;
+    }
+    if (!active_roi_.is_null())
+    {
+        ctx->transform(
+            img::make_safe_img_view(src, active_roi_), dst, fetch_balancewhite_values_from_source());
+        return;
+    }
+    ctx->transform(src, dst, fetch_balancewhite_values_from_source());
+}
+
+bool tcamconvert::tcamconvert_context_base::transform_hdr(const img::img_descriptor& src,
+                                                          const img::img_descriptor& dst,
+                                                          const hdr_bracket_info& info)
+{
+    statistics_ctx_ = nullptr;
+
+    auto merged = hdr_merger_.add(src, info);
+    if (!merged)
+    {
+        return false;
+    }
+
+    apply_thread_config();
+
+    tcam::metrics::scoped_timer timer { conversion_duration_.load(std::memory_order_relaxed) };
+
+    {
+        std::scoped_lock lck { color_correction_mtx_ };
+        fetch_color_transformation_from_source();
+        hdr_trans_impl_.set_color_correction(color_correction_);
+    }
+    hdr_trans_impl_.transform(*merged, dst, fetch_balancewhite_values_from_source());
+    return true;
+}
+
+const auto_alg::channel_statistics* tcamconvert::tcamconvert_context_base::get_statistics()
+    const noexcept
+{
+    if (!statistics_ctx_ || statistics_ctx_->get_statistics().empty())
+    {
+        return nullptr;
+    }
+    return &statistics_ctx_->get_statistics();
+}
+
+void tcamconvert::tcamconvert_context_base::on_statistics_pushed(bool accepted) noexcept
+{
+    if (!accepted)
+    {
+        statistics_backoff_ = statistics_retry_frames;
+    }
 }
 
 void tcamconvert::tcamconvert_context_base::filter(const img::img_descriptor& src)
 {
+    tcam::metrics::scoped_timer timer { conversion_duration_.load(std::memory_order_relaxed) };
+
     trans_impl_.filter(src, fetch_balancewhite_values_from_source());
 }
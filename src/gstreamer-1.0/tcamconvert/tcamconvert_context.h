@@ -16,44 +16,268 @@
 
 #pragma once
 
+#include "../../Metrics.h"
+#include "transform_calibration.h"
+#include "transform_degradation.h"
+#include "transform_hdr.h"
 #include "transform_impl.h"
+#include "transform_worker_pool.h"
 
 #include <dutils_img/dutils_img.h>
 #include <dutils_img_pipe/auto_alg_pass.h>
+#include <array>
+#include <atomic>
 #include <functional>
 #include <gst-helper/gst_signal_helper.h>
 #include <gst-helper/helper_functions.h>
+#include <gst/video/video.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
 #include <tcamprop1.0_base/tcamprop_property_interface.h>
 
 struct GstTCamConvert;
 
 namespace tcamconvert
 {
+class opencl_transform;
+
 class tcamconvert_context_base
 {
 public:
     img::img_type src_type_;
     img::img_type dst_type_;
 
+    // Layout of yuv output buffers, their planes are placed like GStreamer expects them
+    std::optional<GstVideoInfo> dst_video_info_;
+
     void on_input_pad_linked();
     void on_input_pad_unlinked();
 
 public:
     tcamconvert_context_base(GstTCamConvert* self);
+    ~tcamconvert_context_base();
 
-    bool setup(img::img_type src_type, img::img_type dst_type);
+    bool setup(img::img_type src_type,
+               img::img_type dst_type,
+               img_filter::transform::yuv_colorimetry yuv_clr =
+                   img_filter::transform::yuv_colorimetry::bt709);
 
     void transform(const img::img_descriptor& src, const img::img_descriptor& dst);
+
+    // True when images of an exposure bracket can be merged with transform_hdr
+    bool can_merge_hdr() const noexcept
+    {
+        return hdr_active_;
+    }
+
+    // Merges the exposure bracket src belongs to and converts the result into dst.
+    // Returns false while the bracket is not complete, dst is then not written.
+    bool transform_hdr(const img::img_descriptor& src,
+                       const img::img_descriptor& dst,
+                       const hdr_bracket_info& info);
     void filter(const img::img_descriptor& src);
 
+    // True when the conversion set up last can write its result over the source image
+    bool can_transform_in_place() const noexcept
+    {
+        return active_roi_.is_null() && trans_impl_.can_transform_in_place();
+    }
+
+    // Region of the input image that the conversion set up last reads, null for the whole image
+    img::rect get_active_roi() const noexcept
+    {
+        return active_roi_;
+    }
+
+    // Rotation or flip the conversion set up last applies in software
+    img_filter::transform::orientation::mode get_active_orientation() const noexcept
+    {
+        return active_orientation_;
+    }
+
     bool try_connect_to_source(bool force);
 
+    // 0 uses one thread per cpu core. Without a cpu affinity the threads come from the pool all
+    // tcamconvert instances of the process share, see transform_worker_pool.
+    // Changes are applied by the streaming thread before the next image is converted.
+    void set_thread_count(int count);
+    int get_thread_count() const;
+
+    // Order in which the shared pool helps the conversions of the tcamconvert instances
+    void set_worker_priority(worker_priority priority);
+    worker_priority get_worker_priority() const;
+
+    // List of cores the worker threads are pinned to, e.g. "0,2-3"
+    // Returns false when cpu_list cannot be parsed
+    bool set_cpu_affinity(const std::string& cpu_list);
+    std::string get_cpu_affinity() const;
+
+    // Gamma applied to the BGRA32 and yuv output of bayer formats, 1 disables it
+    void set_gamma(double gamma);
+    double get_gamma() const;
+
+    // Range of the MONO10/12/16 values in [0;1] that is stretched to the whole range of the output,
+    // [0;1] disables the stretching
+    void set_contrast_min(double val);
+    double get_contrast_min() const;
+    void set_contrast_max(double val);
+    double get_contrast_max() const;
+
+    // Tone mapping of 10/12/16-bit and merged HDR images, see color_correction_params
+    void set_tone_map(img_filter::filter::tone_map::op oper);
+    img_filter::filter::tone_map::op get_tone_map() const;
+    void set_tone_map_local(double strength);
+    double get_tone_map_local() const;
+
+    // 9 comma separated factors in row order, an empty string disables the color matrix
+    // Returns false when str cannot be parsed
+    bool set_color_matrix(const std::string& str);
+    std::string get_color_matrix() const;
+
+    // Region "x,y,width,height" of the input image that is converted, an empty string converts
+    // the whole image. Changes apply when the caps are negotiated the next time.
+    // Returns false when str cannot be parsed
+    bool set_roi(const std::string& str);
+    std::string get_roi() const;
+
+    // The region aligned to the bayer pattern and packed pixel groups, null for the whole image
+    img::rect get_roi_rect() const;
+
+    // 1, 2, 3 or 4, the output has 1/factor of the width and height of the input.
+    // With downscale_mode::debayer, bayer images are debayered to 1/2 or 1/4, the other modes
+    // bin or skip the raw image by any of the factors before it is converted.
+    // Changes apply when the caps are negotiated the next time.
+    // Returns false for other factors
+    bool set_downscale(int factor);
+    int get_downscale() const;
+    void set_downscale_mode(downscale_mode mode);
+    downscale_mode get_downscale_mode() const;
+
+    // Algorithm of the cpu debayer of 8-bit bayer formats.
+    // Changes apply when the caps are negotiated the next time.
+    void set_debayer_method(debayer_method method);
+    debayer_method get_debayer_method() const;
+
+    // Rotation or flip of the output. Flips are done by the sensor when the source has the
+    // ReverseX and ReverseY properties, the other modes while converting.
+    // Changes apply when the caps are negotiated the next time.
+    void set_orientation(img_filter::transform::orientation::mode mode);
+    img_filter::transform::orientation::mode get_orientation() const;
+
+    // The part of get_orientation that is not done by the sensor
+    img_filter::transform::orientation::mode get_software_orientation() const;
+
+    // Converts bayer 8/16-bit to BGRx and NV12 on an OpenCL GPU when the build supports it.
+    // Other conversions, a roi or downscale use the cpu. Changes apply when the caps are
+    // negotiated the next time.
+    void set_use_opencl(bool use);
+    bool get_use_opencl() const;
+
+    // Paths of the dark frame, flat-field and defect pixel files, see calibration_files.
+    // The files are loaded when the caps are negotiated the next time.
+    void set_dark_frame(const std::string& path);
+    std::string get_dark_frame() const;
+    void set_flat_field(const std::string& path);
+    std::string get_flat_field() const;
+    void set_defect_pixels(const std::string& path);
+    std::string get_defect_pixels() const;
+
+    // Steps down to cheaper debayer methods and then skips images while downstream reports with
+    // QoS events that it is late or the conversion takes longer than the image interval, see
+    // degradation_controller. Merged HDR brackets are not degraded.
+    void set_adaptive_quality(bool enable);
+    bool get_adaptive_quality() const;
+
+    // Proportion of a QoS event received on the src pad
+    void on_qos(double proportion);
+
+    // Called for every image before it is converted with transform, pts_ns is -1 when unknown.
+    // Returns false when the image is to be dropped.
+    bool begin_frame(int64_t pts_ns);
+
+    // Set after the degradation_level changed
+    std::optional<degradation_report> take_degradation_report();
+
+    // Statistics of the BGRA32 lines the last transform wrote, for the auto algorithms of the
+    // source, see transform_context::set_collect_statistics. nullptr when none were collected, e.g.
+    // for a roi, a color matrix, gamma or tone mapping.
+    const auto_alg::channel_statistics* get_statistics() const noexcept;
+
+    // Whether the source took the statistics of the last transform. When it did not, the next
+    // images are converted without collecting any, before it is tried again.
+    void on_statistics_pushed(bool accepted) noexcept;
+
 private:
+    void apply_thread_config();
+    void convert(const img::img_descriptor& src, const img::img_descriptor& dst);
+
+    transform_worker_pool worker_pool_;
+
+    mutable std::mutex thread_config_mtx_;
+    int thread_count_ = 1;
+    std::string cpu_affinity_;
+    std::vector<int> cpu_list_;
+    std::atomic<bool> thread_config_changed_ = false;
+
+    mutable std::mutex color_correction_mtx_;
+    color_correction_params color_correction_;
+    std::string color_matrix_str_;
+
+    mutable std::mutex caps_config_mtx_;
+    std::string roi_str_;
+    img::rect roi_;
+    int downscale_ = 1;
+    downscale_mode downscale_mode_ = downscale_mode::debayer;
+    debayer_method debayer_method_ = debayer_method::edge;
+    img_filter::transform::orientation::mode orientation_ =
+        img_filter::transform::orientation::mode::identity;
+    bool sensor_flips_ = false; // orientation_ is done by ReverseX/ReverseY of the source
+    bool use_opencl_ = false;
+    calibration_files calibration_files_;
+
+    img::rect active_roi_;
+    img_filter::transform::orientation::mode active_orientation_ =
+        img_filter::transform::orientation::mode::identity;
+
+    // loaded by setup for the input dimensions, calib_params_ is passed to trans_impl_
+    calibration_data calibration_;
+    img_filter::filter::calib_correct::params calib_params_;
+
+    // only set with TCAM_CONVERT_OPENCL, trans_impl_ is still set up as fallback
+    std::unique_ptr<opencl_transform> opencl_;
+    bool opencl_active_ = false;
+
     img_filter::whitebalance_params whitebalance_params_;
 
     transform_context trans_impl_;
 
+    // trans_impl_ with the bilinear and the nearest debayer, set up when they are cheaper than
+    // the configured debayer method
+    degradation_controller degradation_;
+    std::array<transform_context, 2> degraded_trans_impl_;
+    std::array<bool, 2> degraded_active_ = {};
+
+    // converts the 16-bit result of hdr_merger_ to dst_type_
+    hdr_merger hdr_merger_;
+    transform_context hdr_trans_impl_;
+    bool hdr_active_ = false;
+
+    // the context of the last transform when it collected statistics
+    const transform_context* statistics_ctx_ = nullptr;
+    int statistics_backoff_ = 0;
+
+    // TCAM_METRICS_PORT, set when a device is opened
+    std::atomic<tcam::metrics::histogram*> conversion_duration_ = nullptr;
+
     auto fetch_balancewhite_values_from_source() -> img_filter::whitebalance_params;
+    // copies the ColorTransformation properties of the source into color_correction_,
+    // color_correction_mtx_ must be held
+    void fetch_color_transformation_from_source();
+    // sets ReverseX/ReverseY of the source for orientation_, or resets them when they were set
+    // before and are no longer wanted
+    void apply_sensor_orientation();
 
 private:
     void init_from_source();
@@ -70,6 +294,13 @@ private:
     std::unique_ptr<tcamprop1::property_interface_float>    wb_green_;
     std::unique_ptr<tcamprop1::property_interface_float>    wb_blue_;
 
+    // only set when the source left the color transformation to us
+    std::unique_ptr<tcamprop1::property_interface_boolean>  ct_enable_;
+    std::array<std::unique_ptr<tcamprop1::property_interface_float>, 9> ct_values_;
+
+    std::unique_ptr<tcamprop1::property_interface_boolean>  reverse_x_;
+    std::unique_ptr<tcamprop1::property_interface_boolean>  reverse_y_;
+
     GstTCamConvert* self_reference_ = nullptr;
 };
 } // namespace tcamconvert
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "transform_calibration.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace calib_correct = img_filter::filter::calib_correct;
+
+namespace
+{
+
+// Reads exactly count values of T from path
+template<class T>
+bool read_map(const std::string& path, size_t count, std::vector<T>& values, std::string& error)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        error = "Unable to open '" + path + "'";
+        return false;
+    }
+    const auto size = static_cast<size_t>(file.tellg());
+    if (size != count * sizeof(T))
+    {
+        error = "'" + path + "' has " + std::to_string(size) + " bytes, expected "
+                + std::to_string(count * sizeof(T));
+        return false;
+    }
+
+    values.resize(count);
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(values.data()), size))
+    {
+        error = "Unable to read '" + path + "'";
+        return false;
+    }
+    return true;
+}
+
+bool read_defects(const std::string& path,
+                  img::dim dim,
+                  std::vector<calib_correct::defect_pixel>& defects,
+                  std::string& error)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        error = "Unable to open '" + path + "'";
+        return false;
+    }
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line))
+    {
+        ++line_number;
+        if (line.find_first_not_of(" \t\r") == std::string::npos || line[0] == '#')
+        {
+            continue;
+        }
+
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream stream(line);
+        calib_correct::defect_pixel d;
+        if (!(stream >> d.x >> d.y) || d.x < 0 || d.y < 0 || d.x >= dim.cx || d.y >= dim.cy)
+        {
+            error = "Invalid defect pixel in line " + std::to_string(line_number) + " of '" + path
+                    + "'";
+            return false;
+        }
+        defects.push_back(d);
+    }
+
+    std::sort(defects.begin(),
+              defects.end(),
+              [](const auto& lhs, const auto& rhs)
+              { return lhs.y != rhs.y ? lhs.y < rhs.y : lhs.x < rhs.x; });
+    return true;
+}
+
+} // namespace
+
+
+void tcamconvert::calibration_data::clear() noexcept
+{
+    files_ = {};
+    dim_ = {};
+    dark_.clear();
+    gain_.clear();
+    defects_.clear();
+}
+
+
+bool tcamconvert::calibration_data::load(const calibration_files& files,
+                                         img::dim dim,
+                                         std::string& error_message)
+{
+    if (files == files_ && dim == dim_)
+    {
+        return true;
+    }
+    clear();
+
+    const size_t count = static_cast<size_t>(dim.cx) * dim.cy;
+
+    if (!files.dark_frame.empty() && !read_map(files.dark_frame, count, dark_, error_message))
+    {
+        clear();
+        return false;
+    }
+
+    if (!files.flat_field.empty())
+    {
+        std::vector<float> gain;
+        if (!read_map(files.flat_field, count, gain, error_message))
+        {
+            clear();
+            return false;
+        }
+
+        gain_.resize(count);
+        std::transform(gain.begin(),
+                       gain.end(),
+                       gain_.begin(),
+                       [](float g)
+                       {
+                           // NaN becomes 0
+                           const float fixed = std::round(g * calib_correct::gain_one);
+                           return static_cast<uint16_t>(fixed > 0 ? std::min(fixed, 65535.f) : 0);
+                       });
+    }
+
+    if (!files.defect_pixels.empty()
+        && !read_defects(files.defect_pixels, dim, defects_, error_message))
+    {
+        clear();
+        return false;
+    }
+
+    files_ = files;
+    dim_ = dim;
+    return true;
+}
+
+
+auto tcamconvert::calibration_data::make_params(int offset_x, int offset_y) const noexcept
+    -> calib_correct::params
+{
+    calib_correct::params p;
+    p.map_dim = dim_;
+    p.offset_x = offset_x;
+    p.offset_y = offset_y;
+    p.dark = dark_.empty() ? nullptr : dark_.data();
+    p.gain = gain_.empty() ? nullptr : gain_.data();
+    p.defects = defects_.data();
+    p.defect_count = static_cast<int>(defects_.size());
+    return p;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "transform_impl.h"
+
+#include <cstdint>
+#include <dutils_img/dutils_img.h>
+#include <string>
+#include <vector>
+
+namespace tcamconvert
+{
+
+// Calibration files of a sensor, empty paths are not used.
+//
+// dark_frame: one 16-bit value in native byte order per pixel, in the range of the 16-bit formats
+// flat_field: one 32-bit float gain in native byte order per pixel, clipped to [0;16)
+// defect_pixels: text file with one "x,y" per line, lines starting with '#' are skipped
+struct calibration_files
+{
+    std::string dark_frame;
+    std::string flat_field;
+    std::string defect_pixels;
+
+    bool empty() const noexcept
+    {
+        return dark_frame.empty() && flat_field.empty() && defect_pixels.empty();
+    }
+
+    bool operator==(const calibration_files& other) const noexcept
+    {
+        return dark_frame == other.dark_frame && flat_field == other.flat_field
+               && defect_pixels == other.defect_pixels;
+    }
+};
+
+// The maps of img_filter::filter::calib_correct::params, loaded from calibration_files.
+class calibration_data
+{
+public:
+    // Loads the files for images with dim, files that were loaded for dim before are kept.
+    // Returns false and sets error_message when a file cannot be read or does not match dim.
+    bool load(const calibration_files& files, img::dim dim, std::string& error_message);
+
+    bool empty() const noexcept
+    {
+        return dark_.empty() && gain_.empty() && defects_.empty();
+    }
+
+    // offset_x and offset_y are the position of the converted region in the image
+    auto make_params(int offset_x, int offset_y) const noexcept
+        -> img_filter::filter::calib_correct::params;
+
+private:
+    void clear() noexcept;
+
+    calibration_files files_;
+    img::dim dim_;
+
+    std::vector<uint16_t> dark_;
+    std::vector<uint16_t> gain_;
+    std::vector<img_filter::filter::calib_correct::defect_pixel> defects_;
+};
+
+} // namespace tcamconvert
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "transform_degradation.h"
+
+#include <algorithm>
+
+namespace
+{
+
+// share of the frame interval a conversion may take
+constexpr double time_budget = 0.9;
+
+constexpr double overload_load = 1.0;
+constexpr double headroom_load = 0.6;
+
+constexpr int overloaded_frames_to_step_down = 4;
+// the averages need a few images to show the effect of a step
+constexpr int settle_frames = 8;
+constexpr int min_recover_frames = 60;
+constexpr int max_recover_frames = 960;
+
+// without new QoS events, the last proportion is no longer used
+constexpr int qos_timeout_frames = 30;
+
+constexpr double average_weight = 0.2;
+
+double update_average(double avg, double val) noexcept
+{
+    return avg == 0 ? val : avg + (val - avg) * average_weight;
+}
+
+} // namespace
+
+
+const char* tcamconvert::to_string(degradation_level level) noexcept
+{
+    switch (level)
+    {
+        case degradation_level::full:
+            return "full";
+        case degradation_level::fast_debayer:
+            return "fast-debayer";
+        case degradation_level::binned_preview:
+            return "binned-preview";
+        case degradation_level::skip_frames:
+            return "skip-frames";
+    }
+    return "unknown";
+}
+
+
+void tcamconvert::degradation_controller::reset(bool fast_debayer_available,
+                                                bool binned_preview_available) noexcept
+{
+    fast_debayer_available_ = fast_debayer_available;
+    binned_preview_available_ = binned_preview_available;
+
+    level_ = degradation_level::full;
+    qos_proportion_ = 0;
+    qos_events_seen_ = qos_events_;
+    frames_without_qos_ = 0;
+    current_qos_ = 0;
+    last_pts_ns_ = -1;
+    frame_interval_us_ = 0;
+    conversion_time_us_ = 0;
+    overloaded_frames_ = 0;
+    headroom_frames_ = 0;
+    frames_since_change_ = 0;
+    recover_frames_ = min_recover_frames;
+    last_change_was_up_ = false;
+    skip_this_ = false;
+    report_ = {};
+    report_pending_ = false;
+}
+
+
+void tcamconvert::degradation_controller::on_qos(double proportion) noexcept
+{
+    qos_proportion_ = proportion;
+    ++qos_events_;
+}
+
+
+bool tcamconvert::degradation_controller::is_available(degradation_level level) const noexcept
+{
+    switch (level)
+    {
+        case degradation_level::fast_debayer:
+            return fast_debayer_available_;
+        case degradation_level::binned_preview:
+            return binned_preview_available_;
+        case degradation_level::full:
+        case degradation_level::skip_frames:
+            return true;
+    }
+    return false;
+}
+
+
+double tcamconvert::degradation_controller::calc_load() const noexcept
+{
+    double load = current_qos_;
+    if (frame_interval_us_ > 0 && conversion_time_us_ > 0)
+    {
+        // only every other image is converted
+        const double interval =
+            frame_interval_us_ * (level_ == degradation_level::skip_frames ? 2 : 1);
+        load = std::max(load, conversion_time_us_ / (interval * time_budget));
+    }
+    return load;
+}
+
+
+void tcamconvert::degradation_controller::change_level(int direction) noexcept
+{
+    const auto previous = level_;
+
+    int next = static_cast<int>(level_);
+    do
+    {
+        next += direction;
+    } while (next > 0 && next < static_cast<int>(degradation_level::skip_frames)
+             && !is_available(static_cast<degradation_level>(next)));
+
+    next = std::clamp(next, 0, static_cast<int>(degradation_level::skip_frames));
+    if (next == static_cast<int>(level_))
+    {
+        return;
+    }
+    level_ = static_cast<degradation_level>(next);
+
+    report_.previous = previous;
+    report_.level = level_;
+    report_.qos_proportion = current_qos_;
+    report_.conversion_time_us = conversion_time_us_;
+    report_.frame_interval_us = frame_interval_us_;
+    report_pending_ = true;
+
+    // the conversion time of the old level says nothing about the new one
+    conversion_time_us_ = 0;
+
+    if (direction < 0)
+    {
+        last_change_was_up_ = true;
+    }
+    else
+    {
+        // the last step up caused this overload, so wait longer before the next one
+        if (last_change_was_up_ && frames_since_change_ < recover_frames_)
+        {
+            recover_frames_ = std::min(recover_frames_ * 2, max_recover_frames);
+        }
+        last_change_was_up_ = false;
+    }
+
+    overloaded_frames_ = 0;
+    headroom_frames_ = 0;
+    frames_since_change_ = 0;
+    skip_this_ = false;
+}
+
+
+bool tcamconvert::degradation_controller::begin_frame(int64_t pts_ns) noexcept
+{
+    if (pts_ns >= 0 && last_pts_ns_ >= 0 && pts_ns > last_pts_ns_)
+    {
+        const double interval_us = (pts_ns - last_pts_ns_) / 1000.0;
+        // gaps, e.g. from a paused pipeline, are not part of the frame rate
+        if (frame_interval_us_ == 0 || interval_us < frame_interval_us_ * 4)
+        {
+            frame_interval_us_ = update_average(frame_interval_us_, interval_us);
+        }
+    }
+    last_pts_ns_ = pts_ns;
+
+    if (const uint64_t events = qos_events_; events != qos_events_seen_)
+    {
+        qos_events_seen_ = events;
+        current_qos_ = qos_proportion_;
+        frames_without_qos_ = 0;
+    }
+    else if (++frames_without_qos_ > qos_timeout_frames)
+    {
+        current_qos_ = 0;
+    }
+
+    if (!enabled_)
+    {
+        if (level_ != degradation_level::full)
+        {
+            change_level(-static_cast<int>(level_));
+        }
+        return true;
+    }
+
+    if (level_ == degradation_level::skip_frames)
+    {
+        skip_this_ = !skip_this_;
+        if (skip_this_)
+        {
+            ++report_.frames_skipped;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+void tcamconvert::degradation_controller::on_converted(double duration_us) noexcept
+{
+    conversion_time_us_ = update_average(conversion_time_us_, duration_us);
+
+    ++report_.frames_converted;
+    if (level_ != degradation_level::full)
+    {
+        ++report_.frames_degraded;
+    }
+
+    if (!enabled_)
+    {
+        return;
+    }
+
+    ++frames_since_change_;
+
+    const double load = calc_load();
+    overloaded_frames_ = load > overload_load ? overloaded_frames_ + 1 : 0;
+    headroom_frames_ = load < headroom_load ? headroom_frames_ + 1 : 0;
+
+    if (overloaded_frames_ >= overloaded_frames_to_step_down
+        && frames_since_change_ >= settle_frames && level_ != degradation_level::skip_frames)
+    {
+        change_level(1);
+    }
+    else if (headroom_frames_ >= recover_frames_ && level_ != degradation_level::full)
+    {
+        change_level(-1);
+    }
+    else if (level_ == degradation_level::full && frames_since_change_ >= max_recover_frames)
+    {
+        // stable again, the next overload starts with the short wait
+        recover_frames_ = min_recover_frames;
+    }
+}
+
+
+auto tcamconvert::degradation_controller::take_report() noexcept
+    -> std::optional<degradation_report>
+{
+    if (!report_pending_)
+    {
+        return std::nullopt;
+    }
+    report_pending_ = false;
+    return report_;
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+namespace tcamconvert
+{
+
+// Steps of the adaptive quality, each one is cheaper than the one before
+enum class degradation_level
+{
+    full,           // the configured conversion
+    fast_debayer,   // bilinear instead of edge or hq
+    binned_preview, // every 2x2 bayer cell gets one color, like a binned image
+    skip_frames,    // binned_preview, and every other image is dropped before it is converted
+};
+
+const char* to_string(degradation_level level) noexcept;
+
+struct degradation_report
+{
+    degradation_level level = degradation_level::full;
+    degradation_level previous = degradation_level::full;
+
+    // since the caps were set
+    uint64_t frames_converted = 0;
+    uint64_t frames_degraded = 0; // converted below full
+    uint64_t frames_skipped = 0;
+
+    double qos_proportion = 0;     // 0 while downstream sends no QoS events
+    double conversion_time_us = 0; // average
+    double frame_interval_us = 0;  // average, 0 before the second image
+};
+
+//
+// Decides the degradation_level of the next image.
+//
+// The load is the larger of the proportion of the last QoS event and the average conversion
+// time relative to 90% of the interval between the images. A load above 1 for a few images steps
+// down one level, a load below 0.6 for 60 images steps up again. Stepping up right into another
+// overload doubles the wait before the next attempt.
+//
+// on_qos may be called from any thread, everything else from the streaming thread.
+//
+class degradation_controller
+{
+public:
+    // Levels that would not change the conversion, e.g. fast_debayer when the debayer already is
+    // bilinear, are passed over.
+    void reset(bool fast_debayer_available, bool binned_preview_available) noexcept;
+
+    void set_enabled(bool enable) noexcept
+    {
+        enabled_ = enable;
+    }
+    bool is_enabled() const noexcept
+    {
+        return enabled_;
+    }
+
+    void on_qos(double proportion) noexcept;
+
+    // Called for every image before it is converted, pts_ns is -1 when unknown.
+    // Returns false when the image is skipped.
+    bool begin_frame(int64_t pts_ns) noexcept;
+
+    void on_converted(double duration_us) noexcept;
+
+    degradation_level get_level() const noexcept
+    {
+        return level_;
+    }
+
+    // Set after the level changed, until it is taken
+    std::optional<degradation_report> take_report() noexcept;
+
+private:
+    bool is_available(degradation_level level) const noexcept;
+    void change_level(int direction) noexcept;
+    double calc_load() const noexcept;
+
+    std::atomic<bool> enabled_ = true;
+
+    std::atomic<double> qos_proportion_ = 0;
+    std::atomic<uint64_t> qos_events_ = 0;
+    uint64_t qos_events_seen_ = 0;
+    int frames_without_qos_ = 0;
+    double current_qos_ = 0;
+
+    bool fast_debayer_available_ = false;
+    bool binned_preview_available_ = false;
+
+    degradation_level level_ = degradation_level::full;
+
+    int64_t last_pts_ns_ = -1;
+    double frame_interval_us_ = 0;
+    double conversion_time_us_ = 0;
+
+    int overloaded_frames_ = 0;
+    int headroom_frames_ = 0;
+    int frames_since_change_ = 0;
+    int recover_frames_ = 0;
+    bool last_change_was_up_ = false;
+    bool skip_this_ = false;
+
+    degradation_report report_;
+    bool report_pending_ = false;
+};
+
+} // namespace tcamconvert
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "transform_hdr.h"
+
+#include "../../../libs/dutils_image/src/dutils_img_base/memcpy_image.h"
+
+namespace hdr_merge = img_filter::filter::hdr_merge;
+
+bool tcamconvert::hdr_merger::setup(img::img_type src_type)
+{
+    reset();
+    merge_func_ = nullptr;
+
+    const auto merged_fcc = hdr_merge::get_hdr_merge_dst_fcc16(src_type.fourcc_type());
+    if (merged_fcc == img::fourcc::FCC_NULL)
+    {
+        return false;
+    }
+
+    src_type_ = src_type;
+    merged_type_ = img::make_img_type(merged_fcc, src_type.dim);
+    merge_func_ = find_hdr_merge_func(merged_type_, src_type_);
+    if (!merge_func_)
+    {
+        return false;
+    }
+
+    for (auto& f : frames_) { f.data.resize(src_type_.buffer_length); }
+    merged_.resize(merged_type_.buffer_length);
+    return true;
+}
+
+
+void tcamconvert::hdr_merger::reset() noexcept
+{
+    for (auto& f : frames_) { f.valid = false; }
+}
+
+
+auto tcamconvert::hdr_merger::add(const img::img_descriptor& src, const hdr_bracket_info& info)
+    -> std::optional<img::img_descriptor>
+{
+    if (!merge_func_ || info.count < 2 || info.count > hdr_merge::max_frame_count
+        || info.index < 0 || info.index >= info.count)
+    {
+        return std::nullopt;
+    }
+
+    const int last = info.count - 1;
+    if (info.index < last)
+    {
+        if (info.index == 0)
+        {
+            reset();
+        }
+        auto& f = frames_[info.index];
+        img::memcpy_image(img::make_img_desc_from_linear_memory(src_type_, f.data.data()), src);
+        f.valid = true;
+        f.exposure_us = info.exposure_us;
+        f.frame_count = info.frame_count;
+        return std::nullopt;
+    }
+
+    hdr_merge::params params;
+    params.count = info.count;
+
+    img::img_descriptor src_list[hdr_merge::max_frame_count];
+    for (int i = 0; i < last; ++i)
+    {
+        const auto& f = frames_[i];
+        // the images of a bracket follow each other, anything else mixes two brackets
+        if (!f.valid || f.frame_count + (last - i) != info.frame_count)
+        {
+            reset();
+            return std::nullopt;
+        }
+        src_list[i] = img::make_img_desc_from_linear_memory(src_type_, frames_[i].data.data());
+        params.exposure[i] = static_cast<float>(f.exposure_us);
+    }
+    src_list[last] = src;
+    params.exposure[last] = static_cast<float>(info.exposure_us);
+
+    auto dst = img::make_img_desc_from_linear_memory(merged_type_, merged_.data());
+    merge_func_(dst, src_list, params);
+
+    reset();
+    return dst;
+}
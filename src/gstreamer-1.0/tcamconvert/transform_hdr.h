@@ -0,0 +1,77 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "transform_impl.h"
+
+#include <array>
+#include <cstdint>
+#include <dutils_img/dutils_img.h>
+#include <optional>
+#include <vector>
+
+namespace tcamconvert
+{
+
+// Position of an image in the exposure bracket of tcamsrc, see the hdr_bracket_* fields of the
+// TcamStatisticsMeta
+struct hdr_bracket_info
+{
+    int index = 0;
+    int count = 0;
+    double exposure_us = 0;
+    uint64_t frame_count = 0;
+};
+
+// Collects the images of one exposure bracket and merges them when the last one arrives.
+class hdr_merger
+{
+public:
+    // Fails for formats the merge kernel does not support
+    bool setup(img::img_type src_type);
+
+    // 16-bit type of the merged images
+    img::img_type get_merged_type() const noexcept
+    {
+        return merged_type_;
+    }
+
+    // Returns the merged image, which is valid until the next call, when src completes a bracket.
+    // Brackets with dropped images are discarded.
+    auto add(const img::img_descriptor& src, const hdr_bracket_info& info)
+        -> std::optional<img::img_descriptor>;
+
+    void reset() noexcept;
+
+private:
+    img::img_type src_type_;
+    img::img_type merged_type_;
+    img_filter::filter::hdr_merge::function_type merge_func_ = nullptr;
+
+    // every image but the last of a bracket is copied, the last one is read from the source
+    struct stored_frame
+    {
+        std::vector<uint8_t> data;
+        bool valid = false;
+        double exposure_us = 0;
+        uint64_t frame_count = 0;
+    };
+    std::array<stored_frame, img_filter::filter::hdr_merge::max_frame_count - 1> frames_;
+    std::vector<uint8_t> merged_;
+};
+
+} // namespace tcamconvert
@@ -1,17 +1,30 @@
 
 #include "transform_impl.h"
 
+#include "../../logging.h"
+#include "../../utils.h"
 #include "../../../libs/dutils_image/src/dutils_img_base/memcpy_image.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/by_demosaic/by_demosaic.h"
 #include "../../../libs/dutils_image/src/dutils_img_filter/by_edge/by_edge.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/by_luma/by_luma.h"
 #include "../../../libs/dutils_image/src/dutils_img_filter/filter/whitebalance/wb_apply.h"
 #include "../../../libs/dutils_image/src/dutils_img_filter/transform/fcc1x_packed/fcc1x_packed_to_fcc.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/fcc1x_packed/transform_fcc1x_mono_to_dst.h"
 #include "../../../libs/dutils_image/src/dutils_img_filter/transform/fcc1x_packed/transform_fcc1x_to_fcc8.h"
 #include "../../../libs/dutils_image/src/dutils_img_filter/transform/fcc8_fcc16/transform_fcc8_fcc16.h"
 #include "../../../libs/dutils_image/src/dutils_img_filter/transform/mono_to_bgr/transform_mono_to_bgr.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/polarization/transform_polarization.h"
+#include "transform_worker_pool.h"
 
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <dutils_img_lib/dutils_get_cpu_features.h>
+#include <dutils_img_lib/dutils_scratch_arena.h>
+#include <optional>
+#include <string>
 #include <vector>
 
 namespace
@@ -71,11 +84,11 @@ static const constexpr transform_path transform_entries[] =
             fourcc::MONO12_PACKED,
             fourcc::MONO16,
         },
-        { fourcc::MONO8, fourcc::MONO16, fourcc::BGRA32 }
+        { fourcc::MONO8, fourcc::MONO16, fourcc::BGRA32, fourcc::MONOFloat }
     },
     {
         { fourcc::BGGR8, },
-        { fourcc::BGGR8, fourcc::BGRA32 }
+        { fourcc::BGGR8, fourcc::BGRA32, fourcc::NV12, fourcc::I420, fourcc::YUY2, fourcc::MONO8 }
     },
     {
         {
@@ -88,11 +101,22 @@ static const constexpr transform_path transform_entries[] =
             fourcc::BGGR12_MIPI_PACKED,
             fourcc::BGGR16,
         },
-        { fourcc::BGGR8, fourcc::BGGR16, fourcc::BGRA32 }
+        {
+            fourcc::BGGR8,
+            fourcc::BGGR16,
+            fourcc::BGRA32,
+            fourcc::BGRA64,
+            fourcc::BGRFloat,
+            fourcc::NV12,
+            fourcc::I420,
+            fourcc::YUY2,
+            fourcc::MONO8,
+            fourcc::MONO16,
+        }
     },
     {
         { fourcc::GBRG8, },
-        { fourcc::GBRG8, fourcc::BGRA32 }
+        { fourcc::GBRG8, fourcc::BGRA32, fourcc::NV12, fourcc::I420, fourcc::YUY2, fourcc::MONO8 }
     },
     {
         {
@@ -105,11 +129,22 @@ static const constexpr transform_path transform_entries[] =
             fourcc::GBRG12_MIPI_PACKED,
             fourcc::GBRG16,
         },
-        { fourcc::GBRG8, fourcc::GBRG16, fourcc::BGRA32 }
+        {
+            fourcc::GBRG8,
+            fourcc::GBRG16,
+            fourcc::BGRA32,
+            fourcc::BGRA64,
+            fourcc::BGRFloat,
+            fourcc::NV12,
+            fourcc::I420,
+            fourcc::YUY2,
+            fourcc::MONO8,
+            fourcc::MONO16,
+        }
     },
     {
         { fourcc::RGGB8, },
-        { fourcc::RGGB8, fourcc::BGRA32 }
+        { fourcc::RGGB8, fourcc::BGRA32, fourcc::NV12, fourcc::I420, fourcc::YUY2, fourcc::MONO8 }
     },
     {
         {
@@ -122,11 +157,22 @@ static const constexpr transform_path transform_entries[] =
             fourcc::RGGB12_MIPI_PACKED,
             fourcc::RGGB16,
         },
-        { fourcc::RGGB8, fourcc::RGGB16, fourcc::BGRA32 }
+        {
+            fourcc::RGGB8,
+            fourcc::RGGB16,
+            fourcc::BGRA32,
+            fourcc::BGRA64,
+            fourcc::BGRFloat,
+            fourcc::NV12,
+            fourcc::I420,
+            fourcc::YUY2,
+            fourcc::MONO8,
+            fourcc::MONO16,
+        }
     },
     {
         { fourcc::GRBG8, },
-        { fourcc::GRBG8, fourcc::BGRA32 }
+        { fourcc::GRBG8, fourcc::BGRA32, fourcc::NV12, fourcc::I420, fourcc::YUY2, fourcc::MONO8 }
     },
     {
         {
@@ -139,7 +185,42 @@ static const constexpr transform_path transform_entries[] =
             fourcc::GRBG12_MIPI_PACKED,
             fourcc::GRBG16,
         },
-        { fourcc::GRBG8, fourcc::GRBG16, fourcc::BGRA32 }
+        {
+            fourcc::GRBG8,
+            fourcc::GRBG16,
+            fourcc::BGRA32,
+            fourcc::BGRA64,
+            fourcc::BGRFloat,
+            fourcc::NV12,
+            fourcc::I420,
+            fourcc::YUY2,
+            fourcc::MONO8,
+            fourcc::MONO16,
+        }
+    },
+    {
+        { fourcc::POLARIZATION_MONO8_90_45_135_0 },
+        {
+            fourcc::POLARIZATION_MONO8_90_45_135_0,
+            fourcc::POLARIZATION_PACKED8,
+            fourcc::POLARIZATION_ADI_MONO8,
+            fourcc::BGRA32,
+            fourcc::BGRFloat,
+        }
+    },
+    {
+        {
+            fourcc::POLARIZATION_MONO12_PACKED_90_45_135_0,
+            fourcc::POLARIZATION_MONO12_SPACKED_90_45_135_0,
+            fourcc::POLARIZATION_MONO16_90_45_135_0,
+        },
+        {
+            fourcc::POLARIZATION_MONO16_90_45_135_0,
+            fourcc::POLARIZATION_PACKED16,
+            fourcc::POLARIZATION_ADI_MONO16,
+            fourcc::BGRA32,
+            fourcc::BGRFloat,
+        }
     },
 };
 // clang-format on
@@ -200,174 +281,1232 @@ auto tcamconvert::tcamconvert_get_supported_output_fccs(img::fourcc src_fcc)
     return rval;
 }
 
+bool tcamconvert::tcamconvert_is_yuv_output_fcc(img::fourcc fcc) noexcept
+{
+    return img::is_fcc_in_fcclist(fcc, { fourcc::NV12, fourcc::I420, fourcc::YUY2 });
+}
+
+bool tcamconvert::tcamconvert_can_downscale(img::fourcc src_fcc, img::fourcc dst_fcc) noexcept
+{
+    return img::is_bayer_fcc(src_fcc)
+           && img::is_fcc_in_fcclist(
+               dst_fcc,
+               { fourcc::BGRA32, fourcc::BGRA64, fourcc::BGRFloat, fourcc::MONO8, fourcc::MONO16 });
+}
+
+auto tcamconvert::tcamconvert_get_raw_downscale_fcc(img::fourcc src_fcc,
+                                                    img::fourcc dst_fcc) noexcept -> img::fourcc
+{
+    if (img::is_polarization_cam_format(src_fcc))
+    {
+        return fourcc::FCC_NULL;
+    }
+
+    auto fcc = src_fcc;
+    const auto fcc16 = img_filter::transform::fcc1x_packed::convert_packed_fcc1x_to_fcc16(src_fcc);
+    if (fcc16 != fourcc::FCC_NULL)
+    {
+        // the binned image cannot be packed again
+        if (src_fcc == dst_fcc)
+        {
+            return fourcc::FCC_NULL;
+        }
+        fcc = fcc16;
+    }
+
+    if (fcc == fourcc::MONO8 || fcc == fourcc::MONO16 || img::is_by8_fcc(fcc)
+        || img::is_by16_fcc(fcc))
+    {
+        return fcc;
+    }
+    return fourcc::FCC_NULL;
+}
+
+
+namespace
+{
+auto parse_cpu_level(const std::string& str) -> std::optional<unsigned int>
+{
+    using namespace img::cpu;
+
+    if (str == "c")
+    {
+        return CPU_C;
+    }
+#if defined DUTILS_ARCH_ARM
+    if (str == "neon")
+    {
+        return CPU_UsesARM_A7;
+    }
+    if (str == "sve2")
+    {
+        return CPU_UsesARM_SVE2;
+    }
+#else
+    if (str == "ssse3")
+    {
+        return CPU_UsesSSSE3;
+    }
+    if (str == "sse41")
+    {
+        return CPU_UsesSSE41;
+    }
+    // Functions without an AVX2 kernel use the SSE4.1 variants
+    if (str == "avx2")
+    {
+        return CPU_UsesAVX2;
+    }
+    if (str == "avx512")
+    {
+        return CPU_UsesAVX512_BW;
+    }
+#endif
+    return std::nullopt;
+}
+
+// Features of the cpu we are running on.
+// TCAM_CONVERT_CPU_LEVEL can be used to restrict these, e.g. for benchmarking.
+auto get_cpu_features() -> unsigned int
+{
+    static const unsigned int features = []
+    {
+        unsigned int feat = img_lib::cpu::get_features();
+
+        auto level_str = tcam::get_environment_variable("TCAM_CONVERT_CPU_LEVEL", "");
+        if (!level_str.empty())
+        {
+            if (auto mask = parse_cpu_level(level_str))
+            {
+                feat &= mask.value();
+            }
+            else
+            {
+                SPDLOG_WARN("Unknown value for TCAM_CONVERT_CPU_LEVEL '{}'. Ignoring.", level_str);
+            }
+        }
+        SPDLOG_DEBUG("tcamconvert uses cpu features 0x{:x}", feat);
+        return feat;
+    }();
+    return features;
+}
+
+bool has_cpu_features(unsigned int required) noexcept
+{
+    return (get_cpu_features() & required) == required;
+}
+
+template<class TGetter> struct dispatch_entry
+{
+    unsigned int required_features;
+    TGetter getter;
+};
+
+// Returns the first function, in order of the list, that the cpu supports
+// and that can handle the passed types.
+template<class TGetter, size_t N, class... TArgs>
+auto select_function(const dispatch_entry<TGetter> (&list)[N], const TArgs&... args)
+    -> decltype(list[0].getter(args...))
+{
+    for (const auto& entry : list)
+    {
+        if (!has_cpu_features(entry.required_features))
+        {
+            continue;
+        }
+        if (auto res = entry.getter(args...); res)
+        {
+            return res;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
 
 static auto find_transform_unary_wb_func(img::img_type type)
 {
+    using namespace img::cpu;
+    using getter_type = img_filter::whitebalance::func_type (*)(img::img_type);
+
+    static const dispatch_entry<getter_type> func_list[] = {
 #if defined DUTILS_ARCH_ARM
-    auto wb_func = img_filter::whitebalance::get_apply_img_neon(type);
-#elif defined DUTILS_ARCH_SSE41
-    auto wb_func = img_filter::whitebalance::get_apply_img_sse41(type);
-#elif
-    auto wb_func = img_filter::whitebalance::get_apply_img_c(type);
+        { CPU_UsesARM_SVE2, img_filter::whitebalance::get_apply_img_sve2 },
+        { CPU_UsesARM_A7, img_filter::whitebalance::get_apply_img_neon },
+#else
+        { CPU_UsesAVX512_BW, img_filter::whitebalance::get_apply_img_avx512 },
+        { CPU_UsesAVX2, img_filter::whitebalance::get_apply_img_avx2 },
+        { CPU_UsesSSE41, img_filter::whitebalance::get_apply_img_sse41 },
 #endif
-    return wb_func;
+        { CPU_C, img_filter::whitebalance::get_apply_img_c },
+    };
+    return select_function(func_list, type);
 }
 
 
 static auto find_transform_mono_to_bgr_func(img::img_type dst_type, img::img_type src_type)
 {
+    using namespace img::cpu;
+    using getter_type =
+        img_filter::transform_function_type (*)(const img::img_type&, const img::img_type&);
+
+    static const dispatch_entry<getter_type> func_list[] = {
+#if defined DUTILS_ARCH_ARM
+        { CPU_UsesARM_A7, img_filter::transform::get_transform_mono_to_bgr_neon },
+#else
+        { CPU_UsesSSE41, img_filter::transform::get_transform_mono_to_bgr_sse41 },
+#endif
+        { CPU_C, img_filter::transform::get_transform_mono_to_bgr_c },
+    };
+    return select_function(func_list, dst_type, src_type);
+}
+
+// MONO10/MONO12 (packed) and MONO16 to BGRA32, MONO16 and MONOFloat in one step
+static auto find_transform_fcc1x_mono_to_dst_func(img::img_type dst_type, img::img_type src_type)
+{
+    using namespace img::cpu;
+    using getter_type =
+        img_filter::transform_function_type (*)(const img::img_type&, const img::img_type&);
+
+    static const dispatch_entry<getter_type> func_list[] = {
+#if defined DUTILS_ARCH_ARM
+        { CPU_UsesARM_A7,
+          img_filter::transform::fcc1x_packed::get_transform_fcc1x_mono_to_dst_neon },
+#else
+        { CPU_UsesAVX2, img_filter::transform::fcc1x_packed::get_transform_fcc1x_mono_to_dst_avx2 },
+#endif
+        { CPU_C, img_filter::transform::fcc1x_packed::get_transform_fcc1x_mono_to_dst_c },
+    };
+    return select_function(func_list, dst_type, src_type);
+}
+
+static auto find_transform_polarization_func(img::img_type dst_type, img::img_type src_type)
+{
+    using namespace img::cpu;
+    using getter_type =
+        img_filter::transform_function_type (*)(const img::img_type&, const img::img_type&);
+
+    static const dispatch_entry<getter_type> func_list[] = {
 #if defined DUTILS_ARCH_ARM
-    auto func = img_filter::transform::get_transform_mono_to_bgr_neon(dst_type, src_type);
-#elif defined DUTILS_ARCH_SSE41
-    auto func = img_filter::transform::get_transform_mono_to_bgr_sse41(dst_type, src_type);
-#elif
-    auto func = img_filter::transform::get_transform_mono_to_bgr_c(dst_type, src_type);
+        { CPU_UsesARM_A7, img_filter::transform::polarization::get_transform_polarization_neon },
+#else
+        { CPU_UsesAVX2, img_filter::transform::polarization::get_transform_polarization_avx2 },
+#endif
+        { CPU_C, img_filter::transform::polarization::get_transform_polarization_c },
+    };
+    return select_function(func_list, dst_type, src_type);
+}
+
+auto tcamconvert::find_hdr_merge_func(img::img_type dst_type, img::img_type src_type)
+    -> img_filter::filter::hdr_merge::function_type
+{
+    using namespace img::cpu;
+    using getter_type = img_filter::filter::hdr_merge::function_type (*)(const img::img_type&,
+                                                                         const img::img_type&);
+
+    static const dispatch_entry<getter_type> func_list[] = {
+#if !defined DUTILS_ARCH_ARM
+        { CPU_UsesAVX2, img_filter::filter::hdr_merge::get_hdr_merge_avx2 },
+#endif
+        { CPU_C, img_filter::filter::hdr_merge::get_hdr_merge_c },
+    };
+    return select_function(func_list, dst_type, src_type);
+}
+
+auto tcamconvert::find_calib_correct_func(img::img_type type)
+    -> img_filter::filter::calib_correct::function_type
+{
+    using namespace img::cpu;
+    using getter_type = img_filter::filter::calib_correct::function_type (*)(
+        const img::img_type&, const img::img_type&);
+
+    static const dispatch_entry<getter_type> func_list[] = {
+#if !defined DUTILS_ARCH_ARM
+        { CPU_UsesAVX2, img_filter::filter::calib_correct::get_calib_correct_avx2 },
+#endif
+        { CPU_C, img_filter::filter::calib_correct::get_calib_correct_c },
+    };
+    return select_function(func_list, type, type);
+}
+
+auto tcamconvert::find_binning_func(img::img_type dst_type,
+                                    img::img_type src_type,
+                                    int factor,
+                                    img_filter::transform::binning::mode mode)
+    -> img_filter::transform::binning::function_type
+{
+    using namespace img::cpu;
+    using getter_type = img_filter::transform::binning::function_type (*)(
+        const img::img_type&, const img::img_type&, int, img_filter::transform::binning::mode);
+
+    static const dispatch_entry<getter_type> func_list[] = {
+#if !defined DUTILS_ARCH_ARM
+        { CPU_UsesAVX2, img_filter::transform::binning::get_binning_avx2 },
 #endif
-    return func;
+        { CPU_C, img_filter::transform::binning::get_binning_c },
+    };
+    return select_function(func_list, dst_type, src_type, factor, mode);
 }
 
 static auto find_transform_function_type(img::img_type dst_type, img::img_type src_type)
     -> img_filter::transform_function_type
 {
-    using func_type =
+    using namespace img::cpu;
+    using getter_type =
         img_filter::transform_function_type (*)(const img::img_type&, const img::img_type&);
 
-    static func_type func_list[] = {
+    static const dispatch_entry<getter_type> func_list[] = {
 #if defined DUTILS_ARCH_ARM
-        img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_neon_v0,
-        img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_neon_v0,
-        img_filter::transform::get_transform_fcc8_to_fcc16_neon,
-        img_filter::transform::get_transform_fcc16_to_fcc8_neon,
+        { CPU_UsesARM_SVE2,
+          img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_sve2 },
+        { CPU_UsesARM_SVE2,
+          img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_sve2 },
+        { CPU_UsesARM_A7,
+          img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_neon_v0 },
+        { CPU_UsesARM_A7,
+          img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_neon_v0 },
+        { CPU_UsesARM_A7, img_filter::transform::get_transform_fcc8_to_fcc16_neon },
+        { CPU_UsesARM_A7, img_filter::transform::get_transform_fcc16_to_fcc8_neon },
 #else
-        img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_ssse3,
-        img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_ssse3,
-        img_filter::transform::get_transform_fcc8_to_fcc16_sse41,
-        img_filter::transform::get_transform_fcc16_to_fcc8_sse41,
+        { CPU_UsesAVX2,
+          img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_avx2 },
+        { CPU_UsesSSSE3,
+          img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_ssse3 },
+        { CPU_UsesSSSE3,
+          img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_ssse3 },
+        { CPU_UsesSSE41, img_filter::transform::get_transform_fcc8_to_fcc16_sse41 },
+        { CPU_UsesSSE41, img_filter::transform::get_transform_fcc16_to_fcc8_sse41 },
 #endif
-        img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_c,
-        img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_c,
-        img_filter::transform::get_transform_fcc8_to_fcc16_c,
-        img_filter::transform::get_transform_fcc16_to_fcc8_c,
+        { CPU_C, img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_c },
+        { CPU_C, img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_c },
+        { CPU_C, img_filter::transform::get_transform_fcc8_to_fcc16_c },
+        { CPU_C, img_filter::transform::get_transform_fcc16_to_fcc8_c },
     };
+    return select_function(func_list, dst_type, src_type);
+}
 
-    for (auto func : func_list)
-    {
-        if (auto res = func(dst_type, src_type); res)
-        {
-            return res;
-        }
-    }
-    return nullptr;
+// White balance and gamma via img_filter::lut::by8_lut_data.
+// There are only C variants, the table lookups do not profit from SIMD.
+static auto find_transform_by_to_by8_lut_func(const img::img_type& dst_type,
+                                              const img::img_type& src_type)
+{
+    using namespace img::cpu;
+    using getter_type =
+        img_filter::transform_function_param_type (*)(const img::img_type&, const img::img_type&);
+
+    static const dispatch_entry<getter_type> func_list[] = {
+        { CPU_C, img_filter::lut::get_transform_by_to_by8_lut_c },
+    };
+    return select_function(func_list, dst_type, src_type);
+}
+
+// Contrast stretching of mono formats via img_filter::lut::mono_lut_data.
+// Like the by8 tables there are only C variants.
+static auto find_transform_mono_lut_func(const img::img_type& dst_type,
+                                         const img::img_type& src_type)
+{
+    using namespace img::cpu;
+    using getter_type =
+        img_filter::transform_function_param_type (*)(const img::img_type&, const img::img_type&);
+
+    static const dispatch_entry<getter_type> func_list[] = {
+        { CPU_C, img_filter::lut::get_transform_mono_to_dst_lut_c },
+    };
+    return select_function(func_list, dst_type, src_type);
 }
 
 static auto find_transform_function_wb_type(img::img_type dst_type, img::img_type src_type)
-    -> std::function<void(const img::img_descriptor& dst,
-                          const img::img_descriptor& src,
-                          img_filter::filter_params& params)>
+    -> tcamconvert::transform_binary_wb_func
 {
-    using func_type =
+    using namespace img::cpu;
+    using getter_type =
         img_filter::transform_function_param_type (*)(const img::img_type&, const img::img_type&);
 
-    static func_type func_list[] = {
+    static const dispatch_entry<getter_type> func_list[] = {
 #if defined DUTILS_ARCH_ARM
-        img_filter::transform::fcc1x_packed::get_transform_fcc1x_to_fcc8_neon_v0,
+        { CPU_UsesARM_A7, img_filter::transform::fcc1x_packed::get_transform_fcc1x_to_fcc8_neon_v0 },
     //img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_neon_v0,
     //img_filter::transform::get_transform_fcc8_to_fcc16_neon,
     //img_filter::transform::get_transform_fcc16_to_fcc8_wb_neon,
-#else
 #endif
-        img_filter::transform::fcc1x_packed::get_transform_fcc1x_to_fcc8_c,
+        { CPU_C, img_filter::transform::fcc1x_packed::get_transform_fcc1x_to_fcc8_c },
     };
 
-    for (auto func : func_list)
+    tcamconvert::transform_binary_wb_func res;
+    res.lut = find_transform_by_to_by8_lut_func(dst_type, src_type);
+    res.fused = select_function(func_list, dst_type, src_type);
+    if (!res.fused)
     {
-        if (auto res = func(dst_type, src_type); res)
-        {
-            return res;
-        }
+        res.transform = find_transform_function_type(dst_type, src_type);
+        res.whitebalance = find_transform_unary_wb_func(dst_type);
     }
+    return res;
+}
+
+// The other methods than edge, the color matrix is only applied by the C variant
+static auto find_bayer8_demosaic_func(const img::img_type& dst_type,
+                                      const img::img_type& src_type,
+                                      img_filter::transform::by_demosaic::method demosaic_method,
+                                      const img_filter::transform::by_edge::options* opt)
+    -> tcamconvert::debayer_func
+{
+    using namespace img::cpu;
+    using namespace img_filter::transform::by_demosaic;
+    using getter_type =
+        img_filter::transform_function_type (*)(img::img_type, img::img_type, method);
+    using getter_with_options_type = function_type (*)(img::img_type, img::img_type, method);
+
+    static const dispatch_entry<getter_type> func_list[] = {
+#if defined DUTILS_ARCH_ARM
+        { CPU_UsesARM_A7, get_transform_by8_to_dst_specialized_neon },
+#else
+        { CPU_UsesAVX2, get_transform_by8_to_dst_specialized_avx2 },
+        { CPU_UsesSSE41, get_transform_by8_to_dst_specialized_sse41 },
+#endif
+        { CPU_C, get_transform_by8_to_dst_specialized_c },
+    };
+    static const dispatch_entry<getter_with_options_type> func_with_options_list[] = {
+        { CPU_C, get_transform_by8_to_dst_c },
+    };
+    return tcamconvert::debayer_func {
+        select_function(func_list, dst_type, src_type, demosaic_method),
+        select_function(func_with_options_list, dst_type, src_type, demosaic_method),
+        opt,
+    };
+}
 
-    auto transform_only_func = find_transform_function_type(dst_type, src_type);
-    auto wb_func = find_transform_unary_wb_func(dst_type);
+static auto to_demosaic_method(tcamconvert::debayer_method method) noexcept
+{
+    switch (method)
+    {
+        case tcamconvert::debayer_method::nearest:
+            return img_filter::transform::by_demosaic::method::nearest;
+        case tcamconvert::debayer_method::bilinear:
+            return img_filter::transform::by_demosaic::method::bilinear;
+        case tcamconvert::debayer_method::edge:
+        case tcamconvert::debayer_method::hq:
+            break;
+    }
+    return img_filter::transform::by_demosaic::method::hq;
+}
 
-    auto transform_func = [transform_only_func, wb_func](const img::img_descriptor& dst,
-                                                         const img::img_descriptor& src,
-                                                         img_filter::filter_params& params)
+// The debayer functions are specialized for the pattern of src_type and the dst format, and are
+// used without color matrix and average green.
+// When opt->use_color_matrix is set, the generic functions are used instead.
+static auto find_bayer8_to_bgra_func(const img::img_type& dst_type,
+                                     const img::img_type& src_type,
+                                     tcamconvert::debayer_method method,
+                                     const img_filter::transform::by_edge::options* opt)
+    -> tcamconvert::debayer_func
+{
+    if (method != tcamconvert::debayer_method::edge)
     {
-        transform_only_func(dst, src);
-        wb_func(dst, params.whitebalance);
+        return find_bayer8_demosaic_func(dst_type, src_type, to_demosaic_method(method), opt);
+    }
+
+    using namespace img::cpu;
+    using namespace img_filter::transform::by_edge;
+    using getter_type = img_filter::transform_function_type (*)(img::img_type, img::img_type, bool);
+    using getter_with_options_type = function_type (*)(img::img_type, img::img_type);
+
+    static const dispatch_entry<getter_type> func_list[] = {
+#if defined DUTILS_ARCH_ARM
+        { CPU_UsesARM_A7, get_transform_by8_to_dst_specialized_neon },
+#else
+        { CPU_UsesAVX2, get_transform_by8_to_dst_specialized_avx2 },
+        { CPU_UsesSSE41, get_transform_by8_to_dst_specialized_sse41 },
+#endif
+        { CPU_C, get_transform_by8_to_dst_specialized_c },
+    };
+    static const dispatch_entry<getter_with_options_type> func_with_options_list[] = {
+#if defined DUTILS_ARCH_ARM
+        { CPU_UsesARM_A7, get_transform_by8_to_dst_neon },
+#else
+        { CPU_UsesAVX2, get_transform_by8_to_dst_avx2 },
+        { CPU_UsesSSE41, get_transform_by8_to_dst_sse41 },
+#endif
+        { CPU_C, get_transform_by8_to_dst_c },
+    };
+    return tcamconvert::debayer_func {
+        select_function(func_list, dst_type, src_type, false),
+        select_function(func_with_options_list, dst_type, src_type),
+        opt,
     };
-    return transform_func;
 }
 
-static auto find_bayer8_to_bgra_func(const img::img_type& dst_type, const img::img_type& src_type)
-    -> tcamconvert::transform_binary_func
+static auto find_bayer16_to_rgb_func(const img::img_type& dst_type,
+                                     const img::img_type& src_type,
+                                     const img_filter::transform::by_edge::options* opt)
+    -> tcamconvert::debayer_func
 {
+    using namespace img::cpu;
+    using namespace img_filter::transform::by_edge;
+    using getter_type = img_filter::transform_function_type (*)(img::img_type, img::img_type, bool);
+    using getter_with_options_type = function_type (*)(img::img_type, img::img_type);
+
+    static const dispatch_entry<getter_type> func_list[] = {
 #if defined DUTILS_ARCH_ARM
-    auto func = img_filter::transform::by_edge::get_transform_by8_to_dst_neon(dst_type, src_type);
-#elif defined DUTILS_ARCH_SSE41
-    auto func = img_filter::transform::by_edge::get_transform_by8_to_dst_sse41(dst_type, src_type);
-#elif
-    auto func = img_filter::transform::by_edge::get_transform_by8_to_dst_c(dst_type, src_type);
+        { CPU_UsesARM_SVE2, get_transform_by16_to_dst_specialized_sve2 },
+        { CPU_UsesARM_A7, get_transform_by16_to_dst_specialized_neon },
+#else
+        { CPU_UsesAVX2, get_transform_by16_to_dst_specialized_avx2 },
 #endif
-    return [func](const img::img_descriptor& dst, const img::img_descriptor& src)
-    {
-        static const img_filter::transform::by_edge::options opt = { {}, false, false };
+        { CPU_C, get_transform_by16_to_dst_specialized_c },
+    };
+    static const dispatch_entry<getter_with_options_type> func_with_options_list[] = {
+#if defined DUTILS_ARCH_ARM
+        { CPU_UsesARM_SVE2, get_transform_by16_to_dst_sve2 },
+        { CPU_UsesARM_A7, get_transform_by16_to_dst_neon },
+#else
+        { CPU_UsesAVX2, get_transform_by16_to_dst_avx2 },
+#endif
+        { CPU_C, get_transform_by16_to_dst_c },
+    };
+    return tcamconvert::debayer_func {
+        select_function(func_list, dst_type, src_type, false),
+        select_function(func_with_options_list, dst_type, src_type),
+        opt,
+    };
+}
+
+// There are only C variants, binning reads every source pixel once and is bound by memory
+static auto find_bayer_binned_func(const img::img_type& dst_type, const img::img_type& src_type)
+{
+    using namespace img::cpu;
+    using getter_type = img_filter::transform::by_binned::function_type (*)(img::img_type,
+                                                                            img::img_type);
 
-        func(dst, src, opt);
+    static const dispatch_entry<getter_type> func_list[] = {
+        { CPU_C, img_filter::transform::by_binned::get_transform_by_to_dst_binned_c },
     };
+    return select_function(func_list, dst_type, src_type);
 }
 
-enum class transform_context_mode
+// There is only a C variant, its inner loops are vectorized by the compiler
+static auto find_bayer_luma_func(const img::img_type& dst_type, const img::img_type& src_type)
 {
-    unary_mono,
-    unary_bayer,
-    binary_mono,
-    binary_bayer,
-    binary_rgb,
-};
+    using namespace img::cpu;
+    using getter_type = img_filter::transform_function_type (*)(img::img_type, img::img_type);
 
-static auto get_transform_context_mode(img::img_type src_type, img::img_type dst_type)
-    -> transform_context_mode
+    static const dispatch_entry<getter_type> func_list[] = {
+        { CPU_C, img_filter::transform::by_luma::get_transform_by_to_luma_c },
+    };
+    return select_function(func_list, dst_type, src_type);
+}
+
+static auto find_transform_bgra_to_yuv_func(const img::img_type& dst_type,
+                                            const img::img_type& src_type,
+                                            img_filter::transform::yuv_colorimetry clr)
 {
-    enum class color_mode
-    {
-        bayer,
-        mono
+    using namespace img::cpu;
+    using getter_type = img_filter::transform_function_type (*)(
+        const img::img_type&, const img::img_type&, img_filter::transform::yuv_colorimetry);
+
+    static const dispatch_entry<getter_type> func_list[] = {
+#if defined DUTILS_ARCH_ARM
+        { CPU_UsesARM_A7, img_filter::transform::get_transform_bgra_to_yuv_neon },
+#else
+        { CPU_UsesAVX2, img_filter::transform::get_transform_bgra_to_yuv_avx2 },
+#endif
+        { CPU_C, img_filter::transform::get_transform_bgra_to_yuv_c },
     };
-    auto clr_mode = img::is_mono_fcc(src_type.fourcc_type()) ? color_mode::mono : color_mode::bayer;
+    return select_function(func_list, dst_type, src_type, clr);
+}
 
-    if (src_type.fourcc_type() == dst_type.fourcc_type())
+namespace
+{
+// Per strip, the last lines of the previous strip are kept in front of the new lines.
+// Debayering line y needs lines y - 2 to y + 2 (y - 1 to y + 1 for edge), so the debayer step lags
+// the unpack step by two lines and needs two more lines in front of its first line.
+constexpr int strip_carry_lines = 4;
+
+// Rough budget for the source, the intermediate and the destination lines of one strip.
+// This should stay in the L2 cache.
+constexpr int strip_cache_budget = 512 * 1024;
+
+constexpr int strip_min_lines = 8;
+
+// Bands smaller than this are not worth the synchronization
+constexpr int band_min_lines = 32;
+
+// Lines converted at once by transform_progressive, has to be even
+constexpr int progressive_band_lines = 64;
+
+// Lines debayered at once when the BGRA32 lines are also read for the statistics, has to be even
+constexpr int statistics_chunk_lines = 32;
+
+int calc_strip_line_count(const img::img_type& src_type,
+                          const img::img_type& strip_type,
+                          const img::img_type& dst_type)
+{
+    const int bytes_per_line = img::calc_minimum_pitch(src_type)
+                               + img::calc_minimum_pitch(strip_type)
+                               + img::calc_minimum_pitch(dst_type);
+
+    return std::max(strip_min_lines, strip_cache_budget / std::max(bytes_per_line, 1)) & ~1;
+}
+
+img::img_descriptor make_lines_desc(const img::img_descriptor& desc,
+                                    int y_beg,
+                                    int y_end,
+                                    uint32_t flags)
+{
+    const auto fcc = desc.fourcc_type();
+    if (img::is_multi_plane_format(fcc))
     {
-        if (clr_mode == color_mode::mono)
+        // y_beg has to be even for sub-sampled planes
+        img::img_planar_layout_data planes = {};
+        for (int index = 0; index < img::planar::get_plane_count(fcc); ++index)
         {
-            return transform_context_mode::unary_mono;
+            const auto plane = desc.plane(index);
+            const auto scale_y = img::planar::get_fcc_info(fcc, index).scale_dim_y;
+            planes.planes[index] = img::img_plane {
+                img::get_line_start(plane, static_cast<int>(y_beg * scale_y)), plane.pitch
+            };
         }
-        return transform_context_mode::unary_bayer;
+        const img::dim dim { desc.dim.cx, y_end - y_beg };
+        return img::make_img_desc_raw(
+            fcc, dim, img::calc_minimum_img_size(fcc, dim), planes, flags);
     }
 
-    if (dst_type.fourcc_type() == img::fourcc::BGRA32)
+    const int pitch = desc.pitch();
+    return img::make_img_desc_raw(desc.fourcc_type(),
+                                  img::dim { desc.dim.cx, y_end - y_beg },
+                                  pitch * (y_end - y_beg),
+                                  img::img_plane { img::get_line_start(desc, y_beg), pitch },
+                                  flags);
+}
+
+// Flags for a debayer call on the lines [y_beg, y_end) of an image with the given height
+uint32_t calc_debayer_flags(int y_beg, int y_end, int height) noexcept
+{
+    uint32_t flags = img::img_descriptor::flags_no_flip;
+    if (y_beg != 0)
     {
-        return transform_context_mode::binary_rgb;
+        flags |= img::img_descriptor::flags_no_wrap_beg;
     }
-
-    if (clr_mode == color_mode::mono)
+    if (y_end != height)
     {
-        return transform_context_mode::binary_mono;
+        flags |= img::img_descriptor::flags_no_wrap_end;
     }
-    return transform_context_mode::binary_bayer;
+    return flags;
 }
 
-bool tcamconvert::transform_context::setup(img::img_type src_type, img::img_type dst_type)
+// Unpacks and white balances strips of src into strip_buffer
+// and debayers the lines that are complete directly into the lines [y_beg, y_end) of dst.
+// debayer_func is called with the dst and strip_buffer lines of every step.
+// When statistics is set, the dst lines of every step are added to it, dst then has to be BGRA32.
+//
+// strip_buffer has to hold strip_carry_lines + strip_lines lines.
+template<class TDebayerFunc>
+void transform_in_strips(const img::img_descriptor& dst_in,
+                         const img::img_descriptor& src,
+                         img_filter::filter_params& params,
+                         int y_beg,
+                         int y_end,
+                         img::fourcc strip_fcc,
+                         img::img_plane strip_buffer,
+                         int strip_lines,
+                         const tcamconvert::transform_binary_wb_func& unpack_func,
+                         const TDebayerFunc& debayer_func,
+                         auto_alg::channel_statistics* statistics = nullptr)
 {
-    transform_unary_wb_func_ = nullptr;
-    transfrom_binary_mono_func_ = nullptr;
-    transform_fccXX_to_dst_func_ = nullptr;
+    // the debayer functions flip this themselves, so we have to do it and tell them not to
+    const auto dst = img::flip_image_in_img_desc_if_allowed(dst_in);
+
+    const int height = src.dim.cy;
+    const auto buffer =
+        img::make_img_desc_raw(strip_fcc,
+                               img::dim { src.dim.cx, strip_carry_lines + strip_lines },
+                               strip_buffer.pitch * (strip_carry_lines + strip_lines),
+                               strip_buffer);
+
+    // Lines y_beg - 2 to y_end + 1 are needed for debayering.
+    // We unpack 2 lines, so that every strip starts on the bayer phase of the image.
+    const int unpack_range_beg = std::max(0, y_beg - 2);
+    const int unpack_range_end = std::min(height, y_end + 2);
+
+    int debayer_beg = y_beg;
+    for (int unpack_beg = unpack_range_beg; debayer_beg < y_end; unpack_beg += strip_lines)
+    {
+        const int unpack_end = std::min(unpack_range_end, unpack_beg + strip_lines);
 
-    transform_intermediate_buffer_ = {};
+        if (unpack_beg != unpack_range_beg)
+        {
+            std::memcpy(img::get_line_start(buffer, 0),
+                        img::get_line_start(buffer, strip_lines),
+                        static_cast<size_t>(strip_buffer.pitch) * strip_carry_lines);
+        }
 
-    switch (get_transform_context_mode(src_type, dst_type))
-    {
+        // buffer line strip_carry_lines is src line unpack_beg
+        const int buffer_offset = strip_carry_lines - unpack_beg;
+
+        const auto unpack_dst =
+            make_lines_desc(buffer, buffer_offset + unpack_beg, buffer_offset + unpack_end, 0);
+        const auto unpack_src = make_lines_desc(src, unpack_beg, unpack_end, 0);
+        unpack_func(unpack_dst, unpack_src, params);
+
+        const int debayer_end = std::min(y_end, unpack_end == height ? height : unpack_end - 2);
+        if (debayer_end <= debayer_beg)
+        {
+            continue;
+        }
+
+        const auto flags = calc_debayer_flags(debayer_beg, debayer_end, height);
+        const auto dst_lines = make_lines_desc(dst, debayer_beg, debayer_end, flags);
+        debayer_func(dst_lines,
+                     make_lines_desc(buffer,
+                                     buffer_offset + debayer_beg,
+                                     buffer_offset + debayer_end,
+                                     flags));
+        if (statistics)
+        {
+            auto_alg::accumulate_channel_statistics(*statistics, dst_lines, debayer_beg);
+        }
+
+        debayer_beg = debayer_end;
+    }
+}
+
+// Debayers src into bgra_buffer and converts the result to the yuv image dst.
+// This is done in chunks of bgra_lines lines, so that the BGRA lines are still in the cache when
+// they are converted. When statistics is set, the BGRA lines are also added to it, src line 0 is
+// then the image line first_line.
+template<class TDebayerFunc>
+void transform_by8_to_yuv(const img::img_descriptor& dst,
+                          const img::img_descriptor& src,
+                          img::img_plane bgra_buffer,
+                          int bgra_lines,
+                          const TDebayerFunc& debayer_func,
+                          img_filter::transform_function_type yuv_func,
+                          auto_alg::channel_statistics* statistics = nullptr,
+                          int first_line = 0)
+{
+    const int height = src.dim.cy;
+    for (int y_beg = 0; y_beg < height; y_beg += bgra_lines)
+    {
+        const int y_end = std::min(height, y_beg + bgra_lines);
+
+        // the neighbouring lines of inner chunks are always present
+        uint32_t flags = img::img_descriptor::flags_no_flip;
+        if (y_beg != 0 || (src.flags & img::img_descriptor::flags_no_wrap_beg))
+        {
+            flags |= img::img_descriptor::flags_no_wrap_beg;
+        }
+        if (y_end != height || (src.flags & img::img_descriptor::flags_no_wrap_end))
+        {
+            flags |= img::img_descriptor::flags_no_wrap_end;
+        }
+
+        const auto bgra = img::make_img_desc_raw(img::fourcc::BGRA32,
+                                                 img::dim { src.dim.cx, y_end - y_beg },
+                                                 bgra_buffer.pitch * (y_end - y_beg),
+                                                 bgra_buffer,
+                                                 flags);
+
+        debayer_func(bgra, make_lines_desc(src, y_beg, y_end, flags));
+        yuv_func(make_lines_desc(dst, y_beg, y_end, dst.flags), bgra);
+        if (statistics)
+        {
+            auto_alg::accumulate_channel_statistics(*statistics, bgra, first_line + y_beg);
+        }
+    }
+}
+
+// Unpacks and white balances the src lines of the dst lines [y_beg, y_end) in strips into
+// strip_buffer and bins them into dst.
+// strip_lines is a multiple of factor, strip_buffer has to hold strip_lines lines.
+template<class TBinFunc>
+void transform_binned_in_strips(const img::img_descriptor& dst,
+                                const img::img_descriptor& src,
+                                img_filter::filter_params& params,
+                                int y_beg,
+                                int y_end,
+                                int factor,
+                                img::fourcc strip_fcc,
+                                img::img_plane strip_buffer,
+                                int strip_lines,
+                                const tcamconvert::transform_binary_wb_func& unpack_func,
+                                const TBinFunc& bin_func)
+{
+    const int dst_lines_per_strip = strip_lines / factor;
+    for (int y = y_beg; y < y_end; y += dst_lines_per_strip)
+    {
+        const int y_strip_end = std::min(y_end, y + dst_lines_per_strip);
+        const int src_lines = (y_strip_end - y) * factor;
+
+        const auto buffer = img::make_img_desc_raw(strip_fcc,
+                                                   img::dim { src.dim.cx, src_lines },
+                                                   strip_buffer.pitch * src_lines,
+                                                   strip_buffer);
+
+        unpack_func(buffer, make_lines_desc(src, y * factor, y_strip_end * factor, 0), params);
+        bin_func(make_lines_desc(dst, y, y_strip_end, dst.flags), buffer);
+    }
+}
+
+// Runs func on the lines of the band. Only usable for functions that do not access neighbouring lines.
+template<class TFunc>
+auto make_line_local_pass(TFunc func) -> tcamconvert::transform_context::band_pass_func
+{
+    return [func](const img::img_descriptor& dst,
+                  const img::img_descriptor& src,
+                  img_filter::filter_params& params,
+                  const tcamconvert::transform_context::band& b)
+    {
+        func(make_lines_desc(dst, b.y_beg, b.y_end, dst.flags),
+             make_lines_desc(src, b.y_beg, b.y_end, src.flags),
+             params);
+    };
+}
+
+// White balances a by8 src in place, with the table when the params contain one
+auto make_by8_wb_in_place_func(tcamconvert::transform_unary_wb_func wb_func,
+                               img_filter::transform_function_param_type lut_func)
+{
+    return [wb_func, lut_func](const img::img_descriptor& /*dst*/,
+                               const img::img_descriptor& src,
+                               img_filter::filter_params& params)
+    {
+        if (params.by8_lut)
+        {
+            lut_func(src, src, params);
+            return;
+        }
+        wb_func(src, params.whitebalance);
+    };
+}
+
+// Converts with the table when the params contain one
+auto make_mono_lut_or_transform_func(img_filter::transform_function_type func,
+                                     img_filter::transform_function_param_type lut_func)
+{
+    return [func, lut_func](const img::img_descriptor& dst,
+                            const img::img_descriptor& src,
+                            img_filter::filter_params& params)
+    {
+        if (lut_func && params.mono_lut)
+        {
+            lut_func(dst, src, params);
+            return;
+        }
+        func(dst, src);
+    };
+}
+
+// Corrects the lines of the band from src into dst. Packed sources are unpacked in strips and
+// every strip is corrected right after it was unpacked.
+auto make_calib_pass(img_filter::filter::calib_correct::function_type calib_func,
+                     img_filter::transform_function_type unpack_func,
+                     const img_filter::filter::calib_correct::params* calib_params,
+                     int strip_lines) -> tcamconvert::transform_context::band_pass_func
+{
+    return [calib_func, unpack_func, calib_params, strip_lines](
+               const img::img_descriptor& dst,
+               const img::img_descriptor& src,
+               img_filter::filter_params& /*params*/,
+               const tcamconvert::transform_context::band& b)
+    {
+        if (!unpack_func)
+        {
+            calib_func(make_lines_desc(dst, b.y_beg, b.y_end, dst.flags),
+                       make_lines_desc(src, b.y_beg, b.y_end, src.flags),
+                       b.y_beg,
+                       *calib_params);
+            return;
+        }
+        for (int y_beg = b.y_beg; y_beg < b.y_end; y_beg += strip_lines)
+        {
+            const int y_end = std::min(b.y_end, y_beg + strip_lines);
+            const auto lines = make_lines_desc(dst, y_beg, y_end, dst.flags);
+            unpack_func(lines, make_lines_desc(src, y_beg, y_end, src.flags));
+            calib_func(lines, lines, y_beg, *calib_params);
+        }
+    };
+}
+
+// Bins the src lines of the dst lines of the band into dst. Packed sources are unpacked in strips
+// of strip_lines dst lines, which are binned right after they were unpacked.
+auto make_downscale_pass(img_filter::transform::binning::function_type bin_func,
+                         img_filter::transform_function_type unpack_func,
+                         img::fourcc unpacked_fcc,
+                         int factor,
+                         int strip_lines) -> tcamconvert::transform_context::band_pass_func
+{
+    return [bin_func, unpack_func, unpacked_fcc, factor, strip_lines](
+               const img::img_descriptor& dst,
+               const img::img_descriptor& src,
+               img_filter::filter_params& /*params*/,
+               const tcamconvert::transform_context::band& b)
+    {
+        if (!unpack_func)
+        {
+            bin_func(make_lines_desc(dst, b.y_beg, b.y_end, dst.flags),
+                     make_lines_desc(src, b.y_beg * factor, b.y_end * factor, src.flags));
+            return;
+        }
+
+        const auto strip_type =
+            img::make_img_type(unpacked_fcc, img::dim { src.dim.cx, strip_lines * factor });
+        const auto strip_buffer = img_lib::scratch::acquire(strip_type.buffer_length);
+        for (int y_beg = b.y_beg; y_beg < b.y_end; y_beg += strip_lines)
+        {
+            const int y_end = std::min(b.y_end, y_beg + strip_lines);
+            const auto lines = img::make_img_desc_from_linear_memory(
+                img::make_img_type(unpacked_fcc,
+                                   img::dim { src.dim.cx, (y_end - y_beg) * factor }),
+                strip_buffer.data());
+            unpack_func(lines,
+                        make_lines_desc(src, y_beg * factor, y_end * factor, src.flags));
+            bin_func(make_lines_desc(dst, y_beg, y_end, dst.flags), lines);
+        }
+    };
+}
+
+// Lines a pass writes into the scratch buffer before they are oriented. Rotations write that
+// many pixels into every dst line, so they should fill a few cache lines, while the chunk still
+// fits into the cache budget.
+int calc_orient_chunk_lines(const img::img_type& type)
+{
+    constexpr int min_bytes_per_dst_line = 256;
+
+    const int pitch = std::max(img::calc_minimum_pitch(type), 1);
+    const int bytes_per_pixel = std::max(pitch / std::max(type.dim.cx, 1), 1);
+    const int lines =
+        std::min(min_bytes_per_dst_line / bytes_per_pixel, strip_cache_budget / pitch);
+    return std::max(strip_min_lines, lines) & ~1;
+}
+
+// Descriptor of an image with the dimensions dim, whose lines [y_beg, y_beg + lines of chunk)
+// are the lines of chunk. Only these lines may be accessed.
+img::img_descriptor make_chunk_as_image_desc(const img::img_descriptor& chunk,
+                                             img::dim dim,
+                                             int y_beg,
+                                             uint32_t flags)
+{
+    const auto fcc = chunk.fourcc_type();
+    const int plane_count = img::planar::get_plane_count(fcc);
+
+    img::img_planar_layout_data planes = {};
+    for (int index = 0; index < plane_count; ++index)
+    {
+        const auto scale_y =
+            plane_count > 1 ? img::planar::get_fcc_info(fcc, index).scale_dim_y : 1.f;
+        const auto plane = chunk.plane(index);
+        planes.planes[index] = img::img_plane {
+            img::get_line_start(plane, -static_cast<int>(y_beg * scale_y)), plane.pitch
+        };
+    }
+    return img::make_img_desc_raw(fcc, dim, img::calc_minimum_img_size(fcc, dim), planes, flags);
+}
+
+// Runs pass on chunks of the band, which it writes into a scratch buffer instead of dst.
+// orient_func then moves every chunk to its place in dst while it is still in the cache.
+// conv_type is the result of pass before it is oriented.
+auto make_oriented_pass(tcamconvert::transform_context::band_pass_func pass,
+                        img_filter::transform::orientation::function_type orient_func,
+                        img::img_type conv_type,
+                        int chunk_lines) -> tcamconvert::transform_context::band_pass_func
+{
+    return [pass = std::move(pass), orient_func, conv_type, chunk_lines](
+               const img::img_descriptor& dst,
+               const img::img_descriptor& src,
+               img_filter::filter_params& params,
+               const tcamconvert::transform_context::band& b)
+    {
+        const auto chunk_type = img::make_img_type(conv_type.fourcc_type(),
+                                                   img::dim { conv_type.dim.cx, chunk_lines });
+        const auto chunk_buffer = img_lib::scratch::acquire(chunk_type.buffer_length);
+        const auto chunk = img::make_img_desc_from_linear_memory(chunk_type, chunk_buffer.data());
+
+        for (int y_beg = b.y_beg; y_beg < b.y_end; y_beg += chunk_lines)
+        {
+            const int y_end = std::min(b.y_end, y_beg + chunk_lines);
+
+            auto chunk_band = b;
+            chunk_band.y_beg = y_beg;
+            chunk_band.y_end = y_end;
+            pass(make_chunk_as_image_desc(chunk, conv_type.dim, y_beg, dst.flags),
+                 src,
+                 params,
+                 chunk_band);
+            orient_func(dst, make_lines_desc(chunk, 0, y_end - y_beg, 0), y_beg);
+        }
+    };
+}
+
+// Moves the lines of the band of src to their place in dst, for conversions without passes
+auto make_orient_pass(img_filter::transform::orientation::function_type orient_func)
+    -> tcamconvert::transform_context::band_pass_func
+{
+    return [orient_func](const img::img_descriptor& dst,
+                         const img::img_descriptor& src,
+                         img_filter::filter_params& /*params*/,
+                         const tcamconvert::transform_context::band& b)
+    { orient_func(dst, make_lines_desc(src, b.y_beg, b.y_end, src.flags), b.y_beg); };
+}
+
+// Addresses all planes of desc from the last line upwards
+img::img_descriptor flip_vertical(const img::img_descriptor& desc)
+{
+    const auto fcc = desc.fourcc_type();
+    const int plane_count = img::planar::get_plane_count(fcc);
+
+    auto res = desc;
+    for (int index = 0; index < plane_count; ++index)
+    {
+        const auto scale_y =
+            plane_count > 1 ? img::planar::get_fcc_info(fcc, index).scale_dim_y : 1.f;
+        const int lines = static_cast<int>(desc.dim.cy * scale_y);
+        const auto plane = desc.plane(index);
+        res.data_.planes[index] =
+            img::img_plane { img::get_line_start(plane, lines - 1), -plane.pitch };
+    }
+    return res;
+}
+
+} // namespace
+
+enum class transform_context_mode
+{
+    unary_mono,
+    unary_bayer,
+    binary_mono,
+    binary_bayer,
+    binary_rgb,
+    binary_rgb16, // BGRA64 and BGRFloat
+    binary_yuv,
+    binary_binned, // bayer to BGRA32, BGRA64 and BGRFloat with 1/2 or 1/4 of the dimensions
+    binary_polarization, // polarized mono to the angles, ADI, false colour BGRA32 or stokes BGRFloat
+    binary_luma, // bayer to MONO8 and MONO16 without debayering, also binned by 2 or 4
+};
+
+static auto get_transform_context_mode(img::img_type src_type, img::img_type dst_type)
+    -> transform_context_mode
+{
+    enum class color_mode
+    {
+        bayer,
+        mono
+    };
+    auto clr_mode = img::is_mono_fcc(src_type.fourcc_type()) ? color_mode::mono : color_mode::bayer;
+
+    if (img::is_bayer_fcc(src_type.fourcc_type()) && img::is_mono_fcc(dst_type.fourcc_type()))
+    {
+        return transform_context_mode::binary_luma;
+    }
+
+    if (src_type.dim != dst_type.dim)
+    {
+        assert(img_filter::transform::by_binned::calc_binning_factor(dst_type.dim, src_type.dim)
+               != 0);
+        return transform_context_mode::binary_binned;
+    }
+
+    if (src_type.fourcc_type() == dst_type.fourcc_type())
+    {
+        if (clr_mode == color_mode::mono || img::is_polarization_cam_format(src_type.fourcc_type()))
+        {
+            return transform_context_mode::unary_mono;
+        }
+        return transform_context_mode::unary_bayer;
+    }
+
+    if (img::is_polarization_cam_format(src_type.fourcc_type()))
+    {
+        return transform_context_mode::binary_polarization;
+    }
+
+    if (dst_type.fourcc_type() == img::fourcc::BGRA32)
+    {
+        return transform_context_mode::binary_rgb;
+    }
+    if (dst_type.fourcc_type() == img::fourcc::BGRA64
+        || dst_type.fourcc_type() == img::fourcc::BGRFloat)
+    {
+        return transform_context_mode::binary_rgb16;
+    }
+    if (tcamconvert::tcamconvert_is_yuv_output_fcc(dst_type.fourcc_type()))
+    {
+        return transform_context_mode::binary_yuv;
+    }
+
+    if (clr_mode == color_mode::mono)
+    {
+        return transform_context_mode::binary_mono;
+    }
+    return transform_context_mode::binary_bayer;
+}
+
+// The line local conversions from 16-bit formats write every block behind the data they
+// have read, so dst can be placed on src.
+static bool can_convert_in_place(transform_context_mode mode,
+                                 const img::img_type& src_type,
+                                 const img::img_type& dst_type) noexcept
+{
+    if (mode != transform_context_mode::binary_mono && mode != transform_context_mode::binary_bayer)
+    {
+        return false;
+    }
+    if (img::get_bits_per_pixel(src_type.fourcc_type()) != 16)
+    {
+        return false;
+    }
+    switch (img::get_bits_per_pixel(dst_type.fourcc_type()))
+    {
+        case 8:
+            // the last SIMD step of a line re-reads the end of the src line
+            return dst_type.dim.cx >= 64;
+        case 16:
+            // otherwise the last SIMD step of a line overlaps the previous one
+            return dst_type.dim.cx % 8 == 0;
+        default:
+            return false;
+    }
+}
+
+bool tcamconvert::transform_context::setup(img::img_type src_type,
+                                           img::img_type dst_type,
+                                           img_filter::transform::yuv_colorimetry yuv_clr)
+{
+    using img_filter::transform::orientation::mode;
+
+    orient_func_ = nullptr;
+    uses_debayer_method_ = false;
+
+    // the passes write the image before it is oriented
+    const auto conv_type = img::make_img_type(
+        dst_type.fourcc_type(),
+        img_filter::transform::orientation::calc_oriented_dim(dst_type.dim, orientation_));
+    conv_dim_ = conv_type.dim;
+
+    if (orientation_ != mode::identity
+        && !img_filter::transform::orientation::can_orient(dst_type.fourcc_type()))
+    {
+        return false;
+    }
+    if (!setup_passes(src_type, conv_type, yuv_clr))
+    {
+        return false;
+    }
+
+    // the tone mapping is folded into the tables, which bayer formats only use for 8-bit outputs
+    const bool uses_tone_map_table =
+        uses_mono_lut_
+        || (uses_color_correction_ && dst_type.fourcc_type() != img::fourcc::BGRA64
+            && dst_type.fourcc_type() != img::fourcc::BGRFloat);
+    tone_stats_func_ = uses_tone_map_table
+                           ? img_filter::filter::tone_map::get_collect_statistics_c(src_fcc_)
+                           : nullptr;
+    tone_curve_ = {};
+
+    if (orientation_ == mode::identity)
+    {
+        return true;
+    }
+
+    in_place_capable_ = false;
+    if (orientation_ == mode::flip_vertical)
+    {
+        // make_dst_desc addresses dst bottom up
+        return true;
+    }
+
+    orient_func_ =
+        img_filter::transform::orientation::get_orientation_c(dst_type, conv_type, orientation_);
+    if (!orient_func_)
+    {
+        return false;
+    }
+    // the wrapped last pass writes chunks of the rotated image
+    statistics_capable_ = false;
+
+    // Only the last pass writes dst
+    if (passes_.empty())
+    {
+        passes_.push_back(make_orient_pass(orient_func_));
+    }
+    else
+    {
+        passes_.back() = make_oriented_pass(
+            std::move(passes_.back()), orient_func_, conv_type, calc_orient_chunk_lines(conv_type));
+    }
+    return true;
+}
+
+bool tcamconvert::transform_context::setup_passes(img::img_type src_type,
+                                                  img::img_type dst_type,
+                                                  img_filter::transform::yuv_colorimetry yuv_clr)
+{
+    transform_unary_wb_func_ = nullptr;
+    passes_.clear();
+    statistics_capable_ = false;
+    binning_factor_ = 0;
+    calib_func_ = nullptr;
+    downscale_func_ = nullptr;
+
+    intermediate_buffer_size_ = 0;
+    band_buffer_size_ = 0;
+
+    const bool downscales_raw = raw_downscale_factor_ > 1;
+
+    // only binned conversions and the raw downscale change the dimensions
+    if (downscales_raw)
+    {
+        if (dst_type.dim
+            != img_filter::transform::binning::calc_binned_dim(
+                tcamconvert_get_raw_downscale_fcc(src_type.fourcc_type(), dst_type.fourcc_type()),
+                src_type.dim,
+                raw_downscale_factor_))
+        {
+            return false;
+        }
+    }
+    else if (src_type.dim != dst_type.dim
+             && (!tcamconvert_can_downscale(src_type.fourcc_type(), dst_type.fourcc_type())
+                 || img_filter::transform::by_binned::calc_binning_factor(dst_type.dim,
+                                                                          src_type.dim)
+                        == 0))
+    {
+        return false;
+    }
+
+    // the corrected and the downscaled images are copies, so this only depends on the types of
+    // the caller
+    in_place_capable_ =
+        !downscales_raw
+        && can_convert_in_place(
+            get_transform_context_mode(src_type, dst_type), src_type, dst_type);
+
+    const bool is_unary = src_type.fourcc_type() == dst_type.fourcc_type();
+    if (setup_calibration(src_type, is_unary))
+    {
+        // the passes convert the unpacked 16-bit image
+        src_type = calib_type_;
+    }
+    if (downscales_raw)
+    {
+        if (!setup_raw_downscale(src_type, dst_type.fourcc_type(), dst_type.dim))
+        {
+            return false;
+        }
+        src_type = downscale_type_;
+    }
+
+    const auto mode = get_transform_context_mode(src_type, dst_type);
+
+    src_fcc_ = src_type.fourcc_type();
+    uses_mono_lut_ = false;
+    uses_color_correction_ = img::is_bayer_fcc(src_fcc_)
+                             && (mode == transform_context_mode::binary_rgb
+                                 || mode == transform_context_mode::binary_rgb16
+                                 || mode == transform_context_mode::binary_yuv
+                                 || mode == transform_context_mode::binary_binned);
+    by8_lut_valid_ = false;
+    set_color_correction(color_correction_);
+
+    switch (mode)
+    {
         case transform_context_mode::unary_mono:
             break;
         case transform_context_mode::unary_bayer:
@@ -379,17 +1518,34 @@ bool tcamconvert::transform_context::setup(img::img_type src_type, img::img_type
         }
         case transform_context_mode::binary_mono:
         {
-            transfrom_binary_mono_func_ = find_transform_function_type(dst_type, src_type);
-            assert(transfrom_binary_mono_func_ != nullptr);
+            // MONOFloat is only written by the fused functions
+            auto func = dst_type.fourcc_type() == fourcc::MONOFloat
+                            ? find_transform_fcc1x_mono_to_dst_func(dst_type, src_type)
+                            : find_transform_function_type(dst_type, src_type);
+            assert(func != nullptr);
+            if (!func)
+            {
+                return false;
+            }
+
+            auto lut_func = find_transform_mono_lut_func(dst_type, src_type);
+            uses_mono_lut_ = lut_func != nullptr;
 
-            return transfrom_binary_mono_func_ != nullptr;
+            passes_.push_back(
+                make_line_local_pass(make_mono_lut_or_transform_func(func, lut_func)));
+            return true;
         }
         case transform_context_mode::binary_bayer:
         {
-            transform_fccXX_to_dst_func_ = find_transform_function_wb_type(dst_type, src_type);
-            assert(transform_fccXX_to_dst_func_ != nullptr);
+            auto func = find_transform_function_wb_type(dst_type, src_type);
+            assert(func);
+            if (!func)
+            {
+                return false;
+            }
 
-            return transform_fccXX_to_dst_func_ != nullptr;
+            passes_.push_back(make_line_local_pass(func));
+            return true;
         }
         case transform_context_mode::binary_rgb:
         {
@@ -397,73 +1553,94 @@ bool tcamconvert::transform_context::setup(img::img_type src_type, img::img_type
             {
                 auto transform_to_bgra_func = find_transform_mono_to_bgr_func(dst_type, src_type);
                 assert(transform_to_bgra_func != nullptr);
+                if (!transform_to_bgra_func)
+                {
+                    return false;
+                }
 
-                transform_fccXX_to_dst_func_ =
+                passes_.push_back(make_line_local_pass(
                     [transform_to_bgra_func](const img::img_descriptor& dst,
                                              const img::img_descriptor& src,
                                              img_filter::filter_params& /*params*/)
-                {
-                    assert(src.fourcc_type() == img::fourcc::MONO8);
-                    assert(dst.fourcc_type() == img::fourcc::BGRA32);
+                    {
+                        assert(src.fourcc_type() == img::fourcc::MONO8);
+                        assert(dst.fourcc_type() == img::fourcc::BGRA32);
 
-                    transform_to_bgra_func(dst, src);
-                };
-                return transform_fccXX_to_dst_func_ != nullptr;
+                        transform_to_bgra_func(dst, src);
+                    }));
+                return true;
             }
-            else if (
-                img::is_mono_fcc(
-                    src_type.fourcc_type())) // MONOXX to BGRA32, done via MONOXX -> MONO8 -> BGRA32
+            else if (img::is_mono_fcc(src_type.fourcc_type())) // MONOXX to BGRA32 in one step
             {
-                auto transform_intermediate_type =
-                    img::make_img_type(img::fourcc::MONO8, src_type.dim);
-
-                transform_intermediate_buffer_.resize(transform_intermediate_type.buffer_length);
-
-                auto transfrom_to_mono8 =
-                    find_transform_function_type(transform_intermediate_type, src_type);
-                assert(transfrom_to_mono8 != nullptr);
-
                 auto transform_to_bgra_func =
-                    find_transform_mono_to_bgr_func(dst_type, transform_intermediate_type);
+                    find_transform_fcc1x_mono_to_dst_func(dst_type, src_type);
                 assert(transform_to_bgra_func != nullptr);
-
-                transform_fccXX_to_dst_func_ =
-                    [transform_intermediate_type, transfrom_to_mono8, transform_to_bgra_func, this](
-                        const img::img_descriptor& dst,
-                        const img::img_descriptor& src,
-                        img_filter::filter_params& /*params*/)
+                if (!transform_to_bgra_func)
                 {
-                    assert(dst.fourcc_type() == img::fourcc::BGRA32);
+                    return false;
+                }
 
-                    auto mono8_img_desc = img::make_img_desc_from_linear_memory(
-                        transform_intermediate_type, transform_intermediate_buffer_.data());
+                auto lut_func = find_transform_mono_lut_func(dst_type, src_type);
+                uses_mono_lut_ = lut_func != nullptr;
 
-                    transfrom_to_mono8(mono8_img_desc, src);
-
-                    transform_to_bgra_func(dst, mono8_img_desc);
-                };
-                return transform_fccXX_to_dst_func_ != nullptr;
+                passes_.push_back(make_line_local_pass(
+                    make_mono_lut_or_transform_func(transform_to_bgra_func, lut_func)));
+                return true;
             }
             else if (img::is_by8_fcc(src_type.fourcc_type())) // Bayer8 -> BGRA32
             {
                 auto wb_func =
                     find_transform_unary_wb_func(src_type); // whitebalance on src image func
                 assert(wb_func != nullptr);
+                auto lut_func = find_transform_by_to_by8_lut_func(src_type, src_type);
+                assert(lut_func != nullptr);
 
-                auto transform_by8_to_bgra_func = find_bayer8_to_bgra_func(dst_type, src_type);
-                assert(transform_by8_to_bgra_func != nullptr);
+                auto transform_by8_to_bgra_func = find_bayer8_to_bgra_func(
+                    dst_type, src_type, debayer_method_, &debayer_options_);
+                assert(transform_by8_to_bgra_func);
+                uses_debayer_method_ = true;
 
-                transform_fccXX_to_dst_func_ =
-                    [transform_by8_to_bgra_func, wb_func](const img::img_descriptor& dst,
-                                                          const img::img_descriptor& src,
-                                                          img_filter::filter_params& params)
+                if (!wb_func || !lut_func || !transform_by8_to_bgra_func)
                 {
-                    assert(dst.fourcc_type() == img::fourcc::BGRA32);
-
-                    wb_func(src, params.whitebalance);
-                    transform_by8_to_bgra_func(dst, src);
-                };
-                return transform_fccXX_to_dst_func_ != nullptr;
+                    return false;
+                }
+
+                // debayering reads the neighbouring lines, so all of src has to be
+                // white balanced before the first band is debayered
+                passes_.push_back(
+                    make_line_local_pass(make_by8_wb_in_place_func(wb_func, lut_func)));
+
+                passes_.push_back(
+                    [transform_by8_to_bgra_func](const img::img_descriptor& dst,
+                                                 const img::img_descriptor& src,
+                                                 img_filter::filter_params& /*params*/,
+                                                 const band& b)
+                    {
+                        assert(dst.fourcc_type() == img::fourcc::BGRA32);
+
+                        if (!b.statistics)
+                        {
+                            const auto flags = calc_debayer_flags(b.y_beg, b.y_end, src.dim.cy);
+                            transform_by8_to_bgra_func(
+                                make_lines_desc(dst, b.y_beg, b.y_end, flags),
+                                make_lines_desc(src, b.y_beg, b.y_end, flags));
+                            return;
+                        }
+
+                        // in chunks, so that the lines are still in the cache for the statistics
+                        for (int y_beg = b.y_beg; y_beg < b.y_end; y_beg += statistics_chunk_lines)
+                        {
+                            const int y_end = std::min(b.y_end, y_beg + statistics_chunk_lines);
+                            const auto flags = calc_debayer_flags(y_beg, y_end, src.dim.cy);
+                            const auto dst_lines = make_lines_desc(dst, y_beg, y_end, flags);
+                            transform_by8_to_bgra_func(dst_lines,
+                                                       make_lines_desc(src, y_beg, y_end, flags));
+                            auto_alg::accumulate_channel_statistics(
+                                *b.statistics, dst_lines, y_beg);
+                        }
+                    });
+                statistics_capable_ = true;
+                return true;
             }
             else if (!img::is_by8_fcc(src_type.fourcc_type())) // bayerXX -> BGRA32, done via bayerXX -> bayer8 -> BGRA32
             {
@@ -471,47 +1648,895 @@ bool tcamconvert::transform_context::setup(img::img_type src_type, img::img_type
                     img::by_transform::convert_bayer_fcc_to_bayer8_fcc(src_type.fourcc_type()),
                     src_type.dim);
 
-                transform_intermediate_buffer_.resize(transform_intermediate_type.buffer_length);
-
                 auto transform_byXX_to_byYY_func =
                     find_transform_function_wb_type(transform_intermediate_type, src_type);
-                assert(transform_byXX_to_byYY_func != nullptr);
+                assert(transform_byXX_to_byYY_func);
                 auto transform_by8_to_bgra_func =
-                    find_bayer8_to_bgra_func(dst_type, transform_intermediate_type);
-                assert(transform_by8_to_bgra_func != nullptr);
+                    find_bayer8_to_bgra_func(dst_type,
+                                             transform_intermediate_type,
+                                             debayer_method_,
+                                             &debayer_options_);
+                assert(transform_by8_to_bgra_func);
+                uses_debayer_method_ = true;
+
+                if (!transform_byXX_to_byYY_func || !transform_by8_to_bgra_func)
+                {
+                    return false;
+                }
+
+                const int strip_lines =
+                    calc_strip_line_count(src_type, transform_intermediate_type, dst_type);
+                const int by8_pitch = img::calc_minimum_pitch(transform_intermediate_type);
+
+                // every band has its own strip buffer
+                band_buffer_size_ =
+                    static_cast<size_t>(by8_pitch) * (strip_carry_lines + strip_lines);
+
+                passes_.push_back(
+                    [transform_by8_to_bgra_func,
+                     transform_byXX_to_byYY_func,
+                     by8_fcc = transform_intermediate_type.fourcc_type(),
+                     by8_pitch,
+                     strip_lines](const img::img_descriptor& dst,
+                                  const img::img_descriptor& src,
+                                  img_filter::filter_params& params,
+                                  const band& b)
+                    {
+                        assert(dst.fourcc_type() == img::fourcc::BGRA32);
+
+                        const img::img_plane strip_buffer { b.strip_buffer, by8_pitch };
+                        transform_in_strips(dst,
+                                            src,
+                                            params,
+                                            b.y_beg,
+                                            b.y_end,
+                                            by8_fcc,
+                                            strip_buffer,
+                                            strip_lines,
+                                            transform_byXX_to_byYY_func,
+                                            transform_by8_to_bgra_func,
+                                            b.statistics);
+                    });
+                statistics_capable_ = true;
+                return true;
+            }
+        }
+        case transform_context_mode::binary_rgb16:
+        {
+            // bayerXX -> bayer16 -> BGRA64/BGRFloat, so no precision is lost before debayering
+            const auto by16_type = img::make_img_type(
+                img::by_transform::convert_bayer_fcc_to_bayer16_fcc(src_type.fourcc_type()),
+                src_type.dim);
+
+            auto transform_by16_to_rgb_func =
+                find_bayer16_to_rgb_func(dst_type, by16_type, &debayer_options_);
+            assert(transform_by16_to_rgb_func);
+            if (!transform_by16_to_rgb_func)
+            {
+                return false;
+            }
+
+            if (img::is_by16_fcc(src_type.fourcc_type()))
+            {
+                auto wb_func = find_transform_unary_wb_func(src_type);
+                assert(wb_func != nullptr);
+                if (!wb_func)
+                {
+                    return false;
+                }
+
+                passes_.push_back(make_line_local_pass(
+                    [wb_func](const img::img_descriptor& /*dst*/,
+                              const img::img_descriptor& src,
+                              img_filter::filter_params& params)
+                    { wb_func(src, params.whitebalance); }));
+
+                passes_.push_back(
+                    [transform_by16_to_rgb_func](const img::img_descriptor& dst,
+                                                 const img::img_descriptor& src,
+                                                 img_filter::filter_params& /*params*/,
+                                                 const band& b)
+                    {
+                        const auto flags = calc_debayer_flags(b.y_beg, b.y_end, src.dim.cy);
+                        transform_by16_to_rgb_func(make_lines_desc(dst, b.y_beg, b.y_end, flags),
+                                                   make_lines_desc(src, b.y_beg, b.y_end, flags));
+                    });
+                return true;
+            }
+
+            auto transform_byXX_to_by16_func = find_transform_function_wb_type(by16_type, src_type);
+            assert(transform_byXX_to_by16_func);
+            if (!transform_byXX_to_by16_func)
+            {
+                return false;
+            }
+
+            const int strip_lines = calc_strip_line_count(src_type, by16_type, dst_type);
+            const int by16_pitch = img::calc_minimum_pitch(by16_type);
 
+            band_buffer_size_ = static_cast<size_t>(by16_pitch) * (strip_carry_lines + strip_lines);
 
-                transform_fccXX_to_dst_func_ = [transform_by8_to_bgra_func,
-                                                transform_byXX_to_byYY_func,
-                                                transform_intermediate_type,
-                                                this](const img::img_descriptor& dst,
-                                                      const img::img_descriptor& src,
-                                                      img_filter::filter_params& params)
+            passes_.push_back(
+                [transform_by16_to_rgb_func,
+                 transform_byXX_to_by16_func,
+                 by16_fcc = by16_type.fourcc_type(),
+                 by16_pitch,
+                 strip_lines](const img::img_descriptor& dst,
+                              const img::img_descriptor& src,
+                              img_filter::filter_params& params,
+                              const band& b)
                 {
-                    assert(dst.fourcc_type() == img::fourcc::BGRA32);
+                    const img::img_plane strip_buffer { b.strip_buffer, by16_pitch };
+                    transform_in_strips(dst,
+                                        src,
+                                        params,
+                                        b.y_beg,
+                                        b.y_end,
+                                        by16_fcc,
+                                        strip_buffer,
+                                        strip_lines,
+                                        transform_byXX_to_by16_func,
+                                        transform_by16_to_rgb_func);
+                });
+            return true;
+        }
+        case transform_context_mode::binary_yuv:
+        {
+            // bayer -> BGRA32 -> yuv, the BGRA32 lines only exist in the strip buffer of the band
+            const auto by8_type = img::make_img_type(
+                img::by_transform::convert_bayer_fcc_to_bayer8_fcc(src_type.fourcc_type()),
+                src_type.dim);
+            const auto bgra_type = img::make_img_type(img::fourcc::BGRA32, src_type.dim);
+
+            auto transform_by8_to_bgra_func =
+                find_bayer8_to_bgra_func(bgra_type, by8_type, debayer_method_, &debayer_options_);
+            assert(transform_by8_to_bgra_func);
+            uses_debayer_method_ = true;
+            auto transform_bgra_to_yuv_func =
+                find_transform_bgra_to_yuv_func(dst_type, bgra_type, yuv_clr);
+            assert(transform_bgra_to_yuv_func != nullptr);
+
+            if (!transform_by8_to_bgra_func || !transform_bgra_to_yuv_func)
+            {
+                return false;
+            }
 
-                    auto by8_img_desc = img::make_img_desc_from_linear_memory(
-                        transform_intermediate_type, transform_intermediate_buffer_.data());
+            const int strip_lines = calc_strip_line_count(src_type, by8_type, bgra_type);
+            const int bgra_pitch = img::calc_minimum_pitch(bgra_type);
+            const size_t bgra_buffer_size = static_cast<size_t>(bgra_pitch) * strip_lines;
 
-                    transform_byXX_to_byYY_func(by8_img_desc, src, params);
+            if (img::is_by8_fcc(src_type.fourcc_type()))
+            {
+                auto wb_func = find_transform_unary_wb_func(src_type);
+                assert(wb_func != nullptr);
+                auto lut_func = find_transform_by_to_by8_lut_func(src_type, src_type);
+                assert(lut_func != nullptr);
+                if (!wb_func || !lut_func)
+                {
+                    return false;
+                }
+
+                band_buffer_size_ = bgra_buffer_size;
+
+                passes_.push_back(
+                    make_line_local_pass(make_by8_wb_in_place_func(wb_func, lut_func)));
+
+                passes_.push_back(
+                    [transform_by8_to_bgra_func,
+                     transform_bgra_to_yuv_func,
+                     bgra_pitch,
+                     strip_lines](const img::img_descriptor& dst,
+                                  const img::img_descriptor& src,
+                                  img_filter::filter_params& /*params*/,
+                                  const band& b)
+                    {
+                        const img::img_plane bgra_buffer { b.strip_buffer, bgra_pitch };
+                        const auto flags = calc_debayer_flags(b.y_beg, b.y_end, src.dim.cy);
+                        transform_by8_to_yuv(make_lines_desc(dst, b.y_beg, b.y_end, dst.flags),
+                                             make_lines_desc(src, b.y_beg, b.y_end, flags),
+                                             bgra_buffer,
+                                             strip_lines,
+                                             transform_by8_to_bgra_func,
+                                             transform_bgra_to_yuv_func,
+                                             b.statistics,
+                                             b.y_beg);
+                    });
+                statistics_capable_ = true;
+                return true;
+            }
 
-                    transform_by8_to_bgra_func(dst, by8_img_desc);
-                };
+            auto transform_byXX_to_by8_func = find_transform_function_wb_type(by8_type, src_type);
+            assert(transform_byXX_to_by8_func);
+            if (!transform_byXX_to_by8_func)
+            {
+                return false;
+            }
 
-                return transform_fccXX_to_dst_func_ != nullptr;
+            // the unpacked lines, followed by the BGRA32 lines
+            const int by8_pitch = img::calc_minimum_pitch(by8_type);
+            const size_t by8_buffer_size =
+                (static_cast<size_t>(by8_pitch) * (strip_carry_lines + strip_lines) + 63) & ~63;
+            band_buffer_size_ = by8_buffer_size + bgra_buffer_size;
+
+            passes_.push_back(
+                [transform_byXX_to_by8_func,
+                 transform_by8_to_bgra_func,
+                 transform_bgra_to_yuv_func,
+                 by8_fcc = by8_type.fourcc_type(),
+                 by8_pitch,
+                 by8_buffer_size,
+                 bgra_pitch,
+                 strip_lines](const img::img_descriptor& dst,
+                              const img::img_descriptor& src,
+                              img_filter::filter_params& params,
+                              const band& b)
+                {
+                    auto* band_buffer = b.strip_buffer;
+                    const img::img_plane strip_buffer { band_buffer, by8_pitch };
+                    const img::img_plane bgra_buffer { band_buffer + by8_buffer_size, bgra_pitch };
+
+                    auto debayer_to_yuv = [&](const img::img_descriptor& yuv_lines,
+                                              const img::img_descriptor& by8_lines)
+                    {
+                        transform_by8_to_yuv(yuv_lines,
+                                             by8_lines,
+                                             bgra_buffer,
+                                             strip_lines,
+                                             transform_by8_to_bgra_func,
+                                             transform_bgra_to_yuv_func);
+                    };
+                    transform_in_strips(dst,
+                                        src,
+                                        params,
+                                        b.y_beg,
+                                        b.y_end,
+                                        by8_fcc,
+                                        strip_buffer,
+                                        strip_lines,
+                                        transform_byXX_to_by8_func,
+                                        debayer_to_yuv);
+                });
+            return true;
+        }
+        case transform_context_mode::binary_binned:
+        {
+            binning_factor_ =
+                img_filter::transform::by_binned::calc_binning_factor(dst_type.dim, src_type.dim);
+
+            // BGRA32 is binned from bayer8, BGRA64 and BGRFloat from bayer16
+            const auto bin_src_fcc =
+                dst_type.fourcc_type() == img::fourcc::BGRA32
+                    ? img::by_transform::convert_bayer_fcc_to_bayer8_fcc(src_type.fourcc_type())
+                    : img::by_transform::convert_bayer_fcc_to_bayer16_fcc(src_type.fourcc_type());
+            const auto bin_src_type = img::make_img_type(bin_src_fcc, src_type.dim);
+
+            auto bin_func = find_bayer_binned_func(dst_type, bin_src_type);
+            assert(bin_func != nullptr);
+            if (!bin_func)
+            {
+                return false;
             }
+
+            if (bin_src_fcc == src_type.fourcc_type())
+            {
+                auto wb_func = find_transform_unary_wb_func(src_type);
+                assert(wb_func != nullptr);
+                auto lut_func = find_transform_by_to_by8_lut_func(src_type, src_type);
+                if (!wb_func)
+                {
+                    return false;
+                }
+
+                // the blocks of a band only contain its own src lines, so the white balance is
+                // done in the same pass
+                passes_.push_back(
+                    [wb_func, lut_func, bin_func, factor = binning_factor_, this](
+                        const img::img_descriptor& dst,
+                        const img::img_descriptor& src,
+                        img_filter::filter_params& params,
+                        const band& b)
+                    {
+                        const auto src_lines =
+                            make_lines_desc(src, b.y_beg * factor, b.y_end * factor, src.flags);
+                        if (lut_func && params.by8_lut)
+                        {
+                            lut_func(src_lines, src_lines, params);
+                        }
+                        else
+                        {
+                            wb_func(src_lines, params.whitebalance);
+                        }
+                        bin_func(make_lines_desc(dst, b.y_beg, b.y_end, dst.flags),
+                                 src_lines,
+                                 debayer_options_);
+                    });
+                return true;
+            }
+
+            auto unpack_func = find_transform_function_wb_type(bin_src_type, src_type);
+            assert(unpack_func);
+            if (!unpack_func)
+            {
+                return false;
+            }
+
+            const int strip_lines = std::max(
+                binning_factor_,
+                calc_strip_line_count(src_type, bin_src_type, dst_type) / binning_factor_
+                    * binning_factor_);
+            const int strip_pitch = img::calc_minimum_pitch(bin_src_type);
+
+            band_buffer_size_ = static_cast<size_t>(strip_pitch) * strip_lines;
+
+            passes_.push_back(
+                [bin_func,
+                 unpack_func,
+                 bin_src_fcc,
+                 strip_pitch,
+                 strip_lines,
+                 factor = binning_factor_,
+                 this](const img::img_descriptor& dst,
+                       const img::img_descriptor& src,
+                       img_filter::filter_params& params,
+                       const band& b)
+                {
+                    const img::img_plane strip_buffer { b.strip_buffer, strip_pitch };
+                    transform_binned_in_strips(
+                        dst,
+                        src,
+                        params,
+                        b.y_beg,
+                        b.y_end,
+                        factor,
+                        bin_src_fcc,
+                        strip_buffer,
+                        strip_lines,
+                        unpack_func,
+                        [&](const img::img_descriptor& dst_lines,
+                            const img::img_descriptor& src_lines)
+                        { bin_func(dst_lines, src_lines, debayer_options_); });
+                });
+            return true;
         }
+        case transform_context_mode::binary_luma:
+        {
+            // MONO8 is filtered from bayer8 and MONO16 from bayer16
+            const auto luma_src_fcc =
+                dst_type.fourcc_type() == img::fourcc::MONO8
+                    ? img::by_transform::convert_bayer_fcc_to_bayer8_fcc(src_type.fourcc_type())
+                    : img::by_transform::convert_bayer_fcc_to_bayer16_fcc(src_type.fourcc_type());
+            const auto luma_src_type = img::make_img_type(luma_src_fcc, src_type.dim);
+
+            auto luma_func = find_bayer_luma_func(dst_type, luma_src_type);
+            assert(luma_func != nullptr);
+            if (!luma_func)
+            {
+                return false;
+            }
+
+            // 0 for the full resolution filter
+            binning_factor_ =
+                img_filter::transform::by_binned::calc_binning_factor(dst_type.dim, src_type.dim);
+
+            if (luma_src_fcc == src_type.fourcc_type())
+            {
+                auto wb_func = find_transform_unary_wb_func(src_type);
+                assert(wb_func != nullptr);
+                if (!wb_func)
+                {
+                    return false;
+                }
+
+                if (binning_factor_ != 0)
+                {
+                    // the blocks of a band only contain its own src lines
+                    passes_.push_back(
+                        [wb_func, luma_func, factor = binning_factor_](
+                            const img::img_descriptor& dst,
+                            const img::img_descriptor& src,
+                            img_filter::filter_params& params,
+                            const band& b)
+                        {
+                            const auto src_lines =
+                                make_lines_desc(src, b.y_beg * factor, b.y_end * factor, src.flags);
+                            wb_func(src_lines, params.whitebalance);
+                            luma_func(make_lines_desc(dst, b.y_beg, b.y_end, dst.flags), src_lines);
+                        });
+                    return true;
+                }
+
+                // the filter reads the neighbouring lines, so all of src has to be white balanced
+                // before the first band is filtered
+                passes_.push_back(make_line_local_pass(
+                    [wb_func](const img::img_descriptor& /*dst*/,
+                              const img::img_descriptor& src,
+                              img_filter::filter_params& params)
+                    { wb_func(src, params.whitebalance); }));
+
+                passes_.push_back(
+                    [luma_func](const img::img_descriptor& dst,
+                                const img::img_descriptor& src,
+                                img_filter::filter_params& /*params*/,
+                                const band& b)
+                    {
+                        const auto flags = calc_debayer_flags(b.y_beg, b.y_end, src.dim.cy);
+                        luma_func(make_lines_desc(dst, b.y_beg, b.y_end, flags),
+                                  make_lines_desc(src, b.y_beg, b.y_end, flags));
+                    });
+                return true;
+            }
+
+            // The packed and 16-bit formats are unpacked and white balanced in strips of the band,
+            // which are filtered while they are in the cache
+            auto unpack_func = find_transform_function_wb_type(luma_src_type, src_type);
+            assert(unpack_func);
+            if (!unpack_func)
+            {
+                return false;
+            }
+
+            const int strip_pitch = img::calc_minimum_pitch(luma_src_type);
+
+            if (binning_factor_ != 0)
+            {
+                const int strip_lines = std::max(
+                    binning_factor_,
+                    calc_strip_line_count(src_type, luma_src_type, dst_type) / binning_factor_
+                        * binning_factor_);
+
+                band_buffer_size_ = static_cast<size_t>(strip_pitch) * strip_lines;
+
+                passes_.push_back(
+                    [luma_func,
+                     unpack_func,
+                     luma_src_fcc,
+                     strip_pitch,
+                     strip_lines,
+                     factor = binning_factor_](const img::img_descriptor& dst,
+                                               const img::img_descriptor& src,
+                                               img_filter::filter_params& params,
+                                               const band& b)
+                    {
+                        const img::img_plane strip_buffer { b.strip_buffer, strip_pitch };
+                        transform_binned_in_strips(dst,
+                                                   src,
+                                                   params,
+                                                   b.y_beg,
+                                                   b.y_end,
+                                                   factor,
+                                                   luma_src_fcc,
+                                                   strip_buffer,
+                                                   strip_lines,
+                                                   unpack_func,
+                                                   luma_func);
+                    });
+                return true;
+            }
+
+            const int strip_lines = calc_strip_line_count(src_type, luma_src_type, dst_type);
+
+            band_buffer_size_ =
+                static_cast<size_t>(strip_pitch) * (strip_carry_lines + strip_lines);
+
+            passes_.push_back(
+                [luma_func, unpack_func, luma_src_fcc, strip_pitch, strip_lines](
+                    const img::img_descriptor& dst,
+                    const img::img_descriptor& src,
+                    img_filter::filter_params& params,
+                    const band& b)
+                {
+                    // the mono lines are top down, transform_in_strips would flip them
+                    auto top_down_dst = dst;
+                    top_down_dst.flags |= img::img_descriptor::flags_no_flip;
+
+                    const img::img_plane strip_buffer { b.strip_buffer, strip_pitch };
+                    transform_in_strips(top_down_dst,
+                                        src,
+                                        params,
+                                        b.y_beg,
+                                        b.y_end,
+                                        luma_src_fcc,
+                                        strip_buffer,
+                                        strip_lines,
+                                        unpack_func,
+                                        luma_func);
+                });
+            return true;
+        }
+        case transform_context_mode::binary_polarization:
+        {
+            // The 12-bit formats are unpacked to 16-bit first. They are stored like the mono
+            // formats, so the mono unpack functions are used.
+            const bool needs_unpack = img::get_bits_per_pixel(src_type.fourcc_type()) == 12;
+            const auto unpack_src_fcc =
+                src_type.fourcc_type() == fourcc::POLARIZATION_MONO12_PACKED_90_45_135_0
+                    ? fourcc::MONO12_PACKED
+                    : fourcc::MONO12_SPACKED;
+            const auto pol_src_type =
+                needs_unpack
+                    ? img::make_img_type(fourcc::POLARIZATION_MONO16_90_45_135_0, src_type.dim)
+                    : src_type;
+
+            auto pol_func = find_transform_polarization_func(dst_type, pol_src_type);
+            assert(pol_func != nullptr);
+            if (!pol_func)
+            {
+                return false;
+            }
+
+            if (needs_unpack)
+            {
+                const auto mono16_type = img::make_img_type(fourcc::MONO16, src_type.dim);
+                auto unpack_func = find_transform_function_type(
+                    mono16_type, img::make_img_type(unpack_src_fcc, src_type.dim));
+                assert(unpack_func != nullptr);
+                if (!unpack_func)
+                {
+                    return false;
+                }
+
+                intermediate_buffer_size_ = pol_src_type.buffer_length;
+
+                passes_.push_back(
+                    [mono16_type, unpack_func, unpack_src_fcc](
+                        const img::img_descriptor& /*dst*/,
+                        const img::img_descriptor& src,
+                        img_filter::filter_params& /*params*/,
+                        const band& b)
+                    {
+                        auto src_lines = make_lines_desc(src, b.y_beg, b.y_end, src.flags);
+                        src_lines.type = static_cast<uint32_t>(unpack_src_fcc);
+
+                        unpack_func(make_lines_desc(img::make_img_desc_from_linear_memory(
+                                                        mono16_type,
+                                                        b.intermediate_buffer),
+                                                    b.y_beg,
+                                                    b.y_end,
+                                                    0),
+                                    src_lines);
+                    });
+            }
+
+            passes_.push_back(
+                [pol_func, pol_src_type, needs_unpack](const img::img_descriptor& dst,
+                                                       const img::img_descriptor& src,
+                                                       img_filter::filter_params& /*params*/,
+                                                       const band& b)
+                {
+                    const auto pol_src = needs_unpack
+                                             ? img::make_img_desc_from_linear_memory(
+                                                 pol_src_type, b.intermediate_buffer)
+                                             : src;
+
+                    // the last line of a band needs the first line of the next band, which the
+                    // previous pass has already unpacked
+                    const int src_y_end = std::min(b.y_end + 1, pol_src.dim.cy);
+                    pol_func(make_lines_desc(dst, b.y_beg, b.y_end, dst.flags),
+                             make_lines_desc(pol_src, b.y_beg, src_y_end, pol_src.flags));
+                });
+            return true;
+        }
+    }
+    return true;
+}
+
+bool tcamconvert::transform_context::setup_calibration(img::img_type src_type, bool is_unary)
+{
+    calib_func_ = nullptr;
+    calib_unpack_func_ = nullptr;
+    calib_passes_.clear();
+
+    const auto src_fcc = src_type.fourcc_type();
+    if (!calib_params_ || !img_filter::filter::calib_correct::is_active(*calib_params_)
+        || img::is_polarization_cam_format(src_fcc))
+    {
+        return false;
+    }
+
+    calib_type_ = src_type;
+    const auto fcc16 = img_filter::transform::fcc1x_packed::convert_packed_fcc1x_to_fcc16(src_fcc);
+    if (fcc16 != img::fourcc::FCC_NULL)
+    {
+        // the corrected image cannot be packed again
+        if (is_unary)
+        {
+            return false;
+        }
+        calib_type_ = img::make_img_type(fcc16, src_type.dim);
+        calib_unpack_func_ = find_transform_function_type(calib_type_, src_type);
+        if (!calib_unpack_func_)
+        {
+            return false;
+        }
+    }
+
+    calib_func_ = find_calib_correct_func(calib_type_);
+    if (!calib_func_)
+    {
+        calib_unpack_func_ = nullptr;
+        return false;
+    }
+
+    const int bytes_per_line =
+        img::calc_minimum_pitch(src_type) + img::calc_minimum_pitch(calib_type_);
+    const int strip_lines =
+        std::max(strip_min_lines, strip_cache_budget / std::max(bytes_per_line, 1)) & ~1;
+
+    calib_passes_.push_back(
+        make_calib_pass(calib_func_, calib_unpack_func_, calib_params_, strip_lines));
+    return true;
+}
+
+bool tcamconvert::transform_context::setup_raw_downscale(img::img_type src_type,
+                                                         img::fourcc dst_fcc,
+                                                         img::dim dst_dim)
+{
+    downscale_passes_.clear();
+
+    const auto binned_fcc = tcamconvert_get_raw_downscale_fcc(src_type.fourcc_type(), dst_fcc);
+    if (binned_fcc == img::fourcc::FCC_NULL)
+    {
+        return false;
+    }
+
+    // src_type is already unpacked when the calibration runs before
+    const auto binned_src_type = img::make_img_type(binned_fcc, src_type.dim);
+    img_filter::transform_function_type unpack_func = nullptr;
+    if (binned_src_type != src_type)
+    {
+        unpack_func = find_transform_function_type(binned_src_type, src_type);
+        if (!unpack_func)
+        {
+            return false;
+        }
+    }
+
+    downscale_type_ = img::make_img_type(binned_fcc, dst_dim);
+    downscale_func_ = find_binning_func(
+        downscale_type_, binned_src_type, raw_downscale_factor_, raw_downscale_mode_);
+    if (!downscale_func_)
+    {
+        return false;
     }
+
+    // lines of dst per strip, even so that every strip has the bayer phase of the image
+    const int bytes_per_line =
+        (img::calc_minimum_pitch(src_type) + img::calc_minimum_pitch(binned_src_type))
+            * raw_downscale_factor_
+        + img::calc_minimum_pitch(downscale_type_);
+    const int strip_lines =
+        std::max(strip_min_lines, strip_cache_budget / std::max(bytes_per_line, 1)) & ~1;
+
+    downscale_passes_.push_back(make_downscale_pass(
+        downscale_func_, unpack_func, binned_fcc, raw_downscale_factor_, strip_lines));
     return true;
 }
 
+int tcamconvert::transform_context::calc_band_count(int height) const noexcept
+{
+    if (!worker_pool_ || height % 2 != 0)
+    {
+        return 1;
+    }
+    return std::clamp(height / band_min_lines, 1, worker_pool_->thread_count());
+}
+
+void tcamconvert::transform_context::run_bands(const img::img_descriptor& dst,
+                                               const img::img_descriptor& src,
+                                               const img_filter::filter_params& params,
+                                               const std::vector<band_pass_func>& passes,
+                                               int dst_height,
+                                               auto_alg::channel_statistics* statistics)
+{
+    // the bands of binned and downscaling passes are in dst lines
+    const int height = std::min(dst_height, src.dim.cy);
+
+    // When converting in place to shorter lines, the dst lines of a band overwrite src lines of
+    // the previous bands
+    const bool shrinks_in_place = dst.data() == src.data() && dst.pitch() != src.pitch();
+    const int band_count = shrinks_in_place ? 1 : calc_band_count(height);
+
+    // bands start on even lines, so that every band has the bayer phase of the image
+    const int band_lines = ((height + band_count - 1) / band_count + 1) & ~1;
+
+    const auto intermediate_buffer = img_lib::scratch::acquire(intermediate_buffer_size_);
+
+    // every band accumulates its own statistics, these are merged after the last pass
+    if (statistics)
+    {
+        if (band_statistics_.size() < static_cast<size_t>(band_count))
+        {
+            band_statistics_.resize(band_count);
+        }
+        for (int index = 0; index < band_count; ++index)
+        {
+            band_statistics_[index].reset(statistics->dim);
+        }
+    }
+
+    for (const auto& pass : passes)
+    {
+        auto run_band = [&](int index)
+        {
+            band b = {
+                std::min(height, index * band_lines),
+                std::min(height, (index + 1) * band_lines),
+                index,
+            };
+            b.statistics = statistics ? &band_statistics_[index] : nullptr;
+            if (b.y_beg == b.y_end)
+            {
+                return;
+            }
+
+            // acquired on the thread running the band, so it usually comes from its cache
+            const auto strip_buffer = img_lib::scratch::acquire(band_buffer_size_);
+            b.strip_buffer = strip_buffer.data();
+            b.intermediate_buffer = intermediate_buffer.data();
+
+            img_filter::filter_params tmp = params;
+            pass(dst, src, tmp, b);
+        };
+
+        if (band_count == 1)
+        {
+            run_band(0);
+        }
+        else
+        {
+            worker_pool_->run(band_count, run_band);
+        }
+    }
+
+    if (statistics)
+    {
+        for (int index = 0; index < band_count; ++index)
+        {
+            statistics->merge(band_statistics_[index]);
+        }
+    }
+}
+
+static auto to_color_matrix_int(const img::color_matrix_float& mtx) noexcept
+    -> img::color_matrix_int
+{
+    // 64 ^= 1.f
+    img::color_matrix_int rval = {};
+    for (int i = 0; i < 9; ++i)
+    {
+        const float fac = std::clamp(std::round(mtx.fac[i] * 64.f), -32768.f, 32767.f);
+        rval.fac[i] = static_cast<int16_t>(fac);
+    }
+    return rval;
+}
+
+void tcamconvert::transform_context::set_color_correction(
+    const color_correction_params& params) noexcept
+{
+    color_correction_ = params;
+
+    debayer_options_.use_color_matrix = uses_color_correction_ && params.use_color_matrix;
+    debayer_options_.color_mtx = to_color_matrix_int(params.color_mtx);
+}
+
+auto tcamconvert::transform_context::update_by8_lut(const img_filter::whitebalance_params& wb)
+    -> const img_filter::lut::by8_lut_data*
+{
+    // Without gamma the SIMD white balance functions are faster than the table lookups
+    if (!uses_color_correction_ || (color_correction_.gamma == 1.f && !tone_maps()))
+    {
+        return nullptr;
+    }
+
+    const bool wb_changed = wb.wb_rr != by8_lut_wb_.wb_rr || wb.wb_gr != by8_lut_wb_.wb_gr
+                            || wb.wb_bb != by8_lut_wb_.wb_bb || wb.wb_gb != by8_lut_wb_.wb_gb;
+    if (!by8_lut_)
+    {
+        by8_lut_ = std::make_unique<img_filter::lut::by8_lut_data>();
+    }
+    if (!by8_lut_valid_ || wb_changed || color_correction_.gamma != by8_lut_gamma_
+        || tone_curve_ != by8_lut_curve_)
+    {
+        img_filter::lut::fill_by8_lut(*by8_lut_,
+                                      img::by_transform::convert_bayer_fcc_to_pattern(src_fcc_),
+                                      wb,
+                                      color_correction_.gamma,
+                                      tone_curve_);
+        by8_lut_valid_ = true;
+        by8_lut_wb_ = wb;
+        by8_lut_gamma_ = color_correction_.gamma;
+        by8_lut_curve_ = tone_curve_;
+    }
+    return by8_lut_.get();
+}
+
+auto tcamconvert::transform_context::update_mono_lut() -> const img_filter::lut::mono_lut_data*
+{
+    const float contrast_min = color_correction_.contrast_min;
+    const float contrast_max = color_correction_.contrast_max;
+    if (!uses_mono_lut_ || (contrast_min <= 0.f && contrast_max >= 1.f && !tone_maps()))
+    {
+        return nullptr;
+    }
+
+    if (!mono_lut_)
+    {
+        mono_lut_ = std::make_unique<img_filter::lut::mono_lut_data>();
+    }
+    if (!mono_lut_valid_ || contrast_min != mono_lut_min_ || contrast_max != mono_lut_max_
+        || tone_curve_ != mono_lut_curve_)
+    {
+        const int black =
+            std::clamp(static_cast<int>(std::lround(contrast_min * 0xFFFF)), 0, 0xFFFE);
+        const int white =
+            std::clamp(static_cast<int>(std::lround(contrast_max * 0xFFFF)), black + 1, 0xFFFF);
+
+        // the curve gets the stretched values, so its white point and log-average are stretched too
+        auto curve = tone_curve_;
+        if (!curve.is_identity())
+        {
+            const auto stretch = [black, white](float val)
+            { return (val * 0xFFFF - black) / static_cast<float>(white - black); };
+            curve.white = std::clamp(stretch(curve.white), 1.f / 1024, 1.f);
+            curve.log_avg = std::clamp(stretch(curve.log_avg), 1.f / 65536, curve.white);
+        }
+
+        img_filter::lut::fill_mono_lut_contrast_stretch(*mono_lut_, black, white, curve);
+        mono_lut_valid_ = true;
+        mono_lut_min_ = contrast_min;
+        mono_lut_max_ = contrast_max;
+        mono_lut_curve_ = tone_curve_;
+    }
+    return mono_lut_.get();
+}
+
+void tcamconvert::transform_context::update_tone_map(const img::img_descriptor& src)
+{
+    using namespace img_filter::filter::tone_map;
+
+    if (!tone_maps())
+    {
+        tone_curve_ = {};
+        return;
+    }
+
+    if (!tone_stats_)
+    {
+        tone_stats_ = std::make_unique<statistics>();
+    }
+    tone_stats_func_(*tone_stats_, src);
+
+    // The white point and the log-average follow the images over a few frames, so the brightness
+    // does not pump with every frame
+    constexpr float adaption_rate = 0.25f;
+
+    auto curve = calc_curve(color_correction_.tone_map, *tone_stats_);
+    if (curve.oper == tone_curve_.oper && curve.oper != op::linear)
+    {
+        curve.white = tone_curve_.white + (curve.white - tone_curve_.white) * adaption_rate;
+        curve.log_avg = tone_curve_.log_avg + (curve.log_avg - tone_curve_.log_avg) * adaption_rate;
+    }
+    tone_curve_ = curve;
+
+    if (color_correction_.tone_map_local > 0.f)
+    {
+        calc_gain_map(tone_gains_, *tone_stats_, std::min(color_correction_.tone_map_local, 1.f));
+        tone_gains_.origin = src.data();
+        tone_gains_.pitch = src.pitch();
+    }
+}
+
 void tcamconvert::transform_context::transform(const img::img_descriptor& src,
                                                const img::img_descriptor& dst,
                                                const img_filter::whitebalance_params& params)
 {
-    if (transform_fccXX_to_dst_func_ == nullptr && transfrom_binary_mono_func_ == nullptr)
+    if (has_raw_stages())
     {
-        img::memcpy_image(dst, src);
+        transform_raw_stages(src, dst, params);
+    }
+    else if (passes_.empty())
+    {
+        img::memcpy_image(make_dst_desc(dst), src);
         if (transform_unary_wb_func_ && params.apply)
         {
             transform_unary_wb_func_(dst, params);
@@ -519,31 +2544,176 @@ void tcamconvert::transform_context::transform(const img::img_descriptor& src,
     }
     else
     {
-        auto dst_ = dst;
-        if (dst.fourcc_type() == img::fourcc::BGRA32)
+        run_bands(make_dst_desc(dst),
+                  src,
+                  make_filter_params(params, src),
+                  passes_,
+                  conv_dim_.cy,
+                  begin_statistics(src.dim));
+    }
+}
+
+auto tcamconvert::transform_context::begin_statistics(img::dim src_dim) noexcept
+    -> auto_alg::channel_statistics*
+{
+    if (collect_statistics_ && statistics_capable_ && downscale_func_ == nullptr)
+    {
+        statistics_.reset(src_dim);
+        return &statistics_;
+    }
+    // only cleared once, the struct is a few KB
+    if (!statistics_.empty())
+    {
+        statistics_.reset({});
+    }
+    return nullptr;
+}
+
+void tcamconvert::transform_context::transform_raw_stages(
+    const img::img_descriptor& src,
+    const img::img_descriptor& dst,
+    const img_filter::whitebalance_params& params)
+{
+    // the tables are only used by passes_
+    const img_filter::filter_params fparams = { params };
+
+    // Every stage writes into a scratch image, which the next stage reads.
+    // Conversions without passes would only copy the result, so the last stage writes into dst.
+    struct stage
+    {
+        const std::vector<band_pass_func>* passes = nullptr;
+        img::img_type type;
+    };
+    stage stages[2];
+    int stage_count = 0;
+    if (calib_func_)
+    {
+        stages[stage_count++] = { &calib_passes_, calib_type_ };
+    }
+    if (downscale_func_)
+    {
+        stages[stage_count++] = { &downscale_passes_, downscale_type_ };
+    }
+
+    auto cur = src;
+    img_lib::scratch::buffer buffers[2];
+    for (int i = 0; i < stage_count; ++i)
+    {
+        if (passes_.empty() && i + 1 == stage_count)
         {
-            dst_ = img::flip_image_in_img_desc(dst);
+            run_bands(make_dst_desc(dst), cur, fparams, *stages[i].passes, dst.dim.cy);
+            if (transform_unary_wb_func_ && params.apply)
+            {
+                transform_unary_wb_func_(dst, params);
+            }
+            return;
         }
 
-        if (transform_fccXX_to_dst_func_)
-        {
-            img_filter::filter_params tmp = { params };
+        buffers[i] = img_lib::scratch::acquire(stages[i].type.buffer_length);
+        const auto out = img::make_img_desc_from_linear_memory(stages[i].type, buffers[i].data());
+        run_bands(out, cur, fparams, *stages[i].passes, out.dim.cy);
+        cur = out;
+    }
+    run_bands(make_dst_desc(dst),
+              cur,
+              make_filter_params(params, cur),
+              passes_,
+              conv_dim_.cy,
+              begin_statistics(cur.dim));
+}
 
-            transform_fccXX_to_dst_func_(dst_, src, tmp);
-        }
-        else
+img::img_descriptor tcamconvert::transform_context::make_dst_desc(
+    const img::img_descriptor& dst) const noexcept
+{
+    auto dst_ = dst;
+    if (img::is_bottom_up_fcc(dst.fourcc_type()) || dst.fourcc_type() == img::fourcc::BGRFloat
+        || tcamconvert_is_yuv_output_fcc(dst.fourcc_type()))
+    {
+        // the dutils functions expect bottom up BGRA, so they would flip this
+        // the other formats are top down, but share the strip code that flips BGRA
+        dst_.flags |= img::img_descriptor::flags_no_flip;
+    }
+    if (orientation_ == img_filter::transform::orientation::mode::flip_vertical)
+    {
+        return flip_vertical(dst_);
+    }
+    return dst_;
+}
+
+img_filter::filter_params tcamconvert::transform_context::make_filter_params(
+    const img_filter::whitebalance_params& params,
+    const img::img_descriptor& src)
+{
+    // the curve has to be known before the tables are filled
+    update_tone_map(src);
+
+    img_filter::filter_params fparams = { params };
+    fparams.by8_lut = update_by8_lut(params);
+    fparams.mono_lut = update_mono_lut();
+    if (tone_maps() && color_correction_.tone_map_local > 0.f)
+    {
+        fparams.tone_gain = &tone_gains_;
+    }
+    return fparams;
+}
+
+bool tcamconvert::transform_context::transform_progressive(
+    const img::img_descriptor& src,
+    const img::img_descriptor& dst,
+    const img_filter::whitebalance_params& params,
+    const wait_for_lines_func& wait_for_lines)
+{
+    const int height = src.dim.cy;
+
+    const bool shrinks_in_place = dst.data() == src.data() && dst.pitch() != src.pitch();
+    // tone mapping needs the statistics of the whole image before the first band
+    if (passes_.size() != 1 || binning_factor_ != 0 || shrinks_in_place || has_raw_stages()
+        || orient_func_ || tone_maps())
+    {
+        if (wait_for_lines(height) < height)
         {
+            return false;
+        }
+        transform(src, dst, params);
+        return true;
+    }
+
+    const auto dst_ = make_dst_desc(dst);
+    const auto fparams = make_filter_params(params, src);
+    auto* statistics = begin_statistics(src.dim);
 
-            assert(transfrom_binary_mono_func_ != nullptr);
+    const auto strip_buffer = img_lib::scratch::acquire(band_buffer_size_);
+    const auto intermediate_buffer = img_lib::scratch::acquire(intermediate_buffer_size_);
 
-            transfrom_binary_mono_func_(dst_, src);
+    for (int y_beg = 0; y_beg < height; y_beg += progressive_band_lines)
+    {
+        const int y_end = std::min(height, y_beg + progressive_band_lines);
+
+        // debayering a band reads up to 2 lines behind it
+        const int lines_needed = std::min(height, y_end + 2);
+        if (wait_for_lines(lines_needed) < lines_needed)
+        {
+            return false;
         }
+
+        img_filter::filter_params tmp = fparams;
+        passes_.front()(
+            dst_,
+            src,
+            tmp,
+            band {
+                y_beg, y_end, 0, strip_buffer.data(), intermediate_buffer.data(), statistics });
     }
+    return true;
 }
 
 void tcamconvert::transform_context::filter(const img::img_descriptor& src,
                                             const img_filter::whitebalance_params& params)
 {
+    if (calib_func_)
+    {
+        calib_func_(src, src, 0, *calib_params_);
+    }
     if (transform_unary_wb_func_ && params.apply)
     {
         transform_unary_wb_func_(src, params);
@@ -1,9 +1,22 @@
 #pragma once
 
+#include "../../../libs/dutils_image/src/dutils_img_filter/by_binned/by_binned.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/by_edge/by_edge.h"
 #include "../../../libs/dutils_image/src/dutils_img_filter/dutils_img_filter_params.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/filter/calib_correct/calib_correct.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/filter/hdr_merge/hdr_merge.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/filter/lut/by8_lut.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/filter/lut/mono_lut.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/filter/tone_map/tone_map.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/bgra_to_yuv/transform_bgra_to_yuv.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/binning/binning.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/orientation/orientation.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/transform_base.h"
 
 #include <dutils_img/dutils_img.h>
+#include <dutils_img_pipe/channel_statistics.h>
 #include <functional>
+#include <memory>
 #include <vector>
 
 namespace tcamconvert
@@ -13,32 +26,418 @@ auto tcamconvert_get_all_output_fccs() -> std::vector<img::fourcc>;
 auto tcamconvert_get_supported_input_fccs(img::fourcc src_fcc) -> std::vector<img::fourcc>;
 auto tcamconvert_get_supported_output_fccs(img::fourcc src_fcc) -> std::vector<img::fourcc>;
 
+// NV12, I420 and YUY2 are written directly from bayer images
+bool tcamconvert_is_yuv_output_fcc(img::fourcc fcc) noexcept;
+
+// Bayer formats to BGRA32, BGRA64, BGRFloat, MONO8 and MONO16 can be downscaled by 2 or 4 while
+// debayering.
+// transform_context::setup selects this when the dimensions of dst are the binned ones of src.
+bool tcamconvert_can_downscale(img::fourcc src_fcc, img::fourcc dst_fcc) noexcept;
+
+// How the downscale property reduces the image.
+// debayer is tcamconvert_can_downscale, the other modes bin or skip the raw image before any other
+// step, see transform_context::set_raw_downscale.
+enum class downscale_mode
+{
+    debayer,
+    average,
+    sum,
+    skip,
+};
+
+// Algorithm of the debayer of 8-bit bayer formats to BGRA32 and the yuv formats, see
+// img_filter::transform::by_demosaic. All other debayer conversions use edge.
+enum class debayer_method
+{
+    nearest,
+    bilinear,
+    edge,
+    hq,
+};
+
+// Format the raw image has while it is binned for the conversion from src_fcc to dst_fcc, packed
+// formats are unpacked to 16-bit. FCC_NULL when src_fcc cannot be binned.
+auto tcamconvert_get_raw_downscale_fcc(img::fourcc src_fcc, img::fourcc dst_fcc) noexcept
+    -> img::fourcc;
+
+// Fastest merge of exposure brackets the cpu supports, nullptr when src cannot be merged into dst
+auto find_hdr_merge_func(img::img_type dst, img::img_type src)
+    -> img_filter::filter::hdr_merge::function_type;
+
+// Fastest calibration correction the cpu supports, nullptr when type cannot be corrected
+auto find_calib_correct_func(img::img_type type)
+    -> img_filter::filter::calib_correct::function_type;
+
+// Fastest binning or skipping the cpu supports, nullptr when src cannot be downscaled into dst
+auto find_binning_func(img::img_type dst,
+                       img::img_type src,
+                       int factor,
+                       img_filter::transform::binning::mode mode)
+    -> img_filter::transform::binning::function_type;
+
 using transform_unary_wb_func = void (*)(const img::img_descriptor& dst,
                                          const img_filter::whitebalance_params& params);
 
 
-using transform_binary_func =
-    std::function<void(const img::img_descriptor& dst, const img::img_descriptor& src)>;
-using transform_binary_wb_func = std::function<void(const img::img_descriptor& dst,
-                                                    const img::img_descriptor& src,
-                                                    img_filter::filter_params& params)>;
+// Selected once in transform_context::setup, so the conversions are called without a type erased
+// wrapper in between.
+using transform_binary_func = img_filter::transform_function_type;
+
+// Either a function that converts and white balances in one step, or a conversion followed by a
+// white balance pass over the dst image.
+// When params.by8_lut is set, lut is used instead, which also applies the gamma of the table.
+struct transform_binary_wb_func
+{
+    img_filter::transform_function_param_type fused = nullptr;
+    img_filter::transform_function_param_type lut = nullptr;
+
+    transform_binary_func transform = nullptr;
+    transform_unary_wb_func whitebalance = nullptr;
+
+    explicit operator bool() const noexcept
+    {
+        return fused != nullptr || (transform != nullptr && whitebalance != nullptr);
+    }
+
+    void operator()(const img::img_descriptor& dst,
+                    const img::img_descriptor& src,
+                    img_filter::filter_params& params) const
+    {
+        if (lut && params.by8_lut)
+        {
+            lut(dst, src, params);
+            return;
+        }
+        if (fused)
+        {
+            fused(dst, src, params);
+            return;
+        }
+        transform(dst, src);
+        whitebalance(dst, params.whitebalance);
+    }
+};
+
+
+// Debayers with the specialized function, or with the generic one when a color matrix is set.
+// opt points to the options of the transform_context, so changes apply to the next image.
+struct debayer_func
+{
+    transform_binary_func specialized = nullptr;
+    img_filter::transform::by_edge::function_type with_options = nullptr;
+    const img_filter::transform::by_edge::options* opt = nullptr;
+
+    explicit operator bool() const noexcept
+    {
+        return specialized != nullptr && with_options != nullptr && opt != nullptr;
+    }
+
+    void operator()(const img::img_descriptor& dst, const img::img_descriptor& src) const
+    {
+        if (opt->use_color_matrix)
+        {
+            with_options(dst, src, *opt);
+            return;
+        }
+        specialized(dst, src);
+    }
+};
+
+// Color correction of the conversions from bayer formats to BGRA32, BGRA64, BGRFloat and yuv,
+// contrast stretching of the mono formats with more than 8 bits and tone mapping of both
+struct color_correction_params
+{
+    // Applied together with the white balance, so only for BGRA32 and yuv.
+    // 1 keeps the linear values.
+    float gamma = 1.f;
+
+    // Applied by the debayer step
+    bool use_color_matrix = false;
+    img::color_matrix_float color_mtx = img::color_matrix_float::get_neutral();
 
+    // The range [contrast_min;contrast_max] of MONO10/12/16 is stretched to the whole output range
+    // by a table, [0;1] keeps the linear conversion.
+    float contrast_min = 0.f;
+    float contrast_max = 1.f;
+
+    // Tone mapping of the sources with more than 8 bits, e.g. merged HDR images, folded into the
+    // tables of the gamma and the contrast stretching. Bayer formats are only tone mapped when
+    // converted to BGRA32 or yuv, mono formats to every output.
+    // The curve and the local gains follow statistics of every source image.
+    img_filter::filter::tone_map::op tone_map = img_filter::filter::tone_map::op::linear;
+    // Strength of the local tone mapping in [0;1], 0 disables it
+    float tone_map_local = 0.f;
+};
+
+class transform_worker_pool;
 
 struct transform_context
 {
-    bool setup(img::img_type src_type, img::img_type dst_type);
+    // yuv_clr is only used for yuv dst types
+    bool setup(img::img_type src_type,
+               img::img_type dst_type,
+               img_filter::transform::yuv_colorimetry yuv_clr =
+                   img_filter::transform::yuv_colorimetry::bt709);
+
+    // When true, transform can be called with dst on the memory of src.
+    // Only the line local conversions from 16-bit formats to 8-bit or 16-bit formats support this.
+    bool can_transform_in_place() const noexcept
+    {
+        return in_place_capable_;
+    }
+
+    // When set, conversions are split into horizontal bands that are run by the pool.
+    // Without a pool everything runs on the calling thread.
+    void set_worker_pool(transform_worker_pool* pool) noexcept
+    {
+        worker_pool_ = pool;
+    }
+
+    // Dark frame, flat-field and defect pixel correction of the raw source, applied before every
+    // other step. Has to be called before setup, params has to stay valid until the next call.
+    // nullptr disables the correction.
+    void set_calibration(const img_filter::filter::calib_correct::params* params) noexcept
+    {
+        calib_params_ = params;
+    }
+
+    // True when setup found a correction for the source type, see set_calibration
+    bool uses_calibration() const noexcept
+    {
+        return calib_func_ != nullptr;
+    }
+
+    // Bins or skips the raw source by factor after the calibration and before every other step,
+    // so the conversion only processes 1/factor^2 of the pixels. dst of setup then has the
+    // dimensions of img_filter::transform::binning::calc_binned_dim.
+    // Has to be called before setup, factor 1 disables it.
+    void set_raw_downscale(img_filter::transform::binning::mode mode, int factor) noexcept
+    {
+        raw_downscale_mode_ = mode;
+        raw_downscale_factor_ = factor;
+    }
+
+    // Has to be called before setup
+    void set_debayer_method(debayer_method method) noexcept
+    {
+        debayer_method_ = method;
+    }
+
+    // True when the conversion set up last debayers with the method of set_debayer_method
+    bool uses_debayer_method() const noexcept
+    {
+        return uses_debayer_method_;
+    }
+
+    // Rotates or flips the result while it is written, dst of setup then has the dimensions of
+    // img_filter::transform::orientation::calc_oriented_dim.
+    // Only dst formats of img_filter::transform::orientation::can_orient are supported.
+    // Has to be called before setup.
+    void set_orientation(img_filter::transform::orientation::mode mode) noexcept
+    {
+        orientation_ = mode;
+    }
+
+    // Has to be called before transform, not concurrently.
+    void set_color_correction(const color_correction_params& params) noexcept;
+
+    // When enabled, the conversions from bayer formats to BGRA32 and from 8-bit bayer formats to
+    // yuv add the BGRA32 lines to auto_alg::channel_statistics while they are written, so the
+    // image is not read again. Conversions that scale the image do not collect statistics.
+    void set_collect_statistics(bool enable) noexcept
+    {
+        collect_statistics_ = enable;
+    }
+
+    // True when the conversion set up last can collect statistics
+    bool can_collect_statistics() const noexcept
+    {
+        return statistics_capable_ && downscale_func_ == nullptr;
+    }
+
+    // Statistics of the last image, empty when none were collected.
+    // The lines are the ones of the source image, independent of the orientation.
+    const auto_alg::channel_statistics& get_statistics() const noexcept
+    {
+        return statistics_;
+    }
 
     void transform(const img::img_descriptor& src,
                    const img::img_descriptor& dst,
                    const img_filter::whitebalance_params& params);
     void filter(const img::img_descriptor& src, const img_filter::whitebalance_params& params);
 
+    // Blocks until at least lines lines of src are complete and returns the number of complete
+    // lines. Returns less when the frame ends early, e.g. tcam::ImageBuffer::wait_for_completed_lines.
+    using wait_for_lines_func = std::function<int(int lines)>;
+
+    // Converts src while it is still being written, see tcam::IImageBufferSink::push_partial_image.
+    // Every band is converted on the calling thread as soon as its src lines are complete.
+    // Conversions with more than one pass, with binning, with a raw stage or with tone mapping
+    // wait for the whole image.
+    // Returns false when src was not completed, dst is then only partially written.
+    bool transform_progressive(const img::img_descriptor& src,
+                               const img::img_descriptor& dst,
+                               const img_filter::whitebalance_params& params,
+                               const wait_for_lines_func& wait_for_lines);
+
+    // Lines [y_beg, y_end) of the image, y_beg is always even
+    struct band
+    {
+        int y_beg = 0;
+        int y_end = 0;
+        int index = 0;
+
+        // scratch memory from img_lib::scratch, only valid during the pass
+        uint8_t* strip_buffer = nullptr;        // band_buffer_size_ bytes, for this band only
+        uint8_t* intermediate_buffer = nullptr; // intermediate_buffer_size_ bytes, shared by all bands and passes
+
+        // set when the statistics are collected, for this band only
+        auto_alg::channel_statistics* statistics = nullptr;
+    };
+
+    // A conversion consists of one or more passes.
+    // All bands of a pass are done before the next pass starts.
+    using band_pass_func = std::function<void(const img::img_descriptor& dst,
+                                              const img::img_descriptor& src,
+                                              img_filter::filter_params& params,
+                                              const band& b)>;
+
 private:
+    bool setup_passes(img::img_type src_type,
+                      img::img_type dst_type,
+                      img_filter::transform::yuv_colorimetry yuv_clr);
+
+    int calc_band_count(int height) const noexcept;
+    // dst_height is the number of lines the passes write, dst may be oriented.
+    // When statistics is set, the bands accumulate into band_statistics_, which are merged into it.
+    void run_bands(const img::img_descriptor& dst,
+                   const img::img_descriptor& src,
+                   const img_filter::filter_params& params,
+                   const std::vector<band_pass_func>& passes,
+                   int dst_height,
+                   auto_alg::channel_statistics* statistics = nullptr);
+
+    // Resets statistics_ for an image converted by passes_, nullptr when none are collected
+    auto begin_statistics(img::dim src_dim) noexcept -> auto_alg::channel_statistics*;
+
+    bool setup_calibration(img::img_type src_type, bool is_unary);
+    bool setup_raw_downscale(img::img_type src_type, img::fourcc dst_fcc, img::dim dst_dim);
+    bool has_raw_stages() const noexcept
+    {
+        return calib_func_ != nullptr || downscale_func_ != nullptr;
+    }
+    void transform_raw_stages(const img::img_descriptor& src,
+                              const img::img_descriptor& dst,
+                              const img_filter::whitebalance_params& params);
+
+    img::img_descriptor make_dst_desc(const img::img_descriptor& dst) const noexcept;
+    // src is the image passes_ convert
+    img_filter::filter_params make_filter_params(const img_filter::whitebalance_params& params,
+                                                 const img::img_descriptor& src);
+
+    // Returns nullptr when no table is needed
+    auto update_by8_lut(const img_filter::whitebalance_params& wb)
+        -> const img_filter::lut::by8_lut_data*;
+    auto update_mono_lut() -> const img_filter::lut::mono_lut_data*;
+
+    bool tone_maps() const noexcept
+    {
+        return tone_stats_func_ != nullptr
+               && (color_correction_.tone_map != img_filter::filter::tone_map::op::linear
+                   || color_correction_.tone_map_local > 0.f);
+    }
+    void update_tone_map(const img::img_descriptor& src);
+
     transform_unary_wb_func transform_unary_wb_func_ = nullptr;
-    transform_binary_func transfrom_binary_mono_func_;
-    transform_binary_wb_func transform_fccXX_to_dst_func_;
+    std::vector<band_pass_func> passes_;
+    bool in_place_capable_ = false;
+
+    // 2 or 4 when debayering downscales, otherwise 0
+    int binning_factor_ = 0;
+
+    transform_worker_pool* worker_pool_ = nullptr;
+
+private: // calibration
+    const img_filter::filter::calib_correct::params* calib_params_ = nullptr;
+    img_filter::filter::calib_correct::function_type calib_func_ = nullptr;
+
+    // Packed sources are unpacked to calib_type_, which the other passes then convert.
+    // Each band is unpacked and corrected in strips, so the unpacked lines are still in the cache
+    // when they are corrected.
+    img_filter::transform_function_type calib_unpack_func_ = nullptr;
+    img::img_type calib_type_;
+    std::vector<band_pass_func> calib_passes_;
+
+private: // raw downscale
+    img_filter::transform::binning::mode raw_downscale_mode_ =
+        img_filter::transform::binning::mode::average;
+    int raw_downscale_factor_ = 1;
+
+    // Runs after the calibration, on its result. Packed sources without calibration are unpacked
+    // in strips by the downscale pass.
+    img_filter::transform::binning::function_type downscale_func_ = nullptr;
+    img::img_type downscale_type_;
+    std::vector<band_pass_func> downscale_passes_;
+
+private: // orientation
+    img_filter::transform::orientation::mode orientation_ =
+        img_filter::transform::orientation::mode::identity;
+
+    // Set for the modes other than identity and flip_vertical, the last pass then writes its
+    // bands in chunks, which this moves into dst. flip_vertical only addresses dst bottom up.
+    img_filter::transform::orientation::function_type orient_func_ = nullptr;
+
+    // dimensions of the result before it is oriented, the bands are in its lines
+    img::dim conv_dim_;
+
+private: // color correction
+    debayer_method debayer_method_ = debayer_method::edge;
+    bool uses_debayer_method_ = false;
+
+    img::fourcc src_fcc_ = img::fourcc::FCC_NULL;
+    bool uses_color_correction_ = false;
+
+    color_correction_params color_correction_;
+    img_filter::transform::by_edge::options debayer_options_ = {
+        img::color_matrix_int::get_neutral(), false, false
+    };
+
+    // only recalculated when the white balance, the gamma or the tone mapping curve changes
+    std::unique_ptr<img_filter::lut::by8_lut_data> by8_lut_;
+    bool by8_lut_valid_ = false;
+    img_filter::whitebalance_params by8_lut_wb_;
+    float by8_lut_gamma_ = 1.f;
+    img_filter::filter::tone_map::curve by8_lut_curve_;
+
+    // set by setup when the conversion has a table variant
+    bool uses_mono_lut_ = false;
+    std::unique_ptr<img_filter::lut::mono_lut_data> mono_lut_;
+    bool mono_lut_valid_ = false;
+    float mono_lut_min_ = 0.f;
+    float mono_lut_max_ = 1.f;
+    img_filter::filter::tone_map::curve mono_lut_curve_;
+
+private: // tone mapping
+    // set by setup when the source has more than 8 bits and the conversion uses one of the tables
+    img_filter::filter::tone_map::statistics_function_type tone_stats_func_ = nullptr;
+    std::unique_ptr<img_filter::filter::tone_map::statistics> tone_stats_;
+    // identity without tone mapping, otherwise follows the images over a few frames
+    img_filter::filter::tone_map::curve tone_curve_;
+    img_filter::filter::tone_map::gain_map tone_gains_;
 
 private: // byXX -> bgra stuff
-    std::vector<uint8_t> transform_intermediate_buffer_;
+    // Sizes of the scratch buffers a conversion needs, set by setup.
+    // The buffers are drawn from img_lib::scratch for each image, so contexts that are not
+    // converting at the same time share the memory.
+    size_t intermediate_buffer_size_ = 0;
+    size_t band_buffer_size_ = 0;
+
+private: // statistics
+    bool collect_statistics_ = false;
+    // set by setup for the conversions that write BGRA32 lines from bayer formats
+    bool statistics_capable_ = false;
+    auto_alg::channel_statistics statistics_;
+    std::vector<auto_alg::channel_statistics> band_statistics_;
 };
 } // namespace tcamconvert
@@ -0,0 +1,539 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "transform_opencl.h"
+
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/bgra_to_yuv/transform_bgra_to_yuv_internal.h"
+#include "../../logging.h"
+
+#define CL_TARGET_OPENCL_VERSION 120
+#include <CL/cl.h>
+#include <array>
+#include <vector>
+
+namespace
+{
+
+// params layout, see opencl_transform::impl::params
+//  0- 3 white balance r, gr, b, gb
+//  4-12 color matrix in row order
+// 13    1 / gamma
+// 14    != 0 when the color matrix is used
+// 16-24 yuv weights of b, g, r for y, u and v, scaled to [0;255] input
+// 25    y offset
+constexpr size_t param_count = 32;
+
+const char* kernel_source = R"CLC(
+// mirrors at the border so that the bayer pattern is kept
+inline float px(__global const uchar* src, int pitch, int w, int h, int x, int y, int bits16)
+{
+    x = x < 0 ? x + 2 : (x >= w ? x - 2 : x);
+    y = y < 0 ? y + 2 : (y >= h ? y - 2 : y);
+    if (bits16)
+    {
+        return *(__global const ushort*)(src + y * pitch + x * 2) * (1.f / 65535.f);
+    }
+    return src[y * pitch + x] * (1.f / 255.f);
+}
+
+inline float3 debayer_rgb(__global const uchar* src, int pitch, int w, int h, int x, int y,
+                          int red_x, int red_y, int bits16, __constant float* p)
+{
+    const float c = px(src, pitch, w, h, x, y, bits16);
+    const float hor = 0.5f * (px(src, pitch, w, h, x - 1, y, bits16) + px(src, pitch, w, h, x + 1, y, bits16));
+    const float ver = 0.5f * (px(src, pitch, w, h, x, y - 1, bits16) + px(src, pitch, w, h, x, y + 1, bits16));
+    const float dia = 0.25f * (px(src, pitch, w, h, x - 1, y - 1, bits16) + px(src, pitch, w, h, x + 1, y - 1, bits16)
+                               + px(src, pitch, w, h, x - 1, y + 1, bits16) + px(src, pitch, w, h, x + 1, y + 1, bits16));
+
+    const int red_row = ((y ^ red_y) & 1) == 0;
+    const int red_col = ((x ^ red_x) & 1) == 0;
+
+    float3 rgb;
+    if (red_row && red_col)
+    {
+        rgb = (float3)(c * p[0], 0.5f * (hor * p[1] + ver * p[3]), dia * p[2]);
+    }
+    else if (!red_row && !red_col)
+    {
+        rgb = (float3)(dia * p[0], 0.5f * (hor * p[3] + ver * p[1]), c * p[2]);
+    }
+    else if (red_row)
+    {
+        rgb = (float3)(hor * p[0], c * p[1], ver * p[2]);
+    }
+    else
+    {
+        rgb = (float3)(ver * p[0], c * p[3], hor * p[2]);
+    }
+
+    if (p[14] != 0.f)
+    {
+        rgb = (float3)(dot(rgb, (float3)(p[4], p[5], p[6])),
+                       dot(rgb, (float3)(p[7], p[8], p[9])),
+                       dot(rgb, (float3)(p[10], p[11], p[12])));
+    }
+    rgb = clamp(rgb, 0.f, 1.f);
+    if (p[13] != 1.f)
+    {
+        rgb = pow(rgb, (float3)(p[13]));
+    }
+    return rgb;
+}
+
+__kernel void bayer_to_bgra32(__global const uchar* src, int src_pitch, int w, int h,
+                              int red_x, int red_y, int bits16, __constant float* p,
+                              __global uchar* dst, int dst_pitch)
+{
+    const int x = get_global_id(0);
+    const int y = get_global_id(1);
+    if (x >= w || y >= h)
+    {
+        return;
+    }
+
+    const float3 rgb = debayer_rgb(src, src_pitch, w, h, x, y, red_x, red_y, bits16, p) * 255.f;
+    const uchar4 bgra = (uchar4)(convert_uchar_sat_rte(rgb.z), convert_uchar_sat_rte(rgb.y),
+                                 convert_uchar_sat_rte(rgb.x), 255);
+    vstore4(bgra, 0, dst + y * dst_pitch + x * 4);
+}
+
+// one work item per 2x2 block, chroma is the average of the block
+__kernel void bayer_to_nv12(__global const uchar* src, int src_pitch, int w, int h,
+                            int red_x, int red_y, int bits16, __constant float* p,
+                            __global uchar* dst, int y_pitch, int uv_offset, int uv_pitch)
+{
+    const int bx = get_global_id(0);
+    const int by = get_global_id(1);
+    if (bx * 2 >= w || by * 2 >= h)
+    {
+        return;
+    }
+
+    float u = 0.f;
+    float v = 0.f;
+    for (int dy = 0; dy < 2; ++dy)
+    {
+        for (int dx = 0; dx < 2; ++dx)
+        {
+            const int x = bx * 2 + dx;
+            const int y = by * 2 + dy;
+            const float3 rgb = debayer_rgb(src, src_pitch, w, h, x, y, red_x, red_y, bits16, p) * 255.f;
+            const float3 bgr = (float3)(rgb.z, rgb.y, rgb.x);
+
+            dst[y * y_pitch + x] =
+                convert_uchar_sat_rte(dot(bgr, (float3)(p[16], p[17], p[18])) + p[25]);
+            u += dot(bgr, (float3)(p[19], p[20], p[21]));
+            v += dot(bgr, (float3)(p[22], p[23], p[24]));
+        }
+    }
+    __global uchar* uv = dst + uv_offset + by * uv_pitch + bx * 2;
+    uv[0] = convert_uchar_sat_rte(u * 0.25f + 128.f);
+    uv[1] = convert_uchar_sat_rte(v * 0.25f + 128.f);
+}
+)CLC";
+
+
+bool check_cl(cl_int err, const char* what)
+{
+    if (err != CL_SUCCESS)
+    {
+        SPDLOG_ERROR("OpenCL error {} in {}", err, what);
+        return false;
+    }
+    return true;
+}
+
+// position of the red pixel in the 2x2 pattern
+void get_red_position(img::fourcc fcc, int& red_x, int& red_y) noexcept
+{
+    using img::by_transform::by_pattern;
+
+    switch (img::by_transform::convert_bayer_fcc_to_pattern(fcc))
+    {
+        case by_pattern::RG:
+            red_x = 0;
+            red_y = 0;
+            break;
+        case by_pattern::GR:
+            red_x = 1;
+            red_y = 0;
+            break;
+        case by_pattern::GB:
+            red_x = 0;
+            red_y = 1;
+            break;
+        case by_pattern::BG:
+            red_x = 1;
+            red_y = 1;
+            break;
+    }
+}
+
+} // namespace
+
+
+struct tcamconvert::opencl_transform::impl
+{
+    cl_device_id device = nullptr;
+    cl_context context = nullptr;
+    cl_command_queue queue = nullptr;
+    cl_program program = nullptr;
+    cl_kernel kernel_bgra32 = nullptr;
+    cl_kernel kernel_nv12 = nullptr;
+
+    cl_mem src_buffer = nullptr;
+    size_t src_buffer_size = 0;
+    cl_mem dst_buffer = nullptr;
+    size_t dst_buffer_size = 0;
+    cl_mem param_buffer = nullptr;
+
+    std::array<float, param_count> params {};
+
+    img::img_type src_type;
+    img::img_type dst_type;
+    int red_x = 0;
+    int red_y = 0;
+
+    std::string device_name;
+
+    ~impl()
+    {
+        release_buffer(src_buffer, src_buffer_size);
+        release_buffer(dst_buffer, dst_buffer_size);
+        if (param_buffer)
+        {
+            clReleaseMemObject(param_buffer);
+        }
+        if (kernel_bgra32)
+        {
+            clReleaseKernel(kernel_bgra32);
+        }
+        if (kernel_nv12)
+        {
+            clReleaseKernel(kernel_nv12);
+        }
+        if (program)
+        {
+            clReleaseProgram(program);
+        }
+        if (queue)
+        {
+            clReleaseCommandQueue(queue);
+        }
+        if (context)
+        {
+            clReleaseContext(context);
+        }
+    }
+
+    static void release_buffer(cl_mem& buffer, size_t& size)
+    {
+        if (buffer)
+        {
+            clReleaseMemObject(buffer);
+        }
+        buffer = nullptr;
+        size = 0;
+    }
+
+    // host accessible memory, so that integrated GPUs do not copy
+    bool ensure_buffer(cl_mem& buffer, size_t& size, size_t required, cl_mem_flags flags)
+    {
+        if (buffer && size >= required)
+        {
+            return true;
+        }
+        release_buffer(buffer, size);
+
+        cl_int err = CL_SUCCESS;
+        buffer = clCreateBuffer(context, flags | CL_MEM_ALLOC_HOST_PTR, required, nullptr, &err);
+        if (!check_cl(err, "clCreateBuffer"))
+        {
+            buffer = nullptr;
+            return false;
+        }
+        size = required;
+        return true;
+    }
+
+    // the first GPU of any platform
+    bool find_device()
+    {
+        cl_uint platform_count = 0;
+        if (clGetPlatformIDs(0, nullptr, &platform_count) != CL_SUCCESS || platform_count == 0)
+        {
+            SPDLOG_WARN("No OpenCL platform found.");
+            return false;
+        }
+        std::vector<cl_platform_id> platforms(platform_count);
+        clGetPlatformIDs(platform_count, platforms.data(), nullptr);
+
+        for (auto platform : platforms)
+        {
+            if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, 1, &device, nullptr) == CL_SUCCESS)
+            {
+                char name[256] = {};
+                clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(name) - 1, name, nullptr);
+                device_name = name;
+                return true;
+            }
+        }
+        SPDLOG_WARN("No OpenCL GPU found.");
+        return false;
+    }
+
+    bool init()
+    {
+        if (program)
+        {
+            return true;
+        }
+        if (!find_device())
+        {
+            return false;
+        }
+
+        cl_int err = CL_SUCCESS;
+        context = clCreateContext(nullptr, 1, &device, nullptr, nullptr, &err);
+        if (!check_cl(err, "clCreateContext"))
+        {
+            context = nullptr;
+            return false;
+        }
+
+        queue = clCreateCommandQueue(context, device, 0, &err);
+        if (!check_cl(err, "clCreateCommandQueue"))
+        {
+            queue = nullptr;
+            return false;
+        }
+
+        param_buffer = clCreateBuffer(
+            context, CL_MEM_READ_ONLY, params.size() * sizeof(float), nullptr, &err);
+        if (!check_cl(err, "clCreateBuffer"))
+        {
+            param_buffer = nullptr;
+            return false;
+        }
+
+        program = clCreateProgramWithSource(context, 1, &kernel_source, nullptr, &err);
+        if (!check_cl(err, "clCreateProgramWithSource"))
+        {
+            program = nullptr;
+            return false;
+        }
+
+        err = clBuildProgram(program, 1, &device, "-cl-fast-relaxed-math", nullptr, nullptr);
+        if (err != CL_SUCCESS)
+        {
+            size_t log_size = 0;
+            clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &log_size);
+            std::string log(log_size, '\0');
+            clGetProgramBuildInfo(
+                program, device, CL_PROGRAM_BUILD_LOG, log_size, log.data(), nullptr);
+            SPDLOG_ERROR("Unable to build the OpenCL kernels: {}", log);
+
+            clReleaseProgram(program);
+            program = nullptr;
+            return false;
+        }
+
+        kernel_bgra32 = clCreateKernel(program, "bayer_to_bgra32", &err);
+        if (!check_cl(err, "clCreateKernel"))
+        {
+            kernel_bgra32 = nullptr;
+            return false;
+        }
+        kernel_nv12 = clCreateKernel(program, "bayer_to_nv12", &err);
+        if (!check_cl(err, "clCreateKernel"))
+        {
+            kernel_nv12 = nullptr;
+            return false;
+        }
+
+        SPDLOG_INFO("tcamconvert uses the OpenCL device '{}'", device_name);
+        return true;
+    }
+};
+
+
+tcamconvert::opencl_transform::opencl_transform() : impl_(std::make_unique<impl>()) {}
+
+tcamconvert::opencl_transform::~opencl_transform() = default;
+
+
+bool tcamconvert::opencl_transform::can_convert(img::fourcc src_fcc, img::fourcc dst_fcc) noexcept
+{
+    if (!img::is_by8_fcc(src_fcc) && !img::is_by16_fcc(src_fcc))
+    {
+        return false;
+    }
+    return dst_fcc == img::fourcc::BGRA32 || dst_fcc == img::fourcc::NV12;
+}
+
+
+bool tcamconvert::opencl_transform::setup(const img::img_type& src_type,
+                                          const img::img_type& dst_type,
+                                          img_filter::transform::yuv_colorimetry yuv_clr)
+{
+    if (!can_convert(src_type.fourcc_type(), dst_type.fourcc_type()) || src_type.dim != dst_type.dim
+        || src_type.dim.cx < 2 || src_type.dim.cy < 2)
+    {
+        return false;
+    }
+    if (dst_type.fourcc_type() == img::fourcc::NV12
+        && (dst_type.dim.cx % 2 != 0 || dst_type.dim.cy % 2 != 0))
+    {
+        return false;
+    }
+
+    if (!impl_->init())
+    {
+        return false;
+    }
+
+    impl_->src_type = src_type;
+    impl_->dst_type = dst_type;
+    get_red_position(src_type.fourcc_type(), impl_->red_x, impl_->red_y);
+
+    const auto coeff = transform_bgra_to_yuv_internal::get_coefficients(yuv_clr);
+    auto& p = impl_->params;
+    for (int i = 0; i < 3; ++i)
+    {
+        p[16 + i] = coeff.y[i] / 128.f;
+        p[19 + i] = coeff.u[i] / 128.f;
+        p[22 + i] = coeff.v[i] / 128.f;
+    }
+    p[25] = coeff.y_offset;
+
+    return true;
+}
+
+
+bool tcamconvert::opencl_transform::transform(const img::img_descriptor& src,
+                                              const img::img_descriptor& dst,
+                                              const img_filter::whitebalance_params& wb,
+                                              const color_correction_params& color_correction)
+{
+    auto& d = *impl_;
+
+    const int w = src.dim.cx;
+    const int h = src.dim.cy;
+    const bool nv12 = dst.fourcc_type() == img::fourcc::NV12;
+
+    auto& p = d.params;
+    p[0] = wb.apply ? wb.wb_rr : 1.f;
+    p[1] = wb.apply ? wb.wb_gr : 1.f;
+    p[2] = wb.apply ? wb.wb_bb : 1.f;
+    p[3] = wb.apply ? wb.wb_gb : 1.f;
+    for (int i = 0; i < 9; ++i) { p[4 + i] = color_correction.color_mtx.fac[i]; }
+    p[13] = color_correction.gamma > 0.f ? 1.f / color_correction.gamma : 1.f;
+    p[14] = color_correction.use_color_matrix ? 1.f : 0.f;
+
+    const size_t src_size = static_cast<size_t>(src.pitch()) * h;
+
+    // NV12 is read back as one range from the start of the y plane to the end of the uv plane
+    auto* dst_ptr = static_cast<uint8_t*>(dst.plane(0).plane_ptr);
+    const int dst_pitch = dst.plane(0).pitch;
+    int uv_offset = 0;
+    int uv_pitch = 0;
+    size_t dst_size = static_cast<size_t>(dst_pitch) * h;
+    if (nv12)
+    {
+        const auto uv = dst.plane(1);
+        uv_offset = static_cast<int>(static_cast<uint8_t*>(uv.plane_ptr) - dst_ptr);
+        uv_pitch = uv.pitch;
+        if (uv_offset < 0)
+        {
+            return false;
+        }
+        dst_size = static_cast<size_t>(uv_offset) + static_cast<size_t>(uv_pitch) * (h / 2);
+    }
+
+    if (!d.ensure_buffer(d.src_buffer, d.src_buffer_size, src_size, CL_MEM_READ_ONLY)
+        || !d.ensure_buffer(d.dst_buffer, d.dst_buffer_size, dst_size, CL_MEM_WRITE_ONLY))
+    {
+        return false;
+    }
+
+    if (!check_cl(clEnqueueWriteBuffer(
+                      d.queue, d.src_buffer, CL_FALSE, 0, src_size, src.data(), 0, nullptr, nullptr),
+                  "clEnqueueWriteBuffer")
+        || !check_cl(clEnqueueWriteBuffer(d.queue,
+                                          d.param_buffer,
+                                          CL_FALSE,
+                                          0,
+                                          p.size() * sizeof(float),
+                                          p.data(),
+                                          0,
+                                          nullptr,
+                                          nullptr),
+                     "clEnqueueWriteBuffer"))
+    {
+        return false;
+    }
+
+    cl_kernel kernel = nv12 ? d.kernel_nv12 : d.kernel_bgra32;
+
+    const cl_int src_pitch = src.pitch();
+    const cl_int bits16 = img::is_by16_fcc(src.fourcc_type()) ? 1 : 0;
+    const cl_int cl_w = w;
+    const cl_int cl_h = h;
+    const cl_int cl_dst_pitch = dst_pitch;
+
+    cl_int err = CL_SUCCESS;
+    err |= clSetKernelArg(kernel, 0, sizeof(cl_mem), &d.src_buffer);
+    err |= clSetKernelArg(kernel, 1, sizeof(cl_int), &src_pitch);
+    err |= clSetKernelArg(kernel, 2, sizeof(cl_int), &cl_w);
+    err |= clSetKernelArg(kernel, 3, sizeof(cl_int), &cl_h);
+    err |= clSetKernelArg(kernel, 4, sizeof(cl_int), &d.red_x);
+    err |= clSetKernelArg(kernel, 5, sizeof(cl_int), &d.red_y);
+    err |= clSetKernelArg(kernel, 6, sizeof(cl_int), &bits16);
+    err |= clSetKernelArg(kernel, 7, sizeof(cl_mem), &d.param_buffer);
+    err |= clSetKernelArg(kernel, 8, sizeof(cl_mem), &d.dst_buffer);
+    err |= clSetKernelArg(kernel, 9, sizeof(cl_int), &cl_dst_pitch);
+    if (nv12)
+    {
+        const cl_int cl_uv_offset = uv_offset;
+        const cl_int cl_uv_pitch = uv_pitch;
+        err |= clSetKernelArg(kernel, 10, sizeof(cl_int), &cl_uv_offset);
+        err |= clSetKernelArg(kernel, 11, sizeof(cl_int), &cl_uv_pitch);
+    }
+    if (!check_cl(err, "clSetKernelArg"))
+    {
+        return false;
+    }
+
+    const size_t global[2] = { static_cast<size_t>(nv12 ? w / 2 : w),
+                               static_cast<size_t>(nv12 ? h / 2 : h) };
+    if (!check_cl(
+            clEnqueueNDRangeKernel(d.queue, kernel, 2, nullptr, global, nullptr, 0, nullptr, nullptr),
+            "clEnqueueNDRangeKernel"))
+    {
+        return false;
+    }
+
+    return check_cl(clEnqueueReadBuffer(
+                        d.queue, d.dst_buffer, CL_TRUE, 0, dst_size, dst_ptr, 0, nullptr, nullptr),
+                    "clEnqueueReadBuffer");
+}
+
+
+std::string tcamconvert::opencl_transform::get_device_name() const
+{
+    return impl_->device_name;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "transform_impl.h"
+
+#include <dutils_img/dutils_img.h>
+#include <memory>
+#include <string>
+
+namespace tcamconvert
+{
+
+// Converts 8 and 16-bit bayer images on an OpenCL device, e.g. an integrated GPU, to BGRA32 or
+// NV12. White balance, bilinear debayering, the color matrix and gamma run in one kernel.
+//
+// Images are copied into buffers that are allocated once per setup in host accessible memory,
+// on integrated GPUs these copies do not leave system memory.
+class opencl_transform
+{
+public:
+    opencl_transform();
+    ~opencl_transform();
+
+    opencl_transform(const opencl_transform&) = delete;
+    opencl_transform& operator=(const opencl_transform&) = delete;
+
+    static bool can_convert(img::fourcc src_fcc, img::fourcc dst_fcc) noexcept;
+
+    // Returns false when no OpenCL device is found or the conversion is not supported
+    bool setup(const img::img_type& src_type,
+               const img::img_type& dst_type,
+               img_filter::transform::yuv_colorimetry yuv_clr);
+
+    // Returns false when the OpenCL runtime reports an error, dst is undefined then
+    bool transform(const img::img_descriptor& src,
+                   const img::img_descriptor& dst,
+                   const img_filter::whitebalance_params& wb,
+                   const color_correction_params& color_correction);
+
+    // empty before the first successful setup
+    std::string get_device_name() const;
+
+private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+};
+
+} // namespace tcamconvert
@@ -0,0 +1,461 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "transform_worker_pool.h"
+
+#include "../../logging.h"
+#include "../../ThreadPolicy.h"
+#include "../../utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+
+namespace
+{
+
+// One run() of a transform_worker_pool that uses the shared pool
+struct shared_job
+{
+    tcamconvert::transform_worker_pool::task_func func = nullptr;
+    void* ctx = nullptr;
+    int task_count = 0;
+    std::atomic<int> next_task = 0;
+
+    tcamconvert::worker_priority priority = tcamconvert::worker_priority::normal;
+    int numa_node = -1;
+    int max_helpers = 0;
+
+    // pool threads working on the job, guarded by shared_pool::mtx_
+    int helpers = 0;
+
+    bool has_tasks() const noexcept
+    {
+        return next_task.load(std::memory_order_relaxed) < task_count;
+    }
+
+    void work()
+    {
+        for (int task = next_task.fetch_add(1); task < task_count; task = next_task.fetch_add(1))
+        {
+            func(ctx, task);
+        }
+    }
+};
+
+// NUMA node of every cpu, empty on machines with a single node
+std::vector<int> read_cpu_nodes()
+{
+    constexpr int max_nodes = 64;
+
+    std::vector<int> rval;
+    int node_count = 0;
+    for (int node = 0; node < max_nodes; ++node)
+    {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string line;
+        if (!std::getline(file, line))
+        {
+            continue;
+        }
+        auto cpus = tcam::parse_cpu_list(line);
+        if (!cpus)
+        {
+            continue;
+        }
+        ++node_count;
+        for (int cpu : cpus.value())
+        {
+            if (cpu >= static_cast<int>(rval.size()))
+            {
+                rval.resize(cpu + 1, -1);
+            }
+            rval[cpu] = node;
+        }
+    }
+    if (node_count < 2)
+    {
+        return {};
+    }
+    return rval;
+}
+
+// cpus of the thread-policy rule of tcamconvert, or all cpus the process may use
+std::vector<int> get_pool_cpus()
+{
+    if (auto rule = tcam::thread_policy::find_rule("tcamconvert"); rule && !rule->cpus.empty())
+    {
+        if (auto cpus = tcam::parse_cpu_list(rule->cpus); cpus && !cpus->empty())
+        {
+            return cpus.value();
+        }
+    }
+
+    std::vector<int> rval;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &set))
+            {
+                rval.push_back(cpu);
+            }
+        }
+    }
+    if (rval.empty())
+    {
+        const int count = std::max(1u, std::thread::hardware_concurrency());
+        for (int cpu = 0; cpu < count; ++cpu) { rval.push_back(cpu); }
+    }
+    return rval;
+}
+
+// Worker threads shared by all transform_worker_pool instances that have no cpu list.
+// The threads are started for the first instance and stopped after the last one.
+class shared_pool
+{
+public:
+    static shared_pool& get()
+    {
+        static shared_pool pool;
+        return pool;
+    }
+
+    ~shared_pool()
+    {
+        stop();
+    }
+
+    // Returns the number of threads that can work on one job, including the caller
+    int acquire()
+    {
+        std::scoped_lock lifecycle_lck { lifecycle_mtx_ };
+        if (clients_++ == 0)
+        {
+            start();
+        }
+        return static_cast<int>(workers_.size()) + 1;
+    }
+
+    void release()
+    {
+        std::scoped_lock lifecycle_lck { lifecycle_mtx_ };
+        if (--clients_ == 0)
+        {
+            stop();
+        }
+    }
+
+    void run(shared_job& job)
+    {
+        job.numa_node = get_node(sched_getcpu());
+        {
+            std::scoped_lock lck { mtx_ };
+            jobs_.push_back(&job);
+        }
+        for (int i = 0; i < job.max_helpers; ++i) { wake_cv_.notify_one(); }
+
+        job.work();
+
+        std::unique_lock lck { mtx_ };
+        jobs_.erase(std::find(jobs_.begin(), jobs_.end(), &job));
+        done_cv_.wait(lck, [&job] { return job.helpers == 0; });
+    }
+
+private:
+    void start()
+    {
+        if (cpu_nodes_.empty())
+        {
+            cpu_nodes_ = read_cpu_nodes();
+        }
+        const auto cpus = get_pool_cpus();
+
+        SPDLOG_DEBUG("Starting {} shared tcamconvert workers", cpus.size() - 1);
+
+        std::scoped_lock lck { mtx_ };
+        stop_ = false;
+        // the threads calling run() work on their jobs as well
+        for (size_t i = 1; i < cpus.size(); ++i)
+        {
+            const int node = get_node(cpus[i]);
+            std::vector<int> node_cpus;
+            if (node >= 0)
+            {
+                std::copy_if(cpus.begin(),
+                             cpus.end(),
+                             std::back_inserter(node_cpus),
+                             [this, node](int cpu) { return get_node(cpu) == node; });
+            }
+            workers_.emplace_back(&shared_pool::worker_main, this, node, std::move(node_cpus));
+        }
+    }
+
+    void stop()
+    {
+        {
+            std::scoped_lock lck { mtx_ };
+            stop_ = true;
+        }
+        wake_cv_.notify_all();
+
+        for (auto& thrd : workers_) { thrd.join(); }
+        workers_.clear();
+    }
+
+    int get_node(int cpu) const noexcept
+    {
+        if (cpu < 0 || cpu >= static_cast<int>(cpu_nodes_.size()))
+        {
+            return -1;
+        }
+        return cpu_nodes_[cpu];
+    }
+
+    // The job an idle thread of node helps next, mtx_ must be held
+    shared_job* find_job(int node) const
+    {
+        shared_job* best = nullptr;
+        for (auto* job : jobs_)
+        {
+            if (job->helpers >= job->max_helpers || !job->has_tasks())
+            {
+                continue;
+            }
+            if (!best || job->priority > best->priority)
+            {
+                best = job;
+                continue;
+            }
+            if (job->priority < best->priority)
+            {
+                continue;
+            }
+            const bool local = node >= 0 && job->numa_node == node;
+            const bool best_local = node >= 0 && best->numa_node == node;
+            if (local != best_local)
+            {
+                best = local ? job : best;
+                continue;
+            }
+            // jobs_ is in submission order, so equal jobs keep the older one
+            if (job->helpers < best->helpers)
+            {
+                best = job;
+            }
+        }
+        return best;
+    }
+
+    void worker_main(int node, std::vector<int> node_cpus)
+    {
+        tcam::thread_policy::setup_thread("tcamconvert");
+
+        // keeps the worker next to the memory of the cameras on its node
+        if (!node_cpus.empty())
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int cpu : node_cpus) { CPU_SET(cpu, &set); }
+            if (int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set); err != 0)
+            {
+                SPDLOG_WARN(
+                    "Unable to pin tcamconvert worker to numa node {}: {}", node, strerror(err));
+            }
+        }
+
+        std::unique_lock lck { mtx_ };
+        while (true)
+        {
+            shared_job* job = nullptr;
+            wake_cv_.wait(lck,
+                          [this, node, &job]
+                          { return stop_ || (job = find_job(node)) != nullptr; });
+            if (stop_)
+            {
+                return;
+            }
+            ++job->helpers;
+            lck.unlock();
+
+            job->work();
+
+            lck.lock();
+            if (--job->helpers == 0)
+            {
+                done_cv_.notify_all();
+            }
+        }
+    }
+
+    std::mutex lifecycle_mtx_;
+    int clients_ = 0;
+    std::vector<int> cpu_nodes_;
+
+    std::vector<std::thread> workers_;
+
+    std::mutex mtx_;
+    std::condition_variable wake_cv_;
+    std::condition_variable done_cv_;
+    std::vector<shared_job*> jobs_;
+    bool stop_ = false;
+};
+
+} // namespace
+
+
+tcamconvert::transform_worker_pool::~transform_worker_pool()
+{
+    stop();
+}
+
+
+void tcamconvert::transform_worker_pool::start(int thread_count, const std::vector<int>& cpu_list)
+{
+    stop();
+
+    if (cpu_list.empty())
+    {
+        if (thread_count > 1)
+        {
+            shared_thread_count_ = std::min(thread_count, shared_pool::get().acquire());
+        }
+        return;
+    }
+
+    stop_ = false;
+    for (int i = 1; i < thread_count; ++i)
+    {
+        int cpu = -1;
+        if (!cpu_list.empty())
+        {
+            cpu = cpu_list[(i - 1) % cpu_list.size()];
+        }
+        workers_.emplace_back(&transform_worker_pool::worker_main, this, cpu, generation_);
+    }
+}
+
+
+void tcamconvert::transform_worker_pool::stop()
+{
+    if (shared_thread_count_ > 0)
+    {
+        shared_pool::get().release();
+        shared_thread_count_ = 0;
+    }
+
+    {
+        std::scoped_lock lck { mtx_ };
+        stop_ = true;
+    }
+    wake_cv_.notify_all();
+
+    for (auto& thrd : workers_) { thrd.join(); }
+    workers_.clear();
+}
+
+
+void tcamconvert::transform_worker_pool::run_tasks(int task_count, task_func func, void* ctx)
+{
+    if (shared_thread_count_ > 1 && task_count > 1)
+    {
+        shared_job job;
+        job.func = func;
+        job.ctx = ctx;
+        job.task_count = task_count;
+        job.priority = priority_;
+        job.max_helpers = std::min(shared_thread_count_, task_count) - 1;
+        shared_pool::get().run(job);
+        return;
+    }
+
+    if (workers_.empty() || task_count <= 1)
+    {
+        for (int i = 0; i < task_count; ++i) { func(ctx, i); }
+        return;
+    }
+
+    {
+        std::scoped_lock lck { mtx_ };
+        func_ = func;
+        func_ctx_ = ctx;
+        task_count_ = task_count;
+        next_task_.store(0);
+        busy_workers_ = static_cast<int>(workers_.size());
+        ++generation_;
+    }
+    wake_cv_.notify_all();
+
+    work_on_tasks();
+
+    std::unique_lock lck { mtx_ };
+    done_cv_.wait(lck, [this] { return busy_workers_ == 0; });
+    func_ = nullptr;
+    func_ctx_ = nullptr;
+}
+
+
+void tcamconvert::transform_worker_pool::work_on_tasks()
+{
+    for (int task = next_task_.fetch_add(1); task < task_count_; task = next_task_.fetch_add(1))
+    {
+        func_(func_ctx_, task);
+    }
+}
+
+
+void tcamconvert::transform_worker_pool::worker_main(int cpu, uint64_t seen_generation)
+{
+    tcam::thread_policy::setup_thread("tcamconvert");
+
+    if (cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set); err != 0)
+        {
+            SPDLOG_WARN("Unable to pin tcamconvert worker to cpu {}: {}", cpu, strerror(err));
+        }
+    }
+
+    while (true)
+    {
+        {
+            std::unique_lock lck { mtx_ };
+            wake_cv_.wait(lck,
+                          [this, seen_generation] { return stop_ || generation_ != seen_generation; });
+            if (stop_)
+            {
+                return;
+            }
+            seen_generation = generation_;
+        }
+
+        work_on_tasks();
+
+        {
+            std::scoped_lock lck { mtx_ };
+            --busy_workers_;
+        }
+        done_cv_.notify_one();
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tcamconvert
+{
+
+// Order in which the idle threads of the shared pool help the conversions that are running
+enum class worker_priority
+{
+    low,    // e.g. a live view that may drop images
+    normal,
+    high,   // e.g. a recording
+};
+
+// Runs the bands of the conversions of one tcamconvert instance.
+//
+// Without a cpu list the bands are run by the process wide pool that all instances share. It has
+// one thread per cpu the process may use, or per cpu of the thread-policy rule of the role
+// tcamconvert. Idle threads take bands of any running conversion: first those with the highest
+// priority, then those submitted from their own NUMA node, then those with the fewest helpers, so
+// that every camera gets its share.
+//
+// With a cpu list the instance keeps its own threads pinned to these cpus, like before.
+//
+// The thread calling run() works on bands too, so a thread count of 1 does not use any other
+// thread.
+class transform_worker_pool
+{
+public:
+    transform_worker_pool() = default;
+    ~transform_worker_pool();
+
+    transform_worker_pool(const transform_worker_pool&) = delete;
+    transform_worker_pool& operator=(const transform_worker_pool&) = delete;
+
+    // Stops all running workers. Then either starts thread_count - 1 own workers, pinning worker n
+    // to cpu_list[n % cpu_list.size()], or, when cpu_list is empty, uses up to thread_count
+    // threads of the shared pool.
+    void start(int thread_count, const std::vector<int>& cpu_list);
+    void stop();
+
+    void set_priority(worker_priority priority) noexcept
+    {
+        priority_ = priority;
+    }
+    worker_priority get_priority() const noexcept
+    {
+        return priority_;
+    }
+
+    // Number of threads working in run(), including the caller
+    int thread_count() const noexcept
+    {
+        return shared_thread_count_ > 0 ? shared_thread_count_
+                                        : static_cast<int>(workers_.size()) + 1;
+    }
+
+    // Calls func(index) for every index in [0, task_count) and returns once all calls are done.
+    // func is only referenced, unlike a std::function this does not allocate for large captures.
+    template<class TFunc> void run(int task_count, TFunc& func)
+    {
+        run_tasks(
+            task_count, [](void* ctx, int index) { (*static_cast<TFunc*>(ctx))(index); }, &func);
+    }
+
+    using task_func = void (*)(void* ctx, int index);
+
+private:
+    void run_tasks(int task_count, task_func func, void* ctx);
+    void worker_main(int cpu, uint64_t seen_generation);
+    void work_on_tasks();
+
+    std::atomic<worker_priority> priority_ = worker_priority::normal;
+
+    // > 0 while the shared pool is used
+    int shared_thread_count_ = 0;
+
+    std::vector<std::thread> workers_;
+
+    std::mutex mtx_;
+    std::condition_variable wake_cv_;
+    std::condition_variable done_cv_;
+
+    task_func func_ = nullptr;
+    void* func_ctx_ = nullptr;
+    int task_count_ = 0;
+    std::atomic<int> next_task_ = 0;
+
+    uint64_t generation_ = 0;
+    int busy_workers_ = 0;
+    bool stop_ = false;
+};
+
+} // namespace tcamconvert
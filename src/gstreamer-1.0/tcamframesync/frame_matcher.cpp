@@ -0,0 +1,96 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "frame_matcher.h"
+
+#include <algorithm>
+
+using namespace tcamframesync;
+
+
+frame_matcher::decision frame_matcher::decide(
+    const std::vector<std::optional<uint64_t>>& heads) const
+{
+    decision ret;
+
+    if (heads.empty())
+    {
+        return ret;
+    }
+
+    uint64_t newest = 0;
+    bool all_present = true;
+    for (const auto& h : heads)
+    {
+        if (h)
+        {
+            newest = std::max(newest, *h);
+        }
+        else
+        {
+            all_present = false;
+        }
+    }
+
+    for (size_t i = 0; i < heads.size(); ++i)
+    {
+        // the other inputs already moved past this frame
+        if (heads[i] && *heads[i] + tolerance_ < newest)
+        {
+            ret.drop.push_back(i);
+        }
+    }
+
+    ret.complete = all_present && ret.drop.empty();
+
+    return ret;
+}
+
+
+frame_matcher::decision frame_matcher::decide_timeout(
+    const std::vector<std::optional<uint64_t>>& heads) const
+{
+    decision ret = decide(heads);
+
+    if (ret.complete || !ret.drop.empty())
+    {
+        return ret;
+    }
+
+    std::optional<uint64_t> oldest;
+    for (const auto& h : heads)
+    {
+        if (h && (!oldest || *h < *oldest))
+        {
+            oldest = h;
+        }
+    }
+
+    if (!oldest)
+    {
+        return ret;
+    }
+
+    for (size_t i = 0; i < heads.size(); ++i)
+    {
+        if (heads[i] && *heads[i] <= *oldest + tolerance_)
+        {
+            ret.drop.push_back(i);
+        }
+    }
+
+    return ret;
+}
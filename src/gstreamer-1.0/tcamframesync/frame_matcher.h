@@ -0,0 +1,67 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace tcamframesync
+{
+
+//
+// Decides which of the oldest queued frames of all inputs belong to the same trigger.
+//
+// Every frame is described by a key, e.g. the trigger count or the camera timestamp.
+// Keys of one input are expected to grow. Frames whose keys are within tolerance of each
+// other form a set. A frame whose key is older than the newest head by more than the
+// tolerance can not find partners anymore and is dropped.
+//
+class frame_matcher
+{
+public:
+    struct decision
+    {
+        // all inputs have a matching frame, take one from every input
+        bool complete = false;
+        // indices of the inputs whose oldest frame has to be dropped
+        std::vector<size_t> drop;
+    };
+
+    void set_tolerance(uint64_t tolerance) noexcept
+    {
+        tolerance_ = tolerance;
+    }
+
+    uint64_t get_tolerance() const noexcept
+    {
+        return tolerance_;
+    }
+
+    // heads[i] is the key of the oldest frame of input i, nullopt when nothing is queued
+    decision decide(const std::vector<std::optional<uint64_t>>& heads) const;
+
+    // Used when waiting for the missing frames took too long.
+    // Drops the oldest group of frames, i.e. the incomplete set.
+    decision decide_timeout(const std::vector<std::optional<uint64_t>>& heads) const;
+
+private:
+    uint64_t tolerance_ = 0;
+};
+
+} // namespace tcamframesync
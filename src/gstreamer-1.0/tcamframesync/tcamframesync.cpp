@@ -0,0 +1,821 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tcamframesync.h"
+
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamframe.h"
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
+#include "../../version.h"
+#include "frame_matcher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <gst/video/video.h>
+#include <optional>
+#include <vector>
+
+GST_DEBUG_CATEGORY_STATIC(gst_tcamframesync_debug_category);
+#define GST_CAT_DEFAULT gst_tcamframesync_debug_category
+
+#define gst_tcamframesync_parent_class parent_class
+G_DEFINE_TYPE(GstTcamFrameSync, gst_tcamframesync, GST_TYPE_AGGREGATOR)
+
+enum
+{
+    PROP_0,
+    PROP_MATCH,
+    PROP_TOLERANCE,
+    PROP_OUTPUT,
+    PROP_SETS,
+    PROP_DROPPED,
+};
+
+#define TCAMFRAMESYNC_DEFAULT_TOLERANCE (1 * GST_MSECOND)
+
+
+namespace tcamframesync
+{
+
+struct frame_sync_state
+{
+    GstTcamFrameSyncMatch match = GST_TCAM_FRAME_SYNC_MATCH_TRIGGER_COUNT;
+    GstTcamFrameSyncOutput output = GST_TCAM_FRAME_SYNC_OUTPUT_TILED;
+    guint64 tolerance = TCAMFRAMESYNC_DEFAULT_TOLERANCE;
+
+    frame_matcher matcher;
+
+    // negotiated in update_src_caps, in order of the sink pad list
+    std::vector<GstVideoInfo> input_info;
+    // false for caps GstVideoInfo does not know, e.g. bayer
+    bool input_is_video = false;
+    GstVideoInfo output_info;
+
+    std::atomic<guint64> sets = 0;
+    std::atomic<guint64> dropped = 0;
+};
+
+// the sink pads of the element, referenced for the lifetime of this object
+struct sink_pad_list
+{
+    std::vector<GstAggregatorPad*> pads;
+
+    explicit sink_pad_list(GstAggregator* agg)
+    {
+        GST_OBJECT_LOCK(agg);
+        for (GList* l = GST_ELEMENT(agg)->sinkpads; l != nullptr; l = l->next)
+        {
+            pads.push_back(GST_AGGREGATOR_PAD(gst_object_ref(l->data)));
+        }
+        GST_OBJECT_UNLOCK(agg);
+    }
+
+    ~sink_pad_list()
+    {
+        for (auto p : pads) { gst_object_unref(p); }
+    }
+
+    sink_pad_list(const sink_pad_list&) = delete;
+    sink_pad_list& operator=(const sink_pad_list&) = delete;
+};
+
+} // namespace tcamframesync
+
+
+static tcamframesync::frame_sync_state& get_state(GstTcamFrameSync* self)
+{
+    return *self->state_;
+}
+
+
+GType gst_tcam_frame_sync_match_get_type(void)
+{
+    static GType tcam_frame_sync_match = 0;
+
+    if (!tcam_frame_sync_match)
+    {
+        static const GEnumValue match_modes[] = {
+            { GST_TCAM_FRAME_SYNC_MATCH_TRIGGER_COUNT,
+              "GST_TCAM_FRAME_SYNC_MATCH_TRIGGER_COUNT",
+              "trigger-count" },
+            { GST_TCAM_FRAME_SYNC_MATCH_CAMERA_TIME,
+              "GST_TCAM_FRAME_SYNC_MATCH_CAMERA_TIME",
+              "camera-time" },
+
+            { 0, NULL, NULL }
+        };
+        tcam_frame_sync_match = g_enum_register_static("GstTcamFrameSyncMatch", match_modes);
+    }
+    return tcam_frame_sync_match;
+}
+
+
+GType gst_tcam_frame_sync_output_get_type(void)
+{
+    static GType tcam_frame_sync_output = 0;
+
+    if (!tcam_frame_sync_output)
+    {
+        static const GEnumValue output_modes[] = {
+            { GST_TCAM_FRAME_SYNC_OUTPUT_TILED, "GST_TCAM_FRAME_SYNC_OUTPUT_TILED", "tiled" },
+            { GST_TCAM_FRAME_SYNC_OUTPUT_BUFFER_LIST,
+              "GST_TCAM_FRAME_SYNC_OUTPUT_BUFFER_LIST",
+              "buffer-list" },
+
+            { 0, NULL, NULL }
+        };
+        tcam_frame_sync_output = g_enum_register_static("GstTcamFrameSyncOutput", output_modes);
+    }
+    return tcam_frame_sync_output;
+}
+
+
+// The key frames of one trigger share.
+// With trigger-count this is the number of frames the device produced, delivered or not.
+// With camera-time this is the device timestamp, cameras without timestamp use the PTS.
+static std::optional<uint64_t> get_frame_key(GstBuffer* buffer, GstTcamFrameSyncMatch match)
+{
+    if (auto frame_meta = gst_buffer_get_tcam_frame_meta(buffer))
+    {
+        const auto& data = frame_meta->data;
+        if (match == GST_TCAM_FRAME_SYNC_MATCH_TRIGGER_COUNT)
+        {
+            return data.frame_count + data.frames_dropped;
+        }
+        if (data.camera_time_ns != 0)
+        {
+            return data.camera_time_ns;
+        }
+    }
+    else if (auto meta = gst_buffer_get_tcam_statistics_meta(buffer); meta && meta->structure)
+    {
+        if (match == GST_TCAM_FRAME_SYNC_MATCH_TRIGGER_COUNT)
+        {
+            guint64 frame_count = 0;
+            guint64 frames_dropped = 0;
+            if (gst_structure_get_uint64(meta->structure, "frame_count", &frame_count))
+            {
+                gst_structure_get_uint64(meta->structure, "frames_dropped", &frames_dropped);
+                return frame_count + frames_dropped;
+            }
+        }
+        else
+        {
+            guint64 camera_time = 0;
+            if (gst_structure_get_uint64(meta->structure, "camera_time_ns", &camera_time)
+                && camera_time != 0)
+            {
+                return camera_time;
+            }
+        }
+    }
+
+    if (match == GST_TCAM_FRAME_SYNC_MATCH_CAMERA_TIME && GST_BUFFER_PTS_IS_VALID(buffer))
+    {
+        return GST_BUFFER_PTS(buffer);
+    }
+    return std::nullopt;
+}
+
+
+static bool tile_video_frames(const tcamframesync::frame_sync_state& state,
+                              const std::vector<GstBuffer*>& set,
+                              GstBuffer* out)
+{
+    // older GStreamer versions take a non-const info
+    GstVideoInfo out_info = state.output_info;
+
+    GstVideoFrame out_frame;
+    if (!gst_video_frame_map(&out_frame, &out_info, out, GST_MAP_WRITE))
+    {
+        return false;
+    }
+
+    std::vector<guint> next_row(GST_VIDEO_FRAME_N_PLANES(&out_frame), 0);
+
+    bool ret = true;
+    for (size_t i = 0; i < set.size() && ret; ++i)
+    {
+        GstVideoFrame in_frame;
+        GstVideoInfo in_info = state.input_info.at(i);
+        if (!gst_video_frame_map(&in_frame, &in_info, set.at(i), GST_MAP_READ))
+        {
+            ret = false;
+            break;
+        }
+
+        for (guint plane = 0; plane < GST_VIDEO_FRAME_N_PLANES(&in_frame); ++plane)
+        {
+            // like gst_video_frame_copy_plane, the plane index is used as component index
+            const guint rows = GST_VIDEO_FRAME_COMP_HEIGHT(&in_frame, plane);
+            const size_t in_stride = GST_VIDEO_FRAME_PLANE_STRIDE(&in_frame, plane);
+            const size_t out_stride = GST_VIDEO_FRAME_PLANE_STRIDE(&out_frame, plane);
+            const size_t line_size = std::min(in_stride, out_stride);
+
+            auto src = static_cast<const guint8*>(GST_VIDEO_FRAME_PLANE_DATA(&in_frame, plane));
+            auto dst = static_cast<guint8*>(GST_VIDEO_FRAME_PLANE_DATA(&out_frame, plane))
+                       + static_cast<size_t>(next_row.at(plane)) * out_stride;
+
+            for (guint row = 0; row < rows; ++row)
+            {
+                memcpy(dst + static_cast<size_t>(row) * out_stride,
+                       src + static_cast<size_t>(row) * in_stride,
+                       line_size);
+            }
+            next_row.at(plane) += rows;
+        }
+        gst_video_frame_unmap(&in_frame);
+    }
+
+    gst_video_frame_unmap(&out_frame);
+    return ret;
+}
+
+
+// formats GstVideoInfo does not know are single planes without padding
+static bool tile_raw_frames(const std::vector<GstBuffer*>& set, GstBuffer* out)
+{
+    GstMapInfo out_map;
+    if (!gst_buffer_map(out, &out_map, GST_MAP_WRITE))
+    {
+        return false;
+    }
+
+    gsize offset = 0;
+    for (auto buf : set)
+    {
+        const gsize size = gst_buffer_get_size(buf);
+        if (offset + size > out_map.size)
+        {
+            gst_buffer_unmap(out, &out_map);
+            return false;
+        }
+        gst_buffer_extract(buf, 0, out_map.data + offset, size);
+        offset += size;
+    }
+
+    gst_buffer_unmap(out, &out_map);
+    return true;
+}
+
+
+static GstFlowReturn finish_set(GstTcamFrameSync* self, std::vector<GstBuffer*>& set)
+{
+    auto& state = get_state(self);
+    GstAggregator* agg = GST_AGGREGATOR(self);
+
+#if GST_CHECK_VERSION(1, 18, 0)
+    if (state.output == GST_TCAM_FRAME_SYNC_OUTPUT_BUFFER_LIST)
+    {
+        GstBufferList* list = gst_buffer_list_new_sized(set.size());
+        for (auto buf : set) { gst_buffer_list_add(list, buf); }
+        set.clear();
+
+        return gst_aggregator_finish_buffer_list(agg, list);
+    }
+#endif
+
+    gsize size = 0;
+    if (state.input_is_video)
+    {
+        size = GST_VIDEO_INFO_SIZE(&state.output_info);
+    }
+    else
+    {
+        for (auto buf : set) { size += gst_buffer_get_size(buf); }
+    }
+
+    GstBuffer* out = gst_buffer_new_allocate(nullptr, size, nullptr);
+
+    bool copied = false;
+    if (out)
+    {
+        copied = state.input_is_video ? tile_video_frames(state, set, out)
+                                      : tile_raw_frames(set, out);
+    }
+
+    if (copied)
+    {
+        // the first input is the reference for the timing of the whole set
+        gst_buffer_copy_into(out, set.front(), GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+    }
+
+    for (auto buf : set) { gst_buffer_unref(buf); }
+    set.clear();
+
+    if (!copied)
+    {
+        if (out)
+        {
+            gst_buffer_unref(out);
+        }
+        GST_ELEMENT_ERROR(self, STREAM, FAILED, ("Unable to tile the frames of a set."), (NULL));
+        return GST_FLOW_ERROR;
+    }
+
+    return gst_aggregator_finish_buffer(agg, out);
+}
+
+
+static GstFlowReturn gst_tcamframesync_aggregate(GstAggregator* agg, gboolean timeout)
+{
+    GstTcamFrameSync* self = GST_TCAMFRAMESYNC(agg);
+    auto& state = get_state(self);
+
+    tcamframesync::sink_pad_list pads(agg);
+
+    if (pads.pads.empty())
+    {
+        return GST_FLOW_OK;
+    }
+
+    if (pads.pads.size() != state.input_info.size())
+    {
+        // inputs were added or removed, update_src_caps has to run again
+        gst_pad_mark_reconfigure(GST_AGGREGATOR_SRC_PAD(agg));
+        return GST_FLOW_OK;
+    }
+
+    std::vector<std::optional<uint64_t>> heads;
+    heads.reserve(pads.pads.size());
+
+    bool input_ended = false;
+    for (auto pad : pads.pads)
+    {
+        GstBuffer* buf = gst_aggregator_pad_peek_buffer(pad);
+        if (!buf)
+        {
+            if (gst_aggregator_pad_is_eos(pad))
+            {
+                input_ended = true;
+            }
+            heads.push_back(std::nullopt);
+            continue;
+        }
+
+        auto key = get_frame_key(buf, state.match);
+        gst_buffer_unref(buf);
+
+        if (!key)
+        {
+            GST_WARNING_OBJECT(pad, "Dropping buffer without tcam statistics meta.");
+            gst_aggregator_pad_drop_buffer(pad);
+            state.dropped++;
+            return GST_FLOW_OK;
+        }
+        heads.push_back(key);
+    }
+
+    auto decision = timeout ? state.matcher.decide_timeout(heads) : state.matcher.decide(heads);
+
+    for (auto index : decision.drop)
+    {
+        GST_DEBUG_OBJECT(pads.pads.at(index),
+                         "Dropping frame %" G_GUINT64_FORMAT " without partners",
+                         *heads.at(index));
+        gst_aggregator_pad_drop_buffer(pads.pads.at(index));
+        state.dropped++;
+    }
+
+    if (!decision.complete)
+    {
+        if (input_ended && decision.drop.empty())
+        {
+            // the missing frames will never arrive
+            return GST_FLOW_EOS;
+        }
+        return GST_FLOW_OK;
+    }
+
+    std::vector<GstBuffer*> set;
+    set.reserve(pads.pads.size());
+    for (auto pad : pads.pads) { set.push_back(gst_aggregator_pad_pop_buffer(pad)); }
+
+    state.sets++;
+
+    return finish_set(self, set);
+}
+
+
+// Running time of the oldest queued frame.
+// In live pipelines aggregate is called with timeout once this plus the latency passed.
+static GstClockTime gst_tcamframesync_get_next_time(GstAggregator* agg)
+{
+    tcamframesync::sink_pad_list pads(agg);
+
+    GstClockTime next_time = GST_CLOCK_TIME_NONE;
+    for (auto pad : pads.pads)
+    {
+        GstBuffer* buf = gst_aggregator_pad_peek_buffer(pad);
+        if (!buf)
+        {
+            continue;
+        }
+
+        if (GST_BUFFER_PTS_IS_VALID(buf))
+        {
+            GST_OBJECT_LOCK(pad);
+            const GstClockTime running_time =
+                gst_segment_to_running_time(&pad->segment, GST_FORMAT_TIME, GST_BUFFER_PTS(buf));
+            GST_OBJECT_UNLOCK(pad);
+
+            if (GST_CLOCK_TIME_IS_VALID(running_time)
+                && (!GST_CLOCK_TIME_IS_VALID(next_time) || running_time < next_time))
+            {
+                next_time = running_time;
+            }
+        }
+        gst_buffer_unref(buf);
+    }
+    return next_time;
+}
+
+
+static GstCaps* create_tiled_caps(GstTcamFrameSync* self, const std::vector<GstCaps*>& input_caps)
+{
+    GstStructure* reference = gst_structure_copy(gst_caps_get_structure(input_caps.front(), 0));
+    gst_structure_remove_field(reference, "height");
+
+    gint total_height = 0;
+    for (auto caps : input_caps)
+    {
+        gint height = 0;
+        const GstStructure* strct = gst_caps_get_structure(caps, 0);
+
+        GstStructure* cmp = gst_structure_copy(strct);
+        gst_structure_remove_field(cmp, "height");
+        const bool same_layout = gst_structure_is_equal(reference, cmp);
+        gst_structure_free(cmp);
+
+        if (!same_layout || !gst_structure_get_int(strct, "height", &height))
+        {
+            GST_ELEMENT_ERROR(self,
+                              CORE,
+                              NEGOTIATION,
+                              ("output=tiled requires identical formats and widths on all inputs. "
+                               "Got %" GST_PTR_FORMAT " and %" GST_PTR_FORMAT,
+                               static_cast<void*>(input_caps.front()),
+                               static_cast<void*>(caps)),
+                              (NULL));
+            gst_structure_free(reference);
+            return nullptr;
+        }
+        total_height += height;
+    }
+
+    gst_structure_set(reference, "height", G_TYPE_INT, total_height, NULL);
+
+    GstCaps* ret = gst_caps_new_empty();
+    gst_caps_append_structure(ret, reference);
+    return ret;
+}
+
+
+static GstFlowReturn gst_tcamframesync_update_src_caps(GstAggregator* agg,
+                                                       GstCaps* caps,
+                                                       GstCaps** ret)
+{
+    GstTcamFrameSync* self = GST_TCAMFRAMESYNC(agg);
+    auto& state = get_state(self);
+
+    tcamframesync::sink_pad_list pads(agg);
+
+    std::vector<GstCaps*> input_caps;
+    auto unref_input_caps = [&input_caps]
+    {
+        for (auto c : input_caps) { gst_caps_unref(c); }
+    };
+
+    for (auto pad : pads.pads)
+    {
+        GstCaps* c = gst_pad_get_current_caps(GST_PAD(pad));
+        if (!c)
+        {
+            unref_input_caps();
+            return GST_AGGREGATOR_FLOW_NEED_DATA;
+        }
+        input_caps.push_back(c);
+    }
+
+    if (input_caps.empty())
+    {
+        return GST_AGGREGATOR_FLOW_NEED_DATA;
+    }
+
+    GstCaps* output_caps = nullptr;
+    if (state.output == GST_TCAM_FRAME_SYNC_OUTPUT_BUFFER_LIST)
+    {
+#if GST_CHECK_VERSION(1, 18, 0)
+        const bool all_equal =
+            std::all_of(input_caps.begin(),
+                        input_caps.end(),
+                        [&input_caps](GstCaps* c) { return gst_caps_is_equal(c, input_caps[0]); });
+        if (all_equal)
+        {
+            output_caps = gst_caps_ref(input_caps.front());
+        }
+        else
+        {
+            GST_ELEMENT_ERROR(self,
+                              CORE,
+                              NEGOTIATION,
+                              ("output=buffer-list requires identical caps on all inputs."),
+                              (NULL));
+        }
+#else
+        GST_ELEMENT_ERROR(self,
+                          CORE,
+                          NEGOTIATION,
+                          ("output=buffer-list requires GStreamer 1.18 or newer."),
+                          (NULL));
+#endif
+    }
+    else
+    {
+        output_caps = create_tiled_caps(self, input_caps);
+    }
+
+    if (!output_caps)
+    {
+        unref_input_caps();
+        return GST_FLOW_NOT_NEGOTIATED;
+    }
+
+    std::vector<GstVideoInfo> input_info(input_caps.size());
+    bool is_video = true;
+    for (size_t i = 0; i < input_caps.size(); ++i)
+    {
+        is_video = is_video && gst_video_info_from_caps(&input_info.at(i), input_caps.at(i));
+    }
+    unref_input_caps();
+
+    if (is_video && !gst_video_info_from_caps(&state.output_info, output_caps))
+    {
+        is_video = false;
+    }
+
+    *ret = gst_caps_intersect(caps, output_caps);
+    gst_caps_unref(output_caps);
+
+    if (gst_caps_is_empty(*ret))
+    {
+        gst_caps_unref(*ret);
+        *ret = nullptr;
+        return GST_FLOW_NOT_NEGOTIATED;
+    }
+
+    state.input_info = std::move(input_info);
+    state.input_is_video = is_video;
+
+    GST_INFO_OBJECT(self,
+                    "Combining %zu inputs into %" GST_PTR_FORMAT,
+                    state.input_info.size(),
+                    static_cast<void*>(*ret));
+
+    return GST_FLOW_OK;
+}
+
+
+static gboolean gst_tcamframesync_start(GstAggregator* agg)
+{
+    auto& state = get_state(GST_TCAMFRAMESYNC(agg));
+
+    state.matcher.set_tolerance(
+        state.match == GST_TCAM_FRAME_SYNC_MATCH_CAMERA_TIME ? state.tolerance : 0);
+    state.input_info.clear();
+    state.sets = 0;
+    state.dropped = 0;
+
+    return TRUE;
+}
+
+
+static gboolean gst_tcamframesync_stop(GstAggregator* agg)
+{
+    get_state(GST_TCAMFRAMESYNC(agg)).input_info.clear();
+
+    return TRUE;
+}
+
+
+static void gst_tcamframesync_set_property(GObject* object,
+                                           guint property_id,
+                                           const GValue* value,
+                                           GParamSpec* pspec)
+{
+    auto& state = get_state(GST_TCAMFRAMESYNC(object));
+
+    switch (property_id)
+    {
+        case PROP_MATCH:
+        {
+            state.match = static_cast<GstTcamFrameSyncMatch>(g_value_get_enum(value));
+            break;
+        }
+        case PROP_TOLERANCE:
+        {
+            state.tolerance = g_value_get_uint64(value);
+            break;
+        }
+        case PROP_OUTPUT:
+        {
+            state.output = static_cast<GstTcamFrameSyncOutput>(g_value_get_enum(value));
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static void gst_tcamframesync_get_property(GObject* object,
+                                           guint property_id,
+                                           GValue* value,
+                                           GParamSpec* pspec)
+{
+    auto& state = get_state(GST_TCAMFRAMESYNC(object));
+
+    switch (property_id)
+    {
+        case PROP_MATCH:
+        {
+            g_value_set_enum(value, state.match);
+            break;
+        }
+        case PROP_TOLERANCE:
+        {
+            g_value_set_uint64(value, state.tolerance);
+            break;
+        }
+        case PROP_OUTPUT:
+        {
+            g_value_set_enum(value, state.output);
+            break;
+        }
+        case PROP_SETS:
+        {
+            g_value_set_uint64(value, state.sets);
+            break;
+        }
+        case PROP_DROPPED:
+        {
+            g_value_set_uint64(value, state.dropped);
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static GstStaticPadTemplate sink_template =
+    GST_STATIC_PAD_TEMPLATE("sink_%u", GST_PAD_SINK, GST_PAD_REQUEST, GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate src_template =
+    GST_STATIC_PAD_TEMPLATE("src", GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+
+static void gst_tcamframesync_init(GstTcamFrameSync* self)
+{
+    self->state_ = new tcamframesync::frame_sync_state;
+}
+
+
+static void gst_tcamframesync_finalize(GObject* object)
+{
+    delete GST_TCAMFRAMESYNC(object)->state_;
+    G_OBJECT_CLASS(gst_tcamframesync_parent_class)->finalize(object);
+}
+
+
+static void gst_tcamframesync_class_init(GstTcamFrameSyncClass* klass)
+{
+    GObjectClass* gobject_class = (GObjectClass*)klass;
+    GstElementClass* gstelement_class = (GstElementClass*)klass;
+    GstAggregatorClass* aggregator_class = GST_AGGREGATOR_CLASS(klass);
+
+    gobject_class->set_property = gst_tcamframesync_set_property;
+    gobject_class->get_property = gst_tcamframesync_get_property;
+    gobject_class->finalize = gst_tcamframesync_finalize;
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_MATCH,
+        g_param_spec_enum("match",
+                          "Match",
+                          "How frames of the same trigger are found",
+                          GST_TYPE_TCAM_FRAME_SYNC_MATCH,
+                          GST_TCAM_FRAME_SYNC_MATCH_TRIGGER_COUNT,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                   | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TOLERANCE,
+        g_param_spec_uint64("tolerance",
+                            "Tolerance",
+                            "Maximum difference in ns between the timestamps of a set, "
+                            "only used with match=camera-time",
+                            0,
+                            G_MAXUINT64,
+                            TCAMFRAMESYNC_DEFAULT_TOLERANCE,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                     | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_OUTPUT,
+        g_param_spec_enum("output",
+                          "Output",
+                          "tiled stacks the frames of a set vertically into one buffer, "
+                          "buffer-list pushes them as one GstBufferList (GStreamer >= 1.18)",
+                          GST_TYPE_TCAM_FRAME_SYNC_OUTPUT,
+                          GST_TCAM_FRAME_SYNC_OUTPUT_TILED,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                   | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_SETS,
+        g_param_spec_uint64("sets",
+                            "Sets",
+                            "Number of complete sets that were pushed",
+                            0,
+                            G_MAXUINT64,
+                            0,
+                            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DROPPED,
+        g_param_spec_uint64("dropped",
+                            "Dropped",
+                            "Number of frames that were dropped because no set could be completed",
+                            0,
+                            G_MAXUINT64,
+                            0,
+                            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    gst_element_class_set_static_metadata(
+        gstelement_class,
+        "The Imaging Source TcamFrameSync gstreamer element",
+        "Generic/Video",
+        "Combines the frames of several triggered cameras into sets",
+        "The Imaging Source <support@theimagingsource.com>");
+
+    gst_element_class_add_static_pad_template_with_gtype(
+        gstelement_class, &sink_template, GST_TYPE_AGGREGATOR_PAD);
+    gst_element_class_add_static_pad_template_with_gtype(
+        gstelement_class, &src_template, GST_TYPE_AGGREGATOR_PAD);
+
+    aggregator_class->aggregate = GST_DEBUG_FUNCPTR(gst_tcamframesync_aggregate);
+    aggregator_class->get_next_time = GST_DEBUG_FUNCPTR(gst_tcamframesync_get_next_time);
+    aggregator_class->update_src_caps = GST_DEBUG_FUNCPTR(gst_tcamframesync_update_src_caps);
+    aggregator_class->start = GST_DEBUG_FUNCPTR(gst_tcamframesync_start);
+    aggregator_class->stop = GST_DEBUG_FUNCPTR(gst_tcamframesync_stop);
+
+    GST_DEBUG_CATEGORY_INIT(
+        gst_tcamframesync_debug_category, "tcamframesync", 0, "tcamframesync element");
+}
+
+
+static gboolean plugin_init(GstPlugin* plugin)
+{
+    return gst_element_register(plugin, "tcamframesync", GST_RANK_NONE, GST_TYPE_TCAMFRAMESYNC);
+}
+
+#ifndef PACKAGE
+#define PACKAGE "tcamframesync"
+#endif
+#ifndef PACKAGE_NAME
+#define PACKAGE_NAME "tcamframesync"
+#endif
+#ifndef GST_PACKAGE_ORIGIN
+#define GST_PACKAGE_ORIGIN "https://github.com/TheImagingSource/tiscamera"
+#endif
+
+
+GST_PLUGIN_DEFINE(GST_VERSION_MAJOR,
+                  GST_VERSION_MINOR,
+                  tcamframesync,
+                  "The Imaging Source tcamframesync plugin",
+                  plugin_init,
+                  get_version(),
+                  "Proprietary",
+                  PACKAGE_NAME,
+                  GST_PACKAGE_ORIGIN)
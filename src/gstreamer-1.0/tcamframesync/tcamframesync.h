@@ -0,0 +1,73 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TCAMFRAMESYNC_H_INC_
+#define TCAMFRAMESYNC_H_INC_
+
+#include <gst/base/gstaggregator.h>
+#include <gst/gst.h>
+
+namespace tcamframesync
+{
+struct frame_sync_state;
+}
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+    GST_TCAM_FRAME_SYNC_MATCH_TRIGGER_COUNT,
+    GST_TCAM_FRAME_SYNC_MATCH_CAMERA_TIME,
+} GstTcamFrameSyncMatch;
+
+GType gst_tcam_frame_sync_match_get_type(void);
+#define GST_TYPE_TCAM_FRAME_SYNC_MATCH (gst_tcam_frame_sync_match_get_type())
+
+typedef enum
+{
+    GST_TCAM_FRAME_SYNC_OUTPUT_TILED,
+    GST_TCAM_FRAME_SYNC_OUTPUT_BUFFER_LIST,
+} GstTcamFrameSyncOutput;
+
+GType gst_tcam_frame_sync_output_get_type(void);
+#define GST_TYPE_TCAM_FRAME_SYNC_OUTPUT (gst_tcam_frame_sync_output_get_type())
+
+#define GST_TYPE_TCAMFRAMESYNC (gst_tcamframesync_get_type())
+#define GST_TCAMFRAMESYNC(obj) \
+    (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_TCAMFRAMESYNC, GstTcamFrameSync))
+#define GST_TCAMFRAMESYNC_CLASS(klass) \
+    (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_TCAMFRAMESYNC, GstTcamFrameSyncClass))
+#define GST_IS_TCAMFRAMESYNC(obj)       (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_TCAMFRAMESYNC))
+#define GST_IS_TCAMFRAMESYNC_CLASS(obj) (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_TCAMFRAMESYNC))
+
+typedef struct GstTcamFrameSync
+{
+    GstAggregator base;
+
+    tcamframesync::frame_sync_state* state_;
+
+} GstTcamFrameSync;
+
+typedef struct GstTcamFrameSyncClass
+{
+    GstAggregatorClass base_class;
+} GstTcamFrameSyncClass;
+
+GType gst_tcamframesync_get_type(void);
+
+G_END_DECLS
+
+#endif /* TCAMFRAMESYNC_H_INC_ */
@@ -18,6 +18,10 @@
 
 #include "../../logging.h"
 
+#include <gst-helper/helper_functions.h>
+#include <map>
+#include <mutex>
+
 using namespace tcam::gst;
 
 
@@ -133,18 +137,25 @@ static const struct conversion_desc tcambin_conversion [] =
 
     {CAPS_TYPE::BAYER_8, CAPS_TYPE::BAYER_8, {true, false, false, false},},
     {CAPS_TYPE::BAYER_8, CAPS_TYPE::RGB_32, {true, false, false, false},},
+    {CAPS_TYPE::BAYER_8, CAPS_TYPE::YUV, {true, false, false, false},},
 
     {CAPS_TYPE::BAYER_10, CAPS_TYPE::RGB_32, {true, false, false, false},},
+    {CAPS_TYPE::BAYER_10, CAPS_TYPE::YUV, {true, false, false, false},},
+    {CAPS_TYPE::BAYER_10, CAPS_TYPE::RGB_64, {true, false, false, false},},
     {CAPS_TYPE::BAYER_10, CAPS_TYPE::BAYER_8, {true, false, false, false},},
     {CAPS_TYPE::BAYER_10, CAPS_TYPE::BAYER_16, {true, false, false, false},},
 
     {CAPS_TYPE::BAYER_12, CAPS_TYPE::BAYER_16, {true, false, false, false},},
     {CAPS_TYPE::BAYER_12, CAPS_TYPE::BAYER_8, {true, false, false, false},},
     {CAPS_TYPE::BAYER_12, CAPS_TYPE::RGB_32, {true, false, false, false},},
+    {CAPS_TYPE::BAYER_12, CAPS_TYPE::YUV, {true, false, false, false},},
+    {CAPS_TYPE::BAYER_12, CAPS_TYPE::RGB_64, {true, false, false, false},},
 
     {CAPS_TYPE::BAYER_16, CAPS_TYPE::BAYER_16, {true, false, false, false},},
     {CAPS_TYPE::BAYER_16, CAPS_TYPE::BAYER_8, {true, false, false, false},},
     {CAPS_TYPE::BAYER_16, CAPS_TYPE::RGB_32, {true, false, false, false},},
+    {CAPS_TYPE::BAYER_16, CAPS_TYPE::YUV, {true, false, false, false},},
+    {CAPS_TYPE::BAYER_16, CAPS_TYPE::RGB_64, {true, false, false, false},},
 
     {CAPS_TYPE::MONO_8, CAPS_TYPE::MONO_8, {true, false, false, false},},
     {CAPS_TYPE::MONO_8, CAPS_TYPE::MONO_16, {true, false, false, false},},
@@ -281,7 +292,7 @@ static GstCaps* get_caps_type_definition(CAPS_TYPE type)
         }
         case CAPS_TYPE::YUV:
         {
-            return gst_caps_from_string("video/x-raw,format={YUYV}");
+            return gst_caps_from_string("video/x-raw,format={YUY2, NV12, I420}");
         }
         case CAPS_TYPE::TIS_POLARIZED:
         {
@@ -312,7 +323,8 @@ namespace tcam::gst
 GstCaps* find_input_caps(GstCaps* available_caps,
                          GstCaps* wanted_caps,
                          input_caps_required_modules& modules,
-                         TcamBinConversionElement toggles)
+                         TcamBinConversionElement toggles,
+                         const format_cost_params& cost_params)
 {
     modules = {};
 
@@ -321,13 +333,46 @@ GstCaps* find_input_caps(GstCaps* available_caps,
         return nullptr;
     }
 
+    gst_helper::gst_ptr<GstCaps> wanted_copy;
     if (wanted_caps == nullptr || gst_caps_is_empty(wanted_caps))
     {
         GST_INFO("No sink caps specified. Continuing with output caps identical to device caps.");
-        wanted_caps = gst_caps_copy(available_caps);
+        wanted_copy = gst_helper::make_ptr(gst_caps_copy(available_caps));
+        wanted_caps = wanted_copy.get();
     }
 
-    TcamBinConversion conversion;
+    // Restarting a pipeline asks the same question again, the caps search and the module
+    // selection are by far the most expensive part of a tcambin start.
+    // The plan only depends on the arguments, so it is shared by all tcambin instances.
+    struct conversion_plan
+    {
+        gst_helper::gst_ptr<GstCaps> input;
+        input_caps_required_modules modules;
+    };
+    static std::mutex plan_cache_mtx;
+    static std::map<std::string, conversion_plan> plan_cache;
+
+    std::string plan_key = gst_helper::to_string(*available_caps) + "|"
+                           + gst_helper::to_string(*wanted_caps) + "|"
+                           + std::to_string(static_cast<int>(toggles)) + "|"
+                           + std::to_string(cost_params.link_capacity);
+    for (const auto& [fourcc, cost] : cost_params.measured_costs)
+    {
+        plan_key += "|" + std::to_string(fourcc) + "=" + std::to_string(cost);
+    }
+    {
+        std::scoped_lock lck { plan_cache_mtx };
+        auto iter = plan_cache.find(plan_key);
+        if (iter != plan_cache.end())
+        {
+            GST_DEBUG("Reusing conversion plan for %s", plan_key.c_str());
+            modules = iter->second.modules;
+            return gst_caps_copy(iter->second.input.get());
+        }
+    }
+
+    // building the caps table parses a couple of caps strings, only do that once
+    static const TcamBinConversion conversion;
 
     // the negotiation is not as obvious as one would hope
     //
@@ -360,12 +405,23 @@ GstCaps* find_input_caps(GstCaps* available_caps,
     {
         GstCaps* used_caps = filter_by_caps_properties(available_caps, wanted_caps);
 
-        actual_input = tcam_gst_find_largest_caps(used_caps, wanted_caps);
+        actual_input = tcam_gst_find_largest_caps(used_caps, wanted_caps, cost_params);
 
         gst_caps_unref(used_caps);
     }
     modules = conversion.get_modules(actual_input, wanted_caps, toggles);
 
+    if (actual_input && !gst_caps_is_empty(actual_input))
+    {
+        std::scoped_lock lck { plan_cache_mtx };
+        // every device/sink combination adds an entry, keep this from growing without bounds
+        if (plan_cache.size() >= 64)
+        {
+            plan_cache.clear();
+        }
+        plan_cache[plan_key] = { gst_helper::make_ptr(gst_caps_copy(actual_input)), modules };
+    }
+
     return actual_input;
 }
 
@@ -456,6 +512,16 @@ struct input_caps_required_modules TcamBinConversion::get_modules(GstCaps* caps,
         }
     }
 
+    // sinks that accept e.g. BGRx and NV12 match several tcamconvert conversions
+    // these all require the same elements
+    for (const auto& c : collection)
+    {
+        if (c.tcamconvert && !c.dutils)
+        {
+            return c;
+        }
+    }
+
     return {};
 }
 
@@ -82,13 +82,17 @@ struct input_caps_required_modules
  * @param requires_vidoeconvert(out) - will be set to true when the videoconvert element is required
  * @param requires_jpegconvert(out) - will be set to true when the jpegdec element is required
  * @param use_dutils(in) - false when dutils shall be ignored
+ * @param cost_params(in) - link and host properties for the format selection
  *
  * @return possible caps for the source
+ *
+ * Results are cached process wide, identical arguments return a copy of the previous result.
  */
 GstCaps* find_input_caps(GstCaps* available_caps,
                          GstCaps* wanted_caps,
                          input_caps_required_modules& modules,
-                         TcamBinConversionElement toggle);
+                         TcamBinConversionElement toggle,
+                         const format_cost_params& cost_params = {});
 
 
 enum class CAPS_TYPE
@@ -18,16 +18,19 @@
 
 #include "../../base_types.h"
 #include "../../logging.h"
+#include "../../utils.h"
 #include "tcambinconversion.h"
 #include "tcamgststrings.h"
 
 #include <algorithm> //std::find
+#include <cstdlib> // strtod
 #include <cstring> // strcmp
 #include <dutils_img/fcc_to_string.h>
 #include <dutils_img/image_fourcc_func.h>
+#include <dutils_img_lib/dutils_fcc_traits.h>
 #include <gst-helper/gst_gvalue_helper.h> // gst_string_list_to_vector
 #include <gst-helper/helper_functions.h>
-#include <map>
+#include <utility>
 
 
 typedef struct tcam_src_element_
@@ -214,299 +217,86 @@ bool tcam::gst::tcam_gst_raw_only_has_mono(const GstCaps* caps)
 }
 
 
-static bool tcam_gst_is_mono10_fourcc(const uint32_t fourcc)
-{
-    if (fourcc == FOURCC_MONO10
-        || fourcc == FOURCC_MONO10_MIPI_PACKED
-        || fourcc == FOURCC_MONO10_SPACKED)
-    {
-        return true;
-    }
-    return false;
-}
-
-
-static bool tcam_gst_is_mono12_fourcc(const uint32_t fourcc)
-{
-    if (fourcc == FOURCC_MONO12
-        || fourcc == FOURCC_MONO12_MIPI_PACKED
-        || fourcc == FOURCC_MONO12_PACKED
-        || fourcc == FOURCC_MONO12_SPACKED)
-    {
-        return true;
-    }
-    return false;
-}
-
-
-static bool tcam_gst_is_fourcc_bayer(const uint32_t fourcc)
-{
-    if (fourcc == FOURCC_GBRG8 || fourcc == FOURCC_GRBG8 || fourcc == FOURCC_RGGB8
-        || fourcc == FOURCC_BGGR8)
-    {
-        return TRUE;
-    }
-    return FALSE;
-}
-
-
-static bool tcam_gst_is_bayer10_fourcc(const uint32_t fourcc)
-{
-    if (fourcc == FOURCC_GBRG10 || fourcc == FOURCC_GRBG10 || fourcc == FOURCC_RGGB10
-        || fourcc == FOURCC_BGGR10)
-    {
-        return TRUE;
-    }
-    return FALSE;
-}
-
-
-static bool tcam_gst_is_bayer10_packed_fourcc(const uint32_t fourcc)
-{
-    if (fourcc == FOURCC_GBRG10_SPACKED || fourcc == FOURCC_GRBG10_SPACKED
-        || fourcc == FOURCC_RGGB10_SPACKED || fourcc == FOURCC_BGGR10_SPACKED
-        || fourcc == FOURCC_GBRG10_MIPI_PACKED || fourcc == FOURCC_GRBG10_MIPI_PACKED
-        || fourcc == FOURCC_RGGB10_MIPI_PACKED || fourcc == FOURCC_BGGR10_MIPI_PACKED)
-    {
-        return TRUE;
-    }
-    return FALSE;
-}
-
-
-static bool tcam_gst_is_bayer12_fourcc(const uint32_t fourcc)
-{
-    if (fourcc == FOURCC_GBRG12 || fourcc == FOURCC_GRBG12 || fourcc == FOURCC_RGGB12
-        || fourcc == FOURCC_BGGR12)
-    {
-        return TRUE;
-    }
-    return FALSE;
-}
-
-
-static bool tcam_gst_is_bayer12_packed_fourcc(const uint32_t fourcc)
+bool tcam::gst::format_is_yuv(const char* name, const char* fmt)
 {
-    if (fourcc == FOURCC_GBRG12_MIPI_PACKED || fourcc == FOURCC_GRBG12_MIPI_PACKED
-        || fourcc == FOURCC_RGGB12_MIPI_PACKED || fourcc == FOURCC_BGGR12_MIPI_PACKED
-        || fourcc == FOURCC_GBRG12_SPACKED || fourcc == FOURCC_GRBG12_SPACKED
-        || fourcc == FOURCC_RGGB12_SPACKED || fourcc == FOURCC_BGGR12_SPACKED
-        || fourcc == FOURCC_GBRG12_PACKED || fourcc == FOURCC_GRBG12_PACKED
-        || fourcc == FOURCC_RGGB12_PACKED || fourcc == FOURCC_BGGR12_PACKED)
+    if (!name || !fmt)
     {
-        return TRUE;
+        return false;
     }
-    return FALSE;
+    return img_lib::fcc_traits::get_gst(name, fmt).is_yuv();
 }
 
 
-static bool tcam_gst_is_bayer16_fourcc(const uint32_t fourcc)
-{
-    if (fourcc == FOURCC_GBRG16 || fourcc == FOURCC_GRBG16 || fourcc == FOURCC_RGGB16
-        || fourcc == FOURCC_BGGR16)
-    {
-        return TRUE;
-    }
-    return FALSE;
-}
-
-static bool tcam_gst_is_fourcc_yuv(const uint32_t fourcc)
+static const img_lib::fcc_traits::fcc_trait& bayer_string_trait(const char* format_string)
 {
-    if (fourcc == FOURCC_YUY2
-        || fourcc == FOURCC_UYVY
-        //|| fourcc == FOURCC_I420
-        //|| fourcc == FOURCC_YV16
-        || fourcc == FOURCC_IYU1 || fourcc == FOURCC_IYU2 || fourcc == FOURCC_Y411
-        || fourcc == FOURCC_NV12)
+    if (format_string == nullptr)
     {
-        return true;
+        return img_lib::fcc_traits::get(img::fourcc::FCC_NULL);
     }
-    return false;
+    return img_lib::fcc_traits::get_gst("video/x-bayer", format_string);
 }
 
 
-bool tcam::gst::format_is_yuv(const char* name, const char* fmt)
+static bool is_bayer_with_depth(const img_lib::fcc_traits::fcc_trait& info, int bit_depth)
 {
-    if (!name || !fmt)
-    {
-        return false;
-    }
-
-    uint32_t fourcc = tcam::gst::tcam_fourcc_from_gst_1_0_caps_string(name, fmt);
-
-    return tcam_gst_is_fourcc_yuv(fourcc);
+    return info.is_bayer() && !info.is_float() && info.bit_depth == bit_depth;
 }
 
 
 bool tcam::gst::tcam_gst_is_bayer8_string(const char* format_string)
 {
-    if (format_string == nullptr)
-    {
-        return false;
-    }
-
-    if (strcmp(format_string, "gbrg") == 0 || strcmp(format_string, "grbg") == 0
-        || strcmp(format_string, "rggb") == 0 || strcmp(format_string, "bggr") == 0)
-    {
-        return true;
-    }
-
-    return false;
+    return is_bayer_with_depth(bayer_string_trait(format_string), 8);
 }
 
 
 bool tcam::gst::tcam_gst_is_bayer10_string(const char* format_string)
 {
-    if (format_string == nullptr)
-    {
-        return false;
-    }
-
-    if (strncmp(format_string, "gbrg10", strlen("gbrg10")) == 0
-        || strncmp(format_string, "grbg10", strlen("grbg10")) == 0
-        || strncmp(format_string, "rggb10", strlen("rggb10")) == 0
-        || strncmp(format_string, "bggr10", strlen("bggr10")) == 0)
-    {
-        return true;
-    }
-
-    return false;
+    return is_bayer_with_depth(bayer_string_trait(format_string), 10);
 }
 
 
 bool tcam::gst::tcam_gst_is_bayer10_packed_string(const char* format_string)
 {
-    if (format_string == nullptr)
-    {
-        return false;
-    }
-
-    static constexpr std::array<std::string_view, 12> format_list = {
-        "rggb10p", "grbg10p", "gbrg10p", "bggr10p", "rggb10s", "grbg10s",
-        "gbrg10s", "bggr10s", "rggb10m", "grbg10m", "gbrg10m", "bggr10m",
-    };
-
-    if (std::find(format_list.begin(), format_list.end(), std::string_view(format_string))
-        != format_list.end())
-    {
-        return true;
-    }
-
-    return false;
+    const auto& info = bayer_string_trait(format_string);
+    return is_bayer_with_depth(info, 10) && info.pack != img_lib::fcc_traits::packing::none;
 }
 
 
 bool tcam::gst::tcam_gst_is_bayer12_string(const char* format_string)
 {
-    if (format_string == nullptr)
-    {
-        return false;
-    }
-
-    if (strncmp(format_string, "gbrg12", strlen("gbrg12")) == 0
-        || strncmp(format_string, "grbg12", strlen("grbg12")) == 0
-        || strncmp(format_string, "rggb12", strlen("rggb12")) == 0
-        || strncmp(format_string, "bggr12", strlen("bggr12")) == 0)
-    {
-        return true;
-    }
-
-    return false;
+    return is_bayer_with_depth(bayer_string_trait(format_string), 12);
 }
 
 
 bool tcam::gst::tcam_gst_is_bayer12_packed_string(const char* format_string)
 {
-    if (format_string == nullptr)
-    {
-        return false;
-    }
-
-    static const std::array<std::string_view, 12> format_list = {
-        "rggb12p", "grbg12p", "gbrg12p", "bggr12p", "rggb12s", "grbg12s",
-        "gbrg12s", "bggr12s", "rggb12m", "grbg12m", "gbrg12m", "bggr12m",
-    };
-
-    if (std::find(format_list.begin(), format_list.end(), std::string_view(format_string))
-        != format_list.end())
-    {
-        return true;
-    }
-
-    return false;
+    const auto& info = bayer_string_trait(format_string);
+    return is_bayer_with_depth(info, 12) && info.pack != img_lib::fcc_traits::packing::none;
 }
 
 bool tcam::gst::tcam_gst_is_bayer16_string(const char* format_string)
 {
-    if (format_string == nullptr)
-    {
-        return false;
-    }
-
-    if (strcmp(format_string, "gbrg16") == 0 || strcmp(format_string, "grbg16") == 0
-        || strcmp(format_string, "rggb16") == 0 || strcmp(format_string, "bggr16") == 0)
-    {
-        return true;
-    }
-
-    return false;
+    return is_bayer_with_depth(bayer_string_trait(format_string), 16);
 }
 
 
 bool tcam::gst::tcam_gst_is_fourcc_rgb(const unsigned int fourcc)
 {
-    if (fourcc == GST_MAKE_FOURCC('R', 'G', 'B', 'x')
-        || fourcc == GST_MAKE_FOURCC('x', 'R', 'G', 'B')
-        || fourcc == GST_MAKE_FOURCC('B', 'G', 'R', 'x')
-        || fourcc == GST_MAKE_FOURCC('x', 'B', 'G', 'R')
-        || fourcc == GST_MAKE_FOURCC('R', 'G', 'B', 'A')
-        || fourcc == GST_MAKE_FOURCC('A', 'R', 'G', 'B')
-        || fourcc == GST_MAKE_FOURCC('B', 'G', 'R', 'A')
-        || fourcc == GST_MAKE_FOURCC('A', 'B', 'G', 'R') || fourcc == FOURCC_BGR24
-        || fourcc == FOURCC_BGRA32 || fourcc == FOURCC_BGRA64)
-    {
-        return TRUE;
-    }
-
-    return FALSE;
-}
-
-static bool tcam_gst_is_bayerpwl_fourcc(const uint32_t fourcc)
-{
-    return img::is_pwl_fcc(static_cast<img::fourcc>(fourcc));
-}
-
-static bool tcam_gst_is_polarized_mono(const unsigned int fourcc)
-{
-    if (fourcc == FOURCC_POLARIZATION_MONO8_90_45_135_0
-        || fourcc == FOURCC_POLARIZATION_MONO16_90_45_135_0
-        || fourcc == FOURCC_POLARIZATION_MONO12_SPACKED_90_45_135_0
-        || fourcc == FOURCC_POLARIZATION_MONO12_PACKED_90_45_135_0
-        || fourcc == FOURCC_POLARIZATION_ADI_PLANAR_MONO8
-        || fourcc == FOURCC_POLARIZATION_ADI_PLANAR_MONO16
-        || fourcc == FOURCC_POLARIZATION_ADI_MONO8 || fourcc == FOURCC_POLARIZATION_ADI_MONO16
-        || fourcc == FOURCC_POLARIZATION_PACKED8 || fourcc == FOURCC_POLARIZATION_PACKED16)
-    {
-        return true;
-    }
-
-    return false;
-}
-
-
-static bool tcam_gst_is_polarized_bayer(const unsigned int fourcc)
-{
-    if (fourcc == FOURCC_POLARIZATION_BG8_90_45_135_0
-        || fourcc == FOURCC_POLARIZATION_BG16_90_45_135_0
-        || fourcc == FOURCC_POLARIZATION_BG12_SPACKED_90_45_135_0
-        || fourcc == FOURCC_POLARIZATION_BG12_PACKED_90_45_135_0
-        || fourcc == FOURCC_POLARIZATION_PACKED8_BAYER_BG
-        || fourcc == FOURCC_POLARIZATION_PACKED16_BAYER_BG)
+    const auto& info = img_lib::fcc_traits::get(fourcc);
+    if (info.is_rgb() && !info.is_float())
     {
         return true;
     }
 
-    return false;
+    // the GStreamer fourccs of the 32-bit formats, these are not in the trait table
+    return fourcc == GST_MAKE_FOURCC('R', 'G', 'B', 'x')
+           || fourcc == GST_MAKE_FOURCC('x', 'R', 'G', 'B')
+           || fourcc == GST_MAKE_FOURCC('B', 'G', 'R', 'x')
+           || fourcc == GST_MAKE_FOURCC('x', 'B', 'G', 'R')
+           || fourcc == GST_MAKE_FOURCC('R', 'G', 'B', 'A')
+           || fourcc == GST_MAKE_FOURCC('A', 'R', 'G', 'B')
+           || fourcc == GST_MAKE_FOURCC('B', 'G', 'R', 'A')
+           || fourcc == GST_MAKE_FOURCC('A', 'B', 'G', 'R');
 }
 
 
@@ -643,125 +433,460 @@ static std::vector<uint32_t> index_format_fourccs(const GstCaps* caps)
     return ret;
 }
 
-static uint32_t find_preferred_format(const std::vector<uint32_t>& vec)
+/**
+ * Rank of fourcc for find_preferred_format, lower is better
+ * Only decides between formats of equal cost.
+ * @return -1 for fourccs without a rank
+ */
+static int preferred_format_rank(uint32_t fourcc)
 {
-    using namespace tcam::gst;
-
-    /**
-     * prefer bayer 8-bit over everything else
-     * if bayer 8-bit does not exist order according to the following list:
-     * color formats like BGR
-     * color formats like YUV
-     * formats like MJPEG
-     * GRAY16
-     * GRAY8
-     * pwl bayer
-     * bayer12/16
-     * polarized bayer
-     * polarized mono
-     */
-
-    if (vec.empty())
+    if (tcam::gst::tcam_gst_is_fourcc_rgb(fourcc))
     {
-        return 0;
+        return 10;
     }
 
-    // maps are ordered
-    // assume vec contains only unique values
-    // map.begin() thus has the entry with best rank
-    // since our key are associated in the way we prefer
-    std::map<int, uint32_t> map;
-
-    for (const auto& fourcc : vec)
+    const auto& info = img_lib::fcc_traits::get(fourcc);
+    if (info.is_float())
     {
-        if (tcam_gst_is_fourcc_bayer(fourcc))
+        return -1;
+    }
+    if (info.is_bayer())
+    {
+        switch (info.bit_depth)
         {
-            //best_result = fourcc;
-            map[0] = fourcc;
+            case 8:
+                return 0;
+            case 10:
+                return 65;
+            case 12:
+                return 70;
+            default:
+                return 80;
         }
-        else if (tcam_gst_is_fourcc_rgb(fourcc))
+    }
+    if (info.is_yuv())
+    {
+        return 20;
+    }
+    if (info.fcc == img::fourcc::MJPG)
+    {
+        return 30;
+    }
+    if (info.is_mono())
+    {
+        switch (info.bit_depth)
         {
-            map[10] = fourcc;
+            case 8:
+                return 40;
+            case 10:
+                return 43;
+            case 12:
+                return 47;
+            default:
+                return 50;
         }
-        else if (tcam_gst_is_fourcc_yuv(fourcc))
+    }
+    if (info.is_pwl_bayer())
+    {
+        return 60;
+    }
+    if (info.is_polarized_bayer())
+    {
+        return 90;
+    }
+    if (info.is_polarized_mono())
+    {
+        return 100;
+    }
+    return -1;
+}
+
+namespace
+{
+
+/*
+ * Cost of delivering a pixel, in ns.
+ * The transport cost applies to every byte the device sends, the others are the cost of
+ * converting a pixel of that format class to any other format.
+ * The defaults were measured with tcam-benchmark-kernels and tcam-benchmark-pipeline on a
+ * x86 host, TCAM_CONVERSION_COST replaces them for other hosts.
+ */
+struct conversion_costs
+{
+    double transport = 0.25;
+    double bayer8 = 1.0;
+    double bayer_packed = 1.6;
+    double bayer16 = 1.3;
+    double pwl = 2.0;
+    double mono = 0.4;
+    double yuv = 1.2;
+    double rgb = 0.8;
+    double mjpeg = 7.0;
+    double polarized = 3.0;
+};
+
+// a typical jpeg frame is about a seventh of the size of the decoded BGR image
+constexpr double jpeg_bytes_per_pixel = 0.4;
+
+
+conversion_costs load_conversion_costs()
+{
+    static constexpr std::pair<const char*, double conversion_costs::*> names[] = {
+        { "transport", &conversion_costs::transport },
+        { "bayer8", &conversion_costs::bayer8 },
+        { "bayer_packed", &conversion_costs::bayer_packed },
+        { "bayer16", &conversion_costs::bayer16 },
+        { "pwl", &conversion_costs::pwl },
+        { "mono", &conversion_costs::mono },
+        { "yuv", &conversion_costs::yuv },
+        { "rgb", &conversion_costs::rgb },
+        { "mjpeg", &conversion_costs::mjpeg },
+        { "polarized", &conversion_costs::polarized },
+    };
+
+    conversion_costs ret;
+
+    // e.g. "mjpeg=20,bayer8=2.5"
+    const std::string config = tcam::get_environment_variable("TCAM_CONVERSION_COST", "");
+    if (config.empty())
+    {
+        return ret;
+    }
+
+    for (const auto& entry : tcam::split_string(config, ","))
+    {
+        const auto sep = entry.find('=');
+        if (sep == std::string::npos)
         {
-            map[20] = fourcc;
+            SPDLOG_WARN("Ignoring invalid TCAM_CONVERSION_COST entry '{}'", entry);
+            continue;
         }
-        else if (fourcc == FOURCC_MJPG)
+
+        const std::string name = entry.substr(0, sep);
+        auto iter = std::find_if(std::begin(names),
+                                 std::end(names),
+                                 [&name](const auto& n) { return name == n.first; });
+
+        char* value_end = nullptr;
+        const double value = std::strtod(entry.c_str() + sep + 1, &value_end);
+        if (iter == std::end(names) || *value_end != '\0' || value < 0)
         {
-            map[30] = fourcc;
+            SPDLOG_WARN("Ignoring invalid TCAM_CONVERSION_COST entry '{}'", entry);
+            continue;
         }
-        else if (fourcc == FOURCC_Y800)
+        ret.*(iter->second) = value;
+    }
+    return ret;
+}
+
+
+const conversion_costs& get_conversion_costs()
+{
+    static const conversion_costs costs = load_conversion_costs();
+    return costs;
+}
+
+
+double calc_bytes_per_pixel(uint32_t fourcc)
+{
+    const auto& info = img_lib::fcc_traits::get(fourcc);
+    if (info.is_compressed())
+    {
+        return jpeg_bytes_per_pixel;
+    }
+    return img::get_bits_per_pixel(fourcc) / 8.0;
+}
+
+
+// output_fourcc is 0 when the sink accepts every format
+double calc_conversion_cost(uint32_t fourcc, uint32_t output_fourcc, const conversion_costs& costs)
+{
+    if (fourcc == output_fourcc)
+    {
+        return 0;
+    }
+
+    const auto& info = img_lib::fcc_traits::get(fourcc);
+    // jpeg has to be decoded by almost every consumer
+    if (info.is_compressed())
+    {
+        return costs.mjpeg;
+    }
+    if (output_fourcc == 0)
+    {
+        return 0;
+    }
+    if (info.is_polarized())
+    {
+        return costs.polarized;
+    }
+    if (info.is_pwl_bayer())
+    {
+        return costs.pwl;
+    }
+    if (info.is_bayer())
+    {
+        if (info.bit_depth == 8)
         {
-            map[40] = fourcc;
+            return costs.bayer8;
         }
-        else if (tcam_gst_is_mono10_fourcc(fourcc))
+        return info.pack == img_lib::fcc_traits::packing::none ? costs.bayer16 : costs.bayer_packed;
+    }
+    if (info.is_yuv())
+    {
+        return costs.yuv;
+    }
+    if (info.is_mono())
+    {
+        return costs.mono;
+    }
+    return costs.rgb;
+}
+
+
+double fraction_to_double(const GValue* value)
+{
+    const int den = gst_value_get_fraction_denominator(value);
+    return den == 0 ? 0 : gst_value_get_fraction_numerator(value) / static_cast<double>(den);
+}
+
+
+double get_max_framerate(const GValue* value)
+{
+    if (value == nullptr)
+    {
+        return 0;
+    }
+    if (GST_VALUE_HOLDS_FRACTION(value))
+    {
+        return fraction_to_double(value);
+    }
+    if (GST_VALUE_HOLDS_FRACTION_RANGE(value))
+    {
+        return fraction_to_double(gst_value_get_fraction_range_max(value));
+    }
+    if (GST_VALUE_HOLDS_LIST(value))
+    {
+        double ret = 0;
+        for (guint i = 0; i < gst_value_list_get_size(value); ++i)
         {
-            map[43] = fourcc;
+            ret = std::max(ret, get_max_framerate(gst_value_list_get_value(value, i)));
         }
-        else if (tcam_gst_is_mono12_fourcc(fourcc))
+        return ret;
+    }
+    return 0;
+}
+
+
+int get_max_int(const GstStructure* struc, const char* field)
+{
+    const GValue* value = gst_structure_get_value(struc, field);
+    if (value == nullptr)
+    {
+        return 0;
+    }
+    if (G_VALUE_HOLDS_INT(value))
+    {
+        return g_value_get_int(value);
+    }
+    if (GST_VALUE_HOLDS_INT_RANGE(value))
+    {
+        return gst_value_get_int_range_max(value);
+    }
+    return 0;
+}
+
+
+struct format_candidate
+{
+    uint32_t fourcc = 0;
+    int rank = 0;
+    // of the largest resolution the format offers
+    double pixels = 0;
+    double max_framerate = 0;
+
+    double achievable_framerate = 0;
+    double cost_per_pixel = 0;
+};
+
+
+format_candidate describe_format(const GstCaps* incoming, uint32_t fourcc)
+{
+    format_candidate ret;
+    ret.fourcc = fourcc;
+
+    for (guint i = 0; i < gst_caps_get_size(incoming); ++i)
+    {
+        const GstStructure* struc = gst_caps_get_structure(incoming, i);
+
+        if (tcam::gst::tcam_fourcc_from_gst_1_0_caps_string(
+                gst_structure_get_name(struc), gst_structure_get_string(struc, "format"))
+            != fourcc)
         {
-            map[47] = fourcc;
+            continue;
         }
-        else if (fourcc == FOURCC_Y16)
+
+        const double pixels = static_cast<double>(get_max_int(struc, "width"))
+                              * get_max_int(struc, "height");
+        const double framerate = get_max_framerate(gst_structure_get_value(struc, "framerate"));
+        if (pixels > ret.pixels || (pixels == ret.pixels && framerate > ret.max_framerate))
         {
-            map[50] = fourcc;
+            ret.pixels = pixels;
+            ret.max_framerate = framerate;
         }
-        else if (tcam_gst_is_bayerpwl_fourcc(fourcc))
+    }
+    return ret;
+}
+
+
+// 0 when the sink does not ask for a single format
+uint32_t get_output_fourcc(const GstCaps* filter)
+{
+    if (filter == nullptr || gst_caps_get_size(filter) != 1)
+    {
+        return 0;
+    }
+    const GstStructure* struc = gst_caps_get_structure(filter, 0);
+    if (gst_structure_has_field(struc, "format")
+        && gst_structure_get_field_type(struc, "format") != G_TYPE_STRING)
+    {
+        return 0;
+    }
+    return tcam::gst::tcam_fourcc_from_gst_1_0_caps_string(
+        gst_structure_get_name(struc), gst_structure_get_string(struc, "format"));
+}
+
+
+// 0 when the sink does not ask for a framerate
+double get_requested_framerate(const GstCaps* filter)
+{
+    if (filter == nullptr || gst_caps_get_size(filter) != 1)
+    {
+        return 0;
+    }
+    const GValue* value = gst_structure_get_value(gst_caps_get_structure(filter, 0), "framerate");
+    if (value == nullptr || !GST_VALUE_HOLDS_FRACTION(value))
+    {
+        return 0;
+    }
+    return fraction_to_double(value);
+}
+
+
+/*
+ * Selects the format that reaches the framerate the pipeline needs with the least cpu time.
+ *
+ * The pipeline needs the requested framerate or, without request, the highest framerate
+ * any of the formats offers. A format reaches it when its caps contain it and the link
+ * can carry its bytes per frame that often.
+ * The cpu time is estimated from the bytes that have to be received and the conversion to
+ * the format the sink asks for, see conversion_costs.
+ * When no format reaches the framerate, the one coming closest is used.
+ * The fixed rank of the formats decides between formats of equal cost.
+ */
+uint32_t find_preferred_format(const std::vector<uint32_t>& vec,
+                               const GstCaps* incoming,
+                               const GstCaps* filter,
+                               const tcam::gst::format_cost_params& params)
+{
+    const auto& costs = get_conversion_costs();
+    const uint32_t output_fourcc = get_output_fourcc(filter);
+
+    std::vector<format_candidate> candidates;
+    for (const auto& fourcc : vec)
+    {
+        const int rank = preferred_format_rank(fourcc);
+        if (rank < 0)
         {
-            map[60] = fourcc;
+            SPDLOG_ERROR("Could not associate rank with fourcc 0x{:x} {}",
+                         fourcc,
+                         img::fcc_to_string(fourcc).c_str());
+            continue;
         }
-        else if (tcam_gst_is_bayer10_fourcc(fourcc) || tcam_gst_is_bayer10_packed_fourcc(fourcc))
+
+        auto c = describe_format(incoming, fourcc);
+        c.rank = rank;
+
+        const double bytes_per_pixel = calc_bytes_per_pixel(fourcc);
+        c.achievable_framerate = c.max_framerate;
+        if (params.link_capacity != 0 && c.pixels > 0 && bytes_per_pixel > 0)
         {
-            map[65] = fourcc;
+            c.achievable_framerate = std::min(
+                c.achievable_framerate, params.link_capacity / (c.pixels * bytes_per_pixel));
         }
-        else if (tcam_gst_is_bayer12_fourcc(fourcc) || tcam_gst_is_bayer12_packed_fourcc(fourcc))
+        double conversion_cost = calc_conversion_cost(fourcc, output_fourcc, costs);
+        // measured for the conversion to BGRx, close enough for other formats
+        if (auto iter = params.measured_costs.find(fourcc);
+            conversion_cost > 0 && iter != params.measured_costs.end())
         {
-            map[70] = fourcc;
+            conversion_cost = iter->second;
         }
-        else if (tcam_gst_is_bayer16_fourcc(fourcc))
+        c.cost_per_pixel = bytes_per_pixel * costs.transport + conversion_cost;
+        candidates.push_back(c);
+    }
+    if (candidates.empty())
+    {
+        return 0;
+    }
+
+    double needed_framerate = get_requested_framerate(filter);
+    if (needed_framerate <= 0)
+    {
+        for (const auto& c : candidates)
         {
-            map[80] = fourcc;
+            needed_framerate = std::max(needed_framerate, c.max_framerate);
         }
-        else if (tcam_gst_is_polarized_bayer(fourcc))
+    }
+
+    // rounding of fractions and link capacities
+    const double tolerance = 0.999;
+    auto is_sufficient = [needed_framerate, tolerance](const format_candidate& c)
+    {
+        return c.achievable_framerate >= needed_framerate * tolerance;
+    };
+
+    auto is_better = [&is_sufficient](const format_candidate& a, const format_candidate& b)
+    {
+        if (is_sufficient(a) != is_sufficient(b))
         {
-            map[90] = fourcc;
+            return is_sufficient(a);
         }
-        else if (tcam_gst_is_polarized_mono(fourcc))
+        if (!is_sufficient(a) && a.achievable_framerate != b.achievable_framerate)
         {
-            map[100] = fourcc;
+            return a.achievable_framerate > b.achievable_framerate;
         }
-        else
+        if (a.cost_per_pixel != b.cost_per_pixel)
         {
-            SPDLOG_ERROR("Could not associate rank with fourcc 0x{:x} {}",
-                         fourcc,
-                         img::fcc_to_string(fourcc).c_str());
+            return a.cost_per_pixel < b.cost_per_pixel;
         }
-    }
-    if (map.empty())
+        return a.rank < b.rank;
+    };
+
+    for (const auto& c : candidates)
     {
-        return 0;
+        SPDLOG_DEBUG("Format {}: {:.1f} of {:.1f} fps, {:.2f} ns per pixel",
+                     img::fcc_to_string(c.fourcc),
+                     c.achievable_framerate,
+                     needed_framerate,
+                     c.cost_per_pixel);
     }
 
-    return map.begin()->second;
+    return std::min_element(candidates.begin(), candidates.end(), is_better)->fourcc;
 }
 
+} // namespace
+
 
-GstCaps* tcam::gst::tcam_gst_find_largest_caps(const GstCaps* incoming, const GstCaps* filter)
+GstCaps* tcam::gst::tcam_gst_find_largest_caps(const GstCaps* incoming,
+                                                const GstCaps* filter,
+                                                const format_cost_params& params)
 {
     /**
      * find_largest_caps tries to find the largest caps
      * according to the following rules:
      *
      * 1. determine the preferred format
-     *       prefer bayer 8-bit over everything else
-     *       if bayer 8-bit does not exist order according to the following list:
-     *       color formats like BGR
-     *       formats like MJPEG
-     *       GRAY8
-     *       GRAY16
-     *       pwl bayer
-     *       bayer12/16
+     *       the cheapest format that reaches the needed framerate, see find_preferred_format
      *
      * 2. find the largest resolution
      * 3. for the format with the largest resolution take the highest framerate
@@ -787,7 +912,7 @@ GstCaps* tcam::gst::tcam_gst_find_largest_caps(const GstCaps* incoming, const Gs
         }
     }
 
-    uint32_t preferred_fourcc = find_preferred_format(format_fourccs);
+    uint32_t preferred_fourcc = find_preferred_format(format_fourccs, incoming, filter, params);
 
     if (is_really_empty_caps(incoming))
     {
@@ -22,6 +22,7 @@
 
 #include <gst/gst.h>
 #include <cstdint>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -89,14 +90,30 @@ std::vector<std::string> index_caps_formats(GstCaps* caps);
 bool gst_caps_are_bayer_only(const GstCaps* caps);
 
 
+/**
+ * Properties of the device link and host the format selection takes into account.
+ */
+struct format_cost_params
+{
+    // bytes per second the link can carry, 0 when unknown
+    uint64_t link_capacity = 0;
+    // measured conversion cost of a fourcc in ns per pixel, replaces the estimate
+    std::map<uint32_t, double> measured_costs;
+};
+
+
 /**
  * Find the caps with the largest resolution and the highest framerate.
- * The format that will be selected is determined through internal ranking.
+ * The format is the one that reaches the framerate the filter asks for (or the highest
+ * framerate) with the least cpu time for transport and conversion to the filter format.
  * @param incoming - GstCaps from which to select
  * @param filter - GstCaps from which to select
+ * @param params - link and host properties, see format_cost_params
  * @return pointer to the largest caps, nullptr on error user has ownership
  */
-GstCaps* tcam_gst_find_largest_caps(const GstCaps* incoming, const GstCaps* filter);
+GstCaps* tcam_gst_find_largest_caps(const GstCaps* incoming,
+                                    const GstCaps* filter,
+                                    const format_cost_params& params = {});
 
 
 bool contains_bayer(const GstCaps* caps);
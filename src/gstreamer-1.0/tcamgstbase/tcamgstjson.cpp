@@ -18,30 +18,170 @@
 
 #include "../../../external/json/json.hpp"
 #include "../../logging.h"
+#include "../../property_dependencies.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <optional>
 
 // for convenience
 using json = nlohmann::json;
 
-std::string tcam::gst::create_device_settings(TcamPropertyProvider* tcam)
+namespace
 {
-    if (!tcam)
+/**
+ * Values load_device_settings last wrote to or read from the device.
+ * Attached to the provider, so that applying settings only writes what differs from the previous
+ * ones. An entry is only used for the property object it was taken from. The provider keeps these
+ * objects while the device is open, a weak ref drops the entries when they go away.
+ * 'tcam-property-changed' drops entries that changed behind our back.
+ */
+class settings_snapshot
+{
+public:
+    static settings_snapshot& get(TcamPropertyProvider* provider)
     {
-        return {};
+        static std::mutex attach_mtx;
+        std::scoped_lock lck { attach_mtx };
+
+        auto ptr =
+            static_cast<settings_snapshot*>(g_object_get_data(G_OBJECT(provider), data_key));
+        if (!ptr)
+        {
+            ptr = new settings_snapshot;
+            g_object_set_data_full(G_OBJECT(provider), data_key, ptr, &settings_snapshot::destroy);
+            g_signal_connect(
+                provider, "tcam-property-changed", G_CALLBACK(on_property_changed), ptr);
+        }
+        return *ptr;
     }
 
-    json j;
+    std::optional<json> find(TcamPropertyBase* prop, const std::string& name)
+    {
+        std::scoped_lock lck { mtx_ };
+        auto iter = entries_.find(name);
+        if (iter == entries_.end() || iter->second.prop != prop)
+        {
+            return std::nullopt;
+        }
+        return iter->second.value;
+    }
 
-    auto& write_obj = j;
+    void store(TcamPropertyBase* prop, const std::string& name, json value)
+    {
+        std::scoped_lock lck { mtx_ };
+        auto& e = entries_[name];
+        if (e.prop != prop)
+        {
+            if (e.prop)
+            {
+                g_object_weak_unref(G_OBJECT(e.prop), on_property_finalized, this);
+            }
+            g_object_weak_ref(G_OBJECT(prop), on_property_finalized, this);
+            e.prop = prop;
+        }
+        e.value = std::move(value);
+        e.generation = generation_;
+    }
 
-    GError* err_get_name = nullptr;
-    GSList* names = tcam_property_provider_get_tcam_property_names(tcam, &err_get_name);
-    if (err_get_name)
+    void begin_apply()
     {
-        SPDLOG_ERROR("Failed to read property names from , err={}.", err_get_name->message);
-        g_error_free(err_get_name);
-        return {};
+        std::scoped_lock lck { mtx_ };
+        ++generation_;
+        applying_ = true;
     }
 
+    void end_apply()
+    {
+        std::scoped_lock lck { mtx_ };
+        applying_ = false;
+    }
+
+private:
+    static constexpr const char* data_key = "tcam-device-settings-snapshot";
+
+    struct entry
+    {
+        TcamPropertyBase* prop = nullptr;
+        json value;
+        uint64_t generation = 0;
+    };
+
+    settings_snapshot() = default;
+    ~settings_snapshot()
+    {
+        for (auto&& [name, e] : entries_)
+        {
+            g_object_weak_unref(G_OBJECT(e.prop), on_property_finalized, this);
+        }
+    }
+
+    static void destroy(gpointer data)
+    {
+        delete static_cast<settings_snapshot*>(data);
+    }
+
+    static void on_property_changed(TcamPropertyProvider* /*provider*/,
+                                    const char* name,
+                                    gpointer user_data)
+    {
+        auto& self = *static_cast<settings_snapshot*>(user_data);
+
+        std::scoped_lock lck { self.mtx_ };
+        for (auto iter = self.entries_.begin(); iter != self.entries_.end();)
+        {
+            bool drop = false;
+            if (name && name[0] != '\0')
+            {
+                drop = iter->first == name;
+            }
+            else
+            {
+                // 'any property may have changed', backends like aravis send this after every
+                // write, so keep what the current load_device_settings call already wrote or read
+                drop = !self.applying_ || iter->second.generation != self.generation_;
+            }
+
+            if (drop)
+            {
+                g_object_weak_unref(G_OBJECT(iter->second.prop), on_property_finalized, &self);
+                iter = self.entries_.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+    }
+
+    static void on_property_finalized(gpointer user_data, GObject* where_the_object_was)
+    {
+        auto& self = *static_cast<settings_snapshot*>(user_data);
+
+        std::scoped_lock lck { self.mtx_ };
+        for (auto iter = self.entries_.begin(); iter != self.entries_.end(); ++iter)
+        {
+            if (G_OBJECT(iter->second.prop) == where_the_object_was)
+            {
+                self.entries_.erase(iter);
+                return;
+            }
+        }
+    }
+
+    std::mutex mtx_;
+    std::map<std::string, entry> entries_;
+    uint64_t generation_ = 0;
+    bool applying_ = false;
+};
+
+/**
+ * Reads the current value of prop_base.
+ * Errors are reported, commands and properties without a value return std::nullopt.
+ */
+std::optional<json> read_property_value(TcamPropertyBase* prop_base, const char* prop_name)
+{
     /**
      * If err is set, reports the error and returns true. Otherwise false is returned.
      */
@@ -56,87 +196,161 @@ std::string tcam::gst::create_device_settings(TcamPropertyProvider* tcam)
         return true;
     };
 
-    for (unsigned int i = 0; i < g_slist_length(names); ++i)
+    GError* err = nullptr;
+    switch (tcam_property_base_get_property_type(prop_base))
     {
-        GError* err_get_prop = nullptr;
-
-        const char* prop_name = static_cast<const char*>(g_slist_nth_data(names, i));
-
-        auto prop_base = tcam_property_provider_get_tcam_property(tcam, prop_name, &err_get_prop);
-        if (is_prop_error_consume(err_get_prop, prop_name))
+        case TCAM_PROPERTY_TYPE_INTEGER:
         {
-            continue;
+            auto value = tcam_property_integer_get_value(TCAM_PROPERTY_INTEGER(prop_base), &err);
+            if (!is_prop_error_consume(err, prop_name))
+            {
+                return json(value);
+            }
+            break;
         }
+        case TCAM_PROPERTY_TYPE_FLOAT:
+        {
+            auto value = tcam_property_float_get_value(TCAM_PROPERTY_FLOAT(prop_base), &err);
+            if (!is_prop_error_consume(err, prop_name))
+            {
+                return json(value);
+            }
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_ENUMERATION:
+        {
+            auto value =
+                tcam_property_enumeration_get_value(TCAM_PROPERTY_ENUMERATION(prop_base), &err);
+            if (!is_prop_error_consume(err, prop_name) && value)
+            {
+                return json(value);
+            }
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_BOOLEAN:
+        {
+            auto value = tcam_property_boolean_get_value(TCAM_PROPERTY_BOOLEAN(prop_base), &err);
+            if (!is_prop_error_consume(err, prop_name))
+            {
+                return json((bool)value);
+            }
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_COMMAND:
+        {
+            // Nothing to do here
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_STRING:
+        {
+            auto value = tcam_property_string_get_value(TCAM_PROPERTY_STRING(prop_base), &err);
+            std::optional<json> rval;
+            if (!is_prop_error_consume(err, prop_name) && value)
+            {
+                rval = json(value);
+            }
+            g_free(value);
+            return rval;
+        }
+    }
+    return std::nullopt;
+}
 
-        if (tcam_property_base_get_access(prop_base) == TCAM_PROPERTY_ACCESS_WO)
-            continue;
-        if (!tcam_property_base_is_available(prop_base, nullptr))
-            continue;
-
-        switch (tcam_property_base_get_property_type(prop_base))
+/**
+ * Converts a value from the settings to what read_property_value returns for a property of type,
+ * so the two can be compared. Returns std::nullopt for values that do not fit type.
+ */
+std::optional<json> normalize_requested_value(TcamPropertyType type, const json& value)
+{
+    switch (type)
+    {
+        case TCAM_PROPERTY_TYPE_INTEGER:
         {
-            case TCAM_PROPERTY_TYPE_INTEGER:
+            if (value.is_number())
             {
-                GError* err = nullptr;
-                auto value =
-                    tcam_property_integer_get_value(TCAM_PROPERTY_INTEGER(prop_base), &err);
-                if (!is_prop_error_consume(err, prop_name))
-                {
-                    write_obj.push_back(json::object_t::value_type(prop_name, value));
-                }
-                break;
+                return json(value.get<int64_t>());
             }
-            case TCAM_PROPERTY_TYPE_FLOAT:
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_FLOAT:
+        {
+            if (value.is_number())
             {
-                GError* err = nullptr;
-                auto value = tcam_property_float_get_value(TCAM_PROPERTY_FLOAT(prop_base), &err);
-                if (!is_prop_error_consume(err, prop_name))
-                {
-                    write_obj.push_back(json::object_t::value_type(prop_name, value));
-                }
-                break;
+                return json(value.get<double>());
             }
-            case TCAM_PROPERTY_TYPE_ENUMERATION:
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_ENUMERATION:
+        case TCAM_PROPERTY_TYPE_STRING:
+        {
+            if (value.is_string())
             {
-                GError* err = nullptr;
-                auto value =
-                    tcam_property_enumeration_get_value(TCAM_PROPERTY_ENUMERATION(prop_base), &err);
-                if (!is_prop_error_consume(err, prop_name))
-                {
-                    write_obj.push_back(json::object_t::value_type(prop_name, value));
-                }
-                break;
+                return json(value);
             }
-            case TCAM_PROPERTY_TYPE_BOOLEAN:
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_BOOLEAN:
+        {
+            if (value.is_boolean())
             {
-                GError* err = nullptr;
-                auto value =
-                    tcam_property_boolean_get_value(TCAM_PROPERTY_BOOLEAN(prop_base), &err);
-                if (!is_prop_error_consume(err, prop_name))
-                {
-                    write_obj.push_back(json::object_t::value_type(prop_name, (bool)value));
-                }
-                break;
+                return json(value);
             }
-            case TCAM_PROPERTY_TYPE_COMMAND:
+            if (value.is_number_unsigned())
             {
-                // Nothing to do here
-                break;
+                return json(value.get<uint64_t>() != 0);
             }
-            case TCAM_PROPERTY_TYPE_STRING:
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_COMMAND:
+        {
+            break;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+std::string tcam::gst::create_device_settings(TcamPropertyProvider* tcam)
+{
+    if (!tcam)
+    {
+        return {};
+    }
+
+    json j;
+
+    auto& write_obj = j;
+
+    GError* err_get_name = nullptr;
+    GSList* names = tcam_property_provider_get_tcam_property_names(tcam, &err_get_name);
+    if (err_get_name)
+    {
+        SPDLOG_ERROR("Failed to read property names from , err={}.", err_get_name->message);
+        g_error_free(err_get_name);
+        return {};
+    }
+
+    for (unsigned int i = 0; i < g_slist_length(names); ++i)
+    {
+        GError* err_get_prop = nullptr;
+
+        const char* prop_name = static_cast<const char*>(g_slist_nth_data(names, i));
+
+        auto prop_base = tcam_property_provider_get_tcam_property(tcam, prop_name, &err_get_prop);
+        if (err_get_prop)
+        {
+            SPDLOG_ERROR("Reading '{}' caused an error: {}", prop_name, err_get_prop->message);
+            g_error_free(err_get_prop);
+            continue;
+        }
+
+        if (tcam_property_base_get_access(prop_base) != TCAM_PROPERTY_ACCESS_WO
+            && tcam_property_base_is_available(prop_base, nullptr))
+        {
+            if (auto value = read_property_value(prop_base, prop_name); value)
             {
-                GError* err = nullptr;
-                auto value =
-                    tcam_property_string_get_value(TCAM_PROPERTY_STRING(prop_base), &err);
-                if (!is_prop_error_consume(err, prop_name))
-                {
-                    if (value)
-                    {
-                        write_obj.push_back(json::object_t::value_type(prop_name, value));
-                    }
-                }
-                g_free(value);
-                break;
+                write_obj.push_back(json::object_t::value_type(prop_name, std::move(*value)));
             }
         }
 
@@ -151,6 +365,7 @@ std::string tcam::gst::create_device_settings(TcamPropertyProvider* tcam)
 enum class apply_single_json_entry_rval
 {
     success,
+    unchanged, // the device already has the value
     error,
     locked_error,
 };
@@ -158,6 +373,7 @@ enum class apply_single_json_entry_rval
 static auto apply_single_json_entry(
     TcamPropertyProvider* tcam,
     json::iterator iter,
+    settings_snapshot& snapshot,
     std::function<void(std::string_view, std::string_view)> report_error_func)
     -> apply_single_json_entry_rval
 {
@@ -179,8 +395,29 @@ static auto apply_single_json_entry(
         if (!tcam_property_base_is_available(prop_base, nullptr))
             return apply_single_json_entry_rval::locked_error;
 
+        const auto prop_type = tcam_property_base_get_property_type(prop_base);
+
+        // commands have no state and are always executed
+        auto requested = normalize_requested_value(prop_type, iter.value());
+        if (requested)
+        {
+            auto current = snapshot.find(prop_base, property_name);
+            if (!current && tcam_property_base_get_access(prop_base) != TCAM_PROPERTY_ACCESS_WO)
+            {
+                current = read_property_value(prop_base, property_name.c_str());
+                if (current)
+                {
+                    snapshot.store(prop_base, property_name, *current);
+                }
+            }
+            if (current && *current == *requested)
+            {
+                g_object_unref(prop_base);
+                return apply_single_json_entry_rval::unchanged;
+            }
+        }
 
-        switch (tcam_property_base_get_property_type(prop_base))
+        switch (prop_type)
         {
             case TCAM_PROPERTY_TYPE_INTEGER:
             {
@@ -248,6 +485,11 @@ static auto apply_single_json_entry(
             }
         }
 
+        if (!err && requested)
+        {
+            snapshot.store(prop_base, property_name, std::move(*requested));
+        }
+
         g_object_unref(prop_base);
 
         if (err)
@@ -278,7 +520,9 @@ static auto apply_single_json_entry(
 }
 
 
-bool tcam::gst::load_device_settings(TcamPropertyProvider* tcam, const std::string& json_data)
+bool tcam::gst::load_device_settings(TcamPropertyProvider* tcam,
+                                     const std::string& json_data,
+                                     std::vector<std::string>* written_properties)
 {
     if (!tcam)
     {
@@ -310,6 +554,19 @@ bool tcam::gst::load_device_settings(TcamPropertyProvider* tcam, const std::stri
         prop_entry_list.push_back(iter);
     }
 
+    // properties that lock others go first, so that e.g. 'ExposureAuto=Off' unlocks
+    // 'ExposureTime' before we try to write it
+    std::stable_partition(prop_entry_list.begin(),
+                          prop_entry_list.end(),
+                          [](const json::iterator& iter)
+                          { return tcam::property::find_dependency_entry(iter.key()) != nullptr; });
+
+    auto& snapshot = settings_snapshot::get(tcam);
+    snapshot.begin_apply();
+
+    std::vector<std::string> written;
+    size_t unchanged_count = 0;
+
     /* This works like this:
      * Walk current list
      *  if one returns 'locked' as the error, add that entry to the retry-list
@@ -325,7 +582,7 @@ bool tcam::gst::load_device_settings(TcamPropertyProvider* tcam, const std::stri
         std::vector<json::iterator> retry_list;
         for (auto&& it : prop_entry_list)
         {
-            auto res = apply_single_json_entry(tcam, it, report_error);
+            auto res = apply_single_json_entry(tcam, it, snapshot, report_error);
             if (res == apply_single_json_entry_rval::locked_error)
             {
                 retry_list.push_back(it);
@@ -333,17 +590,35 @@ bool tcam::gst::load_device_settings(TcamPropertyProvider* tcam, const std::stri
             else if (res == apply_single_json_entry_rval::success)
             {
                 at_least_one_success = true;
+                written.push_back(it.key());
+            }
+            else if (res == apply_single_json_entry_rval::unchanged)
+            {
+                at_least_one_success = true;
+                ++unchanged_count;
             }
         }
         // move contents of the retry_list into the list which will be walked in the next cycle
         prop_entry_list = std::move(retry_list);
     } while (at_least_one_success && !prop_entry_list.empty());
 
+    snapshot.end_apply();
+
+    SPDLOG_INFO("Applied device settings, wrote {} and skipped {} unchanged properties: {}",
+                written.size(),
+                unchanged_count,
+                fmt::join(written, ", "));
+
     // generate the error message list for the properties we could not write due to being 'locked'
     for (auto&& entry : prop_entry_list)
     {
         report_error(entry.key(), "Failed to write locked property");
     }
 
+    if (written_properties)
+    {
+        *written_properties = std::move(written);
+    }
+
     return props.size() != prop_entry_list.size(); // we have at least one successfully 'set' entry
 }
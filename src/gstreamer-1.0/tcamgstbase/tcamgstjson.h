@@ -18,10 +18,20 @@
 
 #include <string>
 #include <tcam-property-1.0.h>
+#include <vector>
 
 namespace tcam::gst
 {
 std::string create_device_settings(TcamPropertyProvider* tcam);
 
-bool load_device_settings(TcamPropertyProvider* tcam, const std::string& json_data);
+/**
+ * Applies the properties in json_data to tcam.
+ * Only values that differ from the last value load_device_settings wrote to or read from the
+ * device are written, properties that lock others are written first.
+ * @param written_properties if not nullptr, receives the names of the properties that were written
+ * @return true if at least one entry could be applied
+ */
+bool load_device_settings(TcamPropertyProvider* tcam,
+                          const std::string& json_data,
+                          std::vector<std::string>* written_properties = nullptr);
 } // namespace tcam::gst
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ipc_protocol.h"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+
+bool fill_address(const std::string& path, sockaddr_un& addr)
+{
+    if (path.empty() || path.size() >= sizeof(addr.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size());
+
+    return true;
+}
+
+} // namespace
+
+
+int tcam::ipc::create_server_socket(const std::string& path)
+{
+    sockaddr_un addr;
+    if (!fill_address(path, addr))
+    {
+        return -1;
+    }
+
+    int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (sock < 0)
+    {
+        return -1;
+    }
+
+    unlink(path.c_str());
+
+    if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+        || listen(sock, 8) != 0)
+    {
+        int err = errno;
+        close(sock);
+        errno = err;
+        return -1;
+    }
+
+    return sock;
+}
+
+
+int tcam::ipc::connect_to_server(const std::string& path)
+{
+    sockaddr_un addr;
+    if (!fill_address(path, addr))
+    {
+        return -1;
+    }
+
+    int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (sock < 0)
+    {
+        return -1;
+    }
+
+    if (connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        int err = errno;
+        close(sock);
+        errno = err;
+        return -1;
+    }
+
+    return sock;
+}
+
+
+bool tcam::ipc::send_packet(int sock, message_type type, const void* payload, size_t size, int fd)
+{
+    if (sizeof(packet_header) + size > max_packet_size)
+    {
+        errno = EMSGSIZE;
+        return false;
+    }
+
+    packet_header header = { static_cast<uint32_t>(type), static_cast<uint32_t>(size) };
+
+    iovec iov[2] = {};
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = const_cast<void*>(payload);
+    iov[1].iov_len = size;
+
+    msghdr msg = {};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = size > 0 ? 2 : 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    if (fd >= 0)
+    {
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+
+    ssize_t ret = sendmsg(sock, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+    return ret == static_cast<ssize_t>(sizeof(header) + size);
+}
+
+
+std::optional<tcam::ipc::packet> tcam::ipc::receive_packet(int sock)
+{
+    std::vector<uint8_t> buffer(max_packet_size);
+
+    iovec iov = {};
+    iov.iov_base = buffer.data();
+    iov.iov_len = buffer.size();
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t ret = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    if (ret <= 0)
+    {
+        return std::nullopt;
+    }
+
+    packet rval;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+        {
+            memcpy(&rval.fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+
+    packet_header header;
+    if (static_cast<size_t>(ret) < sizeof(header) || (msg.msg_flags & MSG_TRUNC))
+    {
+        if (rval.fd >= 0)
+        {
+            close(rval.fd);
+        }
+        return std::nullopt;
+    }
+    memcpy(&header, buffer.data(), sizeof(header));
+
+    if (header.size != static_cast<size_t>(ret) - sizeof(header))
+    {
+        if (rval.fd >= 0)
+        {
+            close(rval.fd);
+        }
+        return std::nullopt;
+    }
+
+    rval.type = static_cast<message_type>(header.type);
+    rval.payload.assign(buffer.begin() + sizeof(header), buffer.begin() + ret);
+
+    return rval;
+}
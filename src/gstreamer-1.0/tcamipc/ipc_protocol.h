@@ -0,0 +1,93 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+//
+// Wire format shared by tcamipcsink and tcamipcsrc.
+//
+// Every packet of the SOCK_SEQPACKET unix socket starts with a packet_header.
+// Frames reference a slot, i.e. one memfd/dmabuf of the producer. The fd of a slot is only
+// attached (SCM_RIGHTS) to the first frame message a consumer gets for that slot, consumers keep
+// their mapping until they receive forget_slot.
+// Every frame is a lease that the consumer has to return with release once it is done reading.
+//
+namespace tcam::ipc
+{
+
+enum class message_type : uint32_t
+{
+    caps = 1, // payload is the caps string, sent on connect and on renegotiation
+    frame = 2, // frame_message, optionally followed by the statistics structure as string
+    release = 3, // release_message, consumer to producer
+    forget_slot = 4, // forget_slot_message
+};
+
+struct packet_header
+{
+    uint32_t type;
+    uint32_t size; // payload size, without header
+};
+
+struct frame_message
+{
+    uint64_t frame_id;
+    uint64_t pts; // GST_CLOCK_TIME_NONE when unset
+    uint64_t offset; // of the image in the slot
+    uint64_t size; // of the image
+    uint64_t mapping_size; // of the slot
+    uint32_t slot;
+    uint32_t reserved;
+};
+
+struct release_message
+{
+    uint64_t frame_id;
+};
+
+struct forget_slot_message
+{
+    uint32_t slot;
+};
+
+constexpr size_t max_packet_size = 64 * 1024;
+
+struct packet
+{
+    message_type type;
+    std::vector<uint8_t> payload;
+    int fd = -1; // owned by the receiver
+};
+
+// Returns -1 and sets errno on failure.
+// An existing socket file at path is replaced.
+int create_server_socket(const std::string& path);
+int connect_to_server(const std::string& path);
+
+// Never blocks, returns false when the packet could not be sent, errno tells why.
+// EAGAIN means the receiver is not reading fast enough.
+bool send_packet(int sock, message_type type, const void* payload, size_t size, int fd = -1);
+
+// nullopt when the peer closed the connection or on errors.
+std::optional<packet> receive_packet(int sock);
+
+} // namespace tcam::ipc
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../version.h"
+#include "tcamipcsink.h"
+#include "tcamipcsrc.h"
+
+static gboolean plugin_init(GstPlugin* plugin)
+{
+    if (!gst_element_register(plugin, "tcamipcsink", GST_RANK_NONE, GST_TYPE_TCAMIPCSINK))
+    {
+        return FALSE;
+    }
+    return gst_element_register(plugin, "tcamipcsrc", GST_RANK_NONE, GST_TYPE_TCAMIPCSRC);
+}
+
+#ifndef PACKAGE
+#define PACKAGE "tcamipc"
+#endif
+#ifndef PACKAGE_NAME
+#define PACKAGE_NAME "tcamipc"
+#endif
+#ifndef GST_PACKAGE_ORIGIN
+#define GST_PACKAGE_ORIGIN "https://github.com/TheImagingSource/tiscamera"
+#endif
+
+
+GST_PLUGIN_DEFINE(GST_VERSION_MAJOR,
+                  GST_VERSION_MINOR,
+                  tcamipc,
+                  "The Imaging Source tcamipc plugin",
+                  plugin_init,
+                  get_version(),
+                  "Proprietary",
+                  PACKAGE_NAME,
+                  GST_PACKAGE_ORIGIN)
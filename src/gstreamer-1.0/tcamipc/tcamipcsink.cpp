@@ -0,0 +1,771 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tcamipcsink.h"
+
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
+#include "../../MemfdAllocator.h"
+#include "ipc_protocol.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <gst/allocators/gstfdmemory.h>
+#include <map>
+#include <mutex>
+#include <poll.h>
+#include <set>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+GST_DEBUG_CATEGORY_STATIC(gst_tcamipcsink_debug_category);
+#define GST_CAT_DEFAULT gst_tcamipcsink_debug_category
+
+#define gst_tcamipcsink_parent_class parent_class
+G_DEFINE_TYPE(GstTcamIpcSink, gst_tcamipcsink, GST_TYPE_BASE_SINK)
+
+enum
+{
+    PROP_0,
+    PROP_SOCKET_PATH,
+    PROP_MAX_LEASES,
+    PROP_CLIENTS,
+};
+
+#define TCAMIPCSINK_DEFAULT_SOCKET_PATH "/tmp/tcamipc.sock"
+#define TCAMIPCSINK_DEFAULT_MAX_LEASES  2
+
+// upper limit for the memfd copies of buffers that are not fd backed
+static const size_t max_copy_buffers = 16;
+
+
+namespace tcamipc
+{
+
+struct client_connection
+{
+    int sock = -1;
+
+    // slots whose fd this client already received
+    std::set<uint32_t> known_slots;
+    // frames leased by this client
+    std::set<uint64_t> leases;
+};
+
+struct frame_lease
+{
+    GstBuffer* buffer = nullptr;
+    unsigned int count = 0;
+    // index into ipc_sink_state::copies, -1 when buffer is the upstream buffer
+    int copy_index = -1;
+};
+
+struct copy_buffer
+{
+    GstMemory* mem = nullptr;
+    bool in_use = false;
+};
+
+struct ipc_sink_state
+{
+    std::string socket_path = TCAMIPCSINK_DEFAULT_SOCKET_PATH;
+    guint max_leases = TCAMIPCSINK_DEFAULT_MAX_LEASES;
+
+    int listen_sock = -1;
+    int wakeup_pipe[2] = { -1, -1 };
+    std::thread server_thread;
+    std::atomic<bool> running = false;
+
+    // protects everything below
+    std::mutex mtx;
+
+    std::vector<client_connection> clients;
+
+    // st_dev/st_ino of the fd identify the memory, independent of dup'ed fds
+    std::map<std::pair<dev_t, ino_t>, uint32_t> slots;
+    uint32_t next_slot = 0;
+
+    std::map<uint64_t, frame_lease> leases;
+    uint64_t next_frame_id = 1;
+
+    std::string caps;
+
+    GstAllocator* fd_allocator = nullptr;
+    std::vector<copy_buffer> copies;
+};
+
+} // namespace tcamipc
+
+
+static tcamipc::ipc_sink_state& get_state(GstTcamIpcSink* self)
+{
+    return *self->state_;
+}
+
+
+// Returns the buffer that has to be unreffed once the lock is released.
+static GstBuffer* release_lease(tcamipc::ipc_sink_state& state, uint64_t frame_id)
+{
+    auto iter = state.leases.find(frame_id);
+    if (iter == state.leases.end())
+    {
+        return nullptr;
+    }
+
+    auto& lease = iter->second;
+    if (lease.count > 1)
+    {
+        lease.count--;
+        return nullptr;
+    }
+
+    GstBuffer* buffer = lease.buffer;
+    if (lease.copy_index >= 0)
+    {
+        state.copies.at(lease.copy_index).in_use = false;
+    }
+    state.leases.erase(iter);
+
+    // for tcammainsrc buffers the last unref requeues the buffer to the device
+    return buffer;
+}
+
+
+static void disconnect_client(tcamipc::ipc_sink_state& state,
+                              size_t index,
+                              std::vector<GstBuffer*>& to_unref)
+{
+    auto& client = state.clients.at(index);
+
+    for (auto frame_id : client.leases)
+    {
+        if (auto buffer = release_lease(state, frame_id))
+        {
+            to_unref.push_back(buffer);
+        }
+    }
+
+    close(client.sock);
+    state.clients.erase(state.clients.begin() + index);
+}
+
+
+static void accept_client(GstTcamIpcSink* self, tcamipc::ipc_sink_state& state)
+{
+    int sock = accept4(state.listen_sock, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (sock < 0)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            GST_WARNING_OBJECT(self, "Unable to accept client: %s", strerror(errno));
+        }
+        return;
+    }
+
+    if (!state.caps.empty()
+        && !tcam::ipc::send_packet(
+            sock, tcam::ipc::message_type::caps, state.caps.c_str(), state.caps.size()))
+    {
+        GST_WARNING_OBJECT(self, "Unable to send caps to new client: %s", strerror(errno));
+        close(sock);
+        return;
+    }
+
+    GST_INFO_OBJECT(self, "Client connected.");
+
+    tcamipc::client_connection client;
+    client.sock = sock;
+    state.clients.push_back(std::move(client));
+}
+
+
+static void handle_client_packet(tcamipc::ipc_sink_state& state,
+                                 tcamipc::client_connection& client,
+                                 const tcam::ipc::packet& p,
+                                 std::vector<GstBuffer*>& to_unref)
+{
+    if (p.fd >= 0)
+    {
+        // clients have no reason to send fds
+        close(p.fd);
+    }
+
+    if (p.type != tcam::ipc::message_type::release
+        || p.payload.size() != sizeof(tcam::ipc::release_message))
+    {
+        return;
+    }
+
+    tcam::ipc::release_message msg;
+    memcpy(&msg, p.payload.data(), sizeof(msg));
+
+    // ignore unknown ids, a client can only return its own leases
+    if (client.leases.erase(msg.frame_id) == 0)
+    {
+        return;
+    }
+
+    if (auto buffer = release_lease(state, msg.frame_id))
+    {
+        to_unref.push_back(buffer);
+    }
+}
+
+
+static void server_loop(GstTcamIpcSink* self)
+{
+    auto& state = get_state(self);
+
+    std::vector<pollfd> fds;
+
+    while (state.running)
+    {
+        fds.clear();
+        fds.push_back({ state.wakeup_pipe[0], POLLIN, 0 });
+        fds.push_back({ state.listen_sock, POLLIN, 0 });
+        {
+            std::scoped_lock lck { state.mtx };
+            for (const auto& c : state.clients) { fds.push_back({ c.sock, POLLIN, 0 }); }
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            GST_ERROR_OBJECT(self, "poll failed: %s", strerror(errno));
+            break;
+        }
+
+        if (fds.at(0).revents)
+        {
+            // stop
+            break;
+        }
+
+        std::vector<GstBuffer*> to_unref;
+        {
+            std::scoped_lock lck { state.mtx };
+
+            // clients are only added and removed by this thread
+            for (size_t i = fds.size() - 1; i >= 2; --i)
+            {
+                if (!fds.at(i).revents)
+                {
+                    continue;
+                }
+
+                size_t index = i - 2;
+                auto p = tcam::ipc::receive_packet(state.clients.at(index).sock);
+                if (!p)
+                {
+                    GST_INFO_OBJECT(self, "Client disconnected.");
+                    disconnect_client(state, index, to_unref);
+                    continue;
+                }
+                handle_client_packet(state, state.clients.at(index), *p, to_unref);
+            }
+
+            if (fds.at(1).revents & POLLIN)
+            {
+                accept_client(self, state);
+            }
+        }
+
+        for (auto b : to_unref) { gst_buffer_unref(b); }
+    }
+}
+
+
+static gboolean gst_tcamipcsink_start(GstBaseSink* sink)
+{
+    GstTcamIpcSink* self = GST_TCAMIPCSINK(sink);
+    auto& state = get_state(self);
+
+    state.listen_sock = tcam::ipc::create_server_socket(state.socket_path);
+    if (state.listen_sock < 0)
+    {
+        GST_ELEMENT_ERROR(self,
+                          RESOURCE,
+                          OPEN_WRITE,
+                          ("Unable to create socket '%s'", state.socket_path.c_str()),
+                          ("%s", strerror(errno)));
+        return FALSE;
+    }
+
+    if (pipe2(state.wakeup_pipe, O_CLOEXEC | O_NONBLOCK) != 0)
+    {
+        GST_ELEMENT_ERROR(self, RESOURCE, FAILED, ("Unable to create pipe"), (nullptr));
+        close(state.listen_sock);
+        state.listen_sock = -1;
+        return FALSE;
+    }
+
+    state.running = true;
+    state.server_thread = std::thread(server_loop, self);
+
+    return TRUE;
+}
+
+
+static void free_copies(tcamipc::ipc_sink_state& state, bool only_unused)
+{
+    for (auto& c : state.copies)
+    {
+        if (c.mem && (!only_unused || !c.in_use))
+        {
+            gst_memory_unref(c.mem);
+            c.mem = nullptr;
+        }
+    }
+}
+
+
+static gboolean gst_tcamipcsink_stop(GstBaseSink* sink)
+{
+    GstTcamIpcSink* self = GST_TCAMIPCSINK(sink);
+    auto& state = get_state(self);
+
+    state.running = false;
+    if (state.server_thread.joinable())
+    {
+        char c = 0;
+        if (write(state.wakeup_pipe[1], &c, 1) != 1)
+        {
+            GST_WARNING_OBJECT(self, "Unable to wake server thread.");
+        }
+        state.server_thread.join();
+    }
+
+    std::vector<GstBuffer*> to_unref;
+    {
+        std::scoped_lock lck { state.mtx };
+
+        for (auto& c : state.clients) { close(c.sock); }
+        state.clients.clear();
+
+        for (auto& [id, lease] : state.leases) { to_unref.push_back(lease.buffer); }
+        state.leases.clear();
+
+        for (auto& c : state.copies) { c.in_use = false; }
+        free_copies(state, false);
+        state.copies.clear();
+
+        state.slots.clear();
+        state.caps.clear();
+    }
+    for (auto b : to_unref) { gst_buffer_unref(b); }
+
+    for (auto& fd : state.wakeup_pipe)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    if (state.listen_sock >= 0)
+    {
+        close(state.listen_sock);
+        state.listen_sock = -1;
+        unlink(state.socket_path.c_str());
+    }
+
+    return TRUE;
+}
+
+
+static gboolean gst_tcamipcsink_set_caps(GstBaseSink* sink, GstCaps* caps)
+{
+    GstTcamIpcSink* self = GST_TCAMIPCSINK(sink);
+    auto& state = get_state(self);
+
+    gchar* str = gst_caps_to_string(caps);
+
+    std::scoped_lock lck { state.mtx };
+
+    state.caps = str;
+    g_free(str);
+
+    // the memory of the new format will be different,
+    // clients keep the old slots mapped until their leases are released
+    free_copies(state, true);
+    for (auto& client : state.clients)
+    {
+        for (auto slot : client.known_slots)
+        {
+            tcam::ipc::forget_slot_message msg = { slot };
+            tcam::ipc::send_packet(
+                client.sock, tcam::ipc::message_type::forget_slot, &msg, sizeof(msg));
+        }
+        client.known_slots.clear();
+
+        if (!tcam::ipc::send_packet(
+                client.sock, tcam::ipc::message_type::caps, state.caps.c_str(), state.caps.size()))
+        {
+            GST_WARNING_OBJECT(self, "Unable to send caps to client: %s", strerror(errno));
+        }
+    }
+    state.slots.clear();
+
+    return TRUE;
+}
+
+
+// Copies buffers that are not fd backed into a memfd.
+// Returns the index into state.copies or -1.
+static int copy_to_memfd(GstTcamIpcSink* self, tcamipc::ipc_sink_state& state, GstBuffer* buffer)
+{
+    const gsize size = gst_buffer_get_size(buffer);
+
+    int index = -1;
+    for (size_t i = 0; i < state.copies.size(); ++i)
+    {
+        auto& c = state.copies.at(i);
+        if (c.in_use)
+        {
+            continue;
+        }
+        if (c.mem && c.mem->maxsize < size)
+        {
+            gst_memory_unref(c.mem);
+            c.mem = nullptr;
+        }
+        index = static_cast<int>(i);
+        break;
+    }
+
+    if (index < 0)
+    {
+        if (state.copies.size() >= max_copy_buffers)
+        {
+            return -1;
+        }
+        state.copies.push_back({});
+        index = static_cast<int>(state.copies.size() - 1);
+    }
+
+    auto& c = state.copies.at(index);
+    if (!c.mem)
+    {
+        int fd = tcam::create_memfd("tcamipcsink", size);
+        if (fd < 0)
+        {
+            GST_ERROR_OBJECT(self, "Unable to create memfd: %s", strerror(errno));
+            return -1;
+        }
+        c.mem =
+            gst_fd_allocator_alloc(state.fd_allocator, fd, size, GST_FD_MEMORY_FLAG_KEEP_MAPPED);
+    }
+
+    gst_memory_resize(c.mem, 0, size);
+
+    GstMapInfo info;
+    if (!gst_memory_map(c.mem, &info, GST_MAP_WRITE))
+    {
+        GST_ERROR_OBJECT(self, "Unable to map memfd.");
+        return -1;
+    }
+    gst_buffer_extract(buffer, 0, info.data, size);
+    gst_memory_unmap(c.mem, &info);
+
+    c.in_use = true;
+
+    return index;
+}
+
+
+static GstFlowReturn gst_tcamipcsink_render(GstBaseSink* sink, GstBuffer* buffer)
+{
+    GstTcamIpcSink* self = GST_TCAMIPCSINK(sink);
+    auto& state = get_state(self);
+
+    std::unique_lock lck { state.mtx };
+
+    bool any_client = false;
+    for (const auto& client : state.clients)
+    {
+        if (client.leases.size() < state.max_leases)
+        {
+            any_client = true;
+            break;
+        }
+    }
+    if (!any_client)
+    {
+        return GST_FLOW_OK;
+    }
+
+    tcamipc::frame_lease lease;
+
+    GstMemory* mem = nullptr;
+    if (gst_buffer_n_memory(buffer) == 1)
+    {
+        mem = gst_buffer_peek_memory(buffer, 0);
+    }
+    if (mem && gst_is_fd_memory(mem))
+    {
+        // tcammainsrc io-mode=memfd/dmabuf, the clients read the device memory directly
+        lease.buffer = gst_buffer_ref(buffer);
+    }
+    else
+    {
+        lease.copy_index = copy_to_memfd(self, state, buffer);
+        if (lease.copy_index < 0)
+        {
+            GST_DEBUG_OBJECT(self, "No memfd buffer available, dropping frame.");
+            return GST_FLOW_OK;
+        }
+        mem = state.copies.at(lease.copy_index).mem;
+        lease.buffer = gst_buffer_new();
+        gst_buffer_append_memory(lease.buffer, gst_memory_ref(mem));
+    }
+
+    int fd = gst_fd_memory_get_fd(mem);
+
+    struct stat st = {};
+    if (fstat(fd, &st) != 0)
+    {
+        GST_ERROR_OBJECT(self, "Unable to stat buffer fd: %s", strerror(errno));
+        if (lease.copy_index >= 0)
+        {
+            state.copies.at(lease.copy_index).in_use = false;
+        }
+        lck.unlock();
+        gst_buffer_unref(lease.buffer);
+        return GST_FLOW_ERROR;
+    }
+
+    auto slot_iter = state.slots.find({ st.st_dev, st.st_ino });
+    if (slot_iter == state.slots.end())
+    {
+        slot_iter =
+            state.slots.emplace(std::make_pair(st.st_dev, st.st_ino), state.next_slot++).first;
+    }
+
+    tcam::ipc::frame_message msg = {};
+    msg.frame_id = state.next_frame_id++;
+    msg.pts = GST_BUFFER_PTS(buffer);
+    msg.offset = mem->offset;
+    msg.size = mem->size;
+    // GstFdMemory maps maxsize from the start of the fd
+    msg.mapping_size = mem->maxsize;
+    msg.slot = slot_iter->second;
+
+    std::vector<uint8_t> payload(sizeof(msg));
+    memcpy(payload.data(), &msg, sizeof(msg));
+
+    if (auto meta = gst_buffer_get_tcam_statistics_meta(buffer); meta && meta->structure)
+    {
+        gchar* str = gst_structure_to_string(meta->structure);
+        payload.insert(payload.end(), str, str + strlen(str));
+        g_free(str);
+    }
+
+    for (auto& client : state.clients)
+    {
+        if (client.leases.size() >= state.max_leases)
+        {
+            // the client is not keeping up, it would starve the pool
+            continue;
+        }
+
+        const bool send_fd = client.known_slots.count(msg.slot) == 0;
+        if (!tcam::ipc::send_packet(client.sock,
+                                    tcam::ipc::message_type::frame,
+                                    payload.data(),
+                                    payload.size(),
+                                    send_fd ? fd : -1))
+        {
+            // EAGAIN: the socket buffer is full, real errors are handled by the server thread
+            continue;
+        }
+
+        if (send_fd)
+        {
+            client.known_slots.insert(msg.slot);
+        }
+        client.leases.insert(msg.frame_id);
+        lease.count++;
+    }
+
+    if (lease.count == 0)
+    {
+        if (lease.copy_index >= 0)
+        {
+            state.copies.at(lease.copy_index).in_use = false;
+        }
+        lck.unlock();
+        gst_buffer_unref(lease.buffer);
+        return GST_FLOW_OK;
+    }
+
+    state.leases.emplace(msg.frame_id, lease);
+
+    return GST_FLOW_OK;
+}
+
+
+static void gst_tcamipcsink_set_property(GObject* object,
+                                         guint property_id,
+                                         const GValue* value,
+                                         GParamSpec* pspec)
+{
+    auto& state = get_state(GST_TCAMIPCSINK(object));
+
+    switch (property_id)
+    {
+        case PROP_SOCKET_PATH:
+        {
+            const char* str = g_value_get_string(value);
+            state.socket_path = str ? str : "";
+            break;
+        }
+        case PROP_MAX_LEASES:
+        {
+            std::scoped_lock lck { state.mtx };
+            state.max_leases = g_value_get_uint(value);
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static void gst_tcamipcsink_get_property(GObject* object,
+                                         guint property_id,
+                                         GValue* value,
+                                         GParamSpec* pspec)
+{
+    auto& state = get_state(GST_TCAMIPCSINK(object));
+
+    switch (property_id)
+    {
+        case PROP_SOCKET_PATH:
+        {
+            g_value_set_string(value, state.socket_path.c_str());
+            break;
+        }
+        case PROP_MAX_LEASES:
+        {
+            g_value_set_uint(value, state.max_leases);
+            break;
+        }
+        case PROP_CLIENTS:
+        {
+            std::scoped_lock lck { state.mtx };
+            g_value_set_uint(value, state.clients.size());
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static GstStaticPadTemplate sink_template =
+    GST_STATIC_PAD_TEMPLATE("sink", GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+
+static void gst_tcamipcsink_init(GstTcamIpcSink* self)
+{
+    self->state_ = new tcamipc::ipc_sink_state;
+    self->state_->fd_allocator = gst_fd_allocator_new();
+}
+
+
+static void gst_tcamipcsink_finalize(GObject* object)
+{
+    auto self = GST_TCAMIPCSINK(object);
+
+    gst_object_unref(self->state_->fd_allocator);
+    delete self->state_;
+
+    G_OBJECT_CLASS(gst_tcamipcsink_parent_class)->finalize(object);
+}
+
+
+static void gst_tcamipcsink_class_init(GstTcamIpcSinkClass* klass)
+{
+    GObjectClass* gobject_class = (GObjectClass*)klass;
+    GstElementClass* gstelement_class = (GstElementClass*)klass;
+    GstBaseSinkClass* basesink_class = GST_BASE_SINK_CLASS(klass);
+
+    gobject_class->set_property = gst_tcamipcsink_set_property;
+    gobject_class->get_property = gst_tcamipcsink_get_property;
+    gobject_class->finalize = gst_tcamipcsink_finalize;
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_SOCKET_PATH,
+        g_param_spec_string("socket-path",
+                            "Socket path",
+                            "Path of the unix socket consumers connect to",
+                            TCAMIPCSINK_DEFAULT_SOCKET_PATH,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                     | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_MAX_LEASES,
+        g_param_spec_uint("max-leases",
+                          "Max leases",
+                          "Maximum number of frames a single consumer may hold, "
+                          "a consumer holding more does not receive new frames",
+                          1,
+                          64,
+                          TCAMIPCSINK_DEFAULT_MAX_LEASES,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_CLIENTS,
+        g_param_spec_uint("clients",
+                          "Clients",
+                          "Number of connected consumers",
+                          0,
+                          G_MAXUINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    gst_element_class_set_static_metadata(
+        gstelement_class,
+        "The Imaging Source TcamIpcSink gstreamer element",
+        "Sink/Video",
+        "Shares buffers with tcamipcsrc instances in other processes",
+        "The Imaging Source <support@theimagingsource.com>");
+
+    gst_element_class_add_static_pad_template(gstelement_class, &sink_template);
+
+    basesink_class->start = GST_DEBUG_FUNCPTR(gst_tcamipcsink_start);
+    basesink_class->stop = GST_DEBUG_FUNCPTR(gst_tcamipcsink_stop);
+    basesink_class->set_caps = GST_DEBUG_FUNCPTR(gst_tcamipcsink_set_caps);
+    basesink_class->render = GST_DEBUG_FUNCPTR(gst_tcamipcsink_render);
+
+    GST_DEBUG_CATEGORY_INIT(
+        gst_tcamipcsink_debug_category, "tcamipcsink", 0, "tcamipcsink element");
+}
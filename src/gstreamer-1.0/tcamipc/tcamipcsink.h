@@ -0,0 +1,55 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TCAMIPCSINK_H_INC_
+#define TCAMIPCSINK_H_INC_
+
+#include <gst/base/gstbasesink.h>
+#include <gst/gst.h>
+
+namespace tcamipc
+{
+struct ipc_sink_state;
+}
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_TCAMIPCSINK (gst_tcamipcsink_get_type())
+#define GST_TCAMIPCSINK(obj) \
+    (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_TCAMIPCSINK, GstTcamIpcSink))
+#define GST_TCAMIPCSINK_CLASS(klass) \
+    (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_TCAMIPCSINK, GstTcamIpcSinkClass))
+#define GST_IS_TCAMIPCSINK(obj)       (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_TCAMIPCSINK))
+#define GST_IS_TCAMIPCSINK_CLASS(obj) (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_TCAMIPCSINK))
+
+typedef struct GstTcamIpcSink
+{
+    GstBaseSink base;
+
+    tcamipc::ipc_sink_state* state_;
+
+} GstTcamIpcSink;
+
+typedef struct GstTcamIpcSinkClass
+{
+    GstBaseSinkClass base_class;
+} GstTcamIpcSinkClass;
+
+GType gst_tcamipcsink_get_type(void);
+
+G_END_DECLS
+
+#endif /* TCAMIPCSINK_H_INC_ */
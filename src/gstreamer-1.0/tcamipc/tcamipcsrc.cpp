@@ -0,0 +1,480 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tcamipcsrc.h"
+
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
+#include "ipc_protocol.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+GST_DEBUG_CATEGORY_STATIC(gst_tcamipcsrc_debug_category);
+#define GST_CAT_DEFAULT gst_tcamipcsrc_debug_category
+
+#define gst_tcamipcsrc_parent_class parent_class
+G_DEFINE_TYPE(GstTcamIpcSrc, gst_tcamipcsrc, GST_TYPE_PUSH_SRC)
+
+enum
+{
+    PROP_0,
+    PROP_SOCKET_PATH,
+};
+
+#define TCAMIPCSRC_DEFAULT_SOCKET_PATH "/tmp/tcamipc.sock"
+
+
+namespace tcamipc
+{
+
+// Shared with all buffers, which send their release through it.
+struct connection
+{
+    explicit connection(int s) : sock(s) {}
+    ~connection()
+    {
+        close(sock);
+    }
+
+    connection(const connection&) = delete;
+    connection& operator=(const connection&) = delete;
+
+    void release(uint64_t frame_id)
+    {
+        tcam::ipc::release_message msg = { frame_id };
+
+        std::scoped_lock lck { mtx };
+        // when this fails the producer is gone and has already dropped all leases
+        tcam::ipc::send_packet(sock, tcam::ipc::message_type::release, &msg, sizeof(msg));
+    }
+
+    int sock = -1;
+    std::mutex mtx;
+};
+
+// Read only mapping of one producer slot, kept alive by the buffers that point into it.
+struct slot_mapping
+{
+    slot_mapping(void* p, size_t s) : ptr(p), size(s) {}
+    ~slot_mapping()
+    {
+        munmap(ptr, size);
+    }
+
+    slot_mapping(const slot_mapping&) = delete;
+    slot_mapping& operator=(const slot_mapping&) = delete;
+
+    void* ptr = nullptr;
+    size_t size = 0;
+};
+
+struct frame_lease
+{
+    std::shared_ptr<connection> conn;
+    std::shared_ptr<slot_mapping> mapping;
+    uint64_t frame_id = 0;
+};
+
+struct ipc_src_state
+{
+    std::string socket_path = TCAMIPCSRC_DEFAULT_SOCKET_PATH;
+
+    std::shared_ptr<connection> conn;
+    std::map<uint32_t, std::shared_ptr<slot_mapping>> slots;
+
+    GstCaps* caps = nullptr;
+
+    int unlock_pipe[2] = { -1, -1 };
+};
+
+} // namespace tcamipc
+
+
+static tcamipc::ipc_src_state& get_state(GstTcamIpcSrc* self)
+{
+    return *self->state_;
+}
+
+
+static void release_frame_lease(gpointer data)
+{
+    auto lease = static_cast<tcamipc::frame_lease*>(data);
+
+    lease->conn->release(lease->frame_id);
+    delete lease;
+}
+
+
+static gboolean gst_tcamipcsrc_start(GstBaseSrc* src)
+{
+    GstTcamIpcSrc* self = GST_TCAMIPCSRC(src);
+    auto& state = get_state(self);
+
+    int sock = tcam::ipc::connect_to_server(state.socket_path);
+    if (sock < 0)
+    {
+        GST_ELEMENT_ERROR(self,
+                          RESOURCE,
+                          OPEN_READ,
+                          ("Unable to connect to '%s'", state.socket_path.c_str()),
+                          ("%s", strerror(errno)));
+        return FALSE;
+    }
+    state.conn = std::make_shared<tcamipc::connection>(sock);
+
+    if (pipe2(state.unlock_pipe, O_CLOEXEC | O_NONBLOCK) != 0)
+    {
+        GST_ELEMENT_ERROR(self, RESOURCE, FAILED, ("Unable to create pipe"), (nullptr));
+        state.conn.reset();
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+static gboolean gst_tcamipcsrc_stop(GstBaseSrc* src)
+{
+    auto& state = get_state(GST_TCAMIPCSRC(src));
+
+    // buffers still downstream keep their mapping and the connection
+    state.slots.clear();
+    state.conn.reset();
+
+    gst_caps_replace(&state.caps, nullptr);
+
+    for (auto& fd : state.unlock_pipe)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    return TRUE;
+}
+
+
+static gboolean gst_tcamipcsrc_negotiate(GstBaseSrc* src)
+{
+    auto& state = get_state(GST_TCAMIPCSRC(src));
+
+    if (!state.caps)
+    {
+        // caps are set by create once the producer sent them
+        return TRUE;
+    }
+    return gst_base_src_set_caps(src, state.caps);
+}
+
+
+static gboolean gst_tcamipcsrc_unlock(GstBaseSrc* src)
+{
+    auto& state = get_state(GST_TCAMIPCSRC(src));
+
+    char c = 0;
+    if (write(state.unlock_pipe[1], &c, 1) != 1)
+    {
+        GST_WARNING_OBJECT(src, "Unable to unlock: %s", strerror(errno));
+    }
+    return TRUE;
+}
+
+
+static gboolean gst_tcamipcsrc_unlock_stop(GstBaseSrc* src)
+{
+    auto& state = get_state(GST_TCAMIPCSRC(src));
+
+    char c = 0;
+    while (read(state.unlock_pipe[0], &c, 1) == 1) {}
+
+    return TRUE;
+}
+
+
+static void handle_caps(GstTcamIpcSrc* self, const tcam::ipc::packet& p)
+{
+    auto& state = get_state(self);
+
+    std::string str(p.payload.begin(), p.payload.end());
+    GstCaps* caps = gst_caps_from_string(str.c_str());
+    if (!caps)
+    {
+        GST_WARNING_OBJECT(self, "Producer sent invalid caps '%s'", str.c_str());
+        return;
+    }
+
+    if (!state.caps || !gst_caps_is_equal(state.caps, caps))
+    {
+        GST_INFO_OBJECT(self, "Producer caps %" GST_PTR_FORMAT, static_cast<void*>(caps));
+        gst_caps_replace(&state.caps, caps);
+        gst_base_src_set_caps(GST_BASE_SRC(self), caps);
+    }
+    gst_caps_unref(caps);
+}
+
+
+static GstBuffer* handle_frame(GstTcamIpcSrc* self, tcam::ipc::packet& p)
+{
+    auto& state = get_state(self);
+
+    if (p.payload.size() < sizeof(tcam::ipc::frame_message))
+    {
+        return nullptr;
+    }
+
+    tcam::ipc::frame_message msg;
+    memcpy(&msg, p.payload.data(), sizeof(msg));
+
+    if (p.fd >= 0)
+    {
+        void* ptr = mmap(nullptr, msg.mapping_size, PROT_READ, MAP_SHARED, p.fd, 0);
+        close(p.fd);
+        p.fd = -1;
+
+        if (ptr == MAP_FAILED)
+        {
+            GST_ERROR_OBJECT(self, "Unable to map slot %u: %s", msg.slot, strerror(errno));
+            state.conn->release(msg.frame_id);
+            return nullptr;
+        }
+        state.slots[msg.slot] = std::make_shared<tcamipc::slot_mapping>(ptr, msg.mapping_size);
+    }
+
+    auto iter = state.slots.find(msg.slot);
+    if (iter == state.slots.end() || msg.offset + msg.size > iter->second->size)
+    {
+        GST_WARNING_OBJECT(self, "Received frame for unknown slot %u", msg.slot);
+        state.conn->release(msg.frame_id);
+        return nullptr;
+    }
+
+    auto lease = new tcamipc::frame_lease { state.conn, iter->second, msg.frame_id };
+
+    GstBuffer* buffer = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY,
+                                                    iter->second->ptr,
+                                                    iter->second->size,
+                                                    msg.offset,
+                                                    msg.size,
+                                                    lease,
+                                                    release_frame_lease);
+    GST_BUFFER_OFFSET(buffer) = msg.frame_id;
+
+    if (p.payload.size() > sizeof(msg))
+    {
+        std::string str(p.payload.begin() + sizeof(msg), p.payload.end());
+        if (auto structure = gst_structure_from_string(str.c_str(), nullptr))
+        {
+            // takes ownership
+            gst_buffer_add_tcam_statistics_meta(buffer, structure);
+        }
+    }
+
+    return buffer;
+}
+
+
+static GstFlowReturn gst_tcamipcsrc_create(GstPushSrc* push_src, GstBuffer** buffer)
+{
+    GstTcamIpcSrc* self = GST_TCAMIPCSRC(push_src);
+    auto& state = get_state(self);
+
+    while (true)
+    {
+        pollfd fds[2] = {
+            { state.unlock_pipe[0], POLLIN, 0 },
+            { state.conn->sock, POLLIN, 0 },
+        };
+
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            GST_ELEMENT_ERROR(self, RESOURCE, READ, ("poll failed"), ("%s", strerror(errno)));
+            return GST_FLOW_ERROR;
+        }
+
+        if (fds[0].revents)
+        {
+            return GST_FLOW_FLUSHING;
+        }
+
+        auto p = tcam::ipc::receive_packet(state.conn->sock);
+        if (!p)
+        {
+            GST_INFO_OBJECT(self, "Producer closed the connection.");
+            return GST_FLOW_EOS;
+        }
+
+        switch (p->type)
+        {
+            case tcam::ipc::message_type::caps:
+            {
+                handle_caps(self, *p);
+                break;
+            }
+            case tcam::ipc::message_type::forget_slot:
+            {
+                if (p->payload.size() == sizeof(tcam::ipc::forget_slot_message))
+                {
+                    tcam::ipc::forget_slot_message msg;
+                    memcpy(&msg, p->payload.data(), sizeof(msg));
+                    state.slots.erase(msg.slot);
+                }
+                break;
+            }
+            case tcam::ipc::message_type::frame:
+            {
+                *buffer = handle_frame(self, *p);
+                if (*buffer)
+                {
+                    return GST_FLOW_OK;
+                }
+                break;
+            }
+            case tcam::ipc::message_type::release:
+            {
+                break;
+            }
+        }
+
+        if (p->fd >= 0)
+        {
+            close(p->fd);
+        }
+    }
+}
+
+
+static void gst_tcamipcsrc_set_property(GObject* object,
+                                        guint property_id,
+                                        const GValue* value,
+                                        GParamSpec* pspec)
+{
+    auto& state = get_state(GST_TCAMIPCSRC(object));
+
+    switch (property_id)
+    {
+        case PROP_SOCKET_PATH:
+        {
+            const char* str = g_value_get_string(value);
+            state.socket_path = str ? str : "";
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static void gst_tcamipcsrc_get_property(GObject* object,
+                                        guint property_id,
+                                        GValue* value,
+                                        GParamSpec* pspec)
+{
+    auto& state = get_state(GST_TCAMIPCSRC(object));
+
+    switch (property_id)
+    {
+        case PROP_SOCKET_PATH:
+        {
+            g_value_set_string(value, state.socket_path.c_str());
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static GstStaticPadTemplate src_template =
+    GST_STATIC_PAD_TEMPLATE("src", GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+
+static void gst_tcamipcsrc_init(GstTcamIpcSrc* self)
+{
+    self->state_ = new tcamipc::ipc_src_state;
+
+    gst_base_src_set_live(GST_BASE_SRC(self), TRUE);
+    gst_base_src_set_format(GST_BASE_SRC(self), GST_FORMAT_TIME);
+    // the producer timestamps are relative to its own pipeline clock
+    gst_base_src_set_do_timestamp(GST_BASE_SRC(self), TRUE);
+}
+
+
+static void gst_tcamipcsrc_finalize(GObject* object)
+{
+    delete GST_TCAMIPCSRC(object)->state_;
+    G_OBJECT_CLASS(gst_tcamipcsrc_parent_class)->finalize(object);
+}
+
+
+static void gst_tcamipcsrc_class_init(GstTcamIpcSrcClass* klass)
+{
+    GObjectClass* gobject_class = (GObjectClass*)klass;
+    GstElementClass* gstelement_class = (GstElementClass*)klass;
+    GstBaseSrcClass* basesrc_class = GST_BASE_SRC_CLASS(klass);
+    GstPushSrcClass* pushsrc_class = GST_PUSH_SRC_CLASS(klass);
+
+    gobject_class->set_property = gst_tcamipcsrc_set_property;
+    gobject_class->get_property = gst_tcamipcsrc_get_property;
+    gobject_class->finalize = gst_tcamipcsrc_finalize;
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_SOCKET_PATH,
+        g_param_spec_string("socket-path",
+                            "Socket path",
+                            "Path of the unix socket of the tcamipcsink",
+                            TCAMIPCSRC_DEFAULT_SOCKET_PATH,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                     | GST_PARAM_MUTABLE_READY)));
+
+    gst_element_class_set_static_metadata(
+        gstelement_class,
+        "The Imaging Source TcamIpcSrc gstreamer element",
+        "Source/Video",
+        "Receives the buffers of a tcamipcsink in another process without copying",
+        "The Imaging Source <support@theimagingsource.com>");
+
+    gst_element_class_add_static_pad_template(gstelement_class, &src_template);
+
+    basesrc_class->start = GST_DEBUG_FUNCPTR(gst_tcamipcsrc_start);
+    basesrc_class->stop = GST_DEBUG_FUNCPTR(gst_tcamipcsrc_stop);
+    basesrc_class->negotiate = GST_DEBUG_FUNCPTR(gst_tcamipcsrc_negotiate);
+    basesrc_class->unlock = GST_DEBUG_FUNCPTR(gst_tcamipcsrc_unlock);
+    basesrc_class->unlock_stop = GST_DEBUG_FUNCPTR(gst_tcamipcsrc_unlock_stop);
+    pushsrc_class->create = GST_DEBUG_FUNCPTR(gst_tcamipcsrc_create);
+
+    GST_DEBUG_CATEGORY_INIT(gst_tcamipcsrc_debug_category, "tcamipcsrc", 0, "tcamipcsrc element");
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TCAMIPCSRC_H_INC_
+#define TCAMIPCSRC_H_INC_
+
+#include <gst/base/gstpushsrc.h>
+#include <gst/gst.h>
+
+namespace tcamipc
+{
+struct ipc_src_state;
+}
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_TCAMIPCSRC (gst_tcamipcsrc_get_type())
+#define GST_TCAMIPCSRC(obj) \
+    (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_TCAMIPCSRC, GstTcamIpcSrc))
+#define GST_TCAMIPCSRC_CLASS(klass) \
+    (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_TCAMIPCSRC, GstTcamIpcSrcClass))
+#define GST_IS_TCAMIPCSRC(obj)       (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_TCAMIPCSRC))
+#define GST_IS_TCAMIPCSRC_CLASS(obj) (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_TCAMIPCSRC))
+
+typedef struct GstTcamIpcSrc
+{
+    GstPushSrc base;
+
+    tcamipc::ipc_src_state* state_;
+
+} GstTcamIpcSrc;
+
+typedef struct GstTcamIpcSrcClass
+{
+    GstPushSrcClass base_class;
+} GstTcamIpcSrcClass;
+
+GType gst_tcamipcsrc_get_type(void);
+
+G_END_DECLS
+
+#endif /* TCAMIPCSRC_H_INC_ */
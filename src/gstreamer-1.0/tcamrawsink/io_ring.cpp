@@ -0,0 +1,244 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "io_ring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+
+int sys_io_uring_setup(unsigned entries, io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return static_cast<int>(
+        syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+#else
+
+int sys_io_uring_setup(unsigned /*entries*/, io_uring_params* /*params*/)
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+int sys_io_uring_enter(int /*fd*/, unsigned, unsigned, unsigned)
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+#endif
+
+template<typename T> T* ring_field(void* ring, uint32_t offset)
+{
+    return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+} // namespace
+
+
+std::unique_ptr<tcamrawsink::io_ring> tcamrawsink::io_ring::create(unsigned entries)
+{
+    io_uring_params params = {};
+    const int fd = sys_io_uring_setup(entries, &params);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<io_ring> ring(new io_ring);
+    ring->fd_ = fd;
+
+    ring->sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap)
+    {
+        ring->sq_size_ = std::max(ring->sq_size_, ring->cq_size_);
+    }
+
+    void* sq = mmap(nullptr,
+                    ring->sq_size_,
+                    PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE,
+                    fd,
+                    IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    ring->sq_ptr_ = sq;
+
+    if (single_mmap)
+    {
+        ring->cq_ptr_ = sq;
+        ring->cq_size_ = 0;
+    }
+    else
+    {
+        void* cq = mmap(nullptr,
+                        ring->cq_size_,
+                        PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE,
+                        fd,
+                        IORING_OFF_CQ_RING);
+        if (cq == MAP_FAILED)
+        {
+            return nullptr;
+        }
+        ring->cq_ptr_ = cq;
+    }
+
+    ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr,
+                      ring->sqes_size_,
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE,
+                      fd,
+                      IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        ring->sqes_size_ = 0;
+        return nullptr;
+    }
+    ring->sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    ring->sq_head_ = ring_field<unsigned>(sq, params.sq_off.head);
+    ring->sq_tail_ = ring_field<unsigned>(sq, params.sq_off.tail);
+    ring->sq_array_ = ring_field<unsigned>(sq, params.sq_off.array);
+    ring->sq_mask_ = *ring_field<unsigned>(sq, params.sq_off.ring_mask);
+    ring->sq_entries_ = *ring_field<unsigned>(sq, params.sq_off.ring_entries);
+
+    ring->cq_head_ = ring_field<unsigned>(ring->cq_ptr_, params.cq_off.head);
+    ring->cq_tail_ = ring_field<unsigned>(ring->cq_ptr_, params.cq_off.tail);
+    ring->cqes_ = ring_field<io_uring_cqe>(ring->cq_ptr_, params.cq_off.cqes);
+    ring->cq_mask_ = *ring_field<unsigned>(ring->cq_ptr_, params.cq_off.ring_mask);
+
+    return ring;
+}
+
+
+tcamrawsink::io_ring::~io_ring()
+{
+    if (sqes_)
+    {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ptr_ && cq_ptr_ != sq_ptr_)
+    {
+        munmap(cq_ptr_, cq_size_);
+    }
+    if (sq_ptr_)
+    {
+        munmap(sq_ptr_, sq_size_);
+    }
+    if (fd_ >= 0)
+    {
+        // pending operations hold their own file references and complete in the kernel
+        close(fd_);
+    }
+}
+
+
+bool tcamrawsink::io_ring::prepare_writev(int fd,
+                                          const iovec* iov,
+                                          unsigned count,
+                                          uint64_t offset,
+                                          uint64_t user_data) noexcept
+{
+    // only this thread moves the tail, the kernel moves the head
+    const unsigned tail = *sq_tail_;
+    const unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (tail - head >= sq_entries_)
+    {
+        return false;
+    }
+
+    const unsigned index = tail & sq_mask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_WRITEV;
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->addr = reinterpret_cast<uintptr_t>(iov);
+    sqe->len = count;
+    sqe->user_data = user_data;
+
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    pending_++;
+
+    return true;
+}
+
+
+int tcamrawsink::io_ring::submit(unsigned min_complete) noexcept
+{
+    if (pending_ == 0 && min_complete == 0)
+    {
+        return 0;
+    }
+
+    int ret = 0;
+    do
+    {
+        ret = sys_io_uring_enter(
+            fd_, pending_, min_complete, min_complete > 0 ? IORING_ENTER_GETEVENTS : 0);
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret < 0)
+    {
+        return -errno;
+    }
+
+    // the number of consumed submissions
+    pending_ -= std::min<unsigned>(ret, pending_);
+    return 0;
+}
+
+
+bool tcamrawsink::io_ring::pop_completion(uint64_t& user_data, int& result) noexcept
+{
+    // only this thread moves the head, the kernel moves the tail
+    const unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE))
+    {
+        return false;
+    }
+
+    const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+    user_data = cqe.user_data;
+    result = cqe.res;
+
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
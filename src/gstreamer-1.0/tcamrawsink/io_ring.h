@@ -0,0 +1,88 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <sys/uio.h>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace tcamrawsink
+{
+
+//
+// Minimal io_uring submission and completion ring, only what raw_writer needs.
+// Talks to the kernel through the syscalls, liburing is not required.
+// Not thread safe, submission and completion happen on the same thread.
+//
+class io_ring
+{
+public:
+    // nullptr when the kernel does not support io_uring or it is not permitted
+    static std::unique_ptr<io_ring> create(unsigned entries);
+
+    ~io_ring();
+
+    io_ring(const io_ring&) = delete;
+    io_ring& operator=(const io_ring&) = delete;
+
+    // Queues a writev, iov has to stay valid until the completion was popped.
+    // Returns false when the submission queue is full.
+    bool prepare_writev(int fd,
+                        const iovec* iov,
+                        unsigned count,
+                        uint64_t offset,
+                        uint64_t user_data) noexcept;
+
+    // Submits all queued entries and waits for at least min_complete completions.
+    // Returns 0 or a negative errno.
+    int submit(unsigned min_complete) noexcept;
+
+    // false when no completion is available
+    // result is the return value of the operation, e.g. the bytes written or a negative errno
+    bool pop_completion(uint64_t& user_data, int& result) noexcept;
+
+private:
+    io_ring() = default;
+
+    int fd_ = -1;
+
+    void* sq_ptr_ = nullptr;
+    size_t sq_size_ = 0;
+    void* cq_ptr_ = nullptr;
+    size_t cq_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned cq_mask_ = 0;
+
+    // prepared, but not yet submitted
+    unsigned pending_ = 0;
+};
+
+} // namespace tcamrawsink
@@ -0,0 +1,494 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "raw_writer.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+
+constexpr size_t align_up(size_t value, size_t alignment) noexcept
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+char* allocate_aligned(size_t size)
+{
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, tcamrawsink::record_alignment, size) != 0)
+    {
+        return nullptr;
+    }
+    return static_cast<char*>(ptr);
+}
+
+} // namespace
+
+
+tcamrawsink::raw_writer::~raw_writer()
+{
+    close();
+}
+
+
+std::string tcamrawsink::raw_writer::format_location(const std::string& pattern, uint64_t segment)
+{
+    std::string rval;
+    bool has_conversion = false;
+
+    for (size_t i = 0; i < pattern.size(); ++i)
+    {
+        if (pattern[i] != '%')
+        {
+            rval += pattern[i];
+            continue;
+        }
+        if (i + 1 < pattern.size() && pattern[i + 1] == '%')
+        {
+            rval += '%';
+            ++i;
+            continue;
+        }
+        if (has_conversion)
+        {
+            return {};
+        }
+
+        size_t pos = i + 1;
+        const bool zero_fill = pos < pattern.size() && pattern[pos] == '0';
+        if (zero_fill)
+        {
+            ++pos;
+        }
+        size_t width = 0;
+        while (pos < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[pos])))
+        {
+            width = width * 10 + static_cast<size_t>(pattern[pos] - '0');
+            if (width > 32)
+            {
+                return {};
+            }
+            ++pos;
+        }
+        if (pos >= pattern.size() || (pattern[pos] != 'd' && pattern[pos] != 'u'))
+        {
+            return {};
+        }
+
+        const auto number = std::to_string(segment);
+        if (number.size() < width)
+        {
+            rval.append(width - number.size(), zero_fill ? '0' : ' ');
+        }
+        rval += number;
+
+        has_conversion = true;
+        i = pos;
+    }
+    return rval;
+}
+
+
+void tcamrawsink::raw_writer::set_error(const std::string& what, int err)
+{
+    // the first error is the interesting one
+    if (!failed_)
+    {
+        error_ = err != 0 ? what + ": " + strerror(err) : what;
+    }
+    failed_ = true;
+}
+
+
+bool tcamrawsink::raw_writer::open(const raw_writer_config& config)
+{
+    close();
+
+    config_ = config;
+    stats_ = {};
+    error_.clear();
+    failed_ = false;
+
+    const auto first = format_location(config_.location, 0);
+    if (first.empty())
+    {
+        set_error("Invalid location '" + config_.location + "'", 0);
+        return false;
+    }
+    if (config_.segment_size > 0 && first == format_location(config_.location, 1))
+    {
+        set_error("Location '" + config_.location + "' needs a %d for the segment number", 0);
+        return false;
+    }
+
+    config_.queue_depth = std::max(config_.queue_depth, 1u);
+    slots_.resize(config_.queue_depth);
+    for (auto& slot : slots_)
+    {
+        slot.tail = allocate_aligned(record_alignment);
+        if (!slot.tail)
+        {
+            set_error("Unable to allocate write buffers", ENOMEM);
+            close();
+            return false;
+        }
+    }
+
+    ring_ = io_ring::create(config_.queue_depth);
+    stats_.io_uring = ring_ != nullptr;
+
+    segment_ = 0;
+    if (!open_segment())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+
+bool tcamrawsink::raw_writer::open_segment()
+{
+    const auto path = format_location(config_.location, segment_);
+
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    if (config_.direct_io)
+    {
+        fd_ = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        // e.g. tmpfs does not support O_DIRECT
+        stats_.direct_io = fd_ >= 0;
+    }
+    if (fd_ < 0)
+    {
+        stats_.direct_io = false;
+        fd_ = ::open(path.c_str(), flags, 0644);
+    }
+    if (fd_ < 0)
+    {
+        set_error("Unable to open '" + path + "'", errno);
+        return false;
+    }
+
+    if (config_.segment_size > 0
+        && fallocate(fd_, 0, 0, static_cast<off_t>(config_.segment_size)) != 0
+        && errno != EOPNOTSUPP && errno != ENOSYS)
+    {
+        // ENOSPC now is better than in the middle of the recording
+        set_error("Unable to preallocate '" + path + "'", errno);
+        return false;
+    }
+
+    const auto index_path = path + ".idx";
+    index_ = fopen(index_path.c_str(), "wbe");
+    if (!index_)
+    {
+        set_error("Unable to open '" + index_path + "'", errno);
+        return false;
+    }
+
+    index_header header = {};
+    memcpy(header.magic, index_magic, sizeof(header.magic));
+    header.version = index_version;
+    header.entry_size = sizeof(index_entry);
+    header.alignment = record_alignment;
+    header.caps_length = static_cast<uint32_t>(config_.caps.size());
+    header.segment = segment_;
+    header.compression = config_.compression;
+
+    if (fwrite(&header, sizeof(header), 1, index_) != 1
+        || fwrite(config_.caps.data(), 1, config_.caps.size(), index_) != config_.caps.size())
+    {
+        set_error("Unable to write '" + index_path + "'", errno);
+        return false;
+    }
+
+    offset_ = 0;
+    stats_.segments++;
+
+    return true;
+}
+
+
+bool tcamrawsink::raw_writer::finish_segment()
+{
+    bool ret = flush();
+
+    if (fd_ >= 0)
+    {
+        // drop the preallocated, unused space
+        if (ftruncate(fd_, static_cast<off_t>(offset_)) != 0)
+        {
+            set_error("Unable to truncate segment", errno);
+            ret = false;
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+    if (index_)
+    {
+        if (fclose(index_) != 0)
+        {
+            set_error("Unable to write index", errno);
+            ret = false;
+        }
+        index_ = nullptr;
+    }
+    return ret;
+}
+
+
+bool tcamrawsink::raw_writer::close()
+{
+    bool ret = finish_segment();
+
+    // closing the ring waits for and cancels what is left after an error
+    ring_.reset();
+    for (auto& slot : slots_)
+    {
+        if (slot.busy && slot.release)
+        {
+            slot.release(slot.user_data);
+        }
+        free(slot.tail);
+        free(slot.bounce);
+    }
+    slots_.clear();
+    in_flight_ = 0;
+
+    return ret && !failed_;
+}
+
+
+void tcamrawsink::raw_writer::complete(write_slot& slot, int result)
+{
+    if (result < 0)
+    {
+        set_error("Write failed", -result);
+    }
+    else if (static_cast<size_t>(result) != slot.expected)
+    {
+        // only happens when the disk is full
+        set_error("Short write", ENOSPC);
+    }
+
+    if (slot.release)
+    {
+        slot.release(slot.user_data);
+        slot.release = nullptr;
+    }
+    slot.busy = false;
+    in_flight_--;
+}
+
+
+bool tcamrawsink::raw_writer::reap(unsigned min_complete)
+{
+    if (!ring_)
+    {
+        return true;
+    }
+
+    // also submits what is still queued
+    if (int ret = ring_->submit(min_complete); ret < 0)
+    {
+        set_error("io_uring_enter failed", -ret);
+        return false;
+    }
+
+    uint64_t index = 0;
+    int result = 0;
+    while (ring_->pop_completion(index, result))
+    {
+        if (index < slots_.size() && slots_[index].busy)
+        {
+            complete(slots_[index], result);
+        }
+    }
+    return true;
+}
+
+
+tcamrawsink::raw_writer::write_slot* tcamrawsink::raw_writer::get_free_slot()
+{
+    while (true)
+    {
+        for (auto& slot : slots_)
+        {
+            if (!slot.busy)
+            {
+                return &slot;
+            }
+        }
+        // back pressure, the disk is slower than the camera
+        if (!reap(1))
+        {
+            return nullptr;
+        }
+    }
+}
+
+
+bool tcamrawsink::raw_writer::flush()
+{
+    while (in_flight_ > 0)
+    {
+        if (!reap(1))
+        {
+            return false;
+        }
+    }
+    if (index_ && fflush(index_) != 0)
+    {
+        set_error("Unable to write index", errno);
+    }
+    return !failed_;
+}
+
+
+bool tcamrawsink::raw_writer::write(const void* data,
+                                    size_t size,
+                                    const index_entry& entry,
+                                    release_fn release,
+                                    void* user_data)
+{
+    const size_t padded = align_up(size, record_alignment);
+
+    if (is_open() && !failed_ && config_.segment_size > 0 && offset_ > 0
+        && offset_ + padded > config_.segment_size)
+    {
+        if (finish_segment())
+        {
+            segment_++;
+            open_segment();
+        }
+    }
+
+    write_slot* slot = nullptr;
+    if (is_open() && !failed_)
+    {
+        slot = get_free_slot();
+    }
+    if (!slot)
+    {
+        if (release)
+        {
+            release(user_data);
+        }
+        return false;
+    }
+
+    auto bytes = static_cast<const char*>(data);
+    const bool aligned = reinterpret_cast<uintptr_t>(data) % record_alignment == 0;
+
+    slot->iov_count = 0;
+    if (!stats_.direct_io || aligned)
+    {
+        // buffered io takes any address, O_DIRECT needs whole blocks
+        const size_t prefix = stats_.direct_io ? size - size % record_alignment : size;
+        if (prefix > 0)
+        {
+            slot->iov[slot->iov_count++] = { const_cast<char*>(bytes), prefix };
+        }
+        if (padded > prefix)
+        {
+            const size_t rest = size - prefix;
+            memcpy(slot->tail, bytes + prefix, rest);
+            memset(slot->tail + rest, 0, padded - size);
+            slot->iov[slot->iov_count++] = { slot->tail, padded - prefix };
+        }
+        slot->release = release;
+        slot->user_data = user_data;
+    }
+    else
+    {
+        if (slot->bounce_size < padded)
+        {
+            free(slot->bounce);
+            slot->bounce = allocate_aligned(padded);
+            slot->bounce_size = slot->bounce ? padded : 0;
+            if (!slot->bounce)
+            {
+                set_error("Unable to allocate write buffers", ENOMEM);
+                if (release)
+                {
+                    release(user_data);
+                }
+                return false;
+            }
+        }
+        memcpy(slot->bounce, bytes, size);
+        memset(slot->bounce + size, 0, padded - size);
+        slot->iov[slot->iov_count++] = { slot->bounce, padded };
+
+        slot->release = nullptr;
+        if (release)
+        {
+            release(user_data);
+        }
+        stats_.copied++;
+    }
+
+    slot->expected = padded;
+    slot->busy = true;
+    in_flight_++;
+
+    const uint64_t offset = offset_;
+    const auto slot_index = static_cast<uint64_t>(slot - slots_.data());
+
+    if (ring_)
+    {
+        // the ring has at least queue_depth entries, this cannot fail
+        ring_->prepare_writev(fd_, slot->iov, slot->iov_count, offset, slot_index);
+        if (int ret = ring_->submit(0); ret < 0)
+        {
+            set_error("io_uring_enter failed", -ret);
+        }
+    }
+    else
+    {
+        ssize_t ret = 0;
+        do
+        {
+            ret = pwritev(
+                fd_, slot->iov, static_cast<int>(slot->iov_count), static_cast<off_t>(offset));
+        } while (ret < 0 && errno == EINTR);
+        complete(*slot, ret < 0 ? -errno : static_cast<int>(ret));
+    }
+
+    index_entry e = entry;
+    e.offset = offset;
+    e.size = static_cast<uint32_t>(size);
+    if (fwrite(&e, sizeof(e), 1, index_) != 1)
+    {
+        set_error("Unable to write index", errno);
+    }
+
+    offset_ += padded;
+    stats_.frames++;
+    stats_.bytes += size;
+
+    // hand finished buffers back as early as possible
+    reap(0);
+
+    return !failed_;
+}
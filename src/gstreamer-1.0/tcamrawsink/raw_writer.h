@@ -0,0 +1,207 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "io_ring.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <sys/uio.h>
+#include <vector>
+
+namespace tcamrawsink
+{
+
+//
+// Segment files contain the images back to back, every image starts at a multiple of
+// record_alignment and is zero padded to the next multiple.
+// Every segment has an index file (segment path + ".idx"), an index_header followed by the
+// caps string and one index_entry per image.
+// Images of recordings with record_compression::lossless are tcam::raw_codec streams,
+// the caps describe the decompressed image.
+//
+
+constexpr size_t record_alignment = 4096;
+
+constexpr char index_magic[8] = { 'T', 'C', 'A', 'M', 'R', 'I', 'D', 'X' };
+constexpr uint32_t index_version = 2;
+
+enum class record_compression : uint32_t
+{
+    none = 0,
+    lossless = 1,
+};
+
+struct index_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_size; // sizeof(index_entry)
+    uint32_t alignment; // record_alignment
+    uint32_t caps_length; // bytes of caps string following this header, without terminator
+    uint64_t segment;
+
+    // version 2
+    record_compression compression;
+    uint32_t reserved;
+};
+
+struct index_entry
+{
+    uint64_t offset; // of the image in the segment file
+    uint32_t size; // valid bytes of the image
+    uint32_t reserved;
+    uint64_t pts;
+    uint64_t frame_count;
+    uint64_t frames_dropped;
+    uint64_t capture_time_ns;
+    uint64_t camera_time_ns;
+};
+
+struct raw_writer_config
+{
+    // may contain one %d/%u conversion (flags and width allowed) for the segment number
+    std::string location;
+    // segments are rotated and preallocated to this size, 0 writes one file
+    uint64_t segment_size = 0;
+    // number of images that may be in flight
+    unsigned queue_depth = 16;
+    bool direct_io = true;
+    std::string caps;
+    // stored in the index, the writer does not compress
+    record_compression compression = record_compression::none;
+};
+
+struct raw_writer_statistics
+{
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    uint64_t segments = 0;
+    // images that could not be written from their own memory, e.g. because it is not aligned
+    uint64_t copied = 0;
+
+    bool direct_io = false;
+    bool io_uring = false;
+};
+
+//
+// Writes images with O_DIRECT, asynchronously through io_uring if available.
+// Falls back to pwritev when io_uring is not available and to buffered io
+// when the file system does not support O_DIRECT.
+//
+// Images whose start is aligned to record_alignment are written from their own memory,
+// only the unaligned tail is copied. The memory is handed back through the release callback
+// once the write completed. All other images are copied into a bounce buffer.
+//
+// Not thread safe.
+//
+class raw_writer
+{
+public:
+    using release_fn = void (*)(void* user_data);
+
+    raw_writer() = default;
+    ~raw_writer();
+
+    raw_writer(const raw_writer&) = delete;
+    raw_writer& operator=(const raw_writer&) = delete;
+
+    // false on error, see get_error
+    bool open(const raw_writer_config& config);
+
+    // data has to stay valid until release was called, which may happen before write returns
+    // release is called even when write fails
+    // entry.offset and entry.size are set by the writer
+    bool write(const void* data,
+               size_t size,
+               const index_entry& entry,
+               release_fn release,
+               void* user_data);
+
+    // waits for all pending writes and flushes the index
+    bool flush();
+
+    // flushes and closes the current segment
+    bool close();
+
+    bool is_open() const noexcept
+    {
+        return fd_ >= 0;
+    }
+
+    const std::string& get_error() const noexcept
+    {
+        return error_;
+    }
+
+    const raw_writer_statistics& get_statistics() const noexcept
+    {
+        return stats_;
+    }
+
+    // Returns an empty string when pattern is not a valid location.
+    static std::string format_location(const std::string& pattern, uint64_t segment);
+
+private:
+    struct write_slot
+    {
+        bool busy = false;
+
+        iovec iov[2] = {};
+        unsigned iov_count = 0;
+        size_t expected = 0;
+
+        release_fn release = nullptr;
+        void* user_data = nullptr;
+
+        // record_alignment bytes for the unaligned tail of an image
+        char* tail = nullptr;
+        // copy of the whole image
+        char* bounce = nullptr;
+        size_t bounce_size = 0;
+    };
+
+    bool open_segment();
+    bool finish_segment();
+
+    // reaps completions, waits until at least min_complete arrived
+    bool reap(unsigned min_complete);
+    void complete(write_slot& slot, int result);
+    write_slot* get_free_slot();
+
+    void set_error(const std::string& what, int err);
+
+    raw_writer_config config_;
+    raw_writer_statistics stats_;
+    std::string error_;
+    bool failed_ = false;
+
+    int fd_ = -1;
+    FILE* index_ = nullptr;
+    uint64_t segment_ = 0;
+    uint64_t offset_ = 0;
+
+    std::unique_ptr<io_ring> ring_;
+    std::vector<write_slot> slots_;
+    unsigned in_flight_ = 0;
+};
+
+} // namespace tcamrawsink
@@ -0,0 +1,716 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tcamrawsink.h"
+
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamframe.h"
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
+#include "../../RawCodec.h"
+#include "../../version.h"
+#include "raw_writer.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <gst-helper/gstcaps_dutils_interop.h>
+#include <string>
+#include <vector>
+
+GST_DEBUG_CATEGORY_STATIC(gst_tcamrawsink_debug_category);
+#define GST_CAT_DEFAULT gst_tcamrawsink_debug_category
+
+#define gst_tcamrawsink_parent_class parent_class
+G_DEFINE_TYPE(GstTcamRawSink, gst_tcamrawsink, GST_TYPE_BASE_SINK)
+
+enum
+{
+    PROP_0,
+    PROP_LOCATION,
+    PROP_SEGMENT_SIZE,
+    PROP_QUEUE_DEPTH,
+    PROP_DIRECT_IO,
+    PROP_COMPRESSION,
+    PROP_FRAMES,
+    PROP_COPIED,
+};
+
+#define TCAMRAWSINK_DEFAULT_LOCATION     "tcamraw-%05d.raw"
+#define TCAMRAWSINK_DEFAULT_SEGMENT_SIZE (G_GUINT64_CONSTANT(4) * 1024 * 1024 * 1024)
+#define TCAMRAWSINK_DEFAULT_QUEUE_DEPTH  4
+#define TCAMRAWSINK_DEFAULT_DIRECT_IO    TRUE
+#define TCAMRAWSINK_DEFAULT_COMPRESSION  GST_TCAMRAWSINK_COMPRESSION_NONE
+
+
+namespace tcamrawsink
+{
+
+struct compressed_buffer;
+
+struct raw_sink_state
+{
+    std::string location = TCAMRAWSINK_DEFAULT_LOCATION;
+    guint64 segment_size = TCAMRAWSINK_DEFAULT_SEGMENT_SIZE;
+    guint queue_depth = TCAMRAWSINK_DEFAULT_QUEUE_DEPTH;
+    bool direct_io = TCAMRAWSINK_DEFAULT_DIRECT_IO;
+    GstTcamRawSinkCompression compression = TCAMRAWSINK_DEFAULT_COMPRESSION;
+
+    raw_writer writer;
+    std::string caps;
+
+    // set while the images are compressed, the format of the caps
+    img::img_type compressed_type = {};
+    size_t compressed_capacity = 0;
+    // compressed_buffers whose write completed
+    std::vector<compressed_buffer*> free_compressed;
+
+    std::atomic<guint64> frames = 0;
+    std::atomic<guint64> copied = 0;
+};
+
+// upstream buffer that is written from its own memory, released once the write completed
+struct mapped_buffer
+{
+    GstBuffer* buffer = nullptr;
+    GstMapInfo info = {};
+};
+
+// page aligned memory of a compressed image, returns to free_compressed once written
+struct compressed_buffer
+{
+    raw_sink_state* state = nullptr;
+    void* data = nullptr;
+};
+
+} // namespace tcamrawsink
+
+
+GType gst_tcamrawsink_compression_get_type(void)
+{
+    static GType tcamrawsink_compression = 0;
+
+    if (!tcamrawsink_compression)
+    {
+        static const GEnumValue compressions[] = {
+            { GST_TCAMRAWSINK_COMPRESSION_NONE, "GST_TCAMRAWSINK_COMPRESSION_NONE", "none" },
+            { GST_TCAMRAWSINK_COMPRESSION_LOSSLESS,
+              "GST_TCAMRAWSINK_COMPRESSION_LOSSLESS",
+              "lossless" },
+
+            { 0, NULL, NULL }
+        };
+        tcamrawsink_compression =
+            g_enum_register_static("GstTcamRawSinkCompression", compressions);
+    }
+    return tcamrawsink_compression;
+}
+
+
+static tcamrawsink::raw_sink_state& get_state(GstTcamRawSink* self)
+{
+    return *self->state_;
+}
+
+
+static void release_mapped_buffer(void* user_data)
+{
+    auto mapped = static_cast<tcamrawsink::mapped_buffer*>(user_data);
+
+    gst_buffer_unmap(mapped->buffer, &mapped->info);
+    gst_buffer_unref(mapped->buffer);
+    delete mapped;
+}
+
+
+static void release_compressed_buffer(void* user_data)
+{
+    auto buffer = static_cast<tcamrawsink::compressed_buffer*>(user_data);
+
+    buffer->state->free_compressed.push_back(buffer);
+}
+
+
+static void free_compressed_buffers(tcamrawsink::raw_sink_state& state)
+{
+    for (auto buffer : state.free_compressed)
+    {
+        free(buffer->data);
+        delete buffer;
+    }
+    state.free_compressed.clear();
+    state.compressed_capacity = 0;
+}
+
+
+static tcamrawsink::compressed_buffer* get_compressed_buffer(tcamrawsink::raw_sink_state& state)
+{
+    if (!state.free_compressed.empty())
+    {
+        auto buffer = state.free_compressed.back();
+        state.free_compressed.pop_back();
+        return buffer;
+    }
+
+    void* data = nullptr;
+    if (posix_memalign(&data, tcamrawsink::record_alignment, state.compressed_capacity) != 0)
+    {
+        return nullptr;
+    }
+    return new tcamrawsink::compressed_buffer { &state, data };
+}
+
+
+// the compressed size varies, so compression needs the image format of the caps
+static void setup_compression(GstTcamRawSink* self,
+                              tcamrawsink::raw_sink_state& state,
+                              const GstCaps& caps)
+{
+    state.compressed_type = {};
+    if (state.compression != GST_TCAMRAWSINK_COMPRESSION_LOSSLESS)
+    {
+        return;
+    }
+
+    const auto type = gst_helper::get_img_type_from_fixated_gstcaps(caps);
+    const size_t max_size = tcam::raw_codec::calc_max_compressed_size(type);
+    if (max_size == 0)
+    {
+        GST_WARNING_OBJECT(self, "Format can not be compressed, recording uncompressed images.");
+        return;
+    }
+
+    state.compressed_type = type;
+    const size_t capacity = (max_size + tcamrawsink::record_alignment - 1)
+                            / tcamrawsink::record_alignment * tcamrawsink::record_alignment;
+    if (capacity != state.compressed_capacity)
+    {
+        free_compressed_buffers(state);
+        state.compressed_capacity = capacity;
+    }
+}
+
+
+static bool open_writer(GstTcamRawSink* self, tcamrawsink::raw_sink_state& state)
+{
+    tcamrawsink::raw_writer_config config;
+    config.location = state.location;
+    config.segment_size = state.segment_size;
+    config.queue_depth = state.queue_depth;
+    config.direct_io = state.direct_io;
+    config.caps = state.caps;
+    config.compression = state.compressed_type.empty() ? tcamrawsink::record_compression::none
+                                                       : tcamrawsink::record_compression::lossless;
+
+    if (!state.writer.open(config))
+    {
+        GST_ELEMENT_ERROR(self,
+                          RESOURCE,
+                          OPEN_WRITE,
+                          ("Unable to open '%s'", state.location.c_str()),
+                          ("%s", state.writer.get_error().c_str()));
+        return false;
+    }
+
+    const auto& stats = state.writer.get_statistics();
+    if (state.direct_io && !stats.direct_io)
+    {
+        GST_WARNING_OBJECT(self, "O_DIRECT is not supported for '%s', using buffered io.",
+                           state.location.c_str());
+    }
+    if (!stats.io_uring)
+    {
+        GST_WARNING_OBJECT(self, "io_uring is not available, writing synchronously.");
+    }
+    GST_INFO_OBJECT(self,
+                    "Recording to '%s' direct-io=%d io_uring=%d compressed=%d",
+                    state.location.c_str(),
+                    stats.direct_io,
+                    stats.io_uring,
+                    !state.compressed_type.empty());
+
+    return true;
+}
+
+
+static gboolean gst_tcamrawsink_start(GstBaseSink* sink)
+{
+    auto& state = get_state(GST_TCAMRAWSINK(sink));
+
+    state.caps.clear();
+    state.frames = 0;
+    state.copied = 0;
+
+    return TRUE;
+}
+
+
+static gboolean gst_tcamrawsink_stop(GstBaseSink* sink)
+{
+    GstTcamRawSink* self = GST_TCAMRAWSINK(sink);
+    auto& state = get_state(self);
+
+    if (state.writer.is_open() && !state.writer.close())
+    {
+        GST_ELEMENT_ERROR(self,
+                          RESOURCE,
+                          WRITE,
+                          ("Recording to '%s' is incomplete", state.location.c_str()),
+                          ("%s", state.writer.get_error().c_str()));
+    }
+    // all writes completed, every compressed buffer is free again
+    free_compressed_buffers(state);
+
+    return TRUE;
+}
+
+
+static gboolean gst_tcamrawsink_set_caps(GstBaseSink* sink, GstCaps* caps)
+{
+    GstTcamRawSink* self = GST_TCAMRAWSINK(sink);
+    auto& state = get_state(self);
+
+    gchar* str = gst_caps_to_string(caps);
+    std::string new_caps = str;
+    g_free(str);
+
+    if (state.writer.is_open())
+    {
+        // the caps are part of the index, a new format would need a new recording
+        if (new_caps != state.caps)
+        {
+            GST_ERROR_OBJECT(self, "Caps can not change during a recording.");
+            return FALSE;
+        }
+        return TRUE;
+    }
+
+    state.caps = new_caps;
+    setup_compression(self, state, *caps);
+
+    return open_writer(self, state);
+}
+
+
+static tcamrawsink::index_entry create_index_entry(GstBuffer* buffer)
+{
+    tcamrawsink::index_entry entry = {};
+    entry.pts = GST_BUFFER_PTS(buffer);
+
+    if (auto frame_meta = gst_buffer_get_tcam_frame_meta(buffer))
+    {
+        entry.frame_count = frame_meta->data.frame_count;
+        entry.frames_dropped = frame_meta->data.frames_dropped;
+        entry.capture_time_ns = frame_meta->data.capture_time_ns;
+        entry.camera_time_ns = frame_meta->data.camera_time_ns;
+    }
+    else if (auto meta = gst_buffer_get_tcam_statistics_meta(buffer); meta && meta->structure)
+    {
+        guint64 value = 0;
+        if (gst_structure_get_uint64(meta->structure, "frame_count", &value))
+        {
+            entry.frame_count = value;
+        }
+        if (gst_structure_get_uint64(meta->structure, "frames_dropped", &value))
+        {
+            entry.frames_dropped = value;
+        }
+        if (gst_structure_get_uint64(meta->structure, "capture_time_ns", &value))
+        {
+            entry.capture_time_ns = value;
+        }
+        if (gst_structure_get_uint64(meta->structure, "camera_time_ns", &value))
+        {
+            entry.camera_time_ns = value;
+        }
+    }
+    return entry;
+}
+
+
+// writes the image from the memory of buffer, which is held until the write completed
+static bool write_mapped(GstTcamRawSink* self,
+                         tcamrawsink::raw_sink_state& state,
+                         GstBuffer* buffer,
+                         const tcamrawsink::index_entry& entry)
+{
+    auto mapped = new tcamrawsink::mapped_buffer;
+    if (!gst_buffer_map(buffer, &mapped->info, GST_MAP_READ))
+    {
+        delete mapped;
+        GST_ELEMENT_ERROR(self, RESOURCE, READ, ("Unable to map buffer"), (nullptr));
+        return false;
+    }
+    // held until the write completed, tcamsrc camera-buffers has to be larger than queue-depth
+    mapped->buffer = gst_buffer_ref(buffer);
+
+    if (!state.writer.write(
+            mapped->info.data, mapped->info.size, entry, release_mapped_buffer, mapped))
+    {
+        GST_ELEMENT_ERROR(self,
+                          RESOURCE,
+                          WRITE,
+                          ("Unable to write to '%s'", state.location.c_str()),
+                          ("%s", state.writer.get_error().c_str()));
+        return false;
+    }
+    return true;
+}
+
+
+// compresses the image into a page aligned buffer, buffer itself is released right away
+static bool write_compressed(GstTcamRawSink* self,
+                             tcamrawsink::raw_sink_state& state,
+                             GstBuffer* buffer,
+                             const tcamrawsink::index_entry& entry)
+{
+    auto compressed = get_compressed_buffer(state);
+    if (!compressed)
+    {
+        GST_ELEMENT_ERROR(self, RESOURCE, NO_SPACE_LEFT, ("Unable to allocate memory"), (nullptr));
+        return false;
+    }
+
+    GstMapInfo info = {};
+    if (!gst_buffer_map(buffer, &info, GST_MAP_READ))
+    {
+        release_compressed_buffer(compressed);
+        GST_ELEMENT_ERROR(self, RESOURCE, READ, ("Unable to map buffer"), (nullptr));
+        return false;
+    }
+
+    size_t size = 0;
+    if (info.size >= static_cast<size_t>(state.compressed_type.buffer_length))
+    {
+        const auto src = img::make_img_desc_from_linear_memory(state.compressed_type, info.data);
+        size = tcam::raw_codec::compress(src, compressed->data, state.compressed_capacity);
+    }
+    gst_buffer_unmap(buffer, &info);
+
+    if (size == 0)
+    {
+        release_compressed_buffer(compressed);
+        GST_ELEMENT_ERROR(self, STREAM, ENCODE, ("Unable to compress the image"), (nullptr));
+        return false;
+    }
+
+    if (!state.writer.write(compressed->data, size, entry, release_compressed_buffer, compressed))
+    {
+        GST_ELEMENT_ERROR(self,
+                          RESOURCE,
+                          WRITE,
+                          ("Unable to write to '%s'", state.location.c_str()),
+                          ("%s", state.writer.get_error().c_str()));
+        return false;
+    }
+    return true;
+}
+
+
+static GstFlowReturn gst_tcamrawsink_render(GstBaseSink* sink, GstBuffer* buffer)
+{
+    GstTcamRawSink* self = GST_TCAMRAWSINK(sink);
+    auto& state = get_state(self);
+
+    if (!state.writer.is_open())
+    {
+        GST_ELEMENT_ERROR(self, CORE, NEGOTIATION, ("No caps before the first buffer"), (nullptr));
+        return GST_FLOW_NOT_NEGOTIATED;
+    }
+
+    const auto entry = create_index_entry(buffer);
+
+    const bool ret = state.compressed_type.empty() ? write_mapped(self, state, buffer, entry)
+                                                   : write_compressed(self, state, buffer, entry);
+
+    const auto& stats = state.writer.get_statistics();
+    state.frames = stats.frames;
+    state.copied = stats.copied;
+
+    return ret ? GST_FLOW_OK : GST_FLOW_ERROR;
+}
+
+
+static gboolean gst_tcamrawsink_event(GstBaseSink* sink, GstEvent* event)
+{
+    GstTcamRawSink* self = GST_TCAMRAWSINK(sink);
+    auto& state = get_state(self);
+
+    if (GST_EVENT_TYPE(event) == GST_EVENT_EOS && state.writer.is_open()
+        && !state.writer.flush())
+    {
+        GST_ELEMENT_ERROR(self,
+                          RESOURCE,
+                          WRITE,
+                          ("Unable to write to '%s'", state.location.c_str()),
+                          ("%s", state.writer.get_error().c_str()));
+    }
+
+    return GST_BASE_SINK_CLASS(gst_tcamrawsink_parent_class)->event(sink, event);
+}
+
+
+static void gst_tcamrawsink_set_property(GObject* object,
+                                         guint property_id,
+                                         const GValue* value,
+                                         GParamSpec* pspec)
+{
+    auto& state = get_state(GST_TCAMRAWSINK(object));
+
+    switch (property_id)
+    {
+        case PROP_LOCATION:
+        {
+            const char* str = g_value_get_string(value);
+            state.location = str ? str : "";
+            break;
+        }
+        case PROP_SEGMENT_SIZE:
+        {
+            state.segment_size = g_value_get_uint64(value);
+            break;
+        }
+        case PROP_QUEUE_DEPTH:
+        {
+            state.queue_depth = g_value_get_uint(value);
+            break;
+        }
+        case PROP_DIRECT_IO:
+        {
+            state.direct_io = g_value_get_boolean(value);
+            break;
+        }
+        case PROP_COMPRESSION:
+        {
+            state.compression = static_cast<GstTcamRawSinkCompression>(g_value_get_enum(value));
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static void gst_tcamrawsink_get_property(GObject* object,
+                                         guint property_id,
+                                         GValue* value,
+                                         GParamSpec* pspec)
+{
+    auto& state = get_state(GST_TCAMRAWSINK(object));
+
+    switch (property_id)
+    {
+        case PROP_LOCATION:
+        {
+            g_value_set_string(value, state.location.c_str());
+            break;
+        }
+        case PROP_SEGMENT_SIZE:
+        {
+            g_value_set_uint64(value, state.segment_size);
+            break;
+        }
+        case PROP_QUEUE_DEPTH:
+        {
+            g_value_set_uint(value, state.queue_depth);
+            break;
+        }
+        case PROP_DIRECT_IO:
+        {
+            g_value_set_boolean(value, state.direct_io);
+            break;
+        }
+        case PROP_COMPRESSION:
+        {
+            g_value_set_enum(value, state.compression);
+            break;
+        }
+        case PROP_FRAMES:
+        {
+            g_value_set_uint64(value, state.frames);
+            break;
+        }
+        case PROP_COPIED:
+        {
+            g_value_set_uint64(value, state.copied);
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static GstStaticPadTemplate sink_template =
+    GST_STATIC_PAD_TEMPLATE("sink", GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+
+static void gst_tcamrawsink_init(GstTcamRawSink* self)
+{
+    self->state_ = new tcamrawsink::raw_sink_state;
+
+    // recordings are written as fast as possible
+    gst_base_sink_set_sync(GST_BASE_SINK(self), FALSE);
+    // last-sample would keep one more buffer of the source pool
+    gst_base_sink_set_last_sample_enabled(GST_BASE_SINK(self), FALSE);
+}
+
+
+static void gst_tcamrawsink_finalize(GObject* object)
+{
+    free_compressed_buffers(*GST_TCAMRAWSINK(object)->state_);
+    delete GST_TCAMRAWSINK(object)->state_;
+
+    G_OBJECT_CLASS(gst_tcamrawsink_parent_class)->finalize(object);
+}
+
+
+static void gst_tcamrawsink_class_init(GstTcamRawSinkClass* klass)
+{
+    GObjectClass* gobject_class = (GObjectClass*)klass;
+    GstElementClass* gstelement_class = (GstElementClass*)klass;
+    GstBaseSinkClass* basesink_class = GST_BASE_SINK_CLASS(klass);
+
+    gobject_class->set_property = gst_tcamrawsink_set_property;
+    gobject_class->get_property = gst_tcamrawsink_get_property;
+    gobject_class->finalize = gst_tcamrawsink_finalize;
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_LOCATION,
+        g_param_spec_string("location",
+                            "Location",
+                            "Path of the segment files, a %d is replaced with the segment number",
+                            TCAMRAWSINK_DEFAULT_LOCATION,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                     | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_SEGMENT_SIZE,
+        g_param_spec_uint64("segment-size",
+                            "Segment size",
+                            "Size in bytes every segment file is preallocated to, "
+                            "a new segment is started when the next image does not fit. "
+                            "0 writes a single file without preallocation",
+                            0,
+                            G_MAXUINT64,
+                            TCAMRAWSINK_DEFAULT_SEGMENT_SIZE,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                     | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_QUEUE_DEPTH,
+        g_param_spec_uint("queue-depth",
+                          "Queue depth",
+                          "Number of images that may be written at the same time, "
+                          "has to be smaller than the number of buffers of the source",
+                          1,
+                          256,
+                          TCAMRAWSINK_DEFAULT_QUEUE_DEPTH,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                   | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DIRECT_IO,
+        g_param_spec_boolean("direct-io",
+                             "Direct io",
+                             "Bypass the page cache with O_DIRECT, "
+                             "buffered io is used when the file system does not support it",
+                             TCAMRAWSINK_DEFAULT_DIRECT_IO,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                      | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_COMPRESSION,
+        g_param_spec_enum("compression",
+                          "Compression",
+                          "Compress every image losslessly before writing it, "
+                          "for raw mono and bayer formats",
+                          GST_TYPE_TCAMRAWSINK_COMPRESSION,
+                          TCAMRAWSINK_DEFAULT_COMPRESSION,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+                                                   | GST_PARAM_MUTABLE_READY)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_FRAMES,
+        g_param_spec_uint64("frames",
+                            "Frames",
+                            "Number of images that were recorded",
+                            0,
+                            G_MAXUINT64,
+                            0,
+                            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_COPIED,
+        g_param_spec_uint64("copied",
+                            "Copied",
+                            "Number of images that had to be copied before writing "
+                            "because their memory is not page aligned",
+                            0,
+                            G_MAXUINT64,
+                            0,
+                            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    gst_element_class_set_static_metadata(
+        gstelement_class,
+        "The Imaging Source TcamRawSink gstreamer element",
+        "Sink/File",
+        "Records raw images with O_DIRECT and io_uring",
+        "The Imaging Source <support@theimagingsource.com>");
+
+    gst_element_class_add_static_pad_template(gstelement_class, &sink_template);
+
+    basesink_class->start = GST_DEBUG_FUNCPTR(gst_tcamrawsink_start);
+    basesink_class->stop = GST_DEBUG_FUNCPTR(gst_tcamrawsink_stop);
+    basesink_class->set_caps = GST_DEBUG_FUNCPTR(gst_tcamrawsink_set_caps);
+    basesink_class->render = GST_DEBUG_FUNCPTR(gst_tcamrawsink_render);
+    basesink_class->event = GST_DEBUG_FUNCPTR(gst_tcamrawsink_event);
+
+    GST_DEBUG_CATEGORY_INIT(
+        gst_tcamrawsink_debug_category, "tcamrawsink", 0, "tcamrawsink element");
+}
+
+
+static gboolean plugin_init(GstPlugin* plugin)
+{
+    return gst_element_register(plugin, "tcamrawsink", GST_RANK_NONE, GST_TYPE_TCAMRAWSINK);
+}
+
+#ifndef PACKAGE
+#define PACKAGE "tcamrawsink"
+#endif
+#ifndef PACKAGE_NAME
+#define PACKAGE_NAME "tcamrawsink"
+#endif
+#ifndef GST_PACKAGE_ORIGIN
+#define GST_PACKAGE_ORIGIN "https://github.com/TheImagingSource/tiscamera"
+#endif
+
+
+GST_PLUGIN_DEFINE(GST_VERSION_MAJOR,
+                  GST_VERSION_MINOR,
+                  tcamrawsink,
+                  "The Imaging Source tcamrawsink plugin",
+                  plugin_init,
+                  get_version(),
+                  "Proprietary",
+                  PACKAGE_NAME,
+                  GST_PACKAGE_ORIGIN)
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TCAMRAWSINK_H_INC_
+#define TCAMRAWSINK_H_INC_
+
+#include <gst/base/gstbasesink.h>
+#include <gst/gst.h>
+
+namespace tcamrawsink
+{
+struct raw_sink_state;
+}
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+    GST_TCAMRAWSINK_COMPRESSION_NONE,
+    GST_TCAMRAWSINK_COMPRESSION_LOSSLESS,
+} GstTcamRawSinkCompression;
+
+GType gst_tcamrawsink_compression_get_type(void);
+#define GST_TYPE_TCAMRAWSINK_COMPRESSION (gst_tcamrawsink_compression_get_type())
+
+#define GST_TYPE_TCAMRAWSINK (gst_tcamrawsink_get_type())
+#define GST_TCAMRAWSINK(obj) \
+    (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_TCAMRAWSINK, GstTcamRawSink))
+#define GST_TCAMRAWSINK_CLASS(klass) \
+    (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_TCAMRAWSINK, GstTcamRawSinkClass))
+#define GST_IS_TCAMRAWSINK(obj)       (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_TCAMRAWSINK))
+#define GST_IS_TCAMRAWSINK_CLASS(obj) (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_TCAMRAWSINK))
+
+typedef struct GstTcamRawSink
+{
+    GstBaseSink base;
+
+    tcamrawsink::raw_sink_state* state_;
+
+} GstTcamRawSink;
+
+typedef struct GstTcamRawSinkClass
+{
+    GstBaseSinkClass base_class;
+} GstTcamRawSinkClass;
+
+GType gst_tcamrawsink_get_type(void);
+
+G_END_DECLS
+
+#endif /* TCAMRAWSINK_H_INC_ */
@@ -16,14 +16,52 @@
 
 #include "gsttcambufferpool.h"
 
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamframe.h"
 #include "../../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
 #include "gst/gstbufferpool.h"
+#include "../../BufferBudget.h"
+#include "../../CompressedBufferSize.h"
+#include "../../CudaHostAllocator.h"
+#include "../../MemfdAllocator.h"
+#include "../../tracepoints.h"
 #include "gsttcammainsrc.h"
 #include "mainsrc_device_state.h"
 
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <gst/allocators/gstdmabuf.h>
+#include <gst/allocators/gstfdmemory.h>
+#include <gst/video/gstvideometa.h>
+#include <gst/video/video-info.h>
+#include <unistd.h> // dup
+
 struct tcam_pool_state
 {
     std::vector<tcam::mainsrc::buffer_info> buffer;
+
+    // wraps exported dmabuf fds into GstDmaBufMemory
+    GstAllocator* dmabuf_allocator = nullptr;
+    // wraps memfd fds into GstFdMemory, see io-mode memfd
+    GstAllocator* fd_allocator = nullptr;
+
+    // buffers acquired from other_pool_ for dmabuf import
+    // they own the memory the tcam buffers are mapped to, indexed by pool slot
+    std::vector<GstBuffer*> imported_buffer;
+
+    // queue entries for copies made by starvation-policy=grow-pool
+    // the device thread claims a free entry, the streaming thread releases it in acquire_buffer
+    std::vector<tcam::mainsrc::buffer_info> extra_buffer;
+    std::unique_ptr<std::atomic<bool>[]> extra_in_use;
+    // copies alive downstream, shared with the copies because they may outlive the pool
+    std::shared_ptr<std::atomic<size_t>> extra_alive = std::make_shared<std::atomic<size_t>>(0);
+    // with camera-buffers=0 every copy reserves this many bytes of the tcam::buffer_budget
+    size_t extra_budget_bytes = 0;
+
+    // format for the GstVideoMeta of strided images
+    // bayer caps have no GstVideoFormat, downstream elements only read the stride from the meta
+    GstVideoFormat video_format = GST_VIDEO_FORMAT_ENCODED;
 };
 
 #define GST_CAT_DEFAULT tcam_mainsrc_debug
@@ -32,6 +70,41 @@ struct tcam_pool_state
 G_DEFINE_TYPE(GstTcamBufferPool, gst_tcam_buffer_pool, GST_TYPE_BUFFER_POOL)
 
 
+// libtcam stage times of the image, see tcam::timing
+static void stage_timing_to_gst_structure(const tcam::ImageBuffer& buffer, GstStructure& struc)
+{
+    if (!tcam::timing::is_enabled())
+    {
+        return;
+    }
+
+    using tcam::timing::stage;
+    const auto& timing = buffer.get_stage_timing();
+
+    gst_structure_set(&struc,
+                      "stream_id",
+                      G_TYPE_UINT,
+                      buffer.get_stream_id(),
+                      "stage_backend_dequeue_ns",
+                      G_TYPE_UINT64,
+                      timing[stage::backend_dequeue],
+                      "stage_push_image_enter_ns",
+                      G_TYPE_UINT64,
+                      timing[stage::push_image_enter],
+                      "stage_push_image_exit_ns",
+                      G_TYPE_UINT64,
+                      timing[stage::push_image_exit],
+                      "stage_pool_callback_ns",
+                      G_TYPE_UINT64,
+                      timing[stage::pool_callback],
+                      // set in acquire_buffer, the structure is reused for every image
+                      "stage_create_return_ns",
+                      G_TYPE_UINT64,
+                      G_GUINT64_CONSTANT(0),
+                      nullptr);
+}
+
+
 static void statistics_to_gst_structure(const tcam::tcam_stream_statistics& stat,
                                         GstStructure& struc)
 {
@@ -80,15 +153,556 @@ static void statistics_to_gst_structure(const tcam::tcam_stream_statistics& stat
                       "is_damaged",
                       G_TYPE_BOOLEAN,
                       stat.is_damaged,
+                      "resent_packets",
+                      G_TYPE_UINT64,
+                      stat.resent_packets,
+                      "missing_packets",
+                      G_TYPE_UINT64,
+                      stat.missing_packets,
+                      "underruns",
+                      G_TYPE_UINT64,
+                      stat.underruns,
+                      "receive_duration_ns",
+                      G_TYPE_UINT64,
+                      stat.receive_duration_ns,
+                      "roi_id",
+                      G_TYPE_UINT,
+                      (guint)stat.roi_id,
+                      "roi_offset_x",
+                      G_TYPE_UINT,
+                      (guint)stat.roi_offset_x,
+                      "roi_offset_y",
+                      G_TYPE_UINT,
+                      (guint)stat.roi_offset_y,
                       nullptr);
+
+    // the structure is reused for every image
+    if (stat.trigger_issue_time_ns != 0)
+    {
+        gst_structure_set(&struc,
+                          "trigger_issue_time_ns",
+                          G_TYPE_UINT64,
+                          stat.trigger_issue_time_ns,
+                          "trigger_arrival_time_ns",
+                          G_TYPE_UINT64,
+                          stat.trigger_arrival_time_ns,
+                          nullptr);
+    }
+    else
+    {
+        gst_structure_remove_fields(
+            &struc, "trigger_issue_time_ns", "trigger_arrival_time_ns", nullptr);
+    }
+
+    if (stat.parameter_set_id != 0)
+    {
+        gst_structure_set(
+            &struc, "parameter_set_id", G_TYPE_UINT, (guint)stat.parameter_set_id, nullptr);
+    }
+    else
+    {
+        gst_structure_remove_field(&struc, "parameter_set_id");
+    }
+
+    if (stat.ptp_time_ns != 0)
+    {
+        gst_structure_set(&struc, "ptp_time_ns", G_TYPE_UINT64, stat.ptp_time_ns, nullptr);
+    }
+    else
+    {
+        gst_structure_remove_field(&struc, "ptp_time_ns");
+    }
+
+    if (stat.missing_lines != 0)
+    {
+        gst_structure_set(&struc, "missing_lines", G_TYPE_UINT, (guint)stat.missing_lines, nullptr);
+    }
+    else
+    {
+        gst_structure_remove_field(&struc, "missing_lines");
+    }
+
+    if (stat.hdr_bracket_count != 0)
+    {
+        gst_structure_set(&struc,
+                          "hdr_bracket_index",
+                          G_TYPE_UINT,
+                          (guint)stat.hdr_bracket_index,
+                          "hdr_bracket_count",
+                          G_TYPE_UINT,
+                          (guint)stat.hdr_bracket_count,
+                          "hdr_exposure_time",
+                          G_TYPE_DOUBLE,
+                          stat.hdr_exposure_us,
+                          nullptr);
+    }
+    else
+    {
+        gst_structure_remove_fields(
+            &struc, "hdr_bracket_index", "hdr_bracket_count", "hdr_exposure_time", nullptr);
+    }
 }
 
 
-static void gst_tcam_buffer_pool_sh_callback(std::shared_ptr<tcam::ImageBuffer> buffer, void* data)
+// The structure is reused for every image, so fields of chunks that were not sent are removed
+static void chunk_data_to_gst_structure(const tcam::tcam_chunk_data& data, GstStructure& struc)
+{
+    if (data.has_exposure_time)
+    {
+        gst_structure_set(
+            &struc, "chunk_exposure_time", G_TYPE_DOUBLE, data.exposure_time_us, nullptr);
+    }
+    else
+    {
+        gst_structure_remove_field(&struc, "chunk_exposure_time");
+    }
+
+    if (data.has_gain)
+    {
+        gst_structure_set(&struc, "chunk_gain", G_TYPE_DOUBLE, data.gain, nullptr);
+    }
+    else
+    {
+        gst_structure_remove_field(&struc, "chunk_gain");
+    }
+
+    if (data.has_frame_id)
+    {
+        gst_structure_set(&struc, "chunk_frame_id", G_TYPE_UINT64, data.frame_id, nullptr);
+    }
+    else
+    {
+        gst_structure_remove_field(&struc, "chunk_frame_id");
+    }
+}
+
+
+static void fill_frame_meta(const tcam::ImageBuffer& buffer,
+                            const tcam::tcam_stream_statistics& stat,
+                            TcamFrameMetaData& data)
+{
+    data = {};
+
+    data.frame_count = stat.frame_count;
+    data.frames_dropped = stat.frames_dropped;
+    data.capture_time_ns = stat.capture_time_ns;
+    data.camera_time_ns = stat.camera_time_ns;
+    data.resent_packets = stat.resent_packets;
+    data.missing_packets = stat.missing_packets;
+    data.underruns = stat.underruns;
+    data.receive_duration_ns = stat.receive_duration_ns;
+    data.trigger_issue_time_ns = stat.trigger_issue_time_ns;
+    data.trigger_arrival_time_ns = stat.trigger_arrival_time_ns;
+    data.ptp_time_ns = stat.ptp_time_ns;
+    data.parameter_set_id = stat.parameter_set_id;
+    data.roi_id = stat.roi_id;
+    data.roi_offset_x = stat.roi_offset_x;
+    data.roi_offset_y = stat.roi_offset_y;
+    data.hdr_bracket_index = stat.hdr_bracket_index;
+    data.hdr_bracket_count = stat.hdr_bracket_count;
+    data.hdr_exposure_time = stat.hdr_exposure_us;
+    data.is_damaged = stat.is_damaged;
+
+    static_assert(tcam::tcam_missing_line_map::max_ranges
+                  == TCAM_FRAME_META_MAX_MISSING_LINE_RANGES);
+    const auto missing = buffer.get_missing_line_map();
+    data.missing_lines = stat.missing_lines;
+    data.missing_line_range_count = missing.range_count;
+    for (guint32 i = 0; i < missing.range_count; ++i)
+    {
+        data.missing_line_ranges[2 * i] = missing.ranges[i].first_line;
+        data.missing_line_ranges[2 * i + 1] = missing.ranges[i].line_count;
+    }
+
+    const auto& chunk = buffer.get_chunk_data();
+    if (chunk.has_exposure_time)
+    {
+        data.chunk_flags |= TCAM_FRAME_META_CHUNK_EXPOSURE_TIME;
+        data.chunk_exposure_time = chunk.exposure_time_us;
+    }
+    if (chunk.has_gain)
+    {
+        data.chunk_flags |= TCAM_FRAME_META_CHUNK_GAIN;
+        data.chunk_gain = chunk.gain;
+    }
+    if (chunk.has_frame_id)
+    {
+        data.chunk_flags |= TCAM_FRAME_META_CHUNK_FRAME_ID;
+        data.chunk_frame_id = chunk.frame_id;
+    }
+
+    if (tcam::timing::is_enabled())
+    {
+        using tcam::timing::stage;
+        const auto& timing = buffer.get_stage_timing();
+
+        data.stream_id = buffer.get_stream_id();
+        data.stage_backend_dequeue_ns = timing[stage::backend_dequeue];
+        data.stage_push_image_enter_ns = timing[stage::push_image_enter];
+        data.stage_push_image_exit_ns = timing[stage::push_image_exit];
+        data.stage_pool_callback_ns = timing[stage::pool_callback];
+        // stage_create_return_ns is set in acquire_buffer
+    }
+}
+
+
+// GstBuffer qdata holding the pool slot + 1, so that 0 means 'not one of ours'
+static GQuark gst_tcam_buffer_pool_slot_quark()
+{
+    static GQuark quark = g_quark_from_static_string("GstTcamBufferPoolSlot");
+    return quark;
+}
+
+
+static tcam::mainsrc::buffer_info* find_buffer_info(GstTcamBufferPool* self,
+                                                    const tcam::ImageBuffer& buffer)
+{
+    size_t slot = buffer.get_pool_slot();
+    if (slot >= self->state_->buffer.size())
+    {
+        return nullptr;
+    }
+
+    auto& info = self->state_->buffer[slot];
+    if (info.tcam_buffer.get() != &buffer)
+    {
+        return nullptr;
+    }
+    return &info;
+}
+
+
+static tcam::mainsrc::buffer_info* find_buffer_info(GstTcamBufferPool* self, GstBuffer* buffer)
+{
+    size_t slot = GPOINTER_TO_SIZE(
+        gst_mini_object_get_qdata(GST_MINI_OBJECT_CAST(buffer), gst_tcam_buffer_pool_slot_quark()));
+    if (slot == 0 || slot > self->state_->buffer.size())
+    {
+        return nullptr;
+    }
+
+    auto& info = self->state_->buffer[slot - 1];
+    if (info.gst_buffer != buffer)
+    {
+        return nullptr;
+    }
+    return &info;
+}
+
+
+// GstBuffer qdata of grow-pool copies, decrements tcam_pool_state::extra_alive and returns the
+// budget of the copy when freed
+static GQuark gst_tcam_buffer_pool_extra_quark()
+{
+    static GQuark quark = g_quark_from_static_string("GstTcamBufferPoolExtra");
+    return quark;
+}
+
+
+// Drivers that pad lines deliver strided images, downstream learns the stride from a GstVideoMeta.
+// With software-crop the meta describes the top left crop_size of the image, so that downstream
+// reads only the size of the caps without a copy.
+// The meta stays on the pooled buffer, the layout only changes with the format.
+static void update_video_meta(GstTcamBufferPool* self,
+                              GstBuffer* gst_buffer,
+                              const tcam::ImageBuffer& buffer,
+                              tcam::tcam_image_size crop_size)
+{
+    const bool cropped = crop_size.width != 0 && crop_size.height != 0;
+    const int pitch = cropped && buffer.get_pitch() == 0
+                          ? static_cast<int>(buffer.get_format().get_pitch_size())
+                          : buffer.get_pitch();
+    GstVideoMeta* meta = gst_buffer_get_video_meta(gst_buffer);
+
+    if (pitch == 0)
+    {
+        if (meta)
+        {
+            gst_buffer_remove_meta(gst_buffer, GST_META_CAST(meta));
+        }
+        return;
+    }
+
+    const auto size = cropped ? crop_size : buffer.get_format().get_size();
+    if (!meta)
+    {
+        gsize offset[GST_VIDEO_MAX_PLANES] = { 0 };
+        gint stride[GST_VIDEO_MAX_PLANES] = { pitch };
+
+        meta = gst_buffer_add_video_meta_full(gst_buffer,
+                                              GST_VIDEO_FRAME_FLAG_NONE,
+                                              self->state_->video_format,
+                                              size.width,
+                                              size.height,
+                                              1,
+                                              offset,
+                                              stride);
+        GST_META_FLAG_SET(GST_META_CAST(meta), GST_META_FLAG_POOLED);
+    }
+    meta->width = size.width;
+    meta->height = size.height;
+    meta->stride[0] = pitch;
+}
+
+
+// One 'tcam-region' GstVideoRegionOfInterestMeta per region of a multi-region readout, placed where
+// the region is stacked in the image. Its 'tcam-region' param holds the position on the sensor.
+// The metas are not pooled, reset_buffer removes them.
+static void add_region_metas(GstBuffer* gst_buffer, const tcam::VideoFormat& format)
+{
+    static const GQuark roi_type = g_quark_from_static_string("tcam-region");
+
+    // a buffer that was prepared but not delivered still has them
+    gpointer state = nullptr;
+    while (auto meta = gst_buffer_iterate_meta_filtered(
+               gst_buffer, &state, GST_VIDEO_REGION_OF_INTEREST_META_API_TYPE))
+    {
+        if (reinterpret_cast<GstVideoRegionOfInterestMeta*>(meta)->roi_type == roi_type)
+        {
+            return;
+        }
+    }
+
+    guint top = 0;
+    guint index = 0;
+    for (const auto& region : format.get_regions())
+    {
+        auto meta = gst_buffer_add_video_region_of_interest_meta_id(
+            gst_buffer, roi_type, 0, top, region.width, region.height);
+        if (meta)
+        {
+            gst_video_region_of_interest_meta_add_param(meta,
+                                                        gst_structure_new("tcam-region",
+                                                                          "index",
+                                                                          G_TYPE_UINT,
+                                                                          index,
+                                                                          "offset-x",
+                                                                          G_TYPE_UINT,
+                                                                          region.offset_x,
+                                                                          "offset-y",
+                                                                          G_TYPE_UINT,
+                                                                          region.offset_y,
+                                                                          nullptr));
+        }
+        top += region.height;
+        ++index;
+    }
+}
+
+
+struct extra_buffer_ref
+{
+    std::shared_ptr<std::atomic<size_t>> alive;
+    size_t budget_bytes = 0;
+};
+
+
+static void release_extra_alive(gpointer data)
+{
+    auto ref = static_cast<extra_buffer_ref*>(data);
+    ref->alive->fetch_sub(1);
+    tcam::buffer_budget::release(ref->budget_bytes);
+    delete ref;
+}
+
+
+// gives a pool buffer that was counted as outstanding back to the device
+static void requeue_to_device(device_state& state, tcam::mainsrc::buffer_info& info)
+{
+    TCAM_TRACE2(pool_release, info.stream_id, info.statistics.frame_count);
+
+    if (!info.pooled)
+    {
+        info.pooled = true;
+        state.buffers_outstanding_--;
+        state.update_pool_metrics();
+    }
+    if (state.sink)
+    {
+        state.sink->requeue_buffer(info.tcam_buffer);
+    }
+}
+
+
+// Copies info into a grow-pool entry, nullptr when max-extra-buffers copies are alive
+static tcam::mainsrc::buffer_info* copy_to_extra_buffer(GstTcamBufferPool* self,
+                                                        device_state& state,
+                                                        const tcam::mainsrc::buffer_info& info)
+{
+    auto& ps = *self->state_;
+    if (ps.extra_alive->load() >= ps.extra_buffer.size())
+    {
+        return nullptr;
+    }
+
+    size_t slot = 0;
+    for (; slot < ps.extra_buffer.size(); ++slot)
+    {
+        bool expected = false;
+        if (ps.extra_in_use[slot].compare_exchange_strong(expected, true))
+        {
+            break;
+        }
+    }
+    if (slot == ps.extra_buffer.size())
+    {
+        return nullptr;
+    }
+
+    // the pool only grows as far as the memory budget of the process allows
+    if (ps.extra_budget_bytes != 0 && !tcam::buffer_budget::try_reserve(ps.extra_budget_bytes))
+    {
+        ps.extra_in_use[slot] = false;
+        return nullptr;
+    }
+
+    GstBuffer* copy = gst_buffer_copy_deep(info.gst_buffer);
+    if (!copy)
+    {
+        tcam::buffer_budget::release(ps.extra_budget_bytes);
+        ps.extra_in_use[slot] = false;
+        return nullptr;
+    }
+
+    ps.extra_alive->fetch_add(1);
+    gst_mini_object_set_qdata(GST_MINI_OBJECT_CAST(copy),
+                              gst_tcam_buffer_pool_extra_quark(),
+                              new extra_buffer_ref { ps.extra_alive, ps.extra_budget_bytes },
+                              release_extra_alive);
+
+    auto& extra = ps.extra_buffer[slot];
+    extra = {};
+    extra.gst_buffer = copy;
+    extra.pooled = false;
+    extra.statistics = info.statistics;
+    extra.stream_id = info.stream_id;
+    extra.prepared = true;
+
+    state.count_extra_buffer();
+    return &extra;
+}
+
+
+static void release_extra_buffer(GstTcamBufferPool* self, tcam::mainsrc::buffer_info& info)
+{
+    auto& ps = *self->state_;
+    info.gst_buffer = nullptr;
+    ps.extra_in_use[&info - ps.extra_buffer.data()] = false;
+}
+
+
+// Called when info would take the last buffer of the device.
+// Returns the entry to queue instead of info, nullptr when nothing has to be queued.
+static tcam::mainsrc::buffer_info* apply_starvation_policy(GstTcamBufferPool* self,
+                                                           device_state& state,
+                                                           tcam::mainsrc::buffer_info* info)
+{
+    state.begin_starvation();
+
+    switch (state.starvation_policy_.load())
+    {
+        case GST_TCAM_STARVATION_DROP_NEWEST:
+        {
+            state.count_starvation_drop();
+            state.sink->requeue_buffer(info->tcam_buffer);
+            return nullptr;
+        }
+        case GST_TCAM_STARVATION_DROP_OLDEST_QUEUED:
+        {
+            // nothing to reclaim when downstream holds all buffers
+            if (auto oldest = state.queue.reclaim())
+            {
+                state.count_starvation_drop();
+                if (oldest->tcam_buffer)
+                {
+                    requeue_to_device(state, *oldest);
+                }
+                else
+                {
+                    gst_buffer_unref(oldest->gst_buffer);
+                    release_extra_buffer(self, *oldest);
+                }
+            }
+            return info;
+        }
+        case GST_TCAM_STARVATION_GROW_POOL:
+        {
+            if (auto copy = copy_to_extra_buffer(self, state, *info))
+            {
+                state.sink->requeue_buffer(info->tcam_buffer);
+                return copy;
+            }
+            return info;
+        }
+        case GST_TCAM_STARVATION_BLOCK:
+        default:
+        {
+            // camera-buffers=0 grows the pool within the budget before it blocks
+            if (state.is_buffer_count_auto())
+            {
+                if (auto copy = copy_to_extra_buffer(self, state, *info))
+                {
+                    state.sink->requeue_buffer(info->tcam_buffer);
+                    return copy;
+                }
+            }
+            return info;
+        }
+    }
+}
+
+
+// Writes the meta, flags and size of the image in info.tcam_buffer into info.gst_buffer
+static void prepare_delivery(GstTcamBufferPool* self,
+                             device_state& state,
+                             tcam::mainsrc::buffer_info& info)
+{
+    const auto& buffer = *info.tcam_buffer;
+    const auto& stats = info.statistics;
+
+    if (auto frame_meta = gst_buffer_get_tcam_frame_meta(info.gst_buffer))
+    {
+        fill_frame_meta(buffer, stats, frame_meta->data);
+    }
+    // only present with statistics-meta=true
+    if (auto meta = gst_buffer_get_tcam_statistics_meta(info.gst_buffer); meta && meta->structure)
+    {
+        statistics_to_gst_structure(stats, *meta->structure);
+        chunk_data_to_gst_structure(buffer.get_chunk_data(), *meta->structure);
+        stage_timing_to_gst_structure(buffer, *meta->structure);
+    }
+
+    if (stats.is_damaged)
+    {
+        // salvaged frames are expected, see salvage-threshold
+        if (!state.drop_incomplete_frames_)
+        {
+            GST_WARNING_OBJECT(GST_OBJECT(self), "Delivering damaged buffer.");
+        }
+        gst_buffer_set_flags(info.gst_buffer, GST_BUFFER_FLAG_CORRUPTED);
+    }
+    // update the image size
+    // not relevant for bayer
+    // image/jpeg relies on this!
+    // a resize of memory that is not exclusive creates a shared sub memory
+    if (gst_buffer_get_size(info.gst_buffer) != buffer.get_valid_data_length())
+    {
+        gst_buffer_set_size(info.gst_buffer, buffer.get_valid_data_length());
+    }
+    update_video_meta(self, info.gst_buffer, buffer, state.crop_size_);
+    add_region_metas(info.gst_buffer, state.format_);
+    info.prepared = true;
+}
+
+
+static void gst_tcam_buffer_pool_sh_callback(const std::shared_ptr<tcam::ImageBuffer>& buffer,
+                                             void* data)
 {
     GstTcamBufferPool* self = GST_TCAM_BUFFER_POOL(data);
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
 
+    buffer->record_stage(tcam::timing::stage::pool_callback);
+
     if (!state->is_streaming_)
     {
         // requeue the buffer so that the backend does not run out
@@ -96,44 +710,163 @@ static void gst_tcam_buffer_pool_sh_callback(std::shared_ptr<tcam::ImageBuffer>
         return;
     }
 
-    std::unique_lock<std::mutex> lck(state->stream_mtx_);
+    auto info = find_buffer_info(self, *buffer);
+    if (!info)
+    {
+        GST_WARNING_OBJECT(self, "Received buffer that is not part of the pool. Requeueing.");
+        state->sink->requeue_buffer(buffer);
+        return;
+    }
+
+    auto stats = buffer->get_statistics();
+
+    state->post_scene_statistics(*buffer);
+
+    if (state->flight_recorder_)
+    {
+        // only frozen windows go downstream, see acquire_recorded_buffer
+        state->update_statistics_summary(stats);
+        state->flight_recorder_->record(*buffer);
+        state->sink->requeue_buffer(buffer);
+        return;
+    }
+
+    state->update_statistics_summary(stats);
 
-    for (auto& info : self->state_->buffer)
+    info->statistics = stats;
+    info->stream_id = buffer->get_stream_id();
+
+    // in burst mode this thread only queues, the streaming thread prepares the buffer
+    const bool deferred = state->burst_count_ > 0;
+    info->prepared = false;
+    if (!deferred)
     {
-        if (info.tcam_buffer == buffer)
+        prepare_delivery(self, *state, *info);
+    }
+
+    auto entry = info;
+    if (state->buffers_outstanding_ + 1 >= self->state_->buffer.size())
+    {
+        if (deferred)
         {
-            auto stats = buffer->get_statistics();
-            GstMeta* meta =
-                gst_buffer_get_meta(info.gst_buffer, g_type_from_name("TcamStatisticsMetaApi"));
-            if (meta)
-            {
-                GstStructure* struc = ((TcamStatisticsMeta*)meta)->structure;
+            // grow-pool copies the GstBuffer, it has to be complete
+            prepare_delivery(self, *state, *info);
+        }
+        entry = apply_starvation_policy(self, *state, info);
+        if (!entry)
+        {
+            return;
+        }
+    }
 
-                if (struc)
-                {
-                    statistics_to_gst_structure(stats, *struc);
-                }
-            }
+    if (entry == info)
+    {
+        info->pooled = false;
+        state->buffers_outstanding_++;
+        state->update_pool_metrics();
+    }
+    entry->queued_at = std::chrono::steady_clock::now();
+    if (!state->queue.push(entry))
+    {
+        GST_ERROR_OBJECT(self, "Buffer queue overflow. Dropping buffer.");
+        if (entry == info)
+        {
+            requeue_to_device(*state, *info);
+        }
+        else
+        {
+            gst_buffer_unref(entry->gst_buffer);
+            release_extra_buffer(self, *entry);
+        }
+    }
+}
 
-            if (stats.is_damaged && !state->drop_incomplete_frames_)
-            {
-                GST_WARNING_OBJECT(GST_OBJECT(self), "Delivering damaged buffer.");
-                gst_buffer_set_flags(info.gst_buffer, GST_BUFFER_FLAG_CORRUPTED);
-            }
-            // update the image size
-            // not relevant for bayer
-            // image/jpeg relies on this!
-            gst_buffer_set_size(info.gst_buffer, info.tcam_buffer->get_valid_data_length());
 
-            info.pooled = false;
-            state->queue.push(info);
+// PTS = capture time in running time.
+// Done in the streaming thread, the element clock is only available once the pipeline plays.
+static void set_capture_timestamp(GstTcamBufferPool* self,
+                                  device_state& state,
+                                  GstTcamTimestampMode mode,
+                                  tcam::mainsrc::buffer_info& info)
+{
+    GstClock* clock = gst_element_get_clock(self->src_element);
+    if (!clock)
+    {
+        return;
+    }
+    const GstClockTime clock_now = gst_clock_get_time(clock);
+    gst_object_unref(clock);
+
+    auto ts = state.timestamper_.get_clock_time(mode, info.statistics, clock_now);
+    if (!ts)
+    {
+        return;
+    }
 
-            state->stream_cv_.notify_all();
-            break;
+    const GstClockTime base_time = gst_element_get_base_time(self->src_element);
+    const GstClockTime running_time = *ts > base_time ? *ts - base_time : 0;
+
+    // a valid DTS keeps GstBaseSrc:do-timestamp from overwriting this
+    GST_BUFFER_PTS(info.gst_buffer) = running_time;
+    GST_BUFFER_DTS(info.gst_buffer) = running_time;
+
+    state.check_capture_latency();
+}
+
+
+static void release_recorded_image(gpointer data)
+{
+    delete static_cast<std::shared_ptr<tcam::ImageBuffer>*>(data);
+}
+
+
+// Wraps the next image of a frozen flight recorder window.
+// The recorder slot returns to the ring when downstream frees the buffer.
+static GstFlowReturn acquire_recorded_buffer(GstTcamBufferPool* self,
+                                             device_state& state,
+                                             GstBuffer** buffer)
+{
+    std::shared_ptr<tcam::ImageBuffer> image;
+    while (!image)
+    {
+        if (!state.is_streaming_ || GST_BUFFER_POOL_IS_FLUSHING(GST_BUFFER_POOL_CAST(self)))
+        {
+            return GST_FLOW_FLUSHING;
         }
+        image = state.flight_recorder_->pop_frozen(std::chrono::milliseconds(100));
     }
 
-    lck.unlock();
+    auto holder = new std::shared_ptr<tcam::ImageBuffer>(image);
+    GstBuffer* gst_buffer = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY,
+                                                        image->get_image_buffer_ptr(),
+                                                        image->get_image_buffer_size(),
+                                                        0,
+                                                        image->get_valid_data_length(),
+                                                        holder,
+                                                        release_recorded_image);
+
+    const auto stats = image->get_statistics();
+    if (auto frame_meta = gst_buffer_add_tcam_frame_meta(gst_buffer))
+    {
+        fill_frame_meta(*image, stats, frame_meta->data);
+    }
+    if (state.statistics_meta_)
+    {
+        GstStructure* struc = gst_structure_new_empty("TcamStatistics");
+        statistics_to_gst_structure(stats, *struc);
+        chunk_data_to_gst_structure(image->get_chunk_data(), *struc);
+        stage_timing_to_gst_structure(*image, *struc);
+        gst_buffer_add_tcam_statistics_meta(gst_buffer, struc);
+    }
+    if (stats.is_damaged)
+    {
+        gst_buffer_set_flags(gst_buffer, GST_BUFFER_FLAG_CORRUPTED);
+    }
+    update_video_meta(self, gst_buffer, *image, state.crop_size_);
+    add_region_metas(gst_buffer, state.format_);
+
+    *buffer = gst_buffer;
+    return GST_FLOW_OK;
 }
 
 
@@ -148,32 +881,82 @@ static GstFlowReturn gst_tcam_buffer_pool_acquire_buffer(GstBufferPool* pool,
 
     GstTcamBufferPool* self = GST_TCAM_BUFFER_POOL(pool);
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
-    std::unique_lock<std::mutex> lck(state->stream_mtx_);
-    while (true)
+
+    if (!state->is_streaming_)
     {
-        if (state->queue.empty() && state->is_streaming_)
-        {
-            // wait until new buffer arrives or stop waiting when we have to shut down
-            state->stream_cv_.wait(lck);
-        }
-        if (!state->is_streaming_)
+        return GST_FLOW_FLUSHING;
+    }
+
+    if (state->flight_recorder_)
+    {
+        return acquire_recorded_buffer(self, *state, buffer);
+    }
+
+    // wait until new buffer arrives or stop waiting when we have to shut down
+    auto info = state->queue.wait_pop([state] { return state->is_streaming_.load(); });
+    if (!info)
+    {
+        return GST_FLOW_FLUSHING;
+    }
+
+    if (!info->prepared)
+    {
+        prepare_delivery(self, *state, *info);
+    }
+
+    info->acquired_at = std::chrono::steady_clock::now();
+    state->add_push_delay(info->acquired_at - info->queued_at);
+
+    if (auto frame_meta = gst_buffer_get_tcam_frame_meta(info->gst_buffer))
+    {
+        frame_meta->data.push_delay_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             info->acquired_at - info->queued_at)
+                                             .count();
+    }
+
+    GstTcamTimestampMode ts_mode = state->timestamp_mode_;
+    if (ts_mode == GST_TCAM_TIMESTAMP_NONE && state->burst_count_ > 0)
+    {
+        // do-timestamp would stamp the delayed push, keep the spacing of the burst
+        ts_mode = GST_TCAM_TIMESTAMP_CAPTURE;
+    }
+    if (ts_mode != GST_TCAM_TIMESTAMP_NONE)
+    {
+        set_capture_timestamp(self, *state, ts_mode, *info);
+    }
+
+    TCAM_TRACE2(pool_acquire, info->stream_id, info->statistics.frame_count);
+
+    // create returns the buffer right away
+    const uint64_t create_time = tcam::timing::record(
+        tcam::timing::stage::create_return, info->stream_id, info->statistics.frame_count);
+    if (create_time != 0)
+    {
+        if (auto frame_meta = gst_buffer_get_tcam_frame_meta(info->gst_buffer))
         {
-            return GST_FLOW_FLUSHING;
+            frame_meta->data.stage_create_return_ns = create_time;
         }
-        if (!state->queue.empty())
+        auto meta = gst_buffer_get_tcam_statistics_meta(info->gst_buffer);
+        if (meta && meta->structure)
         {
-            auto buffer_desc = state->queue.front();
-            state->queue.pop(); // remove buffer from queue
-            *buffer = buffer_desc.gst_buffer;
-
-            return GST_FLOW_OK;
+            gst_structure_set(
+                meta->structure, "stage_create_return_ns", G_TYPE_UINT64, create_time, nullptr);
         }
     }
 
-    // TOOD: return flushing only when inactive
-    // acquire may block, so we can wait indefinetly
+    if (state->discont_pending_.exchange(false))
+    {
+        // first image of a reconnected device, the flags are cleared in reset_buffer
+        GST_BUFFER_FLAG_SET(info->gst_buffer, GST_BUFFER_FLAG_DISCONT);
+    }
 
-    return GST_FLOW_FLUSHING;
+    *buffer = info->gst_buffer;
+    if (!info->tcam_buffer)
+    {
+        // grow-pool copy, the GstBuffer is ours now
+        release_extra_buffer(self, *info);
+    }
+    return GST_FLOW_OK;
 }
 
 
@@ -182,31 +965,231 @@ static void gst_tcam_buffer_pool_release_buffer(GstBufferPool* pool, GstBuffer*
     GstTcamBufferPool* self = GST_TCAM_BUFFER_POOL(pool);
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
 
-    std::unique_lock<std::mutex> lck(state->stream_mtx_);
-    for (auto& info : self->state_->buffer)
+    auto info = find_buffer_info(self, buffer);
+    if (!info)
+    {
+        // grow-pool copies and flight recorder images own their memory, buffer->pool is
+        // already cleared, so this frees them
+        gst_buffer_unref(buffer);
+        return;
+    }
+
+    if (!state->sink)
+    {
+        GST_ERROR_OBJECT(self, "Unable to requeue buffer. Device is not open.");
+        info->pooled = true;
+        return;
+    }
+
+    state->record_hold_time(std::chrono::steady_clock::now() - info->acquired_at);
+
+    requeue_to_device(*state, *info);
+    state->end_starvation();
+}
+
+
+static void gst_tcam_buffer_pool_reset_buffer(GstBufferPool* pool, GstBuffer* buffer)
+{
+    GstTcamBufferPool* self = GST_TCAM_BUFFER_POOL(pool);
+
+    // Elements that work on our buffers in place (or in passthrough) can steer the auto
+    // algorithms by attaching a 'tcam-auto-functions' ROI meta before they release the buffer.
+    static const GQuark roi_type = g_quark_from_static_string("tcam-auto-functions");
+
+    auto meta = gst_buffer_get_video_region_of_interest_meta_id(buffer, roi_type);
+    if (meta && self->src_element)
+    {
+        GST_TCAM_MAINSRC(self->src_element)
+            ->device->set_auto_functions_roi(tcam_image_roi { meta->x, meta->y, meta->w, meta->h });
+    }
+
+    // removes the meta together with all other non pooled metas
+    GST_BUFFER_POOL_CLASS(parent_class)->reset_buffer(pool, buffer);
+}
+
+
+static gboolean gst_tcam_buffer_pool_set_config(GstBufferPool* /*bpool*/, GstStructure* /*config*/)
+{
+    //GST_INFO("set_config============================================");
+    return TRUE;
+}
+
+
+// downstream checks gst_buffer_pool_has_option(buffer->pool, ...) to skip its staging copy
+static const gchar** gst_tcam_buffer_pool_get_options(GstBufferPool* pool)
+{
+    static const gchar* cuda_pinned_options[] = { GST_TCAM_BUFFER_POOL_OPTION_CUDA_PINNED,
+                                                  nullptr };
+    static const gchar* no_options[] = { nullptr };
+
+    GstTcamBufferPool* self = GST_TCAM_BUFFER_POOL(pool);
+    struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
+
+    if (state->buffer_pool_cuda_pinned_)
+    {
+        return cuda_pinned_options;
+    }
+    return no_options;
+}
+
+
+static GstBuffer* create_gst_buffer(GstTcamBufferPool* self, const tcam::ImageBuffer& b)
+{
+    void* address = b.get_image_buffer_ptr();
+    size_t size = b.get_image_buffer_size();
+
+    struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
+
+    switch (state->buffer_pool->get_memory_type())
     {
-        if (info.gst_buffer == buffer)
+        case tcam::TCAM_MEMORY_TYPE_DMA:
         {
-            info.pooled = true;
+            // GstDmaBufMemory closes the fd it is given, the tcam::Memory keeps the original
+            int fd = dup(b.get_file_descriptor());
+            if (fd < 0)
+            {
+                GST_ERROR_OBJECT(self, "Unable to dup dmabuf fd: %s", strerror(errno));
+                return nullptr;
+            }
 
-            if (state->sink)
+            GstBuffer* gst_buffer = gst_buffer_new();
+#if GST_CHECK_VERSION(1, 16, 0)
+            // the gst buffers live as long as the pool, map the driver buffer once
+            // instead of with every gst_memory_map downstream
+            gst_buffer_append_memory(
+                gst_buffer,
+                gst_dmabuf_allocator_alloc_with_flags(
+                    self->state_->dmabuf_allocator, fd, size, GST_FD_MEMORY_FLAG_KEEP_MAPPED));
+#else
+            gst_buffer_append_memory(
+                gst_buffer, gst_dmabuf_allocator_alloc(self->state_->dmabuf_allocator, fd, size));
+#endif
+            return gst_buffer;
+        }
+        case tcam::TCAM_MEMORY_TYPE_DMA_IMPORT:
+        {
+            size_t slot = b.get_pool_slot();
+            if (slot >= self->state_->imported_buffer.size())
             {
-                state->sink->requeue_buffer(info.tcam_buffer);
+                return nullptr;
             }
-            else
+
+            // share the downstream memory, so that downstream recognizes its own dmabuf
+            GstMemory* mem = gst_buffer_peek_memory(self->state_->imported_buffer.at(slot), 0);
+
+            GstBuffer* gst_buffer = gst_buffer_new();
+            gst_buffer_append_memory(gst_buffer, gst_memory_ref(mem));
+            return gst_buffer;
+        }
+        case tcam::TCAM_MEMORY_TYPE_USERPTR:
+        {
+            if (!state->buffer_pool_memfd_)
             {
-                GST_ERROR_OBJECT(self, "Unable to requeue buffer. Device is not open.");
+                break;
             }
+
+            // GstFdMemory closes the fd it is given, the tcam::Memory keeps the original
+            int fd = dup(b.get_file_descriptor());
+            if (fd < 0)
+            {
+                GST_ERROR_OBJECT(self, "Unable to dup memfd: %s", strerror(errno));
+                return nullptr;
+            }
+
+            GstBuffer* gst_buffer = gst_buffer_new();
+            gst_buffer_append_memory(gst_buffer,
+                                     gst_fd_allocator_alloc(self->state_->fd_allocator,
+                                                            fd,
+                                                            size,
+                                                            GST_FD_MEMORY_FLAG_KEEP_MAPPED));
+            return gst_buffer;
+        }
+        case tcam::TCAM_MEMORY_TYPE_MMAP:
+        {
+            break;
         }
     }
-    lck.unlock();
+
+    return gst_buffer_new_wrapped_full(
+        static_cast<GstMemoryFlags>(0), address, size, 0, size, nullptr, nullptr);
 }
 
 
-static gboolean gst_tcam_buffer_pool_set_config(GstBufferPool* /*bpool*/, GstStructure* /*config*/)
+// Acquires buffer_count dmabuf buffers from other_pool_
+// and hands their memory to the tcam::BufferPool
+static bool import_other_pool_buffer(GstTcamBufferPool* self,
+                                     size_t required_size,
+                                     size_t buffer_count)
 {
-    //GST_INFO("set_config============================================");
-    return TRUE;
+    struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
+
+    if (!self->other_pool_)
+    {
+        GST_ERROR_OBJECT(self, "dmabuf-import requires a downstream pool.");
+        return false;
+    }
+
+    std::vector<std::shared_ptr<tcam::Memory>> memory;
+    memory.reserve(buffer_count);
+
+    // do not block when downstream has fewer buffers than we want
+    GstBufferPoolAcquireParams params = {};
+    params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+
+    for (size_t i = 0; i < buffer_count; ++i)
+    {
+        GstBuffer* buffer = nullptr;
+        if (gst_buffer_pool_acquire_buffer(self->other_pool_, &buffer, &params) != GST_FLOW_OK)
+        {
+            GST_ERROR_OBJECT(self,
+                             "Downstream pool only provided %zu of %zu buffers.",
+                             i,
+                             buffer_count);
+            return false;
+        }
+        self->state_->imported_buffer.push_back(buffer);
+
+        GstMemory* mem = gst_buffer_peek_memory(buffer, 0);
+        if (gst_buffer_n_memory(buffer) != 1 || !gst_is_dmabuf_memory(mem))
+        {
+            GST_ERROR_OBJECT(self, "Downstream pool does not provide single dmabuf memory buffers.");
+            return false;
+        }
+
+        gsize mem_size = gst_memory_get_sizes(mem, nullptr, nullptr);
+        if (mem_size < required_size)
+        {
+            GST_ERROR_OBJECT(self,
+                             "Downstream dmabuf is too small. Has %zu, needs %zu.",
+                             (size_t)mem_size,
+                             required_size);
+            return false;
+        }
+
+        try
+        {
+            memory.push_back(std::make_shared<tcam::Memory>(state->device_->get_allocator(),
+                                                            tcam::TCAM_MEMORY_TYPE_DMA_IMPORT,
+                                                            mem_size,
+                                                            nullptr,
+                                                            gst_dmabuf_memory_get_fd(mem)));
+        }
+        catch (const std::runtime_error& err)
+        {
+            GST_ERROR_OBJECT(self, "Unable to import dmabuf: %s", err.what());
+            return false;
+        }
+    }
+
+    state->buffer_pool->set_external_memory(std::move(memory));
+    return true;
+}
+
+
+static void release_imported_buffer(GstTcamBufferPool* self)
+{
+    for (auto& b : self->state_->imported_buffer) { gst_buffer_unref(b); }
+    self->state_->imported_buffer.clear();
 }
 
 
@@ -217,40 +1200,83 @@ static void prepare_gst_buffer_pool(GstTcamBufferPool* self)
 
     auto tcam_buffers = state->buffer_pool->get_buffer();
 
+    // slots index directly into this vector
+    self->state_->buffer.clear();
+    self->state_->buffer.resize(tcam_buffers.size());
+
+    const auto policy = state->starvation_policy_.load();
+    const bool can_grow = policy == GST_TCAM_STARVATION_GROW_POOL
+                          || (policy == GST_TCAM_STARVATION_BLOCK && state->is_buffer_count_auto());
+    const size_t extra_count = can_grow ? state->max_extra_buffers_ : 0;
+    self->state_->extra_budget_bytes =
+        state->is_buffer_count_auto() ? state->budget_buffer_size_ : 0;
+    self->state_->extra_buffer.clear();
+    self->state_->extra_buffer.resize(extra_count);
+    self->state_->extra_in_use = std::make_unique<std::atomic<bool>[]>(extra_count);
+
+    state->queue.reset(tcam_buffers.size() + extra_count);
+    state->pool_size_ = tcam_buffers.size();
+    state->buffers_outstanding_ = 0;
+    state->update_pool_metrics();
+
     for (auto& tb : tcam_buffers)
     {
         if (auto b = tb.lock())
         {
-            void* address = b->get_image_buffer_ptr();
-            size_t size = b->get_image_buffer_size();
-
+            size_t slot = b->get_pool_slot();
+            if (slot >= self->state_->buffer.size())
+            {
+                GST_ERROR_OBJECT(self, "Buffer has invalid pool slot %zu.", slot);
+                continue;
+            }
 
-            GstBuffer* gst_buffer = gst_buffer_new_wrapped_full(
-                static_cast<GstMemoryFlags>(0), address, size, 0, size, nullptr, nullptr);
+            GstBuffer* gst_buffer = create_gst_buffer(self, *b);
+            if (!gst_buffer)
+            {
+                GST_ERROR_OBJECT(self, "Unable to create GstBuffer for pool slot %zu.", slot);
+                continue;
+            }
 
             gst_buffer_set_flags(gst_buffer, GST_BUFFER_FLAG_LIVE);
 
-            // TODO: check config and add meta data that is listed there
-            GstStructure* struc = gst_structure_new_empty("TcamStatistics");
-            auto meta = gst_buffer_add_tcam_statistics_meta(gst_buffer, struc);
+            gst_mini_object_set_qdata(GST_MINI_OBJECT_CAST(gst_buffer),
+                                      gst_tcam_buffer_pool_slot_quark(),
+                                      GSIZE_TO_POINTER(slot + 1),
+                                      nullptr);
 
-            if (!meta)
+            if (auto frame_meta = gst_buffer_add_tcam_frame_meta(gst_buffer))
             {
-                GST_WARNING_OBJECT(self, "Unable to add meta!");
+                auto m = (GstMeta*)frame_meta;
+                m->flags = static_cast<GstMetaFlags>(m->flags | GST_META_FLAG_POOLED);
             }
             else
             {
-                auto m = (GstMeta*)meta;
-                m->flags = static_cast<GstMetaFlags>(m->flags | GST_META_FLAG_POOLED);
+                GST_WARNING_OBJECT(self, "Unable to add frame meta!");
+            }
+
+            if (state->statistics_meta_)
+            {
+                GstStructure* struc = gst_structure_new_empty("TcamStatistics");
+                auto meta = gst_buffer_add_tcam_statistics_meta(gst_buffer, struc);
+
+                if (!meta)
+                {
+                    GST_WARNING_OBJECT(self, "Unable to add meta!");
+                }
+                else
+                {
+                    auto m = (GstMeta*)meta;
+                    m->flags = static_cast<GstMetaFlags>(m->flags | GST_META_FLAG_POOLED);
+                }
             }
 
             tcam::mainsrc::buffer_info info;
-            info.addr = address;
+            info.addr = b->get_image_buffer_ptr();
             info.tcam_buffer = b;
             info.gst_buffer = gst_buffer;
             info.pooled = true;
 
-            self->state_->buffer.push_back(info);
+            self->state_->buffer[slot] = info;
         }
     }
 }
@@ -275,15 +1301,18 @@ static gboolean gst_tcam_buffer_pool_start(GstBufferPool* pool)
                              (void*)self->other_pool_);
             return FALSE;
         }
-        if (gst_buffer_pool_acquire_buffer(self->other_pool_, &buffer, NULL) != GST_FLOW_OK)
+        if (state->io_mode_ != GST_TCAM_IO_DMABUF_IMPORT)
         {
-            GST_ERROR_OBJECT(self,
-                             "Failed to import buffer from downstream pool. %" GST_PTR_FORMAT,
-                             (void*)self->other_pool_);
-            return FALSE;
-        }
+            if (gst_buffer_pool_acquire_buffer(self->other_pool_, &buffer, NULL) != GST_FLOW_OK)
+            {
+                GST_ERROR_OBJECT(self,
+                                 "Failed to import buffer from downstream pool. %" GST_PTR_FORMAT,
+                                 (void*)self->other_pool_);
+                return FALSE;
+            }
 
-        gst_buffer_unref(buffer);
+            gst_buffer_unref(buffer);
+        }
     }
 
     GstStructure* config = gst_buffer_pool_get_config(pool);
@@ -297,18 +1326,68 @@ static gboolean gst_tcam_buffer_pool_start(GstBufferPool* pool)
         return false;
     }
 
+    GstVideoInfo video_info;
+    self->state_->video_format = gst_video_info_from_caps(&video_info, caps)
+                                     ? GST_VIDEO_INFO_FORMAT(&video_info)
+                                     : GST_VIDEO_FORMAT_ENCODED;
+
     auto dev = state->device_;
 
-    tcam::TCAM_MEMORY_TYPE buffer_type = tcam::mainsrc::io_mode_to_memory_type(state->io_mode_);
+    tcam::TCAM_MEMORY_TYPE buffer_type = tcam::mainsrc::io_mode_to_memory_type(
+        state->io_mode_, dev->get_allocator()->get_supported_memory_types());
 
     tcam::tcam_video_format format;
 
     tcam::mainsrc::caps_to_format(*caps, format);
+    const auto device_format = state->to_device_format(format);
+
+    // keep an existing pool across renegotiation
+    // configure() reuses its memory when the new format fits
+    const bool use_memfd = state->io_mode_ == GST_TCAM_IO_MEMFD;
+    bool use_cuda_pinned = state->io_mode_ == GST_TCAM_IO_CUDA_PINNED;
+    if (use_cuda_pinned && !tcam::CudaHostAllocator::is_available())
+    {
+        GST_WARNING_OBJECT(self, "CUDA is not available, io-mode cuda-pinned uses userptr.");
+        use_cuda_pinned = false;
+    }
+
+    if (!state->buffer_pool || state->buffer_pool->get_memory_type() != buffer_type
+        || state->buffer_pool_memfd_ != use_memfd
+        || state->buffer_pool_cuda_pinned_ != use_cuda_pinned)
+    {
+        try
+        {
+            std::shared_ptr<tcam::AllocatorInterface> allocator = dev->get_allocator();
+            if (use_memfd)
+            {
+                allocator = std::make_shared<tcam::MemfdAllocator>();
+            }
+            else if (use_cuda_pinned)
+            {
+                allocator = std::make_shared<tcam::CudaHostAllocator>();
+            }
+            state->buffer_pool = std::make_shared<tcam::BufferPool>(buffer_type, allocator);
+            state->buffer_pool_memfd_ = use_memfd;
+            state->buffer_pool_cuda_pinned_ = use_cuda_pinned;
+        }
+        catch (const std::runtime_error& err)
+        {
+            GST_ERROR_OBJECT(
+                self, "Device does not support the requested io-mode: %s", err.what());
+            return FALSE;
+        }
+    }
 
-    state->buffer_pool = std::make_shared<tcam::BufferPool>(buffer_type, dev->get_allocator());
+    state->buffer_pool->set_buffer_size_padding(state->chunk_data_ ? tcam::chunk_data_buffer_padding
+                                                                   : 0);
 
-    auto alloc_res =
-        state->buffer_pool->configure(tcam::VideoFormat(format), state->imagesink_buffers_);
+    const size_t buffer_size =
+        tcam::compressed::get_buffer_size(device_format)
+        + (state->chunk_data_ ? tcam::chunk_data_buffer_padding : 0);
+    const size_t buffer_count =
+        state->reserve_buffer_budget(device_format, buffer_size);
+
+    auto alloc_res = state->buffer_pool->configure(device_format, buffer_count);
 
     if (!alloc_res)
     {
@@ -317,11 +1396,21 @@ static gboolean gst_tcam_buffer_pool_start(GstBufferPool* pool)
         return FALSE;
     }
 
+    if (buffer_type == tcam::TCAM_MEMORY_TYPE_DMA_IMPORT)
+    {
+        if (!import_other_pool_buffer(
+                self, device_format.get_required_buffer_size(), buffer_count))
+        {
+            release_imported_buffer(self);
+            return FALSE;
+        }
+    }
+
     // prefer user config
     // we do not want to allocate new buffers while running
     // and we have no reason to
-    min_buffers = state->imagesink_buffers_;
-    max_buffers = state->imagesink_buffers_;
+    min_buffers = buffer_count;
+    max_buffers = buffer_count;
 
     gst_buffer_pool_config_set_params(config, caps, size, min_buffers, max_buffers);
 
@@ -339,8 +1428,13 @@ static gboolean gst_tcam_buffer_pool_start(GstBufferPool* pool)
     };
 
 
+    if (!state->prepare_flight_recorder(device_format, buffer_size))
+    {
+        return FALSE;
+    }
+
     state->sink =
-        std::make_shared<tcam::ImageSink>(cb_func, state->format_, state->imagesink_buffers_);
+        std::make_shared<tcam::ImageSink>(cb_func, state->format_, buffer_count);
     state->configure_stream();
 
     prepare_gst_buffer_pool(self);
@@ -361,7 +1455,7 @@ static gboolean gst_tcam_buffer_pool_stop(GstBufferPool* pool)
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
 
     state->stop_stream();
-    state->stream_cv_.notify_all();
+    state->queue.notify_consumer();
 
     return TRUE;
 }
@@ -372,17 +1466,21 @@ void gst_tcam_buffer_pool_delete_buffer(GstTcamBufferPool* self)
 
     for (const auto& b : self->state_->buffer)
     {
+        if (!b.gst_buffer)
+        {
+            continue;
+        }
         //GST_INFO("buffer refcount: %d sh_ptr usecount: %ld", b.gst_buffer->mini_object.refcount, b.tcam_buffer.use_count());
         gst_buffer_unref(b.gst_buffer);
     }
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
 
-    auto res = state->buffer_pool->clear();
-    if (!res)
-    {
-        GST_ERROR("Error while dealing with buffer pool: %s", res.as_failure().error().message().c_str());
-    }
+    // the memory is kept for the next start, configure() releases it when the new format
+    // does not fit, closing the device or changing the io-mode releases it as well
+    state->buffer_pool->clear_buffer();
+    state->release_buffer_budget();
     self->state_->buffer.clear();
+    release_imported_buffer(self);
     state->device_->free_stream();
 }
 
@@ -393,6 +1491,25 @@ static void gst_tcam_buffer_pool_dispose(GObject* object)
 
     auto self = GST_TCAM_BUFFER_POOL(object);
 
+    if (self->state_)
+    {
+        release_imported_buffer(self);
+        if (self->state_->dmabuf_allocator)
+        {
+            gst_object_unref(self->state_->dmabuf_allocator);
+        }
+        if (self->state_->fd_allocator)
+        {
+            gst_object_unref(self->state_->fd_allocator);
+        }
+    }
+
+    if (self->other_pool_)
+    {
+        gst_object_unref(self->other_pool_);
+        self->other_pool_ = nullptr;
+    }
+
     delete self->state_;
     self->state_ = nullptr;
 
@@ -409,6 +1526,8 @@ static void gst_tcam_buffer_pool_finalize(GObject* object)
 static void gst_tcam_buffer_pool_init(GstTcamBufferPool* pool)
 {
     pool->state_ = new tcam_pool_state();
+    pool->state_->dmabuf_allocator = gst_dmabuf_allocator_new();
+    pool->state_->fd_allocator = gst_fd_allocator_new();
 }
 
 static void gst_tcam_buffer_pool_class_init(GstTcamBufferPoolClass* klass)
@@ -420,10 +1539,12 @@ static void gst_tcam_buffer_pool_class_init(GstTcamBufferPoolClass* klass)
     object_class->finalize = gst_tcam_buffer_pool_finalize;
 
     bp_class->acquire_buffer = gst_tcam_buffer_pool_acquire_buffer;
+    bp_class->reset_buffer = gst_tcam_buffer_pool_reset_buffer;
     bp_class->release_buffer = gst_tcam_buffer_pool_release_buffer;
     bp_class->start = gst_tcam_buffer_pool_start;
     bp_class->stop = gst_tcam_buffer_pool_stop;
     bp_class->set_config = gst_tcam_buffer_pool_set_config;
+    bp_class->get_options = gst_tcam_buffer_pool_get_options;
 }
 
 
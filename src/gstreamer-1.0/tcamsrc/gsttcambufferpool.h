@@ -23,6 +23,9 @@
 
 G_BEGIN_DECLS
 
+// option of pools whose buffers are page locked CUDA host memory, see io-mode cuda-pinned
+#define GST_TCAM_BUFFER_POOL_OPTION_CUDA_PINNED "GstBufferPoolOptionTcamCudaPinned"
+
 typedef struct _GstTcamBufferPool GstTcamBufferPool;
 typedef struct _GstTcamBufferPoolClass GstTcamBufferPoolClass;
 
@@ -18,7 +18,10 @@
 
 #include "../../../libs/gst-helper/include/tcamprop1.0_gobject/tcam_property_serialize.h"
 #include "../../../libs/tcam-property/src/tcam-property-1.0.h"
+#include "../../BufferBudget.h"
+#include "../../ThreadPolicy.h"
 #include "../../logging.h"
+#include "../../utils.h"
 #include "../tcamgstbase/tcamgstbase.h"
 #include "../tcamgstbase/tcamgststrings.h"
 #include "gst/gstvalue.h"
@@ -28,6 +31,8 @@
 #include "mainsrc_tcamprop_impl.h"
 #include "tcambind.h"
 
+#include <cstring>
+
 #define GST_TCAM_MAINSRC_DEFAULT_N_BUFFERS 10
 
 GST_DEBUG_CATEGORY(tcam_mainsrc_debug);
@@ -58,8 +63,10 @@ GType gst_tcam_io_mode_get_type(void)
             { GST_TCAM_IO_AUTO, "GST_TCAM_IO_AUTO", "auto" },
             { GST_TCAM_IO_MMAP, "GST_TCAM_IO_MMAP", "mmap" },
             { GST_TCAM_IO_USERPTR, "GST_TCAM_IO_USERPTR", "userptr" },
-            //{ GST_TCAM_IO_DMABUF, "GST_TCAM_IO_DMABUF", "dmabuf" },
-            //{ GST_TCAM_IO_DMABUF_IMPORT, "GST_TCAM_IO_DMABUF_IMPORT", "dmabuf-import" },
+            { GST_TCAM_IO_DMABUF, "GST_TCAM_IO_DMABUF", "dmabuf" },
+            { GST_TCAM_IO_DMABUF_IMPORT, "GST_TCAM_IO_DMABUF_IMPORT", "dmabuf-import" },
+            { GST_TCAM_IO_MEMFD, "GST_TCAM_IO_MEMFD", "memfd" },
+            { GST_TCAM_IO_CUDA_PINNED, "GST_TCAM_IO_CUDA_PINNED", "cuda-pinned" },
 
             { 0, NULL, NULL }
         };
@@ -69,6 +76,47 @@ GType gst_tcam_io_mode_get_type(void)
 }
 
 
+GType gst_tcam_timestamp_mode_get_type(void)
+{
+    static GType tcam_timestamp_mode = 0;
+
+    if (!tcam_timestamp_mode)
+    {
+        static const GEnumValue timestamp_modes[] = {
+            { GST_TCAM_TIMESTAMP_NONE, "GST_TCAM_TIMESTAMP_NONE", "none" },
+            { GST_TCAM_TIMESTAMP_CAPTURE, "GST_TCAM_TIMESTAMP_CAPTURE", "capture" },
+            { GST_TCAM_TIMESTAMP_CAMERA, "GST_TCAM_TIMESTAMP_CAMERA", "camera" },
+
+            { 0, NULL, NULL }
+        };
+        tcam_timestamp_mode = g_enum_register_static("GstTcamTimestampMode", timestamp_modes);
+    }
+    return tcam_timestamp_mode;
+}
+
+
+GType gst_tcam_starvation_policy_get_type(void)
+{
+    static GType tcam_starvation_policy = 0;
+
+    if (!tcam_starvation_policy)
+    {
+        static const GEnumValue policies[] = {
+            { GST_TCAM_STARVATION_BLOCK, "GST_TCAM_STARVATION_BLOCK", "block" },
+            { GST_TCAM_STARVATION_DROP_NEWEST, "GST_TCAM_STARVATION_DROP_NEWEST", "drop-newest" },
+            { GST_TCAM_STARVATION_DROP_OLDEST_QUEUED,
+              "GST_TCAM_STARVATION_DROP_OLDEST_QUEUED",
+              "drop-oldest-queued" },
+            { GST_TCAM_STARVATION_GROW_POOL, "GST_TCAM_STARVATION_GROW_POOL", "grow-pool" },
+
+            { 0, NULL, NULL }
+        };
+        tcam_starvation_policy = g_enum_register_static("GstTcamStarvationPolicy", policies);
+    }
+    return tcam_starvation_policy;
+}
+
+
 enum
 {
     SIGNAL_DEVICE_OPEN,
@@ -85,7 +133,37 @@ enum
     PROP_NUM_BUFFERS,
     PROP_IO_MODE,
     PROP_DROP_INCOMPLETE_BUFFER,
+    PROP_SALVAGE_THRESHOLD,
+    PROP_RECONNECT_TIMEOUT,
     PROP_TCAM_PROPERTIES_GSTSTRUCT,
+    PROP_WARM_START,
+    PROP_FIRST_FRAME_LATENCY,
+    PROP_STATISTICS_INTERVAL,
+    PROP_SCENE_STATISTICS,
+    PROP_DEVICE_EVENTS,
+    PROP_GIGE_PACKET_SOCKET,
+    PROP_GIGE_SOCKET_BUFFER_SIZE,
+    PROP_GIGE_PACKET_RESEND,
+    PROP_GIGE_PACKET_TIMEOUT,
+    PROP_GIGE_FRAME_RETENTION,
+    PROP_RECEIVE_THREAD_AFFINITY,
+    PROP_RECEIVE_THREAD_PRIORITY,
+    PROP_USB_ASYNC_TRANSFERS,
+    PROP_USBFS_MEMORY,
+    PROP_CHUNK_DATA,
+    PROP_TIMESTAMP_MODE,
+    PROP_BUSY_WAIT,
+    PROP_STARVATION_POLICY,
+    PROP_MAX_EXTRA_BUFFERS,
+    PROP_STATISTICS_META,
+    PROP_FLIGHT_RECORDER_PRE_FRAMES,
+    PROP_FLIGHT_RECORDER_POST_FRAMES,
+    PROP_BURST_COUNT,
+    PROP_DECIMATION,
+    PROP_DECIMATION_AUTO_SAMPLING,
+    PROP_THREAD_POLICY,
+    PROP_REGIONS,
+    PROP_SOFTWARE_CROP,
 };
 
 static guint gst_tcammainsrc_signals[SIGNAL_LAST] = {
@@ -284,6 +362,30 @@ static gboolean gst_tcam_mainsrc_negotiate(GstBaseSrc* self)
 }
 
 
+// Replaces the steps of the width and height ranges with 1, see 'software-crop'
+static void remove_resolution_steps(GstCaps& caps)
+{
+    for (guint i = 0; i < gst_caps_get_size(&caps); ++i)
+    {
+        GstStructure* structure = gst_caps_get_structure(&caps, i);
+        for (const char* field : { "width", "height" })
+        {
+            const GValue* value = gst_structure_get_value(structure, field);
+            if (!value || !GST_VALUE_HOLDS_INT_RANGE(value)
+                || gst_value_get_int_range_step(value) == 1)
+            {
+                continue;
+            }
+            GValue range = G_VALUE_INIT;
+            g_value_init(&range, GST_TYPE_INT_RANGE);
+            gst_value_set_int_range(
+                &range, gst_value_get_int_range_min(value), gst_value_get_int_range_max(value));
+            gst_structure_take_value(structure, field, &range);
+        }
+    }
+}
+
+
 static GstCaps* gst_tcam_mainsrc_get_caps(GstBaseSrc* src, GstCaps* filter __attribute__((unused)))
 {
     GstTcamMainSrc* self = GST_TCAM_MAINSRC(src);
@@ -294,6 +396,27 @@ static GstCaps* gst_tcam_mainsrc_get_caps(GstBaseSrc* src, GstCaps* filter __att
         GST_WARNING_OBJECT(self, "Device not initialized. Must be in state >= GST_STATE_READY.");
         return nullptr;
     }
+
+    if (!self->device->regions_.empty())
+    {
+        // the stacked regions are transmitted as one image of this size
+        const auto size = tcam::calc_region_image_size(self->device->regions_);
+        for (guint i = 0; i < gst_caps_get_size(caps); ++i)
+        {
+            gst_structure_set(gst_caps_get_structure(caps, i),
+                              "width",
+                              G_TYPE_INT,
+                              static_cast<int>(size.width),
+                              "height",
+                              G_TYPE_INT,
+                              static_cast<int>(size.height),
+                              nullptr);
+        }
+    }
+    else if (self->device->software_crop_)
+    {
+        remove_resolution_steps(*caps);
+    }
     return caps;
 }
 
@@ -318,14 +441,30 @@ static gboolean gst_tcam_mainsrc_set_caps(GstBaseSrc* src, GstCaps* caps)
 
     self->fps = format.framerate;
 
-    self->device->format_ = tcam::VideoFormat(format);
-    if (!self->device->device_->set_video_format(tcam::VideoFormat(format)))
+    self->device->format_ = self->device->to_device_format(format);
+    if (!self->device->device_->set_video_format(self->device->format_))
     {
         GST_ERROR_OBJECT(self, "Unable to set format in device");
 
         return FALSE;
     }
 
+    const auto device_size = self->device->format_.get_size();
+    if (device_size.width != format.width || device_size.height != format.height)
+    {
+        GST_INFO_OBJECT(self,
+                        "The device streams %ux%u, the %ux%u of the caps are cropped from it.",
+                        device_size.width,
+                        device_size.height,
+                        format.width,
+                        format.height);
+        self->device->crop_size_ = { format.width, format.height };
+    }
+    else
+    {
+        self->device->crop_size_ = {};
+    }
+
     // self->device->device_->set_drop_incomplete_frames(state.drop_incomplete_frames_);
 
     // self->device->is_streaming_ = true;
@@ -335,30 +474,9 @@ static gboolean gst_tcam_mainsrc_set_caps(GstBaseSrc* src, GstCaps* caps)
 }
 
 
-static void gst_tcam_mainsrc_device_lost_callback(const tcam::tcam_device_info* info
-                                                  __attribute__((unused)),
-                                                  void* user_data)
+// Ends the stream with an error, the device is not coming back
+static void gst_tcam_mainsrc_post_device_lost(GstTcamMainSrc* self)
 {
-    GstTcamMainSrc* self = (GstTcamMainSrc*)user_data;
-
-    GstState state;
-
-    // wait for 1 seconds max
-    gst_element_get_state(GST_ELEMENT(self), &state, nullptr, 1000000000);
-
-    if (!self->device || state == GST_STATE_NULL)
-    {
-        // device does not exist
-        // or source is null (aka no device exists)
-        // do nothing
-        return;
-    }
-
-    if (!self->device->is_streaming_)
-    {
-        return;
-    }
-
     auto serial = self->device->get_device_serial();
 
     // set serial as args entry and in actual message
@@ -392,6 +510,40 @@ static void gst_tcam_mainsrc_device_lost_callback(const tcam::tcam_device_info*
     // gst_tcam_mainsrc_stop(GST_BASE_SRC(self));
 }
 
+
+static void gst_tcam_mainsrc_device_lost_callback(const tcam::tcam_device_info* info
+                                                  __attribute__((unused)),
+                                                  void* user_data)
+{
+    GstTcamMainSrc* self = (GstTcamMainSrc*)user_data;
+
+    GstState state;
+
+    // wait for 1 seconds max
+    gst_element_get_state(GST_ELEMENT(self), &state, nullptr, 1000000000);
+
+    if (!self->device || state == GST_STATE_NULL)
+    {
+        // device does not exist
+        // or source is null (aka no device exists)
+        // do nothing
+        return;
+    }
+
+    if (!self->device->is_streaming_)
+    {
+        return;
+    }
+
+    // with reconnect-timeout the pipeline waits for the device to return
+    if (self->device->start_reconnect([self] { gst_tcam_mainsrc_post_device_lost(self); }))
+    {
+        return;
+    }
+
+    gst_tcam_mainsrc_post_device_lost(self);
+}
+
 static bool gst_tcam_mainsrc_init_camera(GstTcamMainSrc* self)
 {
     if (!self->device->open_camera())
@@ -441,13 +593,15 @@ static GstStateChangeReturn gst_tcam_mainsrc_change_state(GstElement* element,
         case GST_STATE_CHANGE_READY_TO_PAUSED:
         {
             self->device->n_buffers_delivered_ = 0;
+            self->device->reset_statistics_summary();
+            self->device->reset_timestamps();
             ret = GST_STATE_CHANGE_NO_PREROLL;
             break;
         }
         case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
         {
             self->device->is_streaming_ = true;
-            self->device->stream_cv_.notify_all();
+            self->device->queue.notify_consumer();
             break;
         }
         default:
@@ -470,12 +624,13 @@ static GstStateChangeReturn gst_tcam_mainsrc_change_state(GstElement* element,
         case GST_STATE_CHANGE_PLAYING_TO_PAUSED:
         {
             self->device->is_streaming_ = false;
-            self->device->stream_cv_.notify_all();
+            self->device->queue.notify_consumer();
             ret = GST_STATE_CHANGE_NO_PREROLL;
             break;
         }
         case GST_STATE_CHANGE_PAUSED_TO_READY:
         {
+            self->device->stop_reconnect();
             bool stop_ret = self->device->device_->stop_stream();
             if (!stop_ret)
             {
@@ -637,9 +792,7 @@ static bool fetch_framerate_via_query_caps_worker(device_state& device,
     uint32_t fourcc = tcam::gst::tcam_fourcc_from_gst_1_0_caps_string(
         gst_structure_get_name(structure), format_string);
 
-    auto format_list = device.device_->get_available_video_formats();
-
-    auto fps_res = device.device_->get_framerate_info(
+    auto fps_res = device.get_framerate_info(
         tcam ::VideoFormat { fourcc, { (uint32_t)width, (uint32_t)height }, scale_info });
     if (fps_res.has_error())
     {
@@ -716,8 +869,16 @@ static gboolean gst_tcam_mainsrc_query(GstBaseSrc* bsrc, GstQuery* query)
                 goto done;
             }
 
-            /* min latency is the time to capture one frame/field */
-            min_latency = gst_util_gdouble_to_guint64(GST_SECOND / self->fps);
+            if (self->device->timestamp_mode_ == GST_TCAM_TIMESTAMP_NONE)
+            {
+                /* min latency is the time to capture one frame/field */
+                min_latency = gst_util_gdouble_to_guint64(GST_SECOND / self->fps);
+            }
+            else
+            {
+                /* PTS is the capture time, buffers are late by exposure and transfer */
+                min_latency = self->device->get_capture_latency(self->fps);
+            }
 
             /* max latency is set to NONE because cameras may enter trigger mode
                and not deliver images for an unspecified amount of time */
@@ -751,7 +912,8 @@ static gboolean gst_tcam_mainsrc_query(GstBaseSrc* bsrc, GstQuery* query)
 
             if (tcam::mainsrc::caps_to_format(*c, format))
             {
-                tcam::VideoFormat fmt(format);
+                // sizes between the steps are accepted with software-crop
+                const auto fmt = self->device->to_device_format(format);
                 auto formats = self->device->device_->get_available_video_formats();
 
                 for (const auto& f : formats)
@@ -887,6 +1049,33 @@ static bool is_state_ready_or_lower(GstTcamMainSrc* self)
 }
 
 
+// The int members of tcam_stream_transport_options that are set via properties
+static int* find_transport_option(tcam::tcam_stream_transport_options& opt, guint prop_id)
+{
+    switch (prop_id)
+    {
+        case PROP_GIGE_PACKET_SOCKET:
+            return &opt.packet_socket;
+        case PROP_GIGE_SOCKET_BUFFER_SIZE:
+            return &opt.socket_buffer_size;
+        case PROP_GIGE_PACKET_RESEND:
+            return &opt.packet_resend;
+        case PROP_GIGE_PACKET_TIMEOUT:
+            return &opt.packet_timeout_us;
+        case PROP_GIGE_FRAME_RETENTION:
+            return &opt.frame_retention_us;
+        case PROP_RECEIVE_THREAD_PRIORITY:
+            return &opt.receive_thread_priority;
+        case PROP_USB_ASYNC_TRANSFERS:
+            return &opt.usb_async_transfers;
+        case PROP_USBFS_MEMORY:
+            return &opt.usbfs_memory_mb;
+        default:
+            return nullptr;
+    }
+}
+
+
 static void gst_tcam_mainsrc_set_property(GObject* object,
                                           guint prop_id,
                                           const GValue* value,
@@ -1009,151 +1198,578 @@ static void gst_tcam_mainsrc_set_property(GObject* object,
             }
             break;
         }
+        case PROP_RECONNECT_TIMEOUT:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'reconnect-timeout' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+            }
+            else
+            {
+                state.reconnect_timeout_ms_ = g_value_get_uint(value);
+            }
+            break;
+        }
+        case PROP_SALVAGE_THRESHOLD:
+        {
+            state.salvage_threshold_ = g_value_get_double(value);
+            if (self->device->device_)
+            {
+                self->device->device_->set_salvage_threshold(state.salvage_threshold_);
+            }
+            break;
+        }
         case PROP_TCAM_PROPERTIES_GSTSTRUCT:
         {
             auto strc = gst_value_get_structure(value);
             self->device->set_tcam_properties(strc);
             break;
         }
-        default:
+        case PROP_WARM_START:
         {
-            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'warm-start' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+            }
+            else
+            {
+                state.warm_start_ = g_value_get_boolean(value) != FALSE;
+            }
             break;
         }
-    }
-}
-
-
-static void gst_tcam_mainsrc_get_property(GObject* object,
-                                          guint prop_id,
-                                          GValue* value,
-                                          GParamSpec* pspec)
-{
-    GstTcamMainSrc* self = GST_TCAM_MAINSRC(object);
-    auto& state = *self->device;
-
-    switch (prop_id)
-    {
-        case PROP_SERIAL:
+        case PROP_STATISTICS_INTERVAL:
         {
-            g_value_set_string(value, state.get_device_serial().c_str());
+            state.statistics_interval_ms_ = g_value_get_uint(value);
             break;
         }
-        case PROP_DEVICE_TYPE:
+        case PROP_SCENE_STATISTICS:
         {
-            g_value_set_string(value,
-                               tcam::tcam_device_type_to_string(state.get_device_type()).c_str());
-
+            state.scene_statistics_interval_ = g_value_get_uint(value);
             break;
         }
-        case PROP_CAMERA_BUFFERS:
+        case PROP_DEVICE_EVENTS:
         {
-            g_value_set_int(value, state.imagesink_buffers_);
+            const char* str = g_value_get_string(value);
+            state.device_events_ = str ? str : "";
+            state.apply_device_events();
             break;
         }
-        case PROP_NUM_BUFFERS:
+        case PROP_CHUNK_DATA:
         {
-            g_value_set_int(value, state.n_buffers_);
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'chunk-data' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+            }
+            else
+            {
+                state.chunk_data_ = g_value_get_boolean(value) != FALSE;
+            }
             break;
         }
-        case PROP_IO_MODE:
+        case PROP_TIMESTAMP_MODE:
         {
-            g_value_set_enum(value, state.io_mode_);
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'timestamp-mode' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+            }
+            else
+            {
+                state.timestamp_mode_ = (GstTcamTimestampMode)g_value_get_enum(value);
+            }
             break;
         }
-        case PROP_DROP_INCOMPLETE_BUFFER:
+        case PROP_BUSY_WAIT:
         {
-            g_value_set_boolean(value, state.drop_incomplete_frames_);
+            state.busy_wait_us_ = g_value_get_uint(value);
+            state.queue.set_spin_duration(std::chrono::microseconds(state.busy_wait_us_));
             break;
         }
-        case PROP_TCAM_PROPERTIES_GSTSTRUCT:
+        case PROP_STARVATION_POLICY:
         {
-            gst_helper::gst_ptr<GstStructure> ptr = self->device->get_tcam_properties();
-            gst_value_set_structure(value, ptr.get());
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'starvation-policy' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+            }
+            else
+            {
+                state.starvation_policy_ = (GstTcamStarvationPolicy)g_value_get_enum(value);
+            }
             break;
         }
-        default:
+        case PROP_MAX_EXTRA_BUFFERS:
         {
-            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'max-extra-buffers' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+            }
+            else
+            {
+                state.max_extra_buffers_ = g_value_get_uint(value);
+            }
             break;
         }
-    }
-}
-
-
-static gboolean tcam_mainsrc_decide_allocation(GstBaseSrc* base_src, GstQuery* query)
-{
-    GstTcamMainSrc* self = GST_TCAM_MAINSRC(base_src);
-
-    if (GST_QUERY_TYPE(query) != GST_QUERY_ALLOCATION)
-    {
-        return FALSE;
-    }
-
-    GstCaps* caps = gst_pad_get_current_caps(GST_BASE_SRC_PAD(base_src));
-
-    GST_DEBUG("Allocation caps: %s", gst_caps_to_string(caps));
-
-    tcam::tcam_video_format format;
-    tcam::mainsrc::caps_to_format(*caps, format);
-
-    gst_caps_unref(caps);
-
-
-    GstBufferPool* src_pool = gst_base_src_get_buffer_pool(GST_BASE_SRC(base_src));
-
-    if (src_pool)
-    {
-        // these steps are taking to prevent a reconfigure
-
-        if (gst_buffer_pool_is_active(self->pool))
+        case PROP_STATISTICS_META:
         {
-            GstBufferPool* pool = src_pool;
-            if (gst_query_get_n_allocation_pools(query))
+            if (!is_state_ready_or_lower(self))
             {
-                gst_query_set_nth_allocation_pool(
-                    query, 0, pool, self->device->format_.get_required_buffer_size(), 1, 0);
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'statistics-meta' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
             }
             else
             {
-                gst_query_add_allocation_pool(
-                    query, pool, self->device->format_.get_required_buffer_size(), 1, 0);
+                state.statistics_meta_ = g_value_get_boolean(value);
             }
+            break;
         }
-
-        gst_object_unref(src_pool);
-    }
-    else
-    {
-        if (self->pool)
+        case PROP_FLIGHT_RECORDER_PRE_FRAMES:
+        case PROP_FLIGHT_RECORDER_POST_FRAMES:
         {
-            gst_buffer_pool_set_active(self->pool, FALSE);
-
-            gst_object_unref(self->pool);
-            self->pool = nullptr;
-        }
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property '%s' is not writable in state >= "
+                                 "GST_STATE_PAUSED.",
+                                 pspec->name);
+            }
+            else if (prop_id == PROP_FLIGHT_RECORDER_PRE_FRAMES)
+            {
+                state.flight_recorder_pre_frames_ = g_value_get_uint(value);
+            }
+            else
+            {
+                state.flight_recorder_post_frames_ = g_value_get_uint(value);
+            }
+            break;
+        }
+        case PROP_BURST_COUNT:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'burst-count' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+            }
+            else
+            {
+                state.burst_count_ = g_value_get_uint(value);
+            }
+            break;
+        }
+        case PROP_DECIMATION:
+        {
+            state.set_decimation(g_value_get_uint(value), state.decimation_auto_sampling_);
+            break;
+        }
+        case PROP_DECIMATION_AUTO_SAMPLING:
+        {
+            state.set_decimation(state.decimation_, g_value_get_uint(value));
+            break;
+        }
+        case PROP_GIGE_PACKET_SOCKET:
+        case PROP_GIGE_SOCKET_BUFFER_SIZE:
+        case PROP_GIGE_PACKET_RESEND:
+        case PROP_GIGE_PACKET_TIMEOUT:
+        case PROP_GIGE_FRAME_RETENTION:
+        case PROP_RECEIVE_THREAD_PRIORITY:
+        case PROP_USB_ASYNC_TRANSFERS:
+        case PROP_USBFS_MEMORY:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property '%s' is not writable in state >= "
+                                 "GST_STATE_PAUSED.",
+                                 pspec->name);
+                return;
+            }
+            *find_transport_option(state.stream_transport_options_, prop_id) =
+                g_value_get_int(value);
+            break;
+        }
+        case PROP_RECEIVE_THREAD_AFFINITY:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'receive-thread-affinity' is not writable in "
+                                 "state >= GST_STATE_PAUSED.");
+                return;
+            }
+            const char* str = g_value_get_string(value);
+            if (str != nullptr && !tcam::parse_cpu_list(str))
+            {
+                GST_WARNING_OBJECT(self, "Unable to parse receive-thread-affinity '%s'", str);
+                return;
+            }
+            state.stream_transport_options_.receive_thread_cpu_affinity = str ? str : "";
+            break;
+        }
+        case PROP_THREAD_POLICY:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'thread-policy' is not writable in "
+                                 "state >= GST_STATE_PAUSED.");
+                return;
+            }
+            const char* str = g_value_get_string(value);
+            if (str != nullptr && !tcam::thread_policy::parse_rules(str))
+            {
+                GST_WARNING_OBJECT(self, "Unable to parse thread-policy '%s'", str);
+                return;
+            }
+            state.thread_policy_ = str ? str : "";
+            break;
+        }
+        case PROP_REGIONS:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'regions' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            const char* str = g_value_get_string(value);
+            if (!state.set_regions(str ? str : ""))
+            {
+                GST_WARNING_OBJECT(self, "Unable to parse regions '%s'", str);
+            }
+            break;
+        }
+        case PROP_SOFTWARE_CROP:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'software-crop' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.software_crop_ = g_value_get_boolean(value);
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static void gst_tcam_mainsrc_get_property(GObject* object,
+                                          guint prop_id,
+                                          GValue* value,
+                                          GParamSpec* pspec)
+{
+    GstTcamMainSrc* self = GST_TCAM_MAINSRC(object);
+    auto& state = *self->device;
+
+    switch (prop_id)
+    {
+        case PROP_SERIAL:
+        {
+            g_value_set_string(value, state.get_device_serial().c_str());
+            break;
+        }
+        case PROP_DEVICE_TYPE:
+        {
+            g_value_set_string(value,
+                               tcam::tcam_device_type_to_string(state.get_device_type()).c_str());
+
+            break;
+        }
+        case PROP_CAMERA_BUFFERS:
+        {
+            g_value_set_int(value, state.imagesink_buffers_);
+            break;
+        }
+        case PROP_NUM_BUFFERS:
+        {
+            g_value_set_int(value, state.n_buffers_);
+            break;
+        }
+        case PROP_IO_MODE:
+        {
+            g_value_set_enum(value, state.io_mode_);
+            break;
+        }
+        case PROP_DROP_INCOMPLETE_BUFFER:
+        {
+            g_value_set_boolean(value, state.drop_incomplete_frames_);
+            break;
+        }
+        case PROP_SALVAGE_THRESHOLD:
+        {
+            g_value_set_double(value, state.salvage_threshold_);
+            break;
+        }
+        case PROP_RECONNECT_TIMEOUT:
+        {
+            g_value_set_uint(value, state.reconnect_timeout_ms_);
+            break;
+        }
+        case PROP_TCAM_PROPERTIES_GSTSTRUCT:
+        {
+            gst_helper::gst_ptr<GstStructure> ptr = self->device->get_tcam_properties();
+            gst_value_set_structure(value, ptr.get());
+            break;
+        }
+        case PROP_WARM_START:
+        {
+            g_value_set_boolean(value, state.warm_start_);
+            break;
+        }
+        case PROP_FIRST_FRAME_LATENCY:
+        {
+            guint64 latency = 0;
+            if (state.device_)
+            {
+                latency = state.device_->get_first_frame_latency_ns();
+            }
+            g_value_set_uint64(value, latency);
+            break;
+        }
+        case PROP_STATISTICS_INTERVAL:
+        {
+            g_value_set_uint(value, state.statistics_interval_ms_);
+            break;
+        }
+        case PROP_SCENE_STATISTICS:
+        {
+            g_value_set_uint(value, state.scene_statistics_interval_);
+            break;
+        }
+        case PROP_DEVICE_EVENTS:
+        {
+            g_value_set_string(value, state.device_events_.c_str());
+            break;
+        }
+        case PROP_GIGE_PACKET_SOCKET:
+        case PROP_GIGE_SOCKET_BUFFER_SIZE:
+        case PROP_GIGE_PACKET_RESEND:
+        case PROP_GIGE_PACKET_TIMEOUT:
+        case PROP_GIGE_FRAME_RETENTION:
+        case PROP_RECEIVE_THREAD_PRIORITY:
+        case PROP_USB_ASYNC_TRANSFERS:
+        case PROP_USBFS_MEMORY:
+        {
+            g_value_set_int(value,
+                            *find_transport_option(state.stream_transport_options_, prop_id));
+            break;
+        }
+        case PROP_RECEIVE_THREAD_AFFINITY:
+        {
+            g_value_set_string(value,
+                               state.stream_transport_options_.receive_thread_cpu_affinity.c_str());
+            break;
+        }
+        case PROP_THREAD_POLICY:
+        {
+            g_value_set_string(value, state.thread_policy_.c_str());
+            break;
+        }
+        case PROP_REGIONS:
+        {
+            g_value_set_string(value, state.get_regions().c_str());
+            break;
+        }
+        case PROP_SOFTWARE_CROP:
+        {
+            g_value_set_boolean(value, state.software_crop_);
+            break;
+        }
+        case PROP_CHUNK_DATA:
+        {
+            g_value_set_boolean(value, state.chunk_data_);
+            break;
+        }
+        case PROP_TIMESTAMP_MODE:
+        {
+            g_value_set_enum(value, state.timestamp_mode_);
+            break;
+        }
+        case PROP_BUSY_WAIT:
+        {
+            g_value_set_uint(value, state.busy_wait_us_);
+            break;
+        }
+        case PROP_STARVATION_POLICY:
+        {
+            g_value_set_enum(value, state.starvation_policy_);
+            break;
+        }
+        case PROP_MAX_EXTRA_BUFFERS:
+        {
+            g_value_set_uint(value, state.max_extra_buffers_);
+            break;
+        }
+        case PROP_STATISTICS_META:
+        {
+            g_value_set_boolean(value, state.statistics_meta_);
+            break;
+        }
+        case PROP_FLIGHT_RECORDER_PRE_FRAMES:
+        {
+            g_value_set_uint(value, state.flight_recorder_pre_frames_);
+            break;
+        }
+        case PROP_FLIGHT_RECORDER_POST_FRAMES:
+        {
+            g_value_set_uint(value, state.flight_recorder_post_frames_);
+            break;
+        }
+        case PROP_BURST_COUNT:
+        {
+            g_value_set_uint(value, state.burst_count_);
+            break;
+        }
+        case PROP_DECIMATION:
+        {
+            g_value_set_uint(value, state.decimation_);
+            break;
+        }
+        case PROP_DECIMATION_AUTO_SAMPLING:
+        {
+            g_value_set_uint(value, state.decimation_auto_sampling_);
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static gboolean tcam_mainsrc_decide_allocation(GstBaseSrc* base_src, GstQuery* query)
+{
+    GstTcamMainSrc* self = GST_TCAM_MAINSRC(base_src);
+
+    if (GST_QUERY_TYPE(query) != GST_QUERY_ALLOCATION)
+    {
+        return FALSE;
+    }
+
+    GstCaps* caps = gst_pad_get_current_caps(GST_BASE_SRC_PAD(base_src));
+
+    GST_DEBUG("Allocation caps: %s", gst_caps_to_string(caps));
+
+    tcam::tcam_video_format format;
+    tcam::mainsrc::caps_to_format(*caps, format);
+    const auto device_format = self->device->to_device_format(format);
+
+    gst_caps_unref(caps);
+
+
+    GstBufferPool* src_pool = gst_base_src_get_buffer_pool(GST_BASE_SRC(base_src));
+
+    if (src_pool)
+    {
+        // these steps are taking to prevent a reconfigure
+
+        if (gst_buffer_pool_is_active(self->pool))
+        {
+            GstBufferPool* pool = src_pool;
+            if (gst_query_get_n_allocation_pools(query))
+            {
+                gst_query_set_nth_allocation_pool(
+                    query, 0, pool, self->device->format_.get_required_buffer_size(), 1, 0);
+            }
+            else
+            {
+                gst_query_add_allocation_pool(
+                    query, pool, self->device->format_.get_required_buffer_size(), 1, 0);
+            }
+        }
+
+        gst_object_unref(src_pool);
+    }
+    else
+    {
+        if (self->pool)
+        {
+            gst_buffer_pool_set_active(self->pool, FALSE);
+
+            gst_object_unref(self->pool);
+            self->pool = nullptr;
+        }
         self->pool = gst_tcam_buffer_pool_new(GST_ELEMENT(self), caps);
         unsigned int size = 10;
+        // the pool may still get fewer from the memory budget when it starts
+        const guint buffer_count = self->device->get_buffer_count(device_format);
+
+        if (self->device->io_mode_ == GST_TCAM_IO_DMABUF_IMPORT)
+        {
+            // the image memory will be taken from the downstream pool
+            GstBufferPool* downstream_pool = nullptr;
+            if (gst_query_get_n_allocation_pools(query) > 0)
+            {
+                gst_query_parse_nth_allocation_pool(
+                    query, 0, &downstream_pool, nullptr, nullptr, nullptr);
+            }
+
+            if (!downstream_pool)
+            {
+                GST_ELEMENT_ERROR(self,
+                                  RESOURCE,
+                                  SETTINGS,
+                                  ("io-mode dmabuf-import requires a downstream buffer pool."),
+                                  (NULL));
+                return FALSE;
+            }
+
+            auto* downstream_config = gst_buffer_pool_get_config(downstream_pool);
+            gst_buffer_pool_config_set_params(downstream_config,
+                                              caps,
+                                              device_format.get_required_buffer_size(),
+                                              buffer_count,
+                                              buffer_count);
+            if (!gst_buffer_pool_set_config(downstream_pool, downstream_config))
+            {
+                GST_WARNING_OBJECT(self, "Downstream pool did not accept the config as is.");
+            }
+
+            gst_tcam_buffer_pool_set_other_pool(GST_TCAM_BUFFER_POOL(self->pool), downstream_pool);
+            gst_object_unref(downstream_pool);
+        }
 
         auto* config = gst_buffer_pool_get_config(self->pool);
 
-        gst_buffer_pool_config_set_params(config, caps, tcam::VideoFormat(format).get_required_buffer_size(), 10, 10);
+        gst_buffer_pool_config_set_params(
+            config, caps, device_format.get_required_buffer_size(), 10, 10);
         gst_buffer_pool_set_config(self->pool, config);
 
         if (gst_query_get_n_allocation_pools(query))
         {
-            gst_query_set_nth_allocation_pool(
-                query, 0, self->pool, self->device->imagesink_buffers_, 1, 0);
+            gst_query_set_nth_allocation_pool(query, 0, self->pool, buffer_count, 1, 0);
         }
         else
         {
-            gst_query_add_allocation_pool(query, self->pool, size, self->device->imagesink_buffers_, 0);
+            gst_query_add_allocation_pool(query, self->pool, size, buffer_count, 0);
         }
 
         self->device->device_->set_drop_incomplete_frames(self->device->drop_incomplete_frames_);
+        self->device->device_->set_salvage_threshold(self->device->salvage_threshold_);
 
 
-        self->device->format_ = tcam::VideoFormat(format);
+        self->device->format_ = device_format;
 
         self->device->is_streaming_ = true;
 
@@ -1163,6 +1779,93 @@ static gboolean tcam_mainsrc_decide_allocation(GstBaseSrc* base_src, GstQuery* q
 }
 
 
+static gboolean gst_tcam_mainsrc_event(GstBaseSrc* bsrc, GstEvent* event)
+{
+    GstTcamMainSrc* self = GST_TCAM_MAINSRC(bsrc);
+
+    // 'tcam-auto-functions-roi, x=(uint), y=(uint), width=(uint), height=(uint)'
+    // An event without a size hands the ROI back to the AutoFunctionsROI properties.
+    if (GST_EVENT_TYPE(event) == GST_EVENT_CUSTOM_UPSTREAM
+        && gst_event_has_name(event, "tcam-auto-functions-roi"))
+    {
+        const GstStructure* strct = gst_event_get_structure(event);
+
+        guint x = 0;
+        guint y = 0;
+        guint width = 0;
+        guint height = 0;
+        gst_structure_get_uint(strct, "x", &x);
+        gst_structure_get_uint(strct, "y", &y);
+        if (gst_structure_get_uint(strct, "width", &width)
+            && gst_structure_get_uint(strct, "height", &height) && width > 0 && height > 0)
+        {
+            self->device->set_auto_functions_roi(tcam_image_roi { x, y, width, height });
+        }
+        else
+        {
+            self->device->set_auto_functions_roi(std::nullopt);
+        }
+        return TRUE;
+    }
+
+    // 'tcam-move-roi, x=(uint), y=(uint)'
+    // Writes OffsetX/OffsetY while streaming, images carry the offset in their statistics.
+    if (GST_EVENT_TYPE(event) == GST_EVENT_CUSTOM_UPSTREAM
+        && gst_event_has_name(event, "tcam-move-roi"))
+    {
+        const GstStructure* strct = gst_event_get_structure(event);
+
+        guint x = 0;
+        guint y = 0;
+        if (!gst_structure_get_uint(strct, "x", &x) || !gst_structure_get_uint(strct, "y", &y))
+        {
+            GST_WARNING_OBJECT(self, "tcam-move-roi requires the fields x and y");
+            return FALSE;
+        }
+        return self->device->move_roi(x, y) ? TRUE : FALSE;
+    }
+
+    // 'tcam-image-statistics, frame-count=(guint64), statistics=(GBytes)'
+    // Sent by tcamconvert with the auto_alg::channel_statistics of each converted image.
+    if (GST_EVENT_TYPE(event) == GST_EVENT_CUSTOM_UPSTREAM
+        && gst_event_has_name(event, "tcam-image-statistics"))
+    {
+        const GstStructure* strct = gst_event_get_structure(event);
+
+        guint64 frame_count = 0;
+        const GValue* value = gst_structure_get_value(strct, "statistics");
+        if (!gst_structure_get_uint64(strct, "frame-count", &frame_count) || !value
+            || !G_VALUE_HOLDS(value, G_TYPE_BYTES))
+        {
+            return FALSE;
+        }
+
+        gsize size = 0;
+        auto data = g_bytes_get_data(static_cast<GBytes*>(g_value_get_boxed(value)), &size);
+        if (size != sizeof(auto_alg::channel_statistics))
+        {
+            // built against another version of the struct
+            return FALSE;
+        }
+
+        // the data of GBytes has no alignment guarantee
+        auto_alg::channel_statistics stats;
+        memcpy(&stats, data, size);
+        return self->device->submit_channel_statistics(frame_count, stats) ? TRUE : FALSE;
+    }
+
+    // 'tcam-flight-recorder-trigger'
+    // Freezes the images around this moment, they are pushed while acquisition continues.
+    if (GST_EVENT_TYPE(event) == GST_EVENT_CUSTOM_UPSTREAM
+        && gst_event_has_name(event, "tcam-flight-recorder-trigger"))
+    {
+        return self->device->trigger_flight_recorder() ? TRUE : FALSE;
+    }
+
+    return GST_BASE_SRC_CLASS(gst_tcam_mainsrc_parent_class)->event(bsrc, event);
+}
+
+
 static void gst_tcam_mainsrc_class_init(GstTcamMainSrcClass* klass)
 {
     GObjectClass* gobject_class = G_OBJECT_CLASS(klass);
@@ -1197,8 +1900,9 @@ static void gst_tcam_mainsrc_class_init(GstTcamMainSrcClass* klass)
         PROP_CAMERA_BUFFERS,
         g_param_spec_int("camera-buffers",
                          "Number of Buffers",
-                         "Number of buffers to use for retrieving images",
-                         1,
+                         "Number of buffers to use for retrieving images, 0 sizes the pool from "
+                         "frame rate, downstream hold time and the process wide memory budget",
+                         0,
                          256,
                          GST_TCAM_MAINSRC_DEFAULT_N_BUFFERS,
                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
@@ -1233,6 +1937,30 @@ static void gst_tcam_mainsrc_class_init(GstTcamMainSrcClass* klass)
                              static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
                                                       | G_PARAM_CONSTRUCT)));
 
+    g_object_class_install_property(
+        gobject_class,
+        PROP_SALVAGE_THRESHOLD,
+        g_param_spec_double("salvage-threshold",
+                            "Salvage threshold",
+                            "Deliver incomplete buffers that lack at most this fraction of their "
+                            "lines, although drop-incomplete-buffer is set (0 = drop all)",
+                            0.0,
+                            1.0,
+                            0.0,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_RECONNECT_TIMEOUT,
+        g_param_spec_uint("reconnect-timeout",
+                          "Reconnect timeout",
+                          "Time in ms a device that is lost while streaming may take to return, "
+                          "the pipeline keeps running meanwhile (0 = post an error right away)",
+                          0,
+                          G_MAXUINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
     g_object_class_install_property(
         gobject_class,
         PROP_TCAM_PROPERTIES_GSTSTRUCT,
@@ -1248,6 +1976,338 @@ static void gst_tcam_mainsrc_class_init(GstTcamMainSrcClass* klass)
             GST_TYPE_STRUCTURE,
             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
+    g_object_class_install_property(
+        gobject_class,
+        PROP_WARM_START,
+        g_param_spec_boolean("warm-start",
+                             "Warm start",
+                             "Prefault and lock all buffers before the stream starts, "
+                             "to avoid page faults while the first images are captured.",
+                             false,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_FIRST_FRAME_LATENCY,
+        g_param_spec_uint64("first-frame-latency",
+                            "First frame latency",
+                            "Time in ns between stream start and the arrival of the first image "
+                            "(0 = no image received yet)",
+                            0,
+                            G_MAXUINT64,
+                            0,
+                            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_STATISTICS_INTERVAL,
+        g_param_spec_uint("statistics-interval",
+                          "Statistics interval",
+                          "Interval in ms in which a 'tcam-stream-statistics' element message with "
+                          "the frame and packet counters of the stream is posted on the bus "
+                          "(0 = disabled)",
+                          0,
+                          G_MAXUINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_SCENE_STATISTICS,
+        g_param_spec_uint("scene-statistics",
+                          "Scene statistics",
+                          "Post a 'tcam-scene-statistics' element message with the histogram, "
+                          "channel means, clipped fraction and sharpness of every n-th image "
+                          "(0 = disabled)",
+                          0,
+                          G_MAXUINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DEVICE_EVENTS,
+        g_param_spec_string("device-events",
+                            "Device events",
+                            "Comma separated list of GenICam events, e.g. "
+                            "'ExposureEnd,FrameTransferEnd', that are posted as "
+                            "'tcam-device-event' element messages as soon as the device sends "
+                            "them (GigE only)",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_GIGE_PACKET_SOCKET,
+        g_param_spec_int("gige-packet-socket",
+                         "GigE packet socket",
+                         "Receive GigE streams with a packet socket (packet_mmap) when the process "
+                         "has CAP_NET_RAW (-1 = TCAM_ARV_PACKET_SOCKET or aravis default, 0 = off, "
+                         "1 = on)",
+                         -1,
+                         1,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_GIGE_SOCKET_BUFFER_SIZE,
+        g_param_spec_int("gige-socket-buffer-size",
+                         "GigE socket buffer size",
+                         "Size of the receive socket buffer in bytes (-1 = aravis default, 0 = "
+                         "automatic)",
+                         -1,
+                         G_MAXINT,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_GIGE_PACKET_RESEND,
+        g_param_spec_int("gige-packet-resend",
+                         "GigE packet resend",
+                         "Request missing packets again (-1 = aravis default, 0 = never, "
+                         "1 = always)",
+                         -1,
+                         1,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_GIGE_PACKET_TIMEOUT,
+        g_param_spec_int("gige-packet-timeout",
+                         "GigE packet timeout",
+                         "Time in us before a missing packet is requested again (-1 = aravis "
+                         "default)",
+                         -1,
+                         G_MAXINT,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_GIGE_FRAME_RETENTION,
+        g_param_spec_int("gige-frame-retention",
+                         "GigE frame retention",
+                         "Time in us before an incomplete frame is given up (-1 = aravis default)",
+                         -1,
+                         G_MAXINT,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_RECEIVE_THREAD_AFFINITY,
+        g_param_spec_string("receive-thread-affinity",
+                            "Receive thread cpu affinity",
+                            "Comma separated list of cpu cores the aravis receive thread is pinned "
+                            "to, e.g. '0,2-3' (empty = TCAM_ARV_STREAM_THREAD_AFFINITY or no "
+                            "pinning)",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_THREAD_POLICY,
+        g_param_spec_string("thread-policy",
+                            "Thread policy",
+                            "Cpu affinity and scheduling of the threads of this device, rules in "
+                            "the syntax of TCAM_THREAD_POLICY, e.g. 'tcam_v4l2_strm:cpus=2:sched="
+                            "fifo:prio=50'. Rules without serial only apply to this device",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_REGIONS,
+        g_param_spec_string("regions",
+                            "Regions",
+                            "Sensor regions 'x,y,width,height;x,y,width,height' of a multi-region "
+                            "readout. The image holds them stacked from top to bottom, each one "
+                            "is described by a 'tcam-region' GstVideoRegionOfInterestMeta. Empty "
+                            "reads out a single region",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_SOFTWARE_CROP,
+        g_param_spec_boolean("software-crop",
+                             "Software crop",
+                             "Accept any width and height within the resolution ranges of the "
+                             "device. Sizes between the steps of a range are streamed as the "
+                             "next larger size, the GstVideoMeta of the buffers then describes "
+                             "the requested size with the stride of the larger image",
+                             TRUE,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_RECEIVE_THREAD_PRIORITY,
+        g_param_spec_int("receive-thread-priority",
+                         "Receive thread priority",
+                         "SCHED_FIFO priority of the aravis receive thread (-1 = "
+                         "TCAM_ARV_STREAM_THREAD_PRIORITY or the aravis real time default, 0 = "
+                         "default scheduling)",
+                         -1,
+                         99,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_USB_ASYNC_TRANSFERS,
+        g_param_spec_int("usb-async-transfers",
+                         "USB3 Vision asynchronous transfers",
+                         "Receive USB3 Vision streams with concurrent asynchronous transfers (-1 = "
+                         "TCAM_ARV_USB_ASYNC or for payloads above 1 MB, 0 = off, 1 = on)",
+                         -1,
+                         1,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_USBFS_MEMORY,
+        g_param_spec_int("usbfs-memory",
+                         "usbfs memory",
+                         "Minimum usbfs_memory_mb of the kernel in MB, raised when the process "
+                         "may (-1 = TCAM_ARV_USBFS_MEMORY_MB or enough for the open USB3 Vision "
+                         "streams, 0 = unchanged)",
+                         -1,
+                         G_MAXINT,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_CHUNK_DATA,
+        g_param_spec_boolean("chunk-data",
+                             "Chunk data",
+                             "Let GigE cameras send exposure time, gain and frame id with every "
+                             "image and add them to the TcamStatistics meta.",
+                             false,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TIMESTAMP_MODE,
+        g_param_spec_enum("timestamp-mode",
+                          "Timestamp mode",
+                          "Set the buffer PTS from the capture time of the backend or the camera "
+                          "clock, mapped to the pipeline clock. 'none' leaves it to do-timestamp.",
+                          GST_TYPE_TCAM_TIMESTAMP_MODE,
+                          GST_TCAM_TIMESTAMP_NONE,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_BUSY_WAIT,
+        g_param_spec_uint("busy-wait",
+                          "Busy wait",
+                          "Time in us the streaming thread polls for the next image before it "
+                          "sleeps. Hands images over without a thread wakeup at the cost of one "
+                          "busy cpu core (0 = sleep immediately)",
+                          0,
+                          G_MAXUINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_STARVATION_POLICY,
+        g_param_spec_enum("starvation-policy",
+                          "Starvation policy",
+                          "What to do when downstream holds so many buffers that the device would "
+                          "run out of buffers",
+                          GST_TYPE_TCAM_STARVATION_POLICY,
+                          GST_TCAM_STARVATION_BLOCK,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_MAX_EXTRA_BUFFERS,
+        g_param_spec_uint("max-extra-buffers",
+                          "Max extra buffers",
+                          "Number of image copies starvation-policy=grow-pool may hand out in "
+                          "addition to camera-buffers",
+                          0,
+                          1000,
+                          10,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_STATISTICS_META,
+        g_param_spec_boolean(
+            "statistics-meta",
+            "Statistics meta",
+            "Add the GstStructure based TcamStatisticsMeta to every buffer, "
+            "the TcamFrameMeta is always added",
+            TRUE,
+            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_FLIGHT_RECORDER_PRE_FRAMES,
+        g_param_spec_uint("flight-recorder-pre-frames",
+                          "Flight recorder pre trigger frames",
+                          "Images before a tcam-flight-recorder-trigger event that are pushed. "
+                          "With this or flight-recorder-post-frames > 0 only triggered windows "
+                          "go downstream",
+                          0,
+                          G_MAXUINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_FLIGHT_RECORDER_POST_FRAMES,
+        g_param_spec_uint("flight-recorder-post-frames",
+                          "Flight recorder post trigger frames",
+                          "Images after a tcam-flight-recorder-trigger event that are pushed",
+                          0,
+                          G_MAXUINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_BURST_COUNT,
+        g_param_spec_uint("burst-count",
+                          "Burst count",
+                          "Images of a burst the pool holds without dropping, they are pushed as "
+                          "fast as downstream takes them. 0 disables burst mode",
+                          0,
+                          tcam::buffer_budget::max_buffer_count,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DECIMATION,
+        g_param_spec_uint("decimation",
+                          "Decimation",
+                          "Push only every n-th image, the others are returned to the device "
+                          "before any processing",
+                          1,
+                          G_MAXUINT,
+                          1,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DECIMATION_AUTO_SAMPLING,
+        g_param_spec_uint("decimation-auto-sampling",
+                          "Decimation auto sampling",
+                          "Every n-th image skipped by decimation is still analyzed by the auto "
+                          "functions, 0 lets them see only the pushed images",
+                          0,
+                          G_MAXUINT,
+                          1,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
     gst_tcammainsrc_signals[SIGNAL_DEVICE_OPEN] = g_signal_new("device-open",
                                                                G_TYPE_FROM_CLASS(klass),
                                                                G_SIGNAL_RUN_LAST,
@@ -1287,6 +2347,7 @@ static void gst_tcam_mainsrc_class_init(GstTcamMainSrcClass* klass)
     gstbasesrc_class->fixate = gst_tcam_mainsrc_fixate_caps;
     gstbasesrc_class->negotiate = gst_tcam_mainsrc_negotiate;
     gstbasesrc_class->query = gst_tcam_mainsrc_query;
+    gstbasesrc_class->event = gst_tcam_mainsrc_event;
     gstbasesrc_class->decide_allocation = tcam_mainsrc_decide_allocation;
 
     gstpushsrc_class->create = gst_tcam_mainsrc_create;
@@ -44,10 +44,43 @@ typedef enum
     GST_TCAM_IO_AUTO = 0,
     GST_TCAM_IO_MMAP = 1,
     GST_TCAM_IO_USERPTR = 2,
-    //GST_TCAM_IO_DMABUF = 3,
-    //GST_TCAM_IO_DMABUF_IMPORT = 4,
+    GST_TCAM_IO_DMABUF = 3,
+    GST_TCAM_IO_DMABUF_IMPORT = 4,
+    // userptr into memfd backed memory, buffers are GstFdMemory
+    GST_TCAM_IO_MEMFD = 5,
+    // userptr into page locked memory from cudaHostAlloc, see tcam::CudaHostAllocator
+    GST_TCAM_IO_CUDA_PINNED = 6,
 } GstTcamIOMode;
 
+#define GST_TYPE_TCAM_TIMESTAMP_MODE (gst_tcam_timestamp_mode_get_type())
+GType gst_tcam_timestamp_mode_get_type(void);
+
+typedef enum
+{
+    // PTS is left to GstBaseSrc:do-timestamp
+    GST_TCAM_TIMESTAMP_NONE = 0,
+    // capture time of the backend, V4L2 buffer timestamp or aravis system timestamp
+    GST_TCAM_TIMESTAMP_CAPTURE = 1,
+    // timestamp of the camera clock, falls back to capture when the device has none
+    GST_TCAM_TIMESTAMP_CAMERA = 2,
+} GstTcamTimestampMode;
+
+#define GST_TYPE_TCAM_STARVATION_POLICY (gst_tcam_starvation_policy_get_type())
+GType gst_tcam_starvation_policy_get_type(void);
+
+// What happens when downstream holds so many buffers that the device would run out
+typedef enum
+{
+    // deliver every image, the device drops images until buffers are returned
+    GST_TCAM_STARVATION_BLOCK = 0,
+    // give the new image back to the device
+    GST_TCAM_STARVATION_DROP_NEWEST = 1,
+    // give the oldest image that is still queued for the streaming thread back to the device
+    GST_TCAM_STARVATION_DROP_OLDEST_QUEUED = 2,
+    // deliver a copy of the new image and give the buffer back, up to max-extra-buffers copies
+    GST_TCAM_STARVATION_GROW_POOL = 3,
+} GstTcamStarvationPolicy;
+
 struct _GstTcamMainSrc
 {
     GstPushSrc element;
@@ -16,6 +16,7 @@
 
 #include "gsttcamsrc.h"
 
+#include "../../../libs/gst-helper/include/tcamprop1.0_gobject/tcam_property_provider_simple_functions.h"
 #include "../../../libs/gst-helper/include/tcamprop1.0_gobject/tcam_property_serialize.h"
 #include "../../../libs/tcam-property/src/tcam-property-1.0.h"
 #include "../../base_types.h"
@@ -23,6 +24,7 @@
 #include "../../public_utils.h"
 #include "../tcamgstbase/tcamgstbase.h"
 #include "../tcamgstbase/tcamgstjson.h"
+#include "gsttcammainsrc.h"
 #include "tcambind.h"
 #include "tcamsrc_tcamprop_impl.h"
 
@@ -50,6 +52,10 @@ struct tcamsrc_state
     bool drop_incomplete_frames = true;
     bool do_timestamp = false;
     int num_buffers = -1;
+    guint statistics_interval_ms = 0;
+    guint scene_statistics = 0;
+    GstTcamTimestampMode timestamp_mode = GST_TCAM_TIMESTAMP_NONE;
+    GstTcamIOMode io_mode = GST_TCAM_IO_AUTO;
 
     gst_helper::gst_ptr<GstStructure> prop_init_gststructure_;
     std::string prop_init_json_;
@@ -101,6 +107,10 @@ enum
     PROP_TCAM_PROPERTIES_JSON,
     PROP_TCAMDEVICE,
     PROP_TCAM_PROPERTIES_GSTSTRUCT,
+    PROP_STATISTICS_INTERVAL,
+    PROP_TIMESTAMP_MODE,
+    PROP_IO_MODE,
+    PROP_SCENE_STATISTICS,
 };
 
 static tcamsrc::tcamsrc_state& get_element_state(GstTcamSrc* self)
@@ -139,6 +149,12 @@ static void emit_device_close(GstElement* /*object*/, void* user_data)
     g_signal_emit(G_OBJECT(user_data), gst_tcamsrc_signals[SIGNAL_DEVICE_CLOSE], 0);
 }
 
+static void emit_property_changed(GstElement* /*object*/, const char* name, void* user_data)
+{
+    // user-data is the tcamsrc instance
+    tcamprop1_gobj::provider_emit_property_changed(TCAM_PROPERTY_PROVIDER(user_data), name);
+}
+
 
 namespace
 {
@@ -271,6 +287,10 @@ static gboolean open_source_element(GstTcamSrc* self)
 
     g_signal_connect(
         G_OBJECT(new_device.get()), "device-close", G_CALLBACK(emit_device_close), self);
+    g_signal_connect(G_OBJECT(new_device.get()),
+                     "tcam-property-changed",
+                     G_CALLBACK(emit_property_changed),
+                     self);
 
     gst_element_set_name(new_device.get(), "source");
     auto state_change_res = gst_element_set_state(new_device.get(), GST_STATE_READY);
@@ -320,6 +340,34 @@ static gboolean open_source_element(GstTcamSrc* self)
 
     apply_element_property(self, PROP_DO_TIMESTAMP, &val_bool, nullptr);
 
+    GValue val_uint = G_VALUE_INIT;
+
+    g_value_init(&val_uint, G_TYPE_UINT);
+    g_value_set_uint(&val_uint, state.statistics_interval_ms);
+
+    apply_element_property(self, PROP_STATISTICS_INTERVAL, &val_uint, nullptr);
+
+    if (active_source_has_property(self, "timestamp-mode"))
+    {
+        g_object_set(G_OBJECT(state.active_source.get()),
+                     "timestamp-mode",
+                     state.timestamp_mode,
+                     nullptr);
+    }
+
+    if (active_source_has_property(self, "io-mode"))
+    {
+        g_object_set(G_OBJECT(state.active_source.get()), "io-mode", state.io_mode, nullptr);
+    }
+
+    if (active_source_has_property(self, "scene-statistics"))
+    {
+        g_object_set(G_OBJECT(state.active_source.get()),
+                     "scene-statistics",
+                     state.scene_statistics,
+                     nullptr);
+    }
+
     if (state.prop_init_gststructure_)
     {
         GValue tmp = G_VALUE_INIT;
@@ -572,6 +620,76 @@ static void apply_element_property(GstTcamSrc* self,
             }
             break;
         }
+        case PROP_STATISTICS_INTERVAL:
+        {
+            state.statistics_interval_ms = g_value_get_uint(value);
+            if (state.is_open())
+            {
+                if (active_source_has_property(self, "statistics-interval"))
+                {
+                    g_object_set_property(
+                        G_OBJECT(state.active_source.get()), "statistics-interval", value);
+                }
+                else
+                {
+                    GST_INFO_OBJECT(
+                        self, "Used source element does not support 'statistics-interval'.");
+                }
+            }
+            break;
+        }
+        case PROP_TIMESTAMP_MODE:
+        {
+            state.timestamp_mode = (GstTcamTimestampMode)g_value_get_enum(value);
+            if (state.is_open())
+            {
+                if (active_source_has_property(self, "timestamp-mode"))
+                {
+                    g_object_set_property(
+                        G_OBJECT(state.active_source.get()), "timestamp-mode", value);
+                }
+                else
+                {
+                    GST_INFO_OBJECT(self,
+                                    "Used source element does not support 'timestamp-mode'.");
+                }
+            }
+            break;
+        }
+        case PROP_IO_MODE:
+        {
+            state.io_mode = (GstTcamIOMode)g_value_get_enum(value);
+            if (state.is_open())
+            {
+                if (active_source_has_property(self, "io-mode"))
+                {
+                    g_object_set_property(G_OBJECT(state.active_source.get()), "io-mode", value);
+                }
+                else
+                {
+                    GST_INFO_OBJECT(self, "Used source element does not support 'io-mode'.");
+                }
+            }
+            break;
+        }
+        case PROP_SCENE_STATISTICS:
+        {
+            state.scene_statistics = g_value_get_uint(value);
+            if (state.is_open())
+            {
+                if (active_source_has_property(self, "scene-statistics"))
+                {
+                    g_object_set_property(
+                        G_OBJECT(state.active_source.get()), "scene-statistics", value);
+                }
+                else
+                {
+                    GST_INFO_OBJECT(self,
+                                    "Used source element does not support 'scene-statistics'.");
+                }
+            }
+            break;
+        }
         case PROP_TCAMDEVICE:
         {
             if (!is_state_null(self))
@@ -763,6 +881,26 @@ static void gst_tcam_src_get_property(GObject* object,
             }
             break;
         }
+        case PROP_STATISTICS_INTERVAL:
+        {
+            g_value_set_uint(value, state.statistics_interval_ms);
+            break;
+        }
+        case PROP_TIMESTAMP_MODE:
+        {
+            g_value_set_enum(value, state.timestamp_mode);
+            break;
+        }
+        case PROP_IO_MODE:
+        {
+            g_value_set_enum(value, state.io_mode);
+            break;
+        }
+        case PROP_SCENE_STATISTICS:
+        {
+            g_value_set_uint(value, state.scene_statistics);
+            break;
+        }
         case PROP_TCAM_PROPERTIES_JSON:
         {
             if (!state.is_open())
@@ -911,8 +1049,9 @@ static void gst_tcam_src_class_init(GstTcamSrcClass* klass)
         PROP_CAMERA_BUFFERS,
         g_param_spec_int("camera-buffers",
                          "Number of Buffers",
-                         "Number of buffers to use for retrieving images",
-                         1,
+                         "Number of buffers to use for retrieving images, 0 sizes the pool from "
+                         "frame rate, downstream hold time and the process wide memory budget",
+                         0,
                          256,
                          10,
                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
@@ -944,6 +1083,46 @@ static void gst_tcam_src_class_init(GstTcamSrcClass* klass)
                              true,
                              static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
                                                       | G_PARAM_CONSTRUCT)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_STATISTICS_INTERVAL,
+        g_param_spec_uint("statistics-interval",
+                          "Statistics interval",
+                          "Interval in ms in which the source posts a 'tcam-stream-statistics' "
+                          "element message on the bus (0 = disabled)",
+                          0,
+                          G_MAXUINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TIMESTAMP_MODE,
+        g_param_spec_enum("timestamp-mode",
+                          "Timestamp mode",
+                          "Source of the buffer PTS, see tcammainsrc",
+                          GST_TYPE_TCAM_TIMESTAMP_MODE,
+                          GST_TCAM_TIMESTAMP_NONE,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_IO_MODE,
+        g_param_spec_enum("io-mode",
+                          "IO Mode",
+                          "Memory the images are captured into, see tcammainsrc",
+                          GST_TYPE_TCAM_IO_MODE,
+                          GST_TCAM_IO_AUTO,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_SCENE_STATISTICS,
+        g_param_spec_uint("scene-statistics",
+                          "Scene statistics",
+                          "Post a 'tcam-scene-statistics' element message for every n-th image, "
+                          "see tcammainsrc (0 = disabled)",
+                          0,
+                          G_MAXUINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
 
     g_object_class_install_property(
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../../spsc_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace tcam::mainsrc
+{
+
+struct buffer_info;
+
+// Handoff queue between the device thread (single producer)
+// and the GstBaseSrc streaming thread (single consumer).
+//
+// push/try_pop are lock free.
+// The mutex/cv pair is only touched when the consumer has to sleep
+// because the queue is empty.
+// With a spin duration the consumer polls the queue for that long before it sleeps. Entries that
+// arrive in the meantime are handed over without any syscall on either side.
+// The producer may take back the oldest entry with reclaim, e.g. when the device runs out of
+// buffers.
+//
+// Every pool slot can be queued at most once, so a capacity
+// equal to the number of pool slots is sufficient.
+class buffer_queue
+{
+public:
+    // Not thread safe. Only call this while no thread is pushing or popping.
+    void reset(size_t capacity)
+    {
+        queue_.reset(capacity);
+    }
+
+    bool push(buffer_info* info) noexcept
+    {
+        if (queue_.push(std::move(info)))
+        {
+            // queue is full
+            return false;
+        }
+
+        // pairs with the fence in wait_pop, either we see the waiting flag or the consumer sees
+        // the new entry
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumer_waiting_.load())
+        {
+            std::lock_guard<std::mutex> lck(wait_mtx_);
+            wait_cv_.notify_one();
+        }
+        return true;
+    }
+
+    buffer_info* try_pop() noexcept
+    {
+        return queue_.pop().value_or(nullptr);
+    }
+
+    // Producer only. Removes the oldest entry that was not yet taken by the consumer.
+    buffer_info* reclaim() noexcept
+    {
+        return queue_.pop().value_or(nullptr);
+    }
+
+    // May be called from any thread, applies to the next wait_pop
+    void set_spin_duration(std::chrono::nanoseconds duration) noexcept
+    {
+        spin_ns_.store(duration.count(), std::memory_order_relaxed);
+    }
+
+    // Blocks until an entry is available or keep_waiting() returns false.
+    // Returns nullptr in the latter case.
+    template<class TPred> buffer_info* wait_pop(TPred keep_waiting)
+    {
+        if (auto ret = spin_pop(keep_waiting))
+        {
+            return ret;
+        }
+
+        while (true)
+        {
+            if (auto ret = try_pop())
+            {
+                return ret;
+            }
+            if (!keep_waiting())
+            {
+                return nullptr;
+            }
+
+            std::unique_lock<std::mutex> lck(wait_mtx_);
+            consumer_waiting_.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            wait_cv_.wait(lck, [this, &keep_waiting] { return !empty() || !keep_waiting(); });
+            consumer_waiting_.store(false);
+        }
+    }
+
+    // Wakes a sleeping consumer so that it re-evaluates its keep_waiting predicate.
+    void notify_consumer()
+    {
+        std::lock_guard<std::mutex> lck(wait_mtx_);
+        wait_cv_.notify_all();
+    }
+
+    bool empty() const noexcept
+    {
+        return queue_.empty();
+    }
+
+    // Number of queued entries, only a snapshot while the queue is in use
+    size_t size() const noexcept
+    {
+        return queue_.size();
+    }
+
+private:
+    template<class TPred> buffer_info* spin_pop(TPred& keep_waiting)
+    {
+        const auto spin = std::chrono::nanoseconds(spin_ns_.load(std::memory_order_relaxed));
+        if (spin.count() <= 0)
+        {
+            return nullptr;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + spin;
+        do
+        {
+            if (auto ret = try_pop())
+            {
+                return ret;
+            }
+            if (!keep_waiting())
+            {
+                return nullptr;
+            }
+            cpu_relax();
+        } while (std::chrono::steady_clock::now() < deadline);
+
+        return nullptr;
+    }
+
+    static void cpu_relax() noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield");
+#endif
+    }
+
+    tcam::spsc_queue<buffer_info*> queue_;
+
+    std::atomic<int64_t> spin_ns_ = 0;
+
+    std::atomic<bool> consumer_waiting_ = false;
+    std::mutex wait_mtx_;
+    std::condition_variable wait_cv_;
+};
+
+} // namespace tcam::mainsrc
@@ -16,23 +16,52 @@
 
 #include "mainsrc_device_state.h"
 
+#include "../../BufferBudget.h"
 #include "../../logging.h"
+#include "../../ThreadPolicy.h"
+#include "../../utils.h"
+#include "mainsrc_standby.h"
 #include "mainsrc_tcamprop_impl.h"
 #include "tcambind.h"
 #include "../tcamgstbase/tcamgststrings.h"
 #include "../tcamgstbase/tcamgstbase.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <tcamprop1.0_gobject/tcam_property_provider_simple_functions.h>
 #include <tcamprop1.0_gobject/tcam_property_serialize.h>
 
 #define GST_CAT_DEFAULT tcam_mainsrc_debug
 
 
-tcam::TCAM_MEMORY_TYPE tcam::mainsrc::io_mode_to_memory_type(GstTcamIOMode mode)
+tcam::TCAM_MEMORY_TYPE tcam::mainsrc::io_mode_to_memory_type(
+    GstTcamIOMode mode,
+    const std::vector<tcam::TCAM_MEMORY_TYPE>& supported)
 {
+    auto is_supported = [&supported](tcam::TCAM_MEMORY_TYPE t)
+    {
+        return std::find(supported.begin(), supported.end(), t) != supported.end();
+    };
+
     switch (mode)
     {
         case GST_TCAM_IO_AUTO:
+        {
+            // driver memory is neither pinned for every QBUF nor copied,
+            // exported as dmabuf downstream can also hand it on without mapping
+            if (is_supported(tcam::TCAM_MEMORY_TYPE_DMA))
+            {
+                return tcam::TCAM_MEMORY_TYPE_DMA;
+            }
+            if (is_supported(tcam::TCAM_MEMORY_TYPE_MMAP))
+            {
+                return tcam::TCAM_MEMORY_TYPE_MMAP;
+            }
+            return tcam::TCAM_MEMORY_TYPE_USERPTR;
+        }
         case GST_TCAM_IO_USERPTR:
+        case GST_TCAM_IO_MEMFD:
+        case GST_TCAM_IO_CUDA_PINNED:
         {
             return tcam::TCAM_MEMORY_TYPE_USERPTR;
         }
@@ -40,10 +69,14 @@ tcam::TCAM_MEMORY_TYPE tcam::mainsrc::io_mode_to_memory_type(GstTcamIOMode mode)
         {
             return tcam::TCAM_MEMORY_TYPE_MMAP;
         }
-        // case GST_TCAM_IO_DMABUF:
-        //     return tcam::TCAM_MEMORY_TYPE_DMA;
-        // case GST_TCAM_IO_DMABUF_IMPORT:
-        //     return tcam::TCAM_MEMORY_TYPE_DMA_IMPORT;
+        case GST_TCAM_IO_DMABUF:
+        {
+            return tcam::TCAM_MEMORY_TYPE_DMA;
+        }
+        case GST_TCAM_IO_DMABUF_IMPORT:
+        {
+            return tcam::TCAM_MEMORY_TYPE_DMA_IMPORT;
+        }
     }
     return tcam::TCAM_MEMORY_TYPE_USERPTR;
 }
@@ -57,10 +90,9 @@ GstTcamIOMode tcam::mainsrc::memory_type_to_io_mode(tcam::TCAM_MEMORY_TYPE t)
         case tcam::TCAM_MEMORY_TYPE_MMAP:
             return GST_TCAM_IO_MMAP;
         case tcam::TCAM_MEMORY_TYPE_DMA:
-        //     return GST_TCAM_IO_DMABUF;
+            return GST_TCAM_IO_DMABUF;
         case tcam::TCAM_MEMORY_TYPE_DMA_IMPORT:
-            break;
-        //     return GST_TCAM_IO_DMABUF_IMPORT;
+            return GST_TCAM_IO_DMABUF_IMPORT;
     }
     return GST_TCAM_IO_USERPTR;
 }
@@ -113,6 +145,61 @@ gboolean tcam::mainsrc::caps_to_format(GstCaps& c, tcam::tcam_video_format& form
 }
 
 
+// The next size of the range that is at least width x height, nullopt when there is none
+static std::optional<tcam::tcam_image_size> round_up_to_step(
+    const tcam::tcam_resolution_description& res,
+    unsigned int width,
+    unsigned int height) noexcept
+{
+    if (width < res.min_size.width || width > res.max_size.width || height < res.min_size.height
+        || height > res.max_size.height)
+    {
+        return std::nullopt;
+    }
+    auto round_up = [](unsigned int val, unsigned int min, unsigned int max, unsigned int step)
+    {
+        step = std::max(step, 1u);
+        return std::min(min + (val - min + step - 1) / step * step, max);
+    };
+    return tcam::tcam_image_size {
+        round_up(width, res.min_size.width, res.max_size.width, res.width_step_size),
+        round_up(height, res.min_size.height, res.max_size.height, res.height_step_size),
+    };
+}
+
+
+tcam::VideoFormat device_state::to_device_format(const tcam::tcam_video_format& format) const
+{
+    auto rval = tcam::VideoFormat(format);
+    rval.set_regions(regions_);
+    if (!software_crop_ || !regions_.empty() || !device_)
+    {
+        return rval;
+    }
+
+    for (const auto& desc : device_->get_available_video_formats())
+    {
+        if (desc.get_fourcc() != format.fourcc)
+        {
+            continue;
+        }
+        for (const auto& res : desc.get_resolutions())
+        {
+            if (res.type != tcam::TCAM_RESOLUTION_TYPE_RANGE || !(res.scaling == format.scaling))
+            {
+                continue;
+            }
+            if (auto size = round_up_to_step(res, format.width, format.height))
+            {
+                rval.set_size(size->width, size->height);
+                return rval;
+            }
+        }
+    }
+    return rval;
+}
+
+
 bool device_state::set_device_serial(const std::string& str) noexcept
 {
     std::lock_guard lck { device_open_mutex_ };
@@ -197,30 +284,213 @@ tcam::TCAM_DEVICE_TYPE device_state::get_device_type() const noexcept
     return device_type_to_open_;
 }
 
-GstCaps* device_state::get_device_caps() const
+GstCaps* device_state::get_device_caps()
 {
     std::lock_guard lck { device_open_mutex_ };
     if (all_caps_ == nullptr)
     {
         return nullptr;
     }
+
+    if (format_list_changed_.exchange(false))
+    {
+        auto caps = tcambind::convert_videoformatsdescription_to_caps(
+            *device_, device_->get_available_video_formats());
+        if (caps && gst_caps_get_size(caps.get()) != 0)
+        {
+            GST_DEBUG_OBJECT(parent_,
+                             "Device formats changed, caps are now: %s",
+                             gst_helper::to_string(*caps).c_str());
+            all_caps_ = caps;
+        }
+        else
+        {
+            GST_WARNING_OBJECT(parent_, "Failed to recreate caps for device. Keeping old caps.");
+        }
+    }
     return gst_caps_copy(all_caps_.get());
 }
 
 
+outcome::result<tcam::framerate_info> device_state::get_framerate_info(
+    const tcam::VideoFormat& fmt)
+{
+    if (!device_)
+    {
+        return tcam::status::DeviceCouldNotBeOpened;
+    }
+
+    std::lock_guard lck { framerate_cache_mtx_ };
+    for (const auto& [cached_fmt, info] : framerate_cache_)
+    {
+        if (cached_fmt == fmt)
+        {
+            return info;
+        }
+    }
+
+    auto res = device_->get_framerate_info(fmt);
+    if (res)
+    {
+        framerate_cache_.emplace_back(fmt, res.value());
+    }
+    return res;
+}
+
+
+void device_state::set_auto_functions_roi(const std::optional<tcam_image_roi>& roi) noexcept
+{
+    if (!device_)
+    {
+        return;
+    }
+
+    if (!device_->set_auto_functions_roi_override(roi))
+    {
+        GST_DEBUG_OBJECT(parent_, "Device has no software auto functions, ignoring the ROI.");
+    }
+}
+
+
+bool device_state::submit_channel_statistics(uint64_t frame_count,
+                                             const auto_alg::channel_statistics& stats) noexcept
+{
+    if (!device_)
+    {
+        return false;
+    }
+    return device_->submit_channel_statistics(frame_count, stats).has_value();
+}
+
+
+bool device_state::move_roi(uint32_t offset_x, uint32_t offset_y) noexcept
+{
+    if (!device_)
+    {
+        return false;
+    }
+
+    auto res = device_->move_roi(offset_x, offset_y);
+    if (!res)
+    {
+        GST_WARNING_OBJECT(parent_,
+                           "Unable to move the ROI to %u/%u: %s",
+                           offset_x,
+                           offset_y,
+                           res.error().message().c_str());
+        return false;
+    }
+    return true;
+}
+
+
+void device_state::on_property_changed(std::string_view name)
+{
+    // scaling is part of the format, these change the formats or their framerates
+    // an empty name ("something changed") does not invalidate, every aravis write sends one
+    static constexpr std::string_view format_properties[] = {
+        "Binning",
+        "Decimation",
+        "Skipping",
+        "DeviceLinkThroughputLimit",
+    };
+
+    const bool affects_formats = std::any_of(std::begin(format_properties),
+                                             std::end(format_properties),
+                                             [name](std::string_view prefix)
+                                             { return name.substr(0, prefix.size()) == prefix; });
+    if (!affects_formats)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard lck { framerate_cache_mtx_ };
+        framerate_cache_.clear();
+    }
+    format_list_changed_ = true;
+    tcamprop_container_.invalidate_names();
+}
+
+
 bool device_state::configure_stream()
 {
-    auto conf_res = device_->configure_stream(format_, sink, buffer_pool);
+    device_->set_stream_transport_options(stream_transport_options_);
+    device_->set_chunk_data_enabled(chunk_data_);
+    device_->set_decimation(decimation_, decimation_auto_sampling_);
+    device_->set_auto_reconnect(reconnect_timeout_ms_ > 0);
+
+    // the stream threads are started by start_stream and pick the rules up
+    if (auto rules = tcam::thread_policy::parse_rules(thread_policy_, get_device_serial()))
+    {
+        tcam::thread_policy::add_rules(*rules);
+    }
+
+    auto conf_res = device_->configure_stream(format_, sink, buffer_pool, warm_start_);
 
     if (!conf_res)
     {
         GST_ELEMENT_ERROR(parent_, CORE, CAPS, ("Failed to configure stream."), (NULL));
         return FALSE;
     }
+    // e.g. genicam features can be implemented only for some pixel formats
+    tcamprop_container_.invalidate_names();
     return TRUE;
 }
 
 
+void device_state::set_decimation(guint factor, guint auto_sampling)
+{
+    decimation_ = std::max(factor, 1u);
+    decimation_auto_sampling_ = auto_sampling;
+    if (device_)
+    {
+        device_->set_decimation(decimation_, decimation_auto_sampling_);
+    }
+}
+
+
+bool device_state::set_regions(const std::string& str)
+{
+    std::vector<tcam::tcam_image_region> regions;
+    if (!str.empty())
+    {
+        for (const auto& entry : tcam::split_string(str, ";"))
+        {
+            unsigned int x = 0;
+            unsigned int y = 0;
+            unsigned int width = 0;
+            unsigned int height = 0;
+            char rest = 0;
+            if (sscanf(entry.c_str(), "%u,%u,%u,%u%c", &x, &y, &width, &height, &rest) != 4
+                || width == 0 || height == 0)
+            {
+                return false;
+            }
+            regions.push_back({ x, y, width, height });
+        }
+    }
+    regions_ = std::move(regions);
+    return true;
+}
+
+
+std::string device_state::get_regions() const
+{
+    std::string str;
+    for (const auto& region : regions_)
+    {
+        if (!str.empty())
+        {
+            str += ';';
+        }
+        str += std::to_string(region.offset_x) + "," + std::to_string(region.offset_y) + ","
+               + std::to_string(region.width) + "," + std::to_string(region.height);
+    }
+    return str;
+}
+
+
 void device_state::start_stream()
 {
     if (device_)
@@ -230,6 +500,538 @@ void device_state::start_stream()
 }
 
 
+void device_state::reset_timestamps() noexcept
+{
+    timestamper_.reset();
+    reported_transfer_delay_ = GST_CLOCK_TIME_NONE;
+}
+
+
+GstClockTime device_state::get_capture_latency(double fps)
+{
+    GstClockTime exposure = 0;
+    if (device_)
+    {
+        auto exposure_time =
+            tcam::property::find_property<tcam::property::IPropertyFloat>(device_->get_properties(),
+                                                                           "ExposureTime");
+        if (exposure_time)
+        {
+            // ExposureTime is in us
+            if (auto value = exposure_time->get_value(); value && value.value() > 0.)
+            {
+                exposure = gst_util_gdouble_to_guint64(value.value() * GST_USECOND);
+            }
+        }
+    }
+
+    GstClockTime transfer = timestamper_.get_delay();
+    if (!GST_CLOCK_TIME_IS_VALID(transfer))
+    {
+        transfer = fps > 0. ? gst_util_gdouble_to_guint64(GST_SECOND / fps) : 0;
+    }
+    reported_transfer_delay_ = transfer;
+
+    return exposure + transfer;
+}
+
+
+void device_state::check_capture_latency()
+{
+    const GstClockTime reported = reported_transfer_delay_;
+    const GstClockTime delay = timestamper_.get_delay();
+    if (!GST_CLOCK_TIME_IS_VALID(reported) || !GST_CLOCK_TIME_IS_VALID(delay))
+    {
+        return;
+    }
+
+    // ignore small changes, every latency message reconfigures the whole pipeline
+    if (delay <= reported + std::max(reported / 4, GST_MSECOND))
+    {
+        return;
+    }
+
+    GST_INFO_OBJECT(parent_,
+                    "Capture delay %" GST_TIME_FORMAT " exceeds the reported latency.",
+                    GST_TIME_ARGS(delay));
+
+    // only post once until the next query
+    reported_transfer_delay_ = delay;
+    gst_element_post_message(GST_ELEMENT(parent_), gst_message_new_latency(GST_OBJECT(parent_)));
+}
+
+
+void device_state::reset_statistics_summary() noexcept
+{
+    statistics_summary_ = {};
+    push_delay_count_ = 0;
+    push_delay_sum_ns_ = 0;
+    push_delay_max_ns_ = 0;
+    starved_since_ns_ = 0;
+    starved_accounted_ns_ = 0;
+    starved_ns_ = 0;
+    starvation_drops_ = 0;
+    extra_buffers_ = 0;
+    scene_statistics_images_ = 0;
+}
+
+
+static int64_t get_steady_time_ns() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+
+void device_state::begin_starvation() noexcept
+{
+    int64_t expected = 0;
+    if (!starved_since_ns_.compare_exchange_strong(expected, get_steady_time_ns()))
+    {
+        // already starved
+        return;
+    }
+
+    GST_DEBUG_OBJECT(parent_,
+                     "Device ran out of buffers. %zu of %zu buffers are held downstream.",
+                     buffers_outstanding_.load(),
+                     pool_size_.load());
+    post_starvation_message(true, 0);
+}
+
+
+void device_state::end_starvation() noexcept
+{
+    if (starved_since_ns_.load() == 0 || buffers_outstanding_ + 1 >= pool_size_)
+    {
+        return;
+    }
+
+    const int64_t since = starved_since_ns_.exchange(0);
+    if (since == 0)
+    {
+        return;
+    }
+
+    const int64_t now = get_steady_time_ns();
+    const auto duration = static_cast<uint64_t>(std::max<int64_t>(now - since, 0));
+
+    // the statistics summary may already have counted the beginning of the period
+    const int64_t accounted = std::max(since, starved_accounted_ns_.load());
+    starved_ns_.fetch_add(static_cast<uint64_t>(std::max<int64_t>(now - accounted, 0)),
+                          std::memory_order_relaxed);
+
+    post_starvation_message(false, duration);
+}
+
+
+void device_state::post_starvation_message(bool starved, uint64_t duration_ns)
+{
+    GValue policy = G_VALUE_INIT;
+    g_value_init(&policy, GST_TYPE_TCAM_STARVATION_POLICY);
+    g_value_set_enum(&policy, starvation_policy_);
+
+    GstStructure* struc = gst_structure_new("tcam-buffer-starvation",
+                                            "starved",
+                                            G_TYPE_BOOLEAN,
+                                            starved,
+                                            "duration_ns",
+                                            G_TYPE_UINT64,
+                                            duration_ns,
+                                            "pool_size",
+                                            G_TYPE_UINT64,
+                                            static_cast<guint64>(pool_size_.load()),
+                                            "pool_outstanding",
+                                            G_TYPE_UINT64,
+                                            static_cast<guint64>(buffers_outstanding_.load()),
+                                            "queue_depth",
+                                            G_TYPE_UINT64,
+                                            static_cast<guint64>(queue.size()),
+                                            nullptr);
+    gst_structure_set_value(struc, "policy", &policy);
+    g_value_unset(&policy);
+
+    gst_element_post_message(GST_ELEMENT(parent_),
+                             gst_message_new_element(GST_OBJECT(parent_), struc));
+}
+
+
+void device_state::update_pool_metrics() noexcept
+{
+    if (pool_outstanding_metric_)
+    {
+        pool_outstanding_metric_->set(static_cast<int64_t>(buffers_outstanding_.load()));
+        pool_size_metric_->set(static_cast<int64_t>(pool_size_.load()));
+    }
+}
+
+
+size_t device_state::get_buffer_count(const tcam::VideoFormat& format) const noexcept
+{
+    if (burst_count_ > 0)
+    {
+        // a whole burst plus the buffers in flight, so that no image of it is dropped
+        return std::max(burst_count_.load() + tcam::buffer_budget::in_flight_buffers,
+                        is_buffer_count_auto() ? size_t { 0 } : size_t(imagesink_buffers_));
+    }
+    if (!is_buffer_count_auto())
+    {
+        return static_cast<size_t>(imagesink_buffers_);
+    }
+    // downstream only holds the images that are not skipped by decimation
+    return tcam::buffer_budget::calc_buffer_count(
+        format.get_framerate() / decimation_, std::chrono::microseconds(hold_time_peak_us_.load()));
+}
+
+
+size_t device_state::reserve_buffer_budget(const tcam::VideoFormat& format, size_t buffer_size)
+{
+    release_buffer_budget();
+
+    const size_t wanted = get_buffer_count(format);
+    // a fixed camera-buffers is always granted, it still counts against the budget of the others
+    // a burst is always granted as well
+    const size_t min_count = is_buffer_count_auto() && burst_count_ == 0
+                                 ? tcam::buffer_budget::min_buffer_count
+                                 : wanted;
+
+    const size_t count = tcam::buffer_budget::reserve_buffers(buffer_size, wanted, min_count);
+
+    budget_buffer_size_ = buffer_size;
+    budget_reserved_bytes_ = count * buffer_size;
+
+    if (is_buffer_count_auto())
+    {
+        GST_INFO_OBJECT(parent_,
+                        "Using %zu buffers, downstream held buffers for up to %" G_GINT64_FORMAT
+                        " us.",
+                        count,
+                        hold_time_peak_us_.load());
+    }
+    return count;
+}
+
+
+void device_state::release_buffer_budget() noexcept
+{
+    tcam::buffer_budget::release(budget_reserved_bytes_);
+    budget_reserved_bytes_ = 0;
+}
+
+
+void device_state::record_hold_time(std::chrono::nanoseconds hold) noexcept
+{
+    const int64_t sample = std::chrono::duration_cast<std::chrono::microseconds>(hold).count();
+
+    // a peak that decays by 1/64 per buffer, one long hold is remembered for a few seconds
+    int64_t cur = hold_time_peak_us_.load(std::memory_order_relaxed);
+    int64_t next = 0;
+    do
+    {
+        next = std::max(sample, cur - cur / 64);
+    } while (!hold_time_peak_us_.compare_exchange_weak(cur, next, std::memory_order_relaxed));
+}
+
+
+bool device_state::prepare_flight_recorder(const tcam::VideoFormat& format, size_t buffer_size)
+{
+    if (flight_recorder_pre_frames_ == 0 && flight_recorder_post_frames_ == 0)
+    {
+        flight_recorder_ = nullptr;
+        return true;
+    }
+
+    tcam::flight_recorder_options options;
+    options.pre_trigger_frames = flight_recorder_pre_frames_;
+    options.post_trigger_frames = flight_recorder_post_frames_;
+
+    flight_recorder_ = std::make_unique<tcam::FlightRecorder>(options);
+    if (auto res = flight_recorder_->allocate(format, buffer_size); !res)
+    {
+        GST_ELEMENT_ERROR(parent_,
+                          RESOURCE,
+                          NO_SPACE_LEFT,
+                          ("Unable to allocate the flight recorder"),
+                          ("%s", res.error().message().c_str()));
+        flight_recorder_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+
+bool device_state::trigger_flight_recorder() noexcept
+{
+    if (!flight_recorder_)
+    {
+        GST_WARNING_OBJECT(parent_,
+                           "tcam-flight-recorder-trigger requires flight-recorder-pre-frames or "
+                           "flight-recorder-post-frames.");
+        return false;
+    }
+    if (!flight_recorder_->trigger())
+    {
+        GST_INFO_OBJECT(parent_,
+                        "Flight recorder is still collecting the last window, ignoring trigger.");
+        return false;
+    }
+    return true;
+}
+
+
+void device_state::add_push_delay(std::chrono::nanoseconds delay) noexcept
+{
+    if (statistics_interval_ms_ == 0)
+    {
+        return;
+    }
+
+    const auto ns = static_cast<uint64_t>(std::max<int64_t>(delay.count(), 0));
+    push_delay_sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+    push_delay_count_.fetch_add(1, std::memory_order_relaxed);
+
+    // only the streaming thread raises the maximum, the device thread resets it
+    if (ns > push_delay_max_ns_.load(std::memory_order_relaxed))
+    {
+        push_delay_max_ns_.store(ns, std::memory_order_relaxed);
+    }
+}
+
+void device_state::update_statistics_summary(const tcam::tcam_stream_statistics& stats) noexcept
+{
+    const guint interval_ms = statistics_interval_ms_;
+    if (interval_ms == 0)
+    {
+        return;
+    }
+
+    auto& sum = statistics_summary_;
+    const gint64 now_us = g_get_monotonic_time();
+    if (sum.interval_start_us == 0)
+    {
+        sum.interval_start_us = now_us;
+    }
+
+    sum.frames++;
+    sum.receive_duration_sum_ns += stats.receive_duration_ns;
+    sum.receive_duration_max_ns = std::max(sum.receive_duration_max_ns, stats.receive_duration_ns);
+
+    const gint64 elapsed_us = now_us - sum.interval_start_us;
+    if (elapsed_us < static_cast<gint64>(interval_ms) * 1000)
+    {
+        return;
+    }
+
+    const uint64_t push_delay_count = push_delay_count_.exchange(0);
+    const uint64_t push_delay_sum_ns = push_delay_sum_ns_.exchange(0);
+    const uint64_t push_delay_max_ns = push_delay_max_ns_.exchange(0);
+
+    // include the running starvation period up to now
+    uint64_t starved_ns = starved_ns_.exchange(0);
+    if (const int64_t since = starved_since_ns_.load(); since != 0)
+    {
+        const int64_t now_ns = get_steady_time_ns();
+        const int64_t accounted = std::max(since, starved_accounted_ns_.exchange(now_ns));
+        starved_ns += static_cast<uint64_t>(std::max<int64_t>(now_ns - accounted, 0));
+    }
+
+    GstStructure* struc = gst_structure_new("tcam-stream-statistics",
+                                            "interval_ns",
+                                            G_TYPE_UINT64,
+                                            static_cast<guint64>(elapsed_us) * 1000,
+                                            "frames",
+                                            G_TYPE_UINT64,
+                                            sum.frames,
+                                            "frame_count",
+                                            G_TYPE_UINT64,
+                                            stats.frame_count,
+                                            "frames_dropped",
+                                            G_TYPE_UINT64,
+                                            stats.frames_dropped,
+                                            "resent_packets",
+                                            G_TYPE_UINT64,
+                                            stats.resent_packets,
+                                            "missing_packets",
+                                            G_TYPE_UINT64,
+                                            stats.missing_packets,
+                                            "underruns",
+                                            G_TYPE_UINT64,
+                                            stats.underruns,
+                                            "receive_duration_avg_ns",
+                                            G_TYPE_UINT64,
+                                            sum.receive_duration_sum_ns / sum.frames,
+                                            "receive_duration_max_ns",
+                                            G_TYPE_UINT64,
+                                            sum.receive_duration_max_ns,
+                                            "push_delay_avg_ns",
+                                            G_TYPE_UINT64,
+                                            push_delay_count ? push_delay_sum_ns / push_delay_count
+                                                             : 0,
+                                            "push_delay_max_ns",
+                                            G_TYPE_UINT64,
+                                            push_delay_max_ns,
+                                            "pool_size",
+                                            G_TYPE_UINT64,
+                                            static_cast<guint64>(pool_size_.load()),
+                                            "pool_outstanding",
+                                            G_TYPE_UINT64,
+                                            static_cast<guint64>(buffers_outstanding_.load()),
+                                            "queue_depth",
+                                            G_TYPE_UINT64,
+                                            static_cast<guint64>(queue.size()),
+                                            "starved_ns",
+                                            G_TYPE_UINT64,
+                                            starved_ns,
+                                            "starvation_drops",
+                                            G_TYPE_UINT64,
+                                            starvation_drops_.exchange(0),
+                                            "extra_buffers",
+                                            G_TYPE_UINT64,
+                                            extra_buffers_.exchange(0),
+                                            nullptr);
+
+    gst_element_post_message(GST_ELEMENT(parent_),
+                             gst_message_new_element(GST_OBJECT(parent_), struc));
+
+    sum = {};
+    sum.interval_start_us = now_us;
+}
+
+void device_state::post_scene_statistics(const tcam::ImageBuffer& buffer)
+{
+    const guint interval = scene_statistics_interval_;
+    if (interval == 0 || scene_statistics_images_++ % interval != 0)
+    {
+        return;
+    }
+
+    if (!scene_statistics_)
+    {
+        scene_statistics_ = auto_alg::make_statistics_ptr();
+    }
+
+    const auto img = buffer.get_img_descriptor();
+
+    // the same sparse sampling the software auto functions use, brightness_roi 0 is the whole image
+    auto_alg::scene_statistics scene;
+    auto_alg::collect_image_statistics(*scene_statistics_, img, auto_alg::auto_pass_params {});
+    if (!auto_alg::get_scene_statistics(*scene_statistics_, scene))
+    {
+        GST_LOG_OBJECT(parent_, "No scene statistics for image format.");
+        return;
+    }
+
+    // keep the contrast measurement around 1024 pixels wide, it reads whole lines
+    const int sharpness = auto_alg::calc_image_sharpness(img, std::max(img.dim.cx / 1024, 1));
+
+    GValue histogram = G_VALUE_INIT;
+    g_value_init(&histogram, GST_TYPE_ARRAY);
+    for (auto bin : scene.histogram)
+    {
+        GValue val = G_VALUE_INIT;
+        g_value_init(&val, G_TYPE_UINT);
+        g_value_set_uint(&val, bin);
+        gst_value_array_append_and_take_value(&histogram, &val);
+    }
+
+    const auto stats = buffer.get_statistics();
+    GstStructure* struc = gst_structure_new("tcam-scene-statistics",
+                                            "frame_count",
+                                            G_TYPE_UINT64,
+                                            stats.frame_count,
+                                            "capture_time_ns",
+                                            G_TYPE_UINT64,
+                                            stats.capture_time_ns,
+                                            "sample_count",
+                                            G_TYPE_INT,
+                                            scene.sample_count,
+                                            "brightness",
+                                            G_TYPE_DOUBLE,
+                                            static_cast<double>(scene.brightness),
+                                            "mean_r",
+                                            G_TYPE_DOUBLE,
+                                            static_cast<double>(scene.mean_r),
+                                            "mean_g",
+                                            G_TYPE_DOUBLE,
+                                            static_cast<double>(scene.mean_g),
+                                            "mean_b",
+                                            G_TYPE_DOUBLE,
+                                            static_cast<double>(scene.mean_b),
+                                            "clipped_fraction",
+                                            G_TYPE_DOUBLE,
+                                            static_cast<double>(scene.clipped_fraction),
+                                            "sharpness",
+                                            G_TYPE_INT,
+                                            sharpness,
+                                            nullptr);
+    gst_structure_take_value(struc, "histogram", &histogram);
+
+    gst_element_post_message(GST_ELEMENT(parent_),
+                             gst_message_new_element(GST_OBJECT(parent_), struc));
+}
+
+bool device_state::apply_device_events()
+{
+    if (!device_)
+    {
+        return true;
+    }
+
+    std::vector<std::string> events;
+    for (size_t begin = 0; begin <= device_events_.size();)
+    {
+        auto end = std::min(device_events_.find(',', begin), device_events_.size());
+        auto name = device_events_.substr(begin, end - begin);
+        name.erase(0, name.find_first_not_of(' '));
+        name.erase(name.find_last_not_of(' ') + 1);
+        if (!name.empty())
+        {
+            events.push_back(name);
+        }
+        begin = end + 1;
+    }
+
+    auto res = device_->set_device_event_callback(
+        events, [this](const tcam::tcam_device_event& event) { post_device_event(event); });
+    if (!res)
+    {
+        GST_WARNING_OBJECT(parent_,
+                           "Unable to enable the device events '%s': %s",
+                           device_events_.c_str(),
+                           res.error().message().c_str());
+        return false;
+    }
+    return true;
+}
+
+void device_state::post_device_event(const tcam::tcam_device_event& event)
+{
+    GstStructure* struc = gst_structure_new("tcam-device-event",
+                                            "name",
+                                            G_TYPE_STRING,
+                                            event.name.c_str(),
+                                            "event_id",
+                                            G_TYPE_UINT,
+                                            static_cast<guint>(event.event_id),
+                                            "stream_channel",
+                                            G_TYPE_UINT,
+                                            static_cast<guint>(event.stream_channel),
+                                            "block_id",
+                                            G_TYPE_UINT64,
+                                            event.block_id,
+                                            "timestamp_ns",
+                                            G_TYPE_UINT64,
+                                            event.timestamp_ns,
+                                            "arrival_time_ns",
+                                            G_TYPE_UINT64,
+                                            event.arrival_time_ns,
+                                            nullptr);
+
+    gst_element_post_message(GST_ELEMENT(parent_),
+                             gst_message_new_element(GST_OBJECT(parent_), struc));
+}
+
 void device_state::stop_stream()
 {
     if (device_ && is_streaming_)
@@ -237,6 +1039,11 @@ void device_state::stop_stream()
         device_->stop_stream();
     }
     is_streaming_ = false;
+
+    if (flight_recorder_)
+    {
+        flight_recorder_->interrupt();
+    }
 }
 
 
@@ -246,19 +1053,33 @@ void device_state::stop_and_clear()
     {
         device_->stop_stream();
     }
-    while (!queue.empty())
+    while (auto info = queue.try_pop())
     {
-        auto ptr = queue.front();
-        queue.pop();
+        if (!info->tcam_buffer)
+        {
+            // copy made by grow-pool
+            gst_buffer_unref(info->gst_buffer);
+            info->gst_buffer = nullptr;
+            continue;
+        }
+        if (!info->pooled)
+        {
+            info->pooled = true;
+            buffers_outstanding_--;
+        }
         if (sink)
         {
-            sink->requeue_buffer(ptr.tcam_buffer);
+            sink->requeue_buffer(info->tcam_buffer);
         }
     }
+    update_pool_metrics();
 }
 
 void device_state::close()
 {
+    // takes stream_mtx_
+    stop_reconnect();
+
     std::lock_guard<std::mutex> lck(stream_mtx_);
 
     // clear list to ensure property users get a no device error
@@ -266,11 +1087,26 @@ void device_state::close()
     tcamprop_interface_.clear();
     if (device_)
     {
+        unsubscribe_property_changes();
+        if (!device_events_.empty())
+        {
+            // the callback refers to this
+            device_->set_device_event_callback({}, nullptr);
+        }
+
         stop_and_clear();
 
+        // the pool memory belongs to the allocator of the device,
+        // it has to be released while the device is still open
+        buffer_pool = nullptr;
         device_ = nullptr;
         sink = nullptr;
+        release_buffer_budget();
         all_caps_.reset();
+        format_list_changed_ = false;
+
+        std::lock_guard cache_lck { framerate_cache_mtx_ };
+        framerate_cache_.clear();
     }
 }
 
@@ -282,7 +1118,7 @@ void device_state::populate_tcamprop_interface()
 
     for (auto& p : properties)
     {
-        auto prop = tcam::mainsrc::make_wrapper_instance(p);
+        auto prop = tcam::mainsrc::make_wrapper_instance(p, device_, write_latency_metric_);
         if (prop)
         {
 #if !NDEBUG
@@ -301,10 +1137,151 @@ void device_state::populate_tcamprop_interface()
         }
     }
 
+    tcamprop_interface_.build_index();
     tcamprop_container_.create_list(&tcamprop_interface_);
 }
 
 
+void device_state::subscribe_property_changes()
+{
+    property_notifier_subscription_ = device_->get_property_notifier()->subscribe(
+        [this, provider = TCAM_PROPERTY_PROVIDER(parent_)](std::string_view name)
+        {
+            on_property_changed(name);
+            tcamprop1_gobj::provider_emit_property_changed(provider, name);
+        });
+}
+
+
+void device_state::unsubscribe_property_changes()
+{
+    if (property_notifier_subscription_)
+    {
+        device_->get_property_notifier()->unsubscribe(property_notifier_subscription_);
+        property_notifier_subscription_ = 0;
+    }
+}
+
+
+bool device_state::start_reconnect(std::function<void()> on_failure)
+{
+    if (reconnect_timeout_ms_ == 0 || !device_)
+    {
+        return false;
+    }
+    if (reconnect_running_.exchange(true))
+    {
+        // the device and the index both report the loss
+        return true;
+    }
+    if (reconnect_thread_.joinable())
+    {
+        // the last reconnect has finished
+        reconnect_thread_.join();
+    }
+    reconnect_abort_ = false;
+    reconnect_thread_ = std::thread(&device_state::reconnect_main, this, std::move(on_failure));
+    return true;
+}
+
+
+void device_state::stop_reconnect()
+{
+    reconnect_abort_ = true;
+    if (reconnect_thread_.joinable())
+    {
+        reconnect_thread_.join();
+    }
+}
+
+
+void device_state::post_reconnect_message(const char* state)
+{
+    GstStructure* struc = gst_structure_new("tcam-device-reconnect",
+                                            "state",
+                                            G_TYPE_STRING,
+                                            state,
+                                            "serial",
+                                            G_TYPE_STRING,
+                                            device_->get_device().get_serial().c_str(),
+                                            nullptr);
+    gst_element_post_message(GST_ELEMENT(parent_),
+                             gst_message_new_element(GST_OBJECT(parent_), struc));
+}
+
+
+void device_state::reconnect_main(std::function<void()> on_failure)
+{
+    tcam::thread_policy::setup_thread("tcam_reconnect");
+
+    GST_WARNING_OBJECT(parent_, "Device lost, trying to reconnect.");
+    post_reconnect_message("lost");
+
+    {
+        // property users get a no device error until the new device is ready
+        std::lock_guard lck { stream_mtx_ };
+        tcamprop_container_.clear_list();
+        tcamprop_interface_.clear();
+        unsubscribe_property_changes();
+    }
+
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(reconnect_timeout_ms_);
+
+    // the new device receives all pool buffers, downstream has to return them first
+    while (buffers_outstanding_ > 0 && !reconnect_abort_
+           && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    outcome::result<void> res = tcam::status::DeviceLost;
+    if (buffers_outstanding_ == 0 && !reconnect_abort_)
+    {
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        res = device_->reconnect(std::max(remaining, std::chrono::milliseconds(0)),
+                                 [this] { return reconnect_abort_.load(); });
+    }
+    else if (buffers_outstanding_ > 0)
+    {
+        GST_ERROR_OBJECT(parent_,
+                         "%zu buffers were not returned, unable to reconnect.",
+                         buffers_outstanding_.load());
+    }
+
+    if (reconnect_abort_)
+    {
+        // the element is stopping
+        reconnect_running_ = false;
+        return;
+    }
+
+    if (!res)
+    {
+        reconnect_running_ = false;
+        on_failure();
+        return;
+    }
+
+    {
+        std::lock_guard lck { stream_mtx_ };
+        populate_tcamprop_interface();
+        subscribe_property_changes();
+    }
+    {
+        std::lock_guard lck { framerate_cache_mtx_ };
+        framerate_cache_.clear();
+    }
+
+    discont_pending_ = true;
+    GST_INFO_OBJECT(parent_, "Device reconnected.");
+    post_reconnect_message("reconnected");
+
+    reconnect_running_ = false;
+}
+
+
 void device_state::apply_properties(const GstStructure& strct)
 {
     tcamprop1_gobj::apply_properties(
@@ -328,25 +1305,53 @@ bool device_state::open_camera()
                      device_serial_to_open_.c_str(),
                      tcam::tcam_device_type_to_string(device_type_to_open_).c_str());
 
-    auto dev = tcam::open_device(device_serial_to_open_, device_type_to_open_);
-    if (!dev)
+    std::shared_ptr<tcam::CaptureDevice> dev;
+    gst_helper::gst_ptr<GstCaps> caps;
+
+    // a hot-standby device is already opened, its caps and buffers are ready
+    std::optional<tcam::mainsrc::standby_device> standby;
+    if (!device_serial_to_open_.empty())
     {
-        GST_ELEMENT_ERROR(parent_, RESOURCE, NOT_FOUND, ("Failed to open device."), (NULL));
-        close();
-        return false;
+        standby = tcam::mainsrc::standby_list::get_instance().take(device_serial_to_open_,
+                                                                    device_type_to_open_);
     }
 
-    auto caps =
-        tcambind::convert_videoformatsdescription_to_caps(*dev, dev->get_available_video_formats());
-    if (caps == nullptr || gst_caps_get_size(caps.get()) == 0)
+    if (standby)
     {
-        GST_ELEMENT_ERROR(parent_, CORE, CAPS, ("Failed to create caps for device."), (NULL));
-        close();
-        return false;
+        GST_INFO_OBJECT(parent_, "Using standby device '%s'", device_serial_to_open_.c_str());
+
+        dev = standby->device;
+        caps = standby->caps;
+    }
+    else
+    {
+        dev = tcam::open_device(device_serial_to_open_, device_type_to_open_);
+        if (!dev)
+        {
+            GST_ELEMENT_ERROR(parent_, RESOURCE, NOT_FOUND, ("Failed to open device."), (NULL));
+            close();
+            return false;
+        }
+
+        caps = tcambind::convert_videoformatsdescription_to_caps(
+            *dev, dev->get_available_video_formats());
+        if (caps == nullptr || gst_caps_get_size(caps.get()) == 0)
+        {
+            GST_ELEMENT_ERROR(parent_, CORE, CAPS, ("Failed to create caps for device."), (NULL));
+            close();
+            return false;
+        }
     }
 
     device_ = dev;
     all_caps_ = caps;
+    if (standby && standby->buffer_pool)
+    {
+        // reused by the GstTcamBufferPool when the negotiated format fits
+        buffer_pool = standby->buffer_pool;
+        buffer_pool_memfd_ = false;
+        buffer_pool_cuda_pinned_ = false;
+    }
 
     GST_DEBUG_OBJECT(
         parent_, "Device provides the following caps: %s", gst_helper::to_string(*caps).c_str());
@@ -355,7 +1360,18 @@ bool device_state::open_camera()
     device_serial_to_open_ = {};
     device_type_to_open_ = tcam::TCAM_DEVICE_TYPE_UNKNOWN;
 
+    const tcam::metrics::label_list labels = { { "serial", device_->get_device().get_serial() } };
+    pool_size_metric_ =
+        tcam::metrics::get_gauge("tcam_pool_buffers", "Buffers of the tcamsrc pool", labels);
+    pool_outstanding_metric_ = tcam::metrics::get_gauge(
+        "tcam_pool_buffers_outstanding", "Pool buffers filled by the device or used downstream", labels);
+    write_latency_metric_ = tcam::metrics::get_histogram(
+        "tcam_property_write_duration_seconds",
+        "Duration of property writes",
+        { { "serial", device_->get_device().get_serial() }, { "source", "user" } });
+
     populate_tcamprop_interface();
+    subscribe_property_changes();
 
     if (prop_init_)
     {
@@ -363,5 +1379,10 @@ bool device_state::open_camera()
         prop_init_.reset();
     }
 
+    if (!device_events_.empty())
+    {
+        apply_device_events();
+    }
+
     return true;
 }
@@ -16,25 +16,34 @@
 
 #pragma once
 
+#include "../../Metrics.h"
 #include "../../tcam.h"
 #include "gsttcambufferpool.h"
 #include "gsttcammainsrc.h"
+#include "mainsrc_buffer_queue.h"
+#include "mainsrc_timestamp.h"
 
-#include <condition_variable>
+#include <chrono>
+#include <dutils_img_pipe/auto_alg_pass.h>
+#include <functional>
 #include <gst-helper/helper_functions.h>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <optional>
 #include <string>
 #include <tcamprop1.0_base/tcamprop_property_interface.h>
 #include <tcamprop1.0_gobject/tcam_property_provider.h>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace tcam::mainsrc
 {
 
 
-tcam::TCAM_MEMORY_TYPE io_mode_to_memory_type(GstTcamIOMode mode);
+// supported are the memory types of the device allocator, they decide what auto resolves to
+tcam::TCAM_MEMORY_TYPE io_mode_to_memory_type(GstTcamIOMode mode,
+                                              const std::vector<tcam::TCAM_MEMORY_TYPE>& supported);
 
 GstTcamIOMode memory_type_to_io_mode(tcam::TCAM_MEMORY_TYPE t);
 
@@ -47,6 +56,16 @@ struct buffer_info
     GstBuffer* gst_buffer = nullptr;
     std::shared_ptr<tcam::ImageBuffer> tcam_buffer;
     bool pooled;
+    // gst_buffer carries the meta and size of tcam_buffer, see prepare_delivery
+    bool prepared = false;
+    // when the device callback queued the buffer
+    std::chrono::steady_clock::time_point queued_at;
+    // when downstream got the buffer, see device_state::record_hold_time
+    std::chrono::steady_clock::time_point acquired_at;
+    // statistics of the image, copied because tcam_buffer is empty for copies of grow-pool
+    tcam::tcam_stream_statistics statistics {};
+    // see tcam::timing
+    uint32_t stream_id = 0;
 };
 
 //std::vector<buffer_info> get_buffer_collection(GstTcamBufferPool* pool);
@@ -66,19 +85,34 @@ struct src_interface_list : tcamprop1::property_list_interface
     }
     auto find_property(std::string_view name) -> tcamprop1::property_interface* final
     {
-        for (const auto& v : tcamprop_properties)
+        auto iter = name_index_.find(name);
+        if (iter != name_index_.end())
         {
-            if (name == v->get_property_name())
-            {
-                return v.get();
-            }
+            return iter->second;
         }
         return nullptr;
     }
+
+    // Call this after tcamprop_properties was filled, find_property only uses the index.
+    void build_index()
+    {
+        name_index_.clear();
+        name_index_.reserve(tcamprop_properties.size());
+        // emplace keeps the first property with a name, like the linear search did
+        for (const auto& v : tcamprop_properties)
+        {
+            name_index_.emplace(v->get_property_name(), v.get());
+        }
+    }
     void clear() noexcept
     {
+        name_index_.clear();
         tcamprop_properties.clear();
     }
+
+private:
+    // the names are owned by the property objects
+    std::unordered_map<std::string_view, tcamprop1::property_interface*> name_index_;
 };
 } // namespace tcam::mainsrc
 
@@ -92,25 +126,196 @@ public: // data members currently still used in gstmainsrc.cpp, maybe move them
     std::shared_ptr<tcam::ImageSink> sink;
 
     std::shared_ptr<tcam::BufferPool> buffer_pool;
+    // buffer_pool was created with a tcam::MemfdAllocator, see io-mode memfd
+    bool buffer_pool_memfd_ = false;
+    // buffer_pool was created with a tcam::CudaHostAllocator, see io-mode cuda-pinned
+    bool buffer_pool_cuda_pinned_ = false;
     tcam::VideoFormat format_;
 
     GstTcamIOMode io_mode_ = GST_TCAM_IO_AUTO;
 
 public: // streaming stuff
     std::mutex stream_mtx_;
-    std::condition_variable stream_cv_;
     std::atomic<bool> is_streaming_ = false;
 
-    std::queue<tcam::mainsrc::buffer_info> queue;
+    // buffers filled by the device, waiting to be acquired by the streaming thread
+    tcam::mainsrc::buffer_queue queue;
+    // in us, time the streaming thread polls the queue before it sleeps, see 'busy-wait'
+    std::atomic<guint> busy_wait_us_ = 0;
+
+public: // buffer starvation, see 'starvation-policy'
+    std::atomic<GstTcamStarvationPolicy> starvation_policy_ = GST_TCAM_STARVATION_BLOCK;
+    // number of copies grow-pool may hand out at the same time
+    guint max_extra_buffers_ = 10;
+
+    // pool buffers delivered by the device that were not yet requeued
+    std::atomic<size_t> buffers_outstanding_ = 0;
+    std::atomic<size_t> pool_size_ = 0;
+
+    // Called from the device thread when an image takes the last buffer of the device.
+    // Posts a 'tcam-buffer-starvation' message when this starts a starvation period.
+    void begin_starvation() noexcept;
+    // Called when downstream returned a buffer, ends the starvation period when the device has
+    // enough buffers again
+    void end_starvation() noexcept;
+
+    void count_starvation_drop() noexcept
+    {
+        starvation_drops_.fetch_add(1, std::memory_order_relaxed);
+    }
+    void count_extra_buffer() noexcept
+    {
+        extra_buffers_.fetch_add(1, std::memory_order_relaxed);
+    }
 
 public: // sink init properties, should be moved into this object
+    // camera-buffers, 0 sizes the pool automatically, see get_buffer_count
     int imagesink_buffers_ = 10;
     bool drop_incomplete_frames_ = true;
+    // see tcam::CaptureDevice::set_salvage_threshold
+    double salvage_threshold_ = 0.0;
+    // add the GstStructure based TcamStatisticsMeta next to the TcamFrameMeta
+    bool statistics_meta_ = true;
+    // prefault and lock all buffers before the stream starts
+    bool warm_start_ = false;
+    // receive settings of network streams, passed to the device in configure_stream
+    tcam::tcam_stream_transport_options stream_transport_options_;
+    // GigE chunk data in the TcamStatistics meta, the buffers have to reserve space for it
+    bool chunk_data_ = false;
+    // thread-policy, rules of tcam::thread_policy for the threads of this device
+    std::string thread_policy_;
+
+public: // camera-buffers=0, see tcam::buffer_budget
+    // camera-buffers, or with 0 the count for format from its frame rate and the hold time
+    size_t get_buffer_count(const tcam::VideoFormat& format) const noexcept;
+    bool is_buffer_count_auto() const noexcept
+    {
+        return imagesink_buffers_ == 0;
+    }
+
+    // Reserves the buffers of buffer_pool from the process wide budget, returns the granted count.
+    // Releases the previous reservation first.
+    size_t reserve_buffer_budget(const tcam::VideoFormat& format, size_t buffer_size);
+    void release_buffer_budget() noexcept;
+
+    // Called when downstream returns a pool buffer.
+    void record_hold_time(std::chrono::nanoseconds hold) noexcept;
+
+    // bytes per buffer of the current reservation, grow-pool copies reserve the same size
+    size_t budget_buffer_size_ = 0;
+
+public: // see 'decimation' and CaptureDevice::set_decimation
+    guint decimation_ = 1;
+    guint decimation_auto_sampling_ = 1;
+
+    // Applied to an open device right away, otherwise by configure_stream
+    void set_decimation(guint factor, guint auto_sampling);
+
+public: // multi-region readout, see 'regions'
+    // sensor regions of the next format, empty reads out a single rectangle
+    std::vector<tcam::tcam_image_region> regions_;
+
+    // "x,y,width,height" per region, separated by ';'. Returns false when str cannot be parsed.
+    bool set_regions(const std::string& str);
+    std::string get_regions() const;
+
+public: // software crop, see 'software-crop'
+    // caps may have any width and height within the resolution ranges of the device
+    bool software_crop_ = true;
+    // size of the caps while the device streams a larger image, 0x0 otherwise
+    tcam::tcam_image_size crop_size_ = {};
+
+    // The format the device streams for the caps format, with regions_.
+    // With software_crop_ a width or height between the steps of a resolution range is rounded up
+    // to the next step, the caps size is then the top left part of the image.
+    tcam::VideoFormat to_device_format(const tcam::tcam_video_format& format) const;
+
+public: // burst mode, see 'burst-count'
+    // 0 - off, otherwise the pool holds a whole burst and the device thread only queues images
+    std::atomic<guint> burst_count_ = 0;
+
+public: // flight recorder, see 'flight-recorder-pre-frames'
+    guint flight_recorder_pre_frames_ = 0;
+    guint flight_recorder_post_frames_ = 0;
+    // nullptr while both are 0, then the live images go downstream
+    std::unique_ptr<tcam::FlightRecorder> flight_recorder_;
+
+    // Creates flight_recorder_ for the images of the next stream, false when allocating failed
+    bool prepare_flight_recorder(const tcam::VideoFormat& format, size_t buffer_size);
+    // Freezes the recorded window, set by the 'tcam-flight-recorder-trigger' upstream event
+    bool trigger_flight_recorder() noexcept;
 
 public: // members used for num-buffers functionality
     int n_buffers_ = -1;
     uint64_t n_buffers_delivered_ = 0;
 
+public: // TCAM_METRICS_PORT, created in open_camera, nullptr while metrics are disabled
+    tcam::metrics::gauge* pool_size_metric_ = nullptr;
+    tcam::metrics::gauge* pool_outstanding_metric_ = nullptr;
+    tcam::metrics::histogram* write_latency_metric_ = nullptr;
+
+    // copies buffers_outstanding_ and pool_size_ into the gauges
+    void update_pool_metrics() noexcept;
+
+public: // periodic 'tcam-stream-statistics' bus message
+    // in ms, 0 disables the message
+    std::atomic<guint> statistics_interval_ms_ = 0;
+
+    void reset_statistics_summary() noexcept;
+    // Called from the device thread for every delivered buffer
+    void update_statistics_summary(const tcam::tcam_stream_statistics& stats) noexcept;
+    // Called from the streaming thread with the time a buffer waited in the queue
+    void add_push_delay(std::chrono::nanoseconds delay) noexcept;
+
+public: // per image 'tcam-scene-statistics' bus message, see 'scene-statistics'
+    // a message for every n-th image, 0 disables the message
+    std::atomic<guint> scene_statistics_interval_ = 0;
+
+    // Called from the device thread for every image, before it is delivered or requeued
+    void post_scene_statistics(const tcam::ImageBuffer& buffer);
+
+    // only used by the device thread
+    auto_alg::statistics_ptr scene_statistics_;
+    uint64_t scene_statistics_images_ = 0;
+
+public: // 'tcam-device-event' bus messages, see 'device-events'
+    // comma separated list of EventSelector entries, e.g. "ExposureEnd,FrameTransferEnd"
+    std::string device_events_;
+
+    // Enables device_events_ on the open device, returns false when the device rejected them
+    bool apply_device_events();
+    // Called from the event thread of the backend
+    void post_device_event(const tcam::tcam_device_event& event);
+
+public: // 'reconnect-timeout', see tcam::CaptureDevice::reconnect
+    // in ms, time a lost device may take to return while streaming, 0 disables the reconnect
+    guint reconnect_timeout_ms_ = 0;
+    // set after a reconnect, the next buffer is flagged GST_BUFFER_FLAG_DISCONT
+    std::atomic<bool> discont_pending_ = false;
+
+    // Reconnects the lost device in a thread, the pipeline keeps running without images.
+    // on_failure is called from that thread when the device did not return.
+    // Returns false when the reconnect is disabled, true when it was started or is running.
+    bool start_reconnect(std::function<void()> on_failure);
+    // Aborts a running reconnect and waits for it
+    void stop_reconnect();
+
+public: // buffer PTS, see 'timestamp-mode'
+    std::atomic<GstTcamTimestampMode> timestamp_mode_ = GST_TCAM_TIMESTAMP_NONE;
+    // only used by the streaming thread
+    tcam::mainsrc::frame_timestamper timestamper_;
+
+    // Not thread safe, only call this while not streaming
+    void reset_timestamps() noexcept;
+
+    // Latency of buffers stamped with the capture time.
+    // Exposure time plus the measured transfer delay, one frame when nothing was measured yet.
+    GstClockTime get_capture_latency(double fps);
+
+    // Called by the streaming thread after a buffer was stamped.
+    // Posts a latency message when the delay grew beyond the last reported latency.
+    void check_capture_latency();
+
 public: // init properties get/set methods. Note: These take the device_open_mutex_ lock internally
     bool set_device_serial(const std::string& str) noexcept;
     bool set_device_type(tcam::TCAM_DEVICE_TYPE type) noexcept;
@@ -122,7 +327,24 @@ public: // init properties get/set methods. Note: These take the device_open_mut
     tcam::TCAM_DEVICE_TYPE get_device_type() const noexcept;
 
     // Returns a copy of the device caps when open, otherwise nullptr
-    GstCaps* get_device_caps() const;
+    GstCaps* get_device_caps();
+
+    // Framerates of fmt. Cached until the device is closed or a property that changes the
+    // available formats was written.
+    outcome::result<tcam::framerate_info> get_framerate_info(const tcam::VideoFormat& fmt);
+
+    // Brightness ROI for the auto algorithms, see CaptureDevice::set_auto_functions_roi_override.
+    // Set by the 'tcam-auto-functions-roi' upstream event and GstVideoRegionOfInterestMeta.
+    void set_auto_functions_roi(const std::optional<tcam_image_roi>& roi) noexcept;
+
+    // see CaptureDevice::submit_channel_statistics, false when the statistics are not used.
+    // Set by the 'tcam-image-statistics' upstream event.
+    bool submit_channel_statistics(uint64_t frame_count,
+                                   const auto_alg::channel_statistics& stats) noexcept;
+
+    // Moves the image on the sensor without restarting the stream, see CaptureDevice::move_roi.
+    // Set by the 'tcam-move-roi' upstream event.
+    bool move_roi(uint32_t offset_x, uint32_t offset_y) noexcept;
 
 public:
     bool is_device_open() const noexcept
@@ -155,8 +377,16 @@ private:
     gst_helper::gst_ptr<GstStructure> prop_init_;
 
 
-    // cache for the device caps
+    // cache for the device caps, rebuilt by get_device_caps after format_list_changed_
     gst_helper::gst_ptr<GstCaps> all_caps_;
+    std::atomic<bool> format_list_changed_ = false;
+
+    // framerate lists already fetched from the device, see get_framerate_info
+    std::mutex framerate_cache_mtx_;
+    std::vector<std::pair<tcam::VideoFormat, tcam::framerate_info>> framerate_cache_;
+
+    // Called by the property notifier, may be called from any thread
+    void on_property_changed(std::string_view name);
 
     // Reference to the GstElement owning this device_state instance
     GstTcamMainSrc* parent_ = nullptr;
@@ -165,5 +395,52 @@ private:
     tcam::mainsrc::src_interface_list tcamprop_interface_;
     tcamprop1_gobj::tcam_property_provider tcamprop_container_;
 
+    // transfer delay used by the last get_capture_latency
+    std::atomic<GstClockTime> reported_transfer_delay_ = GST_CLOCK_TIME_NONE;
+
+    // subscription to device_->get_property_notifier(), 0 when not subscribed
+    int property_notifier_subscription_ = 0;
+
     void populate_tcamprop_interface();
+    // emits property changes of device_ through the TcamPropertyProvider
+    void subscribe_property_changes();
+    void unsubscribe_property_changes();
+
+    void reconnect_main(std::function<void()> on_failure);
+    // posts a 'tcam-device-reconnect' message with the given state
+    void post_reconnect_message(const char* state);
+
+    std::thread reconnect_thread_;
+    std::atomic<bool> reconnect_running_ = false;
+    std::atomic<bool> reconnect_abort_ = false;
+
+    struct statistics_summary
+    {
+        gint64 interval_start_us = 0;
+        uint64_t frames = 0;
+        uint64_t receive_duration_sum_ns = 0;
+        uint64_t receive_duration_max_ns = 0;
+    };
+    statistics_summary statistics_summary_;
+
+    // bytes of the budget held by buffer_pool, see reserve_buffer_budget
+    size_t budget_reserved_bytes_ = 0;
+    // decaying peak of the time downstream holds a buffer, in us, kept across streams
+    std::atomic<int64_t> hold_time_peak_us_ = 0;
+
+    // steady_clock ns since the device ran out of buffers, 0 when not starved
+    std::atomic<int64_t> starved_since_ns_ = 0;
+    // starvation up to this time was already added to starved_ns_
+    std::atomic<int64_t> starved_accounted_ns_ = 0;
+    // collected with the statistics summary
+    std::atomic<uint64_t> starved_ns_ = 0;
+    std::atomic<uint64_t> starvation_drops_ = 0;
+    std::atomic<uint64_t> extra_buffers_ = 0;
+
+    void post_starvation_message(bool starved, uint64_t duration_ns);
+
+    // written by the streaming thread, collected with the statistics summary
+    std::atomic<uint64_t> push_delay_count_ = 0;
+    std::atomic<uint64_t> push_delay_sum_ns_ = 0;
+    std::atomic<uint64_t> push_delay_max_ns_ = 0;
 };
@@ -18,8 +18,10 @@
 
 #include "../../DeviceIndex.h"
 #include "../../logging.h"
+#include "../../ThreadPolicy.h"
 #include "../../utils.h"
 #include "mainsrc_gst_device.h"
+#include "mainsrc_standby.h"
 
 #include <algorithm>
 #include <atomic>
@@ -108,33 +110,11 @@ static GstDevice* tcam_mainsrc_device_new(GstElementFactory* factory,
     return ret;
 }
 
-static void run_update_logic(std::unique_lock<std::mutex>& /*lck*/,
-                             TcamMainSrcDeviceProvider* self,
-                             std::vector<tcam::DeviceInfo>&& new_list)
+static void add_new_devices(TcamMainSrcDeviceProvider* self,
+                            std::vector<tcam::DeviceInfo>&& new_list)
 {
     auto& known_devices = self->state->known_devices_;
 
-    // sort the new known_devices list to [still-present,not-present] with removed_devices_begin as the pivot
-    // Note: We use stable-partition here to prevent elements from moving
-    auto removed_devices_begin = std::stable_partition(
-        known_devices.begin(),
-        known_devices.end(),
-        [&new_list](const auto& known_dev)
-        {
-            return std::any_of(new_list.begin(),
-                               new_list.end(),
-                               [&known_dev](const auto& new_dev) { return known_dev == new_dev; });
-        });
-
-    for (auto iter = removed_devices_begin; iter != known_devices.end();
-         ++iter) // iterate over the 'removed' devices and remove them from
-    {
-        gst_device_provider_device_remove(GST_DEVICE_PROVIDER(self), iter->gstdev.get());
-    }
-
-    known_devices.erase(removed_devices_begin, known_devices.end());
-
-
     // sort the new devices list to [already-known,actually-new] with new_devices_begin as the pivot
     auto new_devices_begin = std::partition(
         new_list.begin(),
@@ -161,9 +141,38 @@ static void run_update_logic(std::unique_lock<std::mutex>& /*lck*/,
     }
 }
 
+static void run_update_logic(std::unique_lock<std::mutex>& /*lck*/,
+                             TcamMainSrcDeviceProvider* self,
+                             std::vector<tcam::DeviceInfo>&& new_list)
+{
+    auto& known_devices = self->state->known_devices_;
+
+    // sort the new known_devices list to [still-present,not-present] with removed_devices_begin as the pivot
+    // Note: We use stable-partition here to prevent elements from moving
+    auto removed_devices_begin = std::stable_partition(
+        known_devices.begin(),
+        known_devices.end(),
+        [&new_list](const auto& known_dev)
+        {
+            return std::any_of(new_list.begin(),
+                               new_list.end(),
+                               [&known_dev](const auto& new_dev) { return known_dev == new_dev; });
+        });
+
+    for (auto iter = removed_devices_begin; iter != known_devices.end();
+         ++iter) // iterate over the 'removed' devices and remove them from
+    {
+        gst_device_provider_device_remove(GST_DEVICE_PROVIDER(self), iter->gstdev.get());
+    }
+
+    known_devices.erase(removed_devices_begin, known_devices.end());
+
+    add_new_devices(self, std::move(new_list));
+}
+
 static void update_device_list(TcamMainSrcDeviceProvider* self)
 {
-    tcam::set_thread_name( "tcam_gstdevlst" );
+    tcam::thread_policy::setup_thread("tcam_gstdevlst");
     std::unique_lock<std::mutex> lck( self->state->mtx_ );
     while (self->state->run_updates_)
     {
@@ -228,7 +237,10 @@ static gboolean tcam_mainsrc_device_provider_start(GstDeviceProvider* provider)
     TcamMainSrcDeviceProvider* self = TCAM_MAINSRC_DEVICE_PROVIDER(provider);
 
     std::unique_lock<std::mutex> lck(self->state->mtx_);
-    run_update_logic(lck, self, self->state->index_.get_device_list());
+    // devices are added per backend, so that USB devices are announced
+    // while GigE discovery is still running
+    self->state->index_.get_device_list([self](const std::vector<tcam::DeviceInfo>& devices)
+                                        { add_new_devices(self, std::vector(devices)); });
     self->state->run_updates_ = true;
     self->state->update_thread_ = std::thread(update_device_list, self);
 
@@ -273,6 +285,35 @@ static void tcam_mainsrc_device_provider_finalize(GObject* object)
     G_OBJECT_CLASS(tcam_mainsrc_device_provider_parent_class)->finalize(object);
 }
 
+static gboolean tcam_mainsrc_device_provider_prepare_standby(TcamMainSrcDeviceProvider* /*self*/,
+                                                             const char* serial,
+                                                             const char* type,
+                                                             GstCaps* caps,
+                                                             int n_buffers)
+{
+    if (serial == nullptr || serial[0] == '\0')
+    {
+        return FALSE;
+    }
+
+    return tcam::mainsrc::standby_list::get_instance().prepare(
+        serial,
+        tcam::tcam_device_from_string(type ? type : ""),
+        caps,
+        n_buffers > 0 ? n_buffers : 10);
+}
+
+static void tcam_mainsrc_device_provider_release_standby(TcamMainSrcDeviceProvider* /*self*/,
+                                                         const char* serial)
+{
+    if (serial == nullptr)
+    {
+        return;
+    }
+
+    tcam::mainsrc::standby_list::get_instance().release(serial);
+}
+
 static void tcam_mainsrc_device_provider_class_init(TcamMainSrcDeviceProviderClass* klass)
 {
     GstDeviceProviderClass* dm_class = GST_DEVICE_PROVIDER_CLASS(klass);
@@ -285,6 +326,34 @@ static void tcam_mainsrc_device_provider_class_init(TcamMainSrcDeviceProviderCla
     dm_class->start = tcam_mainsrc_device_provider_start;
     dm_class->stop = tcam_mainsrc_device_provider_stop;
 
+    // Keeps a device opened, with buffers allocated when fixed caps are given, until a
+    // tcammainsrc with its serial opens it.
+    // prepare-standby(serial, type, caps, n-buffers) -> gboolean, type and caps may be NULL
+    g_signal_new_class_handler("prepare-standby",
+                               G_TYPE_FROM_CLASS(klass),
+                               static_cast<GSignalFlags>(G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION),
+                               G_CALLBACK(tcam_mainsrc_device_provider_prepare_standby),
+                               nullptr,
+                               nullptr,
+                               nullptr,
+                               G_TYPE_BOOLEAN,
+                               4,
+                               G_TYPE_STRING,
+                               G_TYPE_STRING,
+                               GST_TYPE_CAPS,
+                               G_TYPE_INT);
+    // release-standby(serial), closes a standby device that was not taken
+    g_signal_new_class_handler("release-standby",
+                               G_TYPE_FROM_CLASS(klass),
+                               static_cast<GSignalFlags>(G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION),
+                               G_CALLBACK(tcam_mainsrc_device_provider_release_standby),
+                               nullptr,
+                               nullptr,
+                               nullptr,
+                               G_TYPE_NONE,
+                               1,
+                               G_TYPE_STRING);
+
     gst_device_provider_class_set_static_metadata(
         dm_class,
         "TCam Device Provider",
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mainsrc_standby.h"
+
+#include "../../logging.h"
+#include "../../ThreadPolicy.h"
+#include "../../utils.h"
+#include "mainsrc_device_state.h"
+#include "tcambind.h"
+
+#include <algorithm>
+
+using namespace tcam::mainsrc;
+
+
+standby_list& standby_list::get_instance()
+{
+    static standby_list list;
+    return list;
+}
+
+
+bool standby_list::prepare(const std::string& serial,
+                           tcam::TCAM_DEVICE_TYPE type,
+                           const GstCaps* caps,
+                           int n_buffers)
+{
+    std::scoped_lock lck { mtx_ };
+
+    auto iter = std::find_if(
+        entries_.begin(), entries_.end(), [&serial](const entry& e) { return e.serial == serial; });
+    if (iter != entries_.end())
+    {
+        return false;
+    }
+
+    gst_helper::gst_ptr<GstCaps> format_caps;
+    if (caps && gst_caps_is_fixed(caps))
+    {
+        format_caps = gst_helper::make_ptr(gst_caps_copy(caps));
+    }
+
+    auto dev = std::async(std::launch::async, &standby_list::open, serial, type, format_caps, n_buffers);
+
+    entries_.push_back({ serial, type, dev.share() });
+    return true;
+}
+
+
+void standby_list::release(const std::string& serial)
+{
+    std::shared_future<std::optional<standby_device>> dev;
+    {
+        std::scoped_lock lck { mtx_ };
+
+        auto iter = std::find_if(entries_.begin(),
+                                 entries_.end(),
+                                 [&serial](const entry& e) { return e.serial == serial; });
+        if (iter == entries_.end())
+        {
+            return;
+        }
+        dev = std::move(iter->device);
+        entries_.erase(iter);
+    }
+    // the last reference waits for the open thread, outside of the lock
+}
+
+
+std::optional<standby_device> standby_list::take(const std::string& serial,
+                                                 tcam::TCAM_DEVICE_TYPE type)
+{
+    std::shared_future<std::optional<standby_device>> dev;
+    {
+        std::scoped_lock lck { mtx_ };
+
+        auto iter = std::find_if(entries_.begin(),
+                                 entries_.end(),
+                                 [&serial, type](const entry& e)
+                                 {
+                                     return e.serial == serial
+                                            && (type == tcam::TCAM_DEVICE_TYPE_UNKNOWN
+                                                || e.type == tcam::TCAM_DEVICE_TYPE_UNKNOWN
+                                                || e.type == type);
+                                 });
+        if (iter == entries_.end())
+        {
+            return std::nullopt;
+        }
+        dev = std::move(iter->device);
+        entries_.erase(iter);
+    }
+
+    return dev.get();
+}
+
+
+std::optional<standby_device> standby_list::open(const std::string& serial,
+                                                 tcam::TCAM_DEVICE_TYPE type,
+                                                 gst_helper::gst_ptr<GstCaps> caps,
+                                                 int n_buffers)
+{
+    tcam::thread_policy::setup_thread("tcam_standby");
+
+    standby_device ret;
+
+    ret.device = tcam::open_device(serial, type);
+    if (!ret.device)
+    {
+        SPDLOG_ERROR("Unable to open standby device {}", serial);
+        return std::nullopt;
+    }
+
+    ret.caps = tcambind::convert_videoformatsdescription_to_caps(
+        *ret.device, ret.device->get_available_video_formats());
+    if (ret.caps == nullptr || gst_caps_get_size(ret.caps.get()) == 0)
+    {
+        SPDLOG_ERROR("Unable to create caps for standby device {}", serial);
+        return std::nullopt;
+    }
+
+    if (!caps)
+    {
+        return ret;
+    }
+
+    tcam::tcam_video_format format = {};
+    caps_to_format(*caps, format);
+
+    try
+    {
+        auto allocator = ret.device->get_allocator();
+        auto memory_type =
+            io_mode_to_memory_type(GST_TCAM_IO_AUTO, allocator->get_supported_memory_types());
+
+        auto pool = std::make_shared<tcam::BufferPool>(memory_type, allocator);
+        auto res = pool->configure(tcam::VideoFormat(format), n_buffers);
+        if (!res)
+        {
+            SPDLOG_WARN("Unable to allocate buffers for standby device {}: {}",
+                        serial,
+                        res.error().message());
+            return ret;
+        }
+        ret.buffer_pool = pool;
+    }
+    catch (const std::runtime_error& err)
+    {
+        SPDLOG_WARN("Unable to allocate buffers for standby device {}: {}", serial, err.what());
+    }
+
+    SPDLOG_INFO("Standby device {} is ready", serial);
+
+    return ret;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../../tcam.h"
+
+#include <future>
+#include <gst-helper/gst_ptr.h>
+#include <gst/gst.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace tcam::mainsrc
+{
+
+// An opened device that waits for a tcammainsrc to take it over.
+struct standby_device
+{
+    std::shared_ptr<tcam::CaptureDevice> device;
+    // all caps of the device, see tcambind::convert_videoformatsdescription_to_caps
+    gst_helper::gst_ptr<GstCaps> caps;
+    // allocated for the caps given to prepare, nullptr when none were given
+    std::shared_ptr<tcam::BufferPool> buffer_pool;
+};
+
+//
+// Hot-standby devices, see the 'prepare-standby' signal of the device provider.
+//
+// The devices are opened in the background. tcammainsrc takes them over in open_camera
+// instead of opening them again. This skips the device open, which includes the GenICam
+// indexing, the caps creation and the buffer allocation.
+// The list is shared by all provider and tcammainsrc instances of the process.
+//
+class standby_list
+{
+public:
+    static standby_list& get_instance();
+
+    // Opens the device in a background thread.
+    // caps, when fixed, are used to allocate n_buffers buffers.
+    // Returns false when a standby device for serial already exists.
+    bool prepare(const std::string& serial,
+                 tcam::TCAM_DEVICE_TYPE type,
+                 const GstCaps* caps,
+                 int n_buffers);
+
+    // Removes the standby device of serial and closes it.
+    // Blocks while the device is still being opened.
+    void release(const std::string& serial);
+
+    // Hands out the standby device for serial, waiting for a pending open.
+    // nullopt when no standby device exists or opening it failed.
+    std::optional<standby_device> take(const std::string& serial, tcam::TCAM_DEVICE_TYPE type);
+
+private:
+    standby_list() = default;
+
+    static std::optional<standby_device> open(const std::string& serial,
+                                              tcam::TCAM_DEVICE_TYPE type,
+                                              gst_helper::gst_ptr<GstCaps> caps,
+                                              int n_buffers);
+
+    struct entry
+    {
+        std::string serial;
+        tcam::TCAM_DEVICE_TYPE type;
+        std::shared_future<std::optional<standby_device>> device;
+    };
+
+    std::mutex mtx_;
+    std::vector<entry> entries_;
+};
+
+} // namespace tcam::mainsrc
@@ -18,17 +18,43 @@
 
 #include "gsttcammainsrc.h"
 #include "mainsrc_device_state.h"
+#include "../../tracepoints.h"
 
 #include <algorithm>
+#include <utility>
 
 namespace tcam::mainsrc
 {
 
+// times a property write for the metrics and the property_write tracepoints
+class write_scope
+{
+public:
+    write_scope(std::string_view name, tcam::metrics::histogram* write_latency) noexcept
+        : name_(name), timer_(write_latency)
+    {
+        TCAM_TRACE3(property_write_begin, name_.data(), name_.size(), 0);
+    }
+    ~write_scope()
+    {
+        TCAM_TRACE3(property_write_end, name_.data(), name_.size(), 0);
+    }
+
+    write_scope(const write_scope&) = delete;
+    write_scope& operator=(const write_scope&) = delete;
+
+private:
+    std::string_view name_;
+    tcam::metrics::scoped_timer timer_;
+};
+
 template<class TBase> struct TcamPropertyBase : TBase
 {
     TcamPropertyBase(std::shared_ptr<tcam::property::IPropertyBase> prop) : m_prop(prop) {}
 
     std::shared_ptr<tcam::property::IPropertyBase> m_prop;
+    // see make_wrapper_instance
+    tcam::metrics::histogram* m_write_latency = nullptr;
 
     auto get_property_name() const noexcept -> std::string_view final
     {
@@ -90,6 +116,7 @@ struct TcamPropertyInteger : TcamPropertyBase<tcamprop1::property_interface_inte
             return tcam::status::PropertyNotWriteable;
         }
 
+        write_scope scope { m_prop->get_name(), m_write_latency };
         auto ret = tmp->set_value(value);
         if (ret)
         {
@@ -150,6 +177,7 @@ struct TcamPropertyFloat : TcamPropertyBase<tcamprop1::property_interface_float>
             return tcam::status::PropertyNotWriteable;
         }
 
+        write_scope scope { m_prop->get_name(), m_write_latency };
         auto ret = tmp->set_value(value);
 
         if (ret)
@@ -203,6 +231,7 @@ struct TcamPropertyBoolean : TcamPropertyBase<tcamprop1::property_interface_bool
             return tcam::status::PropertyNotWriteable;
         }
 
+        write_scope scope { m_prop->get_name(), m_write_latency };
         auto ret = tmp->set_value(value);
 
         if (ret)
@@ -252,6 +281,7 @@ struct TcamPropertyEnumeration : TcamPropertyBase<tcamprop1::property_interface_
             return tcam::status::PropertyNotWriteable;
         }
 
+        write_scope scope { m_prop->get_name(), m_write_latency };
         auto ret = tmp->set_value(value);
         if (ret)
         {
@@ -264,11 +294,15 @@ struct TcamPropertyEnumeration : TcamPropertyBase<tcamprop1::property_interface_
 
 struct TcamPropertyCommand : TcamPropertyBase<tcamprop1::property_interface_command>
 {
-    TcamPropertyCommand(std::shared_ptr<tcam::property::IPropertyBase> prop)
-        : TcamPropertyBase { prop }
+    TcamPropertyCommand(std::shared_ptr<tcam::property::IPropertyBase> prop,
+                        std::weak_ptr<tcam::CaptureDevice> trigger_device)
+        : TcamPropertyBase { prop }, m_trigger_device { trigger_device }
     {
     }
 
+    // set for TriggerSoftware
+    std::weak_ptr<tcam::CaptureDevice> m_trigger_device;
+
     auto execute_command(uint32_t /* flags */) -> std::error_code final
     {
         auto tmp = static_cast<tcam::property::IPropertyCommand*>(m_prop.get());
@@ -278,7 +312,16 @@ struct TcamPropertyCommand : TcamPropertyBase<tcamprop1::property_interface_comm
             return tcam::status::PropertyNotWriteable;
         }
 
-        auto ret = tmp->execute();
+        write_scope scope { m_prop->get_name(), m_write_latency };
+        auto ret = [&]
+        {
+            if (auto dev = m_trigger_device.lock())
+            {
+                // tags the image with the trigger time, see tcam statistics meta
+                return dev->trigger_software();
+            }
+            return tmp->execute();
+        }();
         if (ret)
         {
             return tcam::status::Success;
@@ -311,6 +354,7 @@ struct TcamPropertyString : TcamPropertyBase<tcamprop1::property_interface_strin
             return tcam::status::PropertyNotWriteable;
         }
 
+        write_scope scope { m_prop->get_name(), m_write_latency };
         auto err = tmp->set_value(value);
         if (err)
         {
@@ -321,35 +365,54 @@ struct TcamPropertyString : TcamPropertyBase<tcamprop1::property_interface_strin
 };
 } // namespace tcam::mainsrc
 
+namespace
+{
+template<class T, typename... Targs>
+auto make_wrapper(tcam::metrics::histogram* write_latency, Targs&&... args)
+{
+    auto rval = std::make_unique<T>(std::forward<Targs>(args)...);
+    rval->m_write_latency = write_latency;
+    return rval;
+}
+} // namespace
+
 auto tcam::mainsrc::make_wrapper_instance(
-    const std::shared_ptr<tcam::property::IPropertyBase>& prop)
+    const std::shared_ptr<tcam::property::IPropertyBase>& prop,
+    const std::shared_ptr<tcam::CaptureDevice>& device,
+    tcam::metrics::histogram* write_latency)
     -> std::unique_ptr<tcamprop1::property_interface>
 {
     switch (prop->get_type())
     {
         case tcamprop1::prop_type::Integer:
         {
-            return std::make_unique<tcam::mainsrc::TcamPropertyInteger>(prop);
+            return make_wrapper<tcam::mainsrc::TcamPropertyInteger>(write_latency, prop);
         }
         case tcamprop1::prop_type::Float:
         {
-            return std::make_unique<tcam::mainsrc::TcamPropertyFloat>(prop);
+            return make_wrapper<tcam::mainsrc::TcamPropertyFloat>(write_latency, prop);
         }
         case tcamprop1::prop_type::Boolean:
         {
-            return std::make_unique<tcam::mainsrc::TcamPropertyBoolean>(prop);
+            return make_wrapper<tcam::mainsrc::TcamPropertyBoolean>(write_latency, prop);
         }
         case tcamprop1::prop_type::Enumeration:
         {
-            return std::make_unique<tcam::mainsrc::TcamPropertyEnumeration>(prop);
+            return make_wrapper<tcam::mainsrc::TcamPropertyEnumeration>(write_latency, prop);
         }
         case tcamprop1::prop_type::Command:
         {
-            return std::make_unique<tcam::mainsrc::TcamPropertyCommand>(prop);
+            std::weak_ptr<tcam::CaptureDevice> trigger_device;
+            if (prop->get_name() == "TriggerSoftware")
+            {
+                trigger_device = device;
+            }
+            return make_wrapper<tcam::mainsrc::TcamPropertyCommand>(
+                write_latency, prop, trigger_device);
         }
         case tcamprop1::prop_type::String:
         {
-            return std::make_unique<tcam::mainsrc::TcamPropertyString>(prop);
+            return make_wrapper<tcam::mainsrc::TcamPropertyString>(write_latency, prop);
         }
     }
     return nullptr;
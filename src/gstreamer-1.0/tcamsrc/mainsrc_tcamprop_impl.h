@@ -22,9 +22,23 @@
 
 #include <memory>
 
+namespace tcam
+{
+class CaptureDevice;
+}
+
+namespace tcam::metrics
+{
+class histogram;
+}
+
 namespace tcam::mainsrc
 {
-auto make_wrapper_instance(const std::shared_ptr<tcam::property::IPropertyBase>& prop)
+// device is used for TriggerSoftware, which is executed through CaptureDevice::trigger_software
+// write_latency receives the duration of writes and commands, may be nullptr
+auto make_wrapper_instance(const std::shared_ptr<tcam::property::IPropertyBase>& prop,
+                           const std::shared_ptr<tcam::CaptureDevice>& device,
+                           tcam::metrics::histogram* write_latency)
     -> std::unique_ptr<tcamprop1::property_interface>;
 void gst_tcam_mainsrc_tcamprop_init(TcamPropertyProviderInterface* iface);
 
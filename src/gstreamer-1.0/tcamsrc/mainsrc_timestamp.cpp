@@ -0,0 +1,229 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mainsrc_timestamp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+using namespace tcam::mainsrc;
+
+namespace
+{
+
+// timestamps further in the past are not considered to be of the tested clock
+constexpr uint64_t max_capture_delay_ns = 10 * GST_SECOND;
+
+// rates outside of this differ too much to be a real clock drift
+constexpr double max_rate_deviation = 0.01;
+
+uint64_t get_time_ns(clockid_t id) noexcept
+{
+    timespec ts = {};
+    clock_gettime(id, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * GST_SECOND + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+std::optional<uint64_t> get_delay_to(clockid_t id, uint64_t timestamp_ns) noexcept
+{
+    const uint64_t now = get_time_ns(id);
+    if (now < timestamp_ns || now - timestamp_ns > max_capture_delay_ns)
+    {
+        return std::nullopt;
+    }
+    return now - timestamp_ns;
+}
+
+} // namespace
+
+
+void clock_mapper::reset() noexcept
+{
+    sample_count_ = 0;
+    next_sample_ = 0;
+    rate_ = 1.;
+    offset_ = 0.;
+}
+
+
+void clock_mapper::add_sample(uint64_t foreign_ns, uint64_t local_ns) noexcept
+{
+    if (sample_count_ == 0)
+    {
+        base_foreign_ = foreign_ns;
+        base_local_ = local_ns;
+        last_sample_foreign_ = 0;
+    }
+
+    const sample s = {
+        static_cast<double>(static_cast<int64_t>(foreign_ns - base_foreign_)),
+        static_cast<double>(static_cast<int64_t>(local_ns - base_local_)),
+    };
+
+    if (sample_count_ != 0 && std::abs(s.foreign - last_sample_foreign_) < min_sample_distance_ns)
+    {
+        // an earlier observation than the fitted line moves the envelope down
+        offset_ = std::min(offset_, s.local - rate_ * s.foreign);
+        return;
+    }
+
+    samples_[next_sample_] = s;
+    next_sample_ = (next_sample_ + 1) % window_size;
+    sample_count_ = std::min(sample_count_ + 1, window_size);
+    last_sample_foreign_ = s.foreign;
+
+    update_fit();
+}
+
+
+void clock_mapper::update_fit() noexcept
+{
+    const auto* begin = samples_.data();
+    const auto* end = samples_.data() + sample_count_;
+
+    double rate = 1.;
+    if (sample_count_ >= 2)
+    {
+        double mean_foreign = 0.;
+        double mean_local = 0.;
+        for (auto* s = begin; s != end; ++s)
+        {
+            mean_foreign += s->foreign;
+            mean_local += s->local;
+        }
+        mean_foreign /= sample_count_;
+        mean_local /= sample_count_;
+
+        double cov = 0.;
+        double var = 0.;
+        for (auto* s = begin; s != end; ++s)
+        {
+            cov += (s->foreign - mean_foreign) * (s->local - mean_local);
+            var += (s->foreign - mean_foreign) * (s->foreign - mean_foreign);
+        }
+        if (var > 0.)
+        {
+            rate = std::clamp(cov / var, 1. - max_rate_deviation, 1. + max_rate_deviation);
+        }
+    }
+    rate_ = rate;
+
+    offset_ = begin->local - rate_ * begin->foreign;
+    for (auto* s = begin; s != end; ++s)
+    {
+        offset_ = std::min(offset_, s->local - rate_ * s->foreign);
+    }
+}
+
+
+std::optional<uint64_t> clock_mapper::map(uint64_t foreign_ns) const noexcept
+{
+    if (sample_count_ == 0)
+    {
+        return std::nullopt;
+    }
+
+    const double foreign = static_cast<double>(static_cast<int64_t>(foreign_ns - base_foreign_));
+    const double local = std::round(rate_ * foreign + offset_);
+
+    if (local < 0. && static_cast<uint64_t>(-local) > base_local_)
+    {
+        return 0;
+    }
+    return base_local_ + static_cast<int64_t>(local);
+}
+
+
+void frame_timestamper::reset() noexcept
+{
+    capture_mapper_.reset();
+    camera_mapper_.reset();
+    last_timestamp_ = GST_CLOCK_TIME_NONE;
+    delay_ = GST_CLOCK_TIME_NONE;
+}
+
+
+std::optional<GstClockTime> frame_timestamper::convert_capture_time(uint64_t capture_time_ns,
+                                                                  GstClockTime clock_now) noexcept
+{
+    if (capture_time_ns == 0)
+    {
+        return std::nullopt;
+    }
+
+    auto delay = get_delay_to(CLOCK_MONOTONIC, capture_time_ns);
+    if (!delay)
+    {
+        delay = get_delay_to(CLOCK_REALTIME, capture_time_ns);
+    }
+    if (delay)
+    {
+        return clock_now > *delay ? clock_now - *delay : 0;
+    }
+
+    capture_mapper_.add_sample(capture_time_ns, clock_now);
+    return capture_mapper_.map(capture_time_ns);
+}
+
+
+std::optional<GstClockTime> frame_timestamper::get_clock_time(
+    GstTcamTimestampMode mode,
+    const tcam::tcam_stream_statistics& stats,
+    GstClockTime clock_now) noexcept
+{
+    if (mode == GST_TCAM_TIMESTAMP_NONE)
+    {
+        return std::nullopt;
+    }
+
+    auto ts = convert_capture_time(stats.capture_time_ns, clock_now);
+
+    if (mode == GST_TCAM_TIMESTAMP_CAMERA && stats.camera_time_ns != 0)
+    {
+        camera_mapper_.add_sample(stats.camera_time_ns, ts.value_or(clock_now));
+        ts = camera_mapper_.map(stats.camera_time_ns);
+    }
+
+    if (!ts)
+    {
+        return std::nullopt;
+    }
+
+    // jitter in the conversion must not make PTS run backwards
+    if (GST_CLOCK_TIME_IS_VALID(last_timestamp_) && *ts < last_timestamp_)
+    {
+        ts = last_timestamp_;
+    }
+    last_timestamp_ = *ts;
+
+    update_delay(clock_now > *ts ? clock_now - *ts : 0);
+
+    return ts;
+}
+
+
+void frame_timestamper::update_delay(GstClockTime delay) noexcept
+{
+    const GstClockTime current = delay_;
+    if (!GST_CLOCK_TIME_IS_VALID(current) || delay >= current)
+    {
+        delay_ = delay;
+        return;
+    }
+    // forget a single late buffer within a few hundred frames
+    delay_ = std::max(delay, current - current / 128);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../../base_types.h"
+#include "gsttcammainsrc.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <gst/gst.h>
+#include <optional>
+
+namespace tcam::mainsrc
+{
+
+//
+// Maps the timestamps of a clock GStreamer does not know onto a local clock.
+//
+// Every sample pairs a foreign timestamp with the local time it was observed at.
+// The rate is a least squares fit over the last samples. The offset follows the earliest
+// observation, i.e. the line is the lower envelope of the samples, so that delivery jitter
+// does not move the mapping and mapped times never lie after the observation.
+//
+class clock_mapper
+{
+public:
+    void reset() noexcept;
+
+    void add_sample(uint64_t foreign_ns, uint64_t local_ns) noexcept;
+
+    // nullopt until the first sample was added
+    std::optional<uint64_t> map(uint64_t foreign_ns) const noexcept;
+
+private:
+    void update_fit() noexcept;
+
+    // samples closer than this are only used to lower the offset,
+    // this keeps the window long enough to see the drift
+    static constexpr double min_sample_distance_ns = 250'000'000.;
+    static constexpr size_t window_size = 64;
+
+    // relative to base_foreign_/base_local_, so that doubles keep ns precision
+    struct sample
+    {
+        double foreign;
+        double local;
+    };
+
+    std::array<sample, window_size> samples_ {};
+    size_t sample_count_ = 0;
+    size_t next_sample_ = 0;
+    double last_sample_foreign_ = 0;
+
+    uint64_t base_foreign_ = 0;
+    uint64_t base_local_ = 0;
+
+    double rate_ = 1.;
+    double offset_ = 0.;
+};
+
+//
+// Turns the timestamps in tcam_stream_statistics into times of the element clock.
+//
+// capture_time_ns is taken from CLOCK_MONOTONIC (V4L2) or CLOCK_REALTIME (Aravis, AFU050,
+// AFU420) by the backends. Both are converted by measuring how long ago the timestamp was
+// taken, other time bases (e.g. tcam-virtcam) are tracked with a clock_mapper.
+// camera_time_ns always runs on a foreign clock and is mapped onto the converted capture time.
+//
+// get_clock_time is meant for the streaming thread, get_delay may be called from any thread.
+//
+class frame_timestamper
+{
+public:
+    void reset() noexcept;
+
+    // clock_now: current time of the element clock
+    std::optional<GstClockTime> get_clock_time(GstTcamTimestampMode mode,
+                                               const tcam::tcam_stream_statistics& stats,
+                                               GstClockTime clock_now) noexcept;
+
+    // Slowly decaying maximum of clock_now - returned timestamp,
+    // GST_CLOCK_TIME_NONE until the first buffer was stamped
+    GstClockTime get_delay() const noexcept
+    {
+        return delay_;
+    }
+
+private:
+    std::optional<GstClockTime> convert_capture_time(uint64_t capture_time_ns,
+                                                     GstClockTime clock_now) noexcept;
+    void update_delay(GstClockTime delay) noexcept;
+
+    clock_mapper capture_mapper_;
+    clock_mapper camera_mapper_;
+
+    GstClockTime last_timestamp_ = GST_CLOCK_TIME_NONE;
+    std::atomic<GstClockTime> delay_ = GST_CLOCK_TIME_NONE;
+};
+
+} // namespace tcam::mainsrc
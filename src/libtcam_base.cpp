@@ -1,9 +1,13 @@
 
 #include "libtcam_base.h"
 
+#include "ThreadPolicy.h"
+#include "utils.h"
 #include "version.h"
 
+#include <algorithm>
 #include <cstdlib>
+#include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
 namespace
@@ -22,11 +26,34 @@ auto fetch_default_log_level() noexcept
 }
 
 
+// TCAM_LOG_ASYNC
+auto create_libtcam_logger() -> std::shared_ptr<spdlog::logger>
+{
+    if (tcam::get_environment_variable_int("TCAM_LOG_ASYNC").value_or(0) == 0)
+    {
+        return std::make_shared<spdlog::logger>("libtcam");
+    }
+
+    // The queue entries are allocated once and keep short messages inline, so a streaming
+    // thread only formats into the queue, the sinks run in the 'tcam_log' thread.
+    // A full queue drops the oldest messages instead of blocking the streaming threads.
+    const int queue_size =
+        std::max(tcam::get_environment_variable_int("TCAM_LOG_ASYNC_QUEUE").value_or(8192), 64);
+    spdlog::init_thread_pool(
+        static_cast<size_t>(queue_size), 1, [] { tcam::thread_policy::setup_thread("tcam_log"); });
+
+    return std::make_shared<spdlog::async_logger>("libtcam",
+                                                  spdlog::sinks_init_list {},
+                                                  spdlog::thread_pool(),
+                                                  spdlog::async_overflow_policy::overrun_oldest);
+}
+
+
 struct default_logger_init
 {
     default_logger_init()
     {
-        default_logger_ = std::make_shared<spdlog::logger>("libtcam");
+        default_logger_ = create_libtcam_logger();
 
         spdlog::set_level(fetch_default_log_level());
         spdlog::set_error_handler(
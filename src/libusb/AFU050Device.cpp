@@ -16,6 +16,7 @@
 
 #include "AFU050Device.h"
 
+#include "../CompressedBufferSize.h"
 #include "../logging.h"
 #include "AFU050DeviceBackend.h"
 #include "AFU050PropertyImpl.h"
@@ -360,6 +361,14 @@ void tcam::AFU050Device::requeue_buffer(const std::shared_ptr<ImageBuffer>& buf)
 {
     std::scoped_lock lck { buffer_list_mtx_ };
 
+    // pool buffers are in slot order, see initialize_buffers
+    const size_t slot = buf->get_pool_slot();
+    if (slot < buffer_list_.size() && buffer_list_[slot].buffer == buf)
+    {
+        buffer_list_[slot].is_queued = true;
+        return;
+    }
+
     for (auto& b : buffer_list_)
     {
         if (b.buffer->get_image_buffer_ptr() == buf->get_image_buffer_ptr())
@@ -371,131 +380,195 @@ void tcam::AFU050Device::requeue_buffer(const std::shared_ptr<ImageBuffer>& buf)
 }
 
 
-void tcam::AFU050Device::transfer_callback(libusb_transfer* transfer)
+// Returns the position of the marker 0xff <marker> or nullptr.
+// memchr is vectorized by the C library, which makes skipping the entropy coded data much
+// cheaper than memmem. Only 0xff has to be looked at, everything else cannot start a marker.
+static const uint8_t* find_jpeg_marker(const uint8_t* data, size_t size, uint8_t marker)
 {
-    if (transfer->status != LIBUSB_TRANSFER_COMPLETED)
+    const uint8_t* end = data + size;
+    while (data < end)
     {
-        if (transfer->status == LIBUSB_TRANSFER_CANCELLED)
+        auto ff = static_cast<const uint8_t*>(memchr(data, 0xff, end - data));
+        if (ff == nullptr || ff + 1 >= end)
         {
-            libusb_free_transfer(transfer);
-            return;
+            return nullptr;
         }
-        else if (transfer->status == LIBUSB_TRANSFER_NO_DEVICE)
+        if (ff[1] == marker)
         {
-            lost_device();
-            libusb_free_transfer(transfer);
-            return;
+            return ff;
         }
-        SPDLOG_ERROR("libusb transfer returned with: {}", transfer->status);
+        data = ff + 1;
     }
+    return nullptr;
+}
 
-    if (!is_stream_on_)
-    {
-        libusb_free_transfer(transfer);
-        return;
-    }
 
-    int processed = 0;
+void tcam::AFU050Device::process_jpeg_data(const uint8_t* data, size_t size)
+{
+    static const uint8_t SOI = 0xd8;
+    static const uint8_t EOI = 0xd9;
 
-    unsigned char* ptr = transfer->buffer;
+    // a marker may be split between two transfers
+    const bool previous_ended_with_ff = last_byte_ff_;
+    last_byte_ff_ = size > 0 && data[size - 1] == 0xff;
 
-    while (processed < transfer->actual_length)
+    size_t pos = 0;
+    while (pos < size)
     {
-        if (!current_jpegbuf_ptr_)
+        size_t search_from = pos;
+
+        if (!in_frame_)
         {
-            unsigned char* start_of_image = (unsigned char*)memmem(
-                ptr + processed, (transfer->actual_length - processed), "\xff\xd8", 2);
-            if (start_of_image)
+            if (pos == 0 && previous_ended_with_ff && data[0] == SOI)
+            {
+                static const uint8_t marker_start = 0xff;
+                begin_jpeg_frame();
+                append_jpeg_data(&marker_start, 1);
+                search_from = 1;
+            }
+            else
             {
-                if (!current_jpegbuf_ptr_)
+                auto soi = find_jpeg_marker(data + pos, size - pos, SOI);
+                if (soi == nullptr)
                 {
-                    current_jpegbuf_ptr_ = current_jpegbuf_data_.data();
-                    //current_jpegbuf_ptr_ = (unsigned char*)malloc(JPEGBUF_SIZE);
+                    return;
                 }
-
-                processed = start_of_image - transfer->buffer;
-                memcpy(current_jpegbuf_ptr_, start_of_image, 2);
-                processed += 2;
-                current_jpegsize_ += 2;
-                current_jpegbuf_index_ += 2;
+                begin_jpeg_frame();
+                pos = soi - data;
+                search_from = pos + 2;
             }
         }
+        else if (pos == 0 && previous_ended_with_ff && data[0] == EOI)
+        {
+            append_jpeg_data(data, 1);
+            finish_jpeg_frame();
+            pos = 1;
+            continue;
+        }
 
-        if (current_jpegbuf_ptr_)
+        const uint8_t* eoi = nullptr;
+        if (search_from < size)
         {
-            unsigned char* end_of_image = (unsigned char*)memmem(
-                ptr + processed, transfer->actual_length - processed, "\xff\xd9", 2);
-            int cplen = transfer->actual_length - processed;
+            eoi = find_jpeg_marker(data + search_from, size - search_from, EOI);
+        }
 
-            if (end_of_image)
-            {
-                cplen = (((end_of_image)-ptr) - processed) + 2;
-            }
+        if (eoi == nullptr)
+        {
+            append_jpeg_data(data + pos, size - pos);
+            return;
+        }
 
-            if ((current_jpegsize_ + cplen) > JPEGBUF_SIZE)
-            {
-                SPDLOG_ERROR("Image is too big. Dropping...");
-                //JPEG too big, dropping
-                current_jpegbuf_index_ = 0;
-                current_jpegsize_ = 0;
-                current_jpegbuf_ptr_ = 0;
-                break;
-            }
+        const size_t end = (eoi - data) + 2;
+        append_jpeg_data(data + pos, end - pos);
+        finish_jpeg_frame();
+        pos = end;
+    }
+}
 
-            memcpy(current_jpegbuf_ptr_ + current_jpegbuf_index_, ptr + processed, cplen);
-            processed += cplen;
-            current_jpegbuf_index_ += cplen;
-            current_jpegsize_ += cplen;
 
-            if (end_of_image)
-            {
-                std::shared_ptr<tcam::ImageBuffer> buffer = get_free_buffer();
-                if (buffer == nullptr)
-                {
-                    ++frames_dropped_;
-                    SPDLOG_TRACE("Failed to fetch free buffer");
-                }
-                else
-                {
-                    assert(buffer->get_image_buffer_size() >= current_jpegsize_);
-                    memcpy(buffer->get_image_buffer_ptr(), current_jpegbuf_ptr_, current_jpegsize_);
-
-                    tcam_stream_statistics stats = {};
-                    stats.frame_count = frames_delivered_;
-                    stats.frames_dropped = frames_dropped_;
-
-                    auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
-
-                    stats.capture_time_ns =
-                        std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count();
-
-                    buffer->set_valid_data_length(current_jpegsize_);
-                    buffer->set_statistics(stats);
-
-                    if (auto sink_ptr = listener_.lock())
-                    {
-                        ++frames_delivered_;
-                        sink_ptr->push_image(buffer);
-                    }
-                    else
-                    {
-                        ++frames_dropped_;
-                        requeue_buffer(buffer);
-                        SPDLOG_ERROR("ImageSink expired. Unable to deliver images.");
-                    }
-                }
-                current_jpegbuf_index_ = 0;
-                current_jpegsize_ = 0;
+void tcam::AFU050Device::begin_jpeg_frame()
+{
+    in_frame_ = true;
+    current_jpegsize_ = 0;
 
-                current_jpegbuf_ptr_ = nullptr;
-            }
+    current_buffer_ = get_free_buffer();
+    if (current_buffer_ == nullptr)
+    {
+        SPDLOG_TRACE("Failed to fetch free buffer");
+    }
+}
+
+
+void tcam::AFU050Device::append_jpeg_data(const uint8_t* data, size_t size)
+{
+    if (current_buffer_ == nullptr)
+    {
+        return;
+    }
+
+    if (current_jpegsize_ + size > current_buffer_->get_image_buffer_size())
+    {
+        SPDLOG_ERROR("Image is too big. Dropping...");
+        // the pool is sized by the observed frames, let the next stream allocate enough
+        compressed::record_frame_size(current_buffer_->get_format(), current_jpegsize_ + size);
+        requeue_buffer(current_buffer_);
+        current_buffer_ = nullptr;
+        return;
+    }
+
+    memcpy(static_cast<uint8_t*>(current_buffer_->get_image_buffer_ptr()) + current_jpegsize_,
+           data,
+           size);
+    current_jpegsize_ += size;
+}
+
+
+void tcam::AFU050Device::finish_jpeg_frame()
+{
+    in_frame_ = false;
+
+    auto buffer = std::move(current_buffer_);
+    current_buffer_ = nullptr;
+
+    if (buffer == nullptr)
+    {
+        ++frames_dropped_;
+        return;
+    }
+
+    tcam_stream_statistics stats = {};
+    stats.frame_count = frames_delivered_;
+    stats.frames_dropped = frames_dropped_;
+
+    auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
+
+    stats.capture_time_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count();
+
+    buffer->set_valid_data_length(current_jpegsize_);
+    buffer->set_statistics(stats);
+    buffer->record_stage(timing::stage::backend_dequeue);
+
+    if (auto sink_ptr = listener_.lock())
+    {
+        ++frames_delivered_;
+        sink_ptr->push_image(buffer);
+    }
+    else
+    {
+        ++frames_dropped_;
+        requeue_buffer(buffer);
+        SPDLOG_ERROR("ImageSink expired. Unable to deliver images.");
+    }
+}
+
+
+void tcam::AFU050Device::transfer_callback(libusb_transfer* transfer)
+{
+    if (transfer->status != LIBUSB_TRANSFER_COMPLETED)
+    {
+        if (transfer->status == LIBUSB_TRANSFER_CANCELLED)
+        {
+            libusb_free_transfer(transfer);
+            return;
         }
-        else
+        else if (transfer->status == LIBUSB_TRANSFER_NO_DEVICE)
         {
-            processed += transfer->actual_length;
+            lost_device();
+            libusb_free_transfer(transfer);
+            return;
         }
+        SPDLOG_ERROR("libusb transfer returned with: {}", transfer->status);
     }
 
+    if (!is_stream_on_)
+    {
+        libusb_free_transfer(transfer);
+        return;
+    }
+
+    process_jpeg_data(transfer->buffer, transfer->actual_length);
+
     if (is_stream_on_)
     {
         //submit the next transfer
@@ -531,18 +604,16 @@ bool tcam::AFU050Device::start_stream(const std::shared_ptr<IImageBufferSink>& s
 
     SPDLOG_TRACE("Starting stream...");
     is_stream_on_ = true;
-    current_jpegbuf_ptr_ = nullptr;
+    in_frame_ = false;
+    last_byte_ff_ = false;
     current_jpegsize_ = 0;
-    current_jpegbuf_index_ = 0;
+    current_buffer_ = nullptr;
 
     listener_ = sink;
 
     frames_delivered_ = 0;
     frames_dropped_ = 0;
 
-    current_jpegbuf_data_.clear();
-    current_jpegbuf_data_.resize(JPEGBUF_SIZE);
-
     for (int cnt = 0; cnt < TRANSFER_COUNT; cnt++)
     {
         uint8_t* buf = (uint8_t*)malloc(LEN_IN_BUFFER);
@@ -582,6 +653,7 @@ void tcam::AFU050Device::stop_stream()
 
     listener_.reset();
 
+    current_buffer_ = nullptr;
     release_buffers();
 
     transfers_.clear();
@@ -135,10 +135,11 @@ private:
     long frames_delivered_ = 0;
     long frames_dropped_ = 0;
 
+    // frames are assembled directly in the ImageBuffer they are delivered in
+    bool in_frame_ = false; // SOI was seen, waiting for EOI
+    bool last_byte_ff_ = false; // the previous transfer ended in the middle of a marker
     size_t current_jpegsize_ = 0;
-    int current_jpegbuf_index_ = 0;
-    unsigned char* current_jpegbuf_ptr_ = nullptr;
-    std::vector<uint8_t> current_jpegbuf_data_;
+    std::shared_ptr<ImageBuffer> current_buffer_; // nullptr while a frame is dropped
 
     std::weak_ptr<IImageBufferSink> listener_;
 
@@ -149,6 +150,11 @@ private:
     static void LIBUSB_CALL libusb_bulk_callback(struct libusb_transfer* trans);
     void transfer_callback(libusb_transfer* transfer);
 
+    void process_jpeg_data(const uint8_t* data, size_t size);
+    void begin_jpeg_frame();
+    void append_jpeg_data(const uint8_t* data, size_t size);
+    void finish_jpeg_frame();
+
     void init_buffers();
 
     void add_int(const std::string& name, const VC_UNIT unit, const unsigned char prop);
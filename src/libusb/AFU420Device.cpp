@@ -17,13 +17,16 @@
 #include "AFU420Device.h"
 
 #include "../logging.h"
+#include "../tracepoints.h"
 #include "../public_utils.h"
 #include "../utils.h"
 #include "AFU420DeviceBackend.h"
+#include "UsbDevMemAllocator.h"
 #include "UsbHandler.h"
 #include "UsbSession.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <dutils_img/fcc_to_string.h>
 #include <dutils_img/image_fourcc_func.h>
@@ -55,7 +58,19 @@ tcam::AFU420Device::AFU420Device(const DeviceInfo& info)
     // ensure defined state
     usb_device_->halt_endpoint(USB_EP_BULK_VIDEO);
 
-    // read_firmware_version();
+    use_direct_transfers_ =
+        tcam::get_environment_variable_int("TCAM_AFU420_DIRECT_TRANSFER").value_or(0) != 0;
+    if (use_direct_transfers_)
+    {
+        allocator_ = std::make_shared<UsbDevMemAllocator>(usb_device_);
+    }
+    else
+    {
+        allocator_ = get_default_allocator();
+    }
+
+    firmware_version_ = read_firmware_version();
+    config_cache_ = tcam::afu420::load_config_cache(firmware_version_);
 
     // properties rely on this information
     check_for_optics();
@@ -69,6 +84,11 @@ tcam::AFU420Device::AFU420Device(const DeviceInfo& info)
     create_properties();
     create_formats();
 
+    if (config_cache_changed_)
+    {
+        tcam::afu420::store_config_cache(firmware_version_, config_cache_);
+    }
+
     query_active_format();
 }
 
@@ -100,6 +120,12 @@ void AFU420Device::query_active_format()
     {
         format.fourcc = FOURCC_GBRG12_MIPI_PACKED;
     }
+    if (bpp == 8 || bpp == 12)
+    {
+        // the format tests may have been served from the cache and left the bit depth untouched
+        device_bit_depth_ = bpp;
+        image_bit_depth_ = bpp;
+    }
     else
     {
         SPDLOG_ERROR("Received bogus bit depth of '{}'", bpp);
@@ -374,7 +400,7 @@ struct AFU420Device::sResolutionConf AFU420Device::CreateResolutionConf(
 }
 
 
-void AFU420Device::read_firmware_version()
+std::string AFU420Device::read_firmware_version()
 {
     int a = 0, b = 0, c = 0, d = 0;
 
@@ -398,9 +424,11 @@ void AFU420Device::read_firmware_version()
     else
     {
         SPDLOG_ERROR("Could not read firmware version");
+        return {};
     }
 
-    SPDLOG_INFO("Firmware version is {}.{}.{}.{} \n", a, b, c, d);
+    SPDLOG_INFO("Firmware version is {}.{}.{}.{}", a, b, c, d);
+    return fmt::format("{}.{}.{}.{}", a, b, c, d);
 }
 
 
@@ -459,7 +487,7 @@ void AFU420Device::create_formats()
             double fps_min = 0;
             double fps_max = 0;
 
-            this->get_frame_rate_range(_fmt.fmt, 1, size, fps_min, fps_max);
+            this->get_frame_rate_range(_fmt.id, scale.binning_h, size, fps_min, fps_max);
 
             std::vector<double> f = create_steps_for_range(fps_min, fps_max);
 
@@ -562,6 +590,9 @@ bool tcam::AFU420Device::set_video_format(const VideoFormat& format)
 
     SPDLOG_INFO("Attempting to set format to: '{}'", format.to_string().c_str());
 
+    const bool bit_depth_changed =
+        device_bit_depth_ != img::get_bits_per_pixel(format.get_fourcc());
+
     int ret = setup_bit_depth(img::get_bits_per_pixel(format.get_fourcc()));
 
     if (ret < 0)
@@ -576,12 +607,19 @@ bool tcam::AFU420Device::set_video_format(const VideoFormat& format)
 
     auto conf = videoformat_to_resolution_conf(format);
 
-    ret = set_resolution_config(conf, resolution_config_mode::set);
-
-    if (ret <= 0)
+    // the device keeps its config, a format switch that only changes the framerate writes only that
+    const bool conf_changed =
+        serialize_resolution_config(conf) != serialize_resolution_config(active_resolution_conf_);
+    if (bit_depth_changed || conf_changed)
     {
-        SPDLOG_ERROR("Could not set bit depth. Aborting.");
-        return false;
+        ret = set_resolution_config(conf, resolution_config_mode::set);
+
+        if (ret <= 0)
+        {
+            SPDLOG_ERROR("Could not set resolution config. Aborting.");
+            return false;
+        }
+        active_resolution_conf_ = conf;
     }
 
     if (!set_framerate(format.get_framerate()))
@@ -639,6 +677,10 @@ bool tcam::AFU420Device::initialize_buffers(std::shared_ptr<BufferPool> pool)
     auto buffs = pool->get_buffer();
     SPDLOG_TRACE("Received {} buffer from external allocator.", buffs.size());
 
+    std::scoped_lock lck { buffers_mutex_ };
+
+    // buffs is in pool slot order, which allows requeue_buffer to index directly
+    buffer_list_.clear();
     buffer_list_.reserve(buffs.size());
 
     for (auto& b : buffs) { buffer_list_.push_back({ b.lock(), true }); }
@@ -659,14 +701,12 @@ void AFU420Device::requeue_buffer(const std::shared_ptr<ImageBuffer>& buffer)
 {
     buffer->set_valid_data_length(0);
 
+    const size_t slot = buffer->get_pool_slot();
+
     std::scoped_lock lck { buffers_mutex_ };
-    for (auto& b : buffer_list_)
+    if (slot < buffer_list_.size() && buffer_list_[slot].buffer == buffer)
     {
-        if (buffer == b.buffer)
-        {
-            b.is_queued = true;
-            break;
-        }
+        buffer_list_[slot].is_queued = true;
     }
 }
 
@@ -674,6 +714,8 @@ void AFU420Device::push_buffer(std::shared_ptr<tcam::ImageBuffer>&& cur_buf)
 {
     assert(cur_buf != nullptr);
 
+    publish_received_lines(*cur_buf, cur_buf->get_valid_data_length(), true);
+
     if (drop_incomplete_frames_ && (usbbulk_image_size_ - cur_buf->get_valid_data_length() != 0))
     {
         SPDLOG_TRACE("Image buffer does not contain enough data. Dropping frame...");
@@ -695,9 +737,9 @@ void AFU420Device::push_buffer(std::shared_ptr<tcam::ImageBuffer>&& cur_buf)
 
     frames_delivered_++;
 
-    if (!deliver_thread_.push(std::move(cur_buf)))
+    if (auto not_delivered = deliver_thread_.push(std::move(cur_buf)))
     {
-        requeue_buffer(cur_buf);
+        requeue_buffer(not_delivered);
     }
 }
 
@@ -768,34 +810,376 @@ struct AFU420Device::header_res AFU420Device::check_and_eat_img_header(unsigned
 }
 
 
-void tcam::AFU420Device::transfer_callback(struct libusb_transfer* xfr)
+static size_t round_up(size_t value, size_t multiple)
+{
+    return ((value + multiple - 1) / multiple) * multiple;
+}
+
+
+AFU420Device::bulk_transfer_item* tcam::AFU420Device::find_transfer_item(
+    struct libusb_transfer* xfr)
+{
+    for (auto& item : transfer_items)
+    {
+        if (item.transfer == xfr)
+        {
+            return &item;
+        }
+    }
+    return nullptr;
+}
+
+
+bool tcam::AFU420Device::submit_transfer(bulk_transfer_item& item)
 {
+    std::scoped_lock lck { transfer_mtx_ };
+
+    // stop_stream waits for transfers_in_flight_, nothing may be submitted after it was called
     if (!is_stream_on_)
     {
-        // do not free transfers
-        //libusb_free_transfer(xfr);
+        return false;
+    }
+
+    int ret = libusb_submit_transfer((libusb_transfer*)item.transfer);
+    if (ret < 0)
+    {
+        SPDLOG_ERROR("error submitting URB: {}", libusb_error_name(ret));
+        return false;
+    }
+    transfers_in_flight_++;
+    return true;
+}
 
-        //SPDLOG_DEBUG("stream is off");
+
+void tcam::AFU420Device::resubmit_transfer(bulk_transfer_item& item)
+{
+    if (direct_in_sync_)
+    {
+        prepare_direct_transfer(item);
+    }
+    else
+    {
+        prepare_copy_transfer(item);
+    }
+
+    if (!submit_transfer(item) && item.role != transfer_role::copy)
+    {
+        // the planned part will never arrive
+        leave_direct_mode("unable to submit transfer");
+        release_direct_part(item.frame_seq);
+    }
+}
+
+
+void tcam::AFU420Device::prepare_copy_transfer(bulk_transfer_item& item)
+{
+    auto xfr = (libusb_transfer*)item.transfer;
+
+    item.role = transfer_role::copy;
+    xfr->buffer = item.buffer.data();
+    xfr->length = item.buffer.size();
+}
+
+
+void tcam::AFU420Device::setup_direct_transfers(size_t max_transfer_size)
+{
+    direct_in_sync_ = false;
+    direct_frames_.clear();
+    direct_next_part_ = 0;
+
+    int max_packet_size = usb_device_->get_max_packet_size(USB_EP_BULK_VIDEO);
+    if (max_packet_size <= 0 || (size_t)max_packet_size > max_transfer_size)
+    {
+        SPDLOG_WARN("Unable to query the max packet size. Direct transfers are disabled.");
         return;
     }
+    usb_max_packet_size_ = max_packet_size;
+
+    // transfers that are not a multiple of the packet size would overflow,
+    // so the header transfer also receives the first bytes of the image
+    const size_t header_size = get_packet_header_size();
+    const size_t image_size = usbbulk_image_size_;
+
+    direct_header_transfer_size_ = round_up(header_size, usb_max_packet_size_);
+    direct_header_image_bytes_ =
+        std::min(direct_header_transfer_size_ - header_size, image_size);
+    direct_transfer_size_ = max_transfer_size / usb_max_packet_size_ * usb_max_packet_size_;
+    direct_data_parts_ = (image_size - direct_header_image_bytes_ + direct_transfer_size_ - 1)
+                         / direct_transfer_size_;
+
+    direct_in_sync_ = true;
+
+    SPDLOG_INFO("Using direct transfers. {} byte header transfer and {} data transfers per frame.",
+                direct_header_transfer_size_,
+                direct_data_parts_);
+}
+
+
+void tcam::AFU420Device::prepare_direct_transfer(bulk_transfer_item& item)
+{
+    auto xfr = (libusb_transfer*)item.transfer;
 
-    auto submit_transfer = [](struct libusb_transfer* _xfr)
+    if (direct_next_part_ == 0)
     {
-        if (libusb_submit_transfer(_xfr) < 0)
+        direct_frame frame;
+        frame.seq = direct_next_seq_++;
         {
-            SPDLOG_ERROR("error re-submitting URB\n");
+            std::scoped_lock lck { buffers_mutex_ };
+            frame.buffer = get_next_buffer();
         }
-    };
+        direct_frames_.push_back(std::move(frame));
 
+        item.role = transfer_role::header;
+        item.image_offset = 0;
+        item.image_bytes = direct_header_image_bytes_;
+        item.in_bounce_buffer = true;
+
+        xfr->buffer = item.buffer.data();
+        xfr->length = direct_header_transfer_size_;
+    }
+    else
+    {
+        const auto& frame = direct_frames_.back();
+
+        item.role = transfer_role::data;
+        item.image_offset =
+            direct_header_image_bytes_ + (direct_next_part_ - 1) * direct_transfer_size_;
+        item.image_bytes =
+            std::min(direct_transfer_size_, usbbulk_image_size_ - item.image_offset);
+
+        // the last transfer may be larger than the remaining image,
+        // it only goes into the image when the memory is large enough
+        const size_t length = round_up(item.image_bytes, usb_max_packet_size_);
+        item.in_bounce_buffer =
+            !frame.buffer || item.image_offset + length > frame.buffer->get_image_buffer_size();
+
+        if (item.in_bounce_buffer)
+        {
+            xfr->buffer = item.buffer.data();
+        }
+        else
+        {
+            xfr->buffer =
+                static_cast<uint8_t*>(frame.buffer->get_image_buffer_ptr()) + item.image_offset;
+        }
+        xfr->length = length;
+    }
+
+    auto& frame = direct_frames_.back();
+    frame.pending++;
+
+    item.frame_seq = frame.seq;
+    item.is_last_of_frame = direct_next_part_ == direct_data_parts_;
+    if (item.is_last_of_frame)
+    {
+        frame.planned = true;
+    }
+
+    direct_next_part_ = (direct_next_part_ + 1) % (direct_data_parts_ + 1);
+}
+
+
+void tcam::AFU420Device::handle_direct_transfer(bulk_transfer_item& item,
+                                                struct libusb_transfer* xfr)
+{
+    auto frame = find_direct_frame(item.frame_seq);
+    if (frame == nullptr)
+    {
+        return;
+    }
 
     if (xfr->status != LIBUSB_TRANSFER_COMPLETED)
     {
-        if (xfr->status == LIBUSB_TRANSFER_CANCELLED)
+        leave_direct_mode("transfer error");
+    }
+
+    if (!direct_in_sync_)
+    {
+        frame->valid = false;
+    }
+    else if (item.role == transfer_role::header)
+    {
+        auto header = check_and_eat_img_header(xfr->buffer, xfr->actual_length);
+        if (header.frame_id < 0 || (size_t)xfr->actual_length != direct_header_transfer_size_)
         {
-            return;
+            leave_direct_mode("image header missing");
+            frame->valid = false;
+        }
+        else if (frame->buffer)
+        {
+            const size_t bytes = std::min(header.size, item.image_bytes);
+            memcpy(frame->buffer->get_image_buffer_ptr(), header.buffer, bytes);
+            frame->received += bytes;
+
+            begin_partial_image(frame->buffer);
+            publish_received_lines(*frame->buffer, frame->received, false);
+        }
+    }
+    else
+    {
+        const size_t bytes = std::min((size_t)xfr->actual_length, item.image_bytes);
+        if (frame->buffer && item.in_bounce_buffer)
+        {
+            memcpy(static_cast<uint8_t*>(frame->buffer->get_image_buffer_ptr()) + item.image_offset,
+                   xfr->buffer,
+                   bytes);
+        }
+        frame->received += bytes;
+        if (frame->buffer)
+        {
+            publish_received_lines(*frame->buffer, frame->received, false);
         }
-        SPDLOG_WARN("transfer status {}", xfr->status);
-        submit_transfer(xfr);
+
+        if (!item.is_last_of_frame && xfr->actual_length < xfr->length)
+        {
+            // the frame ended early, the following transfers would receive the next frame
+            leave_direct_mode("short transfer");
+            frame->valid = false;
+        }
+    }
+
+    release_direct_part(item.frame_seq);
+}
+
+
+AFU420Device::direct_frame* tcam::AFU420Device::find_direct_frame(uint64_t seq)
+{
+    for (auto& frame : direct_frames_)
+    {
+        if (frame.seq == seq)
+        {
+            return &frame;
+        }
+    }
+    return nullptr;
+}
+
+
+void tcam::AFU420Device::release_direct_part(uint64_t seq)
+{
+    auto frame = find_direct_frame(seq);
+    if (frame != nullptr && frame->pending > 0)
+    {
+        frame->pending--;
+    }
+    finish_direct_frame(seq);
+}
+
+
+void tcam::AFU420Device::finish_direct_frame(uint64_t seq)
+{
+    auto iter = std::find_if(direct_frames_.begin(),
+                             direct_frames_.end(),
+                             [seq](const direct_frame& f) { return f.seq == seq; });
+    if (iter == direct_frames_.end() || iter->pending > 0 || !iter->planned)
+    {
+        return;
+    }
+
+    // no transfer writes into the buffer anymore
+    auto frame = std::move(*iter);
+    direct_frames_.erase(iter);
+
+    if (!frame.buffer)
+    {
+        frames_dropped_++;
+        return;
+    }
+    if (!frame.valid)
+    {
+        frames_dropped_++;
+        publish_received_lines(*frame.buffer, frame.received, true);
+        requeue_buffer(frame.buffer);
+        return;
+    }
+
+    frame.buffer->set_valid_data_length(frame.received);
+    push_buffer(std::move(frame.buffer));
+}
+
+
+void tcam::AFU420Device::leave_direct_mode(const char* reason)
+{
+    if (!direct_in_sync_)
+    {
+        return;
+    }
+    direct_in_sync_ = false;
+
+    SPDLOG_WARN("Direct transfers lost sync ({}). Copying image data until the stream restarts.",
+                reason);
+
+    // the remaining parts of this frame will not be prepared
+    if (!direct_frames_.empty() && !direct_frames_.back().planned)
+    {
+        auto& frame = direct_frames_.back();
+        frame.planned = true;
+        frame.valid = false;
+
+        finish_direct_frame(frame.seq);
+    }
+}
+
+
+void tcam::AFU420Device::begin_partial_image(const std::shared_ptr<ImageBuffer>& buffer)
+{
+    if (progressive_line_size_ == 0)
+    {
+        return;
+    }
+
+    buffer->reset_completed_lines();
+    if (auto sink = listener_.lock())
+    {
+        sink->push_partial_image(buffer);
+    }
+}
+
+
+void tcam::AFU420Device::publish_received_lines(ImageBuffer& buffer,
+                                                size_t received,
+                                                bool is_final)
+{
+    if (progressive_line_size_ == 0)
+    {
+        return;
+    }
+
+    const int height = buffer.get_format().get_size().height;
+    buffer.set_completed_lines(
+        static_cast<int>(std::min<size_t>(height, received / progressive_line_size_)), is_final);
+}
+
+
+void tcam::AFU420Device::transfer_callback(struct libusb_transfer* xfr)
+{
+    TCAM_TRACE2(afu420_transfer, static_cast<int>(xfr->status), xfr->actual_length);
+
+    if (!is_stream_on_)
+    {
+        return;
+    }
+
+    auto item = find_transfer_item(xfr);
+    if (item == nullptr)
+    {
+        return;
+    }
+
+    if (xfr->status == LIBUSB_TRANSFER_CANCELLED)
+    {
+        return;
+    }
+
+    if (item->role != transfer_role::copy)
+    {
+        handle_direct_transfer(*item, xfr);
+    }
+
+    if (xfr->status != LIBUSB_TRANSFER_COMPLETED)
+    {
+        SPDLOG_WARN_RATELIMITED("transfer status {}", xfr->status);
+        resubmit_transfer(*item);
 
         if (lost_countdown_ == 0)
         {
@@ -806,6 +1190,18 @@ void tcam::AFU420Device::transfer_callback(struct libusb_transfer* xfr)
         return;
     }
 
+    if (item->role == transfer_role::copy)
+    {
+        handle_copy_transfer(xfr);
+    }
+
+    lost_countdown_ = 20;
+    resubmit_transfer(*item);
+}
+
+
+void tcam::AFU420Device::handle_copy_transfer(struct libusb_transfer* xfr)
+{
     auto header = check_and_eat_img_header(xfr->buffer, xfr->length);
 
     bool is_header = header.frame_id >= 0;
@@ -818,24 +1214,27 @@ void tcam::AFU420Device::transfer_callback(struct libusb_transfer* xfr)
             push_buffer(std::move(current_buffer_));
         }
 
-        current_buffer_ = get_next_buffer();
+        {
+            std::scoped_lock lck { buffers_mutex_ };
+            current_buffer_ = get_next_buffer();
+        }
 
         if (current_buffer_ == nullptr)
         {
-            SPDLOG_ERROR("No buffer to work with. Dropping image"); // Buffer starvation
+            SPDLOG_ERROR_RATELIMITED("No buffer to work with. Dropping image"); // Buffer starvation
             frames_dropped_++;
-            submit_transfer(xfr);
             return;
         }
 
+        begin_partial_image(current_buffer_);
+
         have_header_ = true;
         transfer_offset_ = 0;
     }
 
     if (current_buffer_ == nullptr)
     {
-        submit_transfer(xfr); // just requeue und wait for the next header to arrive
-        return;
+        return; // just requeue und wait for the next header to arrive
     }
 
     int bytes_available = usbbulk_image_size_ - transfer_offset_;
@@ -847,6 +1246,7 @@ void tcam::AFU420Device::transfer_callback(struct libusb_transfer* xfr)
     transfer_offset_ += bytes_to_copy;
 
     current_buffer_->set_valid_data_length(transfer_offset_);
+    publish_received_lines(*current_buffer_, transfer_offset_, false);
 
     bool is_complete_image = transfer_offset_ >= usbbulk_image_size_;
     if (is_complete_image || is_trailer)
@@ -859,8 +1259,6 @@ void tcam::AFU420Device::transfer_callback(struct libusb_transfer* xfr)
         have_header_ = false;
         transfer_offset_ = 0;
     }
-    lost_countdown_ = 20;
-    submit_transfer(xfr);
 }
 
 
@@ -882,7 +1280,7 @@ std::shared_ptr<tcam::ImageBuffer> tcam::AFU420Device::get_next_buffer()
         }
     }
 
-    SPDLOG_ERROR("No free buffers available! {}", buffer_list_.size());
+    SPDLOG_ERROR_RATELIMITED("No free buffers available! {}", buffer_list_.size());
     return nullptr;
 }
 
@@ -891,6 +1289,12 @@ void LIBUSB_CALL tcam::AFU420Device::libusb_bulk_callback(struct libusb_transfer
 {
     AFU420Device* self = static_cast<AFU420Device*>(trans->user_data);
     self->transfer_callback(trans);
+
+    // resubmissions already counted themselves
+    // notify while holding the lock, stop_stream may destroy the device once this reaches 0
+    std::scoped_lock lck { self->transfer_mtx_ };
+    self->transfers_in_flight_--;
+    self->transfer_cv_.notify_all();
 }
 
 bool tcam::AFU420Device::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
@@ -926,29 +1330,64 @@ bool tcam::AFU420Device::start_stream(const std::shared_ptr<IImageBufferSink>& s
 
     usbbulk_image_size_ = active_video_format.get_required_buffer_size();
 
+    progressive_line_size_ = 0;
+    if (progressive_delivery_enabled_ && active_video_format.get_size().height > 0)
+    {
+        progressive_line_size_ = usbbulk_image_size_ / active_video_format.get_size().height;
+    }
+
+    direct_in_sync_ = false;
+    if (use_direct_transfers_)
+    {
+        setup_direct_transfers(buffer_size);
+    }
+
     for (int i = 0; i < num_transfers; ++i)
     {
         transfer_items.push_back({});
-        transfer_items.at(i).transfer = libusb_alloc_transfer(0);
-        transfer_items.at(i).buffer.reserve(buffer_size);
+        auto& item = transfer_items.at(i);
+        item.transfer = libusb_alloc_transfer(0);
+        item.buffer.resize(buffer_size);
 
-        struct libusb_transfer* xfr = (libusb_transfer*)transfer_items.at(i).transfer;
+        struct libusb_transfer* xfr = (libusb_transfer*)item.transfer;
 
         libusb_fill_bulk_transfer(xfr,
                                   usb_device_->get_handle(),
                                   LIBUSB_ENDPOINT_IN | USB_EP_BULK_VIDEO,
-                                  (uint8_t*)transfer_items.at(i).buffer.data(),
-                                  transfer_items.at(i).buffer.capacity(),
+                                  item.buffer.data(),
+                                  item.buffer.size(),
                                   AFU420Device::libusb_bulk_callback,
                                   this,
                                   0);
 
-        libusb_submit_transfer(xfr);
+        if (direct_in_sync_)
+        {
+            prepare_direct_transfer(item);
+        }
+        else
+        {
+            prepare_copy_transfer(item);
+        }
     }
 
     listener_ = sink;
 
-    deliver_thread_.start(sink);
+    deliver_thread_.start(sink, buffer_list_.size());
+
+    {
+        std::scoped_lock lck { transfer_mtx_ };
+        is_stream_on_ = true;
+    }
+
+    for (auto& item : transfer_items)
+    {
+        if (!submit_transfer(item))
+        {
+            SPDLOG_ERROR("Unable to submit transfers. Aborting");
+            stop_stream();
+            return false;
+        }
+    }
 
     unsigned char val = 0;
     int ret = control_write(BASIC_PC_TO_USB_START_STREAM, val);
@@ -957,14 +1396,11 @@ bool tcam::AFU420Device::start_stream(const std::shared_ptr<IImageBufferSink>& s
     {
         SPDLOG_ERROR("Stream could not be started. Aborting");
 
-        listener_.reset();
+        stop_stream();
 
         return false;
     }
 
-    have_header_ = false;
-    is_stream_on_ = true;
-
     SPDLOG_INFO("Stream started");
 
     return true;
@@ -975,21 +1411,44 @@ void tcam::AFU420Device::stop_stream()
 {
     SPDLOG_DEBUG("stop_stream called");
 
-    is_stream_on_ = false;
-
-    deliver_thread_.stop();
+    {
+        std::scoped_lock lck { transfer_mtx_ };
+        is_stream_on_ = false;
+    }
 
     for (auto& item : transfer_items) { libusb_cancel_transfer((libusb_transfer*)item.transfer); }
 
+    // in direct mode the transfers write into the image buffers,
+    // these can only be released once libusb is done with them
+    {
+        std::unique_lock lck { transfer_mtx_ };
+        if (!transfer_cv_.wait_for(
+                lck, std::chrono::seconds(1), [this] { return transfers_in_flight_ == 0; }))
+        {
+            SPDLOG_WARN("{} transfers are still pending after cancellation.", transfers_in_flight_);
+        }
+    }
+
+    if (deliver_thread_.get_dropped_count() > 0)
+    {
+        SPDLOG_DEBUG("{} images were dropped because the sink did not keep up.",
+                     deliver_thread_.get_dropped_count());
+    }
+    // the callbacks push into the deliver queue, it may only be cleared once they are done
+    deliver_thread_.stop();
+
     usb_device_->halt_endpoint(USB_EP_BULK_VIDEO);
 
     listener_.reset();
 
+    direct_frames_.clear();
     release_buffers();
 }
 
 
-int AFU420Device::set_resolution_config(sResolutionConf conf, resolution_config_mode mode)
+int AFU420Device::set_resolution_config(sResolutionConf conf,
+                                        resolution_config_mode mode,
+                                        tcam::afu420::config_limits* limits)
 {
     auto serialized_conf = serialize_resolution_config(conf);
 
@@ -997,9 +1456,11 @@ int AFU420Device::set_resolution_config(sResolutionConf conf, resolution_config_
 
     int hr = control_write(ADVANCED_PC_TO_USB_RES_FPS, test_mode, 0, serialized_conf);
 
-    uint32_t exp_max = 0, exp_min = 0;
-    control_read(exp_min, BASIC_USB_TO_PC_MIN_EXP, test_mode, 0);
-    control_read(exp_max, BASIC_USB_TO_PC_MAX_EXP, test_mode, 0);
+    if (limits && hr > 0)
+    {
+        control_read(limits->exposure_min, BASIC_USB_TO_PC_MIN_EXP, test_mode, 0);
+        control_read(limits->exposure_max, BASIC_USB_TO_PC_MAX_EXP, test_mode, 0);
+    }
 
     return hr;
 }
@@ -1011,6 +1472,11 @@ int AFU420Device::setup_bit_depth(int bpp)
     {
         return EINVAL;
     }
+    if (bpp == device_bit_depth_)
+    {
+        image_bit_depth_ = bpp;
+        return 0;
+    }
     int hr = control_write(BASIC_PC_TO_USB_SET_BIT_DEPTH, (uint16_t)bpp);
 
     if (hr < 0)
@@ -1023,6 +1489,7 @@ int AFU420Device::setup_bit_depth(int bpp)
     }
 
     image_bit_depth_ = bpp;
+    device_bit_depth_ = bpp;
     return hr;
 }
 
@@ -1033,6 +1500,13 @@ int AFU420Device::get_fps_max(double& max,
                               tcam_image_size binning,
                               int src_bpp)
 {
+    const tcam::afu420::config_key key = { src_bpp, binning.width, dim.width, dim.height };
+    if (auto iter = config_cache_.find(key); iter != config_cache_.end())
+    {
+        max = iter->second.max_fps;
+        return 0;
+    }
+
     int hr = setup_bit_depth(src_bpp);
     if (hr < 0)
     {
@@ -1047,7 +1521,8 @@ int AFU420Device::get_fps_max(double& max,
         return EINVAL;
     }
 
-    hr = set_resolution_config(conf, resolution_config_mode::test);
+    tcam::afu420::config_limits limits;
+    hr = set_resolution_config(conf, resolution_config_mode::test, &limits);
 
     if (hr <= 0)
     {
@@ -1067,6 +1542,10 @@ int AFU420Device::get_fps_max(double& max,
 
     max = ((double)ushMaxFPS) / 100.0;
 
+    limits.max_fps = max;
+    config_cache_[key] = limits;
+    config_cache_changed_ = true;
+
     return 0;
 }
 
@@ -1086,8 +1565,8 @@ int AFU420Device::get_frame_rate_range(uint32_t strm_fmt_id,
 
     if (f == stream_fmt_list.end())
     {
-        SPDLOG_DEBUG("???");
-        // return EINVAL;
+        SPDLOG_ERROR("No stream format with id {}", strm_fmt_id);
+        return EINVAL;
     }
 
     uint32_t binning = scaling_factor_id;
@@ -1099,18 +1578,7 @@ int AFU420Device::get_frame_rate_range(uint32_t strm_fmt_id,
     min_fps = 2.f;
     max_fps = 30.f;
 
-    int hr = get_fps_max(max_fps, { 0, 0 }, dim, { binning, binning }, f->src_bpp);
-
-    if (hr == 0)
-    {
-        frame_rate_cache_.push_back({ strm_fmt_id, scaling_factor_id, dim, min_fps, max_fps });
-        if (frame_rate_cache_.size() > 128)
-        {
-            frame_rate_cache_.erase(frame_rate_cache_.begin(), frame_rate_cache_.begin() + 64);
-        }
-    }
-
-    return hr;
+    return get_fps_max(max_fps, { 0, 0 }, dim, { binning, binning }, f->src_bpp);
 }
 
 
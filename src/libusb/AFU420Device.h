@@ -23,12 +23,15 @@
 #include "../VideoFormatDescription.h"
 #include "LibusbDevice.h"
 #include "UsbSession.h"
+#include "afu420_config_cache.h"
 #include "ep_defines_r42.h"
 #include "ep_defines_rx.h"
 #include "libusb_utils.h"
 #include "struct_defines_rx.h"
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <libusb-1.0/libusb.h>
 #include <memory>
 #include <mutex> // std::mutex, std::unique_lock
@@ -76,7 +79,7 @@ public:
 
     std::shared_ptr<tcam::AllocatorInterface> get_allocator() override
     {
-        return get_default_allocator();
+        return allocator_;
     };
 
     bool initialize_buffers(std::shared_ptr<BufferPool> pool) final;
@@ -162,7 +165,8 @@ private:
         set
     };
 
-    std::unique_ptr<LibusbDevice> usb_device_;
+    std::shared_ptr<LibusbDevice> usb_device_;
+    std::shared_ptr<tcam::AllocatorInterface> allocator_;
 
     const tcam_image_size max_sensor_dim_ = { 7716, 5360 };
     const tcam_image_size min_sensor_dim_ = { 264, 256 };
@@ -224,7 +228,8 @@ private:
 
     sResolutionConf videoformat_to_resolution_conf(const VideoFormat& format);
 
-    void read_firmware_version();
+    // "a.b.c.d", empty when the version could not be read
+    std::string read_firmware_version();
 
     tcam_image_size transform_roi_start(tcam_image_size pos, tcam_image_size video_dim);
 
@@ -243,7 +248,8 @@ private:
         bool is_queued;
     };
 
-    tcam::libusb::deliver_thread deliver_thread_;
+    // a newer frame is worth more than the oldest queued one
+    tcam::libusb::deliver_thread deliver_thread_ { overflow_policy::drop_oldest };
 
     std::vector<buffer_info> buffer_list_;
     std::mutex buffers_mutex_;
@@ -281,8 +287,12 @@ private:
         return stream_format_list_;
     }
 
-    int set_resolution_config(sResolutionConf conf, resolution_config_mode mode);
+    // limits are only read when requested, the firmware reports them for the written config
+    int set_resolution_config(sResolutionConf conf,
+                              resolution_config_mode mode,
+                              tcam::afu420::config_limits* limits = nullptr);
 
+    // does not write when the device already uses bpp
     int setup_bit_depth(int bpp);
 
 
@@ -302,11 +312,26 @@ private:
 
     int read_resolution_config_from_device(sResolutionConf& conf);
 
+    enum class transfer_role
+    {
+        copy, // bounce buffer, header detection and copy_block in transfer_callback
+        header, // direct mode, fixed size transfer that receives the image header
+        data, // direct mode, part of the image data
+    };
+
     struct bulk_transfer_item
     {
         std::vector<uint8_t> buffer;
         void* transfer = nullptr;
 
+        transfer_role role = transfer_role::copy;
+        // direct mode, position of the received data in the image
+        size_t image_offset = 0;
+        size_t image_bytes = 0;
+        uint64_t frame_seq = 0;
+        bool in_bounce_buffer = false; // data has to be copied from buffer
+        bool is_last_of_frame = false;
+
         ~bulk_transfer_item()
         {
             if (transfer != nullptr)
@@ -318,6 +343,61 @@ private:
 
     std::vector<bulk_transfer_item> transfer_items;
 
+    // guards is_stream_on_ against submissions and counts the transfers owned by libusb
+    std::mutex transfer_mtx_;
+    std::condition_variable transfer_cv_;
+    int transfers_in_flight_ = 0;
+
+    bool submit_transfer(bulk_transfer_item& item);
+    void resubmit_transfer(bulk_transfer_item& item);
+    bulk_transfer_item* find_transfer_item(struct libusb_transfer* xfr);
+    void prepare_copy_transfer(bulk_transfer_item& item);
+    void handle_copy_transfer(struct libusb_transfer* xfr);
+
+    // Direct mode (TCAM_AFU420_DIRECT_TRANSFER=1)
+    // Instead of copying out of bounce buffers, every frame is received by a planned sequence of
+    // transfers: one header transfer of the size of the image header, rounded up to the max
+    // packet size, followed by data transfers that point into the ImageBuffer at the matching
+    // offsets. libusb completes the transfers of an endpoint in submission order, so the
+    // completions can be matched to direct_frames_ front to back.
+    // When the stream does not match the plan, e.g. after a transfer error, the stream falls back
+    // to copy transfers until it is restarted.
+    // Only touched by the libusb event thread while the stream is running.
+    struct direct_frame
+    {
+        uint64_t seq = 0;
+        std::shared_ptr<ImageBuffer> buffer; // nullptr when the frame is dropped
+        size_t received = 0;
+        size_t pending = 0; // transfers of this frame that are in flight
+        bool planned = false; // all transfers of this frame have been prepared
+        bool valid = true;
+    };
+
+    bool use_direct_transfers_ = false;
+    bool direct_in_sync_ = false;
+    std::deque<direct_frame> direct_frames_; // frames that have transfers in flight
+    uint64_t direct_next_seq_ = 0;
+    size_t direct_next_part_ = 0; // 0 is the header, 1..direct_data_parts_ the data
+    size_t direct_data_parts_ = 0;
+    size_t direct_header_transfer_size_ = 0;
+    size_t direct_header_image_bytes_ = 0; // image data that follows the header in its transfer
+    size_t direct_transfer_size_ = 0;
+    size_t usb_max_packet_size_ = 0;
+
+    void setup_direct_transfers(size_t max_transfer_size);
+    void prepare_direct_transfer(bulk_transfer_item& item);
+    void handle_direct_transfer(bulk_transfer_item& item, struct libusb_transfer* xfr);
+    direct_frame* find_direct_frame(uint64_t seq);
+    void release_direct_part(uint64_t seq);
+    void finish_direct_frame(uint64_t seq);
+    void leave_direct_mode(const char* reason);
+
+    // Progressive delivery, see DeviceInterface::set_progressive_delivery_enabled.
+    // The image data starts at offset 0 of the buffer, so the lines are complete in order.
+    size_t progressive_line_size_ = 0; // 0 when disabled
+    void begin_partial_image(const std::shared_ptr<ImageBuffer>& buffer);
+    void publish_received_lines(ImageBuffer& buffer, size_t received, bool is_final);
+
     static const int actual_image_prefix_size_ = 4;
     int usbbulk_chunk_size_ = 0;
     int usbbulk_image_size_ = 0;
@@ -329,18 +409,14 @@ private:
     };
 
 
-    struct frame_rate_cache_item
-    {
-        uint32_t strm_fmt_id;
-        int scaling_factor_id;
-        tcam_image_size dim;
-
-        double min_fps;
-        double max_fps;
-    };
+    // limits of the tested resolution configs, shared on disk by devices with the same firmware
+    tcam::afu420::config_cache config_cache_;
+    std::string firmware_version_;
+    bool config_cache_changed_ = false;
 
-    std::vector<frame_rate_cache_item> frame_rate_cache_;
     int image_bit_depth_ = 8;
+    // bit depth the device was set to, 0 when unknown
+    int device_bit_depth_ = 0;
 
     int get_stream_bitdepth() const
     {
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "UsbDevMemAllocator.h"
+
+#include "../Memory.h"
+#include "../logging.h"
+
+#include <libusb-1.0/libusb.h>
+
+// libusb_dev_mem_alloc was added with libusb 1.0.21
+#if defined(LIBUSB_API_VERSION) && (LIBUSB_API_VERSION >= 0x01000105)
+#define TCAM_HAVE_LIBUSB_DEV_MEM
+#endif
+
+
+tcam::UsbDevMemAllocator::UsbDevMemAllocator(std::shared_ptr<LibusbDevice> device)
+    : device_(std::move(device)), fallback_(get_default_allocator())
+{
+#if !defined(TCAM_HAVE_LIBUSB_DEV_MEM)
+    dev_mem_supported_ = false;
+#endif
+}
+
+
+void* tcam::UsbDevMemAllocator::allocate(TCAM_MEMORY_TYPE t, size_t length, int fd)
+{
+    if (t != TCAM_MEMORY_TYPE_USERPTR || length == 0)
+    {
+        return nullptr;
+    }
+
+#if defined(TCAM_HAVE_LIBUSB_DEV_MEM)
+    {
+        std::scoped_lock lck { mtx_ };
+        if (dev_mem_supported_)
+        {
+            auto ptr = libusb_dev_mem_alloc(device_->get_handle(), length);
+            if (ptr)
+            {
+                dev_mem_.insert(ptr);
+                return ptr;
+            }
+            SPDLOG_INFO("libusb_dev_mem_alloc is not supported. Image data will be copied by the "
+                        "kernel.");
+            dev_mem_supported_ = false;
+        }
+    }
+#endif
+
+    return fallback_->allocate(t, length, fd);
+}
+
+
+void tcam::UsbDevMemAllocator::free(TCAM_MEMORY_TYPE t, void* ptr, size_t length, int fd)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+#if defined(TCAM_HAVE_LIBUSB_DEV_MEM)
+    {
+        std::scoped_lock lck { mtx_ };
+        auto iter = dev_mem_.find(ptr);
+        if (iter != dev_mem_.end())
+        {
+            libusb_dev_mem_free(device_->get_handle(), static_cast<unsigned char*>(ptr), length);
+            dev_mem_.erase(iter);
+            return;
+        }
+    }
+#endif
+
+    fallback_->free(t, ptr, length, fd);
+}
+
+
+std::vector<std::shared_ptr<tcam::Memory>> tcam::UsbDevMemAllocator::allocate(size_t buffer_count,
+                                                                              TCAM_MEMORY_TYPE t,
+                                                                              size_t length,
+                                                                              int fd)
+{
+    if (t != TCAM_MEMORY_TYPE_USERPTR || buffer_count == 0 || length == 0)
+    {
+        return {};
+    }
+
+    std::vector<std::shared_ptr<tcam::Memory>> buffer;
+    buffer.reserve(buffer_count);
+
+    // every buffer is its own usbfs mapping, a single huge mapping may exceed usbfs_memory_mb
+    for (size_t i = 0; i < buffer_count; ++i)
+    {
+        auto ptr = allocate(t, length, fd);
+        if (!ptr)
+        {
+            break;
+        }
+        buffer.push_back(std::make_shared<tcam::Memory>(shared_from_this(), t, length, ptr));
+    }
+
+    return buffer;
+}
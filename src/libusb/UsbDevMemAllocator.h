@@ -0,0 +1,64 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../Allocator.h"
+#include "LibusbDevice.h"
+
+#include <memory>
+#include <mutex>
+#include <set>
+
+namespace tcam
+{
+
+//
+// Allocates image buffers with libusb_dev_mem_alloc.
+// usbfs maps this memory into the kernel, so bulk transfers into it are not copied again by the
+// kernel. When the kernel does not support this (< 4.6 or no usbfs) the buffers come from the
+// default allocator instead.
+// Holds a reference to the device, as the memory has to be released while the handle is open.
+//
+class UsbDevMemAllocator : public AllocatorInterface,
+                           public std::enable_shared_from_this<UsbDevMemAllocator>
+{
+public:
+    explicit UsbDevMemAllocator(std::shared_ptr<LibusbDevice> device);
+
+    std::vector<TCAM_MEMORY_TYPE> get_supported_memory_types() const final
+    {
+        return { TCAM_MEMORY_TYPE_USERPTR };
+    }
+
+    void* allocate(TCAM_MEMORY_TYPE, size_t, int fd = 0) final;
+    void free(TCAM_MEMORY_TYPE, void* ptr, size_t, int fd = 0) final;
+
+    std::vector<std::shared_ptr<Memory>> allocate(size_t buffer_count,
+                                                  TCAM_MEMORY_TYPE,
+                                                  size_t,
+                                                  int fd = 0) final;
+
+private:
+    std::shared_ptr<LibusbDevice> device_;
+    std::shared_ptr<AllocatorInterface> fallback_;
+
+    std::mutex mtx_;
+    std::set<void*> dev_mem_; // pointers that have to be freed with libusb_dev_mem_free
+    bool dev_mem_supported_ = true;
+};
+
+} // namespace tcam
@@ -17,11 +17,16 @@
 #include "UsbHandler.h"
 
 #include "../logging.h"
+#include "../ThreadPolicy.h"
 #include "../utils.h"
 
+#include <cerrno>
 #include <cstdio>
 #include <cstring>
 #include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 namespace tcam
 {
@@ -35,17 +40,36 @@ UsbHandler& UsbHandler::get_instance()
 
 UsbHandler::UsbHandler() : session(std::make_shared<UsbSession>()), run_event_thread(true)
 {
-    event_thread = std::thread(&UsbHandler::handle_events, this);
+    if (setup_event_fds())
+    {
+        event_thread = std::thread(&UsbHandler::handle_events, this);
+    }
+    else
+    {
+        event_thread = std::thread(&UsbHandler::handle_events_polling, this);
+    }
 }
 
 
 UsbHandler::~UsbHandler()
 {
+    deregister_hotplug_callback();
+
     run_event_thread = false;
+    if (wake_fd_ != -1)
+    {
+        uint64_t val = 1;
+        if (write(wake_fd_, &val, sizeof(val)) != sizeof(val))
+        {
+            SPDLOG_ERROR("Unable to wake event thread: {}", strerror(errno));
+        }
+    }
     if (event_thread.joinable())
     {
         event_thread.join();
     }
+
+    close_event_fds();
 }
 
 
@@ -219,7 +243,7 @@ struct libusb_device_handle* UsbHandler::open_device(const std::string& serial)
 }
 
 
-std::vector<DeviceInfo> UsbHandler::get_device_list()
+std::vector<DeviceInfo> UsbHandler::get_device_list(const std::string& serial)
 {
     libusb_device** devs = nullptr;
 
@@ -272,6 +296,16 @@ std::vector<DeviceInfo> UsbHandler::get_device_list()
             dh, desc.iSerialNumber, (unsigned char*)d.serial_number, sizeof(d.serial_number));
 
         libusb_close(dh);
+
+        if (!serial.empty())
+        {
+            if (serial.compare(d.serial_number) != 0)
+            {
+                continue;
+            }
+            ret.push_back(DeviceInfo(d));
+            break;
+        }
         ret.push_back(DeviceInfo(d));
     }
 
@@ -280,11 +314,236 @@ std::vector<DeviceInfo> UsbHandler::get_device_list()
     return ret;
 }
 
+bool UsbHandler::register_hotplug_callback(std::function<void()> callback)
+{
+    if (!libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG))
+    {
+        SPDLOG_DEBUG("libusb has no hotplug support.");
+        return false;
+    }
+
+    std::scoped_lock lck { hotplug_mtx_ };
+    if (hotplug_registered_)
+    {
+        return false;
+    }
+
+    hotplug_callback_ = std::move(callback);
+
+    int ret = libusb_hotplug_register_callback(
+        this->session->get_session(),
+        static_cast<libusb_hotplug_event>(LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED
+                                          | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
+        LIBUSB_HOTPLUG_NO_FLAGS,
+        0x199e,
+        LIBUSB_HOTPLUG_MATCH_ANY,
+        LIBUSB_HOTPLUG_MATCH_ANY,
+        &UsbHandler::hotplug_cb,
+        this,
+        &hotplug_handle_);
+    if (ret != LIBUSB_SUCCESS)
+    {
+        SPDLOG_ERROR("Unable to register hotplug callback: {}", libusb_error_name(ret));
+        hotplug_callback_ = nullptr;
+        return false;
+    }
+
+    hotplug_registered_ = true;
+    return true;
+}
+
+
+void UsbHandler::deregister_hotplug_callback()
+{
+    libusb_hotplug_callback_handle handle;
+    {
+        std::scoped_lock lck { hotplug_mtx_ };
+        if (!hotplug_registered_)
+        {
+            return;
+        }
+        hotplug_callback_ = nullptr;
+        hotplug_registered_ = false;
+        handle = hotplug_handle_;
+    }
+
+    // libusb holds its own lock while calling hotplug_cb, so hotplug_mtx_ must not be held here
+    libusb_hotplug_deregister_callback(this->session->get_session(), handle);
+}
+
+
+int LIBUSB_CALL UsbHandler::hotplug_cb(libusb_context* /*ctx*/,
+                                       libusb_device* /*dev*/,
+                                       libusb_hotplug_event /*event*/,
+                                       void* user_data)
+{
+    auto self = static_cast<UsbHandler*>(user_data);
+
+    // the callback may still be invoked by the event thread while deregistering
+    std::scoped_lock lck { self->hotplug_mtx_ };
+    if (self->hotplug_callback_)
+    {
+        self->hotplug_callback_();
+    }
+    // 0 keeps the callback registered
+    return 0;
+}
+
+
+bool UsbHandler::setup_event_fds()
+{
+    auto ctx = this->session->get_session();
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epoll_fd_ == -1 || wake_fd_ == -1)
+    {
+        SPDLOG_WARN("Unable to create event fds: {}. Falling back to polling.", strerror(errno));
+        close_event_fds();
+        return false;
+    }
+
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) != 0)
+    {
+        SPDLOG_WARN("Unable to watch eventfd: {}. Falling back to polling.", strerror(errno));
+        close_event_fds();
+        return false;
+    }
+
+    // set the notifiers first, fds that are added in between are then reported twice,
+    // which pollfd_added tolerates, instead of not at all
+    libusb_set_pollfd_notifiers(ctx, &UsbHandler::pollfd_added, &UsbHandler::pollfd_removed, this);
+
+    const struct libusb_pollfd** fds = libusb_get_pollfds(ctx);
+    if (fds == nullptr)
+    {
+        SPDLOG_DEBUG("libusb does not expose its file descriptors. Falling back to polling.");
+        libusb_set_pollfd_notifiers(ctx, nullptr, nullptr, nullptr);
+        close_event_fds();
+        return false;
+    }
+
+    for (size_t i = 0; fds[i] != nullptr; ++i) { pollfd_added(fds[i]->fd, fds[i]->events, this); }
+    libusb_free_pollfds(fds);
+
+    return true;
+}
+
+
+void UsbHandler::close_event_fds()
+{
+    if (epoll_fd_ != -1)
+    {
+        libusb_set_pollfd_notifiers(this->session->get_session(), nullptr, nullptr, nullptr);
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
+    if (wake_fd_ != -1)
+    {
+        close(wake_fd_);
+        wake_fd_ = -1;
+    }
+}
+
+
+void LIBUSB_CALL UsbHandler::pollfd_added(int fd, short events, void* user_data)
+{
+    auto self = static_cast<UsbHandler*>(user_data);
+
+    // poll and epoll share the values for POLLIN/POLLOUT
+    struct epoll_event ev = {};
+    ev.events = static_cast<uint16_t>(events);
+    ev.data.fd = fd;
+
+    if (epoll_ctl(self->epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0)
+    {
+        if (errno == EEXIST)
+        {
+            epoll_ctl(self->epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+            return;
+        }
+        SPDLOG_ERROR("Unable to watch libusb fd {}: {}", fd, strerror(errno));
+    }
+}
+
+
+void LIBUSB_CALL UsbHandler::pollfd_removed(int fd, void* user_data)
+{
+    auto self = static_cast<UsbHandler*>(user_data);
+
+    // the fd may already be closed, in which case the kernel removed it from the set
+    epoll_ctl(self->epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+
 void UsbHandler::handle_events()
 {
-    tcam::set_thread_name("tcam_usbhand");
+    tcam::thread_policy::setup_thread("tcam_usbhand");
+
+    auto ctx = this->session->get_session();
+
+    // with timerfd support (linux) libusb handles its timeouts through one of the fds
+    const bool handles_timeouts = libusb_pollfds_handle_timeouts(ctx) != 0;
+
+    static const int max_events = 16;
+    struct epoll_event events[max_events];
+
+    while (run_event_thread)
+    {
+        int timeout_ms = -1;
+        if (!handles_timeouts)
+        {
+            struct timeval tv = {};
+            if (libusb_get_next_timeout(ctx, &tv) == 1)
+            {
+                timeout_ms = static_cast<int>(tv.tv_sec * 1000 + (tv.tv_usec + 999) / 1000);
+            }
+        }
+
+        int n = epoll_wait(epoll_fd_, events, max_events, timeout_ms);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            SPDLOG_ERROR("epoll_wait failed: {}. Falling back to polling.", strerror(errno));
+            handle_events_polling();
+            return;
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            if (events[i].data.fd == wake_fd_)
+            {
+                uint64_t val = 0;
+                [[maybe_unused]] auto r = read(wake_fd_, &val, sizeof(val));
+            }
+        }
+
+        if (!run_event_thread)
+        {
+            break;
+        }
+
+        // only handles what is ready, does not block
+        struct timeval zero = {};
+        libusb_handle_events_timeout_completed(ctx, &zero, nullptr);
+    }
+}
+
+
+void UsbHandler::handle_events_polling()
+{
+    tcam::thread_policy::setup_thread("tcam_usbhand");
+
+    // libusb returns as soon as an event was handled,
+    // the timeout only limits how long shutdown takes
     struct timeval tv = {};
-    tv.tv_usec = 200; // #TODO this seems to be an excessively short wake timeout
+    tv.tv_usec = 100 * 1000;
     while (run_event_thread)
     {
         libusb_handle_events_timeout_completed(this->session->get_session(), &tv, nullptr);
@@ -22,8 +22,10 @@
 #include "UsbSession.h"
 
 #include <atomic>
+#include <functional>
 #include <libusb-1.0/libusb.h>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
@@ -49,8 +51,18 @@ public:
     struct libusb_device_handle* open_device(const std::string& serial);
 
     /// @name get_device_list
+    /// @param serial - when not empty, only the first camera with this serial is returned
     /// @return vector of device_info of found cameras
-    std::vector<DeviceInfo> get_device_list();
+    std::vector<DeviceInfo> get_device_list(const std::string& serial = {});
+
+    /// @name register_hotplug_callback
+    /// @param callback - called from the event thread whenever a device of ours arrives or leaves
+    /// @return false when libusb has no hotplug support on this platform
+    bool register_hotplug_callback(std::function<void()> callback);
+
+    /// @name deregister_hotplug_callback
+    /// @brief callback is not called anymore once this returns
+    void deregister_hotplug_callback();
 
     /// @name open_camera
     /// @param serial - string containing the serial number of the camera that shall be opened
@@ -64,7 +76,30 @@ private:
     std::atomic_bool run_event_thread;
     std::thread event_thread;
 
+    // The event thread sleeps in epoll on the file descriptors libusb uses
+    // and only calls into libusb when one of them is ready.
+    // wake_fd_ is an eventfd that interrupts the wait for shutdown.
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+
+    bool setup_event_fds();
+    void close_event_fds();
+
     void handle_events();
+    void handle_events_polling();
+
+    static void LIBUSB_CALL pollfd_added(int fd, short events, void* user_data);
+    static void LIBUSB_CALL pollfd_removed(int fd, void* user_data);
+
+    std::mutex hotplug_mtx_;
+    std::function<void()> hotplug_callback_;
+    libusb_hotplug_callback_handle hotplug_handle_ = 0;
+    bool hotplug_registered_ = false;
+
+    static int LIBUSB_CALL hotplug_cb(libusb_context* ctx,
+                                      libusb_device* dev,
+                                      libusb_hotplug_event event,
+                                      void* user_data);
 
 }; /* class UsbHandler */
 
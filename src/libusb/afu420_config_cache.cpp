@@ -0,0 +1,167 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "afu420_config_cache.h"
+
+#include "../../external/json/json.hpp"
+#include "../logging.h"
+#include "../utils.h"
+
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+using json = nlohmann::json;
+
+namespace
+{
+// increment when the layout of the entries changes
+constexpr int config_cache_version = 1;
+
+std::filesystem::path get_cache_file(const std::string& firmware)
+{
+    if (firmware.empty()
+        || tcam::get_environment_variable_int("TCAM_FORMAT_CACHE").value_or(1) == 0)
+    {
+        return {};
+    }
+
+    std::filesystem::path dir = tcam::get_environment_variable("TCAM_FORMAT_CACHE_DIR", "");
+    if (dir.empty())
+    {
+        if (auto xdg = tcam::get_environment_variable("XDG_CACHE_HOME", ""); !xdg.empty())
+        {
+            dir = std::filesystem::path(xdg) / "tiscamera";
+        }
+        else if (auto home = tcam::get_environment_variable("HOME", ""); !home.empty())
+        {
+            dir = std::filesystem::path(home) / ".cache" / "tiscamera";
+        }
+        else
+        {
+            return {};
+        }
+    }
+    return dir / ("afu420-" + firmware + ".json");
+}
+
+} // namespace
+
+
+tcam::afu420::config_cache tcam::afu420::load_config_cache(const std::string& firmware)
+{
+    const auto file_path = get_cache_file(firmware);
+    if (file_path.empty())
+    {
+        return {};
+    }
+
+    std::ifstream file(file_path);
+    if (!file)
+    {
+        return {};
+    }
+
+    try
+    {
+        json j = json::parse(file);
+        if (j.at("version").get<int>() != config_cache_version)
+        {
+            return {};
+        }
+
+        config_cache rval;
+        for (const auto& e : j.at("configs"))
+        {
+            config_key key;
+            key.bpp = e.at("bpp").get<int>();
+            key.binning = e.at("binning").get<uint32_t>();
+            key.width = e.at("width").get<uint32_t>();
+            key.height = e.at("height").get<uint32_t>();
+
+            config_limits limits;
+            limits.max_fps = e.at("max_fps").get<double>();
+            limits.exposure_min = e.at("exposure_min").get<uint32_t>();
+            limits.exposure_max = e.at("exposure_max").get<uint32_t>();
+
+            rval[key] = limits;
+        }
+
+        SPDLOG_DEBUG("Loaded {} resolution configs from '{}'", rval.size(), file_path.string());
+        return rval;
+    }
+    catch (const std::exception& ex)
+    {
+        SPDLOG_WARN("Ignoring invalid config cache '{}': {}", file_path.string(), ex.what());
+    }
+    return {};
+}
+
+
+void tcam::afu420::store_config_cache(const std::string& firmware, const config_cache& cache)
+{
+    const auto file_path = get_cache_file(firmware);
+    if (file_path.empty() || cache.empty())
+    {
+        return;
+    }
+
+    json j;
+    j["version"] = config_cache_version;
+    j["configs"] = json::array();
+    for (const auto& [key, limits] : cache)
+    {
+        j["configs"].push_back({
+            { "bpp", key.bpp },
+            { "binning", key.binning },
+            { "width", key.width },
+            { "height", key.height },
+            { "max_fps", limits.max_fps },
+            { "exposure_min", limits.exposure_min },
+            { "exposure_max", limits.exposure_max },
+        });
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(file_path.parent_path(), ec);
+    if (ec)
+    {
+        SPDLOG_DEBUG("Unable to create config cache directory '{}': {}",
+                     file_path.parent_path().string(),
+                     ec.message());
+        return;
+    }
+
+    // other processes may read the file at the same time, so it is replaced in one step
+    auto tmp_path = file_path;
+    tmp_path += fmt::format(".{}.tmp", getpid());
+    {
+        std::ofstream file(tmp_path);
+        if (!(file << j.dump()))
+        {
+            SPDLOG_DEBUG("Unable to write config cache '{}'", tmp_path.string());
+            std::filesystem::remove(tmp_path, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tmp_path, file_path, ec);
+    if (ec)
+    {
+        SPDLOG_DEBUG("Unable to write config cache '{}': {}", file_path.string(), ec.message());
+        std::filesystem::remove(tmp_path, ec);
+    }
+}
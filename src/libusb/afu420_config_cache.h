@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+
+namespace tcam::afu420
+{
+
+// resolution configuration as it is tested by the firmware, the roi start does not matter
+struct config_key
+{
+    int bpp = 0;
+    uint32_t binning = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    bool operator<(const config_key& other) const noexcept
+    {
+        return std::tie(bpp, binning, width, height)
+               < std::tie(other.bpp, other.binning, other.width, other.height);
+    }
+};
+
+// what the firmware reports for a tested resolution configuration
+struct config_limits
+{
+    double max_fps = 0.0;
+    uint32_t exposure_min = 0;
+    uint32_t exposure_max = 0;
+};
+
+using config_cache = std::map<config_key, config_limits>;
+
+/*
+ * On disk cache of the limits of all resolution configurations of a AFU420.
+ *
+ * Testing a configuration takes a bit depth write, the configuration write and three reads.
+ * The result only depends on the firmware, whose version is the key of a cache file.
+ * The files are stored in the directory of the GenICam format cache, see aravis_format_cache.h.
+ * TCAM_FORMAT_CACHE=0 disables the cache.
+ */
+
+// Returns an empty cache when the cache is disabled or no file exists for firmware
+config_cache load_config_cache(const std::string& firmware);
+
+void store_config_cache(const std::string& firmware, const config_cache& cache);
+
+} // namespace tcam::afu420
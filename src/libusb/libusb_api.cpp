@@ -46,3 +46,26 @@ std::vector<tcam::DeviceInfo> tcam::LibUsbBackend::get_device_list()
 {
     return tcam::libusb::get_libusb_device_list();
 }
+
+
+std::optional<tcam::DeviceInfo> tcam::LibUsbBackend::find_device(const std::string& serial)
+{
+    auto list = UsbHandler::get_instance().get_device_list(serial);
+    if (list.empty())
+    {
+        return std::nullopt;
+    }
+    return list.front();
+}
+
+
+bool tcam::LibUsbBackend::start_monitoring(const backend_monitor_callbacks& callbacks)
+{
+    return UsbHandler::get_instance().register_hotplug_callback(callbacks.device_list_changed);
+}
+
+
+void tcam::LibUsbBackend::stop_monitoring()
+{
+    UsbHandler::get_instance().deregister_hotplug_callback();
+}
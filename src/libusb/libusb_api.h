@@ -31,6 +31,12 @@ public:
     };
     std::shared_ptr<DeviceInterface> open_device(const tcam::DeviceInfo&) final;
     std::vector<DeviceInfo> get_device_list() final;
+    // stops at the first camera with a matching serial descriptor
+    std::optional<DeviceInfo> find_device(const std::string& serial) final;
+
+    // Uses the libusb hotplug callbacks, when the platform supports them
+    bool start_monitoring(const backend_monitor_callbacks& callbacks) final;
+    void stop_monitoring() final;
 
     static LibUsbBackend* get_instance()
     {
@@ -3,6 +3,7 @@
 
 #include "libusb_utils.h"
 
+#include "../ThreadPolicy.h"
 #include "../utils.h"
 #include "UsbHandler.h"
 
@@ -14,16 +15,31 @@ std::vector<DeviceInfo> tcam::libusb::get_libusb_device_list()
     return UsbHandler::get_instance().get_device_list();
 }
 
-bool libusb::deliver_thread::push(std::shared_ptr<ImageBuffer>&& ptr)
+std::shared_ptr<ImageBuffer> libusb::deliver_thread::push(std::shared_ptr<ImageBuffer>&& ptr)
 {
-    std::scoped_lock lck { mutex_ };
     if (end_thread_)
     {
-        return false;
+        return std::move(ptr);
     }
-    queue_.push_back(std::move(ptr));
-    cv_.notify_one();
-    return true;
+
+    // the transfer completed, the deliver thread hands the image on
+    ptr->record_stage(timing::stage::backend_dequeue);
+
+    auto dropped = queue_.push(std::move(ptr));
+
+    // pairs with the fence in thread_main, either we see consumer_waiting_ or it sees the image
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumer_waiting_.load())
+    {
+        std::scoped_lock lck { mutex_ };
+        cv_.notify_one();
+    }
+
+    if (dropped)
+    {
+        return std::move(*dropped);
+    }
+    return nullptr;
 }
 
 
@@ -46,8 +62,9 @@ void libusb::deliver_thread::stop()
     queue_.clear();
 }
 
-void libusb::deliver_thread::start(const std::shared_ptr<IImageBufferSink>& sink)
+void libusb::deliver_thread::start(const std::shared_ptr<IImageBufferSink>& sink, size_t capacity)
 {
+    queue_.reset(capacity);
     end_thread_ = false;
 
     sink_ = sink;
@@ -60,30 +77,21 @@ void libusb::deliver_thread::start(const std::shared_ptr<IImageBufferSink>& sink
 
 void libusb::deliver_thread::thread_main()
 {
-    tcam::set_thread_name("tcam-usb-dlv");
+    tcam::thread_policy::setup_thread("tcam-usb-dlv");
 
-    while (true)
+    while (!end_thread_)
     {
-        std::shared_ptr<tcam::ImageBuffer> ptr;
+        auto ptr = queue_.pop();
+        if (!ptr)
         {
             std::unique_lock lck { mutex_ };
-            if (!end_thread_ && queue_.empty())
-            {
-                cv_.wait(lck);
-            }
-            if (end_thread_)
-            {
-                return;
-            }
-            if (!queue_.empty())
-            {
-                ptr = queue_.front();
-                queue_.erase(queue_.begin());
-            }
-        }
-        if (ptr)
-        {
-            sink_->push_image(ptr);
+            consumer_waiting_ = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            cv_.wait(lck, [this] { return end_thread_ || !queue_.empty(); });
+            consumer_waiting_ = false;
+            continue;
         }
+
+        sink_->push_image(*ptr);
     }
-}
\ No newline at end of file
+}
@@ -5,9 +5,11 @@
 #include "../DeviceInfo.h"
 #include "../ImageBuffer.h"
 #include "../SinkInterface.h"
+#include "../spsc_queue.h"
 
 #include <vector>
 
+#include <atomic>
 #include <condition_variable>
 #include <thread>
 #include <mutex>
@@ -18,22 +20,43 @@ namespace tcam::libusb
 std::vector<DeviceInfo> get_libusb_device_list();
 
 
+// Hands images from the libusb event thread to the sink.
+// The queue between both is a bounded lock free ring, sized by start.
 class deliver_thread
 {
 public:
-    bool push(std::shared_ptr<tcam::ImageBuffer>&& ptr);
+    explicit deliver_thread(overflow_policy policy = overflow_policy::drop_newest) : queue_(policy)
+    {
+    }
 
-    void start(const std::shared_ptr<IImageBufferSink>& list);
+    // Returns the buffer that has to be requeued because it will not be delivered,
+    // either ptr itself when the thread is not running or the dropped buffer when the queue
+    // overflowed. nullptr otherwise.
+    std::shared_ptr<tcam::ImageBuffer> push(std::shared_ptr<tcam::ImageBuffer>&& ptr);
+
+    // capacity - max number of queued images, usually the number of buffers
+    void start(const std::shared_ptr<IImageBufferSink>& sink, size_t capacity);
+    // Must not run concurrently with push, as it clears the queue.
     void stop();
+
+    // number of images dropped because the queue was full, since start
+    size_t get_dropped_count() const noexcept
+    {
+        return queue_.get_dropped_count();
+    }
+
 private:
     void thread_main();
 
     std::thread thread_;
-    std::vector<std::shared_ptr<tcam::ImageBuffer>> queue_;
+    spsc_queue<std::shared_ptr<tcam::ImageBuffer>> queue_;
+
+    // only used when the deliver thread has to sleep because the queue is empty
     std::condition_variable cv_;
     std::mutex mutex_;
+    std::atomic<bool> consumer_waiting_ = false;
 
-    bool end_thread_ = false;
+    std::atomic<bool> end_thread_ = false;
 
     std::shared_ptr<IImageBufferSink> sink_;
 };
@@ -21,6 +21,75 @@
 
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <spdlog/spdlog.h>
 
+namespace tcam
+{
+
+// Lets one message per interval through, used by the TCAM_LOG_RATELIMITED macros
+class log_rate_limiter
+{
+public:
+    explicit log_rate_limiter(std::chrono::milliseconds interval) noexcept
+        : interval_ns_(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count())
+    {
+    }
+
+    // suppressed receives the number of messages that were dropped since the last allowed one
+    bool allow(uint64_t& suppressed) noexcept
+    {
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count();
+
+        int64_t next = next_ns_.load(std::memory_order_relaxed);
+        if (now < next
+            || !next_ns_.compare_exchange_strong(next, now + interval_ns_, std::memory_order_relaxed))
+        {
+            suppressed_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    const int64_t interval_ns_;
+    std::atomic<int64_t> next_ns_ = 0;
+    std::atomic<uint64_t> suppressed_ = 0;
+};
+
+} // namespace tcam
+
+// For conditions that may occur for every image.
+// Logs at most once per interval_ms for this call site, followed by the number of messages
+// that were dropped in between.
+#define TCAM_LOG_RATELIMITED(level, interval_ms, ...)                                         \
+    do                                                                                        \
+    {                                                                                         \
+        if (spdlog::should_log(level))                                                        \
+        {                                                                                     \
+            static tcam::log_rate_limiter tcam_rate_limiter_ { std::chrono::milliseconds(     \
+                interval_ms) };                                                               \
+            uint64_t tcam_suppressed_ = 0;                                                    \
+            if (tcam_rate_limiter_.allow(tcam_suppressed_))                                   \
+            {                                                                                 \
+                SPDLOG_LOGGER_CALL(spdlog::default_logger_raw(), level, __VA_ARGS__);         \
+                if (tcam_suppressed_ > 0)                                                     \
+                {                                                                             \
+                    SPDLOG_LOGGER_CALL(spdlog::default_logger_raw(),                          \
+                                       level,                                                 \
+                                       "{} similar messages suppressed",                      \
+                                       tcam_suppressed_);                                     \
+                }                                                                             \
+            }                                                                                 \
+        }                                                                                     \
+    } while (0)
+
+#define SPDLOG_WARN_RATELIMITED(...)  TCAM_LOG_RATELIMITED(spdlog::level::warn, 1000, __VA_ARGS__)
+#define SPDLOG_ERROR_RATELIMITED(...) TCAM_LOG_RATELIMITED(spdlog::level::err, 1000, __VA_ARGS__)
+
 #endif /* TCAM_LOGGING_H */
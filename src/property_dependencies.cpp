@@ -20,45 +20,50 @@ namespace
 {
 
 // clang-format off
-static const tcam::property::dependency_entry dependency_list[] =
+constexpr std::string_view exposure_auto_dependencies[] = { "ExposureTime" };
+constexpr std::string_view exposure_auto_upper_limit_auto_dependencies[] = { "ExposureAutoUpperLimit" };
+constexpr std::string_view gain_auto_dependencies[] = { "Gain" };
+constexpr std::string_view balance_white_auto_dependencies[] = { "BalanceWhiteRed", "BalanceWhiteGreen", "BalanceWhiteBlue" };
+constexpr std::string_view offset_auto_center_dependencies[] = { "OffsetX", "OffsetY" };
+constexpr std::string_view trigger_mode_dependencies[] = { "TriggerSoftware" };
+
+constexpr tcam::property::dependency_entry dependency_list[] =
 {
     {
         "ExposureAuto",
-        { "ExposureTime" },
+        exposure_auto_dependencies,
         "Continuous"
     },
     {
         "ExposureAutoUpperLimitAuto",
-        {"ExposureAutoUpperLimit"},
+        exposure_auto_upper_limit_auto_dependencies,
         "Continuous"
     },
     {
         "GainAuto",
-        { "Gain" },
+        gain_auto_dependencies,
         "Continuous"
     },
     {
         "BalanceWhiteAuto",
-        { "BalanceWhiteRed","BalanceWhiteGreen", "BalanceWhiteBlue", },
+        balance_white_auto_dependencies,
         "Continuous"
     },
     {
         "OffsetAutoCenter",
-        { "OffsetX", "OffsetY" },
+        offset_auto_center_dependencies,
         "On"
     },
     {
         "TriggerMode",
-        {"TriggerSoftware"},
+        trigger_mode_dependencies,
         "Off"
     }
 };
 
 // clang-format on
 
-} // namespace
-
-const tcam::property::dependency_entry* tcam::property::find_dependency_entry(std::string_view name)
+constexpr const tcam::property::dependency_entry* find_entry(std::string_view name) noexcept
 {
     for (const auto& entry : dependency_list)
     {
@@ -69,3 +74,47 @@ const tcam::property::dependency_entry* tcam::property::find_dependency_entry(st
     }
     return nullptr;
 }
+
+// Every property may appear only once, otherwise the second entry would never be found.
+// A property that locks itself or is locked by two properties would flip its own lock state.
+constexpr bool is_valid_dependency_list() noexcept
+{
+    for (const auto& entry : dependency_list)
+    {
+        if (find_entry(entry.name) != &entry)
+        {
+            return false;
+        }
+        for (const auto& dep : entry.dependent_property_names)
+        {
+            if (dep == entry.name)
+            {
+                return false;
+            }
+            for (const auto& other : dependency_list)
+            {
+                if (&other == &entry)
+                {
+                    continue;
+                }
+                for (const auto& other_dep : other.dependent_property_names)
+                {
+                    if (other_dep == dep)
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(is_valid_dependency_list(), "Invalid property dependency list.");
+
+} // namespace
+
+const tcam::property::dependency_entry* tcam::property::find_dependency_entry(std::string_view name)
+{
+    return find_entry(name);
+}
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <string_view>
 #include <vector>
@@ -47,11 +48,49 @@ public:
     }
 };
 
+// View on a constant array of property names, so that the dependency table needs no
+// dynamic initialization.
+class dependent_name_list
+{
+public:
+    template<size_t N>
+    constexpr dependent_name_list(const std::string_view (&names)[N]) noexcept
+        : begin_(names), size_(N)
+    {
+    }
+
+    constexpr const std::string_view* begin() const noexcept
+    {
+        return begin_;
+    }
+    constexpr const std::string_view* end() const noexcept
+    {
+        return begin_ + size_;
+    }
+    constexpr size_t size() const noexcept
+    {
+        return size_;
+    }
+    constexpr bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    operator std::vector<std::string_view>() const
+    {
+        return { begin(), end() };
+    }
+
+private:
+    const std::string_view* begin_ = nullptr;
+    size_t size_ = 0;
+};
+
 struct dependency_entry
 {
-    const std::string_view name;
-    const std::vector<std::string_view> dependent_property_names;
-    const std::string_view prop_enum_state_for_locked;
+    std::string_view name;
+    dependent_name_list dependent_property_names;
+    std::string_view prop_enum_state_for_locked;
     //const bool prop_boolean_state_for_locked = false; // currently unused
 };
 
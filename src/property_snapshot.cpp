@@ -0,0 +1,584 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "property_snapshot.h"
+
+#include "DeviceInterface.h"
+#include "logging.h"
+#include "property_dependencies.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <variant>
+
+using namespace tcam::property;
+
+namespace
+{
+
+constexpr std::string_view snapshot_magic = "TCSS";
+constexpr uint16_t snapshot_version = 1;
+
+// enumerations are stored as the entry index
+using snapshot_value = std::variant<bool, int64_t, double, std::string>;
+
+struct snapshot_entry
+{
+    uint32_t name_hash = 0;
+    tcamprop1::prop_type type = tcamprop1::prop_type::Integer;
+    snapshot_value value;
+};
+
+// FNV-1a
+uint32_t hash_string(std::string_view str)
+{
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : str)
+    {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+class snapshot_writer
+{
+public:
+    template<class T> void put(T value)
+    {
+        uint64_t tmp = 0;
+        static_assert(sizeof(T) <= sizeof(tmp));
+        std::memcpy(&tmp, &value, sizeof(T));
+        for (size_t i = 0; i < sizeof(T); ++i)
+        {
+            data_.push_back(static_cast<uint8_t>(tmp >> (8 * i)));
+        }
+    }
+
+    void put_bytes(std::string_view str)
+    {
+        data_.insert(data_.end(), str.begin(), str.end());
+    }
+
+    std::vector<uint8_t> take()
+    {
+        return std::move(data_);
+    }
+
+private:
+    std::vector<uint8_t> data_;
+};
+
+class snapshot_reader
+{
+public:
+    explicit snapshot_reader(const std::vector<uint8_t>& data) : data_(data) {}
+
+    template<class T> bool get(T& value)
+    {
+        if (data_.size() - pos_ < sizeof(T))
+        {
+            return false;
+        }
+        uint64_t tmp = 0;
+        for (size_t i = 0; i < sizeof(T); ++i)
+        {
+            tmp |= static_cast<uint64_t>(data_[pos_ + i]) << (8 * i);
+        }
+        std::memcpy(&value, &tmp, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool get_bytes(size_t count, std::string& str)
+    {
+        if (data_.size() - pos_ < count)
+        {
+            return false;
+        }
+        str.assign(reinterpret_cast<const char*>(data_.data()) + pos_, count);
+        pos_ += count;
+        return true;
+    }
+
+    bool at_end() const noexcept
+    {
+        return pos_ == data_.size();
+    }
+
+private:
+    const std::vector<uint8_t>& data_;
+    size_t pos_ = 0;
+};
+
+
+// Command, read-only and locked properties are not part of a snapshot,
+// the values of locked ones follow from the properties that lock them.
+bool is_snapshot_property(const IPropertyBase& prop)
+{
+    if (prop.get_type() == tcamprop1::prop_type::Command)
+    {
+        return false;
+    }
+    if (prop.get_static_info().access != tcamprop1::Access_t::RW)
+    {
+        return false;
+    }
+    const auto flags = prop.get_flags();
+    return (flags & PropertyFlags::Implemented) && (flags & PropertyFlags::Available)
+           && !(flags & PropertyFlags::Locked);
+}
+
+
+outcome::result<snapshot_value> read_value(const IPropertyBase& prop)
+{
+    auto to_snapshot_value = [](auto res) -> outcome::result<snapshot_value>
+    {
+        if (!res)
+        {
+            return res.error();
+        }
+        return snapshot_value { std::move(res.value()) };
+    };
+
+    switch (prop.get_type())
+    {
+        case tcamprop1::prop_type::Integer:
+        {
+            return to_snapshot_value(static_cast<const IPropertyInteger&>(prop).get_value());
+        }
+        case tcamprop1::prop_type::Float:
+        {
+            return to_snapshot_value(static_cast<const IPropertyFloat&>(prop).get_value());
+        }
+        case tcamprop1::prop_type::Boolean:
+        {
+            return to_snapshot_value(static_cast<const IPropertyBool&>(prop).get_value());
+        }
+        case tcamprop1::prop_type::Enumeration:
+        {
+            auto res = static_cast<const IPropertyEnum&>(prop).get_value();
+            if (!res)
+            {
+                return res.error();
+            }
+            return snapshot_value { std::string(res.value()) };
+        }
+        case tcamprop1::prop_type::String:
+        {
+            return to_snapshot_value(static_cast<const IPropertyString&>(prop).get_value());
+        }
+        case tcamprop1::prop_type::Command:
+        {
+            break;
+        }
+    }
+    return tcam::status::PropertyNotImplemented;
+}
+
+
+outcome::result<void> write_value(IPropertyBase& prop, const snapshot_value& value)
+{
+    switch (prop.get_type())
+    {
+        case tcamprop1::prop_type::Integer:
+        {
+            return static_cast<IPropertyInteger&>(prop).set_value(std::get<int64_t>(value));
+        }
+        case tcamprop1::prop_type::Float:
+        {
+            return static_cast<IPropertyFloat&>(prop).set_value(std::get<double>(value));
+        }
+        case tcamprop1::prop_type::Boolean:
+        {
+            return static_cast<IPropertyBool&>(prop).set_value(std::get<bool>(value));
+        }
+        case tcamprop1::prop_type::Enumeration:
+        {
+            return static_cast<IPropertyEnum&>(prop).set_value(std::get<std::string>(value));
+        }
+        case tcamprop1::prop_type::String:
+        {
+            if (auto ec = static_cast<IPropertyString&>(prop).set_value(std::get<std::string>(value)))
+            {
+                return ec;
+            }
+            return outcome::success();
+        }
+        case tcamprop1::prop_type::Command:
+        {
+            break;
+        }
+    }
+    return tcam::status::PropertyNotImplemented;
+}
+
+
+void write_entry(snapshot_writer& out, const snapshot_entry& entry)
+{
+    out.put(entry.name_hash);
+    out.put(static_cast<uint8_t>(entry.type));
+
+    switch (entry.type)
+    {
+        case tcamprop1::prop_type::Integer:
+        {
+            out.put(std::get<int64_t>(entry.value));
+            break;
+        }
+        case tcamprop1::prop_type::Float:
+        {
+            out.put(std::get<double>(entry.value));
+            break;
+        }
+        case tcamprop1::prop_type::Boolean:
+        {
+            out.put(static_cast<uint8_t>(std::get<bool>(entry.value)));
+            break;
+        }
+        case tcamprop1::prop_type::Enumeration:
+        {
+            out.put(static_cast<uint16_t>(std::get<int64_t>(entry.value)));
+            break;
+        }
+        case tcamprop1::prop_type::String:
+        {
+            const auto& str = std::get<std::string>(entry.value);
+            out.put(static_cast<uint16_t>(str.size()));
+            out.put_bytes(str);
+            break;
+        }
+        case tcamprop1::prop_type::Command:
+        {
+            break;
+        }
+    }
+}
+
+
+bool read_entry(snapshot_reader& in, snapshot_entry& entry)
+{
+    uint8_t type = 0;
+    if (!in.get(entry.name_hash) || !in.get(type))
+    {
+        return false;
+    }
+    entry.type = static_cast<tcamprop1::prop_type>(type);
+
+    switch (entry.type)
+    {
+        case tcamprop1::prop_type::Integer:
+        {
+            entry.value = int64_t { 0 };
+            return in.get(std::get<int64_t>(entry.value));
+        }
+        case tcamprop1::prop_type::Float:
+        {
+            entry.value = 0.0;
+            return in.get(std::get<double>(entry.value));
+        }
+        case tcamprop1::prop_type::Boolean:
+        {
+            uint8_t value = 0;
+            if (!in.get(value))
+            {
+                return false;
+            }
+            entry.value = value != 0;
+            return true;
+        }
+        case tcamprop1::prop_type::Enumeration:
+        {
+            uint16_t index = 0;
+            if (!in.get(index))
+            {
+                return false;
+            }
+            entry.value = static_cast<int64_t>(index);
+            return true;
+        }
+        case tcamprop1::prop_type::String:
+        {
+            uint16_t size = 0;
+            std::string str;
+            if (!in.get(size) || !in.get_bytes(size, str))
+            {
+                return false;
+            }
+            entry.value = std::move(str);
+            return true;
+        }
+        case tcamprop1::prop_type::Command:
+        {
+            break;
+        }
+    }
+    return false;
+}
+
+
+std::shared_ptr<IPropertyWriteBatch> get_write_batch(IPropertyBase* prop)
+{
+    auto provider = dynamic_cast<IPropertyWriteBatchProvider*>(prop);
+    return provider ? provider->get_write_batch() : nullptr;
+}
+
+} // namespace
+
+
+outcome::result<std::vector<uint8_t>> tcam::property::capture_snapshot(
+    DeviceInterface& dev,
+    const std::vector<std::shared_ptr<IPropertyBase>>& properties,
+    std::string_view user_set)
+{
+    if (user_set.size() > UINT8_MAX)
+    {
+        return tcam::status::InvalidParameter;
+    }
+
+    std::vector<snapshot_entry> entries;
+    entries.reserve(properties.size());
+    for (const auto& prop : properties)
+    {
+        if (!is_snapshot_property(*prop))
+        {
+            continue;
+        }
+
+        auto value = read_value(*prop);
+        if (!value)
+        {
+            SPDLOG_DEBUG("Not adding '{}' to the snapshot: {}",
+                         prop->get_name(),
+                         value.error().message());
+            continue;
+        }
+
+        snapshot_entry entry { hash_string(prop->get_name()), prop->get_type(), value.value() };
+        if (entry.type == tcamprop1::prop_type::Enumeration)
+        {
+            const auto entries_of_prop = static_cast<IPropertyEnum&>(*prop).get_entries();
+            auto iter = std::find(
+                entries_of_prop.begin(), entries_of_prop.end(), std::get<std::string>(entry.value));
+            if (iter == entries_of_prop.end())
+            {
+                continue;
+            }
+            entry.value = static_cast<int64_t>(iter - entries_of_prop.begin());
+        }
+        else if (entry.type == tcamprop1::prop_type::String
+                 && std::get<std::string>(entry.value).size() > UINT16_MAX)
+        {
+            continue;
+        }
+        entries.push_back(std::move(entry));
+    }
+
+    if (!user_set.empty())
+    {
+        OUTCOME_TRY(dev.save_user_set(user_set));
+    }
+
+    snapshot_writer out;
+    out.put_bytes(snapshot_magic);
+    out.put(snapshot_version);
+    out.put(hash_string(dev.get_device_description().get_name()));
+    out.put(hash_string(dev.get_firmware_version()));
+    out.put(static_cast<uint8_t>(user_set.size()));
+    out.put_bytes(user_set);
+    out.put(static_cast<uint32_t>(entries.size()));
+    for (const auto& entry : entries) { write_entry(out, entry); }
+
+    return out.take();
+}
+
+
+outcome::result<snapshot_restore_result> tcam::property::restore_snapshot(
+    DeviceInterface& dev,
+    const std::vector<std::shared_ptr<IPropertyBase>>& properties,
+    const std::vector<uint8_t>& data)
+{
+    snapshot_reader in(data);
+
+    std::string magic;
+    uint16_t version = 0;
+    uint32_t model_hash = 0;
+    uint32_t firmware_hash = 0;
+    uint8_t user_set_size = 0;
+    std::string user_set;
+    uint32_t entry_count = 0;
+    if (!in.get_bytes(snapshot_magic.size(), magic) || magic != snapshot_magic || !in.get(version)
+        || !in.get(model_hash) || !in.get(firmware_hash) || !in.get(user_set_size)
+        || !in.get_bytes(user_set_size, user_set) || !in.get(entry_count))
+    {
+        SPDLOG_ERROR("Data is not a property snapshot.");
+        return tcam::status::InvalidParameter;
+    }
+    if (version != snapshot_version)
+    {
+        SPDLOG_ERROR("Property snapshot version {} is not supported.", version);
+        return tcam::status::InvalidParameter;
+    }
+    if (model_hash != hash_string(dev.get_device_description().get_name())
+        || firmware_hash != hash_string(dev.get_firmware_version()))
+    {
+        SPDLOG_ERROR("Property snapshot was taken from another model or firmware.");
+        return tcam::status::InvalidParameter;
+    }
+
+    std::vector<snapshot_entry> entries(entry_count);
+    for (auto& entry : entries)
+    {
+        if (!read_entry(in, entry))
+        {
+            SPDLOG_ERROR("Property snapshot is damaged.");
+            return tcam::status::InvalidParameter;
+        }
+    }
+    if (!in.at_end())
+    {
+        SPDLOG_ERROR("Property snapshot is damaged.");
+        return tcam::status::InvalidParameter;
+    }
+
+    snapshot_restore_result result;
+
+    if (!user_set.empty())
+    {
+        if (auto res = dev.load_user_set(user_set); res)
+        {
+            result.loaded_user_set = true;
+        }
+        else
+        {
+            SPDLOG_WARN("Unable to load user set '{}': {}. Writing the values instead.",
+                        user_set,
+                        res.error().message());
+        }
+    }
+
+    // hashes that more than one property has cannot be resolved
+    std::unordered_map<uint32_t, IPropertyBase*> props_by_hash;
+    for (const auto& prop : properties)
+    {
+        auto [iter, added] = props_by_hash.emplace(hash_string(prop->get_name()), prop.get());
+        if (!added)
+        {
+            iter->second = nullptr;
+        }
+    }
+
+    std::vector<std::pair<IPropertyBase*, snapshot_value>> to_write;
+    for (auto& entry : entries)
+    {
+        auto iter = props_by_hash.find(entry.name_hash);
+        if (iter == props_by_hash.end() || iter->second == nullptr
+            || iter->second->get_type() != entry.type)
+        {
+            SPDLOG_WARN("Property snapshot entry {:08x} does not match a property.", entry.name_hash);
+            result.failed++;
+            continue;
+        }
+        auto prop = iter->second;
+
+        // the user set contains everything but the properties libtcam implements
+        if (result.loaded_user_set && !(prop->get_flags() & PropertyFlags::External))
+        {
+            continue;
+        }
+
+        if (entry.type == tcamprop1::prop_type::Enumeration)
+        {
+            const auto entries_of_prop = static_cast<IPropertyEnum*>(prop)->get_entries();
+            const auto index = std::get<int64_t>(entry.value);
+            if (index >= static_cast<int64_t>(entries_of_prop.size()))
+            {
+                SPDLOG_WARN("Property snapshot has no valid entry for '{}'.", prop->get_name());
+                result.failed++;
+                continue;
+            }
+            entry.value = entries_of_prop.at(index);
+        }
+
+        if (auto current = read_value(*prop); current && current.value() == entry.value)
+        {
+            result.unchanged++;
+            continue;
+        }
+        to_write.emplace_back(prop, std::move(entry.value));
+    }
+
+    // properties like ExposureAuto lock others, so they are written first and on their own
+    auto first_dependent = std::stable_partition(
+        to_write.begin(),
+        to_write.end(),
+        [](const auto& e) { return find_dependency_entry(e.first->get_name()) != nullptr; });
+
+    auto write = [&result](IPropertyBase& prop, const snapshot_value& value)
+    {
+        if (auto res = write_value(prop, value); !res)
+        {
+            SPDLOG_WARN("Unable to restore '{}': {}", prop.get_name(), res.error().message());
+            result.failed++;
+            return;
+        }
+        result.written.emplace_back(prop.get_name());
+    };
+
+    for (auto iter = to_write.begin(); iter != first_dependent; ++iter)
+    {
+        write(*iter->first, iter->second);
+    }
+
+    std::shared_ptr<IPropertyWriteBatch> batch;
+    for (auto iter = first_dependent; iter != to_write.end(); ++iter)
+    {
+        auto prop_batch = get_write_batch(iter->first);
+        if (!prop_batch || (batch && prop_batch != batch))
+        {
+            batch = nullptr;
+            break;
+        }
+        batch = prop_batch;
+    }
+    if (batch && std::distance(first_dependent, to_write.end()) > 1)
+    {
+        batch->begin_writes();
+    }
+    else
+    {
+        batch = nullptr;
+    }
+
+    const auto batch_begin = result.written.size();
+    for (auto iter = first_dependent; iter != to_write.end(); ++iter)
+    {
+        write(*iter->first, iter->second);
+    }
+
+    if (batch)
+    {
+        if (auto res = batch->commit_writes(); !res)
+        {
+            SPDLOG_ERROR("Unable to restore property snapshot: {}", res.error().message());
+            result.failed += result.written.size() - batch_begin;
+            result.written.resize(batch_begin);
+        }
+    }
+
+    return result;
+}
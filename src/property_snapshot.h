@@ -0,0 +1,73 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "PropertyInterfaces.h"
+#include "error.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tcam
+{
+class DeviceInterface;
+}
+
+namespace tcam::property
+{
+
+/*
+ * Binary snapshot of the writable property values of a device.
+ *
+ * Properties are stored by the hash of their name and enumerations by the index of their entry,
+ * so a snapshot only fits the model and firmware it was taken from, which restore_snapshot checks.
+ *
+ * Layout, little endian:
+ *   "TCSS", u16 version, u32 model hash, u32 firmware hash, u8 length + user set name,
+ *   u32 entry count, entries of u32 name hash, u8 tcamprop1::prop_type and the value
+ *   (i64, f64, u8 for booleans, u16 enum entry index, u16 length + bytes for strings)
+ */
+
+struct snapshot_restore_result
+{
+    // the device loaded the user set of the snapshot, only library properties were written
+    bool loaded_user_set = false;
+    std::vector<std::string> written;
+    size_t unchanged = 0;
+    size_t failed = 0;
+};
+
+// With a non-empty user_set the device also stores its settings in that user set.
+// Restoring such a snapshot then only loads the user set.
+outcome::result<std::vector<uint8_t>> capture_snapshot(
+    DeviceInterface& dev,
+    const std::vector<std::shared_ptr<IPropertyBase>>& properties,
+    std::string_view user_set = {});
+
+// Writes the values that differ from the current ones, properties that lock others first and
+// the rest in one batch when the backend allows it.
+// Fails with InvalidParameter for damaged snapshots and snapshots of other models or firmwares.
+outcome::result<snapshot_restore_result> restore_snapshot(
+    DeviceInterface& dev,
+    const std::vector<std::shared_ptr<IPropertyBase>>& properties,
+    const std::vector<uint8_t>& data);
+
+} // namespace tcam::property
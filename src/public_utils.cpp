@@ -20,6 +20,9 @@
 #include "utils.h"
 
 #include <algorithm>
+#include <mutex>
+#include <optional>
+#include <sstream>
 
 using namespace tcam;
 
@@ -34,7 +37,8 @@ std::vector<TCAM_DEVICE_TYPE> tcam::get_device_type_list()
         TCAM_DEVICE_TYPE_PIMIPI,
         TCAM_DEVICE_TYPE_MIPI,
         TCAM_DEVICE_TYPE_TEGRA,
-        TCAM_DEVICE_TYPE_VIRTCAM
+        TCAM_DEVICE_TYPE_VIRTCAM,
+        TCAM_DEVICE_TYPE_REPLAY
     };
 }
 
@@ -71,6 +75,8 @@ std::string tcam::tcam_device_type_to_string(TCAM_DEVICE_TYPE type)
             return "tegra";
         case TCAM_DEVICE_TYPE_VIRTCAM:
             return "virtcam";
+        case TCAM_DEVICE_TYPE_REPLAY:
+            return "replay";
         case TCAM_DEVICE_TYPE_UNKNOWN:
         default:
             return "unknown";
@@ -104,10 +110,64 @@ TCAM_DEVICE_TYPE tcam::tcam_device_from_string(const std::string& input)
         return TCAM_DEVICE_TYPE_TEGRA;
     else if (str == "virtcam")
         return TCAM_DEVICE_TYPE_VIRTCAM;
+    else if (str == "replay")
+        return TCAM_DEVICE_TYPE_REPLAY;
 
     return TCAM_DEVICE_TYPE_UNKNOWN;
 }
 
+
+namespace
+{
+std::mutex enabled_backends_mtx;
+// std::nullopt until set_enabled_backends or the first is_backend_enabled
+std::optional<std::vector<TCAM_DEVICE_TYPE>> enabled_backends;
+
+std::vector<TCAM_DEVICE_TYPE> parse_enabled_backends(const std::string& str)
+{
+    std::vector<TCAM_DEVICE_TYPE> ret;
+
+    std::stringstream ss(str);
+    std::string entry;
+    while (std::getline(ss, entry, ','))
+    {
+        auto type = tcam_device_from_string(entry);
+        if (type != TCAM_DEVICE_TYPE_UNKNOWN)
+        {
+            ret.push_back(type);
+        }
+    }
+    return ret;
+}
+} // namespace
+
+
+void tcam::set_enabled_backends(const std::vector<TCAM_DEVICE_TYPE>& types)
+{
+    std::scoped_lock lck { enabled_backends_mtx };
+    enabled_backends = types;
+}
+
+
+bool tcam::is_backend_enabled(TCAM_DEVICE_TYPE type)
+{
+    std::scoped_lock lck { enabled_backends_mtx };
+
+    if (!enabled_backends)
+    {
+        // e.g. TCAM_BACKENDS=v4l2,libusb
+        enabled_backends = parse_enabled_backends(get_environment_variable("TCAM_BACKENDS", ""));
+    }
+
+    if (enabled_backends->empty())
+    {
+        return true;
+    }
+    return std::find(enabled_backends->begin(), enabled_backends->end(), type)
+           != enabled_backends->end();
+}
+
+
 std::vector<tcam_image_size> tcam::get_standard_resolutions(const tcam_image_size& min,
                                                             const tcam_image_size& max)
 {
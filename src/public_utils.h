@@ -40,6 +40,19 @@ std::string tcam_device_type_to_string(TCAM_DEVICE_TYPE type);
 
 TCAM_DEVICE_TYPE tcam_device_from_string(const std::string& str);
 
+
+/**
+ * Restricts the backends libtcam initializes and enumerates.
+ * An empty list enables all compiled-in backends.
+ * Overrides the environment variable TCAM_BACKENDS.
+ * Has to be called before the first device access, backends that are already
+ * in use are not released.
+ */
+void set_enabled_backends(const std::vector<TCAM_DEVICE_TYPE>& types);
+
+
+bool is_backend_enabled(TCAM_DEVICE_TYPE type);
+
 std::vector<tcam_image_size> get_standard_resolutions(const tcam_image_size& min,
                                                       const tcam_image_size& max);
 
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "replay_api.h"
+
+#include "../logging.h"
+#include "../utils.h"
+#include "replay_device.h"
+
+#include <cstring>
+
+using namespace tcam;
+
+static std::vector<tcam::DeviceInfo> get_replay_device_list()
+{
+    std::vector<tcam::DeviceInfo> rval;
+
+    auto env_files = tcam::get_environment_variable("TCAM_REPLAY_FILES", "");
+    if (env_files.empty())
+    {
+        return rval;
+    }
+
+    int index = 0;
+    for (const auto& path : split_string(env_files, ":"))
+    {
+        std::string serial = "7160" + std::to_string(index++);
+        std::string name = path.substr(path.find_last_of('/') + 1);
+
+        tcam_device_info tmp = {};
+        tmp.type = TCAM_DEVICE_TYPE::TCAM_DEVICE_TYPE_REPLAY;
+        strncpy(tmp.name, name.c_str(), sizeof(tmp.name) - 1);
+        strncpy(tmp.identifier, path.c_str(), sizeof(tmp.identifier) - 1);
+        strncpy(tmp.serial_number, serial.c_str(), sizeof(tmp.serial_number) - 1);
+
+        rval.push_back(DeviceInfo(tmp));
+    }
+    return rval;
+}
+
+
+std::shared_ptr<tcam::DeviceInterface> tcam::replay::ReplayBackend::open_device(
+    const tcam::DeviceInfo& device)
+{
+    auto file = replay_file::open(device.get_info().identifier);
+    if (!file)
+    {
+        return nullptr;
+    }
+    return std::make_shared<ReplayDevice>(device, std::move(file.value()));
+}
+
+
+std::vector<tcam::DeviceInfo> tcam::replay::ReplayBackend::get_device_list()
+{
+    return get_replay_device_list();
+}
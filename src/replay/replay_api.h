@@ -14,33 +14,30 @@
  * limitations under the License.
  */
 
-#pragma once
 
-#include "../Allocator.h"
+#pragma once
 
-#include <memory>
+#include "../devicelibrary.h"
 
-namespace tcam
-{
-namespace aravis
+namespace tcam::replay
 {
-class AravisAllocator : public AllocatorInterface, public std::enable_shared_from_this<AravisAllocator>
+
+// Devices for the recordings listed in TCAM_REPLAY_FILES
+class ReplayBackend : public BackendInterface
 {
 public:
-
-    AravisAllocator(){};
-
-    std::vector<TCAM_MEMORY_TYPE> get_supported_memory_types() const final
+    TCAM_DEVICE_TYPE get_type() const final
     {
-        return {TCAM_MEMORY_TYPE_USERPTR};
+        return TCAM_DEVICE_TYPE_REPLAY;
     };
+    std::shared_ptr<tcam::DeviceInterface> open_device(const tcam::DeviceInfo&) final;
+    std::vector<tcam::DeviceInfo> get_device_list() final;
 
-    void* allocate(TCAM_MEMORY_TYPE, size_t, int fd = 0) final;
-    void free(TCAM_MEMORY_TYPE, void* ptr, size_t, int fd = 0) final;
-
-    std::vector<std::shared_ptr<Memory>> allocate(
-        size_t buffer_count, TCAM_MEMORY_TYPE, size_t, int fd = 0) final;
+    static ReplayBackend* get_instance()
+    {
+        static ReplayBackend b;
+        return &b;
+    };
 };
-}
 
-} // namespace tcam::aravis
+} // namespace tcam::replay
@@ -0,0 +1,331 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "replay_device.h"
+
+#include "../RawCodec.h"
+#include "../logging.h"
+#include "../utils.h"
+
+#include <cstring>
+#include <ctime>
+
+namespace
+{
+
+uint64_t monotonic_time_ns()
+{
+    timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+}
+
+} // namespace
+
+
+tcam::replay::ReplayDevice::ReplayDevice(const DeviceInfo& info, std::unique_ptr<replay_file> file)
+    : file_(std::move(file))
+{
+    device = info;
+    format_ = file_->get_format();
+
+    const auto size = format_.get_size();
+
+    tcam_resolution_description res_type = {
+        TCAM_RESOLUTION_TYPE_FIXED, size, size, 0, 0, format_.get_scaling(),
+    };
+    framerate_mapping m = { res_type, { format_.get_framerate() } };
+
+    tcam_video_format_description desc = { format_.get_fourcc(), "" };
+    available_videoformats_.push_back(tcam::VideoFormatDescription(nullptr, desc, { m }));
+
+    SPDLOG_INFO("Opened recording '{}' with {} images of {}.",
+                info.get_info().identifier,
+                file_->get_frame_count(),
+                format_.to_string());
+}
+
+
+tcam::replay::ReplayDevice::~ReplayDevice()
+{
+    stop_stream();
+}
+
+
+tcam::DeviceInfo tcam::replay::ReplayDevice::get_device_description() const
+{
+    return device;
+}
+
+
+bool tcam::replay::ReplayDevice::set_video_format(const VideoFormat& fmt)
+{
+    // the recording can only be played in the format it was recorded with
+    if (fmt.get_fourcc() != format_.get_fourcc() || !(fmt.get_size() == format_.get_size()))
+    {
+        SPDLOG_ERROR("The recording only contains {}.", format_.to_string());
+        return false;
+    }
+    return true;
+}
+
+
+tcam::VideoFormat tcam::replay::ReplayDevice::get_active_video_format() const
+{
+    return format_;
+}
+
+
+std::vector<tcam::VideoFormatDescription> tcam::replay::ReplayDevice::get_available_video_formats()
+{
+    return available_videoformats_;
+}
+
+
+bool tcam::replay::ReplayDevice::initialize_buffers(std::shared_ptr<BufferPool> pool)
+{
+    auto b = pool->get_buffer();
+
+    std::scoped_lock lck { buffer_queue_mutex_ };
+
+    // every buffer is queued at most once, so this never overflows
+    buffer_queue_.reset(b.size());
+
+    for (auto& weak_buffer : b)
+    {
+        if (auto buf = weak_buffer.lock())
+        {
+            buffer_queue_.push(std::move(buf));
+        }
+    }
+    return true;
+}
+
+
+bool tcam::replay::ReplayDevice::release_buffers()
+{
+    std::scoped_lock lck { buffer_queue_mutex_ };
+    buffer_queue_.clear();
+    return true;
+}
+
+
+void tcam::replay::ReplayDevice::requeue_buffer(const std::shared_ptr<ImageBuffer>& buf)
+{
+    auto copy = buf;
+
+    {
+        std::scoped_lock lck { buffer_queue_mutex_ };
+        buffer_queue_.push(std::move(copy));
+    }
+
+    if (free_running_)
+    {
+        {
+            // the stream thread checks the queue with this held, so no wake up is lost
+            std::scoped_lock lck { stream_thread_mutex_ };
+        }
+        stream_thread_cv_.notify_all();
+    }
+}
+
+
+bool tcam::replay::ReplayDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
+{
+    stop_stream();
+
+    stream_sink_ = sink;
+
+    free_running_ = tcam::get_environment_variable_int("TCAM_REPLAY_FREE_RUNNING").value_or(0) != 0;
+    frames_delivered_ = 0;
+    frames_dropped_ = 0;
+    camera_time_offset_ns_ = 0;
+
+    stream_thread_ended_ = false;
+    stream_thread_ = std::thread([this] { stream_thread_main(); });
+
+    return true;
+}
+
+
+void tcam::replay::ReplayDevice::stop_stream()
+{
+    if (!stream_thread_.joinable())
+    {
+        return;
+    }
+
+    {
+        std::scoped_lock lck { stream_thread_mutex_ };
+        stream_thread_ended_ = true;
+        stream_thread_cv_.notify_all();
+    }
+
+    stream_thread_.join();
+}
+
+
+std::chrono::nanoseconds tcam::replay::ReplayDevice::get_frame_interval(size_t index) const
+{
+    const auto fallback = std::chrono::nanoseconds(
+        static_cast<int64_t>(1'000'000'000 / std::max(format_.get_framerate(), 1.)));
+
+    if (index + 1 >= file_->get_frame_count())
+    {
+        return fallback;
+    }
+
+    // the recorded timing, unless the capture times are unusable
+    const uint64_t t0 = file_->get_statistics(index).capture_time_ns;
+    const uint64_t t1 = file_->get_statistics(index + 1).capture_time_ns;
+    if (t0 == 0 || t1 <= t0 || t1 - t0 > 1'000'000'000)
+    {
+        return fallback;
+    }
+    return std::chrono::nanoseconds(t1 - t0);
+}
+
+
+void tcam::replay::ReplayDevice::deliver_frame(size_t index, std::shared_ptr<ImageBuffer> buf)
+{
+    const auto f = file_->get_frame(index);
+
+    // keep what the camera reported, the counters and times belong to this stream
+    tcam_stream_statistics stats = f.statistics;
+
+    size_t length = 0;
+    if (file_->get_compression() == file_compression::none)
+    {
+        length = std::min(f.length, buf->get_image_buffer_size());
+        memcpy(buf->get_image_buffer_ptr(), f.data, length);
+    }
+    else
+    {
+        const auto dst = buf->get_img_descriptor();
+        if (raw_codec::decompress(f.data, f.length, dst))
+        {
+            length = std::min(static_cast<size_t>(format_.get_img_type().buffer_length),
+                              buf->get_image_buffer_size());
+        }
+        else
+        {
+            SPDLOG_WARN("Image {} of the recording can not be decompressed.", index);
+            stats.is_damaged = true;
+        }
+    }
+
+    stats.frame_count = frames_delivered_;
+    stats.frames_dropped = frames_dropped_;
+    stats.capture_time_ns = monotonic_time_ns();
+    if (stats.camera_time_ns != 0)
+    {
+        stats.camera_time_ns += camera_time_offset_ns_;
+    }
+    stats.trigger_issue_time_ns = 0;
+    stats.trigger_arrival_time_ns = 0;
+    stats.parameter_set_id = 0;
+
+    buf->set_statistics(stats);
+    buf->set_valid_data_length(length);
+    buf->record_stage(timing::stage::backend_dequeue);
+
+    stream_sink_->push_image(buf);
+    ++frames_delivered_;
+}
+
+
+void tcam::replay::ReplayDevice::stream_thread_main()
+{
+    const size_t frame_count = file_->get_frame_count();
+
+    const uint64_t first_camera_time = file_->get_statistics(0).camera_time_ns;
+    const uint64_t last_camera_time = file_->get_statistics(frame_count - 1).camera_time_ns;
+
+    size_t index = 0;
+    auto next_time = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        std::shared_ptr<ImageBuffer> buf;
+
+        {
+            std::unique_lock lck { stream_thread_mutex_ };
+
+            if (free_running_)
+            {
+                stream_thread_cv_.wait(lck,
+                                       [this, &buf]
+                                       {
+                                           if (stream_thread_ended_)
+                                           {
+                                               return true;
+                                           }
+                                           auto tmp = buffer_queue_.pop();
+                                           if (tmp)
+                                           {
+                                               buf = std::move(*tmp);
+                                           }
+                                           return buf != nullptr;
+                                       });
+            }
+            else
+            {
+                stream_thread_cv_.wait_until(lck, next_time, [this] { return stream_thread_ended_; });
+            }
+
+            if (stream_thread_ended_)
+            {
+                break;
+            }
+        }
+
+        if (!free_running_)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            next_time += get_frame_interval(index);
+            if (next_time < now)
+            {
+                // fell behind, e.g. while the system was suspended, do not try to catch up
+                next_time = now;
+            }
+
+            if (auto tmp = buffer_queue_.pop())
+            {
+                buf = std::move(*tmp);
+            }
+        }
+
+        if (buf)
+        {
+            deliver_frame(index, std::move(buf));
+        }
+        else
+        {
+            ++frames_dropped_;
+        }
+
+        if (++index == frame_count)
+        {
+            index = 0;
+            if (last_camera_time > first_camera_time)
+            {
+                camera_time_offset_ns_ +=
+                    last_camera_time - first_camera_time + get_frame_interval(frame_count - 1).count();
+            }
+        }
+    }
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "../DeviceInterface.h"
+#include "../VideoFormatDescription.h"
+#include "../spsc_queue.h"
+#include "replay_file.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace tcam::replay
+{
+
+//
+// Streams the images of a recording.
+//
+// Every image is copied from the memory mapped file into the next free buffer,
+// the recording is repeated when its end is reached.
+// By default images are sent with the timing of the recording,
+// with TCAM_REPLAY_FREE_RUNNING as soon as a buffer is available.
+//
+class ReplayDevice : public DeviceInterface
+{
+public:
+    ReplayDevice(const DeviceInfo& info, std::unique_ptr<replay_file> file);
+
+    ReplayDevice() = delete;
+
+    ~ReplayDevice();
+
+    DeviceInfo get_device_description() const final;
+
+    std::vector<std::shared_ptr<tcam::property::IPropertyBase>> get_properties() final
+    {
+        return {};
+    }
+
+    bool set_video_format(const VideoFormat&) final;
+
+    VideoFormat get_active_video_format() const final;
+
+    std::vector<VideoFormatDescription> get_available_video_formats() final;
+
+    std::shared_ptr<tcam::AllocatorInterface> get_allocator() final
+    {
+        return get_default_allocator();
+    };
+
+    bool initialize_buffers(std::shared_ptr<BufferPool>) final;
+
+    bool release_buffers() final;
+
+    void requeue_buffer(const std::shared_ptr<ImageBuffer>&) final;
+
+    bool start_stream(const std::shared_ptr<IImageBufferSink>&) final;
+
+    void stop_stream() final;
+
+private:
+    void stream_thread_main();
+
+    // time until frame index + 1 should be sent
+    std::chrono::nanoseconds get_frame_interval(size_t index) const;
+
+    void deliver_frame(size_t index, std::shared_ptr<ImageBuffer> buf);
+
+    std::unique_ptr<replay_file> file_;
+
+    VideoFormat format_;
+    std::vector<VideoFormatDescription> available_videoformats_;
+
+    std::thread stream_thread_;
+    std::condition_variable stream_thread_cv_;
+    std::mutex stream_thread_mutex_;
+    bool stream_thread_ended_ = false;
+    bool free_running_ = false;
+
+    uint64_t frames_delivered_ = 0;
+    uint64_t frames_dropped_ = 0;
+
+    // camera_time_ns keeps increasing when the recording is repeated
+    uint64_t camera_time_offset_ns_ = 0;
+
+    // free buffers, popped by the stream thread
+    spsc_queue<std::shared_ptr<ImageBuffer>> buffer_queue_;
+    // requeue_buffer may be called from several threads, this keeps it a single producer
+    std::mutex buffer_queue_mutex_;
+
+    std::shared_ptr<IImageBufferSink> stream_sink_;
+};
+
+} // namespace tcam::replay
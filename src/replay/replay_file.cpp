@@ -0,0 +1,362 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "replay_file.h"
+
+#include "../ImageBuffer.h"
+#include "../RawCodec.h"
+#include "../logging.h"
+#include "../utils.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using namespace tcam::replay;
+
+namespace
+{
+
+constexpr size_t align_up(size_t value, size_t alignment) noexcept
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+
+outcome::result<std::unique_ptr<replay_file>> replay_file::open(const std::string& path)
+{
+    std::unique_ptr<replay_file> rval(new replay_file());
+
+    rval->fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (rval->fd_ < 0)
+    {
+        SPDLOG_ERROR("Unable to open recording '{}': {}", path, strerror(errno));
+        return tcam::status::DeviceCouldNotBeOpened;
+    }
+
+    struct stat st = {};
+    if (fstat(rval->fd_, &st) != 0 || static_cast<size_t>(st.st_size) < file_page_size)
+    {
+        SPDLOG_ERROR("Recording '{}' is too small.", path);
+        return tcam::status::FormatInvalid;
+    }
+
+    auto& header = rval->header_;
+    if (pread(rval->fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))
+        || memcmp(header.magic, file_magic, sizeof(file_magic)) != 0)
+    {
+        SPDLOG_ERROR("'{}' is not a tcam recording.", path);
+        return tcam::status::FormatInvalid;
+    }
+    if (header.version == 0 || header.version > file_version
+        || header.statistics_size != sizeof(tcam_stream_statistics))
+    {
+        SPDLOG_ERROR("Recording '{}' has version {} with statistics of {} bytes, "
+                     "expected version {} with {} bytes.",
+                     path,
+                     header.version,
+                     header.statistics_size,
+                     file_version,
+                     sizeof(tcam_stream_statistics));
+        return tcam::status::FormatInvalid;
+    }
+    if (header.version < 2)
+    {
+        header.compression = file_compression::none;
+    }
+    if (header.frame_stride < frame_data_offset + header.frame_data_size
+        || header.frame_stride % file_page_size != 0
+        || (header.compression != file_compression::none
+            && header.compression != file_compression::lossless))
+    {
+        SPDLOG_ERROR("Recording '{}' has an invalid frame layout.", path);
+        return tcam::status::FormatInvalid;
+    }
+
+    if (header.compression == file_compression::none)
+    {
+        // recordings that were not finished have no frame_count, use what is complete
+        const size_t complete_frames = (st.st_size - file_page_size) / header.frame_stride;
+        rval->frame_count_ = header.frame_count != 0
+                                 ? std::min<size_t>(header.frame_count, complete_frames)
+                                 : complete_frames;
+        rval->map_length_ = file_page_size + rval->frame_count_ * header.frame_stride;
+    }
+    else
+    {
+        rval->map_length_ = rval->find_compressed_frames(st.st_size);
+    }
+
+    if (rval->frame_count_ == 0)
+    {
+        SPDLOG_ERROR("Recording '{}' contains no images.", path);
+        return tcam::status::FormatInvalid;
+    }
+
+    void* ptr = mmap(nullptr, rval->map_length_, PROT_READ, MAP_PRIVATE, rval->fd_, 0);
+    if (ptr == MAP_FAILED)
+    {
+        SPDLOG_ERROR("Unable to map recording '{}': {}", path, strerror(errno));
+        return tcam::status::DeviceCouldNotBeOpened;
+    }
+    rval->map_ = static_cast<uint8_t*>(ptr);
+
+    madvise(rval->map_, rval->map_length_, MADV_SEQUENTIAL);
+
+    // enough frames for ~32 MiB in flight
+    const size_t average_frame_size = (rval->map_length_ - file_page_size) / rval->frame_count_;
+    rval->readahead_frames_ = std::max<size_t>(2, (32 << 20) / average_frame_size);
+    rval->advise_frames(0, rval->readahead_frames_, MADV_WILLNEED);
+
+    return rval;
+}
+
+
+replay_file::~replay_file()
+{
+    if (map_)
+    {
+        munmap(map_, map_length_);
+    }
+    if (fd_ >= 0)
+    {
+        close(fd_);
+    }
+}
+
+
+size_t replay_file::find_compressed_frames(size_t file_size) noexcept
+{
+    size_t offset = file_page_size;
+
+    // recordings that were not finished have no frame_count, use what is complete
+    while (header_.frame_count == 0 || frame_offsets_.size() < header_.frame_count)
+    {
+        frame_header fh;
+        if (pread(fd_, &fh, sizeof(fh), offset) != static_cast<ssize_t>(sizeof(fh))
+            || fh.valid_data_length == 0 || fh.valid_data_length > header_.frame_data_size)
+        {
+            break;
+        }
+        const size_t next =
+            offset + align_up(frame_data_offset + fh.valid_data_length, file_page_size);
+        if (next > file_size)
+        {
+            break;
+        }
+        frame_offsets_.push_back(offset);
+        offset = next;
+    }
+
+    frame_count_ = frame_offsets_.size();
+    // the end of the last frame
+    frame_offsets_.push_back(offset);
+    return offset;
+}
+
+
+void replay_file::advise_frames(size_t first, size_t count, int advice) noexcept
+{
+    if (first >= frame_count_)
+    {
+        return;
+    }
+    count = std::min(count, frame_count_ - first);
+
+    const size_t offset = get_frame_offset(first);
+    madvise(map_ + offset, get_frame_offset(first + count) - offset, advice);
+}
+
+
+frame replay_file::get_frame(size_t index) noexcept
+{
+    // one frame enters the readahead window, one leaves the window behind index
+    advise_frames(index + readahead_frames_, 1, MADV_WILLNEED);
+    if (index >= readahead_frames_)
+    {
+        advise_frames(index - readahead_frames_, 1, MADV_DONTNEED);
+    }
+    else if (index == 0)
+    {
+        // looped, the start was released by the previous pass
+        advise_frames(0, readahead_frames_, MADV_WILLNEED);
+    }
+
+    const uint8_t* start = map_ + get_frame_offset(index);
+
+    frame_header fh;
+    memcpy(&fh, start, sizeof(fh));
+
+    frame rval;
+    rval.data = start + frame_data_offset;
+    rval.length = std::min<size_t>(fh.valid_data_length, header_.frame_data_size);
+    rval.statistics = fh.statistics;
+    return rval;
+}
+
+
+tcam::tcam_stream_statistics replay_file::get_statistics(size_t index) const noexcept
+{
+    frame_header fh;
+    memcpy(&fh, map_ + get_frame_offset(index), sizeof(fh));
+    return fh.statistics;
+}
+
+
+outcome::result<std::unique_ptr<replay_recorder>> replay_recorder::create(
+    const std::string& path,
+    const VideoFormat& format,
+    size_t max_frame_size,
+    file_compression compression)
+{
+    std::unique_ptr<replay_recorder> rval(new replay_recorder());
+
+    if (compression != file_compression::none)
+    {
+        const size_t max_compressed_size =
+            tcam::raw_codec::calc_max_compressed_size(format.get_img_type());
+        if (max_compressed_size == 0)
+        {
+            SPDLOG_WARN("{} can not be compressed, recording uncompressed images.",
+                        format.to_string());
+            compression = file_compression::none;
+        }
+        else
+        {
+            max_frame_size = max_compressed_size;
+            rval->compressed_.resize(max_compressed_size);
+        }
+    }
+
+    rval->fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (rval->fd_ < 0)
+    {
+        SPDLOG_ERROR("Unable to create recording '{}': {}", path, strerror(errno));
+        return tcam::status::UndefinedError;
+    }
+
+    auto& header = rval->header_;
+    memcpy(header.magic, file_magic, sizeof(file_magic));
+    header.version = file_version;
+    header.statistics_size = sizeof(tcam_stream_statistics);
+    header.format = format.get_struct();
+    header.frame_data_size = max_frame_size;
+    header.frame_stride = align_up(frame_data_offset + max_frame_size, file_page_size);
+    header.frame_count = 0;
+    header.compression = compression;
+
+    if (pwrite(rval->fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)))
+    {
+        SPDLOG_ERROR("Unable to write recording '{}': {}", path, strerror(errno));
+        return tcam::status::UndefinedError;
+    }
+
+    SPDLOG_INFO("Recording {} to '{}'.", format.to_string(), path);
+
+    return rval;
+}
+
+
+replay_recorder::~replay_recorder()
+{
+    finish();
+}
+
+
+bool replay_recorder::write_frame(const ImageBuffer& buffer) noexcept
+{
+    if (failed_)
+    {
+        return false;
+    }
+
+    frame_header fh = {};
+    fh.statistics = buffer.get_statistics();
+
+    void* data = buffer.get_image_buffer_ptr();
+    if (header_.compression == file_compression::none)
+    {
+        fh.valid_data_length =
+            std::min<uint64_t>(buffer.get_valid_data_length(), header_.frame_data_size);
+    }
+    else
+    {
+        fh.valid_data_length = tcam::raw_codec::compress(
+            buffer.get_img_descriptor(), compressed_.data(), compressed_.size());
+        if (fh.valid_data_length == 0)
+        {
+            SPDLOG_ERROR("Unable to compress the image. Recording stops.");
+            failed_ = true;
+            return false;
+        }
+        data = compressed_.data();
+    }
+
+    static const uint8_t padding[frame_data_offset] = {};
+
+    iovec iov[3] = {
+        { &fh, sizeof(fh) },
+        { const_cast<uint8_t*>(padding), frame_data_offset - sizeof(fh) },
+        { data, fh.valid_data_length },
+    };
+
+    const ssize_t expected = frame_data_offset + fh.valid_data_length;
+
+    if (pwritev(fd_, iov, 3, next_offset_) != expected)
+    {
+        SPDLOG_ERROR("Writing the recording failed: {}. Recording stops.", strerror(errno));
+        failed_ = true;
+        return false;
+    }
+
+    // compressed frames only occupy their own pages
+    next_offset_ += header_.compression == file_compression::none
+                        ? header_.frame_stride
+                        : align_up(expected, file_page_size);
+    header_.frame_count++;
+    return true;
+}
+
+
+void replay_recorder::finish() noexcept
+{
+    if (fd_ < 0)
+    {
+        return;
+    }
+
+    // every frame occupies its full pages, also the last one
+    if (ftruncate(fd_, next_offset_) != 0
+        || pwrite(fd_, &header_, sizeof(header_), 0) != static_cast<ssize_t>(sizeof(header_)))
+    {
+        SPDLOG_ERROR("Unable to finish the recording: {}", strerror(errno));
+    }
+    else
+    {
+        SPDLOG_INFO("Recorded {} images.", header_.frame_count);
+    }
+
+    close(fd_);
+    fd_ = -1;
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "../VideoFormat.h"
+#include "../base_types.h"
+#include "../error.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tcam
+{
+class ImageBuffer;
+}
+
+namespace tcam::replay
+{
+
+//
+// Layout of a recording:
+//
+//   file_header, padded to file_page_size
+//   frame 0 .. frame_count - 1, each frame_stride bytes and page aligned:
+//     frame_header
+//     image data at frame_data_offset
+//
+// Version 2 adds compression. Compressed frames are stored with tcam::raw_codec and only
+// occupy their valid_data_length rounded up to file_page_size, so frames are found by
+// walking the frame headers instead of by frame_stride.
+//
+// Statistics are stored with their in memory layout, statistics_size guards against files of
+// builds with another tcam_stream_statistics.
+//
+
+constexpr char file_magic[8] = "TCAMRAW";
+constexpr uint32_t file_version = 2;
+constexpr size_t file_page_size = 4096;
+constexpr size_t frame_data_offset = 256;
+
+enum class file_compression : uint32_t
+{
+    none = 0,
+    lossless = 1, // tcam::raw_codec
+};
+
+struct file_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t statistics_size;
+
+    tcam_video_format format;
+
+    uint64_t frame_data_size; // bytes reserved for the image of a frame
+    uint64_t frame_stride;
+    uint64_t frame_count; // written when the recording is finished
+
+    // version 2, 0 in files of version 1
+    file_compression compression;
+    uint32_t reserved;
+};
+
+struct frame_header
+{
+    uint64_t valid_data_length;
+    tcam_stream_statistics statistics;
+};
+
+static_assert(sizeof(file_header) <= file_page_size);
+static_assert(sizeof(frame_header) <= frame_data_offset);
+
+struct frame
+{
+    const void* data = nullptr;
+    size_t length = 0;
+    tcam_stream_statistics statistics = {};
+};
+
+
+// Memory maps a recording for sequential reading.
+class replay_file
+{
+public:
+    static outcome::result<std::unique_ptr<replay_file>> open(const std::string& path);
+
+    ~replay_file();
+
+    replay_file(const replay_file&) = delete;
+    replay_file& operator=(const replay_file&) = delete;
+
+    VideoFormat get_format() const noexcept
+    {
+        return VideoFormat(header_.format);
+    }
+
+    size_t get_frame_count() const noexcept
+    {
+        return frame_count_;
+    }
+
+    // frame data has to be decompressed with tcam::raw_codec when this is not none
+    file_compression get_compression() const noexcept
+    {
+        return header_.compression;
+    }
+
+    // index has to be < get_frame_count().
+    // The data points into the mapping and stays valid as long as this object exists.
+    // Advises the kernel to read ahead of index and releases the pages of older frames.
+    frame get_frame(size_t index) noexcept;
+
+    // statistics of index without touching the readahead
+    tcam_stream_statistics get_statistics(size_t index) const noexcept;
+
+private:
+    replay_file() = default;
+
+    void advise_frames(size_t first, size_t count, int advice) noexcept;
+
+    // scans the frame headers of a compressed recording, returns the end of the last
+    // complete frame
+    size_t find_compressed_frames(size_t file_size) noexcept;
+
+    size_t get_frame_offset(size_t index) const noexcept
+    {
+        if (!frame_offsets_.empty())
+        {
+            return frame_offsets_[index];
+        }
+        return file_page_size + index * header_.frame_stride;
+    }
+
+    int fd_ = -1;
+    uint8_t* map_ = nullptr;
+    size_t map_length_ = 0;
+
+    file_header header_ = {};
+    size_t frame_count_ = 0;
+    // offsets of the frames of compressed recordings, frame_count_ + 1 entries
+    std::vector<size_t> frame_offsets_;
+
+    size_t readahead_frames_ = 0;
+};
+
+
+// Writes the images of a stream in the format replay_file reads.
+// write_frame is meant for the stream thread, it issues one pwritev per image.
+// With file_compression::lossless every image is compressed before, which costs CPU time
+// in the stream thread but usually halves the written bytes.
+class replay_recorder
+{
+public:
+    // max_frame_size is the largest image that will be written, usually the buffer size
+    // Formats raw_codec does not support are recorded uncompressed.
+    static outcome::result<std::unique_ptr<replay_recorder>> create(
+        const std::string& path,
+        const VideoFormat& format,
+        size_t max_frame_size,
+        file_compression compression = file_compression::none);
+
+    // finishes the recording
+    ~replay_recorder();
+
+    replay_recorder(const replay_recorder&) = delete;
+    replay_recorder& operator=(const replay_recorder&) = delete;
+
+    // false when writing failed, the recording stops
+    bool write_frame(const ImageBuffer& buffer) noexcept;
+
+    size_t get_frame_count() const noexcept
+    {
+        return header_.frame_count;
+    }
+
+private:
+    replay_recorder() = default;
+
+    void finish() noexcept;
+
+    int fd_ = -1;
+    file_header header_ = {};
+    bool failed_ = false;
+
+    // end of the last frame, frames of compressed recordings have no fixed stride
+    uint64_t next_offset_ = file_page_size;
+    std::vector<uint8_t> compressed_;
+};
+
+} // namespace tcam::replay
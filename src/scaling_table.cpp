@@ -0,0 +1,108 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "scaling_table.h"
+
+#include <algorithm>
+#include <tuple>
+
+using namespace tcam;
+
+
+bool tcam::scaling_less(const image_scaling& lhs, const image_scaling& rhs) noexcept
+{
+    return std::tie(lhs.binning_h, lhs.binning_v, lhs.skipping_h, lhs.skipping_v)
+           < std::tie(rhs.binning_h, rhs.binning_v, rhs.skipping_h, rhs.skipping_v);
+}
+
+
+scaling_table::scaling_table(const tcam_image_size& sensor_size,
+                             const std::vector<image_scaling>& scales)
+{
+    entries_.reserve(scales.size());
+    for (const auto& s : scales) { entries_.push_back({ s, s.allowed_max(sensor_size) }); }
+
+    std::sort(entries_.begin(),
+              entries_.end(),
+              [](const entry& lhs, const entry& rhs) { return scaling_less(lhs.scaling, rhs.scaling); });
+    entries_.erase(std::unique(entries_.begin(),
+                               entries_.end(),
+                               [](const entry& lhs, const entry& rhs)
+                               { return lhs.scaling == rhs.scaling; }),
+                   entries_.end());
+
+    by_width_.resize(entries_.size());
+    for (size_t i = 0; i < by_width_.size(); ++i) { by_width_[i] = i; }
+
+    std::stable_sort(by_width_.begin(),
+                     by_width_.end(),
+                     [this](size_t lhs, size_t rhs)
+                     { return entries_[lhs].max_size.width > entries_[rhs].max_size.width; });
+}
+
+
+const scaling_table::entry* scaling_table::find(const image_scaling& scaling) const noexcept
+{
+    auto iter = std::lower_bound(entries_.begin(),
+                                 entries_.end(),
+                                 scaling,
+                                 [](const entry& e, const image_scaling& s)
+                                 { return scaling_less(e.scaling, s); });
+
+    if (iter == entries_.end() || !(iter->scaling == scaling))
+    {
+        return nullptr;
+    }
+    return &*iter;
+}
+
+
+bool scaling_table::legal_resolution(const image_scaling& scaling,
+                                     const tcam_image_size& resolution) const
+{
+    auto e = find(scaling);
+    if (!e)
+    {
+        return false;
+    }
+    return resolution.width <= e->max_size.width && resolution.height <= e->max_size.height;
+}
+
+
+std::vector<image_scaling> scaling_table::get_scalings_for(const tcam_image_size& resolution) const
+{
+    // everything in front of end is wide enough, only the height remains to be checked
+    auto end = std::partition_point(by_width_.begin(),
+                                    by_width_.end(),
+                                    [this, &resolution](size_t i)
+                                    { return entries_[i].max_size.width >= resolution.width; });
+
+    std::vector<size_t> matches;
+    for (auto iter = by_width_.begin(); iter != end; ++iter)
+    {
+        if (entries_[*iter].max_size.height >= resolution.height)
+        {
+            matches.push_back(*iter);
+        }
+    }
+    std::sort(matches.begin(), matches.end());
+
+    std::vector<image_scaling> rval;
+    rval.reserve(matches.size());
+    for (auto i : matches) { rval.push_back(entries_[i].scaling); }
+    return rval;
+}
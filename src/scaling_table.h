@@ -0,0 +1,74 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "base_types.h"
+
+#include <vector>
+
+namespace tcam
+{
+
+// strict weak ordering over binning_h, binning_v, skipping_h, skipping_v
+bool scaling_less(const image_scaling& lhs, const image_scaling& rhs) noexcept;
+
+//
+// All scalings a device offers together with the largest resolution they allow.
+//
+// Built once when the formats are indexed, caps generation and format checks then look
+// scalings up with a binary search instead of recombining binning and skipping lists.
+//
+class scaling_table
+{
+public:
+    struct entry
+    {
+        image_scaling scaling;
+        tcam_image_size max_size;
+    };
+
+    scaling_table() = default;
+    scaling_table(const tcam_image_size& sensor_size, const std::vector<image_scaling>& scales);
+
+    bool empty() const noexcept
+    {
+        return entries_.empty();
+    }
+
+    // sorted with scaling_less, duplicates are removed
+    const std::vector<entry>& entries() const noexcept
+    {
+        return entries_;
+    }
+
+    const entry* find(const image_scaling& scaling) const noexcept;
+
+    // equivalent to image_scaling::legal_resolution with the sensor size of the table
+    bool legal_resolution(const image_scaling& scaling, const tcam_image_size& resolution) const;
+
+    // all entries that allow resolution, in the order of entries()
+    std::vector<image_scaling> get_scalings_for(const tcam_image_size& resolution) const;
+
+private:
+    std::vector<entry> entries_;
+
+    // indices into entries_, sorted by descending max_size.width
+    std::vector<size_t> by_width_;
+};
+
+} // namespace tcam
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace tcam
+{
+
+//
+// Holds a value that is published by writers and read without locking.
+//
+// Writers must be serialized by the caller, e.g. by a mutex. Readers never block, they retry
+// when a write happened while they were copying. The value is stored as atomic words, so the
+// copy that a reader throws away is not a data race.
+//
+template<typename T> class seqlock
+{
+    static_assert(std::is_trivially_copyable_v<T>, "seqlock needs a trivially copyable type");
+
+public:
+    seqlock()
+    {
+        store(T {});
+    }
+
+    seqlock(const seqlock&) = delete;
+    seqlock& operator=(const seqlock&) = delete;
+
+    // Writers only, one at a time.
+    void store(const T& value) noexcept
+    {
+        uint64_t words[word_count] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        const uint64_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < word_count; ++i)
+        {
+            data_[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    // Any thread.
+    T load() const noexcept
+    {
+        uint64_t words[word_count];
+        while (true)
+        {
+            const uint64_t seq_before = seq_.load(std::memory_order_acquire);
+            if (seq_before & 1)
+            {
+                // a write is in progress
+                continue;
+            }
+
+            for (size_t i = 0; i < word_count; ++i)
+            {
+                words[i] = data_[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == seq_before)
+            {
+                break;
+            }
+        }
+
+        T rval;
+        std::memcpy(&rval, words, sizeof(T));
+        return rval;
+    }
+
+private:
+    static constexpr size_t word_count = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> seq_ = 0;
+    std::atomic<uint64_t> data_[word_count];
+};
+
+} // namespace tcam
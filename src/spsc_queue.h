@@ -0,0 +1,191 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <thread>
+
+namespace tcam
+{
+
+enum class overflow_policy
+{
+    drop_newest, // push hands the new element back
+    drop_oldest, // push removes the oldest element and hands that back
+};
+
+//
+// Bounded lock free queue for one producer and one consumer thread.
+//
+// Every slot carries a sequence number that tells whether it is free or filled for the
+// current lap (Vyukov's bounded queue). Consumers claim slots with a CAS, which is what
+// allows the producer to act as a second consumer for drop_oldest without racing the
+// element that the consumer is currently moving out.
+//
+template<typename T> class spsc_queue
+{
+public:
+    explicit spsc_queue(overflow_policy policy = overflow_policy::drop_newest) : policy_(policy)
+    {
+    }
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    // Not thread safe. Only call this while no thread is pushing or popping.
+    // Drops all queued elements.
+    void reset(size_t capacity)
+    {
+        size_ = capacity;
+        slots_ = capacity > 0 ? std::make_unique<slot[]>(capacity) : nullptr;
+        for (size_t i = 0; i < size_; ++i) { slots_[i].seq.store(i, std::memory_order_relaxed); }
+        enqueue_pos_.store(0, std::memory_order_relaxed);
+        dequeue_pos_.store(0, std::memory_order_relaxed);
+        dropped_.store(0, std::memory_order_relaxed);
+    }
+
+    // Not thread safe.
+    void clear()
+    {
+        reset(size_);
+    }
+
+    // Producer only.
+    // Returns the element that was dropped because the queue was full, see overflow_policy.
+    std::optional<T> push(T&& value)
+    {
+        if (size_ == 0)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return std::optional<T>(std::move(value));
+        }
+
+        const size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        slot& s = slots_[pos % size_];
+
+        std::optional<T> rval;
+
+        if (s.seq.load(std::memory_order_acquire) != pos)
+        {
+            if (policy_ == overflow_policy::drop_newest)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return std::optional<T>(std::move(value));
+            }
+
+            // nullopt when the consumer emptied the queue in the meantime
+            rval = pop();
+            if (rval)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // the consumer may still be moving out of s
+            while (s.seq.load(std::memory_order_acquire) != pos) { std::this_thread::yield(); }
+        }
+
+        s.value = std::move(value);
+        s.seq.store(pos + 1, std::memory_order_release);
+        enqueue_pos_.store(pos + 1, std::memory_order_release);
+
+        return rval;
+    }
+
+    // Consumer only, the producer uses this for drop_oldest.
+    std::optional<T> pop()
+    {
+        if (size_ == 0)
+        {
+            return std::nullopt;
+        }
+
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            slot& s = slots_[pos % size_];
+            const size_t seq = s.seq.load(std::memory_order_acquire);
+
+            if (seq == pos + 1)
+            {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    std::optional<T> rval(std::move(s.value));
+                    s.value = T {};
+                    s.seq.store(pos + size_, std::memory_order_release);
+                    return rval;
+                }
+                // pos was updated by compare_exchange_weak
+            }
+            else if (seq < pos + 1)
+            {
+                // not yet filled in this lap
+                return std::nullopt;
+            }
+            else
+            {
+                // another consumer took it
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool empty() const noexcept
+    {
+        return dequeue_pos_.load(std::memory_order_acquire)
+               == enqueue_pos_.load(std::memory_order_acquire);
+    }
+
+    // Number of queued elements, only a snapshot while other threads push or pop.
+    size_t size() const noexcept
+    {
+        const size_t dequeue = dequeue_pos_.load(std::memory_order_acquire);
+        const size_t enqueue = enqueue_pos_.load(std::memory_order_acquire);
+        return enqueue > dequeue ? enqueue - dequeue : 0;
+    }
+
+    size_t capacity() const noexcept
+    {
+        return size_;
+    }
+
+    // number of elements that were dropped by push since the last reset
+    size_t get_dropped_count() const noexcept
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct slot
+    {
+        std::atomic<size_t> seq = 0;
+        T value {};
+    };
+
+    overflow_policy policy_;
+
+    size_t size_ = 0;
+    std::unique_ptr<slot[]> slots_;
+
+    std::atomic<size_t> enqueue_pos_ = 0;
+    std::atomic<size_t> dequeue_pos_ = 0;
+    std::atomic<size_t> dropped_ = 0;
+};
+
+} // namespace tcam
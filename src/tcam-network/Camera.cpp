@@ -497,10 +497,11 @@ std::string Camera::getFirmwareVersion()
 
 int Camera::uploadFirmware(const std::string& filename,
                            const std::string& overrideModelName,
-                           std::function<void(int, const std::string&)> progressFunc)
+                           std::function<void(int, const std::string&)> progressFunc,
+                           size_t windowSize)
 {
     FirmwareUpdate::Status retv = FirmwareUpdate::Status::DeviceAccessFailed;
-    FwdFirmwareWriter writer = FwdFirmwareWriter(*this);
+    FwdFirmwareWriter writer = FwdFirmwareWriter(*this, windowSize);
 
     if (getControl())
     {
@@ -665,220 +666,432 @@ bool Camera::isReachable()
 }
 
 
-bool Camera::sendWriteRegister(const uint32_t address, uint32_t value)
+namespace
 {
-    unsigned int response = Status::TIMEOUT;
-
-    unsigned short id = generateRequestID();
-    size_t real_size = sizeof(Packet::CMD_WRITEREG);
-
-    std::vector<uint8_t> packet_(real_size);
-    auto _packet = (Packet::CMD_WRITEREG*)packet_.data();
-
-    _packet->header.magic = 0x42;
-    _packet->header.flag = Flags::NEEDACK;
-    _packet->header.command = htons(Commands::WRITEREG_CMD);
-    _packet->header.length = htons(sizeof(Packet::CMD_WRITEREG) - sizeof(Packet::COMMAND_HEADER));
-    _packet->header.req_id = htons(id);
-
-    _packet->ops[0].address = htonl(address);
-    _packet->ops[0].value = htonl(value);
+// GVCP packets carry at most 540 bytes after the header
+constexpr size_t MAX_READREG_COUNT = 540 / sizeof(uint32_t);
+constexpr size_t MAX_WRITEREG_COUNT = 540 / sizeof(Packet::CMD_WRITEREG_OP);
+
+void fillCommandHeader(Packet::COMMAND_HEADER& header,
+                       unsigned int command,
+                       size_t payload_length,
+                       unsigned short id)
+{
+    header.magic = 0x42;
+    header.flag = Flags::NEEDACK;
+    header.command = htons(command);
+    header.length = htons(payload_length);
+    header.req_id = htons(id);
+}
 
-    auto callback_function = [id, &response](void* msg) -> int {
-        Packet::ACK_WRITEREG* ack = (Packet::ACK_WRITEREG*)msg;
-        response = Status::FAILURE;
+// Combines the acknowledges of a request that was split into multiple packets
+// status becomes SUCCESS once all packets succeeded, the first error is kept
+struct batch_status
+{
+    unsigned int& status;
+    size_t packet_count = 0;
+    size_t succeeded = 0;
 
-        if (ntohs(ack->header.ack_id) == id)
+    void update(unsigned int packet_status)
+    {
+        if (status != Status::TIMEOUT)
         {
-            response = ntohs(ack->header.status);
-            return Socket::SendAndReceiveSignals::END;
+            return;
         }
-        return Socket::SendAndReceiveSignals::CONTINUE;
-    };
-
-    try
-    {
-        int retries = tis::PACKET_RETRY_COUNT;
-        while (retries && (response == Status::TIMEOUT))
+        if (packet_status != Status::SUCCESS)
         {
-            socket->sendAndReceive(getCurrentIP(), _packet, real_size, callback_function);
-            retries--;
+            status = packet_status;
+        }
+        else if (++succeeded == packet_count)
+        {
+            status = Status::SUCCESS;
         }
     }
-    catch (SocketSendToException& exc)
-    {
-        std::cerr << exc.what() << std::endl;
-    }
-
-    return response == Status::SUCCESS;
-}
+};
+} // namespace
 
 
-bool Camera::sendReadRegister(const uint32_t address, uint32_t* value)
+void Camera::queueReadRegisters(GvcpEngine& engine,
+                                const std::vector<uint32_t>& addresses,
+                                uint32_t* values,
+                                unsigned int& status)
 {
-
-    if (!value)
+    status = Status::TIMEOUT;
+    if (addresses.empty() || !values)
     {
-        return false;
+        status = Status::INVALID_PARAMETER;
+        return;
     }
 
-    unsigned int response = Status::TIMEOUT;
-
-    unsigned short id = generateRequestID();
+    auto batch = std::make_shared<batch_status>(batch_status { status });
+    batch->packet_count = (addresses.size() + MAX_READREG_COUNT - 1) / MAX_READREG_COUNT;
 
-    Packet::CMD_READREG _packet = Packet::CMD_READREG();
-
-    _packet.header.magic = 0x42;
-    _packet.header.flag = Flags::NEEDACK;
-    _packet.header.command = htons(Commands::READREG_CMD);
-    _packet.header.length = htons(sizeof(Packet::CMD_READREG) - sizeof(Packet::COMMAND_HEADER));
-    _packet.header.req_id = ntohs(id);
+    for (size_t first = 0; first < addresses.size(); first += MAX_READREG_COUNT)
+    {
+        const size_t count = std::min(MAX_READREG_COUNT, addresses.size() - first);
+        const unsigned short id = generateRequestID();
 
-    _packet.address[0] = htonl(address);
+        std::vector<uint8_t> packet(sizeof(Packet::COMMAND_HEADER) + count * sizeof(uint32_t));
+        auto _packet = (Packet::CMD_READREG*)packet.data();
 
-    auto callback_function = [&id, &value, &response](void* msg) -> int {
-        Packet::ACK_READREG* ack = (Packet::ACK_READREG*)msg;
+        fillCommandHeader(_packet->header, Commands::READREG_CMD, count * sizeof(uint32_t), id);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint32_t address = htonl(addresses[first + i]);
+            memcpy(packet.data() + sizeof(Packet::COMMAND_HEADER) + i * sizeof(uint32_t),
+                   &address,
+                   sizeof(address));
+        }
 
-        response = Status::FAILURE;
+        uint32_t* dst = values + first;
+        auto callback_function = [batch, dst, count](void* msg, size_t size) -> int {
+            Packet::ACK_READREG* ack = (Packet::ACK_READREG*)msg;
 
-        if (ntohs(ack->header.ack_id) == id)
-        {
-            if (ack->header.status == Status::SUCCESS)
+            unsigned int packet_status = ntohs(ack->header.status);
+            if (packet_status == Status::SUCCESS)
             {
-                memcpy(value, ack->data, sizeof(uint32_t));
+                if (size < sizeof(Packet::ACK_HEADER) + count * sizeof(uint32_t))
+                {
+                    packet_status = Status::FAILURE;
+                }
+                else
+                {
+                    memcpy(dst, ack->data, count * sizeof(uint32_t));
+                    for (size_t i = 0; i < count; ++i) { dst[i] = ntohl(dst[i]); }
+                }
             }
-            response = ntohs(ack->header.status);
-            *value = ntohl(*value);
+            batch->update(packet_status);
             return Socket::SendAndReceiveSignals::END;
-        }
-        return Socket::SendAndReceiveSignals::CONTINUE;
-    };
+        };
+
+        engine.addRequest(socket,
+                          getCurrentIP(),
+                          packet.data(),
+                          packet.size(),
+                          callback_function,
+                          false,
+                          tis::PACKET_RETRY_COUNT);
+    }
+}
 
-    try
+
+void Camera::queueWriteRegisters(GvcpEngine& engine,
+                                 const std::vector<std::pair<uint32_t, uint32_t>>& ops,
+                                 unsigned int& status)
+{
+    status = Status::TIMEOUT;
+    if (ops.empty())
     {
-        int retries = tis::PACKET_RETRY_COUNT;
-        while (retries && (response == Status::TIMEOUT))
-        {
-            socket->sendAndReceive(getCurrentIP(), &_packet, sizeof(_packet), callback_function);
-            retries--;
-        }
+        status = Status::INVALID_PARAMETER;
+        return;
     }
-    catch (SocketSendToException& exc)
+
+    auto batch = std::make_shared<batch_status>(batch_status { status });
+    batch->packet_count = (ops.size() + MAX_WRITEREG_COUNT - 1) / MAX_WRITEREG_COUNT;
+
+    for (size_t first = 0; first < ops.size(); first += MAX_WRITEREG_COUNT)
     {
-        std::cerr << exc.what() << std::endl;
-    }
+        const size_t count = std::min(MAX_WRITEREG_COUNT, ops.size() - first);
+        const unsigned short id = generateRequestID();
 
-    return response == Status::SUCCESS;
+        std::vector<uint8_t> packet(sizeof(Packet::COMMAND_HEADER)
+                                    + count * sizeof(Packet::CMD_WRITEREG_OP));
+        auto _packet = (Packet::CMD_WRITEREG*)packet.data();
+
+        fillCommandHeader(
+            _packet->header, Commands::WRITEREG_CMD, count * sizeof(Packet::CMD_WRITEREG_OP), id);
+        for (size_t i = 0; i < count; ++i)
+        {
+            Packet::CMD_WRITEREG_OP op;
+            op.address = htonl(ops[first + i].first);
+            op.value = htonl(ops[first + i].second);
+            memcpy(packet.data() + sizeof(Packet::COMMAND_HEADER)
+                       + i * sizeof(Packet::CMD_WRITEREG_OP),
+                   &op,
+                   sizeof(op));
+        }
+
+        auto callback_function = [batch](void* msg, size_t /*size*/) -> int {
+            Packet::ACK_WRITEREG* ack = (Packet::ACK_WRITEREG*)msg;
+            batch->update(ntohs(ack->header.status));
+            return Socket::SendAndReceiveSignals::END;
+        };
+
+        engine.addRequest(socket,
+                          getCurrentIP(),
+                          packet.data(),
+                          packet.size(),
+                          callback_function,
+                          false,
+                          tis::PACKET_RETRY_COUNT);
+    }
 }
 
 
-bool Camera::sendReadMemory(const uint32_t address, const uint32_t size, void* data)
+void Camera::queueReadMemory(GvcpEngine& engine,
+                             const uint32_t address,
+                             const uint32_t size,
+                             void* data,
+                             unsigned int& status)
 {
-    if ((size % 4) != 0)
+    status = Status::TIMEOUT;
+    if ((size % 4) != 0 || !data)
     {
-        return false;
+        status = Status::INVALID_PARAMETER;
+        return;
     }
 
-    unsigned int response = Status::TIMEOUT;
-
     unsigned short id = generateRequestID();
 
     Packet::CMD_READMEM _packet = Packet::CMD_READMEM();
 
-    _packet.header.magic = 0x42;
-    _packet.header.flag = Flags::NEEDACK;
-    _packet.header.command = htons(Commands::READMEM_CMD);
-    _packet.header.length = htons(sizeof(Packet::CMD_READMEM) - sizeof(Packet::COMMAND_HEADER));
-    _packet.header.req_id = ntohs(id);
+    fillCommandHeader(_packet.header,
+                      Commands::READMEM_CMD,
+                      sizeof(Packet::CMD_READMEM) - sizeof(Packet::COMMAND_HEADER),
+                      id);
 
     _packet.count = htons(size);
     _packet.address = htonl(address);
 
-    auto callback_function = [&data, &id, &size, &response](void* msg) -> int {
+    auto callback_function = [data, size, &status](void* msg, size_t received) -> int {
         Packet::ACK_READMEM* ack = (Packet::ACK_READMEM*)msg;
 
-        response = Status::FAILURE;
-
-        if (ntohs(ack->header.ack_id) == id)
+        status = ntohs(ack->header.status);
+        if (status == Status::SUCCESS)
         {
-            if (ack->header.status == Status::SUCCESS)
+            if (received < sizeof(Packet::ACK_READMEM) + size)
+            {
+                status = Status::FAILURE;
+            }
+            else
             {
                 memcpy(data, ack->data, size);
             }
-            response = ntohs(ack->header.status);
-            return Socket::SendAndReceiveSignals::END;
         }
-        return Socket::SendAndReceiveSignals::CONTINUE;
+        return Socket::SendAndReceiveSignals::END;
     };
 
-    try
-    {
-        int retries = tis::PACKET_RETRY_COUNT;
-        while (retries && (response == Status::TIMEOUT))
-        {
-            socket->sendAndReceive(getCurrentIP(), &_packet, sizeof(_packet), callback_function);
-            retries--;
-        }
-    }
-    catch (SocketSendToException& exc)
-    {
-        std::cerr << exc.what() << std::endl;
-    }
-
-    return response == Status::SUCCESS;
+    engine.addRequest(socket,
+                      getCurrentIP(),
+                      &_packet,
+                      sizeof(_packet),
+                      callback_function,
+                      false,
+                      tis::PACKET_RETRY_COUNT);
 }
 
 
-bool Camera::sendWriteMemory(const uint32_t address, const size_t size, void* data)
+void Camera::queueWriteMemory(GvcpEngine& engine,
+                              const uint32_t address,
+                              const size_t size,
+                              const void* data,
+                              unsigned int& status)
 {
-    if ((size % 4) != 0)
+    status = Status::TIMEOUT;
+    if ((size % 4) != 0 || !data)
     {
-        return false;
+        status = Status::INVALID_PARAMETER;
+        return;
     }
 
-    unsigned int response = Status::TIMEOUT;
-
     unsigned short id = generateRequestID();
     size_t real_size = sizeof(Packet::CMD_WRITEMEM) + (size - sizeof(uint32_t));
 
     std::vector<uint8_t> packet_(real_size);
     auto _packet = (Packet::CMD_WRITEMEM*)packet_.data();
 
-    _packet->header.magic = 0x42;
-    _packet->header.flag = Flags::NEEDACK;
-    _packet->header.command = htons(Commands::WRITEMEM_CMD);
-    _packet->header.length = htons(size + sizeof(uint32_t));
-    _packet->header.req_id = htons(id);
+    fillCommandHeader(_packet->header, Commands::WRITEMEM_CMD, size + sizeof(uint32_t), id);
 
     memcpy(&_packet->data, data, size);
     _packet->address = htonl(address);
 
-    auto callback_function = [id, &response](void* msg) -> int {
+    auto callback_function = [&status](void* msg, size_t /*size*/) -> int {
         Packet::ACK_WRITEMEM* ack = (Packet::ACK_WRITEMEM*)msg;
-        response = Status::FAILURE;
+        status = ntohs(ack->header.status);
+        return Socket::SendAndReceiveSignals::END;
+    };
+
+    engine.addRequest(socket,
+                      getCurrentIP(),
+                      _packet,
+                      real_size,
+                      callback_function,
+                      false,
+                      tis::PACKET_RETRY_COUNT);
+}
+
+
+namespace
+{
+// The blocks are sent in segments, so that progress can be reported in between.
+// Only the last window of a segment waits for its acknowledges without new requests.
+constexpr size_t BLOCKS_PER_WINDOW_SEGMENT = 16;
+
+using queue_block_func =
+    std::function<void(GvcpEngine&, size_t offset, size_t length, unsigned int& status)>;
+
+unsigned int transferBlocks(const size_t size,
+                            size_t blockSize,
+                            size_t windowSize,
+                            const queue_block_func& queueBlock,
+                            const std::function<void(size_t)>& progressFunc)
+{
+    windowSize = std::max<size_t>(windowSize, 1);
+    const size_t segmentSize = blockSize * windowSize * BLOCKS_PER_WINDOW_SEGMENT;
 
-        if (ntohs(ack->header.ack_id) == id)
+    for (size_t segmentOffset = 0; segmentOffset < size; segmentOffset += segmentSize)
+    {
+        const size_t segmentEnd = std::min(size, segmentOffset + segmentSize);
+
+        std::vector<unsigned int> status((segmentEnd - segmentOffset + blockSize - 1) / blockSize,
+                                         Status::TIMEOUT);
+
+        GvcpEngine engine(windowSize);
+        for (size_t i = 0; i < status.size(); ++i)
         {
-            response = ntohs(ack->header.status);
-            return Socket::SendAndReceiveSignals::END;
+            const size_t offset = segmentOffset + i * blockSize;
+            queueBlock(engine, offset, std::min(blockSize, segmentEnd - offset), status[i]);
         }
-        return Socket::SendAndReceiveSignals::CONTINUE;
-    };
+        engine.run();
 
-    try
-    {
-        int retries = tis::PACKET_RETRY_COUNT;
-        while (retries && (response == Status::TIMEOUT))
+        for (auto s : status)
+        {
+            if (s != Status::SUCCESS)
+            {
+                return s;
+            }
+        }
+
+        if (progressFunc)
         {
-            socket->sendAndReceive(getCurrentIP(), _packet, real_size, callback_function);
-            retries--;
+            progressFunc(segmentEnd);
         }
     }
-    catch (SocketSendToException& exc)
+    return Status::SUCCESS;
+}
+} // namespace
+
+
+bool Camera::sendWriteMemoryBlocks(const uint32_t address,
+                                   const size_t size,
+                                   const void* data,
+                                   size_t blockSize,
+                                   size_t windowSize,
+                                   std::function<void(size_t)> progressFunc)
+{
+    if ((size % 4) != 0 || blockSize == 0 || (blockSize % 4) != 0)
     {
-        std::cerr << exc.what() << std::endl;
+        return false;
+    }
+
+    auto queueBlock = [this, address, data](
+                          GvcpEngine& engine, size_t offset, size_t length, unsigned int& status) {
+        queueWriteMemory(engine, address + offset, length, (const uint8_t*)data + offset, status);
+    };
+
+    auto response = transferBlocks(size, blockSize, windowSize, queueBlock, progressFunc);
+
+    if (response == Status::ACCESS_DENIED)
+    {
+        std::cout << "Unable to write. Access Denied." << std::endl;
+    }
+
+    return response == Status::SUCCESS;
+}
+
+
+bool Camera::sendReadMemoryBlocks(const uint32_t address,
+                                  const size_t size,
+                                  void* data,
+                                  size_t blockSize,
+                                  size_t windowSize,
+                                  std::function<void(size_t)> progressFunc)
+{
+    if ((size % 4) != 0 || blockSize == 0 || (blockSize % 4) != 0)
+    {
+        return false;
+    }
+
+    auto queueBlock = [this, address, data](
+                          GvcpEngine& engine, size_t offset, size_t length, unsigned int& status) {
+        queueReadMemory(engine, address + offset, length, (uint8_t*)data + offset, status);
+    };
+
+    return transferBlocks(size, blockSize, windowSize, queueBlock, progressFunc)
+           == Status::SUCCESS;
+}
+
+
+bool Camera::sendReadRegisters(const std::vector<uint32_t>& addresses,
+                               std::vector<uint32_t>& values)
+{
+    values.assign(addresses.size(), 0);
+
+    unsigned int response = Status::TIMEOUT;
+
+    GvcpEngine engine;
+    queueReadRegisters(engine, addresses, values.data(), response);
+    engine.run();
+
+    return response == Status::SUCCESS;
+}
+
+
+bool Camera::sendWriteRegisters(const std::vector<std::pair<uint32_t, uint32_t>>& ops)
+{
+    unsigned int response = Status::TIMEOUT;
+
+    GvcpEngine engine;
+    queueWriteRegisters(engine, ops, response);
+    engine.run();
+
+    return response == Status::SUCCESS;
+}
+
+
+bool Camera::sendWriteRegister(const uint32_t address, uint32_t value)
+{
+    return sendWriteRegisters({ { address, value } });
+}
+
+
+bool Camera::sendReadRegister(const uint32_t address, uint32_t* value)
+{
+    if (!value)
+    {
+        return false;
     }
 
+    unsigned int response = Status::TIMEOUT;
+
+    GvcpEngine engine;
+    queueReadRegisters(engine, { address }, value, response);
+    engine.run();
+
+    return response == Status::SUCCESS;
+}
+
+
+bool Camera::sendReadMemory(const uint32_t address, const uint32_t size, void* data)
+{
+    unsigned int response = Status::TIMEOUT;
+
+    GvcpEngine engine;
+    queueReadMemory(engine, address, size, data, response);
+    engine.run();
+
+    return response == Status::SUCCESS;
+}
+
+
+bool Camera::sendWriteMemory(const uint32_t address, const size_t size, void* data)
+{
+    unsigned int response = Status::TIMEOUT;
+
+    GvcpEngine engine;
+    queueWriteMemory(engine, address, size, data, response);
+    engine.run();
+
     if (response == Status::ACCESS_DENIED)
     {
         std::cout << "Unable to write. Access Denied." << std::endl;
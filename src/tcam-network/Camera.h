@@ -17,12 +17,14 @@
 #ifndef _CAMERA_H_
 #define _CAMERA_H_
 
+#include "GvcpEngine.h"
 #include "NetworkInterface.h"
 #include "gigevision.h"
 
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "../compiler_defines.h"
@@ -54,6 +56,9 @@ std::shared_ptr<Camera> getCameraFromList(const camera_list cameras,
                                           camera_ident id_type = CAMERA_SERIAL);
 
 const int PACKET_RETRY_COUNT = 5;
+
+/// number of WRITEMEM/READMEM requests that are in flight during a firmware upload
+const size_t FIRMWARE_UPLOAD_WINDOW_SIZE = 8;
 class Camera
 {
 private:
@@ -176,10 +181,12 @@ public:
     /// @param filename - string containing the location of the firmware that shall be used
     /// @param overrideModelName - string containing the model name that shall be used. empty on default
     /// @param progressFunc callback function to inform over progress
+    /// @param windowSize - number of flash write requests that are in flight at the same time
     /// @return true on success
     int uploadFirmware(const std::string& filename,
                        const std::string& overrideModelName,
-                       std::function<void(int, const std::string&)> progressFunc);
+                       std::function<void(int, const std::string&)> progressFunc,
+                       size_t windowSize = FIRMWARE_UPLOAD_WINDOW_SIZE);
 
     /// @name getInterfaceName
     /// @return name of interface used for communication
@@ -249,6 +256,77 @@ public:
     /// @return int containing the return value of write attempt
     bool sendWriteMemory(const uint32_t address, const size_t size, void* data);
 
+    /// @name sendReadRegisters
+    /// @param addresses - registers that shall be read
+    /// @param values - filled with the register values, in the order of addresses
+    /// @return true on success
+    /// @brief Reads all registers with as few READREG packets as possible
+    bool sendReadRegisters(const std::vector<uint32_t>& addresses, std::vector<uint32_t>& values);
+
+    /// @name sendWriteRegisters
+    /// @param ops - address/value pairs that shall be written, in this order
+    /// @return true on success
+    /// @brief Writes all registers with as few WRITEREG packets as possible
+    bool sendWriteRegisters(const std::vector<std::pair<uint32_t, uint32_t>>& ops);
+
+    /// @name sendWriteMemoryBlocks
+    /// @param address - memory address to be written
+    /// @param size - size of data; has to be a multiple of 4
+    /// @param data - information that shall be written
+    /// @param blockSize - bytes per WRITEMEM packet; has to be a multiple of 4
+    /// @param windowSize - number of packets that are in flight at the same time
+    /// @param progressFunc - called with the number of written bytes; may be empty
+    /// @return true when all blocks were written
+    /// @brief Writes a large memory area without waiting for each acknowledge,
+    /// blocks without acknowledge are resent.
+    bool sendWriteMemoryBlocks(const uint32_t address,
+                               const size_t size,
+                               const void* data,
+                               size_t blockSize,
+                               size_t windowSize,
+                               std::function<void(size_t)> progressFunc);
+
+    /// @name sendReadMemoryBlocks
+    /// @brief READMEM counterpart of sendWriteMemoryBlocks
+    bool sendReadMemoryBlocks(const uint32_t address,
+                              const size_t size,
+                              void* data,
+                              size_t blockSize,
+                              size_t windowSize,
+                              std::function<void(size_t)> progressFunc);
+
+    /// The queue functions add the requests to engine instead of sending them, so that
+    /// multiple cameras can be accessed at the same time.
+    /// value/data and status have to stay valid until engine.run() returns.
+    /// status then contains the GVCP status, Status::TIMEOUT when the camera did not answer.
+
+    /// @name queueReadRegisters
+    /// @param values - has to hold addresses.size() entries
+    void queueReadRegisters(GvcpEngine& engine,
+                            const std::vector<uint32_t>& addresses,
+                            uint32_t* values,
+                            unsigned int& status);
+
+    /// @name queueWriteRegisters
+    void queueWriteRegisters(GvcpEngine& engine,
+                             const std::vector<std::pair<uint32_t, uint32_t>>& ops,
+                             unsigned int& status);
+
+    /// @name queueReadMemory
+    void queueReadMemory(GvcpEngine& engine,
+                         const uint32_t address,
+                         const uint32_t size,
+                         void* data,
+                         unsigned int& status);
+
+    /// @name queueWriteMemory
+    /// @brief data is copied, it does not have to stay valid
+    void queueWriteMemory(GvcpEngine& engine,
+                          const uint32_t address,
+                          const size_t size,
+                          const void* data,
+                          unsigned int& status);
+
 private:
     /// @name sendForceIP
     /// @param ip - ip address camera shall use
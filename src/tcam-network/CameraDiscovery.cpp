@@ -16,6 +16,7 @@
 
 #include "CameraDiscovery.h"
 
+#include "GvcpEngine.h"
 #include "gigevision.h"
 #include "utils.h"
 
@@ -25,7 +26,6 @@
 #include <iostream> // cerr
 #include <linux/if.h>
 #include <netdb.h>
-#include <thread>
 
 namespace tis
 {
@@ -72,46 +72,62 @@ std::vector<std::shared_ptr<NetworkInterface>> detectNetworkInterfaces()
 }
 
 
-void discoverCameras(std::function<void(std::shared_ptr<Camera>)> const& discover_call)
+namespace
 {
-    std::vector<std::shared_ptr<Camera>> cameras;
-    auto interfaces = detectNetworkInterfaces();
 
-    if (interfaces.empty())
+void addDiscoveryRequest(GvcpEngine& engine,
+                         std::shared_ptr<NetworkInterface> interface,
+                         std::function<void(std::shared_ptr<Camera>)> const& discover_call)
+{
+    Packet::CMD_DISCOVERY discovery_packet;
+    discovery_packet.header.command = htons(Commands::DISCOVERY_CMD);
+    discovery_packet.header.flag = Flags::NEEDACK;
+    discovery_packet.header.length = htons(0);
+    discovery_packet.header.magic = 0x42;
+    discovery_packet.header.req_id = htons(1);
+
+    auto callback = [interface, &discover_call](void* msg, size_t size) {
+        if (size >= sizeof(Packet::ACK_DISCOVERY))
+        {
+            Packet::ACK_DISCOVERY* ack = (Packet::ACK_DISCOVERY*)msg;
+            auto cam = std::shared_ptr<Camera>(new Camera(*ack, interface));
+            discover_call(cam);
+        }
+        return Socket::SendAndReceiveSignals::CONTINUE;
+    };
+    try
     {
-        return;
+        auto s = interface->createSocket();
+        engine.addRequest(
+            s, "255.255.255.255", &discovery_packet, sizeof(discovery_packet), callback, true);
     }
-
-    std::vector<std::thread> thread_list;
-    // allocate whole in one step
-    thread_list.reserve(interfaces.size());
-
-    for (auto& inf : interfaces)
+    catch (std::exception& e)
     {
-        std::shared_ptr<NetworkInterface> ni = inf;
-        thread_list.push_back(
-            std::thread([inf, discover_call]() { sendDiscovery(inf, discover_call); }));
+        std::cerr << interface->getInterfaceName() << ": " << e.what() << std::endl;
     }
+}
+
+} // namespace
 
-    for (auto& thr : thread_list) { thr.join(); }
+
+void discoverCameras(std::function<void(std::shared_ptr<Camera>)> const& discover_call)
+{
+    auto interfaces = detectNetworkInterfaces();
+
+    // all interfaces are queried at the same time
+    GvcpEngine engine;
+    for (auto& inf : interfaces) { addDiscoveryRequest(engine, inf, discover_call); }
+
+    engine.run();
 }
 
 
 void discoverCameras(std::vector<std::string> selectected_interfaces,
                      std::function<void(std::shared_ptr<Camera>)> const& discover_call)
 {
-    std::vector<std::shared_ptr<Camera>> cameras;
     auto interfaces = detectNetworkInterfaces();
 
-    if (interfaces.empty())
-    {
-        return;
-    }
-
-    std::vector<std::thread> thread_list;
-    // allocate whole in one step
-    thread_list.reserve(interfaces.size());
-
+    GvcpEngine engine;
     for (auto& inf : interfaces)
     {
         if (std::find(selectected_interfaces.begin(),
@@ -119,42 +135,20 @@ void discoverCameras(std::vector<std::string> selectected_interfaces,
                       inf->getInterfaceName())
             != selectected_interfaces.end())
         {
-            std::shared_ptr<NetworkInterface> ni = inf;
-            thread_list.push_back(
-                std::thread([inf, discover_call]() { sendDiscovery(inf, discover_call); }));
+            addDiscoveryRequest(engine, inf, discover_call);
         }
     }
 
-    for (auto& thr : thread_list) { thr.join(); }
+    engine.run();
 }
 
 
 void sendDiscovery(std::shared_ptr<NetworkInterface> interface,
                    std::function<void(std::shared_ptr<Camera>)> const& discover_call)
 {
-    Packet::CMD_DISCOVERY discovery_packet;
-    discovery_packet.header.command = htons(Commands::DISCOVERY_CMD);
-    discovery_packet.header.flag = Flags::NEEDACK;
-    discovery_packet.header.length = htons(0);
-    discovery_packet.header.magic = 0x42;
-    discovery_packet.header.req_id = htons(1);
-
-    auto callback = [&interface, &discover_call](void* msg) {
-        Packet::ACK_DISCOVERY* ack = (Packet::ACK_DISCOVERY*)msg;
-        auto cam = std::shared_ptr<Camera>(new Camera(*ack, interface));
-        discover_call(cam);
-        return Socket::SendAndReceiveSignals::CONTINUE;
-    };
-    try
-    {
-        auto s = interface->createSocket();
-        s->sendAndReceive(
-            "255.255.255.255", &discovery_packet, sizeof(discovery_packet), callback, true);
-    }
-    catch (SocketSendToException& e)
-    {
-        std::cerr << e.what() << std::endl;
-    }
+    GvcpEngine engine;
+    addDiscoveryRequest(engine, interface, discover_call);
+    engine.run();
 }
 
 void sendIpRecovery(const std::string mac,
@@ -182,27 +176,22 @@ void sendIpRecovery(const std::string mac,
     packet.StaticSubnetMask = netmask;
     packet.StaticGateway = gateway;
 
-    auto bf = [&](std::shared_ptr<NetworkInterface> interface) {
-        auto s = interface->createSocket();
+    // Send through each interface
+    GvcpEngine engine;
+    for (auto& i : detectNetworkInterfaces())
+    {
         try
         {
-            s->sendAndReceive("255.255.255.255", &packet, sizeof(packet), NULL, true);
+            engine.addRequest(
+                i->createSocket(), "255.255.255.255", &packet, sizeof(packet), nullptr, true);
         }
-        catch (SocketSendToException& e)
+        catch (std::exception& e)
         {
         }
-    };
-
-    auto interfaces = detectNetworkInterfaces();
-    std::vector<std::thread> t;
-
-    // Send through each interface
-    for (auto& i : interfaces)
-    {
-        t.push_back(std::thread([&]() { bf(i); }));
     }
 
-    for (auto& th : t) { th.join(); }
+    // no acknowledge is awaited, this only sends
+    engine.run();
 }
 
 } /* namespace tis */
@@ -24,7 +24,10 @@ class FwdFirmwareWriter : public FirmwareUpdate::IFirmwareWriter
 {
 
 public:
-    FwdFirmwareWriter(Camera& cam) : device_itf_(cam) {}
+    FwdFirmwareWriter(Camera& cam, size_t window_size = FIRMWARE_UPLOAD_WINDOW_SIZE)
+        : device_itf_(cam), window_size_(window_size)
+    {
+    }
 
 
     ~FwdFirmwareWriter() {}
@@ -79,8 +82,32 @@ public:
         /* } */
     }
 
+
+    virtual bool writeBlocks(uint32_t addr,
+                             const void* pData,
+                             size_t data_size,
+                             size_t block_size,
+                             std::function<void(size_t)> progress)
+    {
+        return device_itf_.sendWriteMemoryBlocks(
+            addr, data_size, pData, block_size, window_size_, progress);
+    }
+
+
+    virtual bool readBlocks(uint32_t addr,
+                            void* pData,
+                            size_t data_size,
+                            size_t block_size,
+                            std::function<void(size_t)> progress)
+    {
+        return device_itf_.sendReadMemoryBlocks(
+            addr, data_size, pData, block_size, window_size_, progress);
+    }
+
 private:
     Camera& device_itf_;
+    // number of blocks in flight in writeBlocks/readBlocks
+    size_t window_size_;
 
 }; /* class FwdFirmwareWriter */
 
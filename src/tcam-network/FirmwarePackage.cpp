@@ -20,11 +20,14 @@
 
 namespace
 {
+// Decompresses the file straight into dest, dest is left empty on errors
 template<typename TContainer>
 void internalExtractFile(const std::string& packageFileName,
                          const std::string& fileName,
                          TContainer& dest)
 {
+    dest.clear();
+
     int err = 0;
     zip* z = zip_open(packageFileName.c_str(), 0, &err);
 
@@ -35,30 +38,29 @@ void internalExtractFile(const std::string& packageFileName,
 
     struct zip_stat st;
     zip_stat_init(&st);
-    zip_stat(z, fileName.c_str(), 0, &st);
-
-    //Alloc memory for its uncompressed contents
-    char* contents = new char[st.size];
-
-    //Read the compressed file
-    zip_file* f = zip_fopen(z, fileName.c_str(), 0);
+    zip_file* f = nullptr;
+    if (zip_stat(z, fileName.c_str(), 0, &st) == 0 && (st.valid & ZIP_STAT_SIZE))
+    {
+        f = zip_fopen(z, fileName.c_str(), 0);
+    }
     if (f == nullptr)
     {
-        delete[] contents;
+        zip_close(z);
         return;
     }
-    zip_uint64_t ret = zip_fread(f, contents, st.size);
 
-    if (ret != st.size)
+    dest.resize(st.size);
+    if (st.size > 0)
     {
-        delete[] contents;
-        return;
+        zip_int64_t ret = zip_fread(f, &dest[0], st.size);
+        if (ret < 0 || (zip_uint64_t)ret != st.size)
+        {
+            dest.clear();
+        }
     }
 
-    dest.assign(contents, contents + st.size);
-
+    zip_fclose(f);
     zip_close(z);
-    delete[] contents;
 }
 } // namespace
 
@@ -16,7 +16,9 @@
 
 #include "FirmwareUpgrade.h"
 
+#include "FirmwarePackage.h"
 #include "GigE3Update.h"
+#include "StatusPoll.h"
 
 #include <algorithm>
 #include <pugi.h>
@@ -25,7 +27,6 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <zip.h>
 
 
 namespace
@@ -139,33 +140,7 @@ bool isPackageFile(const std::string& fileName)
 std::vector<byte> extractFileFromPackage(const std::string& packageFileName,
                                          const std::string& fileName)
 {
-    std::vector<unsigned char> result;
-
-    //Open the ZIP archive
-    int err = 0;
-    zip* z = zip_open(packageFileName.c_str(), 0, &err);
-
-    //Search for the file of given name
-    struct zip_stat st;
-    zip_stat_init(&st);
-    zip_stat(z, fileName.c_str(), 0, &st);
-
-    //Alloc memory for its uncompressed contents
-    char* contents = new char[st.size];
-
-    //Read the compressed file
-    zip_file* f = zip_fopen(z, fileName.c_str(), 0);
-    zip_fread(f, contents, st.size);
-
-    std::copy(contents, contents + st.size, std::back_inserter(result));
-    // zip_fclose(f);
-
-    //And close the archive
-    zip_close(z);
-
-    delete[] contents;
-
-    return result;
+    return FirmwareUpdate::FirmwarePackage::extractFile(packageFileName, fileName);
 }
 
 
@@ -174,6 +149,25 @@ bool rebootCamera(FirmwareUpdate::IFirmwareWriter& dev)
     return dev.write(0xEF000004, 0xB007B007);
 }
 
+
+// the device clears the erase bit of the control register once the app flash is erased
+const uint32_t BLACKFIN_ERASE_APP = (1 << 2);
+const std::chrono::seconds BLACKFIN_ERASE_TIMEOUT(10);
+
+bool waitForBlackfinErase(FirmwareUpdate::IFirmwareWriter& dev)
+{
+    auto isErased = [&dev]
+    {
+        uint32_t control = 0;
+        return dev.read(0xEF000004, control) && (control & BLACKFIN_ERASE_APP) == 0;
+    };
+
+    return FirmwareUpdate::pollUntil(isErased,
+                                     BLACKFIN_ERASE_TIMEOUT,
+                                     std::chrono::milliseconds(1),
+                                     std::chrono::milliseconds(100));
+}
+
 } /* namespace */
 
 
@@ -187,12 +181,17 @@ Status uploadBlackfinFirmware(IFirmwareWriter& dev, std::vector<unsigned char>&
         return Status::WriteError;
     }
 
-    dev.write(
-        0xEF000004, (1 << 2), 3000 /* longer timeout, eeprom may take a while */); // erase app
+    dev.write(0xEF000004,
+              BLACKFIN_ERASE_APP,
+              3000 /* longer timeout, eeprom may take a while */); // erase app
 
-    sleep(1000);
+    if (!waitForBlackfinErase(dev))
+    {
+        dev.write(0xEF000000, 0x0); // lock
+        return Status::WriteError;
+    }
 
-    if (!dev.write(0xEE020000, &data[0], (uint32_t)data.size(), 3000))
+    if (!dev.writeBlocks(0xEE020000, data.data(), data.size(), 512, [](size_t) {}))
     {
         return Status::WriteVerificationError;
     }
@@ -284,35 +283,71 @@ Status uploadAndVerify(IFirmwareWriter& dev,
                        unsigned char* block,
                        unsigned int blockSize)
 {
-    int retry = 5;
-    bool success = true;
-    do {
-        success = dev.write(address, block, blockSize, 3000);
-        if (success)
+    std::vector<byte> verificationBuf(blockSize);
+
+    for (int retry = 5; retry >= 0; --retry)
+    {
+        unsigned int bytesRead;
+        if (!dev.write(address, block, blockSize, 3000)
+            || !dev.read(address, blockSize, &verificationBuf[0], bytesRead, 3000))
         {
-            std::vector<byte> verificationBuf(blockSize);
-            unsigned int bytesRead;
+            return Status::WriteVerificationError;
+        }
 
-            success = dev.read(address, blockSize, &verificationBuf[0], bytesRead, 3000);
-            if (success)
-            {
-                if (memcmp(block, &verificationBuf[0], blockSize) != 0)
-                {
-                    if (retry-- > 0)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        // failed
-                        success = false;
-                    }
-                }
-            }
+        if (memcmp(block, &verificationBuf[0], blockSize) == 0)
+        {
+            return Status::Success;
         }
-    } while (false);
+    }
 
-    return success ? Status::Success : Status::WriteVerificationError;
+    return Status::WriteVerificationError;
+}
+
+
+/// Writes data with pipelined WRITEMEM, reads everything back with pipelined READMEM
+/// and only rewrites the blocks that do not match with uploadAndVerify.
+Status uploadBlocksAndVerify(IFirmwareWriter& dev,
+                             unsigned int address,
+                             std::vector<byte>& data,
+                             unsigned int blockSize,
+                             std::function<void(int, const std::string&)> progressFunc)
+{
+    // the block transfers require multiples of 4 bytes, a remainder is written by the loop below
+    const size_t alignedSize = data.size() & ~size_t(3);
+
+    // writing is the first, verifying the second half of the progress
+    auto reportProgress = [&](int begin)
+    {
+        return [&, begin](size_t bytes) {
+            progressFunc(begin + (int)(bytes * 50 / data.size()), "");
+        };
+    };
+
+    std::vector<byte> verifyBuffer(alignedSize);
+    if (alignedSize > 0)
+    {
+        // failed transfers show up as blocks that do not match
+        dev.writeBlocks(address, data.data(), alignedSize, blockSize, reportProgress(0));
+        dev.readBlocks(address, verifyBuffer.data(), alignedSize, blockSize, reportProgress(50));
+    }
+
+    for (size_t offset = 0; offset < data.size(); offset += blockSize)
+    {
+        const size_t length = std::min((size_t)blockSize, data.size() - offset);
+        if (offset + length <= alignedSize
+            && memcmp(&data[offset], &verifyBuffer[offset], length) == 0)
+        {
+            continue;
+        }
+
+        Status status = uploadAndVerify(dev, address + offset, &data[offset], (unsigned int)length);
+        if (failed(status))
+        {
+            return status;
+        }
+    }
+
+    return Status::Success;
 }
 
 
@@ -328,15 +363,7 @@ Status uploadGigEFPGAFirmware(IFirmwareWriter& dev,
     }
 
     unsigned int base = 0xEE000000;
-    Status status = Status::Success;
-    for (unsigned int offset = 0; offset < data.size() && succeeded(status); offset += 128)
-    {
-        unsigned int blockSize = std::min(128u, (unsigned int)data.size() - offset);
-
-        status = uploadAndVerify(dev, base + offset, &data[0] + offset, blockSize);
-
-        progressFunc((offset * 100) / data.size(), "");
-    }
+    Status status = uploadBlocksAndVerify(dev, base, data, 128, progressFunc);
 
     dev.write(0xEF000000, 0x0); // lock
 
@@ -376,15 +403,7 @@ Status uploadFPGAConfiguration(IFirmwareWriter& dev,
 
     progressFunc(0, "Uploading");
 
-    Status status = Status::Success;
-    for (unsigned int offset = 0; offset < data.size() && succeeded(status); offset += 256)
-    {
-        unsigned int blockSize = std::min(256u, (unsigned int)data.size() - offset);
-
-        status = uploadAndVerify(dev, base + offset, &data[0] + offset, blockSize);
-
-        progressFunc((offset * 100) / data.size(), "");
-    }
+    Status status = uploadBlocksAndVerify(dev, base, data, 256, progressFunc);
 
     dev.write(0xC1000000, 0x0); // lock
 
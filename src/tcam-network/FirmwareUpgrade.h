@@ -18,6 +18,8 @@
 
 #include "gigevision.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -79,6 +81,54 @@ public:
                       unsigned int& read_count,
                       unsigned int timeout_in_ms = 2000) = 0;
 
+    /// @name writeBlocks
+    /// @param addr - address that shall be written
+    /// @param pData - data that shall be written
+    /// @param data_size - size of pData
+    /// @param block_size - maximum number of bytes per write
+    /// @param progress - called with the number of bytes written so far
+    /// @return true on success
+    /// @brief writes a large memory area; writers may keep multiple blocks in flight
+    virtual bool writeBlocks(uint32_t addr,
+                             const void* pData,
+                             size_t data_size,
+                             size_t block_size,
+                             std::function<void(size_t)> progress)
+    {
+        for (size_t offset = 0; offset < data_size; offset += block_size)
+        {
+            size_t step = std::min(block_size, data_size - offset);
+            if (!write(addr + offset, (uint8_t*)pData + offset, step))
+            {
+                return false;
+            }
+            progress(offset + step);
+        }
+        return true;
+    }
+
+    /// @name readBlocks
+    /// @brief read counterpart of writeBlocks
+    virtual bool readBlocks(uint32_t addr,
+                            void* pData,
+                            size_t data_size,
+                            size_t block_size,
+                            std::function<void(size_t)> progress)
+    {
+        for (size_t offset = 0; offset < data_size; offset += block_size)
+        {
+            unsigned int step = (unsigned int)std::min(block_size, data_size - offset);
+            unsigned int read_count = 0;
+            if (!read(addr + offset, step, (uint8_t*)pData + offset, read_count)
+                || read_count != step)
+            {
+                return false;
+            }
+            progress(offset + step);
+        }
+        return true;
+    }
+
 }; /* class IFirmwareWriter */
 
 
@@ -183,25 +183,15 @@ FirmwareUpdate::Status GigE3::DevicePortFlashMemory::WriteDeviceMemory(
     //const size_t StepSize = 1024 * 16;
     const size_t StepSize = 512;
     size_t totalBytes = data.size();
-    size_t bytesRemaining = totalBytes;
-    size_t bytesWritten = 0;
-
-    while (bytesRemaining > 0)
-    {
-        size_t stepBytes = std::min(bytesRemaining, StepSize);
-
-        if (!dev.write((uint32_t)(address + bytesWritten),
-                       (uint32_t*)(data.data() + bytesWritten),
-                       (size_t)stepBytes,
-                       0))
-        {
-            return Status::WriteError;
-        }
-
-        bytesWritten += stepBytes;
-        bytesRemaining -= stepBytes;
 
+    // the writer may keep multiple blocks in flight
+    auto reportProgress = [&](size_t bytesWritten) {
         progressFunc((int)(bytesWritten * 100 / totalBytes), std::string());
+    };
+
+    if (!dev.writeBlocks(address, data.data(), totalBytes, StepSize, reportProgress))
+    {
+        return Status::WriteError;
     }
 
     return Status::Success;
@@ -217,31 +207,14 @@ FirmwareUpdate::Status GigE3::DevicePortFlashMemory::ReadDeviceMemory(
     //const size_t StepSize = 1024 * 16;
     const size_t StepSize = 512;
     size_t totalBytes = buffer.size();
-    size_t bytesRemaining = totalBytes;
-    size_t bytesRead = 0;
-
-    while (bytesRemaining > 0)
-    {
-        size_t stepBytes = std::min(bytesRemaining, StepSize);
-
-        unsigned int stepBytesRead = 0;
-        if (!dev.read((uint32_t)(address + bytesRead),
-                      (uint32_t)stepBytes,
-                      buffer.data() + bytesRead,
-                      stepBytesRead))
-        {
-            return Status::WriteError;
-        }
-
-        if (stepBytesRead != stepBytes)
-        {
-            return Status::WriteError;
-        }
-
-        bytesRead += stepBytes;
-        bytesRemaining -= stepBytes;
 
+    auto reportProgress = [&](size_t bytesRead) {
         progressFunc((int)(bytesRead * 100 / totalBytes), std::string());
+    };
+
+    if (!dev.readBlocks(address, buffer.data(), totalBytes, StepSize, reportProgress))
+    {
+        return Status::WriteError;
     }
 
     return Status::Success;
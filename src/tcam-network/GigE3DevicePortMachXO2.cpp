@@ -42,13 +42,15 @@ FirmwareUpdate::Status GigE3::DevicePortMachXO2::CheckItems(const std::vector<Up
 
     for (auto&& i : items)
     {
-        auto jedec = MachXO2::JedecFile::Parse(*i.Data);
+        auto jedec = std::make_shared<const MachXO2::JedecFile>(MachXO2::JedecFile::Parse(*i.Data));
 
         // If the data is not valid jedec, the device type should not be detectable
-        if (jedec.deviceType() == MachXO2::DeviceType::MachXO2_Unknown)
+        if (jedec->deviceType() == MachXO2::DeviceType::MachXO2_Unknown)
         {
             return Status::InvalidFile;
         }
+
+        jedec_files_[i.Data.get()] = std::move(jedec);
     }
 
     return Status::Success;
@@ -66,7 +68,8 @@ std::function<void(const char*, int)> forwardAdvancedProgress(
 }
 
 
-I2C::DataArray s_i2cWriteData;
+// update sessions of different cameras run in their own threads
+thread_local I2C::DataArray s_i2cWriteData;
 
 
 size_t AlignBufferSize(size_t size, int alignment)
@@ -197,13 +200,18 @@ FirmwareUpdate::Status GigE3::DevicePortMachXO2::UploadItems(IFirmwareWriter& de
 
     try
     {
-        auto jedec = MachXO2::JedecFile::Parse(*item.Data);
+        // parsed by CheckItems when the package was loaded
+        auto jedec = jedec_files_.find(item.Data.get());
+        if (jedec == jedec_files_.end())
+        {
+            return Status::InvalidFile;
+        }
 
         I2C::I2CDevice i2c(
             0x80, forwardI2CWrite(dev), forwardI2CRead(dev), queryMaxI2cReadLength(dev));
         MachXO2::MachXO2Device mxo2_dev(i2c);
 
-        if (mxo2_dev.UpdateConfiguration(jedec, forwardAdvancedProgress(progressFunc)))
+        if (mxo2_dev.UpdateConfiguration(*jedec->second, forwardAdvancedProgress(progressFunc)))
         {
             // UpdateConfiguration returns false if no upgrade was necessary
             return Status::Success;
@@ -18,8 +18,15 @@
 
 #include "GigE3DevicePort.h"
 
+#include <map>
+#include <memory>
 #include <pugi.h>
 
+namespace MachXO2
+{
+class JedecFile;
+}
+
 namespace FirmwareUpdate
 {
 
@@ -30,6 +37,10 @@ class DevicePortMachXO2 : public IDevicePort
 {
     std::string name_;
 
+    // the items checked by CheckItems, by UploadItem::Data
+    // only written while the package is loaded, update sessions share the port
+    std::map<const std::vector<uint8_t>*, std::shared_ptr<const MachXO2::JedecFile>> jedec_files_;
+
 public:
     virtual std::string name() override
     {
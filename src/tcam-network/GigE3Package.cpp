@@ -22,12 +22,70 @@
 #include "GigE3UploadGroup.h"
 #include "GigE3UploadItem.h"
 
+#include <map>
 #include <memory>
+#include <mutex>
 #include <pugi.h>
+#include <sys/stat.h>
 
 using namespace FirmwareUpdate;
 
 
+namespace
+{
+
+struct shared_package
+{
+    // the file is loaded again when it was replaced
+    off_t size;
+    time_t mtime;
+
+    std::weak_ptr<const GigE3::Package> package;
+};
+
+} // namespace
+
+
+std::shared_ptr<const GigE3::Package> GigE3::Package::LoadShared(
+    const std::string& packageFileName,
+    Status& status)
+{
+    static std::mutex mtx;
+    static std::map<std::string, shared_package> packages;
+
+    struct stat st = {};
+    if (stat(packageFileName.c_str(), &st) != 0)
+    {
+        status = Status::InvalidFile;
+        return nullptr;
+    }
+
+    // sessions starting at the same time wait for the first one instead of loading their own copy
+    std::lock_guard<std::mutex> lck(mtx);
+
+    auto& entry = packages[packageFileName];
+    if (entry.size == st.st_size && entry.mtime == st.st_mtime)
+    {
+        if (auto package = entry.package.lock())
+        {
+            status = Status::Success;
+            return package;
+        }
+    }
+
+    auto package = std::make_shared<Package>();
+    status = package->Load(packageFileName);
+    if (failed(status))
+    {
+        packages.erase(packageFileName);
+        return nullptr;
+    }
+
+    entry = { st.st_size, st.st_mtime, package };
+    return package;
+}
+
+
 std::vector<std::string> GigE3::Package::FindModelNames(const std::string& packageFileName)
 {
     std::vector<std::string> result;
@@ -78,6 +136,18 @@ std::vector<GigE3::UploadGroup>* GigE3::Package::find_upload_groups(const std::s
 }
 
 
+const std::vector<GigE3::UploadGroup>* GigE3::Package::find_upload_groups(
+    const std::string& model_name) const
+{
+    auto it = device_types_.find(model_name);
+    if (it == device_types_.end())
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+
 FirmwareUpdate::Status GigE3::Package::Load(const std::string& packageFileName)
 {
     packageFileName_ = packageFileName;
@@ -326,9 +396,12 @@ FirmwareUpdate::Status GigE3::Package::ReadUploadItem(const pugi::xml_node& uplo
     }
 
     auto len = item.Params.find("Length");
-    if (len != item.Params.end())
+    if (len != item.Params.end() && item.Data->size() != len->second)
     {
-        item.Data->resize(len->second, 0);
+        // file data is shared by all items referencing the file, resize a copy
+        auto data = std::make_shared<std::vector<uint8_t>>(*item.Data);
+        data->resize(len->second, 0);
+        item.Data = std::move(data);
     }
 
     return Status::Success;
@@ -40,11 +40,19 @@ class Package
 public:
     static std::vector<std::string> FindModelNames(const std::string& packageFileName);
 
+    /// @brief Loads the package or returns the one already loaded by another update session.
+    /// The package is not modified after loading, so all sessions updating cameras in parallel
+    /// use the same parsed manifest and file data. It is freed with the last session.
+    /// @return nullptr when loading failed, status contains the reason
+    static std::shared_ptr<const Package> LoadShared(const std::string& packageFileName,
+                                                     Status& status);
+
 public:
     Status Load(const std::string& packageFileName);
 
     IDevicePort* find_port(const std::string& port_name);
     std::vector<UploadGroup>* find_upload_groups(const std::string& model_name);
+    const std::vector<UploadGroup>* find_upload_groups(const std::string& model_name) const;
 
 private:
     std::string packageFileName_;
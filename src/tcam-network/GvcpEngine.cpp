@@ -0,0 +1,252 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "GvcpEngine.h"
+
+#include "gigevision.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream> // cerr
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace tis
+{
+
+GvcpEngine::GvcpEngine(size_t window_size) : window_size_(std::max<size_t>(window_size, 1)) {}
+
+
+void GvcpEngine::addRequest(std::shared_ptr<Socket> socket,
+                            const std::string& destination_address,
+                            const void* data,
+                            size_t size,
+                            reply_callback callback,
+                            bool broadcast,
+                            int retries)
+{
+    if (!socket || size < sizeof(Packet::COMMAND_HEADER))
+    {
+        return;
+    }
+
+    request req;
+    req.destination_address = destination_address;
+    req.packet.assign((const uint8_t*)data, (const uint8_t*)data + size);
+    req.callback = std::move(callback);
+    req.broadcast = broadcast;
+    req.retries = std::max(retries, 1);
+    req.req_id = ntohs(((const Packet::COMMAND_HEADER*)data)->req_id);
+
+    auto& queue = queues_[socket->getFileDescriptor()];
+    queue.socket = socket;
+    queue.pending.push_back(std::move(req));
+}
+
+
+void GvcpEngine::fillWindow(socket_queue& queue)
+{
+    while (queue.in_flight.size() < window_size_ && !queue.pending.empty())
+    {
+        request req = std::move(queue.pending.front());
+        queue.pending.pop_front();
+
+        try
+        {
+            queue.socket->sendTo(
+                req.destination_address, req.packet.data(), req.packet.size(), req.broadcast);
+        }
+        catch (SocketSendToException& e)
+        {
+            std::cerr << e.what() << std::endl;
+            continue;
+        }
+        req.retries--;
+
+        // nothing to wait for
+        if (!req.callback)
+        {
+            continue;
+        }
+
+        req.deadline = clock::now() + std::chrono::milliseconds(queue.socket->getTimeout());
+        queue.in_flight.push_back(std::move(req));
+    }
+}
+
+
+void GvcpEngine::dispatch(socket_queue& queue, void* msg, size_t size)
+{
+    if (size < sizeof(Packet::ACK_HEADER))
+    {
+        return;
+    }
+
+    auto header = (const Packet::ACK_HEADER*)msg;
+    const uint16_t ack_id = ntohs(header->ack_id);
+
+    auto iter = std::find_if(queue.in_flight.begin(),
+                             queue.in_flight.end(),
+                             [ack_id](const request& r) { return r.req_id == ack_id; });
+
+    // late acknowledge of a request that was already given up or completed by a resend
+    if (iter == queue.in_flight.end())
+    {
+        return;
+    }
+
+    auto& req = *iter;
+
+    // the device needs more time, the payload contains the time in ms until the real acknowledge
+    if (ntohs(header->answer) == Commands::PENDING_ACK)
+    {
+        uint16_t time_to_completion = 0;
+        if (size >= sizeof(Packet::ACK_HEADER) + 4)
+        {
+            memcpy(&time_to_completion, (const uint8_t*)msg + sizeof(Packet::ACK_HEADER) + 2, 2);
+        }
+        req.deadline = clock::now() + std::chrono::milliseconds(ntohs(time_to_completion))
+                       + std::chrono::milliseconds(queue.socket->getTimeout());
+        return;
+    }
+
+    if (req.callback(msg, size) == Socket::SendAndReceiveSignals::END)
+    {
+        queue.in_flight.erase(iter);
+        fillWindow(queue);
+    }
+}
+
+
+void GvcpEngine::handleTimeouts(socket_queue& queue, clock::time_point now)
+{
+    for (auto iter = queue.in_flight.begin(); iter != queue.in_flight.end();)
+    {
+        auto& req = *iter;
+        if (req.deadline > now)
+        {
+            ++iter;
+            continue;
+        }
+
+        if (!req.broadcast && req.retries > 0)
+        {
+            try
+            {
+                queue.socket->sendTo(req.destination_address, req.packet.data(), req.packet.size());
+                req.retries--;
+                req.deadline = now + std::chrono::milliseconds(queue.socket->getTimeout());
+                ++iter;
+                continue;
+            }
+            catch (SocketSendToException& e)
+            {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+
+        // timed out, the callback was never called with END
+        iter = queue.in_flight.erase(iter);
+    }
+
+    fillWindow(queue);
+}
+
+
+void GvcpEngine::run()
+{
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0)
+    {
+        std::cerr << "Unable to create epoll instance: " << strerror(errno) << std::endl;
+        queues_.clear();
+        return;
+    }
+
+    for (auto& [fd, queue] : queues_)
+    {
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0)
+        {
+            std::cerr << "Unable to poll socket: " << strerror(errno) << std::endl;
+            queue.pending.clear();
+            continue;
+        }
+        fillWindow(queue);
+    }
+
+    std::vector<epoll_event> events(std::max<size_t>(queues_.size(), 1));
+    while (true)
+    {
+        const auto now = clock::now();
+        auto next_deadline = clock::time_point::max();
+        for (auto& [fd, queue] : queues_)
+        {
+            handleTimeouts(queue, now);
+            for (const auto& req : queue.in_flight)
+            {
+                next_deadline = std::min(next_deadline, req.deadline);
+            }
+        }
+
+        if (next_deadline == clock::time_point::max())
+        {
+            break;
+        }
+
+        // round up, so that we do not spin until the deadline is reached
+        const auto wait_ms =
+            std::chrono::ceil<std::chrono::milliseconds>(next_deadline - now).count();
+
+        int n = epoll_wait(epoll_fd, events.data(), events.size(), std::max<int>(wait_ms, 0));
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            std::cerr << "Error while waiting for GVCP packets: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            auto iter = queues_.find(events[i].data.fd);
+            if (iter == queues_.end())
+            {
+                continue;
+            }
+
+            auto& queue = iter->second;
+
+            // GVCP packets are at most 576 bytes
+            uint8_t msg[1024];
+            ssize_t received = 0;
+            while ((received = queue.socket->receive(msg, sizeof(msg))) >= 0)
+            {
+                dispatch(queue, msg, received);
+            }
+        }
+    }
+
+    close(epoll_fd);
+    queues_.clear();
+}
+
+} /* namespace tis */
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _GVCP_ENGINE_H_
+#define _GVCP_ENGINE_H_
+
+#include "Socket.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../compiler_defines.h"
+
+VISIBILITY_DEFAULT
+
+namespace tis
+{
+
+/// @class GvcpEngine
+/// @brief Sends GVCP requests over any number of sockets and dispatches the acknowledges in a
+/// single epoll loop.
+///
+/// Requests of different sockets are in flight at the same time.
+/// Requests of the same socket are sent one after the other, as a GigE Vision device only
+/// handles one command at a time. A window size > 1 keeps that many requests per socket in
+/// flight, which the device then processes from its receive queue. Only use this for requests
+/// that do not depend on each other, e.g. WRITEMEM of consecutive blocks.
+/// Acknowledges are matched by the req_id of the request, so req_ids have to be unique per socket.
+class GvcpEngine
+{
+public:
+    /// called for every acknowledge of a request
+    /// msg is the received packet, size the number of received bytes
+    /// @return Socket::SendAndReceiveSignals; END completes the request
+    using reply_callback = std::function<int(void* msg, size_t size)>;
+
+    /// @param window_size - number of requests per socket that are in flight at the same time
+    explicit GvcpEngine(size_t window_size = 1);
+
+    GvcpEngine(const GvcpEngine&) = delete;
+    GvcpEngine& operator=(const GvcpEngine&) = delete;
+
+    /// @name addRequest
+    /// @param socket - socket the request is sent from and the acknowledges are received on
+    /// @param destination_address - address that shall receive the request
+    /// @param data - complete packet, starting with a COMMAND_HEADER
+    /// @param size - size of data
+    /// @param callback - function that is called for each acknowledge; may be empty when no acknowledge is expected
+    /// @param broadcast - broadcasts collect acknowledges until the timeout of the socket and are not resent
+    /// @param retries - number of times the request is sent before it is given up
+    void addRequest(std::shared_ptr<Socket> socket,
+                    const std::string& destination_address,
+                    const void* data,
+                    size_t size,
+                    reply_callback callback,
+                    bool broadcast = false,
+                    int retries = 1);
+
+    /// @name run
+    /// @brief sends all added requests and waits until all are completed or timed out
+    /// Callbacks are called from within this function. The engine is empty afterwards.
+    void run();
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct request
+    {
+        std::string destination_address;
+        std::vector<uint8_t> packet;
+        reply_callback callback;
+        bool broadcast = false;
+        int retries = 1;
+
+        uint16_t req_id = 0;
+        clock::time_point deadline;
+    };
+
+    struct socket_queue
+    {
+        std::shared_ptr<Socket> socket;
+        std::deque<request> pending; // not yet sent
+        std::list<request> in_flight; // sent, waiting for the acknowledge
+    };
+
+    /// @brief sends pending requests until the window is full
+    void fillWindow(socket_queue& queue);
+    void dispatch(socket_queue& queue, void* msg, size_t size);
+    void handleTimeouts(socket_queue& queue, clock::time_point now);
+
+    size_t window_size_ = 1;
+
+    // key is the file descriptor of the socket
+    std::map<int, socket_queue> queues_;
+
+}; /* class GvcpEngine */
+
+} /* namespace tis */
+
+VISIBILITY_POP
+
+#endif /* _GVCP_ENGINE_H_ */
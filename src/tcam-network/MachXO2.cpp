@@ -17,19 +17,18 @@
 #include "MachXO2.h"
 
 #include "JedecFile.h"
+#include "StatusPoll.h"
 
 #include <algorithm>
 #include <climits>
 #include <cstdlib>
 #include <iterator>
-#include <unistd.h> // usleep
+#include <thread>
 
 using namespace MachXO2;
 
-inline int millisleep(const unsigned int millisec)
-{
-    return usleep(millisec * 1000);
-}
+// the enable, program page and program done commands take a few hundred us at most
+static const std::chrono::milliseconds COMMAND_TIMEOUT(100);
 
 
 template<typename T> T swap_endian(T u)
@@ -219,8 +218,6 @@ bool MachXO2Device::UpdateConfiguration(const JedecFile& jedec,
     SetProgramDone();
     Refresh();
 
-    millisleep(1000);
-
     EnableTransparentConfigurationMode();
     WriteConfiguration(jedec.configurationData(), map_progress(reportProgress, 0, 70));
 
@@ -265,22 +262,29 @@ static bool IsStatusFail(uint32_t status)
 }
 
 
-// static bool IsStatusBusy (uint32_t status)
-// {
-//     return (status & (1 << 12)) != 0;
-// }
+static bool IsStatusBusy(uint32_t status)
+{
+    return (status & (1 << 12)) != 0;
+}
 
 
 int MachXO2Device::ReadStatus()
 {
     uint32_t status = _itf.read<uint32_t>(Commands::READ_STATUS);
-    // bool isBusy = IsStatusBusy(status);
-    // bool isFail = IsStatusFail(status);
 
     return status;
 }
 
 
+void MachXO2Device::WaitWhileBusy(std::chrono::milliseconds timeout, const char* step)
+{
+    if (!FirmwareUpdate::pollUntil([this] { return !CheckBusy(); }, timeout))
+    {
+        throw std::runtime_error(std::string("The MachXO2 device is still busy after ") + step);
+    }
+}
+
+
 bool MachXO2Device::CheckStatusFail()
 {
     return IsStatusFail(ReadStatus());
@@ -291,14 +295,7 @@ void MachXO2Device::EnableTransparentConfigurationMode()
 {
     _itf.write(Commands::ISC_ENABLE_X);
 
-    if (!CheckBusy())
-    {
-        millisleep(1);
-    }
-    else
-    {
-        while (CheckBusy()) {}
-    }
+    WaitWhileBusy(COMMAND_TIMEOUT, "enabling configuration mode");
 
     if (CheckStatusFail())
     {
@@ -312,7 +309,15 @@ void MachXO2Device::EraseFlash()
 {
     _itf.write(Commands::ERASE_FLASH);
 
-    while (CheckBusy()) {}
+    // the erase delays are the typical times in ms, allow twice that
+    const std::chrono::milliseconds timeout(2 * (info().cfgEraseDelay() + info().ufmEraseDelay()));
+    if (!FirmwareUpdate::pollUntil([this] { return !CheckBusy(); },
+                                   timeout,
+                                   std::chrono::milliseconds(1),
+                                   std::chrono::milliseconds(50)))
+    {
+        throw std::runtime_error("The MachXO2 device did not finish erasing flash and features");
+    }
 
     if (CheckStatusFail())
     {
@@ -338,14 +343,7 @@ void MachXO2Device::WriteConfiguration(const std::vector<uint8_t> data,
 
         reportProgress(p * 100 / totalPages);
 
-        if (!CheckBusy())
-        {
-            millisleep(1);
-        }
-        else
-        {
-            while (CheckBusy()) {}
-        }
+        WaitWhileBusy(COMMAND_TIMEOUT, "programming a page");
     }
 
     reportProgress(100);
@@ -356,14 +354,7 @@ void MachXO2Device::SetProgramDone()
 {
     _itf.write(Commands::SET_PROGRAM_DONE);
 
-    if (!CheckBusy())
-    {
-        millisleep(1);
-    }
-    else
-    {
-        while (CheckBusy()) {}
-    }
+    WaitWhileBusy(COMMAND_TIMEOUT, "setting program done");
 }
 
 
@@ -371,9 +362,33 @@ void MachXO2Device::Refresh()
 {
     _itf.write(Commands::REFRESH);
 
-    millisleep(info().tRefresh() * 1000);
+    // The device reloads its configuration and does not answer until it is done.
+    // tRefresh is the typical time in ms, the previous fixed wait of tRefresh seconds is the limit.
+    std::this_thread::sleep_for(std::chrono::milliseconds(info().tRefresh()));
 
-    if (CheckStatusFail())
+    uint32_t status = 0;
+    auto isRefreshed = [this, &status]
+    {
+        try
+        {
+            status = ReadStatus();
+        }
+        catch (const std::runtime_error&)
+        {
+            return false;
+        }
+        return !IsStatusBusy(status);
+    };
+
+    if (!FirmwareUpdate::pollUntil(isRefreshed,
+                                   std::chrono::milliseconds(info().tRefresh() * 1000),
+                                   std::chrono::milliseconds(1),
+                                   std::chrono::milliseconds(100)))
+    {
+        throw std::runtime_error("MachXO2 device did not finish the REFRESH command");
+    }
+
+    if (IsStatusFail(status))
     {
         throw std::runtime_error("MachXO2 device is in fail state after REFRESH command");
     }
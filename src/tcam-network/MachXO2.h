@@ -18,6 +18,7 @@
 
 #include "I2CDevice.h"
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <map>
@@ -161,6 +162,9 @@ private:
     int ReadStatus();
     bool CheckStatusFail();
 
+    // polls CheckBusy with backoff, throws when the device is still busy after timeout
+    void WaitWhileBusy(std::chrono::milliseconds timeout, const char* step);
+
 public:
     uint32_t QueryUserCode();
     bool UpdateConfiguration(const JedecFile& jedec,
@@ -95,54 +95,79 @@ bool Socket::setBroadcast(bool enable)
 }
 
 
-void Socket::sendAndReceive(const std::string& destination_address,
-                            void* data,
-                            size_t size,
-                            std::function<int(void*)> callback,
-                            const bool broadcast)
+int Socket::getFileDescriptor() const
+{
+    return fd;
+}
+
+
+int Socket::getTimeout() const
+{
+    return timeout_ms;
+}
+
+
+void Socket::sendTo(const std::string& destination_address,
+                    const void* data,
+                    size_t size,
+                    const bool broadcast)
 {
     sockaddr_in destAddr = fillAddr(destination_address, STANDARD_GVCP_PORT);
     setBroadcast(broadcast);
 
     ssize_t send =
-        sendto(fd, (uint8_t*)data, size, 0, (struct sockaddr*)&destAddr, sizeof(destAddr));
+        sendto(fd, (const uint8_t*)data, size, 0, (struct sockaddr*)&destAddr, sizeof(destAddr));
     if (send <= 0)
     {
         throw SocketSendToException();
     }
-    else
+}
+
+
+ssize_t Socket::receive(void* buffer, size_t size)
+{
+    return recv(fd, buffer, size, MSG_DONTWAIT);
+}
+
+
+void Socket::sendAndReceive(const std::string& destination_address,
+                            void* data,
+                            size_t size,
+                            std::function<int(void*)> callback,
+                            const bool broadcast)
+{
+    sendTo(destination_address, data, size, broadcast);
+
+    // we have nothing to wait for end just end here
+    if (callback == NULL)
     {
-        // we have nothing to wait for end just end here
-        if (callback == NULL)
-        {
-            return;
-        }
+        return;
+    }
 
-        timeval timeout;
-        timeout.tv_sec = timeout_ms / 1000;
-        timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    timeval timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
 
-        fd_set fds;
-        FD_ZERO(&fds);
-        FD_SET(fd, &fds);
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(fd, &fds);
 
-        while (select(fd + 1, &fds, NULL, NULL, &timeout) > 0)
-        {
-            char msg[1024];
+    while (select(fd + 1, &fds, NULL, NULL, &timeout) > 0)
+    {
+        char msg[1024];
 
-            struct sockaddr_storage sender = sockaddr_storage();
-            socklen_t sendsize = 0;
+        struct sockaddr_storage sender = sockaddr_storage();
+        socklen_t sendsize = 0;
 
-            if (recvfrom(fd, msg, sizeof(msg), 0, (sockaddr*)&sender, &sendsize) >= 0)
+        if (recvfrom(fd, msg, sizeof(msg), 0, (sockaddr*)&sender, &sendsize) >= 0)
+        {
+            if (callback(msg) == SendAndReceiveSignals::END)
             {
-                if (callback(msg) == SendAndReceiveSignals::END)
-                {
-                    return;
-                }
-
-                // not working due to gcc bug
-                //auto cam = std::make_shared<Camera>(ack, interfaces.at(i).socket, interfaces.at(i).name);
+                return;
             }
+
+            // not working due to gcc bug
+            //auto cam = std::make_shared<Camera>(ack, interfaces.at(i).socket, interfaces.at(i).name);
         }
     }
 }
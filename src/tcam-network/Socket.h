@@ -96,6 +96,32 @@ public:
     /// @return true on success
     bool setBroadcast(bool enable);
 
+    /// @name getFileDescriptor
+    /// @return the file descriptor, for polling
+    int getFileDescriptor() const;
+
+    /// @name getTimeout
+    /// @return time in milliseconds that is waited for a response
+    int getTimeout() const;
+
+    /// @name sendTo
+    /// @param destination_address - address that shall receive data
+    /// @param data - information that shall be sent
+    /// @param size - size of data
+    /// @param broadcast - wether this shall be broadcasted or not
+    /// @brief throws SocketSendToException on error
+    void sendTo(const std::string& destination_address,
+                const void* data,
+                size_t size,
+                const bool broadcast = false);
+
+    /// @name receive
+    /// @param buffer - container for the received packet
+    /// @param size - size of buffer
+    /// @return number of received bytes; -1 when no packet is pending
+    /// @brief does not block
+    ssize_t receive(void* buffer, size_t size);
+
     /// @name sendAndReceive
     /// @param destination_address - address that shall receive data
     /// @param data - information that shall be sent
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace FirmwareUpdate
+{
+
+/// @name pollUntil
+/// @param isDone - queries the device, returns true once the operation has finished
+/// @param timeout - maximum time to wait for the operation
+/// @param firstDelay - wait after the first unsuccessful query, doubled after every query
+/// @param maxDelay - upper limit of the wait between two queries
+/// @return true when isDone returned true before the timeout passed
+/// @brief Polls a device status with exponential backoff.
+/// Short operations are noticed after a few queries, long ones (flash erase)
+/// do not flood the control channel.
+template<typename TIsDone>
+bool pollUntil(TIsDone isDone,
+               std::chrono::milliseconds timeout,
+               std::chrono::microseconds firstDelay = std::chrono::microseconds(100),
+               std::chrono::microseconds maxDelay = std::chrono::milliseconds(50))
+{
+    using namespace std::chrono;
+
+    const auto deadline = steady_clock::now() + timeout;
+    auto delay = firstDelay;
+    while (true)
+    {
+        if (isDone())
+        {
+            return true;
+        }
+
+        const auto now = steady_clock::now();
+        if (now >= deadline)
+        {
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::min(delay, duration_cast<microseconds>(deadline - now)));
+        delay = std::min(delay * 2, maxDelay);
+    }
+}
+
+} /* namespace FirmwareUpdate */
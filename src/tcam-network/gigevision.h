@@ -46,6 +46,7 @@ static const unsigned int EVENT_CMD = 0xC0;
 static const unsigned int EVENT_ACK = 0xC1;
 static const unsigned int EVENTDATA_CMD = 0xC2;
 static const unsigned int EVENTDATA_ACK = 0xC3;
+static const unsigned int PENDING_ACK = 0x89;
 static const unsigned int INVALID_COMMAND = 0xFF;
 
 } /* namespace Commands */
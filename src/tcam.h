@@ -23,7 +23,10 @@
  */
 
 #include "CaptureDevice.h"
+#include "DeviceGroup.h"
 #include "DeviceInfo.h"
+#include "FlightRecorder.h"
+#include "FrameStream.h"
 #include "BufferPool.h"
 #include "ImageBuffer.h"
 #include "ImageSink.h"
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+//
+// USDT probes of the provider 'tcam' for perf, bpftrace, SystemTap and LTTng.
+//
+// A probe is a single nop until a tracer attaches to it, the arguments are only evaluated
+// into registers. Without sys/sdt.h, see the cmake option TCAM_ENABLE_TRACEPOINTS,
+// the macros expand to nothing and do not evaluate their arguments.
+//
+// The probes are listed in doc/pages/tracing.rst, keep that list up to date.
+//
+
+#if defined(TCAM_HAVE_USDT)
+
+#include <sys/sdt.h>
+
+#define TCAM_TRACE0(name)                 DTRACE_PROBE(tcam, name)
+#define TCAM_TRACE1(name, a1)             DTRACE_PROBE1(tcam, name, a1)
+#define TCAM_TRACE2(name, a1, a2)         DTRACE_PROBE2(tcam, name, a1, a2)
+#define TCAM_TRACE3(name, a1, a2, a3)     DTRACE_PROBE3(tcam, name, a1, a2, a3)
+#define TCAM_TRACE4(name, a1, a2, a3, a4) DTRACE_PROBE4(tcam, name, a1, a2, a3, a4)
+
+#else
+
+#define TCAM_TRACE0(name) \
+    do                    \
+    {                     \
+    } while (0)
+#define TCAM_TRACE1(name, a1) \
+    do                        \
+    {                         \
+        (void)sizeof(a1);     \
+    } while (0)
+#define TCAM_TRACE2(name, a1, a2)     \
+    do                                \
+    {                                 \
+        (void)sizeof(a1);             \
+        (void)sizeof(a2);             \
+    } while (0)
+#define TCAM_TRACE3(name, a1, a2, a3) \
+    do                                \
+    {                                 \
+        (void)sizeof(a1);             \
+        (void)sizeof(a2);             \
+        (void)sizeof(a3);             \
+    } while (0)
+#define TCAM_TRACE4(name, a1, a2, a3, a4) \
+    do                                    \
+    {                                     \
+        (void)sizeof(a1);                 \
+        (void)sizeof(a2);                 \
+        (void)sizeof(a3);                 \
+        (void)sizeof(a4);                 \
+    } while (0)
+
+#endif
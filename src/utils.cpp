@@ -28,6 +28,7 @@
 #include <limits>
 #include <pthread.h>
 #include <signal.h> // kill
+#include <sstream>
 #include <sys/ioctl.h>
 
 using namespace tcam;
@@ -280,6 +281,46 @@ std::optional<int> tcam::get_environment_variable_int(const std::string& name)
     return {};
 }
 
+std::optional<std::vector<int>> tcam::parse_cpu_list(const std::string& str)
+{
+    std::vector<int> rval;
+
+    std::istringstream stream(str);
+    std::string entry;
+    while (std::getline(stream, entry, ','))
+    {
+        try
+        {
+            size_t pos = 0;
+            const int first = std::stoi(entry, &pos);
+            int last = first;
+            if (pos < entry.size())
+            {
+                if (entry[pos] != '-')
+                {
+                    return std::nullopt;
+                }
+                size_t pos2 = 0;
+                last = std::stoi(entry.substr(pos + 1), &pos2);
+                if (pos + 1 + pos2 != entry.size())
+                {
+                    return std::nullopt;
+                }
+            }
+            if (first < 0 || last < first)
+            {
+                return std::nullopt;
+            }
+            for (int cpu = first; cpu <= last; ++cpu) { rval.push_back(cpu); }
+        }
+        catch (const std::exception&)
+        {
+            return std::nullopt;
+        }
+    }
+    return rval;
+}
+
 int tcam::set_thread_name(const char* name, pthread_t thrd /*= pthread_self()*/)
 {
     return pthread_setname_np(thrd, name);
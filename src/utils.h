@@ -106,6 +106,12 @@ std::string get_environment_variable(const std::string& name, const std::string&
 
 std::optional<int> get_environment_variable_int(const std::string& name);
 
+/**
+ * @brief parse a list of cpu cores like "0,2-3"
+ * @return the cores in list order; nullopt when str is not a valid list
+ */
+std::optional<std::vector<int>> parse_cpu_list(const std::string& str);
+
 /**
  * @brief set the thread name (for debuggers) of the specified thread.
  * @param thrd the thread specified.
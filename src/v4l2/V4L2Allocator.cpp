@@ -20,9 +20,12 @@
 #include "../error.h"
 #include "../logging.h"
 #include "../utils.h"
+#include "v4l2_capture.h"
 
+#include <fcntl.h> /* O_RDWR O_CLOEXEC */
 #include <linux/videodev2.h>
 #include <sys/mman.h> /* mmap PROT_READ*/
+#include <unistd.h> /* close */
 
 using namespace tcam;
 
@@ -50,16 +53,70 @@ bool reqbufs(int fd_,
  //   return outcome::success();
 }
 
+// Exports and maps mmap buffer 0, like allocate_dma does for every buffer.
+// Drivers may accept V4L2_MEMORY_DMABUF for importing without being able to export.
+bool can_export_dmabuf(int fd, uint32_t buf_type)
+{
+    v4l2::capture_buffer buf(buf_type, V4L2_MEMORY_MMAP, 0);
+    if (tcam::tcam_xioctl(fd, VIDIOC_QUERYBUF, &buf.buf) == -1)
+    {
+        return false;
+    }
+
+    struct v4l2_exportbuffer expbuf = {};
+    expbuf.type = buf_type;
+    expbuf.index = 0;
+    expbuf.flags = O_RDWR | O_CLOEXEC;
+
+    if (tcam::tcam_xioctl(fd, VIDIOC_EXPBUF, &expbuf) == -1)
+    {
+        SPDLOG_INFO("Device does not support dmabuf export: {}", strerror(errno));
+        return false;
+    }
+
+    auto ptr = mmap(NULL, buf.length(), PROT_READ | PROT_WRITE, MAP_SHARED, expbuf.fd, 0);
+    if (ptr == MAP_FAILED)
+    {
+        SPDLOG_INFO("Exported dmabufs of the device can not be mapped: {}", strerror(errno));
+        close(expbuf.fd);
+        return false;
+    }
+    munmap(ptr, buf.length());
+    // the buffer is released with the fd, before the probe frees the mmap buffers
+    close(expbuf.fd);
+    return true;
+}
+
 } // namespace
 
 
+tcam::V4L2Allocator::V4L2Allocator(int fd, uint32_t buf_type)
+    : fd_(fcntl(fd, F_DUPFD_CLOEXEC, 0)), buf_type_(buf_type)
+{
+    if (fd_ == -1)
+    {
+        SPDLOG_ERROR("Unable to duplicate device fd: {}", strerror(errno));
+    }
+    query_supported_memory_types();
+}
+
+
+tcam::V4L2Allocator::~V4L2Allocator()
+{
+    if (fd_ != -1)
+    {
+        close(fd_);
+    }
+}
+
+
 void tcam::V4L2Allocator::query_supported_memory_types()
 {
     memory_types_.clear();
 
     struct v4l2_requestbuffers req = {};
 
-    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.type = buf_type_;
     req.count = 1;
     req.memory = V4L2_MEMORY_USERPTR;
 
@@ -73,9 +130,11 @@ void tcam::V4L2Allocator::query_supported_memory_types()
     req.count = 1;
     req.memory = V4L2_MEMORY_MMAP;
 
+    bool can_export = false;
     if (reqbufs(fd_, req, "mmap"))
     {
         memory_types_.push_back(TCAM_MEMORY_TYPE_MMAP);
+        can_export = can_export_dmabuf(fd_, buf_type_);
         req.count = 0;
         tcam_xioctl(fd_, VIDIOC_REQBUFS, &req);
     }
@@ -85,9 +144,12 @@ void tcam::V4L2Allocator::query_supported_memory_types()
 
     if (reqbufs(fd_, req, "DMA"))
     {
-        //memory_types_.push_back(TCAM_MEMORY_TYPE_DMA);
-        //memory_types_.push_back(TCAM_MEMORY_TYPE_DMA_IMPORT);
-        // TODO: implement dma support
+        // export works on top of driver allocated mmap buffers, io-mode=auto then uses mmap
+        if (can_export)
+        {
+            memory_types_.push_back(TCAM_MEMORY_TYPE_DMA);
+        }
+        memory_types_.push_back(TCAM_MEMORY_TYPE_DMA_IMPORT);
         req.count = 0;
         tcam_xioctl(fd_, VIDIOC_REQBUFS, &req);
     }
@@ -133,7 +195,7 @@ std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_mmap(size_t length,
     struct v4l2_requestbuffers req = {};
 
     req.count = buffer_count;
-    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.type = buf_type_;
     req.memory = V4L2_MEMORY_MMAP;
 
     if (-1 == tcam_xioctl(fd_, VIDIOC_REQBUFS, &req))
@@ -150,11 +212,15 @@ std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_mmap(size_t length,
 
     for (unsigned int n_buffers = 0; n_buffers < buffer_count; ++n_buffers)
     {
-        struct v4l2_buffer buf = {};
+        v4l2::capture_buffer buf(buf_type_, V4L2_MEMORY_MMAP, n_buffers);
 
-        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_MMAP;
-        buf.index = n_buffers;
+        // every buffer has its own offset
+        if (tcam_xioctl(fd_, VIDIOC_QUERYBUF, &buf.buf) == -1)
+        {
+            SPDLOG_ERROR("VIDIOC_QUERYBUF failed for buffer {}: {}", n_buffers, strerror(errno));
+            continue;
+        }
+        buffer_size = std::max<size_t>(length, buf.length());
 
         auto ptr =
             (unsigned char*)mmap(NULL,
@@ -162,7 +228,7 @@ std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_mmap(size_t length,
                                  PROT_READ | PROT_WRITE, /* required */
                                  MAP_SHARED, /* recommended */
                                  fd_,
-                                 buf.m.offset);
+                                 buf.mem_offset());
 
         if (ptr == MAP_FAILED)
         {
@@ -171,7 +237,8 @@ std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_mmap(size_t length,
         }
 
         SPDLOG_TRACE("New mmap buffer {} {}", n_buffers, fmt::ptr(ptr));
-        buffers.push_back(std::make_shared<Memory>(shared_from_this(), TCAM_MEMORY_TYPE_MMAP, length, ptr));
+        buffers.push_back(std::make_shared<Memory>(shared_from_this(), TCAM_MEMORY_TYPE_MMAP, buffer_size, ptr));
+        driver_buffer_count_++;
 
         // TODO: find way to ensure fourcc is correctly handled
 
@@ -194,64 +261,87 @@ std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_mmap(size_t length,
 }
 
 
-std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_dma(size_t /*length*/,
-                                                                 int fd,
+std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_dma(size_t length,
                                                                  size_t buffer_count)
 {
-    struct v4l2_requestbuffers rqbufs = {};
-    rqbufs.count = buffer_count;
-    rqbufs.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    rqbufs.memory = V4L2_MEMORY_DMABUF;
-
-    if (tcam_xioctl(fd_, VIDIOC_REQBUFS, &rqbufs) == -1)
+    if (buffer_count < 2)
     {
-        if (EINVAL == errno)
-        {
-            fprintf(stderr,
-                    "does not support "
-                    "dma\n");
-            exit(EXIT_FAILURE);
-        }
-        else
-        {
-            SPDLOG_ERROR("VIDIOC_REQBUFS");
-        }
+        SPDLOG_ERROR("Insufficient buffer memory for dma");
+        return {};
     }
 
-    struct v4l2_exportbuffer expbuf;
+    // exported buffers are regular driver buffers
+    // they are queued/dequeued as V4L2_MEMORY_MMAP
+    struct v4l2_requestbuffers req = {};
+
+    req.count = buffer_count;
+    req.type = buf_type_;
+    req.memory = V4L2_MEMORY_MMAP;
 
-    memset(&expbuf, 0, sizeof(expbuf));
-    expbuf.type = rqbufs.type;
-    expbuf.index = 0;// index;
-    if (tcam_xioctl(fd_, VIDIOC_EXPBUF, &expbuf) == -1)
+    if (!reqbufs(fd_, req, "dma export"))
     {
-        perror("VIDIOC_EXPBUF");
-        //return -1;
+        return {};
     }
 
-    //int dmafd = expbuf.fd;
+    if (req.count != buffer_count)
+    {
+        SPDLOG_ERROR("Can only allocate {} dma buffer. Aborting.", req.count);
+        return {};
+    }
 
-    // this is queueing
+    std::vector<std::shared_ptr<Memory>> buffers;
+    buffers.reserve(buffer_count);
 
     for (unsigned int i = 0; i < buffer_count; ++i)
     {
-        struct v4l2_buffer buf = {};
+        struct v4l2_exportbuffer expbuf = {};
+
+        expbuf.type = buf_type_;
+        expbuf.index = i;
+        expbuf.flags = O_RDWR | O_CLOEXEC;
+
+        if (tcam_xioctl(fd_, VIDIOC_EXPBUF, &expbuf) == -1)
+        {
+            SPDLOG_ERROR("VIDIOC_EXPBUF failed for buffer {}: {}", i, strerror(errno));
+            return {};
+        }
 
-        buf.index = i;
-        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_DMABUF;
-        //buf.m.fd = buffer[i].dbuf_fd;
-        buf.m.fd = fd;
+        // map for cpu access, e.g. software properties
+        auto ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, expbuf.fd, 0);
 
-        if (tcam_xioctl(fd_, VIDIOC_QBUF, &buf) == -1)
+        if (ptr == MAP_FAILED)
         {
-            // TODO: error handling
+            SPDLOG_ERROR("mmap of dmabuf {} failed: {}", i, strerror(errno));
+            close(expbuf.fd);
+            return {};
         }
+
+        SPDLOG_TRACE("New dma buffer {} fd: {} {}", i, expbuf.fd, fmt::ptr(ptr));
+        buffers.push_back(std::make_shared<Memory>(
+            shared_from_this(), TCAM_MEMORY_TYPE_DMA, length, ptr, expbuf.fd));
+        driver_buffer_count_++;
     }
 
+    return buffers;
+}
 
 
-    return {};
+void* V4L2Allocator::map_dma_import(size_t length, int fd)
+{
+    if (fd < 0)
+    {
+        SPDLOG_ERROR("Invalid dmabuf fd for import.");
+        return nullptr;
+    }
+
+    auto ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (ptr == MAP_FAILED)
+    {
+        SPDLOG_ERROR("mmap of imported dmabuf failed: {}", strerror(errno));
+        return nullptr;
+    }
+    return ptr;
 }
 
 
@@ -285,24 +375,63 @@ void tcam::V4L2Allocator::free_mmap(void* ptr, size_t length)
 }
 
 
-void tcam::V4L2Allocator::free_dma(std::vector<std::shared_ptr<ImageBuffer>> /*buffer_collection*/)
+void tcam::V4L2Allocator::free_dma(void* ptr, size_t length, int fd)
+{
+    free_mmap(ptr, length);
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+}
+
+
+void tcam::V4L2Allocator::release_driver_buffer()
+{
+    if (driver_buffer_count_ == 0 || --driver_buffer_count_ > 0)
+    {
+        return;
+    }
+
+    // the driver refuses REQBUFS(0) while its buffers are mapped or exported,
+    // the BufferPool may keep them across streams, so they are released with the last mapping
+    struct v4l2_requestbuffers req = {};
+    req.count = 0;
+    req.type = buf_type_;
+    req.memory = V4L2_MEMORY_MMAP;
+
+    if (tcam_xioctl(fd_, VIDIOC_REQBUFS, &req) == -1)
+    {
+        SPDLOG_DEBUG("Unable to release driver buffers: {}", strerror(errno));
+    }
+}
+
+
+size_t tcam::V4L2Allocator::get_buffer_length(size_t image_size) const
 {
+    v4l2::capture_layout layout;
+    if (!v4l2::get_capture_layout(fd_, buf_type_, layout))
+    {
+        return image_size;
+    }
+    return std::max<size_t>(image_size, layout.sizeimage);
 }
 
 
-void* tcam::V4L2Allocator::allocate(TCAM_MEMORY_TYPE /*type*/,
-                                    size_t /*length*/,
-                                    int // fd
-    )
+void* tcam::V4L2Allocator::allocate(TCAM_MEMORY_TYPE type, size_t length, int fd)
 {
+    if (type == TCAM_MEMORY_TYPE_DMA_IMPORT)
+    {
+        return map_dma_import(length, fd);
+    }
 
     return nullptr;
 }
 
 
-void tcam::V4L2Allocator::free(TCAM_MEMORY_TYPE type, void* ptr, size_t length, int /*fd*/)
+void tcam::V4L2Allocator::free(TCAM_MEMORY_TYPE type, void* ptr, size_t length, int fd)
 {
-    switch(type)
+    switch (type)
     {
         case TCAM_MEMORY_TYPE_USERPTR:
         {
@@ -312,16 +441,19 @@ void tcam::V4L2Allocator::free(TCAM_MEMORY_TYPE type, void* ptr, size_t length,
         case TCAM_MEMORY_TYPE_MMAP:
         {
             free_mmap(ptr, length);
+            release_driver_buffer();
             break;
         }
         case TCAM_MEMORY_TYPE_DMA:
         {
-            //free_dma(std::vector<std::shared_ptr<ImageBuffer>>)
+            free_dma(ptr, length, fd);
+            release_driver_buffer();
             break;
         }
         case TCAM_MEMORY_TYPE_DMA_IMPORT:
         {
-            SPDLOG_ERROR("Explicitely not supported");
+            // the fd belongs to the exporter, only remove our mapping
+            free_mmap(ptr, length);
             break;
         }
     }
@@ -329,7 +461,7 @@ void tcam::V4L2Allocator::free(TCAM_MEMORY_TYPE type, void* ptr, size_t length,
 
 
 std::vector<std::shared_ptr<Memory>> tcam::V4L2Allocator::allocate(
-    size_t buffer_count, TCAM_MEMORY_TYPE type, size_t length, int fd)
+    size_t buffer_count, TCAM_MEMORY_TYPE type, size_t length, int /*fd*/)
 {
 
     switch (type)
@@ -344,11 +476,11 @@ std::vector<std::shared_ptr<Memory>> tcam::V4L2Allocator::allocate(
         }
         case TCAM_MEMORY_TYPE_DMA:
         {
-            return allocate_dma(length, buffer_count, fd);
+            return allocate_dma(length, buffer_count);
         }
         case TCAM_MEMORY_TYPE_DMA_IMPORT:
         {
-            SPDLOG_ERROR("Nothing to allocate. External memory");
+            SPDLOG_ERROR("Nothing to allocate. Use BufferPool::set_external_memory.");
             return {};
         }
     }
@@ -18,6 +18,7 @@
 
 #include "../Allocator.h"
 
+#include <atomic>
 #include <cstdio> // size_t
 #include <memory>
 
@@ -29,29 +30,36 @@ class V4L2Allocator : public AllocatorInterface, public std::enable_shared_from_
 
 private:
     int fd_ = -1;
+    uint32_t buf_type_;
     std::vector<TCAM_MEMORY_TYPE> memory_types_;
 
+    // mapped mmap/dma buffers, the driver buffers are released with the last one
+    std::atomic<size_t> driver_buffer_count_ = 0;
+
     void query_supported_memory_types();
 
+    void release_driver_buffer();
+
     std::vector<std::shared_ptr<Memory>> allocate_userptr(size_t length, size_t buffer_count);
 
     std::vector<std::shared_ptr<Memory>> allocate_mmap(size_t length, size_t buffer_count);
 
-    std::vector<std::shared_ptr<Memory>> allocate_dma(
-        size_t length, int fd, size_t buffer_count);
+    // allocates driver buffers and exports them as dmabuf fds
+    std::vector<std::shared_ptr<Memory>> allocate_dma(size_t length, size_t buffer_count);
+
+    // maps an imported dmabuf fd for cpu access
+    void* map_dma_import(size_t length, int fd);
 
     void free_userptr(void*);
 
     void free_mmap(void*, size_t);
 
-    void free_dma(std::vector<std::shared_ptr<ImageBuffer>> buffer_collection);
+    void free_dma(void*, size_t, int fd);
 
 public:
-    explicit V4L2Allocator(int fd)
-        : fd_(fd)
-    {
-        query_supported_memory_types();
-    }
+    // fd is duplicated, the memory may outlive the device that created the allocator
+    V4L2Allocator(int fd, uint32_t buf_type);
+    ~V4L2Allocator();
 
     std::vector<TCAM_MEMORY_TYPE> get_supported_memory_types() const final
     {
@@ -64,6 +72,9 @@ public:
 
     std::vector<std::shared_ptr<Memory>> allocate(
         size_t buffer_count, TCAM_MEMORY_TYPE, size_t, int fd = 0) final;
+
+    // the driver may pad lines, its sizeimage is what it needs per buffer
+    size_t get_buffer_length(size_t image_size) const final;
 };
 
 
@@ -118,6 +118,7 @@ void tcam::V4l2Device::generate_properties(const std::vector<v4l2_queryctrl>& qc
             else
             {
                 m_properties.push_back( prop_ptr );
+                m_control_names[qctrl.id] = std::string(prop_ptr->get_name());
             }
         }
     }
@@ -176,7 +177,8 @@ bool tcam::V4l2Device::load_extension_unit()
         return false;
     }
 
-    auto mappings = tcam::uvc::load_description_file(extension_file, message_cb);
+    // uses the mapping cache next to the description file when it is up to date
+    auto mappings = tcam::uvc::load_mapping_file(extension_file, message_cb);
     if (mappings.empty())
     {
         SPDLOG_WARN("Unable to load uvc extension file");
@@ -190,35 +192,30 @@ bool tcam::V4l2Device::load_extension_unit()
 
 void tcam::V4l2Device::create_properties()
 {
-    bool extension_unit_exists = extension_unit_is_loaded();
+    // one enumeration pass serves the extension unit check and the property generation
+    auto qctrl_av = tcam::v4l2::query_controls(m_fd);
 
-    if (!extension_unit_exists)
+    if (!extension_unit_is_loaded(qctrl_av))
     {
-        extension_unit_exists = load_extension_unit();
-    }
-
-    if (!extension_unit_exists)
-    {
-        SPDLOG_WARN(
-            "The property extension unit does not exist. Not all properties will be accessible.");
-    }
-
-    v4l2_queryctrl qctrl = {};
-    qctrl.id = V4L2_CTRL_FLAG_NEXT_CTRL;
-
-    std::vector<v4l2_queryctrl> qctrl_av;
-
-    while (tcam::tcam_xioctl(this->m_fd, VIDIOC_QUERYCTRL, &qctrl) == 0)
-    {
-        // ignore unnecessary control descriptions such as control "groups"
-        if (!(qctrl.flags & V4L2_CTRL_FLAG_DISABLED) && qctrl.type != V4L2_CTRL_TYPE_CTRL_CLASS)
+        if (load_extension_unit())
+        {
+            // the mappings added the controls of the extension unit
+            qctrl_av = tcam::v4l2::query_controls(m_fd);
+        }
+        else
         {
-            qctrl_av.push_back(qctrl);
+            SPDLOG_WARN("The property extension unit does not exist. Not all properties will be "
+                        "accessible.");
         }
-        qctrl.id |= V4L2_CTRL_FLAG_NEXT_CTRL;
     }
 
+    p_property_backend->register_controls(qctrl_av);
+
     generate_properties(qctrl_av);
+
+    // the menus are fetched on first use, devices of the same model share them
+    m_format_index_key = get_format_index_key();
+    p_property_backend->set_menu_cache_key(m_format_index_key);
 }
 
 void tcam::V4l2Device::create_videoformat_dependent_properties()
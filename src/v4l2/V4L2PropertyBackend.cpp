@@ -19,10 +19,114 @@
 #include "../logging.h"
 #include "../utils.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <limits>
 #include <linux/videodev2.h>
 
 
-tcam::v4l2::V4L2PropertyBackend::V4L2PropertyBackend(int fd) : p_fd(fd) {}
+namespace
+{
+
+bool is_cacheable_type(uint32_t type) noexcept
+{
+    switch (type)
+    {
+        case V4L2_CTRL_TYPE_INTEGER:
+        case V4L2_CTRL_TYPE_BOOLEAN:
+        case V4L2_CTRL_TYPE_MENU:
+        case V4L2_CTRL_TYPE_INTEGER_MENU:
+        case V4L2_CTRL_TYPE_INTEGER64:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void set_which_cur_val(v4l2_ext_controls& ctrls) noexcept
+{
+#if defined(V4L2_CTRL_WHICH_CUR_VAL)
+    ctrls.which = V4L2_CTRL_WHICH_CUR_VAL;
+#else
+    ctrls.ctrl_class = 0; // any class, older kernels use the same value
+#endif
+}
+
+bool is_listed_control(const v4l2_queryctrl& qctrl) noexcept
+{
+    // ignore unnecessary control descriptions such as control "groups"
+    return !(qctrl.flags & V4L2_CTRL_FLAG_DISABLED) && qctrl.type != V4L2_CTRL_TYPE_CTRL_CLASS;
+}
+
+int32_t clamp_to_int32(int64_t val) noexcept
+{
+    return static_cast<int32_t>(std::clamp<int64_t>(val,
+                                                    std::numeric_limits<int32_t>::min(),
+                                                    std::numeric_limits<int32_t>::max()));
+}
+
+v4l2_queryctrl to_queryctrl(const v4l2_query_ext_ctrl& qext) noexcept
+{
+    v4l2_queryctrl qctrl = {};
+    qctrl.id = qext.id;
+    qctrl.type = qext.type;
+    static_assert(sizeof(qctrl.name) == sizeof(qext.name));
+    std::copy(std::begin(qext.name), std::end(qext.name), std::begin(qctrl.name));
+    qctrl.minimum = clamp_to_int32(qext.minimum);
+    qctrl.maximum = clamp_to_int32(qext.maximum);
+    qctrl.step = clamp_to_int32(static_cast<int64_t>(
+        std::min<uint64_t>(qext.step, std::numeric_limits<int32_t>::max())));
+    qctrl.default_value = clamp_to_int32(qext.default_value);
+    qctrl.flags = qext.flags;
+    return qctrl;
+}
+
+} // namespace
+
+
+tcam::v4l2::v4l2_queryctrl_list tcam::v4l2::query_controls(int fd)
+{
+    v4l2_queryctrl_list rval;
+
+    v4l2_query_ext_ctrl qext = {};
+    qext.id = V4L2_CTRL_FLAG_NEXT_CTRL;
+
+    while (tcam::tcam_xioctl(fd, VIDIOC_QUERY_EXT_CTRL, &qext) == 0)
+    {
+        auto qctrl = to_queryctrl(qext);
+        if (is_listed_control(qctrl))
+        {
+            rval.push_back(qctrl);
+        }
+        qext.id |= V4L2_CTRL_FLAG_NEXT_CTRL;
+    }
+
+    // the loop always ends with a failing ioctl, EINVAL marks the last control
+    if (!rval.empty() || errno != ENOTTY)
+    {
+        return rval;
+    }
+
+    v4l2_queryctrl qctrl = {};
+    qctrl.id = V4L2_CTRL_FLAG_NEXT_CTRL;
+
+    while (tcam::tcam_xioctl(fd, VIDIOC_QUERYCTRL, &qctrl) == 0)
+    {
+        if (is_listed_control(qctrl))
+        {
+            rval.push_back(qctrl);
+        }
+        qctrl.id |= V4L2_CTRL_FLAG_NEXT_CTRL;
+    }
+    return rval;
+}
+
+
+tcam::v4l2::V4L2PropertyBackend::V4L2PropertyBackend(int fd)
+    : p_fd(fd),
+      p_cache_ttl(tcam::get_environment_variable_int("TCAM_V4L2_PROPERTY_CACHE_MS").value_or(100))
+{
+}
 
 
 static outcome::result<int64_t> v4l2_control_ioctl(int fd, unsigned int request, v4l2_control* ctrl)
@@ -67,16 +171,62 @@ static outcome::result<int64_t> v4l2_control_ioctl(int fd, unsigned int request,
 outcome::result<int64_t> tcam::v4l2::V4L2PropertyBackend::write_control(int v4l2_id,
                                                                             int new_value)
 {
+    {
+        std::scoped_lock lck { p_batch_mtx };
+        if (p_batch_active && p_batch_thread == std::this_thread::get_id())
+        {
+            auto iter = std::find_if(
+                p_batch.begin(), p_batch.end(), [v4l2_id](auto& v) { return v.v4l2_id == v4l2_id; });
+            if (iter != p_batch.end())
+            {
+                iter->value = new_value;
+            }
+            else
+            {
+                p_batch.push_back({ v4l2_id, new_value });
+            }
+            return new_value;
+        }
+    }
+
     struct v4l2_control ctrl = {};
     ctrl.id = v4l2_id;
     ctrl.value = new_value;
 
-    return v4l2_control_ioctl(p_fd, VIDIOC_S_CTRL, &ctrl);
+    auto res = v4l2_control_ioctl(p_fd, VIDIOC_S_CTRL, &ctrl);
+
+    // writes may also change other controls, e.g. the auto variants
+    invalidate_cache();
+
+    return res;
 }
 
 
 outcome::result<int64_t> tcam::v4l2::V4L2PropertyBackend::read_control(int v4l2_id)
 {
+    {
+        std::scoped_lock lck { p_cache_mtx };
+
+        if (p_cache_ttl.count() > 0 && p_cacheable_types.count(v4l2_id))
+        {
+            if (!p_snapshot_valid
+                || std::chrono::steady_clock::now() - p_snapshot_time > p_cache_ttl)
+            {
+                // on failure the control is read on its own below
+                (void)refresh_snapshot();
+            }
+
+            if (p_snapshot_valid)
+            {
+                auto iter = p_snapshot.find(v4l2_id);
+                if (iter != p_snapshot.end())
+                {
+                    return iter->second;
+                }
+            }
+        }
+    }
+
     struct v4l2_control ctrl = {};
     ctrl.id = v4l2_id;
 
@@ -84,9 +234,298 @@ outcome::result<int64_t> tcam::v4l2::V4L2PropertyBackend::read_control(int v4l2_
 }
 
 
+outcome::result<void> tcam::v4l2::V4L2PropertyBackend::write_controls(
+    const std::vector<control_value>& values)
+{
+    if (values.empty())
+    {
+        return outcome::success();
+    }
+
+    std::vector<v4l2_ext_control> ext(values.size());
+    {
+        std::scoped_lock lck { p_cache_mtx };
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            ext[i].id = values[i].v4l2_id;
+
+            auto iter = p_cacheable_types.find(values[i].v4l2_id);
+            if (iter != p_cacheable_types.end() && iter->second == V4L2_CTRL_TYPE_INTEGER64)
+            {
+                ext[i].value64 = values[i].value;
+            }
+            else
+            {
+                ext[i].value = static_cast<int32_t>(values[i].value);
+            }
+        }
+    }
+
+    v4l2_ext_controls ctrls = {};
+    set_which_cur_val(ctrls);
+    ctrls.count = ext.size();
+    ctrls.controls = ext.data();
+
+    if (tcam::tcam_xioctl(p_fd, VIDIOC_S_EXT_CTRLS, &ctrls) == 0)
+    {
+        invalidate_cache();
+        return outcome::success();
+    }
+
+    SPDLOG_DEBUG("VIDIOC_S_EXT_CTRLS failed at index {}: {}. Writing controls one by one.",
+                 ctrls.error_idx,
+                 strerror(errno));
+
+    for (const auto& v : values)
+    {
+        OUTCOME_TRY(write_control(v.v4l2_id, static_cast<int>(v.value)));
+    }
+    return outcome::success();
+}
+
+
+outcome::result<void> tcam::v4l2::V4L2PropertyBackend::read_controls(
+    std::vector<control_value>& values)
+{
+    if (values.empty())
+    {
+        return outcome::success();
+    }
+
+    std::vector<v4l2_ext_control> ext(values.size());
+    for (size_t i = 0; i < values.size(); ++i) { ext[i].id = values[i].v4l2_id; }
+
+    v4l2_ext_controls ctrls = {};
+    set_which_cur_val(ctrls);
+    ctrls.count = ext.size();
+    ctrls.controls = ext.data();
+
+    if (tcam::tcam_xioctl(p_fd, VIDIOC_G_EXT_CTRLS, &ctrls) == 0)
+    {
+        std::scoped_lock lck { p_cache_mtx };
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            auto iter = p_cacheable_types.find(values[i].v4l2_id);
+            if (iter != p_cacheable_types.end() && iter->second == V4L2_CTRL_TYPE_INTEGER64)
+            {
+                values[i].value = ext[i].value64;
+            }
+            else
+            {
+                values[i].value = ext[i].value;
+            }
+        }
+        return outcome::success();
+    }
+
+    SPDLOG_DEBUG("VIDIOC_G_EXT_CTRLS failed at index {}: {}. Reading controls one by one.",
+                 ctrls.error_idx,
+                 strerror(errno));
+
+    for (auto& v : values)
+    {
+        struct v4l2_control ctrl = {};
+        ctrl.id = v.v4l2_id;
+
+        OUTCOME_TRY(v.value, v4l2_control_ioctl(p_fd, VIDIOC_G_CTRL, &ctrl));
+    }
+    return outcome::success();
+}
+
+
+void tcam::v4l2::V4L2PropertyBackend::register_controls(
+    const std::vector<v4l2_queryctrl>& qctrl_list)
+{
+    std::scoped_lock lck { p_cache_mtx };
+
+    bool events_supported = true;
+    for (const auto& qctrl : qctrl_list)
+    {
+        if (!is_cacheable_type(qctrl.type)
+            || (qctrl.flags & (V4L2_CTRL_FLAG_WRITE_ONLY | V4L2_CTRL_FLAG_VOLATILE)))
+        {
+            continue;
+        }
+
+        p_cacheable_types[qctrl.id] = qctrl.type;
+
+        if (!events_supported)
+        {
+            continue;
+        }
+
+        // without V4L2_EVENT_SUB_FL_ALLOW_FEEDBACK only changes made through other file handles
+        // are reported, our own writes invalidate the cache directly
+        v4l2_event_subscription sub = {};
+        sub.type = V4L2_EVENT_CTRL;
+        sub.id = qctrl.id;
+
+        if (tcam::tcam_xioctl(p_fd, VIDIOC_SUBSCRIBE_EVENT, &sub) != 0)
+        {
+            // changes from other processes are then only seen after the cache expires
+            SPDLOG_DEBUG("Unable to subscribe to control events: {}", strerror(errno));
+            events_supported = false;
+        }
+    }
+
+    p_snapshot_valid = false;
+}
+
+
+void tcam::v4l2::V4L2PropertyBackend::invalidate_cache()
+{
+    std::scoped_lock lck { p_cache_mtx };
+    p_snapshot_valid = false;
+}
+
+
+void tcam::v4l2::V4L2PropertyBackend::handle_control_events()
+{
+    std::vector<int> changed_ids;
+
+    v4l2_event ev = {};
+    while (tcam::tcam_xioctl(p_fd, VIDIOC_DQEVENT, &ev) == 0)
+    {
+        if (ev.type == V4L2_EVENT_CTRL
+            && (ev.u.ctrl.changes & (V4L2_EVENT_CTRL_CH_VALUE | V4L2_EVENT_CTRL_CH_FLAGS)))
+        {
+            changed_ids.push_back(static_cast<int>(ev.id));
+        }
+        ev = {};
+    }
+
+    if (changed_ids.empty())
+    {
+        return;
+    }
+
+    std::function<void(int)> cb;
+    {
+        std::scoped_lock lck { p_cache_mtx };
+        p_snapshot_valid = false;
+        cb = p_control_changed_cb;
+    }
+
+    if (cb)
+    {
+        for (auto id : changed_ids) { cb(id); }
+    }
+}
+
+
+void tcam::v4l2::V4L2PropertyBackend::set_control_changed_callback(
+    std::function<void(int v4l2_id)> cb)
+{
+    std::scoped_lock lck { p_cache_mtx };
+    p_control_changed_cb = std::move(cb);
+}
+
+
+void tcam::v4l2::V4L2PropertyBackend::begin_writes()
+{
+    std::scoped_lock lck { p_batch_mtx };
+    if (p_batch_active)
+    {
+        SPDLOG_WARN("A write batch is already active.");
+        return;
+    }
+    p_batch_active = true;
+    p_batch_thread = std::this_thread::get_id();
+}
+
+
+outcome::result<void> tcam::v4l2::V4L2PropertyBackend::commit_writes()
+{
+    std::vector<control_value> batch;
+    {
+        std::scoped_lock lck { p_batch_mtx };
+        if (!p_batch_active || p_batch_thread != std::this_thread::get_id())
+        {
+            return outcome::success();
+        }
+        batch.swap(p_batch);
+        p_batch_active = false;
+    }
+
+    return write_controls(batch);
+}
+
+
+outcome::result<void> tcam::v4l2::V4L2PropertyBackend::refresh_snapshot()
+{
+    p_snapshot_valid = false;
+
+    if (!p_batch_read_supported || p_cacheable_types.empty())
+    {
+        return tcam::status::UndefinedError;
+    }
+
+    std::vector<v4l2_ext_control> ext;
+    ext.reserve(p_cacheable_types.size());
+    for (const auto& [id, type] : p_cacheable_types)
+    {
+        v4l2_ext_control c = {};
+        c.id = id;
+        ext.push_back(c);
+    }
+
+    v4l2_ext_controls ctrls = {};
+    set_which_cur_val(ctrls);
+    ctrls.count = ext.size();
+    ctrls.controls = ext.data();
+
+    if (tcam::tcam_xioctl(p_fd, VIDIOC_G_EXT_CTRLS, &ctrls) != 0)
+    {
+        // do not retry on every read, single reads still work
+        SPDLOG_DEBUG("VIDIOC_G_EXT_CTRLS failed for id {:#x}: {}. Disabling the property cache.",
+                     ctrls.error_idx < ext.size() ? ext[ctrls.error_idx].id : 0,
+                     strerror(errno));
+        p_batch_read_supported = false;
+        return tcam::status::UndefinedError;
+    }
+
+    p_snapshot.clear();
+    for (const auto& c : ext)
+    {
+        if (p_cacheable_types[c.id] == V4L2_CTRL_TYPE_INTEGER64)
+        {
+            p_snapshot[c.id] = c.value64;
+        }
+        else
+        {
+            p_snapshot[c.id] = c.value;
+        }
+    }
+    p_snapshot_time = std::chrono::steady_clock::now();
+    p_snapshot_valid = true;
+
+    return outcome::success();
+}
+
+
+void tcam::v4l2::V4L2PropertyBackend::set_menu_cache_key(const std::string& key)
+{
+    p_menu_cache_key = key;
+}
+
+
 auto tcam::v4l2::V4L2PropertyBackend::get_menu_entries(int v4l2_id, int max)
     -> std::vector<tcam::v4l2::menu_entry>
 {
+    static std::mutex cache_mtx;
+    static std::map<std::pair<std::string, int>, std::vector<tcam::v4l2::menu_entry>> cache;
+
+    const auto key = std::make_pair(p_menu_cache_key, v4l2_id);
+    if (!p_menu_cache_key.empty())
+    {
+        std::scoped_lock lck { cache_mtx };
+        auto iter = cache.find(key);
+        if (iter != cache.end())
+        {
+            return iter->second;
+        }
+    }
+
     std::vector<tcam::v4l2::menu_entry> rval;
     for (int i = 0; i <= max; i++)
     {
@@ -99,5 +538,11 @@ auto tcam::v4l2::V4L2PropertyBackend::get_menu_entries(int v4l2_id, int max)
         }
         rval.push_back({ i, std::string((char*)qmenu.name) });
     }
+
+    if (!p_menu_cache_key.empty())
+    {
+        std::scoped_lock lck { cache_mtx };
+        cache[key] = rval;
+    }
     return rval;
 }
@@ -16,15 +16,40 @@
 
 #pragma once
 
+#include "../PropertyInterfaces.h"
 #include "../error.h"
 #include "v4l2_genicam_conversion.h"
 
+#include <chrono>
+#include <functional>
+#include <linux/videodev2.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace tcam::v4l2
 {
 
-class V4L2PropertyBackend
+// All controls of the device with one VIDIOC_QUERY_EXT_CTRL pass, disabled controls and control
+// classes are skipped. The 64 bit ranges are clamped to v4l2_queryctrl.
+// Falls back to VIDIOC_QUERYCTRL on kernels without VIDIOC_QUERY_EXT_CTRL.
+v4l2_queryctrl_list query_controls(int fd);
+
+struct control_value
+{
+    int v4l2_id = 0;
+    int64_t value = 0;
+};
+
+//
+// Reads of registered controls are served from a snapshot that is fetched with a single
+// VIDIOC_G_EXT_CTRLS. The snapshot is dropped after TCAM_V4L2_PROPERTY_CACHE_MS, on every write,
+// on format changes and when a control event reports a change made by someone else.
+// Volatile controls (e.g. ExposureTime while ExposureAuto is active) are always read directly.
+//
+class V4L2PropertyBackend : public tcam::property::IPropertyWriteBatch
 {
 public:
     explicit V4L2PropertyBackend(int fd);
@@ -33,9 +58,56 @@ public:
 
     outcome::result<int64_t> read_control(int v4l2_id);
 
+    // Writes all values with one VIDIOC_S_EXT_CTRLS.
+    // Falls back to single writes in the given order when the driver rejects the batch.
+    outcome::result<void> write_controls(const std::vector<control_value>& values);
+
+    // Fills in the value of every entry with one VIDIOC_G_EXT_CTRLS.
+    outcome::result<void> read_controls(std::vector<control_value>& values);
+
+    // The entries are shared by all devices with the same menu cache key.
     std::vector<tcam::v4l2::menu_entry> get_menu_entries(int v4l2_id, int max);
+
+    // Identifies model, firmware and extension unit of the device, empty disables the cache.
+    // Has to be set before the first call to get_menu_entries.
+    void set_menu_cache_key(const std::string& key);
+
+    // Makes the controls eligible for the snapshot and subscribes to their change events.
+    void register_controls(const std::vector<v4l2_queryctrl>& qctrl_list);
+
+    void invalidate_cache();
+
+    // Dequeues all pending control events. Call this when the fd signals POLLPRI.
+    void handle_control_events();
+
+    // Called from handle_control_events with the id of every control that was changed by
+    // someone else, e.g. ExposureTime while the firmware auto exposure runs.
+    void set_control_changed_callback(std::function<void(int v4l2_id)> cb);
+
+    // Collects write_control calls of the calling thread into one write_controls
+    void begin_writes() final;
+    outcome::result<void> commit_writes() final;
+
 private:
+    outcome::result<void> refresh_snapshot();
+
     int p_fd = 0;
+
+    std::mutex p_cache_mtx;
+    std::chrono::milliseconds p_cache_ttl;
+    std::map<int, uint32_t> p_cacheable_types; // v4l2 id -> V4L2_CTRL_TYPE_*
+    std::map<int, int64_t> p_snapshot;
+    std::chrono::steady_clock::time_point p_snapshot_time;
+    bool p_snapshot_valid = false;
+    bool p_batch_read_supported = true;
+    std::function<void(int)> p_control_changed_cb;
+
+    std::string p_menu_cache_key;
+
+    std::mutex p_batch_mtx;
+    bool p_batch_active = false;
+    std::thread::id p_batch_thread;
+    std::vector<control_value> p_batch;
 };
 
 } // namespace tcam::property
@@ -17,23 +17,29 @@
 #include "V4l2Device.h"
 
 #include "../logging.h"
+#include "../scaling_table.h"
+#include "../tracepoints.h"
+#include "../ThreadPolicy.h"
 #include "../utils.h"
+#include "v4l2_capture.h"
+#include "v4l2_hotplug.h"
 #include "v4l2_utils.h"
 
 #include <algorithm>
 #include <cstring> /* memcpy*/
 #include <dutils_img/fcc_to_string.h>
+#include <dutils_img/image_fourcc_func.h>
+#include <dutils_img/img_type.h>
 #include <errno.h>
 #include <fcntl.h> /* O_RDWR O_NONBLOCK */
-#include <libudev.h>
 #include <linux/videodev2.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
 #include <unistd.h>
 
 using namespace tcam;
 
-static const int lost_countdown_default = 5;
-
-
 V4l2Device::V4l2Device(const DeviceInfo& device_desc)
 {
     device = device_desc;
@@ -48,13 +54,39 @@ V4l2Device::V4l2Device(const DeviceInfo& device_desc)
         throw std::runtime_error("Failed opening device.");
     }
 
-    m_monitor_v4l2_thread = std::thread(&V4l2Device::monitor_v4l2_thread_func, this);
-
     p_property_backend = std::make_shared<tcam::v4l2::V4L2PropertyBackend>(m_fd);
 
-    allocator_ = std::make_shared<V4L2Allocator>(m_fd);
+    {
+        v4l2::hotplug_monitor::subscription sub;
+        sub.devnode = device.get_identifier();
+        sub.removed = [this]()
+        {
+            SPDLOG_ERROR("Lost device! {}", device.get_name().c_str());
+            this->lost_device();
+        };
+        sub.fd = m_fd;
+        sub.control_event = [this]() { p_property_backend->handle_control_events(); };
+
+        m_hotplug_token = v4l2::hotplug_monitor::get_instance().subscribe(std::move(sub));
+    }
+
+    m_buf_type = v4l2::query_capture_buffer_type(m_fd);
+
+    allocator_ = std::make_shared<V4L2Allocator>(m_fd, m_buf_type);
 
     this->create_properties();
+
+    // m_control_names is complete at this point and will not change afterwards
+    p_property_backend->set_control_changed_callback(
+        [this](int v4l2_id)
+        {
+            auto iter = m_control_names.find(v4l2_id);
+            if (iter != m_control_names.end())
+            {
+                property_notifier_->notify(iter->second);
+            }
+        });
+
     this->index_formats();
 
     determine_active_video_format();
@@ -70,18 +102,14 @@ V4l2Device::~V4l2Device()
         stop_stream();
     }
 
-    this->m_stop_monitor_v4l2_thread = true;
+    // the monitor polls m_fd until this returns
+    v4l2::hotplug_monitor::get_instance().unsubscribe(m_hotplug_token);
 
     if (this->m_fd != -1)
     {
         close(m_fd);
         m_fd = -1;
     }
-
-    if (m_monitor_v4l2_thread.joinable())
-    {
-        m_monitor_v4l2_thread.join();
-    }
 }
 
 
@@ -118,24 +146,27 @@ bool V4l2Device::set_video_format(const VideoFormat& new_format)
 
     // set format in camera
 
-    struct v4l2_format fmt = {};
-
-    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-
-    fmt.fmt.pix.width = new_format.get_size().width;
-    fmt.fmt.pix.height = new_format.get_size().height;
-
-    fmt.fmt.pix.pixelformat = fourcc;
-    fmt.fmt.pix.field = V4L2_FIELD_NONE;
-
-    int ret = tcam_xioctl(this->m_fd, VIDIOC_S_FMT, &fmt);
-
-    if (ret < 0)
+    v4l2::capture_layout layout;
+    if (!v4l2::set_capture_format(m_fd,
+                                  m_buf_type,
+                                  fourcc,
+                                  new_format.get_size().width,
+                                  new_format.get_size().height,
+                                  layout))
     {
         SPDLOG_ERROR("Error while setting format '{}'", strerror(errno));
         return false;
     }
 
+    if (layout.num_planes != 1)
+    {
+        SPDLOG_ERROR("Formats with {} memory planes are not supported.", layout.num_planes);
+        return false;
+    }
+
+    // controls like the framerate depend on the format
+    p_property_backend->invalidate_cache();
+
     /* framerate */
 
     if (!set_framerate(new_format.get_framerate()))
@@ -209,7 +240,7 @@ bool V4l2Device::set_framerate(double framerate)
 
     struct v4l2_streamparm parm = {};
 
-    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    parm.type = m_buf_type;
 
     parm.parm.capture.timeperframe.numerator = fps->numerator;
     parm.parm.capture.timeperframe.denominator = fps->denominator;
@@ -236,7 +267,7 @@ double V4l2Device::get_framerate()
     // - ranges are not supported by uvc
     struct v4l2_streamparm parm = {};
 
-    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    parm.type = m_buf_type;
 
     int ret = tcam_xioctl(m_fd, VIDIOC_G_PARM, &parm);
 
@@ -271,7 +302,7 @@ bool V4l2Device::initialize_buffers(std::shared_ptr<BufferPool> pool)
 
     for (unsigned int i = 0; i < b.size(); ++i)
     {
-        buffer_info info = { b.at(i), false };
+        buffer_info info = { b.at(i).lock(), false };
 
         this->m_buffers.push_back(info);
     }
@@ -287,12 +318,23 @@ bool V4l2Device::release_buffers()
         return false;
     }
 
+    // driver buffers stay allocated while the pool keeps their memory for the next stream,
+    // the V4L2Allocator releases them together with the last mapping
+    if (pool_
+        && (pool_->get_memory_type() == TCAM_MEMORY_TYPE_MMAP
+            || pool_->get_memory_type() == TCAM_MEMORY_TYPE_DMA))
+    {
+        m_buffers.clear();
+        return true;
+    }
+
     // dequeue all buffers
     struct v4l2_requestbuffers req = {};
 
     req.count = 0; // free all buffers
-    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    req.memory = V4L2_MEMORY_USERPTR;
+    req.type = m_buf_type;
+    req.memory = pool_ ? v4l2::memory_type_to_v4l2_memory(pool_->get_memory_type())
+                       : static_cast<uint32_t>(V4L2_MEMORY_USERPTR);
 
     if (-1 == tcam_xioctl(m_fd, VIDIOC_REQBUFS, &req))
     {
@@ -305,110 +347,181 @@ bool V4l2Device::release_buffers()
 }
 
 
-bool V4l2Device::queue_mmap(int i, std::shared_ptr<ImageBuffer> b)
+bool V4l2Device::queue_mmap(int i, const std::shared_ptr<ImageBuffer>& b)
 {
-    struct v4l2_buffer buf = {};
-
-    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    buf.memory = V4L2_MEMORY_MMAP;
+    v4l2::capture_buffer buf(m_buf_type, V4L2_MEMORY_MMAP, i);
 
-    buf.index = i;
-
-    int ret = tcam_xioctl(m_fd, VIDIOC_QBUF, &buf);
+    int ret = tcam_xioctl(m_fd, VIDIOC_QBUF, &buf.buf);
     if (ret == -1)
     {
         SPDLOG_ERROR("Unable to queue mmap buffer({}): {} {}", errno, strerror(errno), fmt::ptr(b->get_image_buffer_ptr()));
         return false;
     }
+    TCAM_TRACE2(v4l2_qbuf, buf.buf.index, buf.buf.memory);
 
     return true;
 }
 
 
-bool V4l2Device::queue_userptr(int i, std::shared_ptr<ImageBuffer> b)
+bool V4l2Device::queue_dma(int i, const std::shared_ptr<ImageBuffer>& b)
 {
+    v4l2::capture_buffer buf(m_buf_type, V4L2_MEMORY_DMABUF, i);
+    buf.set_dmabuf(b->get_file_descriptor(), b->get_image_buffer_size());
+
+    int ret = tcam_xioctl(m_fd, VIDIOC_QBUF, &buf.buf);
+    if (ret == -1)
+    {
+        SPDLOG_ERROR("Unable to queue dma buffer({}): {} fd: {}",
+                     errno,
+                     strerror(errno),
+                     b->get_file_descriptor());
+        return false;
+    }
+    TCAM_TRACE2(v4l2_qbuf, buf.buf.index, buf.buf.memory);
+
+    return true;
+}
+
 
-    struct v4l2_buffer buf = {};
+bool V4l2Device::queue_userptr(int i, const std::shared_ptr<ImageBuffer>& b)
+{
 
-    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    buf.memory = V4L2_MEMORY_USERPTR;
-    buf.index = i;
-    buf.m.userptr = (unsigned long)b->get_image_buffer_ptr();
-    buf.length = b->get_image_buffer_size();
+    v4l2::capture_buffer buf(m_buf_type, V4L2_MEMORY_USERPTR, i);
+    buf.set_userptr(b->get_image_buffer_ptr(), b->get_image_buffer_size());
 
     // requeue buffer
-    int ret = tcam_xioctl(m_fd, VIDIOC_QBUF, &buf);
+    int ret = tcam_xioctl(m_fd, VIDIOC_QBUF, &buf.buf);
     if (ret == -1)
     {
         SPDLOG_ERROR("Could not requeue buffer");
         return false;
     }
+    TCAM_TRACE2(v4l2_qbuf, buf.buf.index, buf.buf.memory);
     return true;
 }
 
 
 void V4l2Device::requeue_buffer(const std::shared_ptr<ImageBuffer>& buffer)
 {
+    // m_buffers is in pool slot order, the slot is also the v4l2 buffer index
+    const size_t i = buffer->get_pool_slot();
+    if (i >= m_buffers.size())
+    {
+        SPDLOG_DEBUG("Buffer not requeued. Not part of the buffer list. ptr={}.",
+                     static_cast<void*>(buffer.get()));
+        return;
+    }
 
-    for (unsigned int i = 0; i < m_buffers.size(); ++i)
+    std::scoped_lock lck { m_buffer_mtx };
+
+    auto& b = m_buffers[i];
+
+    if (b.is_queued || b.buffer != buffer)
     {
+        return;
+    }
 
-        auto& b = m_buffers.at(i);
+    b.is_queued = queue_buffer(i, buffer);
+}
 
-        auto buf_ptr = b.buffer.lock();
 
-        if (!b.is_queued && buf_ptr == buffer)
+bool V4l2Device::queue_buffer(size_t i, const std::shared_ptr<ImageBuffer>& buffer)
+{
+    switch (pool_->get_memory_type())
+    {
+        case TCAM_MEMORY_TYPE_USERPTR:
         {
-            switch (pool_->get_memory_type())
-            {
-                case TCAM_MEMORY_TYPE_USERPTR:
-                {
-                    if (queue_userptr(i, buf_ptr))
-                    {
-                        b.is_queued = true;
-                    }
-                    break;
-                }
-                case TCAM_MEMORY_TYPE_MMAP:
-                {
-                    if (queue_mmap(i, buf_ptr))
-                    {
-                        b.is_queued = true;
-                    }
-                    break;
-                }
-                case TCAM_MEMORY_TYPE_DMA:
-                case TCAM_MEMORY_TYPE_DMA_IMPORT:
-                {
-                    SPDLOG_ERROR("Queueing of DMA not implemented");
-                    break;
-                }
-            }
+            return queue_userptr(i, buffer);
+        }
+        case TCAM_MEMORY_TYPE_MMAP:
+        case TCAM_MEMORY_TYPE_DMA:
+        {
+            // exported dma buffers are driver buffers and are queued like mmap buffers
+            return queue_mmap(i, buffer);
+        }
+        case TCAM_MEMORY_TYPE_DMA_IMPORT:
+        {
+            return queue_dma(i, buffer);
         }
     }
+    return false;
 }
 
 
-void V4l2Device::update_stream_timeout()
+size_t V4l2Device::get_queued_buffer_count()
 {
+    std::scoped_lock lck { m_buffer_mtx };
+
+    return std::count_if(
+        m_buffers.begin(), m_buffers.end(), [](const buffer_info& b) { return b.is_queued; });
+}
+
+
+bool V4l2Device::restart_stream()
+{
+    std::scoped_lock lck { m_buffer_mtx };
+
+    // stop_stream holds the lock while switching the stream off
+    if (!m_is_stream_on)
+    {
+        return false;
+    }
+
+    auto type = static_cast<v4l2_buf_type>(m_buf_type);
+    if (tcam_xioctl(m_fd, VIDIOC_STREAMOFF, &type) == -1)
+    {
+        SPDLOG_ERROR("Unable to set ioctl VIDIOC_STREAMOFF {} {}", errno, strerror(errno));
+        return false;
+    }
+
+    // STREAMOFF removes all buffers from the driver queue
+    // buffers that are dequeued are owned by the sink and come back through requeue_buffer
+    for (size_t i = 0; i < m_buffers.size(); ++i)
+    {
+        auto& b = m_buffers[i];
+        if (!b.is_queued)
+        {
+            continue;
+        }
+
+        b.is_queued = b.buffer && queue_buffer(i, b.buffer);
+    }
+
+    if (m_uvc_meta.is_streaming() && !m_uvc_meta.restart())
+    {
+        SPDLOG_WARN("Unable to restart the uvc metadata stream. Images have no camera time.");
+        m_uvc_meta.stop();
+    }
+
+    if (tcam_xioctl(m_fd, VIDIOC_STREAMON, &type) == -1)
+    {
+        SPDLOG_ERROR("Unable to set ioctl VIDIOC_STREAMON {} {}", errno, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+
+v4l2::stream_watchdog::timing V4l2Device::get_stream_timing()
+{
+    v4l2::stream_watchdog::timing rval;
+
+    rval.framerate = m_active_video_format.get_framerate();
+    rval.trigger_mode = is_trigger_mode_enabled();
+
     for (const auto& p : m_properties)
     {
         if (p->get_name() == "ExposureTime")
         {
             auto val = std::dynamic_pointer_cast<tcam::property::IPropertyFloat>(p)->get_value();
-
             if (val)
             {
-                m_stream_timeout_sec = (val.value() / 1000000) + 2;
-            }
-            else
-            {
-                // TODO: implement error handling
+                rval.exposure_us = val.value();
             }
             break;
         }
     }
-    SPDLOG_DEBUG("Setting stream timeout to {}", m_stream_timeout_sec.load());
+    return rval;
 }
 
 
@@ -422,23 +535,35 @@ bool V4l2Device::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
             break;
         }
         case TCAM_MEMORY_TYPE_MMAP:
+        case TCAM_MEMORY_TYPE_DMA:
         {
             SPDLOG_DEBUG("init mmap");
             init_mmap_buffers();
             break;
         }
-        case TCAM_MEMORY_TYPE_DMA:
         case TCAM_MEMORY_TYPE_DMA_IMPORT:
         {
-            SPDLOG_ERROR("MEMORY type not implemented");
-            return false;
+            SPDLOG_DEBUG("init dma import");
+            if (!init_dma_buffers())
+            {
+                return false;
+            }
+            break;
         }
     }
 
-    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    // the metadata of a frame is only stored when a metadata buffer is queued,
+    // so the metadata node has to stream before the first image arrives
+    if (tcam::get_environment_variable_int("TCAM_V4L2_UVC_META").value_or(1) != 0)
+    {
+        m_uvc_meta.start(device.get_info().identifier, m_buffers.size());
+    }
+
+    auto type = static_cast<v4l2_buf_type>(m_buf_type);
     if (-1 == tcam_xioctl(m_fd, VIDIOC_STREAMON, &type))
     {
         SPDLOG_ERROR("Unable to set ioctl VIDIOC_STREAMON {} {}", errno, strerror(errno));
+        m_uvc_meta.stop();
         return false;
     }
 
@@ -446,9 +571,32 @@ bool V4l2Device::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
 
     m_listener = sink;
 
-    m_is_stream_on = true;
+    reset_stream_state();
+
+    if (Reactor::is_enabled())
+    {
+        m_is_stream_on = true;
+        if (!start_reactor_stream())
+        {
+            m_is_stream_on = false;
+            tcam_xioctl(m_fd, VIDIOC_STREAMOFF, &type);
+            m_uvc_meta.stop();
+            return false;
+        }
+        SPDLOG_INFO("Stream is driven by the reactor.");
+        return true;
+    }
+
+    m_stream_stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_stream_stop_fd == -1)
+    {
+        SPDLOG_ERROR("Unable to create eventfd: {}", strerror(errno));
+        tcam_xioctl(m_fd, VIDIOC_STREAMOFF, &type);
+        m_uvc_meta.stop();
+        return false;
+    }
 
-    update_stream_timeout();
+    m_is_stream_on = true;
 
     SPDLOG_INFO("Starting stream in work thread.");
 
@@ -467,24 +615,51 @@ void V4l2Device::stop_stream()
 
     SPDLOG_TRACE("Stopping stream...");
 
-    if (m_is_stream_on)
     {
-        enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        // a restart of the stream thread must not switch the stream on again
+        std::scoped_lock lck { m_buffer_mtx };
+
+        auto type = static_cast<v4l2_buf_type>(m_buf_type);
         int ret = tcam_xioctl(m_fd, VIDIOC_STREAMOFF, &type);
 
         if (ret < 0)
         {
             SPDLOG_ERROR("Unable to set ioctl VIDIOC_STREAMOFF {}", errno);
         }
-    }
 
-    m_is_stream_on = false;
+        m_is_stream_on = false;
+    }
 
-    if (m_work_thread.joinable())
+    if (m_strand)
+    {
+        // waits for handlers that are already running
+        Reactor::get_instance().remove(m_stream_fd_handle);
+        Reactor::get_instance().remove(m_stream_timer_handle);
+        m_stream_fd_handle = 0;
+        m_stream_timer_handle = 0;
+        m_strand.reset();
+    }
+    else
     {
-        m_work_thread.join();
+        // wake the work thread
+        uint64_t val = 1;
+        if (write(m_stream_stop_fd, &val, sizeof(val)) != sizeof(val))
+        {
+            SPDLOG_ERROR("Unable to signal work thread: {}", strerror(errno));
+        }
+
+        if (m_work_thread.joinable())
+        {
+            m_work_thread.join();
+        }
+
+        close(m_stream_stop_fd);
+        m_stream_stop_fd = -1;
     }
 
+    // the stream thread no longer dequeues metadata
+    m_uvc_meta.stop();
+
     m_listener.reset();
 
     SPDLOG_DEBUG("Stopped stream");
@@ -975,14 +1150,82 @@ void V4l2Device::generate_scales()
 }
 
 
+std::string V4l2Device::get_format_index_key() const
+{
+    if (tcam::get_environment_variable_int("TCAM_FORMAT_CACHE").value_or(1) == 0)
+    {
+        return {};
+    }
+
+    const auto product_id = tcam::v4l2::fetch_product_id(device);
+    const auto firmware = tcam::v4l2::fetch_firmware_revision(device);
+    if (product_id == 0 || firmware.empty())
+    {
+        return {};
+    }
+
+    // the controls differ between extension unit versions
+    // FNV-1a over the control ids
+    uint64_t controls = 0xcbf29ce484222325ull;
+    for (const auto& [id, name] : m_control_names)
+    {
+        controls = (controls ^ static_cast<uint32_t>(id)) * 0x100000001b3ull;
+    }
+
+    return fmt::format("199e:{:04x}-{}-{:016x}", product_id, firmware, controls);
+}
+
+
 void V4l2Device::index_formats()
 {
+    // the scaling properties belong to this instance, only the probing of the scales is cached
+    if (m_scale.scale_type == Unknown)
+    {
+        determine_scaling();
+    }
+
+    static std::mutex cache_mtx;
+    static std::map<std::string, format_index> cache;
+
+    const auto& key = m_format_index_key;
+    if (!key.empty())
+    {
+        std::scoped_lock lck { cache_mtx };
+        auto iter = cache.find(key);
+        if (iter != cache.end())
+        {
+            SPDLOG_DEBUG("Reusing format enumeration of {}", key);
+
+            m_available_videoformats = iter->second.formats;
+            framerate_conversions = iter->second.framerate_conversions;
+            m_scale.scales = iter->second.scales;
+            m_scale.override_index = iter->second.override_index;
+            m_emulate_bayer = iter->second.emulate_bayer;
+            return;
+        }
+    }
+
     generate_scales();
+    enumerate_formats();
+
+    if (!key.empty())
+    {
+        std::scoped_lock lck { cache_mtx };
+        cache[key] = { m_available_videoformats,
+                       framerate_conversions,
+                       m_scale.scales,
+                       m_scale.override_index,
+                       m_emulate_bayer };
+    }
+}
+
 
+void V4l2Device::enumerate_formats()
+{
     struct v4l2_fmtdesc fmtdesc = {};
     struct v4l2_frmsizeenum frms = {};
 
-    fmtdesc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmtdesc.type = m_buf_type;
 
     for (fmtdesc.index = 0; !tcam_xioctl(m_fd, VIDIOC_ENUM_FMT, &fmtdesc); fmtdesc.index++)
     {
@@ -1011,6 +1254,8 @@ void V4l2Device::index_formats()
             }
         }
 
+        const scaling_table scales(sensor_size, m_scale.scales);
+
         for (frms.index = 0; !tcam_xioctl(m_fd, VIDIOC_ENUM_FRAMESIZES, &frms); frms.index++)
         {
             if (frms.type == V4L2_FRMSIZE_TYPE_DISCRETE)
@@ -1029,17 +1274,14 @@ void V4l2Device::index_formats()
                 framerate_mapping r = { res, f };
                 rf.push_back(r);
 
-                for (auto s : m_scale.scales)
+                for (const auto& s : scales.get_scalings_for(res.max_size))
                 {
-                    if (s.legal_resolution(sensor_size, res.max_size))
-                    {
-                        // being here we have a valid resolution/scaling combo
-                        // copy resolution desc and add scaling
-                        auto scaled_res = res;
-                        scaled_res.scaling = s;
+                    // being here we have a valid resolution/scaling combo
+                    // copy resolution desc and add scaling
+                    auto scaled_res = res;
+                    scaled_res.scaling = s;
 
-                        rf.push_back({scaled_res, f});
-                    }
+                    rf.push_back({scaled_res, f});
                 }
             }
             else
@@ -1106,14 +1348,8 @@ std::vector<double> V4l2Device::index_framerates(const struct v4l2_frmsizeenum&
 
 void V4l2Device::determine_active_video_format()
 {
-
-    struct v4l2_format fmt = {};
-
-    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-
-    int ret = tcam_xioctl(this->m_fd, VIDIOC_G_FMT, &fmt);
-
-    if (ret < 0)
+    v4l2::capture_layout layout;
+    if (!v4l2::get_capture_layout(m_fd, m_buf_type, layout))
     {
         SPDLOG_ERROR("Error while querying video format");
 
@@ -1122,9 +1358,9 @@ void V4l2Device::determine_active_video_format()
 
     v4l2_streamparm parm = {};
 
-    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    parm.type = m_buf_type;
 
-    ret = tcam_xioctl(m_fd, VIDIOC_G_PARM, &parm);
+    int ret = tcam_xioctl(m_fd, VIDIOC_G_PARM, &parm);
 
     if (ret < 0)
     {
@@ -1134,79 +1370,106 @@ void V4l2Device::determine_active_video_format()
     }
 
     tcam_video_format format = {};
-    format.fourcc = fmt.fmt.pix.pixelformat;
+    format.fourcc = layout.pixelformat;
 
     if (format.fourcc == V4L2_PIX_FMT_GREY)
     {
         format.fourcc = FOURCC_Y800;
     }
 
-    format.width = fmt.fmt.pix.width;
-    format.height = fmt.fmt.pix.height;
+    format.width = layout.width;
+    format.height = layout.height;
 
     format.framerate = get_framerate();
 
     format.scaling = get_current_scaling();
 
     this->m_active_video_format = VideoFormat(format);
+
+    // drivers of MIPI CSI-2 receivers align lines, e.g. to 64 bytes
+    const auto packed_pitch = img::calc_minimum_pitch(m_active_video_format.get_img_type());
+    if (layout.bytesperline > static_cast<uint32_t>(packed_pitch))
+    {
+        m_pitch = layout.bytesperline;
+        m_packed_pitch = packed_pitch;
+        SPDLOG_DEBUG("Driver pads lines to {} bytes, {} bytes are image data",
+                     m_pitch,
+                     packed_pitch);
+    }
+    else
+    {
+        m_pitch = 0;
+    }
 }
 
 
-bool V4l2Device::extension_unit_is_loaded()
+bool V4l2Device::extension_unit_is_loaded(const std::vector<v4l2_queryctrl>& qctrl_list)
 {
     /*
       This function checks if any custom properties
       have been loaded. The used identifier is 0x199e.
       It is used as a prefix for all TIS property IDs.
      */
-    struct v4l2_queryctrl qctrl = {};
-    qctrl.id = V4L2_CTRL_FLAG_NEXT_CTRL;
+    return std::any_of(qctrl_list.begin(),
+                       qctrl_list.end(),
+                       [](const v4l2_queryctrl& qctrl)
+                       { return ((qctrl.id >> 12) ^ 0x199e) == 0; });
+}
 
-    while (tcam_xioctl(this->m_fd, VIDIOC_QUERYCTRL, &qctrl) == 0)
-    {
-        if (((qctrl.id >> 12) ^ 0x199e) == 0)
-        {
-            return true;
-        }
-        qctrl.id |= V4L2_CTRL_FLAG_NEXT_CTRL;
-    }
-    return false;
+
+void V4l2Device::reset_stream_state()
+{
+    m_already_received_valid_image = false;
+    m_stall_log_counter = 0;
+
+    // restarts of the stream before a stall is only reported
+    m_max_stall_restarts =
+        std::max(tcam::get_environment_variable_int("TCAM_V4L2_STALL_RESTARTS").value_or(2), 0);
+
+    m_watchdog.reset(get_stream_timing(), v4l2::stream_watchdog::clock::now());
 }
 
 
 void V4l2Device::stream()
 {
-    tcam::set_thread_name("tcam_v4l2_strm");
+    tcam::thread_policy::setup_thread("tcam_v4l2_strm", device.get_serial());
 
-    m_already_received_valid_image = false;
-    static const int log_repetition = 10;
-    int log_repetition_counter = 0;
-    int lost_countdown = lost_countdown_default;
-    // period elapsed for current image
-    int waited_seconds = 0;
-    // maximum_waiting period
-    // do not compare waited_seconds with m_stream_timeout_sec directly
-    // m_stream_timeout_sec may be set to low values while we are
-    // still waiting for a long exposure image
-    // still 'step in between' prevents such errors
-    int waiting_period = m_stream_timeout_sec;
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1)
+    {
+        SPDLOG_ERROR("Unable to create epoll instance: {}", strerror(errno));
+        return;
+    }
 
-    while (this->m_is_stream_on)
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = m_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, m_fd, &ev) == -1)
     {
-        fd_set fds;
+        SPDLOG_ERROR("Unable to add device to epoll: {}", strerror(errno));
+        close(epoll_fd);
+        return;
+    }
 
-        FD_ZERO(&fds);
-        FD_SET(m_fd, &fds);
+    ev.events = EPOLLIN;
+    ev.data.fd = m_stream_stop_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, m_stream_stop_fd, &ev) == -1)
+    {
+        SPDLOG_ERROR("Unable to add eventfd to epoll: {}", strerror(errno));
+        close(epoll_fd);
+        return;
+    }
 
-        int select_timeout = 2;
+    // the timeout is only used for lost image detection
+    // stopping the stream wakes us through m_stream_stop_fd
+    while (this->m_is_stream_on)
+    {
+        struct epoll_event events[2] = {};
 
-        /* Timeout. */
-        struct timeval tv;
-        tv.tv_sec = select_timeout;
-        tv.tv_usec = 0;
+        const auto wait_timeout = m_watchdog.get_wait_timeout(v4l2::stream_watchdog::clock::now());
 
         /* Wait until device gives go */
-        int ret = select(m_fd + 1, &fds, NULL, NULL, &tv);
+        int ret = epoll_wait(epoll_fd, events, 2, wait_timeout.count());
         if (ret == -1)
         {
             if (errno == EINTR)
@@ -1215,9 +1478,8 @@ void V4l2Device::stream()
             }
             else
             {
-                /* error during select */
-                SPDLOG_ERROR("Error during select. errno: %d (%s)", errno, strerror(errno));
-                return;
+                SPDLOG_ERROR("Error during epoll_wait. errno: {} ({})", errno, strerror(errno));
+                break;
             }
         }
 
@@ -1225,54 +1487,139 @@ void V4l2Device::stream()
         // just quit the loop because stop was requested
         if (!m_is_stream_on)
         {
-            return;
+            break;
         }
 
-        if (ret == 0) // timeout encountered
+        bool image_ready = false;
+        for (int i = 0; i < ret; ++i)
         {
-            if (is_trigger_mode_enabled())
+            if (events[i].data.fd == m_fd)
             {
-                continue; // timeout while trigger is enabled, just continue
+                image_ready = true;
             }
+        }
 
-            if (waited_seconds < waiting_period)
-            {
-                waited_seconds += select_timeout;
-            }
-            else
-            {
-                SPDLOG_ERROR("Timeout while waiting for new image buffer.");
-                m_statistics.frames_dropped++;
-                waited_seconds = 0;
-                lost_countdown--;
-            }
+        if (image_ready)
+        {
+            on_images_ready();
+            continue;
         }
-        else
+
+        if (ret > 0)
         {
-            bool ret_value = get_frame();
-            if (ret_value)
-            {
-                lost_countdown = lost_countdown_default; // reset lost countdown variable
-                log_repetition_counter = 0;
-            }
-            else
-            {
-                lost_countdown--;
-            }
-            waiting_period = m_stream_timeout_sec;
+            continue; // spurious wakeup through the eventfd
+        }
+
+        on_stream_timeout();
+    }
+
+    close(epoll_fd);
+}
+
+
+bool V4l2Device::start_reactor_stream()
+{
+    auto& reactor = Reactor::get_instance();
+
+    m_strand = reactor.create_strand();
+
+    // both handlers share the strand, they never run concurrently
+    auto on_timer = [this]()
+    {
+        if (m_is_stream_on)
+        {
+            on_stream_timeout();
+            arm_stream_timer();
         }
-        if (lost_countdown <= 0 && log_repetition_counter < log_repetition)
+    };
+    auto on_readable = [this](uint32_t /*events*/)
+    {
+        if (m_is_stream_on)
         {
-            SPDLOG_WARN("Did not receive image for long time.");
-            lost_countdown = lost_countdown_default;
-            if (log_repetition_counter < log_repetition)
-            {
-                log_repetition_counter++;
-            }
-            if (log_repetition_counter >= log_repetition)
-            {
-                SPDLOG_WARN("Stopping messages \"Did not receive image for long time.\".");
-            }
+            on_images_ready();
+            arm_stream_timer();
+        }
+    };
+
+    m_stream_timer_handle = reactor.add_timer(m_strand, on_timer);
+    arm_stream_timer();
+
+    m_stream_fd_handle = reactor.watch_fd(m_fd, EPOLLIN, m_strand, on_readable);
+    if (m_stream_fd_handle == 0)
+    {
+        reactor.remove(m_stream_timer_handle);
+        m_stream_timer_handle = 0;
+        m_strand.reset();
+        return false;
+    }
+    return true;
+}
+
+
+void V4l2Device::arm_stream_timer()
+{
+    const auto now = v4l2::stream_watchdog::clock::now();
+    Reactor::get_instance().arm_timer(m_stream_timer_handle,
+                                      now + m_watchdog.get_wait_timeout(now));
+}
+
+
+void V4l2Device::on_images_ready()
+{
+    if (get_frames())
+    {
+        m_watchdog.image_received(v4l2::stream_watchdog::clock::now());
+        m_stall_log_counter = 0;
+    }
+}
+
+
+void V4l2Device::on_stream_timeout()
+{
+    static const int log_repetition = 10;
+
+    // exposure time, frame rate or trigger mode may have changed since the last image
+    // only reread them now, while images arrive the current values do not matter
+    m_watchdog.update(get_stream_timing());
+
+    const auto now = v4l2::stream_watchdog::clock::now();
+    if (!m_watchdog.check_stalled(now))
+    {
+        return;
+    }
+
+    if (get_queued_buffer_count() == 0)
+    {
+        // the sink holds all buffers, the driver has nothing to fill
+        SPDLOG_DEBUG(
+            "No image since {} ms, no buffer is queued.",
+            std::chrono::duration_cast<std::chrono::milliseconds>(m_watchdog.get_stall_timeout())
+                .count());
+        return;
+    }
+
+    m_statistics.frames_dropped++;
+
+    if (m_watchdog.get_stall_count() <= m_max_stall_restarts)
+    {
+        SPDLOG_WARN(
+            "No image since {} ms. Restarting stream.",
+            std::chrono::duration_cast<std::chrono::milliseconds>(m_watchdog.get_stall_timeout())
+                .count());
+        if (restart_stream())
+        {
+            m_watchdog.stream_restarted(v4l2::stream_watchdog::clock::now());
+        }
+        return;
+    }
+
+    if (m_stall_log_counter < log_repetition)
+    {
+        SPDLOG_WARN("Did not receive image for long time.");
+        m_stall_log_counter++;
+        if (m_stall_log_counter >= log_repetition)
+        {
+            SPDLOG_WARN("Stopping messages \"Did not receive image for long time.\".");
         }
     }
 }
@@ -1299,31 +1646,58 @@ bool V4l2Device::is_trigger_mode_enabled()
 }
 
 
-bool V4l2Device::get_frame()
+bool V4l2Device::get_frames()
 {
-    struct v4l2_buffer buf = {};
+    bool delivered = false;
 
-    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-
-    if (pool_->get_memory_type() == TCAM_MEMORY_TYPE_USERPTR)
-    {
-        buf.memory = V4L2_MEMORY_USERPTR;
-    }
-    else
+    // the fd is non-blocking, so DQBUF returns EAGAIN once all ready buffers are drained
+    // bound the loop, a buffer cannot be ready more than once per wakeup
+    for (size_t i = 0; i < m_buffers.size() && m_is_stream_on; ++i)
     {
-        buf.memory = V4L2_MEMORY_MMAP;
+        auto ret = get_frame();
+        if (ret == dequeue_result::image)
+        {
+            delivered = true;
+        }
+        else
+        {
+            break;
+        }
     }
-    int ret = tcam_xioctl(m_fd, VIDIOC_DQBUF, &buf);
+    return delivered;
+}
+
+
+V4l2Device::dequeue_result V4l2Device::get_frame()
+{
+    v4l2::capture_buffer dqbuf(m_buf_type,
+                               v4l2::memory_type_to_v4l2_memory(pool_->get_memory_type()));
+    const auto& buf = dqbuf.buf;
+
+    // tcam_xioctl retries on EAGAIN, which is the expected end of the drain loop
+    int ret = 0;
+    do {
+        ret = ioctl(m_fd, VIDIOC_DQBUF, &dqbuf.buf);
+    } while (ret == -1 && errno == EINTR);
 
     if (ret == -1)
     {
+        if (errno == EAGAIN)
+        {
+            return dequeue_result::empty;
+        }
         SPDLOG_TRACE("Unable to dequeue buffer.");
-        return false;
+        return dequeue_result::error;
     }
+    const uint32_t bytesused = dqbuf.bytesused();
+    TCAM_TRACE3(v4l2_dqbuf, buf.index, bytesused, buf.sequence);
 
     auto& image_buffer = m_buffers.at(buf.index);
 
-    image_buffer.is_queued = false;
+    {
+        std::scoped_lock lck { m_buffer_mtx };
+        image_buffer.is_queued = false;
+    }
 
     // buf.bytesused
     /* The number of bytes occupied by the data in the buffer. It depends on
@@ -1338,17 +1712,23 @@ bool V4l2Device::get_frame()
 
     if (m_active_video_format.get_fourcc() != FOURCC_MJPG)
     {
-        if (buf.bytesused != (this->m_active_video_format.get_required_buffer_size()))
+        // padded lines, the last line may end without padding
+        const size_t expected = m_pitch == 0 ? m_active_video_format.get_required_buffer_size()
+                                           : m_pitch * m_active_video_format.get_size().height;
+        const bool valid = m_pitch == 0 ? bytesused == expected
+                                        : bytesused >= expected - (m_pitch - m_packed_pitch);
+        if (!valid)
         {
             if (m_already_received_valid_image)
             {
-                SPDLOG_ERROR("Buffer has wrong size. Got: {} Expected: {} Dropping...",
-                             buf.bytesused,
-                             this->m_active_video_format.get_required_buffer_size());
+                SPDLOG_ERROR_RATELIMITED(
+                    "Buffer has wrong size. Got: {} Expected: {} Dropping...",
+                    bytesused,
+                    expected);
             }
             //SPDLOG_ERROR("error requeue");
-            requeue_buffer(image_buffer.buffer.lock());
-            return true;
+            requeue_buffer(image_buffer.buffer);
+            return dequeue_result::image;
         }
     }
     m_already_received_valid_image = true;
@@ -1357,9 +1737,27 @@ bool V4l2Device::get_frame()
     m_statistics.capture_time_ns =
         ((long long)buf.timestamp.tv_sec * 1000 * 1000 * 1000) + (buf.timestamp.tv_usec * 1000);
     m_statistics.frame_count++;
-    auto b = image_buffer.buffer.lock();
+
+    // the metadata buffer of a frame carries the sequence number of its video buffer
+    m_statistics.camera_time_ns = 0;
+    tcam_chunk_data chunk_data = {};
+    v4l2::uvc_frame_meta meta;
+    if (m_uvc_meta.get_meta(buf.sequence, meta))
+    {
+        m_statistics.camera_time_ns = m_uvc_meta.get_camera_time_ns(meta);
+        if (chunk_data_enabled_)
+        {
+            chunk_data.has_exposure_time = meta.has_exposure_time;
+            chunk_data.exposure_time_us = meta.exposure_time_us;
+        }
+    }
+
+    const auto& b = image_buffer.buffer;
     b->set_statistics(m_statistics);
-    b->set_valid_data_length(buf.bytesused);
+    b->set_chunk_data(chunk_data);
+    b->set_valid_data_length(bytesused);
+    b->set_pitch(m_pitch);
+    b->record_stage(timing::stage::backend_dequeue);
 
     //SPDLOG_INFO("pushing new buffer");
 
@@ -1370,10 +1768,10 @@ bool V4l2Device::get_frame()
     else
     {
         SPDLOG_ERROR("ImageSink expired. Unable to deliver images.");
-        return false;
+        return dequeue_result::error;
     }
 
-    return true;
+    return dequeue_result::image;
 }
 
 
@@ -1382,7 +1780,7 @@ void V4l2Device::init_userptr_buffers()
     struct v4l2_requestbuffers req = {};
 
     req.count = m_buffers.size();
-    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.type = m_buf_type;
     req.memory = V4L2_MEMORY_USERPTR;
 
     if (-1 == tcam_xioctl(m_fd, VIDIOC_REQBUFS, &req))
@@ -1400,20 +1798,15 @@ void V4l2Device::init_userptr_buffers()
 
     for (unsigned int i = 0; i < m_buffers.size(); ++i)
     {
-        struct v4l2_buffer buf = {};
-
-        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_USERPTR;
-        buf.index = i;
+        v4l2::capture_buffer buf(m_buf_type, V4L2_MEMORY_USERPTR, i);
 
-        auto b = m_buffers.at(i).buffer.lock();
+        const auto& b = m_buffers.at(i).buffer;
 
-        buf.m.userptr = (unsigned long)b->get_image_buffer_ptr();
-        buf.length = b->get_image_buffer_size();
+        buf.set_userptr(b->get_image_buffer_ptr(), b->get_image_buffer_size());
 
-        SPDLOG_DEBUG("Queueing buffer({}) with length {}", fmt::ptr(b->get_image_buffer_ptr()), buf.length);
+        SPDLOG_DEBUG("Queueing buffer({}) with length {}", fmt::ptr(b->get_image_buffer_ptr()), buf.length());
 
-        if (-1 == tcam_xioctl(m_fd, VIDIOC_QBUF, &buf))
+        if (-1 == tcam_xioctl(m_fd, VIDIOC_QBUF, &buf.buf))
         {
             SPDLOG_ERROR("Unable to queue v4l2_buffer 'VIDIOC_QBUF' {}", strerror(errno));
             return;
@@ -1446,22 +1839,18 @@ void V4l2Device::init_mmap_buffers()
 
     for (unsigned int n_buffers = 0; n_buffers < m_buffers.size(); ++n_buffers)
     {
-        struct v4l2_buffer buf = {};
+        v4l2::capture_buffer buf(m_buf_type, V4L2_MEMORY_MMAP, n_buffers);
 
-        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_MMAP;
-        buf.index = n_buffers;
-
-        if (tcam_xioctl(m_fd, VIDIOC_QUERYBUF, &buf) == -1)
+        if (tcam_xioctl(m_fd, VIDIOC_QUERYBUF, &buf.buf) == -1)
         {
-            SPDLOG_ERROR("WHAT index: {} {} {}", buf.index, errno, strerror(errno));
+            SPDLOG_ERROR("WHAT index: {} {} {}", buf.buf.index, errno, strerror(errno));
             //return;
         }
     }
 
     for (unsigned int i = 0; i < m_buffers.size(); ++i)
     {
-        if (queue_mmap(i, m_buffers.at(i).buffer.lock()))
+        if (queue_mmap(i, m_buffers.at(i).buffer))
         {
             m_buffers.at(i).is_queued = true;
         }
@@ -1469,25 +1858,35 @@ void V4l2Device::init_mmap_buffers()
 }
 
 
-void V4l2Device::init_dma_buffers()
+bool V4l2Device::init_dma_buffers()
 {
-    for (unsigned int i = 0; i < m_buffers.size(); ++i)
+    // the memory is owned by downstream, the driver only needs to know the buffer count
+    struct v4l2_requestbuffers req = {};
+
+    req.count = m_buffers.size();
+    req.type = m_buf_type;
+    req.memory = V4L2_MEMORY_DMABUF;
+
+    if (tcam_xioctl(m_fd, VIDIOC_REQBUFS, &req) == -1)
     {
-        struct v4l2_buffer buf = {};
+        SPDLOG_ERROR("VIDIOC_REQBUFS for dma import failed: {}", strerror(errno));
+        return false;
+    }
 
-        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_DMABUF;
-        buf.index = i;
-        // TODO: pass dma fd
-        // buf.m.fd = dmafd;
+    if (req.count != m_buffers.size())
+    {
+        SPDLOG_ERROR("Driver only accepts {} of {} dma buffer.", req.count, m_buffers.size());
+        return false;
+    }
 
-        if (tcam_xioctl(m_fd, VIDIOC_QBUF, &buf) == -1)
+    for (unsigned int i = 0; i < m_buffers.size(); ++i)
+    {
+        if (queue_dma(i, m_buffers.at(i).buffer))
         {
-            perror("VIDIOC_QBUF");
-            return;
+            m_buffers.at(i).is_queued = true;
         }
-
     }
+    return true;
 }
 
 
@@ -1506,84 +1905,3 @@ tcam_image_size V4l2Device::get_sensor_size() const
 }
 
 
-void V4l2Device::monitor_v4l2_thread_func()
-{
-    tcam::set_thread_name( "tcam_v4l2_mon" );
-    auto udev = udev_new();
-    if (!udev)
-    {
-        SPDLOG_ERROR("Failed to create udev context");
-        return;
-    }
-
-    /* Set up a monitor to monitor hidraw devices */
-    auto mon = udev_monitor_new_from_netlink(udev, "udev");
-    if (!mon)
-    {
-        SPDLOG_ERROR("Failed to create udev monitor");
-        udev_unref(udev);
-        return;
-    }
-    udev_monitor_filter_add_match_subsystem_devtype(mon, "video4linux", NULL);
-    udev_monitor_enable_receiving(mon);
-    /* Get the file descriptor (fd) for the monitor.
-       This fd will get passed to select() */
-    int udev_fd = udev_monitor_get_fd(mon);
-
-    /* This section will run continuously, calling usleep() at
-       the end of each pass. This is to demonstrate how to use
-       a udev_monitor in a non-blocking way. */
-    while (!m_stop_monitor_v4l2_thread)
-    {
-        /* Set up the call to select(). In this case, select() will
-           only operate on a single file descriptor, the one
-           associated with our udev_monitor. Note that the timeval
-           object is set to 0, which will cause select() to not
-           block. */
-        fd_set fds;
-        int select_fd = udev_fd + 1;
-
-        FD_ZERO(&fds);
-        FD_SET(udev_fd, &fds);
-
-        struct timeval tv;
-        tv.tv_sec = 1;
-        tv.tv_usec = 0;
-
-        int ret = select(select_fd, &fds, NULL, NULL, &tv);
-
-        /* Check if our file descriptor has received data. */
-        if (ret > 0 && FD_ISSET(udev_fd, &fds))
-        {
-            /* Make the call to receive the device.
-               select() ensured that this will not block. */
-            auto dev = udev_monitor_receive_device(mon);
-            if (dev)
-            {
-                if (strcmp(udev_device_get_devnode(dev), device.get_identifier().c_str()) == 0)
-                {
-                    if (strcmp(udev_device_get_action(dev), "remove") == 0)
-                    {
-                        SPDLOG_ERROR("Lost device! {}", device.get_name().c_str());
-                        this->lost_device();
-                        break;
-                    }
-                    else
-                    {
-                        SPDLOG_WARN("Received an event for device: '{}' This should not happen.",
-                                    udev_device_get_action(dev));
-                    }
-                }
-
-                udev_device_unref(dev);
-            }
-            else
-            {
-                SPDLOG_ERROR("No Device from udev_monitor_receive_device. An error occured.");
-            }
-        }
-    }
-
-    udev_monitor_unref(mon);
-    udev_unref(udev);
-}
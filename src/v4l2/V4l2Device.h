@@ -21,14 +21,19 @@
 #include "../VideoFormat.h"
 #include "../VideoFormatDescription.h"
 #include "../BufferPool.h"
+#include "../Reactor.h"
 #include "V4L2PropertyBackend.h"
 #include "V4L2Allocator.h"
+#include "v4l2_stream_watchdog.h"
+#include "v4l2_uvc_meta.h"
 
 #include <atomic>
 #include <condition_variable> // std::condition_variable
 #include <linux/videodev2.h>
+#include <map>
 #include <memory>
 #include <mutex> // std::mutex, std::unique_lock
+#include <string>
 #include <thread>
 
 VISIBILITY_INTERNAL
@@ -87,10 +92,25 @@ private:
 
     std::thread m_work_thread;
 
+    // TCAM_REACTOR=1, the stream is driven by the process wide Reactor instead of m_work_thread
+    std::shared_ptr<Reactor::strand> m_strand;
+    Reactor::handle m_stream_fd_handle = 0;
+    Reactor::handle m_stream_timer_handle = 0;
+
     int m_fd = -1;
 
+    // V4L2_BUF_TYPE_VIDEO_CAPTURE or V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE
+    uint32_t m_buf_type = 0;
+
+    // eventfd used to wake the work thread when the stream is stopped
+    int m_stream_stop_fd = -1;
+
     VideoFormat m_active_video_format;
 
+    // bytesperline of the active format when the driver pads lines, 0 for packed lines
+    int m_pitch = 0;
+    int m_packed_pitch = 0;
+
     std::vector<VideoFormatDescription> m_available_videoformats;
     bool m_emulate_bayer = false;
 
@@ -109,19 +129,18 @@ private:
     std::vector<std::shared_ptr<tcam::property::IPropertyBase>> m_properties;
     std::vector<std::shared_ptr<tcam::property::IPropertyBase>> m_internal_properties;
 
-    std::shared_ptr<tcam::AllocatorInterface> allocator_ = nullptr;
+    // v4l2 id -> name of the public property, used for change notifications
+    std::map<int, std::string> m_control_names;
 
-    std::thread m_monitor_v4l2_thread;
-    std::atomic<bool> m_stop_monitor_v4l2_thread { false };
+    std::shared_ptr<tcam::AllocatorInterface> allocator_ = nullptr;
 
-    void monitor_v4l2_thread_func();
+    // removal and control events are delivered by the process wide hotplug_monitor
+    uint64_t m_hotplug_token = 0;
 
     void notify_device_lost_func();
 
     void lost_device();
 
-    void update_stream_timeout();
-
 
     struct override_mapping
     {
@@ -148,18 +167,37 @@ private:
 
     void    update_properties( const VideoFormat& current_fmt );
 
+    // result of index_formats, reused when a device of the same model, firmware and
+    // extension unit is opened again
+    struct format_index
+    {
+        std::vector<VideoFormatDescription> formats;
+        std::vector<framerate_conv> framerate_conversions;
+        std::vector<image_scaling> scales;
+        std::vector<override_mapping> override_index;
+        bool emulate_bayer = false;
+    };
+
+    // empty when the device cannot be identified or TCAM_FORMAT_CACHE=0
+    std::string get_format_index_key() const;
+    // get_format_index_key after the properties were created, also keys the menu cache
+    std::string m_format_index_key;
+
     /**
      * @brief iterate over all v4l2 format descriptions and convert them
      *        into the internal representation
+     *
+     * Uses the cached result of an earlier call for the same key.
      */
     void index_formats();
+    void enumerate_formats();
 
     std::vector<double> index_framerates(const struct v4l2_frmsizeenum& frms);
 
     void determine_active_video_format();
 
     bool load_extension_unit();
-    bool extension_unit_is_loaded();
+    bool extension_unit_is_loaded(const std::vector<v4l2_queryctrl>& qctrl_list);
 
     void generate_properties( const std::vector<v4l2_queryctrl>& qctrl_list );
     void create_properties();
@@ -181,32 +219,72 @@ private:
 
     struct buffer_info
     {
-        std::weak_ptr<ImageBuffer> buffer;
+        // held until release_buffers, so that dequeueing does not lock a weak_ptr per image
+        std::shared_ptr<ImageBuffer> buffer;
         bool is_queued = false;
     };
 
-    std::atomic<int> m_stream_timeout_sec { 10 };
-
+    // guards is_queued against requeue_buffer calls while the stream thread restarts the stream
+    std::mutex m_buffer_mtx;
     std::vector<buffer_info> m_buffers;
 
     std::weak_ptr<IImageBufferSink> m_listener;
 
+    // metadata node of uvcvideo devices, camera time and exposure of every frame
+    // disabled with TCAM_V4L2_UVC_META=0
+    v4l2::uvc_meta_stream m_uvc_meta;
+
     std::shared_ptr<tcam::v4l2::prop_impl_offset_auto_center>   software_auto_center_;
 
+    // state of the running stream, only used by the stream thread or the stream strand
+    v4l2::stream_watchdog m_watchdog;
+    int m_max_stall_restarts = 2;
+    int m_stall_log_counter = 0;
+
+    void reset_stream_state();
+
     void stream();
 
-    bool get_frame();
+    bool start_reactor_stream();
+    void arm_stream_timer();
+
+    // an image can be dequeued
+    void on_images_ready();
+    // no image arrived within the wait timeout of m_watchdog
+    void on_stream_timeout();
+
+    enum class dequeue_result
+    {
+        image, // an image was dequeued and delivered or dropped
+        empty, // no buffer is ready
+        error,
+    };
+
+    dequeue_result get_frame();
+
+    // dequeue and deliver all buffers that are ready
+    // returns false if not a single image could be delivered
+    bool get_frames();
 
     void init_userptr_buffers();
     void init_mmap_buffers();
-    void init_dma_buffers();
+    bool init_dma_buffers();
 
-    bool queue_dma(int i, std::shared_ptr<ImageBuffer>);
-    bool queue_mmap(int i, std::shared_ptr<ImageBuffer>);
-    bool queue_userptr(int i, std::shared_ptr<ImageBuffer>);
+    bool queue_dma(int i, const std::shared_ptr<ImageBuffer>&);
+    bool queue_mmap(int i, const std::shared_ptr<ImageBuffer>&);
+    bool queue_userptr(int i, const std::shared_ptr<ImageBuffer>&);
+    // m_buffer_mtx has to be held
+    bool queue_buffer(size_t i, const std::shared_ptr<ImageBuffer>& buffer);
+
+    size_t get_queued_buffer_count();
+
+    // STREAMOFF/STREAMON, buffers that were queued in the driver are queued again
+    bool restart_stream();
 
     bool is_trigger_mode_enabled();
 
+    v4l2::stream_watchdog::timing get_stream_timing();
+
     tcam_image_size get_sensor_size() const;
 };
 
@@ -20,9 +20,11 @@
 
 #include "json.hpp"
 
+#include <cstring>
 #include <fcntl.h>
 #include <fstream>
 #include <limits.h> // LONG_MAX
+#include <optional>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -248,24 +250,28 @@ std::string tcam::uvc::determine_extension_file(const std::string& pid_in)
 }
 
 
-std::vector<tcam::uvc::description> tcam::uvc::load_description_file(
-    const std::string& filename,
-    std::function<void(const std::string&)> cb)
+static std::string read_file(const std::string& filename)
 {
-    static const int max_string_length = 31;
-
-    uuid_t guid;
-
-    std::vector<description> mappings;
-
-    std::ifstream ifs(filename);
+    std::ifstream ifs(filename, std::ios::binary);
 
     if (!ifs.good())
     {
-        return mappings;
+        return {};
     }
 
-    std::string tmp_content(std::istreambuf_iterator<char>{ifs}, {});
+    return std::string(std::istreambuf_iterator<char> { ifs }, {});
+}
+
+
+static std::vector<tcam::uvc::description> parse_description(
+    const std::string& tmp_content,
+    std::function<void(const std::string&)> cb)
+{
+    static const int max_string_length = 31;
+
+    uuid_t guid;
+
+    std::vector<tcam::uvc::description> mappings;
 
     json json_desc;
 
@@ -288,7 +294,7 @@ std::vector<tcam::uvc::description> tcam::uvc::load_description_file(
 
     for (const auto& m : json_desc.at("mappings"))
     {
-        struct description desc;
+        tcam::uvc::description desc;
         desc.mapping = {};
 
         auto& map = desc.mapping;
@@ -357,3 +363,257 @@ std::vector<tcam::uvc::description> tcam::uvc::load_description_file(
 
     return mappings;
 }
+
+
+std::vector<tcam::uvc::description> tcam::uvc::load_description_file(
+    const std::string& filename,
+    std::function<void(const std::string&)> cb)
+{
+    std::string content = read_file(filename);
+
+    if (content.empty())
+    {
+        return {};
+    }
+    return parse_description(content, cb);
+}
+
+
+namespace
+{
+
+/*
+ * Layout of the mapping cache, all values in host byte order.
+ * The cache is created at build time on the machine that uses it.
+ *
+ * cache_header
+ * cache_header.count times:
+ *     cache_mapping
+ *     cache_mapping.menu_count times uvc_menu_info
+ */
+
+constexpr char cache_magic[8] = { 't', 'c', 'a', 'm', 'u', 'v', 'c', 'm' };
+constexpr uint32_t cache_version = 1;
+
+struct cache_header
+{
+    char magic[8];
+    uint32_t version;
+    // checksum of the description file the cache was created from
+    uint32_t source_checksum;
+    uint32_t count;
+};
+
+// uvc_xu_control_mapping without the menu pointer
+struct cache_mapping
+{
+    __u32 id;
+    __u8 name[32];
+    __u8 entity[16];
+    __u8 selector;
+    __u8 size;
+    __u8 offset;
+    __u8 reserved;
+    __u32 v4l2_type;
+    __u32 data_type;
+    __u32 menu_count;
+};
+
+static_assert(sizeof(cache_mapping) == 68);
+static_assert(sizeof(uvc_menu_info) == 36);
+
+// FNV-1a
+uint32_t checksum(const std::string& content)
+{
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : content)
+    {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+
+bool is_cache(const std::string& content)
+{
+    return content.size() >= sizeof(cache_header)
+           && memcmp(content.data(), cache_magic, sizeof(cache_magic)) == 0;
+}
+
+
+// source_checksum is not compared when it is empty
+std::vector<tcam::uvc::description> parse_cache(const std::string& content,
+                                                std::optional<uint32_t> source_checksum,
+                                                std::function<void(const std::string&)> cb)
+{
+    if (!is_cache(content))
+    {
+        cb("Not a uvc extension mapping cache.");
+        return {};
+    }
+
+    cache_header header;
+    memcpy(&header, content.data(), sizeof(header));
+
+    if (header.version != cache_version)
+    {
+        cb("Mapping cache version " + std::to_string(header.version) + " is not supported.");
+        return {};
+    }
+
+    if (source_checksum && header.source_checksum != *source_checksum)
+    {
+        cb("Mapping cache was created from a different description file.");
+        return {};
+    }
+
+    std::vector<tcam::uvc::description> mappings;
+    mappings.reserve(header.count);
+
+    size_t pos = sizeof(header);
+    for (uint32_t i = 0; i < header.count; ++i)
+    {
+        cache_mapping m;
+        if (pos + sizeof(m) > content.size())
+        {
+            cb("Mapping cache is truncated.");
+            return {};
+        }
+        memcpy(&m, content.data() + pos, sizeof(m));
+        pos += sizeof(m);
+
+        tcam::uvc::description desc;
+        desc.mapping = {};
+
+        auto& map = desc.mapping;
+        map.id = m.id;
+        memcpy(map.name, m.name, sizeof(map.name));
+        map.name[sizeof(map.name) - 1] = '\0';
+        memcpy(map.entity, m.entity, sizeof(map.entity));
+        map.selector = m.selector;
+        map.size = m.size;
+        map.offset = m.offset;
+        map.v4l2_type = m.v4l2_type;
+        map.data_type = m.data_type;
+
+        if (pos + m.menu_count * sizeof(uvc_menu_info) > content.size())
+        {
+            cb("Mapping cache is truncated.");
+            return {};
+        }
+        desc.entries.resize(m.menu_count);
+        memcpy(desc.entries.data(), content.data() + pos, m.menu_count * sizeof(uvc_menu_info));
+        pos += m.menu_count * sizeof(uvc_menu_info);
+
+        mappings.push_back(std::move(desc));
+    }
+
+    return mappings;
+}
+
+} // namespace
+
+
+std::string tcam::uvc::get_cache_filename(const std::string& description_file)
+{
+    static const std::string json_ending = ".json";
+
+    if (description_file.size() > json_ending.size()
+        && description_file.compare(description_file.size() - json_ending.size(),
+                                    json_ending.size(),
+                                    json_ending)
+               == 0)
+    {
+        return description_file.substr(0, description_file.size() - json_ending.size()) + ".bin";
+    }
+    return description_file + ".bin";
+}
+
+
+bool tcam::uvc::write_mapping_cache(const std::string& description_file,
+                                    const std::string& cache_file,
+                                    std::function<void(const std::string&)> cb)
+{
+    std::string content = read_file(description_file);
+    if (content.empty())
+    {
+        cb("Unable to read " + description_file);
+        return false;
+    }
+
+    auto mappings = parse_description(content, cb);
+    if (mappings.empty())
+    {
+        return false;
+    }
+
+    cache_header header = {};
+    memcpy(header.magic, cache_magic, sizeof(header.magic));
+    header.version = cache_version;
+    header.source_checksum = checksum(content);
+    header.count = mappings.size();
+
+    std::string out(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const auto& desc : mappings)
+    {
+        const auto& map = desc.mapping;
+
+        cache_mapping m = {};
+        m.id = map.id;
+        memcpy(m.name, map.name, sizeof(m.name));
+        memcpy(m.entity, map.entity, sizeof(m.entity));
+        m.selector = map.selector;
+        m.size = map.size;
+        m.offset = map.offset;
+        m.v4l2_type = map.v4l2_type;
+        m.data_type = map.data_type;
+        m.menu_count = desc.entries.size();
+
+        out.append(reinterpret_cast<const char*>(&m), sizeof(m));
+        out.append(reinterpret_cast<const char*>(desc.entries.data()),
+                   desc.entries.size() * sizeof(uvc_menu_info));
+    }
+
+    std::ofstream ofs(cache_file, std::ios::binary | std::ios::trunc);
+    ofs.write(out.data(), out.size());
+
+    if (!ofs.good())
+    {
+        cb("Unable to write " + cache_file);
+        return false;
+    }
+    return true;
+}
+
+
+std::vector<tcam::uvc::description> tcam::uvc::load_mapping_file(
+    const std::string& filename,
+    std::function<void(const std::string&)> cb)
+{
+    std::string content = read_file(filename);
+
+    if (content.empty())
+    {
+        return {};
+    }
+
+    if (is_cache(content))
+    {
+        return parse_cache(content, std::nullopt, cb);
+    }
+
+    std::string cache = read_file(get_cache_filename(filename));
+    if (!cache.empty())
+    {
+        auto mappings = parse_cache(cache, checksum(content), cb);
+        if (!mappings.empty())
+        {
+            return mappings;
+        }
+        cb("Ignoring mapping cache for " + filename);
+    }
+
+    return parse_description(content, cb);
+}
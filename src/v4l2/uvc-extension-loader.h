@@ -77,6 +77,42 @@ void apply_mappings(int fd,
 std::vector<description> load_description_file(const std::string& filename,
                                                std::function<void(const std::string&)> cb);
 
+
+/**
+ * @name write_mapping_cache
+ * @param description_file - absolute filepath of the json description file
+ * @param cache_file - file the binary mapping cache shall be written to
+ * @param cb - callback function for error/warning messages
+ * @return true on success
+ *
+ * The cache contains the mappings as they are submitted to the kernel and
+ * a checksum of the description file it was created from.
+ */
+bool write_mapping_cache(const std::string& description_file,
+                         const std::string& cache_file,
+                         std::function<void(const std::string&)> cb);
+
+
+/**
+ * @name get_cache_filename
+ * @param description_file - filepath of a json description file
+ * @return filepath of the mapping cache for that file, e.g. usb33.bin for usb33.json
+ */
+std::string get_cache_filename(const std::string& description_file);
+
+
+/**
+ * @name load_mapping_file
+ * @param filename - absolute filepath of a description file or mapping cache
+ * @param cb - callback function for error/warning messages
+ * @return vector of description structs, will be empty on error
+ *
+ * For description files the cache next to the file is used when it was created
+ * from the same file content, otherwise the json is parsed.
+ */
+std::vector<description> load_mapping_file(const std::string& filename,
+                                           std::function<void(const std::string&)> cb);
+
 } // namespace tcam::uvc
 
 #endif /* TCAM_SRC_V4L2_UVC_EXTENSION_LOADER_H */
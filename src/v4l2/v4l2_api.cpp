@@ -16,7 +16,10 @@
 
 #include "v4l2_api.h"
 
+#include "../logging.h"
+#include "../utils.h"
 #include "V4l2Device.h"
+#include "v4l2_hotplug.h"
 #include "v4l2_utils.h"
 
 
@@ -29,3 +32,52 @@ std::vector<tcam::DeviceInfo> tcam::V4L2Backend::get_device_list()
 {
     return get_v4l2_device_list();
 }
+
+
+std::optional<tcam::DeviceInfo> tcam::V4L2Backend::find_device(const std::string& serial)
+{
+    auto list = get_v4l2_device_list(serial);
+    if (list.empty())
+    {
+        return std::nullopt;
+    }
+    return list.front();
+}
+
+
+bool tcam::V4L2Backend::start_monitoring(const backend_monitor_callbacks& callbacks)
+{
+    std::scoped_lock lck { monitor_mtx_ };
+
+    if (hotplug_token_ != 0)
+    {
+        return false;
+    }
+
+    v4l2::hotplug_monitor::subscription sub;
+    sub.any_event = [cb = callbacks.device_list_changed](const std::string& /*action*/,
+                                                         const std::string& /*devnode*/)
+    {
+        if (cb)
+        {
+            cb();
+        }
+    };
+
+    hotplug_token_ = v4l2::hotplug_monitor::get_instance().subscribe(std::move(sub));
+
+    return true;
+}
+
+
+void tcam::V4L2Backend::stop_monitoring()
+{
+    std::scoped_lock lck { monitor_mtx_ };
+    if (hotplug_token_ == 0)
+    {
+        return;
+    }
+
+    v4l2::hotplug_monitor::get_instance().unsubscribe(hotplug_token_);
+    hotplug_token_ = 0;
+}
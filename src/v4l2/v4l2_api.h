@@ -18,6 +18,9 @@
 
 #include "../devicelibrary.h"
 
+#include <cstdint>
+#include <mutex>
+
 namespace tcam
 {
 
@@ -30,12 +33,23 @@ public:
     };
     std::shared_ptr<DeviceInterface> open_device(const tcam::DeviceInfo&) final;
     std::vector<DeviceInfo> get_device_list() final;
+    // matches the usb serial in sysfs, no device is opened
+    std::optional<DeviceInfo> find_device(const std::string& serial) final;
+
+    // Subscribes to the process wide hotplug_monitor
+    bool start_monitoring(const backend_monitor_callbacks& callbacks) final;
+    void stop_monitoring() final;
 
     static V4L2Backend* get_instance()
     {
         static V4L2Backend b;
         return &b;
     };
+
+private:
+    std::mutex monitor_mtx_;
+    // 0 while not monitoring
+    uint64_t hotplug_token_ = 0;
 };
 
 } // namespace tcam
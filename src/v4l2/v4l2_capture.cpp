@@ -0,0 +1,197 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "v4l2_capture.h"
+
+#include "../logging.h"
+#include "../utils.h"
+
+#include <cerrno>
+#include <cstring>
+
+using namespace tcam;
+
+
+uint32_t v4l2::query_capture_buffer_type(int fd)
+{
+    v4l2_capability cap = {};
+    if (tcam_xioctl(fd, VIDIOC_QUERYCAP, &cap) == -1)
+    {
+        SPDLOG_ERROR("VIDIOC_QUERYCAP failed: {}", strerror(errno));
+        return V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    }
+
+    const uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps
+                                                                     : cap.capabilities;
+
+    if (!(caps & V4L2_CAP_VIDEO_CAPTURE) && (caps & V4L2_CAP_VIDEO_CAPTURE_MPLANE))
+    {
+        SPDLOG_DEBUG("Using the multi planar capture api");
+        return V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+    }
+    return V4L2_BUF_TYPE_VIDEO_CAPTURE;
+}
+
+
+v4l2::capture_buffer::capture_buffer(uint32_t type, uint32_t memory, uint32_t index) noexcept
+{
+    buf.type = type;
+    buf.memory = memory;
+    buf.index = index;
+
+    if (is_mplane(type))
+    {
+        buf.m.planes = &plane;
+        buf.length = 1;
+    }
+}
+
+
+void v4l2::capture_buffer::set_userptr(void* ptr, size_t length) noexcept
+{
+    if (is_mplane(buf.type))
+    {
+        plane.m.userptr = reinterpret_cast<unsigned long>(ptr);
+        plane.length = length;
+    }
+    else
+    {
+        buf.m.userptr = reinterpret_cast<unsigned long>(ptr);
+        buf.length = length;
+    }
+}
+
+
+void v4l2::capture_buffer::set_dmabuf(int fd, size_t length) noexcept
+{
+    if (is_mplane(buf.type))
+    {
+        plane.m.fd = fd;
+        plane.length = length;
+    }
+    else
+    {
+        buf.m.fd = fd;
+        buf.length = length;
+    }
+}
+
+
+uint32_t v4l2::capture_buffer::bytesused() const noexcept
+{
+    // for the multi planar api buf.bytesused is ignored, see the v4l2_buffer documentation
+    return is_mplane(buf.type) ? plane.bytesused : buf.bytesused;
+}
+
+
+uint32_t v4l2::capture_buffer::mem_offset() const noexcept
+{
+    return is_mplane(buf.type) ? plane.m.mem_offset : buf.m.offset;
+}
+
+
+uint32_t v4l2::capture_buffer::length() const noexcept
+{
+    return is_mplane(buf.type) ? plane.length : buf.length;
+}
+
+
+namespace
+{
+
+void fill_layout(const v4l2_format& fmt, v4l2::capture_layout& layout)
+{
+    if (v4l2::is_mplane(fmt.type))
+    {
+        layout.pixelformat = fmt.fmt.pix_mp.pixelformat;
+        layout.width = fmt.fmt.pix_mp.width;
+        layout.height = fmt.fmt.pix_mp.height;
+        layout.bytesperline = fmt.fmt.pix_mp.plane_fmt[0].bytesperline;
+        layout.sizeimage = fmt.fmt.pix_mp.plane_fmt[0].sizeimage;
+        layout.num_planes = fmt.fmt.pix_mp.num_planes;
+    }
+    else
+    {
+        layout.pixelformat = fmt.fmt.pix.pixelformat;
+        layout.width = fmt.fmt.pix.width;
+        layout.height = fmt.fmt.pix.height;
+        layout.bytesperline = fmt.fmt.pix.bytesperline;
+        layout.sizeimage = fmt.fmt.pix.sizeimage;
+        layout.num_planes = 1;
+    }
+}
+
+} // namespace
+
+
+bool v4l2::get_capture_layout(int fd, uint32_t buf_type, capture_layout& layout)
+{
+    v4l2_format fmt = {};
+    fmt.type = buf_type;
+
+    if (tcam_xioctl(fd, VIDIOC_G_FMT, &fmt) == -1)
+    {
+        return false;
+    }
+
+    fill_layout(fmt, layout);
+    return true;
+}
+
+
+bool v4l2::set_capture_format(int fd,
+                              uint32_t buf_type,
+                              uint32_t pixelformat,
+                              uint32_t width,
+                              uint32_t height,
+                              capture_layout& layout)
+{
+    v4l2_format fmt = {};
+    fmt.type = buf_type;
+
+    if (is_mplane(buf_type))
+    {
+        fmt.fmt.pix_mp.width = width;
+        fmt.fmt.pix_mp.height = height;
+        fmt.fmt.pix_mp.pixelformat = pixelformat;
+        fmt.fmt.pix_mp.field = V4L2_FIELD_NONE;
+        fmt.fmt.pix_mp.num_planes = 1;
+    }
+    else
+    {
+        fmt.fmt.pix.width = width;
+        fmt.fmt.pix.height = height;
+        fmt.fmt.pix.pixelformat = pixelformat;
+        fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    }
+
+    if (tcam_xioctl(fd, VIDIOC_S_FMT, &fmt) == -1)
+    {
+        // drivers refuse S_FMT while buffers are allocated,
+        // kept mmap buffers are only reused when the format does not change
+        if (errno == EBUSY && get_capture_layout(fd, buf_type, layout)
+            && layout.pixelformat == pixelformat && layout.width == width
+            && layout.height == height)
+        {
+            return true;
+        }
+        return false;
+    }
+
+    fill_layout(fmt, layout);
+    return true;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <linux/videodev2.h>
+
+namespace tcam::v4l2
+{
+
+// V4L2_BUF_TYPE_VIDEO_CAPTURE, or V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE for drivers that only
+// offer the multi planar api, e.g. MIPI CSI-2 receivers
+uint32_t query_capture_buffer_type(int fd);
+
+constexpr bool is_mplane(uint32_t buf_type) noexcept
+{
+    return buf_type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+}
+
+//
+// v4l2_buffer that works with both capture apis.
+//
+// Only formats that use a single memory plane are supported, which is the case for all
+// formats our cameras deliver. With the multi planar api the plane is stored in here,
+// so the struct is neither copyable nor movable.
+//
+struct capture_buffer
+{
+    capture_buffer(uint32_t type, uint32_t memory, uint32_t index = 0) noexcept;
+
+    capture_buffer(const capture_buffer&) = delete;
+    capture_buffer& operator=(const capture_buffer&) = delete;
+
+    void set_userptr(void* ptr, size_t length) noexcept;
+    void set_dmabuf(int fd, size_t length) noexcept;
+
+    uint32_t bytesused() const noexcept;
+    // mmap offset, valid after VIDIOC_QUERYBUF
+    uint32_t mem_offset() const noexcept;
+    uint32_t length() const noexcept;
+
+    v4l2_buffer buf = {};
+    v4l2_plane plane = {};
+};
+
+// memory layout the driver uses for the current format
+struct capture_layout
+{
+    uint32_t pixelformat = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    // may be larger than width * bytes per pixel when the driver pads lines
+    uint32_t bytesperline = 0;
+    uint32_t sizeimage = 0;
+
+    uint32_t num_planes = 1;
+};
+
+// VIDIOC_G_FMT
+bool get_capture_layout(int fd, uint32_t buf_type, capture_layout& layout);
+
+// VIDIOC_S_FMT, layout receives what the driver actually configured
+bool set_capture_format(int fd,
+                        uint32_t buf_type,
+                        uint32_t pixelformat,
+                        uint32_t width,
+                        uint32_t height,
+                        capture_layout& layout);
+
+} // namespace tcam::v4l2
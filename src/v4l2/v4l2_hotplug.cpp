@@ -0,0 +1,361 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "v4l2_hotplug.h"
+
+#include "../logging.h"
+#include "../ThreadPolicy.h"
+#include "../utils.h"
+
+#include <cstring>
+#include <libudev.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace tcam::v4l2;
+
+
+hotplug_monitor& hotplug_monitor::get_instance()
+{
+    static hotplug_monitor instance;
+    return instance;
+}
+
+
+hotplug_monitor::hotplug_monitor()
+{
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake_fd_ < 0)
+    {
+        SPDLOG_ERROR("Unable to create eventfd: {}", strerror(errno));
+    }
+}
+
+
+hotplug_monitor::~hotplug_monitor()
+{
+    std::thread to_join;
+    {
+        std::scoped_lock lck { mtx_ };
+        running_ = false;
+        to_join = std::move(thread_);
+    }
+    wake();
+    if (to_join.joinable())
+    {
+        to_join.join();
+    }
+
+    if (wake_fd_ >= 0)
+    {
+        close(wake_fd_);
+    }
+}
+
+
+hotplug_monitor::token hotplug_monitor::subscribe(subscription sub)
+{
+    // a thread that ended because all subscriptions were dropped from within a callback
+    std::thread old_thread;
+    {
+        std::scoped_lock lck { mtx_ };
+        if (!running_ && thread_.joinable())
+        {
+            old_thread = std::move(thread_);
+        }
+    }
+    if (old_thread.joinable())
+    {
+        old_thread.join();
+    }
+
+    token t = 0;
+    {
+        std::scoped_lock lck { mtx_ };
+
+        t = next_token_++;
+        subscriptions_.emplace(t, std::make_shared<const subscription>(std::move(sub)));
+        changed_ = true;
+
+        if (!running_ && !thread_.joinable())
+        {
+            running_ = true;
+            thread_ = std::thread(&hotplug_monitor::thread_func, this);
+            thread_id_ = thread_.get_id();
+        }
+    }
+    wake();
+
+    return t;
+}
+
+
+void hotplug_monitor::unsubscribe(token t)
+{
+    std::thread to_join;
+    bool is_monitor_thread = false;
+    {
+        std::scoped_lock lck { mtx_ };
+
+        is_monitor_thread = std::this_thread::get_id() == thread_id_;
+
+        if (subscriptions_.erase(t) > 0)
+        {
+            changed_ = true;
+        }
+
+        if (subscriptions_.empty() && running_)
+        {
+            running_ = false;
+            if (!is_monitor_thread)
+            {
+                to_join = std::move(thread_);
+            }
+        }
+    }
+    wake();
+
+    if (!is_monitor_thread)
+    {
+        // wait for callbacks that are already running
+        std::scoped_lock dispatch_lck { dispatch_mtx_ };
+    }
+
+    if (to_join.joinable())
+    {
+        to_join.join();
+    }
+}
+
+
+void hotplug_monitor::wake()
+{
+    uint64_t val = 1;
+    if (wake_fd_ >= 0 && write(wake_fd_, &val, sizeof(val)) != sizeof(val))
+    {
+        SPDLOG_ERROR("Unable to wake udev monitor thread: {}", strerror(errno));
+    }
+}
+
+
+std::shared_ptr<const hotplug_monitor::subscription> hotplug_monitor::find(token t) const
+{
+    std::scoped_lock lck { mtx_ };
+
+    auto iter = subscriptions_.find(t);
+    if (iter == subscriptions_.end())
+    {
+        return nullptr;
+    }
+    return iter->second;
+}
+
+
+void hotplug_monitor::dispatch_udev_event(const std::string& action,
+                                          const std::string& devnode,
+                                          const std::string& serial)
+{
+    std::scoped_lock dispatch_lck { dispatch_mtx_ };
+
+    std::vector<token> tokens;
+    {
+        std::scoped_lock lck { mtx_ };
+        for (const auto& [t, sub] : subscriptions_) { tokens.push_back(t); }
+    }
+
+    for (auto t : tokens)
+    {
+        // earlier callbacks may have unsubscribed it
+        auto sub = find(t);
+        if (!sub)
+        {
+            continue;
+        }
+
+        if (sub->any_event)
+        {
+            sub->any_event(action, devnode);
+        }
+
+        if (action != "remove" || !sub->removed)
+        {
+            continue;
+        }
+
+        const bool matches = (!sub->devnode.empty() && sub->devnode == devnode)
+                             || (!sub->serial.empty() && sub->serial == serial);
+        if (!matches)
+        {
+            continue;
+        }
+
+        {
+            std::scoped_lock lck { mtx_ };
+            subscriptions_.erase(t);
+            changed_ = true;
+            if (subscriptions_.empty())
+            {
+                running_ = false;
+            }
+        }
+        sub->removed();
+    }
+}
+
+
+void hotplug_monitor::dispatch_control_event(token t)
+{
+    std::scoped_lock dispatch_lck { dispatch_mtx_ };
+
+    auto sub = find(t);
+    if (sub && sub->control_event)
+    {
+        sub->control_event();
+    }
+}
+
+
+void hotplug_monitor::thread_func()
+{
+    tcam::thread_policy::setup_thread("tcam_v4l2_mon");
+
+    udev* udev_ctx = udev_new();
+    udev_monitor* mon = nullptr;
+    if (udev_ctx)
+    {
+        mon = udev_monitor_new_from_netlink(udev_ctx, "udev");
+    }
+    if (mon)
+    {
+        udev_monitor_filter_add_match_subsystem_devtype(mon, "video4linux", NULL);
+        udev_monitor_enable_receiving(mon);
+    }
+    else
+    {
+        // control events still work
+        SPDLOG_ERROR("Failed to create udev monitor. Device removals will not be detected.");
+    }
+
+    // [0] udev, [1] wake_fd_, followed by the device fds of tokens
+    std::vector<pollfd> fds;
+    std::vector<token> tokens;
+
+    while (true)
+    {
+        {
+            std::scoped_lock lck { mtx_ };
+            if (!running_)
+            {
+                break;
+            }
+
+            if (changed_ || fds.empty())
+            {
+                changed_ = false;
+
+                fds.assign(2, pollfd {});
+                fds[0].fd = mon ? udev_monitor_get_fd(mon) : -1;
+                fds[0].events = POLLIN;
+                fds[1].fd = wake_fd_;
+                fds[1].events = POLLIN;
+
+                tokens.clear();
+                for (const auto& [t, sub] : subscriptions_)
+                {
+                    if (sub->fd < 0)
+                    {
+                        continue;
+                    }
+                    pollfd p = {};
+                    p.fd = sub->fd;
+                    // control events are signaled as exceptional condition
+                    p.events = POLLPRI;
+                    fds.push_back(p);
+                    tokens.push_back(t);
+                }
+            }
+        }
+
+        int ret = poll(fds.data(), fds.size(), -1);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            SPDLOG_ERROR("poll on udev monitor failed: {}", strerror(errno));
+
+            std::scoped_lock lck { mtx_ };
+            running_ = false;
+            break;
+        }
+
+        if (fds[1].revents & POLLIN)
+        {
+            uint64_t val = 0;
+            if (read(wake_fd_, &val, sizeof(val)) < 0 && errno != EAGAIN)
+            {
+                SPDLOG_ERROR("Unable to read eventfd: {}", strerror(errno));
+            }
+        }
+
+        for (size_t i = 2; i < fds.size(); ++i)
+        {
+            if (fds[i].revents & POLLPRI)
+            {
+                dispatch_control_event(tokens[i - 2]);
+            }
+            if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL))
+            {
+                // removed or closed device, poll would return immediately until unsubscribed
+                fds[i].fd = -1;
+            }
+        }
+
+        if (!(fds[0].revents & POLLIN))
+        {
+            continue;
+        }
+
+        auto dev = udev_monitor_receive_device(mon);
+        if (!dev)
+        {
+            continue;
+        }
+
+        const char* action = udev_device_get_action(dev);
+        if (action && (strcmp(action, "add") == 0 || strcmp(action, "remove") == 0))
+        {
+            const char* devnode = udev_device_get_devnode(dev);
+            const char* serial = udev_device_get_property_value(dev, "ID_SERIAL_SHORT");
+            SPDLOG_DEBUG("udev: {} {}", action, devnode ? devnode : "");
+
+            dispatch_udev_event(action, devnode ? devnode : "", serial ? serial : "");
+        }
+        udev_device_unref(dev);
+    }
+
+    if (mon)
+    {
+        udev_monitor_unref(mon);
+    }
+    if (udev_ctx)
+    {
+        udev_unref(udev_ctx);
+    }
+}
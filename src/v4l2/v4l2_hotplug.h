@@ -0,0 +1,102 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace tcam::v4l2
+{
+
+//
+// Process wide udev monitor for the video4linux subsystem.
+//
+// One thread watches udev and the control event queues of all open devices and dispatches
+// to the subscriptions. Callbacks are called from that thread and must not block.
+// The thread runs while at least one subscription exists.
+//
+class hotplug_monitor
+{
+public:
+    struct subscription
+    {
+        // removal is matched by devnode or by serial, empty values never match
+        std::string devnode;
+        std::string serial;
+        // called once, the subscription is dropped afterwards
+        std::function<void()> removed;
+
+        // an open device fd that is polled for V4L2 events (POLLPRI), -1 for none
+        // it has to stay open until unsubscribe returned
+        int fd = -1;
+        std::function<void()> control_event;
+
+        // every add/remove event of the subsystem
+        std::function<void(const std::string& action, const std::string& devnode)> any_event;
+    };
+
+    using token = uint64_t;
+
+    static hotplug_monitor& get_instance();
+
+    // Must not be called from within a callback.
+    token subscribe(subscription sub);
+
+    // No callback of the subscription runs after this returned.
+    // May be called from within a callback, then only later callbacks are prevented.
+    void unsubscribe(token t);
+
+    hotplug_monitor(const hotplug_monitor&) = delete;
+    hotplug_monitor& operator=(const hotplug_monitor&) = delete;
+
+private:
+    hotplug_monitor();
+    ~hotplug_monitor();
+
+    void thread_func();
+    void wake();
+
+    void dispatch_udev_event(const std::string& action,
+                             const std::string& devnode,
+                             const std::string& serial);
+    void dispatch_control_event(token t);
+
+    // returns the subscription while it is registered
+    std::shared_ptr<const subscription> find(token t) const;
+
+    mutable std::mutex mtx_;
+    std::map<token, std::shared_ptr<const subscription>> subscriptions_;
+    token next_token_ = 1;
+    // set when subscriptions_ changed and the poll set has to be rebuilt
+    bool changed_ = false;
+
+    bool running_ = false;
+    std::thread thread_;
+    std::thread::id thread_id_;
+    // written to interrupt poll
+    int wake_fd_ = -1;
+
+    // held while callbacks run, unsubscribe waits on it
+    std::mutex dispatch_mtx_;
+};
+
+} // namespace tcam::v4l2
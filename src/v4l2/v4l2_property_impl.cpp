@@ -90,6 +90,23 @@ outcome::result<void> tcam::v4l2::V4L2PropertyBackendWrapper::set_backend_value(
     return outcome::success();
 }
 
+std::shared_ptr<tcam::property::IPropertyWriteBatch> tcam::v4l2::V4L2PropertyBackendWrapper::
+    get_write_batch() const
+{
+    return device_ptr_.lock();
+}
+
+std::vector<tcam::v4l2::menu_entry> tcam::v4l2::V4L2PropertyBackendWrapper::get_menu_entries(
+    int max) const
+{
+    if (auto ptr = device_ptr_.lock())
+    {
+        return ptr->get_menu_entries(v4l2_id_, max);
+    }
+    SPDLOG_ERROR("Unable to lock v4l2 device backend. Cannot retrieve menu entries.");
+    return {};
+}
+
 outcome::result<int64_t> tcam::v4l2::V4L2PropertyBackendWrapper::get_backend_value() const
 {
     return get_backend_value(v4l2_id_);
@@ -382,11 +399,9 @@ outcome::result<void> tcam::v4l2::V4L2PropertyCommandImpl::execute()
 tcam::v4l2::V4L2PropertyEnumImpl::V4L2PropertyEnumImpl(
     const v4l2_queryctrl& queryctrl,
     const std::shared_ptr<V4L2PropertyBackend>& backend)
-    : V4L2PropertyImplBase(queryctrl, backend)
+    : V4L2PropertyImplBase(queryctrl, backend), m_menu_max(queryctrl.maximum),
+      m_default_value(queryctrl.default_value)
 {
-    m_entries = backend->get_menu_entries(queryctrl.id, queryctrl.maximum);
-
-    m_default = get_entry_name(queryctrl.default_value);
 }
 
 tcam::v4l2::V4L2PropertyEnumImpl::V4L2PropertyEnumImpl(
@@ -394,18 +409,20 @@ tcam::v4l2::V4L2PropertyEnumImpl::V4L2PropertyEnumImpl(
     const std::shared_ptr<V4L2PropertyBackend>& backend,
     const tcamprop1::prop_static_info_enumeration* static_info,
     tcam::v4l2::fetch_menu_entries_func func)
-    : V4L2PropertyImplBase(queryctrl, static_info, backend), p_static_info(static_info)
+    : V4L2PropertyImplBase(queryctrl, static_info, backend), m_menu_max(queryctrl.maximum),
+      m_default_value(queryctrl.default_value), p_static_info(static_info)
 {
     if (func)
     {
-        m_entries = func();
-    }
-    else
-    {
-        m_entries = backend->get_menu_entries(queryctrl.id, queryctrl.maximum);
+        std::call_once(m_entries_flag, [this, func] { m_entries = func(); });
     }
+}
 
-    m_default = get_entry_name(queryctrl.default_value);
+const std::vector<tcam::v4l2::menu_entry>& tcam::v4l2::V4L2PropertyEnumImpl::get_menu() const
+{
+    std::call_once(m_entries_flag,
+                   [this] { m_entries = backend_.get_menu_entries(m_menu_max); });
+    return m_entries;
 }
 
 outcome::result<void> tcam::v4l2::V4L2PropertyEnumImpl::set_value(
@@ -434,7 +451,7 @@ outcome::result<std::string_view> tcam::v4l2::V4L2PropertyEnumImpl::get_value()
 {
     OUTCOME_TRY(int64_t value, backend_.get_backend_value());
 
-    for (const auto& [entry_value, entry_name] : m_entries)
+    for (const auto& [entry_value, entry_name] : get_menu())
     {
         if (entry_value == value)
         {
@@ -447,14 +464,14 @@ outcome::result<std::string_view> tcam::v4l2::V4L2PropertyEnumImpl::get_value()
 std::vector<std::string> tcam::v4l2::V4L2PropertyEnumImpl::get_entries() const
 {
     std::vector<std::string> v;
-    v.reserve(m_entries.size());
-    for (const auto& [entry_value, entry_name] : m_entries) { v.push_back(entry_name); }
+    v.reserve(get_menu().size());
+    for (const auto& [entry_value, entry_name] : get_menu()) { v.push_back(entry_name); }
     return v;
 }
 
 std::string_view tcam::v4l2::V4L2PropertyEnumImpl::get_entry_name(int value) const
 {
-    for (const auto& [entry_value, entry_name] : m_entries)
+    for (const auto& [entry_value, entry_name] : get_menu())
     {
         if (entry_value == value)
         {
@@ -467,7 +484,7 @@ std::string_view tcam::v4l2::V4L2PropertyEnumImpl::get_entry_name(int value) con
 outcome::result<int64_t> tcam::v4l2::V4L2PropertyEnumImpl::get_entry_value(
     std::string_view name) const
 {
-    for (const auto& [entry_value, entry_name] : m_entries)
+    for (const auto& [entry_value, entry_name] : get_menu())
     {
         if (entry_name == name)
         {
@@ -24,6 +24,7 @@
 
 #include <linux/videodev2.h>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <tcamprop1.0_base/tcamprop_property_info.h>
 
@@ -58,6 +59,10 @@ public:
     outcome::result<void> set_backend_value(uint32_t ctrl_id, int64_t new_value);
     outcome::result<int64_t> get_backend_value(uint32_t ctrl_id) const;
 
+    std::shared_ptr<tcam::property::IPropertyWriteBatch> get_write_batch() const;
+
+    std::vector<tcam::v4l2::menu_entry> get_menu_entries(int max) const;
+
 private:
     uint32_t v4l2_id_ = 0;
 
@@ -94,9 +99,17 @@ private:
 };
 
 template<class TPropertyInterface>
-class V4L2PropertyImplBase : public V4L2PropertyLockImpl, public TPropertyInterface
+class V4L2PropertyImplBase :
+    public V4L2PropertyLockImpl,
+    public TPropertyInterface,
+    public tcam::property::IPropertyWriteBatchProvider
 {
 public:
+    std::shared_ptr<tcam::property::IPropertyWriteBatch> get_write_batch() const final
+    {
+        return backend_.get_write_batch();
+    }
+
     tcamprop1::prop_static_info get_static_info() const final
     {
         if (p_static_info_base)
@@ -270,7 +283,7 @@ public:
 
     outcome::result<std::string_view> get_default() const final
     {
-        return m_default;
+        return get_entry_name(m_default_value);
     }
 
     std::vector<std::string> get_entries() const override;
@@ -281,9 +294,14 @@ private:
     std::string_view get_entry_name(int value) const;
     outcome::result<int64_t> get_entry_value(std::string_view name) const;
 
-    std::vector<tcam::v4l2::menu_entry> m_entries;
+    // the menu of the device is queried on first use, most enumerations are never looked at
+    const std::vector<tcam::v4l2::menu_entry>& get_menu() const;
+
+    mutable std::once_flag m_entries_flag;
+    mutable std::vector<tcam::v4l2::menu_entry> m_entries;
+    int m_menu_max = 0;
 
-    std::string m_default;
+    int m_default_value = 0;
 
     const tcamprop1::prop_static_info_enumeration* p_static_info = nullptr;
 };
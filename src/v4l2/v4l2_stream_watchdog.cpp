@@ -0,0 +1,121 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "v4l2_stream_watchdog.h"
+
+#include "../utils.h"
+
+#include <algorithm>
+
+using namespace tcam::v4l2;
+
+namespace
+{
+
+// usb transfers and driver scheduling add latency that is independent of the frame rate
+constexpr auto min_stall_timeout = std::chrono::milliseconds(250);
+
+// sensors need a while until the first image after STREAMON
+constexpr auto first_image_grace = std::chrono::seconds(1);
+
+// trigger mode does not time out, but the stream thread rechecks the timing regularly
+constexpr auto trigger_wait_timeout = std::chrono::seconds(1);
+
+} // namespace
+
+
+void stream_watchdog::reset(const timing& t, clock::time_point now)
+{
+    last_image_ = now;
+    waiting_for_first_image_ = true;
+    stall_count_ = 0;
+    stall_periods_ = get_default_stall_periods();
+    update(t);
+}
+
+
+void stream_watchdog::update(const timing& t)
+{
+    trigger_mode_ = t.trigger_mode;
+
+    double interval_us = t.exposure_us;
+    if (t.framerate > 0)
+    {
+        interval_us = std::max(interval_us, 1000000.0 / t.framerate);
+    }
+
+    auto timeout = std::chrono::microseconds(
+        static_cast<int64_t>(interval_us * stall_periods_));
+
+    timeout_ = std::max<std::chrono::microseconds>(timeout, min_stall_timeout);
+}
+
+
+void stream_watchdog::image_received(clock::time_point now)
+{
+    last_image_ = now;
+    waiting_for_first_image_ = false;
+    stall_count_ = 0;
+}
+
+
+void stream_watchdog::stream_restarted(clock::time_point now)
+{
+    last_image_ = now;
+    waiting_for_first_image_ = true;
+}
+
+
+std::chrono::milliseconds stream_watchdog::get_wait_timeout(clock::time_point now) const
+{
+    if (trigger_mode_)
+    {
+        return trigger_wait_timeout;
+    }
+
+    auto remaining = std::chrono::ceil<std::chrono::milliseconds>(get_deadline() - now);
+    return std::max(remaining, std::chrono::milliseconds(1));
+}
+
+
+bool stream_watchdog::check_stalled(clock::time_point now)
+{
+    if (trigger_mode_ || now < get_deadline())
+    {
+        return false;
+    }
+
+    last_image_ = now;
+    waiting_for_first_image_ = false;
+    stall_count_++;
+    return true;
+}
+
+
+stream_watchdog::clock::time_point stream_watchdog::get_deadline() const
+{
+    if (waiting_for_first_image_)
+    {
+        return last_image_ + timeout_ + first_image_grace;
+    }
+    return last_image_ + timeout_;
+}
+
+
+int stream_watchdog::get_default_stall_periods()
+{
+    return std::max(tcam::get_environment_variable_int("TCAM_V4L2_STALL_PERIODS").value_or(4), 1);
+}
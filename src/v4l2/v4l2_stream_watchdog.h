@@ -0,0 +1,90 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+
+namespace tcam::v4l2
+{
+
+//
+// Decides when a running stream that does not deliver images is stalled.
+//
+// The expected distance between two images is the larger one of frame period and exposure
+// time. The stream is stalled when no image arrived for stall_periods of those. After a stall
+// the waiting starts anew, so a stream that stays silent is reported once per timeout.
+//
+// Streams in trigger mode never stall, images only arrive when the trigger fires.
+//
+// Not thread safe, meant for the stream thread only.
+//
+class stream_watchdog
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct timing
+    {
+        double framerate = 0; // 0 when unknown
+        double exposure_us = 0; // 0 when unknown
+        bool trigger_mode = false;
+    };
+
+    // start of a stream, the first image gets additional time, reads TCAM_V4L2_STALL_PERIODS
+    void reset(const timing& t, clock::time_point now);
+
+    // timing changed while streaming
+    void update(const timing& t);
+
+    void image_received(clock::time_point now);
+
+    // the stream was switched off and on again, the stall count is kept
+    void stream_restarted(clock::time_point now);
+
+    // how long the stream thread may wait for an image before calling check_stalled
+    std::chrono::milliseconds get_wait_timeout(clock::time_point now) const;
+
+    // true when the timeout is over, this also restarts the waiting
+    bool check_stalled(clock::time_point now);
+
+    // stalls since the last image
+    int get_stall_count() const noexcept
+    {
+        return stall_count_;
+    }
+
+    std::chrono::microseconds get_stall_timeout() const noexcept
+    {
+        return timeout_;
+    }
+
+    // reads TCAM_V4L2_STALL_PERIODS
+    static int get_default_stall_periods();
+
+private:
+    clock::time_point get_deadline() const;
+
+    std::chrono::microseconds timeout_ { std::chrono::seconds(2) };
+    clock::time_point last_image_;
+    bool waiting_for_first_image_ = true;
+    bool trigger_mode_ = false;
+    int stall_count_ = 0;
+    // image intervals without an image until the stream counts as stalled, set by reset
+    int stall_periods_ = 4;
+};
+
+} // namespace tcam::v4l2
@@ -24,10 +24,11 @@
 #endif
 
 #include <glob.h>
+#include <sys/stat.h>
 #include <linux/videodev2.h>
 #include <regex>
 
-std::vector<tcam::DeviceInfo> tcam::get_v4l2_device_list()
+std::vector<tcam::DeviceInfo> tcam::get_v4l2_device_list(const std::string& serial)
 {
     struct udev* udev = udev_new();
     if (!udev)
@@ -161,6 +162,18 @@ std::vector<tcam::DeviceInfo> tcam::get_v4l2_device_list()
                 strncpy(info.serial_number, tmp.c_str(), sizeof(info.serial_number) - 1);
             }
 
+            if (!serial.empty())
+            {
+                if (serial != info.serial_number)
+                {
+                    udev_device_unref(dev);
+                    continue;
+                }
+                device_list.push_back(DeviceInfo(info));
+                udev_device_unref(dev);
+                break;
+            }
+
             auto new_dev = DeviceInfo(info);
             if (!device_is_known(new_dev))
             {
@@ -243,3 +256,67 @@ uint32_t tcam::v4l2::fetch_product_id(const DeviceInfo& info)
     }
     return std::strtol(info.get_info().additional_identifier, nullptr, 16);
 }
+
+std::string tcam::v4l2::fetch_firmware_revision(const DeviceInfo& info)
+{
+    if (info.get_device_type() != TCAM_DEVICE_TYPE_V4L2)
+    {
+        return {};
+    }
+
+    struct stat st = {};
+    if (stat(info.get_info().identifier, &st) != 0 || !S_ISCHR(st.st_mode))
+    {
+        return {};
+    }
+
+    struct udev* udev = udev_new();
+    if (!udev)
+    {
+        return {};
+    }
+
+    std::string ret;
+
+    struct udev_device* dev = udev_device_new_from_devnum(udev, 'c', st.st_rdev);
+    if (dev)
+    {
+        // owned by dev
+        struct udev_device* parent_device =
+            udev_device_get_parent_with_subsystem_devtype(dev, "usb", "usb_device");
+        if (parent_device)
+        {
+            const char* revision = udev_device_get_sysattr_value(parent_device, "bcdDevice");
+            if (revision)
+            {
+                ret = revision;
+            }
+        }
+        udev_device_unref(dev);
+    }
+
+    udev_unref(udev);
+
+    return ret;
+}
+
+uint32_t tcam::v4l2::memory_type_to_v4l2_memory(TCAM_MEMORY_TYPE t)
+{
+    switch (t)
+    {
+        case TCAM_MEMORY_TYPE_USERPTR:
+        {
+            return V4L2_MEMORY_USERPTR;
+        }
+        case TCAM_MEMORY_TYPE_MMAP:
+        case TCAM_MEMORY_TYPE_DMA:
+        {
+            return V4L2_MEMORY_MMAP;
+        }
+        case TCAM_MEMORY_TYPE_DMA_IMPORT:
+        {
+            return V4L2_MEMORY_DMABUF;
+        }
+    }
+    return V4L2_MEMORY_USERPTR;
+}
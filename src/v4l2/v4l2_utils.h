@@ -20,6 +20,7 @@
 #include "../DeviceInfo.h"
 #include "../compiler_defines.h"
 
+#include <string>
 #include <vector>
 
 VISIBILITY_INTERNAL
@@ -43,13 +44,22 @@ enum class v4l2_device_type
 
 v4l2_device_type get_device_type(const DeviceInfo&);
 uint32_t fetch_product_id(const DeviceInfo&);
+
+// bcdDevice of the usb device behind the devnode, e.g. "0114"
+// empty when it cannot be determined
+std::string fetch_firmware_revision(const DeviceInfo&);
+
+// v4l2_memory used for VIDIOC_QBUF/VIDIOC_DQBUF/VIDIOC_REQBUFS
+// exported dma buffers are driver buffers and use V4L2_MEMORY_MMAP
+uint32_t memory_type_to_v4l2_memory(TCAM_MEMORY_TYPE t);
 }
 /**
  * @name get_v4l2_device_list
  * @brief lists all supported v4l2 devices
+ * @param serial - when not empty, only the first device with this serial is returned
  * @return vector containing all found v4l2 devices
  */
-std::vector<DeviceInfo> get_v4l2_device_list();
+std::vector<DeviceInfo> get_v4l2_device_list(const std::string& serial = {});
 
 } /* namespace tcam */
 
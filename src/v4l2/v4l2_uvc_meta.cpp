@@ -0,0 +1,574 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "v4l2_uvc_meta.h"
+
+#include "../logging.h"
+#include "../utils.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <libudev.h>
+#include <linux/videodev2.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace tcam;
+
+
+namespace
+{
+
+// bmHeaderInfo of the payload header
+constexpr uint8_t uvc_header_pts = 1 << 2;
+constexpr uint8_t uvc_header_scr = 1 << 3;
+
+constexpr size_t uvc_header_pts_size = 4;
+constexpr size_t uvc_header_scr_size = 6;
+
+// struct uvc_meta_buf without the payload header, which starts with bHeaderLength
+constexpr size_t uvc_meta_block_size = sizeof(uint64_t) + sizeof(uint16_t);
+
+// KSCAMERA_METADATA_ITEMHEADER, Size includes the header
+constexpr size_t ms_item_header_size = 8;
+constexpr uint32_t ms_metadata_id_capture_stats = 3;
+constexpr uint32_t ms_capture_stats_flag_exposure_time = 1 << 0;
+// Flags, Reserved, ExposureTime in 100 ns
+constexpr size_t ms_capture_stats_exposure_end = ms_item_header_size + 4 + 4 + 8;
+
+template<typename T> T read_le(const uint8_t* p) noexcept
+{
+    T val = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        val |= static_cast<T>(p[i]) << (8 * i);
+    }
+    return val;
+}
+
+void parse_ms_metadata(const uint8_t* data, size_t size, v4l2::uvc_frame_meta& meta)
+{
+    while (size >= ms_item_header_size)
+    {
+        const auto id = read_le<uint32_t>(data);
+        const auto item_size = read_le<uint32_t>(data + 4);
+        if (item_size < ms_item_header_size || item_size > size)
+        {
+            return;
+        }
+
+        if (id == ms_metadata_id_capture_stats && item_size >= ms_capture_stats_exposure_end)
+        {
+            const auto flags = read_le<uint32_t>(data + ms_item_header_size);
+            if (flags & ms_capture_stats_flag_exposure_time)
+            {
+                const auto exposure = read_le<uint64_t>(data + ms_item_header_size + 8);
+                meta.has_exposure_time = true;
+                meta.exposure_time_us = exposure / 10.0;
+            }
+        }
+
+        data += item_size;
+        size -= item_size;
+    }
+}
+
+// owned by dev, nullptr when the device is not an usb device
+const char* get_usb_parent_syspath(udev_device* dev, const char* devtype)
+{
+    auto parent = udev_device_get_parent_with_subsystem_devtype(dev, "usb", devtype);
+    return parent ? udev_device_get_syspath(parent) : nullptr;
+}
+
+udev_device* open_udev_device(udev* udev, const std::string& devnode)
+{
+    struct stat st = {};
+    if (stat(devnode.c_str(), &st) == -1)
+    {
+        return nullptr;
+    }
+    return udev_device_new_from_devnum(udev, 'c', st.st_rdev);
+}
+
+bool is_meta_capture_node(const char* devnode)
+{
+    int fd = open(devnode, O_RDWR | O_NONBLOCK);
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    v4l2_capability cap = {};
+    bool ret = false;
+    if (tcam_xioctl(fd, VIDIOC_QUERYCAP, &cap) != -1)
+    {
+        const uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps
+                                                                         : cap.capabilities;
+        ret = (caps & V4L2_CAP_META_CAPTURE) != 0;
+    }
+    close(fd);
+    return ret;
+}
+
+} // namespace
+
+
+bool v4l2::parse_uvc_meta(const uint8_t* data, size_t size, uvc_frame_meta& meta)
+{
+    bool found = false;
+
+    while (size > uvc_meta_block_size)
+    {
+        const uint8_t* header = data + uvc_meta_block_size;
+        const size_t header_length = header[0];
+        if (header_length < 2 || uvc_meta_block_size + header_length > size)
+        {
+            break;
+        }
+        found = true;
+
+        const uint8_t info = header[1];
+        size_t offset = 2;
+        if (info & uvc_header_pts)
+        {
+            if (offset + uvc_header_pts_size > header_length)
+            {
+                break;
+            }
+            if (!meta.has_pts)
+            {
+                meta.has_pts = true;
+                meta.pts = read_le<uint32_t>(header + offset);
+            }
+            offset += uvc_header_pts_size;
+        }
+        if (info & uvc_header_scr)
+        {
+            offset += uvc_header_scr_size;
+        }
+
+        // everything behind the standard fields belongs to the device
+        if (offset < header_length)
+        {
+            parse_ms_metadata(header + offset, header_length - offset, meta);
+        }
+
+        data += uvc_meta_block_size + header_length;
+        size -= uvc_meta_block_size + header_length;
+    }
+    return found;
+}
+
+
+std::string v4l2::find_uvc_meta_node(const std::string& video_devnode)
+{
+    std::string ret;
+
+    udev* udev = udev_new();
+    if (!udev)
+    {
+        return ret;
+    }
+
+    udev_device* video_dev = open_udev_device(udev, video_devnode);
+    const char* interface =
+        video_dev ? get_usb_parent_syspath(video_dev, "usb_interface") : nullptr;
+    if (!interface)
+    {
+        if (video_dev)
+        {
+            udev_device_unref(video_dev);
+        }
+        udev_unref(udev);
+        return ret;
+    }
+
+    udev_enumerate* enumerate = udev_enumerate_new(udev);
+    udev_enumerate_add_match_subsystem(enumerate, "video4linux");
+    udev_enumerate_scan_devices(enumerate);
+
+    udev_list_entry* entry = nullptr;
+    udev_list_entry_foreach(entry, udev_enumerate_get_list_entry(enumerate))
+    {
+        udev_device* dev = udev_device_new_from_syspath(udev, udev_list_entry_get_name(entry));
+        if (!dev)
+        {
+            continue;
+        }
+
+        const char* devnode = udev_device_get_devnode(dev);
+        const char* parent = get_usb_parent_syspath(dev, "usb_interface");
+        if (devnode && parent && strcmp(parent, interface) == 0 && video_devnode != devnode
+            && is_meta_capture_node(devnode))
+        {
+            ret = devnode;
+        }
+        udev_device_unref(dev);
+
+        if (!ret.empty())
+        {
+            break;
+        }
+    }
+
+    udev_enumerate_unref(enumerate);
+    udev_device_unref(video_dev);
+    udev_unref(udev);
+
+    return ret;
+}
+
+
+uint32_t v4l2::fetch_uvc_clock_frequency(const std::string& video_devnode)
+{
+    std::string path;
+
+    udev* udev = udev_new();
+    if (!udev)
+    {
+        return 0;
+    }
+    if (udev_device* dev = open_udev_device(udev, video_devnode))
+    {
+        if (const char* usb_device = get_usb_parent_syspath(dev, "usb_device"))
+        {
+            path = std::string(usb_device) + "/descriptors";
+        }
+        udev_device_unref(dev);
+    }
+    udev_unref(udev);
+
+    if (path.empty())
+    {
+        return 0;
+    }
+
+    // device descriptor followed by all configuration descriptors
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<uint8_t> desc((std::istreambuf_iterator<char>(file)),
+                                    std::istreambuf_iterator<char>());
+
+    constexpr uint8_t type_interface = 0x04;
+    constexpr uint8_t type_cs_interface = 0x24;
+    constexpr uint8_t class_video = 0x0E;
+    constexpr uint8_t subclass_video_control = 0x01;
+    constexpr uint8_t vc_header = 0x01;
+
+    bool in_video_control = false;
+    for (size_t i = 0; i + 2 <= desc.size() && desc[i] >= 2; i += desc[i])
+    {
+        const uint8_t length = desc[i];
+        if (i + length > desc.size())
+        {
+            break;
+        }
+
+        const uint8_t type = desc[i + 1];
+        if (type == type_interface && length >= 9)
+        {
+            in_video_control = desc[i + 5] == class_video && desc[i + 6] == subclass_video_control;
+        }
+        else if (in_video_control && type == type_cs_interface && length >= 12
+                 && desc[i + 2] == vc_header)
+        {
+            // bcdUVC and wTotalLength precede dwClockFrequency
+            return read_le<uint32_t>(&desc[i + 7]);
+        }
+    }
+    return 0;
+}
+
+
+void v4l2::uvc_clock::reset(uint32_t clock_frequency) noexcept
+{
+    frequency_ = clock_frequency;
+    wraps_ = 0;
+    last_pts_ = 0;
+    has_last_ = false;
+}
+
+
+uint64_t v4l2::uvc_clock::to_ns(uint32_t pts) noexcept
+{
+    if (frequency_ == 0)
+    {
+        return 0;
+    }
+
+    if (has_last_ && pts < last_pts_)
+    {
+        ++wraps_;
+    }
+    last_pts_ = pts;
+    has_last_ = true;
+
+    const uint64_t ticks = (wraps_ << 32) | pts;
+    return (ticks / frequency_) * 1'000'000'000 + (ticks % frequency_) * 1'000'000'000 / frequency_;
+}
+
+
+v4l2::uvc_meta_stream::~uvc_meta_stream()
+{
+    stop();
+}
+
+
+bool v4l2::uvc_meta_stream::start(const std::string& video_devnode, size_t buffer_count)
+{
+    stop();
+
+#if defined(V4L2_META_FMT_UVC)
+    const auto devnode = find_uvc_meta_node(video_devnode);
+    if (devnode.empty())
+    {
+        return false;
+    }
+
+    fd_ = open(devnode.c_str(), O_RDWR | O_NONBLOCK);
+    if (fd_ == -1)
+    {
+        SPDLOG_WARN("Unable to open uvc metadata node {}: {}", devnode, strerror(errno));
+        return false;
+    }
+
+    v4l2_format fmt = {};
+    fmt.type = V4L2_BUF_TYPE_META_CAPTURE;
+    fmt.fmt.meta.dataformat = V4L2_META_FMT_UVC;
+    if (tcam_xioctl(fd_, VIDIOC_S_FMT, &fmt) == -1)
+    {
+        SPDLOG_WARN("Unable to set the uvc metadata format on {}: {}", devnode, strerror(errno));
+        release();
+        return false;
+    }
+
+    v4l2_requestbuffers req = {};
+    req.count = buffer_count;
+    req.type = V4L2_BUF_TYPE_META_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (tcam_xioctl(fd_, VIDIOC_REQBUFS, &req) == -1 || req.count == 0)
+    {
+        SPDLOG_WARN("Unable to allocate uvc metadata buffers on {}: {}", devnode, strerror(errno));
+        release();
+        return false;
+    }
+
+    buffers_.resize(req.count);
+    for (uint32_t i = 0; i < req.count; ++i)
+    {
+        v4l2_buffer buf = {};
+        buf.type = V4L2_BUF_TYPE_META_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (tcam_xioctl(fd_, VIDIOC_QUERYBUF, &buf) == -1)
+        {
+            SPDLOG_WARN("Unable to query uvc metadata buffer {}: {}", i, strerror(errno));
+            release();
+            return false;
+        }
+
+        void* start = mmap(nullptr, buf.length, PROT_READ, MAP_SHARED, fd_, buf.m.offset);
+        if (start == MAP_FAILED)
+        {
+            SPDLOG_WARN("Unable to map uvc metadata buffer {}: {}", i, strerror(errno));
+            release();
+            return false;
+        }
+        buffers_[i] = { start, buf.length };
+    }
+
+    for (uint32_t i = 0; i < buffers_.size(); ++i)
+    {
+        if (!queue(i))
+        {
+            release();
+            return false;
+        }
+    }
+
+    auto type = static_cast<v4l2_buf_type>(V4L2_BUF_TYPE_META_CAPTURE);
+    if (tcam_xioctl(fd_, VIDIOC_STREAMON, &type) == -1)
+    {
+        SPDLOG_WARN("Unable to start the uvc metadata stream: {}", strerror(errno));
+        release();
+        return false;
+    }
+
+    clock_.reset(fetch_uvc_clock_frequency(video_devnode));
+    has_pending_ = false;
+
+    SPDLOG_DEBUG("Streaming uvc metadata from {}", devnode);
+    return true;
+#else
+    (void)video_devnode;
+    (void)buffer_count;
+    return false;
+#endif
+}
+
+
+void v4l2::uvc_meta_stream::stop()
+{
+    if (fd_ == -1)
+    {
+        return;
+    }
+
+    auto type = static_cast<v4l2_buf_type>(V4L2_BUF_TYPE_META_CAPTURE);
+    tcam_xioctl(fd_, VIDIOC_STREAMOFF, &type);
+
+    release();
+}
+
+
+bool v4l2::uvc_meta_stream::restart()
+{
+    if (fd_ == -1)
+    {
+        return false;
+    }
+
+    auto type = static_cast<v4l2_buf_type>(V4L2_BUF_TYPE_META_CAPTURE);
+    if (tcam_xioctl(fd_, VIDIOC_STREAMOFF, &type) == -1)
+    {
+        return false;
+    }
+
+    // STREAMOFF returns all buffers to us
+    for (uint32_t i = 0; i < buffers_.size(); ++i)
+    {
+        queue(i);
+    }
+    has_pending_ = false;
+
+    return tcam_xioctl(fd_, VIDIOC_STREAMON, &type) != -1;
+}
+
+
+bool v4l2::uvc_meta_stream::get_meta(uint32_t sequence, uvc_frame_meta& meta)
+{
+    if (fd_ == -1)
+    {
+        return false;
+    }
+
+    // sequence numbers wrap around
+    auto is_before = [](uint32_t a, uint32_t b) { return static_cast<int32_t>(a - b) < 0; };
+
+    if (has_pending_)
+    {
+        if (is_before(sequence, pending_.sequence))
+        {
+            return false;
+        }
+        has_pending_ = false;
+        if (pending_.sequence == sequence)
+        {
+            meta = pending_;
+            return true;
+        }
+    }
+
+    for (size_t i = 0; i < buffers_.size(); ++i)
+    {
+        v4l2_buffer buf = {};
+        buf.type = V4L2_BUF_TYPE_META_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+
+        int ret = 0;
+        do {
+            ret = ioctl(fd_, VIDIOC_DQBUF, &buf);
+        } while (ret == -1 && errno == EINTR);
+
+        if (ret == -1)
+        {
+            // EAGAIN, the metadata of this frame was dropped by the driver
+            return false;
+        }
+
+        uvc_frame_meta parsed;
+        parsed.sequence = buf.sequence;
+        const bool valid = buf.index < buffers_.size()
+                           && parse_uvc_meta(static_cast<const uint8_t*>(buffers_[buf.index].start),
+                                             std::min<size_t>(buf.bytesused,
+                                                              buffers_[buf.index].length),
+                                             parsed);
+        queue(buf.index);
+
+        if (!valid || is_before(buf.sequence, sequence))
+        {
+            continue;
+        }
+        if (buf.sequence == sequence)
+        {
+            meta = parsed;
+            return true;
+        }
+
+        pending_ = parsed;
+        has_pending_ = true;
+        return false;
+    }
+    return false;
+}
+
+
+uint64_t v4l2::uvc_meta_stream::get_camera_time_ns(const uvc_frame_meta& meta)
+{
+    return meta.has_pts ? clock_.to_ns(meta.pts) : 0;
+}
+
+
+bool v4l2::uvc_meta_stream::queue(uint32_t index)
+{
+    v4l2_buffer buf = {};
+    buf.type = V4L2_BUF_TYPE_META_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = index;
+
+    if (tcam_xioctl(fd_, VIDIOC_QBUF, &buf) == -1)
+    {
+        SPDLOG_WARN("Unable to queue uvc metadata buffer {}: {}", index, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+
+void v4l2::uvc_meta_stream::release()
+{
+    for (auto& b : buffers_)
+    {
+        if (b.start)
+        {
+            munmap(b.start, b.length);
+        }
+    }
+    buffers_.clear();
+
+    if (fd_ != -1)
+    {
+        // frees the driver buffers
+        close(fd_);
+        fd_ = -1;
+    }
+    has_pending_ = false;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tcam::v4l2
+{
+
+// Values of one frame taken from the UVC payload header and the Microsoft camera metadata
+// (KSCAMERA_METADATA_CAPTURESTATS) that devices may append to the header.
+struct uvc_frame_meta
+{
+    uint32_t sequence = 0; // v4l2_buffer.sequence of the video buffer
+
+    bool has_pts = false;
+    uint32_t pts = 0; // dwPresentationTime, ticks of the camera clock
+
+    bool has_exposure_time = false;
+    double exposure_time_us = 0.0;
+};
+
+// Parses a V4L2_META_FMT_UVC buffer.
+// The driver stores the header of every payload whose header differs from the previous one,
+// the first PTS and the last capture stats of the frame are used.
+// Returns false when the buffer contains no header.
+bool parse_uvc_meta(const uint8_t* data, size_t size, uvc_frame_meta& meta);
+
+// Metadata devnode of the usb interface of video_devnode, e.g. /dev/video1 for /dev/video0.
+// Empty for devices that are not driven by uvcvideo and for kernels older than 4.16.
+std::string find_uvc_meta_node(const std::string& video_devnode);
+
+// dwClockFrequency of the VideoControl interface header descriptor, 0 when unknown
+uint32_t fetch_uvc_clock_frequency(const std::string& video_devnode);
+
+//
+// Converts the 32 bit PTS of the payload headers to ns of the camera clock.
+// Wrap arounds are counted, so the time keeps increasing while frames arrive at least once
+// per wrap around period (71 minutes at 1 MHz, 30 seconds at 144 MHz).
+//
+class uvc_clock
+{
+public:
+    void reset(uint32_t clock_frequency) noexcept;
+
+    // 0 when the clock frequency is unknown
+    uint64_t to_ns(uint32_t pts) noexcept;
+
+private:
+    uint32_t frequency_ = 0;
+    uint64_t wraps_ = 0;
+    uint32_t last_pts_ = 0;
+    bool has_last_ = false;
+};
+
+//
+// Streams the metadata node of a uvcvideo device together with its video node.
+//
+// The driver completes the metadata buffer of a frame before the video buffer and gives both
+// the same sequence number. Metadata buffers that were not claimed by a video buffer are
+// requeued, so a slow consumer never starves the metadata queue.
+//
+// start/stop are called from the control thread, get_meta from the stream thread.
+//
+class uvc_meta_stream
+{
+public:
+    uvc_meta_stream() = default;
+    ~uvc_meta_stream();
+
+    uvc_meta_stream(const uvc_meta_stream&) = delete;
+    uvc_meta_stream& operator=(const uvc_meta_stream&) = delete;
+
+    // Opens the metadata node of video_devnode and switches it on.
+    // Returns false when the device has no metadata node, the video stream works without it.
+    bool start(const std::string& video_devnode, size_t buffer_count);
+
+    void stop();
+
+    bool is_streaming() const noexcept
+    {
+        return fd_ != -1;
+    }
+
+    // STREAMOFF/STREAMON, all buffers are queued again
+    bool restart();
+
+    // Dequeues metadata buffers until the one of sequence is found.
+    // Returns false when the metadata of the frame was lost or does not contain a header.
+    bool get_meta(uint32_t sequence, uvc_frame_meta& meta);
+
+    // camera time of the PTS in meta, 0 when not available
+    uint64_t get_camera_time_ns(const uvc_frame_meta& meta);
+
+private:
+    struct mapping
+    {
+        void* start = nullptr;
+        size_t length = 0;
+    };
+
+    bool queue(uint32_t index);
+    void release();
+
+    int fd_ = -1;
+    std::vector<mapping> buffers_;
+    uvc_clock clock_;
+
+    // metadata of a later frame that was dequeued before its video buffer
+    bool has_pending_ = false;
+    uvc_frame_meta pending_;
+};
+
+} // namespace tcam::v4l2
@@ -16,6 +16,7 @@
 
 #include "virtcam_device.h"
 
+#include "../ThreadPolicy.h"
 #include "../logging.h"
 #include "../utils.h"
 #include "dutils_img/image_fourcc.h"
@@ -69,6 +70,11 @@ tcam::virtcam::VirtcamDevice::VirtcamDevice(const DeviceInfo& info, const std::v
 tcam::virtcam::VirtcamDevice::~VirtcamDevice()
 {
     stop_stream();
+
+    if (device_lost_thread_.joinable())
+    {
+        device_lost_thread_.join();
+    }
 }
 
 tcam::DeviceInfo tcam::virtcam::VirtcamDevice::get_device_description() const
@@ -99,14 +105,16 @@ bool tcam::virtcam::VirtcamDevice::initialize_buffers(std::shared_ptr<BufferPool
 
     auto b = pool_->get_buffer();
 
-    buffer_queue_.clear();
-    buffer_queue_.reserve(b.size());
+    std::scoped_lock lck { buffer_queue_mutex_ };
+
+    // every buffer is queued at most once, so this never overflows
+    buffer_queue_.reset(b.size());
 
     for (auto& weak_buffer : b)
     {
         if (auto buf = weak_buffer.lock())
         {
-            buffer_queue_.push_back(buf);
+            buffer_queue_.push(std::move(buf));
         }
     }
 
@@ -115,14 +123,24 @@ bool tcam::virtcam::VirtcamDevice::initialize_buffers(std::shared_ptr<BufferPool
 
 bool tcam::virtcam::VirtcamDevice::release_buffers()
 {
+    std::scoped_lock lck { buffer_queue_mutex_ };
     buffer_queue_.clear();
     return true;
 }
 
 void tcam::virtcam::VirtcamDevice::requeue_buffer(const std::shared_ptr<ImageBuffer>& buf)
 {
-    std::scoped_lock lck { buffer_queue_mutex_ };
-    buffer_queue_.push_back(buf);
+    auto copy = buf;
+
+    {
+        std::scoped_lock lck { buffer_queue_mutex_ };
+        buffer_queue_.push(std::move(copy));
+    }
+
+    if (free_running_)
+    {
+        notify_stream_thread();
+    }
 }
 
 bool tcam::virtcam::VirtcamDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
@@ -132,16 +150,51 @@ bool tcam::virtcam::VirtcamDevice::start_stream(const std::shared_ptr<IImageBuff
 
     stream_sink_ = sink;
 
-    stream_thread_ended_ = false;
-    stream_thread_ = std::thread([this] { stream_thread_main(); });
+    free_running_ = tcam::get_environment_variable_int("TCAM_VIRTCAM_FREE_RUNNING").value_or(0) != 0;
+    if (free_running_)
+    {
+        SPDLOG_INFO("Free running, images are sent as soon as buffers are available.");
+        prerender_buffers();
+    }
+
+    const auto impairment_options =
+        parse_impairment_options(tcam::get_environment_variable("TCAM_VIRTCAM_IMPAIRMENT", ""));
+    if (impairment_options.is_active())
+    {
+        SPDLOG_INFO("Emulating transport impairments.");
+        impairment_ = std::make_unique<impairment>(impairment_options);
+    }
+    else
+    {
+        impairment_.reset();
+    }
+    device_lost_pending_ = false;
+
+    if (device_lost_thread_.joinable()
+        && device_lost_thread_.get_id() != std::this_thread::get_id())
+    {
+        device_lost_thread_.join();
+    }
 
     start_time_ = std::chrono::high_resolution_clock::now();
 
+    stream_thread_ended_ = false;
+    if (free_running_)
+    {
+        stream_thread_ = std::thread([this] { stream_thread_free_running(); });
+    }
+    else
+    {
+        stream_thread_ = std::thread([this] { stream_thread_main(); });
+    }
+
     return true;
 }
 
 void tcam::virtcam::VirtcamDevice::stop_stream()
 {
+    std::scoped_lock stop_lck { stop_stream_mutex_ };
+
     if (!stream_thread_.joinable())
         return;
 
@@ -163,6 +216,8 @@ void tcam::virtcam::VirtcamDevice::trigger_device_lost ()
 
 void tcam::virtcam::VirtcamDevice::stream_thread_main()
 {
+    tcam::thread_policy::setup_thread("tcam_virtcam", device.get_serial());
+
     const int64_t timeout_in_us = 1'000'000 / active_video_format_.get_framerate();
 
     const auto send_interval = std::chrono::microseconds(timeout_in_us);
@@ -215,17 +270,29 @@ void tcam::virtcam::VirtcamDevice::stream_thread_main()
                 generator_->fill_image(dst);
 
                 tcam_stream_statistics stats = {};
-                stats.frame_count = frames_delivered_;
-                stats.frames_dropped = frames_dropped_;
+                if (emulate_transport(buf, stats, true))
+                {
+                    stats.frame_count = frames_delivered_;
+                    stats.frames_dropped = frames_dropped_;
+
+                    auto end = std::chrono::high_resolution_clock::now();
+                    stats.capture_time_ns =
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_time_)
+                            .count();
 
-                auto end = std::chrono::high_resolution_clock::now();
-                stats.capture_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_time_).count();
+                    buf->set_statistics(stats);
+                    buf->set_valid_data_length(buf->get_image_buffer_size());
+                    buf->record_stage(timing::stage::backend_dequeue);
 
-                buf->set_statistics(stats);
-                buf->set_valid_data_length(buf->get_image_buffer_size());
+                    stream_sink_->push_image(buf);
+                    ++frames_delivered_;
+                }
 
-                stream_sink_->push_image(buf);
-                ++frames_delivered_;
+                if (device_lost_pending_)
+                {
+                    emulate_device_lost();
+                    break;
+                }
             }
             else
             {
@@ -236,16 +303,194 @@ void tcam::virtcam::VirtcamDevice::stream_thread_main()
 }
 
 
-std::shared_ptr<tcam::ImageBuffer> tcam::virtcam::VirtcamDevice::fetch_free_buffer()
+void tcam::virtcam::VirtcamDevice::prerender_buffers()
 {
-    std::scoped_lock lck { buffer_queue_mutex_ };
+    if (!pool_ || !generator_)
+    {
+        return;
+    }
 
-    if (buffer_queue_.empty())
+    for (auto& weak_buffer : pool_->get_buffer())
     {
-        return {};
+        if (auto buf = weak_buffer.lock())
+        {
+            auto dst = buf->get_img_descriptor();
+
+            // every buffer gets another color, so that consecutive images still differ
+            generator_->step();
+            generator_->fill_image(dst);
+        }
     }
-    auto buf = buffer_queue_.front();
-    buffer_queue_.erase(buffer_queue_.begin());
+}
 
-    return buf;
+
+void tcam::virtcam::VirtcamDevice::notify_stream_thread()
+{
+    {
+        // the stream thread checks its wait condition with this held, so no wake up is lost
+        std::scoped_lock lck { stream_thread_mutex_ };
+    }
+    stream_thread_cv_.notify_all();
+}
+
+
+void tcam::virtcam::VirtcamDevice::stream_thread_free_running()
+{
+    tcam::thread_policy::setup_thread("tcam_virtcam", device.get_serial());
+
+    while (true)
+    {
+        std::shared_ptr<ImageBuffer> buf;
+
+        {
+            std::unique_lock lck { stream_thread_mutex_ };
+
+            // requeue_buffer and the software trigger notify,
+            // the timeout is only a fallback
+            stream_thread_cv_.wait_for(lck,
+                                       std::chrono::milliseconds(10),
+                                       [this, &buf]
+                                       {
+                                           if (stream_thread_ended_)
+                                           {
+                                               return true;
+                                           }
+                                           if (trigger_mode_ && !trigger_next_image_)
+                                           {
+                                               return false;
+                                           }
+                                           buf = fetch_free_buffer();
+                                           return buf != nullptr;
+                                       });
+
+            if (stream_thread_ended_)
+            {
+                break;
+            }
+            if (!buf)
+            {
+                continue;
+            }
+            if (trigger_mode_)
+            {
+                trigger_next_image_ = false;
+            }
+        }
+
+        // the image content was rendered by prerender_buffers,
+        // only the frame counter in the first bytes changes
+        const uint64_t frame_counter = frames_delivered_;
+        if (buf->get_image_buffer_size() >= sizeof(frame_counter))
+        {
+            memcpy(buf->get_image_buffer_ptr(), &frame_counter, sizeof(frame_counter));
+        }
+
+        tcam_stream_statistics stats = {};
+        if (emulate_transport(buf, stats, false))
+        {
+            stats.frame_count = frames_delivered_;
+            stats.frames_dropped = frames_dropped_;
+
+            auto end = std::chrono::high_resolution_clock::now();
+            stats.capture_time_ns =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_time_).count();
+
+            buf->set_statistics(stats);
+            buf->set_valid_data_length(buf->get_image_buffer_size());
+            buf->record_stage(timing::stage::backend_dequeue);
+
+            stream_sink_->push_image(buf);
+            ++frames_delivered_;
+        }
+
+        if (device_lost_pending_)
+        {
+            emulate_device_lost();
+            break;
+        }
+    }
+}
+
+
+bool tcam::virtcam::VirtcamDevice::emulate_transport(const std::shared_ptr<ImageBuffer>& buf,
+                                                     tcam_stream_statistics& stats,
+                                                     bool clear_missing_lines)
+{
+    if (!impairment_)
+    {
+        return true;
+    }
+
+    const auto dst = buf->get_img_descriptor();
+    const auto result = impairment_->next_frame(buf->get_image_buffer_size(), dst.dim.cy);
+
+    device_lost_pending_ = result.device_lost;
+
+    if (result.delay.count() > 0)
+    {
+        std::unique_lock lck { stream_thread_mutex_ };
+        if (stream_thread_cv_.wait_for(
+                lck, result.delay, [this] { return stream_thread_ended_; }))
+        {
+            lck.unlock();
+            requeue_buffer(buf);
+            return false;
+        }
+    }
+
+    stats.is_damaged = result.is_damaged;
+    stats.missing_lines = result.missing_lines;
+    buf->set_missing_line_map(result.missing_line_map);
+
+    if (!result.is_damaged)
+    {
+        return true;
+    }
+
+    // same decision as the aravis backend
+    bool salvage = false;
+    if (result.missing_lines > 0 && salvage_threshold_ > 0.0)
+    {
+        salvage = result.missing_lines <= salvage_threshold_ * dst.dim.cy;
+    }
+
+    if (drop_incomplete_frames_ && !salvage)
+    {
+        ++frames_dropped_;
+        requeue_buffer(buf);
+        return false;
+    }
+
+    if (clear_missing_lines && result.missing_lines > 0 && !dst.empty())
+    {
+        const auto& range = result.missing_line_map.ranges[0];
+        memset(img::get_line_start(dst, range.first_line),
+               0,
+               static_cast<size_t>(dst.pitch()) * range.line_count);
+    }
+    return true;
+}
+
+
+void tcam::virtcam::VirtcamDevice::emulate_device_lost()
+{
+    SPDLOG_INFO("Emulating the loss of the device after {} images.", frames_delivered_);
+
+    {
+        std::scoped_lock lck { stream_thread_mutex_ };
+        stream_thread_ended_ = true;
+    }
+
+    // a device that was lost before has been joined by start_stream
+    device_lost_thread_ = std::thread([this] { trigger_device_lost(); });
+}
+
+
+std::shared_ptr<tcam::ImageBuffer> tcam::virtcam::VirtcamDevice::fetch_free_buffer()
+{
+    if (auto buf = buffer_queue_.pop())
+    {
+        return std::move(*buf);
+    }
+    return {};
 }
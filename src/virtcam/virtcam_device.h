@@ -18,6 +18,8 @@
 
 #include "../DeviceInterface.h"
 #include "../VideoFormatDescription.h"
+#include "../spsc_queue.h"
+#include "virtcam_impairment.h"
 
 #include <condition_variable> // std::condition_variable
 #include <memory>
@@ -87,6 +89,18 @@ private:
     std::mutex stream_thread_mutex_;
     bool stream_thread_ended_ = false;
 
+    // TCAM_VIRTCAM_FREE_RUNNING, images are sent as soon as a buffer is available
+    bool free_running_ = false;
+
+    // TCAM_VIRTCAM_IMPAIRMENT, nullptr for a perfect transport
+    std::unique_ptr<impairment> impairment_;
+    bool device_lost_pending_ = false;
+
+    // trigger_device_lost joins the stream thread, so a scripted loss runs in here
+    std::thread device_lost_thread_;
+    // stop_stream may be called by the device lost thread and the owner at the same time
+    std::mutex stop_stream_mutex_;
+
     int frames_dropped_ = 0;
     int frames_delivered_ = 0;
     std::chrono::time_point<std::chrono::high_resolution_clock> start_time_;
@@ -107,7 +121,9 @@ private:
 
     std::shared_ptr<BufferPool> pool_ = nullptr;
 
-    std::vector<std::shared_ptr<ImageBuffer>> buffer_queue_;
+    // free buffers, popped by the stream thread
+    spsc_queue<std::shared_ptr<ImageBuffer>> buffer_queue_;
+    // requeue_buffer may be called from several threads, this keeps it a single producer
     std::mutex buffer_queue_mutex_;
 
     std::shared_ptr<IImageBufferSink> stream_sink_;
@@ -115,9 +131,26 @@ private:
     std::unique_ptr<tcam::generator::IGenerator> generator_;
 
     void stream_thread_main();
+    void stream_thread_free_running();
+
+    // fills all pool buffers once, the free running thread only stamps the frame counter
+    void prerender_buffers();
+
+    // wakes the free running thread
+    void notify_stream_thread();
 
     std::shared_ptr<ImageBuffer> fetch_free_buffer();
 
+    // Applies impairment_ to an image that is ready to be sent, fills is_damaged and
+    // missing_lines of stats. Returns false when the image is not delivered, it is requeued.
+    // clear_missing_lines zeroes the lost lines, the free running images are not rendered again.
+    bool emulate_transport(const std::shared_ptr<ImageBuffer>& buf,
+                           tcam_stream_statistics& stats,
+                           bool clear_missing_lines);
+
+    // ends the stream thread and reports the device as lost from device_lost_thread_
+    void emulate_device_lost();
+
     void generate_properties();
 };
 
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "virtcam_impairment.h"
+
+#include "../logging.h"
+#include "../utils.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace tcam::virtcam;
+
+
+namespace
+{
+
+template<typename T> bool parse_number(const std::string& str, T& val)
+{
+    try
+    {
+        size_t pos = 0;
+        T tmp;
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            tmp = static_cast<T>(std::stod(str, &pos));
+        }
+        else
+        {
+            tmp = static_cast<T>(std::stoull(str, &pos));
+        }
+        if (pos != str.size() || tmp < 0)
+        {
+            return false;
+        }
+        val = tmp;
+        return true;
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
+bool parse_distribution(const std::string& str, jitter_distribution& val)
+{
+    if (str == "uniform")
+    {
+        val = jitter_distribution::uniform;
+    }
+    else if (str == "normal")
+    {
+        val = jitter_distribution::normal;
+    }
+    else if (str == "exponential")
+    {
+        val = jitter_distribution::exponential;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+
+impairment_options tcam::virtcam::parse_impairment_options(const std::string& options)
+{
+    impairment_options rval;
+
+    if (options.empty())
+    {
+        return rval;
+    }
+
+    for (const auto& s : tcam::split_string(options, ","))
+    {
+        auto setting = tcam::split_string(s, "=");
+        if (setting.size() != 2)
+        {
+            SPDLOG_ERROR("Unable to interpret TCAM_VIRTCAM_IMPAIRMENT setting: {}", s);
+            continue;
+        }
+
+        const auto& key = setting.at(0);
+        const auto& value = setting.at(1);
+
+        bool ok = true;
+        if (key == "bandwidth")
+        {
+            ok = parse_number(value, rval.bandwidth_mbit);
+        }
+        else if (key == "jitter")
+        {
+            ok = parse_number(value, rval.jitter_us);
+        }
+        else if (key == "jitter-distribution")
+        {
+            ok = parse_distribution(value, rval.distribution);
+        }
+        else if (key == "damage")
+        {
+            ok = parse_number(value, rval.damage_rate) && rval.damage_rate <= 1.0;
+        }
+        else if (key == "missing-lines")
+        {
+            ok = parse_number(value, rval.missing_lines);
+        }
+        else if (key == "stall")
+        {
+            ok = parse_number(value, rval.stall_rate) && rval.stall_rate <= 1.0;
+        }
+        else if (key == "stall-duration")
+        {
+            ok = parse_number(value, rval.stall_ms);
+        }
+        else if (key == "lost-after")
+        {
+            ok = parse_number(value, rval.lost_after);
+        }
+        else if (key == "seed")
+        {
+            ok = parse_number(value, rval.seed);
+        }
+        else
+        {
+            SPDLOG_ERROR("TCAM_VIRTCAM_IMPAIRMENT: unknown setting '{}'", key);
+            continue;
+        }
+
+        if (!ok)
+        {
+            SPDLOG_ERROR(
+                "TCAM_VIRTCAM_IMPAIRMENT: value for '{}' could not be interpreted. Value is: '{}'",
+                key,
+                value);
+        }
+    }
+    return rval;
+}
+
+
+tcam::virtcam::impairment::impairment(const impairment_options& options)
+    : options_(options), rng_(options.seed)
+{
+}
+
+
+auto tcam::virtcam::impairment::next_frame(size_t image_size, uint32_t image_height)
+    -> frame_result
+{
+    frame_result rval;
+
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    double delay_us = 0;
+    if (options_.bandwidth_mbit > 0)
+    {
+        delay_us += image_size * 8 / options_.bandwidth_mbit;
+    }
+
+    if (options_.jitter_us > 0)
+    {
+        switch (options_.distribution)
+        {
+            case jitter_distribution::uniform:
+            {
+                delay_us += std::uniform_real_distribution<double>(0.0, options_.jitter_us)(rng_);
+                break;
+            }
+            case jitter_distribution::normal:
+            {
+                std::normal_distribution<double> dist(0.0, options_.jitter_us);
+                delay_us += std::abs(dist(rng_));
+                break;
+            }
+            case jitter_distribution::exponential:
+            {
+                delay_us += std::exponential_distribution<double>(1.0 / options_.jitter_us)(rng_);
+                break;
+            }
+        }
+    }
+
+    if (options_.stall_rate > 0 && chance(rng_) < options_.stall_rate)
+    {
+        delay_us += options_.stall_ms * 1000;
+    }
+
+    rval.delay = std::chrono::microseconds(static_cast<int64_t>(delay_us));
+
+    if (options_.damage_rate > 0 && chance(rng_) < options_.damage_rate)
+    {
+        rval.is_damaged = true;
+
+        const uint32_t count = std::min(options_.missing_lines, image_height);
+        if (count > 0)
+        {
+            // one contiguous block, like the lines of a lost packet
+            const uint32_t first =
+                std::uniform_int_distribution<uint32_t>(0, image_height - count)(rng_);
+
+            rval.missing_line_map.range_count = 1;
+            rval.missing_line_map.ranges[0] = { first, count };
+            rval.missing_lines = count;
+        }
+    }
+
+    ++frame_count_;
+    rval.device_lost = options_.lost_after > 0 && frame_count_ >= options_.lost_after;
+
+    return rval;
+}
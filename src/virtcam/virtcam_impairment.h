@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../base_types.h"
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace tcam::virtcam
+{
+
+enum class jitter_distribution
+{
+    uniform, // [0, jitter]
+    normal, // |N(0, jitter)|
+    exponential, // mean jitter
+};
+
+//
+// Transport behaviour emulated by tcam-virtcam, read from TCAM_VIRTCAM_IMPAIRMENT, e.g.
+// "bandwidth=400,jitter=2000,jitter-distribution=normal,damage=0.01,missing-lines=16"
+//
+// All values default to a perfect transport.
+//
+struct impairment_options
+{
+    double bandwidth_mbit = 0; // transfer time of an image is size * 8 / bandwidth, 0 is unlimited
+
+    double jitter_us = 0; // additional latency of every image
+    jitter_distribution distribution = jitter_distribution::uniform;
+
+    double damage_rate = 0; // probability of a damaged image, like a lost packet
+    // lines lost in a damaged image, 0 marks it damaged without a missing line map
+    uint32_t missing_lines = 0;
+
+    double stall_rate = 0; // probability that the transport stalls before an image
+    double stall_ms = 0;
+
+    uint64_t lost_after = 0; // the device is lost after this many images, 0 never
+
+    uint32_t seed = 0; // the same seed repeats the same sequence of impairments
+
+    bool is_active() const noexcept
+    {
+        return bandwidth_mbit > 0 || jitter_us > 0 || damage_rate > 0 || stall_rate > 0
+               || lost_after > 0;
+    }
+};
+
+// Unknown keys and invalid values are logged and ignored
+impairment_options parse_impairment_options(const std::string& options);
+
+//
+// Decides what happens to the images of a stream. Not thread safe, owned by the stream thread.
+//
+class impairment
+{
+public:
+    explicit impairment(const impairment_options& options);
+
+    struct frame_result
+    {
+        // time the image spends in the transport after it was captured
+        std::chrono::microseconds delay { 0 };
+
+        bool is_damaged = false;
+        tcam_missing_line_map missing_line_map = {};
+        uint32_t missing_lines = 0;
+
+        bool device_lost = false;
+    };
+
+    frame_result next_frame(size_t image_size, uint32_t image_height);
+
+private:
+    impairment_options options_;
+    std::mt19937 rng_;
+    uint64_t frame_count_ = 0;
+};
+
+} // namespace tcam::virtcam
@@ -79,6 +79,7 @@ outcome::result<void> tcam::virtcam::VirtcamPropertyBackend::execute(tcam::virtc
         case tcam::virtcam::VirtcamProperty::TriggerSoftware:
         {
             device_->trigger_next_image_ = true;
+            device_->notify_stream_thread();
             return outcome::success();
         }
     }
@@ -0,0 +1,449 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Streams a virtcam device through tcammainsrc into a fakesink and fails when the threads on the
+// path from the device to the GstBuffer allocate heap memory after the warm up.
+//
+// malloc and friends of this executable replace the ones of libc for the whole process, they
+// count the calls of the watched threads while the measurement runs. The first allocations are
+// printed with a backtrace, --abort stops at the first one for a debugger.
+
+#include <CLI11.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <execinfo.h>
+#include <gst/gst.h>
+#include <pthread.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void* ptr);
+}
+
+namespace
+{
+
+// Everything here is used from within malloc, it must not allocate itself.
+
+constexpr size_t max_thread_prefixes = 8;
+constexpr size_t max_threads = 32;
+constexpr uint64_t max_backtraces = 5;
+
+struct thread_prefix
+{
+    char name[16];
+};
+
+thread_prefix watched_prefixes[max_thread_prefixes] = {};
+size_t watched_prefix_count = 0;
+
+struct thread_stat
+{
+    std::atomic<bool> used = false;
+    char name[16] = {};
+    std::atomic<uint64_t> allocations = 0;
+};
+
+thread_stat thread_stats[max_threads];
+
+std::atomic<bool> is_armed = false;
+bool abort_on_allocation = false;
+std::atomic<uint64_t> allocation_count = 0;
+
+enum class thread_class : uint8_t
+{
+    unknown,
+    watched,
+    other,
+};
+
+thread_local thread_class this_thread_class = thread_class::unknown;
+thread_local thread_stat* this_thread_stat = nullptr;
+// allocations of the hook itself (backtrace_symbols_fd) are not counted
+thread_local bool is_in_hook = false;
+
+
+bool is_watched(const char* name)
+{
+    for (size_t i = 0; i < watched_prefix_count; ++i)
+    {
+        const char* prefix = watched_prefixes[i].name;
+        if (strncmp(name, prefix, strlen(prefix)) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+thread_stat* claim_thread_stat(const char* name)
+{
+    for (auto& s : thread_stats)
+    {
+        bool expected = false;
+        if (s.used.compare_exchange_strong(expected, true))
+        {
+            strncpy(s.name, name, sizeof(s.name) - 1);
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+
+void classify_this_thread()
+{
+    // names are set when the threads start, long before the measurement is armed
+    char name[16] = {};
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+
+    if (is_watched(name))
+    {
+        this_thread_class = thread_class::watched;
+        this_thread_stat = claim_thread_stat(name);
+    }
+    else
+    {
+        this_thread_class = thread_class::other;
+    }
+}
+
+
+void print_allocation(size_t size)
+{
+    char msg[128];
+    int len = snprintf(msg,
+                       sizeof(msg),
+                       "\nAllocation of %zu bytes in thread '%s':\n",
+                       size,
+                       this_thread_stat ? this_thread_stat->name : "?");
+    if (len > 0 && write(STDERR_FILENO, msg, std::min<size_t>(len, sizeof(msg) - 1)) < 0)
+    {
+        return;
+    }
+
+    void* frames[32];
+    int frame_count = backtrace(frames, 32);
+    backtrace_symbols_fd(frames, frame_count, STDERR_FILENO);
+}
+
+
+void on_allocation(size_t size)
+{
+    if (!is_armed.load(std::memory_order_relaxed) || is_in_hook)
+    {
+        return;
+    }
+
+    is_in_hook = true;
+
+    if (this_thread_class == thread_class::unknown)
+    {
+        classify_this_thread();
+    }
+
+    if (this_thread_class == thread_class::watched)
+    {
+        if (this_thread_stat)
+        {
+            this_thread_stat->allocations++;
+        }
+        if (allocation_count++ < max_backtraces)
+        {
+            print_allocation(size);
+        }
+        if (abort_on_allocation)
+        {
+            abort();
+        }
+    }
+
+    is_in_hook = false;
+}
+
+} // namespace
+
+
+extern "C"
+{
+
+void* malloc(size_t size)
+{
+    on_allocation(size);
+    return __libc_malloc(size);
+}
+
+
+void* calloc(size_t count, size_t size)
+{
+    on_allocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+
+void* realloc(void* ptr, size_t size)
+{
+    on_allocation(size);
+    return __libc_realloc(ptr, size);
+}
+
+
+void* memalign(size_t alignment, size_t size)
+{
+    on_allocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    on_allocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+
+int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+    on_allocation(size);
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr ? 0 : ENOMEM;
+}
+
+
+void free(void* ptr)
+{
+    __libc_free(ptr);
+}
+
+} // extern "C"
+
+
+namespace
+{
+
+struct harness_state
+{
+    GMainLoop* loop = nullptr;
+    double duration_s = 0;
+    uint64_t frames_start = 0;
+    uint64_t frames = 0;
+    bool error = false;
+};
+
+
+gboolean bus_callback(GstBus* /*bus*/, GstMessage* message, gpointer data)
+{
+    auto& state = *static_cast<harness_state*>(data);
+
+    if (GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR)
+    {
+        GError* err = nullptr;
+        gst_message_parse_error(message, &err, nullptr);
+        fprintf(stderr, "Error: %s\n", err ? err->message : "");
+        g_clear_error(&err);
+
+        state.error = true;
+        g_main_loop_quit(state.loop);
+    }
+    return TRUE;
+}
+
+
+GstPadProbeReturn count_probe(GstPad* /*pad*/, GstPadProbeInfo* /*info*/, gpointer data)
+{
+    static_cast<std::atomic<uint64_t>*>(data)->fetch_add(1, std::memory_order_relaxed);
+    return GST_PAD_PROBE_OK;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    CLI::App app { "Checks that streaming does not allocate heap memory after the warm up" };
+
+    std::string caps_str = "video/x-bayer,format=rggb,width=1920,height=1080,framerate=60/1";
+    double warmup_s = 2;
+    double duration_s = 10;
+    bool free_running = false;
+    bool convert = false;
+    std::vector<std::string> threads = { "tcam_virtcam", "src:src" };
+
+    app.add_option("-c,--caps", caps_str, "Caps of the virtcam device", true);
+    app.add_option("-w,--warmup", warmup_s, "Seconds before the allocations are counted", true);
+    app.add_option("-d,--duration", duration_s, "Seconds to count allocations", true);
+    app.add_flag("--free-running",
+                 free_running,
+                 "Send images as fast as buffers are available, ignoring the frame rate");
+    app.add_flag("--convert", convert, "Add tcamconvert and watch its worker threads");
+    app.add_option("-t,--threads",
+                   threads,
+                   "Name prefixes of the watched threads, 'src:src' is the streaming thread",
+                   true)
+        ->delimiter(',');
+    app.add_flag("--abort", abort_on_allocation, "Abort at the first allocation");
+
+    CLI11_PARSE(app, argc, argv);
+
+    if (convert)
+    {
+        threads.push_back("tcamconvert");
+    }
+    for (const auto& t : threads)
+    {
+        if (watched_prefix_count == max_thread_prefixes)
+        {
+            break;
+        }
+        strncpy(watched_prefixes[watched_prefix_count++].name,
+                t.c_str(),
+                sizeof(thread_prefix::name) - 1);
+    }
+
+    // the first backtrace loads libgcc, which allocates
+    void* frame = nullptr;
+    backtrace(&frame, 1);
+
+    // one virtcam device is enough, an existing configuration is kept
+    setenv("TCAM_VIRTCAM_DEVICES", "alloc-free", 0);
+    if (free_running)
+    {
+        setenv("TCAM_VIRTCAM_FREE_RUNNING", "1", 1);
+    }
+
+    gst_init(&argc, &argv);
+
+    std::string pipeline_str = "tcammainsrc name=src type=virtcam num-buffers=-1 ! " + caps_str;
+    if (convert)
+    {
+        pipeline_str += " ! tcamconvert ! video/x-raw,format=BGRx";
+    }
+    // the last sample would be a GstSample per buffer
+    pipeline_str += " ! fakesink name=sink sync=false enable-last-sample=false";
+
+    GError* err = nullptr;
+    GstElement* pipeline = gst_parse_launch(pipeline_str.c_str(), &err);
+    if (!pipeline)
+    {
+        fprintf(stderr, "Unable to create pipeline: %s\n", err ? err->message : "");
+        g_clear_error(&err);
+        return 1;
+    }
+
+    std::atomic<uint64_t> frames = 0;
+    GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    GstPad* sink_pad = gst_element_get_static_pad(sink, "sink");
+    gst_pad_add_probe(sink_pad, GST_PAD_PROBE_TYPE_BUFFER, count_probe, &frames, nullptr);
+    gst_object_unref(sink_pad);
+    gst_object_unref(sink);
+
+    harness_state state;
+    state.loop = g_main_loop_new(nullptr, FALSE);
+    state.duration_s = duration_s;
+
+    GstBus* bus = gst_element_get_bus(pipeline);
+    gst_bus_add_watch(bus, bus_callback, &state);
+    gst_object_unref(bus);
+
+    printf("Pipeline: %s\n", pipeline_str.c_str());
+
+    if (gst_element_set_state(pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    {
+        fprintf(stderr, "Unable to start pipeline.\n");
+        return 1;
+    }
+
+    struct timer_context
+    {
+        harness_state* state;
+        std::atomic<uint64_t>* frames;
+    };
+    timer_context ctx { &state, &frames };
+
+    g_timeout_add(
+        static_cast<guint>(warmup_s * 1000),
+        [](gpointer data) -> gboolean
+        {
+            auto& c = *static_cast<timer_context*>(data);
+
+            c.state->frames_start = c.frames->load();
+            is_armed = true;
+
+            g_timeout_add(
+                static_cast<guint>(c.state->duration_s * 1000),
+                [](gpointer d) -> gboolean
+                {
+                    auto& context = *static_cast<timer_context*>(d);
+
+                    is_armed = false;
+                    context.state->frames = context.frames->load() - context.state->frames_start;
+
+                    g_main_loop_quit(context.state->loop);
+                    return G_SOURCE_REMOVE;
+                },
+                data);
+            return G_SOURCE_REMOVE;
+        },
+        &ctx);
+
+    g_main_loop_run(state.loop);
+    is_armed = false;
+
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+    g_main_loop_unref(state.loop);
+
+    if (state.error)
+    {
+        return 1;
+    }
+
+    printf("\nFrames: %lu\n", static_cast<unsigned long>(state.frames));
+    for (const auto& s : thread_stats)
+    {
+        if (s.used)
+        {
+            printf("  %-16s %lu allocations\n", s.name, static_cast<unsigned long>(s.allocations));
+        }
+    }
+
+    if (state.frames == 0)
+    {
+        fprintf(stderr, "No frames were delivered.\n");
+        return 1;
+    }
+
+    const auto total = allocation_count.load();
+    if (total != 0)
+    {
+        printf("FAILED: %lu allocations after the warm up\n", static_cast<unsigned long>(total));
+        return 1;
+    }
+    printf("PASSED: no allocations after the warm up\n");
+    return 0;
+}
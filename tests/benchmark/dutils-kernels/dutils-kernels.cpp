@@ -0,0 +1,1056 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// Runs the C and SIMD variants of the dutils_image kernels over the standard resolutions,
+// checks their output against the C reference and reports the throughput.
+// The debayer kernels also report their PSNR against the scene a bayer test image was sampled from.
+
+#include "../../../libs/dutils_image/src/dutils_img_base/memcpy_image.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/by_demosaic/by_demosaic.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/by_edge/by_edge.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/by_luma/by_luma.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/filter/whitebalance/wb_apply.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/bgra_to_yuv/transform_bgra_to_yuv.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/fcc1x_packed/fcc1x_packed_to_fcc.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/fcc1x_packed/transform_fcc1x_mono_to_dst.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/fcc8_fcc16/transform_fcc8_fcc16.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/mono_to_bgr/transform_mono_to_bgr.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/polarization/transform_polarization.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/pwl/transform_pwl_functions.h"
+#include "../../../libs/dutils_image/src/dutils_img_pipe/auto_alg/auto_sample_sums.h"
+
+#include <CLI11.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <dutils_img/dutils_cpu_features.h>
+#include <dutils_img/fcc_to_string.h>
+#include <dutils_img/image_bayer_pattern.h>
+#include <dutils_img_lib/dutils_get_cpu_features.h>
+#include <functional>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using kernel_func = std::function<void(const img::img_descriptor& dst, const img::img_descriptor& src)>;
+
+struct kernel_variant
+{
+    std::string isa;
+    kernel_func func;
+};
+
+struct format_pair
+{
+    img::fourcc dst;
+    img::fourcc src;
+};
+
+struct kernel_family
+{
+    const char* name;
+    // the first variant is the reference the others are compared against
+    std::vector<kernel_variant> (*find_variants)(const img::img_type& dst, const img::img_type& src);
+    std::vector<format_pair> formats;
+    // dst is modified in place, src is not used
+    bool in_place = false;
+    // allowed difference of a channel value to the reference
+    double tolerance = 0;
+    // src is a bayer image of the test scene and the PSNR of dst is reported
+    bool measure_quality = false;
+    // dst only receives a few results, so only src counts for the throughput
+    bool reduction = false;
+};
+
+struct result
+{
+    std::string family;
+    std::string isa;
+    std::string dst_fcc;
+    std::string src_fcc;
+    img::dim dim;
+
+    double time_us = 0;
+    double gb_per_s = 0;
+    double mpix_per_s = 0;
+
+    double max_diff = 0;
+    bool matches = true;
+
+    // PSNR against the test scene in dB, NAN when not measured
+    double psnr = NAN;
+};
+
+
+unsigned int cpu_features = 0;
+
+bool has_cpu_features(unsigned int required) noexcept
+{
+    return (cpu_features & required) == required;
+}
+
+template<class TFunc, class TCall>
+void add_variant(std::vector<kernel_variant>& list,
+                 const char* isa,
+                 unsigned int required,
+                 TFunc func,
+                 TCall call)
+{
+    if (func == nullptr || !has_cpu_features(required))
+    {
+        return;
+    }
+    list.push_back({ isa,
+                     [func, call](const img::img_descriptor& dst, const img::img_descriptor& src)
+                     { call(func, dst, src); } });
+}
+
+const auto call_transform = [](auto func, const img::img_descriptor& dst, const img::img_descriptor& src)
+{ func(dst, src); };
+
+
+std::vector<kernel_variant> find_by8_edge(const img::img_type& dst, const img::img_type& src)
+{
+    using namespace img_filter::transform::by_edge;
+    using namespace img::cpu;
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, get_transform_by8_to_dst_specialized_c(dst, src, false), call_transform);
+#if defined DUTILS_ARCH_ARM
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_by8_to_dst_specialized_neon(dst, src, false), call_transform);
+#else
+    add_variant(rval, "sse41", CPU_UsesSSE41, get_transform_by8_to_dst_specialized_sse41(dst, src, false), call_transform);
+    add_variant(rval, "avx2", CPU_UsesAVX2, get_transform_by8_to_dst_specialized_avx2(dst, src, false), call_transform);
+#endif
+    return rval;
+}
+
+template<img_filter::transform::by_demosaic::method m>
+std::vector<kernel_variant> find_by8_demosaic(const img::img_type& dst, const img::img_type& src)
+{
+    using namespace img_filter::transform::by_demosaic;
+    using namespace img::cpu;
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, get_transform_by8_to_dst_specialized_c(dst, src, m), call_transform);
+#if defined DUTILS_ARCH_ARM
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_by8_to_dst_specialized_neon(dst, src, m), call_transform);
+#else
+    add_variant(rval, "sse41", CPU_UsesSSE41, get_transform_by8_to_dst_specialized_sse41(dst, src, m), call_transform);
+    add_variant(rval, "avx2", CPU_UsesAVX2, get_transform_by8_to_dst_specialized_avx2(dst, src, m), call_transform);
+#endif
+    return rval;
+}
+
+std::vector<kernel_variant> find_by8_edge_ccm(const img::img_type& dst, const img::img_type& src)
+{
+    using namespace img_filter::transform::by_edge;
+    using namespace img::cpu;
+
+    static const options opt = { img::color_matrix_int::get_defaults(), true, false };
+
+    const auto call = [](function_type func, const img::img_descriptor& d, const img::img_descriptor& s)
+    { func(d, s, opt); };
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, get_transform_by8_to_dst_c(dst, src), call);
+#if defined DUTILS_ARCH_ARM
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_by8_to_dst_neon(dst, src), call);
+#else
+    add_variant(rval, "sse41", CPU_UsesSSE41, get_transform_by8_to_dst_sse41(dst, src), call);
+    add_variant(rval, "avx2", CPU_UsesAVX2, get_transform_by8_to_dst_avx2(dst, src), call);
+#endif
+    return rval;
+}
+
+std::vector<kernel_variant> find_by16_edge(const img::img_type& dst, const img::img_type& src)
+{
+    using namespace img_filter::transform::by_edge;
+    using namespace img::cpu;
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, get_transform_by16_to_dst_specialized_c(dst, src, false), call_transform);
+#if defined DUTILS_ARCH_ARM
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_by16_to_dst_specialized_neon(dst, src, false), call_transform);
+    add_variant(rval, "sve2", CPU_UsesARM_SVE2, get_transform_by16_to_dst_specialized_sve2(dst, src, false), call_transform);
+#else
+    add_variant(rval, "avx2", CPU_UsesAVX2, get_transform_by16_to_dst_specialized_avx2(dst, src, false), call_transform);
+#endif
+    return rval;
+}
+
+std::vector<kernel_variant> find_by_luma(const img::img_type& dst, const img::img_type& src)
+{
+    using namespace img::cpu;
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, img_filter::transform::by_luma::get_transform_by_to_luma_c(dst, src), call_transform);
+    return rval;
+}
+
+std::vector<kernel_variant> find_fcc1x_packed_to_fcc8(const img::img_type& dst, const img::img_type& src)
+{
+    using namespace img_filter::transform::fcc1x_packed;
+    using namespace img::cpu;
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, get_transform_fcc10or12_packed_to_fcc8_c(dst, src), call_transform);
+#if defined DUTILS_ARCH_ARM
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_fcc10or12_packed_to_fcc8_neon_v0(dst, src), call_transform);
+    add_variant(rval, "sve2", CPU_UsesARM_SVE2, get_transform_fcc10or12_packed_to_fcc8_sve2(dst, src), call_transform);
+#else
+    add_variant(rval, "ssse3", CPU_UsesSSSE3, get_transform_fcc10or12_packed_to_fcc8_ssse3(dst, src), call_transform);
+    add_variant(rval, "avx2", CPU_UsesAVX2, get_transform_fcc10or12_packed_to_fcc8_avx2(dst, src), call_transform);
+#endif
+    return rval;
+}
+
+std::vector<kernel_variant> find_fcc1x_packed_to_fcc16(const img::img_type& dst, const img::img_type& src)
+{
+    using namespace img_filter::transform::fcc1x_packed;
+    using namespace img::cpu;
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, get_transform_fcc10or12_packed_to_fcc16_c(dst, src), call_transform);
+#if defined DUTILS_ARCH_ARM
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_fcc10or12_packed_to_fcc16_neon_v0(dst, src), call_transform);
+    add_variant(rval, "sve2", CPU_UsesARM_SVE2, get_transform_fcc10or12_packed_to_fcc16_sve2(dst, src), call_transform);
+#else
+    add_variant(rval, "ssse3", CPU_UsesSSSE3, get_transform_fcc10or12_packed_to_fcc16_ssse3(dst, src), call_transform);
+#endif
+    return rval;
+}
+
+std::vector<kernel_variant> find_fcc1x_mono_to_dst(const img::img_type& dst, const img::img_type& src)
+{
+    using namespace img_filter::transform::fcc1x_packed;
+    using namespace img::cpu;
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, get_transform_fcc1x_mono_to_dst_c(dst, src), call_transform);
+#if defined DUTILS_ARCH_ARM
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_fcc1x_mono_to_dst_neon(dst, src), call_transform);
+#else
+    add_variant(rval, "avx2", CPU_UsesAVX2, get_transform_fcc1x_mono_to_dst_avx2(dst, src), call_transform);
+#endif
+    return rval;
+}
+
+std::vector<kernel_variant> find_fcc8_fcc16(const img::img_type& dst, const img::img_type& src)
+{
+    using namespace img_filter::transform;
+    using namespace img::cpu;
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, get_transform_fcc8_to_fcc16_c(dst, src), call_transform);
+    add_variant(rval, "c", CPU_C, get_transform_fcc16_to_fcc8_c(dst, src), call_transform);
+#if defined DUTILS_ARCH_ARM
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_fcc8_to_fcc16_neon(dst, src), call_transform);
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_fcc16_to_fcc8_neon(dst, src), call_transform);
+#else
+    add_variant(rval, "sse41", CPU_UsesSSE41, get_transform_fcc8_to_fcc16_sse41(dst, src), call_transform);
+    add_variant(rval, "sse41", CPU_UsesSSE41, get_transform_fcc16_to_fcc8_sse41(dst, src), call_transform);
+#endif
+    return rval;
+}
+
+std::vector<kernel_variant> find_mono_to_bgr(const img::img_type& dst, const img::img_type& src)
+{
+    using namespace img_filter::transform;
+    using namespace img::cpu;
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, get_transform_mono_to_bgr_c(dst, src), call_transform);
+#if defined DUTILS_ARCH_ARM
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_mono_to_bgr_neon(dst, src), call_transform);
+#else
+    add_variant(rval, "sse41", CPU_UsesSSE41, get_transform_mono_to_bgr_sse41(dst, src), call_transform);
+#endif
+    return rval;
+}
+
+std::vector<kernel_variant> find_bgra_to_yuv(const img::img_type& dst, const img::img_type& src)
+{
+    using namespace img_filter::transform;
+    using namespace img::cpu;
+
+    constexpr auto clr = yuv_colorimetry::bt709;
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, get_transform_bgra_to_yuv_c(dst, src, clr), call_transform);
+#if defined DUTILS_ARCH_ARM
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_bgra_to_yuv_neon(dst, src, clr), call_transform);
+#else
+    add_variant(rval, "avx2", CPU_UsesAVX2, get_transform_bgra_to_yuv_avx2(dst, src, clr), call_transform);
+#endif
+    return rval;
+}
+
+std::vector<kernel_variant> find_wb_apply(const img::img_type& dst, const img::img_type& /*src*/)
+{
+    using namespace img_filter::whitebalance;
+    using namespace img::cpu;
+
+    const auto call = [](func_type func, const img::img_descriptor& d, const img::img_descriptor& /*s*/)
+    { func(d, apply_params { true, 1.25f, 1.f, 0.8f, 1.f }); };
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, get_apply_img_c(dst), call);
+#if defined DUTILS_ARCH_ARM
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_apply_img_neon(dst), call);
+    add_variant(rval, "sve2", CPU_UsesARM_SVE2, get_apply_img_sve2(dst), call);
+#else
+    add_variant(rval, "sse41", CPU_UsesSSE41, get_apply_img_sse41(dst), call);
+    add_variant(rval, "avx2", CPU_UsesAVX2, get_apply_img_avx2(dst), call);
+    add_variant(rval, "avx512", CPU_UsesAVX512_BW, get_apply_img_avx512(dst), call);
+#endif
+    return rval;
+}
+
+std::vector<kernel_variant> find_pwl_to_fccfloat(const img::img_type& dst, const img::img_type& src)
+{
+    using namespace img_filter::transform::pwl;
+    using namespace img::cpu;
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, get_transform_pwl_to_fccfloat_c(dst, src), call_transform);
+#if defined DUTILS_ARCH_ARM
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_pwl_to_fccfloat_neon(dst, src), call_transform);
+#else
+    add_variant(rval, "avx2", CPU_UsesAVX2, get_transform_pwl_to_fccfloat_avx2(dst, src), call_transform);
+#endif
+    return rval;
+}
+
+// white balance and hdr gain applied while decompanding
+const auto call_pwl_wb = [](img_filter::transform_function_param_type func,
+                            const img::img_descriptor& dst,
+                            const img::img_descriptor& src)
+{
+    static img_filter::pwl12_to_fcc8_wb_map_data lut_data;
+
+    img_filter::filter_params params;
+    params.whitebalance = { true, 1.25f, 1.f, 0.8f, 1.f };
+    params.pwl_transform.hdr_gain = 20.f;
+    params.pwl12_to_fcc8_wb_lut = &lut_data;
+    func(dst, src, params);
+};
+
+std::vector<kernel_variant> find_pwl_to_fccfloat_wb(const img::img_type& dst, const img::img_type& src)
+{
+    using namespace img_filter::transform::pwl;
+    using namespace img::cpu;
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, get_transform_pwl_to_fccfloat_wb_c(dst, src), call_pwl_wb);
+#if defined DUTILS_ARCH_ARM
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_pwl_to_fccfloat_wb_neon(dst, src), call_pwl_wb);
+#else
+    add_variant(rval, "avx2", CPU_UsesAVX2, get_transform_pwl_to_fccfloat_wb_avx2(dst, src), call_pwl_wb);
+#endif
+    return rval;
+}
+
+std::vector<kernel_variant> find_pwl_to_fcc8_fcc16(const img::img_type& dst, const img::img_type& src)
+{
+    using namespace img_filter::transform::pwl;
+    using namespace img::cpu;
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, get_transform_pwl12_to_fcc8_c(dst, src), call_pwl_wb);
+    add_variant(rval, "c", CPU_C, get_transform_pwl12_to_fcc16_c(dst, src), call_pwl_wb);
+#if defined DUTILS_ARCH_ARM
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_pwl12_to_fcc8_neon(dst, src), call_pwl_wb);
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_pwl12_to_fcc16_neon(dst, src), call_pwl_wb);
+#else
+    add_variant(rval, "avx2", CPU_UsesAVX2, get_transform_pwl12_to_fcc8_avx2(dst, src), call_pwl_wb);
+    add_variant(rval, "avx2", CPU_UsesAVX2, get_transform_pwl12_to_fcc16_avx2(dst, src), call_pwl_wb);
+#endif
+    return rval;
+}
+
+std::vector<kernel_variant> find_polarization(const img::img_type& dst, const img::img_type& src)
+{
+    using namespace img_filter::transform::polarization;
+    using namespace img::cpu;
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, get_transform_polarization_c(dst, src), call_transform);
+#if defined DUTILS_ARCH_ARM
+    add_variant(rval, "neon", CPU_UsesARM_A7, get_transform_polarization_neon(dst, src), call_transform);
+#else
+    add_variant(rval, "avx2", CPU_UsesAVX2, get_transform_polarization_avx2(dst, src), call_transform);
+#endif
+    return rval;
+}
+
+std::vector<kernel_variant> find_memcpy(const img::img_type& /*dst*/, const img::img_type& /*src*/)
+{
+    using img::memcpy_method;
+
+    const int threads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+    auto make = [](const char* name, memcpy_method method, int max_threads) -> kernel_variant
+    {
+        img::memcpy_options opt;
+        opt.method = method;
+        opt.max_threads = max_threads;
+        return { name,
+                 [opt](const img::img_descriptor& dst, const img::img_descriptor& src)
+                 { img::memcpy_image(dst, src, opt); } };
+    };
+
+    // nt are the non-temporal stores, mt splits the copy over all cores
+    return {
+        make("c", memcpy_method::regular, 1),
+        make("nt", memcpy_method::streaming, 1),
+        make("mt", memcpy_method::regular, threads),
+        make("nt-mt", memcpy_method::streaming, threads),
+    };
+}
+
+// the auto algorithms reduce at most this many sample points at once, see auto_alg::impl::image_sampling_points_rgbf
+constexpr int sample_set_size = 1500;
+
+// src holds the RGBf samples, the sum of each set of sample_set_size samples is written to dst as float
+std::vector<kernel_variant> find_sample_gray_sum(const img::img_type& /*dst*/, const img::img_type& /*src*/)
+{
+    using namespace auto_alg::impl::sample_sums;
+    using namespace img::cpu;
+
+    const auto call = [](gray_u8_sum_func func, const img::img_descriptor& d, const img::img_descriptor& s)
+    {
+        const int cnt = s.dim.cx * s.dim.cy;
+        const auto* samples = reinterpret_cast<const auto_alg::impl::RGBf*>(s.data());
+        auto* sums = reinterpret_cast<float*>(d.data());
+        for (int i = 0; i < cnt; i += sample_set_size)
+        {
+            sums[i / sample_set_size] = static_cast<float>(func(samples + i, std::min(sample_set_size, cnt - i), 1.f));
+        }
+    };
+
+    std::vector<kernel_variant> rval;
+    add_variant(rval, "c", CPU_C, &gray_u8_sum_c, call);
+#if !defined DUTILS_ARCH_ARM
+    add_variant(rval, "sse41", CPU_UsesSSE41, &gray_u8_sum_sse41, call);
+    add_variant(rval, "avx2", CPU_UsesAVX2, &gray_u8_sum_avx2, call);
+#endif
+    return rval;
+}
+
+
+std::vector<kernel_family> get_families()
+{
+    using img::fourcc;
+
+    using img_filter::transform::by_demosaic::method;
+
+    return {
+        // the SIMD versions round the interpolation differently
+        { "by8_edge",
+          find_by8_edge,
+          { { fourcc::BGRA32, fourcc::RGGB8 }, { fourcc::BGR24, fourcc::GBRG8 } },
+          false,
+          1,
+          true },
+        { "by8_nearest",
+          find_by8_demosaic<method::nearest>,
+          { { fourcc::BGRA32, fourcc::RGGB8 }, { fourcc::BGR24, fourcc::GBRG8 } },
+          false,
+          0,
+          true },
+        { "by8_bilinear",
+          find_by8_demosaic<method::bilinear>,
+          { { fourcc::BGRA32, fourcc::RGGB8 }, { fourcc::BGR24, fourcc::GBRG8 } },
+          false,
+          0,
+          true },
+        { "by8_hq",
+          find_by8_demosaic<method::hq>,
+          { { fourcc::BGRA32, fourcc::RGGB8 }, { fourcc::BGR24, fourcc::GBRG8 } },
+          false,
+          0,
+          true },
+        { "by8_edge_ccm", find_by8_edge_ccm, { { fourcc::BGRA32, fourcc::RGGB8 } }, false, 2 },
+        { "by16_edge", find_by16_edge, { { fourcc::BGRA64, fourcc::RGGB16 } } },
+        { "by_luma", find_by_luma, { { fourcc::MONO8, fourcc::RGGB8 }, { fourcc::MONO16, fourcc::RGGB16 } } },
+        { "fcc1x_packed_to_fcc8",
+          find_fcc1x_packed_to_fcc8,
+          {
+              { fourcc::MONO8, fourcc::MONO10_MIPI_PACKED },
+              { fourcc::MONO8, fourcc::MONO12_PACKED },
+              { fourcc::RGGB8, fourcc::RGGB12_MIPI_PACKED },
+          } },
+        { "fcc1x_packed_to_fcc16",
+          find_fcc1x_packed_to_fcc16,
+          {
+              { fourcc::MONO16, fourcc::MONO10_MIPI_PACKED },
+              { fourcc::MONO16, fourcc::MONO12_PACKED },
+              { fourcc::RGGB16, fourcc::RGGB12_MIPI_PACKED },
+          } },
+        { "fcc1x_mono_to_dst",
+          find_fcc1x_mono_to_dst,
+          {
+              { fourcc::BGRA32, fourcc::MONO12_PACKED },
+              { fourcc::BGRA32, fourcc::MONO16 },
+              { fourcc::MONOFloat, fourcc::MONO12_MIPI_PACKED },
+              { fourcc::MONOFloat, fourcc::MONO16 },
+          } },
+        { "fcc8_fcc16",
+          find_fcc8_fcc16,
+          { { fourcc::MONO16, fourcc::MONO8 }, { fourcc::MONO8, fourcc::MONO16 } } },
+        { "mono_to_bgr",
+          find_mono_to_bgr,
+          { { fourcc::BGRA32, fourcc::MONO8 }, { fourcc::BGRA64, fourcc::MONO16 } } },
+        { "bgra_to_yuv",
+          find_bgra_to_yuv,
+          {
+              { fourcc::NV12, fourcc::BGRA32 },
+              { fourcc::I420, fourcc::BGRA32 },
+              { fourcc::YUY2, fourcc::BGRA32 },
+          },
+          false,
+          1 },
+        { "wb_apply",
+          find_wb_apply,
+          {
+              { fourcc::RGGB8, fourcc::RGGB8 },
+              { fourcc::RGGB16, fourcc::RGGB16 },
+              { fourcc::RGGBFloat, fourcc::RGGBFloat },
+          },
+          true },
+        // neon evaluates the PWL curve instead of using the lut
+        { "pwl_to_fccfloat",
+          find_pwl_to_fccfloat,
+          {
+              { fourcc::RGGBFloat, fourcc::PWL_RG12_MIPI },
+              { fourcc::RGGBFloat, fourcc::PWL_RG12 },
+              { fourcc::RGGBFloat, fourcc::PWL_RG16H12 },
+          },
+          false,
+          1e-6 },
+        { "pwl_to_fccfloat_wb",
+          find_pwl_to_fccfloat_wb,
+          { { fourcc::RGGBFloat, fourcc::PWL_RG12_MIPI }, { fourcc::RGGBFloat, fourcc::PWL_RG12 } },
+          false,
+          1e-6 },
+        { "pwl_to_fcc8_fcc16",
+          find_pwl_to_fcc8_fcc16,
+          {
+              { fourcc::RGGB8, fourcc::PWL_RG12_MIPI },
+              { fourcc::RGGB8, fourcc::PWL_RG12 },
+              { fourcc::RGGB16, fourcc::PWL_RG12_MIPI },
+          },
+          false,
+          1 },
+        // compilers may contract the float calculations of the C variant differently
+        { "polarization",
+          find_polarization,
+          {
+              { fourcc::POLARIZATION_PACKED8, fourcc::POLARIZATION_MONO8_90_45_135_0 },
+              { fourcc::POLARIZATION_ADI_MONO8, fourcc::POLARIZATION_MONO8_90_45_135_0 },
+              { fourcc::BGRA32, fourcc::POLARIZATION_MONO8_90_45_135_0 },
+              { fourcc::POLARIZATION_PACKED16, fourcc::POLARIZATION_MONO16_90_45_135_0 },
+              { fourcc::POLARIZATION_ADI_MONO16, fourcc::POLARIZATION_MONO16_90_45_135_0 },
+              { fourcc::BGRA32, fourcc::POLARIZATION_MONO16_90_45_135_0 },
+          },
+          false,
+          1 },
+        { "polarization_stokes",
+          find_polarization,
+          {
+              { fourcc::BGRFloat, fourcc::POLARIZATION_MONO8_90_45_135_0 },
+              { fourcc::BGRFloat, fourcc::POLARIZATION_MONO16_90_45_135_0 },
+          },
+          false,
+          1e-6 },
+        { "memcpy",
+          find_memcpy,
+          { { fourcc::MONO8, fourcc::MONO8 }, { fourcc::BGRA32, fourcc::BGRA32 } } },
+        // the gray values of the auto hdr gain, the SIMD versions keep the order of the C version
+        { "sample_gray_sum",
+          find_sample_gray_sum,
+          { { fourcc::MONOFloat, fourcc::BGRFloat } },
+          false,
+          0,
+          false,
+          true },
+    };
+}
+
+
+enum class channel_type
+{
+    u8,
+    u16,
+    f32,
+};
+
+channel_type get_channel_type(img::fourcc fcc) noexcept
+{
+    using img::fourcc;
+
+    if (img::is_byfloat_fcc(fcc) || fcc == fourcc::BGRFloat || fcc == fourcc::MONOFloat)
+    {
+        return channel_type::f32;
+    }
+    if (img::is_by16_fcc(fcc) || fcc == fourcc::MONO16 || fcc == fourcc::BGRA64
+        || fcc == fourcc::POLARIZATION_MONO16_90_45_135_0 || fcc == fourcc::POLARIZATION_PACKED16
+        || fcc == fourcc::POLARIZATION_ADI_MONO16)
+    {
+        return channel_type::u16;
+    }
+    return channel_type::u8;
+}
+
+// float images get values in [0;1], PWL_RG12 12 bit values, all others random bytes
+void fill_random(std::vector<uint8_t>& buffer, img::fourcc fcc, std::mt19937& rng)
+{
+    if (get_channel_type(fcc) == channel_type::f32)
+    {
+        std::uniform_real_distribution<float> dist(0.f, 1.f);
+        auto* ptr = reinterpret_cast<float*>(buffer.data());
+        for (size_t i = 0; i < buffer.size() / sizeof(float); ++i) { ptr[i] = dist(rng); }
+        return;
+    }
+    for (auto& b : buffer) { b = static_cast<uint8_t>(rng()); }
+
+    if (fcc == img::fourcc::PWL_RG12)
+    {
+        // the C variants expect 12 bit values
+        auto* ptr = reinterpret_cast<uint16_t*>(buffer.data());
+        for (size_t i = 0; i < buffer.size() / sizeof(uint16_t); ++i) { ptr[i] &= 0x0FFF; }
+    }
+}
+
+template<typename T> double max_diff_of(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b)
+{
+    const auto* pa = reinterpret_cast<const T*>(a.data());
+    const auto* pb = reinterpret_cast<const T*>(b.data());
+
+    double rval = 0;
+    for (size_t i = 0; i < a.size() / sizeof(T); ++i)
+    {
+        const double diff = std::abs(static_cast<double>(pa[i]) - static_cast<double>(pb[i]));
+        if (!(diff <= rval)) // also catches NaN
+        {
+            rval = std::isnan(diff) ? INFINITY : diff;
+        }
+    }
+    return rval;
+}
+
+double max_diff(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, img::fourcc fcc)
+{
+    switch (get_channel_type(fcc))
+    {
+        case channel_type::f32:
+            return max_diff_of<float>(a, b);
+        case channel_type::u16:
+            return max_diff_of<uint16_t>(a, b);
+        case channel_type::u8:
+            break;
+    }
+    return max_diff_of<uint8_t>(a, b);
+}
+
+// BGR of the test scene at x, y in [0;1]: smooth color gradients, diagonal color edges and a
+// gray zone plate in the right third, that reaches 1/4 cycle per pixel at its border
+void scene_pixel(img::dim dim, int x, int y, double (&bgr)[3])
+{
+    const double pi = 3.14159265358979323846;
+    const double fx = double(x) / dim.cx;
+    const double fy = double(y) / dim.cy;
+
+    double r = 0.5 + 0.4 * std::sin(2 * pi * (2 * fx + fy));
+    double g = 0.5 + 0.4 * std::sin(2 * pi * 3 * fy + 1.0);
+    double b = 0.5 + 0.4 * std::cos(2 * pi * (fx + 2 * fy));
+
+    if (((x + 2 * y) / 97) % 2)
+    {
+        r *= 0.3;
+        b = 1.0 - 0.5 * b;
+    }
+
+    if (x >= 2 * dim.cx / 3)
+    {
+        const double radius = std::max(1.0, std::min(dim.cx / 6.0, dim.cy / 2.0));
+        const double dx = x - 5.0 * dim.cx / 6;
+        const double dy = y - dim.cy / 2.0;
+        const double k = 0.25 * pi / radius;
+        r = g = b = 0.5 + 0.45 * std::cos(k * (dx * dx + dy * dy));
+    }
+
+    bgr[0] = b;
+    bgr[1] = g;
+    bgr[2] = r;
+}
+
+uint8_t to_u8(double val) noexcept
+{
+    return static_cast<uint8_t>(std::clamp(val * 255.0 + 0.5, 0.0, 255.0));
+}
+
+// Samples the test scene with the bayer pattern of src
+void fill_bayer_scene(const img::img_descriptor& src)
+{
+    using namespace img::by_transform;
+    using namespace img::by_transform::by_pattern_alg;
+
+    // index of the color of the first pixel of a pattern in BGR
+    const auto color_index = [](by_pattern pat)
+    {
+        switch (pat)
+        {
+            case by_pattern::BG:
+                return 0;
+            case by_pattern::RG:
+                return 2;
+            case by_pattern::GB:
+            case by_pattern::GR:
+                break;
+        }
+        return 1;
+    };
+
+    const auto pattern = convert_bayer_fcc_to_pattern(src.fourcc_type());
+    for (int y = 0; y < src.dim.cy; ++y)
+    {
+        const auto line_pattern = (y % 2) ? next_line(pattern) : pattern;
+        const int index[2] = { color_index(line_pattern), color_index(next_pixel(line_pattern)) };
+
+        auto* line = img::get_line_start(src, y);
+        for (int x = 0; x < src.dim.cx; ++x)
+        {
+            double bgr[3];
+            scene_pixel(src.dim, x, y, bgr);
+            line[x] = to_u8(bgr[index[x % 2]]);
+        }
+    }
+}
+
+// PSNR of the BGRA32 or BGR24 image dst against the test scene
+double calc_scene_psnr(const img::img_descriptor& dst)
+{
+    const auto fcc = dst.fourcc_type();
+    const int bytes_per_pixel = img::get_bits_per_pixel(fcc) / 8;
+
+    double sum = 0;
+    for (int y = 0; y < dst.dim.cy; ++y)
+    {
+        const int line_y = img::is_bottom_up_fcc(fcc) ? dst.dim.cy - 1 - y : y;
+        const auto* line = img::get_line_start(dst, line_y);
+        for (int x = 0; x < dst.dim.cx; ++x)
+        {
+            double bgr[3];
+            scene_pixel(dst.dim, x, y, bgr);
+            for (int c = 0; c < 3; ++c)
+            {
+                const double diff = double(line[x * bytes_per_pixel + c]) - to_u8(bgr[c]);
+                sum += diff * diff;
+            }
+        }
+    }
+
+    const double mse = sum / (3.0 * dst.dim.cx * dst.dim.cy);
+    if (mse == 0)
+    {
+        return INFINITY;
+    }
+    return 10 * std::log10(255.0 * 255.0 / mse);
+}
+
+// Median time of one call in us, runs for at least min_time and min_iterations.
+double measure(const kernel_func& func,
+               const img::img_descriptor& dst,
+               const img::img_descriptor& src,
+               std::chrono::milliseconds min_time,
+               int min_iterations)
+{
+    using clock = std::chrono::steady_clock;
+
+    func(dst, src); // warm up caches and page in dst
+
+    std::vector<double> times;
+    const auto start = clock::now();
+    while ((int)times.size() < min_iterations || clock::now() - start < min_time)
+    {
+        const auto t0 = clock::now();
+        func(dst, src);
+        const auto t1 = clock::now();
+        times.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+    }
+    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    return times[times.size() / 2];
+}
+
+struct options
+{
+    std::vector<img::dim> resolutions;
+    std::string family_filter;
+    std::chrono::milliseconds min_time { 200 };
+    int min_iterations = 5;
+};
+
+void run_family(const kernel_family& family, const options& opt, std::vector<result>& results)
+{
+    std::mt19937 rng(42);
+
+    for (const auto& fmt : family.formats)
+    {
+        for (const auto& dim : opt.resolutions)
+        {
+            const auto dst_type = img::make_img_type(fmt.dst, dim);
+            const auto src_type = img::make_img_type(fmt.src, dim);
+
+            const auto variants = family.find_variants(dst_type, src_type);
+            if (variants.empty())
+            {
+                continue;
+            }
+
+            std::vector<uint8_t> src_buffer(src_type.buffer_length);
+            fill_random(src_buffer, fmt.src, rng);
+
+            // the timing runs overwrite dst, so the reference result is kept separately
+            std::vector<uint8_t> ref_result;
+            std::vector<uint8_t> dst_buffer(dst_type.buffer_length);
+
+            auto make_desc = [](const img::img_type& type, std::vector<uint8_t>& buffer)
+            { return img::make_img_desc_from_linear_memory(type, buffer.data()); };
+
+            const auto src = make_desc(src_type, src_buffer);
+            if (family.measure_quality)
+            {
+                fill_bayer_scene(src);
+            }
+
+            for (const auto& variant : variants)
+            {
+                const auto dst = make_desc(dst_type, dst_buffer);
+
+                // one call on fresh data for the comparison, in place kernels start from src
+                if (family.in_place)
+                {
+                    std::copy(src_buffer.begin(), src_buffer.end(), dst_buffer.begin());
+                }
+                else
+                {
+                    std::fill(dst_buffer.begin(), dst_buffer.end(), 0);
+                }
+                variant.func(dst, src);
+
+                result res;
+                res.family = family.name;
+                res.isa = variant.isa;
+                res.dst_fcc = img::fcc_to_string(fmt.dst);
+                res.src_fcc = img::fcc_to_string(fmt.src);
+                res.dim = dim;
+
+                if (ref_result.empty())
+                {
+                    ref_result = dst_buffer;
+                }
+                else
+                {
+                    res.max_diff = max_diff(ref_result, dst_buffer, fmt.dst);
+                    res.matches = res.max_diff <= family.tolerance;
+                }
+                if (family.measure_quality)
+                {
+                    res.psnr = calc_scene_psnr(dst);
+                }
+
+                res.time_us = measure(variant.func, dst, src, opt.min_time, opt.min_iterations);
+
+                // in place kernels read and write dst, reductions only read src
+                double bytes = double(src_type.buffer_length) + dst_type.buffer_length;
+                if (family.in_place)
+                {
+                    bytes = 2.0 * dst_type.buffer_length;
+                }
+                else if (family.reduction)
+                {
+                    bytes = double(src_type.buffer_length);
+                }
+                res.gb_per_s = bytes / (res.time_us * 1e3);
+                res.mpix_per_s = double(dim.cx) * dim.cy / res.time_us;
+
+                results.push_back(res);
+
+                printf("%-22s %-6s %-8s -> %-8s %5dx%-5d %9.1f us %7.2f GB/s %8.1f Mpix/s",
+                       res.family.c_str(),
+                       res.isa.c_str(),
+                       res.src_fcc.c_str(),
+                       res.dst_fcc.c_str(),
+                       dim.cx,
+                       dim.cy,
+                       res.time_us,
+                       res.gb_per_s,
+                       res.mpix_per_s);
+                if (!std::isnan(res.psnr))
+                {
+                    printf(" %6.2f dB", res.psnr);
+                }
+                if (!res.matches)
+                {
+                    printf("  MISMATCH max diff %g", res.max_diff);
+                }
+                printf("\n");
+                fflush(stdout);
+            }
+        }
+    }
+}
+
+// null when not measured, a large value for identical images
+std::string format_psnr(double psnr)
+{
+    if (std::isnan(psnr))
+    {
+        return "null";
+    }
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.3f", std::isinf(psnr) ? 999.0 : psnr);
+    return buf;
+}
+
+bool write_json(const std::string& filename, const std::vector<result>& results)
+{
+    FILE* f = fopen(filename.c_str(), "w");
+    if (!f)
+    {
+        fprintf(stderr, "Unable to open '%s' for writing.\n", filename.c_str());
+        return false;
+    }
+
+    fprintf(f, "{\n  \"cpu_features\": %u,\n  \"results\": [\n", cpu_features);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& r = results[i];
+        fprintf(f,
+                "    { \"family\": \"%s\", \"isa\": \"%s\", \"src\": \"%s\", \"dst\": \"%s\", "
+                "\"width\": %d, \"height\": %d, \"time_us\": %.3f, \"gb_per_s\": %.4f, "
+                "\"mpix_per_s\": %.3f, \"max_diff\": %g, \"matches\": %s, \"psnr\": %s }%s\n",
+                r.family.c_str(),
+                r.isa.c_str(),
+                r.src_fcc.c_str(),
+                r.dst_fcc.c_str(),
+                r.dim.cx,
+                r.dim.cy,
+                r.time_us,
+                r.gb_per_s,
+                r.mpix_per_s,
+                std::isinf(r.max_diff) ? 1e300 : r.max_diff,
+                r.matches ? "true" : "false",
+                format_psnr(r.psnr).c_str(),
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return true;
+}
+
+std::optional<img::dim> parse_dim(const std::string& str)
+{
+    int w = 0;
+    int h = 0;
+    if (sscanf(str.c_str(), "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0)
+    {
+        return std::nullopt;
+    }
+    return img::dim { w, h };
+}
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+    CLI::App app { "Benchmark and cross check the dutils_image kernels" };
+
+    std::vector<std::string> resolutions = { "640x480", "1920x1080", "2448x2048", "4096x3000" };
+    std::string family_filter;
+    std::string json_file;
+    int min_time_ms = 200;
+    int min_iterations = 5;
+    bool list_only = false;
+
+    app.add_option("-r,--resolution", resolutions, "Resolutions to test, e.g. 1920x1080");
+    app.add_option("-f,--family", family_filter, "Only run kernel families containing this string");
+    app.add_option("-j,--json", json_file, "Write the results as JSON to this file");
+    app.add_option("-t,--min-time", min_time_ms, "Minimum run time per kernel in ms");
+    app.add_option("-n,--min-iterations", min_iterations, "Minimum iterations per kernel");
+    app.add_flag("-l,--list", list_only, "List the kernel families and exit");
+
+    CLI11_PARSE(app, argc, argv);
+
+    cpu_features = img_lib::cpu::get_features();
+
+    const auto families = get_families();
+    if (list_only)
+    {
+        for (const auto& family : families) { printf("%s\n", family.name); }
+        return 0;
+    }
+
+    options opt;
+    opt.family_filter = family_filter;
+    opt.min_time = std::chrono::milliseconds(min_time_ms);
+    opt.min_iterations = std::max(min_iterations, 1);
+    for (const auto& str : resolutions)
+    {
+        auto dim = parse_dim(str);
+        if (!dim)
+        {
+            fprintf(stderr, "Invalid resolution '%s', expected WIDTHxHEIGHT.\n", str.c_str());
+            return 1;
+        }
+        opt.resolutions.push_back(*dim);
+    }
+
+    std::vector<result> results;
+    for (const auto& family : families)
+    {
+        if (!family_filter.empty() && std::string(family.name).find(family_filter) == std::string::npos)
+        {
+            continue;
+        }
+        run_family(family, opt, results);
+    }
+
+    if (!json_file.empty() && !write_json(json_file, results))
+    {
+        return 1;
+    }
+
+    const auto mismatches =
+        std::count_if(results.begin(), results.end(), [](const result& r) { return !r.matches; });
+    if (mismatches > 0)
+    {
+        fprintf(stderr, "%d kernel runs differ from the reference.\n", static_cast<int>(mismatches));
+        return 2;
+    }
+    return 0;
+}
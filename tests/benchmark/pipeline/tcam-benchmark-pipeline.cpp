@@ -0,0 +1,535 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// Streams a virtcam device through tcammainsrc and tcamconvert into a fakesink and reports the
+// sustained frame rate, the latency of the individual stages, cpu time per frame and drops.
+
+#include <CLI11.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <gst/gst.h>
+#include <mutex>
+#include <string>
+#include <sys/resource.h>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+using clock_type = std::chrono::steady_clock;
+
+int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               clock_type::now().time_since_epoch())
+        .count();
+}
+
+int64_t get_cpu_time_ns()
+{
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+
+    auto to_ns = [](const timeval& tv)
+    {
+        return static_cast<int64_t>(tv.tv_sec) * 1'000'000'000 + tv.tv_usec * 1000;
+    };
+    return to_ns(usage.ru_utime) + to_ns(usage.ru_stime);
+}
+
+struct percentiles
+{
+    size_t count = 0;
+    double p50_us = 0;
+    double p90_us = 0;
+    double p99_us = 0;
+    double max_us = 0;
+};
+
+percentiles calc_percentiles(std::vector<int64_t> samples)
+{
+    percentiles rval;
+    rval.count = samples.size();
+    if (samples.empty())
+    {
+        return rval;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto at = [&samples](double p)
+    {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))]
+               / 1000.0;
+    };
+    rval.p50_us = at(0.5);
+    rval.p90_us = at(0.9);
+    rval.p99_us = at(0.99);
+    rval.max_us = samples.back() / 1000.0;
+    return rval;
+}
+
+// Everything the pad probes and the bus watch collect.
+// The probes run in the streaming thread, the bus watch in the main loop.
+struct benchmark_state
+{
+    GMainLoop* loop = nullptr;
+    GstElement* pipeline = nullptr;
+    GstElement* source = nullptr;
+
+    std::atomic<bool> measuring = false;
+    int64_t measure_start_ns = 0;
+    int64_t measure_start_cpu_ns = 0;
+    int64_t measure_end_ns = 0;
+    int64_t measure_end_cpu_ns = 0;
+
+    std::mutex mtx;
+
+    // keyed by the pts of the buffer, written by the tcammainsrc src pad probe
+    std::unordered_map<GstClockTime, int64_t> source_out_ns;
+    std::unordered_map<GstClockTime, int64_t> convert_out_ns;
+
+    std::vector<int64_t> capture_to_source; // pts until the buffer leaves tcammainsrc
+    std::vector<int64_t> source_to_convert; // tcammainsrc src pad until tcamconvert src pad
+    std::vector<int64_t> convert_to_sink;   // tcamconvert src pad until fakesink
+    std::vector<int64_t> end_to_end;        // pts until fakesink
+
+    uint64_t frames = 0;
+
+    // from the tcam-stream-statistics messages
+    bool have_statistics = false;
+    uint64_t frames_dropped_start = 0;
+    uint64_t frames_dropped = 0;
+    uint64_t starvation_drops = 0;
+    uint64_t max_pool_outstanding = 0;
+    uint64_t max_queue_depth = 0;
+    uint64_t push_delay_max_ns = 0;
+
+    bool error = false;
+};
+
+// returns the running time of element or GST_CLOCK_TIME_NONE
+GstClockTime get_running_time(GstElement* element)
+{
+    GstClock* clock = gst_element_get_clock(element);
+    if (!clock)
+    {
+        return GST_CLOCK_TIME_NONE;
+    }
+    const GstClockTime now = gst_clock_get_time(clock);
+    gst_object_unref(clock);
+
+    const GstClockTime base_time = gst_element_get_base_time(element);
+    if (now < base_time)
+    {
+        return GST_CLOCK_TIME_NONE;
+    }
+    return now - base_time;
+}
+
+GstPadProbeReturn source_probe(GstPad* /*pad*/, GstPadProbeInfo* info, gpointer user_data)
+{
+    auto& state = *static_cast<benchmark_state*>(user_data);
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+    if (!state.measuring || !buffer || !GST_BUFFER_PTS_IS_VALID(buffer))
+    {
+        return GST_PAD_PROBE_OK;
+    }
+
+    const int64_t t = now_ns();
+    const GstClockTime running_time = get_running_time(state.source);
+
+    std::scoped_lock lck { state.mtx };
+    state.source_out_ns[GST_BUFFER_PTS(buffer)] = t;
+    if (GST_CLOCK_TIME_IS_VALID(running_time) && running_time >= GST_BUFFER_PTS(buffer))
+    {
+        state.capture_to_source.push_back(running_time - GST_BUFFER_PTS(buffer));
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn convert_probe(GstPad* /*pad*/, GstPadProbeInfo* info, gpointer user_data)
+{
+    auto& state = *static_cast<benchmark_state*>(user_data);
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+    if (!state.measuring || !buffer || !GST_BUFFER_PTS_IS_VALID(buffer))
+    {
+        return GST_PAD_PROBE_OK;
+    }
+
+    const int64_t t = now_ns();
+
+    std::scoped_lock lck { state.mtx };
+    auto iter = state.source_out_ns.find(GST_BUFFER_PTS(buffer));
+    if (iter != state.source_out_ns.end())
+    {
+        state.source_to_convert.push_back(t - iter->second);
+        state.convert_out_ns[GST_BUFFER_PTS(buffer)] = t;
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn sink_probe(GstPad* /*pad*/, GstPadProbeInfo* info, gpointer user_data)
+{
+    auto& state = *static_cast<benchmark_state*>(user_data);
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+    if (!state.measuring || !buffer)
+    {
+        return GST_PAD_PROBE_OK;
+    }
+
+    const int64_t t = now_ns();
+    const GstClockTime running_time = get_running_time(state.source);
+
+    std::scoped_lock lck { state.mtx };
+    state.frames++;
+
+    if (!GST_BUFFER_PTS_IS_VALID(buffer))
+    {
+        return GST_PAD_PROBE_OK;
+    }
+    const GstClockTime pts = GST_BUFFER_PTS(buffer);
+
+    if (auto iter = state.convert_out_ns.find(pts); iter != state.convert_out_ns.end())
+    {
+        state.convert_to_sink.push_back(t - iter->second);
+        state.convert_out_ns.erase(iter);
+    }
+    state.source_out_ns.erase(pts);
+
+    if (GST_CLOCK_TIME_IS_VALID(running_time) && running_time >= pts)
+    {
+        state.end_to_end.push_back(running_time - pts);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+void handle_statistics(benchmark_state& state, const GstStructure* struc)
+{
+    guint64 value = 0;
+
+    if (gst_structure_get_uint64(struc, "frames_dropped", &value))
+    {
+        if (!state.have_statistics)
+        {
+            // the counter is cumulative, only count the drops after the warm up
+            state.frames_dropped_start = value;
+            state.have_statistics = true;
+        }
+        state.frames_dropped = value - std::min(value, state.frames_dropped_start);
+    }
+    if (gst_structure_get_uint64(struc, "starvation_drops", &value))
+    {
+        state.starvation_drops += value;
+    }
+    if (gst_structure_get_uint64(struc, "pool_outstanding", &value))
+    {
+        state.max_pool_outstanding = std::max<uint64_t>(state.max_pool_outstanding, value);
+    }
+    if (gst_structure_get_uint64(struc, "queue_depth", &value))
+    {
+        state.max_queue_depth = std::max<uint64_t>(state.max_queue_depth, value);
+    }
+    if (gst_structure_get_uint64(struc, "push_delay_max_ns", &value))
+    {
+        state.push_delay_max_ns = std::max<uint64_t>(state.push_delay_max_ns, value);
+    }
+}
+
+gboolean bus_callback(GstBus* /*bus*/, GstMessage* message, gpointer user_data)
+{
+    auto& state = *static_cast<benchmark_state*>(user_data);
+
+    switch (GST_MESSAGE_TYPE(message))
+    {
+        case GST_MESSAGE_ERROR:
+        {
+            GError* err = nullptr;
+            gchar* debug = nullptr;
+            gst_message_parse_error(message, &err, &debug);
+            fprintf(stderr, "Error: %s\n%s\n", err->message, debug ? debug : "");
+            g_error_free(err);
+            g_free(debug);
+
+            state.error = true;
+            g_main_loop_quit(state.loop);
+            break;
+        }
+        case GST_MESSAGE_EOS:
+        {
+            g_main_loop_quit(state.loop);
+            break;
+        }
+        case GST_MESSAGE_ELEMENT:
+        {
+            const GstStructure* struc = gst_message_get_structure(message);
+            if (state.measuring && struc
+                && gst_structure_has_name(struc, "tcam-stream-statistics"))
+            {
+                handle_statistics(state, struc);
+            }
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+    return TRUE;
+}
+
+void add_probe(GstElement* element, const char* pad_name, GstPadProbeCallback cb, benchmark_state& state)
+{
+    GstPad* pad = gst_element_get_static_pad(element, pad_name);
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, cb, &state, nullptr);
+    gst_object_unref(pad);
+}
+
+void print_stage(const char* name, const percentiles& p)
+{
+    printf("  %-20s p50 %9.1f us  p90 %9.1f us  p99 %9.1f us  max %9.1f us  (%zu samples)\n",
+           name,
+           p.p50_us,
+           p.p90_us,
+           p.p99_us,
+           p.max_us,
+           p.count);
+}
+
+void write_stage_json(FILE* f, const char* name, const percentiles& p, bool last)
+{
+    fprintf(f,
+            "    \"%s\": { \"p50_us\": %.3f, \"p90_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f, "
+            "\"samples\": %zu }%s\n",
+            name,
+            p.p50_us,
+            p.p90_us,
+            p.p99_us,
+            p.max_us,
+            p.count,
+            last ? "" : ",");
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    CLI::App app { "Pipeline throughput benchmark on top of tcam-virtcam" };
+
+    std::string caps_str = "video/x-bayer,format=rggb,width=1920,height=1080,framerate=60/1";
+    std::string output_format = "BGRx";
+    double warmup_s = 2;
+    double duration_s = 10;
+    int camera_buffers = 10;
+    double min_fps = 0;
+    bool no_convert = false;
+    bool free_running = false;
+    std::string json_file;
+
+    app.add_option("-c,--caps", caps_str, "Caps of the virtcam device", true);
+    app.add_option("-o,--output-format", output_format, "Format tcamconvert converts to", true);
+    app.add_option("-w,--warmup", warmup_s, "Seconds before the measurement starts", true);
+    app.add_option("-d,--duration", duration_s, "Seconds to measure", true);
+    app.add_option("-b,--camera-buffers", camera_buffers, "Number of device buffers", true);
+    app.add_option("--min-fps", min_fps, "Return an error when the frame rate is lower", true);
+    app.add_flag("--no-convert", no_convert, "Connect tcammainsrc directly to the fakesink");
+    app.add_flag("--free-running",
+                 free_running,
+                 "Let virtcam send images as fast as buffers are available, ignoring the frame rate");
+    app.add_option("-j,--json", json_file, "Write the results as JSON to this file");
+
+    CLI11_PARSE(app, argc, argv);
+
+    // one virtcam device is enough, an existing configuration is kept
+    setenv("TCAM_VIRTCAM_DEVICES", "benchmark", 0);
+    if (free_running)
+    {
+        setenv("TCAM_VIRTCAM_FREE_RUNNING", "1", 1);
+    }
+
+    gst_init(&argc, &argv);
+
+    std::string pipeline_str = "tcammainsrc name=source type=virtcam num-buffers=-1 "
+                               "statistics-interval=500 camera-buffers="
+                               + std::to_string(camera_buffers) + " ! " + caps_str;
+    if (!no_convert)
+    {
+        pipeline_str += " ! tcamconvert name=convert ! video/x-raw,format=" + output_format;
+    }
+    pipeline_str += " ! fakesink name=sink sync=false";
+
+    GError* err = nullptr;
+    GstElement* pipeline = gst_parse_launch(pipeline_str.c_str(), &err);
+    if (!pipeline)
+    {
+        fprintf(stderr, "Unable to create pipeline: %s\n", err ? err->message : "");
+        g_clear_error(&err);
+        return 1;
+    }
+
+    benchmark_state state;
+    state.loop = g_main_loop_new(nullptr, FALSE);
+    state.pipeline = pipeline;
+    state.source = gst_bin_get_by_name(GST_BIN(pipeline), "source");
+
+    GstElement* convert = gst_bin_get_by_name(GST_BIN(pipeline), "convert");
+    GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+
+    add_probe(state.source, "src", source_probe, state);
+    if (convert)
+    {
+        add_probe(convert, "src", convert_probe, state);
+    }
+    add_probe(sink, "sink", sink_probe, state);
+
+    GstBus* bus = gst_element_get_bus(pipeline);
+    gst_bus_add_watch(bus, bus_callback, &state);
+    gst_object_unref(bus);
+
+    printf("Pipeline: %s\n", pipeline_str.c_str());
+
+    if (gst_element_set_state(pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    {
+        fprintf(stderr, "Unable to start pipeline.\n");
+        return 1;
+    }
+
+    struct timer_context
+    {
+        benchmark_state* state;
+        double duration_s;
+    };
+    timer_context ctx { &state, duration_s };
+
+    g_timeout_add(
+        static_cast<guint>(warmup_s * 1000),
+        [](gpointer data) -> gboolean
+        {
+            auto& c = *static_cast<timer_context*>(data);
+
+            c.state->measure_start_ns = now_ns();
+            c.state->measure_start_cpu_ns = get_cpu_time_ns();
+            c.state->measuring = true;
+
+            g_timeout_add(
+                static_cast<guint>(c.duration_s * 1000),
+                [](gpointer d) -> gboolean
+                {
+                    auto& s = *static_cast<benchmark_state*>(d);
+
+                    s.measuring = false;
+                    s.measure_end_ns = now_ns();
+                    s.measure_end_cpu_ns = get_cpu_time_ns();
+
+                    g_main_loop_quit(s.loop);
+                    return G_SOURCE_REMOVE;
+                },
+                c.state);
+            return G_SOURCE_REMOVE;
+        },
+        &ctx);
+
+    g_main_loop_run(state.loop);
+
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+
+    if (state.error)
+    {
+        return 1;
+    }
+
+    std::scoped_lock lck { state.mtx };
+
+    const double elapsed_s = (state.measure_end_ns - state.measure_start_ns) / 1e9;
+    const double fps = elapsed_s > 0 ? state.frames / elapsed_s : 0;
+    const double cpu_per_frame_us =
+        state.frames ? (state.measure_end_cpu_ns - state.measure_start_cpu_ns) / 1000.0 / state.frames
+                     : 0;
+
+    const auto capture_to_source = calc_percentiles(state.capture_to_source);
+    const auto source_to_convert = calc_percentiles(state.source_to_convert);
+    const auto convert_to_sink = calc_percentiles(state.convert_to_sink);
+    const auto end_to_end = calc_percentiles(state.end_to_end);
+
+    printf("Frames:          %llu in %.2f s\n", (unsigned long long)state.frames, elapsed_s);
+    printf("Frame rate:      %.2f fps\n", fps);
+    printf("CPU per frame:   %.1f us\n", cpu_per_frame_us);
+    printf("Dropped:         %llu by the device, %llu by buffer starvation\n",
+           (unsigned long long)state.frames_dropped,
+           (unsigned long long)state.starvation_drops);
+    printf("Buffers:         max %llu outstanding, max %llu queued, max push delay %.1f us\n",
+           (unsigned long long)state.max_pool_outstanding,
+           (unsigned long long)state.max_queue_depth,
+           state.push_delay_max_ns / 1000.0);
+    printf("Latency:\n");
+    print_stage("capture -> source", capture_to_source);
+    if (convert)
+    {
+        print_stage("source -> convert", source_to_convert);
+        print_stage("convert -> sink", convert_to_sink);
+    }
+    print_stage("capture -> sink", end_to_end);
+
+    if (!json_file.empty())
+    {
+        FILE* f = fopen(json_file.c_str(), "w");
+        if (!f)
+        {
+            fprintf(stderr, "Unable to open '%s' for writing.\n", json_file.c_str());
+            return 1;
+        }
+        fprintf(f, "{\n  \"caps\": \"%s\",\n", caps_str.c_str());
+        fprintf(f, "  \"convert\": %s,\n", convert ? "true" : "false");
+        fprintf(f, "  \"free_running\": %s,\n", free_running ? "true" : "false");
+        fprintf(f, "  \"frames\": %llu,\n", (unsigned long long)state.frames);
+        fprintf(f, "  \"duration_s\": %.3f,\n", elapsed_s);
+        fprintf(f, "  \"fps\": %.3f,\n", fps);
+        fprintf(f, "  \"cpu_per_frame_us\": %.3f,\n", cpu_per_frame_us);
+        fprintf(f, "  \"frames_dropped\": %llu,\n", (unsigned long long)state.frames_dropped);
+        fprintf(f, "  \"starvation_drops\": %llu,\n", (unsigned long long)state.starvation_drops);
+        fprintf(f, "  \"latency\": {\n");
+        write_stage_json(f, "capture_to_source", capture_to_source, false);
+        write_stage_json(f, "source_to_convert", source_to_convert, false);
+        write_stage_json(f, "convert_to_sink", convert_to_sink, false);
+        write_stage_json(f, "capture_to_sink", end_to_end, true);
+        fprintf(f, "  }\n}\n");
+        fclose(f);
+    }
+
+    if (convert)
+    {
+        gst_object_unref(convert);
+    }
+    gst_object_unref(sink);
+    gst_object_unref(state.source);
+    gst_object_unref(pipeline);
+    g_main_loop_unref(state.loop);
+
+    if (fps < min_fps)
+    {
+        fprintf(stderr, "Frame rate %.2f is below the minimum of %.2f fps.\n", fps, min_fps);
+        return 2;
+    }
+    return 0;
+}
@@ -29,6 +29,7 @@ struct TcamCaptureConfig
 {
     FormatHandling format_selection_type = FormatHandling::Auto;
     ConversionElement conversion_element = ConversionElement::Auto;
+    PreviewMode preview_mode = PreviewMode::Software;
     QString video_sink_element = "qwidget5videosink";
 
     // expectations
@@ -38,17 +39,38 @@ struct TcamCaptureConfig
     // if a capsfilter element named device-caps exists it will have the configured caps set
     // all tcam-property elements are named: tcam0, tcam1, etc
     // tcam0 is always source
+    // if a videorate element named preview-rate exists its max-rate is set to the display refresh rate
+    // the preview queue holds at most 2 buffers and drops the oldest,
+    // a slow preview may not hold back the pool or the capture-tee branches of VideoSaver
     QString pipeline =
         "tcambin name=tcam0 ! video/x-raw,format=BGRx "
         " ! tee name=capture-tee "
-        " ! queue leaky=1 max-size-time=0 max-size-bytes=0 max-size-buffers=0"
+        " ! queue name=preview-queue leaky=2 max-size-time=0 max-size-bytes=0 max-size-buffers=2"
+        " ! videorate drop-only=true name=preview-rate "
         " ! videoconvert n-threads=4 "
         " ! fpsdisplaysink video-sink={video-sink-element} sync=false name=sink "
         "text-overlay=false signal-fps-measurements=true";
 
+    // used instead of pipeline when preview_mode is OpenGL and no pipeline is configured
+    // the color conversion and scaling happen in a shader, the display sink gets GLMemory
+    // the debayering stays with the conversion element of tcambin
+    QString gl_pipeline =
+        "tcambin name=tcam0 ! video/x-raw,format=BGRx "
+        " ! tee name=capture-tee "
+        " ! queue name=preview-queue leaky=2 max-size-time=0 max-size-bytes=0 max-size-buffers=2"
+        " ! videorate drop-only=true name=preview-rate "
+        " ! glupload ! glcolorconvert "
+        " ! fpsdisplaysink video-sink=glimagesink sync=false name=sink "
+        "text-overlay=false signal-fps-measurements=true";
+
+    // true when the pipeline was loaded from the settings
+    bool custom_pipeline = false;
+
     ImageSaveType save_image_type = ImageSaveType::BMP;
     QString save_image_location = "/tmp/";
     QString save_image_filename_structure = "tcam-capture-{serial}-{caps}-{timestamp}.{extension}";
+    // consecutive images saved by "Save Image Burst"
+    int save_image_burst_count = 10;
 
     QString save_video_location = "/tmp/";
     QString save_video_filename_structure = "tcam-capture-{serial}-{caps}-{timestamp}.{extension}";
@@ -60,10 +82,12 @@ struct TcamCaptureConfig
 
         s.setValue("format_selection_type", (int)format_selection_type);
         s.setValue("conversion_element", (int)conversion_element);
+        s.setValue("preview_mode", (int)preview_mode);
 
         s.setValue("save_image_type", (int)save_image_type);
         s.setValue("save_image_location", save_image_location);
         s.setValue("save_image_filename_structure", save_image_filename_structure);
+        s.setValue("save_image_burst_count", save_image_burst_count);
 
         s.setValue("save_video_type", (int)save_video_type);
         s.setValue("save_video_location", save_video_location);
@@ -80,6 +104,7 @@ struct TcamCaptureConfig
         save_image_type = (ImageSaveType)s.value("save_image_type", (int)save_image_type).toInt();
         save_image_location = s.value("save_image_location", save_image_location).toString();
         save_image_filename_structure = s.value("save_image_filename_structure", save_image_filename_structure).toString();
+        save_image_burst_count = s.value("save_image_burst_count", save_image_burst_count).toInt();
 
         save_video_type = (VideoCodec)s.value("save_video_type", (int)save_video_type).toInt();
         save_video_location = s.value("save_video_location", save_video_location).toString();
@@ -88,11 +113,13 @@ struct TcamCaptureConfig
 
         format_selection_type = (FormatHandling)s.value("format_selection_type", (int)format_selection_type).toInt();
         conversion_element = (ConversionElement)s.value("conversion_element", (int)conversion_element).toInt();
+        preview_mode = (PreviewMode)s.value("preview_mode", (int)preview_mode).toInt();
 
         auto tmp = s.value("pipeline", "").toString();
         if (!tmp.isEmpty())
         {
             pipeline = tmp;
+            custom_pipeline = true;
 
             pipeline.replace(QString("{display-sink}"),
                              QString("fpsdisplaysink video-sink={video-sink-element} sync=false name=sink text-overlay=false signal-fps-measurements=true"));
@@ -121,4 +148,33 @@ struct TcamCaptureConfig
 
 
     }
+
+    static bool gl_preview_available()
+    {
+        for (const char* name : { "glupload", "glcolorconvert", "glimagesink" })
+        {
+            auto factory = gst_element_factory_find(name);
+            if (!factory)
+            {
+                return false;
+            }
+            gst_object_unref(factory);
+        }
+        return true;
+    }
+
+    // pipeline string that open_pipeline should launch
+    QString get_pipeline() const
+    {
+        if (preview_mode == PreviewMode::OpenGL && !custom_pipeline)
+        {
+            if (gl_preview_available())
+            {
+                return gl_pipeline;
+            }
+            SPDLOG_WARN("OpenGL preview requested but GStreamer GL elements are missing. "
+                        "Using the default pipeline.");
+        }
+        return pipeline;
+    }
 };
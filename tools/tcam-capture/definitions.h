@@ -35,8 +35,17 @@ enum class ConversionElement : int
 };
 
 
+enum class PreviewMode : int
+{
+    Software = 0,
+    OpenGL,
+};
+
+
 // supported types are identical
 // to the types QImage::save supports
+// TIFF requires the Qt image formats plugin
+// RAW writes the buffer as is and a json file describing it
 enum class ImageSaveType
 {
     BMP,
@@ -48,6 +57,8 @@ enum class ImageSaveType
     PGM,
     XBM,
     XPM,
+    TIFF,
+    RAW,
 };
 
 
@@ -172,6 +183,14 @@ inline QString image_save_type_to_string(ImageSaveType t)
         {
             return "XPM";
         }
+        case ImageSaveType::TIFF:
+        {
+            return "TIFF";
+        }
+        case ImageSaveType::RAW:
+        {
+            return "RAW";
+        }
     }
     return "";
 }
@@ -180,7 +199,7 @@ inline QString image_save_type_to_string(ImageSaveType t)
 inline std::vector<QString> get_image_save_type_names()
 {
     return {
-        "BMP", "GIF", "JPG", "JPEG", "PNG", "PBM", "PGM", "XBM", "XPM",
+        "BMP", "GIF", "JPG", "JPEG", "PNG", "PBM", "PGM", "XBM", "XPM", "TIFF", "RAW",
     };
 }
 
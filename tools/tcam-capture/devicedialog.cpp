@@ -107,6 +107,16 @@ void DeviceDialog::on_buttonBox_accepted()
 
 void DeviceDialog::new_device(const Device& new_device)
 {
+    // the device may have been added before this dialog was created
+    // with its notification still queued
+    for (int i = 0; i < this->ui->listWidget->count(); ++i)
+    {
+        if (*static_cast<DeviceWidget*>(this->ui->listWidget->item(i)) == new_device)
+        {
+            return;
+        }
+    }
+
     auto w = new DeviceWidget(new_device);
     this->ui->listWidget->blockSignals(true);
     this->ui->listWidget->addItem(w);
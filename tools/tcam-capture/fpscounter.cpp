@@ -18,6 +18,7 @@ FPSCounter::~FPSCounter()
     {
         stop();
     }
+    detach();
     delete p_timer;
 }
 
@@ -41,6 +42,8 @@ void FPSCounter::fps_callback(GstElement* /*fps_sink*/,
 void FPSCounter::start()
 {
     m_running = true;
+    m_buffer_count = 0;
+    m_last_time = std::chrono::steady_clock::now();
     p_timer->start(1000);
 }
 
@@ -52,6 +55,45 @@ void FPSCounter::stop()
 }
 
 
+void FPSCounter::attach(GstElement* element)
+{
+    detach();
+
+    p_pad = gst_element_get_static_pad(element, "sink");
+
+    if (!p_pad)
+    {
+        return;
+    }
+
+    m_probe_id =
+        gst_pad_add_probe(p_pad, GST_PAD_PROBE_TYPE_BUFFER, &FPSCounter::buffer_probe, this, nullptr);
+}
+
+
+void FPSCounter::detach()
+{
+    if (!p_pad)
+    {
+        return;
+    }
+
+    gst_pad_remove_probe(p_pad, m_probe_id);
+    gst_object_unref(p_pad);
+    p_pad = nullptr;
+    m_probe_id = 0;
+}
+
+
+GstPadProbeReturn FPSCounter::buffer_probe(GstPad* /*pad*/,
+                                           GstPadProbeInfo* /*info*/,
+                                           gpointer user_data)
+{
+    static_cast<FPSCounter*>(user_data)->m_buffer_count.fetch_add(1, std::memory_order_relaxed);
+    return GST_PAD_PROBE_OK;
+}
+
+
 void FPSCounter::tick()
 {
     update_values();
@@ -60,6 +102,23 @@ void FPSCounter::tick()
 
 void FPSCounter::update_values()
 {
+    if (p_pad)
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = now - m_last_time;
+        m_last_time = now;
+
+        double fps = 0.0;
+        uint64_t count = m_buffer_count.exchange(0);
+        if (elapsed.count() > 0.0)
+        {
+            fps = count / elapsed.count();
+        }
+
+        emit this->new_fps_measurement(fps);
+        return;
+    }
+
     m_mutex.lock();
 
     auto count = m_queue.size();
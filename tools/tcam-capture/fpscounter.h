@@ -7,6 +7,7 @@
 
 #include <QObject>
 #include <QMutex>
+#include <atomic>
 #include <chrono>
 #include <queue>
 
@@ -32,6 +33,13 @@ public:
 
     void stop();
 
+    // count buffers on the sink pad of element instead of using fps_callback
+    // the display sink only sees the frames the preview renders,
+    // the tee in front of the preview branch sees all of them
+    void attach(GstElement* element);
+
+    void detach();
+
 public slots:
 
     void tick();
@@ -44,6 +52,8 @@ private:
 
     void update_values();
 
+    static GstPadProbeReturn buffer_probe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+
     // std::chrono::high_resolution_clock::time_point m_start_time;
     //std::chrono::high_resolution_clock::time_point m_last_time;
 
@@ -58,6 +68,11 @@ private:
 
     QMutex m_mutex;
 
+    GstPad* p_pad = nullptr;
+    gulong m_probe_id = 0;
+    std::atomic<uint64_t> m_buffer_count = 0;
+    std::chrono::steady_clock::time_point m_last_time;
+
     QTimer* p_timer;
 
 };
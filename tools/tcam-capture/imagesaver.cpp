@@ -0,0 +1,260 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "imagesaver.h"
+
+#include <QFile>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstring>
+
+namespace
+{
+
+// buffers kept for the next images, more are freed once written
+constexpr size_t max_pooled_buffers = 8;
+
+QImage::Format to_qimage_format(GstVideoFormat fmt)
+{
+    switch (fmt)
+    {
+        case GST_VIDEO_FORMAT_BGRx:
+        {
+            return QImage::Format_RGB32;
+        }
+        case GST_VIDEO_FORMAT_BGRA:
+        {
+            return QImage::Format_ARGB32;
+        }
+        case GST_VIDEO_FORMAT_GRAY8:
+        {
+            return QImage::Format_Grayscale8;
+        }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+        case GST_VIDEO_FORMAT_GRAY16_LE:
+        {
+            return QImage::Format_Grayscale16;
+        }
+#endif
+        default:
+        {
+            return QImage::Format_Invalid;
+        }
+    }
+}
+
+} // namespace
+
+namespace tcam::tools::capture
+{
+
+ImageSaver::ImageSaver() : worker_(&ImageSaver::worker_main, this) {}
+
+
+ImageSaver::~ImageSaver()
+{
+    {
+        std::lock_guard lck { mtx_ };
+        stop_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+}
+
+
+QString ImageSaver::last_saved_file() const
+{
+    std::lock_guard lck { mtx_ };
+    return last_saved_file_;
+}
+
+
+bool ImageSaver::save(GstBuffer* buffer, GstCaps* caps, const QString& filename, ImageSaveType type)
+{
+    job j;
+    gst_video_info_init(&j.info);
+    // e.g. bayer caps have no video info, these can only be saved as RAW
+    j.has_info = gst_video_info_from_caps(&j.info, caps);
+    if (!j.has_info && type != ImageSaveType::RAW)
+    {
+        g_warning("Failed to parse video info");
+        return false;
+    }
+
+    GstMapInfo map;
+    if (!gst_buffer_map(buffer, &map, GST_MAP_READ))
+    {
+        return false;
+    }
+
+    j.data = acquire_buffer(map.size);
+    memcpy(j.data.data(), map.data, map.size);
+    gst_buffer_unmap(buffer, &map);
+
+    if (type == ImageSaveType::RAW)
+    {
+        gchar* caps_str = gst_caps_to_string(caps);
+        j.caps = caps_str;
+        g_free(caps_str);
+    }
+    j.pts = GST_BUFFER_PTS(buffer);
+    j.filename = filename;
+    j.type = type;
+
+    {
+        std::lock_guard lck { mtx_ };
+        queue_.push_back(std::move(j));
+    }
+    queue_depth_++;
+    cv_.notify_one();
+    return true;
+}
+
+
+std::vector<uint8_t> ImageSaver::acquire_buffer(size_t size)
+{
+    std::vector<uint8_t> ret;
+    {
+        std::lock_guard lck { mtx_ };
+        if (!pool_.empty())
+        {
+            ret = std::move(pool_.back());
+            pool_.pop_back();
+        }
+    }
+    // does not reallocate while the image size stays the same
+    ret.resize(size);
+    return ret;
+}
+
+
+void ImageSaver::release_buffer(std::vector<uint8_t>&& buffer)
+{
+    std::lock_guard lck { mtx_ };
+    if (pool_.size() < max_pooled_buffers)
+    {
+        pool_.push_back(std::move(buffer));
+    }
+}
+
+
+void ImageSaver::worker_main()
+{
+    std::unique_lock lck { mtx_ };
+    while (true)
+    {
+        cv_.wait(lck, [this] { return stop_ || !queue_.empty(); });
+        if (queue_.empty())
+        {
+            // stop_ is only honored once everything is written
+            return;
+        }
+
+        job j = std::move(queue_.front());
+        queue_.pop_front();
+        lck.unlock();
+
+        bool ok = (j.type == ImageSaveType::RAW) ? write_raw(j) : write_image(j);
+        if (ok)
+        {
+            saved_images_++;
+        }
+        else
+        {
+            qWarning("Unable to save image: %s", j.filename.toStdString().c_str());
+            failed_images_++;
+        }
+
+        release_buffer(std::move(j.data));
+
+        lck.lock();
+        if (ok)
+        {
+            last_saved_file_ = j.filename;
+        }
+        // decremented after writing, so that the depth includes the image being encoded
+        queue_depth_--;
+    }
+}
+
+
+bool ImageSaver::write_image(const job& j) const
+{
+    auto fmt = to_qimage_format(GST_VIDEO_INFO_FORMAT(&j.info));
+    if (fmt == QImage::Format_Invalid)
+    {
+        qWarning("Image format %s can only be saved as RAW", GST_VIDEO_INFO_NAME(&j.info));
+        return false;
+    }
+
+    // wraps the pooled buffer, QImage does not copy
+    QImage image(j.data.data(),
+                 GST_VIDEO_INFO_WIDTH(&j.info),
+                 GST_VIDEO_INFO_HEIGHT(&j.info),
+                 GST_VIDEO_INFO_PLANE_STRIDE(&j.info, 0),
+                 fmt);
+
+    return image.save(j.filename, image_save_type_to_string(j.type).toStdString().c_str());
+}
+
+
+bool ImageSaver::write_raw(const job& j) const
+{
+    QFile file(j.filename);
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(reinterpret_cast<const char*>(j.data.data()), j.data.size())
+               != (qint64)j.data.size())
+    {
+        return false;
+    }
+
+    QJsonObject meta;
+    meta["caps"] = j.caps;
+    meta["size"] = (qint64)j.data.size();
+    if (GST_CLOCK_TIME_IS_VALID(j.pts))
+    {
+        meta["pts"] = (qint64)j.pts;
+    }
+
+    if (j.has_info)
+    {
+        meta["format"] = GST_VIDEO_INFO_NAME(&j.info);
+        meta["width"] = GST_VIDEO_INFO_WIDTH(&j.info);
+        meta["height"] = GST_VIDEO_INFO_HEIGHT(&j.info);
+
+        QJsonArray planes;
+        for (guint i = 0; i < GST_VIDEO_INFO_N_PLANES(&j.info); ++i)
+        {
+            QJsonObject plane;
+            plane["offset"] = (qint64)GST_VIDEO_INFO_PLANE_OFFSET(&j.info, i);
+            plane["stride"] = GST_VIDEO_INFO_PLANE_STRIDE(&j.info, i);
+            planes.append(plane);
+        }
+        meta["planes"] = planes;
+    }
+
+    QFile sidecar(j.filename + ".json");
+    if (!sidecar.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+    sidecar.write(QJsonDocument(meta).toJson());
+    return true;
+}
+
+} // namespace tcam::tools::capture
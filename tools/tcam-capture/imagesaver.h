@@ -0,0 +1,103 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "definitions.h"
+
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tcam::tools::capture
+{
+
+// Encodes and writes images in a background thread.
+// The caller only copies the image into a pooled buffer, so neither the GUI
+// nor the streaming thread waits for the encoder or the disk.
+class ImageSaver
+{
+public:
+    ImageSaver();
+    // writes all images that are still queued
+    ~ImageSaver();
+
+    ImageSaver(const ImageSaver&) = delete;
+    ImageSaver& operator=(const ImageSaver&) = delete;
+
+    // Copies buffer and queues it to be written to filename.
+    // caps have to describe a raw video format.
+    // ImageSaveType::RAW writes the buffer as is and a json sidecar describing it.
+    // Returns false when the image could not be copied.
+    bool save(GstBuffer* buffer, GstCaps* caps, const QString& filename, ImageSaveType type);
+
+    // images that are copied but not yet written
+    size_t queue_depth() const
+    {
+        return queue_depth_;
+    }
+    uint64_t saved_images() const
+    {
+        return saved_images_;
+    }
+    uint64_t failed_images() const
+    {
+        return failed_images_;
+    }
+    // the file the last successfully saved image was written to
+    QString last_saved_file() const;
+
+private:
+    struct job
+    {
+        std::vector<uint8_t> data;
+        GstVideoInfo info;
+        bool has_info = false;
+        QString caps;
+        GstClockTime pts = GST_CLOCK_TIME_NONE;
+        QString filename;
+        ImageSaveType type;
+    };
+
+    void worker_main();
+    bool write_image(const job& j) const;
+    bool write_raw(const job& j) const;
+
+    std::vector<uint8_t> acquire_buffer(size_t size);
+    void release_buffer(std::vector<uint8_t>&& buffer);
+
+    std::atomic<size_t> queue_depth_ { 0 };
+    std::atomic<uint64_t> saved_images_ { 0 };
+    std::atomic<uint64_t> failed_images_ { 0 };
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<job> queue_;
+    std::vector<std::vector<uint8_t>> pool_;
+    QString last_saved_file_;
+    bool stop_ = false;
+
+    std::thread worker_;
+};
+
+} // namespace tcam::tools::capture
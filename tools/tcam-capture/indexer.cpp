@@ -145,8 +145,32 @@ Indexer::Indexer()
     gst_object_unref(bus);
 
     gst_device_monitor_add_filter(p_monitor, "Video/Source/tcam", NULL);
+
+    // starting the monitor enumerates all backends
+    // with many GigE cameras this takes seconds and must not block the UI
+    m_discovery_thread = std::thread(&Indexer::run_discovery, this);
+}
+
+Indexer::~Indexer()
+{
+    if (m_discovery_thread.joinable())
+    {
+        m_discovery_thread.join();
+    }
+
+    gst_device_monitor_stop(p_monitor);
+
+    gst_object_unref(p_monitor);
+
+    for (auto& [serial, caps] : m_caps_cache) { gst_caps_unref(caps); }
+}
+
+
+void Indexer::run_discovery()
+{
     gst_device_monitor_start(p_monitor);
 
+    // devices are added one by one and posted to the ui thread as they come in
     GList* devices = gst_device_monitor_get_devices(p_monitor);
     for (GList* entry = devices; entry != nullptr; entry = entry->next)
     {
@@ -155,13 +179,49 @@ Indexer::Indexer()
         add_device(dev);
     }
     g_list_free_full(devices, gst_object_unref);
+
+    {
+        std::lock_guard lck { m_initial_mutex };
+        m_initial_done = true;
+    }
+    m_initial_cv.notify_all();
 }
 
-Indexer::~Indexer()
+
+void Indexer::wait_for_initial_list()
 {
-    gst_device_monitor_stop(p_monitor);
+    std::unique_lock lck { m_initial_mutex };
+    m_initial_cv.wait(lck, [this] { return m_initial_done; });
+}
 
-    gst_object_unref(p_monitor);
+
+void Indexer::cache_caps(const Device& dev, GstCaps* caps)
+{
+    if (!caps)
+    {
+        return;
+    }
+
+    QMutexLocker lock(&m_mutex);
+
+    auto iter = m_caps_cache.find(dev.serial_long());
+    if (iter != m_caps_cache.end())
+    {
+        gst_caps_unref(iter->second);
+        iter->second = gst_caps_copy(caps);
+    }
+    else
+    {
+        m_caps_cache.emplace(dev.serial_long(), gst_caps_copy(caps));
+    }
+
+    for (auto& d : m_device_list)
+    {
+        if (d == dev)
+        {
+            d.set_caps(caps);
+        }
+    }
 }
 
 std::vector<Device> Indexer::get_device_list()
@@ -182,6 +242,11 @@ void Indexer::add_device(GstDevice* new_device)
                                      [&dev](const Device& vec_dev) { return vec_dev == dev; });
         if (is_new_device)
         {
+            auto cached = m_caps_cache.find(dev.serial_long());
+            if (cached != m_caps_cache.end())
+            {
+                dev.set_caps(cached->second);
+            }
             m_device_list.push_back(dev);
         }
     }
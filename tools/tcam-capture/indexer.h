@@ -21,7 +21,12 @@
 
 #include <QMutex>
 #include <QTimer>
+#include <condition_variable>
 #include <gst/gst.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 class Indexer : public QObject
@@ -34,6 +39,14 @@ public:
 
     std::vector<Device> get_device_list();
 
+    // discovery runs in a background thread
+    // blocks until the devices present at startup have been added
+    void wait_for_initial_list();
+
+    // caps are only probed when a device is opened
+    // remember them so that a rediscovered device has them right away
+    void cache_caps(const Device& dev, GstCaps* caps);
+
 signals:
 
     void new_device(const Device&);
@@ -47,10 +60,19 @@ private:
     void add_device(GstDevice* new_device);
     void remove_device(GstDevice* device);
 
+    void run_discovery();
+
     std::vector<Device> m_device_list;
+    // serial_long -> caps
+    std::map<std::string, GstCaps*> m_caps_cache;
 
     QMutex m_mutex;
 
+    std::thread m_discovery_thread;
+    std::mutex m_initial_mutex;
+    std::condition_variable m_initial_cv;
+    bool m_initial_done = false;
+
     GstDeviceMonitor* p_monitor = nullptr;
 };
 
@@ -20,8 +20,11 @@
 
 #include <QDialogButtonBox>
 #include <QErrorMessage>
+#include <QGuiApplication>
 #include <QMenu>
 #include <QMessageBox>
+#include <QScreen>
+#include <QWindow>
 // #include <QVideoWidget>
 #include "aboutdialog.h"
 #include "caps.h"
@@ -29,12 +32,15 @@
 #include "device.h"
 #include "devicedialog.h"
 #include "filename_generator.h"
+#include "imagesaver.h"
 #include "optionsdialog.h"
 #include "propertydialog.h"
 
 #include <glib-object.h>
 #include <gst/gst.h>
 #include <gst/video/videooverlay.h>
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <qimage.h>
 #include "../../libs/tcam-property//src/gst/meta/gstmetatcamstatistics.h"
@@ -117,6 +123,14 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
     connect(p_action_save_image, &QAction::triggered, this, &MainWindow::save_image_triggered);
     p_toolbar->addAction(p_action_save_image);
 
+    p_action_save_image_burst = new QAction(QIcon(":/images/snap.png"), "Save Image Burst");
+    p_action_save_image_burst->setToolTip("Save the configured number of consecutive images");
+    connect(p_action_save_image_burst,
+            &QAction::triggered,
+            this,
+            &MainWindow::save_image_burst_triggered);
+    p_toolbar->addAction(p_action_save_image_burst);
+
     p_action_save_video = new QAction(QIcon(":/images/start_capture.png"), "Record Video");
     connect(p_action_save_video, &QAction::triggered, this, &MainWindow::save_video_triggered);
     p_toolbar->addAction(p_action_save_video);
@@ -130,6 +144,23 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
 
     this->statusBar()->addPermanentWidget(p_fps_label);
 
+    p_record_label = new QLabel();
+    this->statusBar()->addPermanentWidget(p_record_label);
+
+    p_record_timer = new QTimer(this);
+    connect(p_record_timer, &QTimer::timeout, this, &MainWindow::update_recording_stats);
+
+    p_snapshot_label = new QLabel();
+    this->statusBar()->addPermanentWidget(p_snapshot_label);
+
+    image_saver_ = std::make_unique<tcam::tools::capture::ImageSaver>();
+
+    p_snapshot_timer = new QTimer(this);
+    connect(p_snapshot_timer, &QTimer::timeout, this, &MainWindow::update_snapshot_stats);
+
+    // probe now instead of delaying the first recording
+    tcam::tools::capture::probe_h264_encoder();
+
     enable_device_gui_elements(false);
 
     // open device dialog to make it more obvious what to do next
@@ -162,6 +193,8 @@ void MainWindow::on_actionQuit_triggered()
 
 bool MainWindow::open_device(const QString& serial)
 {
+    m_index->wait_for_initial_list();
+
     auto device_list = m_index->get_device_list();
 
     bool found_it = false;
@@ -268,9 +301,19 @@ gboolean MainWindow::bus_callback(GstBus* /*bus*/, GstMessage* message, gpointer
                     if (self->video_saver_ && GST_MESSAGE_SRC(forward_msg) == self->video_saver_->gst_pointer())
                     {
                         self->video_saver_->destroy_pipeline();
+
+                        auto dropped = self->video_saver_->dropped_frames();
                         self->video_saver_ = nullptr;
 
-                        self->statusBar()->showMessage("Saved video. ", 5000);
+                        self->p_record_timer->stop();
+                        self->p_record_label->setText("");
+
+                        QString msg = "Saved video. ";
+                        if (dropped > 0)
+                        {
+                            msg += QString::number(dropped) + " frames were dropped.";
+                        }
+                        self->statusBar()->showMessage(msg, 5000);
                         return TRUE;
                     }
                 }
@@ -364,7 +407,7 @@ void MainWindow::on_actionOpen_Device_triggered()
 
 void MainWindow::open_pipeline(FormatHandling handling)
 {
-    std::string pipeline_string = m_config.pipeline.toStdString();
+    std::string pipeline_string = m_config.get_pipeline().toStdString();
     GError* err = nullptr;
 
     bool set_device = false;
@@ -504,6 +547,7 @@ void MainWindow::open_pipeline(FormatHandling handling)
         {
             src_caps = gst_caps_from_string(available_caps);
             m_selected_device.set_caps(src_caps);
+            m_index->cache_caps(m_selected_device, src_caps);
         }
     }
     else
@@ -515,6 +559,7 @@ void MainWindow::open_pipeline(FormatHandling handling)
         gst_object_unref(src_pad);
 
         m_selected_device.set_caps(src_caps);
+        m_index->cache_caps(m_selected_device, src_caps);
 
         gst_object_unref(tcamsrc);
     }
@@ -598,7 +643,7 @@ void MainWindow::open_pipeline(FormatHandling handling)
                 {
                     g_object_set(disp, "widget", ui->widget, nullptr);
                 }
-                else if (has_property(disp, "video-sink"))
+                else if (has_property(disp, "video-sink") || GST_IS_VIDEO_OVERLAY(disp))
                 {
                     gst_video_overlay_set_window_handle(GST_VIDEO_OVERLAY(disp), this->ui->widget->winId());
                 }
@@ -614,8 +659,39 @@ void MainWindow::open_pipeline(FormatHandling handling)
         }
 
     }
+
+    // rendering more frames than the screen can show only costs cpu/gpu time
+    GstElement* preview_rate = gst_bin_get_by_name(GST_BIN(p_pipeline), "preview-rate");
+    if (preview_rate)
+    {
+        if (has_property(preview_rate, "max-rate"))
+        {
+            QScreen* screen = QGuiApplication::primaryScreen();
+            if (window()->windowHandle() && window()->windowHandle()->screen())
+            {
+                screen = window()->windowHandle()->screen();
+            }
+
+            if (screen && screen->refreshRate() > 0)
+            {
+                int max_rate = std::lround(screen->refreshRate());
+                qDebug("Limiting preview to display refresh rate of %d Hz", max_rate);
+                g_object_set(preview_rate, "max-rate", max_rate, nullptr);
+            }
+        }
+        gst_object_unref(preview_rate);
+    }
+
     gst_element_set_state(p_pipeline, GST_STATE_PLAYING);
 
+    // the preview is throttled, count the frames that enter the tee
+    GstElement* tee = gst_bin_get_by_name(GST_BIN(p_pipeline), "capture-tee");
+    if (tee)
+    {
+        m_fps_counter.attach(tee);
+        gst_object_unref(tee);
+    }
+
     connect(&m_fps_counter, &FPSCounter::new_fps_measurement, this, &MainWindow::fps_tick);
     m_fps_counter.start();
 
@@ -670,6 +746,7 @@ void MainWindow::open_pipeline(FormatHandling handling)
 void MainWindow::close_pipeline()
 {
     m_fps_counter.stop();
+    m_fps_counter.detach();
 
     enable_device_gui_elements(false);
 
@@ -775,7 +852,7 @@ void MainWindow::open_about_triggered()
         return;
     }
 
-    p_about = new AboutDialog(m_config.pipeline, this);
+    p_about = new AboutDialog(m_config.get_pipeline(), this);
 
     p_about->setWindowIcon(QIcon(":/images/logo.png"));
 
@@ -818,6 +895,7 @@ void MainWindow::enable_device_gui_elements(bool toggle)
     p_action_format_dialog->setEnabled(toggle);
 
     p_action_save_image->setEnabled(toggle);
+    p_action_save_image_burst->setEnabled(toggle);
     p_action_save_video->setEnabled(toggle);
 
     if (p_about)
@@ -844,6 +922,20 @@ void MainWindow::reset_fps_tick()
 }
 
 
+void MainWindow::update_recording_stats()
+{
+    if (!video_saver_)
+    {
+        return;
+    }
+
+    p_record_label->setText(QString("REC %1 | encoded: %2 | dropped: %3")
+                                .arg(video_saver_->encoder_name())
+                                .arg(video_saver_->encoded_frames())
+                                .arg(video_saver_->dropped_frames()));
+}
+
+
 void MainWindow::fps_tick(double new_fps)
 {
     if (!p_displaysink)
@@ -1066,6 +1158,29 @@ void MainWindow::open_format_triggered()
 }
 
 
+QString MainWindow::generate_image_filename(const QString& extension) const
+{
+    QString caps_str;
+    if (p_selected_caps)
+    {
+        caps_str = tcam::tools::capture::caps_to_file_str(*p_selected_caps);
+    }
+    else
+    {
+        qInfo("No caps to interpret");
+        caps_str = "";
+    }
+
+    auto fng = tcam::tools::capture::FileNameGenerator(
+        m_selected_device.serial_long().c_str(), caps_str);
+
+    fng.set_base_pattern(m_config.save_image_filename_structure);
+    fng.set_file_extension(extension);
+
+    return m_config.save_image_location + "/" + fng.generate();
+}
+
+
 void MainWindow::save_image_triggered()
 {
 
@@ -1084,74 +1199,161 @@ void MainWindow::save_image_triggered()
 
     if (sample)
     {
+        auto image_type = m_config.save_image_type;
+        const QString extension = image_save_type_to_string(image_type).toLower();
+        const QString name = generate_image_filename(extension);
 
-        GstBuffer* buffer = gst_sample_get_buffer(sample);
-        GstMapInfo info; // contains the actual image
-        if (gst_buffer_map(buffer, &info, GST_MAP_READ))
+        // only the copy happens here, encoding and writing are done by the image saver
+        if (image_saver_->save(
+                gst_sample_get_buffer(sample), gst_sample_get_caps(sample), name, image_type))
         {
-            GstVideoInfo* video_info = gst_video_info_new();
-            if (!gst_video_info_from_caps(video_info, gst_sample_get_caps(sample)))
-            {
-                // Could not parse video info (should not happen)
-                g_warning("Failed to parse video info");
-            }
+            update_snapshot_stats();
+            p_snapshot_timer->start(200);
+        }
+        else
+        {
+            statusBar()->showMessage("ERROR! No image saved.", 5000);
+        }
 
-            QImage image = QImage(info.data, video_info->width, video_info->height, QImage::Format::Format_ARGB32);
+        gst_sample_unref(sample);
+    }
 
-            // BMP - Windows Bitmap Read / write
-            // GIF - Graphic Interchange Format(optional) Read
-            // JPG - Joint Photographic Experts Group Read / write
-            // JPEG - Joint Photographic Experts Group Read / write
-            // PNG - Portable Network Graphics Read / write
-            // PBM - Portable Bitmap Read
-            // PGM - Portable Graymap Read PPM Portable Pixmap Read / write
-            // XBM - X11 Bitmap Read / write
-            // XPM
+    if (has_property(p_displaysink, "video-sink"))
+    {
+        g_object_unref(sink);
+    }
+}
 
-            const QString path = m_config.save_image_location;
-            auto image_type = m_config.save_image_type;
-            const QString extension = image_save_type_to_string(image_type).toLower();
 
+namespace
+{
 
-            QString caps_str;
-            if (p_selected_caps)
-            {
-                caps_str = tcam::tools::capture::caps_to_file_str(*p_selected_caps);
-            }
-            else
-            {
-                qInfo("No caps to interpret");
-                caps_str = "";
-            }
+struct BurstCapture
+{
+    tcam::tools::capture::ImageSaver* saver = nullptr;
+    std::atomic<bool>* running = nullptr;
 
-            auto fng = tcam::tools::capture::FileNameGenerator(
-                m_selected_device.serial_long().c_str(), caps_str);
+    // path of the first image without extension, an index is appended for every image
+    QString base_name;
+    QString extension;
+    ImageSaveType type;
 
-            fng.set_base_pattern(m_config.save_image_filename_structure);
-            fng.set_file_extension(extension);
+    int count = 0;
+    int captured = 0;
+};
 
-            auto name = fng.generate();
 
-            if (image.save(path + "/" + name, extension.toStdString().c_str()))
-            {
-                // show message for 5 seconds
-                statusBar()->showMessage("Saved image: " + path + "/" + name, 5000);
-            }
-            else
-            {
-                statusBar()->showMessage("ERROR! No image saved.", 5000);
-            }
+// Runs in the streaming thread for every buffer entering the capture-tee.
+// Unlike the last-sample of the display sink this does not miss any image.
+GstPadProbeReturn burst_probe_callback(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    auto burst = static_cast<BurstCapture*>(user_data);
 
-            gst_buffer_unmap(buffer, &info);
-            gst_video_info_free(video_info);
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    GstCaps* caps = gst_pad_get_current_caps(pad);
+    if (!buffer || !caps)
+    {
+        if (caps)
+        {
+            gst_caps_unref(caps);
         }
+        return GST_PAD_PROBE_OK;
+    }
 
-        gst_sample_unref(sample);
+    QString name = QString("%1_%2.%3")
+                       .arg(burst->base_name)
+                       .arg(burst->captured, 4, 10, QChar('0'))
+                       .arg(burst->extension);
+    if (!burst->saver->save(buffer, caps, name, burst->type))
+    {
+        qWarning("Unable to copy burst image %d", burst->captured);
     }
+    gst_caps_unref(caps);
 
-    if (has_property(p_displaysink, "video-sink"))
+    burst->captured++;
+    if (burst->captured >= burst->count)
     {
-        g_object_unref(sink);
+        return GST_PAD_PROBE_REMOVE;
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+} // namespace
+
+
+void MainWindow::save_image_burst_triggered()
+{
+    if (!p_pipeline || m_burst_running)
+    {
+        return;
+    }
+
+    GstElement* tee = gst_bin_get_by_name(GST_BIN(p_pipeline), "capture-tee");
+    if (!tee)
+    {
+        statusBar()->showMessage("ERROR! No element capture-tee in pipeline. No burst saved.",
+                                 5000);
+        return;
+    }
+    GstPad* pad = gst_element_get_static_pad(tee, "sink");
+    gst_object_unref(tee);
+
+    auto burst = new BurstCapture();
+    burst->saver = image_saver_.get();
+    burst->running = &m_burst_running;
+    burst->type = m_config.save_image_type;
+    burst->extension = image_save_type_to_string(burst->type).toLower();
+    burst->count = std::max(m_config.save_image_burst_count, 1);
+
+    burst->base_name = generate_image_filename(burst->extension);
+    if (burst->base_name.endsWith("." + burst->extension))
+    {
+        burst->base_name.chop(burst->extension.size() + 1);
+    }
+
+    m_burst_running = true;
+    gst_pad_add_probe(pad,
+                      GST_PAD_PROBE_TYPE_BUFFER,
+                      burst_probe_callback,
+                      burst,
+                      [](gpointer data)
+                      {
+                          // called once the probe is removed, also when the pipeline is closed
+                          auto b = static_cast<BurstCapture*>(data);
+                          *b->running = false;
+                          delete b;
+                      });
+    gst_object_unref(pad);
+
+    update_snapshot_stats();
+    p_snapshot_timer->start(200);
+}
+
+
+void MainWindow::update_snapshot_stats()
+{
+    auto depth = image_saver_->queue_depth();
+
+    if (depth > 0 || m_burst_running)
+    {
+        p_snapshot_label->setText(QString("Saving images: %1 queued").arg(depth));
+        return;
+    }
+
+    p_snapshot_timer->stop();
+    p_snapshot_label->setText("");
+
+    auto failed = image_saver_->failed_images();
+    if (failed > m_reported_failed_images)
+    {
+        statusBar()->showMessage(
+            QString("ERROR! %1 images not saved.").arg(failed - m_reported_failed_images), 5000);
+        m_reported_failed_images = failed;
+    }
+    else
+    {
+        // show message for 5 seconds
+        statusBar()->showMessage("Saved image: " + image_saver_->last_saved_file(), 5000);
     }
 }
 
@@ -1179,6 +1381,9 @@ void MainWindow::save_video_triggered()
         p_action_save_video->setIcon(QIcon(":/images/stop.png"));
 
         statusBar()->showMessage("Saving video: " + name);
+
+        update_recording_stats();
+        p_record_timer->start(1000);
     }
     else
     {
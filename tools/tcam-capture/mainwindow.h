@@ -21,6 +21,7 @@
 #include "config.h"
 #include "definitions.h"
 #include "fpscounter.h"
+#include "imagesaver.h"
 #include "indexer.h"
 #include "tcamcollection.h"
 #include "videosaver.h"
@@ -30,6 +31,7 @@
 #include <QSettings>
 #include <QTimer>
 #include <QToolBar>
+#include <atomic>
 #include <gst/gst.h>
 #include <memory>
 
@@ -66,6 +68,7 @@ public slots:
     void device_lost_cb(const Device& dev);
 
     void save_image_triggered();
+    void save_image_burst_triggered();
     void save_video_triggered();
 
 private slots:
@@ -95,6 +98,9 @@ private slots:
 
     void fps_tick(double);
 
+    void update_recording_stats();
+    void update_snapshot_stats();
+
 
 private:
     static void init_device_dialog(MainWindow* instance)
@@ -111,6 +117,7 @@ private:
     QToolBar* p_toolbar = nullptr;
     QAction* p_action_save_video = nullptr;
     QAction* p_action_save_image = nullptr;
+    QAction* p_action_save_image_burst = nullptr;
 
     QAction* p_action_property_dialog = nullptr;
     QAction* p_action_format_dialog = nullptr;
@@ -127,11 +134,20 @@ private:
 
     QLabel* p_fps_label = nullptr;
     QLabel* p_trigger_info_label = nullptr;
+    QLabel* p_record_label = nullptr;
+    QLabel* p_snapshot_label = nullptr;
 
     FPSCounter m_fps_counter;
 
     std::unique_ptr<tcam::tools::capture::VideoSaver> video_saver_ = nullptr;
 
+    // encodes and writes snapshots, so that the live view does not wait for the disk
+    std::unique_ptr<tcam::tools::capture::ImageSaver> image_saver_ = nullptr;
+    // set while a burst probe is attached to the capture-tee
+    std::atomic<bool> m_burst_running = false;
+    // failures already shown in the status bar
+    uint64_t m_reported_failed_images = 0;
+
     static gboolean bus_callback(GstBus* /*bus*/, GstMessage* message, gpointer user_data);
     static GstPadProbeReturn pad_probe_callback(GstPad* pad,
                                                 GstPadProbeInfo* info,
@@ -140,6 +156,9 @@ private:
     void reset_fps_tick();
     GstCaps* open_format_dialog();
 
+    // full path of the next image
+    QString generate_image_filename(const QString& extension) const;
+
     void open_pipeline(FormatHandling);
     void close_pipeline();
 
@@ -147,6 +166,8 @@ private:
     void save_settings();
 
     QTimer* p_fps_timer = nullptr;
+    QTimer* p_record_timer = nullptr;
+    QTimer* p_snapshot_timer = nullptr;
 
     GstCaps* p_selected_caps = nullptr;
     QString m_device_caps;
@@ -93,6 +93,24 @@ void OptionsDialog::setup_general()
     }
 
     ui->combo_convert_options->setCurrentIndex(active_index);
+
+    // same order as PreviewMode
+    ui->combo_preview_options->addItem("software");
+    ui->combo_preview_options->addItem("OpenGL");
+
+    int active_preview = (int)app_config.preview_mode;
+    if (!TcamCaptureConfig::gl_preview_available())
+    {
+        enable_menu_entry(ui->combo_preview_options, (int)PreviewMode::OpenGL, false);
+        active_preview = (int)PreviewMode::Software;
+    }
+    ui->combo_preview_options->setCurrentIndex(active_preview);
+
+    if (app_config.custom_pipeline)
+    {
+        ui->combo_preview_options->setToolTip("A pipeline is configured. It is used as is.");
+        ui->combo_preview_options->setEnabled(false);
+    }
 }
 
 void OptionsDialog::setup_image()
@@ -125,6 +143,8 @@ void OptionsDialog::setup_image()
 
     ui->saveImageInfoLabel->setText(tcam::tools::capture::FileNameGenerator::get_help_text());
 
+    ui->saveImageBurstSpinBox->setValue(app_config.save_image_burst_count);
+
     connect(ui->saveImageAsComboBox,
             SIGNAL(currentIndexChanged(const QString&)),
             this,
@@ -295,11 +315,13 @@ void OptionsDialog::update_video_filename_extension_preview(const QString& new_e
 TcamCaptureConfig OptionsDialog::get_config()
 {
     app_config.conversion_element = (ConversionElement)ui->combo_convert_options->currentIndex();
+    app_config.preview_mode = (PreviewMode)ui->combo_preview_options->currentIndex();
 
     // save image settings
     app_config.save_image_type = (ImageSaveType)ui->saveImageAsComboBox->currentIndex();
     app_config.save_video_location = ui->saveImageLocationEditLine->text();
     app_config.save_image_filename_structure = ui->saveImageFilenameEditLine->text();
+    app_config.save_image_burst_count = ui->saveImageBurstSpinBox->value();
 
     // save video settings
 
@@ -24,19 +24,53 @@
 
 #include <QAction>
 #include <QKeyEvent>
+#include <map>
+#include <mutex>
 
-PropertyTree::PropertyTree(const std::vector<Property*>& properties, QWidget* parent)
-    : QWidget(parent), m_properties(properties)
+// The 'tcam-property-changed' signal is emitted from device threads.
+// The relay outlives the dialog until the last signal handler is gone.
+struct PropertyDialog::change_relay
+{
+    std::mutex mtx;
+    PropertyDialog* dialog = nullptr;
+};
+
+namespace
+{
+void on_tcam_property_changed(GstElement* /*element*/, const char* name, gpointer user_data)
+{
+    auto& relay = **static_cast<std::shared_ptr<PropertyDialog::change_relay>*>(user_data);
+
+    std::lock_guard lck { relay.mtx };
+    if (relay.dialog)
+    {
+        QMetaObject::invokeMethod(relay.dialog,
+                                  "property_changed",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(QString, QString(name ? name : "")));
+    }
+}
+
+void free_change_relay(gpointer data, GClosure* /*closure*/)
+{
+    delete static_cast<std::shared_ptr<PropertyDialog::change_relay>*>(data);
+}
+} // namespace
+
+PropertyTree::PropertyTree(const std::vector<TcamPropertyBase*>& properties, QWidget* parent)
+    : QWidget(parent), m_tcam_properties(properties)
 {
     setWindowFlags(windowFlags() | Qt::WindowStaysOnTopHint);
 
-    setup_ui();
+    setLayout(new QFormLayout());
 }
 
-void PropertyTree::setup_ui()
+void PropertyTree::populate(const std::vector<Property*>& properties)
 {
-    QFormLayout* l = new QFormLayout();
-    setLayout(l);
+    m_properties = properties;
+    m_populated = true;
+
+    auto l = static_cast<QFormLayout*>(layout());
 
     for (auto* ptr : m_properties)
     {
@@ -69,21 +103,33 @@ PropertyDialog::PropertyDialog(TcamCollection& collection, QWidget* parent)
 
     p_worker->moveToThread(p_work_thread);
 
+    qRegisterMetaType<PropertyStateBatch>("PropertyStateBatch");
+
     initialize_dialog(collection);
 
-    p_worker->add_properties(m_properties);
-    update();
+    p_change_timer = new QTimer(this);
+    p_change_timer->setSingleShot(true);
+    p_change_timer->setInterval(100);
+    connect(p_change_timer, &QTimer::timeout, this, &PropertyDialog::flush_property_changes);
+
+    connect_change_notifications(collection);
+
+    // only the first tab is created now, the others when they are first shown
+    update_tab(ui->tabWidget->currentIndex());
 }
 
 PropertyDialog::~PropertyDialog()
 {
-    delete ui;
+    disconnect_change_notifications();
 
+    // the worker reads the widgets, stop it before they are deleted
     if (p_work_thread->isRunning())
     {
         p_work_thread->quit();
     }
     p_work_thread->wait();
+
+    delete ui;
 }
 
 
@@ -95,11 +141,59 @@ void PropertyDialog::notify_device_lost(const QString& info)
 
 void PropertyDialog::update_tab(int index)
 {
+    if (index < 0)
+    {
+        return;
+    }
+
+    populate_tab(index);
+
+    // the values are read by the worker and shown once they arrive in apply_states
     auto name = ui->tabWidget->tabText(index);
     emit this->update_category(name);
 }
 
 
+void PropertyDialog::populate_tab(int index)
+{
+    auto tree = qobject_cast<PropertyTree*>(ui->tabWidget->widget(index));
+    if (!tree || tree->is_populated())
+    {
+        return;
+    }
+
+    std::vector<Property*> props;
+    props.reserve(tree->get_tcam_properties().size());
+
+    for (auto* prop : tree->get_tcam_properties())
+    {
+        if (auto ptr = create_property_widget(prop); ptr)
+        {
+            props.push_back(ptr);
+        }
+    }
+
+    tree->populate(props);
+
+    m_properties.insert(m_properties.end(), props.begin(), props.end());
+    p_worker->add_properties(props);
+}
+
+
+void PropertyDialog::apply_states(PropertyStateBatch states)
+{
+    for (auto& [prop, state] : states)
+    {
+        if (state.valid)
+        {
+            // widgets are disabled until their first state arrived
+            dynamic_cast<QWidget*>(prop)->setEnabled(true);
+        }
+        prop->apply_state(state);
+    }
+}
+
+
 void PropertyDialog::refresh()
 {
     int index = ui->tabWidget->currentIndex();
@@ -107,6 +201,71 @@ void PropertyDialog::refresh()
 }
 
 
+void PropertyDialog::property_changed(const QString& name)
+{
+    m_pending_changes.insert(name);
+    if (!p_change_timer->isActive())
+    {
+        p_change_timer->start();
+    }
+}
+
+
+void PropertyDialog::flush_property_changes()
+{
+    auto changes = std::move(m_pending_changes);
+    m_pending_changes.clear();
+
+    if (changes.contains(QString()))
+    {
+        refresh();
+        return;
+    }
+
+    for (const auto& name : changes) { emit update_property(name); }
+}
+
+
+void PropertyDialog::connect_change_notifications(TcamCollection& collection)
+{
+    p_change_relay = std::make_shared<change_relay>();
+    p_change_relay->dialog = this;
+
+    for (auto* elem : collection.get_elements())
+    {
+        gst_object_ref(elem);
+
+        auto id = g_signal_connect_data(elem,
+                                        "tcam-property-changed",
+                                        G_CALLBACK(on_tcam_property_changed),
+                                        new std::shared_ptr<change_relay>(p_change_relay),
+                                        free_change_relay,
+                                        (GConnectFlags)0);
+        m_change_handlers.push_back({ elem, id });
+    }
+}
+
+
+void PropertyDialog::disconnect_change_notifications()
+{
+    if (p_change_relay)
+    {
+        std::lock_guard lck { p_change_relay->mtx };
+        p_change_relay->dialog = nullptr;
+    }
+
+    for (auto& [elem, id] : m_change_handlers)
+    {
+        if (id)
+        {
+            g_signal_handler_disconnect(elem, id);
+        }
+        gst_object_unref(elem);
+    }
+    m_change_handlers.clear();
+}
+
+
 void PropertyDialog::keyPressEvent(QKeyEvent* event)
 {
     // this is to ensure the property dialog behaves
@@ -127,7 +286,9 @@ void PropertyDialog::initialize_dialog(TcamCollection& collection)
 
     std::vector<std::string> known_categories;
 
-    std::vector<Property*>& prop_list = m_properties;
+    // the widgets are only created once their tab is shown,
+    // reading ranges and values of hundreds of GigE features takes seconds
+    std::map<std::string, std::vector<TcamPropertyBase*>> category_props;
 
     for (const std::string& name : names)
     {
@@ -158,60 +319,7 @@ void PropertyDialog::initialize_dialog(TcamCollection& collection)
         if (!is_known_category)
             known_categories.push_back(category);
 
-        switch (tcam_property_base_get_property_type(prop))
-        {
-            case TCAM_PROPERTY_TYPE_FLOAT:
-            {
-                auto ptr = new DoubleWidget(TCAM_PROPERTY_FLOAT(prop));
-                connect(ptr, &DoubleWidget::value_changed, p_worker, &PropertyWorker::write_property, Qt::QueuedConnection);
-                connect(ptr, &DoubleWidget::update_category, p_worker, &PropertyWorker::update_category, Qt::QueuedConnection);
-                connect(ptr, &DoubleWidget::device_lost, this, &PropertyDialog::notify_device_lost);
-                prop_list.push_back(ptr);
-                break;
-            }
-            case TCAM_PROPERTY_TYPE_INTEGER:
-            {
-                auto ptr = new IntWidget(TCAM_PROPERTY_INTEGER(prop));
-                connect(ptr, &IntWidget::value_changed, p_worker, &PropertyWorker::write_property, Qt::QueuedConnection);
-                connect(ptr, &IntWidget::update_category, p_worker, &PropertyWorker::update_category, Qt::QueuedConnection);
-                connect(ptr, &IntWidget::device_lost, this, &PropertyDialog::notify_device_lost);
-                prop_list.push_back(ptr);
-                break;
-            }
-            case TCAM_PROPERTY_TYPE_ENUMERATION:
-            {
-                auto ptr = new EnumWidget(TCAM_PROPERTY_ENUMERATION(prop));
-                connect(ptr, &EnumWidget::value_changed, p_worker, &PropertyWorker::write_property);
-                connect(ptr, &EnumWidget::update_category, p_worker, &PropertyWorker::update_category);
-                connect(ptr, &EnumWidget::device_lost, this, &PropertyDialog::notify_device_lost);
-                prop_list.push_back(ptr);
-                break;
-            }
-            case TCAM_PROPERTY_TYPE_BOOLEAN:
-            {
-                auto ptr = new BoolWidget(TCAM_PROPERTY_BOOLEAN(prop));
-                connect(ptr, &BoolWidget::value_changed, p_worker, &PropertyWorker::write_property);
-                connect(ptr, &BoolWidget::device_lost, this, &PropertyDialog::notify_device_lost);
-                prop_list.push_back(ptr);
-                break;
-            }
-            case TCAM_PROPERTY_TYPE_COMMAND:
-            {
-                auto ptr = new ButtonWidget(TCAM_PROPERTY_COMMAND(prop));
-                connect(
-                    ptr, &ButtonWidget::value_changed, p_worker, &PropertyWorker::write_property);
-                connect(ptr, &ButtonWidget::device_lost, this, &PropertyDialog::notify_device_lost);
-                prop_list.push_back(ptr);
-                break;
-            }
-            case TCAM_PROPERTY_TYPE_STRING:
-            {
-                auto ptr = new StringWidget(TCAM_PROPERTY_STRING(prop));
-                connect(ptr, &StringWidget::device_lost, this, &PropertyDialog::notify_device_lost);
-                prop_list.push_back(ptr);
-                break;
-            }
-        }
+        category_props[category].push_back(prop);
     }
 
     static const std::string best_order[] =
@@ -235,21 +343,13 @@ void PropertyDialog::initialize_dialog(TcamCollection& collection)
 
     for (const auto& o : best_order)
     {
-        std::vector<Property*> props;
-
-        for (auto& p : prop_list)
-        {
-            if (p->get_category() == o)
-            {
-                props.push_back(p);
-            }
-        }
-        if (props.empty())
+        auto props = category_props.find(o);
+        if (props == category_props.end())
         {
             continue;
         }
 
-        PropertyTree* tab_tree = new PropertyTree(props);
+        PropertyTree* tab_tree = new PropertyTree(props->second);
 
         ui->tabWidget->addTab(tab_tree, o.c_str());
         added_tabs.push_back(o);
@@ -268,22 +368,13 @@ void PropertyDialog::initialize_dialog(TcamCollection& collection)
             continue;
         }
 
-        std::vector<Property*> props;
-
-        for (auto& p : prop_list)
-        {
-            if (p->get_category() == cat)
-            {
-                props.push_back(p);
-            }
-        }
-
-        if (props.empty())
+        auto props = category_props.find(cat);
+        if (props == category_props.end())
         {
             continue;
         }
 
-        PropertyTree* tab_tree = new PropertyTree(props);
+        PropertyTree* tab_tree = new PropertyTree(props->second);
 
         ui->tabWidget->addTab(tab_tree, cat.c_str());
     }
@@ -292,6 +383,9 @@ void PropertyDialog::initialize_dialog(TcamCollection& collection)
     connect(ui->tabWidget, &QTabWidget::currentChanged, this, &PropertyDialog::update_tab);
     // updates shall be done in another context
     connect(this, &PropertyDialog::update_category, p_worker, &PropertyWorker::update_category);
+    connect(this, &PropertyDialog::update_property, p_worker, &PropertyWorker::update_property);
+    // read states are shown in this context
+    connect(p_worker, &PropertyWorker::states_read, this, &PropertyDialog::apply_states);
 
     // connect buttons
     connect(ui->button_update, &QPushButton::clicked, this, &PropertyDialog::refresh);
@@ -299,3 +393,71 @@ void PropertyDialog::initialize_dialog(TcamCollection& collection)
 
 
 }
+
+
+Property* PropertyDialog::create_property_widget(TcamPropertyBase* prop)
+{
+    Property* widget = nullptr;
+
+    switch (tcam_property_base_get_property_type(prop))
+    {
+        case TCAM_PROPERTY_TYPE_FLOAT:
+        {
+            auto ptr = new DoubleWidget(TCAM_PROPERTY_FLOAT(prop));
+            connect(ptr, &DoubleWidget::value_changed, p_worker, &PropertyWorker::write_property, Qt::QueuedConnection);
+            connect(ptr, &DoubleWidget::update_category, p_worker, &PropertyWorker::update_category, Qt::QueuedConnection);
+            connect(ptr, &DoubleWidget::device_lost, this, &PropertyDialog::notify_device_lost);
+            widget = ptr;
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_INTEGER:
+        {
+            auto ptr = new IntWidget(TCAM_PROPERTY_INTEGER(prop));
+            connect(ptr, &IntWidget::value_changed, p_worker, &PropertyWorker::write_property, Qt::QueuedConnection);
+            connect(ptr, &IntWidget::update_category, p_worker, &PropertyWorker::update_category, Qt::QueuedConnection);
+            connect(ptr, &IntWidget::device_lost, this, &PropertyDialog::notify_device_lost);
+            widget = ptr;
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_ENUMERATION:
+        {
+            auto ptr = new EnumWidget(TCAM_PROPERTY_ENUMERATION(prop));
+            connect(ptr, &EnumWidget::value_changed, p_worker, &PropertyWorker::write_property);
+            connect(ptr, &EnumWidget::update_category, p_worker, &PropertyWorker::update_category);
+            connect(ptr, &EnumWidget::device_lost, this, &PropertyDialog::notify_device_lost);
+            widget = ptr;
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_BOOLEAN:
+        {
+            auto ptr = new BoolWidget(TCAM_PROPERTY_BOOLEAN(prop));
+            connect(ptr, &BoolWidget::value_changed, p_worker, &PropertyWorker::write_property);
+            connect(ptr, &BoolWidget::device_lost, this, &PropertyDialog::notify_device_lost);
+            widget = ptr;
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_COMMAND:
+        {
+            auto ptr = new ButtonWidget(TCAM_PROPERTY_COMMAND(prop));
+            connect(
+                ptr, &ButtonWidget::value_changed, p_worker, &PropertyWorker::write_property);
+            connect(ptr, &ButtonWidget::device_lost, this, &PropertyDialog::notify_device_lost);
+            widget = ptr;
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_STRING:
+        {
+            auto ptr = new StringWidget(TCAM_PROPERTY_STRING(prop));
+            connect(ptr, &StringWidget::device_lost, this, &PropertyDialog::notify_device_lost);
+            widget = ptr;
+            break;
+        }
+    }
+
+    if (widget)
+    {
+        // enabled once the first state arrived
+        dynamic_cast<QWidget*>(widget)->setEnabled(false);
+    }
+    return widget;
+}
@@ -22,10 +22,14 @@
 
 #include <QDialog>
 #include <QLayout>
+#include <QSet>
 #include <QThread>
+#include <QTimer>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
-class Property;
 namespace Ui
 {
 class PropertyDialog;
@@ -36,12 +40,23 @@ class PropertyTree : public QWidget
     Q_OBJECT
 
 public:
-    PropertyTree(const std::vector<Property*>& properties, QWidget* parent = nullptr);
+    PropertyTree(const std::vector<TcamPropertyBase*>& properties, QWidget* parent = nullptr);
+
+    // the widgets are created when the tab is first shown
+    bool is_populated() const
+    {
+        return m_populated;
+    }
+    const std::vector<TcamPropertyBase*>& get_tcam_properties() const
+    {
+        return m_tcam_properties;
+    }
+    void populate(const std::vector<Property*>& properties);
 
 private:
-    void setup_ui();
-
+    std::vector<TcamPropertyBase*> m_tcam_properties;
     std::vector<Property*> m_properties;
+    bool m_populated = false;
 
     QVBoxLayout* p_layout = nullptr;
 };
@@ -54,6 +69,8 @@ public:
     explicit PropertyDialog(TcamCollection& collection, QWidget* parent = nullptr);
     ~PropertyDialog();
 
+    struct change_relay;
+
 public slots:
 
     void notify_device_lost(const QString& info);
@@ -62,19 +79,41 @@ public slots:
 
     void keyPressEvent(QKeyEvent* event);
 
+private slots:
+
+    // called for every 'tcam-property-changed' signal, an empty name refreshes the current tab
+    void property_changed(const QString& name);
+    void flush_property_changes();
+
+    // shows the states the worker read
+    void apply_states(PropertyStateBatch states);
+
 signals:
 
     void device_lost(const QString& info);
     void update_category(QString name);
+    void update_property(QString name);
 
 private:
     void initialize_dialog(TcamCollection& collection);
+    Property* create_property_widget(TcamPropertyBase* prop);
+    void populate_tab(int index);
+    void connect_change_notifications(TcamCollection& collection);
+    void disconnect_change_notifications();
+
+    std::shared_ptr<change_relay> p_change_relay;
+    std::vector<std::pair<GstElement*, gulong>> m_change_handlers;
+
+    // changes are collected for a short time, auto algorithms notify on every frame
+    QSet<QString> m_pending_changes;
+    QTimer* p_change_timer = nullptr;
 
     Ui::PropertyDialog* ui = nullptr;
 
     QThread* p_work_thread = nullptr;
     PropertyWorker* p_worker = nullptr;
 
+    // widgets of all tabs that were shown so far
     std::vector<Property*> m_properties;
 };
 
@@ -17,6 +17,7 @@
 #include "propertywidget.h"
 
 #include <QTimer>
+#include <atomic>
 #include <cassert>
 #include <gst/gst.h>
 
@@ -95,69 +96,67 @@ EnumWidget::EnumWidget(TcamPropertyEnumeration* prop, QWidget* parent)
     setup_ui();
 }
 
-void EnumWidget::update()
+PropertyState EnumWidget::read_state()
 {
+    PropertyState state;
     GError* err = nullptr;
 
-    bool available = tcam_property_base_is_available(TCAM_PROPERTY_BASE(p_prop), &err);
-    HANDLE_ERROR(err, return );
+    state.available = tcam_property_base_is_available(TCAM_PROPERTY_BASE(p_prop), &err);
+    HANDLE_ERROR(err, return state);
 
-    if (!available)
+    if (state.available)
     {
-        p_combobox->blockSignals(true);
-        p_combobox->setEnabled(false);
-        p_combobox->setCurrentIndex(-1); // this shows the placeholder text
-        p_combobox->blockSignals(false);
-    }
-    else if (is_readonly_)
-    {
-        QString value = tcam_property_enumeration_get_value(p_prop, &err);
-        HANDLE_ERROR(err, return );
-
-        p_combobox->blockSignals(true);
-        p_combobox->setEnabled(false);
+        state.string_value = tcam_property_enumeration_get_value(p_prop, &err);
+        HANDLE_ERROR(err, return state);
 
-        for (int index = 0; index < p_combobox->count(); index++)
+        if (!is_readonly_)
         {
-            if (p_combobox->itemText(index) == value)
-            {
-                p_combobox->setCurrentIndex(index);
-                break;
-            }
+            state.locked = tcam_property_base_is_locked(TCAM_PROPERTY_BASE(p_prop), &err);
+            HANDLE_ERROR(err, return state);
         }
-
-        p_combobox->blockSignals(false);
     }
-    else
+
+    state.valid = true;
+    return state;
+}
+
+void EnumWidget::apply_state(const PropertyState& state)
+{
+    if (!state.valid)
     {
-        QString value = tcam_property_enumeration_get_value(p_prop, &err);
-        HANDLE_ERROR(err, return );
+        return;
+    }
 
-        bool lock = tcam_property_base_is_locked(TCAM_PROPERTY_BASE(p_prop), &err);
-        HANDLE_ERROR(err, return );
+    p_combobox->blockSignals(true);
 
-        p_combobox->blockSignals(true);
-        p_combobox->setEnabled(!lock);
+    if (!state.available)
+    {
+        p_combobox->setEnabled(false);
+        p_combobox->setCurrentIndex(-1); // this shows the placeholder text
+    }
+    else
+    {
+        p_combobox->setEnabled(!is_readonly_ && !state.locked);
 
         // setCurrentText caused problems on some developer systems
         // by selecting the entry via index this is circumvented
         for (int index = 0; index < p_combobox->count(); index++)
         {
-            if (p_combobox->itemText(index) == value)
+            if (p_combobox->itemText(index) == state.string_value)
             {
                 p_combobox->setCurrentIndex(index);
                 break;
             }
         }
 
-        if (value == "Once")
+        if (!is_readonly_ && state.string_value == "Once")
         {
             QTimer::singleShot(500,
                                [this]() { emit this->update_category(get_category().c_str()); });
         }
-
-        p_combobox->blockSignals(false);
     }
+
+    p_combobox->blockSignals(false);
 }
 
 void EnumWidget::drop_down_changed(const QString& entry)
@@ -206,8 +205,6 @@ void EnumWidget::setup_ui()
 
     g_slist_free_full(entries, g_free);
 
-    update();
-
     connect(p_combobox, &QComboBox::currentTextChanged, this, &EnumWidget::drop_down_changed);
 
     p_layout->addWidget(p_combobox);
@@ -220,14 +217,47 @@ IntWidget::IntWidget(TcamPropertyInteger* prop, QWidget* parent) : QWidget(paren
     setup_ui();
 }
 
-void IntWidget::update()
+PropertyState IntWidget::read_state()
 {
+    PropertyState state;
     GError* err = nullptr;
 
-    bool available = tcam_property_base_is_available(TCAM_PROPERTY_BASE(p_prop), &err);
-    HANDLE_ERROR(err, return );
+    state.available = tcam_property_base_is_available(TCAM_PROPERTY_BASE(p_prop), &err);
+    HANDLE_ERROR(err, return state);
+
+    if (state.available)
+    {
+        if (!is_readonly_)
+        {
+            state.int_min = INT_MIN;
+            state.int_max = INT_MAX;
+            tcam_property_integer_get_range(
+                p_prop, &state.int_min, &state.int_max, &state.int_step, &err);
+            HANDLE_ERROR(err, return state);
+        }
+
+        state.int_value = tcam_property_integer_get_value(p_prop, &err);
+        HANDLE_ERROR(err, return state);
+
+        if (!is_readonly_)
+        {
+            state.locked = tcam_property_base_is_locked(TCAM_PROPERTY_BASE(p_prop), &err);
+            HANDLE_ERROR(err, return state);
+        }
+    }
+
+    state.valid = true;
+    return state;
+}
 
-    if (!available)
+void IntWidget::apply_state(const PropertyState& state)
+{
+    if (!state.valid)
+    {
+        return;
+    }
+
+    if (!state.available)
     {
         if (p_slider)
             p_slider->setDisabled(true);
@@ -236,8 +266,7 @@ void IntWidget::update()
     }
     else if (is_readonly_)
     {
-        gint64 value = tcam_property_integer_get_value(p_prop, &err);
-        HANDLE_ERROR(err, return );
+        gint64 value = state.int_value;
 
         assert(p_slider == nullptr);
         assert(p_box != nullptr);
@@ -257,14 +286,10 @@ void IntWidget::update()
     {
         // !read-only && available
 
-        gint64 min = INT_MIN;
-        gint64 max = INT_MAX;
-        gint64 step = 1;
-        tcam_property_integer_get_range(p_prop, &min, &max, &step, &err);
-        HANDLE_ERROR(err, return );
-
-        gint64 value = tcam_property_integer_get_value(p_prop, &err);
-        HANDLE_ERROR(err, return );
+        gint64 min = state.int_min;
+        gint64 max = state.int_max;
+        gint64 step = state.int_step;
+        gint64 value = state.int_value;
 
         // fix behavior of QSlider/QBox to only show 0, when the range is extremely large
         if (min <= INT_MIN && max >= INT_MAX)
@@ -278,16 +303,13 @@ void IntWidget::update()
             max = value;
         }
 
-        bool lock = tcam_property_base_is_locked(TCAM_PROPERTY_BASE(p_prop), &err);
-        HANDLE_ERROR(err, return );
-
         if (p_slider && !p_slider->isSliderDown())
         {
             const QSignalBlocker blocker(p_slider);
 
             p_slider->setRange(min, max, step);
             p_slider->setValue(value);
-            p_slider->setDisabled(lock);
+            p_slider->setDisabled(state.locked);
         }
         if (p_box)
         {
@@ -298,7 +320,7 @@ void IntWidget::update()
             p_box->setSingleStep(step);
 
             p_box->setValue(value);
-            p_box->setReadOnly(lock);
+            p_box->setReadOnly(state.locked);
         }
     }
 }
@@ -382,8 +404,6 @@ void IntWidget::setup_ui()
         p_box->setSuffix(QString::asprintf(" %s", unit_ptr));
     }
 
-    update();
-
     if (p_slider)
     {
         connect(p_slider, &TcamSlider::valueChanged, this, &IntWidget::slider_changed, Qt::QueuedConnection);
@@ -423,14 +443,45 @@ DoubleWidget::DoubleWidget(TcamPropertyFloat* prop, QWidget* parent) : QWidget(p
     setup_ui();
 }
 
-void DoubleWidget::update()
+PropertyState DoubleWidget::read_state()
 {
+    PropertyState state;
     GError* err = nullptr;
 
-    bool is_available = tcam_property_base_is_available(TCAM_PROPERTY_BASE(p_prop), &err);
-    HANDLE_ERROR(err, return );
+    state.available = tcam_property_base_is_available(TCAM_PROPERTY_BASE(p_prop), &err);
+    HANDLE_ERROR(err, return state);
+
+    if (state.available)
+    {
+        if (!is_readonly_)
+        {
+            tcam_property_float_get_range(
+                p_prop, &state.float_min, &state.float_max, &state.float_step, &err);
+            HANDLE_ERROR(err, return state);
+        }
 
-    if (!is_available)
+        state.float_value = tcam_property_float_get_value(p_prop, &err);
+        HANDLE_ERROR(err, return state);
+
+        if (!is_readonly_)
+        {
+            state.locked = tcam_property_base_is_locked(TCAM_PROPERTY_BASE(p_prop), &err);
+            HANDLE_ERROR(err, return state);
+        }
+    }
+
+    state.valid = true;
+    return state;
+}
+
+void DoubleWidget::apply_state(const PropertyState& state)
+{
+    if (!state.valid)
+    {
+        return;
+    }
+
+    if (!state.available)
     {
         if (p_slider)
             p_slider->setDisabled(true);
@@ -439,8 +490,7 @@ void DoubleWidget::update()
     }
     else if (is_readonly_)
     {
-        gdouble value = tcam_property_float_get_value(p_prop, &err);
-        HANDLE_ERROR(err, return );
+        gdouble value = state.float_value;
 
         assert(p_slider == nullptr);
         assert(p_box != nullptr);
@@ -458,36 +508,24 @@ void DoubleWidget::update()
     }
     else
     {
-        gdouble min = 0;
-        gdouble max = 0;
-        gdouble step = 1;
-        tcam_property_float_get_range(p_prop, &min, &max, &step, &err);
-        HANDLE_ERROR(err, return );
-
-        gdouble value = tcam_property_float_get_value(p_prop, &err);
-        HANDLE_ERROR(err, return );
-
-        bool lock = tcam_property_base_is_locked(TCAM_PROPERTY_BASE(p_prop), &err);
-        HANDLE_ERROR(err, return );
-
         if (p_slider && !p_slider->isSliderDown())
         {
             const QSignalBlocker blocker(p_slider);
 
-            p_slider->setRange(min, max, step);
-            p_slider->setValue(value);
-            p_slider->setDisabled(lock);
+            p_slider->setRange(state.float_min, state.float_max, state.float_step);
+            p_slider->setValue(state.float_value);
+            p_slider->setDisabled(state.locked);
         }
         if (p_box)
         {
             const QSignalBlocker blocker(p_box);
 
             p_box->setDisabled(false);
-            p_box->setRange(min, max);
-            p_box->setSingleStep(step);
+            p_box->setRange(state.float_min, state.float_max);
+            p_box->setSingleStep(state.float_step);
 
-            p_box->setValue(value);
-            p_box->setReadOnly(lock);
+            p_box->setValue(state.float_value);
+            p_box->setReadOnly(state.locked);
         }
     }
 }
@@ -561,8 +599,6 @@ void DoubleWidget::setup_ui()
         p_box->setSuffix(QString::asprintf(" %s", unit_ptr));
     }
 
-    update();
-
     if (p_slider)
     {
         connect(p_slider, &TcamSlider::valueChanged, this, &DoubleWidget::slider_changed, Qt::QueuedConnection);
@@ -604,38 +640,46 @@ BoolWidget::BoolWidget(TcamPropertyBoolean* prop, QWidget* parent) : QWidget(par
 }
 
 
-void BoolWidget::update()
+PropertyState BoolWidget::read_state()
 {
+    PropertyState state;
     GError* err = nullptr;
 
-    bool is_available = tcam_property_base_is_available(TCAM_PROPERTY_BASE(p_prop), &err);
-    HANDLE_ERROR(err, return );
+    state.available = tcam_property_base_is_available(TCAM_PROPERTY_BASE(p_prop), &err);
+    HANDLE_ERROR(err, return state);
 
-    if (!is_available)
+    if (state.available)
     {
-        p_checkbox->setEnabled(false);
+        state.bool_value = tcam_property_boolean_get_value(p_prop, &err);
+        HANDLE_ERROR(err, return state);
+
+        if (!is_readonly_)
+        {
+            state.locked = tcam_property_base_is_locked(TCAM_PROPERTY_BASE(p_prop), &err);
+            HANDLE_ERROR(err, return state);
+        }
     }
-    else if (is_readonly_)
+
+    state.valid = true;
+    return state;
+}
+
+void BoolWidget::apply_state(const PropertyState& state)
+{
+    if (!state.valid)
     {
-        bool value = tcam_property_boolean_get_value(p_prop, &err);
-        HANDLE_ERROR(err, return );
+        return;
+    }
 
-        p_checkbox->blockSignals(true);
-        p_checkbox->setChecked(value);
+    if (!state.available)
+    {
         p_checkbox->setEnabled(false);
-        p_checkbox->blockSignals(false);
     }
     else
     {
-        bool value = tcam_property_boolean_get_value(p_prop, &err);
-        HANDLE_ERROR(err, return );
-
-        bool lock = tcam_property_base_is_locked(TCAM_PROPERTY_BASE(p_prop), &err);
-        HANDLE_ERROR(err, return );
-
         p_checkbox->blockSignals(true);
-        p_checkbox->setChecked(value);
-        p_checkbox->setEnabled(!lock);
+        p_checkbox->setChecked(state.bool_value);
+        p_checkbox->setEnabled(!is_readonly_ && !state.locked);
         p_checkbox->blockSignals(false);
     }
 }
@@ -660,8 +704,6 @@ void BoolWidget::setup_ui()
 
     p_checkbox = new QCheckBox();
 
-    update();
-
     connect(p_checkbox, &QCheckBox::clicked, this, &BoolWidget::checkbox_changed);
 
     p_layout->addWidget(p_checkbox);
@@ -683,25 +725,32 @@ ButtonWidget::ButtonWidget(TcamPropertyCommand* prop, QWidget* parent)
     setup_ui();
 }
 
-void ButtonWidget::update()
+PropertyState ButtonWidget::read_state()
 {
+    PropertyState state;
     GError* err = nullptr;
 
-    bool is_available = tcam_property_base_is_available(TCAM_PROPERTY_BASE(p_prop), &err);
-    HANDLE_ERROR(err, return );
+    state.available = tcam_property_base_is_available(TCAM_PROPERTY_BASE(p_prop), &err);
+    HANDLE_ERROR(err, return state);
 
-    if (!is_available)
+    if (state.available)
     {
-        p_button->setEnabled(false);
+        state.locked = tcam_property_base_is_locked(TCAM_PROPERTY_BASE(p_prop), &err);
+        HANDLE_ERROR(err, return state);
     }
-    else
-    {
-        bool lock = tcam_property_base_is_locked(TCAM_PROPERTY_BASE(p_prop), &err);
 
-        HANDLE_ERROR(err, return );
+    state.valid = true;
+    return state;
+}
 
-        p_button->setEnabled(!lock);
+void ButtonWidget::apply_state(const PropertyState& state)
+{
+    if (!state.valid)
+    {
+        return;
     }
+
+    p_button->setEnabled(state.available && !state.locked);
 }
 
 void ButtonWidget::got_clicked()
@@ -726,8 +775,6 @@ void ButtonWidget::setup_ui()
 
     p_button = new QPushButton();
 
-    update();
-
     connect(p_button, &QPushButton::pressed, this, &ButtonWidget::got_clicked);
 
     p_layout->addWidget(p_button);
@@ -742,27 +789,28 @@ StringWidget::StringWidget(TcamPropertyString* prop, QWidget* parent)
     setup_ui();
 }
 
-void StringWidget::update()
+PropertyState StringWidget::read_state()
 {
+    PropertyState state;
     GError* err = nullptr;
 
     auto access = tcam_property_base_get_access(TCAM_PROPERTY_BASE(p_prop));
 
-    static bool issue_ro_warning;
+    static std::atomic<bool> issue_ro_warning;
 
-    if (access != TCAM_PROPERTY_ACCESS_RO && !issue_ro_warning)
+    if (access != TCAM_PROPERTY_ACCESS_RO && !issue_ro_warning.exchange(true))
     {
         qWarning("Property '%s' is not read-only. String values are not writeable from tcam-capture.", get_name().toStdString().c_str());
-        issue_ro_warning = true;
     }
 
     const char* value = tcam_property_string_get_value(p_prop, &err);
 
-    HANDLE_ERROR(err, return)
+    HANDLE_ERROR(err, return state)
 
+    state.available = true;
     if (value)
     {
-        p_label->setText(value);
+        state.string_value = value;
     }
     else
     {
@@ -771,8 +819,21 @@ void StringWidget::update()
         // a layout change, which seems to have a library
         // bug (tested qt 5.15). Adding a longer empty text
         // prevents reformatting
-        p_label->setText("                    ");
+        state.string_value = "                    ";
     }
+
+    state.valid = true;
+    return state;
+}
+
+void StringWidget::apply_state(const PropertyState& state)
+{
+    if (!state.valid)
+    {
+        return;
+    }
+
+    p_label->setText(state.string_value);
 }
 
 void StringWidget::set_in_backend()
@@ -788,8 +849,6 @@ void StringWidget::setup_ui()
     // values should be copyable
     p_label->setTextInteractionFlags(Qt::TextSelectableByMouse | Qt::TextSelectableByKeyboard);
 
-    update();
-
     p_layout->addWidget(p_label);
 
     setToolTip(generate_tooltip(TCAM_PROPERTY_BASE(p_prop)));
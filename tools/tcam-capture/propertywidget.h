@@ -28,16 +28,50 @@
 #include <QString>
 #include <QWidget>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "tcamspinbox.h"
 #include <tcam-property-1.0.h>
 
+// Everything a property widget shows that has to be read from the device.
+struct PropertyState
+{
+    bool valid = false; // false when reading failed, the widget keeps showing the old values
+    bool available = false;
+    bool locked = false;
+
+    // the members that are read depend on the property type
+    gint64 int_value = 0;
+    gint64 int_min = 0;
+    gint64 int_max = 0;
+    gint64 int_step = 1;
+
+    double float_value = 0.0;
+    double float_min = 0.0;
+    double float_max = 0.0;
+    double float_step = 1.0;
+
+    bool bool_value = false;
+    QString string_value; // also the entry of enumerations
+};
+
+class Property;
+
+// states of the properties of one update, read together by the PropertyWorker
+using PropertyStateBatch = std::vector<std::pair<Property*, PropertyState>>;
+
 class Property
 {
 public:
     virtual ~Property() = default;
 
-    virtual void update() = 0;
+    // Reads the state from the device.
+    // Called in the PropertyWorker thread, so it must not touch any widget.
+    virtual PropertyState read_state() = 0;
+    // Shows a state returned by read_state(), only called in the GUI thread.
+    virtual void apply_state(const PropertyState& state) = 0;
+
     virtual void set_in_backend() = 0;
 
     QString get_name() const;
@@ -53,7 +87,8 @@ class EnumWidget : public QWidget, public Property
 public:
     EnumWidget(TcamPropertyEnumeration* prop, QWidget* parent = nullptr);
 
-    virtual void update() final;
+    virtual PropertyState read_state() final;
+    virtual void apply_state(const PropertyState& state) final;
 
     virtual void set_in_backend() final;
 
@@ -90,7 +125,8 @@ class IntWidget : public QWidget, public Property
 public:
     IntWidget(TcamPropertyInteger* prop, QWidget* parent = nullptr);
 
-    virtual void update() final;
+    virtual PropertyState read_state() final;
+    virtual void apply_state(const PropertyState& state) final;
     virtual void set_in_backend() final;
 
 protected:
@@ -128,7 +164,8 @@ class DoubleWidget : public QWidget, public Property
 public:
     DoubleWidget(TcamPropertyFloat* prop, QWidget* parent = nullptr);
 
-    virtual void update() final;
+    virtual PropertyState read_state() final;
+    virtual void apply_state(const PropertyState& state) final;
     virtual void set_in_backend() final;
 
 protected:
@@ -167,7 +204,8 @@ class BoolWidget : public QWidget, public Property
 public:
     BoolWidget(TcamPropertyBoolean* prop, QWidget* parent = nullptr);
 
-    virtual void update() final;
+    virtual PropertyState read_state() final;
+    virtual void apply_state(const PropertyState& state) final;
     virtual void set_in_backend() final;
 
 protected:
@@ -202,7 +240,8 @@ public:
     ButtonWidget(TcamPropertyCommand* prop, QWidget* parent = nullptr);
 
 
-    virtual void update() final;
+    virtual PropertyState read_state() final;
+    virtual void apply_state(const PropertyState& state) final;
     virtual void set_in_backend() final;
 
 protected:
@@ -235,7 +274,8 @@ class StringWidget : public QWidget, public Property
 public:
     explicit StringWidget(TcamPropertyString* prop, QWidget* parent = nullptr);
 
-    virtual void update() final;
+    virtual PropertyState read_state() final;
+    virtual void apply_state(const PropertyState& state) final;
     virtual void set_in_backend() final;
 
 protected:
@@ -256,4 +296,6 @@ private:
     TcamPropertyString* p_prop = nullptr;
 };
 
+Q_DECLARE_METATYPE(PropertyStateBatch)
+
 #endif // PROPERTYWIDGET_H
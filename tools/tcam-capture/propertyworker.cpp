@@ -16,7 +16,6 @@
 
 #include "propertyworker.h"
 
-#include "propertywidget.h"
 #include <QThread>
 
 PropertyWorker::PropertyWorker()
@@ -25,10 +24,40 @@ PropertyWorker::PropertyWorker()
 
 void PropertyWorker::add_properties(const std::vector<Property*>& new_props)
 {
+    std::lock_guard lck { m_mtx };
     m_properties.insert(m_properties.end(), new_props.begin(), new_props.end());
 }
 
 
+template<class TPred> void PropertyWorker::read_states(TPred pred)
+{
+    std::vector<Property*> props;
+    {
+        std::lock_guard lck { m_mtx };
+        for (auto& prop : m_properties)
+        {
+            if (pred(prop))
+            {
+                props.push_back(prop);
+            }
+        }
+    }
+
+    if (props.empty())
+    {
+        return;
+    }
+
+    // the reads of one batch follow each other closely, so backends with a property cache,
+    // e.g. the control snapshot of v4l2, serve most of them without a device round trip
+    PropertyStateBatch states;
+    states.reserve(props.size());
+    for (auto* prop : props) { states.emplace_back(prop, prop->read_state()); }
+
+    emit states_read(std::move(states));
+}
+
+
 void PropertyWorker::write_property(Property* p)
 {
     p->set_in_backend();
@@ -36,23 +65,19 @@ void PropertyWorker::write_property(Property* p)
     const auto cat = p->get_category();
     const auto name = p->get_name();
 
-    for (auto& prop : m_properties)
-    {
-        if (name != prop->get_name() && prop->get_category() == cat)
-        {
-            prop->update();
-        }
-    }
+    read_states([&](Property* prop)
+                { return name != prop->get_name() && prop->get_category() == cat; });
+}
+
+
+void PropertyWorker::update_property(QString name)
+{
+    read_states([&](Property* prop) { return name == prop->get_name(); });
 }
 
 
 void PropertyWorker::update_category(QString category)
 {
-    for (auto& prop : m_properties)
-    {
-        if (prop->get_category() == category.toStdString())
-        {
-            prop->update();
-        }
-    }
+    const auto cat = category.toStdString();
+    read_states([&](Property* prop) { return prop->get_category() == cat; });
 }
@@ -17,26 +17,39 @@
 #ifndef PROPERTYWORKER_H
 #define PROPERTYWORKER_H
 
+#include "propertywidget.h"
+
 #include <QTimer>
+#include <mutex>
 #include <vector>
 
-class Property;
-
+// Reads and writes properties in its own thread, so that device access does not block the GUI.
+// Read states are passed back to the GUI thread in batches through states_read.
 class PropertyWorker : public QObject
 {
     Q_OBJECT
 public:
     PropertyWorker();
 
+    // may be called from any thread, the dialog adds the properties of a tab once it is shown
     void add_properties(const std::vector<Property*>& new_props);
 
 public slots:
 
     void update_category(QString category);
+    void update_property(QString name);
 
     void write_property(Property* p);
 
+signals:
+
+    void states_read(PropertyStateBatch states);
+
 private:
+    // reads all properties matching pred and emits them as one batch
+    template<class TPred> void read_states(TPred pred);
+
+    std::mutex m_mtx;
     std::vector<Property*> m_properties;
 };
 
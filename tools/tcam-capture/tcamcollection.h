@@ -41,6 +41,12 @@ public:
 
     std::vector<std::string> get_names() const;
 
+    // elements providing the properties, the references belong to the collection
+    std::vector<GstElement*> get_elements() const
+    {
+        return m_elements;
+    }
+
     TcamPropertyBase* get_property(const std::string& name);
 
     bool is_trigger_mode_active();
@@ -27,16 +27,70 @@ namespace
 
 {
 
+bool has_element(const char* name)
+{
+    auto factory = gst_element_factory_find(name);
+    if (!factory)
+    {
+        return false;
+    }
+    gst_object_unref(factory);
+    return true;
+}
+
+tcam::tools::capture::H264Encoder find_h264_encoder()
+{
+    // the converters run on the same hardware as the encoder, no cpu conversion is needed
+    if (has_element("nvv4l2h264enc") && has_element("nvvidconv"))
+    {
+        return { "nvv4l2h264enc",
+                 " ! nvvidconv ! video/x-raw(memory:NVMM),format=NV12 "
+                 " ! nvv4l2h264enc name=save-enc ! h264parse ",
+                 true };
+    }
+    if (has_element("vah264enc") && has_element("vapostproc"))
+    {
+        return { "vah264enc",
+                 " ! vapostproc ! video/x-raw(memory:VAMemory),format=NV12 "
+                 " ! vah264enc name=save-enc ! h264parse ",
+                 true };
+    }
+    if (has_element("vaapih264enc") && has_element("vaapipostproc"))
+    {
+        return { "vaapih264enc",
+                 " ! vaapipostproc format=nv12 ! vaapih264enc name=save-enc ! h264parse ",
+                 true };
+    }
+    if (has_element("qsvh264enc"))
+    {
+        return { "qsvh264enc",
+                 " ! videoconvert n-threads=4 ! video/x-raw,format=NV12 "
+                 " ! qsvh264enc name=save-enc ! h264parse ",
+                 true };
+    }
+    if (has_element("v4l2h264enc"))
+    {
+        // the mem2mem converter of the SoC, e.g. the i.MX 8 ISI
+        const QString convert = has_element("v4l2convert") ? " ! v4l2convert "
+                                                           : " ! videoconvert n-threads=4 ";
+        return { "v4l2h264enc",
+                 convert
+                     + " ! video/x-raw,format=NV12 ! v4l2h264enc name=save-enc ! h264parse ",
+                 true };
+    }
+
+    return { "x264enc", " ! videoconvert n-threads=4 ! queue ! x264enc name=save-enc ", false };
+}
+
 QString find_codec_pipeline(VideoCodec codec)
 {
     // the following parts have to be kept identical between codecs
     // begin with a queue named save-queue
     // end with a filesink named save-sink
 
-    QString start = "queue name=save-queue max-size-time=0 max-size-bytes=0 max-size-buffers=0 "
-        "leaky=downstream"
-        " ! videoconvert n-threads=4 "
-        " ! queue ";
+    // images older than 2 seconds are dropped and counted when the encoder falls behind
+    QString start = "queue name=save-queue max-size-time=2000000000 max-size-bytes=0 "
+                    "max-size-buffers=0 leaky=downstream";
     QString end = " ! queue max-size-time=0 max-size-bytes=0 max-size-buffers=0 "
           " ! filesink async=true sync=false name=save-sink";
 
@@ -45,7 +99,7 @@ QString find_codec_pipeline(VideoCodec codec)
         case VideoCodec::H264:
         {
             return start
-                   + " ! x264enc name=save-enc "
+                   + tcam::tools::capture::probe_h264_encoder().pipeline
                    + " ! mp4mux "
                    + end;
         }
@@ -61,9 +115,8 @@ QString find_codec_pipeline(VideoCodec codec)
         // }
         case VideoCodec::MJPEG:
         {
-            return "queue name=save-queue leaky=1 max-size-time=0 max-size-bytes=0 "
-                   "max-size-buffers=0 "
-                   " ! videoconvert n-threads=4 "
+            return start
+                   + " ! videoconvert n-threads=4 "
                    " ! jpegenc name=save-enc "
                    " ! avimux "
                    " ! queue max-size-time=0 max-size-bytes=0 max-size-buffers=0 "
@@ -77,6 +130,26 @@ QString find_codec_pipeline(VideoCodec codec)
 
 } // namespace
 
+
+const tcam::tools::capture::H264Encoder& tcam::tools::capture::probe_h264_encoder()
+{
+    static const H264Encoder encoder = []
+    {
+        auto enc = find_h264_encoder();
+        if (enc.is_hardware)
+        {
+            qInfo("Recording H264 with hardware encoder %s", enc.element.toStdString().c_str());
+        }
+        else
+        {
+            qInfo("No hardware H264 encoder found. Recording with x264enc.");
+        }
+        return enc;
+    }();
+    return encoder;
+}
+
+
 tcam::tools::capture::VideoSaver::VideoSaver(GstPipeline* pipeline,
                                              const QString& filename,
                                              VideoCodec codec)
@@ -98,6 +171,16 @@ void tcam::tools::capture::VideoSaver::start_saving()
     auto file_sink = gst_bin_get_by_name(GST_BIN(save_pipeline_), "save-sink");
 
     g_object_set(file_sink, "location", target_file_.toStdString().c_str(), nullptr);
+    gst_object_unref(file_sink);
+
+    g_signal_connect(queue_, "overrun", G_CALLBACK(&VideoSaver::on_queue_overrun), this);
+
+    auto enc = gst_bin_get_by_name(GST_BIN(save_pipeline_), "save-enc");
+    auto enc_pad = gst_element_get_static_pad(enc, "sink");
+    gst_pad_add_probe(
+        enc_pad, GST_PAD_PROBE_TYPE_BUFFER, &VideoSaver::on_encoder_buffer, this, nullptr);
+    gst_object_unref(enc_pad);
+    gst_object_unref(enc);
 
     gst_bin_add(GST_BIN(pipeline_), save_pipeline_);
 
@@ -142,6 +225,8 @@ void tcam::tools::capture::VideoSaver::destroy_pipeline()
     {
         gst_element_set_state(save_pipeline_, GST_STATE_NULL);
 
+        g_signal_handlers_disconnect_by_data(queue_, this);
+
         gst_bin_remove(GST_BIN(pipeline_), save_pipeline_);
 
         gst_object_unref(save_pipeline_);
@@ -161,3 +246,36 @@ GstObject* tcam::tools::capture::VideoSaver::gst_pointer() const
 
     return GST_OBJECT(sink);
 }
+
+
+QString tcam::tools::capture::VideoSaver::encoder_name() const
+{
+    switch (codec_)
+    {
+        case VideoCodec::H264:
+        {
+            return probe_h264_encoder().element;
+        }
+        case VideoCodec::MJPEG:
+        {
+            return "jpegenc";
+        }
+    }
+    return {};
+}
+
+
+void tcam::tools::capture::VideoSaver::on_queue_overrun(GstElement* /*queue*/, gpointer user_data)
+{
+    // with leaky=downstream every overrun drops the oldest image
+    static_cast<VideoSaver*>(user_data)->dropped_frames_++;
+}
+
+
+GstPadProbeReturn tcam::tools::capture::VideoSaver::on_encoder_buffer(GstPad* /*pad*/,
+                                                                      GstPadProbeInfo* /*info*/,
+                                                                      gpointer user_data)
+{
+    static_cast<VideoSaver*>(user_data)->encoded_frames_++;
+    return GST_PAD_PROBE_OK;
+}
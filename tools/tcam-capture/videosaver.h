@@ -19,6 +19,7 @@
 #include "gst/gstelement.h"
 #include "gst/gstmessage.h"
 #include <QString>
+#include <atomic>
 #include <gst/gst.h>
 
 #include "config.h"
@@ -26,6 +27,19 @@
 namespace tcam::tools::capture
 {
 
+// Part of the H264 recording pipeline between the capture-tee branch and the muxer
+struct H264Encoder
+{
+    QString element; // e.g. nvv4l2h264enc, x264enc
+    // conversion to NV12 and encoder, the encoder is named save-enc
+    QString pipeline;
+    bool is_hardware = false;
+};
+
+// Looks for a hardware encoder of Jetson, VA-API/Intel or V4L2 m2m (e.g. NXP) systems.
+// Probed once, falls back to x264enc.
+const H264Encoder& probe_h264_encoder();
+
 class VideoSaver
 {
 public:
@@ -48,7 +62,28 @@ public:
     // typically the sink
     GstObject* gst_pointer() const;
 
+    // element that encodes the video
+    QString encoder_name() const;
+
+    // images the save-queue dropped because the encoder fell behind
+    uint64_t dropped_frames() const
+    {
+        return dropped_frames_;
+    }
+    // images that reached the encoder
+    uint64_t encoded_frames() const
+    {
+        return encoded_frames_;
+    }
+
 private:
+    static void on_queue_overrun(GstElement* queue, gpointer user_data);
+    static GstPadProbeReturn on_encoder_buffer(GstPad* pad,
+                                               GstPadProbeInfo* info,
+                                               gpointer user_data);
+
+    std::atomic<uint64_t> dropped_frames_ { 0 };
+    std::atomic<uint64_t> encoded_frames_ { 0 };
 
     GstElement* pipeline_ = nullptr;
     QString target_file_;
@@ -0,0 +1,690 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark.h"
+
+#include "../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
+#include "general.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <gst-helper/helper_functions.h>
+#include <gst/gst.h>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <time.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+// time for the camera and auto algorithms to settle before the measurement starts
+constexpr std::chrono::seconds warmup_duration { 1 };
+
+// the achieved rate may be this much below the target, the timestamps of the sink jitter
+constexpr double fps_tolerance = 0.01;
+
+
+uint64_t monotonic_ns()
+{
+    timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1'000'000'000ULL + uint64_t(ts.tv_nsec);
+}
+
+
+struct thread_cpu
+{
+    pid_t tid = 0;
+    std::string name;
+    uint64_t cpu_ns = 0;
+};
+
+// user + system time of all threads of this process, from /proc/self/task/<tid>/stat
+std::vector<thread_cpu> read_thread_cpu()
+{
+    std::vector<thread_cpu> ret;
+
+    DIR* dir = opendir("/proc/self/task");
+    if (!dir)
+    {
+        return ret;
+    }
+
+    const uint64_t ticks_per_s = sysconf(_SC_CLK_TCK);
+
+    while (auto entry = readdir(dir))
+    {
+        if (entry->d_name[0] == '.')
+        {
+            continue;
+        }
+
+        std::ifstream stat_file(std::string("/proc/self/task/") + entry->d_name + "/stat");
+        std::string line;
+        std::getline(stat_file, line);
+
+        // the name in field 2 is in parentheses and may contain spaces
+        auto name_begin = line.find('(');
+        auto name_end = line.rfind(')');
+        if (name_begin == std::string::npos || name_end == std::string::npos
+            || name_end + 2 > line.size())
+        {
+            continue;
+        }
+
+        // fields 3 to 13 are skipped, 14 and 15 are utime and stime
+        std::istringstream fields(line.substr(name_end + 2));
+        std::string skip;
+        for (int i = 3; i <= 13; ++i) { fields >> skip; }
+
+        uint64_t utime = 0;
+        uint64_t stime = 0;
+        fields >> utime >> stime;
+
+        ret.push_back({ static_cast<pid_t>(std::atoi(entry->d_name)),
+                        line.substr(name_begin + 1, name_end - name_begin - 1),
+                        (utime + stime) * 1'000'000'000ULL / ticks_per_s });
+    }
+    closedir(dir);
+
+    return ret;
+}
+
+
+// tcamconvert runs in the streaming thread of the queue 'conv' in front of it and in its worker
+// threads, GStreamer names streaming threads '<element>:<pad>'
+bool is_conversion_thread(const std::string& name)
+{
+    return name == "tcamconvert" || name.rfind("conv:", 0) == 0;
+}
+
+
+struct cpu_usage
+{
+    uint64_t capture_ns = 0;
+    uint64_t conversion_ns = 0;
+};
+
+// everything except the main thread, which only waits for the run to end, and tcamconvert is
+// accounted to the capture
+cpu_usage get_cpu_usage(const std::vector<thread_cpu>& begin, const std::vector<thread_cpu>& end)
+{
+    cpu_usage ret;
+    const pid_t main_tid = getpid();
+
+    for (const auto& thrd : end)
+    {
+        if (thrd.tid == main_tid)
+        {
+            continue;
+        }
+
+        auto start = std::find_if(
+            begin.begin(), begin.end(), [&thrd](const thread_cpu& t) { return t.tid == thrd.tid; });
+        const uint64_t start_ns = start != begin.end() ? start->cpu_ns : 0;
+        if (thrd.cpu_ns < start_ns)
+        {
+            continue;
+        }
+
+        if (is_conversion_thread(thrd.name))
+        {
+            ret.conversion_ns += thrd.cpu_ns - start_ns;
+        }
+        else
+        {
+            ret.capture_ns += thrd.cpu_ns - start_ns;
+        }
+    }
+    return ret;
+}
+
+
+const GstStructure* get_statistics(GstBuffer* buffer)
+{
+    auto meta = gst_buffer_get_tcam_statistics_meta(buffer);
+    return meta ? meta->structure : nullptr;
+}
+
+uint64_t get_uint64(const GstStructure& struc, const char* name)
+{
+    guint64 val = 0;
+    gst_structure_get_uint64(&struc, name, &val);
+    return val;
+}
+
+
+// the transport counters are totals since stream start, first/last give the run
+struct counter_span
+{
+    uint64_t first = 0;
+    uint64_t last = 0;
+
+    void update(uint64_t val, bool is_first) noexcept
+    {
+        if (is_first)
+        {
+            first = val;
+        }
+        last = val;
+    }
+    uint64_t delta() const noexcept
+    {
+        return last >= first ? last - first : 0;
+    }
+};
+
+
+struct run_state
+{
+    std::atomic<bool> recording = false;
+
+    // written by the streaming thread of tcamsrc
+    uint64_t source_frames = 0;
+    bool has_statistics = false;
+    counter_span frame_count;
+    counter_span frames_dropped;
+    counter_span resent_packets;
+    counter_span missing_packets;
+    uint64_t damaged = 0;
+
+    // The statistics meta does not pass tcamconvert, the sink finds the dequeue time of its
+    // buffer by the pts
+    std::mutex dequeue_mutex;
+    std::unordered_map<GstClockTime, uint64_t> dequeue_ns_by_pts;
+
+    // written by the streaming thread of the sink
+    std::vector<uint64_t> arrival_ns;
+    std::vector<uint64_t> latency_ns;
+};
+
+
+GstPadProbeReturn source_probe(GstPad* /*pad*/, GstPadProbeInfo* info, gpointer user_data)
+{
+    auto& state = *static_cast<run_state*>(user_data);
+    if (!state.recording)
+    {
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+    state.source_frames++;
+
+    auto stats = get_statistics(buffer);
+    if (!stats)
+    {
+        return GST_PAD_PROBE_OK;
+    }
+
+    const bool is_first = !state.has_statistics;
+    state.has_statistics = true;
+
+    state.frame_count.update(get_uint64(*stats, "frame_count"), is_first);
+    state.frames_dropped.update(get_uint64(*stats, "frames_dropped"), is_first);
+    state.resent_packets.update(get_uint64(*stats, "resent_packets"), is_first);
+    state.missing_packets.update(get_uint64(*stats, "missing_packets"), is_first);
+
+    gboolean is_damaged = FALSE;
+    if (gst_structure_get_boolean(stats, "is_damaged", &is_damaged) && is_damaged)
+    {
+        state.damaged++;
+    }
+
+    // 0 when TCAM_STAGE_TIMING=0
+    if (auto dequeue_ns = get_uint64(*stats, "stage_backend_dequeue_ns");
+        dequeue_ns != 0 && GST_BUFFER_PTS_IS_VALID(buffer))
+    {
+        std::scoped_lock lck { state.dequeue_mutex };
+        state.dequeue_ns_by_pts[GST_BUFFER_PTS(buffer)] = dequeue_ns;
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+
+GstPadProbeReturn sink_probe(GstPad* /*pad*/, GstPadProbeInfo* info, gpointer user_data)
+{
+    auto& state = *static_cast<run_state*>(user_data);
+    if (!state.recording)
+    {
+        return GST_PAD_PROBE_OK;
+    }
+
+    const uint64_t now = monotonic_ns();
+    state.arrival_ns.push_back(now);
+
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (!GST_BUFFER_PTS_IS_VALID(buffer))
+    {
+        return GST_PAD_PROBE_OK;
+    }
+
+    std::scoped_lock lck { state.dequeue_mutex };
+    auto iter = state.dequeue_ns_by_pts.find(GST_BUFFER_PTS(buffer));
+    if (iter != state.dequeue_ns_by_pts.end())
+    {
+        if (iter->second <= now)
+        {
+            state.latency_ns.push_back(now - iter->second);
+        }
+        state.dequeue_ns_by_pts.erase(iter);
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+
+// returns the message of an error or end of stream within timeout, empty otherwise
+std::string wait_for_error(GstBus* bus, std::chrono::nanoseconds timeout)
+{
+    auto msg = gst_bus_timed_pop_filtered(
+        bus, timeout.count(), (GstMessageType)(GST_MESSAGE_ERROR | GST_MESSAGE_EOS));
+    if (!msg)
+    {
+        return {};
+    }
+
+    std::string ret = "Unexpected end of stream.";
+    if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR)
+    {
+        GError* err = nullptr;
+        gchar* debug_info = nullptr;
+        gst_message_parse_error(msg, &err, &debug_info);
+        ret = err->message;
+        g_clear_error(&err);
+        g_free(debug_info);
+    }
+    gst_message_unref(msg);
+    return ret;
+}
+
+
+struct run_result
+{
+    // empty when the pipeline ran for the whole duration
+    std::string error;
+
+    double requested_fps = 0;
+    double achieved_fps = 0;
+
+    uint64_t frames = 0;
+    uint64_t dropped = 0;
+    uint64_t frame_count_gaps = 0;
+    uint64_t damaged = 0;
+    uint64_t resent_packets = 0;
+    uint64_t missing_packets = 0;
+
+    cpu_usage cpu;
+
+    // sorted
+    std::vector<uint64_t> latency_ns;
+};
+
+
+GstElement* make_element(const char* factory, const char* name)
+{
+    auto elem = gst_element_factory_make(factory, name);
+    if (!elem)
+    {
+        std::cerr << "Unable to create " << factory << " element." << std::endl;
+    }
+    return elem;
+}
+
+
+run_result run_pipeline(const std::string& serial,
+                        const GstCaps& caps,
+                        bool use_convert,
+                        std::chrono::nanoseconds duration)
+{
+    run_result res;
+
+    int fps_num = 0;
+    int fps_denom = 1;
+    if (gst_structure_get_fraction(gst_caps_get_structure(&caps, 0), "framerate", &fps_num, &fps_denom)
+        && fps_denom != 0)
+    {
+        res.requested_fps = double(fps_num) / fps_denom;
+    }
+
+    // tcamsrc ! capsfilter [! queue ! tcamconvert ! capsfilter] ! fakesink
+    auto pipeline = gst_helper::make_ptr(gst_pipeline_new("benchmark"));
+
+    std::vector<GstElement*> chain = { make_element("tcamsrc", "src"),
+                                       make_element("capsfilter", "src_caps") };
+    if (use_convert)
+    {
+        chain.push_back(make_element("queue", "conv"));
+        chain.push_back(make_element("tcamconvert", "convert"));
+        chain.push_back(make_element("capsfilter", "convert_caps"));
+    }
+    chain.push_back(make_element("fakesink", "sink"));
+
+    if (std::any_of(chain.begin(), chain.end(), [](GstElement* e) { return e == nullptr; }))
+    {
+        for (auto e : chain)
+        {
+            if (e)
+            {
+                gst_object_unref(e);
+            }
+        }
+        res.error = "Unable to create the pipeline.";
+        return res;
+    }
+
+    GstElement* source = chain.front();
+    GstElement* sink = chain.back();
+
+    g_object_set(source, "serial", serial.c_str(), nullptr);
+    g_object_set(chain[1], "caps", &caps, nullptr);
+    g_object_set(sink, "sync", FALSE, nullptr);
+    if (use_convert)
+    {
+        auto bgrx = gst_helper::make_ptr(gst_caps_from_string("video/x-raw,format=BGRx"));
+        g_object_set(chain[4], "caps", bgrx.get(), nullptr);
+    }
+
+    for (auto e : chain) { gst_bin_add(GST_BIN(pipeline.get()), e); }
+    for (size_t i = 1; i < chain.size(); ++i)
+    {
+        if (!gst_element_link(chain[i - 1], chain[i]))
+        {
+            res.error = "Unable to link the pipeline.";
+            return res;
+        }
+    }
+
+    run_state state;
+
+    auto source_pad = gst_helper::make_ptr(gst_element_get_static_pad(source, "src"));
+    auto sink_pad = gst_helper::make_ptr(gst_element_get_static_pad(sink, "sink"));
+    gst_pad_add_probe(source_pad.get(), GST_PAD_PROBE_TYPE_BUFFER, source_probe, &state, nullptr);
+    gst_pad_add_probe(sink_pad.get(), GST_PAD_PROBE_TYPE_BUFFER, sink_probe, &state, nullptr);
+
+    auto bus = gst_helper::make_ptr(gst_pipeline_get_bus(GST_PIPELINE(pipeline.get())));
+
+    tcam::tools::ctrl::ElementStateGuard state_guard(*pipeline.get());
+
+    gst_element_set_state(pipeline.get(), GST_STATE_PLAYING);
+    if (gst_element_get_state(pipeline.get(), nullptr, nullptr, 10 * GST_SECOND)
+        != GST_STATE_CHANGE_SUCCESS)
+    {
+        res.error = wait_for_error(bus.get(), std::chrono::nanoseconds(0));
+        if (res.error.empty())
+        {
+            res.error = "Pipeline did not start within 10 s.";
+        }
+        return res;
+    }
+
+    res.error = wait_for_error(bus.get(), warmup_duration);
+    if (!res.error.empty())
+    {
+        return res;
+    }
+
+    const auto cpu_begin = read_thread_cpu();
+    state.recording = true;
+
+    res.error = wait_for_error(bus.get(), duration);
+
+    state.recording = false;
+    res.cpu = get_cpu_usage(cpu_begin, read_thread_cpu());
+
+    // joins the streaming threads, the state is not written afterwards
+    gst_element_set_state(pipeline.get(), GST_STATE_NULL);
+
+    res.frames = state.arrival_ns.size();
+    if (state.arrival_ns.size() > 1)
+    {
+        const auto span_ns = state.arrival_ns.back() - state.arrival_ns.front();
+        if (span_ns > 0)
+        {
+            res.achieved_fps = (state.arrival_ns.size() - 1) * 1e9 / span_ns;
+        }
+    }
+
+    res.dropped = state.frames_dropped.delta();
+    res.damaged = state.damaged;
+    res.resent_packets = state.resent_packets.delta();
+    res.missing_packets = state.missing_packets.delta();
+    if (state.has_statistics && state.source_frames > 0)
+    {
+        const uint64_t expected = state.frame_count.delta() + 1;
+        res.frame_count_gaps = expected > state.source_frames ? expected - state.source_frames : 0;
+    }
+
+    res.latency_ns = std::move(state.latency_ns);
+    std::sort(res.latency_ns.begin(), res.latency_ns.end());
+
+    return res;
+}
+
+
+double to_ms(uint64_t ns)
+{
+    return ns / 1e6;
+}
+
+// nearest rank
+uint64_t percentile(const std::vector<uint64_t>& sorted, int p)
+{
+    return sorted[(sorted.size() - 1) * p / 100];
+}
+
+
+bool print_result(const run_result& res, bool use_convert, double target_fps)
+{
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  pipeline:       " << (use_convert ? "tcamsrc ! tcamconvert ! BGRx" : "tcamsrc")
+              << std::endl;
+
+    if (!res.error.empty())
+    {
+        std::cout << "  error:          " << res.error << std::endl
+                  << "  result:         FAIL" << std::endl;
+        return false;
+    }
+
+    if (target_fps <= 0)
+    {
+        target_fps = res.requested_fps;
+    }
+
+    std::cout << "  fps:            " << res.achieved_fps << " of " << res.requested_fps
+              << " requested" << std::endl
+              << "  frames:         " << res.frames << " received, " << res.dropped << " dropped, "
+              << res.frame_count_gaps << " missing in frame_count, " << res.damaged << " damaged"
+              << std::endl
+              << "  packets:        " << res.resent_packets << " resent, " << res.missing_packets
+              << " missing" << std::endl;
+
+    if (res.frames > 0)
+    {
+        std::cout << "  cpu per frame:  capture " << to_ms(res.cpu.capture_ns / res.frames)
+                  << " ms, conversion " << to_ms(res.cpu.conversion_ns / res.frames) << " ms"
+                  << std::endl;
+    }
+
+    if (!res.latency_ns.empty())
+    {
+        std::cout << "  latency:        p50 " << to_ms(percentile(res.latency_ns, 50)) << " ms, p90 "
+                  << to_ms(percentile(res.latency_ns, 90)) << " ms, p99 "
+                  << to_ms(percentile(res.latency_ns, 99)) << " ms, max "
+                  << to_ms(res.latency_ns.back()) << " ms" << std::endl;
+    }
+    else
+    {
+        std::cout << "  latency:        n/a, requires the libtcam stage timing (TCAM_STAGE_TIMING)"
+                  << std::endl;
+    }
+
+    const bool rate_ok = res.achieved_fps >= target_fps * (1.0 - fps_tolerance);
+    const bool frames_ok = res.frames > 0 && res.dropped == 0 && res.frame_count_gaps == 0
+                           && res.damaged == 0;
+    const bool passed = rate_ok && frames_ok;
+
+    std::cout << "  result:         " << (passed ? "PASS" : "FAIL") << " (" << res.achieved_fps
+              << (rate_ok ? " >= " : " < ") << "target " << target_fps << " fps"
+              << (frames_ok ? "" : ", incomplete frames") << ")" << std::endl;
+
+    return passed;
+}
+
+
+// fixed caps with the largest resolution and framerate for every entry of caps
+std::vector<gst_helper::gst_ptr<GstCaps>> expand_caps(const GstCaps& caps)
+{
+    std::vector<gst_helper::gst_ptr<GstCaps>> ret;
+    std::vector<std::string> seen;
+
+    auto normalized = gst_helper::make_ptr(gst_caps_normalize(gst_caps_copy(&caps)));
+
+    for (guint i = 0; i < gst_caps_get_size(normalized.get()); ++i)
+    {
+        GstCaps* single = gst_caps_copy_nth(normalized.get(), i);
+        GstStructure* struc = gst_caps_get_structure(single, 0);
+
+        gst_structure_fixate_field_nearest_int(struc, "width", G_MAXINT);
+        gst_structure_fixate_field_nearest_int(struc, "height", G_MAXINT);
+        gst_structure_fixate_field_nearest_fraction(struc, "framerate", G_MAXINT, 1);
+
+        auto fixed = gst_helper::make_ptr(gst_caps_fixate(single));
+
+        auto str = gst_helper::to_string(*fixed);
+        if (std::find(seen.begin(), seen.end(), str) == seen.end())
+        {
+            seen.push_back(str);
+            ret.push_back(std::move(fixed));
+        }
+    }
+    return ret;
+}
+
+
+gst_helper::gst_ptr<GstCaps> query_device_caps(const std::string& serial)
+{
+    auto source = tcam::tools::ctrl::open_element("tcamsrc");
+    if (!source || !tcam::tools::ctrl::set_serial(source, serial))
+    {
+        return nullptr;
+    }
+
+    tcam::tools::ctrl::ElementStateGuard state_guard(*source.get());
+    if (!state_guard.set_state(GST_STATE_READY))
+    {
+        std::cerr << "Unable to open the device." << std::endl;
+        return nullptr;
+    }
+
+    auto pad = gst_helper::make_ptr(gst_element_get_static_pad(source.get(), "src"));
+    return gst_helper::make_ptr(gst_pad_query_caps(pad.get(), nullptr));
+}
+
+
+// sink caps of tcamconvert, nullptr when it is not installed
+gst_helper::gst_ptr<GstCaps> query_convert_caps()
+{
+    auto convert = gst_helper::make_ptr(gst_element_factory_make("tcamconvert", nullptr));
+    if (!convert)
+    {
+        return nullptr;
+    }
+    auto pad = gst_helper::make_ptr(gst_element_get_static_pad(convert.get(), "sink"));
+    return gst_helper::make_ptr(gst_pad_query_caps(pad.get(), nullptr));
+}
+
+} // namespace
+
+
+int tcam::tools::ctrl::run_benchmark(const std::string& serial, const benchmark_options& options)
+{
+    gst_helper::gst_ptr<GstCaps> caps;
+    if (options.caps_str.empty())
+    {
+        caps = query_device_caps(serial);
+    }
+    else
+    {
+        if (!is_valid_device_serial(serial))
+        {
+            std::cerr << "Device with given serial does not exist." << std::endl;
+            return 2;
+        }
+        caps = gst_helper::make_ptr(gst_caps_from_string(options.caps_str.c_str()));
+        if (!caps)
+        {
+            std::cerr << "Unable to parse caps '" << options.caps_str << "'." << std::endl;
+            return 2;
+        }
+    }
+
+    if (!caps || gst_caps_is_empty(caps.get()) || gst_caps_is_any(caps.get()))
+    {
+        std::cerr << "No caps to benchmark." << std::endl;
+        return 2;
+    }
+
+    const auto convert_caps = query_convert_caps();
+    const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double>(options.duration_s));
+
+    int run_count = 0;
+    int pass_count = 0;
+
+    for (const auto& fixed : expand_caps(*caps))
+    {
+        std::cout << std::endl << gst_helper::to_string(*fixed) << std::endl;
+
+        for (bool use_convert : { false, true })
+        {
+            if (use_convert
+                && (!convert_caps || !gst_caps_can_intersect(fixed.get(), convert_caps.get())))
+            {
+                std::cout << "  pipeline:       tcamsrc ! tcamconvert ! BGRx" << std::endl
+                          << "  result:         SKIPPED, not supported by tcamconvert" << std::endl;
+                continue;
+            }
+
+            auto res = run_pipeline(serial, *fixed, use_convert, duration);
+
+            run_count++;
+            if (print_result(res, use_convert, options.target_fps))
+            {
+                pass_count++;
+            }
+        }
+    }
+
+    const bool all_passed = run_count > 0 && pass_count == run_count;
+
+    std::cout << std::endl
+              << "Benchmark " << (all_passed ? "PASS" : "FAIL") << ": " << pass_count << " of "
+              << run_count << " runs passed" << std::endl;
+
+    return all_passed ? 0 : 1;
+}
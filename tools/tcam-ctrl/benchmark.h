@@ -0,0 +1,40 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+
+namespace tcam::tools::ctrl
+{
+
+struct benchmark_options
+{
+    // fixed or unfixed caps, empty for all caps of the device
+    std::string caps_str;
+    double duration_s = 5.0;
+    // rate a run has to reach to pass, 0 for the framerate of the caps
+    double target_fps = 0.0;
+};
+
+/**
+ * Streams every selected caps for duration_s through tcamsrc, once directly into a sink and once
+ * through tcamconvert, and prints one report per run with a PASS/FAIL line.
+ * @return 0 when all runs passed, 1 when a run failed, 2 when the device could not be used
+ */
+int run_benchmark(const std::string& serial, const benchmark_options& options);
+
+} // namespace tcam::tools::ctrl
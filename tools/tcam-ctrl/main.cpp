@@ -16,9 +16,12 @@
 
 #include "../../src/public_utils.h"
 #include "../../src/version.h"
+#include "benchmark.h"
 #include "formats.h"
 #include "general.h"
 #include "properties.h"
+#include "property_benchmark.h"
+#include "snapshot.h"
 #include "system.h"
 
 #include <CLI11.hpp>
@@ -43,25 +46,47 @@ static void print_version(size_t /*t*/)
 }
 
 
+static GstBusSyncReply print_added_device(GstBus* /*bus*/, GstMessage* msg, gpointer /*data*/)
+{
+    if (GST_MESSAGE_TYPE(msg) != GST_MESSAGE_DEVICE_ADDED)
+    {
+        return GST_BUS_PASS;
+    }
+
+    GstDevice* device = nullptr;
+    gst_message_parse_device_added(msg, &device);
+
+    GstStructure* struc = gst_device_get_properties(device);
+
+    printf("Model: %s Serial: %s Type: %s\n",
+           gst_structure_get_string(struc, "model"),
+           gst_structure_get_string(struc, "serial"),
+           gst_structure_get_string(struc, "type"));
+    fflush(stdout);
+
+    gst_structure_free(struc);
+    gst_object_unref(device);
+
+    return GST_BUS_DROP;
+}
+
+
 static void print_devices(size_t /*t*/)
 {
     auto monitor = gst_device_monitor_new();
 
     gst_device_monitor_add_filter(monitor, "Video/Source/tcam", NULL);
 
-    GList* devices = gst_device_monitor_get_devices(monitor);
+    // starting the monitor returns once all backends are enumerated,
+    // devices are printed as soon as their backend reports them
+    GstBus* bus = gst_device_monitor_get_bus(monitor);
+    gst_bus_set_sync_handler(bus, print_added_device, nullptr, nullptr);
 
-    for (GList* dev = devices; dev; dev = dev->next)
-    {
-        GstStructure* struc = gst_device_get_properties(GST_DEVICE(dev->data));
+    gst_device_monitor_start(monitor);
+    gst_device_monitor_stop(monitor);
 
-        printf("Model: %s Serial: %s Type: %s\n",
-               gst_structure_get_string(struc, "model"),
-               gst_structure_get_string(struc, "serial"),
-               gst_structure_get_string(struc, "type"));
-    }
-
-    g_list_free_full(devices, gst_object_unref);
+    gst_bus_set_sync_handler(bus, nullptr, nullptr, nullptr);
+    gst_object_unref(bus);
     gst_object_unref(monitor);
 }
 
@@ -138,6 +163,63 @@ int main(int argc, char* argv[])
                                      "Read a JSON string/file containing properties and their "
                                      "values and set them in the device");
 
+    auto save_snapshot = app.add_option("--save-snapshot",
+                                        serial,
+                                        "Write a binary snapshot of all property values to the "
+                                        "file given as argument");
+    std::string snapshot_user_set;
+    app.add_option("--snapshot-user-set",
+                   snapshot_user_set,
+                   "Also store the settings in this camera user set, e.g. UserSet1. Loading the "
+                   "snapshot then only loads the user set")
+        ->needs(save_snapshot);
+
+    auto load_snapshot = app.add_option("--load-snapshot",
+                                        serial,
+                                        "Restore a snapshot written by --save-snapshot from the "
+                                        "file given as argument");
+
+    benchmark_options benchmark_opts;
+
+    auto benchmark = app.add_option("--benchmark",
+                                    serial,
+                                    "Stream the device with and without tcamconvert and report "
+                                    "framerate, drops, cpu usage and latency");
+    app.add_option("--benchmark-caps",
+                   benchmark_opts.caps_str,
+                   "Caps to benchmark, all caps of the device when not given")
+        ->needs(benchmark);
+    app.add_option("--benchmark-duration",
+                   benchmark_opts.duration_s,
+                   "Seconds to stream per run",
+                   true)
+        ->needs(benchmark);
+    app.add_option("--benchmark-target-fps",
+                   benchmark_opts.target_fps,
+                   "Framerate a run has to reach to pass, default is the framerate of the caps")
+        ->needs(benchmark);
+
+    property_benchmark_options property_benchmark_opts;
+
+    auto property_benchmark = app.add_option(
+        "--property-benchmark",
+        serial,
+        "Measure the read and write latency of all device properties, idle and while streaming");
+    app.add_option("--property-benchmark-iterations",
+                   property_benchmark_opts.iterations,
+                   "Accesses per property and phase",
+                   true)
+        ->needs(property_benchmark);
+    app.add_flag("--property-benchmark-write",
+                 property_benchmark_opts.write,
+                 "Also write the current values back, commands are never executed")
+        ->needs(property_benchmark);
+    app.add_option("--property-benchmark-stall-factor",
+                   property_benchmark_opts.stall_factor,
+                   "Image intervals this many times the median count as stalls",
+                   true)
+        ->needs(property_benchmark);
+
     auto list_transform = app.add_subcommand("--transform", "list format transformations of a GstElement");
 
     std::string transform_element = "tcamconvert";
@@ -275,6 +357,29 @@ int main(int argc, char* argv[])
 
         load_state_json_string(serial, json_str);
     }
+    else if (*save_snapshot || *load_snapshot)
+    {
+        if (app.remaining_size() != 1)
+        {
+            std::cerr << "Expected the snapshot file as argument" << std::endl;
+            return 1;
+        }
+        const auto file = app.remaining().at(0);
+
+        if (*save_snapshot)
+        {
+            return save_property_snapshot(serial, file, snapshot_user_set);
+        }
+        return load_property_snapshot(serial, file);
+    }
+    else if (*benchmark)
+    {
+        return run_benchmark(serial, benchmark_opts);
+    }
+    else if (*property_benchmark)
+    {
+        return run_property_benchmark(serial, property_benchmark_opts);
+    }
     else if (*list_transform)
     {
         std::string caps_str = "";
@@ -0,0 +1,693 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "property_benchmark.h"
+
+#include "../../src/CaptureDevice.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using tcam::property::IPropertyBase;
+
+// time for the camera and auto algorithms to settle before the measurement starts
+constexpr std::chrono::seconds warmup_duration { 1 };
+
+// a property stalls the stream when at least this share of its streaming accesses coincides
+// with a late image, late images that have other causes are spread over all properties
+constexpr double stall_ratio = 0.1;
+
+
+uint64_t monotonic_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+
+struct access_span
+{
+    uint64_t begin_ns = 0;
+    uint64_t end_ns = 0;
+};
+
+
+// accesses of one kind, the spans are kept for the stall detection
+struct samples
+{
+    std::vector<access_span> spans;
+
+    template<class TFunc> bool measure(TFunc&& func)
+    {
+        const auto begin = monotonic_ns();
+        const bool ok = func();
+        spans.push_back({ begin, monotonic_ns() });
+        return ok;
+    }
+
+    std::vector<uint64_t> sorted_durations() const
+    {
+        std::vector<uint64_t> ret;
+        ret.reserve(spans.size());
+        for (const auto& span : spans) { ret.push_back(span.end_ns - span.begin_ns); }
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    }
+};
+
+
+const char* type_name(tcamprop1::prop_type type)
+{
+    switch (type)
+    {
+        case tcamprop1::prop_type::Boolean:
+            return "Boolean";
+        case tcamprop1::prop_type::Integer:
+            return "Integer";
+        case tcamprop1::prop_type::Float:
+            return "Float";
+        case tcamprop1::prop_type::Enumeration:
+            return "Enumeration";
+        case tcamprop1::prop_type::Command:
+            return "Command";
+        case tcamprop1::prop_type::String:
+            return "String";
+    }
+    return "";
+}
+
+
+// one get_value, false when the property cannot be read
+bool read_value(IPropertyBase& prop)
+{
+    using namespace tcam::property;
+
+    switch (prop.get_type())
+    {
+        case tcamprop1::prop_type::Boolean:
+            return static_cast<IPropertyBool&>(prop).get_value().has_value();
+        case tcamprop1::prop_type::Integer:
+            return static_cast<IPropertyInteger&>(prop).get_value().has_value();
+        case tcamprop1::prop_type::Float:
+            return static_cast<IPropertyFloat&>(prop).get_value().has_value();
+        case tcamprop1::prop_type::Enumeration:
+            return static_cast<IPropertyEnum&>(prop).get_value().has_value();
+        case tcamprop1::prop_type::String:
+            return static_cast<IPropertyString&>(prop).get_value().has_value();
+        case tcamprop1::prop_type::Command:
+            return false;
+    }
+    return false;
+}
+
+
+// Writes the value the property had when this was called, empty for commands, strings and
+// properties that are not available or locked.
+std::function<bool()> make_write_back(IPropertyBase& prop)
+{
+    using namespace tcam::property;
+
+    const auto flags = prop.get_flags();
+    if (!(flags & PropertyFlags::Available) || is_locked(flags))
+    {
+        return {};
+    }
+
+    switch (prop.get_type())
+    {
+        case tcamprop1::prop_type::Boolean:
+        {
+            auto& p = static_cast<IPropertyBool&>(prop);
+            auto val = p.get_value();
+            if (!val)
+            {
+                return {};
+            }
+            return [&p, v = val.value()] { return !p.set_value(v).has_error(); };
+        }
+        case tcamprop1::prop_type::Integer:
+        {
+            auto& p = static_cast<IPropertyInteger&>(prop);
+            auto val = p.get_value();
+            if (!val)
+            {
+                return {};
+            }
+            return [&p, v = val.value()] { return !p.set_value(v).has_error(); };
+        }
+        case tcamprop1::prop_type::Float:
+        {
+            auto& p = static_cast<IPropertyFloat&>(prop);
+            auto val = p.get_value();
+            if (!val)
+            {
+                return {};
+            }
+            return [&p, v = val.value()] { return !p.set_value(v).has_error(); };
+        }
+        case tcamprop1::prop_type::Enumeration:
+        {
+            auto& p = static_cast<IPropertyEnum&>(prop);
+            auto val = p.get_value();
+            if (!val)
+            {
+                return {};
+            }
+            return [&p, v = std::string(val.value())] { return !p.set_value(v).has_error(); };
+        }
+        case tcamprop1::prop_type::String:
+        case tcamprop1::prop_type::Command:
+            return {};
+    }
+    return {};
+}
+
+
+struct property_result
+{
+    std::shared_ptr<IPropertyBase> prop;
+
+    // includes what the backend does on the first access, e.g. filling its caches
+    uint64_t first_read_ns = 0;
+    bool readable = false;
+    bool writable = false;
+
+    samples idle_read;
+    samples idle_write;
+    samples stream_read;
+    samples stream_write;
+
+    // streaming accesses that coincide with a late image
+    size_t stalls = 0;
+
+    size_t stream_accesses() const noexcept
+    {
+        return stream_read.spans.size() + stream_write.spans.size();
+    }
+    bool stalls_stream() const noexcept
+    {
+        return stalls >= 2 && stalls >= stall_ratio * stream_accesses();
+    }
+};
+
+
+void measure_property(property_result& res,
+                      bool streaming,
+                      const tcam::tools::ctrl::property_benchmark_options& options)
+{
+    auto& reads = streaming ? res.stream_read : res.idle_read;
+    for (int i = 0; i < options.iterations; ++i)
+    {
+        if (!reads.measure([&res] { return read_value(*res.prop); }))
+        {
+            break;
+        }
+    }
+
+    if (!options.write || (streaming && !res.writable))
+    {
+        return;
+    }
+
+    auto write_back = make_write_back(*res.prop);
+    if (!write_back)
+    {
+        return;
+    }
+
+    auto& writes = streaming ? res.stream_write : res.idle_write;
+    for (int i = 0; i < options.iterations; ++i)
+    {
+        if (!writes.measure(write_back))
+        {
+            break;
+        }
+    }
+    // e.g. read only features or values that are rejected while streaming
+    if (!streaming)
+    {
+        res.writable = !writes.spans.empty() && writes.spans.size() == size_t(options.iterations);
+    }
+}
+
+
+// one pass over all readable properties per sample
+samples measure_read_sweeps(const std::vector<property_result>& results, int iterations)
+{
+    samples ret;
+    for (int i = 0; i < iterations; ++i)
+    {
+        ret.measure(
+            [&results]
+            {
+                for (const auto& res : results)
+                {
+                    if (res.readable)
+                    {
+                        read_value(*res.prop);
+                    }
+                }
+                return true;
+            });
+    }
+    return ret;
+}
+
+
+struct write_sweeps
+{
+    samples single;
+    // empty when no property of the device supports batched writes
+    samples batched;
+};
+
+// one pass over all writable properties per sample, once with single writes and once with the
+// properties of one batch in one transaction
+write_sweeps measure_write_sweeps(const std::vector<property_result>& results, int iterations)
+{
+    using namespace tcam::property;
+
+    std::vector<std::function<bool()>> singles;
+    std::vector<std::pair<std::shared_ptr<IPropertyWriteBatch>, std::function<bool()>>> batched;
+
+    for (const auto& res : results)
+    {
+        if (!res.writable)
+        {
+            continue;
+        }
+        auto write_back = make_write_back(*res.prop);
+        if (!write_back)
+        {
+            continue;
+        }
+
+        auto provider = std::dynamic_pointer_cast<IPropertyWriteBatchProvider>(res.prop);
+        if (auto batch = provider ? provider->get_write_batch() : nullptr)
+        {
+            batched.emplace_back(batch, write_back);
+        }
+        singles.push_back(std::move(write_back));
+    }
+
+    write_sweeps ret;
+    if (singles.empty())
+    {
+        return ret;
+    }
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        ret.single.measure(
+            [&singles]
+            {
+                for (auto& write : singles) { write(); }
+                return true;
+            });
+    }
+
+    if (batched.empty())
+    {
+        return ret;
+    }
+
+    // properties without a batch are written one by one, as in the single pass
+    std::vector<std::function<bool()>> unbatched;
+    for (const auto& res : results)
+    {
+        auto provider = std::dynamic_pointer_cast<IPropertyWriteBatchProvider>(res.prop);
+        if (res.writable && !(provider && provider->get_write_batch()))
+        {
+            if (auto write_back = make_write_back(*res.prop))
+            {
+                unbatched.push_back(std::move(write_back));
+            }
+        }
+    }
+
+    std::vector<std::shared_ptr<IPropertyWriteBatch>> batches;
+    for (const auto& [batch, write] : batched)
+    {
+        if (std::find(batches.begin(), batches.end(), batch) == batches.end())
+        {
+            batches.push_back(batch);
+        }
+    }
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        ret.batched.measure(
+            [&]
+            {
+                for (auto& batch : batches)
+                {
+                    batch->begin_writes();
+                    for (auto& [owner, write] : batched)
+                    {
+                        if (owner == batch)
+                        {
+                            write();
+                        }
+                    }
+                    (void)batch->commit_writes();
+                }
+                for (auto& write : unbatched) { write(); }
+                return true;
+            });
+    }
+    return ret;
+}
+
+
+// the active format, or the largest resolution with the highest framerate of the first format
+std::optional<tcam::VideoFormat> select_format(tcam::CaptureDevice& dev)
+{
+    auto active = dev.get_active_video_format();
+    if (active.get_size().width != 0 && active.get_framerate() > 0)
+    {
+        return active;
+    }
+
+    for (const auto& desc : dev.get_available_video_formats())
+    {
+        auto resolutions = desc.get_resolutions();
+        if (resolutions.empty())
+        {
+            continue;
+        }
+
+        tcam::VideoFormat fmt;
+        fmt.set_fourcc(desc.get_fourcc());
+        fmt.set_size(resolutions.front().max_size.width, resolutions.front().max_size.height);
+        fmt.set_scaling(resolutions.front().scaling);
+
+        auto rates = desc.get_framerates(fmt);
+        if (rates.empty())
+        {
+            continue;
+        }
+        fmt.set_framerate(*std::max_element(rates.begin(), rates.end()));
+        return fmt;
+    }
+    return std::nullopt;
+}
+
+
+struct stream_state
+{
+    std::mutex mtx;
+    bool recording = false;
+    std::vector<uint64_t> arrival_ns;
+};
+
+
+// intervals between two images that are stall_factor times longer than the median interval
+std::vector<access_span> find_late_intervals(const std::vector<uint64_t>& arrival_ns,
+                                             double stall_factor)
+{
+    std::vector<access_span> ret;
+    if (arrival_ns.size() < 3)
+    {
+        return ret;
+    }
+
+    std::vector<uint64_t> intervals;
+    for (size_t i = 1; i < arrival_ns.size(); ++i)
+    {
+        intervals.push_back(arrival_ns[i] - arrival_ns[i - 1]);
+    }
+    auto median = intervals.begin() + intervals.size() / 2;
+    std::nth_element(intervals.begin(), median, intervals.end());
+    const double limit = *median * stall_factor;
+
+    for (size_t i = 1; i < arrival_ns.size(); ++i)
+    {
+        if (arrival_ns[i] - arrival_ns[i - 1] > limit)
+        {
+            ret.push_back({ arrival_ns[i - 1], arrival_ns[i] });
+        }
+    }
+    return ret;
+}
+
+
+// late is sorted and does not overlap
+size_t count_stalls(const samples& accesses, const std::vector<access_span>& late)
+{
+    size_t ret = 0;
+    for (const auto& span : accesses.spans)
+    {
+        // first late interval that ends after the access began
+        auto iter = std::upper_bound(late.begin(),
+                                     late.end(),
+                                     span.begin_ns,
+                                     [](uint64_t t, const access_span& l) { return t < l.end_ns; });
+        if (iter != late.end() && iter->begin_ns < span.end_ns)
+        {
+            ret++;
+        }
+    }
+    return ret;
+}
+
+
+double to_us(uint64_t ns)
+{
+    return ns / 1e3;
+}
+
+// nearest rank
+uint64_t percentile(const std::vector<uint64_t>& sorted, int p)
+{
+    return sorted[(sorted.size() - 1) * p / 100];
+}
+
+std::string format_samples(const samples& s)
+{
+    auto sorted = s.sorted_durations();
+    if (sorted.empty())
+    {
+        return "n/a";
+    }
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << "p50 " << to_us(percentile(sorted, 50))
+        << " us, p99 " << to_us(percentile(sorted, 99)) << " us, max " << to_us(sorted.back())
+        << " us";
+    return out.str();
+}
+
+
+void print_result(const property_result& res, bool write)
+{
+    std::cout << std::endl
+              << res.prop->get_name() << " (" << type_name(res.prop->get_type()) << ")"
+              << std::endl;
+
+    if (!res.readable)
+    {
+        std::cout << "  read:    not readable" << std::endl;
+        return;
+    }
+
+    std::cout << std::fixed << std::setprecision(1) << "  read:    first "
+              << to_us(res.first_read_ns) << " us" << std::endl
+              << "           idle      " << format_samples(res.idle_read) << std::endl
+              << "           streaming " << format_samples(res.stream_read) << std::endl;
+
+    if (write)
+    {
+        if (res.writable)
+        {
+            std::cout << "  write:   idle      " << format_samples(res.idle_write) << std::endl
+                      << "           streaming " << format_samples(res.stream_write)
+                      << std::endl;
+        }
+        else
+        {
+            std::cout << "  write:   not writable" << std::endl;
+        }
+    }
+
+    if (res.stream_accesses() > 0)
+    {
+        std::cout << "  stalls:  " << res.stalls << " of " << res.stream_accesses()
+                  << " streaming accesses coincide with a late image"
+                  << (res.stalls_stream() ? ", STALLS THE STREAM" : "") << std::endl;
+    }
+}
+
+} // namespace
+
+
+int tcam::tools::ctrl::run_property_benchmark(const std::string& serial,
+                                              const property_benchmark_options& options)
+{
+    auto dev = tcam::open_device(serial);
+    if (!dev)
+    {
+        std::cerr << "Unable to open device with serial '" << serial << "'." << std::endl;
+        return 2;
+    }
+
+    std::vector<property_result> results;
+    for (auto& prop : dev->get_properties())
+    {
+        if (prop->get_type() != tcamprop1::prop_type::Command
+            && tcam::property::is_implemented(prop->get_flags()))
+        {
+            property_result res;
+            res.prop = prop;
+            results.push_back(std::move(res));
+        }
+    }
+
+    std::cout << dev->get_device().get_name() << " " << serial << " ("
+              << dev->get_device().get_device_type_as_string() << "), " << results.size()
+              << " properties, " << options.iterations << " accesses per property and phase"
+              << std::endl;
+
+    // idle
+    for (auto& res : results)
+    {
+        const auto begin = monotonic_ns();
+        res.readable = read_value(*res.prop);
+        res.first_read_ns = monotonic_ns() - begin;
+
+        if (res.readable)
+        {
+            measure_property(res, false, options);
+        }
+    }
+    const auto idle_sweeps = measure_read_sweeps(results, options.iterations);
+    write_sweeps idle_write_sweeps;
+    if (options.write)
+    {
+        idle_write_sweeps = measure_write_sweeps(results, options.iterations);
+    }
+
+    // streaming
+    auto format = select_format(*dev);
+    if (!format)
+    {
+        std::cerr << "The device has no format to stream." << std::endl;
+        return 2;
+    }
+
+    stream_state state;
+    std::shared_ptr<tcam::ImageSink> sink;
+    sink = std::make_shared<tcam::ImageSink>(
+        [&state, &sink](const std::shared_ptr<tcam::ImageBuffer>& buffer)
+        {
+            {
+                std::scoped_lock lck { state.mtx };
+                if (state.recording)
+                {
+                    state.arrival_ns.push_back(monotonic_ns());
+                }
+            }
+            sink->requeue_buffer(buffer);
+        },
+        *format,
+        10);
+
+    if (!dev->configure_stream(*format, sink, nullptr) || !dev->start_stream())
+    {
+        std::cerr << "Unable to stream " << format->to_string() << "." << std::endl;
+        return 2;
+    }
+    std::cout << "Streaming " << format->to_string() << std::endl;
+
+    std::this_thread::sleep_for(warmup_duration);
+    {
+        std::scoped_lock lck { state.mtx };
+        state.recording = true;
+    }
+
+    for (auto& res : results)
+    {
+        if (res.readable)
+        {
+            measure_property(res, true, options);
+        }
+    }
+    const auto stream_sweeps = measure_read_sweeps(results, options.iterations);
+
+    {
+        std::scoped_lock lck { state.mtx };
+        state.recording = false;
+    }
+    dev->stop_stream();
+    dev->free_stream();
+
+    const auto late = find_late_intervals(state.arrival_ns, options.stall_factor);
+    for (auto& res : results)
+    {
+        res.stalls = count_stalls(res.stream_read, late) + count_stalls(res.stream_write, late);
+    }
+
+    for (const auto& res : results) { print_result(res, options.write); }
+
+    const auto readable = std::count_if(
+        results.begin(), results.end(), [](const property_result& r) { return r.readable; });
+
+    std::cout << std::endl
+              << "All " << readable << " readable properties in one pass" << std::endl
+              << "  read:    idle      " << format_samples(idle_sweeps) << std::endl
+              << "           streaming " << format_samples(stream_sweeps) << std::endl;
+    if (options.write)
+    {
+        std::cout << "  write:   single    " << format_samples(idle_write_sweeps.single)
+                  << std::endl
+                  << "           batched   " << format_samples(idle_write_sweeps.batched)
+                  << std::endl;
+    }
+
+    std::cout << std::endl
+              << state.arrival_ns.size() << " images while streaming, " << late.size()
+              << " of them late" << std::endl;
+
+    std::vector<std::string> stalling;
+    for (const auto& res : results)
+    {
+        if (res.stalls_stream())
+        {
+            stalling.emplace_back(res.prop->get_name());
+        }
+    }
+    if (stalling.empty())
+    {
+        std::cout << "No property stalls the stream." << std::endl;
+        return 0;
+    }
+
+    std::cout << "Properties that stall the stream:";
+    for (const auto& name : stalling) { std::cout << " " << name; }
+    std::cout << std::endl;
+    return 1;
+}
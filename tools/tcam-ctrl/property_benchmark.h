@@ -0,0 +1,42 @@
+/*
+ * Copyright 2026 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+
+namespace tcam::tools::ctrl
+{
+
+struct property_benchmark_options
+{
+    // accesses per property and phase
+    int iterations = 50;
+    // also write the current value back, commands are never executed
+    bool write = false;
+    // an image interval this many times the median interval counts as a stall
+    double stall_factor = 1.5;
+};
+
+/**
+ * Measures get_value/set_value of every property of the device, once idle and once while the
+ * device streams at its current format, and prints the latency distributions per property.
+ * Properties whose accesses coincide with late images are flagged as stalling the stream.
+ * @return 0 when no property stalls the stream, 1 otherwise, 2 when the device could not be used
+ */
+int run_property_benchmark(const std::string& serial, const property_benchmark_options& options);
+
+} // namespace tcam::tools::ctrl
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "snapshot.h"
+
+#include "../../src/CaptureDevice.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+int tcam::tools::ctrl::save_property_snapshot(const std::string& serial,
+                                              const std::string& file,
+                                              const std::string& user_set)
+{
+    auto dev = tcam::open_device(serial);
+    if (!dev)
+    {
+        std::cerr << "Unable to open device with serial '" << serial << "'." << std::endl;
+        return 1;
+    }
+
+    auto snapshot = dev->save_property_snapshot(user_set);
+    if (!snapshot)
+    {
+        std::cerr << "Unable to create snapshot: " << snapshot.error().message() << std::endl;
+        return 1;
+    }
+
+    std::ofstream ofs(file, std::ios::binary | std::ios::trunc);
+    ofs.write(reinterpret_cast<const char*>(snapshot.value().data()), snapshot.value().size());
+    if (!ofs)
+    {
+        std::cerr << "Unable to write '" << file << "'." << std::endl;
+        return 1;
+    }
+
+    std::cout << "Wrote " << snapshot.value().size() << " bytes to " << file << std::endl;
+    return 0;
+}
+
+
+int tcam::tools::ctrl::load_property_snapshot(const std::string& serial, const std::string& file)
+{
+    std::ifstream ifs(file, std::ios::binary);
+    if (!ifs)
+    {
+        std::cerr << "Unable to read '" << file << "'." << std::endl;
+        return 1;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(ifs)),
+                              std::istreambuf_iterator<char>());
+
+    auto dev = tcam::open_device(serial);
+    if (!dev)
+    {
+        std::cerr << "Unable to open device with serial '" << serial << "'." << std::endl;
+        return 1;
+    }
+
+    auto written = dev->load_property_snapshot(data);
+    if (!written)
+    {
+        std::cerr << "Unable to load snapshot: " << written.error().message() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Wrote " << written.value().size() << " properties" << std::endl;
+    for (const auto& name : written.value()) { std::cout << "\t" << name << std::endl; }
+    return 0;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+
+namespace tcam::tools::ctrl
+{
+
+/**
+ * Writes a binary snapshot of all property values of the device to file.
+ * With a non-empty user_set the camera also stores its settings in that user set.
+ * @return 0 on success, 1 otherwise
+ */
+int save_property_snapshot(const std::string& serial,
+                           const std::string& file,
+                           const std::string& user_set);
+
+/**
+ * Restores a snapshot written by save_property_snapshot and prints the written properties.
+ * @return 0 on success, 1 otherwise
+ */
+int load_property_snapshot(const std::string& serial, const std::string& file);
+
+} // namespace tcam::tools::ctrl
@@ -21,6 +21,8 @@
 #include "../../src/tcam-semaphores.h"
 #include "gige-daemon.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <sstream>
 #include <stdlib.h>
@@ -35,7 +37,8 @@
 using namespace tis;
 
 
-tcam::tools::gige_daemon::CameraListHolder::CameraListHolder() : continue_loop(true)
+tcam::tools::gige_daemon::CameraListHolder::CameraListHolder()
+    : scan_interval_ms(SCAN_INTERVAL_MIN_MS), continue_loop(true)
 {
     // to understand shared memory use this guide:
     // https://beej.us/guide/bgipc/html/single/bgipc.html#semaphores
@@ -112,6 +115,8 @@ std::vector<DeviceInfo> tcam::tools::gige_daemon::CameraListHolder::get_camera_l
 
     for (unsigned int i = 0; i < d->device_count; ++i) { ret.push_back(DeviceInfo(d->devices[i])); }
 
+    shmdt(d);
+
     return ret;
 }
 
@@ -148,11 +153,47 @@ static std::vector<tcam::DeviceInfo> get_aravis_list()
 }
 
 
+// a busy camera may miss a discovery, it is not reported as lost for that
+static const int LOST_SCAN_COUNT = 3;
+
+
+void tcam::tools::gige_daemon::CameraListHolder::apply_loss_tolerance(std::vector<DeviceInfo>& list)
+{
+    for (auto& entry : seen_devices)
+    {
+        if (std::find(list.begin(), list.end(), entry.dev) != list.end())
+        {
+            entry.missed_scans = 0;
+        }
+        else if (++entry.missed_scans < LOST_SCAN_COUNT)
+        {
+            list.push_back(entry.dev);
+        }
+    }
+
+    seen_devices.erase(std::remove_if(seen_devices.begin(),
+                                      seen_devices.end(),
+                                      [](const seen_device& entry)
+                                      { return entry.missed_scans >= LOST_SCAN_COUNT; }),
+                       seen_devices.end());
+
+    for (const auto& dev : list)
+    {
+        if (std::none_of(seen_devices.begin(),
+                         seen_devices.end(),
+                         [&dev](const seen_device& entry) { return entry.dev == dev; }))
+        {
+            seen_devices.push_back({ dev, 0 });
+        }
+    }
+}
+
+
 void tcam::tools::gige_daemon::CameraListHolder::loop_function()
 {
     std::unique_lock<std::mutex> lck(mtx);
 
-    auto res = cv.wait_for(lck, std::chrono::seconds(2));
+    auto res = cv.wait_for(lck, std::chrono::milliseconds(scan_interval_ms));
 
     // preemptiv stop
     if (res == std::cv_status::no_timeout)
@@ -161,6 +202,7 @@ void tcam::tools::gige_daemon::CameraListHolder::loop_function()
     }
 
     std::vector<tcam::DeviceInfo> aravis_list = get_aravis_list();
+    apply_loss_tolerance(aravis_list);
     std::vector<struct tcam_device_info> arv_list;
     arv_list.reserve(aravis_list.size());
     for (const auto& e : aravis_list) { arv_list.push_back(e.get_info()); }
@@ -174,14 +216,52 @@ void tcam::tools::gige_daemon::CameraListHolder::loop_function()
 
     struct tcam_gige_device_list* tmp_ptr = (struct tcam_gige_device_list*)shmat(shmid, NULL, 0);
 
-    tmp_ptr->device_count = arv_list.size();
+    if (tmp_ptr == (void*)-1)
+    {
+        return;
+    }
+
+    // clients only copy the list again, when the generation changed
+    bool changed = tmp_ptr->device_count != arv_list.size()
+                   || memcmp(tmp_ptr->devices,
+                             arv_list.data(),
+                             arv_list.size() * sizeof(struct tcam_device_info))
+                          != 0;
 
-    struct tcam_device_info* ptr = tmp_ptr->devices;
-    for (const auto& dev : arv_list)
+    if (changed)
     {
-        memcpy(ptr, &dev, sizeof(struct tcam_device_info));
-        ++ptr;
+        const uint64_t generation = tmp_ptr->generation.load(std::memory_order_relaxed);
+
+        tmp_ptr->generation.store(generation + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        tmp_ptr->device_count = arv_list.size();
+
+        struct tcam_device_info* ptr = tmp_ptr->devices;
+        for (const auto& dev : arv_list)
+        {
+            memcpy(ptr, &dev, sizeof(struct tcam_device_info));
+            ++ptr;
+        }
+
+        tmp_ptr->generation.store(generation + 2, std::memory_order_release);
+
+        tmp_ptr->change_count.fetch_add(1, std::memory_order_release);
+        notify_change(tmp_ptr->change_count);
+
+        // devices that were just plugged in often come with others, e.g. a switch was powered
+        scan_interval_ms = SCAN_INTERVAL_MIN_MS;
     }
+    else
+    {
+        // nobody is waiting for changes, clients that only poll are fine with the idle interval
+        const int64_t max_interval = tmp_ptr->subscriber_count.load(std::memory_order_relaxed) != 0
+                                         ? SCAN_INTERVAL_SUBSCRIBED_MS
+                                         : SCAN_INTERVAL_IDLE_MS;
+        scan_interval_ms = std::min(scan_interval_ms * 2, max_interval);
+    }
+
+    tmp_ptr->last_update_ms.store(get_device_list_time_ms(), std::memory_order_release);
 
     // force update to change time
     struct shmid_ds ds = {};
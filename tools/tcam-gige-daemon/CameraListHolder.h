@@ -51,10 +51,23 @@ private:
 
     void loop_function();
 
+    // keeps devices that are missing from fewer than LOST_SCAN_COUNT consecutive scans
+    void apply_loss_tolerance(std::vector<DeviceInfo>& list);
+
     std::vector<DeviceInfo> camera_list;
 
+    struct seen_device
+    {
+        DeviceInfo dev;
+        int missed_scans = 0;
+    };
+    std::vector<seen_device> seen_devices;
+
     std::vector<std::string> interface_list;
 
+    // see SCAN_INTERVAL_MIN_MS
+    int64_t scan_interval_ms;
+
     bool continue_loop = true;
     std::thread work_thread;
     std::mutex mtx;
@@ -19,18 +19,93 @@
 
 #include "../../src/base_types.h"
 
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 namespace tcam::tools::gige_daemon
 {
 
 static const size_t TCAM_DEVICE_LIST_MAX = 50;
 
+// Layout of the shared memory segment.
+// The daemon writes it while holding the semaphore. Clients do not need the semaphore, they
+// read it like a seqlock: generation is odd while the daemon changes the list, a copy is only
+// valid when generation was even and did not change while copying.
 struct tcam_gige_device_list
 {
+    // incremented before and after every change of the list
+    std::atomic<uint64_t> generation;
+    // std::chrono::steady_clock time of the last completed discovery in ms
+    // steady_clock is CLOCK_MONOTONIC, so the value is comparable between processes
+    std::atomic<int64_t> last_update_ms;
+
+    // incremented after every change of the list
+    // subscribers wait on it with wait_for_change, the daemon wakes them with notify_change
+    std::atomic<uint32_t> change_count;
+    // number of attached subscribers, the daemon scans more often while there are any
+    std::atomic<uint32_t> subscriber_count;
+
     unsigned int device_count;
 
     tcam::tcam_device_info devices[TCAM_DEVICE_LIST_MAX];
 };
 
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared memory requires lock free atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free && sizeof(std::atomic<uint32_t>) == 4,
+              "futex requires a plain 32 bit word");
+
+// Clients use local discovery, when the daemon did not update the list for this long,
+// e.g. because it was killed and the segment still exists.
+constexpr int64_t DEVICE_LIST_MAX_AGE_MS = 10000;
+
+// The daemon scans again SCAN_INTERVAL_MIN_MS after a change and doubles the interval for every
+// scan without a change, up to SCAN_INTERVAL_SUBSCRIBED_MS while clients are subscribed and
+// SCAN_INTERVAL_IDLE_MS otherwise. Both have to stay well below DEVICE_LIST_MAX_AGE_MS.
+constexpr int64_t SCAN_INTERVAL_MIN_MS = 500;
+constexpr int64_t SCAN_INTERVAL_SUBSCRIBED_MS = 2000;
+constexpr int64_t SCAN_INTERVAL_IDLE_MS = 5000;
+
+// futex operations on a word of the shared segment
+// FUTEX_PRIVATE_FLAG must not be used, the waiters are in other processes
+
+// returns when change_count is not expected anymore, after timeout_ms or on a spurious wakeup
+inline void wait_for_change(std::atomic<uint32_t>& change_count, uint32_t expected, int64_t timeout_ms)
+{
+    timespec timeout = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000 };
+    syscall(SYS_futex,
+            reinterpret_cast<uint32_t*>(&change_count),
+            FUTEX_WAIT,
+            expected,
+            &timeout,
+            nullptr,
+            0);
+}
+
+inline void notify_change(std::atomic<uint32_t>& change_count)
+{
+    syscall(SYS_futex,
+            reinterpret_cast<uint32_t*>(&change_count),
+            FUTEX_WAKE,
+            INT_MAX,
+            nullptr,
+            nullptr,
+            0);
+}
+
+inline int64_t get_device_list_time_ms()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
 constexpr const char* LOCK_FILE = "/var/lock/tcam-gige-daemon.lock";
 
 } // namespace tcam::tools::gige_daemon
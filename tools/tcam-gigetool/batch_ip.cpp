@@ -0,0 +1,539 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "batch_ip.h"
+
+#include "../../external/json/json.hpp"
+#include "../../src/tcam-network/Camera.h"
+#include "../../src/tcam-network/CameraDiscovery.h"
+#include "../../src/tcam-network/GvcpEngine.h"
+#include "../../src/tcam-network/gigevision.h"
+#include "../../src/tcam-network/utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace tcam::tools::gigetool
+{
+
+namespace
+{
+
+// time the cameras get to apply a FORCEIP before the result is verified
+constexpr auto FORCEIP_SETTLE_TIME = std::chrono::milliseconds(500);
+
+std::string trim(const std::string& str)
+{
+    const auto begin = str.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos)
+    {
+        return std::string();
+    }
+    const auto end = str.find_last_not_of(" \t\r\n");
+    return str.substr(begin, end - begin + 1);
+}
+
+
+ip_assignment make_assignment(const std::string& mac,
+                              const std::string& ip,
+                              const std::string& netmask,
+                              const std::string& gateway,
+                              const std::string& location)
+{
+    if (!tis::isValidMAC(mac))
+    {
+        throw std::runtime_error(location + ": invalid MAC address '" + mac + "'");
+    }
+
+    std::string err;
+    if (!tis::verifySettings(ip, netmask, gateway, err))
+    {
+        throw std::runtime_error(location + ": " + err);
+    }
+
+    // normalize, so that the entries can be compared with Camera::getMAC
+    return { tis::int2mac(tis::mac2int(mac)), ip, netmask, gateway };
+}
+
+
+std::vector<ip_assignment> parse_json(std::istream& in,
+                                      const std::string& default_netmask,
+                                      const std::string& default_gateway)
+{
+    auto json = nlohmann::json::parse(in, nullptr, false);
+
+    if (!json.is_array())
+    {
+        throw std::runtime_error("JSON file has to contain an array of assignments");
+    }
+
+    std::vector<ip_assignment> ret;
+    for (size_t i = 0; i < json.size(); ++i)
+    {
+        const auto& entry = json.at(i);
+        const std::string location = "entry " + std::to_string(i);
+
+        if (!entry.is_object() || !entry.contains("mac") || !entry.contains("ip"))
+        {
+            throw std::runtime_error(location + ": 'mac' and 'ip' are required");
+        }
+
+        ret.push_back(make_assignment(entry.at("mac").get<std::string>(),
+                                      entry.at("ip").get<std::string>(),
+                                      entry.value("netmask", default_netmask),
+                                      entry.value("gateway", default_gateway),
+                                      location));
+    }
+    return ret;
+}
+
+
+std::vector<ip_assignment> parse_csv(std::istream& in,
+                                     const std::string& default_netmask,
+                                     const std::string& default_gateway)
+{
+    std::vector<ip_assignment> ret;
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line))
+    {
+        line_number++;
+        line = trim(line);
+
+        if (line.empty() || line.front() == '#')
+        {
+            continue;
+        }
+
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) { fields.push_back(trim(field)); }
+
+        // header
+        if (line_number == 1 && !fields.empty() && fields.front() == "mac")
+        {
+            continue;
+        }
+
+        const std::string location = "line " + std::to_string(line_number);
+        if (fields.size() < 2 || fields.size() > 4)
+        {
+            throw std::runtime_error(location + ": expected mac,ip[,netmask[,gateway]]");
+        }
+
+        ret.push_back(make_assignment(fields.at(0),
+                                      fields.at(1),
+                                      fields.size() > 2 ? fields.at(2) : default_netmask,
+                                      fields.size() > 3 ? fields.at(3) : default_gateway,
+                                      location));
+    }
+    return ret;
+}
+
+
+tis::camera_list discover()
+{
+    tis::camera_list cameras;
+    std::mutex cam_lock;
+
+    tis::discoverCameras(
+        [&cameras, &cam_lock](std::shared_ptr<tis::Camera> camera)
+        {
+            std::lock_guard<std::mutex> lck(cam_lock);
+
+            // interfaces with multiple addresses report a camera more than once
+            if (std::none_of(cameras.begin(),
+                             cameras.end(),
+                             [&camera](const std::shared_ptr<tis::Camera>& cam)
+                             { return cam->getMAC() == camera->getMAC(); }))
+            {
+                cameras.push_back(camera);
+            }
+        });
+
+    return cameras;
+}
+
+
+std::shared_ptr<tis::Camera> find_by_mac(const tis::camera_list& cameras, const std::string& mac)
+{
+    for (const auto& cam : cameras)
+    {
+        if (cam->getMAC() == mac)
+        {
+            return cam;
+        }
+    }
+    return nullptr;
+}
+
+
+bool has_configuration(tis::Camera& camera, const ip_assignment& entry)
+{
+    return tis::ip2int(camera.getCurrentIP()) == tis::ip2int(entry.ip)
+           && tis::ip2int(camera.getCurrentSubnet()) == tis::ip2int(entry.netmask);
+}
+
+
+enum class entry_state
+{
+    pending,
+    forced, // current configuration is correct, persistent configuration still missing
+    done,
+};
+
+
+struct batch_entry
+{
+    ip_assignment assignment;
+    entry_state state = entry_state::pending;
+    int attempts = 0;
+    std::string error;
+
+    // filled by the engine callbacks
+    bool forceip_acked = false;
+};
+
+
+/**
+ * FORCEIP is addressed by MAC and broadcasted on all interfaces, as a camera that does not
+ * answer the discovery cannot be associated with an interface.
+ * Every entry gets its own sockets, so that the engine has all of them in flight at the same time.
+ */
+void queue_forceip(tis::GvcpEngine& engine,
+                   const std::vector<std::shared_ptr<tis::NetworkInterface>>& interfaces,
+                   batch_entry& entry)
+{
+    const uint64_t mac = tis::mac2int(entry.assignment.mac);
+
+    Packet::CMD_FORCEIP packet = {};
+
+    packet.header.magic = 0x42;
+    packet.header.flag = Flags::NEEDACK;
+    packet.header.command = htons(Commands::FORCEIP_CMD);
+    packet.header.length = htons(sizeof(Packet::CMD_FORCEIP) - sizeof(Packet::COMMAND_HEADER));
+    packet.header.req_id = htons(2);
+
+    packet.DeviceMACHigh = htons(mac >> 32 & 0xFFFF);
+    packet.DeviceMACLow = htonl(mac & 0xFFFFFFFF);
+
+    packet.StaticIP = tis::ip2int(entry.assignment.ip);
+    packet.StaticSubnetMask = tis::ip2int(entry.assignment.netmask);
+    packet.StaticGateway = tis::ip2int(entry.assignment.gateway);
+
+    auto callback = [&entry](void* /*msg*/, size_t /*size*/) -> int
+    {
+        entry.forceip_acked = true;
+        return tis::Socket::SendAndReceiveSignals::END;
+    };
+
+    for (const auto& inf : interfaces)
+    {
+        try
+        {
+            engine.addRequest(
+                inf->createSocket(), "255.255.255.255", &packet, sizeof(packet), callback, true);
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << inf->getInterfaceName() << ": " << e.what() << std::endl;
+        }
+    }
+}
+
+
+struct persistent_request
+{
+    batch_entry* entry = nullptr;
+    std::shared_ptr<tis::Camera> camera;
+
+    unsigned int control_status = Status::TIMEOUT;
+    unsigned int read_status = Status::TIMEOUT;
+    uint32_t ipcfg = 0;
+
+    unsigned int ip_status = Status::TIMEOUT;
+    unsigned int netmask_status = Status::TIMEOUT;
+    unsigned int gateway_status = Status::TIMEOUT;
+    unsigned int ipcfg_status = Status::TIMEOUT;
+    unsigned int release_status = Status::TIMEOUT;
+};
+
+
+/**
+ * Writes the persistent configuration of all cameras in two engine runs.
+ * The first one takes control and reads the ip configuration register,
+ * the second one writes the persistent registers and releases control.
+ * The requests of one camera are run in order on its socket,
+ * the cameras themselves are accessed at the same time.
+ */
+void write_persistent(std::vector<persistent_request>& requests)
+{
+    {
+        tis::GvcpEngine engine;
+        for (auto& r : requests)
+        {
+            r.camera->queueWriteRegisters(
+                engine, { { Register::CONTROLCHANNEL_PRIVELEGE_REGISTER, 2 } }, r.control_status);
+            r.camera->queueReadMemory(
+                engine, Register::CURRENT_IPCFG_REGISTER, 4, &r.ipcfg, r.read_status);
+        }
+        engine.run();
+    }
+
+    tis::GvcpEngine engine;
+    for (auto& r : requests)
+    {
+        if (r.control_status != Status::SUCCESS)
+        {
+            continue;
+        }
+
+        if (r.read_status == Status::SUCCESS)
+        {
+            const uint32_t ip = tis::ip2int(r.entry->assignment.ip);
+            const uint32_t netmask = tis::ip2int(r.entry->assignment.netmask);
+            const uint32_t gateway = tis::ip2int(r.entry->assignment.gateway);
+
+            // static ip on, dhcp off, link local address always on
+            uint32_t ipcfg = ntohl(r.ipcfg);
+            ipcfg |= Register::IPCFG_PERSISTANT | Register::IPCFG_LLA;
+            ipcfg &= ~Register::IPCFG_DHCP;
+            ipcfg = htonl(ipcfg);
+
+            r.camera->queueWriteMemory(
+                engine, Register::PERSISTANT_IPADDRESS_REGISTER, 4, &ip, r.ip_status);
+            r.camera->queueWriteMemory(
+                engine, Register::PERSISTANT_SUBNETMASK_REGISTER, 4, &netmask, r.netmask_status);
+            r.camera->queueWriteMemory(
+                engine, Register::PERSISTANT_DEFAULTGATEWAY_REGISTER, 4, &gateway, r.gateway_status);
+            r.camera->queueWriteMemory(
+                engine, Register::CURRENT_IPCFG_REGISTER, 4, &ipcfg, r.ipcfg_status);
+        }
+
+        r.camera->queueWriteRegisters(
+            engine, { { Register::CONTROLCHANNEL_PRIVELEGE_REGISTER, 0 } }, r.release_status);
+    }
+    engine.run();
+
+    for (auto& r : requests)
+    {
+        if (r.control_status != Status::SUCCESS)
+        {
+            r.entry->error = "unable to get control, camera is busy";
+        }
+        else if (r.read_status != Status::SUCCESS)
+        {
+            r.entry->error = "unable to read ip configuration";
+        }
+        else if (r.ip_status != Status::SUCCESS || r.netmask_status != Status::SUCCESS
+                 || r.gateway_status != Status::SUCCESS || r.ipcfg_status != Status::SUCCESS)
+        {
+            r.entry->error = "unable to write persistent ip configuration";
+        }
+        else
+        {
+            r.entry->state = entry_state::done;
+            r.entry->error.clear();
+        }
+    }
+}
+
+} // namespace
+
+
+std::vector<ip_assignment> read_ip_assignments(const std::string& file,
+                                               const std::string& default_netmask,
+                                               const std::string& default_gateway)
+{
+    std::ifstream in(file);
+    if (!in)
+    {
+        throw std::runtime_error("Unable to open '" + file + "'");
+    }
+
+    // JSON files start with their array, everything else is treated as CSV
+    in >> std::ws;
+    if (in.peek() == '[')
+    {
+        return parse_json(in, default_netmask, default_gateway);
+    }
+    return parse_csv(in, default_netmask, default_gateway);
+}
+
+
+int run_batch_ip(const batch_ip_options& options)
+{
+    std::vector<batch_entry> entries;
+    try
+    {
+        for (auto& a :
+             read_ip_assignments(options.file, options.default_netmask, options.default_gateway))
+        {
+            batch_entry entry;
+            entry.assignment = a;
+            entries.push_back(entry);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+
+    if (entries.empty())
+    {
+        std::cerr << "No assignments in '" << options.file << "'" << std::endl;
+        return 2;
+    }
+
+    const auto interfaces = tis::detectNetworkInterfaces();
+    if (interfaces.empty())
+    {
+        std::cerr << "No usable network interfaces." << std::endl;
+        return 2;
+    }
+
+    std::cout << "Configuring " << entries.size() << " cameras..." << std::endl;
+
+    auto cameras = discover();
+
+    for (int round = 0; round <= options.retries; ++round)
+    {
+        bool sent_forceip = false;
+        {
+            tis::GvcpEngine engine;
+            for (auto& entry : entries)
+            {
+                if (entry.state != entry_state::pending)
+                {
+                    continue;
+                }
+
+                auto cam = find_by_mac(cameras, entry.assignment.mac);
+                if (cam && has_configuration(*cam, entry.assignment))
+                {
+                    entry.state = entry_state::forced;
+                    continue;
+                }
+
+                entry.attempts++;
+                entry.forceip_acked = false;
+                queue_forceip(engine, interfaces, entry);
+                sent_forceip = true;
+            }
+            engine.run();
+        }
+
+        if (sent_forceip)
+        {
+            std::this_thread::sleep_for(FORCEIP_SETTLE_TIME);
+            cameras = discover();
+        }
+
+        std::vector<persistent_request> persistent;
+        for (auto& entry : entries)
+        {
+            if (entry.state == entry_state::done)
+            {
+                continue;
+            }
+
+            auto cam = find_by_mac(cameras, entry.assignment.mac);
+            if (!cam)
+            {
+                entry.state = entry_state::pending;
+                entry.error = entry.forceip_acked ? "acknowledged but not found afterwards"
+                                                  : "camera not found";
+                continue;
+            }
+            if (!has_configuration(*cam, entry.assignment))
+            {
+                entry.state = entry_state::pending;
+                entry.error = "camera reports " + cam->getCurrentIP() + "/" + cam->getCurrentSubnet();
+                continue;
+            }
+
+            entry.state = entry_state::forced;
+            entry.error.clear();
+
+            if (!options.persistent)
+            {
+                entry.state = entry_state::done;
+            }
+            else if (cam->isReachable())
+            {
+                persistent_request r;
+                r.entry = &entry;
+                r.camera = cam;
+                persistent.push_back(r);
+            }
+            else
+            {
+                entry.error = "not reachable from this host, persistent configuration not written";
+            }
+        }
+
+        if (!persistent.empty())
+        {
+            write_persistent(persistent);
+        }
+
+        if (std::all_of(entries.begin(),
+                        entries.end(),
+                        [](const batch_entry& e) { return e.state == entry_state::done; }))
+        {
+            break;
+        }
+    }
+
+    std::cout << std::endl << std::left;
+
+    size_t failed = 0;
+    for (const auto& entry : entries)
+    {
+        const bool ok = entry.state == entry_state::done;
+        if (!ok)
+        {
+            failed++;
+        }
+
+        std::cout << std::setw(6) << (ok ? "OK" : "FAIL") << std::setw(20) << entry.assignment.mac
+                  << std::setw(17) << entry.assignment.ip << std::setw(17)
+                  << entry.assignment.netmask << "attempts: " << entry.attempts;
+        if (!ok)
+        {
+            std::cout << " - " << entry.error;
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << std::endl
+              << entries.size() - failed << " of " << entries.size() << " cameras configured."
+              << std::endl;
+
+    return failed == 0 ? 0 : 1;
+}
+
+} // namespace tcam::tools::gigetool
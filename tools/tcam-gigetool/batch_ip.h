@@ -0,0 +1,65 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace tcam::tools::gigetool
+{
+
+struct ip_assignment
+{
+    std::string mac;
+    std::string ip;
+    std::string netmask;
+    std::string gateway;
+};
+
+struct batch_ip_options
+{
+    // CSV or JSON file with the assignments
+    std::string file;
+    // used for entries without netmask/gateway
+    std::string default_netmask = "255.255.255.0";
+    std::string default_gateway = "0.0.0.0";
+    // number of additional rounds for cameras that did not take their configuration
+    int retries = 3;
+    // also write the persistent ip configuration and enable static ip
+    bool persistent = false;
+};
+
+/**
+ * Reads assignments from file.
+ * CSV: one "mac,ip[,netmask[,gateway]]" per line, empty lines and lines starting with '#' are
+ *      ignored, as is a header line starting with "mac".
+ * JSON: array of objects with the keys "mac", "ip" and optionally "netmask" and "gateway".
+ * @throw std::runtime_error on unreadable files or invalid entries
+ */
+std::vector<ip_assignment> read_ip_assignments(const std::string& file,
+                                               const std::string& default_netmask,
+                                               const std::string& default_gateway);
+
+/**
+ * Sends FORCEIP for all assignments at the same time, verifies the result with a discovery and
+ * repeats this for the cameras that did not take their configuration.
+ * Prints one summary line per assignment.
+ * @return 0 when all cameras were configured, 1 when some failed, 2 when the file could not be used
+ */
+int run_batch_ip(const batch_ip_options& options);
+
+} // namespace tcam::tools::gigetool
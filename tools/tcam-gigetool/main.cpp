@@ -18,12 +18,15 @@
 
 #include "../../src/tcam-network/Camera.h"
 #include "../../src/tcam-network/CameraDiscovery.h"
+#include "batch_ip.h"
 
+#include <atomic>
 #include <iostream>
 #include <mutex>
 #include <memory>
 #include <ostream>
 #include <string>
+#include <thread>
 
 namespace
 {
@@ -769,8 +772,8 @@ int execute_batch_upload (const CLI::App& app)
                         return tis::camera_list();
                     }
                 }
+                cameras.push_back(cam);
             }
-            cameras.push_back(cam);
         }
         return cameras;
     };
@@ -784,36 +787,70 @@ int execute_batch_upload (const CLI::App& app)
         return 0;
     }
 
-    if (app.get_option("--reconfigure"))
+    if (*app.get_option("--reconfigure"))
     {
         batch_rescue(cameras, base_address);
         sleep(1);
         cameras = get_interface_cameras(interface);
     }
 
+    size_t parallel = 1;
+    app.get_option("--parallel")->results(parallel);
+    parallel = std::max<size_t>(parallel, 1);
+
+    size_t window = 1;
+    app.get_option("--window")->results(window);
+
     std::cout << "Uploading to " << cameras.size() << " cameras..." << std::endl;
 
-    for (auto& camera : cameras)
+    // every camera has its own socket, so the uploads do not interfere
+    std::mutex output_lock;
+    std::atomic<size_t> next_camera = 0;
+    auto upload_worker = [&]()
     {
-        std::string serial = camera->getSerialNumber();
-        auto func = [&serial] (int progress, const std::string& s) {
-            std::cout << "\r";
+        for (size_t i = next_camera++; i < cameras.size(); i = next_camera++)
+        {
+            auto& camera = cameras.at(i);
+            std::string serial = camera->getSerialNumber();
 
-            std::cout << std::setw(10) << serial << std::setw(5) << progress << "%";
-            if (s != "")
+            // only report steps of 10%, the cameras are updated at the same time
+            int last_reported = -10;
+            auto func = [&] (int progress, const std::string& s) {
+                if (progress < last_reported + 10 && s.empty())
+                {
+                    return;
+                }
+                last_reported = progress;
+
+                std::lock_guard<std::mutex> lck(output_lock);
+                std::cout << std::setw(10) << serial << std::setw(5) << progress << "%";
+                if (s != "")
+                {
+                    std::cout << std::setw(40) << s;
+                }
+                std::cout << std::endl;
+            };
+
+            int ret = camera->uploadFirmware(firmware_file, "", func, window);
+
+            std::lock_guard<std::mutex> lck(output_lock);
+            if (ret < 0)
             {
-                std::cout << std::setw(40) << s;
+                std::cerr << "Error while uploading firmware to " << serial << std::endl;
+            }
+            else
+            {
+                std::cout << serial << ": done" << std::endl;
             }
-            std::cout.flush();
-        };
-
-        std::cout << std::endl;
-        int ret = camera->uploadFirmware(firmware_file, "", func);
-        if (ret < 0)
-        {
-            std::cerr << "Error while uploading firmware to " << serial << std::endl;
         }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < std::min(parallel, cameras.size()); ++i)
+    {
+        workers.emplace_back(upload_worker);
     }
+    for (auto& w : workers) { w.join(); }
 
     std::cout << "Done." << std::endl;
     return 0;
@@ -843,24 +880,19 @@ int execute_check_control(const CLI::App& app)
     static constexpr int GEV_PRIMARY_APPLICATION_PORT_REGISTER = 0x0A04;
     static constexpr int GEV_PRIMARY_APPLICATION_IP_ADDRESS_REGISTER = 0x0A14;
     static constexpr int GEV_HEARTBEAT_TIMEOUT_REGISTER = 0x0938;
-    uint32_t port;
-    uint32_t address;
-    uint32_t timeout;
-    if (!camera->sendReadRegister(GEV_PRIMARY_APPLICATION_IP_ADDRESS_REGISTER, &address))
-    {
-        std::cerr << "Unable to read address register from device." << std::endl;
-        return 2;
-    }
-    if (!camera->sendReadRegister(GEV_PRIMARY_APPLICATION_PORT_REGISTER, &port))
-    {
-        std::cerr << "Unable to read port register from device." << std::endl;
-        return 2;
-    }
-    if (!camera->sendReadRegister(GEV_HEARTBEAT_TIMEOUT_REGISTER, &timeout))
-    {
-        std::cerr << "Unable to read timeout register from device." << std::endl;
+    // one READREG for all registers
+    std::vector<uint32_t> values;
+    if (!camera->sendReadRegisters({ GEV_PRIMARY_APPLICATION_IP_ADDRESS_REGISTER,
+                                     GEV_PRIMARY_APPLICATION_PORT_REGISTER,
+                                     GEV_HEARTBEAT_TIMEOUT_REGISTER },
+                                   values))
+    {
+        std::cerr << "Unable to read control registers from device." << std::endl;
         return 2;
     }
+    uint32_t address = values.at(0);
+    uint32_t port = values.at(1);
+    uint32_t timeout = values.at(2);
 
     // hacky fix
     // many firmware versions return a wrong value for the port information
@@ -969,7 +1001,29 @@ int main(int argc, char* argv[])
 
     auto app_batch_fw = app.add_subcommand("batchupload", "upload firmware to camera");
     app_batch_fw->add_option("--file", "Firmware file to use")->check(CLI::ExistingFile)->required();
-    app_batch_fw->add_option("-b,--baseaddress", "Firmware file to use")->check(CLI::ExistingFile)->required();
+    app_batch_fw->add_option("-b,--baseaddress", "First IPv4 address for --reconfigure")->check(CLI::ValidIPV4);
+    app_batch_fw->add_option("--interface", "Network interface of the cameras")->required();
+    app_batch_fw->add_flag("--reconfigure", "Assign consecutive addresses starting at --baseaddress");
+    app_batch_fw->add_option("--parallel", "Number of cameras that are updated at the same time")->default_val("8");
+    app_batch_fw->add_option("--window", "Number of flash write requests in flight per camera")
+        ->default_val(std::to_string(tis::FIRMWARE_UPLOAD_WINDOW_SIZE));
+
+    auto app_batch_ip = app.add_subcommand("batchconfigure",
+                                           "assign IP configurations from a CSV or JSON file");
+    tcam::tools::gigetool::batch_ip_options batch_ip;
+    app_batch_ip->add_option("--file", batch_ip.file, "File with mac,ip[,netmask[,gateway]] entries")
+        ->check(CLI::ExistingFile)
+        ->required();
+    app_batch_ip
+        ->add_option("--netmask", batch_ip.default_netmask, "Netmask for entries without one", true)
+        ->check(CLI::ValidIPV4);
+    app_batch_ip
+        ->add_option("--gateway", batch_ip.default_gateway, "Gateway for entries without one", true)
+        ->check(CLI::ValidIPV4);
+    app_batch_ip->add_option("--retries", batch_ip.retries, "Additional attempts per camera", true);
+    app_batch_ip->add_flag("--persistent",
+                           batch_ip.persistent,
+                           "Also store the configuration as persistent static IP");
 
     auto check_control = app.add_subcommand("check-control", "find IP of controlling PC");
 
@@ -1010,6 +1064,10 @@ int main(int argc, char* argv[])
     {
         return execute_batch_upload(*app_batch_fw);
     }
+    else if (*app_batch_ip)
+    {
+        return tcam::tools::gigetool::run_batch_ip(batch_ip);
+    }
     else if (*check_control)
     {
         return execute_check_control(*check_control);
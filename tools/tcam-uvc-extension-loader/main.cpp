@@ -46,6 +46,12 @@ int main(int argc, char** argv)
     f->required();
     f->check(CLI::ExistingFile);
 
+    std::string cache_file;
+    app.add_option("-c,--compile",
+                   cache_file,
+                   "Write the mappings of the file as binary cache instead of applying them.",
+                   false);
+
     bool verbose_output = false;
     app.add_flag("-v,--verbose", verbose_output, "Print additional output.");
 
@@ -61,8 +67,18 @@ int main(int argc, char** argv)
     // for loading the file we always want verbose output
     bool tmp_output = verbose_output;
     verbose_output = true;
-    // load file
-    auto mappings = tcam::uvc::load_description_file(description_file, message_cb);
+
+    if (!cache_file.empty())
+    {
+        if (!tcam::uvc::write_mapping_cache(description_file, cache_file, message_cb))
+        {
+            return 3;
+        }
+        return 0;
+    }
+
+    // load file, prefers an up to date cache next to a json file
+    auto mappings = tcam::uvc::load_mapping_file(description_file, message_cb);
     if (mappings.empty())
     {
         return 3;